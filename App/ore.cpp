@@ -62,20 +62,24 @@ int main(int argc, char** argv) {
         exit(0);
     }
 
-    if (argc != 2) {
-        std::cout << endl << "usage: ORE path/to/ore.xml" << endl << endl;
+    bool service = argc == 3 && string(argv[1]) == "--service";
+    if (argc != 2 && !service) {
+        std::cout << endl << "usage: ORE [--service] path/to/ore.xml" << endl << endl;
         return -1;
     }
 
     ore::data::initBuilders();
 
-    string inputFile(argv[1]);
+    string inputFile(argv[service ? 2 : 1]);
 
     try {
         auto params = boost::make_shared<Parameters>();
         params->fromFile(inputFile);
-        OREApp ore(params, true);
-        ore.run();
+        OREApp ore(params, !service);
+        if (service)
+            ore.runService(std::cin, std::cout);
+        else
+            ore.run();
         return 0;
     } catch (const exception& e) {
         cout << endl << "an error occurred: " << e.what() << endl;
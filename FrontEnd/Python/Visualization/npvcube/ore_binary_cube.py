@@ -0,0 +1,159 @@
+'''
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+'''
+
+# Memory mapped reader for ORE binary cube files (cube.bin), the Python counterpart of the C++ MappedBinaryCubeReader
+# in OREAnalytics/orea/cube/binarycubefile.hpp.
+#
+# The file is mapped read-only and the values are returned as numpy views on the mapped file, i.e. without copying, so
+# that cubes larger than the available memory can be explored. Only uncompressed files are supported, i.e. cubes written
+# with the file ending .bin, not .bin.gz.
+#
+# Example:
+#
+#     from ore_binary_cube import BinaryCube
+#     cube = BinaryCube("Output/cube.bin")
+#     npv = cube.values("Swap_20")           # shape (dates, samples, depth)
+#     epe = npv[:, :, 0].clip(min=0).mean(axis=1)
+#     date5 = cube.date_slice(5)             # shape (ids, samples), copied chunk by chunk
+
+import datetime
+import struct
+
+import numpy as np
+
+_MAGIC = b"ORECBIN\0"
+_VERSION = 2
+_ENDIANNESS_MARKER = 0x01020304
+# serial numbers are the ones of QuantLib::Date, i.e. days since 30 December 1899
+_SERIAL_ORIGIN = datetime.date(1899, 12, 30)
+
+
+def _to_date(serial):
+    return _SERIAL_ORIGIN + datetime.timedelta(days=int(serial))
+
+
+class BinaryCube:
+    """Read-only view of a binary cube file, see BinaryCubeWriter for the format.
+
+    The values of an id are stored contiguously: depth T0 values followed by the future values in (date, sample,
+    depth) order. The ids are stored in chunks of idsPerChunk ids, each chunk is preceded by its raw and stored size.
+    """
+
+    def __init__(self, filename):
+        self.filename = filename
+        self._map = np.memmap(filename, dtype=np.uint8, mode="r")
+        self._pos = 0
+
+        if bytes(self._read_bytes(len(_MAGIC))) != _MAGIC:
+            raise ValueError(filename + " is not a binary cube file")
+        version, marker, value_size, compressed = self._read("=IIII")
+        if version != _VERSION:
+            raise ValueError("unsupported version %d in %s" % (version, filename))
+        if marker != _ENDIANNESS_MARKER:
+            raise ValueError(filename + " was written on a platform with different byte order")
+        if value_size not in (4, 8):
+            raise ValueError("unsupported value size %d in %s" % (value_size, filename))
+        if compressed != 0:
+            raise ValueError(filename + " is compressed and can not be memory mapped, write the cube as .bin")
+
+        (asof,) = self._read("=q")
+        n_ids, n_dates, samples, depth = self._read("=QQQQ")
+        self.asof = _to_date(asof)
+        self.dates = [_to_date(s) for s in self._read("=%dq" % n_dates)]
+        self.samples = samples
+        self.depth = depth
+        self.ids = []
+        for _ in range(n_ids):
+            (size,) = self._read("=I")
+            self.ids.append(bytes(self._read_bytes(size)).decode("utf-8"))
+        self._index = {id: n for n, id in enumerate(self.ids)}
+        self.ids_per_chunk, n_chunks = self._read("=QQ")
+        self._offsets = self._read("=%dQ" % n_chunks)
+        if 0 in self._offsets:
+            raise ValueError(filename + " is incomplete, the chunk index is not written")
+
+        self.dtype = np.dtype(np.float64 if value_size == 8 else np.float32)
+        self._id_values = depth * (1 + n_dates * samples)
+        for c, offset in enumerate(self._offsets):
+            n = min(self.ids_per_chunk, n_ids - c * self.ids_per_chunk)
+            raw, stored = struct.unpack_from("=QQ", self._map, offset)
+            if raw != stored or raw != n * self._id_values * value_size:
+                raise ValueError("chunk %d in %s is corrupt" % (c, filename))
+            if offset + 16 + raw > len(self._map):
+                raise ValueError("chunk %d exceeds the size of %s" % (c, filename))
+
+    def _read_bytes(self, n):
+        result = self._map[self._pos : self._pos + n]
+        if len(result) != n:
+            raise ValueError("unexpected end of header in " + self.filename)
+        self._pos += n
+        return result
+
+    def _read(self, fmt):
+        size = struct.calcsize(fmt)
+        result = struct.unpack_from(fmt, self._map, self._pos)
+        self._pos += size
+        return result
+
+    @property
+    def shape(self):
+        """The dimensions (ids, dates, samples, depth) of the cube"""
+        return (len(self.ids), len(self.dates), self.samples, self.depth)
+
+    def index(self, id):
+        """The position of an id in ids"""
+        return self._index[id]
+
+    def _position(self, id):
+        return id if isinstance(id, (int, np.integer)) else self._index[id]
+
+    def chunk(self, c):
+        """View of the chunk c with shape (ids in chunk, 1 + dates * samples, depth), the T0 values come first"""
+        n = min(self.ids_per_chunk, len(self.ids) - c * self.ids_per_chunk)
+        return np.ndarray(
+            shape=(n, 1 + len(self.dates) * self.samples, self.depth),
+            dtype=self.dtype,
+            buffer=self._map,
+            offset=self._offsets[c] + 16,
+        )
+
+    def _block(self, id):
+        n = self._position(id)
+        return self.chunk(n // self.ids_per_chunk)[n % self.ids_per_chunk]
+
+    def t0(self, id):
+        """View of the T0 values of an id (given by name or position), shape (depth,)"""
+        return self._block(id)[0]
+
+    def values(self, id):
+        """View of the future values of an id (given by name or position), shape (dates, samples, depth)"""
+        return self._block(id)[1:].reshape(len(self.dates), self.samples, self.depth)
+
+    def get(self, id, date, sample, depth=0):
+        """A single future value"""
+        return self.values(id)[date, sample, depth]
+
+    def date_slice(self, date, depth=0, ids=None):
+        """The values of all (or the given) ids at a date index, shape (ids, samples); the chunks can not be viewed
+        as one array, so this is copied chunk by chunk"""
+        if ids is not None:
+            return np.stack([self.values(id)[date, :, depth] for id in ids])
+        begin = 1 + date * self.samples
+        return np.concatenate(
+            [self.chunk(c)[:, begin : begin + self.samples, depth] for c in range(len(self._offsets))]
+        )
@@ -0,0 +1,123 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <benchmark/benchmarkdata.hpp>
+
+#include <test/testmarket.hpp>
+#include <test/testportfolio.hpp>
+
+#include <ql/settings.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::analytics;
+
+namespace ore {
+namespace benchmarks {
+
+Date benchmarkDate() { return Date(14, April, 2016); }
+
+boost::shared_ptr<Market> initMarket() {
+    Settings::instance().evaluationDate() = benchmarkDate();
+    // the test market sets up the conventions it needs
+    return boost::make_shared<testsuite::TestMarket>(benchmarkDate());
+}
+
+boost::shared_ptr<ScenarioSimMarketParameters> simMarketParameters() {
+    auto parameters = boost::make_shared<ScenarioSimMarketParameters>();
+    parameters->baseCcy() = "EUR";
+    parameters->setDiscountCurveNames({"EUR", "GBP", "USD", "CHF", "JPY"});
+    parameters->setYieldCurveTenors("",
+                                    {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
+    parameters->setIndices({"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M", "CHF-LIBOR-6M", "JPY-LIBOR-6M"});
+    parameters->interpolation() = "LogLinear";
+
+    parameters->setSimulateSwapVols(false);
+    parameters->setSwapVolTerms("", {6 * Months, 1 * Years});
+    parameters->setSwapVolExpiries("", {1 * Years, 2 * Years});
+    parameters->setSwapVolKeys({"EUR", "GBP", "USD", "CHF", "JPY"});
+    parameters->swapVolDecayMode() = "ForwardVariance";
+
+    parameters->setFxVolExpiries("", {1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years, 4 * Years, 5 * Years});
+    parameters->setFxVolDecayMode(std::string("ConstantVariance"));
+    parameters->setSimulateFXVols(false);
+    parameters->setFxVolCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
+    parameters->setFxCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
+
+    parameters->setEquityVolExpiries("",
+                                     {1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years, 4 * Years, 5 * Years});
+    parameters->setEquityVolDecayMode("ConstantVariance");
+    parameters->setSimulateEquityVols(false);
+    return parameters;
+}
+
+boost::shared_ptr<EngineData> engineData() {
+    auto data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("FxOption") = "GarmanKohlhagen";
+    data->engine("FxOption") = "AnalyticEuropeanEngine";
+    return data;
+}
+
+boost::shared_ptr<Portfolio> swapPortfolio(Size n) {
+    // the trade parameters cycle deterministically, so that the portfolio only depends on n
+    static const std::vector<std::pair<std::string, std::string>> ccyIndex = {{"EUR", "EUR-EURIBOR-6M"},
+                                                                             {"USD", "USD-LIBOR-3M"},
+                                                                             {"GBP", "GBP-LIBOR-6M"},
+                                                                             {"CHF", "CHF-LIBOR-6M"},
+                                                                             {"JPY", "JPY-LIBOR-6M"}};
+    auto portfolio = boost::make_shared<Portfolio>();
+    for (Size i = 0; i < n; ++i) {
+        auto const& ci = ccyIndex[i % ccyIndex.size()];
+        Size term = 2 + (7 * i) % 29;
+        Real rate = 0.001 + 0.0001 * static_cast<Real>((13 * i) % 390);
+        portfolio->add(testsuite::buildSwap("Swap_" + std::to_string(i), ci.first, i % 2 == 0, 10000000.0, 0, term,
+                                            rate, 0.0, "1Y", "30/360", "6M", "A360", ci.second));
+    }
+    return portfolio;
+}
+
+boost::shared_ptr<Portfolio> fxOptionPortfolio(Size n) {
+    auto portfolio = boost::make_shared<Portfolio>();
+    for (Size i = 0; i < n; ++i) {
+        Size expiry = 1 + i % 5;
+        Real soldAmount = 1000000.0 * (1.0 + 0.05 * static_cast<Real>(i % 11));
+        portfolio->add(testsuite::buildFxOption("FxOption_" + std::to_string(i), i % 2 == 0 ? "Long" : "Short",
+                                                i % 3 == 0 ? "Put" : "Call", expiry, "EUR", 1000000.0, "USD",
+                                                soldAmount));
+    }
+    return portfolio;
+}
+
+TemporaryFile::TemporaryFile(const std::string& suffix) {
+    name_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("ore-benchmark-%%%%-%%%%"))
+                .string() +
+            suffix;
+}
+
+TemporaryFile::~TemporaryFile() {
+    boost::system::error_code ec;
+    boost::filesystem::remove(name_, ec);
+}
+
+} // namespace benchmarks
+} // namespace ore
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/benchmarkdata.hpp
+    \brief Deterministic market, portfolio and file fixtures shared by the benchmarks
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <ored/marketdata/market.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/time/date.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+
+namespace ore {
+namespace benchmarks {
+
+//! The fixed as of date of all benchmarks, the date of the test market
+QuantLib::Date benchmarkDate();
+
+//! Sets the evaluation date and the conventions and returns the test market
+boost::shared_ptr<ore::data::Market> initMarket();
+
+//! Simulation market parameters with discount and index curves in EUR, GBP, USD, CHF and JPY
+boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> simMarketParameters();
+
+//! Engine data for swaps and fx options
+boost::shared_ptr<ore::data::EngineData> engineData();
+
+//! A portfolio of \p n vanilla swaps in five currencies, the same for each call with the same \p n
+boost::shared_ptr<ore::data::Portfolio> swapPortfolio(QuantLib::Size n);
+
+//! A portfolio of \p n EUR/USD fx options with varying expiries and strikes
+boost::shared_ptr<ore::data::Portfolio> fxOptionPortfolio(QuantLib::Size n);
+
+//! A file in the temporary directory that is removed when the object goes out of scope
+class TemporaryFile {
+public:
+    explicit TemporaryFile(const std::string& suffix);
+    ~TemporaryFile();
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+    const std::string& name() const { return name_; }
+
+private:
+    std::string name_;
+};
+
+} // namespace benchmarks
+} // namespace ore
@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/cube.cpp
+    \brief Benchmarks for NPV cube access and IO
+*/
+
+#include <benchmark/benchmarkdata.hpp>
+
+#include <orea/cube/cube_io.hpp>
+#include <orea/cube/inmemorycube.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/make_shared.hpp>
+
+using namespace QuantLib;
+using namespace ore::analytics;
+using namespace ore::benchmarks;
+
+namespace {
+
+const Size cubeDates = 50;
+const Size cubeSamples = 100;
+// the file formats of the cube IO benchmarks, selected by the second benchmark argument
+const std::vector<std::string> cubeFileSuffixes = {".csv", ".bin"};
+
+boost::shared_ptr<DoublePrecisionInMemoryCube> buildCube(const Size trades, const InMemoryCubeLayout layout) {
+    std::set<std::string> ids;
+    for (Size i = 0; i < trades; ++i)
+        ids.insert("Trade_" + std::to_string(i));
+    std::vector<Date> dates;
+    for (Size j = 0; j < cubeDates; ++j)
+        dates.push_back(benchmarkDate() + static_cast<Integer>(30 * (j + 1)));
+    return boost::make_shared<DoublePrecisionInMemoryCube>(benchmarkDate(), ids, dates, cubeSamples, 0.0, layout);
+}
+
+void fillCube(NPVCube& cube) {
+    for (Size i = 0; i < cube.numIds(); ++i)
+        for (Size j = 0; j < cube.numDates(); ++j)
+            for (Size k = 0; k < cube.samples(); ++k)
+                cube.set(static_cast<Real>(i + j + k), i, j, k);
+}
+
+// set in the order of the valuation engine, i.e. trades inside dates inside samples
+void BM_CubeSet(benchmark::State& state) {
+    auto cube = buildCube(state.range(0), static_cast<InMemoryCubeLayout>(state.range(1)));
+    for (auto _ : state) {
+        for (Size k = 0; k < cube->samples(); ++k)
+            for (Size j = 0; j < cube->numDates(); ++j)
+                for (Size i = 0; i < cube->numIds(); ++i)
+                    cube->set(1.0, i, j, k);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * cube->numIds() * cube->numDates() * cube->samples());
+}
+
+// get in the order of the post processor, i.e. samples inside dates inside trades
+void BM_CubeGet(benchmark::State& state) {
+    auto cube = buildCube(state.range(0), static_cast<InMemoryCubeLayout>(state.range(1)));
+    fillCube(*cube);
+    for (auto _ : state) {
+        Real sum = 0.0;
+        for (Size i = 0; i < cube->numIds(); ++i)
+            for (Size j = 0; j < cube->numDates(); ++j)
+                for (Size k = 0; k < cube->samples(); ++k)
+                    sum += cube->get(i, j, k);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * cube->numIds() * cube->numDates() * cube->samples());
+}
+
+void BM_CubeSave(benchmark::State& state) {
+    auto cube = buildCube(state.range(0), InMemoryCubeLayout::TradeDateSampleDepth);
+    fillCube(*cube);
+    TemporaryFile file(cubeFileSuffixes[state.range(1)]);
+    for (auto _ : state)
+        saveCube(file.name(), *cube, true);
+    state.SetItemsProcessed(state.iterations() * cube->numIds() * cube->numDates() * cube->samples());
+}
+
+void BM_CubeLoad(benchmark::State& state) {
+    auto cube = buildCube(state.range(0), InMemoryCubeLayout::TradeDateSampleDepth);
+    fillCube(*cube);
+    TemporaryFile file(cubeFileSuffixes[state.range(1)]);
+    saveCube(file.name(), *cube, true);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(loadCube(file.name(), true));
+    state.SetItemsProcessed(state.iterations() * cube->numIds() * cube->numDates() * cube->samples());
+}
+
+} // namespace
+
+// the second argument is the InMemoryCubeLayout for set and get and the file format for save and load
+BENCHMARK(BM_CubeSet)->Args({1000, 0})->Args({1000, 1})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CubeGet)->Args({1000, 0})->Args({1000, 1})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CubeSave)->Args({100, 0})->Args({100, 1})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CubeLoad)->Args({100, 0})->Args({100, 1})->Unit(benchmark::kMillisecond);
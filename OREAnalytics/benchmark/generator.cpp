@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/generator.cpp
+    \brief Command line tool writing synthetic portfolios and matching market configurations
+*/
+
+#include <benchmark/portfoliogenerator.hpp>
+
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/settings.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <map>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::benchmarks;
+
+namespace {
+
+void usage() {
+    std::cout << "usage: ore-generator [--swaps=N] [--fxOptions=N] [--bermudanSwaptions=N] [--cds=N]\n"
+                 "                     [--currencies=M] [--counterparties=K] [--asof=YYYY-MM-DD]\n"
+                 "                     [--input=path/to/Examples/Input] [--marketFile=market_20160205.txt]\n"
+                 "                     [--output=path]\n\n"
+                 "Writes portfolio.xml and netting.xml to the output path and, if an input path is given, copies of\n"
+                 "todaysmarket.xml, curveconfig.xml and the market file from the input path with default curves for\n"
+                 "the synthetic counterparties added. The as of date defaults to 2016-02-05, the date of the example\n"
+                 "market data.\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+
+    std::map<std::string, std::string> args = {{"swaps", "0"},
+                                               {"fxOptions", "0"},
+                                               {"bermudanSwaptions", "0"},
+                                               {"cds", "0"},
+                                               {"currencies", "5"},
+                                               {"counterparties", "10"},
+                                               {"asof", "2016-02-05"},
+                                               {"input", ""},
+                                               {"marketFile", "market_20160205.txt"},
+                                               {"output", "."}};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        auto pos = arg.find('=');
+        if (arg.substr(0, 2) != "--" || pos == std::string::npos || args.find(arg.substr(2, pos - 2)) == args.end()) {
+            usage();
+            return arg == "-h" || arg == "--help" ? 0 : -1;
+        }
+        args[arg.substr(2, pos - 2)] = arg.substr(pos + 1);
+    }
+
+    try {
+        PortfolioGeneratorParameters parameters;
+        parameters.swaps = parseInteger(args["swaps"]);
+        parameters.fxOptions = parseInteger(args["fxOptions"]);
+        parameters.bermudanSwaptions = parseInteger(args["bermudanSwaptions"]);
+        parameters.creditDefaultSwaps = parseInteger(args["cds"]);
+        parameters.currencies = parseInteger(args["currencies"]);
+        parameters.counterparties = parseInteger(args["counterparties"]);
+
+        Date asof = parseDate(args["asof"]);
+        Settings::instance().evaluationDate() = asof;
+
+        boost::filesystem::path output(args["output"]);
+        boost::filesystem::create_directories(output);
+
+        writePortfolio(parameters, (output / "portfolio.xml").string());
+        generateNettingSets(parameters)->toFile((output / "netting.xml").string());
+        std::cout << "Wrote " << parameters.size() << " trades for " << parameters.counterparties
+                  << " counterparties to " << output.string() << std::endl;
+
+        if (!args["input"].empty()) {
+            boost::filesystem::path input(args["input"]);
+            writeMarketConfiguration(parameters, asof, (input / "todaysmarket.xml").string(),
+                                     (input / "curveconfig.xml").string(), (input / args["marketFile"]).string(),
+                                     output.string());
+            std::cout << "Wrote market configuration based on " << input.string() << std::endl;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
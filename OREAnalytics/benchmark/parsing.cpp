@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/parsing.cpp
+    \brief Benchmarks for loading market data files and parsing portfolio xml
+*/
+
+#include <benchmark/benchmarkdata.hpp>
+
+#include <ored/marketdata/csvloader.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/make_shared.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::benchmarks;
+
+namespace {
+
+std::string dateString(const Date& d) {
+    std::ostringstream os;
+    os << d.year() << std::setw(2) << std::setfill('0') << static_cast<int>(d.month()) << std::setw(2)
+       << std::setfill('0') << d.dayOfMonth();
+    return os.str();
+}
+
+// n distinct money market quotes as of the benchmark date
+void writeMarketFile(const std::string& fileName, const Size n) {
+    static const std::vector<std::string> ccys = {"EUR", "USD", "GBP", "CHF", "JPY"};
+    std::ofstream file(fileName);
+    const std::string asof = dateString(benchmarkDate());
+    for (Size i = 0; i < n; ++i)
+        file << asof << " MM/RATE/" << ccys[i % ccys.size()] << "/" << i / (ccys.size() * 500) << "D/"
+             << (i / ccys.size()) % 500 + 1 << "D " << 0.01 + 1e-6 * static_cast<Real>(i) << "\n";
+}
+
+// n fixings of five ibor indices on the calendar days before the benchmark date
+void writeFixingFile(const std::string& fileName, const Size n) {
+    static const std::vector<std::string> indices = {"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M",
+                                                     "CHF-LIBOR-6M", "JPY-LIBOR-6M"};
+    std::ofstream file(fileName);
+    for (Size i = 0; i < n; ++i)
+        file << dateString(benchmarkDate() - static_cast<Integer>(i / indices.size() + 1)) << " "
+             << indices[i % indices.size()] << " " << 0.01 + 1e-6 * static_cast<Real>(i) << "\n";
+}
+
+void BM_CSVLoaderMarketData(benchmark::State& state) {
+    TemporaryFile marketFile(".txt"), fixingFile(".txt");
+    writeMarketFile(marketFile.name(), state.range(0));
+    writeFixingFile(fixingFile.name(), 0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(CSVLoader(marketFile.name(), fixingFile.name()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CSVLoaderFixings(benchmark::State& state) {
+    TemporaryFile marketFile(".txt"), fixingFile(".txt");
+    writeMarketFile(marketFile.name(), 0);
+    writeFixingFile(fixingFile.name(), state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(CSVLoader(marketFile.name(), fixingFile.name()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PortfolioFromXML(benchmark::State& state) {
+    const std::string xml = swapPortfolio(state.range(0))->toXMLString();
+    for (auto _ : state) {
+        Portfolio portfolio;
+        portfolio.fromXMLString(xml);
+        benchmark::DoNotOptimize(portfolio.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * xml.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_CSVLoaderMarketData)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CSVLoaderFixings)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PortfolioFromXML)->Arg(1000)->Unit(benchmark::kMillisecond);
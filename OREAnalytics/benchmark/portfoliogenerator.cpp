@@ -0,0 +1,218 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <benchmark/portfoliogenerator.hpp>
+
+#include <test/testportfolio.hpp>
+
+#include <ored/portfolio/envelope.hpp>
+#include <ored/utilities/xmlutils.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace QuantLib;
+using namespace ore::data;
+
+namespace ore {
+namespace benchmarks {
+
+namespace {
+
+struct CurrencyData {
+    std::string currency, index, floatFrequency;
+    // rough EUR fx rate, used to set strikes near the money
+    Real eurFxRate;
+};
+
+const std::vector<CurrencyData> currencyData = {{"EUR", "EUR-EURIBOR-6M", "6M", 1.0},
+                                                {"USD", "USD-LIBOR-3M", "3M", 1.1},
+                                                {"GBP", "GBP-LIBOR-6M", "6M", 0.8},
+                                                {"CHF", "CHF-LIBOR-6M", "6M", 1.1},
+                                                {"JPY", "JPY-LIBOR-6M", "6M", 125.0}};
+
+// a uniform number in [0, 1) that only depends on the trade index and the stream, using the splitmix64 mixer
+Real uniform(const Size i, const Size stream) {
+    std::uint64_t z = static_cast<std::uint64_t>(i) * 8 + stream + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return static_cast<Real>(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+Size uniformIndex(const Size i, const Size stream, const Size n) {
+    return std::min(static_cast<Size>(uniform(i, stream) * static_cast<Real>(n)), n - 1);
+}
+
+std::string yyyymmdd(const Date& d) {
+    std::ostringstream os;
+    os << d.year() << std::setw(2) << std::setfill('0') << static_cast<int>(d.month()) << std::setw(2)
+       << std::setfill('0') << d.dayOfMonth();
+    return os.str();
+}
+
+std::string defaultCurveId(const std::string& name) { return name + "_SR_EUR"; }
+
+std::string outputFile(const std::string& outputPath, const std::string& inputFile) {
+    auto p = boost::filesystem::path(outputPath) / boost::filesystem::path(inputFile).filename();
+    QL_REQUIRE(!boost::filesystem::exists(inputFile) || !boost::filesystem::equivalent(p, inputFile),
+               "writeMarketConfiguration: output file " << p.string() << " would overwrite the input file");
+    return p.string();
+}
+
+} // namespace
+
+std::string syntheticCounterparty(Size k) { return "SYN_CPTY_" + std::to_string(k + 1); }
+
+boost::shared_ptr<Trade> generateTrade(const PortfolioGeneratorParameters& parameters, Size i) {
+    QL_REQUIRE(i < parameters.size(), "generateTrade: trade index " << i << " out of range, portfolio has "
+                                                                      << parameters.size() << " trades");
+    QL_REQUIRE(parameters.currencies >= 1 && parameters.currencies <= currencyData.size(),
+               "generateTrade: number of currencies (" << parameters.currencies << ") must be between 1 and "
+                                                       << currencyData.size());
+    QL_REQUIRE(parameters.counterparties >= 1, "generateTrade: at least one counterparty required");
+
+    const std::string cpty = syntheticCounterparty(i % parameters.counterparties);
+    const CurrencyData& ccy = currencyData[uniformIndex(i, 0, parameters.currencies)];
+    const Size term = 2 + uniformIndex(i, 1, 29);
+    const Real rate = 0.005 + 0.035 * uniform(i, 2);
+    const Real notional = 1000000.0 * static_cast<Real>(1 + uniformIndex(i, 3, 100));
+    const bool isPayer = uniform(i, 4) < 0.5;
+    const std::string longShort = uniform(i, 5) < 0.5 ? "Long" : "Short";
+
+    boost::shared_ptr<Trade> trade;
+    Size n = parameters.swaps;
+    if (i < n) {
+        trade = testsuite::buildSwap("SWAP_" + std::to_string(i + 1), ccy.currency, isPayer, notional, 0, term, rate,
+                                     0.0, "1Y", "30/360", ccy.floatFrequency, "A360", ccy.index);
+    } else if (i < (n += parameters.fxOptions)) {
+        // options on EUR against the trade currency, or USD for EUR trades
+        const CurrencyData& foreign = ccy.currency == "EUR" ? currencyData[1] : ccy;
+        const Real strike = foreign.eurFxRate * (0.8 + 0.4 * uniform(i, 6));
+        trade = testsuite::buildFxOption("FXOPTION_" + std::to_string(i + 1), longShort,
+                                         uniform(i, 7) < 0.5 ? "Call" : "Put", 1 + uniformIndex(i, 8, 5), "EUR",
+                                         notional, foreign.currency, notional * strike);
+    } else if (i < (n += parameters.bermudanSwaptions)) {
+        const Size swapTerm = std::min<Size>(term, 20);
+        trade = testsuite::buildBermudanSwaption("BERMUDAN_" + std::to_string(i + 1), longShort, ccy.currency,
+                                                 isPayer, notional, swapTerm - 1, 1, swapTerm - 1, rate, 0.0, "1Y",
+                                                 "30/360", ccy.floatFrequency, "A360", ccy.index);
+    } else {
+        // protection on the next counterparty, so that each counterparty's default curve is also a reference curve
+        const std::string reference = syntheticCounterparty((i + 1) % parameters.counterparties);
+        trade = testsuite::buildCreditDefaultSwap("CDS_" + std::to_string(i + 1), "EUR", reference, reference,
+                                                  isPayer, notional, 0, 1 + uniformIndex(i, 9, 10), 0.0,
+                                                  uniform(i, 10) < 0.5 ? 0.01 : 0.05, "3M", "A360");
+    }
+    trade->envelope() = Envelope(cpty, cpty);
+    return trade;
+}
+
+void writePortfolio(const PortfolioGeneratorParameters& parameters, const std::string& fileName) {
+    std::ofstream file(fileName);
+    QL_REQUIRE(file.is_open(), "writePortfolio: failed to open " << fileName);
+    file << "<?xml version=\"1.0\"?>\n<Portfolio>\n";
+    for (Size i = 0; i < parameters.size(); ++i) {
+        XMLDocument doc;
+        doc.appendNode(generateTrade(parameters, i)->toXML(doc));
+        file << doc.toString();
+    }
+    file << "</Portfolio>\n";
+    file.close();
+    QL_REQUIRE(!file.fail(), "writePortfolio: error writing " << fileName);
+}
+
+boost::shared_ptr<NettingSetManager> generateNettingSets(const PortfolioGeneratorParameters& parameters) {
+    auto manager = boost::make_shared<NettingSetManager>();
+    for (Size k = 0; k < parameters.counterparties; ++k)
+        manager->add(boost::make_shared<NettingSetDefinition>(syntheticCounterparty(k)));
+    return manager;
+}
+
+void writeMarketConfiguration(const PortfolioGeneratorParameters& parameters, const Date& asof,
+                              const std::string& todaysMarketFile, const std::string& curveConfigFile,
+                              const std::string& marketFile, const std::string& outputPath) {
+
+    // today's market: add the default curves to the default configuration
+    XMLDocument todaysMarket(todaysMarketFile);
+    XMLNode* root = todaysMarket.getFirstNode("TodaysMarket");
+    QL_REQUIRE(root, "writeMarketConfiguration: no TodaysMarket node in " << todaysMarketFile);
+    XMLNode* defaultCurves = XMLUtils::getChildNode(root, "DefaultCurves");
+    while (defaultCurves && XMLUtils::getAttribute(defaultCurves, "id") != "default")
+        defaultCurves = XMLUtils::getNextSibling(defaultCurves, "DefaultCurves");
+    if (!defaultCurves) {
+        defaultCurves = XMLUtils::addChild(todaysMarket, root, "DefaultCurves");
+        XMLUtils::addAttribute(todaysMarket, defaultCurves, "id", "default");
+    }
+    for (Size k = 0; k < parameters.counterparties; ++k) {
+        const std::string name = syntheticCounterparty(k);
+        XMLUtils::addChild(todaysMarket, defaultCurves, "DefaultCurve", "Default/EUR/" + defaultCurveId(name), "name",
+                           name);
+    }
+    todaysMarket.toFile(outputFile(outputPath, todaysMarketFile));
+
+    // curve configurations: flat hazard rate curves as for the CPTY_C curve of the examples
+    XMLDocument curveConfig(curveConfigFile);
+    root = curveConfig.getFirstNode("CurveConfiguration");
+    QL_REQUIRE(root, "writeMarketConfiguration: no CurveConfiguration node in " << curveConfigFile);
+    XMLNode* defaultCurveConfigs = XMLUtils::getChildNode(root, "DefaultCurves");
+    if (!defaultCurveConfigs)
+        defaultCurveConfigs = XMLUtils::addChild(curveConfig, root, "DefaultCurves");
+    for (Size k = 0; k < parameters.counterparties; ++k) {
+        const std::string name = syntheticCounterparty(k);
+        XMLNode* node = XMLUtils::addChild(curveConfig, defaultCurveConfigs, "DefaultCurve");
+        XMLUtils::addChild(curveConfig, node, "CurveId", defaultCurveId(name));
+        XMLUtils::addChild(curveConfig, node, "CurveDescription", name + " SR HR EUR");
+        XMLUtils::addChild(curveConfig, node, "Currency", "EUR");
+        XMLUtils::addChild(curveConfig, node, "Type", "HazardRate");
+        XMLUtils::addChild(curveConfig, node, "DiscountCurve", "");
+        XMLUtils::addChild(curveConfig, node, "DayCounter", "A360");
+        XMLUtils::addChild(curveConfig, node, "RecoveryRate", "RECOVERY_RATE/RATE/" + name + "/SR/EUR");
+        XMLNode* quotes = XMLUtils::addChild(curveConfig, node, "Quotes");
+        XMLUtils::addChild(curveConfig, quotes, "Quote", "HAZARD_RATE/RATE/" + name + "/SR/EUR/1Y");
+        XMLUtils::addChild(curveConfig, node, "Conventions", "CDS-STANDARD-CONVENTIONS");
+    }
+    curveConfig.toFile(outputFile(outputPath, curveConfigFile));
+
+    // market data: the input quotes followed by the recovery and hazard rates of the counterparties
+    std::ifstream in(marketFile);
+    QL_REQUIRE(in.is_open(), "writeMarketConfiguration: failed to open " << marketFile);
+    const std::string marketOutputFile = outputFile(outputPath, marketFile);
+    std::ofstream out(marketOutputFile);
+    QL_REQUIRE(out.is_open(), "writeMarketConfiguration: failed to open " << marketOutputFile);
+    out << in.rdbuf();
+    const std::string date = yyyymmdd(asof);
+    for (Size k = 0; k < parameters.counterparties; ++k) {
+        const std::string name = syntheticCounterparty(k);
+        out << "\n" << date << " RECOVERY_RATE/RATE/" << name << "/SR/EUR 0.4";
+        out << "\n" << date << " HAZARD_RATE/RATE/" << name << "/SR/EUR/1Y " << 0.005 + 0.0005 * (k % 20);
+    }
+    out << "\n";
+    out.close();
+    QL_REQUIRE(!out.fail(), "writeMarketConfiguration: error writing " << marketOutputFile);
+}
+
+} // namespace benchmarks
+} // namespace ore
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/portfoliogenerator.hpp
+    \brief Synthetic large portfolios and matching market configurations for scaling tests
+*/
+
+#pragma once
+
+#include <ored/portfolio/nettingsetmanager.hpp>
+#include <ored/portfolio/trade.hpp>
+
+#include <ql/time/date.hpp>
+
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace benchmarks {
+
+//! Parameters of a synthetic portfolio
+/*! The portfolio consists of the given numbers of swaps, fx options, bermudan swaptions and credit default swaps.
+    They are spread over the first \c currencies of EUR, USD, GBP, CHF and JPY and over \c counterparties synthetic
+    counterparties SYN_CPTY_1, SYN_CPTY_2, ..., each with its own uncollateralised netting set. The trade parameters
+    are derived from the trade index only, so that a portfolio of size n is a prefix of every larger portfolio with
+    the same parameters, independent of the order in which the trades are generated.
+*/
+struct PortfolioGeneratorParameters {
+    QuantLib::Size swaps = 0;
+    QuantLib::Size fxOptions = 0;
+    QuantLib::Size bermudanSwaptions = 0;
+    QuantLib::Size creditDefaultSwaps = 0;
+    QuantLib::Size currencies = 5;
+    QuantLib::Size counterparties = 10;
+
+    QuantLib::Size size() const { return swaps + fxOptions + bermudanSwaptions + creditDefaultSwaps; }
+};
+
+//! The name of the k-th synthetic counterparty, k = 0, ..., counterparties - 1
+std::string syntheticCounterparty(QuantLib::Size k);
+
+/*! Build the i-th trade of the synthetic portfolio, i = 0, ..., size() - 1. Dates are relative to the global
+    evaluation date. */
+boost::shared_ptr<ore::data::Trade> generateTrade(const PortfolioGeneratorParameters& parameters, QuantLib::Size i);
+
+/*! Write the synthetic portfolio to the given xml file. The trades are written one by one, so that portfolios with
+    millions of trades do not need to be held in memory. */
+void writePortfolio(const PortfolioGeneratorParameters& parameters, const std::string& fileName);
+
+//! The netting set definitions of the synthetic counterparties
+boost::shared_ptr<ore::data::NettingSetManager> generateNettingSets(const PortfolioGeneratorParameters& parameters);
+
+/*! Write today's market parameters, curve configurations and market data matching the synthetic portfolio. The
+    files are copies of the given input files, e.g. those in Examples/Input, with a flat hazard rate default curve
+    in EUR added for each synthetic counterparty. The input files must provide the yield curves, indices, fx and
+    volatility structures that the portfolio references, the Examples/Input files do. */
+void writeMarketConfiguration(const PortfolioGeneratorParameters& parameters, const QuantLib::Date& asof,
+                              const std::string& todaysMarketFile, const std::string& curveConfigFile,
+                              const std::string& marketFile, const std::string& outputPath);
+
+} // namespace benchmarks
+} // namespace ore
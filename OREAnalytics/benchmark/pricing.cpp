@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/pricing.cpp
+    \brief Benchmarks for trade pricing and simulation market updates
+*/
+
+#include <benchmark/benchmarkdata.hpp>
+
+#include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/make_shared.hpp>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::analytics;
+using namespace ore::benchmarks;
+
+namespace {
+
+// replays a fixed set of scenarios, so that each update of the sim market changes all risk factors
+class ReplayScenarioGenerator : public ScenarioGenerator {
+public:
+    explicit ReplayScenarioGenerator(const std::vector<boost::shared_ptr<Scenario>>& scenarios)
+        : scenarios_(scenarios), i_(0) {}
+    boost::shared_ptr<Scenario> next(const Date&) override { return scenarios_[i_++ % scenarios_.size()]; }
+    void reset() override { i_ = 0; }
+
+private:
+    std::vector<boost::shared_ptr<Scenario>> scenarios_;
+    Size i_;
+};
+
+boost::shared_ptr<ScenarioSimMarket> simMarketWithScenarios(const Size nScenarios) {
+    auto simMarket = boost::make_shared<ScenarioSimMarket>(initMarket(), simMarketParameters());
+    auto base = simMarket->baseScenario();
+    std::vector<boost::shared_ptr<Scenario>> scenarios;
+    for (Size k = 0; k < nScenarios; ++k) {
+        auto s = base->clone();
+        Real factor = 1.0 + 0.001 * static_cast<Real>(k + 1) * (k % 2 == 0 ? 1.0 : -1.0);
+        for (auto const& key : base->keys())
+            s->add(key, base->get(key) * factor);
+        scenarios.push_back(s);
+    }
+    simMarket->scenarioGenerator() = boost::make_shared<ReplayScenarioGenerator>(scenarios);
+    return simMarket;
+}
+
+void priceAll(const Portfolio& portfolio) {
+    for (auto const& [id, trade] : portfolio.trades()) {
+        trade->instrument()->updateQlInstruments();
+        benchmark::DoNotOptimize(trade->instrument()->NPV());
+    }
+}
+
+void BM_SwapPricing(benchmark::State& state) {
+    auto market = initMarket();
+    auto portfolio = swapPortfolio(state.range(0));
+    portfolio->build(boost::make_shared<EngineFactory>(engineData(), market));
+    for (auto _ : state)
+        priceAll(*portfolio);
+    state.SetItemsProcessed(state.iterations() * portfolio->size());
+}
+
+void BM_FxOptionPricing(benchmark::State& state) {
+    auto market = initMarket();
+    auto portfolio = fxOptionPortfolio(state.range(0));
+    portfolio->build(boost::make_shared<EngineFactory>(engineData(), market));
+    for (auto _ : state)
+        priceAll(*portfolio);
+    state.SetItemsProcessed(state.iterations() * portfolio->size());
+}
+
+void BM_SimMarketUpdate(benchmark::State& state) {
+    auto simMarket = simMarketWithScenarios(16);
+    const Date today = benchmarkDate();
+    for (auto _ : state)
+        simMarket->update(today);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["riskFactors"] = static_cast<double>(simMarket->baseScenario()->keys().size());
+}
+
+// one step of a scenario valuation: update the sim market and reprice the portfolio on it
+void BM_SimMarketUpdateAndSwapPricing(benchmark::State& state) {
+    auto simMarket = simMarketWithScenarios(16);
+    auto portfolio = swapPortfolio(state.range(0));
+    portfolio->build(boost::make_shared<EngineFactory>(engineData(), simMarket));
+    const Date today = benchmarkDate();
+    for (auto _ : state) {
+        simMarket->update(today);
+        priceAll(*portfolio);
+    }
+    state.SetItemsProcessed(state.iterations() * portfolio->size());
+}
+
+} // namespace
+
+BENCHMARK(BM_SwapPricing)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FxOptionPricing)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SimMarketUpdate)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SimMarketUpdateAndSwapPricing)->Arg(100)->Unit(benchmark::kMillisecond);
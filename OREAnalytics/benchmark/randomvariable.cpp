@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/randomvariable.cpp
+    \brief Benchmarks for random variable arithmetic and regression
+*/
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <benchmark/benchmark.h>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+namespace {
+
+RandomVariable uniformRandomVariable(const Size n, MersenneTwisterUniformRng& rng) {
+    RandomVariable r(n);
+    for (Size i = 0; i < n; ++i)
+        r.set(i, rng.nextReal());
+    return r;
+}
+
+// a typical payoff expression of a script or amc leg
+void BM_RandomVariableArithmetic(benchmark::State& state) {
+    MersenneTwisterUniformRng rng(42);
+    const Size n = state.range(0);
+    RandomVariable x = uniformRandomVariable(n, rng), y = uniformRandomVariable(n, rng);
+    RandomVariable strike(n, 0.5), zero(n, 0.0);
+    for (auto _ : state) {
+        RandomVariable v = max(x * exp(y - strike) - strike, zero) + x * y;
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// regression of a payoff on two regressors with a monomial basis of order four, the second argument selects
+// the RandomVariableRegressionMethod
+void BM_RandomVariableRegression(benchmark::State& state) {
+    MersenneTwisterUniformRng rng(42);
+    const Size n = state.range(0);
+    const auto method = static_cast<RandomVariableRegressionMethod>(state.range(1));
+    RandomVariable x = uniformRandomVariable(n, rng), y = uniformRandomVariable(n, rng);
+    RandomVariable noise = uniformRandomVariable(n, rng);
+    RandomVariable r = x * x + x * y + noise;
+    std::vector<const RandomVariable*> regressor = {&x, &y};
+    auto monomials = monomialBasis(regressor.size(), 4);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(regressionCoefficients(r, regressor, monomials, Filter(), method));
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+} // namespace
+
+BENCHMARK(BM_RandomVariableArithmetic)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RandomVariableRegression)
+    ->Args({10000, static_cast<int>(RandomVariableRegressionMethod::QR)})
+    ->Args({10000, static_cast<int>(RandomVariableRegressionMethod::NormalEquations)})
+    ->Unit(benchmark::kMicrosecond);
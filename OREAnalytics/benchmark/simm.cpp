@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/simm.cpp
+    \brief Benchmarks for the SIMM aggregation
+*/
+
+#include <orea/simm/crifrecord.hpp>
+#include <orea/simm/simmbucketmapperbase.hpp>
+#include <orea/simm/simmcalculator.hpp>
+#include <orea/simm/utilities.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <boost/make_shared.hpp>
+
+using namespace QuantLib;
+using namespace ore::analytics;
+
+namespace {
+
+/* delta sensitivities of n trades in ten netting sets, each trade has an IR curve delta in every SIMM tenor and an
+   FX delta, the records only depend on n */
+SimmNetSensitivities crif(const Size n, const SimmBucketMapper& bucketMapper) {
+    static const std::vector<std::string> ccys = {"USD", "EUR", "GBP", "JPY", "CHF"};
+    static const std::vector<std::string> tenors = {"2w", "1m", "3m", "6m", "1y", "2y",
+                                                    "3y", "5y", "10y", "15y", "20y", "30y"};
+    SimmNetSensitivities records;
+    for (Size i = 0; i < n; ++i) {
+        const std::string tradeId = "Trade_" + std::to_string(i);
+        const std::string portfolioId = "Portfolio_" + std::to_string(i % 10);
+        const std::string& ccy = ccys[i % ccys.size()];
+        const std::string bucket = bucketMapper.bucket(SimmConfiguration::RiskType::IRCurve, ccy);
+        for (Size t = 0; t < tenors.size(); ++t) {
+            Real amount = 1000.0 * (static_cast<Real>((i * 7 + t * 3) % 17) - 8.0);
+            records.insert(CrifRecord(tradeId, "Swap", portfolioId, SimmConfiguration::ProductClass::RatesFX,
+                                      SimmConfiguration::RiskType::IRCurve, ccy, bucket, tenors[t], "Libor3m", "USD",
+                                      amount, amount, "SIMM", "SEC", "SEC"));
+        }
+        if (ccy != "USD") {
+            Real amount = 10000.0 * (static_cast<Real>(i % 5) - 2.0);
+            records.insert(CrifRecord(tradeId, "Swap", portfolioId, SimmConfiguration::ProductClass::RatesFX,
+                                      SimmConfiguration::RiskType::FX, ccy, "", "", "", "USD", amount, amount, "SIMM",
+                                      "SEC", "SEC"));
+        }
+    }
+    return records;
+}
+
+// the second argument is the number of threads of the calculator
+void BM_SimmCalculation(benchmark::State& state) {
+    auto bucketMapper = boost::make_shared<SimmBucketMapperBase>();
+    auto config = buildSimmConfiguration("2.6", bucketMapper);
+    auto records = crif(state.range(0), *bucketMapper);
+    for (auto _ : state) {
+        SimmCalculator calculator(records, config, "USD", "", nullptr, true, false, true, state.range(1));
+        benchmark::DoNotOptimize(calculator.simmResults());
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_SimmCalculation)->Args({1000, 1})->Args({1000, 4})->Unit(benchmark::kMillisecond);
@@ -28,6 +28,73 @@ namespace ore {
 using namespace data;
 namespace analytics {
 
+namespace {
+
+// Interpolation of the scenario values on the date grid as in estimateUncollatValue(), shared by all scenarios.
+// The value is v1 + (v2 - v1) * weight, where v1, v2 are the values at pos1, pos2, a null position refers to t0.
+struct GridInterpolation {
+    Size pos1, pos2;
+    Real weight;
+
+    Real value(const Real& valueToday, const vector<vector<Real>>& values, Size scenIndex) const {
+        Real v1 = pos1 == Null<Size>() ? valueToday : values[pos1][scenIndex];
+        if (weight == 0.0)
+            return v1;
+        return v1 + (values[pos2][scenIndex] - v1) * weight;
+    }
+};
+
+GridInterpolation gridInterpolation(const Date& simulationDate, const Date& date_t0, const vector<Date>& dateGrid) {
+
+    QL_REQUIRE(simulationDate >= date_t0, "CollatExposureHelper error: simulation date < start date");
+    QL_REQUIRE(dateGrid[0] >= date_t0, "CollatExposureHelper error: cube dateGrid starts before t0");
+
+    if (simulationDate >= dateGrid.back())
+        return {dateGrid.size() - 1, dateGrid.size() - 1, 0.0};
+    if (simulationDate == date_t0)
+        return {Null<Size>(), Null<Size>(), 0.0};
+    for (Size i = 0; i < dateGrid.size(); i++) {
+        if (dateGrid[i] == simulationDate)
+            return {i, i, 0.0};
+#ifdef FLAT_INTERPOLATION
+        else if (simulationDate < dateGrid.front())
+            return {0, 0, 0.0};
+        else if (i < dateGrid.size() - 1 && simulationDate > dateGrid[i] && simulationDate < dateGrid[i + 1])
+            return {i + 1, i + 1, 0.0};
+#endif
+    }
+
+    Date t1, t2;
+    Size pos1, pos2;
+    if (simulationDate <= dateGrid[0]) {
+        t1 = date_t0;
+        t2 = dateGrid[0];
+        pos1 = Null<Size>();
+        pos2 = 0;
+    } else {
+        vector<Date>::const_iterator it = lower_bound(dateGrid.begin(), dateGrid.end(), simulationDate);
+        QL_REQUIRE(it != dateGrid.end(), "CollatExposureHelper error; "
+                                             << "date interpolation points not found (it.end())");
+        QL_REQUIRE(it != dateGrid.begin(), "CollatExposureHelper error; "
+                                               << "date interpolation points not found (it.begin())");
+        pos1 = (it - 1) - dateGrid.begin();
+        pos2 = it - dateGrid.begin();
+        t1 = dateGrid[pos1];
+        t2 = dateGrid[pos2];
+    }
+    return {pos1, pos2, double(simulationDate - t1) / double(t2 - t1)};
+}
+
+// Margin calls issued on one margin date, for the scenarios with a call the amount is non-zero. The pay date depends
+// on the direction of the call, index 0 refers to calls (positive amounts), index 1 to postings (negative amounts).
+struct MarginCalls {
+    Date payDate[2];
+    bool open[2];
+    vector<Real> amount;
+};
+
+} // namespace
+
 CollateralExposureHelper::CalculationType parseCollateralCalculationType(const string& s) {
     static map<string, CollateralExposureHelper::CalculationType> m = {
         {"Symmetric", CollateralExposureHelper::Symmetric},
@@ -248,5 +315,140 @@ boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> CollateralExposu
         QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalancePaths");
     }
 }
+
+vector<vector<Real>> CollateralExposureHelper::collateralBalances(
+    const boost::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+    const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+    const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+    const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType) {
+    try {
+        const boost::shared_ptr<CSA>& csa = csaDef->csaDetails();
+        const Real ia = csa->independentAmountHeld();
+        const Real thresholdRcv = csa->thresholdRcv(), thresholdPay = csa->thresholdPay();
+        const Real mtaRcv = csa->mtaRcv(), mtaPay = csa->mtaPay();
+        const Real spreadRcv = csa->collatSpreadRcv(), spreadPay = csa->collatSpreadPay();
+        const Period mpor = csa->marginPeriodOfRisk();
+        const Period lag = calcType == NoLag ? 0 * Days : mpor;
+
+        // as in creditSupportAmount() and marginRequirementCalc()
+        auto deliveryAmount = [&](const Real uncollatValue, const Real collatBalance, const Real openMargins) {
+            Real csaAmount = uncollatValue - ia >= 0 ? max(uncollatValue - ia - thresholdRcv, 0.0)
+                                                     : min(uncollatValue - ia + thresholdPay, 0.0);
+            Real collatShortfall = csaAmount - collatBalance - openMargins;
+            Real mta = collatShortfall >= 0.0 ? mtaRcv : mtaPay;
+            return fabs(collatShortfall) >= mta ? collatShortfall : 0.0;
+        };
+
+        const Size numScenarios = nettingSetValues.front().size();
+        QL_REQUIRE(numScenarios == csaFxScenarioRates.front().size(), "netting values -v- scenario FX rate mismatch");
+
+        // the state of the accounts, the latest balance and its date
+        vector<Real> balance(numScenarios, deliveryAmount(nettingSetPv, 0.0, 0.0));
+        vector<Date> balanceDate(numScenarios, date_t0);
+        vector<Real> rate(numScenarios), margin(numScenarios);
+        vector<MarginCalls> marginCalls;
+
+        // the balances on the date grid, filled when a balance with a later date is set
+        vector<vector<Real>> result(dateGrid.size(), vector<Real>(numScenarios, 0.0));
+        vector<Size> gridIndex(numScenarios, 0);
+        auto setBalance = [&](const Size k, const Date& d, const Real b) {
+            while (gridIndex[k] < dateGrid.size() && dateGrid[gridIndex[k]] < d)
+                result[gridIndex[k]++][k] = balance[k];
+            balance[k] = b;
+            balanceDate[k] = d;
+        };
+        auto accrued = [&](const Size k, const Date& d) {
+            Real accrualRate = rate[k] - (balance[k] >= 0.0 ? spreadRcv : spreadPay);
+            return balance[k] * std::pow(1.0 + accrualRate / 365.0, d - balanceDate[k]);
+        };
+
+        Date simEndDate = std::min(nettingSet_maturity, dateGrid.back()) + mpor;
+        Date tmpDate = date_t0;
+        Date nextMarginReqDateUs = date_t0;
+        Date nextMarginReqDateCtp = date_t0;
+        while (tmpDate <= simEndDate) {
+            bool eligMarginReqDateUs = tmpDate == nextMarginReqDateUs;
+            bool eligMarginReqDateCtp = tmpDate == nextMarginReqDateCtp;
+            GridInterpolation interpolation = gridInterpolation(tmpDate, date_t0, dateGrid);
+            for (Size k = 0; k < numScenarios; ++k)
+                rate[k] = interpolation.value(csaTodayCollatCurve, csaScenCollatCurves, k);
+
+            // settle the margin calls due, in the order of their pay dates, see CollateralAccount::updateAccountBalance
+            vector<std::pair<Date, std::pair<Size, Size>>> due;
+            for (Size c = 0; c < marginCalls.size(); ++c) {
+                for (Size dir = 0; dir < 2; ++dir) {
+                    if (marginCalls[c].open[dir] && marginCalls[c].payDate[dir] <= tmpDate)
+                        due.push_back(std::make_pair(marginCalls[c].payDate[dir], std::make_pair(c, dir)));
+                }
+            }
+            std::stable_sort(due.begin(), due.end(),
+                             [](const std::pair<Date, std::pair<Size, Size>>& x,
+                                const std::pair<Date, std::pair<Size, Size>>& y) { return x.first < y.first; });
+            for (auto const& [payDate, call] : due) {
+                MarginCalls& m = marginCalls[call.first];
+                for (Size k = 0; k < numScenarios; ++k) {
+                    Real amount = m.amount[k];
+                    if (amount == 0.0 || (amount > 0.0) != (call.second == 0))
+                        continue;
+                    if (payDate == balanceDate[k]) {
+                        balance[k] += amount;
+                    } else {
+                        QL_REQUIRE(payDate > balanceDate[k],
+                                   "CollateralAccount error; balance update failed due to invalid dates");
+                        setBalance(k, payDate, accrued(k, payDate) + amount);
+                    }
+                    // settled, so that the amount does not count as outstanding any more
+                    m.amount[k] = 0.0;
+                }
+                m.open[call.second] = false;
+            }
+            marginCalls.erase(std::remove_if(marginCalls.begin(), marginCalls.end(),
+                                             [](const MarginCalls& m) { return !m.open[0] && !m.open[1]; }),
+                              marginCalls.end());
+
+            // bring the accounts up to the simulation date and compute the margin requirements
+            bool hasMarginCall = false;
+            for (Size k = 0; k < numScenarios; ++k) {
+                if (tmpDate > balanceDate[k])
+                    setBalance(k, tmpDate, accrued(k, tmpDate));
+                Real openMargins = 0.0;
+                for (auto const& m : marginCalls)
+                    openMargins += m.amount[k];
+                Real uncollatVal = interpolation.value(nettingSetPv, nettingSetValues, k) /
+                                   interpolation.value(csaFxTodayRate, csaFxScenarioRates, k);
+                margin[k] = deliveryAmount(uncollatVal, balance[k], openMargins);
+                if ((margin[k] > 0.0 && !eligMarginReqDateUs) || (margin[k] < 0.0 && !eligMarginReqDateCtp))
+                    margin[k] = 0.0;
+                hasMarginCall = hasMarginCall || margin[k] != 0.0;
+            }
+
+            // issue the margin calls, see updateMarginCall()
+            if (hasMarginCall) {
+                MarginCalls m;
+                m.payDate[0] = calcType == AsymmetricDVA ? tmpDate : tmpDate + lag;
+                m.payDate[1] = calcType == AsymmetricCVA ? tmpDate : tmpDate + lag;
+                m.open[0] = m.open[1] = true;
+                m.amount = margin;
+                marginCalls.push_back(std::move(m));
+            }
+
+            if (nextMarginReqDateUs == tmpDate)
+                nextMarginReqDateUs = tmpDate + csa->marginCallFrequency();
+            if (nextMarginReqDateCtp == tmpDate)
+                nextMarginReqDateCtp = tmpDate + csa->marginPostFrequency();
+            tmpDate = std::min(nextMarginReqDateUs, nextMarginReqDateCtp);
+        }
+
+        // set account balance to zero after maturity of portfolio, the remaining grid points are initialised to zero
+        for (Size k = 0; k < numScenarios; ++k)
+            setBalance(k, simEndDate + Period(1, Days), 0.0);
+        return result;
+    } catch (const std::exception& e) {
+        QL_FAIL(e.what());
+    } catch (...) {
+        QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalances");
+    }
+}
+
 } // namespace analytics
 } // namespace ore
@@ -108,6 +108,18 @@ public:
         const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
         const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
         const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric);
+
+    /*!
+      Same as collateralBalancePaths(), but the collateral accounts of all scenarios are evolved together: the margin
+      call schedule, the open margin calls and the interpolation on the date grid are shared by the scenarios, the
+      balances are held in one array per quantity. Returns the account balances by date grid point and scenario,
+      i.e. the values of CollateralAccount::accountBalance() on the dateGrid for the paths of collateralBalancePaths()
+    */
+    static vector<vector<Real>> collateralBalances(
+        const boost::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+        const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+        const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+        const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric);
 };
 
 //! Convert text representation to CollateralExposureHelper::CalculationType
@@ -69,6 +69,7 @@ void CreditMigrationCalculator::build() {
                               baseCurrency_);
 
     hlp.build(portfolio_->trades());
+    hlp.setThreads(nThreads_, threadPool_);
 
     // compute output
 
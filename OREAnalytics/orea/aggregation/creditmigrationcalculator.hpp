@@ -26,6 +26,7 @@
 #include <orea/aggregation/creditsimulationparameters.hpp>
 #include <orea/cube/cubeinterpretation.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <ored/portfolio/portfolio.hpp>
 
 #include <boost/shared_ptr.hpp>
@@ -53,6 +54,13 @@ public:
 
     void build();
 
+    /*! Process the paths of each time step in build() in nThreads jobs, on the given thread pool if set, otherwise in
+        separate threads, see CreditMigrationHelper::setThreads() */
+    void setThreads(const Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = std::max<Size>(nThreads, 1);
+        threadPool_ = threadPool;
+    }
+
     const std::vector<Real> upperBucketBounds() const { return upperBucketBounds_; }
     const std::vector<std::vector<Real>> cdf() const { return cdf_; }
     const std::vector<std::vector<Real>> pdf() const { return pdf_; }
@@ -72,6 +80,9 @@ private:
     std::vector<Real> upperBucketBounds_;
     std::vector<std::vector<Real>> cdf_;
     std::vector<std::vector<Real>> pdf_;
+
+    Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 } // namespace analytics
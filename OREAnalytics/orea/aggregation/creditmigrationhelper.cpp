@@ -75,6 +75,26 @@ Real conditionalProb(const Real p, const Real m, const Real v) {
     return nd((icnP - m) / std::sqrt(1.0 - v));
 }
 
+// threshold for conditionalProb(), mapping p = 0 and p = 1 to -QL_MAX_REAL and QL_MAX_REAL
+Real migrationThreshold(const Real p) {
+    if (close_enough(p, 0.0))
+        return -QL_MAX_REAL;
+    if (close_enough(p, 1.0))
+        return QL_MAX_REAL;
+    return QuantLib::InverseCumulativeNormal()(p);
+}
+
+// same as conditionalProb(), but for a precomputed threshold
+Real conditionalProbFromThreshold(const Real threshold, const Real m, const Real v) {
+    if (threshold == -QL_MAX_REAL)
+        return 0.0;
+    if (threshold == QL_MAX_REAL)
+        return 1.0;
+    if (close_enough(v, 1.0))
+        return threshold >= m ? 1.0 : 0.0;
+    return QuantLib::CumulativeNormalDistribution()((threshold - m) / std::sqrt(1.0 - v));
+}
+
 Real prob_tauA_lt_tauB_lt_T(const Real pa, const Real pb, const Real T) {
     Real l1 = -std::log(1.0 - pa) / T;
     Real l2 = -std::log(1.0 - pb) / T;
@@ -208,14 +228,14 @@ void CreditMigrationHelper::initEntityStateSimulation() {
 
 } // initEntityStatesSimulation
 
-std::vector<Matrix> CreditMigrationHelper::initEntityStateSimulation(const Size date, const Size path) {
+std::vector<Matrix> CreditMigrationHelper::initEntityStateSimulation(const Size date, const Size path,
+                                                                     const std::map<string, Matrix>& transMat) const {
     std::vector<Matrix> res = std::vector<Matrix>(parameters_->entities().size(), Matrix(n_, n_, 0.0));
 
     const std::vector<string>& matrixNames = parameters_->transitionMatrices();
 
     // build terminal matrices conditional on global states
     Size numWarnings = 0;
-    auto transMat = rescaledTransitionMatrices(date);
     for (Size i = 0; i < parameters_->entities().size(); ++i) {
         const Matrix& m = transMat.at(matrixNames[i]);
         for (Size ii = 0; ii < m.rows(); ++ii) {
@@ -254,7 +274,7 @@ std::vector<Matrix> CreditMigrationHelper::initEntityStateSimulation(const Size
 }
 
 void CreditMigrationHelper::simulateEntityStates(const std::vector<Matrix>& cond, const Size path,
-                                                 const MersenneTwisterUniformRng& mt) {
+                                                 const MersenneTwisterUniformRng& mt) const {
 
     QL_REQUIRE(evaluation_ != Evaluation::Analytic,
                "CreditMigrationHelper::simulateEntityStates() unexpected call, not in simulation mode");
@@ -343,8 +363,25 @@ Real CreditMigrationHelper::generateMigrationPnl(const Size date, const Size pat
     return pnl;
 } // generateMigrationPnl
 
+std::vector<std::vector<Real>>
+CreditMigrationHelper::migrationThresholds(const std::map<string, Matrix>& transMat) const {
+    const std::vector<string>& matrixNames = parameters_->transitionMatrices();
+    std::vector<std::vector<Real>> res(parameters_->entities().size(), std::vector<Real>(n_));
+    for (Size i = 0; i < parameters_->entities().size(); ++i) {
+        Size initialState = parameters_->initialStates()[i];
+        const Matrix& m = transMat.at(matrixNames[i]);
+        Real p = 0.0;
+        for (Size j = 0; j < n_; ++j) {
+            p += m[initialState][j];
+            res[i][j] = migrationThreshold(p);
+        }
+    }
+    return res;
+} // migrationThresholds
+
 void CreditMigrationHelper::generateConditionalMigrationPnl(const Size date, const Size path,
                                                             const std::map<string, Matrix>& transMat,
+                                                            const std::vector<std::vector<Real>>& thresholds,
                                                             std::vector<Array>& condProbs,
                                                             std::vector<Array>& pnl) const {
 
@@ -356,11 +393,9 @@ void CreditMigrationHelper::generateConditionalMigrationPnl(const Size date, con
     for (Size i = 0; i < entities.size(); ++i) {
         // compute conditional migration prob
         Size initialState = parameters_->initialStates()[i];
-        Real p = 0.0, condProb0 = 0.0;
-        const Matrix& m = transMat.at(matrixNames[i]);
+        Real condProb0 = 0.0;
         for (Size j = 0; j < n_; ++j) {
-            p += m[initialState][j];
-            Real condProb = conditionalProb(p, globalStates_[date][i][path], globalVar_[i]);
+            Real condProb = conditionalProbFromThreshold(thresholds[i][j], globalStates_[date][i][path], globalVar_[i]);
             condProbs[i][j] = condProb - condProb0;
             condProb0 = condProb;
         }
@@ -467,115 +502,141 @@ Array CreditMigrationHelper::pnlDistribution(const Size date) {
     // 2 compute conditional pnl distributions and average over paths
 
     const std::set<std::string>& tradeIds = cube_->ids();
-    Array res(bucketing_.buckets(), 0.0);
-
     Size numPaths = cube_->samples();
-    Real avgCash = 0.0;
 
-    HullWhiteBucketing hwBucketing(bucketing_.upperBucketBound().begin(), bucketing_.upperBucketBound().end());
-
-    MersenneTwisterUniformRng mt(parameters_->seed());
-
-    for (Size path = 0; path < numPaths; ++path) {
-
-        // 2a market pnl (t0 to horizon date, over whole cube)
-
-        Real cash = 0.0;
-
-        if (parameters_->marketRisk()) {
-            for (Size j = 0; j <= date + 1; ++j) {
-                for (auto const& tradeId : tradeIds) {
-                    Size i = cube_->idsAndIndexes().at(tradeId);
-                    // get cumulative survival probability on the path
-                    Real sp = 1.0;
-                    //Real rr = 0.0;
-                    // FIXME 1
-                    // Methodology question: Do we need/want to multiply with the stochastic discount factor
-                    // here if we do an explicit credit default simulation at horizon?
-                    // FIXME 2
-                    // make CDS PnL neutral bei weighting flows with surv prob and generating protection flow
-                    // with default prob
-                    if (parameters_->zeroMarketPnl() && j > 0 &&
-                        tradeCreditCurves_.find(tradeId) != tradeCreditCurves_.end()) {
-                        string creditCurve = tradeCreditCurves_.at(tradeId);
-                        sp = aggData_->get(j - 1, path, AggregationScenarioDataType::SurvivalWeight, creditCurve);
-                        //rr = aggData_->get(j - 1, path, AggregationScenarioDataType::RecoveryRate, creditCurve);
-                    }
-                    if (j == 0) {
-                        // at t0 we flip the sign of the npvs to get the initial cash balance
-                        cash -= cube_->getT0(i, 0);
-                        // collect intermediate cashflows
-                        if (cubeIndexCashflows_ != Null<Size>())
-                            cash += cube_->getT0(i, cubeIndexCashflows_);
-                    } else if (j <= date) {
-                        // collect intermediate cashflows
-                        if (cubeIndexCashflows_ != Null<Size>())
-                            cash += sp * cube_->get(i, j - 1, path, cubeIndexCashflows_);
-                    } else {
-                        // at the horizon date we realise the npv
-                        cash += sp * cube_->get(i, j - 1, path, 0);
+    // the migration thresholds do not depend on the path, so we compute them once here
+
+    std::vector<std::vector<Real>> thresholds;
+    if (parameters_->creditRisk() && evaluation_ == Evaluation::Analytic)
+        thresholds = migrationThresholds(transMat);
+
+    // each job accumulates the contributions of its paths into its own slot, the slots are added up below
+
+    Size nBlocks = std::min(nThreads_, std::max<Size>(numPaths, 1));
+    std::vector<Array> blockRes(nBlocks, Array(bucketing_.buckets(), 0.0));
+    std::vector<Real> blockAvgCash(nBlocks, 0.0);
+
+    runBlocks(numPaths, nBlocks, threadPool_, [&](const Size begin, const Size end) {
+        // runBlocks() starts block b at numPaths * b / nBlocks
+        Size block = 0;
+        while (block + 1 < nBlocks && numPaths * (block + 1) / nBlocks <= begin)
+            ++block;
+        Array& res = blockRes[block];
+        Real& avgCash = blockAvgCash[block];
+
+        HullWhiteBucketing hwBucketing(bucketing_.upperBucketBound().begin(), bucketing_.upperBucketBound().end());
+
+        MersenneTwisterUniformRng mt(parameters_->seed() + begin);
+
+        for (Size path = begin; path < end; ++path) {
+
+            // 2a market pnl (t0 to horizon date, over whole cube)
+
+            Real cash = 0.0;
+
+            if (parameters_->marketRisk()) {
+                for (Size j = 0; j <= date + 1; ++j) {
+                    for (auto const& tradeId : tradeIds) {
+                        Size i = cube_->idsAndIndexes().at(tradeId);
+                        // get cumulative survival probability on the path
+                        Real sp = 1.0;
+                        //Real rr = 0.0;
+                        // FIXME 1
+                        // Methodology question: Do we need/want to multiply with the stochastic discount factor
+                        // here if we do an explicit credit default simulation at horizon?
+                        // FIXME 2
+                        // make CDS PnL neutral bei weighting flows with surv prob and generating protection flow
+                        // with default prob
+                        if (parameters_->zeroMarketPnl() && j > 0 &&
+                            tradeCreditCurves_.find(tradeId) != tradeCreditCurves_.end()) {
+                            string creditCurve = tradeCreditCurves_.at(tradeId);
+                            sp = aggData_->get(j - 1, path, AggregationScenarioDataType::SurvivalWeight, creditCurve);
+                            //rr = aggData_->get(j - 1, path, AggregationScenarioDataType::RecoveryRate, creditCurve);
+                        }
+                        if (j == 0) {
+                            // at t0 we flip the sign of the npvs to get the initial cash balance
+                            cash -= cube_->getT0(i, 0);
+                            // collect intermediate cashflows
+                            if (cubeIndexCashflows_ != Null<Size>())
+                                cash += cube_->getT0(i, cubeIndexCashflows_);
+                        } else if (j <= date) {
+                            // collect intermediate cashflows
+                            if (cubeIndexCashflows_ != Null<Size>())
+                                cash += sp * cube_->get(i, j - 1, path, cubeIndexCashflows_);
+                        } else {
+                            // at the horizon date we realise the npv
+                            cash += sp * cube_->get(i, j - 1, path, 0);
+                        }
                     }
+                } // for data
+            }     // if market risk
+
+            if (!parameters_->creditRisk()) {
+                // if we just add scalar market pnl realisations, we don't really need
+                // the bucketing algorithm to do that, we just update the result
+                // distribution directly
+                res[hwBucketing.index(cash)] += 1.0 / static_cast<Real>(numPaths);
+                continue;
+            }
+
+            // 2b credit migration pnl (at horizon date, over entities specified in credit simulation parameters)
+
+            std::vector<Array> condProbs, pnl;
+
+            if (evaluation_ != Evaluation::Analytic) {
+                // 2b-1 generate pnl on the path using simulated idiosyncratic factors
+                condProbs.resize(1, Array(parameters_->paths(), 1.0 / static_cast<Real>(parameters_->paths())));
+                // we could build the distribution more efficiently here, but later in 2c we add the market pnl
+                // maybe extend the hw bucketing so that we can feed precomputed distributions and just update
+                // these with additional data?
+                pnl.resize(1, Array(parameters_->paths(), 0.0));
+                auto cond = initEntityStateSimulation(date, path, transMat);
+                for (Size path2 = 0; path2 < parameters_->paths(); ++path2) {
+                    simulateEntityStates(cond, path, mt);
+                    pnl[0][path2] = generateMigrationPnl(date, path, n_);
                 }
-            } // for data
-        }     // if market risk
-
-        if (!parameters_->creditRisk()) {
-            // if we just add scalar market pnl realisations, we don't really need
-            // the bucketing algorithm to do that, we just update the result
-            // distribution directly
-            res[hwBucketing.index(cash)] += 1.0 / static_cast<Real>(numPaths);
-            continue;
-        }
+            } else {
+                // 2b-2 generate pnl distribution without simulation of idiosyncratic factors using the conditional
+                // independence of migration on the path / systemic factors
+
+                // n+1 states, since for CDS we have to subdivide the issuer default into
+                // i) default of issuer and non-default of CDS cpty
+                // ii) default of issuer, default of CDS cpty (but after the issuer default)
+                // iii) default of issuer, default of CDS cpty (before the issuer default)
+                // for non-CDS trades for all sub-states the pnl will be set to the same value
+                // for CDS trades i)+ii) will have the same pnl, but iii) will have a zero pnl
+                // in total, we only have to distinguish i)+ii) and iii), i.e. we need one
+                // additional state
+
+                condProbs.resize(entities.size(), Array(n_ + 1, 0.0));
+                pnl.resize(entities.size(), Array(n_ + 1, 0.0));
+                generateConditionalMigrationPnl(date, path, transMat, thresholds, condProbs, pnl);
+            }
 
-        // 2b credit migration pnl (at horizon date, over entities specified in credit simulation parameters)
-
-        std::vector<Array> condProbs, pnl;
-
-        if (evaluation_ != Evaluation::Analytic) {
-            // 2b-1 generate pnl on the path using simulated idiosyncratic factors
-            condProbs.resize(1, Array(parameters_->paths(), 1.0 / static_cast<Real>(parameters_->paths())));
-            // we could build the distribution more efficiently here, but later in 2c we add the market pnl
-            // maybe extend the hw bucketing so that we can feed precomputed distributions and just update
-            // these with additional data?
-            pnl.resize(1, Array(parameters_->paths(), 0.0));
-            auto cond = initEntityStateSimulation(date, path);
-            for (Size path2 = 0; path2 < parameters_->paths(); ++path2) {
-                simulateEntityStates(cond, path, mt);
-                pnl[0][path2] = generateMigrationPnl(date, path, n_);
+            // 2c aggregate market pnl and credit migration pnl
+
+            if (parameters_->marketRisk()) {
+                condProbs.push_back(Array(1, 1.0));
+                pnl.push_back(Array(1, cash));
             }
-        } else {
-            // 2b-2 generate pnl distribution without simulation of idiosyncratic factors using the conditional
-            // independence of migration on the path / systemic factors
-
-            // n+1 states, since for CDS we have to subdivide the issuer default into
-            // i) default of issuer and non-default of CDS cpty
-            // ii) default of issuer, default of CDS cpty (but after the issuer default)
-            // iii) default of issuer, default of CDS cpty (before the issuer default)
-            // for non-CDS trades for all sub-states the pnl will be set to the same value
-            // for CDS trades i)+ii) will have the same pnl, but iii) will have a zero pnl
-            // in total, we only have to distinguish i)+ii) and iii), i.e. we need one
-            // additional state
-
-            condProbs.resize(entities.size(), Array(n_ + 1, 0.0));
-            pnl.resize(entities.size(), Array(n_ + 1, 0.0));
-            generateConditionalMigrationPnl(date, path, transMat, condProbs, pnl);
-        }
 
-        // 2c aggregate market pnl and credit migration pnl
+            hwBucketing.computeMultiState(condProbs.begin(), condProbs.end(), pnl.begin());
 
-        if (parameters_->marketRisk()) {
-            condProbs.push_back(Array(1, 1.0));
-            pnl.push_back(Array(1, cash));
-        }
+            // 2d add pnl contribution of path to result distribution
+            res += hwBucketing.probability() / static_cast<Real>(numPaths);
+            // average market risk pnl
+            avgCash += cash / static_cast<Real>(numPaths);
 
-        hwBucketing.computeMultiState(condProbs.begin(), condProbs.end(), pnl.begin());
+        } // for path
 
-        // 2d add pnl contribution of path to result distribution
-        res += hwBucketing.probability() / static_cast<Real>(numPaths);
-        // average market risk pnl
-        avgCash += cash / static_cast<Real>(numPaths);
+    });
 
-    } // for path
+    Array res(bucketing_.buckets(), 0.0);
+    Real avgCash = 0.0;
+    for (Size b = 0; b < nBlocks; ++b) {
+        res += blockRes[b];
+        avgCash += blockAvgCash[b];
+    }
 
     DLOG("Expected Market Risk PnL at date " << date << ": " << avgCash);
     return res;
@@ -25,6 +25,7 @@
 
 #include <orea/aggregation/creditsimulationparameters.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 
 #include <ored/portfolio/bond.hpp>
@@ -68,6 +69,15 @@ public:
     //
     Array pnlDistribution(const Size date);
 
+    /*! Process the paths in pnlDistribution() in nThreads jobs, on the given thread pool if set, otherwise in
+        separate threads. In simulation mode each job draws from its own random number generator, seeded with the
+        seed from the parameters plus the index of the first path of the job, so that the results for a single job
+        coincide with the sequential computation. */
+    void setThreads(const Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = std::max<Size>(nThreads, 1);
+        threadPool_ = threadPool;
+    }
+
 private:
     /*! Get the transition matrix from today to date by entity,
       sanitise the annual transition matrix input,
@@ -88,11 +98,13 @@ private:
         Evaluation = TerminalSimulation:
         Return transition matrix for each entity for the given date,
         conditional on the global terminal state on the given path */
-    std::vector<Matrix> initEntityStateSimulation(const Size date, const Size path);
+    std::vector<Matrix> initEntityStateSimulation(const Size date, const Size path,
+                                                  const std::map<string, Matrix>& transMat) const;
 
     /*! Generate one entity state sample path for all entities given the global state path
         and given the conditional transition matrices for all entities at the terminal date. */
-    void simulateEntityStates(const std::vector<Matrix>& cond, const Size path, const MersenneTwisterUniformRng& mt);
+    void simulateEntityStates(const std::vector<Matrix>& cond, const Size path,
+                              const MersenneTwisterUniformRng& mt) const;
 
     //! Look up the simulated entity credit state for the given entity, date and path
     Size simulatedEntityState(const Size i, const Size path) const;
@@ -101,9 +113,15 @@ private:
       netting set counterparties on the given global path */
     Real generateMigrationPnl(const Size date, const Size path, const Size n) const;
 
+    /*! Return the thresholds of the entity states X_i for the migration from the initial state to the states
+      0, ..., n-1 by entity, i.e. the inverse cumulative normal of the cumulative transition probabilities. These
+      do not depend on the path and are computed once per date. */
+    std::vector<std::vector<Real>> migrationThresholds(const std::map<string, Matrix>& transMat) const;
+
     /*! Return a vector of PnL impacts and associated conditional probabilities for the specified global path,
       due to credit migration or default of Bond/CDS issuers and default of netting set counterparties */
     void generateConditionalMigrationPnl(const Size date, const Size path, const std::map<string, Matrix>& transMat,
+                                         const std::vector<std::vector<Real>>& thresholds,
                                          std::vector<Array>& condProbs, std::vector<Array>& pnl) const;
 
     boost::shared_ptr<CreditSimulationParameters> parameters_;
@@ -133,12 +151,15 @@ private:
     std::vector<std::map<string, Matrix>> rescaledTransitionMatrices_;
     // Variance of the systemic part (Y_i) of entity state X_i
     std::vector<Real> globalVar_;
-    // Storage for the simulated idiosyncratic factors Z by entity, sample number
-    std::vector<std::vector<Size>> simulatedEntityState_;
+    // Storage for the simulated idiosyncratic factors Z by entity, sample number, written by the job owning the path
+    mutable std::vector<std::vector<Size>> simulatedEntityState_;
 
     std::vector<std::vector<Matrix>> entityStateSimulationMatrices_;
     // Systemic part (Y_i) of entity state X_i by date index, entity index, sample number
     std::vector<std::vector<std::vector<Real>>> globalStates_;
+
+    Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 CreditMigrationHelper::CreditMode parseCreditMode(const std::string& s);
@@ -22,32 +22,62 @@
 */
 
 #include <orea/aggregation/cvaspreadsensitivitycalculator.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <boost/make_shared.hpp>
 
 namespace ore {
 namespace analytics {
 
-CVASpreadSensitivityCalculator::CVASpreadSensitivityCalculator(const string& key, const Date& asof,
-                                                               const vector<Real>& epe, const vector<Date>& dates,
-                                                               const Handle<DefaultProbabilityTermStructure>& dts,
-                                                               const Real& recovery,
-                                                               const Handle<YieldTermStructure>& yts,
-                                                               const vector<Period>& shiftTenors, Real shiftSize)
-    : key_(key), asof_(asof), epe_(epe), dates_(dates), dts_(dts), recovery_(recovery), yts_(yts),
-      shiftTenors_(shiftTenors), shiftSize_(shiftSize) {
+CVASpreadSensitivityWeights::CVASpreadSensitivityWeights(const string& key, const Date& asof,
+                                                         const vector<Date>& dates,
+                                                         const Handle<DefaultProbabilityTermStructure>& dts,
+                                                         const Real& recovery, const Handle<YieldTermStructure>& yts,
+                                                         const vector<Period>& shiftTenors, Real shiftSize)
+    : key_(key), asof_(asof), dates_(dates), dts_(dts), recovery_(recovery), yts_(yts), shiftTenors_(shiftTenors),
+      shiftSize_(shiftSize) {
     shiftTimes_ = vector<Real>(shiftTenors.size(), 0.0);
-    hazardRateSensitivities_ = vector<Real>(shiftTenors.size(), 0.0);
-    cdsSpreadSensitivities_ = vector<Real>(shiftTenors.size(), 0.0);
     for (Size i = 0; i < shiftTenors_.size(); ++i)
         shiftTimes_[i] = dts_->timeFromReference(asof_ + shiftTenors_[i]);
 
-    Real cvaBase = cva();
-    Array input(shiftTenors_.size(), 0.0);
-    for (Size i = 0; i < shiftTenors_.size(); ++i) {
-        Real cvaShifted = cva(true, i);
-        hazardRateSensitivities_[i] = cvaShifted - cvaBase;
-        input[i] = hazardRateSensitivities_[i];
+    // survival probabilities on the date grid, the shifted ones only differ by a deterministic factor
+
+    vector<Time> times(dates_.size() + 1);
+    times[0] = dts_->timeFromReference(asof_);
+    for (Size j = 0; j < dates_.size(); ++j)
+        times[j + 1] = dts_->timeFromReference(dates_[j]);
+    survivalProbabilities_.resize(times.size());
+    for (Size j = 0; j < times.size(); ++j)
+        survivalProbabilities_[j] = dts_->survivalProbability(times[j]);
+
+    weights_ = Matrix(shiftTimes_.size(), dates_.size(), 0.0);
+    for (Size i = 0; i < shiftTimes_.size(); ++i) {
+        Real f0 = shiftFactor(times[0], i);
+        for (Size j = 0; j < dates_.size(); ++j) {
+            Real f1 = shiftFactor(times[j + 1], i);
+            Real s0 = survivalProbabilities_[j], s1 = survivalProbabilities_[j + 1];
+            weights_[i][j] = (1.0 - recovery_) * ((s0 * f0 - s1 * f1) - (s0 - s1));
+            f0 = f1;
+        }
+    }
+
+    // survival probabilities and discount factors on the CDS premium grid, up to the longest shift term
+
+    Real dt = 0.5;
+    Size nMax = 0;
+    for (Size i = 0; i < shiftTimes_.size(); ++i) {
+        Real T = shiftTimes_[i];
+        Size n = Size(floor(T / dt + 0.5));
+        QL_REQUIRE(fabs(T - dt * n) < 0.1 * dt, "shift term is not a multiple of 6M");
+        nMax = std::max(nMax, n);
+    }
+    cdsSurvivalProbabilities_.resize(nMax + 1);
+    cdsDiscounts_.resize(nMax + 1, 1.0);
+    for (Size i = 0; i <= nMax; ++i) {
+        cdsSurvivalProbabilities_[i] = dts_->survivalProbability(dt * i);
+        if (i > 0)
+            cdsDiscounts_[i] = yts_->discount(dt * i);
     }
-    DLOG("CVA Calculator key=" << key_ << " cvaBase=" << cvaBase);
 
     jacobi_ = Matrix(shiftTenors_.size(), shiftTenors_.size(), 0.0);
     for (Size i = 0; i < shiftTenors_.size(); ++i) {
@@ -62,70 +92,94 @@ CVASpreadSensitivityCalculator::CVASpreadSensitivityCalculator(const string& key
         }
         DLOG("CVA Calculator key=" << key_ << " jacobi column[" << i << "]=" << row);
     }
-
-    Array output = inverse(jacobi_) * input;
-    for (Size i = 0; i < shiftTenors_.size(); ++i)
-        cdsSpreadSensitivities_[i] = output[i];
+    inverseJacobi_ = inverse(jacobi_);
 }
 
-Real CVASpreadSensitivityCalculator::survivalProbability(Time t, bool shift, Size index) {
-    if (shift == false)
-        return dts_->survivalProbability(t);
-
+Real CVASpreadSensitivityWeights::shiftFactor(Time t, Size index) const {
     QL_REQUIRE(index < shiftTimes_.size(), "index " << index << " out of range");
     Real t2 = shiftTimes_[index];
     Real t1 = index == 0 ? 0.0 : shiftTimes_[index - 1];
     bool lastBucket = index == shiftTimes_.size() - 1 ? true : false;
     if (t < t1)
-        return dts_->survivalProbability(t);
+        return 1.0;
     else if (t < t2) {
-        return dts_->survivalProbability(t) * exp(-shiftSize_ * (t - t1));
+        return exp(-shiftSize_ * (t - t1));
     } else { // t >= t2
         if (!lastBucket)
-            return dts_->survivalProbability(t) * exp(-shiftSize_ * (t2 - t1));
+            return exp(-shiftSize_ * (t2 - t1));
         else
-            return dts_->survivalProbability(t) * exp(-shiftSize_ * (t - t1));
+            return exp(-shiftSize_ * (t - t1));
     }
 }
 
-Real CVASpreadSensitivityCalculator::survivalProbability(Date d, bool shift, Size index) {
-    Real t = dts_->timeFromReference(d);
-    return survivalProbability(t, shift, index);
-}
-
-Real CVASpreadSensitivityCalculator::cva(bool shift, Size index) {
-    Real sum = 0.0;
-    for (Size j = 0; j < dates_.size(); ++j) {
-        Date d0 = j == 0 ? asof_ : dates_[j - 1];
-        Date d1 = dates_[j];
-        Real s0 = survivalProbability(d0, shift, index);
-        Real s1 = survivalProbability(d1, shift, index);
-        Real increment = (1.0 - recovery_) * (s0 - s1) * epe_[j + 1];
-        sum += increment;
-    }
-    DLOG("CVA Calculator key=" << key_ << " shift=" << shift << " index=" << index << " cva=" << sum);
-    return sum;
-}
-
-Real CVASpreadSensitivityCalculator::fairCdsSpread(Size term, bool shift, Size index) {
+Real CVASpreadSensitivityWeights::fairCdsSpread(Size term, bool shift, Size index) const {
     // not following the CDS2015 date rule, but a CDS with 6m periods, paying at period ends, no rebate
     QL_REQUIRE(term < shiftTimes_.size(), "term " << term << " out of range");
     Real T = shiftTimes_[term];
     Real dt = 0.5;
     Size n = Size(floor(T / dt + 0.5));
-    QL_REQUIRE(fabs(T - dt * n) < 0.1 * dt, "shift term is not a multiple of 6M");
     Real enumerator = 0.0, denominator = 0.0;
     for (Size i = 1; i <= n; ++i) {
         Real t0 = dt * (i - 1);
         Real t1 = dt * i;
-        Real s0 = survivalProbability(t0, shift, index);
-        Real s1 = survivalProbability(t1, shift, index);
-        Real dis = yts_->discount(t1);
+        Real s0 = cdsSurvivalProbabilities_[i - 1] * (shift ? shiftFactor(t0, index) : 1.0);
+        Real s1 = cdsSurvivalProbabilities_[i] * (shift ? shiftFactor(t1, index) : 1.0);
+        Real dis = cdsDiscounts_[i];
         enumerator += (s0 - s1) * dis;
         denominator += dt * s1 * dis;
     }
     return (1.0 - recovery_) * enumerator / denominator;
 }
 
+Real CVASpreadSensitivityWeights::cva(const vector<Real>& epe) const {
+    QL_REQUIRE(epe.size() == dates_.size() + 1,
+               "CVASpreadSensitivityWeights: epe size " << epe.size() << " does not match dates " << dates_.size());
+    Real sum = 0.0;
+    for (Size j = 0; j < dates_.size(); ++j)
+        sum += (1.0 - recovery_) * (survivalProbabilities_[j] - survivalProbabilities_[j + 1]) * epe[j + 1];
+    return sum;
+}
+
+vector<Real> CVASpreadSensitivityWeights::hazardRateSensitivities(const vector<Real>& epe) const {
+    QL_REQUIRE(epe.size() == dates_.size() + 1,
+               "CVASpreadSensitivityWeights: epe size " << epe.size() << " does not match dates " << dates_.size());
+    vector<Real> res(shiftTimes_.size(), 0.0);
+    for (Size i = 0; i < shiftTimes_.size(); ++i) {
+        for (Size j = 0; j < dates_.size(); ++j)
+            res[i] += weights_[i][j] * epe[j + 1];
+    }
+    return res;
+}
+
+vector<Real> CVASpreadSensitivityWeights::cdsSpreadSensitivities(const vector<Real>& hazardRateSensitivities) const {
+    Array input(hazardRateSensitivities.begin(), hazardRateSensitivities.end());
+    Array output = inverseJacobi_ * input;
+    return vector<Real>(output.begin(), output.end());
+}
+
+CVASpreadSensitivityCalculator::CVASpreadSensitivityCalculator(const string& key, const Date& asof,
+                                                               const vector<Real>& epe, const vector<Date>& dates,
+                                                               const Handle<DefaultProbabilityTermStructure>& dts,
+                                                               const Real& recovery,
+                                                               const Handle<YieldTermStructure>& yts,
+                                                               const vector<Period>& shiftTenors, Real shiftSize)
+    : key_(key), epe_(epe), weights_(boost::make_shared<CVASpreadSensitivityWeights>(
+                                key, asof, dates, dts, recovery, yts, shiftTenors, shiftSize)) {
+    calculate();
+}
+
+CVASpreadSensitivityCalculator::CVASpreadSensitivityCalculator(
+    const string& key, const vector<Real>& epe, const boost::shared_ptr<const CVASpreadSensitivityWeights>& weights)
+    : key_(key), epe_(epe), weights_(weights) {
+    QL_REQUIRE(weights_, "CVASpreadSensitivityCalculator: no weights given");
+    calculate();
+}
+
+void CVASpreadSensitivityCalculator::calculate() {
+    hazardRateSensitivities_ = weights_->hazardRateSensitivities(epe_);
+    cdsSpreadSensitivities_ = weights_->cdsSpreadSensitivities(hazardRateSensitivities_);
+    DLOG("CVA Calculator key=" << key_ << " cvaBase=" << weights_->cva(epe_));
+}
+
 } // namespace analytics
 } // namespace ore
@@ -43,6 +43,87 @@ using namespace QuantExt;
 using namespace data;
 using namespace std;
 
+//! CVA Spread Sensitivity Weights
+/*!
+  Hazard rate and CDS spread sensitivity weights for a given default curve on a given date grid.
+
+  The CVA is linear in the exposure profile, so that the hazard rate sensitivity for each bucket is a weighted sum
+  of the exposures on the date grid. The weights only depend on the survival probabilities with and without
+  shifted hazard rates, which are computed once here, and can be shared by all netting sets with the same
+  counterparty. The same holds for the Jacobian of the fair CDS spreads w.r.t. the bucketed hazard rates.
+*/
+class CVASpreadSensitivityWeights {
+public:
+    CVASpreadSensitivityWeights(//! For logging purposes
+                                const std::string& key,
+                                //! Asof date
+                                const Date& asof,
+                                //! Date grid
+                                const vector<Date>& dates,
+                                //! Default term structure
+                                const Handle<DefaultProbabilityTermStructure>& dts,
+                                //! Market recovery rate
+                                const Real& recovery,
+                                //! CDS Discount curve
+                                const Handle<YieldTermStructure>& yts,
+                                //! Shift grid
+                                const vector<Period>& shiftTenors,
+                                //! Shift size
+                                Real shiftSize = 0.0001);
+
+    //! Inspectors
+    // @{
+    const string& key() const { return key_; }
+    const Date& asof() const { return asof_; }
+    const vector<Date>& dates() const { return dates_; }
+    const Handle<DefaultProbabilityTermStructure>& defaultTermStructure() const { return dts_; }
+    Real recoveryRate() const { return recovery_; }
+    const Handle<YieldTermStructure>& discountCurve() const { return yts_; }
+    const vector<Period>& shiftTenors() const { return shiftTenors_; }
+    Real shiftSize() const { return shiftSize_; }
+    // @}
+
+    //! Results
+    // @{
+    const vector<Real>& shiftTimes() const { return shiftTimes_; }
+    //! Weights by shift bucket and date, the hazard rate sensitivity of bucket i is sum_j weights[i][j] * epe[j + 1]
+    const Matrix& weights() const { return weights_; }
+    const Matrix& jacobi() const { return jacobi_; }
+    const Matrix& inverseJacobi() const { return inverseJacobi_; }
+    // @}
+
+    //! CVA for the given EPE profile, including the value at the asof date
+    Real cva(const vector<Real>& epe) const;
+    //! Hazard rate sensitivities for the given EPE profile, including the value at the asof date
+    vector<Real> hazardRateSensitivities(const vector<Real>& epe) const;
+    //! CDS spread sensitivities for the given hazard rate sensitivities
+    vector<Real> cdsSpreadSensitivities(const vector<Real>& hazardRateSensitivities) const;
+
+private:
+    // factor applied to the survival probability at time t when shifting the hazard rate in the specified bucket
+    Real shiftFactor(Time t, Size index) const;
+    //! Fair CDS Spread calculation with and without shifted hazard rates
+    Real fairCdsSpread(Size term, bool shift = false, Size index = 0) const;
+
+    string key_;
+    Date asof_;
+    vector<Date> dates_;
+    Handle<DefaultProbabilityTermStructure> dts_;
+    Real recovery_;
+    Handle<YieldTermStructure> yts_;
+    vector<Period> shiftTenors_;
+    Real shiftSize_;
+
+    vector<Real> shiftTimes_;
+    // survival probabilities on the date grid, starting with the asof date
+    vector<Real> survivalProbabilities_;
+    // survival probabilities and discount factors on the semi annual CDS premium grid, starting with t = 0
+    vector<Real> cdsSurvivalProbabilities_, cdsDiscounts_;
+    Matrix weights_;
+    Matrix jacobi_;
+    Matrix inverseJacobi_;
+};
+
 //! CVA Spread Sensitivity Calculator
 /*!
   Compute hazard rate and CDS spread sensitivities for a given exposure profile 
@@ -68,51 +149,41 @@ public:
 				   const vector<Period>& shiftTenors,
 				   //! Shift size
 				   Real shiftSize = 0.0001);  
+
+    //! Constructor using precomputed weights, e.g. shared by the netting sets of one counterparty
+    CVASpreadSensitivityCalculator(const std::string& key, const vector<Real>& epe,
+                                   const boost::shared_ptr<const CVASpreadSensitivityWeights>& weights);
   
     //! Inspectors
     // @{
     const string key() { return key_; }
-    Date asof() { return asof_; }
+    Date asof() { return weights_->asof(); }
     const vector<Real>& exposureProfile() { return epe_; }
-    const vector<Date>& exposureDateGrid() { return dates_; }
-    const Handle<DefaultProbabilityTermStructure>& defaultTermStructure() { return dts_; }
-    Real recoveryRate() { return recovery_; }
-    const Handle<YieldTermStructure>& discountCurve() { return yts_; }
-    const vector<Period> shiftTenors() { return shiftTenors_; }
+    const vector<Date>& exposureDateGrid() { return weights_->dates(); }
+    const Handle<DefaultProbabilityTermStructure>& defaultTermStructure() { return weights_->defaultTermStructure(); }
+    Real recoveryRate() { return weights_->recoveryRate(); }
+    const Handle<YieldTermStructure>& discountCurve() { return weights_->discountCurve(); }
+    const vector<Period> shiftTenors() { return weights_->shiftTenors(); }
     // @}
   
     //! Results
     // @{
-    const vector<Real> shiftTimes() { return shiftTimes_; }
-    Real shiftSize() { return shiftSize_; }
+    const vector<Real> shiftTimes() { return weights_->shiftTimes(); }
+    Real shiftSize() { return weights_->shiftSize(); }
     const vector<Real> hazardRateSensitivities() { return hazardRateSensitivities_; }
     const vector<Real> cdsSpreadSensitivities() { return cdsSpreadSensitivities_; }
-    const Matrix& jacobi() { return jacobi_; }
+    const Matrix& jacobi() { return weights_->jacobi(); }
     // @}
 
 private:
-    // survival probability with shifted hazard rates in the specified bucket 
-    Real survivalProbability(Date d, bool shift, Size index);
-    Real survivalProbability(Time t, bool shift, Size index);
-    // CVA calculation with and without shifted hazard rates
-    Real cva(bool shift = false, Size index = 0);
-    //! Fair CDS Spread calculation with and without shifted hazard rates
-    Real fairCdsSpread(Size term, bool shift = false, Size index = 0);
-		     
+    void calculate();
+
     string key_;
-    Date asof_;
     vector<Real> epe_;
-    vector<Date> dates_;
-    Handle<DefaultProbabilityTermStructure> dts_;
-    Real recovery_;
-    Handle<YieldTermStructure> yts_;
-    vector<Period> shiftTenors_;
+    boost::shared_ptr<const CVASpreadSensitivityWeights> weights_;
 
-    vector<Real> shiftTimes_;
-    Real shiftSize_;
     vector<Real> hazardRateSensitivities_;
     vector<Real> cdsSpreadSensitivities_;  
-    Matrix jacobi_;
 };
 
 } // namespace analytics
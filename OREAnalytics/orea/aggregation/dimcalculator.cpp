@@ -86,15 +86,16 @@ DynamicInitialMarginCalculator::DynamicInitialMarginCalculator(
             nettingSetDIM_[nettingSetId] = vector<vector<Real>>(dates, vector<Real>(samples, 0.0));
             nettingSetExpectedDIM_[nettingSetId] = vector<Real>(dates, 0.0);
         }
+        vector<Real> defaultNpvs, closeOutNpvs, mporFlows(samples, 0.0);
         for (Size j = 0; j < datesLoopSize_; ++j) {
+            cubeInterpretation_->getDefaultNpvs(cube_, i, j, defaultNpvs);
+            cubeInterpretation_->getCloseOutNpvs(cube_, i, j, closeOutNpvs);
+            if (cubeInterpretation_->storeFlows())
+                cubeInterpretation_->getMporFlows(cube_, i, j, mporFlows);
             for (Size k = 0; k < samples; ++k) {
-                Real defaultNpv = cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
-                Real closeOutNpv = cubeInterpretation_->getCloseOutNpv(cube_, i, j, k);
-                Real mporFlow =
-                    cubeInterpretation_->storeFlows() ? cubeInterpretation_->getMporFlows(cube_, i, j, k) : 0.0;
-                nettingSetNPV_[nettingSetId][j][k] += defaultNpv;
-                nettingSetCloseOutNPV_[nettingSetId][j][k] += closeOutNpv;
-                nettingSetFLOW_[nettingSetId][j][k] += mporFlow;
+                nettingSetNPV_[nettingSetId][j][k] += defaultNpvs[k];
+                nettingSetCloseOutNPV_[nettingSetId][j][k] += closeOutNpvs[k];
+                nettingSetFLOW_[nettingSetId][j][k] += mporFlows[k];
             }
         }
     }
@@ -17,6 +17,7 @@
 */
 
 #include <orea/aggregation/dimregressioncalculator.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ql/errors.hpp>
@@ -36,6 +37,10 @@
 #include <boost/accumulators/statistics/error_of_mean.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
 
 using namespace std;
 using namespace QuantLib;
@@ -51,15 +56,15 @@ RegressionDynamicInitialMarginCalculator::RegressionDynamicInitialMarginCalculat
     const boost::shared_ptr<CubeInterpretation>& cubeInterpretation,
     const boost::shared_ptr<AggregationScenarioData>& scenarioData, Real quantile, Size horizonCalendarDays,
     Size regressionOrder, std::vector<std::string> regressors, Size localRegressionEvaluations,
-    Real localRegressionBandWidth, const std::map<std::string, Real>& currentIM)
+    Real localRegressionBandWidth, const std::map<std::string, Real>& currentIM, Size localRegressionBins)
 : DynamicInitialMarginCalculator(inputs, portfolio, cube, cubeInterpretation, scenarioData, quantile, horizonCalendarDays,
                                  currentIM),
       regressionOrder_(regressionOrder), regressors_(regressors),
-      localRegressionEvaluations_(localRegressionEvaluations), localRegressionBandWidth_(localRegressionBandWidth) {
+      localRegressionEvaluations_(localRegressionEvaluations), localRegressionBandWidth_(localRegressionBandWidth),
+      localRegressionBins_(localRegressionBins) {
     Size dates = cube_->dates().size();
     Size samples = cube_->samples();
     for (const auto& nettingSetId : nettingSetIds_) {
-        regressorArray_[nettingSetId] = vector<vector<Array>>(dates, vector<Array>(samples));
         nettingSetLocalDIM_[nettingSetId] = vector<vector<Real>>(dates, vector<Real>(samples, 0.0));
         nettingSetZeroOrderDIM_[nettingSetId] = vector<Real>(dates, 0.0);
         nettingSetSimpleDIMh_[nettingSetId] = vector<Real>(dates, 0.0);
@@ -122,6 +127,36 @@ void RegressionDynamicInitialMarginCalculator::build() {
     Size simple_dim_index_h = Size(floor(quantile_ * (samples - 1) + 0.5));
     Size simple_dim_index_p = Size(floor((1.0 - quantile_) * (samples - 1) + 0.5));
 
+    Size nThreads = inputs_ ? inputs_->nThreads() : 1;
+    boost::shared_ptr<ThreadPool> threadPool = inputs_ ? inputs_->threadPool() : nullptr;
+    LOG("DIM regression uses " << nThreads << " threads");
+
+    // The scenario data regressors do not depend on the netting set, we compile them once for all netting sets and
+    // only fill in the NPV regressor (if any) per netting set below
+    vector<Size> npvRegressors;
+    for (Size i = 0; i < regressors_.size(); ++i) {
+        // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
+        if (boost::to_upper_copy(regressors_[i]) == "NPV")
+            npvRegressors.push_back(i);
+    }
+    boost::shared_ptr<vector<vector<Array>>> scenarioRegressors;
+    if (!regressors_.empty()) {
+        scenarioRegressors = boost::make_shared<vector<vector<Array>>>(
+            cube_->dates().size(), vector<Array>(samples, Array(regressors_.size(), 0.0)));
+        for (Size i = 0; i < regressors_.size(); ++i) {
+            if (std::find(npvRegressors.begin(), npvRegressors.end(), i) != npvRegressors.end())
+                continue;
+            AggregationScenarioDataType type = regressorType(regressors_[i]);
+            for (Size j = 0; j < stopDatesLoop; ++j)
+                for (Size k = 0; k < samples; ++k)
+                    (*scenarioRegressors)[j][k][i] =
+                        cubeInterpretation_->getDefaultAggregationScenarioData(type, j, k, regressors_[i]);
+        }
+    }
+
+    // Gaussian kernel support used in the binned local regression, in multiples of the band width
+    const Real localRegressionKernelSupport = 6.0;
+
     Size nettingSetCount = 0;
     for (auto n : nettingSetIds_) {
         LOG("Process netting set " << n);
@@ -176,149 +211,182 @@ void RegressionDynamicInitialMarginCalculator::build() {
             nettingSetScaling_.find(n) == nettingSetScaling_.end() ? 1.0 : nettingSetScaling_[n];
         LOG("Netting set DIM scaling factor: " << nettingSetDimScaling);
 
-        for (Size j = 0; j < stopDatesLoop; ++j) {
-            accumulator_set<double, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance>> accDiff;
-            accumulator_set<double, stats<boost::accumulators::tag::mean>> accOneOverNumeraire;
-            for (Size k = 0; k < samples; ++k) {
-                Real numDefault =
-                    cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real numCloseOut =
-                    cubeInterpretation_->getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real npvDefault = nettingSetNPV_[n][j][k];
-                Real flow = nettingSetFLOW_[n][j][k];
-                Real npvCloseOut = nettingSetCloseOutNPV_[n][j][k];
-                accDiff((npvCloseOut * numCloseOut) + (flow * numDefault) - (npvDefault * numDefault));
-                accOneOverNumeraire(1.0 / numDefault);
-            }
+        // Results and inputs of the netting set, each date is processed by one job
+        const vector<vector<Real>>& npv = nettingSetNPV_.at(n);
+        const vector<vector<Real>>& flows = nettingSetFLOW_.at(n);
+        const vector<vector<Real>>& closeOutNpv = nettingSetCloseOutNPV_.at(n);
+        vector<vector<Real>>& deltaNpv = nettingSetDeltaNPV_.at(n);
+        vector<vector<Real>>& dimResult = nettingSetDIM_.at(n);
+        vector<vector<Real>>& localDim = nettingSetLocalDIM_.at(n);
+        vector<Real>& expectedDim = nettingSetExpectedDIM_.at(n);
+        vector<Real>& zeroOrderDim = nettingSetZeroOrderDIM_.at(n);
+        vector<Real>& simpleDimH = nettingSetSimpleDIMh_.at(n);
+        vector<Real>& simpleDimP = nettingSetSimpleDIMp_.at(n);
+
+        // The regressor matrix is shared with the other netting sets unless it contains the netting set NPV
+        boost::shared_ptr<vector<vector<Array>>> regressors;
+        if (regressors_.empty()) {
+            regressors = boost::make_shared<vector<vector<Array>>>(cube_->dates().size(), vector<Array>(samples));
+            for (Size j = 0; j < stopDatesLoop; ++j)
+                for (Size k = 0; k < samples; ++k)
+                    (*regressors)[j][k] = Array(1, npv[j][k]);
+        } else if (npvRegressors.empty()) {
+            regressors = scenarioRegressors;
+        } else {
+            regressors = boost::make_shared<vector<vector<Array>>>(*scenarioRegressors);
+            for (Size j = 0; j < stopDatesLoop; ++j)
+                for (Size k = 0; k < samples; ++k)
+                    for (Size i : npvRegressors)
+                        (*regressors)[j][k][i] = npv[j][k];
+        }
+        regressorArray_[n] = regressors;
 
-            Size mporCalendarDays = cubeInterpretation_->getMporCalendarDays(cube_, j);
-            Real horizonScaling = sqrt(1.0 * horizonCalendarDays_ / mporCalendarDays);
-
-            Real stdevDiff = sqrt(variance(accDiff));
-            Real E_OneOverNumeraire =
-                mean(accOneOverNumeraire); // "re-discount" (the stdev is calculated on non-discounted deltaNPVs)
-
-            nettingSetZeroOrderDIM_[n][j] = stdevDiff * horizonScaling * confidenceLevel;
-            nettingSetZeroOrderDIM_[n][j] *= E_OneOverNumeraire;
-
-            vector<Real> rx0(samples, 0.0);
-            vector<Array> rx(samples, Array());
-            vector<Real> ry1(samples, 0.0);
-            vector<Real> ry2(samples, 0.0);
-            for (Size k = 0; k < samples; ++k) {
-                Real numDefault =
-                    cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real numCloseOut =
-                    cubeInterpretation_->getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real x = nettingSetNPV_[n][j][k] * numDefault;
-                Real f = nettingSetFLOW_[n][j][k] * numDefault;
-                Real y = nettingSetCloseOutNPV_[n][j][k] * numCloseOut;
-                Real z = (y + f - x);
-                rx[k] = regressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
-                rx0[k] = rx[k][0];
-                ry1[k] = z;     // for local regression
-                ry2[k] = z * z; // for least squares regression
-                nettingSetDeltaNPV_[n][j][k] = z;
-                regressorArray_[n][j][k] = rx[k];
-            }
-            vector<Real> delNpvVec_copy = nettingSetDeltaNPV_[n][j];
-            sort(delNpvVec_copy.begin(), delNpvVec_copy.end());
-            Real simpleDim_h = delNpvVec_copy[simple_dim_index_h];
-            Real simpleDim_p = delNpvVec_copy[simple_dim_index_p];
-            simpleDim_h *= horizonScaling;                                  // the usual scaling factors
-            simpleDim_p *= horizonScaling;                                  // the usual scaling factors
-            nettingSetSimpleDIMh_[n][j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
-            nettingSetSimpleDIMp_[n][j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
-
-            QL_REQUIRE(rx.size() > v.size(), "not enough points for regression with polynom order " << polynomOrder);
-            if (close_enough(stdevDiff, 0.0)) {
-                LOG("DIM: Zero std dev estimation at step " << j);
-                // Skip IM calculation if all samples have zero NPV (e.g. after latest maturity)
+        runBlocks(stopDatesLoop, nThreads, threadPool, [&](const Size begin, const Size end) {
+            for (Size j = begin; j < end; ++j) {
+                accumulator_set<double, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance>>
+                    accDiff;
+                accumulator_set<double, stats<boost::accumulators::tag::mean>> accOneOverNumeraire;
                 for (Size k = 0; k < samples; ++k) {
-                    nettingSetDIM_[n][j][k] = 0.0;
-                    nettingSetLocalDIM_[n][j][k] = 0.0;
+                    Real numDefault = cubeInterpretation_->getDefaultAggregationScenarioData(
+                        AggregationScenarioDataType::Numeraire, j, k);
+                    Real numCloseOut = cubeInterpretation_->getCloseOutAggregationScenarioData(
+                        AggregationScenarioDataType::Numeraire, j, k);
+                    Real npvDefault = npv[j][k];
+                    Real flow = flows[j][k];
+                    Real npvCloseOut = closeOutNpv[j][k];
+                    accDiff((npvCloseOut * numCloseOut) + (flow * numDefault) - (npvDefault * numDefault));
+                    accOneOverNumeraire(1.0 / numDefault);
                 }
-            } else {
-                // Least squares polynomial regression with specified polynom order
-                QuantExt::StabilisedGLLS ls(rx, ry2, v, QuantExt::StabilisedGLLS::MeanStdDev);
-                LOG("DIM data normalisation at time step "
-                    << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift() << " x-multiplier = "
-                    << ls.xMultiplier() << " y-shift = " << ls.yShift() << " y-multiplier = " << ls.yMultiplier());
-                LOG("DIM regression coefficients at time step " << j << ": " << fixed << setprecision(6)
-                                                                << ls.transformedCoefficients());
-
-                // Local regression versus first regression variable (i.e. we do not perform a
-                // multidimensional local regression):
-                // We evaluate this at a limited number of samples only for validation purposes.
-                // Note that computational effort scales quadratically with number of samples.
-                // NadarayaWatson needs a large number of samples for good results.
-                QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
-                                            GaussianKernel(0.0, localRegressionBandWidth_));
-                Size localRegressionSamples = samples;
-                if (localRegressionEvaluations_ > 0)
-                    localRegressionSamples = Size(floor(1.0 * samples / localRegressionEvaluations_ + .5));
-
-                // Evaluate regression function to compute DIM for each scenario
+
+                Size mporCalendarDays = cubeInterpretation_->getMporCalendarDays(cube_, j);
+                Real horizonScaling = sqrt(1.0 * horizonCalendarDays_ / mporCalendarDays);
+
+                Real stdevDiff = sqrt(variance(accDiff));
+                Real E_OneOverNumeraire =
+                    mean(accOneOverNumeraire); // "re-discount" (the stdev is calculated on non-discounted deltaNPVs)
+
+                zeroOrderDim[j] = stdevDiff * horizonScaling * confidenceLevel;
+                zeroOrderDim[j] *= E_OneOverNumeraire;
+
+                const vector<Array>& rx = (*regressors)[j];
+                vector<Real> rx0(samples, 0.0);
+                vector<Real> ry1(samples, 0.0);
+                vector<Real> ry2(samples, 0.0);
                 for (Size k = 0; k < samples; ++k) {
-                    // Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
                     Real numDefault = cubeInterpretation_->getDefaultAggregationScenarioData(
                         AggregationScenarioDataType::Numeraire, j, k);
-                    Array regressor = regressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
-                    Real e = ls.eval(regressor, v);
-                    if (e < 0.0)
-                        LOG("Negative variance regression for date " << j << ", sample " << k
-                                                                     << ", regressor = " << regressor);
-
-                    // Note:
-                    // 1) We assume vanishing mean of "z", because the drift over a MPOR is usually small,
-                    //    and to avoid a second regression for the conditional mean
-                    // 2) In particular the linear regression function can yield negative variance values in
-                    //    extreme scenarios where an exact analytical or delta VaR calculation would yield a
-                    //    variance approaching zero. We correct this here by taking the positive part.
-                    Real std = sqrt(std::max(e, 0.0));
-                    Real scalingFactor = horizonScaling * confidenceLevel * nettingSetDimScaling;
-                    // Real dim = std * scalingFactor / num1;
-                    Real dim = std * scalingFactor / numDefault;
-                    dimCube_->set(dim, nettingSetCount, j, k);
-                    nettingSetDIM_[n][j][k] = dim;
-                    nettingSetExpectedDIM_[n][j] += dim / samples;
-
-                    // Evaluate the Kernel regression for a subset of the samples only (performance)
-                    if (localRegressionEvaluations_ > 0 && (k % localRegressionSamples == 0))
-                        // nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / num1;
-                        nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / numDefault;
-                    else
-                        nettingSetLocalDIM_[n][j][k] = 0.0;
+                    Real numCloseOut = cubeInterpretation_->getCloseOutAggregationScenarioData(
+                        AggregationScenarioDataType::Numeraire, j, k);
+                    Real x = npv[j][k] * numDefault;
+                    Real f = flows[j][k] * numDefault;
+                    Real y = closeOutNpv[j][k] * numCloseOut;
+                    Real z = (y + f - x);
+                    rx0[k] = rx[k][0];
+                    ry1[k] = z;     // for local regression
+                    ry2[k] = z * z; // for least squares regression
+                    deltaNpv[j][k] = z;
+                }
+                vector<Real> delNpvVec_copy = deltaNpv[j];
+                sort(delNpvVec_copy.begin(), delNpvVec_copy.end());
+                Real simpleDim_h = delNpvVec_copy[simple_dim_index_h];
+                Real simpleDim_p = delNpvVec_copy[simple_dim_index_p];
+                simpleDim_h *= horizonScaling;                    // the usual scaling factors
+                simpleDim_p *= horizonScaling;                    // the usual scaling factors
+                simpleDimH[j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
+                simpleDimP[j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
+
+                QL_REQUIRE(rx.size() > v.size(),
+                           "not enough points for regression with polynom order " << polynomOrder);
+                if (close_enough(stdevDiff, 0.0)) {
+                    LOG("DIM: Zero std dev estimation at step " << j);
+                    // Skip IM calculation if all samples have zero NPV (e.g. after latest maturity)
+                    for (Size k = 0; k < samples; ++k) {
+                        dimResult[j][k] = 0.0;
+                        localDim[j][k] = 0.0;
+                    }
+                } else {
+                    // Least squares polynomial regression with specified polynom order
+                    QuantExt::StabilisedGLLS ls(rx, ry2, v, QuantExt::StabilisedGLLS::MeanStdDev);
+                    LOG("DIM data normalisation at time step "
+                        << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift()
+                        << " x-multiplier = " << ls.xMultiplier() << " y-shift = " << ls.yShift()
+                        << " y-multiplier = " << ls.yMultiplier());
+                    LOG("DIM regression coefficients at time step " << j << ": " << fixed << setprecision(6)
+                                                                    << ls.transformedCoefficients());
+
+                    // Local regression versus first regression variable (i.e. we do not perform a
+                    // multidimensional local regression):
+                    // We evaluate this at a limited number of samples only for validation purposes.
+                    // NadarayaWatson needs a large number of samples for good results. The computational effort of the
+                    // exact estimator scales quadratically with number of samples, by default we use the binned
+                    // approximation, which scales linearly.
+                    GaussianKernel kernel(0.0, localRegressionBandWidth_);
+                    boost::optional<QuantExt::NadarayaWatson> exactLr;
+                    boost::optional<QuantExt::BinnedNadarayaWatson> binnedLr;
+                    if (localRegressionEvaluations_ > 0) {
+                        if (localRegressionBins_ == 0)
+                            exactLr.emplace(rx0.begin(), rx0.end(), ry1.begin(), kernel);
+                        else
+                            binnedLr.emplace(rx0.begin(), rx0.end(), ry1.begin(), kernel,
+                                             localRegressionKernelSupport * localRegressionBandWidth_,
+                                             localRegressionBins_);
+                    }
+                    Size localRegressionSamples = samples;
+                    if (localRegressionEvaluations_ > 0)
+                        localRegressionSamples = Size(floor(1.0 * samples / localRegressionEvaluations_ + .5));
+
+                    // Evaluate regression function to compute DIM for each scenario
+                    for (Size k = 0; k < samples; ++k) {
+                        // Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
+                        Real numDefault = cubeInterpretation_->getDefaultAggregationScenarioData(
+                            AggregationScenarioDataType::Numeraire, j, k);
+                        const Array& regressor = rx[k];
+                        Real e = ls.eval(regressor, v);
+                        if (e < 0.0)
+                            LOG("Negative variance regression for date " << j << ", sample " << k
+                                                                         << ", regressor = " << regressor);
+
+                        // Note:
+                        // 1) We assume vanishing mean of "z", because the drift over a MPOR is usually small,
+                        //    and to avoid a second regression for the conditional mean
+                        // 2) In particular the linear regression function can yield negative variance values in
+                        //    extreme scenarios where an exact analytical or delta VaR calculation would yield a
+                        //    variance approaching zero. We correct this here by taking the positive part.
+                        Real std = sqrt(std::max(e, 0.0));
+                        Real scalingFactor = horizonScaling * confidenceLevel * nettingSetDimScaling;
+                        // Real dim = std * scalingFactor / num1;
+                        Real dim = std * scalingFactor / numDefault;
+                        dimCube_->set(dim, nettingSetCount, j, k);
+                        dimResult[j][k] = dim;
+                        expectedDim[j] += dim / samples;
+
+                        // Evaluate the Kernel regression for a subset of the samples only (performance)
+                        if (localRegressionEvaluations_ > 0 && (k % localRegressionSamples == 0))
+                            // nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / num1;
+                            localDim[j][k] = (exactLr ? exactLr->standardDeviation(regressor[0])
+                                                      : binnedLr->standardDeviation(regressor[0])) *
+                                             scalingFactor / numDefault;
+                        else
+                            localDim[j][k] = 0.0;
+                    }
                 }
             }
-        }
+        });
 
         nettingSetCount++;
     }
     LOG("DIM by polynomial regression done");
 }
 
-Array RegressionDynamicInitialMarginCalculator::regressorArray(string nettingSet, Size dateIndex,
-                                                                           Size sampleIndex) {
-    Array a(regressors_.size());
-    for (Size i = 0; i < regressors_.size(); ++i) {
-        string variable = regressors_[i];
-        if (boost::to_upper_copy(variable) ==
-            "NPV") // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
-            a[i] = nettingSetNPV_[nettingSet][dateIndex][sampleIndex];
-        else if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
-            a[i] = cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::IndexFixing,
-                                                                      dateIndex, sampleIndex, variable);
-        else if (scenarioData_->has(AggregationScenarioDataType::FXSpot, variable))
-            a[i] = cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::FXSpot, dateIndex,
-                                                                      sampleIndex, variable);
-        else if (scenarioData_->has(AggregationScenarioDataType::Generic, variable))
-            a[i] = cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Generic, dateIndex,
-                                                                      sampleIndex, variable);
-        else
-            QL_FAIL("scenario data does not provide data for " << variable);
-    }
-    return a;
+AggregationScenarioDataType RegressionDynamicInitialMarginCalculator::regressorType(const string& variable) const {
+    if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
+        return AggregationScenarioDataType::IndexFixing;
+    else if (scenarioData_->has(AggregationScenarioDataType::FXSpot, variable))
+        return AggregationScenarioDataType::FXSpot;
+    else if (scenarioData_->has(AggregationScenarioDataType::Generic, variable))
+        return AggregationScenarioDataType::Generic;
+    else
+        QL_FAIL("scenario data does not provide data for " << variable);
 }
 
 map<string, Real> RegressionDynamicInitialMarginCalculator::unscaledCurrentDIM() {
@@ -473,8 +541,12 @@ void RegressionDynamicInitialMarginCalculator::exportDimRegression(
             numeraires[k] =
                 cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, timeStep, k);
 
-        auto p = sort_permutation(regressorArray_[nettingSet][timeStep], lessThan);
-        vector<Array> reg = apply_permutation(regressorArray_[nettingSet][timeStep], p);
+        auto r = regressorArray_.find(nettingSet);
+        QL_REQUIRE(r != regressorArray_.end() && r->second,
+                   "DIM regressors not available for netting set " << nettingSet);
+        const vector<Array>& regressors = (*r->second)[timeStep];
+        auto p = sort_permutation(regressors, lessThan);
+        vector<Array> reg = apply_permutation(regressors, p);
         vector<Real> dim = apply_permutation(nettingSetDIM_[nettingSet][timeStep], p);
         vector<Real> ldim = apply_permutation(nettingSetLocalDIM_[nettingSet][timeStep], p);
         vector<Real> delta = apply_permutation(nettingSetDeltaNPV_[nettingSet][timeStep], p);
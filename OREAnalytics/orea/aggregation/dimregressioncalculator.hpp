@@ -63,7 +63,9 @@ public:
         //! Local regression band width in standard deviations of the regression variable
         Real localRegressionBandWidth = 0,
 	//! Actual t0 IM by netting set used to scale the DIM evolution, no scaling if the argument is omitted
-	const std::map<std::string, Real>& currentIM = std::map<std::string, Real>());
+	const std::map<std::string, Real>& currentIM = std::map<std::string, Real>(),
+        //! Number of bins of the binned local regression, 0 means exact Nadaraya-Watson regression
+        Size localRegressionBins = 401);
 
     map<string, Real> unscaledCurrentDIM() override;
     void build() override;
@@ -78,16 +80,18 @@ public:
     const vector<Real>& simpleResultsLower(const string& nettingSet);
 
 private:
-    //! Compile the array of DIM regressors for the specified netting set, date and sample index
-    Array regressorArray(string nettingSet, Size dateIndex, Size sampleIndex);
+    //! Scenario data type providing the specified (non-NPV) regressor
+    AggregationScenarioDataType regressorType(const string& variable) const;
 
     Size regressionOrder_;
     vector<string> regressors_;
     Size localRegressionEvaluations_;
     Real localRegressionBandWidth_;
+    Size localRegressionBins_;
 
-    // For each netting set: Array of regressor values by date and sample
-    map<string, vector<vector<Array>>> regressorArray_;
+    // For each netting set: Array of regressor values by date and sample, shared between netting sets if the
+    // regressors do not include the netting set NPV
+    map<string, boost::shared_ptr<vector<vector<Array>>>> regressorArray_;
     // For each netting set: local regression DIM estimate by date and sample
     map<string, vector<vector<Real>>> nettingSetLocalDIM_;
     // For each netting set: vector of values by date, aggregated over trades and samples
@@ -0,0 +1,355 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/aggregation/dimsimmcalculator.hpp>
+#include <orea/engine/threadpool.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/methods/montecarlo/lsmbasissystem.hpp>
+#include <ql/version.hpp>
+
+#include <qle/math/stabilisedglls.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace QuantLib;
+
+namespace ore {
+namespace analytics {
+
+using RiskType = SimmConfiguration::RiskType;
+using RiskClass = SimmConfiguration::RiskClass;
+
+SimmDynamicInitialMarginCalculator::RiskFactor parseDimSimmRiskFactor(const std::string& s) {
+    vector<string> tokens;
+    boost::split(tokens, s, boost::is_any_of(":"));
+    QL_REQUIRE(tokens.size() >= 3 && tokens.size() <= 5,
+               "parseDimSimmRiskFactor: expected name:riskType:qualifier[:label1[:label2]], got '" << s << "'");
+    SimmDynamicInitialMarginCalculator::RiskFactor f;
+    f.name = boost::trim_copy(tokens[0]);
+    f.riskType = parseSimmRiskType(boost::trim_copy(tokens[1]));
+    f.qualifier = boost::trim_copy(tokens[2]);
+    f.label1 = tokens.size() > 3 ? boost::trim_copy(tokens[3]) : "";
+    f.label2 = tokens.size() > 4 ? boost::trim_copy(tokens[4]) : "";
+    return f;
+}
+
+SimmDynamicInitialMarginCalculator::SimmDynamicInitialMarginCalculator(
+    const boost::shared_ptr<InputParameters>& inputs, const boost::shared_ptr<Portfolio>& portfolio,
+    const boost::shared_ptr<NPVCube>& cube, const boost::shared_ptr<CubeInterpretation>& cubeInterpretation,
+    const boost::shared_ptr<AggregationScenarioData>& scenarioData,
+    const boost::shared_ptr<SimmConfiguration>& simmConfiguration, const std::string& calculationCurrency,
+    const vector<RiskFactor>& riskFactors, Size regressionOrder, const std::map<std::string, Real>& currentIM)
+    : DynamicInitialMarginCalculator(inputs, portfolio, cube, cubeInterpretation, scenarioData, 0.99, 10, currentIM),
+      simmConfiguration_(simmConfiguration), calculationCurrency_(calculationCurrency), riskFactors_(riskFactors),
+      regressionOrder_(regressionOrder) {
+
+    QL_REQUIRE(simmConfiguration_, "SimmDynamicInitialMarginCalculator: SIMM configuration is null");
+    QL_REQUIRE(!riskFactors_.empty(), "SimmDynamicInitialMarginCalculator: no risk factors given");
+    QL_REQUIRE(regressionOrder_ >= 1, "SimmDynamicInitialMarginCalculator: regression order must be at least 1");
+
+    // The scenario data type of each risk factor and the buckets of the risk classes, the risk weights and
+    // correlations do not depend on the date and sample and are set up once
+
+    map<RiskClass, map<string, vector<Size>>> buckets;
+    for (Size i = 0; i < riskFactors_.size(); ++i) {
+        const RiskFactor& f = riskFactors_[i];
+        if (f.riskType == RiskType::IRCurve) {
+            QL_REQUIRE(!f.label1.empty(), "SimmDynamicInitialMarginCalculator: risk factor "
+                                              << f.name << " of risk type " << f.riskType << " requires a tenor label");
+            QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, f.name),
+                       "SimmDynamicInitialMarginCalculator: scenario data does not provide index fixings for "
+                           << f.name);
+            factorTypes_.push_back(AggregationScenarioDataType::IndexFixing);
+            buckets[RiskClass::InterestRate][f.qualifier].push_back(i);
+        } else if (f.riskType == RiskType::FX) {
+            QL_REQUIRE(f.qualifier != calculationCurrency_, "SimmDynamicInitialMarginCalculator: Risk_FX qualifier "
+                                                                << f.qualifier
+                                                                << " equals the calculation currency");
+            QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::FXSpot, f.name),
+                       "SimmDynamicInitialMarginCalculator: scenario data does not provide FX spots for " << f.name);
+            factorTypes_.push_back(AggregationScenarioDataType::FXSpot);
+            // FX is treated as a single bucket
+            buckets[RiskClass::FX][""].push_back(i);
+        } else {
+            QL_FAIL("SimmDynamicInitialMarginCalculator: risk type " << f.riskType << " of risk factor " << f.name
+                                                                     << " not supported, expected "
+                                                                     << RiskType::IRCurve << " or " << RiskType::FX);
+        }
+    }
+
+    for (const auto& [riskClass, classBuckets] : buckets) {
+        RiskClassBuckets rcb;
+        rcb.riskClass = riskClass;
+        vector<string> qualifiers;
+        for (const auto& [qualifier, factors] : classBuckets) {
+            Bucket b;
+            b.factors = factors;
+            b.correlation = Matrix(factors.size(), factors.size(), 1.0);
+            for (Size k = 0; k < factors.size(); ++k) {
+                const RiskFactor& fk = riskFactors_[factors[k]];
+                b.riskWeights.push_back(
+                    simmConfiguration_->weight(fk.riskType, fk.qualifier, fk.label1, calculationCurrency_));
+                for (Size l = 0; l < k; ++l) {
+                    const RiskFactor& fl = riskFactors_[factors[l]];
+                    Real rho;
+                    if (fk.riskType == RiskType::IRCurve) {
+                        // sub curve times tenor correlation, as in the SimmCalculator
+                        rho = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", fk.label2,
+                                                              RiskType::IRCurve, qualifier, "", fl.label2) *
+                              simmConfiguration_->correlation(RiskType::IRCurve, qualifier, fk.label1, "",
+                                                              RiskType::IRCurve, qualifier, fl.label1, "");
+                    } else {
+                        rho = simmConfiguration_->correlation(fk.riskType, fk.qualifier, fk.label1, fk.label2,
+                                                              fl.riskType, fl.qualifier, fl.label1, fl.label2,
+                                                              calculationCurrency_);
+                    }
+                    b.correlation[k][l] = b.correlation[l][k] = rho;
+                }
+            }
+            rcb.buckets.push_back(b);
+            qualifiers.push_back(qualifier);
+        }
+        rcb.correlation = Matrix(qualifiers.size(), qualifiers.size(), 1.0);
+        for (Size b = 0; b < qualifiers.size(); ++b) {
+            for (Size c = 0; c < b; ++c) {
+                rcb.correlation[b][c] = rcb.correlation[c][b] = simmConfiguration_->correlation(
+                    RiskType::IRCurve, qualifiers[b], "", "", RiskType::IRCurve, qualifiers[c], "", "");
+            }
+        }
+        riskClasses_.push_back(rcb);
+    }
+
+    riskClassCorrelation_ = Matrix(riskClasses_.size(), riskClasses_.size(), 1.0);
+    for (Size r = 0; r < riskClasses_.size(); ++r)
+        for (Size s = 0; s < r; ++s)
+            riskClassCorrelation_[r][s] = riskClassCorrelation_[s][r] =
+                simmConfiguration_->correlationRiskClasses(riskClasses_[r].riskClass, riskClasses_[s].riskClass);
+
+    Size dates = cube_->dates().size();
+    Size samples = cube_->samples();
+    for (const auto& nettingSetId : nettingSetIds_)
+        nettingSetSensitivities_[nettingSetId] =
+            vector<vector<vector<Real>>>(riskFactors_.size(), vector<vector<Real>>(dates, vector<Real>(samples, 0.0)));
+}
+
+const vector<vector<vector<Real>>>& SimmDynamicInitialMarginCalculator::sensitivities(const string& nettingSet) {
+    auto s = nettingSetSensitivities_.find(nettingSet);
+    QL_REQUIRE(s != nettingSetSensitivities_.end(), "netting set " << nettingSet << " not found in DIM sensitivities");
+    return s->second;
+}
+
+void SimmDynamicInitialMarginCalculator::regressionSensitivities(const string& nettingSet, Size j,
+                                                                 vector<vector<Real>>& sensis) const {
+    Size samples = cube_->samples();
+    const vector<vector<Real>>& npv = nettingSetNPV_.at(nettingSet);
+
+    // netting set values in the cube currency at the simulation date
+    vector<Real> y(samples);
+    for (Size k = 0; k < samples; ++k)
+        y[k] = npv[j][k] *
+               cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
+
+    // the risk factor values, risk factors which do not vary over the samples of this date can not be regressed on
+    // and get zero sensitivities
+    vector<vector<Real>> x(riskFactors_.size(), vector<Real>(samples));
+    vector<Size> active;
+    for (Size i = 0; i < riskFactors_.size(); ++i) {
+        for (Size k = 0; k < samples; ++k)
+            x[i][k] = cubeInterpretation_->getDefaultAggregationScenarioData(factorTypes_[i], j, k,
+                                                                             riskFactors_[i].name);
+        auto [minX, maxX] = std::minmax_element(x[i].begin(), x[i].end());
+        if (!close_enough(*minX, *maxX))
+            active.push_back(i);
+        std::fill(sensis[i].begin(), sensis[i].end(), 0.0);
+    }
+    auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+    if (active.empty() || close_enough(*minY, *maxY))
+        return;
+
+#if QL_HEX_VERSION > 0x01150000
+    std::vector<ext::function<Real(Array)>> v(
+        LsmBasisSystem::multiPathBasisSystem(active.size(), regressionOrder_, LsmBasisSystem::Monomial));
+#else // QL 1.14 and below
+    std::vector<boost::function1<Real, Array>> v(
+        LsmBasisSystem::multiPathBasisSystem(active.size(), regressionOrder_, LsmBasisSystem::Monomial));
+#endif
+    QL_REQUIRE(samples > v.size(), "not enough samples for regression with polynom order "
+                                       << regressionOrder_ << " on " << active.size() << " risk factors");
+    vector<Array> rx(samples, Array(active.size()));
+    for (Size k = 0; k < samples; ++k)
+        for (Size a = 0; a < active.size(); ++a)
+            rx[k][a] = x[active[a]][k];
+    QuantExt::StabilisedGLLS ls(rx, y, v, QuantExt::StabilisedGLLS::MeanStdDev);
+
+    // central differences of the regression function under the SIMM shifts
+    for (Size k = 0; k < samples; ++k) {
+        Array point = rx[k];
+        for (Size a = 0; a < active.size(); ++a) {
+            Size i = active[a];
+            Real h = riskFactors_[i].riskType == RiskType::FX ? 0.01 * rx[k][a] : 0.0001;
+            point[a] = rx[k][a] + h;
+            Real up = ls.eval(point, v);
+            point[a] = rx[k][a] - h;
+            Real down = ls.eval(point, v);
+            point[a] = rx[k][a];
+            sensis[i][k] = 0.5 * (up - down);
+        }
+    }
+}
+
+void SimmDynamicInitialMarginCalculator::simmMargin(const vector<vector<Real>>& sensis, vector<Real>& margin) const {
+    Size samples = margin.size();
+    vector<vector<Real>> riskClassMargin(riskClasses_.size(), vector<Real>(samples, 0.0));
+    for (Size r = 0; r < riskClasses_.size(); ++r) {
+        const RiskClassBuckets& rcb = riskClasses_[r];
+        Size nb = rcb.buckets.size();
+        // bucket margins K_b and the sums of weighted sensitivities S_b by bucket and sample
+        vector<vector<Real>> k2(nb, vector<Real>(samples, 0.0)), sumWs(nb, vector<Real>(samples, 0.0));
+        for (Size b = 0; b < nb; ++b) {
+            const Bucket& bucket = rcb.buckets[b];
+            Size n = bucket.factors.size();
+            for (Size f = 0; f < n; ++f) {
+                const vector<Real>& sf = sensis[bucket.factors[f]];
+                Real wf = bucket.riskWeights[f];
+                for (Size k = 0; k < samples; ++k) {
+                    Real w = wf * sf[k];
+                    sumWs[b][k] += w;
+                    k2[b][k] += w * w;
+                }
+                for (Size g = 0; g < f; ++g) {
+                    const vector<Real>& sg = sensis[bucket.factors[g]];
+                    Real c = 2.0 * bucket.correlation[f][g] * wf * bucket.riskWeights[g];
+                    for (Size k = 0; k < samples; ++k)
+                        k2[b][k] += c * sf[k] * sg[k];
+                }
+            }
+        }
+        // aggregation across buckets
+        vector<Real>& m = riskClassMargin[r];
+        for (Size b = 0; b < nb; ++b) {
+            for (Size k = 0; k < samples; ++k) {
+                Real kbk = std::sqrt(std::max(k2[b][k], 0.0));
+                m[k] += kbk * kbk;
+                k2[b][k] = kbk;
+                sumWs[b][k] = std::max(std::min(sumWs[b][k], kbk), -kbk);
+            }
+            for (Size c = 0; c < b; ++c) {
+                Real gamma = 2.0 * rcb.correlation[b][c];
+                for (Size k = 0; k < samples; ++k)
+                    m[k] += gamma * sumWs[b][k] * sumWs[c][k];
+            }
+        }
+        for (Size k = 0; k < samples; ++k)
+            m[k] = std::sqrt(std::max(m[k], 0.0));
+    }
+    // aggregation across risk classes
+    std::fill(margin.begin(), margin.end(), 0.0);
+    for (Size r = 0; r < riskClasses_.size(); ++r) {
+        for (Size k = 0; k < samples; ++k)
+            margin[k] += riskClassMargin[r][k] * riskClassMargin[r][k];
+        for (Size s = 0; s < r; ++s) {
+            Real psi = 2.0 * riskClassCorrelation_[r][s];
+            for (Size k = 0; k < samples; ++k)
+                margin[k] += psi * riskClassMargin[r][k] * riskClassMargin[s][k];
+        }
+    }
+    for (Size k = 0; k < samples; ++k)
+        margin[k] = std::sqrt(std::max(margin[k], 0.0));
+}
+
+map<string, Real> SimmDynamicInitialMarginCalculator::unscaledCurrentDIM() {
+    map<string, Real> result;
+    Size samples = cube_->samples();
+    vector<vector<Real>> sensis(riskFactors_.size(), vector<Real>(samples, 0.0));
+    vector<Real> margin(samples, 0.0);
+    for (const auto& n : nettingSetIds_) {
+        regressionSensitivities(n, 0, sensis);
+        simmMargin(sensis, margin);
+        Real dim = 0.0;
+        for (Size k = 0; k < samples; ++k)
+            dim += margin[k] /
+                   cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, 0, k);
+        result[n] = dim / samples;
+        LOG("T0 IM (SIMM) - {" << n << "} = " << result[n]);
+    }
+    return result;
+}
+
+void SimmDynamicInitialMarginCalculator::build() {
+    LOG("DIM Analysis by SIMM aggregation of regression sensitivities, SIMM version "
+        << simmConfiguration_->version() << ", " << riskFactors_.size() << " risk factors, polynom order "
+        << regressionOrder_);
+
+    Size samples = cube_->samples();
+    Size nThreads = inputs_ ? inputs_->nThreads() : 1;
+    boost::shared_ptr<ThreadPool> threadPool = inputs_ ? inputs_->threadPool() : nullptr;
+
+    map<string, Real> currentDim;
+    if (!currentIM_.empty())
+        currentDim = unscaledCurrentDIM();
+
+    Size nettingSetCount = 0;
+    for (const auto& n : nettingSetIds_) {
+        LOG("Process netting set " << n);
+
+        if (currentIM_.find(n) != currentIM_.end()) {
+            Real t0dim = currentDim.at(n);
+            nettingSetScaling_[n] = close_enough(t0dim, 0.0) ? 1.0 : currentIM_[n] / t0dim;
+            LOG("t0 scaling for netting set " << n << ": t0im=" << currentIM_[n] << " t0dim=" << t0dim
+                                              << " t0scaling=" << nettingSetScaling_[n]);
+        }
+        Real scaling = nettingSetScaling_.find(n) == nettingSetScaling_.end() ? 1.0 : nettingSetScaling_[n];
+
+        vector<vector<vector<Real>>>& sensitivities = nettingSetSensitivities_.at(n);
+        vector<vector<Real>>& dimResult = nettingSetDIM_.at(n);
+        vector<Real>& expectedDim = nettingSetExpectedDIM_.at(n);
+
+        runBlocks(datesLoopSize_, nThreads, threadPool, [&](const Size begin, const Size end) {
+            vector<vector<Real>> sensis(riskFactors_.size(), vector<Real>(samples, 0.0));
+            vector<Real> margin(samples, 0.0);
+            for (Size j = begin; j < end; ++j) {
+                regressionSensitivities(n, j, sensis);
+                simmMargin(sensis, margin);
+                expectedDim[j] = 0.0;
+                for (Size k = 0; k < samples; ++k) {
+                    for (Size i = 0; i < riskFactors_.size(); ++i)
+                        sensitivities[i][j][k] = sensis[i][k];
+                    Real numDefault = cubeInterpretation_->getDefaultAggregationScenarioData(
+                        AggregationScenarioDataType::Numeraire, j, k);
+                    Real dim = margin[k] * scaling / numDefault;
+                    dimCube_->set(dim, nettingSetCount, j, k);
+                    dimResult[j][k] = dim;
+                    expectedDim[j] += dim / samples;
+                }
+            }
+        });
+
+        nettingSetCount++;
+    }
+    LOG("DIM by SIMM aggregation done");
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/aggregation/dimsimmcalculator.hpp
+    \brief Dynamic Initial Margin calculator by SIMM aggregation of path-wise regression sensitivities
+    \ingroup analytics
+*/
+
+#pragma once
+
+#include <orea/aggregation/dimcalculator.hpp>
+#include <orea/simm/simmconfiguration.hpp>
+
+#include <ql/math/matrix.hpp>
+
+namespace ore {
+namespace analytics {
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace data;
+using namespace std;
+
+//! Dynamic Initial Margin Calculator using the SIMM delta margin formulas on path-wise sensitivities
+/*!
+  At each simulation date the netting set value is regressed on the simulated risk factors (index fixings and FX spots
+  from the aggregation scenario data) by a polynomial of the given order. The derivative of the regression function
+  along each path provides a proxy for the SIMM delta sensitivity to each risk factor, computed as the central
+  difference of the regression function under the SIMM shift of the risk factor (1bp absolute for Risk_IRCurve, 1%
+  relative for Risk_FX). Each risk factor is mapped to a SIMM risk type, qualifier and labels, the weighted
+  sensitivities are then aggregated by the SIMM delta margin formulas within buckets, across buckets and across risk
+  classes for all samples of a date at once.
+
+  The calculation covers the delta margin of the Risk_IRCurve and Risk_FX risk types in a single product class.
+  Concentration thresholds are not applied, i.e. the concentration risk factors are 1, and vega and curvature margins
+  are not part of the result. The sensitivities are expressed in the currency of the NPV cube, which should be the
+  SIMM calculation currency. The quantile and horizon of the result are the ones the SIMM risk weights are calibrated
+  to.
+*/
+class SimmDynamicInitialMarginCalculator : public DynamicInitialMarginCalculator {
+public:
+    //! A simulated risk factor and its SIMM classification
+    struct RiskFactor {
+        //! Name of the risk factor in the aggregation scenario data, i.e. an index name or a currency
+        std::string name;
+        //! SIMM risk type, Risk_IRCurve or Risk_FX
+        SimmConfiguration::RiskType riskType;
+        //! SIMM qualifier, i.e. the currency of the curve respectively the FX currency
+        std::string qualifier;
+        //! SIMM labels, the tenor and sub curve for Risk_IRCurve, empty for Risk_FX
+        std::string label1, label2;
+    };
+
+    SimmDynamicInitialMarginCalculator(
+        //! Global input parameters
+        const boost::shared_ptr<InputParameters>& inputs,
+        //! Driving portfolio consistent with the cube below
+        const boost::shared_ptr<Portfolio>& portfolio,
+        //! NPV cube resulting from the Monte Carlo simulation loop
+        const boost::shared_ptr<NPVCube>& cube,
+        //! Interpretation of the cube, regular NPV, MPoR grid etc
+        const boost::shared_ptr<CubeInterpretation>& cubeInterpretation,
+        //! Additional output of the MC simulation loop with numeraires, index fixings, FX spots etc
+        const boost::shared_ptr<AggregationScenarioData>& scenarioData,
+        //! SIMM configuration providing risk weights and correlations
+        const boost::shared_ptr<SimmConfiguration>& simmConfiguration,
+        //! SIMM calculation currency, the currency of the NPV cube
+        const std::string& calculationCurrency,
+        //! Simulated risk factors the netting set values are regressed on
+        const vector<RiskFactor>& riskFactors,
+        //! Polynom order of the regression, at least 1, order 1 gives the same sensitivities on all paths of a date
+        Size regressionOrder = 2,
+        //! Actual t0 IM by netting set used to scale the DIM evolution, no scaling if the argument is omitted
+        const std::map<std::string, Real>& currentIM = std::map<std::string, Real>());
+
+    //! Expected SIMM based DIM at the first simulation date
+    map<string, Real> unscaledCurrentDIM() override;
+    void build() override;
+
+    //! Path-wise sensitivities of a netting set by risk factor, date and sample, available after build()
+    const vector<vector<vector<Real>>>& sensitivities(const string& nettingSet);
+
+private:
+    // a SIMM bucket, the positions of its risk factors, their risk weights and correlations
+    struct Bucket {
+        vector<Size> factors;
+        vector<Real> riskWeights;
+        Matrix correlation;
+    };
+    // the buckets of a SIMM risk class and the correlation between the buckets
+    struct RiskClassBuckets {
+        SimmConfiguration::RiskClass riskClass;
+        vector<Bucket> buckets;
+        Matrix correlation;
+    };
+
+    // regress the netting set values of date j on the risk factors and fill the sensitivities by factor and sample
+    void regressionSensitivities(const string& nettingSet, Size j, vector<vector<Real>>& sensis) const;
+    // SIMM margin by sample from the sensitivities by factor and sample
+    void simmMargin(const vector<vector<Real>>& sensis, vector<Real>& margin) const;
+
+    boost::shared_ptr<SimmConfiguration> simmConfiguration_;
+    std::string calculationCurrency_;
+    vector<RiskFactor> riskFactors_;
+    Size regressionOrder_;
+
+    vector<AggregationScenarioDataType> factorTypes_;
+    vector<RiskClassBuckets> riskClasses_;
+    Matrix riskClassCorrelation_;
+
+    // For each netting set: sensitivities by risk factor, date and sample
+    map<string, vector<vector<vector<Real>>>> nettingSetSensitivities_;
+};
+
+//! Parse a risk factor of the form name:riskType:qualifier[:label1[:label2]], e.g. EUR-EURIBOR-6M:Risk_IRCurve:EUR:5y
+SimmDynamicInitialMarginCalculator::RiskFactor parseDimSimmRiskFactor(const std::string& s);
+
+} // namespace analytics
+} // namespace ore
@@ -64,119 +64,145 @@ DynamicCreditXvaCalculator::DynamicCreditXvaCalculator(
         QL_REQUIRE(tradeExposureCube_->dates()[i] == cptyCube->dates()[i],
             "date at " << i << " in tradeExposureCube and cptyCube mismatch ("
             << tradeExposureCube_->dates()[i] << " vs " << cptyCube->dates()[i] << ")");
+        dateIndex_[tradeExposureCube_->dates()[i]] = i;
     }
+
+    QL_REQUIRE(cptyCube->samples() >= tradeExposureCube_->samples() &&
+                   cptyCube->samples() >= nettingSetExposureCube_->samples(),
+               "number of samples in cptyCube (" << cptyCube->samples() << ") is less than in the exposure cubes ("
+                                                 << tradeExposureCube_->samples() << ", "
+                                                 << nettingSetExposureCube_->samples() << ")");
 }
 
+const float* DynamicCreditXvaCalculator::survivalProbabilities(const string& name, const Date& d) {
+    const Size samples = cptyCube_->samples();
+    auto sp = survivalProbabilities_.find(name);
+    if (sp == survivalProbabilities_.end()) {
+        Size id = cptyCube_->getTradeIndex(name);
+        vector<float> values((cptyCube_->numDates() + 1) * samples, 1.0f);
+        for (Size j = 0; j < cptyCube_->numDates(); ++j) {
+            cptyCube_->getSamples(id, j, cptySpIndex_, buffer_);
+            std::copy(buffer_.begin(), buffer_.end(), values.begin() + (j + 1) * samples);
+        }
+        sp = survivalProbabilities_.emplace(name, std::move(values)).first;
+    }
+    if (d == asof())
+        return sp->second.data();
+    auto j = dateIndex_.find(d);
+    QL_REQUIRE(j != dateIndex_.end(), "DynamicCreditXvaCalculator: date " << d << " not found in cptyCube");
+    return sp->second.data() + (j->second + 1) * samples;
+}
+
+const vector<Real>& DynamicCreditXvaCalculator::samples(const boost::shared_ptr<NPVCube>& cube, const string& id,
+                                                        const Date& d, Size depth) {
+    auto j = dateIndex_.find(d);
+    QL_REQUIRE(j != dateIndex_.end(), "DynamicCreditXvaCalculator: date " << d << " not found in exposure cube");
+    cube->getSamples(cube->getTradeIndex(id), j->second, depth, buffer_);
+    return buffer_;
+}
 
 const Real DynamicCreditXvaCalculator::calculateCvaIncrement(
     const string& tid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
+    const float* s0 = survivalProbabilities(cid, d0);
+    const float* s1 = survivalProbabilities(cid, d1);
+    const vector<Real>& epe = samples(tradeExposureCube_, tid, d1, tradeEpeIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(cid, d1, k, cptySpIndex_);
-        Real epe = tradeExposureCube_->get(tid, d1, k, tradeEpeIndex_);
-        increment += (s0 - s1) * epe;
-    }
+    for (Size k = 0; k < tradeExposureCube_->samples(); ++k)
+        increment += (s0[k] - s1[k]) * epe[k];
     return (1.0 - rr) * increment / tradeExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateDvaIncrement(
     const string& tid, const Date& d0, const Date& d1, const Real& rr) {
+    const float* s0 = survivalProbabilities(dvaName_, d0);
+    const float* s1 = survivalProbabilities(dvaName_, d1);
+    const vector<Real>& ene = samples(tradeExposureCube_, tid, d1, tradeEneIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(dvaName_, d1, k, cptySpIndex_);
-        Real ene = tradeExposureCube_->get(tid, d1, k, tradeEneIndex_);
-        increment += (s0 - s1) * ene;
-    }
+    for (Size k = 0; k < tradeExposureCube_->samples(); ++k)
+        increment += (s0[k] - s1[k]) * ene[k];
     return (1.0 - rr) * increment / tradeExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateNettingSetCvaIncrement(
     const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
+    const float* s0 = survivalProbabilities(cid, d0);
+    const float* s1 = survivalProbabilities(cid, d1);
+    const vector<Real>& epe = samples(nettingSetExposureCube_, nid, d1, nettingSetEpeIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(cid, d1, k, cptySpIndex_);
-        Real epe = nettingSetExposureCube_->get(nid, d1, k, nettingSetEpeIndex_);
-        increment += (s0 - s1) * epe;
-    }
+    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k)
+        increment += (s0[k] - s1[k]) * epe[k];
     return (1.0 - rr) * increment / nettingSetExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateNettingSetDvaIncrement(
     const string& nid, const Date& d0, const Date& d1, const Real& rr) {
+    const float* s0 = survivalProbabilities(dvaName_, d0);
+    const float* s1 = survivalProbabilities(dvaName_, d1);
+    const vector<Real>& ene = samples(nettingSetExposureCube_, nid, d1, nettingSetEneIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(dvaName_, d1, k, cptySpIndex_);
-        Real ene = nettingSetExposureCube_->get(nid, d1, k, nettingSetEneIndex_);
-        increment += (s0 - s1) * ene;
-    }
+    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k)
+        increment += (s0[k] - s1[k]) * ene[k];
     return (1.0 - rr) * increment / nettingSetExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateFbaIncrement(
     const string& tid, const string& cid, const string& dvaName,
     const Date& d0, const Date& d1, const Real& dcf) {
+    // no survival weighting for an empty name
+    const float* s0 = cid == "" ? nullptr : survivalProbabilities(cid, d0);
+    const float* s1 = dvaName == "" ? nullptr : survivalProbabilities(dvaName_, d0);
+    const vector<Real>& ene = samples(tradeExposureCube_, tid, d1, tradeEneIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real ene = tradeExposureCube_->get(tid, d1, k, tradeEneIndex_);
-        increment += s0 * s1 * ene;
-    }
+    for (Size k = 0; k < tradeExposureCube_->samples(); ++k)
+        increment += (s0 ? s0[k] : 1.0) * (s1 ? s1[k] : 1.0) * ene[k];
     return increment * dcf / tradeExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateFcaIncrement(
     const string& tid, const string& cid, const string& dvaName,
     const Date& d0, const Date& d1, const Real& dcf) {
+    const float* s0 = cid == "" ? nullptr : survivalProbabilities(cid, d0);
+    const float* s1 = dvaName == "" ? nullptr : survivalProbabilities(dvaName_, d0);
+    const vector<Real>& epe = samples(tradeExposureCube_, tid, d1, tradeEpeIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real epe = tradeExposureCube_->get(tid, d1, k, tradeEpeIndex_);
-        increment += s0 * s1 * epe;
-    }
+    for (Size k = 0; k < tradeExposureCube_->samples(); ++k)
+        increment += (s0 ? s0[k] : 1.0) * (s1 ? s1[k] : 1.0) * epe[k];
     return increment * dcf / tradeExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateNettingSetFbaIncrement(
     const string& nid, const string& cid, const string& dvaName,
     const Date& d0, const Date& d1, const Real& dcf) {
+    const float* s0 = cid == "" ? nullptr : survivalProbabilities(cid, d0);
+    const float* s1 = dvaName == "" ? nullptr : survivalProbabilities(dvaName_, d0);
+    const vector<Real>& ene = samples(nettingSetExposureCube_, nid, d1, nettingSetEneIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real ene = nettingSetExposureCube_->get(nid, d1, k, nettingSetEneIndex_);
-        increment += s0 * s1 * ene;
-    }
+    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k)
+        increment += (s0 ? s0[k] : 1.0) * (s1 ? s1[k] : 1.0) * ene[k];
     return increment * dcf / nettingSetExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateNettingSetFcaIncrement(
     const string& nid, const string& cid, const string& dvaName,
     const Date& d0, const Date& d1, const Real& dcf) {
+    const float* s0 = cid == "" ? nullptr : survivalProbabilities(cid, d0);
+    const float* s1 = dvaName == "" ? nullptr : survivalProbabilities(dvaName_, d0);
+    const vector<Real>& epe = samples(nettingSetExposureCube_, nid, d1, nettingSetEpeIndex_);
     Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real epe = nettingSetExposureCube_->get(nid, d1, k, nettingSetEpeIndex_);
-        increment += s0 * s1 * epe;
-    }
+    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k)
+        increment += (s0 ? s0[k] : 1.0) * (s1 ? s1[k] : 1.0) * epe[k];
     return increment * dcf / nettingSetExposureCube_->samples();
 }
 
 const Real DynamicCreditXvaCalculator::calculateNettingSetMvaIncrement(
     const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& dcf) {
 
+    const float* s0 = cid == "" ? nullptr : survivalProbabilities(cid, d0);
+    const float* s1 = dvaName_ == "" ? nullptr : survivalProbabilities(dvaName_, d0);
     Real increment = 0.0;
     for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName_ == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
         Real im = dimCalculator_->dimCube()->get(nid, d1, k);
-        increment += s0 * s1 * im;
+        increment += (s0 ? s0[k] : 1.0) * (s1 ? s1[k] : 1.0) * im;
     }
     return increment * dcf / nettingSetExposureCube_->samples();
 }
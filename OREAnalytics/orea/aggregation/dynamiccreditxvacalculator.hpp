@@ -25,6 +25,9 @@
 
 #include <orea/aggregation/xvacalculator.hpp>
 
+#include <map>
+#include <vector>
+
 namespace ore {
 namespace analytics {
 using namespace QuantLib;
@@ -100,8 +103,21 @@ public:
                                                        const Date& d0, const Date& d1, const Real& dcf) override;
 
 protected:
+    /*! Survival probabilities of the given name for all samples at the given date, read from the cpty cube once per
+        name and shared by all trades and netting sets with the same counterparty */
+    const float* survivalProbabilities(const string& name, const Date& d);
+    //! Samples of the given id, date and depth of the cube, via the buffer
+    const vector<Real>& samples(const boost::shared_ptr<NPVCube>& cube, const string& id, const Date& d,
+                                Size depth);
+
     const boost::shared_ptr<NPVCube>& cptyCube_;
     Size cptySpIndex_;
+    // date index in the cubes by date
+    map<Date, Size> dateIndex_;
+    /* survival probabilities by name in single precision as in the cpty cube, by date and sample, the first date is
+       the asof date with survival probability 1 */
+    map<string, vector<float>> survivalProbabilities_;
+    vector<Real> buffer_;
 };
 
 } // namespace analytics
@@ -43,24 +43,72 @@ ExposureAllocator::ExposureAllocator(
 void ExposureAllocator::build() {
     LOG("Compute allocated trade exposures");
 
-    for (const auto& [nettingSetId, idx] : nettedExposureCube_->idsAndIndexes()) {
+    // the trades to allocate to, the trades of a netting set are adjacent
 
-        for (const auto & [tid, trade] : portfolio_->trades()) {
-            string nid = trade->envelope().nettingSetId();
-            if (nid != nettingSetId)
+    struct Allocation {
+        string tid, nid;
+        Size tradeIndex, nettingSetIndex;
+        Real epeWeight, eneWeight;
+    };
+    vector<Allocation> allocations;
+    bool withWeights = true;
+    for (const auto& [nettingSetId, nettingSetIndex] : nettedExposureCube_->idsAndIndexes()) {
+        for (const auto& [tid, trade] : portfolio_->trades()) {
+            if (trade->envelope().nettingSetId() != nettingSetId)
                 continue;
-            
+            // the weights do not depend on the date and sample, we compute them once per trade here
+            Real epeWeight = allocatedEpeWeight(tid, nettingSetId);
+            Real eneWeight = allocatedEneWeight(tid, nettingSetId);
+            withWeights = withWeights && epeWeight != Null<Real>() && eneWeight != Null<Real>();
+            allocations.push_back({tid, nettingSetId, tradeExposureCube_->getTradeIndex(tid), nettingSetIndex,
+                                   epeWeight, eneWeight});
+        }
+    }
 
+    if (!withWeights) {
+        for (const auto& a : allocations) {
             for (Date date : tradeExposureCube_->dates()) {
                 for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-                    tradeExposureCube_->set(calculateAllocatedEpe(tid, nid, date, k),
-                                            tid, date, k, allocatedTradeEpeIndex_);
-                    tradeExposureCube_->set(calculateAllocatedEne(tid, nid, date, k),
-                                            tid, date, k, allocatedTradeEneIndex_);
+                    tradeExposureCube_->set(calculateAllocatedEpe(a.tid, a.nid, date, k),
+                                            a.tid, date, k, allocatedTradeEpeIndex_);
+                    tradeExposureCube_->set(calculateAllocatedEne(a.tid, a.nid, date, k),
+                                            a.tid, date, k, allocatedTradeEneIndex_);
                 }
             }
         }
+        LOG("Completed calculating allocated trade exposures");
+        return;
     }
+
+    QL_REQUIRE(nettedExposureCube_->dates() == tradeExposureCube_->dates() &&
+                   nettedExposureCube_->samples() == tradeExposureCube_->samples(),
+               "ExposureAllocator: trade and netting set exposure cubes have different dates or samples");
+
+    // read the netting set exposures once per date and broadcast them to the trades of the netting set, the jobs
+    // write to distinct trades of the trade exposure cube
+
+    const Size dates = tradeExposureCube_->numDates(), samples = tradeExposureCube_->samples();
+    runBlocks(allocations.size(), nThreads_, threadPool_, [&](const Size begin, const Size end) {
+        vector<Real> epe, ene;
+        for (Size first = begin; first < end;) {
+            Size last = first + 1;
+            while (last < end && allocations[last].nettingSetIndex == allocations[first].nettingSetIndex)
+                ++last;
+            for (Size j = 0; j < dates; ++j) {
+                nettedExposureCube_->getSamples(allocations[first].nettingSetIndex, j, nettingSetEpeIndex_, epe);
+                nettedExposureCube_->getSamples(allocations[first].nettingSetIndex, j, nettingSetEneIndex_, ene);
+                for (Size t = first; t < last; ++t) {
+                    const Allocation& a = allocations[t];
+                    for (Size k = 0; k < samples; ++k) {
+                        tradeExposureCube_->set(epe[k] * a.epeWeight, a.tradeIndex, j, k, allocatedTradeEpeIndex_);
+                        tradeExposureCube_->set(ene[k] * a.eneWeight, a.tradeIndex, j, k, allocatedTradeEneIndex_);
+                    }
+                }
+            }
+            first = last;
+        }
+    });
+
     LOG("Completed calculating allocated trade exposures");
 }
 
@@ -110,6 +158,16 @@ Real RelativeFairValueNetExposureAllocator::calculateAllocatedEne(const string&
     return netENE * -std::max(-tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
 }
 
+Real RelativeFairValueNetExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
+    QL_REQUIRE(nettingSetPositiveValueToday_[nid] > 0.0, "non-zero positive NPV expected");
+    return std::max(tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
+}
+
+Real RelativeFairValueNetExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
+    QL_REQUIRE(nettingSetNegativeValueToday_[nid] > 0.0, "non-zero negative NPV expected");
+    return -std::max(-tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
+}
+
 RelativeFairValueGrossExposureAllocator::RelativeFairValueGrossExposureAllocator(
     const boost::shared_ptr<Portfolio>& portfolio,
     const boost::shared_ptr<NPVCube>& tradeExposureCube,
@@ -151,6 +209,15 @@ Real RelativeFairValueGrossExposureAllocator::calculateAllocatedEne(const string
     return netENE * tradeValueToday_[tid] / nettingSetValueToday_[nid];
 }
 
+Real RelativeFairValueGrossExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
+    QL_REQUIRE(nettingSetValueToday_[nid] != 0.0, "non-zero netting set value expected");
+    return tradeValueToday_[tid] / nettingSetValueToday_[nid];
+}
+
+Real RelativeFairValueGrossExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
+    return allocatedEpeWeight(tid, nid);
+}
+
 RelativeXvaExposureAllocator::RelativeXvaExposureAllocator(
     const boost::shared_ptr<Portfolio>& portfolio,
     const boost::shared_ptr<NPVCube>& tradeExposureCube,
@@ -181,6 +248,14 @@ Real RelativeXvaExposureAllocator::calculateAllocatedEne(const string& tid, cons
     return netENE * tradeDva_[tid] / nettingSetSumDva_[nid];
 }
 
+Real RelativeXvaExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
+    return tradeCva_[tid] / nettingSetSumCva_[nid];
+}
+
+Real RelativeXvaExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
+    return tradeDva_[tid] / nettingSetSumDva_[nid];
+}
+
 NoneExposureAllocator::NoneExposureAllocator(
     const boost::shared_ptr<Portfolio>& portfolio,
     const boost::shared_ptr<NPVCube>& tradeExposureCube,
@@ -195,6 +270,8 @@ Real NoneExposureAllocator::calculateAllocatedEne(const string& tid, const strin
                                                   const Date& date, const Size sample) {
     return 0;
 }
+Real NoneExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) { return 0.0; }
+Real NoneExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) { return 0.0; }
 
 ExposureAllocator::AllocationMethod parseAllocationMethod(const string& s) {
     static map<string, ExposureAllocator::AllocationMethod> m = {
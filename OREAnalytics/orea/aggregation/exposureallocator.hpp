@@ -24,6 +24,7 @@
 #pragma once
 
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <ored/portfolio/portfolio.hpp>
 
 namespace ore {
@@ -63,10 +64,24 @@ public:
     //! Compute exposures along all paths and fill result structures
     virtual void build();
 
+    /*! Process the trades in build() in nThreads jobs, on the given thread pool if set, otherwise in separate
+        threads. This requires the allocation weights, see allocatedEpeWeight(), otherwise the allocation is done
+        sequentially. */
+    void setThreads(const Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = std::max<Size>(nThreads, 1);
+        threadPool_ = threadPool;
+    }
 
 protected:
     virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) = 0;
     virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) = 0;
+    /*! Return w such that the allocated EPE of the trade is w times the netting set EPE on all dates and samples,
+        or Null<Real>() if the allocation is not of this form. With the weights build() reads the netting set
+        exposures once per date for all trades of the netting set, otherwise calculateAllocatedEpe() is called for
+        each trade, date and sample. */
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) { return Null<Real>(); }
+    //! Same as allocatedEpeWeight() for the ENE
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) { return Null<Real>(); }
     boost::shared_ptr<Portfolio> portfolio_;
     boost::shared_ptr<NPVCube> tradeExposureCube_;
     boost::shared_ptr<NPVCube> nettedExposureCube_;
@@ -77,6 +92,8 @@ protected:
     Size nettingSetEpeIndex_;
     Size nettingSetEneIndex_;
     map<string, Real> nettingSetValueToday_, nettingSetPositiveValueToday_, nettingSetNegativeValueToday_;
+    Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 class RelativeFairValueNetExposureAllocator : public ExposureAllocator {
@@ -93,6 +110,8 @@ public:
 protected:
     virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
     virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeValueToday_;
     map<string, Real> nettingSetPositiveValueToday_;
     map<string, Real> nettingSetNegativeValueToday_;
@@ -112,6 +131,8 @@ public:
 protected:
     virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
     virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeValueToday_;
     map<string, Real> nettingSetValueToday_;
 };
@@ -134,6 +155,8 @@ public:
 protected:
     virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
     virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeCva_;
     map<string, Real> tradeDva_;
     map<string, Real> nettingSetSumCva_;
@@ -151,6 +174,8 @@ public:
 protected:
     virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
     virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
 };
 
 //! Convert text representation to ExposureAllocator::AllocationMethod
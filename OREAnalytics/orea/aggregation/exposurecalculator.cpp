@@ -17,6 +17,7 @@
 */
 
 #include <orea/aggregation/exposurecalculator.hpp>
+#include <orea/aggregation/exposurestatistics.hpp>
 #include <orea/cube/inmemorycube.hpp>
 
 #include <ored/portfolio/trade.hpp>
@@ -36,8 +37,8 @@ ExposureCalculator::ExposureCalculator(
     const boost::shared_ptr<Market>& market,
     bool exerciseNextBreak, const string& baseCurrency, const string& configuration,
     const Real quantile, const CollateralExposureHelper::CalculationType calcType, const bool multiPath,
-    const bool flipViewXVA)
-    : portfolio_(portfolio), cube_(cube), cubeInterpretation_(cubeInterpretation),
+    const bool flipViewXVA, const boost::shared_ptr<NPVCube>& nettingSetCube)
+    : portfolio_(portfolio), cube_(cube), nettingSetCube_(nettingSetCube), cubeInterpretation_(cubeInterpretation),
        market_(market), exerciseNextBreak_(exerciseNextBreak),
       baseCurrency_(baseCurrency), configuration_(configuration),
       quantile_(quantile), calcType_(calcType),
@@ -45,6 +46,9 @@ ExposureCalculator::ExposureCalculator(
       today_(market_->asofDate()), dc_(ActualActual(ActualActual::ISDA)), flipViewXVA_(flipViewXVA) {
 
     QL_REQUIRE(portfolio_, "portfolio is null");
+    // the break dates are applied to the trade values before they are aggregated
+    QL_REQUIRE(!nettingSetCube_ || !exerciseNextBreak_,
+               "ExposureCalculator: exerciseNextBreak is not supported with a netting set cube");
 
     if (multiPath) {
         exposureCube_ = boost::make_shared<SinglePrecisionInMemoryCubeN>(
@@ -70,149 +74,203 @@ ExposureCalculator::ExposureCalculator(
 
 void ExposureCalculator::build() {
     LOG("Compute trade exposure profiles, " << (flipViewXVA_ ? "inverted (flipViewXVA = Y)" : "regular (flipViewXVA = N)"));
-    size_t i = 0;
-    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++i) {
-        auto trade = tradeIt->second;
-        string tradeId = tradeIt->first;
-        string nettingSetId = trade->envelope().nettingSetId();
-        LOG("Aggregate exposure for trade " << tradeId);
-        if (nettingSetDefaultValue_.find(nettingSetId) == nettingSetDefaultValue_.end()) {
-            nettingSetDefaultValue_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
-            nettingSetCloseOutValue_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
-            nettingSetMporPositiveFlow_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
-            nettingSetMporNegativeFlow_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
-        }
 
-        // Identify the next break date if provided, default is trade maturity.
-        Date nextBreakDate = trade->maturity();
-        TradeActions ta = trade->tradeActions();
-        if (exerciseNextBreak_ && !ta.empty()) {
-            // loop over actions and pick next mutual break, if available
-            vector<TradeAction> actions = ta.actions();
-            for (Size j = 0; j < actions.size(); ++j) {
-                DLOG("TradeAction for " << tradeId << ", actionType " << actions[j].type() << ", actionOwner "
-                                        << actions[j].owner());
-                // FIXME: Introduce enumeration and parse text when building trade
-                if (actions[j].type() == "Break" && actions[j].owner() == "Mutual") {
-                    QuantLib::Schedule schedule = ore::data::makeSchedule(actions[j].schedule());
-                    vector<Date> dates = schedule.dates();
-                    std::sort(dates.begin(), dates.end());
-                    Date today = Settings::instance().evaluationDate();
-                    for (Size k = 0; k < dates.size(); ++k) {
-                        if (dates[k] > today && dates[k] < nextBreakDate) {
-                            nextBreakDate = dates[k];
-                            DLOG("Next break date for trade " << tradeId << ": "
-                                                              << QuantLib::io::iso_date(nextBreakDate));
-                            break;
+    // Set up all result containers up front, so that the netting sets can be processed concurrently below. Each
+    // netting set is processed by one thread, which only writes to the entries of its own netting set and trades.
+    map<string, Size> nettingSetIndex;
+    for (Size n = 0; n < nettingSetIds_.size(); ++n) {
+        nettingSetIndex[nettingSetIds_[n]] = n;
+        for (auto v : {&nettingSetDefaultValue_, &nettingSetCloseOutValue_, &nettingSetMporPositiveFlow_,
+                       &nettingSetMporNegativeFlow_})
+            (*v)[nettingSetIds_[n]] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
+    }
+    vector<Size> nettingSetCubeIndex;
+    if (nettingSetCube_) {
+        QL_REQUIRE(nettingSetCube_->dates() == dates_ && nettingSetCube_->samples() == cube_->samples(),
+                   "ExposureCalculator: netting set cube dates and samples do not match the trade cube");
+        for (const auto& n : nettingSetIds_)
+            nettingSetCubeIndex.push_back(nettingSetCube_->getTradeIndex(n));
+    }
+    // with a netting set cube, only the T0 values are available on trade level
+    const Size tradeDates = nettingSetCube_ ? 0 : dates_.size();
+    vector<vector<Size>> nettingSetTrades(nettingSetIds_.size());
+    vector<map<string, boost::shared_ptr<Trade>>::const_iterator> trades;
+    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt) {
+        nettingSetTrades[nettingSetIndex.at(tradeIt->second->envelope().nettingSetId())].push_back(trades.size());
+        trades.push_back(tradeIt);
+        ee_b_[tradeIt->first];
+        eee_b_[tradeIt->first];
+        pfe_[tradeIt->first];
+        epe_b_[tradeIt->first];
+        eepe_b_[tradeIt->first];
+    }
+
+    // Market data and settings are not accessed in the worker threads
+    Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+    vector<Real> discounts(dates_.size());
+    for (Size j = 0; j < dates_.size(); ++j)
+        discounts[j] = curve->discount(dates_[j]);
+    const Date evaluationDate = Settings::instance().evaluationDate();
+
+    runBlocks(nettingSetIds_.size(), nThreads_, threadPool_, [&](const Size begin, const Size end) {
+        for (Size n = begin; n < end; ++n) {
+            const string& nettingSetId = nettingSetIds_[n];
+            auto& nettingSetDefaultValue = nettingSetDefaultValue_.at(nettingSetId);
+            auto& nettingSetCloseOutValue = nettingSetCloseOutValue_.at(nettingSetId);
+            auto& nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_.at(nettingSetId);
+            auto& nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_.at(nettingSetId);
+            for (Size i : nettingSetTrades[n]) {
+                const auto& trade = trades[i]->second;
+                const string& tradeId = trades[i]->first;
+                LOG("Aggregate exposure for trade " << tradeId);
+
+                // Identify the next break date if provided, default is trade maturity.
+                Date nextBreakDate = trade->maturity();
+                TradeActions ta = trade->tradeActions();
+                if (exerciseNextBreak_ && !ta.empty()) {
+                    // loop over actions and pick next mutual break, if available
+                    vector<TradeAction> actions = ta.actions();
+                    for (Size j = 0; j < actions.size(); ++j) {
+                        DLOG("TradeAction for " << tradeId << ", actionType " << actions[j].type() << ", actionOwner "
+                                                << actions[j].owner());
+                        // FIXME: Introduce enumeration and parse text when building trade
+                        if (actions[j].type() == "Break" && actions[j].owner() == "Mutual") {
+                            QuantLib::Schedule schedule = ore::data::makeSchedule(actions[j].schedule());
+                            vector<Date> dates = schedule.dates();
+                            std::sort(dates.begin(), dates.end());
+                            for (Size k = 0; k < dates.size(); ++k) {
+                                if (dates[k] > evaluationDate && dates[k] < nextBreakDate) {
+                                    nextBreakDate = dates[k];
+                                    DLOG("Next break date for trade " << tradeId << ": "
+                                                                      << QuantLib::io::iso_date(nextBreakDate));
+                                    break;
+                                }
+                            }
                         }
                     }
                 }
-            }
-        }
 
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
-        Real npv0;
-        if (flipViewXVA_) {
-            npv0 = -cube_->getT0(i);
-        } else {
-            npv0 = cube_->getT0(i);
-        }
-        vector<Real> epe(dates_.size() + 1, 0.0);
-        vector<Real> ene(dates_.size() + 1, 0.0);
-        vector<Real> ee_b(dates_.size() + 1, 0.0);
-        vector<Real> eee_b(dates_.size() + 1, 0.0);
-        vector<Real> pfe(dates_.size() + 1, 0.0);
-        epe[0] = std::max(npv0, 0.0);
-        ene[0] = std::max(-npv0, 0.0);
-        ee_b[0] = epe[0];
-        eee_b[0] = ee_b[0];
-        pfe[0] = std::max(npv0, 0.0);
-        exposureCube_->setT0(epe[0], tradeId, ExposureIndex::EPE);
-        exposureCube_->setT0(ene[0], tradeId, ExposureIndex::ENE);
-        for (Size j = 0; j < dates_.size(); ++j) {
-            Date d = cube_->dates()[j];
-            vector<Real> distribution(cube_->samples(), 0.0);
-            for (Size k = 0; k < cube_->samples(); ++k) {
-                // RL 2020-07-17
-                // 1) If the calculation type is set to NoLag:
-                //    Collateral balances are NOT delayed by the MPoR, but we use the close-out NPV.
-                // 2) Otherwise:
-                //    Collateral balances are delayed by the MPoR (if possible, i.e. the valuation
-                //    grid has MPoR spacing), and we use the default date NPV.
-                //    This is the treatment in the ORE releases up to June 2020).
-                Real defaultValue =
-                    d > nextBreakDate && exerciseNextBreak_ ? 0.0 : cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
-                Real closeOutValue;
-                if (isRegularCubeStorage_ && j == dates_.size() - 1)
-                    closeOutValue = defaultValue;
-                else
-                    closeOutValue = d > nextBreakDate && exerciseNextBreak_
-                                        ? 0.0
-                                        : cubeInterpretation_->getCloseOutNpv(cube_, i, j, k);
-
-                Real positiveCashFlow = cubeInterpretation_->getMporPositiveFlows(cube_, i, j, k);
-                Real negativeCashFlow = cubeInterpretation_->getMporNegativeFlows(cube_, i, j, k);
-                //for single trade exposures, always default value is relevant
-                Real npv = defaultValue;
-                epe[j + 1] += max(npv, 0.0) / cube_->samples();
-                ene[j + 1] += max(-npv, 0.0) / cube_->samples();
-                nettingSetDefaultValue_[nettingSetId][j][k] += defaultValue;
-                nettingSetCloseOutValue_[nettingSetId][j][k] += closeOutValue;
-                nettingSetMporPositiveFlow_[nettingSetId][j][k] += positiveCashFlow;
-                nettingSetMporNegativeFlow_[nettingSetId][j][k] += negativeCashFlow;
-                distribution[k] = npv;
-                if (multiPath_) {
-                    exposureCube_->set(max(npv, 0.0), tradeId, d, k, ExposureIndex::EPE);
-                    exposureCube_->set(max(-npv, 0.0), tradeId, d, k, ExposureIndex::ENE);
+                Real npv0;
+                if (flipViewXVA_) {
+                    npv0 = -cube_->getT0(i);
+                } else {
+                    npv0 = cube_->getT0(i);
                 }
+                vector<Real> epe(dates_.size() + 1, 0.0);
+                vector<Real> ene(dates_.size() + 1, 0.0);
+                vector<Real> ee_b(dates_.size() + 1, 0.0);
+                vector<Real> eee_b(dates_.size() + 1, 0.0);
+                vector<Real> pfe(dates_.size() + 1, 0.0);
+                epe[0] = std::max(npv0, 0.0);
+                ene[0] = std::max(-npv0, 0.0);
+                ee_b[0] = epe[0];
+                eee_b[0] = ee_b[0];
+                pfe[0] = std::max(npv0, 0.0);
+                exposureCube_->setT0(epe[0], i, ExposureIndex::EPE);
+                exposureCube_->setT0(ene[0], i, ExposureIndex::ENE);
+                vector<Real> defaultValues, closeOutValues, positiveCashFlows, negativeCashFlows;
+                for (Size j = 0; j < tradeDates; ++j) {
+                    Date d = dates_[j];
+                    // RL 2020-07-17
+                    // 1) If the calculation type is set to NoLag:
+                    //    Collateral balances are NOT delayed by the MPoR, but we use the close-out NPV.
+                    // 2) Otherwise:
+                    //    Collateral balances are delayed by the MPoR (if possible, i.e. the valuation
+                    //    grid has MPoR spacing), and we use the default date NPV.
+                    //    This is the treatment in the ORE releases up to June 2020).
+                    bool broken = d > nextBreakDate && exerciseNextBreak_;
+                    if (broken)
+                        defaultValues.assign(cube_->samples(), 0.0);
+                    else
+                        cubeInterpretation_->getDefaultNpvs(cube_, i, j, defaultValues);
+                    if (isRegularCubeStorage_ && j == dates_.size() - 1)
+                        closeOutValues = defaultValues;
+                    else if (broken)
+                        closeOutValues.assign(cube_->samples(), 0.0);
+                    else
+                        cubeInterpretation_->getCloseOutNpvs(cube_, i, j, closeOutValues);
+                    cubeInterpretation_->getMporPositiveFlows(cube_, i, j, positiveCashFlows);
+                    cubeInterpretation_->getMporNegativeFlows(cube_, i, j, negativeCashFlows);
+                    for (Size k = 0; k < cube_->samples(); ++k) {
+                        Real defaultValue = defaultValues[k];
+                        Real closeOutValue = closeOutValues[k];
+                        Real positiveCashFlow = positiveCashFlows[k];
+                        Real negativeCashFlow = negativeCashFlows[k];
+                        //for single trade exposures, always default value is relevant
+                        Real npv = defaultValue;
+                        nettingSetDefaultValue[j][k] += defaultValue;
+                        nettingSetCloseOutValue[j][k] += closeOutValue;
+                        nettingSetMporPositiveFlow[j][k] += positiveCashFlow;
+                        nettingSetMporNegativeFlow[j][k] += negativeCashFlow;
+                        if (multiPath_) {
+                            exposureCube_->set(max(npv, 0.0), i, j, k, ExposureIndex::EPE);
+                            exposureCube_->set(max(-npv, 0.0), i, j, k, ExposureIndex::ENE);
+                        }
+                    }
+                    expectedExposures(defaultValues.data(), defaultValues.size(), epe[j + 1], ene[j + 1]);
+                    if (!multiPath_) {
+                        exposureCube_->set(epe[j + 1], i, j, 0, ExposureIndex::EPE);
+                        exposureCube_->set(ene[j + 1], i, j, 0, ExposureIndex::ENE);
+                    }
+                    ee_b[j + 1] = epe[j + 1] / discounts[j];
+                    eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
+                    // the default values are not used after this point, so they can be reordered
+                    pfe[j + 1] = std::max(sampleQuantile(defaultValues, quantile_), 0.0);
+                }
+                ee_b_.at(tradeId) = ee_b;
+                eee_b_.at(tradeId) = eee_b;
+                pfe_.at(tradeId) = pfe;
+
+                Real epe_b = 0.0;
+                Real eepe_b = 0.0;
+
+                Size t = 0;
+                Calendar cal = WeekendsOnly();
+                /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
+                (or until maturity if all positions of the netting set mature before one year).
+                This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
+                included.
+                This may effect DateGrids with daily data points*/
+                Date maturity = std::min(cal.adjust(today_ + 1 * Years + 4 * Days), trade->maturity());
+                QuantLib::Real maturityTime = dc_.yearFraction(today_, maturity);
+
+                while (t < dates_.size() && times_[t] <= maturityTime)
+                    ++t;
+
+                if (t > 0) {
+                    vector<double> weights(t);
+                    weights[0] = times_[0];
+                    for (Size k = 1; k < t; k++)
+                        weights[k] = times_[k] - times_[k - 1];
+                    double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+                    for (Size k = 0; k < t; k++)
+                        weights[k] /= totalWeights;
+
+                    for (Size k = 0; k < t; k++) {
+                        epe_b += ee_b[k] * weights[k];
+                        eepe_b += eee_b[k] * weights[k];
+                    }
+                }
+                epe_b_.at(tradeId) = epe_b;
+                eepe_b_.at(tradeId) = eepe_b;
             }
-            if (!multiPath_) {
-                exposureCube_->set(epe[j + 1], tradeId, d, 0, ExposureIndex::EPE);
-                exposureCube_->set(ene[j + 1], tradeId, d, 0, ExposureIndex::ENE);
-            }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
-            eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
-        }
-        ee_b_[tradeId] = ee_b;
-        eee_b_[tradeId] = eee_b;
-        pfe_[tradeId] = pfe;
-
-        Real epe_b = 0.0;
-        Real eepe_b = 0.0;
-
-        Size t = 0;
-        Calendar cal = WeekendsOnly();
-        /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
-        (or until maturity if all positions of the netting set mature before one year).
-        This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
-        included.
-        This may effect DateGrids with daily data points*/
-        Date maturity = std::min(cal.adjust(today_ + 1 * Years + 4 * Days), trade->maturity());
-        QuantLib::Real maturityTime = dc_.yearFraction(today_, maturity);
-
-        while (t < dates_.size() && times_[t] <= maturityTime)
-            ++t;
-
-        if (t > 0) {
-            vector<double> weights(t);
-            weights[0] = times_[0];
-            for (Size k = 1; k < t; k++)
-                weights[k] = times_[k] - times_[k - 1];
-            double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
-            for (Size k = 0; k < t; k++)
-                weights[k] /= totalWeights;
-
-            for (Size k = 0; k < t; k++) {
-                epe_b += ee_b[k] * weights[k];
-                eepe_b += eee_b[k] * weights[k];
+
+            if (nettingSetCube_) {
+                vector<Real> values;
+                Size id = nettingSetCubeIndex[n];
+                for (Size j = 0; j < dates_.size(); ++j) {
+                    cubeInterpretation_->getDefaultNpvs(nettingSetCube_, id, j, values);
+                    nettingSetDefaultValue[j] = values;
+                    if (isRegularCubeStorage_ && j == dates_.size() - 1)
+                        nettingSetCloseOutValue[j] = values;
+                    else
+                        cubeInterpretation_->getCloseOutNpvs(nettingSetCube_, id, j, nettingSetCloseOutValue[j]);
+                    cubeInterpretation_->getMporPositiveFlows(nettingSetCube_, id, j, nettingSetMporPositiveFlow[j]);
+                    cubeInterpretation_->getMporNegativeFlows(nettingSetCube_, id, j, nettingSetMporNegativeFlow[j]);
+                }
             }
         }
-        epe_b_[tradeId] = epe_b;
-        eepe_b_[tradeId] = eepe_b;
-    }
+    });
 }
 
 vector<Real> ExposureCalculator::getMeanExposure(const string& tid, ExposureIndex index) {
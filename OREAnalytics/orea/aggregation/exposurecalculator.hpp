@@ -26,6 +26,7 @@
 #include <orea/aggregation/collatexposurehelper.hpp>
 #include <orea/cube/cubeinterpretation.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <ored/portfolio/portfolio.hpp>
 
 #include <boost/shared_ptr.hpp>
@@ -67,7 +68,11 @@ public:
 	    //! Flag to indicate exposure evaluation with dynamic credit
         const bool multiPath,
         //! Flag to indicate flipped xva calculation
-        const bool flipViewXVA
+        const bool flipViewXVA,
+        /*! Netting set values aggregated during the valuation, see NettingSetAggregationCube. If given, the netting
+            set values are read from this cube and the trade cube above only provides the T0 values, the trade exposure
+            profiles are zero after T0. */
+        const boost::shared_ptr<NPVCube>& nettingSetCube = nullptr
     );
 
     virtual ~ExposureCalculator() {}
@@ -75,6 +80,13 @@ public:
     //! Compute exposures along all paths and fill result structures
     virtual void build();
 
+    /*! Process the netting sets in build() in nThreads jobs, on the given thread pool if set, otherwise in separate
+        threads. The trades of one netting set are processed in the same job. */
+    void setThreads(const Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = std::max<Size>(nThreads, 1);
+        threadPool_ = threadPool;
+    }
+
     enum ExposureIndex {
         EPE = 0,
         ENE,
@@ -85,6 +97,7 @@ public:
 
     boost::shared_ptr<Portfolio> portfolio() { return portfolio_; }
     boost::shared_ptr<NPVCube> npvCube() { return cube_; }
+    boost::shared_ptr<NPVCube> nettingSetCube() { return nettingSetCube_; }
     boost::shared_ptr<CubeInterpretation> cubeInterpretation() { return cubeInterpretation_; }
     boost::shared_ptr<Market> market() { return market_; }
     bool exerciseNextBreak() { return exerciseNextBreak_; }
@@ -122,6 +135,7 @@ public:
 protected:
     const boost::shared_ptr<Portfolio> portfolio_;
     const boost::shared_ptr<NPVCube> cube_;
+    const boost::shared_ptr<NPVCube> nettingSetCube_;
     const boost::shared_ptr<CubeInterpretation> cubeInterpretation_;
     const boost::shared_ptr<Market> market_;
     const bool exerciseNextBreak_;
@@ -151,6 +165,8 @@ protected:
     map<string, Real> eepe_b_;
     vector<Real> getMeanExposure(const string& tid, ExposureIndex index);
     bool flipViewXVA_;
+    Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 } // namespace analytics
@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+#include <orea/aggregation/exposurestatistics.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+class KahanSum {
+public:
+    void add(const Real x) {
+        Real y = x - c_;
+        Real t = s_ + y;
+        c_ = (t - s_) - y;
+        s_ = t;
+    }
+    Real sum() const { return s_; }
+
+private:
+    Real s_ = 0.0, c_ = 0.0;
+};
+
+// sums of the positive and negative parts, sign = 1 for the positive, -1 for the negative part, 0 for both
+template <int sign> void exposureSums(const Real* v, const Size n, Real& pos, Real& neg) {
+    // independent partial sums, these map to the lanes of the vector registers
+    const Size lanes = 4;
+    Real p[lanes] = {}, q[lanes] = {};
+    Size k = 0;
+    for (; k + lanes <= n; k += lanes) {
+        for (Size l = 0; l < lanes; ++l) {
+            if (sign >= 0)
+                p[l] += std::max(v[k + l], 0.0);
+            if (sign <= 0)
+                q[l] += std::max(-v[k + l], 0.0);
+        }
+    }
+    for (; k < n; ++k) {
+        if (sign >= 0)
+            p[0] += std::max(v[k], 0.0);
+        if (sign <= 0)
+            q[0] += std::max(-v[k], 0.0);
+    }
+    pos = (p[0] + p[1]) + (p[2] + p[3]);
+    neg = (q[0] + q[1]) + (q[2] + q[3]);
+}
+
+template <int sign> void compensatedExposureSums(const Real* v, const Size n, Real& pos, Real& neg) {
+    KahanSum p, q;
+    for (Size k = 0; k < n; ++k) {
+        if (sign >= 0)
+            p.add(std::max(v[k], 0.0));
+        if (sign <= 0)
+            q.add(std::max(-v[k], 0.0));
+    }
+    pos = p.sum();
+    neg = q.sum();
+}
+
+template <int sign> void exposureMeans(const Real* v, const Size n, Real& pos, Real& neg, const bool compensated) {
+    QL_REQUIRE(n > 0, "exposure statistics: no samples given");
+    if (compensated)
+        compensatedExposureSums<sign>(v, n, pos, neg);
+    else
+        exposureSums<sign>(v, n, pos, neg);
+    pos /= n;
+    neg /= n;
+}
+
+} // namespace
+
+void expectedExposures(const Real* values, Size n, Real& epe, Real& ene, bool compensated) {
+    exposureMeans<0>(values, n, epe, ene, compensated);
+}
+
+Real expectedPositiveExposure(const Real* values, Size n, bool compensated) {
+    Real epe, ene;
+    exposureMeans<1>(values, n, epe, ene, compensated);
+    return epe;
+}
+
+Real expectedNegativeExposure(const Real* values, Size n, bool compensated) {
+    Real epe, ene;
+    exposureMeans<-1>(values, n, epe, ene, compensated);
+    return ene;
+}
+
+Real sampleQuantile(std::vector<Real>& samples, Real quantile) {
+    QL_REQUIRE(!samples.empty(), "sampleQuantile: no samples given");
+    QL_REQUIRE(quantile >= 0.0 && quantile <= 1.0, "sampleQuantile: quantile (" << quantile << ") must be in [0,1]");
+    Size index = Size(std::floor(quantile * (samples.size() - 1) + 0.5));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+/*! \file orea/aggregation/exposurestatistics.hpp
+    \brief Exposure statistics over the samples of a cube slice
+    \ingroup analytics
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Expected positive and negative exposure of n contiguous samples
+/*! Computes epe = mean(max(v, 0)) and ene = mean(max(-v, 0)) in one pass. The sums are accumulated in several
+    independent partial sums, so that the loop can be vectorised without reordering the additions. If compensated
+    is true, Kahan summation is used instead, which is slower, but more accurate for large numbers of samples.
+
+    \ingroup analytics
+*/
+void expectedExposures(const Real* values, Size n, Real& epe, Real& ene, bool compensated = false);
+
+//! Expected positive exposure mean(max(v, 0)) of n contiguous samples, see expectedExposures()
+Real expectedPositiveExposure(const Real* values, Size n, bool compensated = false);
+
+//! Expected negative exposure mean(max(-v, 0)) of n contiguous samples, see expectedExposures()
+Real expectedNegativeExposure(const Real* values, Size n, bool compensated = false);
+
+//! Quantile of the samples, the order of the samples is changed
+/*! Returns the value at position floor(quantile * (n - 1) + 0.5) of the sorted samples, the position is found with
+    std::nth_element, i.e. in linear time.
+
+    \ingroup analytics
+*/
+Real sampleQuantile(std::vector<Real>& samples, Real quantile);
+
+} // namespace analytics
+} // namespace ore
@@ -17,6 +17,7 @@
 */
 
 #include <orea/aggregation/nettedexposurecalculator.hpp>
+#include <orea/aggregation/exposurestatistics.hpp>
 
 #include <ored/portfolio/trade.hpp>
 
@@ -104,7 +105,6 @@ void NettedExposureCalculator::build() {
     
     map<string, Real> nettingSetValueToday;
     map<string, Date> nettingSetMaturity;
-    map<string, Size> nettingSetSize;
     Size cubeIndex = 0;
     for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++cubeIndex) {
         const auto& trade = tradeIt->second;
@@ -126,261 +126,285 @@ void NettedExposureCalculator::build() {
         if (nettingSetValueToday.find(nettingSetId) == nettingSetValueToday.end()) {
             nettingSetValueToday[nettingSetId] = 0.0;
             nettingSetMaturity[nettingSetId] = today;
-            nettingSetSize[nettingSetId] = 0;
         }
 
         nettingSetValueToday[nettingSetId] += npv;
 
         if (trade->maturity() > nettingSetMaturity[nettingSetId])
             nettingSetMaturity[nettingSetId] = trade->maturity();
-        nettingSetSize[nettingSetId]++;
     }
 
     vector<vector<Real>> averagePositiveAllocation(portfolio_->size(), vector<Real>(cube_->dates().size(), 0.0));
     vector<vector<Real>> averageNegativeAllocation(portfolio_->size(), vector<Real>(cube_->dates().size(), 0.0));
 
-    Size nettingSetCount = 0;
-    for (auto n : nettingSetDefaultValue_) {
-        string nettingSetId = n.first;
-        vector<vector<Real>> data = n.second;
-        boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
-        //only for active CSA and calcType == NoLag close-out value is relevant
-        if (netting->activeCsaFlag() && calcType_ == CollateralExposureHelper::CalculationType::NoLag) 
-            data = nettingSetCloseOutValue_[nettingSetId];
+    /* Retrieve the market data and set up all result containers up front, so that the netting sets can be processed
+       concurrently below. Each netting set is processed by one thread, which only writes to the entries of its own
+       netting set and trades. */
+    vector<string> nettingSetIds;
+    map<string, Size> nettingSetIndex;
+    for (const auto& n : nettingSetDefaultValue_) {
+        nettingSetIndex[n.first] = nettingSetIds.size();
+        nettingSetIds.push_back(n.first);
+        for (auto v : {&ee_b_, &eee_b_, &pfe_, &expectedCollateral_, &colvaInc_, &eoniaFloorInc_})
+            (*v)[n.first];
+        for (auto v : {&epe_b_, &eepe_b_, &colva_, &collateralFloor_})
+            (*v)[n.first] = 0.0;
+    }
+    vector<vector<Size>> nettingSetTrades(nettingSetIds.size());
+    cubeIndex = 0;
+    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++cubeIndex)
+        nettingSetTrades[nettingSetIndex.at(tradeIt->second->envelope().nettingSetId())].push_back(cubeIndex);
+
+    Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+    vector<Real> discounts(cube_->dates().size());
+    for (Size j = 0; j < cube_->dates().size(); ++j)
+        discounts[j] = curve->discount(cube_->dates()[j]);
+
+    vector<DayCounter> csaIndexDayCounter(nettingSetIds.size(), ActualActual(ActualActual::ISDA));
+    vector<Real> csaFxRateToday(nettingSetIds.size(), Null<Real>()), csaRateToday(nettingSetIds.size(), Null<Real>());
+    for (Size n = 0; n < nettingSetIds.size(); ++n) {
+        boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetIds[n]);
+        if (!netting->activeCsaFlag())
+            continue;
+        QL_REQUIRE(netting->csaDetails(), "active CSA for netting set " << nettingSetIds[n]
+                << ", but CSA details not initialised");
+        string csaIndexName = netting->csaDetails()->index();
+        if (csaIndexName != "") {
+            csaIndexDayCounter[n] = market_->iborIndex(csaIndexName)->dayCounter();
+            QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
+                       "scenario data does not provide index values for " << csaIndexName);
+        }
+        csaMarketData(nettingSetIds[n], csaFxRateToday[n], csaRateToday[n]);
+    }
+
+    runBlocks(nettingSetIds.size(), nThreads_, threadPool_, [&](const Size begin, const Size end) {
+        for (Size nettingSetCount = begin; nettingSetCount < end; ++nettingSetCount) {
+            const string& nettingSetId = nettingSetIds[nettingSetCount];
+            const vector<Size>& trades = nettingSetTrades[nettingSetCount];
+            boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
+            //only for active CSA and calcType == NoLag close-out value is relevant
+            const vector<vector<Real>>& data =
+                netting->activeCsaFlag() && calcType_ == CollateralExposureHelper::CalculationType::NoLag
+                    ? nettingSetCloseOutValue_.at(nettingSetId)
+                    : nettingSetDefaultValue_.at(nettingSetId);
         
-        vector<vector<Real>> nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_[nettingSetId];
-        vector<vector<Real>> nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_[nettingSetId];
-
-        LOG("Aggregate exposure for netting set " << nettingSetId);
-        // Get the collateral account balance paths for the netting set.
-        // The pointer may remain empty if there is no CSA or if it is inactive.
-        boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> collateral =
-            collateralPaths(nettingSetId,
-                            nettingSetValueToday[nettingSetId],
-                            nettingSetDefaultValue_[nettingSetId],
-                            nettingSetMaturity[nettingSetId]);
-
-	// Get the CSA index for Eonia Floor calculation below
-        colva_[nettingSetId] = 0.0;
-        collateralFloor_[nettingSetId] = 0.0;
-        string csaIndexName;
-        Handle<IborIndex> csaIndex;
-        bool applyInitialMargin = false;
-        CSA::Type initialMarginType = CSA::Bilateral;
-        if (netting->activeCsaFlag()) {
-            csaIndexName = netting->csaDetails()->index();
-            if (csaIndexName != "") {
-                csaIndex = market_->iborIndex(csaIndexName);
-                QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
-                           "scenario data does not provide index values for " << csaIndexName);
+            const vector<vector<Real>>& nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_.at(nettingSetId);
+            const vector<vector<Real>>& nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_.at(nettingSetId);
+
+            LOG("Aggregate exposure for netting set " << nettingSetId);
+            // Get the collateral account balances for the netting set by date and sample.
+            // They remain empty if there is no CSA or if it is inactive.
+            vector<vector<Real>> collateral =
+                collateralBalances(nettingSetId,
+                                nettingSetValueToday.at(nettingSetId),
+                                nettingSetDefaultValue_.at(nettingSetId),
+                                nettingSetMaturity.at(nettingSetId),
+                                csaFxRateToday[nettingSetCount], csaRateToday[nettingSetCount]);
+
+            // Get the CSA index for Eonia Floor calculation below
+            Real& colva = colva_.at(nettingSetId);
+            Real& collateralFloor = collateralFloor_.at(nettingSetId);
+            string csaIndexName;
+            bool applyInitialMargin = false;
+            CSA::Type initialMarginType = CSA::Bilateral;
+            if (netting->activeCsaFlag()) {
+                csaIndexName = netting->csaDetails()->index();
+                applyInitialMargin = netting->csaDetails()->applyInitialMargin() && applyInitialMargin_;
+                initialMarginType = netting->csaDetails()->initialMarginType();
+                LOG("ApplyInitialMargin=" << applyInitialMargin << " for netting set " << nettingSetId 
+                    << ", CSA IM=" << netting->csaDetails()->applyInitialMargin()
+                    << ", CSA IM Type=" << initialMarginType
+                    << ", Analytics DIM=" << applyInitialMargin_);
+                if (applyInitialMargin_ && !netting->csaDetails()->applyInitialMargin())
+                    ALOG("ApplyInitialMargin deactivated at netting set level " << nettingSetId);
+                if (!applyInitialMargin_ && netting->csaDetails()->applyInitialMargin())
+                    ALOG("ApplyInitialMargin deactivated in analytics, but active at netting set level "
+                         << nettingSetId);
             }
-            QL_REQUIRE(netting->csaDetails(), "active CSA for netting set " << nettingSetId
-                    << ", but CSA details not initialised");
-            applyInitialMargin = netting->csaDetails()->applyInitialMargin() && applyInitialMargin_;
-            initialMarginType = netting->csaDetails()->initialMarginType();
-            LOG("ApplyInitialMargin=" << applyInitialMargin << " for netting set " << nettingSetId 
-                << ", CSA IM=" << netting->csaDetails()->applyInitialMargin()
-                << ", CSA IM Type=" << initialMarginType
-                << ", Analytics DIM=" << applyInitialMargin_);
-            if (applyInitialMargin_ && !netting->csaDetails()->applyInitialMargin())
-                ALOG("ApplyInitialMargin deactivated at netting set level " << nettingSetId);
-            if (!applyInitialMargin_ && netting->csaDetails()->applyInitialMargin())
-                ALOG("ApplyInitialMargin deactivated in analytics, but active at netting set level " << nettingSetId);
-        }
 
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
-        vector<Real> epe(cube_->dates().size() + 1, 0.0);
-        vector<Real> ene(cube_->dates().size() + 1, 0.0);
-        vector<Real> ee_b(cube_->dates().size() + 1, 0.0);
-        vector<Real> eee_b(cube_->dates().size() + 1, 0.0);
-        vector<Real> eee_b_kva_1(cube_->dates().size() + 1, 0.0);
-        vector<Real> eee_b_kva_2(cube_->dates().size() + 1, 0.0);
-        vector<Real> eepe_b_kva_1(cube_->dates().size() + 1, 0.0);
-        vector<Real> eepe_b_kva_2(cube_->dates().size() + 1, 0.0);
-        vector<Real> eab(cube_->dates().size() + 1, 0.0);
-        vector<Real> pfe(cube_->dates().size() + 1, 0.0);
-        vector<Real> colvaInc(cube_->dates().size() + 1, 0.0);
-        vector<Real> eoniaFloorInc(cube_->dates().size() + 1, 0.0);
-        Real npv = nettingSetValueToday[nettingSetId];
-        if ((fullInitialCollateralisation_) & (netting->activeCsaFlag())) {
-            // This assumes that the collateral at t=0 is the same as the npv at t=0.
-            epe[0] = 0;
-            ene[0] = 0;
-            pfe[0] = 0;
-        } else {
-            epe[0] = std::max(npv, 0.0);
-            ene[0] = std::max(-npv, 0.0);
-            pfe[0] = std::max(npv, 0.0);
-        }
-        // The fullInitialCollateralisation flag doesn't affect the eab, which feeds into the "ExpectedCollateral"
-        // column of the 'exposure_nettingset_*' reports.  We always assume the full collateral here.
-        eab[0] = -npv;
-        ee_b[0] = epe[0];
-        eee_b[0] = ee_b[0];
-        nettedCube_->setT0(npv, nettingSetCount);
-        exposureCube_->setT0(epe[0], nettingSetCount, ExposureIndex::EPE);
-        exposureCube_->setT0(ene[0], nettingSetCount, ExposureIndex::ENE);
-
-        for (Size j = 0; j < cube_->dates().size(); ++j) {
-
-            Date date = cube_->dates()[j];
-            Date prevDate = j > 0 ? cube_->dates()[j - 1] : today;
+            vector<Real> epe(cube_->dates().size() + 1, 0.0);
+            vector<Real> ene(cube_->dates().size() + 1, 0.0);
+            vector<Real> ee_b(cube_->dates().size() + 1, 0.0);
+            vector<Real> eee_b(cube_->dates().size() + 1, 0.0);
+            vector<Real> eab(cube_->dates().size() + 1, 0.0);
+            vector<Real> pfe(cube_->dates().size() + 1, 0.0);
+            vector<Real> colvaInc(cube_->dates().size() + 1, 0.0);
+            vector<Real> eoniaFloorInc(cube_->dates().size() + 1, 0.0);
+            Real npv = nettingSetValueToday.at(nettingSetId);
+            if ((fullInitialCollateralisation_) & (netting->activeCsaFlag())) {
+                // This assumes that the collateral at t=0 is the same as the npv at t=0.
+                epe[0] = 0;
+                ene[0] = 0;
+                pfe[0] = 0;
+            } else {
+                epe[0] = std::max(npv, 0.0);
+                ene[0] = std::max(-npv, 0.0);
+                pfe[0] = std::max(npv, 0.0);
+            }
+            // The fullInitialCollateralisation flag doesn't affect the eab, which feeds into the "ExpectedCollateral"
+            // column of the 'exposure_nettingset_*' reports.  We always assume the full collateral here.
+            eab[0] = -npv;
+            ee_b[0] = epe[0];
+            eee_b[0] = ee_b[0];
+            nettedCube_->setT0(npv, nettingSetCount);
+            exposureCube_->setT0(epe[0], nettingSetCount, ExposureIndex::EPE);
+            exposureCube_->setT0(ene[0], nettingSetCount, ExposureIndex::ENE);
+
             vector<Real> distribution(cube_->samples(), 0.0);
-            for (Size k = 0; k < cube_->samples(); ++k) {
-                Real balance = 0.0;
-                if (collateral) {
-                    balance = collateral->at(k)->accountBalance(date);
-                    if (netting->csaDetails()->csaCurrency() != baseCurrency_) {
-                        // Convert from CSACurrency to baseCurrency
-                        double fxRate = scenarioData_->get(j, k, AggregationScenarioDataType::FXSpot,
-                                                           netting->csaDetails()->csaCurrency());
-                        balance *= fxRate;
+            // exposures net of initial margin, the epe and ene are computed from these
+            vector<Real> heldImExposure(cube_->samples(), 0.0), postedImExposure(cube_->samples(), 0.0);
+            // default date npvs of the netting set's trades for all samples, used in the marginal allocation
+            vector<vector<Real>> tradeDefaultNpvs(marginalAllocation_ ? trades.size() : 0);
+            for (Size j = 0; j < cube_->dates().size(); ++j) {
+
+                Date date = cube_->dates()[j];
+                Date prevDate = j > 0 ? cube_->dates()[j - 1] : today;
+                for (Size t = 0; t < tradeDefaultNpvs.size(); ++t)
+                    cubeInterpretation_->getDefaultNpvs(cube_, trades[t], j, tradeDefaultNpvs[t]);
+                for (Size k = 0; k < cube_->samples(); ++k) {
+                    Real balance = 0.0;
+                    if (!collateral.empty()) {
+                        balance = collateral[j][k];
+                        if (netting->csaDetails()->csaCurrency() != baseCurrency_) {
+                            // Convert from CSACurrency to baseCurrency
+                            double fxRate = scenarioData_->get(j, k, AggregationScenarioDataType::FXSpot,
+                                                               netting->csaDetails()->csaCurrency());
+                            balance *= fxRate;
+                        }
                     }
-                }
-                eab[j + 1] += balance / cube_->samples();
+                    eab[j + 1] += balance / cube_->samples();
                 
-                Real mporCashFlow = 0;
-                // If ActualDate is active, then the cash flows over mpor can be configured.
-                // Otherwise (StickyDate is active), it is assumed that no cash flow over mpor is paid out.
-                if (!withMporStickyDate_){
-                    if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::BothPay) // in cube generation -actual date- the (+/-) cashflows over mpor are payed out, i.e. are not part of the exposure . 
-                        mporCashFlow = 0; 
-                    else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::NonePay) // +/- cashflows is to be incorporated in the exposure
-                        mporCashFlow = (nettingSetMporPositiveFlow[j][k] + nettingSetMporNegativeFlow[j][k]);
-                    else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::WePay) // only positive cash flows (i.e. cp's cashflows) is to be incorporated in the exposure, since cp does not pay out cash flows
-                        mporCashFlow = nettingSetMporPositiveFlow[j][k];
-                    else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::TheyPay) // onyl negative cash flows (i.e. our cashflows)  is to be incorporated in the exposure,  ince we do not pay out cash flows
-                        mporCashFlow = nettingSetMporNegativeFlow[j][k];
-                }
-                Real exposure = data[j][k] - balance + mporCashFlow;
-                Real dim = 0.0;
-                if (applyInitialMargin && collateral) { // don't apply initial margin without VM, i.e. inactive CSA
-                    // Initial Margin
-                    // Use IM to reduce exposure
-                    // Size dimIndex = j == 0 ? 0 : j - 1;
-                    Size dimIndex = j;
-                    dim = dimCalculator_->dynamicIM(nettingSetId)[dimIndex][k];
-                    QL_REQUIRE(dim >= 0, "negative DIM for set " << nettingSetId << ", date " << j << ", sample " << k
-                                                                 << ": " << dim);
-                }
-                Real dim_epe = 0;
-                Real dim_ene = 0;
-                if (initialMarginType != CSA::Type::PostOnly)
-                    dim_epe = dim;
-                if (initialMarginType != CSA::Type::CallOnly)
-                    dim_ene = dim;
-                epe[j + 1] += std::max(exposure - dim_epe, 0.0) /
-                              cube_->samples(); // dim here represents the held IM, and is expressed as a positive number
-                ene[j + 1] += std::max(-exposure - dim_ene, 0.0) /
-                              cube_->samples(); // dim here represents the posted IM, and is expressed as a positive number
-                distribution[k] = exposure;
-                nettedCube_->set(exposure, nettingSetCount, j, k);
-
-                if (multiPath_) {
-                    exposureCube_->set(std::max(exposure - dim_epe, 0.0), nettingSetCount, j, k, ExposureIndex::EPE);
-                    exposureCube_->set(std::max(-exposure - dim_ene, 0.0), nettingSetCount, j, k, ExposureIndex::ENE);
-                }
+                    Real mporCashFlow = 0;
+                    // If ActualDate is active, then the cash flows over mpor can be configured.
+                    // Otherwise (StickyDate is active), it is assumed that no cash flow over mpor is paid out.
+                    if (!withMporStickyDate_){
+                        if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::BothPay) // in cube generation -actual date- the (+/-) cashflows over mpor are payed out, i.e. are not part of the exposure . 
+                            mporCashFlow = 0; 
+                        else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::NonePay) // +/- cashflows is to be incorporated in the exposure
+                            mporCashFlow = (nettingSetMporPositiveFlow[j][k] + nettingSetMporNegativeFlow[j][k]);
+                        else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::WePay) // only positive cash flows (i.e. cp's cashflows) is to be incorporated in the exposure, since cp does not pay out cash flows
+                            mporCashFlow = nettingSetMporPositiveFlow[j][k];
+                        else if (mporCashFlowMode_ == ScenarioGeneratorData::MporCashFlowMode::TheyPay) // onyl negative cash flows (i.e. our cashflows)  is to be incorporated in the exposure,  ince we do not pay out cash flows
+                            mporCashFlow = nettingSetMporNegativeFlow[j][k];
+                    }
+                    Real exposure = data[j][k] - balance + mporCashFlow;
+                    Real dim = 0.0;
+                    if (applyInitialMargin && !collateral.empty()) { // don't apply initial margin without VM, i.e. inactive CSA
+                        // Initial Margin
+                        // Use IM to reduce exposure
+                        // Size dimIndex = j == 0 ? 0 : j - 1;
+                        Size dimIndex = j;
+                        dim = dimCalculator_->dynamicIM(nettingSetId)[dimIndex][k];
+                        QL_REQUIRE(dim >= 0, "negative DIM for set " << nettingSetId << ", date " << j << ", sample " << k
+                                                                     << ": " << dim);
+                    }
+                    Real dim_epe = 0;
+                    Real dim_ene = 0;
+                    if (initialMarginType != CSA::Type::PostOnly)
+                        dim_epe = dim;
+                    if (initialMarginType != CSA::Type::CallOnly)
+                        dim_ene = dim;
+                    // dim_epe represents the held IM, dim_ene the posted IM, both are expressed as positive numbers
+                    heldImExposure[k] = exposure - dim_epe;
+                    postedImExposure[k] = exposure + dim_ene;
+                    distribution[k] = exposure;
+                    nettedCube_->set(exposure, nettingSetCount, j, k);
+
+                    if (multiPath_) {
+                        exposureCube_->set(std::max(exposure - dim_epe, 0.0), nettingSetCount, j, k, ExposureIndex::EPE);
+                        exposureCube_->set(std::max(-exposure - dim_ene, 0.0), nettingSetCount, j, k, ExposureIndex::ENE);
+                    }
 
-                if (netting->activeCsaFlag()) {
-                    Real indexValue = 0.0;
-                    DayCounter dc = ActualActual(ActualActual::ISDA);
-                    if (csaIndexName != "") {
-                        indexValue = scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
-                        dc = csaIndex->dayCounter();
+                    if (netting->activeCsaFlag()) {
+                        Real indexValue = 0.0;
+                        if (csaIndexName != "")
+                            indexValue = scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
+                        Real dcf = csaIndexDayCounter[nettingSetCount].yearFraction(prevDate, date);
+                        Real collateralSpread = (balance >= 0.0 ? netting->csaDetails()->collatSpreadRcv() : netting->csaDetails()->collatSpreadPay());
+                        Real numeraire = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
+                        Real colvaDelta = -balance * collateralSpread * dcf / numeraire / cube_->samples();
+                        // intuitive floorDelta including collateralSpread would be:
+                        // -balance * (max(indexValue - collateralSpread,0) - (indexValue - collateralSpread)) * dcf /
+                        // samples
+                        Real floorDelta = -balance * std::max(-(indexValue - collateralSpread), 0.0) * dcf / numeraire / cube_->samples();
+                        colvaInc[j + 1] += colvaDelta;
+                        colva += colvaDelta;
+                        eoniaFloorInc[j + 1] += floorDelta;
+                        collateralFloor += floorDelta;
                     }
-                    Real dcf = dc.yearFraction(prevDate, date);
-                    Real collateralSpread = (balance >= 0.0 ? netting->csaDetails()->collatSpreadRcv() : netting->csaDetails()->collatSpreadPay());
-                    Real numeraire = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                    Real colvaDelta = -balance * collateralSpread * dcf / numeraire / cube_->samples();
-                    // intuitive floorDelta including collateralSpread would be:
-                    // -balance * (max(indexValue - collateralSpread,0) - (indexValue - collateralSpread)) * dcf /
-                    // samples
-                    Real floorDelta = -balance * std::max(-(indexValue - collateralSpread), 0.0) * dcf / numeraire / cube_->samples();
-                    colvaInc[j + 1] += colvaDelta;
-                    colva_[nettingSetId] += colvaDelta;
-                    eoniaFloorInc[j + 1] += floorDelta;
-                    collateralFloor_[nettingSetId] += floorDelta;
-                }
 
-                if (marginalAllocation_) {
-                    Size i = 0;
-                    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end();
-                         ++tradeIt, ++i) {
-                        const auto& trade = tradeIt->second;
-                        string nid = trade->envelope().nettingSetId();
-                        if (nid != nettingSetId)
-                            continue;
-                        
-                        Real allocation = 0.0;
-                        if (balance == 0.0)
-                            allocation = cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
-                        // else if (data[j][k] == 0.0)
-                        else if (fabs(data[j][k]) <= marginalAllocationLimit_)
-                            allocation = exposure / nettingSetSize[nid];
-                        else
-                            allocation = exposure * cubeInterpretation_->getDefaultNpv(cube_, i, j, k) / data[j][k];
-
-                        if (multiPath_) {
-                            if (exposure > 0.0)
-                                tradeExposureCube_->set(allocation, i, j, k, allocatedEpeIndex_);
-                            else
-                                tradeExposureCube_->set(-allocation, i, j, k, allocatedEneIndex_);
-                        } else {
-                            if (exposure > 0.0)
-                                averagePositiveAllocation[i][j] += allocation / cube_->samples();
+                    if (marginalAllocation_) {
+                        for (Size t = 0; t < trades.size(); ++t) {
+                            Size i = trades[t];
+                            Real allocation = 0.0;
+                            if (balance == 0.0)
+                                allocation = tradeDefaultNpvs[t][k];
+                            // else if (data[j][k] == 0.0)
+                            else if (fabs(data[j][k]) <= marginalAllocationLimit_)
+                                allocation = exposure / trades.size();
                             else
-                                averageNegativeAllocation[i][j] -= allocation / cube_->samples();
+                                allocation = exposure * tradeDefaultNpvs[t][k] / data[j][k];
+
+                            if (multiPath_) {
+                                if (exposure > 0.0)
+                                    tradeExposureCube_->set(allocation, i, j, k, allocatedEpeIndex_);
+                                else
+                                    tradeExposureCube_->set(-allocation, i, j, k, allocatedEneIndex_);
+                            } else {
+                                if (exposure > 0.0)
+                                    averagePositiveAllocation[i][j] += allocation / cube_->samples();
+                                else
+                                    averageNegativeAllocation[i][j] -= allocation / cube_->samples();
+                            }
                         }
                     }
                 }
+                epe[j + 1] = expectedPositiveExposure(heldImExposure.data(), heldImExposure.size());
+                ene[j + 1] = expectedNegativeExposure(postedImExposure.data(), postedImExposure.size());
+                if (!multiPath_) {
+                    exposureCube_->set(epe[j + 1], nettingSetCount, j, 0, ExposureIndex::EPE);
+                    exposureCube_->set(ene[j + 1], nettingSetCount, j, 0, ExposureIndex::ENE);
+                }
+                ee_b[j + 1] = epe[j + 1] / discounts[j];
+                eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
+                pfe[j + 1] = std::max(sampleQuantile(distribution, quantile_), 0.0);
             }
-            if (!multiPath_) {
-                exposureCube_->set(epe[j + 1], nettingSetCount, j, 0, ExposureIndex::EPE);
-                exposureCube_->set(ene[j + 1], nettingSetCount, j, 0, ExposureIndex::ENE);
-            }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
-            eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
-        }
-        ee_b_[nettingSetId] = ee_b;
-        eee_b_[nettingSetId] = eee_b;
-        pfe_[nettingSetId] = pfe;
-        expectedCollateral_[nettingSetId] = eab;
-        colvaInc_[nettingSetId] = colvaInc;
-        eoniaFloorInc_[nettingSetId] = eoniaFloorInc;
-
-        nettingSetCount++;
-
-        Real epe_b = 0;
-        Real eepe_b = 0;
-
-        Size t = 0;
-        Calendar cal = WeekendsOnly();
-        Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), nettingSetMaturity[nettingSetId]);
-        QuantLib::Real maturityTime = dc.yearFraction(today, maturity);
-
-        while (t < cube_->dates().size() && times[t] <= maturityTime)
-            ++t;
-
-        if (t > 0) {
-            vector<double> weights(t);
-            weights[0] = times[0];
-            for (Size k = 1; k < t; k++)
-                weights[k] = times[k] - times[k - 1];
-            double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
-            for (Size k = 0; k < t; k++)
-                weights[k] /= totalWeights;
-
-            for (Size k = 0; k < t; k++) {
-                epe_b += ee_b[k] * weights[k];
-                eepe_b += eee_b[k] * weights[k];
+            ee_b_.at(nettingSetId) = ee_b;
+            eee_b_.at(nettingSetId) = eee_b;
+            pfe_.at(nettingSetId) = pfe;
+            expectedCollateral_.at(nettingSetId) = eab;
+            colvaInc_.at(nettingSetId) = colvaInc;
+            eoniaFloorInc_.at(nettingSetId) = eoniaFloorInc;
+
+            Real epe_b = 0;
+            Real eepe_b = 0;
+
+            Size t = 0;
+            Calendar cal = WeekendsOnly();
+            Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), nettingSetMaturity.at(nettingSetId));
+            QuantLib::Real maturityTime = dc.yearFraction(today, maturity);
+
+            while (t < cube_->dates().size() && times[t] <= maturityTime)
+                ++t;
+
+            if (t > 0) {
+                vector<double> weights(t);
+                weights[0] = times[0];
+                for (Size k = 1; k < t; k++)
+                    weights[k] = times[k] - times[k - 1];
+                double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+                for (Size k = 0; k < t; k++)
+                    weights[k] /= totalWeights;
+
+                for (Size k = 0; k < t; k++) {
+                    epe_b += ee_b[k] * weights[k];
+                    eepe_b += eee_b[k] * weights[k];
+                }
             }
+            epe_b_.at(nettingSetId) = epe_b;
+            eepe_b_.at(nettingSetId) = eepe_b;
         }
-        epe_b_[nettingSetId] = epe_b;
-        eepe_b_[nettingSetId] = eepe_b;
-    }
+    });
                 
     if (marginalAllocation_ && !multiPath_) {
         for (Size i = 0; i < portfolio_->trades().size(); ++i) {
@@ -392,24 +416,11 @@ void NettedExposureCalculator::build() {
     }
 }
 
-boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>>
-NettedExposureCalculator::collateralPaths(
-    const string& nettingSetId,
-    const Real& nettingSetValueToday,
-    const vector<vector<Real>>& nettingSetValue,
-    const Date& nettingSetMaturity) {
-
-    boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> collateral;
-
-    if (!nettingSetManager_->has(nettingSetId) || !nettingSetManager_->get(nettingSetId)->activeCsaFlag()) {
-        LOG("CSA missing or inactive for netting set " << nettingSetId);
-        return collateral;
-    }
-
-    LOG("Build collateral account balance paths for netting set " << nettingSetId);
+void NettedExposureCalculator::csaMarketData(const string& nettingSetId, Real& csaFxRateToday,
+                                             Real& csaRateToday) const {
     boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
     string csaFxPair = netting->csaDetails()->csaCurrency() + baseCurrency_;
-    Real csaFxRateToday = 1.0;
+    csaFxRateToday = 1.0;
     if (netting->csaDetails()->csaCurrency() != baseCurrency_)
         csaFxRateToday = market_->fxRate(csaFxPair, configuration_)->value();
     LOG("CSA FX rate for pair " << csaFxPair << " = " << csaFxRateToday);
@@ -421,8 +432,32 @@ NettedExposureCalculator::collateralPaths(
     if (!market_->iborIndex(csaIndexName, configuration_)->isValidFixingDate(today)) {
         today = market_->iborIndex(csaIndexName, configuration_)->fixingCalendar().adjust(today, Preceding);
     }
-    Real csaRateToday = market_->iborIndex(csaIndexName, configuration_)->fixing(today);
+    csaRateToday = market_->iborIndex(csaIndexName, configuration_)->fixing(today);
     LOG("CSA compounding rate for index " << csaIndexName << " = " << setprecision(8) << csaRateToday << " as of " << today);
+}
+
+vector<vector<Real>>
+NettedExposureCalculator::collateralBalances(
+    const string& nettingSetId,
+    const Real& nettingSetValueToday,
+    const vector<vector<Real>>& nettingSetValue,
+    const Date& nettingSetMaturity,
+    Real csaFxRateToday,
+    Real csaRateToday) {
+
+    vector<vector<Real>> collateral;
+
+    if (!nettingSetManager_->has(nettingSetId) || !nettingSetManager_->get(nettingSetId)->activeCsaFlag()) {
+        LOG("CSA missing or inactive for netting set " << nettingSetId);
+        return collateral;
+    }
+
+    LOG("Build collateral account balances for netting set " << nettingSetId);
+    boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
+    string csaFxPair = netting->csaDetails()->csaCurrency() + baseCurrency_;
+    string csaIndexName = netting->csaDetails()->index();
+    if (csaFxRateToday == Null<Real>() || csaRateToday == Null<Real>())
+        csaMarketData(nettingSetId, csaFxRateToday, csaRateToday);
 
     // Copy scenario data to keep the collateral exposure helper unchanged
     vector<vector<Real>> csaScenFxRates(cube_->dates().size(), vector<Real>(cube_->samples(), 0.0));
@@ -449,7 +484,7 @@ NettedExposureCalculator::collateralPaths(
         }
     }
 
-    collateral = CollateralExposureHelper::collateralBalancePaths(
+    collateral = CollateralExposureHelper::collateralBalances(
         netting,              // this netting set's definition
         nettingSetValueToday, // today's netting set NPV
         market_->asofDate(),  // original evaluation date
@@ -461,7 +496,7 @@ NettedExposureCalculator::collateralPaths(
         csaRateToday,         // today's collateral compounding rate in CSA currency
         csaScenRates,         // matrix of CSA ccy short rates by date and sample
         calcType_);
-    LOG("Collateral account balance paths for netting set " << nettingSetId << " done");
+    LOG("Collateral account balances for netting set " << nettingSetId << " done");
 
     return collateral;
 }
@@ -75,6 +75,13 @@ public:
     //! Compute exposures along all paths and fill result structures
     virtual void build();
 
+    /*! Process the netting sets in build() in nThreads jobs, on the given thread pool if set, otherwise in separate
+        threads. The market data is retrieved before the jobs are started. */
+    void setThreads(const Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = std::max<Size>(nThreads, 1);
+        threadPool_ = threadPool;
+    }
+
     enum ExposureIndex {
         EPE,
         ENE
@@ -143,14 +150,23 @@ protected:
     map<string, Real> collateralFloor_;
     vector<Real> getMeanExposure(const string& tid, ExposureIndex index);
 
-    boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>>
-    collateralPaths(const string& nettingSetId,
+    /*! The collateral balances of the netting set by cube date and sample, empty if the netting set has no active CSA.
+        The CSA FX rate and compounding rate as of today are retrieved from the market if not given */
+    vector<vector<Real>>
+    collateralBalances(const string& nettingSetId,
         const Real& nettingSetValueToday,
         const vector<vector<Real>>& nettingSetValue,
-        const Date& nettingSetMaturity);
+        const Date& nettingSetMaturity,
+        Real csaFxRateToday = Null<Real>(),
+        Real csaRateToday = Null<Real>());
+
+    //! The CSA FX rate to base currency and the CSA compounding rate as of today for a netting set with active CSA
+    void csaMarketData(const string& nettingSetId, Real& csaFxRateToday, Real& csaRateToday) const;
 
     bool withMporStickyDate_;
     ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode_;
+    Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 } // namespace analytics
@@ -25,6 +25,7 @@
 #include <orea/aggregation/staticcreditxvacalculator.hpp>
 #include <orea/aggregation/cvaspreadsensitivitycalculator.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
@@ -45,6 +46,8 @@
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 
+#include <algorithm>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -53,6 +56,41 @@ using namespace boost::accumulators;
 namespace ore {
 namespace analytics {
 
+namespace {
+// Sums of the running maximum of values starting at j, weighted by weights, over the windows [j, ends[j]) for all j.
+// Sweeps backwards over j, keeping the indices at which the running maximum starting at j increases on a stack, so
+// that the cost is O(n log n) instead of O(n^2).
+vector<Real> runningMaximumSums(const vector<Real>& values, const vector<Real>& weights, const vector<Size>& ends) {
+    const Size n = values.size();
+    // prefix sums of the weights
+    vector<Real> w(n + 1, 0.0);
+    for (Size k = 0; k < n; ++k)
+        w[k + 1] = w[k] + weights[k];
+    // stack of indices, increasing from top to bottom, and the cumulated contributions from the bottom, where the
+    // contribution of an entry is its value times the weights up to the next entry below it
+    vector<Size> index;
+    vector<Real> cumulated;
+    vector<Real> result(n, 0.0);
+    for (Size j = n; j > 0; --j) {
+        Size i = j - 1;
+        while (!index.empty() && values[index.back()] <= values[i]) {
+            index.pop_back();
+            cumulated.pop_back();
+        }
+        Size next = index.empty() ? n : index.back();
+        cumulated.push_back((cumulated.empty() ? 0.0 : cumulated.back()) + values[i] * (w[next] - w[i]));
+        index.push_back(i);
+        Size e = ends[i];
+        if (e <= i)
+            continue;
+        // the deepest entry before the end of the window, its contribution is truncated at the window end
+        Size p = std::partition_point(index.begin(), index.end(), [e](const Size k) { return k >= e; }) - index.begin();
+        result[i] = cumulated.back() - cumulated[p] + values[index[p]] * (w[e] - w[index[p]]);
+    }
+    return result;
+}
+} // namespace
+
 PostProcess::PostProcess(
     const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<NettingSetManager>& nettingSetManager,
     const boost::shared_ptr<Market>& market, const std::string& configuration, const boost::shared_ptr<NPVCube>& cube,
@@ -68,9 +106,11 @@ PostProcess::PostProcess(
     const boost::shared_ptr<CreditSimulationParameters>& creditSimulationParameters,
     const std::vector<Real>& creditMigrationDistributionGrid, const std::vector<Size>& creditMigrationTimeSteps,
     const Matrix& creditStateCorrelationMatrix,
-    bool withMporStickyDate, ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode)
+    bool withMporStickyDate, ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode, Size nThreads,
+    const boost::shared_ptr<ThreadPool>& threadPool, const boost::shared_ptr<NPVCube>& nettingSetCube)
     : portfolio_(portfolio), nettingSetManager_(nettingSetManager), market_(market), configuration_(configuration),
-      cube_(cube), cptyCube_(cptyCube), scenarioData_(scenarioData), analytics_(analytics), baseCurrency_(baseCurrency),
+      cube_(cube), nettingSetCube_(nettingSetCube), cptyCube_(cptyCube), scenarioData_(scenarioData),
+      analytics_(analytics), baseCurrency_(baseCurrency),
       quantile_(quantile), calcType_(parseCollateralCalculationType(calculationType)), dvaName_(dvaName),
       fvaBorrowingCurve_(fvaBorrowingCurve), fvaLendingCurve_(fvaLendingCurve), dimCalculator_(dimCalculator),
       cubeInterpretation_(cubeInterpretation), fullInitialCollateralisation_(fullInitialCollateralisation),
@@ -81,8 +121,10 @@ PostProcess::PostProcess(
       creditSimulationParameters_(creditSimulationParameters),
       creditMigrationDistributionGrid_(creditMigrationDistributionGrid),
       creditMigrationTimeSteps_(creditMigrationTimeSteps), creditStateCorrelationMatrix_(creditStateCorrelationMatrix),
-      withMporStickyDate_(withMporStickyDate), mporCashFlowMode_(mporCashFlowMode) {
+      withMporStickyDate_(withMporStickyDate), mporCashFlowMode_(mporCashFlowMode), nThreads_(nThreads),
+      threadPool_(threadPool) {
 
+    TraceSpan span("postprocess", "PostProcess");
     QL_REQUIRE(cubeInterpretation_ != nullptr, "PostProcess: cubeInterpretation is not given.");
     bool isRegularCubeStorage = !cubeInterpretation_->withCloseOutLag();
 
@@ -129,6 +171,17 @@ PostProcess::PostProcess(
 
     ExposureAllocator::AllocationMethod allocationMethod = parseAllocationMethod(allocMethod);
 
+    if (nettingSetCube_) {
+        // these require the trade values, which are not stored when they are aggregated during the valuation
+        LOG("Netting set values are provided by a netting set cube, the cube only holds the trade T0 values");
+        QL_REQUIRE(allocationMethod == ExposureAllocator::AllocationMethod::None,
+                   "PostProcess: exposure allocation requires trade level values, it is not supported with a netting "
+                   "set cube");
+        QL_REQUIRE(!analytics_["dynamicCredit"] && !analytics_["creditMigration"],
+                   "PostProcess: dynamic credit and credit migration require trade level values, they are not "
+                   "supported with a netting set cube");
+    }
+
     /***********************************************
      * Step 0: Netting as of today
      * a) Compute the netting set NPV as of today
@@ -148,7 +201,10 @@ PostProcess::PostProcess(
      */
     if (analytics_["dim"] || analytics_["mva"]) {
         QL_REQUIRE(dimCalculator_, "DIM calculator not set");
-        dimCalculator_->build();
+        {
+            TraceSpan calculatorSpan("postprocess", "DynamicInitialMarginCalculator::build");
+            dimCalculator_->build();
+        }
     }
 
     /************************************************************
@@ -163,9 +219,13 @@ PostProcess::PostProcess(
         boost::make_shared<ExposureCalculator>(
             portfolio, cube_, cubeInterpretation_,
             market_, analytics_["exerciseNextBreak"], baseCurrency_, configuration_,
-            quantile_, calcType_, analytics_["dynamicCredit"], analytics_["flipViewXVA"]
+            quantile_, calcType_, analytics_["dynamicCredit"], analytics_["flipViewXVA"], nettingSetCube_
         );
-    exposureCalculator_->build();
+    exposureCalculator_->setThreads(nThreads_, threadPool_);
+    {
+        TraceSpan calculatorSpan("postprocess", "ExposureCalculator::build");
+        exposureCalculator_->build();
+    }
 
     /******************************************************************
      * Step 3: Netting set exposure and allocation to trades
@@ -194,7 +254,11 @@ PostProcess::PostProcess(
             exposureCalculator_->exposureCube(), ExposureCalculator::allocatedEPE, ExposureCalculator::allocatedENE,
             analytics_["flipViewXVA"], withMporStickyDate_, mporCashFlowMode_
         );
-    nettedExposureCalculator_->build();
+    nettedExposureCalculator_->setThreads(nThreads_, threadPool_);
+    {
+        TraceSpan calculatorSpan("postprocess", "NettedExposureCalculator::build");
+        nettedExposureCalculator_->build();
+    }
 
     /********************************************************
      * Update Stand Alone XVAs
@@ -223,7 +287,10 @@ PostProcess::PostProcess(
             NettedExposureCalculator::ExposureIndex::ENE, analytics_["flipViewXVA"], 
             flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix);
     }
-    cvaCalculator_->build();
+    {
+        TraceSpan calculatorSpan("postprocess", "ValueAdjustmentCalculator::build");
+        cvaCalculator_->build();
+    }
 
     /***************************
      * Simple allocation methods
@@ -261,8 +328,13 @@ PostProcess::PostProcess(
             nettedExposureCalculator_->exposureCube());
     else
         QL_FAIL("allocationMethod " << allocationMethod << " not available");
-    if(exposureAllocator)
-        exposureAllocator->build();
+    if(exposureAllocator) {
+        exposureAllocator->setThreads(nThreads_, threadPool_);
+        {
+            TraceSpan calculatorSpan("postprocess", "ExposureAllocator::build");
+            exposureAllocator->build();
+        }
+    }
 
     /********************************************************
      * Update Allocated XVAs
@@ -284,7 +356,10 @@ PostProcess::PostProcess(
             NettedExposureCalculator::ExposureIndex::ENE, analytics_["flipViewXVA"], flipViewBorrowingCurvePostfix,
             flipViewLendingCurvePostfix);
     }
-    allocatedCvaCalculator_->build();
+    {
+        TraceSpan calculatorSpan("postprocess", "ValueAdjustmentCalculator::build");
+        allocatedCvaCalculator_->build();
+    }
 
     /********************************************************
      * Cache average EPE and ENE
@@ -318,7 +393,11 @@ PostProcess::PostProcess(
             portfolio_, creditSimulationParameters_, cube_, cubeInterpretation_,
             nettedExposureCalculator_->nettedCube(), scenarioData_, creditMigrationDistributionGrid_,
             creditMigrationTimeSteps_, creditStateCorrelationMatrix_, baseCurrency_);
-        creditMigrationCalculator_->build();
+        creditMigrationCalculator_->setThreads(nThreads_, threadPool_);
+        {
+            TraceSpan calculatorSpan("postprocess", "CreditMigrationCalculator::build");
+            creditMigrationCalculator_->build();
+        }
         creditMigrationUpperBucketBounds_ = creditMigrationCalculator_->upperBucketBounds();
         creditMigrationCdf_ = creditMigrationCalculator_->cdf();
         creditMigrationPdf_ = creditMigrationCalculator_->pdf();
@@ -326,6 +405,7 @@ PostProcess::PostProcess(
 }
 
 void PostProcess::updateNettingSetKVA() {
+    TraceSpan span("postprocess", "PostProcess::updateNettingSetKVA");
 
     // Loop over all netting sets
     for (const auto& [nettingSetId,pos] : nettingSetIds()) {
@@ -347,6 +427,41 @@ void PostProcess::updateNettingSetKVA() {
     Handle<YieldTermStructure> discountCurve = market_->discountCurve(baseCurrency_, configuration_);
     DayCounter dc = ActualActual(ActualActual::ISDA);
 
+    // Year fractions and discount factors of the date grid, shared by all netting sets
+    // yf[k] = yf(d_{k-1}, d_k) with d_{-1} = today, dt[k] = yf(d_k, d_{k+1}), yf0[k] = yf(today, d_{k-1})
+    vector<Real> yf(dates), dt(dates, 0.0), yf0(dates), discounts(dates);
+    for (Size k = 0; k < dates; ++k) {
+        Date prevDate = k == 0 ? today : dateVector[k - 1];
+        yf[k] = dc.yearFraction(prevDate, dateVector[k]);
+        if (k + 1 < dates)
+            dt[k] = dc.yearFraction(dateVector[k], dateVector[k + 1]);
+        yf0[k] = dc.yearFraction(today, prevDate);
+        discounts[k] = discountCurve->discount(dateVector[k]);
+    }
+
+    // For each date j the first date more than one year after j, ending the window of the effective maturity
+    // denominator, and the cut off index for the EEPE calculation: one year ahead
+    vector<Size> effMatEnd(dates), eepeEnd(dates);
+    for (Size j = 0, m = 0, kmax = 0; j < dates; ++j) {
+        m = std::max(m, j);
+        while (m < dates && dc.yearFraction(dateVector[j], dateVector[m]) <= 1.0)
+            m++;
+        effMatEnd[j] = m;
+        kmax = std::max(kmax, j);
+        while (dateVector[kmax] < dateVector[j] + 1 * Years + 4 * Days && kmax < dates - 1)
+            kmax++;
+        eepeEnd[j] = kmax;
+    }
+
+    // The market data is retrieved in the loop over the netting sets, the KVA of the netting sets is then
+    // computed in parallel
+    struct KvaParameters {
+        string nettingSetId;
+        vector<Real> epe, ene;
+        Real LGD1, LGD2, kva99PD1, kva99PD2, kvaMatAdjB1, kvaMatAdjB2;
+    };
+    vector<KvaParameters> parameters;
+
     // Loop over all netting sets
     for (const auto& [nettingSetId, pos] : nettingSetIds()) {
         string cid;
@@ -422,120 +537,119 @@ void PostProcess::updateNettingSetKVA() {
         DLOG("Their KVA-CCR " << nettingSetId << ": Floored PD99=" << kva99PD2);
         DLOG("Their KVA-CCR " << nettingSetId << ": B(PD)=" << kvaMatAdjB2);
 
-        for (Size j = 0; j < dates; ++j) {
-            Date d0 = j == 0 ? today : cube_->dates()[j - 1];
-            Date d1 = cube_->dates()[j];
+        parameters.push_back({nettingSetId, epe, ene, LGD1, LGD2, kva99PD1, kva99PD2, kvaMatAdjB1, kvaMatAdjB2});
+    }
 
-            // Preprocess:
+    runBlocks(parameters.size(), nThreads_, threadPool_, [&](const Size begin, const Size end) {
+        for (Size n = begin; n < end; ++n) {
+            const string& nettingSetId = parameters[n].nettingSetId;
+            const vector<Real>& epe = parameters[n].epe;
+            const vector<Real>& ene = parameters[n].ene;
+            const Real LGD1 = parameters[n].LGD1, LGD2 = parameters[n].LGD2;
+            const Real kva99PD1 = parameters[n].kva99PD1, kva99PD2 = parameters[n].kva99PD2;
+            const Real kvaMatAdjB1 = parameters[n].kvaMatAdjB1, kvaMatAdjB2 = parameters[n].kvaMatAdjB2;
+            Real& ourKvaCcr = ourNettingSetKVACCR_.at(nettingSetId);
+            Real& theirKvaCcr = theirNettingSetKVACCR_.at(nettingSetId);
+            Real& ourKvaCva = ourNettingSetKVACVA_.at(nettingSetId);
+            Real& theirKvaCva = theirNettingSetKVACVA_.at(nettingSetId);
+
+            // Preprocess for all dates j:
             // 1) Effective maturity from effective expected exposure as of time j
             //    Index _1 corresponds to our perspective, index _2 to their perspective.
+            //    The numerator sums the exposures more than one year after j, the denominator the effective expected
+            //    exposures starting at time j up to one year.
             // 2) Basel EEPE as of time j, i.e. as time average over EEE, starting at time j
             // More accuracy may be achieved here by using a Longstaff-Schwartz method / regression
-            Real eee_kva_1 = 0.0, eee_kva_2 = 0.0;
-            Real effMatNumer1 = 0.0, effMatNumer2 = 0.0;
-            Real effMatDenom1 = 0.0, effMatDenom2 = 0.0;
-            Real eepe_kva_1 = 0, eepe_kva_2 = 0.0;
-            Size kmax = j, count = 0;
-            // Cut off index for EEPE/EENE calculation: One year ahead
-            while (dateVector[kmax] < dateVector[j] + 1 * Years + 4 * Days && kmax < dates - 1)
-                kmax++;
-            Real sumdt = 0.0, eee1_b = 0.0, eee2_b = 0.0;
-            for (Size k = j; k < dates; ++k) {
-                Date d2 = cube_->dates()[k];
-                Date prevDate = k == 0 ? today : dateVector[k - 1];
-
-                eee_kva_1 = std::max(eee_kva_1, epe[k + 1]);
-                eee_kva_2 = std::max(eee_kva_2, ene[k + 1]);
-
-                // Components of the KVA maturity adjustment MA as of time j
-                if (dc.yearFraction(d1, d2) > 1.0) {
-                    effMatNumer1 += epe[k + 1] * dc.yearFraction(prevDate, d2);
-                    effMatNumer2 += ene[k + 1] * dc.yearFraction(prevDate, d2);
-                }
-                if (dc.yearFraction(d1, d2) <= 1.0) {
-                    effMatDenom1 += eee_kva_1 * dc.yearFraction(prevDate, d2);
-                    effMatDenom2 += eee_kva_2 * dc.yearFraction(prevDate, d2);
-                }
-
-                if (k < kmax) {
-                    Real dt = dc.yearFraction(cube_->dates()[k], cube_->dates()[k + 1]);
-                    sumdt += dt;
-                    Real epe_b = epe[k + 1] / discountCurve->discount(dateVector[k]);
-                    Real ene_b = ene[k + 1] / discountCurve->discount(dateVector[k]);
-                    eee1_b = std::max(epe_b, eee1_b);
-                    eee2_b = std::max(ene_b, eee2_b);
-                    eepe_kva_1 += eee1_b * dt;
-                    eepe_kva_2 += eee2_b * dt;
-                    count++;
-                }
+            vector<Real> epe_k(dates), ene_k(dates), epe_b(dates), ene_b(dates);
+            for (Size k = 0; k < dates; ++k) {
+                epe_k[k] = epe[k + 1];
+                ene_k[k] = ene[k + 1];
+                epe_b[k] = epe[k + 1] / discounts[k];
+                ene_b[k] = ene[k + 1] / discounts[k];
+            }
+            vector<Real> effMatDenom1 = runningMaximumSums(epe_k, yf, effMatEnd);
+            vector<Real> effMatDenom2 = runningMaximumSums(ene_k, yf, effMatEnd);
+            vector<Real> eepeSum1 = runningMaximumSums(epe_b, dt, eepeEnd);
+            vector<Real> eepeSum2 = runningMaximumSums(ene_b, dt, eepeEnd);
+            // suffix sums for the effective maturity numerators, prefix sums for the EEPE time average
+            vector<Real> effMatTail1(dates + 1, 0.0), effMatTail2(dates + 1, 0.0), sumdt(dates + 1, 0.0);
+            for (Size k = dates; k > 0; --k) {
+                effMatTail1[k - 1] = effMatTail1[k] + epe_k[k - 1] * yf[k - 1];
+                effMatTail2[k - 1] = effMatTail2[k] + ene_k[k - 1] * yf[k - 1];
+            }
+            for (Size k = 0; k < dates; ++k)
+                sumdt[k + 1] = sumdt[k] + dt[k];
+
+            for (Size j = 0; j < dates; ++j) {
+                Real effMatNumer1 = effMatTail1[effMatEnd[j]], effMatNumer2 = effMatTail2[effMatEnd[j]];
+                Size count = eepeEnd[j] - j;
+
+                // Normalize EEPE/EENE calculation
+                Real eepe_kva_1 = count > 0 ? eepeSum1[j] / (sumdt[eepeEnd[j]] - sumdt[j]) : 0.0;
+                Real eepe_kva_2 = count > 0 ? eepeSum2[j] / (sumdt[eepeEnd[j]] - sumdt[j]) : 0.0;
+
+                // KVA CCR using the IRB risk weighted asset method and IMM:
+                // KVA effective maturity of the nettingSet, capped at 5
+                Real kvaNWMaturity1 =
+                    std::min(1.0 + (effMatDenom1[j] == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1[j]), 5.0);
+                Real kvaNWMaturity2 =
+                    std::min(1.0 + (effMatDenom2[j] == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2[j]), 5.0);
+
+                // Maturity adjustment factor for the RWA method:
+                // MA(PD, M) = (1 + (M - 2.5) * B(PD)) / (1 - 1.5 * B(PD)), capped at 5, floored at 1, M = effective
+                // maturity
+                Real kvaMatAdj1 = std::max(
+                    std::min((1.0 + (kvaNWMaturity1 - 2.5) * kvaMatAdjB1) / (1.0 - 1.5 * kvaMatAdjB1), 5.0), 1.0);
+                Real kvaMatAdj2 = std::max(
+                    std::min((1.0 + (kvaNWMaturity2 - 2.5) * kvaMatAdjB2) / (1.0 - 1.5 * kvaMatAdjB2), 5.0), 1.0);
+
+                // CCR Capital: RC = EAD x LGD x PD99.9 x MA(PD, M); EAD = alpha x EEPE(t) (approximated by EPE here);
+                Real kvaRC1 = kvaAlpha_ * eepe_kva_1 * LGD1 * kva99PD1 * kvaMatAdj1;
+                Real kvaRC2 = kvaAlpha_ * eepe_kva_2 * LGD2 * kva99PD2 * kvaMatAdj2;
+
+                // Expected risk capital discounted at capital discount rate
+                Real kvaCapitalDiscount = 1 / std::pow(1 + kvaCapitalDiscountRate_, yf0[j]);
+                Real kvaCCRIncrement1 = kvaRC1 * kvaCapitalDiscount * yf[j] * kvaCapitalHurdle_ * kvaRegAdjustment_;
+                Real kvaCCRIncrement2 = kvaRC2 * kvaCapitalDiscount * yf[j] * kvaCapitalHurdle_ * kvaRegAdjustment_;
+
+                ourKvaCcr += kvaCCRIncrement1;
+                theirKvaCcr += kvaCCRIncrement2;
+
+                DLOG("Our KVA-CCR for " << nettingSetId << ": " << j << " EEPE=" << setprecision(2) << eepe_kva_1
+                                        << " EPE=" << epe[j] << " RC=" << kvaRC1 << " M=" << setprecision(6)
+                                        << kvaNWMaturity1 << " MA=" << kvaMatAdj1 << " Cost=" << setprecision(2)
+                                        << kvaCCRIncrement1 << " KVA=" << ourKvaCcr);
+                DLOG("Their KVA-CCR for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " ENE=" << ene[j]
+                                          << " RC=" << kvaRC2 << " M=" << setprecision(6) << kvaNWMaturity2
+                                          << " MA=" << kvaMatAdj2 << " Cost=" << setprecision(2) << kvaCCRIncrement2
+                                          << " KVA=" << theirKvaCcr);
+
+                // CVA Capital
+                // effective maturity without cap at 5, DF set to 1 for IMM banks
+                // TODO: Set MA in CCR capital calculation to 1
+                Real kvaCvaMaturity1 = 1.0 + (effMatDenom1[j] == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1[j]);
+                Real kvaCvaMaturity2 = 1.0 + (effMatDenom2[j] == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2[j]);
+                Real scva1 = kvaTheirCvaRiskWeight_ * kvaCvaMaturity1 * eepe_kva_1;
+                Real scva2 = kvaOurCvaRiskWeight_ * kvaCvaMaturity2 * eepe_kva_2;
+                Real kvaCVAIncrement1 = scva1 * kvaCapitalDiscount * yf[j] * kvaCapitalHurdle_ * kvaRegAdjustment_;
+                Real kvaCVAIncrement2 = scva2 * kvaCapitalDiscount * yf[j] * kvaCapitalHurdle_ * kvaRegAdjustment_;
+
+                DLOG("Our KVA-CVA for " << nettingSetId << ": " << j << " EEPE=" << eepe_kva_1 << " SCVA=" << scva1
+                                        << " Cost=" << kvaCVAIncrement1);
+                DLOG("Their KVA-CVA for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " SCVA=" << scva2
+                                          << " Cost=" << kvaCVAIncrement2);
+
+                ourKvaCva += kvaCVAIncrement1;
+                theirKvaCva += kvaCVAIncrement2;
             }
-
-            // Normalize EEPE/EENE calculation
-            eepe_kva_1 = count > 0 ? eepe_kva_1 / sumdt : 0.0;
-            eepe_kva_2 = count > 0 ? eepe_kva_2 / sumdt : 0.0;
-
-            // KVA CCR using the IRB risk weighted asset method and IMM:
-            // KVA effective maturity of the nettingSet, capped at 5
-            Real kvaNWMaturity1 = std::min(1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1), 5.0);
-            Real kvaNWMaturity2 = std::min(1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2), 5.0);
-
-            // Maturity adjustment factor for the RWA method:
-            // MA(PD, M) = (1 + (M - 2.5) * B(PD)) / (1 - 1.5 * B(PD)), capped at 5, floored at 1, M = effective
-            // maturity
-            Real kvaMatAdj1 =
-                std::max(std::min((1.0 + (kvaNWMaturity1 - 2.5) * kvaMatAdjB1) / (1.0 - 1.5 * kvaMatAdjB1), 5.0), 1.0);
-            Real kvaMatAdj2 =
-                std::max(std::min((1.0 + (kvaNWMaturity2 - 2.5) * kvaMatAdjB2) / (1.0 - 1.5 * kvaMatAdjB2), 5.0), 1.0);
-
-            // CCR Capital: RC = EAD x LGD x PD99.9 x MA(PD, M); EAD = alpha x EEPE(t) (approximated by EPE here);
-            Real kvaRC1 = kvaAlpha_ * eepe_kva_1 * LGD1 * kva99PD1 * kvaMatAdj1;
-            Real kvaRC2 = kvaAlpha_ * eepe_kva_2 * LGD2 * kva99PD2 * kvaMatAdj2;
-
-            // Expected risk capital discounted at capital discount rate
-            Real kvaCapitalDiscount = 1 / std::pow(1 + kvaCapitalDiscountRate_, dc.yearFraction(today, d0));
-            Real kvaCCRIncrement1 =
-                kvaRC1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-            Real kvaCCRIncrement2 =
-                kvaRC2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-
-            ourNettingSetKVACCR_[nettingSetId] += kvaCCRIncrement1;
-            theirNettingSetKVACCR_[nettingSetId] += kvaCCRIncrement2;
-
-            DLOG("Our KVA-CCR for " << nettingSetId << ": " << j << " EEPE=" << setprecision(2) << eepe_kva_1
-                                    << " EPE=" << epe[j] << " RC=" << kvaRC1 << " M=" << setprecision(6)
-                                    << kvaNWMaturity1 << " MA=" << kvaMatAdj1 << " Cost=" << setprecision(2)
-                                    << kvaCCRIncrement1 << " KVA=" << ourNettingSetKVACCR_[nettingSetId]);
-            DLOG("Their KVA-CCR for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " ENE=" << ene[j]
-                                      << " RC=" << kvaRC2 << " M=" << setprecision(6) << kvaNWMaturity2
-                                      << " MA=" << kvaMatAdj2 << " Cost=" << setprecision(2) << kvaCCRIncrement2
-                                      << " KVA=" << theirNettingSetKVACCR_[nettingSetId]);
-
-            // CVA Capital
-            // effective maturity without cap at 5, DF set to 1 for IMM banks
-            // TODO: Set MA in CCR capital calculation to 1
-            Real kvaCvaMaturity1 = 1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1);
-            Real kvaCvaMaturity2 = 1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2);
-            Real scva1 = kvaTheirCvaRiskWeight_ * kvaCvaMaturity1 * eepe_kva_1;
-            Real scva2 = kvaOurCvaRiskWeight_ * kvaCvaMaturity2 * eepe_kva_2;
-            Real kvaCVAIncrement1 =
-                scva1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-            Real kvaCVAIncrement2 =
-                scva2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-
-            DLOG("Our KVA-CVA for " << nettingSetId << ": " << j << " EEPE=" << eepe_kva_1 << " SCVA=" << scva1
-                                    << " Cost=" << kvaCVAIncrement1);
-            DLOG("Their KVA-CVA for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " SCVA=" << scva2
-                                      << " Cost=" << kvaCVAIncrement2);
-
-            ourNettingSetKVACVA_[nettingSetId] += kvaCVAIncrement1;
-            theirNettingSetKVACVA_[nettingSetId] += kvaCVAIncrement2;
         }
-    }
+    });
 
     LOG("Update netting set KVA done");
 }
 
 void PostProcess::updateNettingSetCvaSensitivity() {
+    TraceSpan span("postprocess", "PostProcess::updateNettingSetCvaSensitivity");
 
     if (!analytics_["cvaSensi"])
         return;
@@ -544,43 +658,52 @@ void PostProcess::updateNettingSetCvaSensitivity() {
 
     Handle<YieldTermStructure> discountCurve = market_->discountCurve(baseCurrency_, configuration_);
 
-    for (auto n : netEPE_) {
+    // the sensitivity weights only depend on the counterparty curve, so we build them once per counterparty,
+    // this also keeps the market and curve access out of the parallel part below
+
+    map<string, boost::shared_ptr<const CVASpreadSensitivityWeights>> weights;
+    vector<pair<string, boost::shared_ptr<const CVASpreadSensitivityWeights>>> nettingSets;
+    for (auto const& n : netEPE_) {
         string nettingSetId = n.first;
-        vector<Real> epe = netEPE_[nettingSetId];
         string cid;
-        Handle<DefaultProbabilityTermStructure> cvaDts;
-        Real cvaRR;
         if (analytics_["flipViewXVA"]) {
             cid = dvaName_;
         } else {
             cid = nettedExposureCalculator_->counterparty(nettingSetId);
         }
-        cvaDts = market_->defaultCurve(cid)->curve();
-        QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
-        cvaRR = market_->recoveryRate(cid, configuration_)->value();
-
-	    bool cvaSensi = analytics_["cvaSensi"];
-	    LOG("CVA Sensitivity: " << cvaSensi);
-	    if (cvaSensi) {
-	        boost::shared_ptr<CVASpreadSensitivityCalculator> cvaSensiCalculator = boost::make_shared<CVASpreadSensitivityCalculator>(
-	             nettingSetId, market_->asofDate(), epe, cube_->dates(), cvaDts, cvaRR, discountCurve, cvaSpreadSensiGrid_, cvaSpreadSensiShiftSize_);
-
-	        for (Size i = 0; i < cvaSensiCalculator->shiftTimes().size(); ++i) {
-	            DLOG("CVA Sensi Calculator: t=" << cvaSensiCalculator->shiftTimes()[i]
-		         << " h=" << cvaSensiCalculator->hazardRateSensitivities()[i] 
-		         << " s=" << cvaSensiCalculator->cdsSpreadSensitivities()[i]); 
-	        }
-
-	        netCvaHazardRateSensi_[nettingSetId] = cvaSensiCalculator->hazardRateSensitivities();
-	        netCvaSpreadSensi_[nettingSetId] = cvaSensiCalculator->cdsSpreadSensitivities();
-	        cvaSpreadSensiTimes_ = cvaSensiCalculator->shiftTimes();
-	    } else {
-	        cvaSpreadSensiTimes_ = vector<Real>();
-	        netCvaHazardRateSensi_[nettingSetId] = vector<Real>();
-	        netCvaSpreadSensi_[nettingSetId] = vector<Real>();
-	    }
+        auto w = weights.find(cid);
+        if (w == weights.end()) {
+            Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid)->curve();
+            QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
+            Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
+            w = weights
+                    .insert(make_pair(cid, boost::make_shared<CVASpreadSensitivityWeights>(
+                                               cid, market_->asofDate(), cube_->dates(), cvaDts, cvaRR, discountCurve,
+                                               cvaSpreadSensiGrid_, cvaSpreadSensiShiftSize_)))
+                    .first;
+        }
+        nettingSets.push_back(make_pair(nettingSetId, w->second));
+        netCvaHazardRateSensi_[nettingSetId] = vector<Real>();
+        netCvaSpreadSensi_[nettingSetId] = vector<Real>();
     }
 
+    runBlocks(nettingSets.size(), nThreads_, threadPool_, [&](const Size begin, const Size end) {
+        for (Size n = begin; n < end; ++n) {
+            const string& nettingSetId = nettingSets[n].first;
+            CVASpreadSensitivityCalculator cvaSensiCalculator(nettingSetId, netEPE_.at(nettingSetId),
+                                                              nettingSets[n].second);
+            for (Size i = 0; i < cvaSensiCalculator.shiftTimes().size(); ++i) {
+                DLOG("CVA Sensi Calculator: t=" << cvaSensiCalculator.shiftTimes()[i]
+                                                << " h=" << cvaSensiCalculator.hazardRateSensitivities()[i]
+                                                << " s=" << cvaSensiCalculator.cdsSpreadSensitivities()[i]);
+            }
+            netCvaHazardRateSensi_.at(nettingSetId) = cvaSensiCalculator.hazardRateSensitivities();
+            netCvaSpreadSensi_.at(nettingSetId) = cvaSensiCalculator.cdsSpreadSensitivities();
+        }
+    });
+
+    cvaSpreadSensiTimes_ = nettingSets.empty() ? vector<Real>() : nettingSets.back().second->shiftTimes();
+
     LOG("Update netting set CVA sensitivities done");
 }
   
@@ -167,7 +167,15 @@ public:
         //! If set to true, cash flows in the margin period of risk are ignored in the collateral modelling
         bool withMporStickyDate = false,
         //! Treatment of cash flows over the margin period of risk
-        ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode = ScenarioGeneratorData::MporCashFlowMode::NonePay);
+        ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode = ScenarioGeneratorData::MporCashFlowMode::NonePay,
+        //! Number of jobs the netting sets are processed in by the exposure calculators
+        Size nThreads = 1,
+        //! Thread pool to run the jobs on, if not given the jobs run on their own threads
+        const boost::shared_ptr<ThreadPool>& threadPool = nullptr,
+        /*! Netting set values aggregated during the valuation, see NettingSetAggregationCube. If given, the cube
+            above only provides the trade T0 values, the trade level exposures are zero after T0, and allocation,
+            dynamic credit and credit migration are not supported. */
+        const boost::shared_ptr<NPVCube>& nettingSetCube = nullptr);
 
     void setDimCalculator(boost::shared_ptr<DynamicInitialMarginCalculator> dimCalculator) {
         dimCalculator_ = dimCalculator;
@@ -293,6 +301,8 @@ public:
 
     //! Inspector for the input NPV cube (by trade, time, scenario)
     const boost::shared_ptr<NPVCube>& cube() { return cube_; }
+    //! Inspector for the input netting set NPV cube (by netting set, time, scenario), might be null
+    const boost::shared_ptr<NPVCube>& nettingSetCube() { return nettingSetCube_; }
     //! Inspector for the input Cpty cube (by name, time, scenario)
     const boost::shared_ptr<NPVCube>& cptyCube() { return cptyCube_; }
     //! Return the  for the input NPV cube after netting and collateral (by netting set, time, scenario)
@@ -330,6 +340,7 @@ protected:
     boost::shared_ptr<Market> market_;
     const std::string configuration_;
     boost::shared_ptr<NPVCube> cube_;
+    boost::shared_ptr<NPVCube> nettingSetCube_;
     boost::shared_ptr<NPVCube> cptyCube_;
     boost::shared_ptr<AggregationScenarioData> scenarioData_;
     map<string, bool> analytics_;
@@ -378,6 +389,8 @@ protected:
     std::vector<std::vector<Real>> creditMigrationPdf_;
     bool withMporStickyDate_;
     ScenarioGeneratorData::MporCashFlowMode mporCashFlowMode_;
+    Size nThreads_;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 } // namespace analytics
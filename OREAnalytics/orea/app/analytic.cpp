@@ -17,6 +17,7 @@
 */
 
 #include <orea/app/analytic.hpp>
+#include <orea/app/reportsink.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/engine/bufferedsensitivitystream.hpp>
@@ -29,12 +30,16 @@
 #include <orea/engine/valuationengine.hpp>
 #include <orea/aggregation/dimregressioncalculator.hpp>
 
+#include <ored/marketdata/calibratedcurvecache.hpp>
+#include <ored/marketdata/inmemoryloader.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/portfolio/builders/currencyswap.hpp>
 #include <ored/portfolio/builders/fxoption.hpp>
 #include <ored/portfolio/builders/multilegoption.hpp>
 #include <ored/portfolio/builders/swaption.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
+#include <ored/utilities/tracing.hpp>
 
 #include <boost/timer/timer.hpp>
 
@@ -80,8 +85,12 @@ Analytic::Analytic(std::unique_ptr<Impl> impl,
 
 void Analytic::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoader>& loader,
                          const std::set<std::string>& runTypes) {
-    if (impl_)
+    if (impl_) {
+        TraceSpan span("analytic", "Analytic::runAnalytic");
+        span.arg("label", label());
         impl_->runAnalytic(loader, runTypes);
+        recordMemory(label() + "/run");
+    }
 }
 
 void Analytic::setUpConfigurations() {
@@ -103,6 +112,16 @@ const std::string Analytic::label() const {
     return impl_ ? impl_->label() : string(); 
 }
 
+boost::shared_ptr<ore::data::Report> Analytic::report(const std::string& type, const std::string& name) {
+    if (writeIntermediateReports_ && inputs_ && inputs_->reportSinkFactory()) {
+        if (auto sink = inputs_->reportSinkFactory()->sink(type, name))
+            return sink;
+    }
+    auto report = boost::make_shared<ore::data::InMemoryReport>();
+    reports_[type][name] = report;
+    return report;
+}
+
 // Analytic
 bool Analytic::match(const std::set<std::string>& runTypes) {
     if (runTypes.size() == 0)
@@ -151,6 +170,8 @@ boost::shared_ptr<EngineFactory> Analytic::Impl::engineFactory() {
 void Analytic::buildMarket(const boost::shared_ptr<ore::data::InMemoryLoader>& loader,
                            const bool marketRequired) {
     LOG("Analytic::buildMarket called");    
+    TraceSpan span("analytic", "Analytic::buildMarket");
+    span.arg("label", label());
     cpu_timer mtimer;
 
     QL_REQUIRE(loader, "market data loader not set");
@@ -164,11 +185,21 @@ void Analytic::buildMarket(const boost::shared_ptr<ore::data::InMemoryLoader>& l
             // Check that the loader has quotes
             QL_REQUIRE( loader_->hasQuotes(inputs()->asof()),
                        "There are no quotes available for date " << inputs()->asof());
+            // Reuse the curves calibrated in previous runs with unchanged inputs
+            CalibratedCurveCache& curveCache = CalibratedCurveCache::instance();
+            if (!inputs()->calibratedCurveCacheFile().empty()) {
+                curveCache.setEnabled(true);
+                if (curveCache.size() == 0)
+                    curveCache.load(inputs()->calibratedCurveCacheFile());
+            }
             // Build the market
             market_ = boost::make_shared<TodaysMarket>(inputs()->asof(), configurations().todaysMarketParams, loader_,
                                                        configurations().curveConfig, inputs()->continueOnError(),
                                                        true, inputs()->lazyMarketBuilding(), inputs()->refDataManager(),
-                                                       false, *inputs()->iborFallbackConfig());
+                                                       false, *inputs()->iborFallbackConfig(), true, true,
+                                                       inputs()->parallelMarketBuilding() ? inputs()->nThreads() : 1);
+            if (!inputs()->calibratedCurveCacheFile().empty())
+                curveCache.save(inputs()->calibratedCurveCacheFile());
             // Note: we usually wrap the market into a PC market, but skip this step here
         } catch (const std::exception& e) {
             if (marketRequired)
@@ -181,6 +212,7 @@ void Analytic::buildMarket(const boost::shared_ptr<ore::data::InMemoryLoader>& l
     }
     mtimer.stop();
     LOG("Market Build time " << setprecision(2) << mtimer.format(default_places, "%w") << " sec");
+    recordMemory(label() + "/market");
 }
 
 void Analytic::marketCalibration(const boost::shared_ptr<MarketCalibrationReportBase>& mcr) {
@@ -189,6 +221,8 @@ void Analytic::marketCalibration(const boost::shared_ptr<MarketCalibrationReport
 }
 
 void Analytic::buildPortfolio() {
+    TraceSpan span("analytic", "Analytic::buildPortfolio");
+    span.arg("label", label());
     QuantLib::ext::shared_ptr<Portfolio> tmp = portfolio_ ? portfolio_ : inputs()->portfolio();
         
     // create a new empty portfolio
@@ -205,7 +239,10 @@ void Analytic::buildPortfolio() {
 
         LOG("Build the portfolio");
         boost::shared_ptr<EngineFactory> factory = impl()->engineFactory();
-        portfolio()->build(factory, "analytic/" + label());
+        // a lazily built market can not be read by several threads
+        Size nThreads =
+            inputs()->parallelPortfolioBuilding() && !inputs()->lazyMarketBuilding() ? inputs()->nThreads() : 1;
+        portfolio()->build(factory, "analytic/" + label(), true, nThreads);
 
         // remove dates that will have matured
         Date maturityDate = inputs()->asof();
@@ -214,11 +251,27 @@ void Analytic::buildPortfolio() {
 
         LOG("Filter trades that expire before " << maturityDate);
         portfolio()->removeMatured(maturityDate);
+        recordMemory(label() + "/portfolio");
     } else {
         ALOG("Skip building the portfolio, because market not set");
     }
 }
 
+void Analytic::recordMemory(const std::string& phase) {
+    MemoryAccounting& accounting = MemoryAccounting::instance();
+    if (!accounting.enabled())
+        return;
+    if (auto l = boost::dynamic_pointer_cast<InMemoryLoader>(loader_))
+        accounting.record(phase, "Loader", "InMemoryLoader", l->numberOfQuotes(), l->memoryFootprint());
+    if (auto m = boost::dynamic_pointer_cast<TodaysMarket>(market_))
+        accounting.record(phase, "Market", "TodaysMarket", m->numberOfBuiltObjects(), m->memoryFootprint());
+    if (portfolio_)
+        accounting.record(phase, "Portfolio", "Portfolio", portfolio_->size(), portfolio_->memoryFootprint());
+    if (impl_)
+        impl_->recordMemory(phase);
+    accounting.recordProcess(phase);
+}
+
 /*******************************************************************
  * MARKET Analytic
  *******************************************************************/
@@ -232,7 +285,7 @@ void MarketDataAnalyticImpl::runAnalytic(
     const std::set<std::string>& runTypes) {
 
     Settings::instance().evaluationDate() = inputs_->asof();
-    ObservationMode::instance().setMode(inputs_->observationModel());
+    ObservationMode::instance().setMode(inputs_->observationModel(), ObservationMode::Mode::None);
 
     CONSOLEW("Build Market");
     analytic()->buildMarket(loader);
@@ -106,6 +106,9 @@ public:
     virtual void marketCalibration(const boost::shared_ptr<MarketCalibrationReportBase>& mcr = nullptr);
     virtual void modifyPortfolio() {}
     virtual void replaceTrades() {}
+    /*! Record the memory footprint of the loader, market, portfolio and the objects held by the implementation at the
+        end of the given phase, a no-op unless the ore::data::MemoryAccounting is enabled */
+    void recordMemory(const std::string& phase);
 
     //! Inspectors
     const std::string label() const;
@@ -130,6 +133,10 @@ public:
     analytic_mktcubes& mktCubes() { return mktCubes_; };
     const bool getWriteIntermediateReports() const { return writeIntermediateReports_; }
     void setWriteIntermediateReports(const bool flag) { writeIntermediateReports_ = flag; }
+    /*! Return the report to write the report \p name of the analytic type \p type to. This is the sink provided by
+        the report sink factory of the inputs, if any, or a new InMemoryReport stored in reports() otherwise. Reports
+        of analytics that do not write intermediate reports are always kept in memory. */
+    boost::shared_ptr<ore::data::Report> report(const std::string& type, const std::string& name);
 
     //! Check whether any of the requested run types is covered by this analytic
     bool match(const std::set<std::string>& runTypes);
@@ -188,6 +195,9 @@ public:
     //! build an engine factory
     virtual boost::shared_ptr<ore::data::EngineFactory> engineFactory();
 
+    //! record the memory footprint of the objects held by the implementation, see Analytic::recordMemory()
+    virtual void recordMemory(const std::string& phase) {}
+
     void setLabel(const string& label) { label_ = label; }
     const std::string& label() const { return label_; };
 
@@ -89,10 +89,22 @@ void ParConversionAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::I
             configs.todaysMarketParams, nullptr, inputs_->marketConfig("pricing"), true, false,
             *inputs_->iborFallbackConfig());
 
+        if (inputs_->nThreads() > 1) {
+            parAnalysis->setParallel(inputs_->nThreads(), [this]() {
+                auto& configs = analytic()->configurations();
+                return buildScenarioSimMarketForSensitivityAnalysis(
+                    analytic()->market(), configs.simMarketParams, configs.sensiScenarioData, configs.curveConfig,
+                    configs.todaysMarketParams, nullptr, inputs_->marketConfig("pricing"), true, false,
+                    *inputs_->iborFallbackConfig());
+            });
+            parAnalysis->setThreadPool(inputs_->threadPool());
+        }
+
         parAnalysis->computeParInstrumentSensitivities(simMarket);
 
         boost::shared_ptr<ParSensitivityConverter> parConverter =
-            boost::make_shared<ParSensitivityConverter>(parAnalysis->parSensitivities(), parAnalysis->shiftSizes());
+            boost::make_shared<ParSensitivityConverter>(parAnalysis->parSensitivities(), parAnalysis->shiftSizes(),
+                                                        inputs_->parConversionJacobiCacheDirectory());
 
         map<RiskFactorKey, Size> factorToIndex;
 
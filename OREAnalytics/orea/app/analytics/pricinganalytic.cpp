@@ -22,6 +22,7 @@
 #include <orea/engine/parsensitivityanalysis.hpp>
 #include <orea/engine/parsensitivitycubestream.hpp>
 #include <orea/engine/sensitivityanalysisplus.hpp>
+#include <orea/engine/sensitivitybasedstresstest.hpp>
 #include <orea/engine/stresstest.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 
@@ -54,7 +55,7 @@ void PricingAnalyticImpl::runAnalytic(
     const std::set<std::string>& runTypes) {
 
     Settings::instance().evaluationDate() = inputs_->asof();
-    ObservationMode::instance().setMode(inputs_->observationModel());
+    ObservationMode::instance().setMode(inputs_->observationModel(), ObservationMode::Mode::None);
 
     QL_REQUIRE(inputs_->portfolio(), "PricingAnalytic::run: No portfolio loaded.");
 
@@ -78,6 +79,10 @@ void PricingAnalyticImpl::runAnalytic(
     // e.g. to apply SIMM exemptions.
     analytic()->modifyPortfolio();
 
+    // a lazily built market can not be read by several threads
+    Size cashflowThreads =
+        inputs_->parallelCashflowReport() && !inputs_->lazyMarketBuilding() ? inputs_->nThreads() : 1;
+
     for (const auto& type : analytic()->analyticTypes()) {
         boost::shared_ptr<InMemoryReport> report = boost::make_shared<InMemoryReport>();
         InMemoryReport tmpReport;
@@ -90,9 +95,8 @@ void PricingAnalyticImpl::runAnalytic(
         if (type == "NPV") {
             CONSOLEW("Pricing: NPV Report");
             ReportWriter(inputs_->reportNaString())
-                .writeNpv(*report, effectiveResultCurrency, analytic()->market(), "",
+                .writeNpv(*analytic()->report(type, "npv"), effectiveResultCurrency, analytic()->market(), "",
                           analytic()->portfolio());
-            analytic()->reports()[type]["npv"] = report;
             CONSOLE("OK");
             if (inputs_->outputAdditionalResults()) {
                 CONSOLEW("Pricing: Additional Results");
@@ -120,10 +124,9 @@ void PricingAnalyticImpl::runAnalytic(
             CONSOLEW("Pricing: Cashflow Report");
             string marketConfig = inputs_->marketConfig("pricing");
             ReportWriter(inputs_->reportNaString())
-                .writeCashflow(*report, effectiveResultCurrency, analytic()->portfolio(),
+                .writeCashflow(*analytic()->report(type, "cashflow"), effectiveResultCurrency, analytic()->portfolio(),
                                analytic()->market(),
-                               marketConfig, inputs_->includePastCashflows());
-            analytic()->reports()[type]["cashflow"] = report;
+                               marketConfig, inputs_->includePastCashflows(), cashflowThreads);
             CONSOLE("OK");
         }
         else if (type == "CASHFLOWNPV") {
@@ -132,7 +135,7 @@ void PricingAnalyticImpl::runAnalytic(
             ReportWriter(inputs_->reportNaString())
                 .writeCashflow(tmpReport, effectiveResultCurrency, analytic()->portfolio(),
                                analytic()->market(),
-                               marketConfig, inputs_->includePastCashflows());
+                               marketConfig, inputs_->includePastCashflows(), cashflowThreads);
             ReportWriter(inputs_->reportNaString())
                 .writeCashflowNpv(*report, tmpReport, analytic()->market(), marketConfig,
                                   effectiveResultCurrency, inputs_->cashflowHorizon());
@@ -146,13 +149,50 @@ void PricingAnalyticImpl::runAnalytic(
             std::string marketConfig = inputs_->marketConfig("pricing");
             std::vector<boost::shared_ptr<ore::data::EngineBuilder>> extraEngineBuilders;
             std::vector<boost::shared_ptr<ore::data::LegBuilder>> extraLegBuilders;
-            boost::shared_ptr<StressTest> stressTest = boost::make_shared<StressTest>(
-                analytic()->portfolio(), analytic()->market(), marketConfig, inputs_->pricingEngine(),
-                inputs_->stressSimMarketParams(), inputs_->stressScenarioData(),
-                *analytic()->configurations().curveConfig, *analytic()->configurations().todaysMarketParams, nullptr,
-                inputs_->refDataManager(), *inputs_->iborFallbackConfig(),
-                inputs_->continueOnError());
-            stressTest->writeReport(report, inputs_->stressThreshold());
+            auto fullStressTest = [this, &marketConfig, &loader](const boost::shared_ptr<Portfolio>& portfolio) {
+                // with several threads the stress scenarios are distributed over the threads
+                if (inputs_->nThreads() > 1)
+                    return boost::make_shared<StressTest>(
+                        inputs_->nThreads(), loader, portfolio, analytic()->market(), inputs_->pricingEngine(),
+                        inputs_->stressSimMarketParams(), inputs_->stressScenarioData(),
+                        analytic()->configurations().curveConfig, analytic()->configurations().todaysMarketParams,
+                        nullptr, inputs_->refDataManager(), *inputs_->iborFallbackConfig(),
+                        inputs_->continueOnError(), inputs_->incrementalValuation(), inputs_->threadPool(),
+                        inputs_->shareTodaysMarket());
+                return boost::make_shared<StressTest>(
+                    portfolio, analytic()->market(), marketConfig, inputs_->pricingEngine(),
+                    inputs_->stressSimMarketParams(), inputs_->stressScenarioData(),
+                    *analytic()->configurations().curveConfig, *analytic()->configurations().todaysMarketParams,
+                    nullptr, inputs_->refDataManager(), *inputs_->iborFallbackConfig(), inputs_->continueOnError(),
+                    inputs_->incrementalValuation());
+            };
+            if (inputs_->stressSensitivityBased()) {
+                QL_REQUIRE(inputs_->stressSensiScenarioData(),
+                           "sensitivity based stress test requires sensitivity scenario data");
+                LOG("Stress Test Analysis - compute sensitivities for the sensitivity based stress test");
+                auto sensiAnalysis = boost::make_shared<SensitivityAnalysis>(
+                    analytic()->portfolio(), analytic()->market(), marketConfig, inputs_->pricingEngine(),
+                    inputs_->stressSimMarketParams(), inputs_->stressSensiScenarioData(), true,
+                    analytic()->configurations().curveConfig, analytic()->configurations().todaysMarketParams, false,
+                    inputs_->refDataManager(), *inputs_->iborFallbackConfig(), inputs_->continueOnError());
+                sensiAnalysis->setIncrementalValuation(inputs_->incrementalValuation());
+                sensiAnalysis->generateSensitivities();
+                auto sensiStressTest = boost::make_shared<SensitivityBasedStressTest>(
+                    sensiAnalysis->sensiCube(), sensiAnalysis->sensitivityData(), sensiAnalysis->simMarket(),
+                    inputs_->stressSimMarketParams(), inputs_->stressScenarioData(),
+                    inputs_->stressSensitivityErrorThreshold());
+                if (!sensiStressTest->fullRevaluationTrades().empty()) {
+                    LOG("Stress Test Analysis - full revaluation of "
+                        << sensiStressTest->fullRevaluationTrades().size() << " trades");
+                    auto portfolio = boost::make_shared<Portfolio>();
+                    for (auto const& id : sensiStressTest->fullRevaluationTrades())
+                        portfolio->add(analytic()->portfolio()->trades().at(id));
+                    sensiStressTest->setFullRevaluationResults(*fullStressTest(portfolio));
+                }
+                sensiStressTest->writeReport(report, inputs_->stressThreshold());
+            } else {
+                fullStressTest(analytic()->portfolio())->writeReport(report, inputs_->stressThreshold());
+            }
             analytic()->reports()[type]["stress"] = report;
             CONSOLE("OK");
         }
@@ -182,13 +222,18 @@ void PricingAnalyticImpl::runAnalytic(
                     extraTradeBuilders = {};
                 std::function<std::vector<boost::shared_ptr<ore::data::EngineBuilder>>()> extraEngineBuilders = {};
                 std::function<std::vector<boost::shared_ptr<ore::data::LegBuilder>>()> extraLegBuilders = {};
-                sensiAnalysis = boost::make_shared<SensitivityAnalysisPlus>(
+                auto sensiAnalysisPlus = boost::make_shared<SensitivityAnalysisPlus>(
                     inputs_->nThreads(), inputs_->asof(), loader, analytic()->portfolio(),
                     Market::defaultConfiguration, inputs_->pricingEngine(),
                     analytic()->configurations().simMarketParams, analytic()->configurations().sensiScenarioData, 
                     recalibrateModels, analytic()->configurations().curveConfig,
                     analytic()->configurations().todaysMarketParams, ccyConv, inputs_->refDataManager(),
                     *inputs_->iborFallbackConfig(), true, inputs_->dryRun());
+                sensiAnalysisPlus->setThreadPool(inputs_->threadPool());
+                sensiAnalysisPlus->setScenarioParallel(inputs_->sampleParallel());
+                sensiAnalysisPlus->setShareTodaysMarket(inputs_->shareTodaysMarket());
+                sensiAnalysisPlus->setThreadPlacement(inputs_->threadPlacement());
+                sensiAnalysis = sensiAnalysisPlus;
                 LOG("Multi-threaded sensi analysis created");
             }
             // FIXME: Why are these disabled?
@@ -208,6 +253,9 @@ void PricingAnalyticImpl::runAnalytic(
                 }
             }
 
+            sensiAnalysis->setIncrementalValuation(inputs_->incrementalValuation());
+            sensiAnalysis->setAnalyticDeltas(inputs_->analyticDeltas(), inputs_->validateAnalyticDeltas());
+
             LOG("Sensi analysis - generate");
             sensiAnalysis->registerProgressIndicator(boost::make_shared<ProgressLog>("sensitivities", 100, ORE_NOTICE));
             sensiAnalysis->generateSensitivities();
@@ -216,30 +264,46 @@ void PricingAnalyticImpl::runAnalytic(
             auto baseCurrency = sensiAnalysis->simMarketData()->baseCcy();
             auto ss = boost::make_shared<SensitivityCubeStream>(sensiAnalysis->sensiCube(), baseCurrency);
             ReportWriter(inputs_->reportNaString())
-                .writeSensitivityReport(*report, ss, inputs_->sensiThreshold());
-            analytic()->reports()[type]["sensitivity"] = report;
+                .writeSensitivityReport(*analytic()->report(type, "sensitivity"), ss, inputs_->sensiThreshold());
 
             LOG("Sensi analysis - write sensitivity scenario report in memory");
-            boost::shared_ptr<InMemoryReport> scenarioReport = boost::make_shared<InMemoryReport>();
             ReportWriter(inputs_->reportNaString())
-                .writeScenarioReport(*scenarioReport, sensiAnalysis->sensiCube(),
+                .writeScenarioReport(*analytic()->report(type, "sensitivity_scenario"), sensiAnalysis->sensiCube(),
                                      inputs_->sensiThreshold());
-            analytic()->reports()[type]["sensitivity_scenario"] = scenarioReport;
+
+            if (!sensiAnalysis->skippedCrossGammaPairs().empty()) {
+                LOG("Sensi analysis - write skipped cross gamma report in memory");
+                boost::shared_ptr<InMemoryReport> skippedReport = boost::make_shared<InMemoryReport>();
+                ReportWriter(inputs_->reportNaString())
+                    .writeSkippedCrossGammaReport(*skippedReport, sensiAnalysis->skippedCrossGammaPairs());
+                analytic()->reports()[type]["crossgamma_skipped"] = skippedReport;
+            }
 
             if (inputs_->parSensi()) {
                 LOG("Sensi analysis - par conversion");
+                if (inputs_->nThreads() > 1) {
+                    std::string simMarketConfiguration = sensiAnalysis->marketConfiguration();
+                    parAnalysis->setParallel(inputs_->nThreads(), [this, simMarketConfiguration]() {
+                        auto& configs = analytic()->configurations();
+                        return buildScenarioSimMarketForSensitivityAnalysis(
+                            analytic()->market(), configs.simMarketParams, configs.sensiScenarioData,
+                            configs.curveConfig, configs.todaysMarketParams, nullptr, simMarketConfiguration, true,
+                            inputs_->alignPillars(), *inputs_->iborFallbackConfig());
+                    });
+                    parAnalysis->setThreadPool(inputs_->threadPool());
+                }
                 parAnalysis->computeParInstrumentSensitivities(sensiAnalysis->simMarket());
                 boost::shared_ptr<ParSensitivityConverter> parConverter =
-                    boost::make_shared<ParSensitivityConverter>(parAnalysis->parSensitivities(), parAnalysis->shiftSizes());
+                    boost::make_shared<ParSensitivityConverter>(parAnalysis->parSensitivities(), parAnalysis->shiftSizes(),
+                                                                inputs_->jacobiCacheDirectory());
                 auto parCube = boost::make_shared<ZeroToParCube>(sensiAnalysis->sensiCube(), parConverter, typesDisabled, true);
                 LOG("Sensi analysis - write par sensitivity report in memory");
                 boost::shared_ptr<ParSensitivityCubeStream> pss = boost::make_shared<ParSensitivityCubeStream>(parCube, baseCurrency);
                 // If the stream is going to be reused - wrap it into a buffered stream to gain some
                 // performance. The cost for this is the memory footpring of the buffer.
-                boost::shared_ptr<InMemoryReport> parSensiReport = boost::make_shared<InMemoryReport>();
                 ReportWriter(inputs_->reportNaString())
-                    .writeSensitivityReport(*parSensiReport, pss, inputs_->sensiThreshold());
-                analytic()->reports()[type]["par_sensitivity"] = parSensiReport;
+                    .writeSensitivityReport(*analytic()->report(type, "par_sensitivity"), pss,
+                                            inputs_->sensiThreshold());
 
                 if (inputs_->outputJacobi()) {
                     boost::shared_ptr<InMemoryReport> jacobiReport = boost::make_shared<InMemoryReport>();
@@ -72,7 +72,10 @@ void SimmAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLo
                                                    inputs_->simmResultCurrency(),
                                                    analytic()->market(),
                                                    simmAnalytic->determineWinningRegulations(),
-                                                   inputs_->enforceIMRegulations());
+                                                   inputs_->enforceIMRegulations(),
+                                                   false,
+                                                   inputs_->nThreads(),
+                                                   inputs_->threadPool());
 
     Real fxSpot = 1.0;
     if (!inputs_->simmReportingCurrency().empty()) {
@@ -41,7 +41,7 @@ void VarAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
     LOG("Running parametric VaR");
 
     Settings::instance().evaluationDate() = inputs_->asof();
-    ObservationMode::instance().setMode(inputs_->observationModel());
+    ObservationMode::instance().setMode(inputs_->observationModel(), ObservationMode::Mode::None);
 
     LOG("VAR: Build Market");
     CONSOLEW("Risk: Build Market for VaR");
@@ -66,6 +66,7 @@ void VarAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
     auto calc = boost::make_shared<ParametricVarReport>(tradePortfolio, inputs_->portfolioFilter(), 
         inputs_->sensitivityStream(), inputs_->covarianceData(), inputs_->varQuantiles(), 
         varParams, inputs_->varBreakDown(), inputs_->salvageCovariance());
+    calc->setThreads(inputs_->nThreads(), inputs_->threadPool());
 
     boost::shared_ptr<InMemoryReport> report = boost::make_shared<InMemoryReport>();
     analytic()->reports()["VAR"]["var"] = report;
@@ -17,20 +17,35 @@
 */
 
 #include <orea/aggregation/dimregressioncalculator.hpp>
+#include <orea/aggregation/dimsimmcalculator.hpp>
 #include <orea/app/analytics/xvaanalytic.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
+#include <orea/cube/filemappedcube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
+#include <orea/cube/nettingsetaggregationcube.hpp>
+#include <orea/cube/quantisedcube.hpp>
+#include <orea/cube/samplesubsetcube.hpp>
+#include <orea/cube/truncatedcube.hpp>
 #include <orea/engine/amcvaluationengine.hpp>
+#include <orea/engine/exposureconvergencemonitor.hpp>
 #include <orea/engine/mporcalculator.hpp>
 #include <orea/engine/multistatenpvcalculator.hpp>
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/pricingcostprofile.hpp>
+#include <orea/engine/vanillaoptionbatchcalculator.hpp>
+#include <orea/scenario/riskfactorpruning.hpp>
 #include <orea/scenario/scenariowriter.hpp>
-#include <orea/scenario/simplescenariofactory.hpp>
+#include <orea/scenario/compactscenariofactory.hpp>
+#include <orea/scenario/scenariocache.hpp>
+#include <orea/simm/simmbucketmapperbase.hpp>
+#include <orea/simm/utilities.hpp>
 
 #include <ored/model/crossassetmodelbuilder.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 
 using namespace ore::data;
 using namespace boost::filesystem;
@@ -84,6 +99,22 @@ void  XvaAnalyticImpl::checkConfigurations(const boost::shared_ptr<Portfolio>& p
     }
 }
 
+void XvaAnalyticImpl::recordMemory(const std::string& phase) {
+    MemoryAccounting& accounting = MemoryAccounting::instance();
+    auto recordCube = [&accounting, &phase](const std::string& name, const boost::shared_ptr<NPVCube>& cube) {
+        if (cube)
+            accounting.record(phase, "Cube", name, cube->numIds() * cube->numDates() * cube->samples() * cube->depth(),
+                              cube->memoryFootprint());
+    };
+    recordCube("npv", cube_);
+    recordCube("nettingSet", nettingSetCube_);
+    recordCube("counterparty", cptyCube_);
+    recordCube("amc", amcCube_);
+    if (!scenarioData_.empty())
+        accounting.record(phase, "AggregationScenarioData", "scenarioData",
+                          scenarioData_->dimDates() * scenarioData_->dimSamples(), scenarioData_->memoryFootprint());
+}
+
 boost::shared_ptr<EngineFactory> XvaAnalyticImpl::engineFactory() {
     LOG("XvaAnalytic::engineFactory() called");
     boost::shared_ptr<EngineData> edCopy = boost::make_shared<EngineData>(*inputs_->simulationPricingEngine());
@@ -130,8 +161,11 @@ void XvaAnalyticImpl::buildScenarioSimMarket() {
 void XvaAnalyticImpl::buildScenarioGenerator(const bool continueOnCalibrationError) {
     if (!model_)
         buildCrossAssetModel(continueOnCalibrationError);
-    ScenarioGeneratorBuilder sgb(analytic()->configurations().scenarioGeneratorData);
-    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<SimpleScenarioFactory>();
+    if (inputs_->cacheScenarios())
+        ScenarioCache::instance().setSpillDirectory(inputs_->scenarioCacheDirectory());
+    ScenarioGeneratorBuilder sgb(analytic()->configurations().scenarioGeneratorData, inputs_->cacheScenarios());
+    // the key table of the compact scenarios is set by the cross asset model scenario generator
+    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<CompactScenarioFactory>();
     string config = inputs_->marketConfig("simulation");
     scenarioGenerator_ = sgb.build(model_, sf, analytic()->configurations().simMarketParams, inputs_->asof(), analytic()->market(), config); 
     QL_REQUIRE(scenarioGenerator_, "failed to build the scenario generator"); 
@@ -157,7 +191,8 @@ void XvaAnalyticImpl::buildCrossAssetModel(const bool continueOnCalibrationError
         inputs_->marketConfig("fxcalibration"), inputs_->marketConfig("eqcalibration"),
         inputs_->marketConfig("infcalibration"), inputs_->marketConfig("crcalibration"),
         inputs_->marketConfig("simulation"), false, continueOnCalibrationError, "",
-        inputs_->salvageCorrelationMatrix() ? SalvagingAlgorithm::Spectral : SalvagingAlgorithm::None);
+        inputs_->salvageCorrelationMatrix() ? SalvagingAlgorithm::Spectral : SalvagingAlgorithm::None,
+        inputs_->lazyMarketBuilding() ? 1 : inputs_->nThreads());
     model_ = *modelBuilder.model();
 }
 
@@ -202,8 +237,31 @@ void XvaAnalyticImpl::initClassicRun(const boost::shared_ptr<Portfolio>& portfol
 
     // We can skip the cube initialization if the mt val engine is used, since it builds its own cubes
     if (inputs_->nThreads() == 1) {
-        if (portfolio->size() > 0)
-            initCube(cube_, portfolio->ids(), cubeDepth_);
+        if (portfolio->size() > 0) {
+            if (streamingExposure_) {
+                // only the netting set values are stored, they are aggregated while the trades are priced
+                LOG("XVA: Init netting set aggregation cube");
+                cube_ = boost::make_shared<NettingSetAggregationCube>(
+                    inputs_->asof(), portfolio, grid_->valuationDates(), samples_, cubeDepth_, subtractedTrades_);
+            } else if (!inputs_->mappedCubeFile().empty()) {
+                // the cube is written to the file directly and can be reloaded from it by loadCube()
+                LOG("XVA: Init cube mapped to file " << inputs_->mappedCubeFile());
+                cube_ = boost::make_shared<SinglePrecisionFileMappedCube>(
+                    inputs_->mappedCubeFile(), inputs_->asof(), portfolio->ids(), grid_->valuationDates(), samples_,
+                    cubeDepth_, 0.0f);
+            } else if (inputs_->quantisedCube()) {
+                LOG("XVA: Init quantised cube");
+                cube_ = boost::make_shared<QuantisedInMemoryCube>(inputs_->asof(), portfolio->ids(),
+                                                                  grid_->valuationDates(), samples_, cubeDepth_);
+            } else if (inputs_->truncatedCube()) {
+                // the trades are stored up to their maturity, the valuation engine skips the later dates
+                LOG("XVA: Init truncated cube");
+                cube_ = boost::make_shared<SinglePrecisionTruncatedCube>(inputs_->asof(), portfolio,
+                                                                         grid_->valuationDates(), samples_, cubeDepth_);
+            } else {
+                initCube(cube_, portfolio->ids(), cubeDepth_);
+            }
+        }
         // not required by any calculators in ore at the moment
         nettingSetCube_ = nullptr;
         // Init counterparty cube for the storage of survival probabilities
@@ -236,7 +294,21 @@ boost::shared_ptr<Portfolio> XvaAnalyticImpl::classicRun(const boost::shared_ptr
         classicPortfolio_->add(trade);    
     QL_REQUIRE(analytic()->market(), "today's market not set");
     boost::shared_ptr<EngineFactory> factory = engineFactory();
+    // record the market objects the portfolio uses to prune the simulated risk factors below
+    bool prune = inputs_->pruneRiskFactors() && inputs_->nThreads() == 1;
+    if (prune) {
+        simMarket_->clearRequests();
+        simMarket_->setRecordRequests(true);
+    }
     classicPortfolio_->build(factory, "analytic/" + label());
+    if (prune) {
+        simMarket_->setRecordRequests(false);
+        auto report = boost::make_shared<InMemoryReport>();
+        pruneRiskFactors(simMarket_, *analytic()->configurations().simMarketParams, *classicPortfolio_, report);
+        analytic()->reports()["XVA"]["riskfactorpruning"] = report;
+    } else if (inputs_->pruneRiskFactors()) {
+        WLOG("XVA: risk factor pruning is only supported for single threaded runs, ignored");
+    }
     Date maturityDate = inputs_->asof();
     if (inputs_->portfolioFilterDate() != Null<Date>())
         maturityDate = inputs_->portfolioFilterDate();
@@ -268,7 +340,9 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
                 boost::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency());
             calculators.push_back(boost::make_shared<MPORCalculator>(npvCalc, cubeInterpreter_->defaultDateNpvIndex(),
                                                                      cubeInterpreter_->closeOutDateNpvIndex()));
-        } else
+        } else if (inputs_->batchVanillaOptionPricing())
+            calculators.push_back(boost::make_shared<VanillaOptionBatchNPVCalculator>(inputs_->exposureBaseCurrency()));
+        else
             calculators.push_back(boost::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency()));
         if (inputs_->storeFlows())
             calculators.push_back(boost::make_shared<CashflowCalculator>(
@@ -304,6 +378,8 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
     auto progressBar = boost::make_shared<SimpleProgressBar>(o.str(), ConsoleLog::instance().width(), ConsoleLog::instance().progressBarWidth());
     auto progressLog = boost::make_shared<ProgressLog>("Building cube", 100, ORE_NOTICE);
 
+    ValuationEngineTimings timings;
+
     if(inputs_->nThreads() == 1) {
 
         // single-threaded engine run
@@ -311,18 +387,54 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
         ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
+        engine.setCollectTimings(inputs_->collectRuntimes());
+        engine.setSkipMaturedTrades(inputs_->truncatedCube());
+        engine.setTradeTypeObservationModes(inputs_->tradeTypeObservationModels());
+        boost::shared_ptr<ExposureConvergenceMonitor> monitor;
+        if (inputs_->convergenceTolerance() > 0.0) {
+            monitor = boost::make_shared<ExposureConvergenceMonitor>(portfolio, inputs_->convergenceTolerance(),
+                                                                     inputs_->convergenceMinSamples());
+            engine.setConvergenceMonitor(monitor);
+        }
         engine.buildCube(portfolio, cube_, calculators(), analytic()->configurations().scenarioGeneratorData->withMporStickyDate(),
                          nettingSetCube_, cptyCube_, cptyCalculators());
+        timings = engine.timings();
+        if (monitor) {
+            for (auto const& [nettingSet, se] : monitor->standardErrors())
+                LOG("XVA: netting set " << nettingSet << " time averaged EPE "
+                                        << monitor->expectedExposures().at(nettingSet) << ", standard error " << se);
+        }
+        if (auto a = boost::dynamic_pointer_cast<NettingSetAggregationCube>(cube_))
+            nettingSetCube_ = a->nettingSetCube();
+        if (auto q = boost::dynamic_pointer_cast<QuantisedInMemoryCube>(cube_))
+            LOG("XVA: quantised cube error bound " << q->errorBound() << ", relative to the largest value per trade "
+                                                   << "and date " << QuantisedInMemoryCube::relativeErrorBound());
+        if (engine.simulatedSamples() < cube_->samples()) {
+            LOG("XVA: the simulation stopped after " << engine.simulatedSamples() << " of " << cube_->samples()
+                                                     << " samples");
+            cube_ = boost::make_shared<SampleSubsetCube>(cube_, engine.simulatedSamples());
+            if (nettingSetCube_)
+                nettingSetCube_ = boost::make_shared<SampleSubsetCube>(nettingSetCube_, engine.simulatedSamples());
+            if (cptyCube_)
+                cptyCube_ = boost::make_shared<SampleSubsetCube>(cptyCube_, engine.simulatedSamples());
+        }
     } else {
 
         // multi-threaded engine run
 
         /* TODO we assume no netting output cube is needed. Currently there are no valuation calculators in ore that require this cube. */
 
-        auto cubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
-                                  const std::vector<QuantLib::Date>& dates,
-                                  const Size samples) -> boost::shared_ptr<NPVCube> {
-            if (cubeDepth_ == 1)
+        map<string, string> nettingSetMap = portfolio->nettingSetMap();
+        auto cubeFactory = [this, nettingSetMap](const QuantLib::Date& asof, const std::set<std::string>& ids,
+                                                 const std::vector<QuantLib::Date>& dates,
+                                                 const Size samples) -> boost::shared_ptr<NPVCube> {
+            if (streamingExposure_)
+                return boost::make_shared<NettingSetAggregationCube>(asof, ids, nettingSetMap, dates, samples,
+                                                                     cubeDepth_, subtractedTrades_);
+            else if (inputs_->useProcesses())
+                return boost::make_shared<SinglePrecisionMemoryMappedCube>(asof, ids, dates, samples, cubeDepth_,
+                                                                           0.0f);
+            else if (cubeDepth_ == 1)
                 return boost::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
             else
                 return boost::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples,
@@ -334,9 +446,11 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
                                                                  const QuantLib::Size)>
             cptyCubeFactory;
         if (inputs_->storeSurvivalProbabilities()) {
-            cptyCubeFactory = [](const QuantLib::Date& asof, const std::set<std::string>& ids,
-                                 const std::vector<QuantLib::Date>& dates,
-                                 const Size samples) -> boost::shared_ptr<NPVCube> {
+            cptyCubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
+                                     const std::vector<QuantLib::Date>& dates,
+                                     const Size samples) -> boost::shared_ptr<NPVCube> {
+                if (inputs_->useProcesses())
+                    return boost::make_shared<SinglePrecisionMemoryMappedCube>(asof, ids, dates, samples, 1, 0.0f);
                 return boost::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
             };
         } else {
@@ -355,11 +469,41 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
 
+        engine.setDynamicScheduling(inputs_->threadChunkSize());
+        engine.setShareTodaysMarket(inputs_->shareTodaysMarket());
+        engine.setUseProcesses(inputs_->useProcesses());
+        engine.setSampleParallel(inputs_->sampleParallel());
+        engine.setCollectTimings(inputs_->collectRuntimes());
+        engine.setTradeTypeObservationModes(inputs_->tradeTypeObservationModels());
+        engine.setThreadPool(inputs_->threadPool());
+        engine.setThreadPlacement(inputs_->threadPlacement());
+
+        // balance the split by the pricing times from the previous run, if available
+        boost::shared_ptr<PricingCostProfile> pricingCostProfile;
+        if (!inputs_->pricingCostProfile().empty()) {
+            pricingCostProfile = boost::make_shared<PricingCostProfile>();
+            if (exists(inputs_->pricingCostProfile()))
+                pricingCostProfile->fromFile(inputs_->pricingCostProfile());
+            engine.setPricingCostProfile(pricingCostProfile);
+        }
+
         engine.buildCube(portfolio, calculators, cptyCalculators,
                          analytic()->configurations().scenarioGeneratorData->withMporStickyDate());
+        timings = engine.timings();
+
+        if (pricingCostProfile)
+            pricingCostProfile->toFile(inputs_->pricingCostProfile());
 
         cube_ = boost::make_shared<JointNPVCube>(engine.outputCubes(), portfolio->ids());
 
+        if (streamingExposure_) {
+            // the netting sets of the sub-portfolios overlap, their values are added up
+            vector<boost::shared_ptr<NPVCube>> nettingSetCubes;
+            for (const auto& c : engine.outputCubes())
+                nettingSetCubes.push_back(boost::dynamic_pointer_cast<NettingSetAggregationCube>(c)->nettingSetCube());
+            nettingSetCube_ = JointNPVCube(nettingSetCubes, {}, false).materialise(true);
+        }
+
         if (inputs_->storeSurvivalProbabilities())
             cptyCube_ = boost::make_shared<JointNPVCube>(
                 engine.outputCptyCubes(), portfolio->counterparties(), false,
@@ -368,6 +512,12 @@ void XvaAnalyticImpl::buildClassicCube(const boost::shared_ptr<Portfolio>& portf
 
     CONSOLE("OK");
 
+    if (inputs_->collectRuntimes()) {
+        auto report = boost::make_shared<InMemoryReport>();
+        ReportWriter(inputs_->reportNaString()).writeRuntimes(*report, timings);
+        analytic()->reports()["XVA"]["runtimes"] = report;
+    }
+
     LOG("XVA::buildCube done");
 
     Settings::instance().evaluationDate() = inputs_->asof();
@@ -453,6 +603,7 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
                                      inputs_->exposureSimMarketParams()->additionalScenarioDataCcys());
         amcEngine.registerProgressIndicator(progressBar);
         amcEngine.registerProgressIndicator(progressLog);
+        amcEngine.setPathBundles(inputs_->amcPathBundles());
         // We only need to generate asd, if this does not happen in the classic run
         if (!doClassicRun)
             amcEngine.aggregationScenarioData() = *scenarioData_;
@@ -479,6 +630,8 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
 
         amcEngine.registerProgressIndicator(progressBar);
         amcEngine.registerProgressIndicator(progressLog);
+        amcEngine.setThreadPool(inputs_->threadPool());
+        amcEngine.setPathBundles(inputs_->amcPathBundles());
         // as for the single-threaded case, we only need to generate asd, if this does not happen in the classic run
         if (!doClassicRun)
             amcEngine.aggregationScenarioData() = *scenarioData_;
@@ -539,6 +692,18 @@ void XvaAnalyticImpl::runPostProcessor() {
 
     checkConfigurations(analytic()->portfolio());
         
+    if (!dimCalculator_ && (analytics["mva"] || analytics["dim"]) && inputs_->dimModel() == "SIMM") {
+        LOG("create SimmDynamicInitialMarginCalculator, SIMM version " << inputs_->dimSimmVersion());
+        vector<SimmDynamicInitialMarginCalculator::RiskFactor> riskFactors;
+        for (auto const& f : inputs_->dimSimmRiskFactors())
+            riskFactors.push_back(parseDimSimmRiskFactor(f));
+        auto simmConfiguration = buildSimmConfiguration(inputs_->dimSimmVersion(),
+                                                        boost::make_shared<SimmBucketMapperBase>());
+        dimCalculator_ = boost::make_shared<SimmDynamicInitialMarginCalculator>(
+            inputs_, analytic()->portfolio(), cube_, cubeInterpreter_, *scenarioData_, simmConfiguration, baseCurrency,
+            riskFactors, dimRegressionOrder == 0 ? 2 : dimRegressionOrder);
+    }
+
     if (!dimCalculator_ && (analytics["mva"] || analytics["dim"])) {
         ALOG("dim calculator not set, create RegressionDynamicInitialMarginCalculator");
         dimCalculator_ = boost::make_shared<RegressionDynamicInitialMarginCalculator>(
@@ -568,7 +733,8 @@ void XvaAnalyticImpl::runPostProcessor() {
         cvaSensiShiftSize, kvaCapitalDiscountRate, kvaAlpha, kvaRegAdjustment, kvaCapitalHurdle, kvaOurPdFloor,
         kvaTheirPdFloor, kvaOurCvaRiskWeight, kvaTheirCvaRiskWeight, cptyCube_, flipViewBorrowingCurvePostfix,
         flipViewLendingCurvePostfix, inputs_->creditSimulationParameters(), inputs_->creditMigrationDistributionGrid(),
-        inputs_->creditMigrationTimeSteps(), creditStateCorrelationMatrix(), withMporStickyDate, mporCashFlowMode);
+        inputs_->creditMigrationTimeSteps(), creditStateCorrelationMatrix(), withMporStickyDate, mporCashFlowMode,
+        inputs_->nThreads(), inputs_->threadPool(), streamingExposure_ ? nettingSetCube_ : nullptr);
     LOG("post done");
 }
 
@@ -584,7 +750,7 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
         runXva_ = true;
 
     Settings::instance().evaluationDate() = inputs_->asof();
-    ObservationMode::instance().setMode(inputs_->exposureObservationModel());
+    ObservationMode::instance().setMode(inputs_->exposureObservationModel(), ObservationMode::Mode::Disable);
 
     LOG("XVA: Build Today's Market");
     CONSOLEW("XVA: Build Market");
@@ -642,6 +808,56 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
          * The bulk of the AMC work is done before in the AMC portfolio building/training
          ********************************************************************************/
 
+        // the trade values are not stored with streaming exposure, so this is only possible if they are not needed
+        streamingExposure_ = false;
+        if (inputs_->streamingExposure() || inputs_->incrementalXva()) {
+            string reason;
+            if (doAmcRun)
+                reason = "AMC";
+            else if (parseAllocationMethod(inputs_->exposureAllocationMethod()) !=
+                     ExposureAllocator::AllocationMethod::None)
+                reason = "exposure allocation";
+            else if (inputs_->dimAnalytic() || inputs_->mvaAnalytic())
+                reason = "DIM and MVA";
+            else if (inputs_->dynamicCredit() || inputs_->creditMigrationAnalytic())
+                reason = "dynamic credit and credit migration";
+            else if (inputs_->exerciseNextBreak())
+                reason = "exerciseNextBreak";
+            else if (inputs_->nThreads() > 1 && inputs_->useProcesses())
+                reason = "multiple processes";
+            if (reason.empty()) {
+                LOG("XVA: Aggregate trade values by netting set during the valuation");
+                streamingExposure_ = true;
+            } else {
+                QL_REQUIRE(!inputs_->incrementalXva(), "XVA: Incremental XVA is not supported with " << reason);
+                WLOG("XVA: Streaming exposure is not supported with " << reason << ", build the trade level cube");
+            }
+        }
+
+        /* In the incremental mode only the portfolio of new and removed trades is priced, on the scenarios of a
+           previous run. The scenario data of that run is reused as is, and the values of the trades are added to
+           resp. subtracted from its netting set values below. */
+        subtractedTrades_.clear();
+        if (inputs_->incrementalXva()) {
+            QL_REQUIRE(inputs_->nettingSetCube(),
+                       "XVA: Incremental XVA requires the netting set cube of a previous run");
+            QL_REQUIRE(inputs_->mktCube(), "XVA: Incremental XVA requires the scenario data of a previous run");
+            QL_REQUIRE(inputs_->mktCube()->dimDates() == grid_->valuationDates().size() &&
+                           inputs_->mktCube()->dimSamples() == samples_,
+                       "XVA: Incremental XVA, the scenario data of the previous run has "
+                           << inputs_->mktCube()->dimDates() << " dates and " << inputs_->mktCube()->dimSamples()
+                           << " samples, expected " << grid_->valuationDates().size() << " and " << samples_);
+            scenarioData_.linkTo(inputs_->mktCube());
+            for (const auto& id : inputs_->incrementalRemovedTrades()) {
+                if (inputs_->portfolio()->has(id))
+                    subtractedTrades_.insert(id);
+                else
+                    WLOG("XVA: Incremental XVA, removed trade " << id << " is not in the portfolio, ignored");
+            }
+            LOG("XVA: Incremental XVA for " << inputs_->portfolio()->size() - subtractedTrades_.size()
+                                            << " new and " << subtractedTrades_.size() << " removed trades");
+        }
+
         if (doAmcRun)
             amcRun(doClassicRun);
         else
@@ -658,6 +874,9 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
         
         if (doClassicRun && doAmcRun) {
             LOG("Joining classical and AMC cube");
+            // the classic simulation may have stopped early, see ExposureConvergenceMonitor
+            if (cube_->samples() < amcCube_->samples())
+                amcCube_ = boost::make_shared<SampleSubsetCube>(amcCube_, cube_->samples());
             cube_ = boost::make_shared<JointNPVCube>(cube_, amcCube_);
         } else if (!doClassicRun && doAmcRun) {
             LOG("We have generated an AMC cube only");
@@ -665,6 +884,18 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
         } else {
             WLOG("We have generated a classic cube only");
         }
+
+        if (inputs_->incrementalXva()) {
+            const boost::shared_ptr<NPVCube>& base = inputs_->nettingSetCube();
+            QL_REQUIRE(nettingSetCube_, "XVA: Incremental XVA, no netting set values generated");
+            QL_REQUIRE(base->asof() == nettingSetCube_->asof() && base->dates() == nettingSetCube_->dates() &&
+                           base->samples() == nettingSetCube_->samples() && base->depth() == nettingSetCube_->depth(),
+                       "XVA: Incremental XVA, the netting set cube of the previous run does not match the simulation ("
+                           << base->numDates() << " dates, " << base->samples() << " samples, depth " << base->depth()
+                           << ")");
+            LOG("XVA: Add the new and removed trades to the " << base->numIds() << " netting sets of the previous run");
+            nettingSetCube_ = JointNPVCube(base, nettingSetCube_, {}, false).materialise(true);
+        }
         
         LOG("NPV cube generation completed");
 
@@ -709,7 +940,10 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
 
     // Return the cubes to serialalize
     if (inputs_->writeCube()) {
-        analytic()->npvCubes()["XVA"]["cube"] = cube_;
+        if (streamingExposure_)
+            WLOG("XVA: Streaming exposure, the trade level cube is not written");
+        else
+            analytic()->npvCubes()["XVA"]["cube"] = cube_;
         analytic()->mktCubes()["XVA"]["scenariodata"] = *scenarioData_;
         if (nettingSetCube_) {
             analytic()->npvCubes()["XVA"]["nettingsetcube"] = nettingSetCube_;
@@ -720,7 +954,9 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
     }
 
     // Generate cube reports to inspect
-    if (inputs_->rawCubeOutput()) {
+    if (inputs_->rawCubeOutput() && streamingExposure_) {
+        WLOG("XVA: Streaming exposure, the raw cube report is not written");
+    } else if (inputs_->rawCubeOutput()) {
         map<string, string> nettingSetMap = analytic()->portfolio()->nettingSetMap();
         auto report = boost::make_shared<InMemoryReport>();
         ReportWriter(inputs_->reportNaString()).writeCube(*report, cube_, nettingSetMap);
@@ -744,7 +980,9 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
         CONSOLEW("XVA: Reports");
         LOG("Generating XVA reports and cube outputs");
 
-        if (inputs_->exposureProfilesByTrade()) {
+        if (inputs_->exposureProfilesByTrade() && streamingExposure_) {
+            WLOG("XVA: Streaming exposure, the trade exposure reports are not written");
+        } else if (inputs_->exposureProfilesByTrade()) {
             for (const auto& [tradeId, tradeIdCubePos] : postProcess_->tradeIds()) {
                 auto report = boost::make_shared<InMemoryReport>();
                 ReportWriter(inputs_->reportNaString())
@@ -829,7 +1067,7 @@ void XvaAnalyticImpl::runAnalytic(const boost::shared_ptr<ore::data::InMemoryLoa
     }
 
     // reset that mode
-    ObservationMode::instance().setMode(inputs_->observationModel());
+    ObservationMode::instance().setMode(inputs_->observationModel(), ObservationMode::Mode::None);
 }
 
 Matrix XvaAnalyticImpl::creditStateCorrelationMatrix() const {
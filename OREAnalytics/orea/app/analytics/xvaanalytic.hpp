@@ -40,6 +40,7 @@ public:
     
 protected:
     boost::shared_ptr<ore::data::EngineFactory> engineFactory() override;
+    void recordMemory(const std::string& phase) override;
     void buildScenarioSimMarket();
     void buildCrossAssetModel(bool continueOnError);
     void buildScenarioGenerator(bool continueOnError);
@@ -77,6 +78,11 @@ protected:
 
     bool runSimulation_ = false;
     bool runXva_ = false;
+    // aggregate the trade values by netting set during the valuation, see NettingSetAggregationCube
+    bool streamingExposure_ = false;
+    /* the trade values to subtract from the netting set values, i.e. the trades removed from the netting sets of the
+       previous run in the incremental XVA mode */
+    std::set<std::string> subtractedTrades_;
 };
 
 class XvaAnalytic : public Analytic {
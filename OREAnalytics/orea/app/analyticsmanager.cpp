@@ -24,11 +24,24 @@
 #include <orea/app/analyticsmanager.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
+#include <orea/cube/arrow_io.hpp>
+#include <orea/engine/observationmode.hpp>
 
+#include <ored/marketdata/todaysmarket.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
+
+#include <qle/math/salvagedmatrixcache.hpp>
 
 #include <ql/errors.hpp>
+#include <ql/settings.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 using namespace std;
 using namespace boost::filesystem;
@@ -37,6 +50,11 @@ using ore::data::InMemoryReport;
 namespace ore {
 namespace analytics {
 
+namespace {
+// number of matrices kept in the salvaged matrix cache if only a cache file is given
+const Size defaultSalvagedMatrixCacheSize = 100;
+} // namespace
+
 Size matches(const std::set<std::string>& requested, const std::set<std::string>& available) {
     Size count = 0;
     for (auto r : requested) {
@@ -49,7 +67,12 @@ Size matches(const std::set<std::string>& requested, const std::set<std::string>
 AnalyticsManager::AnalyticsManager(const boost::shared_ptr<InputParameters>& inputs, 
                                    const boost::shared_ptr<MarketDataLoader>& marketDataLoader)
     : inputs_(inputs), marketDataLoader_(marketDataLoader) {    
-    
+
+    if (inputs_->nThreads() > 1 && inputs_->threadPool() == nullptr) {
+        threadPool_ = boost::make_shared<ThreadPool>(inputs_->nThreads());
+        inputs_->setThreadPool(threadPool_);
+    }
+
     addAnalytic("MARKETDATA", boost::make_shared<MarketDataAnalytic>(inputs));
     addAnalytic("PRICING", boost::make_shared<PricingAnalytic>(inputs));
     addAnalytic("VAR", boost::make_shared<VarAnalytic>(inputs_));
@@ -123,6 +146,16 @@ void AnalyticsManager::runAnalytics(const std::set<std::string>& analyticTypes,
     if (analytics_.size() == 0)
         return;
 
+    if (inputs_->memoryAccounting()) {
+        MemoryAccounting::instance().setEnabled(true);
+        MemoryAccounting::instance().clear();
+    }
+
+    if (!inputs_->traceFile().empty()) {
+        Tracer::instance().setEnabled(true);
+        Tracer::instance().clear();
+    }
+
     std::vector<boost::shared_ptr<ore::data::TodaysMarketParameters>> tmps = todaysMarketParams();
     std::set<Date> marketDates;
     for (const auto& a : analytics_) {
@@ -164,9 +197,46 @@ void AnalyticsManager::runAnalytics(const std::set<std::string>& analyticTypes,
         reports_["DIVIDENDS"]["dividends"] = dividendReport;
     }
 
+    /* share the salvaged correlation / covariance matrices and their square roots between the analytics of this
+       run, a cache file adds the results of previous runs */
+    QuantExt::SalvagedMatrixCache& matrixCache = QuantExt::SalvagedMatrixCache::instance();
+    Size matrixCacheSize = inputs_->salvagedMatrixCacheSize();
+    if (matrixCacheSize == 0 && !inputs_->salvagedMatrixCacheFile().empty())
+        matrixCacheSize = defaultSalvagedMatrixCacheSize;
+    if (matrixCacheSize > 0) {
+        LOG("AnalyticsManager::runAnalytics: enable salvaged matrix cache with size " << matrixCacheSize);
+        matrixCache.enable(matrixCacheSize);
+        if (!inputs_->salvagedMatrixCacheFile().empty()) {
+            matrixCache.load(inputs_->salvagedMatrixCacheFile());
+            LOG("AnalyticsManager::runAnalytics: loaded " << matrixCache.size() << " salvaged matrices from "
+                                                          << inputs_->salvagedMatrixCacheFile());
+        }
+    }
+
     // run requested analytics
+    std::vector<std::pair<std::string, boost::shared_ptr<Analytic>>> requested;
     for (auto a : analytics_) {
-        if (matches(analyticTypes, a.second->analyticTypes()) > 0) {
+        if (matches(analyticTypes, a.second->analyticTypes()) > 0)
+            requested.push_back(a);
+    }
+
+    std::string requirement;
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    requirement = "a QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN";
+#elif !defined(QL_ENABLE_SESSIONS)
+    requirement = "a QuantLib build with QL_ENABLE_SESSIONS";
+#endif
+    if (inputs_->parallelAnalytics() && requested.size() > 1 && !requirement.empty())
+        WLOG("AnalyticsManager: parallel analytics require " << requirement << ", run sequentially");
+
+    if (inputs_->parallelAnalytics() && requested.size() > 1 && requirement.empty()) {
+        runConcurrently(requested, analyticTypes);
+        if (marketCalibrationReport) {
+            for (auto const& a : requested)
+                a.second->marketCalibration(marketCalibrationReport);
+        }
+    } else {
+        for (auto const& a : requested) {
             LOG("run analytic with label '" << a.first << "'");
             a.second->runAnalytic(marketDataLoader_->loader(), analyticTypes);
             LOG("run analytic with label '" << a.first << "' finished.");
@@ -176,6 +246,38 @@ void AnalyticsManager::runAnalytics(const std::set<std::string>& analyticTypes,
         }
     }
 
+    if (matrixCacheSize > 0) {
+        if (!inputs_->salvagedMatrixCacheFile().empty()) {
+            matrixCache.save(inputs_->salvagedMatrixCacheFile());
+            LOG("AnalyticsManager::runAnalytics: saved " << matrixCache.size() << " salvaged matrices to "
+                                                         << inputs_->salvagedMatrixCacheFile());
+        }
+        matrixCache.disable();
+    }
+
+    // write the market objects used by the analytics, this is a minimal todaysmarket.xml for the next run
+    if (!inputs_->todaysMarketUsageFile().empty()) {
+        if (!inputs_->lazyMarketBuilding())
+            WLOG("AnalyticsManager: the market is not built lazily, all market objects are reported as used");
+        TodaysMarketParameters used;
+        for (auto a : analytics_) {
+            auto todaysMarket = boost::dynamic_pointer_cast<TodaysMarket>(a.second->market());
+            if (!todaysMarket)
+                continue;
+            auto p = todaysMarket->usedMarketParameters();
+            for (auto const& c : p->configurations()) {
+                used.addConfiguration(c.first, c.second);
+                for (auto const& o : getMarketObjectTypes()) {
+                    auto const& m = p->mapping(o, c.first);
+                    if (!m.empty())
+                        used.addMarketObject(o, p->marketObjectId(o, c.first), m);
+                }
+            }
+        }
+        LOG("AnalyticsManager: write used market objects to " << inputs_->todaysMarketUsageFile());
+        used.toFile(inputs_->todaysMarketUsageFile());
+    }
+
     if (inputs_->portfolio()) {
         auto pricingStatsReport = boost::make_shared<InMemoryReport>();
         ReportWriter(inputs_->reportNaString())
@@ -183,6 +285,19 @@ void AnalyticsManager::runAnalytics(const std::set<std::string>& analyticTypes,
         reports_["STATS"]["pricingstats"] = pricingStatsReport;
     }
 
+    if (MemoryAccounting::instance().enabled()) {
+        MemoryAccounting::instance().recordProcess("end");
+        auto memoryReport = boost::make_shared<InMemoryReport>();
+        ReportWriter(inputs_->reportNaString())
+            .writeMemoryBreakdown(*memoryReport, MemoryAccounting::instance().entries());
+        reports_["MEMORY"]["memory_breakdown"] = memoryReport;
+    }
+
+    if (!inputs_->traceFile().empty()) {
+        Tracer::instance().setEnabled(false);
+        Tracer::instance().toFile(inputs_->traceFile());
+    }
+
     if (marketCalibrationReport) {
         auto report = marketCalibrationReport->outputCalibrationReport();
         if (report) {
@@ -194,6 +309,115 @@ void AnalyticsManager::runAnalytics(const std::set<std::string>& analyticTypes,
     inputs_->writeOutParameters();
 }
 
+void AnalyticsManager::runConcurrently(
+    const std::vector<std::pair<std::string, boost::shared_ptr<Analytic>>>& analytics,
+    const std::set<std::string>& analyticTypes) {
+
+    // an analytic waits for the other requested analytics that it holds as dependent analytics
+    std::map<std::string, std::set<std::string>> prerequisites;
+    std::set<std::string> labels;
+    for (auto const& a : analytics)
+        labels.insert(a.first);
+    for (auto const& [label, analytic] : analytics) {
+        for (auto const& [key, _] : analytic->dependentAnalytics()) {
+            if (key != label && labels.find(key) != labels.end())
+                prerequisites[label].insert(key);
+        }
+    }
+
+    /* the analytics build their portfolios from the input portfolio, so all but the first analytic get a copy of the
+       inputs with their own portfolio, the trades must not be built concurrently */
+    for (Size i = 1; i < analytics.size(); ++i) {
+        auto inputs = boost::make_shared<InputParameters>(*inputs_);
+        if (inputs_->portfolio())
+            inputs->setPortfolio(inputs_->portfolio()->toXMLString());
+        std::vector<boost::shared_ptr<Analytic>> all = analytics[i].second->allDependentAnalytics();
+        all.push_back(analytics[i].second);
+        for (auto const& a : all) {
+            a->setInputs(inputs);
+            if (a->impl())
+                a->impl()->setInputs(inputs);
+        }
+    }
+
+    // state of the main session to set up in the sessions of the analytics
+    const Date evaluationDate = Settings::instance().evaluationDate();
+    const bool includeReferenceDateEvents = Settings::instance().includeReferenceDateEvents();
+    const boost::optional<bool> includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+    const bool enforcesTodaysHistoricFixings = Settings::instance().enforcesTodaysHistoricFixings();
+    const ObservationMode::Mode observationMode = ObservationMode::instance().mode();
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::set<std::string> done;
+    Size running = 0;
+    std::exception_ptr error;
+    const Size maxRunning = std::max<Size>(inputs_->nThreads(), 1);
+
+    auto run = [&](const std::string& label, const boost::shared_ptr<Analytic>& analytic) {
+        std::exception_ptr e;
+        try {
+            Settings::instance().evaluationDate() = evaluationDate;
+            Settings::instance().includeReferenceDateEvents() = includeReferenceDateEvents;
+            Settings::instance().includeTodaysCashFlows() = includeTodaysCashFlows;
+            Settings::instance().enforcesTodaysHistoricFixings() = enforcesTodaysHistoricFixings;
+            ObservationMode::instance().setMode(observationMode);
+            LOG("run analytic with label '" << label << "' in thread " << std::this_thread::get_id());
+            analytic->runAnalytic(marketDataLoader_->loader(), analyticTypes);
+            LOG("run analytic with label '" << label << "' finished.");
+        } catch (...) {
+            e = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (e && !error)
+            error = e;
+        done.insert(label);
+        --running;
+        finished.notify_all();
+    };
+
+    /* the analytics run in threads of their own rather than on the shared thread pool, since their engines submit
+       tasks to the pool and wait for them */
+    std::vector<std::thread> threads;
+    std::vector<std::pair<std::string, boost::shared_ptr<Analytic>>> pending = analytics;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!pending.empty() && !error) {
+            bool started = false;
+            for (auto it = pending.begin(); it != pending.end() && running < maxRunning;) {
+                bool ready = true;
+                for (auto const& p : prerequisites[it->first])
+                    ready = ready && done.find(p) != done.end();
+                if (ready) {
+                    ++running;
+                    threads.emplace_back(run, it->first, it->second);
+                    it = pending.erase(it);
+                    started = true;
+                } else {
+                    ++it;
+                }
+            }
+            if (!started && running == 0) {
+                std::ostringstream labelList;
+                for (auto const& a : pending)
+                    labelList << " " << a.first;
+                try {
+                    QL_FAIL("AnalyticsManager: cyclic dependencies between the analytics" << labelList.str());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                break;
+            }
+            if (!pending.empty())
+                finished.wait(lock);
+        }
+    }
+    for (auto& t : threads)
+        t.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
 Analytic::analytic_reports const AnalyticsManager::reports() {
     Analytic::analytic_reports reports = reports_;
     for (auto a : analytics_) {
@@ -271,12 +495,17 @@ void AnalyticsManager::toFile(const ore::analytics::Analytic::analytic_reports&
 
             // attach a suffix only if it does not have one already
             string suffix = "";
-            if (!endsWith(fileName,".csv") && !endsWith(fileName, ".txt"))
+            if (!endsWith(fileName, ".csv") && !endsWith(fileName, ".txt") && !endsWith(fileName, ".gz") &&
+                !isArrowFilename(fileName))
                 suffix = ".csv";
             std::string fullFileName = outputPath + "/" + fileName + suffix;
 
-            report->toFile(fullFileName, sep, commentCharacter, quoteChar, nullString,
-                           lowerHeaderReportNames.find(reportName) != lowerHeaderReportNames.end());
+            if (isArrowFilename(fullFileName))
+                saveReportToArrow(fullFileName, *report);
+            else
+                report->toFile(fullFileName, sep, commentCharacter, quoteChar, nullString,
+                               lowerHeaderReportNames.find(reportName) != lowerHeaderReportNames.end(),
+                               inputs_->nThreads());
             LOG("report " << reportName << " written to " << fullFileName); 
         }
     }
@@ -68,9 +68,16 @@ public:
                 const std::set<std::string>& lowerHeaderReportNames = {});
 
 private:
+    /*! Run the given analytics concurrently, each in its own thread and QuantLib session, an analytic is started once
+        the requested analytics it depends on (see Analytic::dependentAnalytics()) are done */
+    void runConcurrently(const std::vector<std::pair<std::string, boost::shared_ptr<Analytic>>>& analytics,
+                         const std::set<std::string>& analyticTypes);
+
     std::map<std::string, boost::shared_ptr<Analytic>> analytics_;
     boost::shared_ptr<InputParameters> inputs_;
     boost::shared_ptr<MarketDataLoader> marketDataLoader_;
+    // worker threads shared by all analytics, created for multi-threaded runs only
+    boost::shared_ptr<ThreadPool> threadPool_;
     Analytic::analytic_reports reports_;
     std::set<std::string> validAnalytics_;
     std::set<std::string> requestedAnalytics_;
@@ -23,10 +23,12 @@
 #include <orea/engine/sensitivityfilestream.hpp>
 #include <orea/scenario/shiftscenariogenerator.hpp>
 #include <orea/simm/simmbucketmapperbase.hpp>
+#include <orea/simm/simmsensitivitymapper.hpp>
 #include <ored/ored.hpp>
 #include <ored/utilities/calendaradjustmentconfig.hpp>
 #include <ored/utilities/currencyconfig.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <ored/utilities/xmlconfigurationcache.hpp>
 
 namespace ore {
 namespace analytics {
@@ -64,7 +66,7 @@ void InputParameters::setRefDataManager(const std::string& xml) {
 }
 
 void InputParameters::setRefDataManagerFromFile(const std::string& fileName) {
-    refDataManager_ = boost::make_shared<BasicReferenceDataManager>(fileName);
+    refDataManager_ = boost::make_shared<BasicReferenceDataManager>(fileName, lazyReferenceData_);
 }
 
 void InputParameters::setConventions(const std::string& xml) {
@@ -73,6 +75,10 @@ void InputParameters::setConventions(const std::string& xml) {
 }
     
 void InputParameters::setConventionsFromFile(const std::string& fileName) {
+    if (cacheConfigurations_) {
+        conventions_ = XMLConfigurationCache::instance().fromFile<Conventions>(fileName);
+        return;
+    }
     conventions_ = boost::make_shared<Conventions>();
     conventions_->fromFile(fileName);
 }
@@ -84,6 +90,10 @@ void InputParameters::setCurveConfigs(const std::string& xml) {
 }
 
 void InputParameters::setCurveConfigsFromFile(const std::string& fileName) {
+    if (cacheConfigurations_) {
+        curveConfigs_.add(XMLConfigurationCache::instance().fromFile<CurveConfigurations>(fileName));
+        return;
+    }
     auto curveConfig = boost::make_shared<CurveConfigurations>();
     curveConfig->fromFile(fileName);
     curveConfigs_.add(curveConfig);
@@ -129,7 +139,10 @@ void InputParameters::setPortfolioFromFile(const std::string& fileNameString, co
     portfolio_ = boost::make_shared<Portfolio>(buildFailedTrades_);
     for (auto file : files) {
         LOG("Loading portfolio from file: " << file);
-        portfolio_->fromFile(file);
+        if (portfolioChunkSize_ > 0)
+            portfolio_->fromFile(file, nThreads_, portfolioChunkSize_);
+        else
+            portfolio_->fromFile(file);
     }
 }
 
@@ -191,6 +204,16 @@ void InputParameters::setStressScenarioDataFromFile(const std::string& fileName)
     stressScenarioData_->fromFile(fileName);
 }
     
+void InputParameters::setStressSensiScenarioData(const std::string& xml) {
+    stressSensiScenarioData_ = boost::make_shared<SensitivityScenarioData>();
+    stressSensiScenarioData_->fromXMLString(xml);
+}
+
+void InputParameters::setStressSensiScenarioDataFromFile(const std::string& fileName) {
+    stressSensiScenarioData_ = boost::make_shared<SensitivityScenarioData>();
+    stressSensiScenarioData_->fromFile(fileName);
+}
+
 void InputParameters::setStressPricingEngine(const std::string& xml) {
     stressPricingEngine_ = boost::make_shared<EngineData>();
     stressPricingEngine_->fromXMLString(xml);
@@ -312,12 +335,39 @@ void InputParameters::setSensitivityStreamFromFile(const std::string& fileName)
     sensitivityStream_ = boost::make_shared<SensitivityFileStream>(fileName);
 }
 
+void InputParameters::setIncrementalRemovedTrades(const std::string& s) {
+    // parse to set<string>
+    auto v = parseListOfValues(s);
+    incrementalRemovedTrades_ = std::set<std::string>(v.begin(), v.end());
+}
+
+void InputParameters::setStreamReports(const std::string& s) {
+    // parse to set<string>
+    auto v = parseListOfValues(s);
+    streamReports_ = std::set<std::string>(v.begin(), v.end());
+}
+
 void InputParameters::setAmcTradeTypes(const std::string& s) {
     // parse to set<string>
     auto v = parseListOfValues(s);
     amcTradeTypes_ = std::set<std::string>(v.begin(), v.end());
 }
     
+void InputParameters::setTradeTypeObservationModels(const std::string& s) {
+    // parse to map<string, ObservationMode::Mode>, e.g. Swap:Unregister,Swaption:None
+    tradeTypeObservationModels_.clear();
+    for (auto const& v : parseListOfValues(s)) {
+        std::vector<std::string> tokens;
+        boost::split(tokens, v, boost::is_any_of(":"));
+        QL_REQUIRE(tokens.size() == 2, "invalid trade type observation model '" << v << "', expected TradeType:Mode");
+        QL_REQUIRE(tokens[1] == "None" || tokens[1] == "Unregister",
+                   "invalid observation model '" << tokens[1] << "' for trade type " << tokens[0]
+                                                 << ", expected None or Unregister");
+        tradeTypeObservationModels_[tokens[0]] =
+            tokens[1] == "None" ? ObservationMode::Mode::None : ObservationMode::Mode::Unregister;
+    }
+}
+
 void InputParameters::setCvaSensiGrid(const std::string& s) {
     // parse to vector<Period>
     cvaSensiGrid_ = parseListOfValues<Period>(s, &parsePeriod);
@@ -361,6 +411,11 @@ void InputParameters::setDimRegressors(const std::string& s) {
     // parse to vector<string>
     dimRegressors_ = parseListOfValues(s);
 }
+
+void InputParameters::setDimSimmRiskFactors(const std::string& s) {
+    // parse to vector<string>, each entry is parsed by parseDimSimmRiskFactor()
+    dimSimmRiskFactors_ = parseListOfValues(s);
+}
     
 void InputParameters::setDimOutputGridPoints(const std::string& s) {
     // parse to vector<Size>
@@ -402,15 +457,25 @@ void InputParameters::setCrifLoader() {
 void InputParameters::setCrifFromFile(const std::string& fileName, char eol, char delim, char quoteChar, char escapeChar) {
     if (!crifLoader_)
         setCrifLoader();
+    crifLoader_->setThreads(nThreads_);
     crifLoader_->loadFromFile(fileName, eol, delim, quoteChar, escapeChar);
 }
 
 void InputParameters::setCrifFromBuffer(const std::string& csvBuffer, char eol, char delim, char quoteChar, char escapeChar) {
     if (!crifLoader_)
         setCrifLoader();
+    crifLoader_->setThreads(nThreads_);
     crifLoader_->loadFromString(csvBuffer, eol, delim, quoteChar, escapeChar);
 }
 
+void InputParameters::setCrifFromSensitivities(SensitivityStream& stream,
+                                               const boost::shared_ptr<ore::data::Market>& market) {
+    if (!crifLoader_)
+        setCrifLoader();
+    SimmSensitivityMapper mapper(crifLoader_->simmConfiguration(), market, simmNameMapper_, portfolio_);
+    mapper.load(stream, *crifLoader_);
+}
+
 void InputParameters::setSimmNameMapper(const std::string& xml) {
     simmNameMapper_ = boost::make_shared<SimmBasicNameMapper>();
     simmNameMapper_->fromXMLString(xml);    
@@ -30,7 +30,10 @@
 #include <orea/scenario/stressscenariodata.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
+#include <orea/engine/observationmode.hpp>
 #include <orea/engine/sensitivitystream.hpp>
+#include <orea/engine/threadplacement.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/simm/crifloader.hpp>
 #include <orea/simm/simmbasicnamemapper.hpp>
 #include <orea/simm/simmbucketmapper.hpp>
@@ -49,6 +52,8 @@ namespace ore {
 namespace analytics {
 using namespace ore::data;
 
+class ReportSinkFactory;
+
 //! Base class for input data, also exposed via SWIG
 class InputParameters {
 public:
@@ -64,11 +69,21 @@ public:
     void setBaseCurrency(const std::string& s) { baseCurrency_ = s; }
     void setContinueOnError(bool b) { continueOnError_ = b; }
     void setLazyMarketBuilding(bool b) { lazyMarketBuilding_ = b; }
+    void setParallelMarketBuilding(bool b) { parallelMarketBuilding_ = b; }
+    void setParallelPortfolioBuilding(bool b) { parallelPortfolioBuilding_ = b; }
+    void setParallelAnalytics(bool b) { parallelAnalytics_ = b; }
+    void setPortfolioChunkSize(QuantLib::Size s) { portfolioChunkSize_ = s; }
+    void setParallelCashflowReport(bool b) { parallelCashflowReport_ = b; }
+    void setCalibratedCurveCacheFile(const std::string& s) { calibratedCurveCacheFile_ = s; }
+    void setSalvagedMatrixCacheSize(Size s) { salvagedMatrixCacheSize_ = s; }
+    void setSalvagedMatrixCacheFile(const std::string& s) { salvagedMatrixCacheFile_ = s; }
+    void setTodaysMarketUsageFile(const std::string& s) { todaysMarketUsageFile_ = s; }
     void setBuildFailedTrades(bool b) { buildFailedTrades_ = b; }
     void setObservationModel(const std::string& s) { observationModel_ = s; }
     void setImplyTodaysFixings(bool b) { implyTodaysFixings_ = b; }
     void setMarketConfig(const std::string& config, const std::string& context);
     void setRefDataManager(const std::string& xml);
+    void setLazyReferenceData(bool b) { lazyReferenceData_ = b; }
     void setRefDataManagerFromFile(const std::string& fileName);
     void setConventions(const std::string& xml);
     void setConventionsFromFile(const std::string& fileName);
@@ -84,7 +99,23 @@ public:
     void setPortfolioFromFile(const std::string& fileNameString, const std::string& inputPath); 
     void setMarketConfigs(const std::map<std::string, std::string>& m);
     void setThreads(int i) { nThreads_ = i; }
+    void setThreadChunkSize(Size s) { threadChunkSize_ = s; }
+    void setShareTodaysMarket(bool b) { shareTodaysMarket_ = b; }
+    void setThreadPlacement(const std::string& s) { threadPlacement_ = parseThreadPlacement(s); }
+    void setUseProcesses(bool b) { useProcesses_ = b; }
+    void setSampleParallel(bool b) { sampleParallel_ = b; }
+    void setIncrementalValuation(bool b) { incrementalValuation_ = b; }
+    void setAnalyticDeltas(bool b) { analyticDeltas_ = b; }
+    void setValidateAnalyticDeltas(bool b) { validateAnalyticDeltas_ = b; }
+    void setCollectRuntimes(bool b) { collectRuntimes_ = b; }
+    void setPricingCostProfile(const std::string& s) { pricingCostProfile_ = s; }
+    void setThreadPool(const boost::shared_ptr<ThreadPool>& p) { threadPool_ = p; }
+    void setReportSinkFactory(const boost::shared_ptr<ReportSinkFactory>& f) { reportSinkFactory_ = f; }
+    void setStreamReports(const std::string& s); // parse to set<string>
     void setEntireMarket(bool b) { entireMarket_ = b; }
+    void setCacheConfigurations(bool b) { cacheConfigurations_ = b; }
+    void setMemoryAccounting(bool b) { memoryAccounting_ = b; }
+    void setTraceFile(const std::string& s) { traceFile_ = s; }
     void setAllFixings(bool b) { allFixings_ = b; }
     void setEomInflationFixings(bool b) { eomInflationFixings_ = b; }
     void setUseMarketDataFixings(bool b) { useMarketDataFixings_ = b; }
@@ -116,6 +147,7 @@ public:
     void setParSensi(bool b) { parSensi_ = b; }
     void setAlignPillars(bool b) { alignPillars_ = b; }
     void setOutputJacobi(bool b) { outputJacobi_ = b; }
+    void setJacobiCacheDirectory(const std::string& s) { jacobiCacheDirectory_ = s; }
     void setUseSensiSpreadedTermStructures(bool b) { useSensiSpreadedTermStructures_ = b; }
     void setSensiThreshold(Real r) { sensiThreshold_ = r; }
     void setSensiSimMarketParams(const std::string& xml);
@@ -139,6 +171,10 @@ public:
     void setStressPricingEngine(const boost::shared_ptr<EngineData>& engineData) {
         stressPricingEngine_ = engineData;
     }
+    void setStressSensitivityBased(bool b) { stressSensitivityBased_ = b; }
+    void setStressSensitivityErrorThreshold(Real r) { stressSensitivityErrorThreshold_ = r; }
+    void setStressSensiScenarioData(const std::string& xml);
+    void setStressSensiScenarioDataFromFile(const std::string& fileName);
 
     // Setters for VaR
     void setSalvageCovariance(bool b) { salvageCovariance_ = b; }
@@ -157,8 +193,10 @@ public:
     void setSalvageCorrelationMatrix(bool b) { salvageCorrelationMatrix_ = b; }
     void setAmc(bool b) { amc_ = b; }
     void setAmcTradeTypes(const std::string& s); // parse to set<string>
+    void setAmcPathBundles(QuantLib::Size s) { amcPathBundles_ = s; }
     void setExposureBaseCurrency(const std::string& s) { exposureBaseCurrency_ = s; } 
     void setExposureObservationModel(const std::string& s) { exposureObservationModel_ = s; }
+    void setTradeTypeObservationModels(const std::string& s); // parse to map<string, ObservationMode::Mode>
     void setNettingSetId(const std::string& s) { nettingSetId_ = s; }
     void setScenarioGenType(const std::string& s) { scenarioGenType_ = s; }
     void setStoreFlows(bool b) { storeFlows_ = b; }
@@ -166,6 +204,18 @@ public:
     void setStoreSurvivalProbabilities(bool b) { storeSurvivalProbabilities_ = b; }
     void setWriteCube(bool b) { writeCube_ = b; }
     void setWriteScenarios(bool b) { writeScenarios_ = b; }
+    void setCacheScenarios(bool b) { cacheScenarios_ = b; }
+    void setScenarioCacheDirectory(const std::string& s) { scenarioCacheDirectory_ = s; }
+    void setPruneRiskFactors(bool b) { pruneRiskFactors_ = b; }
+    void setMappedCubeFile(const std::string& s) { mappedCubeFile_ = s; }
+    void setQuantisedCube(bool b) { quantisedCube_ = b; }
+    void setTruncatedCube(bool b) { truncatedCube_ = b; }
+    void setConvergenceTolerance(QuantLib::Real r) { convergenceTolerance_ = r; }
+    void setConvergenceMinSamples(Size s) { convergenceMinSamples_ = s; }
+    void setBatchVanillaOptionPricing(bool b) { batchVanillaOptionPricing_ = b; }
+    void setStreamingExposure(bool b) { streamingExposure_ = b; }
+    void setIncrementalXva(bool b) { incrementalXva_ = b; }
+    void setIncrementalRemovedTrades(const std::string& s); // parse to set<string>
     void setExposureSimMarketParams(const std::string& xml);
     void setExposureSimMarketParamsFromFile(const std::string& fileName);
     void setScenarioGeneratorData(const std::string& xml);
@@ -197,6 +247,9 @@ public:
     void setNettingSetCubeFromFile(const std::string& file);
     void setCptyCubeFromFile(const std::string& file);
     void setMarketCubeFromFile(const std::string& file);
+    void setCube(const boost::shared_ptr<NPVCube>& cube) { cube_ = cube; }
+    void setNettingSetCube(const boost::shared_ptr<NPVCube>& cube) { nettingSetCube_ = cube; }
+    void setCptyCube(const boost::shared_ptr<NPVCube>& cube) { cptyCube_ = cube; }
     // boost::shared_ptr<AggregationScenarioData> mktCube();
     void setFlipViewXVA(bool b) { flipViewXVA_ = b; }
     void setFullInitialCollateralisation(bool b) { fullInitialCollateralisation_ = b; }
@@ -242,6 +295,9 @@ public:
     void setDimOutputNettingSet(const std::string& s) { dimOutputNettingSet_ = s; }
     void setDimLocalRegressionEvaluations(Size s) { dimLocalRegressionEvaluations_ = s; }
     void setDimLocalRegressionBandwidth(Real r) { dimLocalRegressionBandwidth_ = r; }
+    void setDimModel(const std::string& s) { dimModel_ = s; }
+    void setDimSimmVersion(const std::string& s) { dimSimmVersion_ = s; }
+    void setDimSimmRiskFactors(const std::string& s); // parse to vector<string>
     // capital value adjustment details
     void setKvaCapitalDiscountRate(Real r) { kvaCapitalDiscountRate_ = r; } 
     void setKvaAlpha(Real r) { kvaAlpha_ = r; }
@@ -272,6 +328,9 @@ public:
                          char eol = '\n', char delim = ',', char quoteChar = '\0', char escapeChar = '\\');
     void setCrifFromBuffer(const std::string& csvBuffer,
                            char eol = '\n', char delim = ',', char quoteChar = '\0', char escapeChar = '\\');
+    //! Map the sensitivities of \p stream to CRIF records, see SimmSensitivityMapper
+    void setCrifFromSensitivities(ore::analytics::SensitivityStream& stream,
+                                  const boost::shared_ptr<ore::data::Market>& market = nullptr);
     void setSimmNameMapper(const boost::shared_ptr<ore::analytics::SimmBasicNameMapper>& p) { simmNameMapper_ = p; }
     void setSimmNameMapper(const std::string& xml);
     void setSimmNameMapperFromFile(const std::string& fileName);
@@ -287,6 +346,7 @@ public:
     void setParConversionXbsParConversion(bool b) { parConversionXbsParConversion_ = b; }
     void setParConversionAlignPillars(bool b) { parConversionAlignPillars_ = b; }
     void setParConversionOutputJacobi(bool b) { parConversionOutputJacobi_ = b; }
+    void setParConversionJacobiCacheDirectory(const std::string& s) { parConversionJacobiCacheDirectory_ = s; }
     void setParConversionThreshold(Real r) { parConversionThreshold_ = r; }
     void setParConversionSimMarketParams(const std::string& xml);
     void setParConversionSimMarketParamsFromFile(const std::string& fileName);
@@ -319,6 +379,17 @@ public:
     const std::string& resultCurrency() { return resultCurrency_; }
     bool continueOnError() { return continueOnError_; }
     bool lazyMarketBuilding() { return lazyMarketBuilding_; }
+    bool parallelMarketBuilding() { return parallelMarketBuilding_; }
+    bool parallelPortfolioBuilding() { return parallelPortfolioBuilding_; }
+    // if true, the requested analytics are run concurrently, see AnalyticsManager::runAnalytics()
+    bool parallelAnalytics() const { return parallelAnalytics_; }
+    QuantLib::Size portfolioChunkSize() const { return portfolioChunkSize_; }
+    bool parallelCashflowReport() const { return parallelCashflowReport_; }
+    bool lazyReferenceData() const { return lazyReferenceData_; }
+    const std::string& calibratedCurveCacheFile() { return calibratedCurveCacheFile_; }
+    Size salvagedMatrixCacheSize() const { return salvagedMatrixCacheSize_; }
+    const std::string& salvagedMatrixCacheFile() { return salvagedMatrixCacheFile_; }
+    const std::string& todaysMarketUsageFile() { return todaysMarketUsageFile_; }
     bool buildFailedTrades() { return buildFailedTrades_; }
     const std::string& observationModel() { return observationModel_; }
     bool implyTodaysFixings() { return implyTodaysFixings_; }
@@ -334,7 +405,27 @@ public:
 
     QuantLib::Size maxRetries() const { return maxRetries_; }
     QuantLib::Size nThreads() const { return nThreads_; }
+    QuantLib::Size threadChunkSize() const { return threadChunkSize_; }
+    bool shareTodaysMarket() const { return shareTodaysMarket_; }
+    ThreadPlacement threadPlacement() const { return threadPlacement_; }
+    bool useProcesses() const { return useProcesses_; }
+    bool sampleParallel() const { return sampleParallel_; }
+    bool incrementalValuation() const { return incrementalValuation_; }
+    bool analyticDeltas() const { return analyticDeltas_; }
+    bool validateAnalyticDeltas() const { return validateAnalyticDeltas_; }
+    bool collectRuntimes() const { return collectRuntimes_; }
+    const std::string& pricingCostProfile() const { return pricingCostProfile_; }
+    // the thread pool shared by the multi-threaded engines of all analytics, null for single-threaded runs
+    const boost::shared_ptr<ThreadPool>& threadPool() const { return threadPool_; }
+    // the sinks the analytics stream their reports to, null to keep all reports in memory
+    const boost::shared_ptr<ReportSinkFactory>& reportSinkFactory() const { return reportSinkFactory_; }
+    const std::set<std::string>& streamReports() const { return streamReports_; }
     bool entireMarket() { return entireMarket_; }
+    // if true, conventions and curve configurations read from files are shared via the XMLConfigurationCache
+    bool cacheConfigurations() const { return cacheConfigurations_; }
+    // if true, the memory footprints of the subsystems are recorded and written as the memory breakdown report
+    bool memoryAccounting() const { return memoryAccounting_; }
+    const std::string& traceFile() const { return traceFile_; }
     bool allFixings() { return allFixings_; }
     bool eomInflationFixings() { return eomInflationFixings_; }
     bool useMarketDataFixings() { return useMarketDataFixings_; }
@@ -382,6 +473,7 @@ public:
     bool parSensi() const { return parSensi_; };
     bool alignPillars() const { return alignPillars_; };
     bool outputJacobi() const { return outputJacobi_; };
+    const std::string& jacobiCacheDirectory() const { return jacobiCacheDirectory_; }
     bool useSensiSpreadedTermStructures() { return useSensiSpreadedTermStructures_; }
     QuantLib::Real sensiThreshold() const { return sensiThreshold_; }
     const boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& sensiSimMarketParams() { return sensiSimMarketParams_; }
@@ -396,6 +488,11 @@ public:
     const boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& stressSimMarketParams() { return stressSimMarketParams_; }
     const boost::shared_ptr<ore::analytics::StressTestScenarioData>& stressScenarioData() { return stressScenarioData_; }
     const boost::shared_ptr<ore::data::EngineData>& stressPricingEngine() { return stressPricingEngine_; }
+    bool stressSensitivityBased() { return stressSensitivityBased_; }
+    QuantLib::Real stressSensitivityErrorThreshold() { return stressSensitivityErrorThreshold_; }
+    const boost::shared_ptr<ore::analytics::SensitivityScenarioData>& stressSensiScenarioData() {
+        return stressSensiScenarioData_;
+    }
 
     /*****************
      * Getters for VaR
@@ -416,8 +513,13 @@ public:
     bool salvageCorrelationMatrix() { return salvageCorrelationMatrix_; }
     bool amc() { return amc_; }
     const std::set<std::string>& amcTradeTypes() { return amcTradeTypes_; }
+    QuantLib::Size amcPathBundles() const { return amcPathBundles_; }
     const std::string& exposureBaseCurrency() { return exposureBaseCurrency_; }
     const std::string& exposureObservationModel() { return exposureObservationModel_; }
+    // observation modes by trade type overriding the exposure observation model, see ValuationEngine
+    const std::map<std::string, ObservationMode::Mode>& tradeTypeObservationModels() const {
+        return tradeTypeObservationModels_;
+    }
     const std::string& nettingSetId() { return nettingSetId_; }
     const std::string& scenarioGenType() { return scenarioGenType_; }
     bool storeFlows() { return storeFlows_; }
@@ -425,6 +527,18 @@ public:
     bool storeSurvivalProbabilities() { return storeSurvivalProbabilities_; }
     bool writeCube() { return writeCube_; }
     bool writeScenarios() { return writeScenarios_; }
+    bool cacheScenarios() { return cacheScenarios_; }
+    const std::string& scenarioCacheDirectory() { return scenarioCacheDirectory_; }
+    bool pruneRiskFactors() { return pruneRiskFactors_; }
+    const std::string& mappedCubeFile() { return mappedCubeFile_; }
+    bool quantisedCube() { return quantisedCube_; }
+    bool truncatedCube() { return truncatedCube_; }
+    QuantLib::Real convergenceTolerance() { return convergenceTolerance_; }
+    Size convergenceMinSamples() { return convergenceMinSamples_; }
+    bool batchVanillaOptionPricing() { return batchVanillaOptionPricing_; }
+    bool streamingExposure() { return streamingExposure_; }
+    bool incrementalXva() { return incrementalXva_; }
+    const std::set<std::string>& incrementalRemovedTrades() { return incrementalRemovedTrades_; }
     const boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& exposureSimMarketParams() { return exposureSimMarketParams_; }
     const boost::shared_ptr<ScenarioGeneratorData> scenarioGeneratorData() { return scenarioGeneratorData_; }
     const boost::shared_ptr<CrossAssetModelData>& crossAssetModelData() { return crossAssetModelData_; }
@@ -490,6 +604,9 @@ public:
     const std::string& dimOutputNettingSet() { return dimOutputNettingSet_; }
     Size dimLocalRegressionEvaluations() { return dimLocalRegressionEvaluations_; }
     Real dimLocalRegressionBandwidth() { return dimLocalRegressionBandwidth_; }
+    const std::string& dimModel() { return dimModel_; }
+    const std::string& dimSimmVersion() { return dimSimmVersion_; }
+    const std::vector<std::string>& dimSimmRiskFactors() { return dimSimmRiskFactors_; }
     // capital value adjustment details
     Real kvaCapitalDiscountRate() { return kvaCapitalDiscountRate_; } 
     Real kvaAlpha() { return kvaAlpha_; }
@@ -531,6 +648,7 @@ public:
     bool parConversionXbsParConversion() { return parConversionXbsParConversion_; }
     bool parConversionAlignPillars() const { return parConversionAlignPillars_; };
     bool parConversionOutputJacobi() const { return parConversionOutputJacobi_; };
+    const std::string& parConversionJacobiCacheDirectory() const { return parConversionJacobiCacheDirectory_; }
     QuantLib::Real parConversionThreshold() const { return parConversionThreshold_; }
     const boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& parConversionSimMarketParams() {
         return parConversionSimMarketParams_;
@@ -580,6 +698,16 @@ protected:
     std::string resultCurrency_;
     bool continueOnError_ = true;
     bool lazyMarketBuilding_ = true;
+    bool parallelMarketBuilding_ = false;
+    bool parallelPortfolioBuilding_ = false;
+    bool parallelAnalytics_ = false;
+    QuantLib::Size portfolioChunkSize_ = 0;
+    bool parallelCashflowReport_ = false;
+    bool lazyReferenceData_ = false;
+    std::string calibratedCurveCacheFile_;
+    Size salvagedMatrixCacheSize_ = 0;
+    std::string salvagedMatrixCacheFile_;
+    std::string todaysMarketUsageFile_;
     bool buildFailedTrades_ = true;
     std::string observationModel_ = "None";
     bool implyTodaysFixings_ = false;
@@ -593,8 +721,24 @@ protected:
     boost::shared_ptr<ore::data::Portfolio> portfolio_;
     QuantLib::Size maxRetries_ = 7;
     QuantLib::Size nThreads_ = 1;
+    QuantLib::Size threadChunkSize_ = 0;
+    bool shareTodaysMarket_ = false;
+    ThreadPlacement threadPlacement_ = ThreadPlacement::None;
+    bool useProcesses_ = false;
+    bool sampleParallel_ = false;
+    bool incrementalValuation_ = false;
+    bool analyticDeltas_ = false;
+    bool validateAnalyticDeltas_ = false;
+    bool collectRuntimes_ = false;
+    std::string pricingCostProfile_;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    boost::shared_ptr<ReportSinkFactory> reportSinkFactory_;
+    std::set<std::string> streamReports_;
    
     bool entireMarket_ = false; 
+    bool cacheConfigurations_ = false;
+    bool memoryAccounting_ = false;
+    std::string traceFile_;
     bool allFixings_ = false; 
     bool eomInflationFixings_ = true;
     bool useMarketDataFixings_ = true;
@@ -633,6 +777,7 @@ protected:
     bool xbsParConversion_ = false;
     bool parSensi_ = false;
     bool outputJacobi_ = false;
+    std::string jacobiCacheDirectory_ = "";
     bool alignPillars_ = false;
     bool useSensiSpreadedTermStructures_ = true;
     QuantLib::Real sensiThreshold_ = 1e-6;
@@ -648,6 +793,10 @@ protected:
     boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> stressSimMarketParams_;
     boost::shared_ptr<ore::analytics::StressTestScenarioData> stressScenarioData_;
     boost::shared_ptr<ore::data::EngineData> stressPricingEngine_;
+    // approximate the stress scenarios by a second order expansion in the sensitivities
+    bool stressSensitivityBased_ = false;
+    QuantLib::Real stressSensitivityErrorThreshold_ = 0.1;
+    boost::shared_ptr<ore::analytics::SensitivityScenarioData> stressSensiScenarioData_;
 
     /*****************
      * VAR analytics
@@ -656,7 +805,7 @@ protected:
     std::vector<Real> varQuantiles_;
     bool varBreakDown_ = false;
     std::string portfolioFilter_;
-    // Delta, DeltaGammaNormal, MonteCarlo, Cornish-Fisher, Saddlepoint 
+    // Delta, DeltaGammaNormal, MonteCarlo, QuasiMonteCarlo, Cornish-Fisher, Saddlepoint 
     std::string varMethod_;
     Size mcVarSamples_ = 0;
     long mcVarSeed_ = 0;
@@ -669,8 +818,10 @@ protected:
     bool salvageCorrelationMatrix_ = false;
     bool amc_ = false;
     std::set<std::string> amcTradeTypes_;
+    QuantLib::Size amcPathBundles_ = 0;
     std::string exposureBaseCurrency_ = "";
     std::string exposureObservationModel_ = "Disable";
+    std::map<std::string, ObservationMode::Mode> tradeTypeObservationModels_;
     std::string nettingSetId_ = "";
     std::string scenarioGenType_ = "";
     bool storeFlows_ = false;
@@ -678,6 +829,18 @@ protected:
     bool storeSurvivalProbabilities_ = false;
     bool writeCube_ = false;
     bool writeScenarios_ = false;
+    bool cacheScenarios_ = false;
+    std::string scenarioCacheDirectory_ = "";
+    bool pruneRiskFactors_ = false;
+    std::string mappedCubeFile_ = "";
+    bool quantisedCube_ = false;
+    bool truncatedCube_ = false;
+    QuantLib::Real convergenceTolerance_ = 0.0;
+    Size convergenceMinSamples_ = 1000;
+    bool batchVanillaOptionPricing_ = false;
+    bool streamingExposure_ = false;
+    bool incrementalXva_ = false;
+    std::set<std::string> incrementalRemovedTrades_;
     boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> exposureSimMarketParams_;
     boost::shared_ptr<ScenarioGeneratorData> scenarioGeneratorData_;
     boost::shared_ptr<CrossAssetModelData> crossAssetModelData_;
@@ -735,6 +898,9 @@ protected:
     string dimOutputNettingSet_;
     Size dimLocalRegressionEvaluations_ = 0;
     Real dimLocalRegressionBandwidth_ = 0.25;
+    string dimModel_ = "Regression";
+    string dimSimmVersion_ = "2.6";
+    vector<string> dimSimmRiskFactors_;
     // capital value adjustment details
     Real kvaCapitalDiscountRate_ = 0.10;
     Real kvaAlpha_ = 1.4;
@@ -769,6 +935,7 @@ protected:
      ***************/
     bool parConversionXbsParConversion_ = false;
     bool parConversionOutputJacobi_ = false;
+    std::string parConversionJacobiCacheDirectory_ = "";
     bool parConversionAlignPillars_ = false;
     QuantLib::Real parConversionThreshold_ = 1e-6;
     boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> parConversionSimMarketParams_;
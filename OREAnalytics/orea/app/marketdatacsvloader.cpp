@@ -91,13 +91,11 @@ void MarketDataCsvLoaderImpl::retrieveFixings(const boost::shared_ptr<ore::data:
             // map<string, set<Date>>
             const string& name = kv.first;
             for (const auto& date : kv.second) {
-                // lazy loop over all of them...
-                for (const auto& fix : csvLoader_->loadFixings()) {
-                    if (fix.name == name && fix.date == date) {
-                        // add it to the inMemory
-                        loader->addFixing(fix.date, fix.name, fix.fixing);
-                        //DLOG("add fixing for " << fix.name << " as of " << io::iso_date(fix.date));
-                    }
+                // look up the fixing by name and date, then add it to the inMemory
+                if (csvLoader_->hasFixing(name, date)) {
+                    Fixing fix = csvLoader_->getFixing(name, date);
+                    loader->addFixing(fix.date, fix.name, fix.fixing);
+                    //DLOG("add fixing for " << fix.name << " as of " << io::iso_date(fix.date));
                 }
             }
         }
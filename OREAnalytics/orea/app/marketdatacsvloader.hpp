@@ -33,7 +33,7 @@ public:
     MarketDataCsvLoaderImpl() {}
 
     MarketDataCsvLoaderImpl(const boost::shared_ptr<InputParameters>& inputs, 
-        const boost::shared_ptr<ore::data::CSVLoader>& csvLoader)
+        const boost::shared_ptr<ore::data::Loader>& csvLoader)
         : inputs_(inputs), csvLoader_(csvLoader) {}
     
     void loadCorporateActionData(boost::shared_ptr<ore::data::InMemoryLoader>& loader,
@@ -47,15 +47,18 @@ public:
         ore::analytics::FixingMap fixings = {},
         std::map<std::pair<std::string, QuantLib::Date>, std::set<QuantLib::Date>> lastAvailableFixingLookupMap = {}) override;
 
+    //! the csv loader is only read, so that several dates can be retrieved at the same time
+    bool supportsConcurrentRetrieval() const override { return true; }
+
 private:
     boost::shared_ptr<InputParameters> inputs_;
-    boost::shared_ptr<ore::data::CSVLoader> csvLoader_;
+    boost::shared_ptr<ore::data::Loader> csvLoader_;
 };
 
 class MarketDataCsvLoader : public MarketDataLoader {
 public: 
     MarketDataCsvLoader(const boost::shared_ptr<InputParameters>& inputs,
-                        const boost::shared_ptr<ore::data::CSVLoader>& csvLoader)
+                        const boost::shared_ptr<ore::data::Loader>& csvLoader)
         : MarketDataLoader(inputs, boost::make_shared<MarketDataCsvLoaderImpl>(inputs, csvLoader)) {}
 };
     
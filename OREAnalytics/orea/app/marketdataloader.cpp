@@ -23,6 +23,10 @@
 #include <ored/utilities/to_string.hpp>
 #include <ored/utilities/currencyhedgedequityindexdecomposition.hpp>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace ore::data;
 using QuantExt::OptionPriceSurface;
 
@@ -173,7 +177,7 @@ void MarketDataLoader::populateFixings(
         
         // portfolio fixings will warn if missinbg
         if (inputs_->portfolio()) {
-            portfolioFixings = inputs_->portfolio()->fixings();
+            portfolioFixings = inputs_->portfolio()->fixings(Date(), inputs_->nThreads());
             LOG("The portfolio depends on fixings from " << portfolioFixings.size() << " indices");
             for (const auto& it : portfolioFixings)
                 addRelevantFixings(it, lastAvailableFixingLookupMap);
@@ -279,16 +283,54 @@ void MarketDataLoader::populateLoader(
         }
     }
 
-    for (const auto& d : loaderDates) {
-        QuoteMap quoteMap;
-        quoteMap[d] = quotes;
+    Size nThreads = std::min<Size>(inputs_->nThreads(), loaderDates.size());
+    if (nThreads > 1 && impl()->supportsConcurrentRetrieval()) {
+        // retrieve the dates in parallel, each into a loader of its own, and merge the loaders in date order
+        LOG("CurveConfigs require " << quotes.size() << " quotes, retrieving " << loaderDates.size()
+                                    << " dates using " << nThreads << " threads");
+        std::vector<Date> dates(loaderDates.begin(), loaderDates.end());
+        std::vector<boost::shared_ptr<InMemoryLoader>> loaders(dates.size());
+        std::vector<std::exception_ptr> errors(nThreads);
+        std::atomic<Size> next(0);
+        std::vector<std::thread> workers;
+        for (Size t = 0; t < nThreads; ++t) {
+            workers.emplace_back([this, &dates, &loaders, &errors, &next, &quotes, t]() {
+                try {
+                    for (Size i = next++; i < dates.size(); i = next++) {
+                        QuoteMap quoteMap;
+                        quoteMap[dates[i]] = quotes;
+                        loaders[i] = boost::make_shared<InMemoryLoader>();
+                        impl()->retrieveMarketData(loaders[i], quoteMap, dates[i]);
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        for (auto const& e : errors)
+            if (e)
+                std::rethrow_exception(e);
+
+        for (Size i = 0; i < dates.size(); ++i) {
+            for (auto const& d : loaders[i]->dates())
+                for (auto const& md : loaders[i]->loadQuotes(d))
+                    loader_->add(md);
+            quotes_[dates[i]] = quotes;
+        }
+    } else {
+        for (const auto& d : loaderDates) {
+            QuoteMap quoteMap;
+            quoteMap[d] = quotes;
 
-        LOG("CurveConfigs require " << quotes.size() << " quotes");
+            LOG("CurveConfigs require " << quotes.size() << " quotes");
 
-        // Get the relevant market data loader for the pricing call
-        impl()->retrieveMarketData(loader_, quoteMap, d);
+            // Get the relevant market data loader for the pricing call
+            impl()->retrieveMarketData(loader_, quoteMap, d);
 
-        quotes_[d] = quotes;
+            quotes_[d] = quotes;
+        }
     }
     LOG("Got market data");
 }
@@ -60,6 +60,10 @@ public:
     //! retrieve fixings
     virtual void retrieveFixings(const boost::shared_ptr<ore::data::InMemoryLoader>& loader, FixingMap fixings = {}, 
         std::map<std::pair<std::string, QuantLib::Date>, std::set<QuantLib::Date>> lastAvailableFixingLookupMap = {}) = 0;
+
+    /*! true if retrieveMarketData() can be called concurrently for different request dates, each call populating its
+        own loader, false by default */
+    virtual bool supportsConcurrentRetrieval() const { return false; }
 };
 
 class MarketDataLoader {
@@ -27,6 +27,8 @@
 
 #include <orea/app/marketdatainmemoryloader.hpp>
 #include <orea/app/oreapp.hpp>
+#include <orea/app/oreservice.hpp>
+#include <orea/app/xvasharding.hpp>
 #include <orea/orea.hpp>
 #include <ored/ored.hpp>
 #include <ored/report/inmemoryreport.hpp>
@@ -153,6 +155,7 @@ boost::shared_ptr<AggregationScenarioData> OREApp::getMarketCube(std::string cub
 
 std::vector<std::string> OREApp::getErrors() {
     std::vector<std::string> errors;
+    Log::instance().flush();
     while (fbLogger_ && fbLogger_->logger->hasNext())
         errors.push_back(fbLogger_->logger->next());
     return errors;
@@ -173,7 +176,7 @@ vector<string> OREApp::getFileNames(const string& fileString, const string& path
     return fileNames;
 }
 
-boost::shared_ptr<CSVLoader> OREApp::buildCsvLoader(const boost::shared_ptr<Parameters>& params) {
+boost::shared_ptr<Loader> OREApp::buildCsvLoader(const boost::shared_ptr<Parameters>& params) {
     bool implyTodaysFixings = false;
     vector<string> marketFiles = {};
     vector<string> fixingFiles = {};
@@ -206,7 +209,34 @@ boost::shared_ptr<CSVLoader> OREApp::buildCsvLoader(const boost::shared_ptr<Para
         WLOG("dividend data file not found");
     }
 
-    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings);
+    // if a snapshot of the same files is available, read it instead of parsing the files
+    std::string snapshotFile, snapshotTag;
+    tmp = params->get("setup", "marketDataSnapshot", false);
+    if (tmp != "") {
+        snapshotFile = params->get("setup", "outputPath") + "/" + tmp;
+        std::ostringstream os;
+        os << io::iso_date(Settings::instance().evaluationDate()) << "|" << implyTodaysFixings;
+        for (auto const& files : {marketFiles, fixingFiles, dividendFiles}) {
+            for (auto const& f : files)
+                os << "|" << f << "|" << boost::filesystem::file_size(f) << "|"
+                   << boost::filesystem::last_write_time(f);
+        }
+        snapshotTag = os.str();
+        auto snapshot = boost::make_shared<CompactLoader>();
+        if (snapshot->readSnapshot(snapshotFile, snapshotTag))
+            return snapshot;
+    }
+
+    // large market data and fixing files are parsed in chunks on nThreads threads
+    Size nThreads = inputs_ ? inputs_->nThreads() : 1;
+    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings,
+                                                std::set<Date>(), nThreads);
+
+    if (!snapshotFile.empty()) {
+        CompactLoader snapshot;
+        snapshot.add(*loader, loader->dates());
+        snapshot.writeSnapshot(snapshotFile, snapshotTag);
+    }
 
     return loader;
 }
@@ -229,6 +259,13 @@ void OREApp::analytics() {
         auto csvLoader = buildCsvLoader(params_);
         auto loader = boost::make_shared<MarketDataCsvLoader>(inputs_, csvLoader);
 
+        // Stream the selected reports to files in the results path while they are written
+        if (!inputs_->streamReports().empty())
+            inputs_->setReportSinkFactory(boost::make_shared<CSVReportSinkFactory>(
+                inputs_->resultsPath().string(), inputs_->streamReports(), outputs_->fileNameMap(),
+                inputs_->csvSeparator(), inputs_->csvCommentCharacter(), inputs_->csvQuoteChar(),
+                inputs_->reportNaString()));
+
         // Create the analytics manager
         analyticsManager_ = boost::make_shared<AnalyticsManager>(inputs_, loader);
         LOG("Available analytics: " << to_string(analyticsManager_->validAnalytics()));
@@ -302,6 +339,18 @@ OREApp::OREApp(boost::shared_ptr<Parameters> params, bool console,
     
     setupLog(outputPath, logFile, logMask, logRootPath);
 
+    // Switch on asynchronous logging if requested
+    if (params_->has("setup", "asyncLogging") && parseBool(params_->get("setup", "asyncLogging"))) {
+        Log::OverflowPolicy policy = Log::OverflowPolicy::Block;
+        if (params_->has("setup", "asyncLogOverflow")) {
+            string s = params_->get("setup", "asyncLogOverflow");
+            QL_REQUIRE(s == "Block" || s == "Drop",
+                       "asyncLogOverflow '" << s << "' not recognised, expected Block or Drop");
+            policy = s == "Block" ? Log::OverflowPolicy::Block : Log::OverflowPolicy::Drop;
+        }
+        Log::instance().switchOnAsync(policy);
+    }
+
     // Log the input parameters
     params_->log();
 
@@ -408,6 +457,24 @@ void OREApp::run(const std::vector<std::string>& marketData,
     LOG("ORE analytics done");
 }
 
+void OREApp::runService(std::istream& in, std::ostream& out) {
+    try {
+        QL_REQUIRE(params_, "OREApp::runService() requires the ORE parameters");
+        LOG("ORE service starting");
+        CONSOLEW("Building market and portfolio");
+        OREService service(inputs_, buildCsvLoader(params_));
+        CONSOLE("OK");
+        service.serve(in, out, outputs_->fileNameMap());
+    } catch (std::exception& e) {
+        ostringstream oss;
+        oss << "Error in ORE service: " << e.what();
+        ALOG(StructuredAnalyticsWarningMessage("OREApp::runService()", oss.str(), e.what()));
+        CONSOLE(oss.str());
+        QL_FAIL(oss.str());
+    }
+    LOG("ORE service done");
+}
+
 void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
                                   const boost::shared_ptr<Parameters>& params) {
     QL_REQUIRE(inputs, "InputParameters not created yet");
@@ -481,6 +548,62 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (tmp != "")
         inputs->setThreads(parseInteger(tmp));
 
+    tmp = params_->get("setup", "cacheConfigurations", false);
+    if (tmp != "")
+        inputs->setCacheConfigurations(parseBool(tmp));
+
+    tmp = params_->get("setup", "memoryAccounting", false);
+    if (tmp != "")
+        inputs->setMemoryAccounting(parseBool(tmp));
+
+    tmp = params_->get("setup", "traceFile", false);
+    if (tmp != "")
+        inputs->setTraceFile(outputPath + "/" + tmp);
+
+    tmp = params_->get("setup", "streamReports", false);
+    if (tmp != "")
+        inputs->setStreamReports(tmp);
+
+    tmp = params_->get("setup", "threadChunkSize", false);
+    if (tmp != "")
+        inputs->setThreadChunkSize(parseInteger(tmp));
+
+    tmp = params_->get("setup", "shareTodaysMarket", false);
+    if (tmp != "")
+        inputs->setShareTodaysMarket(parseBool(tmp));
+
+    tmp = params_->get("setup", "threadPlacement", false);
+    if (tmp != "")
+        inputs->setThreadPlacement(tmp);
+
+    tmp = params_->get("setup", "useProcesses", false);
+    if (tmp != "")
+        inputs->setUseProcesses(parseBool(tmp));
+
+    tmp = params_->get("setup", "sampleParallel", false);
+    if (tmp != "")
+        inputs->setSampleParallel(parseBool(tmp));
+
+    tmp = params_->get("setup", "incrementalValuation", false);
+    if (tmp != "")
+        inputs->setIncrementalValuation(parseBool(tmp));
+
+    tmp = params_->get("setup", "analyticDeltas", false);
+    if (tmp != "")
+        inputs->setAnalyticDeltas(parseBool(tmp));
+
+    tmp = params_->get("setup", "validateAnalyticDeltas", false);
+    if (tmp != "")
+        inputs->setValidateAnalyticDeltas(parseBool(tmp));
+
+    tmp = params_->get("setup", "collectRuntimes", false);
+    if (tmp != "")
+        inputs->setCollectRuntimes(parseBool(tmp));
+
+    tmp = params_->get("setup", "pricingCostProfile", false);
+    if (tmp != "")
+        inputs->setPricingCostProfile(tmp);
+
     tmp = params_->get("setup", "entireMarket", false);
     if (tmp != "")
         inputs->setEntireMarket(parseBool(tmp));
@@ -497,6 +620,42 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (tmp != "")
         inputs->setLazyMarketBuilding(parseBool(tmp));
 
+    tmp = params_->get("setup", "parallelMarketBuilding", false);
+    if (tmp != "")
+        inputs->setParallelMarketBuilding(parseBool(tmp));
+
+    tmp = params_->get("setup", "parallelPortfolioBuilding", false);
+    if (tmp != "")
+        inputs->setParallelPortfolioBuilding(parseBool(tmp));
+
+    tmp = params_->get("setup", "parallelAnalytics", false);
+    if (tmp != "")
+        inputs->setParallelAnalytics(parseBool(tmp));
+
+    tmp = params_->get("setup", "portfolioChunkSize", false);
+    if (tmp != "")
+        inputs->setPortfolioChunkSize(parseInteger(tmp));
+
+    tmp = params_->get("setup", "parallelCashflowReport", false);
+    if (tmp != "")
+        inputs->setParallelCashflowReport(parseBool(tmp));
+
+    tmp = params_->get("setup", "calibratedCurveCache", false);
+    if (tmp != "")
+        inputs->setCalibratedCurveCacheFile(outputPath + "/" + tmp);
+
+    tmp = params_->get("setup", "salvagedMatrixCacheSize", false);
+    if (tmp != "")
+        inputs->setSalvagedMatrixCacheSize(parseInteger(tmp));
+
+    tmp = params_->get("setup", "salvagedMatrixCache", false);
+    if (tmp != "")
+        inputs->setSalvagedMatrixCacheFile(outputPath + "/" + tmp);
+
+    tmp = params_->get("setup", "todaysMarketUsage", false);
+    if (tmp != "")
+        inputs->setTodaysMarketUsageFile(outputPath + "/" + tmp);
+
     tmp = params_->get("setup", "buildFailedTrades", false);
     if (tmp != "")
         inputs->setBuildFailedTrades(parseBool(tmp));
@@ -504,7 +663,7 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     tmp = params_->get("setup", "observationModel", false);
     if (tmp != "") {
         inputs->setObservationModel(tmp);
-        ObservationMode::instance().setMode(inputs->observationModel());
+        ObservationMode::instance().setMode(inputs->observationModel(), ObservationMode::Mode::None);
         LOG("Observation Mode is " << inputs->observationModel());
     }
 
@@ -512,6 +671,10 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (tmp != "")
         inputs->setImplyTodaysFixings(ore::data::parseBool(tmp));
 
+    tmp = params_->get("setup", "lazyReferenceData", false);
+    if (tmp != "")
+        inputs->setLazyReferenceData(parseBool(tmp));
+
     tmp = params_->get("setup", "referenceDataFile", false);
     if (tmp != "") {
         string refDataFile = inputPath + "/" + tmp;
@@ -646,6 +809,10 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         if (tmp != "")
             inputs->setOutputJacobi(parseBool(tmp));
 
+        tmp = params_->get("sensitivity", "jacobiCacheDirectory", false);
+        if (tmp != "")
+            inputs->setJacobiCacheDirectory(tmp);
+
         tmp = params_->get("sensitivity", "alignPillars", false);
         if (tmp != "")
             inputs->setAlignPillars(parseBool(tmp));
@@ -722,6 +889,23 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         tmp = params_->get("stress", "outputThreshold", false); 
         if (tmp != "")
             inputs->setStressThreshold(parseReal(tmp));
+
+        tmp = params_->get("stress", "sensitivityBased", false);
+        if (tmp != "")
+            inputs->setStressSensitivityBased(parseBool(tmp));
+
+        tmp = params_->get("stress", "sensitivityErrorThreshold", false);
+        if (tmp != "")
+            inputs->setStressSensitivityErrorThreshold(parseReal(tmp));
+
+        tmp = params_->get("stress", "sensitivityConfigFile", false);
+        if (tmp != "") {
+            string file = inputPath + "/" + tmp;
+            LOG("Load sensitivity scenario data for the sensitivity based stress test from file " << file);
+            inputs->setStressSensiScenarioDataFromFile(file);
+        } else if (inputs->stressSensitivityBased()) {
+            WLOG("Sensitivity scenario data for the sensitivity based stress test not loaded");
+        }
     }
 
     /****************
@@ -833,6 +1017,14 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (!tmp.empty() && parseBool(tmp))
         inputs->insertAnalytic("XVA");
 
+    // a shard of a distributed simulation only simulates its part of the portfolio, see partitionByNettingSet()
+    tmp = params_->get("simulation", "shards", false);
+    if (tmp != "" && inputs->portfolio()) {
+        Size simulationShards = parseInteger(tmp);
+        Size shardIndex = parseInteger(params_->get("simulation", "shardIndex"));
+        restrictToShard(*inputs->portfolio(), simulationShards, shardIndex);
+    }
+
     tmp = params_->get("simulation", "salvageCorrelationMatrix", false);
     if (tmp != "")
         inputs->setSalvageCorrelationMatrix(parseBool(tmp));
@@ -845,6 +1037,10 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (tmp != "")
         inputs->setAmcTradeTypes(tmp);
 
+    tmp = params_->get("simulation", "amcPathBundles", false);
+    if (tmp != "")
+        inputs->setAmcPathBundles(parseInteger(tmp));
+
     inputs->setSimulationPricingEngine(inputs->pricingEngine());
     inputs->setExposureObservationModel(inputs->observationModel());
     inputs->setExposureBaseCurrency(inputs->baseCurrency());
@@ -896,6 +1092,10 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         else
             inputs->setExposureObservationModel(inputs->observationModel());
         
+        tmp = params_->get("simulation", "tradeTypeObservationModels", false);
+        if (tmp != "")
+            inputs->setTradeTypeObservationModels(tmp);
+
         tmp = params_->get("simulation", "storeFlows", false);
         if (tmp == "Y")
             inputs->setStoreFlows(true);
@@ -919,6 +1119,54 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         tmp = params_->get("simulation", "scenariodump", false);
         if (tmp != "")
             inputs->setWriteScenarios(true);
+
+        tmp = params_->get("simulation", "cacheScenarios", false);
+        if (tmp == "Y")
+            inputs->setCacheScenarios(true);
+
+        tmp = params_->get("simulation", "scenarioCacheDirectory", false);
+        if (tmp != "")
+            inputs->setScenarioCacheDirectory((inputs->resultsPath() / tmp).string());
+
+        tmp = params_->get("simulation", "pruneRiskFactors", false);
+        if (tmp == "Y")
+            inputs->setPruneRiskFactors(true);
+
+        tmp = params_->get("simulation", "mappedCubeFile", false);
+        if (tmp != "")
+            inputs->setMappedCubeFile((inputs->resultsPath() / tmp).string());
+
+        tmp = params_->get("simulation", "quantisedCube", false);
+        if (tmp == "Y")
+            inputs->setQuantisedCube(true);
+
+        tmp = params_->get("simulation", "truncatedCube", false);
+        if (tmp == "Y")
+            inputs->setTruncatedCube(true);
+
+        tmp = params_->get("simulation", "convergenceTolerance", false);
+        if (tmp != "")
+            inputs->setConvergenceTolerance(parseReal(tmp));
+
+        tmp = params_->get("simulation", "convergenceMinSamples", false);
+        if (tmp != "")
+            inputs->setConvergenceMinSamples(parseInteger(tmp));
+
+        tmp = params_->get("simulation", "batchVanillaOptionPricing", false);
+        if (tmp == "Y")
+            inputs->setBatchVanillaOptionPricing(true);
+
+        tmp = params_->get("simulation", "streamingExposure", false);
+        if (tmp == "Y")
+            inputs->setStreamingExposure(true);
+
+        tmp = params_->get("simulation", "incrementalXva", false);
+        if (tmp == "Y")
+            inputs->setIncrementalXva(true);
+
+        tmp = params_->get("simulation", "incrementalRemovedTrades", false);
+        if (tmp != "")
+            inputs->setIncrementalRemovedTrades(tmp);
     }
 
     /**********************
@@ -931,14 +1179,35 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     else
         inputs->setXvaBaseCurrency(inputs->exposureBaseCurrency());
 
+    // the cubes of a distributed simulation are written by the shards, with the shard index in the file names
+    tmp = params_->get("xva", "shards", false);
+    Size shards = tmp == "" ? 1 : parseInteger(tmp);
+    QL_REQUIRE(shards > 0, "number of shards must be positive");
+
     if (inputs->analytics().find("XVA") != inputs->analytics().end() &&
         inputs->analytics().find("EXPOSURE") == inputs->analytics().end()) {
         inputs->setLoadCube(true);
+        tmp = params_->get("xva", "shardCommand", false);
+        if (shards > 1 && tmp != "") {
+            string resultFile = params_->get("xva", "cubeFile", false);
+            if (resultFile != "")
+                resultFile = inputs->resultsPath().string() + "/" + resultFile;
+            string retries = params_->get("xva", "shardRetries", false);
+            string concurrency = params_->get("xva", "shardConcurrency", false);
+            ShardCoordinator coordinator(tmp, shards, retries == "" ? 2 : parseInteger(retries), resultFile,
+                                         concurrency == "" ? 0 : parseInteger(concurrency));
+            coordinator.run();
+        }
         tmp = params_->get("xva", "cubeFile", false);
         if (tmp != "") {
             string cubeFile = inputs->resultsPath().string() + "/" + tmp;
-            LOG("Load cube from file " << cubeFile);
-            inputs->setCubeFromFile(cubeFile);
+            if (shards > 1) {
+                LOG("Load " << shards << " cube shards from files " << cubeFile);
+                inputs->setCube(boost::make_shared<JointNPVCube>(loadCubeShards(cubeFile, shards)));
+            } else {
+                LOG("Load cube from file " << cubeFile);
+                inputs->setCubeFromFile(cubeFile);
+            }
             LOG("Cube loading done: ids=" << inputs->cube()->numIds()
                 << " dates=" << inputs->cube()->numDates()
                 << " samples=" << inputs->cube()->samples()
@@ -957,11 +1226,18 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         inputs->setNettingSetManagerFromFile(csaFile);
     }
     
+    // the incremental XVA runs on top of the netting set cube and scenario data of a previous run
     tmp = params_->get("xva", "nettingSetCubeFile", false);
-    if (inputs->loadCube() && tmp != "") {
+    if ((inputs->loadCube() || inputs->incrementalXva()) && tmp != "") {
         string cubeFile = inputs->resultsPath().string() + "/" + tmp;
-        LOG("Load nettingset cube from file " << cubeFile);
-        inputs->setNettingSetCubeFromFile(cubeFile);
+        if (shards > 1 && !inputs->incrementalXva()) {
+            // the netting sets are not split between the shards
+            LOG("Load " << shards << " nettingset cube shards from files " << cubeFile);
+            inputs->setNettingSetCube(boost::make_shared<JointNPVCube>(loadCubeShards(cubeFile, shards)));
+        } else {
+            LOG("Load nettingset cube from file " << cubeFile);
+            inputs->setNettingSetCubeFromFile(cubeFile);
+        }
         DLOG("NettingSetCube loading done: ids=" << inputs->nettingSetCube()->numIds()
              << " dates=" << inputs->nettingSetCube()->numDates()
              << " samples=" << inputs->nettingSetCube()->samples()
@@ -971,8 +1247,16 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     tmp = params_->get("xva", "cptyCubeFile", false);
     if (inputs->loadCube() && tmp != "") {
         string cubeFile = inputs->resultsPath().string() + "/" + tmp;
-        LOG("Load cpty cube from file " << cubeFile);
-        inputs->setCptyCubeFromFile(cubeFile);
+        if (shards > 1) {
+            // a counterparty may appear in several shards, with the same survival probabilities
+            LOG("Load " << shards << " cpty cube shards from files " << cubeFile);
+            inputs->setCptyCube(boost::make_shared<JointNPVCube>(
+                loadCubeShards(cubeFile, shards), std::set<std::string>(), false,
+                [](Real a, Real x) { return std::max(a, x); }, 0.0));
+        } else {
+            LOG("Load cpty cube from file " << cubeFile);
+            inputs->setCptyCubeFromFile(cubeFile);
+        }
         DLOG("CptyCube loading done: ids=" << inputs->cptyCube()->numIds()
              << " dates=" << inputs->cptyCube()->numDates()
              << " samples=" << inputs->cptyCube()->samples()
@@ -980,8 +1264,9 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     }
 
     tmp = params_->get("xva", "scenarioFile", false);
-    if (inputs->loadCube() && tmp != "") {
-        string cubeFile = inputs->resultsPath().string() + "/" + tmp;
+    if ((inputs->loadCube() || inputs->incrementalXva()) && tmp != "") {
+        // the shards simulate the same scenarios, the scenario data of the first shard is used
+        string cubeFile = inputs->resultsPath().string() + "/" + (shards > 1 ? shardName(tmp, 0) : tmp);
         LOG("Load agg scen data from file " << cubeFile);
         inputs->setMarketCubeFromFile(cubeFile);
         LOG("MktCube loading done");
@@ -1146,6 +1431,18 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
     if (tmp != "")
         inputs->setDimLocalRegressionBandwidth(parseReal(tmp));
 
+    tmp = params_->get("xva", "dimModel", false);
+    if (tmp != "")
+        inputs->setDimModel(tmp);
+
+    tmp = params_->get("xva", "dimSimmVersion", false);
+    if (tmp != "")
+        inputs->setDimSimmVersion(tmp);
+
+    tmp = params_->get("xva", "dimSimmRiskFactors", false);
+    if (tmp != "")
+        inputs->setDimSimmRiskFactors(tmp);
+
     // KVA
 
     tmp = params_->get("xva", "kvaCapitalDiscountRate", false);
@@ -1293,6 +1590,10 @@ void OREApp::buildInputParameters(boost::shared_ptr<InputParameters> inputs,
         if (tmp != "")
             inputs->setParConversionOutputJacobi(parseBool(tmp));
 
+        tmp = params_->get("zeroToParSensiConversion", "jacobiCacheDirectory", false);
+        if (tmp != "")
+            inputs->setParConversionJacobiCacheDirectory(tmp);
+
     }
 
     if (inputs->analytics().size() == 0) {
@@ -1327,7 +1628,11 @@ void OREApp::setupLog(const std::string& path, const std::string& file, Size mas
     Log::instance().switchOn();
 }
 
-void OREApp::closeLog() { Log::instance().removeAllLoggers(); }
+void OREApp::closeLog() {
+    // write the pending messages of the asynchronous mode before the loggers are removed
+    Log::instance().switchOffAsync();
+    Log::instance().removeAllLoggers();
+}
 
 } // namespace analytics
 } // namespace ore
@@ -55,6 +55,10 @@ public:
     //! Runs analytics and generates reports after using the second OREApp c'tor
     void run(const std::vector<std::string>& marketData,
              const std::vector<std::string>& fixingData);
+
+    /*! Builds the market and the portfolio once after using the first OREApp c'tor and serves the requests read from
+        \p in, see OREService::serve() */
+    void runService(std::istream& in, std::ostream& out);
     
     boost::shared_ptr<InputParameters> getInputs() { return inputs_; }
 
@@ -83,7 +87,8 @@ protected:
     void buildInputParameters(boost::shared_ptr<InputParameters> inputs,
                               const boost::shared_ptr<Parameters>& params);
     vector<string> getFileNames(const string& fileString, const string& path);
-    boost::shared_ptr<CSVLoader> buildCsvLoader(const boost::shared_ptr<Parameters>& params);
+    //! Loader for the market data, fixing and dividend files, read from a snapshot if possible
+    boost::shared_ptr<Loader> buildCsvLoader(const boost::shared_ptr<Parameters>& params);
     //! set up logging
     void setupLog(const std::string& path, const std::string& file, Size mask,
                   const boost::filesystem::path& logRootPath);
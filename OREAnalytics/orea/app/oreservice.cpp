@@ -0,0 +1,272 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/app/marketdatacsvloader.hpp>
+#include <orea/app/oreservice.hpp>
+#include <orea/app/reportwriter.hpp>
+
+#include <ored/configuration/conventions.hpp>
+#include <ored/marketdata/marketdatumparser.hpp>
+#include <ored/report/csvreport.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/quotes/simplequote.hpp>
+#include <ql/settings.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace ore::data;
+using boost::timer::cpu_timer;
+using boost::timer::default_places;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+std::vector<std::string> readLines(const std::string& fileName) {
+    std::ifstream file(fileName);
+    QL_REQUIRE(file.is_open(), "OREService: error opening file " << fileName);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        boost::trim(line);
+        if (!line.empty() && line[0] != '#')
+            lines.push_back(line);
+    }
+    return lines;
+}
+} // namespace
+
+OREService::OREService(const boost::shared_ptr<InputParameters>& inputs, const boost::shared_ptr<Loader>& loader)
+    : inputs_(inputs), loader_(boost::make_shared<InMemoryLoader>()) {
+    QL_REQUIRE(inputs_, "OREService: input parameters not set");
+    QL_REQUIRE(loader, "OREService: loader not set");
+    for (auto const& md : loader->loadQuotes(inputs_->asof()))
+        loader_->add(md);
+    for (auto const& f : loader->loadFixings())
+        loader_->addFixing(f.date, f.name, f.fixing);
+    for (auto const& d : loader->loadDividends())
+        loader_->addDividend(d);
+    initialise();
+}
+
+OREService::OREService(const boost::shared_ptr<InputParameters>& inputs, const std::vector<std::string>& marketData,
+                       const std::vector<std::string>& fixingData)
+    : inputs_(inputs), loader_(boost::make_shared<InMemoryLoader>()) {
+    QL_REQUIRE(inputs_, "OREService: input parameters not set");
+    loadDataFromBuffers(*loader_, marketData, fixingData, inputs_->implyTodaysFixings());
+    initialise();
+}
+
+void OREService::initialise() {
+    QL_REQUIRE(inputs_->pricingEngine(), "OREService: pricingEngine not set");
+    QL_REQUIRE(inputs_->conventions(), "OREService: conventions not set");
+    QL_REQUIRE(inputs_->todaysMarketParams(), "OREService: todaysMarketParams not set");
+    QL_REQUIRE(inputs_->curveConfigs().has(), "OREService: curve configurations not set");
+
+    Settings::instance().evaluationDate() = inputs_->asof();
+    GlobalPseudoCurrencyMarketParameters::instance().set(inputs_->pricingEngine()->globalParameters());
+    InstrumentConventions::instance().setConventions(inputs_->conventions());
+
+    // the resident portfolio is the one of the inputs, so that analytics see the added and removed trades
+    if (!inputs_->portfolio())
+        inputs_->setPortfolio("<Portfolio/>");
+    portfolio_ = inputs_->portfolio();
+
+    buildMarket();
+}
+
+void OREService::buildMarket() {
+    cpu_timer timer;
+    QL_REQUIRE(loader_->hasQuotes(inputs_->asof()), "OREService: there are no quotes for " << inputs_->asof());
+    market_ = boost::make_shared<TodaysMarket>(inputs_->asof(), inputs_->todaysMarketParams(), loader_,
+                                               inputs_->curveConfigs().get(), inputs_->continueOnError(), true, false,
+                                               inputs_->refDataManager(), true, *inputs_->iborFallbackConfig(), false,
+                                               true, inputs_->parallelMarketBuilding() ? inputs_->nThreads() : 1);
+    engineFactory_ = engineFactory();
+    ++marketBuilds_;
+    marketStale_ = false;
+    portfolioStale_ = true;
+    refresh();
+    timer.stop();
+    LOG("OREService: built market and " << portfolio_->size() << " trades in "
+                                        << timer.format(default_places, "%w") << " sec");
+}
+
+boost::shared_ptr<EngineFactory> OREService::engineFactory() const {
+    auto engineData = boost::make_shared<EngineData>(*inputs_->pricingEngine());
+    engineData->globalParameters()["RunType"] = "NPV";
+    std::map<MarketContext, std::string> configurations;
+    configurations[MarketContext::irCalibration] = inputs_->marketConfig("lgmcalibration");
+    configurations[MarketContext::fxCalibration] = inputs_->marketConfig("fxcalibration");
+    configurations[MarketContext::pricing] = inputs_->marketConfig("pricing");
+    return boost::make_shared<EngineFactory>(engineData, market_, configurations, inputs_->refDataManager(),
+                                             *inputs_->iborFallbackConfig());
+}
+
+void OREService::refresh() {
+    if (marketStale_) {
+        // builds the portfolio, too
+        buildMarket();
+        return;
+    }
+    if (portfolioStale_) {
+        portfolio_->reset();
+        Size nThreads = inputs_->parallelPortfolioBuilding() ? inputs_->nThreads() : 1;
+        portfolio_->build(engineFactory_, "service", true, nThreads);
+        portfolioStale_ = false;
+    }
+}
+
+const boost::shared_ptr<Market>& OREService::market() {
+    refresh();
+    return market_;
+}
+
+const boost::shared_ptr<Portfolio>& OREService::portfolio() {
+    refresh();
+    return portfolio_;
+}
+
+Size OREService::updateQuotes(const std::vector<std::string>& marketData) {
+    InMemoryLoader updates;
+    loadDataFromBuffers(updates, marketData, {}, false);
+    Size updated = 0, added = 0;
+    for (auto const& d : updates.dates()) {
+        for (auto const& md : updates.loadQuotes(d)) {
+            boost::shared_ptr<SimpleQuote> q;
+            if (loader_->has(md->name(), d))
+                q = boost::dynamic_pointer_cast<SimpleQuote>(*loader_->get(md->name(), d)->quote());
+            if (q) {
+                // the market keeps the link to the loader quotes, the dependent objects are notified
+                q->setValue(md->quote()->value());
+                ++updated;
+            } else {
+                loader_->add(md);
+                ++added;
+            }
+        }
+    }
+    if (added > 0)
+        marketStale_ = true;
+    DLOG("OREService: updated " << updated << " quotes, added " << added << " quotes");
+    return updated;
+}
+
+void OREService::addTrades(const std::string& portfolioXml) {
+    refresh();
+    Portfolio trades(portfolio_->buildFailedTrades());
+    trades.fromXMLString(portfolioXml);
+    trades.build(engineFactory_, "service", true);
+    for (auto const& [id, trade] : trades.trades()) {
+        portfolio_->remove(id);
+        portfolio_->add(trade);
+    }
+    DLOG("OREService: added " << trades.size() << " trades, portfolio size is " << portfolio_->size());
+}
+
+Size OREService::removeTrades(const std::set<std::string>& tradeIds) {
+    Size removed = 0;
+    for (auto const& id : tradeIds) {
+        if (portfolio_->remove(id))
+            ++removed;
+    }
+    return removed;
+}
+
+void OREService::writeNpv(Report& report) {
+    refresh();
+    ReportWriter(inputs_->reportNaString())
+        .writeNpv(report, inputs_->baseCurrency(), market_, inputs_->marketConfig("pricing"), portfolio_);
+}
+
+boost::shared_ptr<AnalyticsManager> OREService::runAnalytics(const std::set<std::string>& analytics) {
+    auto manager =
+        boost::make_shared<AnalyticsManager>(inputs_, boost::make_shared<MarketDataCsvLoader>(inputs_, loader_));
+    manager->runAnalytics(analytics);
+    // the analytics build the resident trades against their own markets
+    portfolioStale_ = true;
+    Settings::instance().evaluationDate() = inputs_->asof();
+    return manager;
+}
+
+void OREService::serve(std::istream& in, std::ostream& out, const std::map<std::string, std::string>& reportNames) {
+    std::string line;
+    while (std::getline(in, line)) {
+        boost::trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::vector<std::string> tokens;
+        boost::split(tokens, line, boost::is_any_of(" \t"), boost::token_compress_on);
+        const std::string& request = tokens[0];
+        if (request == "quit")
+            break;
+        cpu_timer timer;
+        try {
+            std::ostringstream result;
+            if (request == "quote") {
+                QL_REQUIRE(tokens.size() == 4, "expected quote <date> <name> <value>");
+                result << updateQuotes({tokens[1] + " " + tokens[2] + " " + tokens[3]}) << " updated";
+            } else if (request == "quotes") {
+                QL_REQUIRE(tokens.size() == 2, "expected quotes <file>");
+                result << updateQuotes(readLines(tokens[1])) << " updated";
+            } else if (request == "trades") {
+                QL_REQUIRE(tokens.size() == 2, "expected trades <file>");
+                std::ifstream file(tokens[1]);
+                QL_REQUIRE(file.is_open(), "error opening file " << tokens[1]);
+                std::stringstream xml;
+                xml << file.rdbuf();
+                addTrades(xml.str());
+                result << portfolio_->size() << " trades";
+            } else if (request == "remove") {
+                QL_REQUIRE(tokens.size() > 1, "expected remove <tradeId> ...");
+                result << removeTrades(std::set<std::string>(tokens.begin() + 1, tokens.end())) << " removed";
+            } else if (request == "npv") {
+                QL_REQUIRE(tokens.size() == 2, "expected npv <file>");
+                CSVFileReport report(tokens[1], inputs_->csvSeparator(), inputs_->csvCommentCharacter(),
+                                     inputs_->csvQuoteChar(), inputs_->reportNaString());
+                writeNpv(report);
+                result << tokens[1];
+            } else if (request == "run") {
+                QL_REQUIRE(tokens.size() == 2, "expected run <analytic>,...");
+                auto analytics = parseListOfValues(tokens[1]);
+                auto manager = runAnalytics(std::set<std::string>(analytics.begin(), analytics.end()));
+                manager->toFile(manager->reports(), inputs_->resultsPath().string(), reportNames,
+                                inputs_->csvSeparator(), inputs_->csvCommentCharacter(), inputs_->csvQuoteChar(),
+                                inputs_->reportNaString());
+                result << inputs_->resultsPath().string();
+            } else {
+                QL_FAIL("unknown request '" << request << "'");
+            }
+            timer.stop();
+            out << "OK " << result.str() << " " << timer.format(default_places, "%w") << std::endl;
+        } catch (const std::exception& e) {
+            ALOG("OREService: request '" << line << "' failed: " << e.what());
+            out << "ERROR " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/app/oreservice.hpp
+  \brief Long lived ORE service keeping the market and the portfolio built between requests
+  \ingroup app
+ */
+
+#pragma once
+
+#include <orea/app/analyticsmanager.hpp>
+#include <orea/app/inputparameters.hpp>
+#include <ored/marketdata/inmemoryloader.hpp>
+#include <ored/marketdata/todaysmarket.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/report/report.hpp>
+
+#include <iosfwd>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Long lived service that loads the static configuration once and keeps the market and the portfolio built
+/*! The conventions, curve configurations and pricing engine configuration are taken from the input parameters once.
+    Today's market is built with the link to the loader quotes preserved, so that updated quotes are set on the
+    existing quotes and only the dependent term structures and trades are recalculated, nothing is rebuilt. Only
+    quotes that were not known to the loader cause a rebuild of the market and the portfolio before the next request.
+
+    Added trades are built against the resident engine factory, so that cached engines are shared with the resident
+    trades. Other analytics are run by an AnalyticsManager on the current quotes and the resident portfolio, they
+    reuse the static configuration but build their own market, the resident trades are rebuilt against the resident
+    market before the next pricing request.
+
+    \ingroup app
+*/
+class OREService {
+public:
+    //! Constructor, the quotes, fixings and dividends of the asof date are taken from the given loader
+    OREService(const boost::shared_ptr<InputParameters>& inputs, const boost::shared_ptr<ore::data::Loader>& loader);
+    //! Constructor taking market data and fixings in the format of OREApp::run()
+    OREService(const boost::shared_ptr<InputParameters>& inputs, const std::vector<std::string>& marketData,
+               const std::vector<std::string>& fixingData);
+
+    /*! Set the given quotes, in the format of OREApp::run(). Returns the number of quotes updated in place, quotes
+        that were not known before are added and trigger a rebuild of the market before the next request. */
+    QuantLib::Size updateQuotes(const std::vector<std::string>& marketData);
+
+    //! Add the trades of the given portfolio XML, trades with an id already in the portfolio are replaced
+    void addTrades(const std::string& portfolioXml);
+    //! Remove the trades with the given ids, returns the number of trades removed
+    QuantLib::Size removeTrades(const std::set<std::string>& tradeIds);
+
+    //! Write the npv report of the resident portfolio, as ReportWriter::writeNpv()
+    void writeNpv(ore::data::Report& report);
+
+    /*! Run the given analytics on the current quotes and the resident portfolio, the returned manager holds the
+        reports and cubes */
+    boost::shared_ptr<AnalyticsManager> runAnalytics(const std::set<std::string>& analytics);
+
+    /*! Serve the requests read line by line from \p in until the end of the input or a quit request, see the user
+        guide for the requests. Each request is answered with a line starting with OK or ERROR. Analytics reports
+        are written to the results path of the inputs with the given file names. */
+    void serve(std::istream& in, std::ostream& out, const std::map<std::string, std::string>& reportNames = {});
+
+    //! \name Inspectors
+    //@{
+    const boost::shared_ptr<InputParameters>& inputs() const { return inputs_; }
+    const boost::shared_ptr<ore::data::InMemoryLoader>& loader() const { return loader_; }
+    const boost::shared_ptr<ore::data::Market>& market();
+    const boost::shared_ptr<ore::data::Portfolio>& portfolio();
+    //! Number of market builds so far, including the initial one
+    QuantLib::Size numberOfMarketBuilds() const { return marketBuilds_; }
+    //@}
+
+private:
+    void initialise();
+    //! Rebuild the market and the portfolio if new quotes were added, rebuild the portfolio if it is stale
+    void refresh();
+    void buildMarket();
+    boost::shared_ptr<ore::data::EngineFactory> engineFactory() const;
+
+    boost::shared_ptr<InputParameters> inputs_;
+    boost::shared_ptr<ore::data::InMemoryLoader> loader_;
+    boost::shared_ptr<ore::data::Market> market_;
+    boost::shared_ptr<ore::data::EngineFactory> engineFactory_;
+    boost::shared_ptr<ore::data::Portfolio> portfolio_;
+    bool marketStale_ = false, portfolioStale_ = false;
+    QuantLib::Size marketBuilds_ = 0;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/app/reportsink.hpp>
+#include <orea/cube/arrow_io.hpp>
+
+#include <ored/report/csvreport.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <boost/make_shared.hpp>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+bool endsWith(const std::string& name, const std::string& suffix) {
+    return name.size() >= suffix.size() && std::equal(suffix.rbegin(), suffix.rend(), name.rbegin());
+}
+} // namespace
+
+CSVReportSinkFactory::CSVReportSinkFactory(const std::string& outputPath, const std::set<std::string>& reportNames,
+                                           const std::map<std::string, std::string>& fileNames, const char sep,
+                                           const bool commentCharacter, char quoteChar, const std::string& nullString)
+    : outputPath_(outputPath), reportNames_(reportNames), fileNames_(fileNames), sep_(sep),
+      commentCharacter_(commentCharacter), quoteChar_(quoteChar), nullString_(nullString) {}
+
+boost::shared_ptr<ore::data::Report> CSVReportSinkFactory::sink(const std::string& type, const std::string& name) {
+    if (reportNames_.find("*") == reportNames_.end() && reportNames_.find(name) == reportNames_.end())
+        return nullptr;
+
+    auto f = fileNames_.find(name);
+    std::string fileName = f != fileNames_.end() && !f->second.empty() ? f->second : name;
+    // arrow files are written from the in memory report at the end of the run
+    if (isArrowFilename(fileName))
+        return nullptr;
+    if (!endsWith(fileName, ".csv") && !endsWith(fileName, ".txt") && !endsWith(fileName, ".gz"))
+        fileName += ".csv";
+    // a report name used by several analytics is prefixed by the analytic type
+    if (!files_.insert(fileName).second) {
+        fileName = type + "_" + fileName;
+        QL_REQUIRE(files_.insert(fileName).second,
+                   "CSVReportSinkFactory: report " << name << " of analytic " << type << " is streamed twice");
+    }
+    std::string fullFileName = outputPath_ + "/" + fileName;
+    LOG("CSVReportSinkFactory: stream report " << name << " of analytic " << type << " to " << fullFileName);
+    return boost::make_shared<ore::data::CSVFileReport>(fullFileName, sep_, commentCharacter_, quoteChar_,
+                                                        nullString_);
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/app/reportsink.hpp
+    \brief Sinks for reports that are streamed while they are produced
+*/
+
+#pragma once
+
+#include <ored/report/report.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Interface for sinks that receive the rows of a report while it is produced
+/*! By default the analytics fill InMemoryReports that are written at the end of the run. If a factory is set in
+    the InputParameters, an analytic asks it for a sink for each report it produces and writes the report to the
+    sink instead. The report is not kept in memory then, see Analytic::report().
+*/
+class ReportSinkFactory {
+public:
+    virtual ~ReportSinkFactory() {}
+    /*! Return the report the report \p name of the analytic type \p type is streamed to, or nullptr if the report
+        is to be kept in memory */
+    virtual boost::shared_ptr<ore::data::Report> sink(const std::string& type, const std::string& name) = 0;
+};
+
+//! Streams the selected reports to csv files in the output path, using the file names of AnalyticsManager::toFile()
+class CSVReportSinkFactory : public ReportSinkFactory {
+public:
+    /*! \param reportNames the reports to stream, "*" streams all reports
+        \param fileNames   optional file names replacing the report names
+    */
+    CSVReportSinkFactory(const std::string& outputPath, const std::set<std::string>& reportNames,
+                         const std::map<std::string, std::string>& fileNames = {}, const char sep = ',',
+                         const bool commentCharacter = false, char quoteChar = '\0',
+                         const std::string& nullString = "#N/A");
+
+    boost::shared_ptr<ore::data::Report> sink(const std::string& type, const std::string& name) override;
+
+    //! The files written so far
+    const std::set<std::string>& files() const { return files_; }
+
+private:
+    std::string outputPath_;
+    std::set<std::string> reportNames_;
+    std::map<std::string, std::string> fileNames_;
+    char sep_;
+    bool commentCharacter_;
+    char quoteChar_;
+    std::string nullString_;
+    std::set<std::string> files_;
+};
+
+} // namespace analytics
+} // namespace ore
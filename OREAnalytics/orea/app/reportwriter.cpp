@@ -43,6 +43,10 @@
 #include <qle/instruments/cashflowresults.hpp>
 #include <stdio.h>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 
 using ore::data::to_string;
 using QuantLib::Date;
@@ -125,453 +129,540 @@ void ReportWriter::writeNpv(ore::data::Report& report, const std::string& baseCu
     LOG("NPV file written");
 }
 
-void ReportWriter::writeCashflow(ore::data::Report& report, const std::string& baseCurrency,
-                                 boost::shared_ptr<ore::data::Portfolio> portfolio,
-                                 boost::shared_ptr<ore::data::Market> market, const std::string& configuration,
-                                 const bool includePastCashflows) {
-
-    Date asof = Settings::instance().evaluationDate();
-
-    LOG("Writing cashflow report for " << asof);
-    report.addColumn("TradeId", string())
-        .addColumn("Type", string())
-        .addColumn("CashflowNo", Size())
-        .addColumn("LegNo", Size())
-        .addColumn("PayDate", Date())
-        .addColumn("FlowType", string())
-        .addColumn("Amount", double(), 4)
-        .addColumn("Currency", string())
-        .addColumn("Coupon", double(), 10)
-        .addColumn("Accrual", double(), 10)
-        .addColumn("AccrualStartDate", Date(), 4)
-        .addColumn("AccrualEndDate", Date(), 4)
-        .addColumn("AccruedAmount", double(), 4)
-        .addColumn("fixingDate", Date())
-        .addColumn("fixingValue", double(), 10)
-        .addColumn("Notional", double(), 4)
-        .addColumn("DiscountFactor", double(), 10)
-        .addColumn("PresentValue", double(), 10)
-        .addColumn("FXRate(Local-Base)", double(), 10)
-        .addColumn("PresentValue(Base)", double(), 10)
-        .addColumn("BaseCurrency", string())
-        .addColumn("FloorStrike", double(), 6)
-        .addColumn("CapStrike", double(), 6)
-        .addColumn("FloorVolatility", double(), 6)
-        .addColumn("CapVolatility", double(), 6);
+namespace {
+
+// the cashflow report columns of one trade, apart from the trade id, trade type and base currency
+struct CashflowColumns {
+    vector<Size> cashflowNo, legNo;
+    vector<Date> payDate;
+    vector<string> flowType, currency;
+    vector<Real> amount, coupon, accrual;
+    vector<Date> accrualStartDate, accrualEndDate;
+    vector<Real> accruedAmount;
+    vector<Date> fixingDate;
+    vector<Real> fixingValue, notional, discountFactor, presentValue, fxRateLocalBase, presentValueBase, floorStrike,
+        capStrike, floorVolatility, capVolatility;
+
+    Size size() const { return cashflowNo.size(); }
+
+    void add(Size cfNo, Size lNo, const Date& pd, const string& ft, Real amt, const string& ccy, Real cpn, Real acc,
+             const Date& accStart, const Date& accEnd, Real accrued, const Date& fd, Real fv, Real ntl, Real df,
+             Real pv, Real fx, Real pvBase, Real fs, Real cs, Real fVol, Real cVol) {
+        cashflowNo.push_back(cfNo);
+        legNo.push_back(lNo);
+        payDate.push_back(pd);
+        flowType.push_back(ft);
+        amount.push_back(amt);
+        currency.push_back(ccy);
+        coupon.push_back(cpn);
+        accrual.push_back(acc);
+        accrualStartDate.push_back(accStart);
+        accrualEndDate.push_back(accEnd);
+        accruedAmount.push_back(accrued);
+        fixingDate.push_back(fd);
+        fixingValue.push_back(fv);
+        notional.push_back(ntl);
+        discountFactor.push_back(df);
+        presentValue.push_back(pv);
+        fxRateLocalBase.push_back(fx);
+        presentValueBase.push_back(pvBase);
+        floorStrike.push_back(fs);
+        capStrike.push_back(cs);
+        floorVolatility.push_back(fVol);
+        capVolatility.push_back(cVol);
+    }
+};
 
-    std::map<std::string, boost::shared_ptr<Trade>> trades = portfolio->trades();
+CashflowColumns extractCashflows(const boost::shared_ptr<Trade>& trade, const std::string& baseCurrency,
+                                 const boost::shared_ptr<ore::data::Market>& market, const std::string& configuration,
+                                 const bool includePastCashflows, const Date& asof) {
 
-    for (auto [tradeId, trade]: trades) {
+    CashflowColumns columns;
 
-        // if trade is marked as not having cashflows, we skip it
+    // if trade is marked as not having cashflows, we skip it
 
-        if (!trade->hasCashflows()) {
-            WLOG("cashflow for " << trade->tradeType() << " " << trade->id() << " skipped");
-            continue;
-        }
+    if (!trade->hasCashflows()) {
+        WLOG("cashflow for " << trade->tradeType() << " " << trade->id() << " skipped");
+        return columns;
+    }
 
-        // if trade provides cashflows as additional results, we use that information instead of the legs
+    // if trade provides cashflows as additional results, we use that information instead of the legs
 
-        bool useAdditionalResults = false;
-        try {
-            const auto& addResults = trade->instrument()->additionalResults();
-            useAdditionalResults = addResults.find("cashFlowResults") != addResults.end();
-        } catch (const std::exception& e) {
-            ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(),
-                                             "Error during cashflow reporting / checking for cashFlowResults",
-                                             e.what()));
-        }
-
-        try {
+    bool useAdditionalResults = false;
+    try {
+        const auto& addResults = trade->instrument()->additionalResults();
+        useAdditionalResults = addResults.find("cashFlowResults") != addResults.end();
+    } catch (const std::exception& e) {
+        ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(),
+                                         "Error during cashflow reporting / checking for cashFlowResults",
+                                         e.what()));
+    }
 
-            const Real multiplier = trade->instrument()->multiplier();
-
-            if (!useAdditionalResults) {
-
-                // leg based cashflow reporting
-
-                const vector<Leg>& legs = trade->legs();
-                for (size_t i = 0; i < legs.size(); i++) {
-                    const QuantLib::Leg& leg = legs[i];
-                    bool payer = trade->legPayers()[i];
-                    string ccy = trade->legCurrencies()[i];
-                    Handle<YieldTermStructure> discountCurve;
-                    if (market)
-                        discountCurve = market->discountCurve(ccy, configuration);
-                    for (size_t j = 0; j < leg.size(); j++) {
-                        boost::shared_ptr<QuantLib::CashFlow> ptrFlow = leg[j];
-                        Date payDate = ptrFlow->date();
-                        if (!ptrFlow->hasOccurred(asof) || includePastCashflows) {
-                            Real amount = ptrFlow->amount();
-                            string flowType = "";
+    try {
+
+        const Real multiplier = trade->instrument()->multiplier();
+
+        if (!useAdditionalResults) {
+
+            // leg based cashflow reporting
+
+            const vector<Leg>& legs = trade->legs();
+            for (size_t i = 0; i < legs.size(); i++) {
+                const QuantLib::Leg& leg = legs[i];
+                bool payer = trade->legPayers()[i];
+                string ccy = trade->legCurrencies()[i];
+                Handle<YieldTermStructure> discountCurve;
+                if (market)
+                    discountCurve = market->discountCurve(ccy, configuration);
+                for (size_t j = 0; j < leg.size(); j++) {
+                    boost::shared_ptr<QuantLib::CashFlow> ptrFlow = leg[j];
+                    Date payDate = ptrFlow->date();
+                    if (!ptrFlow->hasOccurred(asof) || includePastCashflows) {
+                        Real amount = ptrFlow->amount();
+                        string flowType = "";
+                        if (payer)
+                            amount *= -1.0;
+                        std::string ccy = trade->legCurrencies()[i];
+                        boost::shared_ptr<QuantLib::Coupon> ptrCoupon =
+                            boost::dynamic_pointer_cast<QuantLib::Coupon>(ptrFlow);
+                        boost::shared_ptr<QuantExt::CommodityCashFlow> ptrCommCf =
+                            boost::dynamic_pointer_cast<QuantExt::CommodityCashFlow>(ptrFlow);
+                        Real coupon;
+                        Real accrual;
+                        Real notional;
+                        Date accrualStartDate, accrualEndDate;
+                        Real accruedAmount;
+                        if (ptrCoupon) {
+                            coupon = ptrCoupon->rate();
+                            accrual = ptrCoupon->accrualPeriod();
+                            notional = ptrCoupon->nominal();
+                            accrualStartDate = ptrCoupon->accrualStartDate();
+                            accrualEndDate = ptrCoupon->accrualEndDate();
+                            accruedAmount = ptrCoupon->accruedAmount(asof);
                             if (payer)
-                                amount *= -1.0;
-                            std::string ccy = trade->legCurrencies()[i];
-                            boost::shared_ptr<QuantLib::Coupon> ptrCoupon =
-                                boost::dynamic_pointer_cast<QuantLib::Coupon>(ptrFlow);
-                            boost::shared_ptr<QuantExt::CommodityCashFlow> ptrCommCf =
-                                boost::dynamic_pointer_cast<QuantExt::CommodityCashFlow>(ptrFlow);
-                            Real coupon;
-                            Real accrual;
-                            Real notional;
-                            Date accrualStartDate, accrualEndDate;
-                            Real accruedAmount;
-                            if (ptrCoupon) {
-                                coupon = ptrCoupon->rate();
-                                accrual = ptrCoupon->accrualPeriod();
-                                notional = ptrCoupon->nominal();
-                                accrualStartDate = ptrCoupon->accrualStartDate();
-                                accrualEndDate = ptrCoupon->accrualEndDate();
-                                accruedAmount = ptrCoupon->accruedAmount(asof);
-                                if (payer)
-                                    accruedAmount *= -1.0;
-                                flowType = "Interest";
-                            } else if (ptrCommCf) {
-                                coupon = Null<Real>();
-                                accrual = Null<Real>();
-                                notional = ptrCommCf->periodQuantity(); // this is measured in units, e.g. barrels for oil
-                                accrualStartDate = accrualEndDate = Null<Date>();
-                                accruedAmount = Null<Real>();
-                                flowType = "Notional (units)";
-                            } else {
-                                coupon = Null<Real>();
-                                accrual = Null<Real>();
-                                notional = Null<Real>();
-                                accrualStartDate = accrualEndDate = Null<Date>();
-                                accruedAmount = Null<Real>();
-                                flowType = "Notional";
-                            }
-                            // This BMA part here (and below) is necessary because the fixingDay() method of
-                            // AverageBMACoupon returns an exception rather than the last fixing day of the period.
+                                accruedAmount *= -1.0;
+                            flowType = "Interest";
+                        } else if (ptrCommCf) {
+                            coupon = Null<Real>();
+                            accrual = Null<Real>();
+                            notional = ptrCommCf->periodQuantity(); // this is measured in units, e.g. barrels for oil
+                            accrualStartDate = accrualEndDate = Null<Date>();
+                            accruedAmount = Null<Real>();
+                            flowType = "Notional (units)";
+                        } else {
+                            coupon = Null<Real>();
+                            accrual = Null<Real>();
+                            notional = Null<Real>();
+                            accrualStartDate = accrualEndDate = Null<Date>();
+                            accruedAmount = Null<Real>();
+                            flowType = "Notional";
+                        }
+                        // This BMA part here (and below) is necessary because the fixingDay() method of
+                        // AverageBMACoupon returns an exception rather than the last fixing day of the period.
 
-                            boost::shared_ptr<QuantLib::Coupon> cpn =
-                                boost::dynamic_pointer_cast<QuantLib::Coupon>(ptrFlow);
-                            if (cpn) {
-                                ptrFlow = unpackIndexedCoupon(cpn);
+                        boost::shared_ptr<QuantLib::Coupon> cpn =
+                            boost::dynamic_pointer_cast<QuantLib::Coupon>(ptrFlow);
+                        if (cpn) {
+                            ptrFlow = unpackIndexedCoupon(cpn);
+                        }
+                        boost::shared_ptr<AverageBMACoupon> ptrBMA =
+                            boost::dynamic_pointer_cast<QuantLib::AverageBMACoupon>(ptrFlow);
+                        boost::shared_ptr<QuantLib::FloatingRateCoupon> ptrFloat =
+                            boost::dynamic_pointer_cast<QuantLib::FloatingRateCoupon>(ptrFlow);
+                        boost::shared_ptr<QuantLib::InflationCoupon> ptrInfl =
+                            boost::dynamic_pointer_cast<QuantLib::InflationCoupon>(ptrFlow);
+                        boost::shared_ptr<QuantLib::IndexedCashFlow> ptrIndCf =
+                            boost::dynamic_pointer_cast<QuantLib::IndexedCashFlow>(ptrFlow);
+                        boost::shared_ptr<QuantExt::FXLinkedCashFlow> ptrFxlCf =
+                            boost::dynamic_pointer_cast<QuantExt::FXLinkedCashFlow>(ptrFlow);
+                        boost::shared_ptr<QuantExt::EquityCoupon> ptrEqCp =
+                            boost::dynamic_pointer_cast<QuantExt::EquityCoupon>(ptrFlow);
+                        Date fixingDate;
+                        Real fixingValue = Null<Real>();
+                        if (ptrBMA) {
+                            // We return the last fixing inside the coupon period
+                            fixingDate = ptrBMA->fixingDates().end()[-2];
+                            fixingValue = ptrBMA->pricer()->swapletRate();
+                            if (fixingDate > asof)
+                                flowType = "BMAaverage";
+                        } else if (ptrFloat) {
+                            fixingDate = ptrFloat->fixingDate();
+                            try {
+                                fixingValue = ptrFloat->index()->fixing(fixingDate);
+                            } catch (...) {
+                                // catch invalid fixing date, missing fixing, etc. and fall through with
+                                // fixingValue = Null (which appears as NA in the report)
                             }
-                            boost::shared_ptr<AverageBMACoupon> ptrBMA =
-                                boost::dynamic_pointer_cast<QuantLib::AverageBMACoupon>(ptrFlow);
-                            boost::shared_ptr<QuantLib::FloatingRateCoupon> ptrFloat =
-                                boost::dynamic_pointer_cast<QuantLib::FloatingRateCoupon>(ptrFlow);
-                            boost::shared_ptr<QuantLib::InflationCoupon> ptrInfl =
-                                boost::dynamic_pointer_cast<QuantLib::InflationCoupon>(ptrFlow);
-                            boost::shared_ptr<QuantLib::IndexedCashFlow> ptrIndCf =
-                                boost::dynamic_pointer_cast<QuantLib::IndexedCashFlow>(ptrFlow);
-                            boost::shared_ptr<QuantExt::FXLinkedCashFlow> ptrFxlCf =
-                                boost::dynamic_pointer_cast<QuantExt::FXLinkedCashFlow>(ptrFlow);
-                            boost::shared_ptr<QuantExt::EquityCoupon> ptrEqCp =
-                                boost::dynamic_pointer_cast<QuantExt::EquityCoupon>(ptrFlow);
-                            Date fixingDate;
-                            Real fixingValue = Null<Real>();
-                            if (ptrBMA) {
-                                // We return the last fixing inside the coupon period
-                                fixingDate = ptrBMA->fixingDates().end()[-2];
-                                fixingValue = ptrBMA->pricer()->swapletRate();
-                                if (fixingDate > asof)
-                                    flowType = "BMAaverage";
-                            } else if (ptrFloat) {
-                                fixingDate = ptrFloat->fixingDate();
-                                try {
-                                    fixingValue = ptrFloat->index()->fixing(fixingDate);
-                                } catch (...) {
-                                    // catch invalid fixing date, missing fixing, etc. and fall through with
-                                    // fixingValue = Null (which appears as NA in the report)
-                                }
-                                if (fixingDate > asof)
-                                    flowType = "InterestProjected";
-                                if (auto c = boost::dynamic_pointer_cast<QuantLib::IborCoupon>(ptrFloat)) {
-                                    fixingValue = (c->rate() - c->spread()) / c->gearing();
-                                }
-                                if (auto c = boost::dynamic_pointer_cast<QuantLib::CappedFlooredIborCoupon>(ptrFloat)) {
+                            if (fixingDate > asof)
+                                flowType = "InterestProjected";
+                            if (auto c = boost::dynamic_pointer_cast<QuantLib::IborCoupon>(ptrFloat)) {
+                                fixingValue = (c->rate() - c->spread()) / c->gearing();
+                            }
+                            if (auto c = boost::dynamic_pointer_cast<QuantLib::CappedFlooredIborCoupon>(ptrFloat)) {
+                                fixingValue = (c->underlying()->rate() - c->underlying()->spread()) /
+                                               c->underlying()->gearing();
+                            }
+                            if (auto sc = boost::dynamic_pointer_cast<QuantLib::StrippedCappedFlooredCoupon>(ptrFloat)) {
+                                if (auto c = boost::dynamic_pointer_cast<QuantLib::CappedFlooredIborCoupon>(sc->underlying())) {
                                     fixingValue = (c->underlying()->rate() - c->underlying()->spread()) /
                                                    c->underlying()->gearing();
                                 }
-                                if (auto sc = boost::dynamic_pointer_cast<QuantLib::StrippedCappedFlooredCoupon>(ptrFloat)) {
-                                    if (auto c = boost::dynamic_pointer_cast<QuantLib::CappedFlooredIborCoupon>(sc->underlying())) {
-                                        fixingValue = (c->underlying()->rate() - c->underlying()->spread()) /
-                                                       c->underlying()->gearing();
-                                    }
-                                }
-                                // for ON coupons the fixing value is the compounded / averaged rate, not the last
-                                // single ON fixing
-                                if (auto on = boost::dynamic_pointer_cast<QuantExt::AverageONIndexedCoupon>(ptrFloat)) {
-                                    fixingValue = (on->rate() - on->spread()) / on->gearing();
-                                } else if (auto on = boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(
-                                               ptrFloat)) {
-                                    fixingValue = (on->rate() - on->effectiveSpread()) / on->gearing();
-                                } else if (auto c = boost::dynamic_pointer_cast<
-                                               QuantExt::CappedFlooredAverageONIndexedCoupon>(ptrFloat)) {
-                                    fixingValue = (c->underlying()->rate() - c->underlying()->spread()) /
-                                                  c->underlying()->gearing();
-                                } else if (auto c = boost::dynamic_pointer_cast<
-                                               QuantExt::CappedFlooredOvernightIndexedCoupon>(ptrFloat)) {
-                                    fixingValue = (c->underlying()->rate() - c->underlying()->effectiveSpread()) /
-                                                  c->underlying()->gearing();
-                                }
-                                // similar treatment of sub period coupons
-                                if (auto sp = boost::dynamic_pointer_cast<QuantExt::SubPeriodsCoupon1>(ptrFloat)) {
-                                    fixingValue = (sp->rate() - sp->spread()) / sp->gearing();
-                                }
-                            } else if (ptrInfl) {
-                                fixingDate = ptrInfl->fixingDate();
-                                fixingValue = ptrInfl->indexFixing();
-                                flowType = "Inflation";
-                            } else if (ptrIndCf) {
-                                fixingDate = ptrIndCf->fixingDate();
-                                fixingValue = ptrIndCf->indexFixing();
-                                flowType = "Index";
-                            } else if (ptrFxlCf) {
-                                fixingDate = ptrFxlCf->fxFixingDate();
-                                fixingValue = ptrFxlCf->fxRate();
-                            } else if (ptrEqCp) {
-                                fixingDate = ptrEqCp->fixingEndDate();
-                                fixingValue = ptrEqCp->equityCurve()->fixing(fixingDate);
-                            } else if (ptrCommCf) {
-                                fixingDate = ptrCommCf->lastPricingDate();
-                                fixingValue = ptrCommCf->fixing();
-                            } else {
-                                fixingDate = Null<Date>();
-                                fixingValue = Null<Real>();
                             }
+                            // for ON coupons the fixing value is the compounded / averaged rate, not the last
+                            // single ON fixing
+                            if (auto on = boost::dynamic_pointer_cast<QuantExt::AverageONIndexedCoupon>(ptrFloat)) {
+                                fixingValue = (on->rate() - on->spread()) / on->gearing();
+                            } else if (auto on = boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(
+                                           ptrFloat)) {
+                                fixingValue = (on->rate() - on->effectiveSpread()) / on->gearing();
+                            } else if (auto c = boost::dynamic_pointer_cast<
+                                           QuantExt::CappedFlooredAverageONIndexedCoupon>(ptrFloat)) {
+                                fixingValue = (c->underlying()->rate() - c->underlying()->spread()) /
+                                              c->underlying()->gearing();
+                            } else if (auto c = boost::dynamic_pointer_cast<
+                                           QuantExt::CappedFlooredOvernightIndexedCoupon>(ptrFloat)) {
+                                fixingValue = (c->underlying()->rate() - c->underlying()->effectiveSpread()) /
+                                              c->underlying()->gearing();
+                            }
+                            // similar treatment of sub period coupons
+                            if (auto sp = boost::dynamic_pointer_cast<QuantExt::SubPeriodsCoupon1>(ptrFloat)) {
+                                fixingValue = (sp->rate() - sp->spread()) / sp->gearing();
+                            }
+                        } else if (ptrInfl) {
+                            fixingDate = ptrInfl->fixingDate();
+                            fixingValue = ptrInfl->indexFixing();
+                            flowType = "Inflation";
+                        } else if (ptrIndCf) {
+                            fixingDate = ptrIndCf->fixingDate();
+                            fixingValue = ptrIndCf->indexFixing();
+                            flowType = "Index";
+                        } else if (ptrFxlCf) {
+                            fixingDate = ptrFxlCf->fxFixingDate();
+                            fixingValue = ptrFxlCf->fxRate();
+                        } else if (ptrEqCp) {
+                            fixingDate = ptrEqCp->fixingEndDate();
+                            fixingValue = ptrEqCp->equityCurve()->fixing(fixingDate);
+                        } else if (ptrCommCf) {
+                            fixingDate = ptrCommCf->lastPricingDate();
+                            fixingValue = ptrCommCf->fixing();
+                        } else {
+                            fixingDate = Null<Date>();
+                            fixingValue = Null<Real>();
+                        }
 
-                            Real effectiveAmount = Null<Real>();
-                            Real discountFactor = Null<Real>();
-                            Real presentValue = Null<Real>();
-                            Real presentValueBase = Null<Real>();
-                            Real fxRateLocalBase = Null<Real>();
-                            Real floorStrike = Null<Real>();
-                            Real capStrike = Null<Real>();
-                            Real floorVolatility = Null<Real>();
-                            Real capVolatility = Null<Real>();
-
-                            if (amount != Null<Real>())
-                                effectiveAmount = amount * multiplier;
-
-                            if (market) {
-                                discountFactor = ptrFlow->hasOccurred(asof) ? 0.0 : discountCurve->discount(payDate);
+                        Real effectiveAmount = Null<Real>();
+                        Real discountFactor = Null<Real>();
+                        Real presentValue = Null<Real>();
+                        Real presentValueBase = Null<Real>();
+                        Real fxRateLocalBase = Null<Real>();
+                        Real floorStrike = Null<Real>();
+                        Real capStrike = Null<Real>();
+                        Real floorVolatility = Null<Real>();
+                        Real capVolatility = Null<Real>();
+
+                        if (amount != Null<Real>())
+                            effectiveAmount = amount * multiplier;
+
+                        if (market) {
+                            discountFactor = ptrFlow->hasOccurred(asof) ? 0.0 : discountCurve->discount(payDate);
 				if(effectiveAmount != Null<Real>())
 				    presentValue = discountFactor * effectiveAmount;
-                                try {
-                                    fxRateLocalBase = market->fxRate(ccy + baseCurrency)->value();
-                                    presentValueBase = presentValue * fxRateLocalBase;
-                                } catch (...) {
-                                }
+                            try {
+                                fxRateLocalBase = market->fxRate(ccy + baseCurrency)->value();
+                                presentValueBase = presentValue * fxRateLocalBase;
+                            } catch (...) {
+                            }
 
-                                // scan for known capped / floored coupons and extract cap / floor strike and fixing
-                                // date
+                            // scan for known capped / floored coupons and extract cap / floor strike and fixing
+                            // date
 
-                                // unpack stripped cap/floor coupon
-                                boost::shared_ptr<CashFlow> c = ptrFlow;
-                                if (auto tmp = boost::dynamic_pointer_cast<StrippedCappedFlooredCoupon>(ptrFlow)) {
-                                    c = tmp->underlying();
-                                }
-                                Date volFixingDate;
-                                std::string qlIndexName; // index used to retrieve vol
-                                bool usesCapVol = false, usesSwaptionVol = false;
-                                Period swaptionTenor;
-                                if (auto tmp = boost::dynamic_pointer_cast<CappedFlooredCoupon>(c)) {
-                                    floorStrike = tmp->effectiveFloor();
-                                    capStrike = tmp->effectiveCap();
-                                    volFixingDate = tmp->fixingDate();
-                                    qlIndexName = tmp->index()->name();
-                                    if (auto cms = boost::dynamic_pointer_cast<CmsCoupon>(tmp->underlying())) {
-                                        swaptionTenor = cms->swapIndex()->tenor();
-                                        qlIndexName = cms->swapIndex()->iborIndex()->name();
-                                        usesSwaptionVol = true;
-                                    } else if (auto ibor = boost::dynamic_pointer_cast<IborCoupon>(tmp->underlying())) {
-                                        qlIndexName = ibor->index()->name();
-                                        usesCapVol = true;
-                                    }
-                                } else if (auto tmp =
-                                               boost::dynamic_pointer_cast<CappedFlooredOvernightIndexedCoupon>(c)) {
-                                    floorStrike = tmp->effectiveFloor();
-                                    capStrike = tmp->effectiveCap();
-                                    volFixingDate = tmp->underlying()->fixingDates().front();
-                                    qlIndexName = tmp->index()->name();
-                                    usesCapVol = true;
-                                    // for now we output the stripped caplet vol, not the effective one
-                                    // capVolatility = tmp->effectiveCapletVolatility();
-                                    // floorVolatility = tmp->effectiveFloorletVolatility();
-                                } else if (auto tmp =
-                                               boost::dynamic_pointer_cast<CappedFlooredAverageONIndexedCoupon>(c)) {
-                                    floorStrike = tmp->effectiveFloor();
-                                    capStrike = tmp->effectiveCap();
-                                    volFixingDate = tmp->underlying()->fixingDates().front();
-                                    qlIndexName = tmp->index()->name();
+                            // unpack stripped cap/floor coupon
+                            boost::shared_ptr<CashFlow> c = ptrFlow;
+                            if (auto tmp = boost::dynamic_pointer_cast<StrippedCappedFlooredCoupon>(ptrFlow)) {
+                                c = tmp->underlying();
+                            }
+                            Date volFixingDate;
+                            std::string qlIndexName; // index used to retrieve vol
+                            bool usesCapVol = false, usesSwaptionVol = false;
+                            Period swaptionTenor;
+                            if (auto tmp = boost::dynamic_pointer_cast<CappedFlooredCoupon>(c)) {
+                                floorStrike = tmp->effectiveFloor();
+                                capStrike = tmp->effectiveCap();
+                                volFixingDate = tmp->fixingDate();
+                                qlIndexName = tmp->index()->name();
+                                if (auto cms = boost::dynamic_pointer_cast<CmsCoupon>(tmp->underlying())) {
+                                    swaptionTenor = cms->swapIndex()->tenor();
+                                    qlIndexName = cms->swapIndex()->iborIndex()->name();
+                                    usesSwaptionVol = true;
+                                } else if (auto ibor = boost::dynamic_pointer_cast<IborCoupon>(tmp->underlying())) {
+                                    qlIndexName = ibor->index()->name();
                                     usesCapVol = true;
-                                    // capVolatility = tmp->effectiveCapletVolatility();
-                                    // for now we output the stripped caplet vol, not the effective one
-                                    // floorVolatility = tmp->effectiveFloorletVolatility();
                                 }
+                            } else if (auto tmp =
+                                           boost::dynamic_pointer_cast<CappedFlooredOvernightIndexedCoupon>(c)) {
+                                floorStrike = tmp->effectiveFloor();
+                                capStrike = tmp->effectiveCap();
+                                volFixingDate = tmp->underlying()->fixingDates().front();
+                                qlIndexName = tmp->index()->name();
+                                usesCapVol = true;
+                                // for now we output the stripped caplet vol, not the effective one
+                                // capVolatility = tmp->effectiveCapletVolatility();
+                                // floorVolatility = tmp->effectiveFloorletVolatility();
+                            } else if (auto tmp =
+                                           boost::dynamic_pointer_cast<CappedFlooredAverageONIndexedCoupon>(c)) {
+                                floorStrike = tmp->effectiveFloor();
+                                capStrike = tmp->effectiveCap();
+                                volFixingDate = tmp->underlying()->fixingDates().front();
+                                qlIndexName = tmp->index()->name();
+                                usesCapVol = true;
+                                // capVolatility = tmp->effectiveCapletVolatility();
+                                // for now we output the stripped caplet vol, not the effective one
+                                // floorVolatility = tmp->effectiveFloorletVolatility();
+                            }
 
-                                // get market volaility for cap / floor
-
-                                if (volFixingDate != Date() && fixingDate > market->asofDate()) {
-                                    volFixingDate = std::max(volFixingDate, market->asofDate() + 1);
-                                    if (floorStrike != Null<Real>()) {
-                                        if (usesSwaptionVol) {
-                                            floorVolatility =
-                                                market
-                                                    ->swaptionVol(IndexNameTranslator::instance().oreName(qlIndexName),
-                                                                  configuration)
-                                                    ->volatility(volFixingDate, swaptionTenor, floorStrike);
-                                        } else if (usesCapVol && floorVolatility == Null<Real>()) {
-                                            floorVolatility =
-                                                market
-                                                    ->capFloorVol(IndexNameTranslator::instance().oreName(qlIndexName),
-                                                                  configuration)
-                                                    ->volatility(volFixingDate, floorStrike);
-                                        }
+                            // get market volaility for cap / floor
+
+                            if (volFixingDate != Date() && fixingDate > market->asofDate()) {
+                                volFixingDate = std::max(volFixingDate, market->asofDate() + 1);
+                                if (floorStrike != Null<Real>()) {
+                                    if (usesSwaptionVol) {
+                                        floorVolatility =
+                                            market
+                                                ->swaptionVol(IndexNameTranslator::instance().oreName(qlIndexName),
+                                                              configuration)
+                                                ->volatility(volFixingDate, swaptionTenor, floorStrike);
+                                    } else if (usesCapVol && floorVolatility == Null<Real>()) {
+                                        floorVolatility =
+                                            market
+                                                ->capFloorVol(IndexNameTranslator::instance().oreName(qlIndexName),
+                                                              configuration)
+                                                ->volatility(volFixingDate, floorStrike);
                                     }
-                                    if (capStrike != Null<Real>()) {
-                                        if (usesSwaptionVol) {
-                                            capVolatility =
-                                                market
-                                                    ->swaptionVol(IndexNameTranslator::instance().oreName(qlIndexName),
-                                                                  configuration)
-                                                    ->volatility(volFixingDate, swaptionTenor, capStrike);
-                                        } else if (usesCapVol && capVolatility == Null<Real>()) {
-                                            capVolatility =
-                                                market
-                                                    ->capFloorVol(IndexNameTranslator::instance().oreName(qlIndexName),
-                                                                  configuration)
-                                                    ->volatility(volFixingDate, capStrike);
-                                        }
+                                }
+                                if (capStrike != Null<Real>()) {
+                                    if (usesSwaptionVol) {
+                                        capVolatility =
+                                            market
+                                                ->swaptionVol(IndexNameTranslator::instance().oreName(qlIndexName),
+                                                              configuration)
+                                                ->volatility(volFixingDate, swaptionTenor, capStrike);
+                                    } else if (usesCapVol && capVolatility == Null<Real>()) {
+                                        capVolatility =
+                                            market
+                                                ->capFloorVol(IndexNameTranslator::instance().oreName(qlIndexName),
+                                                              configuration)
+                                                ->volatility(volFixingDate, capStrike);
                                     }
                                 }
                             }
-
-                            report.next()
-                                .add(trade->id())
-                                .add(trade->tradeType())
-                                .add(j + 1)
-                                .add(i)
-                                .add(payDate)
-                                .add(flowType)
-                                .add(effectiveAmount)
-                                .add(ccy)
-                                .add(coupon)
-                                .add(accrual)
-                                .add(accrualStartDate)
-                                .add(accrualEndDate)
-                                .add(accruedAmount * (accruedAmount == Null<Real>() ? 1.0 : multiplier))
-                                .add(fixingDate)
-                                .add(fixingValue)
-                                .add(notional * (notional == Null<Real>() ? 1.0 : multiplier))
-                                .add(discountFactor)
-                                .add(presentValue)
-                                .add(fxRateLocalBase)
-                                .add(presentValueBase)
-                                .add(baseCurrency)
-                                .add(floorStrike)
-                                .add(capStrike)
-                                .add(floorVolatility)
-                                .add(capVolatility);
                         }
+
+                        columns.add(j + 1, i, payDate, flowType, effectiveAmount, ccy, coupon, accrual,
+                                    accrualStartDate, accrualEndDate,
+                                    accruedAmount * (accruedAmount == Null<Real>() ? 1.0 : multiplier), fixingDate,
+                                    fixingValue, notional * (notional == Null<Real>() ? 1.0 : multiplier),
+                                    discountFactor, presentValue, fxRateLocalBase, presentValueBase, floorStrike,
+                                    capStrike, floorVolatility, capVolatility);
                     }
                 }
+            }
 
-            } else {
-
-                // additional result based cashflow reporting
-
-                auto tmp = trade->instrument()->additionalResults().find("cashFlowResults");
-                QL_REQUIRE(
-                    tmp != trade->instrument()->additionalResults().end(),
-                    "internal error: expected cashFlowResults in additional results when writing cashflow report");
-                QL_REQUIRE(tmp->second.type() == typeid(std::vector<CashFlowResults>),
-                           "cashflowResults type not handlded");
-                std::vector<CashFlowResults> cfResults = boost::any_cast<std::vector<CashFlowResults>>(tmp->second);
-                std::map<Size, Size> cashflowNumber;
-                for (auto const& cf : cfResults) {
-                    string ccy = "";
-                    if (!cf.currency.empty()) {
-                        ccy = cf.currency;
-                    } else if (trade->legCurrencies().size() > cf.legNumber) {
-                        ccy = trade->legCurrencies()[cf.legNumber];
-                    } else {
-                        ccy = trade->npvCurrency();
-                    }
+        } else {
+
+            // additional result based cashflow reporting
+
+            auto tmp = trade->instrument()->additionalResults().find("cashFlowResults");
+            QL_REQUIRE(
+                tmp != trade->instrument()->additionalResults().end(),
+                "internal error: expected cashFlowResults in additional results when writing cashflow report");
+            QL_REQUIRE(tmp->second.type() == typeid(std::vector<CashFlowResults>),
+                       "cashflowResults type not handlded");
+            std::vector<CashFlowResults> cfResults = boost::any_cast<std::vector<CashFlowResults>>(tmp->second);
+            std::map<Size, Size> cashflowNumber;
+            for (auto const& cf : cfResults) {
+                string ccy = "";
+                if (!cf.currency.empty()) {
+                    ccy = cf.currency;
+                } else if (trade->legCurrencies().size() > cf.legNumber) {
+                    ccy = trade->legCurrencies()[cf.legNumber];
+                } else {
+                    ccy = trade->npvCurrency();
+                }
 
-                    Real effectiveAmount = Null<Real>();
-                    Real discountFactor = Null<Real>();
-                    Real presentValue = Null<Real>();
-                    Real presentValueBase = Null<Real>();
-                    Real fxRateLocalBase = Null<Real>();
-                    Real floorStrike = Null<Real>();
-                    Real capStrike = Null<Real>();
-                    Real floorVolatility = Null<Real>();
-                    Real capVolatility = Null<Real>();
-
-                    if (cf.amount != Null<Real>())
-                        effectiveAmount = cf.amount * multiplier;
-                    if (cf.discountFactor != Null<Real>())
-                        discountFactor = cf.discountFactor;
-                    else if (!cf.currency.empty() && cf.payDate != Null<Date>() && market) {
-                        discountFactor = cf.payDate < asof
-                                             ? 0.0
-                                             : market->discountCurve(cf.currency, configuration)->discount(cf.payDate);
-                    }
-                    if (cf.presentValue != Null<Real>()) {
-                        presentValue = cf.presentValue * multiplier;
-                    } else if (effectiveAmount != Null<Real>() && discountFactor != Null<Real>()) {
-                        presentValue = effectiveAmount * discountFactor;
-                    }
-                    if (cf.fxRateLocalBase != Null<Real>()) {
-                        fxRateLocalBase = cf.fxRateLocalBase;
-                    } else if (market) {
-                        try {
-                            fxRateLocalBase = market->fxRate(ccy + baseCurrency)->value();
-                        } catch (...) {
-                        }
-                    }
-                    if (cf.presentValueBase != Null<Real>()) {
-                        presentValueBase = cf.presentValueBase;
-                    } else if (presentValue != Null<Real>() && fxRateLocalBase != Null<Real>()) {
-                        presentValueBase = presentValue * fxRateLocalBase;
+                Real effectiveAmount = Null<Real>();
+                Real discountFactor = Null<Real>();
+                Real presentValue = Null<Real>();
+                Real presentValueBase = Null<Real>();
+                Real fxRateLocalBase = Null<Real>();
+                Real floorStrike = Null<Real>();
+                Real capStrike = Null<Real>();
+                Real floorVolatility = Null<Real>();
+                Real capVolatility = Null<Real>();
+
+                if (cf.amount != Null<Real>())
+                    effectiveAmount = cf.amount * multiplier;
+                if (cf.discountFactor != Null<Real>())
+                    discountFactor = cf.discountFactor;
+                else if (!cf.currency.empty() && cf.payDate != Null<Date>() && market) {
+                    discountFactor = cf.payDate < asof
+                                         ? 0.0
+                                         : market->discountCurve(cf.currency, configuration)->discount(cf.payDate);
+                }
+                if (cf.presentValue != Null<Real>()) {
+                    presentValue = cf.presentValue * multiplier;
+                } else if (effectiveAmount != Null<Real>() && discountFactor != Null<Real>()) {
+                    presentValue = effectiveAmount * discountFactor;
+                }
+                if (cf.fxRateLocalBase != Null<Real>()) {
+                    fxRateLocalBase = cf.fxRateLocalBase;
+                } else if (market) {
+                    try {
+                        fxRateLocalBase = market->fxRate(ccy + baseCurrency)->value();
+                    } catch (...) {
                     }
-                    if (cf.floorStrike != Null<Real>())
-                        floorStrike = cf.floorStrike;
-                    if (cf.capStrike != Null<Real>())
-                        capStrike = cf.capStrike;
-                    if (cf.floorVolatility != Null<Real>())
-                        floorVolatility = cf.floorVolatility;
-                    if (cf.capVolatility != Null<Real>())
-                        capVolatility = cf.capVolatility;
-
-                    report.next()
-                        .add(trade->id())
-                        .add(trade->tradeType())
-                        .add(++cashflowNumber[cf.legNumber])
-                        .add(cf.legNumber)
-                        .add(cf.payDate)
-                        .add(cf.type)
-                        .add(effectiveAmount)
-                        .add(ccy)
-                        .add(cf.rate)
-                        .add(cf.accrualPeriod)
-                        .add(cf.accrualStartDate)
-                        .add(cf.accrualEndDate)
-                        .add(cf.accruedAmount * (cf.accruedAmount == Null<Real>() ? 1.0 : multiplier))
-                        .add(cf.fixingDate)
-                        .add(cf.fixingValue)
-                        .add(cf.notional * (cf.notional == Null<Real>() ? 1.0 : multiplier))
-                        .add(discountFactor)
-                        .add(presentValue)
-                        .add(fxRateLocalBase)
-                        .add(presentValueBase)
-                        .add(baseCurrency)
-                        .add(floorStrike)
-                        .add(capStrike)
-                        .add(floorVolatility)
-                        .add(capVolatility);
                 }
+                if (cf.presentValueBase != Null<Real>()) {
+                    presentValueBase = cf.presentValueBase;
+                } else if (presentValue != Null<Real>() && fxRateLocalBase != Null<Real>()) {
+                    presentValueBase = presentValue * fxRateLocalBase;
+                }
+                if (cf.floorStrike != Null<Real>())
+                    floorStrike = cf.floorStrike;
+                if (cf.capStrike != Null<Real>())
+                    capStrike = cf.capStrike;
+                if (cf.floorVolatility != Null<Real>())
+                    floorVolatility = cf.floorVolatility;
+                if (cf.capVolatility != Null<Real>())
+                    capVolatility = cf.capVolatility;
+
+                columns.add(++cashflowNumber[cf.legNumber], cf.legNumber, cf.payDate, cf.type, effectiveAmount, ccy,
+                            cf.rate, cf.accrualPeriod, cf.accrualStartDate, cf.accrualEndDate,
+                            cf.accruedAmount * (cf.accruedAmount == Null<Real>() ? 1.0 : multiplier), cf.fixingDate,
+                            cf.fixingValue, cf.notional * (cf.notional == Null<Real>() ? 1.0 : multiplier),
+                            discountFactor, presentValue, fxRateLocalBase, presentValueBase, floorStrike, capStrike,
+                            floorVolatility, capVolatility);
             }
+        }
 
-        } catch (std::exception& e) {
-            ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "Error during cashflow report generation",
-                                             e.what()));
+    } catch (std::exception& e) {
+        ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "Error during cashflow report generation",
+                                         e.what()));
+    }
+
+    return columns;
+}
+
+} // namespace
+
+void ReportWriter::writeCashflow(ore::data::Report& report, const std::string& baseCurrency,
+                                 boost::shared_ptr<ore::data::Portfolio> portfolio,
+                                 boost::shared_ptr<ore::data::Market> market, const std::string& configuration,
+                                 const bool includePastCashflows, const Size nThreads) {
+
+    Date asof = Settings::instance().evaluationDate();
+
+    LOG("Writing cashflow report for " << asof);
+    report.addColumn("TradeId", string())
+        .addColumn("Type", string())
+        .addColumn("CashflowNo", Size())
+        .addColumn("LegNo", Size())
+        .addColumn("PayDate", Date())
+        .addColumn("FlowType", string())
+        .addColumn("Amount", double(), 4)
+        .addColumn("Currency", string())
+        .addColumn("Coupon", double(), 10)
+        .addColumn("Accrual", double(), 10)
+        .addColumn("AccrualStartDate", Date(), 4)
+        .addColumn("AccrualEndDate", Date(), 4)
+        .addColumn("AccruedAmount", double(), 4)
+        .addColumn("fixingDate", Date())
+        .addColumn("fixingValue", double(), 10)
+        .addColumn("Notional", double(), 4)
+        .addColumn("DiscountFactor", double(), 10)
+        .addColumn("PresentValue", double(), 10)
+        .addColumn("FXRate(Local-Base)", double(), 10)
+        .addColumn("PresentValue(Base)", double(), 10)
+        .addColumn("BaseCurrency", string())
+        .addColumn("FloorStrike", double(), 6)
+        .addColumn("CapStrike", double(), 6)
+        .addColumn("FloorVolatility", double(), 6)
+        .addColumn("CapVolatility", double(), 6);
+
+    vector<boost::shared_ptr<Trade>> trades;
+    for (auto const& [tradeId, trade] : portfolio->trades())
+        trades.push_back(trade);
+
+    // the cashflows are extracted per trade, on several threads if requested, and written in the order of the trades
+    vector<CashflowColumns> columns(trades.size());
+    Size nWorkers = std::min(nThreads, trades.size());
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN) || defined(QL_ENABLE_SESSIONS)
+    if (nWorkers > 1) {
+        WLOG("Cashflow report: parallel extraction with " << nThreads
+                                                          << " threads requires a QuantLib build with "
+                                                             "QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without "
+                                                             "QL_ENABLE_SESSIONS, extract sequentially");
+        nWorkers = 1;
+    }
+#endif
+    if (nWorkers > 1) {
+        LOG("Extract the cashflows of " << trades.size() << " trades on " << nWorkers << " threads");
+        vector<std::exception_ptr> errors(nWorkers);
+        std::atomic<Size> next(0);
+        vector<std::thread> workers;
+        for (Size w = 0; w < nWorkers; ++w) {
+            workers.emplace_back([&trades, &columns, &errors, &next, &baseCurrency, &market, &configuration,
+                                  includePastCashflows, &asof, w]() {
+                try {
+                    for (Size i = next++; i < trades.size(); i = next++)
+                        columns[i] = extractCashflows(trades[i], baseCurrency, market, configuration,
+                                                      includePastCashflows, asof);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
+        for (auto const& e : errors)
+            if (e)
+                std::rethrow_exception(e);
+    } else {
+        for (Size i = 0; i < trades.size(); ++i)
+            columns[i] = extractCashflows(trades[i], baseCurrency, market, configuration, includePastCashflows, asof);
+    }
+
+    for (Size i = 0; i < trades.size(); ++i) {
+        const CashflowColumns& c = columns[i];
+        for (Size k = 0; k < c.size(); ++k) {
+            report.next()
+                .add(trades[i]->id())
+                .add(trades[i]->tradeType())
+                .add(c.cashflowNo[k])
+                .add(c.legNo[k])
+                .add(c.payDate[k])
+                .add(c.flowType[k])
+                .add(c.amount[k])
+                .add(c.currency[k])
+                .add(c.coupon[k])
+                .add(c.accrual[k])
+                .add(c.accrualStartDate[k])
+                .add(c.accrualEndDate[k])
+                .add(c.accruedAmount[k])
+                .add(c.fixingDate[k])
+                .add(c.fixingValue[k])
+                .add(c.notional[k])
+                .add(c.discountFactor[k])
+                .add(c.presentValue[k])
+                .add(c.fxRateLocalBase[k])
+                .add(c.presentValueBase[k])
+                .add(baseCurrency)
+                .add(c.floorStrike[k])
+                .add(c.capStrike[k])
+                .add(c.floorVolatility[k])
+                .add(c.capVolatility[k]);
         }
+        // release the columns of the trade once they are written
+        columns[i] = CashflowColumns();
     }
     report.end();
     LOG("Cashflow report written");
@@ -602,11 +693,11 @@ void ReportWriter::writeCashflowNpv(ore::data::Report& report, const ore::data::
     map<string, Real> npvMap;
     Date asof = Settings::instance().evaluationDate();
     for (Size i = 0; i < cashflowReport.rows(); ++i) {
-        string tradeId = boost::get<string>(cashflowReport.data(tradeIdColumn).at(i));
-        string tradeType = boost::get<string>(cashflowReport.data(tradeTypeColumn).at(i));
-        Date payDate = boost::get<Date>(cashflowReport.data(payDateColumn).at(i));
-        string ccy = boost::get<string>(cashflowReport.data(ccyColumn).at(i));
-        Real pv = boost::get<Real>(cashflowReport.data(pvColumn).at(i));
+        string tradeId = boost::get<string>(cashflowReport.value(tradeIdColumn, i));
+        string tradeType = boost::get<string>(cashflowReport.value(tradeTypeColumn, i));
+        Date payDate = boost::get<Date>(cashflowReport.value(payDateColumn, i));
+        string ccy = boost::get<string>(cashflowReport.value(ccyColumn, i));
+        Real pv = boost::get<Real>(cashflowReport.value(pvColumn, i));
         Real fx = 1.0;
 	// There shouldn't be entries in the cf report without ccy. We assume ccy = baseCcy in this case and log an error.
         if (ccy.empty()) {
@@ -1073,6 +1164,29 @@ void ReportWriter::writeScenarioReport(ore::data::Report& report,
     LOG("Scenario report finished");
 }
 
+void ReportWriter::writeSkippedCrossGammaReport(
+    ore::data::Report& report,
+    const std::map<SensitivityCube::crossPair, std::pair<Real, Real>>& skippedPairs) {
+
+    LOG("Writing skipped cross gamma report");
+
+    report.addColumn("Factor_1", string());
+    report.addColumn("Factor_2", string());
+    report.addColumn("MaxAbsDelta_1", double(), 2);
+    report.addColumn("MaxAbsDelta_2", double(), 2);
+
+    for (auto const& [factors, deltas] : skippedPairs) {
+        report.next();
+        report.add(prettyPrintInternalCurveName(to_string(factors.first)));
+        report.add(prettyPrintInternalCurveName(to_string(factors.second)));
+        report.add(deltas.first);
+        report.add(deltas.second);
+    }
+
+    report.end();
+    LOG("Skipped cross gamma report finished");
+}
+
 void ReportWriter::writeSensitivityReport(Report& report, const boost::shared_ptr<SensitivityStream>& ss,
                                           Real outputThreshold, Size outputPrecision) {
 
@@ -1357,6 +1471,67 @@ void ReportWriter::writePricingStats(ore::data::Report& report, const boost::sha
     LOG("Pricing stats report written");
 }
 
+void ReportWriter::writeMemoryBreakdown(ore::data::Report& report,
+                                        const std::vector<ore::data::MemoryAccounting::Entry>& entries) {
+
+    LOG("Writing memory breakdown report");
+
+    report.addColumn("Phase", string())
+        .addColumn("Subsystem", string())
+        .addColumn("Name", string())
+        .addColumn("Count", Size())
+        .addColumn("Bytes", Size());
+
+    for (auto const& e : entries)
+        report.next().add(e.phase).add(e.subsystem).add(e.name).add(e.count).add(e.bytes);
+
+    report.end();
+    LOG("Memory breakdown report written");
+}
+
+void ReportWriter::writeRuntimes(ore::data::Report& report, const ValuationEngineTimings& timings) {
+
+    LOG("Writing runtimes report");
+
+    report.addColumn("Category", string())
+        .addColumn("Name", string())
+        .addColumn("TradeType", string())
+        .addColumn("Count", Size())
+        .addColumn("WallTime", Size())
+        .addColumn("CpuTime", Size())
+        .addColumn("AverageWallTime", Size());
+
+    auto addRow = [&report](const string& category, const string& name, const string& tradeType,
+                            const ValuationEngineTimings::Timing& t) {
+        Size wall = t.wall / 1000;
+        Size cpu = t.cpu / 1000;
+        report.next().add(category).add(name).add(tradeType).add(t.count).add(wall).add(cpu).add(
+            t.count > 0 ? wall / t.count : 0);
+    };
+
+    map<string, ValuationEngineTimings::Timing> tradeTypes;
+    for (auto const& [tid, t] : timings.trades) {
+        auto tt = timings.tradeTypes.find(tid);
+        tradeTypes[tt == timings.tradeTypes.end() ? string() : tt->second].add(t);
+    }
+
+    for (auto const& [name, t] : timings.phases)
+        addRow("Phase", name, "", t);
+    for (auto const& [name, t] : timings.marketUpdates)
+        addRow("MarketUpdate", name, "", t);
+    for (auto const& [name, t] : timings.calculators)
+        addRow("Calculator", name, "", t);
+    for (auto const& [name, t] : tradeTypes)
+        addRow("TradeType", name, name, t);
+    for (auto const& [tid, t] : timings.trades) {
+        auto tt = timings.tradeTypes.find(tid);
+        addRow("Trade", tid, tt == timings.tradeTypes.end() ? string() : tt->second, t);
+    }
+
+    report.end();
+    LOG("Runtimes report written");
+}
+
 void ReportWriter::writeCube(ore::data::Report& report, const boost::shared_ptr<NPVCube>& cube,
                              const std::map<std::string, std::string>& nettingSetMap) {
     LOG("Writing cube report");
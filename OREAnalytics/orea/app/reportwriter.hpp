@@ -29,6 +29,7 @@
 #include <orea/app/parameters.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
+#include <orea/engine/valuationengine.hpp>
 #include <orea/engine/sensitivitystream.hpp>
 #include <orea/simm/crifrecord.hpp>
 #include <orea/simm/simmresults.hpp>
@@ -40,6 +41,7 @@
 #include <ored/report/report.hpp>
 #include <ored/report/inmemoryreport.hpp>
 #include <ored/utilities/dategrid.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <string>
 
@@ -65,7 +67,7 @@ public:
                                boost::shared_ptr<ore::data::Portfolio> portfolio,
                                boost::shared_ptr<ore::data::Market> market = boost::shared_ptr<ore::data::Market>(),
                                const std::string& configuration = ore::data::Market::defaultConfiguration,
-                               const bool includePastCashflows = false);
+                               const bool includePastCashflows = false, const QuantLib::Size nThreads = 1);
 
     virtual void writeCashflowNpv(ore::data::Report& report,
                                   const ore::data::InMemoryReport& cashflowReport,
@@ -101,6 +103,11 @@ public:
                                      const boost::shared_ptr<SensitivityCube>& sensitivityCube,
                                      QuantLib::Real outputThreshold = 0.0);
 
+    //! Write the cross gamma pairs skipped by the materiality check, see SensitivityAnalysis::skippedCrossGammaPairs()
+    virtual void writeSkippedCrossGammaReport(
+        ore::data::Report& report,
+        const std::map<SensitivityCube::crossPair, std::pair<QuantLib::Real, QuantLib::Real>>& skippedPairs);
+
     virtual void writeSensitivityReport(ore::data::Report& report, const boost::shared_ptr<SensitivityStream>& ss,
                                         QuantLib::Real outputThreshold = 0.0, QuantLib::Size outputPrecision = 2);
 
@@ -116,6 +123,14 @@ public:
 
     virtual void writePricingStats(ore::data::Report& report, const boost::shared_ptr<Portfolio>& portfolio);
 
+    /*! Write the timings collected by a valuation engine run by phase, market update risk factor type, calculator,
+        trade type and trade, all times are in microseconds */
+    virtual void writeRuntimes(ore::data::Report& report, const ValuationEngineTimings& timings);
+
+    //! Write the memory footprints recorded by the ore::data::MemoryAccounting, one row per record
+    virtual void writeMemoryBreakdown(ore::data::Report& report,
+                                      const std::vector<ore::data::MemoryAccounting::Entry>& entries);
+
     virtual void writeCube(ore::data::Report& report, const boost::shared_ptr<NPVCube>& cube,
                            const std::map<std::string, std::string>& nettingSetMap = std::map<std::string, std::string>());
 
@@ -20,7 +20,7 @@
 #include <orea/app/xvarunner.hpp>
 #include <orea/engine/mporcalculator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
-#include <orea/scenario/simplescenariofactory.hpp>
+#include <orea/scenario/compactscenariofactory.hpp>
 #include <ored/model/crossassetmodelbuilder.hpp>
 
 #include <algorithm>
@@ -128,7 +128,8 @@ void XvaRunner::buildSimMarket(const boost::shared_ptr<ore::data::Market>& marke
         projectedSsmData = simMarketData_;
     }
 
-    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<SimpleScenarioFactory>();
+    // the key table of the compact scenarios is set by the cross asset model scenario generator
+    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<CompactScenarioFactory>();
     boost::shared_ptr<ScenarioGenerator> sg =
         getProjectedScenarioGenerator(currencyFilter, market, projectedSsmData, sf, continueOnErr);
     simMarket_ = boost::make_shared<ScenarioSimMarket>(market, projectedSsmData, Market::defaultConfiguration,
@@ -0,0 +1,169 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/app/xvasharding.hpp>
+#include <orea/cube/cube_io.hpp>
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <thread>
+
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+std::vector<std::set<std::string>> partitionByNettingSet(const ore::data::Portfolio& portfolio, const Size shards) {
+    QL_REQUIRE(shards > 0, "partitionByNettingSet: number of shards must be positive");
+
+    std::map<std::string, std::set<std::string>> nettingSets;
+    for (auto const& [tradeId, nettingSetId] : portfolio.nettingSetMap())
+        nettingSets[nettingSetId].insert(tradeId);
+
+    std::vector<std::pair<std::string, Size>> sizes;
+    for (auto const& [nettingSetId, tradeIds] : nettingSets)
+        sizes.push_back(std::make_pair(nettingSetId, tradeIds.size()));
+    std::stable_sort(sizes.begin(), sizes.end(),
+                     [](const std::pair<std::string, Size>& a, const std::pair<std::string, Size>& b) {
+                         return a.second > b.second;
+                     });
+
+    std::vector<std::set<std::string>> result(shards);
+    std::vector<Size> load(shards, 0);
+    for (auto const& [nettingSetId, size] : sizes) {
+        Size shard = std::min_element(load.begin(), load.end()) - load.begin();
+        result[shard].insert(nettingSets[nettingSetId].begin(), nettingSets[nettingSetId].end());
+        load[shard] += size;
+    }
+    return result;
+}
+
+void restrictToShard(ore::data::Portfolio& portfolio, const Size shards, const Size shardIndex) {
+    QL_REQUIRE(shardIndex < shards,
+               "restrictToShard: shard index " << shardIndex << " out of range, expected less than " << shards);
+    if (shards == 1)
+        return;
+    std::set<std::string> tradeIds = partitionByNettingSet(portfolio, shards)[shardIndex];
+    Size size = portfolio.size();
+    for (auto const& id : portfolio.ids()) {
+        if (tradeIds.find(id) == tradeIds.end())
+            portfolio.remove(id);
+    }
+    LOG("Portfolio restricted to shard " << shardIndex << " of " << shards << ": " << portfolio.size() << " of "
+                                         << size << " trades");
+    if (portfolio.size() == 0)
+        WLOG("Shard " << shardIndex << " of " << shards << " holds no trades");
+}
+
+std::string shardName(const std::string& pattern, const Size shard) {
+    return boost::replace_all_copy(pattern, "{shard}", ore::data::to_string(shard));
+}
+
+std::vector<boost::shared_ptr<NPVCube>> loadCubeShards(const std::string& pattern, const Size shards) {
+    QL_REQUIRE(pattern.find("{shard}") != std::string::npos,
+               "loadCubeShards: file name " << pattern << " does not contain the placeholder {shard}");
+    std::vector<boost::shared_ptr<NPVCube>> cubes;
+    for (Size i = 0; i < shards; ++i) {
+        std::string fileName = shardName(pattern, i);
+        LOG("Load cube shard " << i << " from file " << fileName);
+        cubes.push_back(loadCube(fileName));
+        if (i > 0) {
+            QL_REQUIRE(cubes[i]->asof() == cubes[0]->asof() && cubes[i]->dates() == cubes[0]->dates() &&
+                           cubes[i]->samples() == cubes[0]->samples() && cubes[i]->depth() == cubes[0]->depth(),
+                       "loadCubeShards: cube shard " << fileName << " does not match the first shard ("
+                                                     << cubes[0]->numDates() << " dates, " << cubes[0]->samples()
+                                                     << " samples, depth " << cubes[0]->depth() << ")");
+        }
+    }
+    return cubes;
+}
+
+ShardCoordinator::ShardCoordinator(const std::string& command, const Size shards, const Size maxRetries,
+                                   const std::string& resultFile, const Size maxConcurrent)
+    : command_(command), shards_(shards), maxRetries_(maxRetries), resultFile_(resultFile),
+      maxConcurrent_(maxConcurrent == 0 ? shards : std::min(maxConcurrent, shards)) {
+    QL_REQUIRE(shards_ > 0, "ShardCoordinator: number of shards must be positive");
+    QL_REQUIRE(!command_.empty(), "ShardCoordinator: no command given");
+}
+
+bool ShardCoordinator::runShard(const Size shard) const {
+    std::string command = shardName(command_, shard);
+    std::string resultFile = shardName(resultFile_, shard);
+    if (!resultFile.empty())
+        boost::filesystem::remove(resultFile);
+    LOG("ShardCoordinator: run shard " << shard << ": " << command);
+    int status = std::system(command.c_str());
+    if (status != 0) {
+        WLOG("ShardCoordinator: shard " << shard << " failed with exit status " << status);
+        return false;
+    }
+    if (!resultFile.empty() && !boost::filesystem::exists(resultFile)) {
+        WLOG("ShardCoordinator: shard " << shard << " did not write " << resultFile);
+        return false;
+    }
+    return true;
+}
+
+void ShardCoordinator::run() {
+    attempts_.assign(shards_, 0);
+    std::vector<char> succeeded(shards_, 0);
+    std::atomic<Size> next(0);
+    auto worker = [this, &succeeded, &next]() {
+        for (Size shard = next++; shard < shards_; shard = next++) {
+            while (!succeeded[shard] && attempts_[shard] <= maxRetries_) {
+                ++attempts_[shard];
+                try {
+                    succeeded[shard] = runShard(shard);
+                } catch (const std::exception& e) {
+                    WLOG("ShardCoordinator: shard " << shard << " failed: " << e.what());
+                }
+            }
+        }
+    };
+
+    LOG("ShardCoordinator: run " << shards_ << " shards, " << maxConcurrent_ << " at a time");
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < maxConcurrent_; ++i)
+        threads.emplace_back(worker);
+    for (auto& t : threads)
+        t.join();
+
+    std::vector<Size> failed;
+    for (Size i = 0; i < shards_; ++i) {
+        if (!succeeded[i])
+            failed.push_back(i);
+        else if (attempts_[i] > 1)
+            LOG("ShardCoordinator: shard " << i << " succeeded after " << attempts_[i] << " runs");
+    }
+    QL_REQUIRE(failed.empty(), "ShardCoordinator: shards " << ore::data::to_string(failed) << " failed after "
+                                                           << maxRetries_ + 1 << " runs");
+    LOG("ShardCoordinator: all shards completed");
+}
+
+} // namespace analytics
+} // namespace ore
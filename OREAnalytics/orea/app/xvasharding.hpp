@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/app/xvasharding.hpp
+    \brief Partition of an exposure simulation into shards, coordination of the shard runs and merge of their cubes
+    \ingroup app
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/types.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Partition the trades of a portfolio into the given number of shards by netting set
+/*! The netting sets are assigned in the order of decreasing number of trades, each to the shard with the fewest
+    trades so far, ties are broken by netting set id and shard index. The partition therefore only depends on the
+    portfolio, so that the shard runs of a distributed simulation, each restricting the same portfolio to its shard,
+    agree on it. Since a netting set is not split, the netting set values of a shard are complete, which allows
+    streaming exposure and the netting set level post processing in the shards. Shards may be empty if there are
+    fewer netting sets than shards.
+
+    \ingroup app
+*/
+std::vector<std::set<std::string>> partitionByNettingSet(const ore::data::Portfolio& portfolio,
+                                                         const QuantLib::Size shards);
+
+//! Remove the trades that do not belong to the given shard from the portfolio, see partitionByNettingSet()
+void restrictToShard(ore::data::Portfolio& portfolio, const QuantLib::Size shards, const QuantLib::Size shardIndex);
+
+//! Replace the placeholder {shard} in the given file name or command by the shard index
+std::string shardName(const std::string& pattern, const QuantLib::Size shard);
+
+//! Load the cubes written by the shards of a distributed simulation, the file names are given by the pattern
+std::vector<boost::shared_ptr<NPVCube>> loadCubeShards(const std::string& pattern, const QuantLib::Size shards);
+
+//! Runs the shards of a distributed exposure simulation as external commands and reruns failed shards
+/*! The command is run once per shard with the placeholder {shard} replaced by the shard index, typically a call of
+    ore with the shard's parameters on a node of a cluster, e.g. via ssh or the submit command of a batch scheduler
+    that waits for the job to complete. A shard run fails if the command returns a non-zero exit status or if the
+    result file, given as a pattern as well, does not exist afterwards. Failed shards are run again up to maxRetries
+    times, since the shard runs are deterministic a rerun gives the same cube as a successful first run.
+
+    \ingroup app
+*/
+class ShardCoordinator {
+public:
+    /*! The shards are run concurrently, at most maxConcurrent at a time, all at once if maxConcurrent is zero. The
+        result file is removed before a shard is run, so that a stale file of a previous run is not taken as a
+        result. */
+    ShardCoordinator(const std::string& command, const QuantLib::Size shards, const QuantLib::Size maxRetries = 2,
+                     const std::string& resultFile = "", const QuantLib::Size maxConcurrent = 0);
+
+    //! Run all shards, throws if a shard still fails after the retries
+    void run();
+
+    //! The number of runs per shard in the last call of run()
+    const std::vector<QuantLib::Size>& attempts() const { return attempts_; }
+
+private:
+    // run a shard once, return true on success
+    bool runShard(const QuantLib::Size shard) const;
+
+    std::string command_;
+    QuantLib::Size shards_, maxRetries_;
+    std::string resultFile_;
+    QuantLib::Size maxConcurrent_;
+    std::vector<QuantLib::Size> attempts_;
+};
+
+} // namespace analytics
+} // namespace ore
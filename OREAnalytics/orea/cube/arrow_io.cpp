@@ -0,0 +1,332 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/arrow_io.hpp>
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/filesystem.hpp>
+
+#ifdef ORE_USE_ARROW
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+#endif
+
+#include <algorithm>
+#include <map>
+
+namespace ore {
+namespace analytics {
+
+bool isArrowFilename(const std::string& filename) {
+    std::string extension = boost::filesystem::path(filename).extension().string();
+    return extension == ".arrow" || extension == ".feather";
+}
+
+#ifdef ORE_USE_ARROW
+
+namespace {
+
+void check(const arrow::Status& status, const std::string& what) {
+    QL_REQUIRE(status.ok(), "Arrow: " << what << " failed: " << status.ToString());
+}
+
+template <class T> T check(arrow::Result<T> result, const std::string& what) {
+    check(result.status(), what);
+    return std::move(result).ValueUnsafe();
+}
+
+template <class Builder> std::shared_ptr<arrow::Array> finish(Builder& builder) {
+    return check(builder.Finish(), "finish array");
+}
+
+// days since 1970-01-01, the epoch of arrow's date32 type
+std::int32_t daysSinceEpoch(const QuantLib::Date& d) {
+    return static_cast<std::int32_t>(d.serialNumber() - QuantLib::Date(1, QuantLib::January, 1970).serialNumber());
+}
+
+std::shared_ptr<arrow::Array> stringArray(const std::vector<std::string>& values) {
+    arrow::StringBuilder builder;
+    for (auto const& v : values)
+        check(builder.Append(v), "append string");
+    return finish(builder);
+}
+
+std::shared_ptr<arrow::Array> dictionaryArray(const std::shared_ptr<arrow::Array>& indices,
+                                              const std::shared_ptr<arrow::Array>& dictionary) {
+    return check(arrow::DictionaryArray::FromArrays(arrow::dictionary(arrow::int32(), dictionary->type()), indices,
+                                                    dictionary),
+                 "build dictionary array");
+}
+
+//! Arrow IPC file writer, the record batches are written as they are passed
+class ArrowFile {
+public:
+    ArrowFile(const std::string& filename, const std::shared_ptr<arrow::Schema>& schema)
+        : filename_(filename), schema_(schema) {
+        out_ = check(arrow::io::FileOutputStream::Open(filename), "open " + filename);
+        writer_ = check(arrow::ipc::MakeFileWriter(out_, schema_), "create writer for " + filename);
+    }
+
+    void write(Size rows, const std::vector<std::shared_ptr<arrow::Array>>& columns) {
+        auto batch = arrow::RecordBatch::Make(schema_, static_cast<std::int64_t>(rows), columns);
+        check(writer_->WriteRecordBatch(*batch), "write record batch to " + filename_);
+    }
+
+    void close() {
+        check(writer_->Close(), "close writer for " + filename_);
+        check(out_->Close(), "close " + filename_);
+    }
+
+private:
+    std::string filename_;
+    std::shared_ptr<arrow::Schema> schema_;
+    std::shared_ptr<arrow::io::FileOutputStream> out_;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer_;
+};
+
+} // namespace
+
+bool arrowSupported() { return true; }
+
+void saveCubeToArrow(const std::string& filename, const NPVCube& cube, const bool doublePrecision) {
+    auto valueType = doublePrecision ? arrow::float64() : arrow::float32();
+    auto schema = arrow::schema({arrow::field("id", arrow::dictionary(arrow::int32(), arrow::utf8())),
+                                 arrow::field("date", arrow::dictionary(arrow::int32(), arrow::date32())),
+                                 arrow::field("sample", arrow::uint32()), arrow::field("depth", arrow::uint32()),
+                                 arrow::field("value", valueType)});
+
+    // the dictionaries are the same for all record batches
+    std::vector<std::string> ids(cube.numIds());
+    for (auto const& [id, i] : cube.idsAndIndexes())
+        ids[i] = id;
+    auto idDictionary = stringArray(ids);
+    arrow::Date32Builder dateBuilder;
+    check(dateBuilder.Append(daysSinceEpoch(cube.asof())), "append date");
+    for (auto const& d : cube.dates())
+        check(dateBuilder.Append(daysSinceEpoch(d)), "append date");
+    auto dateDictionary = finish(dateBuilder);
+
+    ArrowFile file(filename, schema);
+    arrow::Int32Builder idIndex, dateIndex;
+    arrow::UInt32Builder sample, depth;
+    arrow::DoubleBuilder doubleValue;
+    arrow::FloatBuilder floatValue;
+    std::vector<Real> values;
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        Size rows = 0;
+        auto add = [&](Size j, Size k, Size d, Real value) {
+            check(idIndex.Append(static_cast<std::int32_t>(i)), "append id");
+            check(dateIndex.Append(static_cast<std::int32_t>(j)), "append date");
+            check(sample.Append(static_cast<std::uint32_t>(k)), "append sample");
+            check(depth.Append(static_cast<std::uint32_t>(d)), "append depth");
+            if (doublePrecision)
+                check(doubleValue.Append(value), "append value");
+            else
+                check(floatValue.Append(static_cast<float>(value)), "append value");
+            ++rows;
+        };
+        for (Size d = 0; d < cube.depth(); ++d) {
+            Real t0 = cube.getT0(i, d);
+            if (d == 0 || t0 != 0.0)
+                add(0, 0, d, t0);
+        }
+        for (Size j = 0; j < cube.numDates(); ++j) {
+            for (Size d = 0; d < cube.depth(); ++d) {
+                cube.getSamples(i, j, d, values);
+                for (Size k = 0; k < values.size(); ++k) {
+                    if (values[k] != 0.0)
+                        add(j + 1, k, d, values[k]);
+                }
+            }
+        }
+        file.write(rows, {dictionaryArray(finish(idIndex), idDictionary),
+                          dictionaryArray(finish(dateIndex), dateDictionary), finish(sample), finish(depth),
+                          doublePrecision ? finish(doubleValue) : finish(floatValue)});
+    }
+    file.close();
+    LOG("Cube with " << cube.numIds() << " ids written to arrow file " << filename);
+}
+
+void saveAggregationScenarioDataToArrow(const std::string& filename, const AggregationScenarioData& data) {
+    auto schema = arrow::schema({arrow::field("date", arrow::uint32()), arrow::field("sample", arrow::uint32()),
+                                 arrow::field("type", arrow::dictionary(arrow::int32(), arrow::utf8())),
+                                 arrow::field("qualifier", arrow::dictionary(arrow::int32(), arrow::utf8())),
+                                 arrow::field("value", arrow::float64())});
+
+    auto keys = data.keys();
+    std::vector<std::string> types, qualifiers;
+    std::map<std::string, std::int32_t> typeIndex, qualifierIndex;
+    std::vector<std::pair<std::int32_t, std::int32_t>> keyIndex;
+    for (auto const& [type, qualifier] : keys) {
+        std::string t = ore::data::to_string(type);
+        auto it = typeIndex.emplace(t, static_cast<std::int32_t>(types.size())).first;
+        if (it->second == static_cast<std::int32_t>(types.size()))
+            types.push_back(t);
+        auto jt = qualifierIndex.emplace(qualifier, static_cast<std::int32_t>(qualifiers.size())).first;
+        if (jt->second == static_cast<std::int32_t>(qualifiers.size()))
+            qualifiers.push_back(qualifier);
+        keyIndex.push_back(std::make_pair(it->second, jt->second));
+    }
+    auto typeDictionary = stringArray(types);
+    auto qualifierDictionary = stringArray(qualifiers);
+
+    ArrowFile file(filename, schema);
+    arrow::UInt32Builder date, sample;
+    arrow::Int32Builder type, qualifier;
+    arrow::DoubleBuilder value;
+    for (Size i = 0; i < data.dimDates(); ++i) {
+        for (Size j = 0; j < data.dimSamples(); ++j) {
+            for (Size k = 0; k < keys.size(); ++k) {
+                check(date.Append(static_cast<std::uint32_t>(i + 1)), "append date");
+                check(sample.Append(static_cast<std::uint32_t>(j)), "append sample");
+                check(type.Append(keyIndex[k].first), "append type");
+                check(qualifier.Append(keyIndex[k].second), "append qualifier");
+                check(value.Append(data.get(i, j, keys[k].first, keys[k].second)), "append value");
+            }
+        }
+        file.write(data.dimSamples() * keys.size(),
+                   {finish(date), finish(sample), dictionaryArray(finish(type), typeDictionary),
+                    dictionaryArray(finish(qualifier), qualifierDictionary), finish(value)});
+    }
+    file.close();
+    LOG("Aggregation scenario data written to arrow file " << filename);
+}
+
+void saveReportToArrow(const std::string& filename, const ore::data::InMemoryReport& report, const Size batchSize) {
+    QL_REQUIRE(batchSize > 0, "saveReportToArrow(): batchSize must be positive");
+
+    // the ReportType variant is boost::variant<Size, Real, string, Date, Period>
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> dictionaries(report.columns());
+    std::vector<std::map<std::string, std::int32_t>> dictionaryIndices(report.columns());
+    for (Size c = 0; c < report.columns(); ++c) {
+        std::shared_ptr<arrow::DataType> type;
+        switch (report.columnType(c).which()) {
+        case 0:
+            type = arrow::uint64();
+            break;
+        case 1:
+            type = arrow::float64();
+            break;
+        case 2: {
+            std::vector<std::string> values;
+            for (auto id : report.stringIdColumn(c)) {
+                const std::string& s = report.internedString(id);
+                if (dictionaryIndices[c].emplace(s, static_cast<std::int32_t>(values.size())).second)
+                    values.push_back(s);
+            }
+            dictionaries[c] = stringArray(values);
+            type = arrow::dictionary(arrow::int32(), arrow::utf8());
+            break;
+        }
+        case 3:
+            type = arrow::date32();
+            break;
+        default:
+            type = arrow::utf8();
+            break;
+        }
+        fields.push_back(arrow::field(report.header(c), type));
+    }
+
+    ArrowFile file(filename, arrow::schema(fields));
+    for (Size start = 0; start < report.rows(); start += batchSize) {
+        Size end = std::min(report.rows(), start + batchSize);
+        std::vector<std::shared_ptr<arrow::Array>> columns;
+        for (Size c = 0; c < report.columns(); ++c) {
+            switch (report.columnType(c).which()) {
+            case 0: {
+                arrow::UInt64Builder b;
+                const auto& data = report.sizeColumn(c);
+                for (Size r = start; r < end; ++r) {
+                    Size v = data[r];
+                    check(v == QuantLib::Null<Size>() ? b.AppendNull() : b.Append(v), "append size");
+                }
+                columns.push_back(finish(b));
+                break;
+            }
+            case 1: {
+                arrow::DoubleBuilder b;
+                const auto& data = report.realColumn(c);
+                for (Size r = start; r < end; ++r) {
+                    Real v = data[r];
+                    check(v == QuantLib::Null<Real>() ? b.AppendNull() : b.Append(v), "append real");
+                }
+                columns.push_back(finish(b));
+                break;
+            }
+            case 2: {
+                arrow::Int32Builder b;
+                const auto& data = report.stringIdColumn(c);
+                for (Size r = start; r < end; ++r)
+                    check(b.Append(dictionaryIndices[c].at(report.internedString(data[r]))), "append string");
+                columns.push_back(dictionaryArray(finish(b), dictionaries[c]));
+                break;
+            }
+            case 3: {
+                arrow::Date32Builder b;
+                const auto& data = report.dateColumn(c);
+                for (Size r = start; r < end; ++r) {
+                    const QuantLib::Date& v = data[r];
+                    check(v == QuantLib::Date() ? b.AppendNull() : b.Append(daysSinceEpoch(v)), "append date");
+                }
+                columns.push_back(finish(b));
+                break;
+            }
+            default: {
+                arrow::StringBuilder b;
+                const auto& data = report.periodColumn(c);
+                for (Size r = start; r < end; ++r)
+                    check(b.Append(ore::data::to_string(data[r])), "append period");
+                columns.push_back(finish(b));
+                break;
+            }
+            }
+        }
+        file.write(end - start, columns);
+    }
+    file.close();
+    LOG("Report with " << report.rows() << " rows written to arrow file " << filename);
+}
+
+#else
+
+bool arrowSupported() { return false; }
+
+void saveCubeToArrow(const std::string& filename, const NPVCube&, const bool) {
+    QL_FAIL("Can not write cube to " << filename << ", ORE was built without Arrow support (ORE_USE_ARROW)");
+}
+
+void saveAggregationScenarioDataToArrow(const std::string& filename, const AggregationScenarioData&) {
+    QL_FAIL("Can not write aggregation scenario data to " << filename
+                                                          << ", ORE was built without Arrow support (ORE_USE_ARROW)");
+}
+
+void saveReportToArrow(const std::string& filename, const ore::data::InMemoryReport&, const Size) {
+    QL_FAIL("Can not write report to " << filename << ", ORE was built without Arrow support (ORE_USE_ARROW)");
+}
+
+#endif
+
+} // namespace analytics
+} // namespace ore
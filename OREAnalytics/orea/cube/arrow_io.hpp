@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/arrow_io.hpp
+    \brief save cubes, agg scen data and reports in the Apache Arrow IPC file format
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+
+#include <ored/report/inmemoryreport.hpp>
+
+namespace ore {
+namespace analytics {
+
+//! True if ORE was built with Arrow support (ORE_USE_ARROW), otherwise the functions below throw
+bool arrowSupported();
+
+//! True if the filename ends with .arrow or .feather
+bool isArrowFilename(const std::string& filename);
+
+/*! Save a cube as Arrow IPC file with the columns id, date, sample, depth and value. As in the csv format the T0
+    values are written with date index 0 and sample 0, zero values are omitted except for the T0 value of depth 0.
+    The id and date columns are dictionary encoded with the cube's ids resp. the asof date followed by the cube
+    dates. One record batch is written per id, so that the cube is not copied as a whole. The values are written in
+    single precision unless doublePrecision is true. */
+void saveCubeToArrow(const std::string& filename, const NPVCube& cube, const bool doublePrecision = false);
+
+/*! Save aggregation scenario data as Arrow IPC file with the columns date (the date index starting at 1 as in the
+    csv format), sample, type, qualifier and value. The type and qualifier columns are dictionary encoded, one
+    record batch is written per date. */
+void saveAggregationScenarioDataToArrow(const std::string& filename, const AggregationScenarioData& data);
+
+/*! Save a report as Arrow IPC file. Size, Real and Date columns are written as uint64, float64 and date32 columns
+    with null values for Null<Size>(), Null<Real>() and Date(), string columns are dictionary encoded and periods are
+    written as strings. The rows are written in record batches of batchSize rows. */
+void saveReportToArrow(const std::string& filename, const ore::data::InMemoryReport& report,
+                       const Size batchSize = 65536);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,572 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/binarycubefile.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+#ifdef ORE_USE_ZLIB
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+const char magic[8] = {'O', 'R', 'E', 'C', 'B', 'I', 'N', '\0'};
+const char asdMagic[8] = {'O', 'R', 'E', 'A', 'B', 'I', 'N', '\0'};
+const std::uint32_t cubeVersion = 2;
+const std::uint32_t asdVersion = 1;
+const std::uint32_t endiannessMarker = 0x01020304;
+// target size of the uncompressed chunks if the number of ids per chunk is not given
+const Size targetChunkBytes = 8 * 1024 * 1024;
+
+template <class T> void writeValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void readBytes(std::ifstream& in, void* target, Size bytes, const std::string& filename) {
+    in.read(static_cast<char*>(target), bytes);
+    QL_REQUIRE(in.gcount() == static_cast<std::streamsize>(bytes), "unexpected end of file " << filename);
+}
+
+#ifdef ORE_USE_ZLIB
+std::vector<char> compressChunk(const std::vector<char>& buffer) {
+    std::vector<char> compressed;
+    boost::iostreams::filtering_ostream os;
+    os.push(boost::iostreams::zlib_compressor());
+    os.push(boost::iostreams::back_inserter(compressed));
+    os.write(buffer.data(), buffer.size());
+    os.reset();
+    return compressed;
+}
+#endif
+
+// write the raw and stored size of the chunk followed by the stored chunk
+void writeStoredChunk(std::ofstream& out, Size rawSize, const std::vector<char>& stored) {
+    writeValue(out, static_cast<std::uint64_t>(rawSize));
+    writeValue(out, static_cast<std::uint64_t>(stored.size()));
+    out.write(stored.data(), stored.size());
+}
+
+// write the chunk, compressed if required
+void writeChunk(std::ofstream& out, const std::vector<char>& buffer, const bool compress) {
+#ifdef ORE_USE_ZLIB
+    if (compress) {
+        writeStoredChunk(out, buffer.size(), compressChunk(buffer));
+        return;
+    }
+#endif
+    writeStoredChunk(out, buffer.size(), buffer);
+}
+
+// read a chunk written by writeChunk(), the buffer must have the expected raw size
+void readChunk(std::ifstream& in, std::vector<char>& buffer, std::vector<char>& stored, const bool compressed,
+               const std::string& filename, Size chunk) {
+    std::uint64_t raw, storedSize;
+    readBytes(in, &raw, sizeof(raw), filename);
+    readBytes(in, &storedSize, sizeof(storedSize), filename);
+    QL_REQUIRE(raw == buffer.size(), "chunk " << chunk << " in " << filename << " has " << raw << " bytes, expected "
+                                              << buffer.size());
+    if (compressed) {
+#ifdef ORE_USE_ZLIB
+        stored.resize(storedSize);
+        readBytes(in, stored.data(), storedSize, filename);
+        boost::iostreams::filtering_istream is;
+        is.push(boost::iostreams::zlib_decompressor());
+        is.push(boost::iostreams::array_source(stored.data(), stored.size()));
+        is.read(buffer.data(), buffer.size());
+        QL_REQUIRE(is.gcount() == static_cast<std::streamsize>(buffer.size()),
+                   "chunk " << chunk << " in " << filename << " is corrupt");
+#endif
+    } else {
+        QL_REQUIRE(storedSize == raw, "chunk " << chunk << " in " << filename << " is corrupt");
+        readBytes(in, buffer.data(), buffer.size(), filename);
+    }
+}
+
+template <class T> void pack(char* target, const std::vector<Real>& values) {
+    for (Size i = 0; i < values.size(); ++i) {
+        T v = static_cast<T>(values[i]);
+        std::memcpy(target + i * sizeof(T), &v, sizeof(T));
+    }
+}
+
+template <class T> void unpack(const char* source, std::vector<Real>& values) {
+    for (Size i = 0; i < values.size(); ++i) {
+        T v;
+        std::memcpy(&v, source + i * sizeof(T), sizeof(T));
+        values[i] = v;
+    }
+}
+
+// run f(i) for i = 0, ..., n - 1 on up to nThreads threads, rethrows the first exception
+template <class F> void parallelFor(Size n, Size nThreads, const F& f) {
+    nThreads = std::max<Size>(1, std::min(nThreads, n));
+    if (nThreads == 1) {
+        for (Size i = 0; i < n; ++i)
+            f(i, 0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(nThreads);
+    std::vector<std::thread> threads;
+    for (Size t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&f, &errors, n, nThreads, t]() {
+            try {
+                for (Size i = t; i < n; i += nThreads)
+                    f(i, t);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    for (auto const& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+} // namespace
+
+Size defaultCubeFileThreads() { return std::max<Size>(1, std::thread::hardware_concurrency()); }
+
+BinaryCubeWriter::BinaryCubeWriter(const std::string& filename, const Date& asof, const std::vector<std::string>& ids,
+                                   const std::vector<Date>& dates, Size samples, Size depth,
+                                   const bool doublePrecision, const bool compress, Size idsPerChunk, Size nThreads)
+    : filename_(filename), out_(filename, std::ios::binary | std::ios::trunc), numIds_(ids.size()),
+      idSize_(depth * (1 + dates.size() * samples)), valueSize_(doublePrecision ? sizeof(double) : sizeof(float)),
+      idsPerChunk_(idsPerChunk), nThreads_(std::max<Size>(1, nThreads)), written_(0), writtenChunks_(0),
+      compress_(compress) {
+    QL_REQUIRE(out_.is_open(), "BinaryCubeWriter: error opening file " << filename);
+    QL_REQUIRE(numIds_ > 0, "BinaryCubeWriter: no ids given");
+#ifndef ORE_USE_ZLIB
+    if (compress_) {
+        WLOG("BinaryCubeWriter: compression requires zlib support, write " << filename << " uncompressed");
+        compress_ = false;
+    }
+#endif
+    if (idsPerChunk_ == 0)
+        idsPerChunk_ = std::max<Size>(1, targetChunkBytes / (idSize_ * valueSize_));
+    idsPerChunk_ = std::min(idsPerChunk_, numIds_);
+    Size numChunks = (numIds_ + idsPerChunk_ - 1) / idsPerChunk_;
+
+    out_.write(magic, sizeof(magic));
+    writeValue(out_, cubeVersion);
+    writeValue(out_, endiannessMarker);
+    writeValue(out_, static_cast<std::uint32_t>(valueSize_));
+    writeValue(out_, static_cast<std::uint32_t>(compress_ ? 1 : 0));
+    writeValue(out_, static_cast<std::int64_t>(asof.serialNumber()));
+    writeValue(out_, static_cast<std::uint64_t>(ids.size()));
+    writeValue(out_, static_cast<std::uint64_t>(dates.size()));
+    writeValue(out_, static_cast<std::uint64_t>(samples));
+    writeValue(out_, static_cast<std::uint64_t>(depth));
+    for (auto const& d : dates)
+        writeValue(out_, static_cast<std::int64_t>(d.serialNumber()));
+    for (auto const& id : ids) {
+        writeValue(out_, static_cast<std::uint32_t>(id.size()));
+        out_.write(id.data(), id.size());
+    }
+    writeValue(out_, static_cast<std::uint64_t>(idsPerChunk_));
+    writeValue(out_, static_cast<std::uint64_t>(numChunks));
+    // the chunk index is written on close()
+    indexPosition_ = out_.tellp();
+    offsets_.resize(numChunks, 0);
+    for (Size c = 0; c < numChunks; ++c)
+        writeValue(out_, static_cast<std::uint64_t>(0));
+}
+
+BinaryCubeWriter::~BinaryCubeWriter() {
+    if (out_.is_open())
+        out_.close();
+}
+
+void BinaryCubeWriter::write(const std::vector<Real>& t0, const std::vector<Real>& values) {
+    QL_REQUIRE(out_.is_open(), "BinaryCubeWriter: file " << filename_ << " is closed");
+    QL_REQUIRE(written_ < numIds_, "BinaryCubeWriter: all " << numIds_ << " ids are written already");
+    QL_REQUIRE(t0.size() + values.size() == idSize_, "BinaryCubeWriter: got " << t0.size() << " + " << values.size()
+                                                                             << " values, expected " << idSize_);
+    if (pending_.empty() || pending_.back().size() == idsPerChunk_ * idSize_ * valueSize_) {
+        pending_.emplace_back();
+        pending_.back().reserve(std::min(idsPerChunk_, numIds_ - written_) * idSize_ * valueSize_);
+    }
+    std::vector<char>& chunk = pending_.back();
+    Size pos = chunk.size();
+    chunk.resize(pos + idSize_ * valueSize_);
+    if (valueSize_ == sizeof(double)) {
+        pack<double>(chunk.data() + pos, t0);
+        pack<double>(chunk.data() + pos + t0.size() * valueSize_, values);
+    } else {
+        pack<float>(chunk.data() + pos, t0);
+        pack<float>(chunk.data() + pos + t0.size() * valueSize_, values);
+    }
+    ++written_;
+    // compress up to nThreads chunks at once
+    if (chunk.size() == idsPerChunk_ * idSize_ * valueSize_ && pending_.size() == nThreads_)
+        flush();
+}
+
+void BinaryCubeWriter::flush() {
+    std::vector<std::vector<char>> stored(pending_.size());
+#ifdef ORE_USE_ZLIB
+    if (compress_)
+        parallelFor(pending_.size(), nThreads_,
+                    [this, &stored](Size i, Size) { stored[i] = compressChunk(pending_[i]); });
+#endif
+    for (Size i = 0; i < pending_.size(); ++i) {
+        offsets_[writtenChunks_ + i] = static_cast<std::uint64_t>(out_.tellp());
+        writeStoredChunk(out_, pending_[i].size(), compress_ ? stored[i] : pending_[i]);
+    }
+    writtenChunks_ += pending_.size();
+    pending_.clear();
+    QL_REQUIRE(!out_.fail(), "BinaryCubeWriter: error writing to " << filename_);
+}
+
+void BinaryCubeWriter::close() {
+    QL_REQUIRE(written_ == numIds_,
+               "BinaryCubeWriter: " << written_ << " ids written to " << filename_ << ", expected " << numIds_);
+    flush();
+    out_.seekp(indexPosition_);
+    for (auto const& o : offsets_)
+        writeValue(out_, o);
+    out_.close();
+    QL_REQUIRE(!out_.fail(), "BinaryCubeWriter: error closing " << filename_);
+}
+
+BinaryCubeReader::BinaryCubeReader(const std::string& filename)
+    : filename_(filename), in_(filename, std::ios::binary), read_(0), currentChunk_(QuantLib::Null<Size>()) {
+    QL_REQUIRE(in_.is_open(), "BinaryCubeReader: error opening file " << filename);
+    char m[sizeof(magic)];
+    std::uint32_t v, e, valueSize, compressed;
+    std::int64_t asof;
+    std::uint64_t nIds, nDates, samples, depth, idsPerChunk, numChunks;
+    read(m, sizeof(m));
+    QL_REQUIRE(std::memcmp(m, magic, sizeof(magic)) == 0,
+               "BinaryCubeReader: " << filename_ << " is not a binary cube file");
+    read(&v, sizeof(v));
+    QL_REQUIRE(v == cubeVersion, "BinaryCubeReader: unsupported version " << v << " in " << filename_);
+    read(&e, sizeof(e));
+    QL_REQUIRE(e == endiannessMarker,
+               "BinaryCubeReader: " << filename_ << " was written on a platform with different byte order");
+    read(&valueSize, sizeof(valueSize));
+    QL_REQUIRE(valueSize == sizeof(double) || valueSize == sizeof(float),
+               "BinaryCubeReader: unsupported value size " << valueSize << " in " << filename_);
+    read(&compressed, sizeof(compressed));
+#ifndef ORE_USE_ZLIB
+    QL_REQUIRE(compressed == 0,
+               "BinaryCubeReader: " << filename_ << " is compressed, this requires zlib support (ORE_USE_ZLIB)");
+#endif
+    read(&asof, sizeof(asof));
+    read(&nIds, sizeof(nIds));
+    read(&nDates, sizeof(nDates));
+    read(&samples, sizeof(samples));
+    read(&depth, sizeof(depth));
+
+    asof_ = Date(static_cast<Date::serial_type>(asof));
+    samples_ = samples;
+    depth_ = depth;
+    valueSize_ = valueSize;
+    compressed_ = compressed != 0;
+    for (Size i = 0; i < nDates; ++i) {
+        std::int64_t serial;
+        read(&serial, sizeof(serial));
+        dates_.push_back(Date(static_cast<Date::serial_type>(serial)));
+    }
+    for (Size i = 0; i < nIds; ++i) {
+        std::uint32_t size;
+        read(&size, sizeof(size));
+        std::string id(size, ' ');
+        read(&id[0], size);
+        QL_REQUIRE(idIndex_.insert(std::make_pair(id, i)).second,
+                   "BinaryCubeReader: duplicate id " << id << " in " << filename_);
+        ids_.push_back(id);
+    }
+    read(&idsPerChunk, sizeof(idsPerChunk));
+    read(&numChunks, sizeof(numChunks));
+    QL_REQUIRE(idsPerChunk > 0 && numChunks == (nIds + idsPerChunk - 1) / idsPerChunk,
+               "BinaryCubeReader: invalid chunk index in " << filename_);
+    idsPerChunk_ = idsPerChunk;
+    offsets_.resize(numChunks);
+    for (auto& o : offsets_) {
+        read(&o, sizeof(o));
+        QL_REQUIRE(o > 0, "BinaryCubeReader: " << filename_ << " is incomplete, the chunk index is not written");
+    }
+    idSize_ = depth_ * (1 + dates_.size() * samples_);
+}
+
+void BinaryCubeReader::read(void* target, Size bytes) { readBytes(in_, target, bytes, filename_); }
+
+void BinaryCubeReader::loadChunk(std::ifstream& in, Size c, std::vector<char>& buffer,
+                                 std::vector<char>& stored) const {
+    in.seekg(offsets_[c]);
+    buffer.resize(std::min(idsPerChunk_, ids_.size() - c * idsPerChunk_) * idSize_ * valueSize_);
+    readChunk(in, buffer, stored, compressed_, filename_, c);
+}
+
+void BinaryCubeReader::extract(const std::vector<char>& buffer, Size n, std::vector<Real>& t0,
+                               std::vector<Real>& values) const {
+    const char* p = buffer.data() + (n % idsPerChunk_) * idSize_ * valueSize_;
+    t0.resize(depth_);
+    values.resize(idSize_ - depth_);
+    if (valueSize_ == sizeof(double)) {
+        unpack<double>(p, t0);
+        unpack<double>(p + depth_ * valueSize_, values);
+    } else {
+        unpack<float>(p, t0);
+        unpack<float>(p + depth_ * valueSize_, values);
+    }
+}
+
+bool BinaryCubeReader::next(std::vector<Real>& t0, std::vector<Real>& values) {
+    if (read_ == ids_.size())
+        return false;
+    Size c = read_ / idsPerChunk_;
+    if (c != currentChunk_) {
+        loadChunk(in_, c, buffer_, stored_);
+        currentChunk_ = c;
+    }
+    extract(buffer_, read_, t0, values);
+    ++read_;
+    return true;
+}
+
+void BinaryCubeReader::get(const std::string& id, std::vector<Real>& t0, std::vector<Real>& values) {
+    auto it = idIndex_.find(id);
+    QL_REQUIRE(it != idIndex_.end(), "BinaryCubeReader: id " << id << " not found in " << filename_);
+    Size c = it->second / idsPerChunk_;
+    if (c != currentChunk_) {
+        loadChunk(in_, c, buffer_, stored_);
+        currentChunk_ = c;
+    }
+    extract(buffer_, it->second, t0, values);
+}
+
+void BinaryCubeReader::forEach(
+    Size nThreads,
+    const std::function<void(Size, const std::vector<Real>&, const std::vector<Real>&)>& f) const {
+    nThreads = std::max<Size>(1, std::min(nThreads, offsets_.size()));
+    // one stream and buffer set per thread
+    std::vector<std::ifstream> streams;
+    for (Size t = 0; t < nThreads; ++t) {
+        streams.emplace_back(filename_, std::ios::binary);
+        QL_REQUIRE(streams.back().is_open(), "BinaryCubeReader: error opening file " << filename_);
+    }
+    std::vector<std::vector<char>> buffers(nThreads), stored(nThreads);
+    std::vector<std::vector<Real>> t0(nThreads), values(nThreads);
+    parallelFor(offsets_.size(), nThreads, [this, &f, &streams, &buffers, &stored, &t0, &values](Size c, Size t) {
+        loadChunk(streams[t], c, buffers[t], stored[t]);
+        for (Size n = c * idsPerChunk_; n < std::min((c + 1) * idsPerChunk_, ids_.size()); ++n) {
+            extract(buffers[t], n, t0[t], values[t]);
+            f(n, t0[t], values[t]);
+        }
+    });
+}
+
+MappedBinaryCubeReader::MappedBinaryCubeReader(const std::string& filename)
+    : filename_(filename), header_(filename), file_(filename.c_str(), boost::interprocess::read_only),
+      region_(file_, boost::interprocess::read_only) {
+    QL_REQUIRE(!header_.compressed(), "MappedBinaryCubeReader: " << filename_
+                                                                 << " is compressed and can not be memory mapped");
+    valueSize_ = header_.doublePrecision() ? sizeof(double) : sizeof(float);
+    idSize_ = depth() * (1 + dates().size() * samples());
+    for (Size i = 0; i < ids().size(); ++i)
+        idIndex_[ids()[i]] = i;
+    // check the chunk headers and that the chunks are within the file
+    const char* p = static_cast<const char*>(region_.get_address());
+    for (Size c = 0; c < header_.numChunks(); ++c) {
+        std::uint64_t raw, stored, offset = header_.chunkOffset(c);
+        Size n = std::min(header_.idsPerChunk(), ids().size() - c * header_.idsPerChunk());
+        QL_REQUIRE(offset + 2 * sizeof(std::uint64_t) + n * idSize_ * valueSize_ <= region_.get_size(),
+                   "MappedBinaryCubeReader: chunk " << c << " exceeds the size of " << filename_);
+        std::memcpy(&raw, p + offset, sizeof(raw));
+        std::memcpy(&stored, p + offset + sizeof(raw), sizeof(stored));
+        QL_REQUIRE(raw == n * idSize_ * valueSize_ && stored == raw,
+                   "MappedBinaryCubeReader: chunk " << c << " in " << filename_ << " is corrupt");
+    }
+    DLOG("MappedBinaryCubeReader: mapped " << filename_ << " with " << ids().size() << " ids in "
+                                           << header_.numChunks() << " chunks");
+}
+
+Size MappedBinaryCubeReader::index(const std::string& id) const {
+    auto it = idIndex_.find(id);
+    QL_REQUIRE(it != idIndex_.end(), "MappedBinaryCubeReader: id " << id << " not found in " << filename_);
+    return it->second;
+}
+
+Size MappedBinaryCubeReader::offset(Size n) const {
+    QL_REQUIRE(n < ids().size(), "MappedBinaryCubeReader: index " << n << " out of range, " << filename_ << " has "
+                                                                  << ids().size() << " ids");
+    Size c = n / header_.idsPerChunk();
+    return header_.chunkOffset(c) + 2 * sizeof(std::uint64_t) + (n % header_.idsPerChunk()) * idSize_ * valueSize_;
+}
+
+const char* MappedBinaryCubeReader::data(Size n) const {
+    return static_cast<const char*>(region_.get_address()) + offset(n);
+}
+
+Real MappedBinaryCubeReader::value(const char* p, Size i) const {
+    if (valueSize_ == sizeof(double)) {
+        double v;
+        std::memcpy(&v, p + i * sizeof(double), sizeof(double));
+        return v;
+    } else {
+        float v;
+        std::memcpy(&v, p + i * sizeof(float), sizeof(float));
+        return v;
+    }
+}
+
+Real MappedBinaryCubeReader::getT0(Size n, Size d) const {
+    QL_REQUIRE(d < depth(), "MappedBinaryCubeReader: depth " << d << " out of range 0..." << depth() - 1);
+    return value(data(n), d);
+}
+
+Real MappedBinaryCubeReader::get(Size n, Size date, Size sample, Size d) const {
+    QL_REQUIRE(date < dates().size() && sample < samples() && d < depth(),
+               "MappedBinaryCubeReader: date " << date << ", sample " << sample << " or depth " << d
+                                               << " out of range");
+    return value(data(n), depth() + (date * samples() + sample) * depth() + d);
+}
+
+bool isBinaryCubeFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char m[sizeof(magic)];
+    return in.read(m, sizeof(m)) && std::memcmp(m, magic, sizeof(magic)) == 0;
+}
+
+BinaryAggregationScenarioDataWriter::BinaryAggregationScenarioDataWriter(
+    const std::string& filename, Size dimDates, Size dimSamples,
+    const std::vector<std::pair<AggregationScenarioDataType, std::string>>& keys, const bool compress)
+    : filename_(filename), out_(filename, std::ios::binary | std::ios::trunc), numKeys_(keys.size()),
+      chunkSize_(dimDates * dimSamples), written_(0), compress_(compress) {
+    QL_REQUIRE(out_.is_open(), "BinaryAggregationScenarioDataWriter: error opening file " << filename);
+#ifndef ORE_USE_ZLIB
+    if (compress_) {
+        WLOG("BinaryAggregationScenarioDataWriter: compression requires zlib support, write " << filename
+                                                                                             << " uncompressed");
+        compress_ = false;
+    }
+#endif
+    out_.write(asdMagic, sizeof(asdMagic));
+    writeValue(out_, asdVersion);
+    writeValue(out_, endiannessMarker);
+    writeValue(out_, static_cast<std::uint32_t>(compress_ ? 1 : 0));
+    writeValue(out_, static_cast<std::uint64_t>(dimDates));
+    writeValue(out_, static_cast<std::uint64_t>(dimSamples));
+    writeValue(out_, static_cast<std::uint64_t>(keys.size()));
+    for (auto const& k : keys) {
+        writeValue(out_, static_cast<std::uint32_t>(k.first));
+        writeValue(out_, static_cast<std::uint32_t>(k.second.size()));
+        out_.write(k.second.data(), k.second.size());
+    }
+    buffer_.resize(chunkSize_ * sizeof(double));
+}
+
+BinaryAggregationScenarioDataWriter::~BinaryAggregationScenarioDataWriter() {
+    if (out_.is_open())
+        out_.close();
+}
+
+void BinaryAggregationScenarioDataWriter::write(const std::vector<Real>& values) {
+    QL_REQUIRE(out_.is_open(), "BinaryAggregationScenarioDataWriter: file " << filename_ << " is closed");
+    QL_REQUIRE(written_ < numKeys_,
+               "BinaryAggregationScenarioDataWriter: all " << numKeys_ << " keys are written already");
+    QL_REQUIRE(values.size() == chunkSize_, "BinaryAggregationScenarioDataWriter: got "
+                                                << values.size() << " values, expected " << chunkSize_);
+    pack<double>(buffer_.data(), values);
+    writeChunk(out_, buffer_, compress_);
+    QL_REQUIRE(!out_.fail(), "BinaryAggregationScenarioDataWriter: error writing to " << filename_);
+    ++written_;
+}
+
+void BinaryAggregationScenarioDataWriter::close() {
+    QL_REQUIRE(written_ == numKeys_, "BinaryAggregationScenarioDataWriter: " << written_ << " keys written to "
+                                                                             << filename_ << ", expected "
+                                                                             << numKeys_);
+    out_.close();
+    QL_REQUIRE(!out_.fail(), "BinaryAggregationScenarioDataWriter: error closing " << filename_);
+}
+
+BinaryAggregationScenarioDataReader::BinaryAggregationScenarioDataReader(const std::string& filename)
+    : filename_(filename), in_(filename, std::ios::binary), read_(0) {
+    QL_REQUIRE(in_.is_open(), "BinaryAggregationScenarioDataReader: error opening file " << filename);
+    char m[sizeof(asdMagic)];
+    std::uint32_t v, e, compressed;
+    std::uint64_t dimDates, dimSamples, nKeys;
+    read(m, sizeof(m));
+    QL_REQUIRE(std::memcmp(m, asdMagic, sizeof(asdMagic)) == 0, "BinaryAggregationScenarioDataReader: "
+                                                                    << filename_
+                                                                    << " is not a binary aggregation scenario file");
+    read(&v, sizeof(v));
+    QL_REQUIRE(v == asdVersion,
+               "BinaryAggregationScenarioDataReader: unsupported version " << v << " in " << filename_);
+    read(&e, sizeof(e));
+    QL_REQUIRE(e == endiannessMarker, "BinaryAggregationScenarioDataReader: "
+                                          << filename_ << " was written on a platform with different byte order");
+    read(&compressed, sizeof(compressed));
+#ifndef ORE_USE_ZLIB
+    QL_REQUIRE(compressed == 0, "BinaryAggregationScenarioDataReader: "
+                                    << filename_ << " is compressed, this requires zlib support (ORE_USE_ZLIB)");
+#endif
+    read(&dimDates, sizeof(dimDates));
+    read(&dimSamples, sizeof(dimSamples));
+    read(&nKeys, sizeof(nKeys));
+    dimDates_ = dimDates;
+    dimSamples_ = dimSamples;
+    compressed_ = compressed != 0;
+    for (Size i = 0; i < nKeys; ++i) {
+        std::uint32_t type, size;
+        read(&type, sizeof(type));
+        read(&size, sizeof(size));
+        std::string qualifier(size, ' ');
+        read(&qualifier[0], size);
+        keys_.push_back(std::make_pair(AggregationScenarioDataType(type), qualifier));
+    }
+    buffer_.resize(dimDates_ * dimSamples_ * sizeof(double));
+}
+
+void BinaryAggregationScenarioDataReader::read(void* target, Size bytes) { readBytes(in_, target, bytes, filename_); }
+
+bool BinaryAggregationScenarioDataReader::next(std::vector<Real>& values) {
+    if (read_ == keys_.size())
+        return false;
+    readChunk(in_, buffer_, stored_, compressed_, filename_, read_);
+    values.resize(dimDates_ * dimSamples_);
+    unpack<double>(buffer_.data(), values);
+    ++read_;
+    return true;
+}
+
+bool isBinaryAggregationScenarioDataFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char m[sizeof(asdMagic)];
+    return in.read(m, sizeof(m)) && std::memcmp(m, asdMagic, sizeof(asdMagic)) == 0;
+}
+
+} // namespace analytics
+} // namespace ore
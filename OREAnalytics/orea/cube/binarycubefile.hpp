@@ -0,0 +1,261 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/binarycubefile.hpp
+    \brief Binary cube and aggregation scenario data file formats, streaming writers and readers
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/scenario/aggregationscenariodata.hpp>
+
+#include <ql/time/date.hpp>
+#include <ql/types.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Number of threads used by default to compress and decompress cube files, the number of cores
+Size defaultCubeFileThreads();
+
+//! Streaming writer for binary cube files
+/*! The binary format is the counterpart of the csv format written by saveCube(). The file consists of
+
+    - a header with a magic string, a format version, an endianness marker, the size of the stored values (4 or 8
+      bytes), a compression flag, the asof date, the dimensions, the dates and the ids in the order of their index,
+    - the number of ids per chunk, the number of chunks and the chunk index, i.e. the file offset of each chunk,
+    - the chunks, each holding the values of a block of consecutive ids. For each id the T0 values (depth) are
+      followed by the future values (date, sample, depth). Each chunk starts with its uncompressed and its stored
+      size in bytes (uint64), if compression is enabled the chunk is zlib compressed.
+
+    Numbers are written in native byte order, the reader checks the endianness marker. The chunks are compressed
+    independently, so that they can be compressed and decompressed in parallel and single ids can be read without
+    decompressing the other chunks. The writer holds at most nThreads chunks in memory.
+
+    \ingroup cube
+*/
+class BinaryCubeWriter {
+public:
+    /*! Constructor, opens the file and writes the header. Compression requires ORE_USE_ZLIB, otherwise the chunks
+        are written uncompressed. If idsPerChunk is zero, the chunks hold about 8 MB of uncompressed values. */
+    BinaryCubeWriter(const std::string& filename, const Date& asof, const std::vector<std::string>& ids,
+                     const std::vector<Date>& dates, Size samples, Size depth, const bool doublePrecision = false,
+                     const bool compress = false, Size idsPerChunk = 0, Size nThreads = 1);
+    //! Destructor, closes the file
+    ~BinaryCubeWriter();
+
+    //! Write the values of the next id, t0 holds depth values, values holds dates x samples x depth values
+    void write(const std::vector<Real>& t0, const std::vector<Real>& values);
+    //! Close the file, all ids must have been written
+    void close();
+
+private:
+    // compress and write the pending chunks
+    void flush();
+
+    std::string filename_;
+    std::ofstream out_;
+    Size numIds_, idSize_, valueSize_, idsPerChunk_, nThreads_, written_, writtenChunks_;
+    bool compress_;
+    std::streampos indexPosition_;
+    std::vector<std::uint64_t> offsets_;
+    std::vector<std::vector<char>> pending_;
+};
+
+//! Reader for binary cube files, see BinaryCubeWriter for the format
+/*! The ids can be read sequentially by next(), by id using get(), or all at once on several threads by forEach().
+
+    \ingroup cube
+ */
+class BinaryCubeReader {
+public:
+    //! Constructor, opens the file and reads the header and the chunk index
+    explicit BinaryCubeReader(const std::string& filename);
+
+    const Date& asof() const { return asof_; }
+    //! The ids in the order of their index
+    const std::vector<std::string>& ids() const { return ids_; }
+    const std::vector<Date>& dates() const { return dates_; }
+    Size samples() const { return samples_; }
+    Size depth() const { return depth_; }
+    //! True if the values are stored in double precision
+    bool doublePrecision() const { return valueSize_ == sizeof(double); }
+    //! Number of chunks in the file
+    Size numChunks() const { return offsets_.size(); }
+    //! Number of ids per chunk, the last chunk may hold less
+    Size idsPerChunk() const { return idsPerChunk_; }
+    //! True if the chunks are compressed
+    bool compressed() const { return compressed_; }
+    //! File offset of the given chunk
+    std::uint64_t chunkOffset(Size c) const { return offsets_.at(c); }
+
+    /*! Read the values of the next id and return true, or return false if all ids have been read. t0 is resized to
+        depth values, values to dates x samples x depth values. */
+    bool next(std::vector<Real>& t0, std::vector<Real>& values);
+
+    //! Read the values of the given id, only the chunk holding the id is decompressed
+    void get(const std::string& id, std::vector<Real>& t0, std::vector<Real>& values);
+
+    /*! Decompress the chunks on up to nThreads threads and call f(n, t0, values) for each id, where n is the position
+        in ids(). f is called concurrently for different ids. */
+    void forEach(Size nThreads,
+                 const std::function<void(Size, const std::vector<Real>&, const std::vector<Real>&)>& f) const;
+
+private:
+    void read(void* target, Size bytes);
+    void loadChunk(std::ifstream& in, Size c, std::vector<char>& buffer, std::vector<char>& stored) const;
+    void extract(const std::vector<char>& buffer, Size n, std::vector<Real>& t0, std::vector<Real>& values) const;
+
+    std::string filename_;
+    std::ifstream in_;
+    Date asof_;
+    std::vector<std::string> ids_;
+    std::map<std::string, Size> idIndex_;
+    std::vector<Date> dates_;
+    Size samples_, depth_, valueSize_, idSize_, idsPerChunk_, read_, currentChunk_;
+    bool compressed_;
+    std::vector<std::uint64_t> offsets_;
+    std::vector<char> buffer_, stored_;
+};
+
+//! Memory mapped reader for uncompressed binary cube files, see BinaryCubeWriter for the format
+/*! The values are read in place from the mapped file, without loading the whole cube into memory. The values of an id
+    are stored contiguously, the depth T0 values are followed by the future values in date, sample, depth order. Files
+    written with compression (.bin.gz) are not supported, since they can not be read in place.
+
+    The same layout is read by the Python module FrontEnd/Python/Visualization/npvcube/ore_binary_cube.py, which
+    returns numpy views on the mapped file.
+
+    \ingroup cube
+ */
+class MappedBinaryCubeReader {
+public:
+    //! Constructor, reads the header and the chunk index and maps the file
+    explicit MappedBinaryCubeReader(const std::string& filename);
+
+    const Date& asof() const { return header_.asof(); }
+    //! The ids in the order of their index
+    const std::vector<std::string>& ids() const { return header_.ids(); }
+    const std::vector<Date>& dates() const { return header_.dates(); }
+    Size samples() const { return header_.samples(); }
+    Size depth() const { return header_.depth(); }
+    //! True if the values are stored in double precision
+    bool doublePrecision() const { return header_.doublePrecision(); }
+
+    //! The position of the id in ids()
+    Size index(const std::string& id) const;
+    //! File offset of the values of the id at position n in ids()
+    Size offset(Size n) const;
+    //! Pointer to the values of the id at position n in the mapped file, the values are not necessarily aligned
+    const char* data(Size n) const;
+
+    //! T0 value of the id at position n
+    Real getT0(Size n, Size depth = 0) const;
+    //! Future value of the id at position n
+    Real get(Size n, Size date, Size sample, Size depth = 0) const;
+
+private:
+    Real value(const char* p, Size i) const;
+
+    std::string filename_;
+    BinaryCubeReader header_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::map<std::string, Size> idIndex_;
+    Size idSize_, valueSize_;
+};
+
+//! Check whether the file is a binary cube file
+bool isBinaryCubeFile(const std::string& filename);
+
+//! Streaming writer for binary aggregation scenario data files
+/*! The format follows the one of the BinaryCubeWriter: a header with the magic string, version, endianness marker,
+    compression flag, the dimensions and the keys (type, qualifier), followed by one chunk per key holding the
+    date x sample values in double precision.
+
+    \ingroup cube
+*/
+class BinaryAggregationScenarioDataWriter {
+public:
+    //! Constructor, opens the file and writes the header
+    BinaryAggregationScenarioDataWriter(const std::string& filename, Size dimDates, Size dimSamples,
+                                        const std::vector<std::pair<AggregationScenarioDataType, std::string>>& keys,
+                                        const bool compress = false);
+    //! Destructor, closes the file
+    ~BinaryAggregationScenarioDataWriter();
+
+    //! Write the chunk of the next key, values holds dates x samples values
+    void write(const std::vector<Real>& values);
+    //! Close the file, all keys must have been written
+    void close();
+
+private:
+    std::string filename_;
+    std::ofstream out_;
+    Size numKeys_, chunkSize_, written_;
+    bool compress_;
+    std::vector<char> buffer_;
+};
+
+//! Streaming reader for binary aggregation scenario data files, see BinaryAggregationScenarioDataWriter
+/*! \ingroup cube
+ */
+class BinaryAggregationScenarioDataReader {
+public:
+    //! Constructor, opens the file and reads the header
+    explicit BinaryAggregationScenarioDataReader(const std::string& filename);
+
+    Size dimDates() const { return dimDates_; }
+    Size dimSamples() const { return dimSamples_; }
+    //! The keys in the order of the chunks
+    const std::vector<std::pair<AggregationScenarioDataType, std::string>>& keys() const { return keys_; }
+
+    /*! Read the chunk of the next key and return true, or return false if all keys have been read. values is resized
+        to dates x samples values. */
+    bool next(std::vector<Real>& values);
+
+private:
+    void read(void* target, Size bytes);
+
+    std::string filename_;
+    std::ifstream in_;
+    Size dimDates_, dimSamples_, read_;
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys_;
+    bool compressed_;
+    std::vector<char> buffer_, stored_;
+};
+
+//! Check whether the file is a binary aggregation scenario data file
+bool isBinaryAggregationScenarioDataFile(const std::string& filename);
+
+} // namespace analytics
+} // namespace ore
@@ -16,9 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/cube/arrow_io.hpp>
+#include <orea/cube/binarycubefile.hpp>
 #include <orea/cube/cube_io.hpp>
+#include <orea/cube/filemappedcube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 
+#include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
 
 #include <boost/filesystem.hpp>
@@ -46,6 +50,14 @@ bool use_compression(const std::string& filename) {
 #endif
 }
 
+bool use_binary(const std::string& filename) {
+    // binary format for filenames ending with bin or bin.gz
+    boost::filesystem::path p(filename);
+    if (p.extension().string() == ".gz")
+        p = p.stem();
+    return p.extension().string() == ".bin";
+}
+
 std::string getMetaData(const std::string& line, const std::string& tag) {
 
     // assuming a fixed width format "# tag        : <value>"
@@ -59,8 +71,107 @@ std::string getMetaData(const std::string& line, const std::string& tag) {
 
 } // namespace
 
+namespace {
+
+boost::shared_ptr<NPVCube> createInMemoryCube(const QuantLib::Date& asof, const std::set<std::string>& ids,
+                                              const std::vector<QuantLib::Date>& dates, Size samples, Size depth,
+                                              const bool doublePrecision) {
+    if (doublePrecision && depth <= 1)
+        return boost::make_shared<DoublePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0);
+    else if (doublePrecision && depth > 1)
+        return boost::make_shared<DoublePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0);
+    else if (!doublePrecision && depth <= 1)
+        return boost::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
+    else
+        return boost::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0f);
+}
+
+boost::shared_ptr<NPVCube> loadBinaryCube(const std::string& filename, const bool doublePrecision) {
+    BinaryCubeReader reader(filename);
+    std::set<std::string> ids(reader.ids().begin(), reader.ids().end());
+    auto result = createInMemoryCube(reader.asof(), ids, reader.dates(), reader.samples(), reader.depth(),
+                                     doublePrecision || reader.doublePrecision());
+    // the chunks are decompressed in parallel, each call sets the values of a different id
+    reader.forEach(defaultCubeFileThreads(), [&reader, &result](Size n, const std::vector<Real>& t0,
+                                                                const std::vector<Real>& values) {
+        Size i = result->getTradeIndex(reader.ids()[n]);
+        Size v = 0;
+        for (Size d = 0; d < reader.depth(); ++d)
+            result->setT0(t0[d], i, d);
+        for (Size j = 0; j < reader.dates().size(); ++j)
+            for (Size k = 0; k < reader.samples(); ++k)
+                for (Size d = 0; d < reader.depth(); ++d, ++v)
+                    result->set(values[v], i, j, k, d);
+    });
+    LOG("loaded binary cube from " << filename << ": asof = " << reader.asof() << ", dim = " << ids.size() << " x "
+                                   << reader.dates().size() << " x " << reader.samples() << " x " << reader.depth());
+    return result;
+}
+
+void saveBinaryCube(const std::string& filename, const NPVCube& cube, const bool doublePrecision) {
+    std::vector<std::string> ids(cube.numIds());
+    for (auto const& [id, pos] : cube.idsAndIndexes())
+        ids[pos] = id;
+    BinaryCubeWriter writer(filename, cube.asof(), ids, cube.dates(), cube.samples(), cube.depth(), doublePrecision,
+                            use_compression(filename), 0, defaultCubeFileThreads());
+    std::vector<Real> t0(cube.depth()), values(cube.numDates() * cube.samples() * cube.depth());
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        Size v = 0;
+        for (Size d = 0; d < cube.depth(); ++d)
+            t0[d] = cube.getT0(i, d);
+        for (Size j = 0; j < cube.numDates(); ++j)
+            for (Size k = 0; k < cube.samples(); ++k)
+                for (Size d = 0; d < cube.depth(); ++d, ++v)
+                    values[v] = cube.get(i, j, k, d);
+        writer.write(t0, values);
+    }
+    writer.close();
+}
+
+boost::shared_ptr<AggregationScenarioData> loadBinaryAggregationScenarioData(const std::string& filename) {
+    BinaryAggregationScenarioDataReader reader(filename);
+    auto result = boost::make_shared<InMemoryAggregationScenarioData>(reader.dimDates(), reader.dimSamples());
+    std::vector<Real> values;
+    for (Size n = 0; reader.next(values); ++n) {
+        auto const& key = reader.keys()[n];
+        for (Size i = 0, v = 0; i < reader.dimDates(); ++i)
+            for (Size j = 0; j < reader.dimSamples(); ++j, ++v)
+                result->set(i, j, values[v], key.first, key.second);
+    }
+    LOG("loaded binary aggregation scenario data from " << filename << ": dimDates = " << reader.dimDates()
+                                                        << ", dimSamples = " << reader.dimSamples()
+                                                        << ", keys = " << reader.keys().size());
+    return result;
+}
+
+void saveBinaryAggregationScenarioData(const std::string& filename, const AggregationScenarioData& cube) {
+    auto keys = cube.keys();
+    BinaryAggregationScenarioDataWriter writer(filename, cube.dimDates(), cube.dimSamples(), keys,
+                                               use_compression(filename));
+    std::vector<Real> values(cube.dimDates() * cube.dimSamples());
+    for (auto const& k : keys) {
+        for (Size i = 0, v = 0; i < cube.dimDates(); ++i)
+            for (Size j = 0; j < cube.dimSamples(); ++j, ++v)
+                values[v] = cube.get(i, j, k.first, k.second);
+        writer.write(values);
+    }
+    writer.close();
+}
+
+} // namespace
+
 boost::shared_ptr<NPVCube> loadCube(const std::string& filename, const bool doublePrecision) {
 
+    // file mapped cubes are used in place, the precision is given by the file
+
+    if (isFileMappedCube(filename)) {
+        LOG("loadCube(): map cube file " << filename);
+        return openFileMappedCube(filename, true);
+    }
+
+    if (isBinaryCubeFile(filename))
+        return loadBinaryCube(filename, doublePrecision);
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -103,16 +214,7 @@ boost::shared_ptr<NPVCube> loadCube(const std::string& filename, const bool doub
         ids.insert(line.substr(2));
     }
 
-    boost::shared_ptr<NPVCube> result;
-    if (doublePrecision && depth <= 1) {
-        result = boost::make_shared<DoublePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0);
-    } else if (doublePrecision && depth > 1) {
-        result = boost::make_shared<DoublePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0);
-    } else if (!doublePrecision && depth <= 1) {
-        result = boost::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-    } else if (!doublePrecision && depth > 1) {
-        result = boost::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0f);
-    }
+    boost::shared_ptr<NPVCube> result = createInMemoryCube(asof, ids, dates, samples, depth, doublePrecision);
 
     std::getline(in, line); // header line for data
 
@@ -144,6 +246,16 @@ boost::shared_ptr<NPVCube> loadCube(const std::string& filename, const bool doub
 
 void saveCube(const std::string& filename, const NPVCube& cube, const bool doublePrecision) {
 
+    if (isArrowFilename(filename)) {
+        saveCubeToArrow(filename, cube, doublePrecision);
+        return;
+    }
+
+    if (use_binary(filename)) {
+        saveBinaryCube(filename, cube, doublePrecision);
+        return;
+    }
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -199,6 +311,9 @@ void saveCube(const std::string& filename, const NPVCube& cube, const bool doubl
 
 boost::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename) {
 
+    if (isBinaryAggregationScenarioDataFile(filename))
+        return loadBinaryAggregationScenarioData(filename);
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -267,6 +382,16 @@ boost::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std
 
 void saveAggregationScenarioData(const std::string& filename, const AggregationScenarioData& cube) {
 
+    if (isArrowFilename(filename)) {
+        saveAggregationScenarioDataToArrow(filename, cube);
+        return;
+    }
+
+    if (use_binary(filename)) {
+        saveBinaryAggregationScenarioData(filename, cube);
+        return;
+    }
+
     // open file
 
     bool gzip = use_compression(filename);
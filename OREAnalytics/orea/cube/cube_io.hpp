@@ -29,10 +29,20 @@
 namespace ore {
 namespace analytics {
 
+/*! Load a cube from a csv, binary or file mapped cube file, the format is detected from the file content. Binary
+    and csv cubes are loaded into an InMemoryCube, stored in double precision if required by the parameter or the
+    binary file. File mapped cubes are mapped copy on write, see FileMappedCube. */
 boost::shared_ptr<NPVCube> loadCube(const std::string& filename, const bool doublePrecision = false);
+/*! Save a cube in the binary format if the filename ends with .bin or .bin.gz, see BinaryCubeWriter, as Arrow IPC file
+    if it ends with .arrow or .feather, see saveCubeToArrow(), and in the csv format otherwise. Csv files that do not
+    end with csv or txt are compressed if zlib support is enabled. */
 void saveCube(const std::string& filename, const NPVCube& cube, const bool doublePrecision = false);
 
+//! Load aggregation scenario data from a csv or binary file, the format is detected from the file content
 boost::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename);
+/*! Save aggregation scenario data in the binary format if the filename ends with .bin or .bin.gz, see
+    BinaryAggregationScenarioDataWriter, as Arrow IPC file if it ends with .arrow or .feather, see
+    saveAggregationScenarioDataToArrow(), and in the csv format otherwise */
 void saveAggregationScenarioData(const std::string& filename, const AggregationScenarioData& cube);
 
 } // namespace analytics
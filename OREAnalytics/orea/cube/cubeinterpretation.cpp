@@ -124,6 +124,60 @@ Real CubeInterpretation::getMporFlows(const boost::shared_ptr<NPVCube>& cube, Si
     return getMporPositiveFlows(cube, tradeIdx, dateIdx, sampleIdx) + getMporNegativeFlows(cube, tradeIdx, dateIdx, sampleIdx) ;
 }
 
+void CubeInterpretation::getGenericValues(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                          Size depth, std::vector<Real>& out) const {
+    cube->getSamples(tradeIdx, dateIdx, depth, out);
+    if (flipViewXVA_) {
+        for (auto& v : out)
+            v = -v;
+    }
+}
+
+void CubeInterpretation::getDefaultNpvs(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                        std::vector<Real>& out) const {
+    getGenericValues(cube, tradeIdx, dateIdx, defaultDateNpvIndex_, out);
+}
+
+void CubeInterpretation::getCloseOutNpvs(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                         std::vector<Real>& out) const {
+    if (withCloseOutLag_) {
+        getGenericValues(cube, tradeIdx, dateIdx, closeOutDateNpvIndex_, out);
+        for (Size k = 0; k < out.size(); ++k)
+            out[k] /= getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, dateIdx, k);
+    } else {
+        getGenericValues(cube, tradeIdx, dateIdx + 1, defaultDateNpvIndex_, out);
+    }
+}
+
+void CubeInterpretation::getMporPositiveFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                              std::vector<Real>& out) const {
+    try {
+        getGenericValues(cube, tradeIdx, dateIdx, mporFlowsIndex_, out);
+    } catch (std::exception& e) {
+        DLOG("Unable to retrieve MPOR flows for trade " << tradeIdx << ", date " << dateIdx << "; " << e.what());
+        out.assign(cube->samples(), 0.0);
+    }
+}
+
+void CubeInterpretation::getMporNegativeFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                              std::vector<Real>& out) const {
+    try {
+        getGenericValues(cube, tradeIdx, dateIdx, mporFlowsIndex_ + 1, out);
+    } catch (std::exception& e) {
+        DLOG("Unable to retrieve MPOR flows for trade " << tradeIdx << ", date " << dateIdx << "; " << e.what());
+        out.assign(cube->samples(), 0.0);
+    }
+}
+
+void CubeInterpretation::getMporFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                                      std::vector<Real>& out) const {
+    std::vector<Real> negative;
+    getMporPositiveFlows(cube, tradeIdx, dateIdx, out);
+    getMporNegativeFlows(cube, tradeIdx, dateIdx, negative);
+    for (Size k = 0; k < out.size(); ++k)
+        out[k] += negative[k];
+}
+
 Real CubeInterpretation::getDefaultAggregationScenarioData(const AggregationScenarioDataType& dataType, Size dateIdx,
                                                            Size sampleIdx, const std::string& qualifier) const {
     QL_REQUIRE(!aggregationScenarioData_.empty(),
@@ -33,6 +33,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace ore {
 using namespace data;
@@ -86,6 +87,21 @@ public:
     //! Retrieve the aggregate value of Margin Period of Risk cashflows from the Cube
     Real getMporFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx, Size sampleIdx) const;
 
+    /*! Slice versions of the methods above, retrieving the values of all samples for a trade and date at once, out is
+        resized to the number of samples of the cube */
+    void getGenericValues(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx, Size depth,
+                          std::vector<Real>& out) const;
+    void getDefaultNpvs(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                        std::vector<Real>& out) const;
+    void getCloseOutNpvs(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                         std::vector<Real>& out) const;
+    void getMporPositiveFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                              std::vector<Real>& out) const;
+    void getMporNegativeFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                              std::vector<Real>& out) const;
+    void getMporFlows(const boost::shared_ptr<NPVCube>& cube, Size tradeIdx, Size dateIdx,
+                      std::vector<Real>& out) const;
+
     //! Retrieve a (default date) simulated risk factor value from AggregationScenarioData
     Real getDefaultAggregationScenarioData(const AggregationScenarioDataType& dataType, Size dateIdx, Size sampleIdx,
                                            const std::string& qualifier = "") const;
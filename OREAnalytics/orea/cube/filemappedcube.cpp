@@ -0,0 +1,149 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/filemappedcube.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+const char magic[8] = {'O', 'R', 'E', 'C', 'U', 'B', 'E', '\0'};
+const std::uint32_t version = 1;
+const std::uint32_t endiannessMarker = 0x01020304;
+
+template <class T> void write(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+} // namespace
+
+namespace detail {
+
+void createFileMappedCubeFile(const std::string& filename, const FileMappedCubeHeader& header) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out.is_open(), "FileMappedCube: error creating file " << filename);
+    out.write(magic, sizeof(magic));
+    write(out, version);
+    write(out, endiannessMarker);
+    write(out, static_cast<std::uint32_t>(header.valueSize));
+    write(out, static_cast<std::uint32_t>(0));
+    write(out, static_cast<std::int64_t>(header.asof.serialNumber()));
+    write(out, static_cast<std::uint64_t>(header.ids.size()));
+    write(out, static_cast<std::uint64_t>(header.dates.size()));
+    write(out, static_cast<std::uint64_t>(header.samples));
+    write(out, static_cast<std::uint64_t>(header.depth));
+    for (auto const& d : header.dates)
+        write(out, static_cast<std::int64_t>(d.serialNumber()));
+    for (auto const& id : header.ids) {
+        write(out, static_cast<std::uint32_t>(id.size()));
+        out.write(id.data(), id.size());
+    }
+    Size pos = static_cast<Size>(out.tellp());
+    const char padding[8] = {};
+    out.write(padding, (8 - pos % 8) % 8);
+    pos = static_cast<Size>(out.tellp());
+    out.close();
+    QL_REQUIRE(!out.fail(), "FileMappedCube: error writing header to " << filename);
+    Size values = header.ids.size() * header.depth * (1 + header.dates.size() * header.samples);
+    boost::filesystem::resize_file(filename, pos + values * header.valueSize);
+    DLOG("FileMappedCube: created " << filename << " with " << header.ids.size() << " ids, " << header.dates.size()
+                                    << " dates, " << header.samples << " samples, depth " << header.depth);
+}
+
+FileMappedCubeHeader readFileMappedCubeHeader(const char* p, Size n, const std::string& filename) {
+    Size pos = 0;
+    auto read = [p, n, &pos, &filename](void* target, const Size bytes) {
+        QL_REQUIRE(pos + bytes <= n, "FileMappedCube: unexpected end of header in " << filename);
+        std::memcpy(target, p + pos, bytes);
+        pos += bytes;
+    };
+
+    char m[sizeof(magic)];
+    std::uint32_t v, e, valueSize, unused;
+    std::int64_t asof;
+    std::uint64_t nIds, nDates, samples, depth;
+    read(m, sizeof(m));
+    QL_REQUIRE(std::memcmp(m, magic, sizeof(magic)) == 0, "FileMappedCube: " << filename << " is not a cube file");
+    read(&v, sizeof(v));
+    QL_REQUIRE(v == version, "FileMappedCube: unsupported version " << v << " in " << filename);
+    read(&e, sizeof(e));
+    QL_REQUIRE(e == endiannessMarker,
+               "FileMappedCube: " << filename << " was written on a platform with different byte order");
+    read(&valueSize, sizeof(valueSize));
+    read(&unused, sizeof(unused));
+    read(&asof, sizeof(asof));
+    read(&nIds, sizeof(nIds));
+    read(&nDates, sizeof(nDates));
+    read(&samples, sizeof(samples));
+    read(&depth, sizeof(depth));
+
+    FileMappedCubeHeader header;
+    header.asof = Date(static_cast<Date::serial_type>(asof));
+    header.samples = samples;
+    header.depth = depth;
+    header.valueSize = valueSize;
+    for (Size i = 0; i < nDates; ++i) {
+        std::int64_t serial;
+        read(&serial, sizeof(serial));
+        header.dates.push_back(Date(static_cast<Date::serial_type>(serial)));
+    }
+    for (Size i = 0; i < nIds; ++i) {
+        std::uint32_t size;
+        read(&size, sizeof(size));
+        std::string id(size, ' ');
+        read(&id[0], size);
+        header.ids.insert(id);
+    }
+    header.dataOffset = (pos + 7) / 8 * 8;
+    QL_REQUIRE(header.ids.size() == nIds, "FileMappedCube: duplicate ids in " << filename);
+    QL_REQUIRE(header.dataOffset + valueSize * nIds * depth * (1 + nDates * samples) <= n,
+               "FileMappedCube: " << filename << " is truncated");
+    return header;
+}
+
+} // namespace detail
+
+bool isFileMappedCube(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char m[sizeof(magic)];
+    return in.read(m, sizeof(m)) && std::memcmp(m, magic, sizeof(magic)) == 0;
+}
+
+boost::shared_ptr<NPVCube> openFileMappedCube(const std::string& filename, const bool copyOnWrite) {
+    std::ifstream in(filename, std::ios::binary);
+    char header[sizeof(magic) + 3 * sizeof(std::uint32_t)];
+    QL_REQUIRE(in.read(header, sizeof(header)) && std::memcmp(header, magic, sizeof(magic)) == 0,
+               "openFileMappedCube: " << filename << " is not a cube file");
+    std::uint32_t valueSize;
+    std::memcpy(&valueSize, header + sizeof(magic) + 2 * sizeof(std::uint32_t), sizeof(valueSize));
+    if (valueSize == sizeof(double))
+        return boost::make_shared<DoublePrecisionFileMappedCube>(filename, copyOnWrite);
+    else if (valueSize == sizeof(float))
+        return boost::make_shared<SinglePrecisionFileMappedCube>(filename, copyOnWrite);
+    QL_FAIL("openFileMappedCube: unsupported value size " << valueSize << " in " << filename);
+}
+
+} // namespace analytics
+} // namespace ore
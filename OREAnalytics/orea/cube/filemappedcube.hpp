@@ -0,0 +1,223 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/filemappedcube.hpp
+    \brief A cube implementation that stores the cube in a memory mapped file
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+namespace detail {
+//! Meta data of a file mapped cube, see FileMappedCube
+struct FileMappedCubeHeader {
+    Date asof;
+    std::set<std::string> ids;
+    vector<Date> dates;
+    Size samples = 0;
+    Size depth = 0;
+    Size valueSize = 0;
+    // offset of the T0 values from the start of the file, a multiple of 8
+    Size dataOffset = 0;
+};
+
+//! Write the header to a new file and resize the file to hold the values, the values are zero
+void createFileMappedCubeFile(const std::string& filename, const FileMappedCubeHeader& header);
+//! Parse the header from the start of a mapped file of n bytes
+FileMappedCubeHeader readFileMappedCubeHeader(const char* p, Size n, const std::string& filename);
+} // namespace detail
+
+//! FileMappedCube stores the cube in a memory mapped binary file
+/*! The file consists of
+
+    - a header with a magic string, a format version, an endianness marker, the size of the stored values (4 or 8
+      bytes), the asof date, the dimensions, the dates and the ids, padded to a multiple of 8 bytes,
+    - the T0 values (id, depth), followed by the future values (id, date, sample, depth).
+
+    Numbers are stored in native byte order. The cube can hold more data than fits into memory, the operating system
+    pages in only the parts of the file that are accessed. The file is the persisted cube, it can be opened again by
+    the second constructor or by loadCube(), there is no separate save step.
+
+    \ingroup cube
+ */
+template <typename T> class FileMappedCube : public NPVCube {
+public:
+    //! ctor, creates the file, an existing file is overwritten
+    FileMappedCube(const std::string& filename, const Date& asof, const std::set<std::string>& ids,
+                   const vector<Date>& dates, Size samples, Size depth = 1, const T& t = T())
+        : filename_(filename) {
+        QL_REQUIRE(ids.size() > 0, "FileMappedCube::FileMappedCube no ids specified");
+        QL_REQUIRE(dates.size() > 0, "FileMappedCube::FileMappedCube no dates specified");
+        QL_REQUIRE(samples > 0, "FileMappedCube::FileMappedCube samples must be > 0");
+        QL_REQUIRE(depth > 0, "FileMappedCube::FileMappedCube depth must be > 0");
+        detail::FileMappedCubeHeader header;
+        header.asof = asof;
+        header.ids = ids;
+        header.dates = dates;
+        header.samples = samples;
+        header.depth = depth;
+        header.valueSize = sizeof(T);
+        detail::createFileMappedCubeFile(filename, header);
+        map(boost::interprocess::read_write, boost::interprocess::read_write);
+        if (t != T())
+            std::fill(t0Data_, data_ + offset(numIds(), 0, 0, 0), t);
+    }
+
+    /*! ctor, opens an existing file, if copyOnWrite is true, values set on the cube are not written back to the
+        file */
+    explicit FileMappedCube(const std::string& filename, const bool copyOnWrite = false) : filename_(filename) {
+        if (copyOnWrite)
+            map(boost::interprocess::read_only, boost::interprocess::copy_on_write);
+        else
+            map(boost::interprocess::read_write, boost::interprocess::read_write);
+    }
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+
+    //! Return a map of all ids and their position in the cube
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! Get a T0 value from the cube
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return t0Data_[i * depth_ + d];
+    }
+
+    //! Set a value in the cube
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+
+    //! Get a value from the cube
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return data_[offset(i, j, k, d)];
+    }
+
+    //! Set a value in the cube
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        data_[offset(i, j, k, d)] = static_cast<T>(value);
+    }
+
+    //! Get the values of all samples for a given id, date and depth
+    void getSamples(Size i, Size j, Size d, std::vector<Real>& out) const override {
+        check(i, j, 0, d);
+        const T* p = data_ + offset(i, j, 0, d);
+        out.resize(samples_);
+        for (Size k = 0; k < samples_; ++k)
+            out[k] = p[k * depth_];
+    }
+
+    //! Remove all values for a given id, the values for one id are contiguous
+    void remove(Size i) override {
+        check(i, 0, 0, 0);
+        std::fill(t0Data_ + i * depth_, t0Data_ + (i + 1) * depth_, T());
+        std::fill(data_ + offset(i, 0, 0, 0), data_ + offset(i + 1, 0, 0, 0), T());
+    }
+
+    //! The file name
+    const std::string& filename() const { return filename_; }
+
+    //! Write the modified pages to the file, this is done by the operating system anyway when the cube is destroyed
+    void flush() { region_.flush(); }
+
+protected:
+    void map(boost::interprocess::mode_t fileMode, boost::interprocess::mode_t regionMode) {
+        file_ = boost::interprocess::file_mapping(filename_.c_str(), fileMode);
+        region_ = boost::interprocess::mapped_region(file_, regionMode);
+        char* p = static_cast<char*>(region_.get_address());
+        detail::FileMappedCubeHeader header = detail::readFileMappedCubeHeader(p, region_.get_size(), filename_);
+        QL_REQUIRE(header.valueSize == sizeof(T), "FileMappedCube: file " << filename_ << " stores values of size "
+                                                                          << header.valueSize << ", expected "
+                                                                          << sizeof(T));
+        asof_ = header.asof;
+        dates_ = header.dates;
+        samples_ = header.samples;
+        depth_ = header.depth;
+        Size pos = 0;
+        for (const auto& id : header.ids)
+            idIdx_[id] = pos++;
+        t0Data_ = reinterpret_cast<T*>(p + header.dataOffset);
+        data_ = t0Data_ + idIdx_.size() * depth_;
+    }
+
+    Size offset(Size i, Size j, Size k, Size d) const { return ((i * dates_.size() + j) * samples_ + k) * depth_ + d; }
+
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    std::string filename_;
+    QuantLib::Date asof_;
+    vector<QuantLib::Date> dates_;
+    Size samples_ = 0;
+    Size depth_ = 0;
+    std::map<std::string, Size> idIdx_;
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    T* t0Data_ = nullptr;
+    T* data_ = nullptr;
+};
+
+//! FileMappedCube with single precision floating point numbers.
+using SinglePrecisionFileMappedCube = FileMappedCube<float>;
+
+//! FileMappedCube with double precision floating point numbers.
+using DoublePrecisionFileMappedCube = FileMappedCube<double>;
+
+//! Check whether the file is a file mapped cube
+bool isFileMappedCube(const std::string& filename);
+
+//! Open a file mapped cube with the precision stored in the file, see FileMappedCube
+boost::shared_ptr<NPVCube> openFileMappedCube(const std::string& filename, const bool copyOnWrite = false);
+
+} // namespace analytics
+} // namespace ore
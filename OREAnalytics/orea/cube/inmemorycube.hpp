@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -30,6 +31,7 @@
 
 #include <boost/make_shared.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <set>
 
 namespace ore {
@@ -39,11 +41,17 @@ using QuantLib::Real;
 using QuantLib::Size;
 using std::vector;
 
-//! InMemoryCube stores the cube in memory using nested STL vectors
-/*! InMemoryCube stores the cube in memory using nested STL vectors, this class is a template
- *  to allow both single and double precision implementations.
- *
- *  The use of nested STL vectors is adds a small memory overhead (~ 1 to 2%)
+//! Order of the dimensions in the flat storage of an InMemoryCube, the last dimension varies fastest
+/*! The samples and depth of one (id, date) pair are contiguous in both orders. DateTradeSampleDepth stores all ids
+    of one date contiguously, which suits aggregations over the netting sets or trades for a fixed date.
+
+    \ingroup cube
+ */
+enum class InMemoryCubeLayout { TradeDateSampleDepth, DateTradeSampleDepth };
+
+//! InMemoryCube stores the cube in memory using a single contiguous STL vector
+/*! InMemoryCube stores the cube in memory using a single contiguous STL vector in the order given by the
+ *  InMemoryCubeLayout, this class is a template to allow both single and double precision implementations.
 
  \ingroup cube
  */
@@ -51,17 +59,25 @@ template <typename T> class InMemoryCubeBase : public NPVCube {
 public:
     //! default ctor
     InMemoryCubeBase(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
-                     const T& t = T())
-        : asof_(asof), dates_(dates), samples_(samples), t0Data_(ids.size(), t),
-          data_(ids.size(), vector<vector<T>>(dates.size(), vector<T>(samples, t))) {
+                     Size depth, const T& t = T(),
+                     InMemoryCubeLayout layout = InMemoryCubeLayout::TradeDateSampleDepth)
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth), layout_(layout),
+          t0Data_(ids.size() * depth, t), data_(ids.size() * dates.size() * samples * depth, t) {
         QL_REQUIRE(ids.size() > 0, "InMemoryCube::InMemoryCube no ids specified");
         QL_REQUIRE(dates.size() > 0, "InMemoryCube::InMemoryCube no dates specified");
         QL_REQUIRE(samples > 0, "InMemoryCube::InMemoryCube samples must be > 0");
+        QL_REQUIRE(depth > 0, "InMemoryCube::InMemoryCube depth must be > 0");
         size_t pos = 0;
         for (const auto& id : ids) {
             idIdx_[id] = pos++;
         }
-        
+        if (layout_ == InMemoryCubeLayout::TradeDateSampleDepth) {
+            dateStride_ = samples * depth;
+            idStride_ = dates.size() * dateStride_;
+        } else {
+            idStride_ = samples * depth;
+            dateStride_ = ids.size() * idStride_;
+        }
     }
 
     //! default constructor
@@ -80,6 +96,48 @@ public:
     //! Return the asof date (T0 date)
     QuantLib::Date asof() const override { return asof_; }
 
+    //! The order of the dimensions in the storage
+    InMemoryCubeLayout layout() const { return layout_; }
+
+    //! The samples x depth values for id i and date j, contiguous with the depth varying fastest
+    const T* values(Size i, Size j) const {
+        check(i, j, 0, 0);
+        return data_.data() + offset(i, j, 0, 0);
+    }
+
+    //! Get the values of all samples for a given id, date and depth
+    void getSamples(Size i, Size j, Size d, std::vector<Real>& out) const override {
+        check(i, j, 0, d);
+        const T* p = data_.data() + offset(i, j, 0, d);
+        out.resize(samples_);
+        for (Size k = 0; k < samples_; ++k)
+            out[k] = p[k * depth_];
+    }
+
+    //! Remove all values for a given id
+    void remove(Size i) override {
+        check(i, 0, 0, 0);
+        std::fill(t0Data_.begin() + i * depth_, t0Data_.begin() + (i + 1) * depth_, T());
+        if (layout_ == InMemoryCubeLayout::TradeDateSampleDepth) {
+            std::fill(data_.begin() + offset(i, 0, 0, 0), data_.begin() + offset(i, 0, 0, 0) + idStride_, T());
+        } else {
+            for (Size j = 0; j < dates_.size(); ++j)
+                std::fill(data_.begin() + offset(i, j, 0, 0), data_.begin() + offset(i, j, 0, 0) + idStride_, T());
+        }
+    }
+
+    //! Remove all values for a given id and sample, keep the T0 values
+    void remove(Size i, Size k) override {
+        check(i, 0, k, 0);
+        for (Size j = 0; j < dates_.size(); ++j)
+            std::fill(data_.begin() + offset(i, j, k, 0), data_.begin() + offset(i, j, k, 0) + depth_, T());
+    }
+
+    std::size_t memoryFootprint() const override {
+        return ore::data::memoryFootprint(data_) + ore::data::memoryFootprint(t0Data_) +
+               ore::data::memoryFootprint(dates_) + ore::data::memoryFootprint(idIdx_);
+    }
+
 protected:
     void check(Size i, Size j, Size k, Size d) const {
         QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
@@ -88,25 +146,29 @@ protected:
         QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
     }
 
+    Size offset(Size i, Size j, Size k, Size d) const { return i * idStride_ + j * dateStride_ + k * depth_ + d; }
+
     QuantLib::Date asof_;
     vector<QuantLib::Date> dates_;
-    Size samples_;
+    Size samples_ = 0;
+    Size depth_ = 0;
+    InMemoryCubeLayout layout_ = InMemoryCubeLayout::TradeDateSampleDepth;
+    Size idStride_ = 0, dateStride_ = 0;
     vector<T> t0Data_;
-    vector<vector<vector<T>>> data_;
+    vector<T> data_;
 
     std::map<std::string, Size> idIdx_;
 };
 
 //! InMemoryCube of fixed depth 1
-/*! This implementation stores the type directly in an InMemoryCubeBase to avoid us having
- *  nested vectors all of length 1
+/*! This implementation stores the type directly in an InMemoryCubeBase of depth 1
  */
 template <typename T> class InMemoryCube1 : public InMemoryCubeBase<T> {
 public:
     //! ctor
     InMemoryCube1(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
-                  const T& t = T())
-        : InMemoryCubeBase<T>(asof, ids, dates, samples, t) {}
+                  const T& t = T(), InMemoryCubeLayout layout = InMemoryCubeLayout::TradeDateSampleDepth)
+        : InMemoryCubeBase<T>(asof, ids, dates, samples, 1, t, layout) {}
 
     //! default
     InMemoryCube1() {}
@@ -129,54 +191,54 @@ public:
     //! Get a value from the cube
     Real get(Size i, Size j, Size k, Size d) const override {
         this->check(i, j, k, d);
-        return this->data_[i][j][k];
+        return this->data_[this->offset(i, j, k, 0)];
     }
 
     //! Set a value in the cube
     void set(Real value, Size i, Size j, Size k, Size d) override {
         this->check(i, j, k, d);
-        this->data_[i][j][k] = static_cast<T>(value);
+        this->data_[this->offset(i, j, k, 0)] = static_cast<T>(value);
     }
 };
 
 //! InMemoryCube of variable depth
-/*! This implementation stores a vector an InMemoryCubeBase
+/*! This implementation stores the depth as the fastest varying dimension of an InMemoryCubeBase
  */
-template <typename T> class InMemoryCubeN : public InMemoryCubeBase<vector<T>> {
+template <typename T> class InMemoryCubeN : public InMemoryCubeBase<T> {
 public:
     //! ctor
     InMemoryCubeN(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples, Size depth,
-                  const T& t = T())
-        : InMemoryCubeBase<vector<T>>(asof, ids, dates, samples, vector<T>(depth, t)) {}
+                  const T& t = T(), InMemoryCubeLayout layout = InMemoryCubeLayout::TradeDateSampleDepth)
+        : InMemoryCubeBase<T>(asof, ids, dates, samples, depth, t, layout) {}
 
     //! default
     InMemoryCubeN() {}
 
     //! Depth
-    Size depth() const override { return this->data_[0][0][0].size(); } // we don't want any members in this class
+    Size depth() const override { return this->depth_; }
 
     //! Get a T0 value from the cube
     virtual Real getT0(Size i, Size d) const override {
         this->check(i, 0, 0, d);
-        return this->t0Data_[i][d];
+        return this->t0Data_[i * this->depth_ + d];
     }
 
     //! Set a value in the cube
     virtual void setT0(Real value, Size i, Size d) override {
         this->check(i, 0, 0, d);
-        this->t0Data_[i][d] = static_cast<T>(value);
+        this->t0Data_[i * this->depth_ + d] = static_cast<T>(value);
     }
 
     //! Get a value from the cube
     Real get(Size i, Size j, Size k, Size d) const override {
         this->check(i, j, k, d);
-        return this->data_[i][j][k][d];
+        return this->data_[this->offset(i, j, k, d)];
     }
 
     //! Set a value in the cube
     void set(Real value, Size i, Size j, Size k, Size d) override {
         this->check(i, j, k, d);
-        this->data_[i][j][k][d] = static_cast<T>(value);
+        this->data_[this->offset(i, j, k, d)] = static_cast<T>(value);
     }
 };
 
@@ -16,10 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 
 #include <ql/errors.hpp>
 
+#include <boost/make_shared.hpp>
+
 #include <numeric>
 #include <set>
 
@@ -107,14 +110,14 @@ const std::vector<QuantLib::Date>& JointNPVCube::dates() const { return cubes_[0
 
 QuantLib::Date JointNPVCube::asof() const { return cubes_[0]->asof(); }
 
-std::set<std::pair<boost::shared_ptr<NPVCube>, Size>> JointNPVCube::cubeAndId(Size id) const {
+const std::set<std::pair<boost::shared_ptr<NPVCube>, Size>>& JointNPVCube::cubeAndId(Size id) const {
     QL_REQUIRE(id < cubeAndId_.size(),
                "JointNPVCube: id (" << id << ") out of range, have " << cubeAndId_.size() << " ids");
     return cubeAndId_[id];
 }
 
 Real JointNPVCube::getT0(Size id, Size depth) const {
-    auto cids = cubeAndId(id);
+    const auto& cids = cubeAndId(id);
     if (cids.size() == 1)
         return cids.begin()->first->getT0(cids.begin()->second, depth);
     Real tmp = accumulatorInit_;
@@ -124,14 +127,14 @@ Real JointNPVCube::getT0(Size id, Size depth) const {
 }
 
 void JointNPVCube::setT0(Real value, Size id, Size depth) {
-    auto c = cubeAndId(id);
+    const auto& c = cubeAndId(id);
     QL_REQUIRE(c.size() == 1,
                "JointNPVCube::setT0(): not allowed, because id '" << id << "' occurs in more than one input cube");
     (*c.begin()).first->setT0(value, (*c.begin()).second, depth);
 }
 
 Real JointNPVCube::get(Size id, Size date, Size sample, Size depth) const {
-    auto cids = cubeAndId(id);
+    const auto& cids = cubeAndId(id);
     if (cids.size() == 1)
         return cids.begin()->first->get(cids.begin()->second, date, sample, depth);
     Real tmp = accumulatorInit_;
@@ -141,11 +144,50 @@ Real JointNPVCube::get(Size id, Size date, Size sample, Size depth) const {
 }
 
 void JointNPVCube::set(Real value, Size id, Size date, Size sample, Size depth) {
-    auto c = cubeAndId(id);
+    const auto& c = cubeAndId(id);
     QL_REQUIRE(c.size() == 1,
                "JointNPVCube::set(): not allowed, because id '" << id << "' occurs in more than one input cube");
     (*c.begin()).first->set(value, (*c.begin()).second, date, sample, depth);
 }
 
+void JointNPVCube::getSamples(Size id, Size date, Size depth, std::vector<Real>& out) const {
+    const auto& cids = cubeAndId(id);
+    if (cids.size() == 1) {
+        cids.begin()->first->getSamples(cids.begin()->second, date, depth, out);
+        return;
+    }
+    out.assign(samples(), accumulatorInit_);
+    std::vector<Real> tmp;
+    for (auto const& p : cids) {
+        p.first->getSamples(p.second, date, depth, tmp);
+        for (Size k = 0; k < tmp.size(); ++k)
+            out[k] = accumulator_(out[k], tmp[k]);
+    }
+}
+
+boost::shared_ptr<NPVCube> JointNPVCube::materialise(const bool doublePrecision) const {
+    std::set<std::string> ids;
+    for (auto const& [id, ignored] : idIdx_)
+        ids.insert(id);
+    boost::shared_ptr<NPVCube> result;
+    if (doublePrecision)
+        result = boost::make_shared<DoublePrecisionInMemoryCubeN>(asof(), ids, dates(), samples(), depth(), 0.0);
+    else
+        result = boost::make_shared<SinglePrecisionInMemoryCubeN>(asof(), ids, dates(), samples(), depth(), 0.0f);
+    // the ids of both cubes are ordered lexicographically, so the indices coincide
+    std::vector<Real> values;
+    for (Size i = 0; i < numIds(); ++i) {
+        for (Size d = 0; d < depth(); ++d) {
+            result->setT0(getT0(i, d), i, d);
+            for (Size j = 0; j < numDates(); ++j) {
+                getSamples(i, j, d, values);
+                for (Size k = 0; k < values.size(); ++k)
+                    result->set(values[k], i, j, k, d);
+            }
+        }
+    }
+    return result;
+}
+
 } // namespace analytics
 } // namespace ore
@@ -26,6 +26,7 @@
 #include <orea/cube/npvcube.hpp>
 
 #include <set>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -75,8 +76,16 @@ public:
     Real get(Size id, Size date, Size sample, Size depth = 0) const override;
     void set(Real value, Size id, Size date, Size sample, Size depth = 0) override;
 
+    /*! Get the values of all samples for the given id, date and depth. This avoids the per cell lookup and
+        aggregation of get(), the samples are read from the input cubes in bulk. */
+    void getSamples(Size id, Size date, Size depth, std::vector<Real>& out) const override;
+
+    /*! Build an InMemoryCube holding the values of this cube. Duplicate ids are aggregated once, so that consumers
+        reading the result cube repeatedly do not pay the aggregation cost on each access. */
+    boost::shared_ptr<NPVCube> materialise(const bool doublePrecision = false) const;
+
 private:
-    std::set<std::pair<boost::shared_ptr<NPVCube>, Size>> cubeAndId(Size id) const;
+    const std::set<std::pair<boost::shared_ptr<NPVCube>, Size>>& cubeAndId(Size id) const;
 
     const std::vector<boost::shared_ptr<NPVCube>> cubes_;
     const std::function<Real(Real a, Real x)> accumulator_;
@@ -132,6 +132,11 @@ std::map<QuantLib::Size, QuantLib::Real> JointNPVSensiCube::getTradeNPVs(Size tr
     return c.first->getTradeNPVs(c.second);
 }
 
+std::vector<QuantLib::Size> JointNPVSensiCube::getTradeScenarios(Size tradeIdx) const {
+    const auto& c = cubeAndId(tradeIdx);
+    return c.first->getTradeScenarios(c.second);
+}
+
 std::set<QuantLib::Size> JointNPVSensiCube::relevantScenarios() const {
     std::set<QuantLib::Size> tmp;
     for (auto const& c : cubes_) {
@@ -65,6 +65,7 @@ public:
     void set(Real value, Size id, Size date, Size sample, Size depth = 0) override;
 
     std::map<QuantLib::Size, QuantLib::Real> getTradeNPVs(Size tradeIdx) const override;
+    std::vector<QuantLib::Size> getTradeScenarios(Size tradeIdx) const override;
     std::set<QuantLib::Size> relevantScenarios() const override;
 
     void remove(Size id) override;
@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/memorymappedcube.hpp
+    \brief A cube implementation that stores the cube in a memory mapped region
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/interprocess/anonymous_shared_memory.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+//! MemoryMappedCube stores the cube in a single contiguous memory mapped region
+/*! The region is an anonymous shared mapping, i.e. it is not backed by a file, but it is shared with child processes
+    created by fork(). Values written by a child process are therefore visible in the parent process without any
+    copying, which is used by the process based backend of the MultiThreadedValuationEngine.
+
+    The T0 values are stored first (id, depth), followed by the future values (id, date, sample, depth).
+
+    \ingroup cube
+ */
+template <typename T> class MemoryMappedCube : public NPVCube {
+public:
+    //! ctor
+    MemoryMappedCube(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
+                     Size depth = 1, const T& t = T())
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth),
+          region_(boost::interprocess::anonymous_shared_memory(regionSize(ids.size(), dates.size(), samples, depth))) {
+        QL_REQUIRE(ids.size() > 0, "MemoryMappedCube::MemoryMappedCube no ids specified");
+        QL_REQUIRE(dates.size() > 0, "MemoryMappedCube::MemoryMappedCube no dates specified");
+        QL_REQUIRE(samples > 0, "MemoryMappedCube::MemoryMappedCube samples must be > 0");
+        QL_REQUIRE(depth > 0, "MemoryMappedCube::MemoryMappedCube depth must be > 0");
+        size_t pos = 0;
+        for (const auto& id : ids) {
+            idIdx_[id] = pos++;
+        }
+        t0Data_ = static_cast<T*>(region_.get_address());
+        data_ = t0Data_ + ids.size() * depth_;
+        std::fill(t0Data_, data_ + ids.size() * dates.size() * samples * depth, t);
+    }
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+
+    //! Return a map of all ids and their position in the cube
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! Get a T0 value from the cube
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return t0Data_[i * depth_ + d];
+    }
+
+    //! Set a value in the cube
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+
+    //! Get a value from the cube
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return data_[offset(i, j, k, d)];
+    }
+
+    //! Set a value in the cube
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        data_[offset(i, j, k, d)] = static_cast<T>(value);
+    }
+
+    //! Get the values of all samples for a given id, date and depth
+    void getSamples(Size i, Size j, Size d, std::vector<Real>& out) const override {
+        check(i, j, 0, d);
+        const T* p = data_ + offset(i, j, 0, d);
+        out.resize(samples_);
+        for (Size k = 0; k < samples_; ++k)
+            out[k] = p[k * depth_];
+    }
+
+    //! Remove all values for a given id, the values for one id are contiguous
+    void remove(Size i) override {
+        check(i, 0, 0, 0);
+        std::fill(t0Data_ + i * depth_, t0Data_ + (i + 1) * depth_, T());
+        std::fill(data_ + offset(i, 0, 0, 0), data_ + offset(i + 1, 0, 0, 0), T());
+    }
+
+protected:
+    static std::size_t regionSize(Size ids, Size dates, Size samples, Size depth) {
+        return sizeof(T) * ids * depth * (1 + dates * samples);
+    }
+
+    Size offset(Size i, Size j, Size k, Size d) const { return ((i * dates_.size() + j) * samples_ + k) * depth_ + d; }
+
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    QuantLib::Date asof_;
+    vector<QuantLib::Date> dates_;
+    Size samples_;
+    Size depth_;
+    std::map<std::string, Size> idIdx_;
+
+    boost::interprocess::mapped_region region_;
+    T* t0Data_;
+    T* data_;
+};
+
+//! MemoryMappedCube with single precision floating point numbers.
+using SinglePrecisionMemoryMappedCube = MemoryMappedCube<float>;
+
+//! MemoryMappedCube with double precision floating point numbers.
+using DoublePrecisionMemoryMappedCube = MemoryMappedCube<double>;
+
+} // namespace analytics
+} // namespace ore
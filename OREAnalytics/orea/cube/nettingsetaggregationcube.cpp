@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/nettingsetaggregationcube.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/make_shared.hpp>
+
+namespace ore {
+namespace analytics {
+
+NettingSetAggregationCube::NettingSetAggregationCube(const Date& asof, const std::set<std::string>& ids,
+                                                     const std::map<std::string, std::string>& nettingSetIds,
+                                                     const std::vector<Date>& dates, Size samples, Size depth,
+                                                     const std::set<std::string>& subtractedIds) {
+    init(asof, ids, nettingSetIds, dates, samples, depth, subtractedIds);
+}
+
+NettingSetAggregationCube::NettingSetAggregationCube(const Date& asof,
+                                                     const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                                                     const std::vector<Date>& dates, Size samples, Size depth,
+                                                     const std::set<std::string>& subtractedIds) {
+    std::map<std::string, std::string> nettingSetIds;
+    for (const auto& [tid, t] : portfolio->trades())
+        nettingSetIds[tid] = t->envelope().nettingSetId();
+    init(asof, portfolio->ids(), nettingSetIds, dates, samples, depth, subtractedIds);
+}
+
+void NettingSetAggregationCube::init(const Date& asof, const std::set<std::string>& ids,
+                                     const std::map<std::string, std::string>& nettingSetIds,
+                                     const std::vector<Date>& dates, Size samples, Size depth,
+                                     const std::set<std::string>& subtractedIds) {
+    QL_REQUIRE(!ids.empty(), "NettingSetAggregationCube: no ids specified");
+    std::set<std::string> nettingSets;
+    for (const auto& id : ids) {
+        auto n = nettingSetIds.find(id);
+        QL_REQUIRE(n != nettingSetIds.end(), "NettingSetAggregationCube: no netting set given for id " << id);
+        nettingSets.insert(n->second);
+    }
+    // the netting sets are summed in double precision, there are usually much fewer netting sets than trades
+    nettingSetCube_ =
+        boost::make_shared<DoublePrecisionInMemoryCubeN>(asof, nettingSets, dates, samples, depth, 0.0);
+    Size pos = 0;
+    for (const auto& id : ids) {
+        idIdx_[id] = pos++;
+        nettingSetIndex_.push_back(nettingSetCube_->getTradeIndex(nettingSetIds.at(id)));
+        sign_.push_back(subtractedIds.find(id) == subtractedIds.end() ? 1.0 : -1.0);
+    }
+    t0Data_.resize(ids.size() * depth, 0.0);
+}
+
+void NettingSetAggregationCube::check(Size id, Size depth) const {
+    QL_REQUIRE(id < numIds(), "NettingSetAggregationCube: out of bounds on ids (id=" << id << ", numIds=" << numIds()
+                                                                                       << ")");
+    QL_REQUIRE(depth < this->depth(),
+               "NettingSetAggregationCube: out of bounds on depth (depth=" << depth << ", depth=" << this->depth()
+                                                                           << ")");
+}
+
+Real NettingSetAggregationCube::getT0(Size id, Size depth) const {
+    check(id, depth);
+    return t0Data_[id * this->depth() + depth];
+}
+
+void NettingSetAggregationCube::setT0(Real value, Size id, Size depth) {
+    check(id, depth);
+    Real& t0 = t0Data_[id * this->depth() + depth];
+    Size n = nettingSetIndex_[id];
+    nettingSetCube_->setT0(nettingSetCube_->getT0(n, depth) + sign_[id] * (value - t0), n, depth);
+    t0 = value;
+}
+
+Real NettingSetAggregationCube::get(Size id, Size date, Size sample, Size depth) const {
+    QL_FAIL("NettingSetAggregationCube: future values are not stored on trade level, use the netting set cube");
+}
+
+void NettingSetAggregationCube::set(Real value, Size id, Size date, Size sample, Size depth) {
+    check(id, depth);
+    Size n = nettingSetIndex_[id];
+    nettingSetCube_->set(nettingSetCube_->get(n, date, sample, depth) + sign_[id] * value, n, date, sample, depth);
+}
+
+void NettingSetAggregationCube::remove(Size id) {
+    for (Size d = 0; d < depth(); ++d)
+        setT0(0.0, id, d);
+    WLOG("NettingSetAggregationCube: the future values of id " << id
+                                                               << " can not be removed from the netting set values");
+}
+
+void NettingSetAggregationCube::remove(Size id, Size sample) {
+    // nothing to do, the T0 values are kept and the future values are not stored on trade level
+    check(id, 0);
+}
+
+} // namespace analytics
+} // namespace ore
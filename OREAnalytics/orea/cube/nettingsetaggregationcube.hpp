@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+/*! \file orea/cube/nettingsetaggregationcube.hpp
+    \brief A cube that aggregates the trade values written to it by netting set
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! NettingSetAggregationCube adds the trade values written to it to the values of the trade's netting set
+/*! The cube has the trade ids and can be passed to the ValuationEngine as output cube, but it does not store the
+    future values on trade level. Each value set for a trade is added to the value of the trade's netting set at the
+    same date, sample and depth in nettingSetCube(), i.e. the netting set exposure profiles are aggregated while the
+    trades are priced and the memory of the trade level cube is not needed. The T0 values are stored on trade level as
+    well, they are needed e.g. for the trade level T0 exposures.
+
+    Getting a future trade value is an error. Since the aggregated values can not be attributed to the trades
+    afterwards, remove() only resets the T0 values of the trade, the future values of the trade priced before the
+    trade's valuation failed remain in the netting set values.
+
+    The values of the subtractedIds are subtracted from the netting set values instead. Together with a netting set cube
+    from a previous run on the same scenarios, this allows to add and remove trades without pricing the rest of the
+    netting set again, see the incremental XVA mode of the XvaAnalytic.
+
+    The value of a netting set, date, sample and depth is updated by reading and writing it, so that concurrent writes
+    are only safe for distinct samples, as in the sample parallel MultiThreadedValuationEngine.
+
+    \ingroup cube
+ */
+class NettingSetAggregationCube : public NPVCube {
+public:
+    //! ctor, nettingSetIds maps each id to its netting set
+    NettingSetAggregationCube(const Date& asof, const std::set<std::string>& ids,
+                              const std::map<std::string, std::string>& nettingSetIds, const std::vector<Date>& dates,
+                              Size samples, Size depth, const std::set<std::string>& subtractedIds = {});
+
+    //! ctor, aggregates the trades of the portfolio by their netting set
+    NettingSetAggregationCube(const Date& asof, const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                              const std::vector<Date>& dates, Size samples, Size depth,
+                              const std::set<std::string>& subtractedIds = {});
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return nettingSetCube_->numDates(); }
+    Size samples() const override { return nettingSetCube_->samples(); }
+    Size depth() const override { return nettingSetCube_->depth(); }
+
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    const std::vector<Date>& dates() const override { return nettingSetCube_->dates(); }
+    Date asof() const override { return nettingSetCube_->asof(); }
+
+    Real getT0(Size id, Size depth = 0) const override;
+    void setT0(Real value, Size id, Size depth = 0) override;
+
+    //! Not available, the future values are only stored on netting set level
+    Real get(Size id, Size date, Size sample, Size depth = 0) const override;
+    void set(Real value, Size id, Size date, Size sample, Size depth = 0) override;
+
+    void remove(Size id) override;
+    void remove(Size id, Size sample) override;
+
+    //! The aggregated values, with the netting set ids of the trades as ids
+    const boost::shared_ptr<NPVCube>& nettingSetCube() const { return nettingSetCube_; }
+
+private:
+    void init(const Date& asof, const std::set<std::string>& ids,
+              const std::map<std::string, std::string>& nettingSetIds, const std::vector<Date>& dates, Size samples,
+              Size depth, const std::set<std::string>& subtractedIds);
+    void check(Size id, Size depth) const;
+
+    std::map<std::string, Size> idIdx_;
+    std::vector<Size> nettingSetIndex_;
+    // +1 for the ids added to the netting set values, -1 for the subtracted ids
+    std::vector<Real> sign_;
+    std::vector<Real> t0Data_;
+    boost::shared_ptr<NPVCube> nettingSetCube_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -108,6 +108,10 @@ public:
         set(value, index(id), index(date), sample, depth);
     }
 
+    /*! Get the values of all samples for a given id, date and depth, out is resized to samples(). The default
+        implementation calls get() for each sample, cubes storing the samples contiguously override this. */
+    virtual void getSamples(Size id, Size date, Size depth, std::vector<Real>& out) const;
+
     /*! remove all values for a given id, i.e. change the state as if setT0() and set() has never been called for the id
         the default implementation has generelly to be overriden in derived classes depending on how values are stored */
     virtual void remove(Size id);
@@ -117,6 +121,11 @@ public:
 
     Size getTradeIndex(const std::string& id) const { return index(id); }
 
+    /*! An estimate of the memory held by the cube in bytes, see ore::data::MemoryAccounting. The default
+        implementation returns 0, i.e. it is meant for cubes that do not hold their values themselves, like views
+        on other cubes or memory mapped cubes. */
+    virtual std::size_t memoryFootprint() const { return 0; }
+
 protected:
     virtual Size index(const std::string& id) const {
         const auto& it = idsAndIndexes().find(id);
@@ -134,6 +143,12 @@ protected:
 
 // impl
 
+inline void NPVCube::getSamples(Size id, Size date, Size depth, std::vector<Real>& out) const {
+    out.resize(this->samples());
+    for (Size sample = 0; sample < out.size(); ++sample)
+        out[sample] = get(id, date, sample, depth);
+}
+
 inline void NPVCube::remove(Size id) {
     for (Size date = 0; date < this->numDates(); ++date) {
         for (Size depth = 0; depth < this->depth(); ++depth) {
@@ -28,6 +28,7 @@
 #include <ql/time/date.hpp>
 #include <ql/types.hpp>
 #include <set>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -77,6 +78,15 @@ public:
         return getTradeNPVs(index(tradeId));
     }
 
+    /*! Return the indices of the risk factor shifts for the trade at index \p tradeIdx with an NPV different from the
+        base NPV, in increasing order, i.e. the keys of getTradeNPVs() */
+    virtual std::vector<QuantLib::Size> getTradeScenarios(Size tradeIdx) const {
+        std::vector<QuantLib::Size> result;
+        for (auto const& [k, _] : getTradeNPVs(tradeIdx))
+            result.push_back(k);
+        return result;
+    }
+
     /*! Return the set of scenario indices with non-zero result */
     virtual std::set<QuantLib::Size> relevantScenarios() const = 0;
 };
@@ -0,0 +1,152 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/quantisedcube.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+const std::int8_t noScale = std::numeric_limits<std::int8_t>::min();
+const long maxQuantised = std::numeric_limits<std::int16_t>::max();
+
+// smallest exponent e such that the value rounded to a multiple of 2^e fits into an int16
+int requiredExponent(Real value) {
+    int x;
+    std::frexp(value, &x);
+    int e = x - 15;
+    if (std::lround(std::ldexp(std::abs(value), -e)) > maxQuantised)
+        ++e;
+    QL_REQUIRE(e <= std::numeric_limits<std::int8_t>::max(),
+               "QuantisedInMemoryCube: value " << value << " is too large to be stored");
+    return std::max(e, noScale + 1);
+}
+
+std::int16_t quantise(Real value, int e) { return static_cast<std::int16_t>(std::lround(std::ldexp(value, -e))); }
+} // namespace
+
+QuantisedInMemoryCube::QuantisedInMemoryCube(const Date& asof, const std::set<std::string>& ids,
+                                             const vector<Date>& dates, Size samples, Size depth)
+    : asof_(asof), dates_(dates), samples_(samples), depth_(depth), t0Data_(ids.size() * depth, 0.0),
+      data_(ids.size() * dates.size() * samples * depth, 0), exponents_(ids.size() * dates.size() * depth, noScale) {
+    QL_REQUIRE(ids.size() > 0, "QuantisedInMemoryCube: no ids specified");
+    QL_REQUIRE(dates.size() > 0, "QuantisedInMemoryCube: no dates specified");
+    QL_REQUIRE(samples > 0, "QuantisedInMemoryCube: samples must be > 0");
+    QL_REQUIRE(depth > 0, "QuantisedInMemoryCube: depth must be > 0");
+    Size pos = 0;
+    for (const auto& id : ids)
+        idIdx_[id] = pos++;
+}
+
+void QuantisedInMemoryCube::check(Size i, Size j, Size k, Size d) const {
+    QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+    QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+    QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+    QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+}
+
+Real QuantisedInMemoryCube::getT0(Size i, Size d) const {
+    check(i, 0, 0, d);
+    return t0Data_[i * depth_ + d];
+}
+
+void QuantisedInMemoryCube::setT0(Real value, Size i, Size d) {
+    check(i, 0, 0, d);
+    t0Data_[i * depth_ + d] = value;
+}
+
+Real QuantisedInMemoryCube::get(Size i, Size j, Size k, Size d) const {
+    check(i, j, k, d);
+    Size s = slice(i, j, d);
+    return exponents_[s] == noScale ? 0.0 : std::ldexp(static_cast<Real>(data_[s * samples_ + k]), exponents_[s]);
+}
+
+void QuantisedInMemoryCube::set(Real value, Size i, Size j, Size k, Size d) {
+    check(i, j, k, d);
+    QL_REQUIRE(std::isfinite(value), "QuantisedInMemoryCube: can not store " << value);
+    Size s = slice(i, j, d);
+    std::int16_t* q = data_.data() + s * samples_;
+    if (value == 0.0) {
+        q[k] = 0;
+        return;
+    }
+    int e = requiredExponent(value);
+    if (exponents_[s] == noScale) {
+        exponents_[s] = static_cast<std::int8_t>(e);
+    } else if (e > exponents_[s]) {
+        // rescale the values set before, each rescaling adds at most half of the new scale to their error
+        for (Size l = 0; l < samples_; ++l)
+            q[l] = quantise(q[l], e - exponents_[s]);
+        exponents_[s] = static_cast<std::int8_t>(e);
+    }
+    q[k] = quantise(value, exponents_[s]);
+}
+
+void QuantisedInMemoryCube::getSamples(Size i, Size j, Size d, std::vector<Real>& out) const {
+    check(i, j, 0, d);
+    Size s = slice(i, j, d);
+    out.resize(samples_);
+    if (exponents_[s] == noScale) {
+        std::fill(out.begin(), out.end(), 0.0);
+        return;
+    }
+    const std::int16_t* q = data_.data() + s * samples_;
+    for (Size k = 0; k < samples_; ++k)
+        out[k] = std::ldexp(static_cast<Real>(q[k]), exponents_[s]);
+}
+
+void QuantisedInMemoryCube::remove(Size i) {
+    check(i, 0, 0, 0);
+    std::fill(t0Data_.begin() + i * depth_, t0Data_.begin() + (i + 1) * depth_, 0.0);
+    Size n = dates_.size() * depth_;
+    std::fill(exponents_.begin() + slice(i, 0, 0), exponents_.begin() + slice(i, 0, 0) + n, noScale);
+    std::fill(data_.begin() + slice(i, 0, 0) * samples_, data_.begin() + (slice(i, 0, 0) + n) * samples_, 0);
+}
+
+void QuantisedInMemoryCube::remove(Size i, Size k) {
+    check(i, 0, k, 0);
+    for (Size s = slice(i, 0, 0); s < slice(i, 0, 0) + dates_.size() * depth_; ++s)
+        data_[s * samples_ + k] = 0;
+}
+
+Real QuantisedInMemoryCube::errorBound(Size i, Size j, Size d) const {
+    check(i, j, 0, d);
+    Size s = slice(i, j, d);
+    return exponents_[s] == noScale ? 0.0 : std::ldexp(1.0, exponents_[s]);
+}
+
+Real QuantisedInMemoryCube::errorBound() const {
+    std::int8_t e = noScale;
+    for (auto const x : exponents_)
+        e = std::max(e, x);
+    return e == noScale ? 0.0 : std::ldexp(1.0, e);
+}
+
+Real QuantisedInMemoryCube::relativeErrorBound() {
+    // the value fixing the exponent is at least 2^(e+14), or at least 32767.5 * 2^(e-1) if it was incremented
+    return 1.0 / 16383.75;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/quantisedcube.hpp
+    \brief A lossy in memory cube storing 16 bit integers with a scale per slice
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+//! In memory cube storing the values as 16 bit integers with a power of two scale per (id, date, depth) slice
+/*! A value v of the slice (i, j, d) is stored as the integer q with v = q * 2^e, where the exponent e is shared by
+    the samples of the slice. The exponent is chosen from the first non-zero value set in the slice and increased when
+    a larger value is set later, the values set before are rescaled then. This uses a quarter of the memory of a
+    DoublePrecisionInMemoryCubeN and half of the memory of a SinglePrecisionInMemoryCubeN.
+
+    The absolute error of each value of a slice is bounded by 2^e, see errorBound(). Since the largest absolute value
+    of the slice is at least 16383.75 * 2^e, the error relative to that value is bounded by relativeErrorBound(),
+    about 6.1E-5. No scale is stored for slices holding only zeros, zeros are represented exactly.
+
+    The T0 values are stored in double precision.
+
+    \ingroup cube
+ */
+class QuantisedInMemoryCube : public NPVCube {
+public:
+    QuantisedInMemoryCube(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
+                          Size depth = 1);
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+
+    //! Return a map of all ids and their position in the cube
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! Get / set a T0 value
+    Real getT0(Size i, Size d) const override;
+    void setT0(Real value, Size i, Size d) override;
+
+    //! Get / set a value, the value set is quantised
+    Real get(Size i, Size j, Size k, Size d) const override;
+    void set(Real value, Size i, Size j, Size k, Size d) override;
+
+    //! Get the values of all samples for a given id, date and depth
+    void getSamples(Size i, Size j, Size d, std::vector<Real>& out) const override;
+
+    //! Remove all values for a given id
+    void remove(Size i) override;
+    //! Remove all values for a given id and sample, keep the T0 values
+    void remove(Size i, Size k) override;
+
+    //! Bound for the absolute error of the values of the slice (i, j, d), zero if the slice holds zeros only
+    Real errorBound(Size i, Size j, Size d) const;
+    //! Bound for the absolute error of all values in the cube
+    Real errorBound() const;
+    //! Bound for the error of a value relative to the largest absolute value of its slice
+    static Real relativeErrorBound();
+
+private:
+    void check(Size i, Size j, Size k, Size d) const;
+    Size slice(Size i, Size j, Size d) const { return (i * dates_.size() + j) * depth_ + d; }
+
+    QuantLib::Date asof_;
+    vector<QuantLib::Date> dates_;
+    Size samples_, depth_;
+    std::map<std::string, Size> idIdx_;
+    vector<double> t0Data_;
+    // the samples of a slice are contiguous
+    vector<std::int16_t> data_;
+    // exponent per slice, noScale for slices holding zeros only
+    vector<std::int8_t> exponents_;
+};
+
+} // namespace analytics
+} // namespace ore
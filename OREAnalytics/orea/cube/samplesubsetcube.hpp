@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/samplesubsetcube.hpp
+    \brief A view on the first samples of a cube
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <ql/errors.hpp>
+
+namespace ore {
+namespace analytics {
+
+//! SampleSubsetCube exposes the first samples of an underlying cube
+/*! This is used when a simulation stops before all samples of the cube are generated, see
+    ValuationEngine::setConvergenceMonitor(), so that the post processing only sees the generated samples. The values
+    are not copied, the view reads and writes through to the underlying cube.
+
+    \ingroup cube
+ */
+class SampleSubsetCube : public NPVCube {
+public:
+    SampleSubsetCube(const boost::shared_ptr<NPVCube>& cube, const Size samples) : cube_(cube), samples_(samples) {
+        QL_REQUIRE(cube_, "SampleSubsetCube: cube is null");
+        QL_REQUIRE(samples_ > 0 && samples_ <= cube_->samples(), "SampleSubsetCube: samples ("
+                                                                     << samples_ << ") must be positive and not exceed "
+                                                                     << "the samples of the cube (" << cube_->samples()
+                                                                     << ")");
+    }
+
+    //! The underlying cube
+    const boost::shared_ptr<NPVCube>& cube() const { return cube_; }
+
+    Size numIds() const override { return cube_->numIds(); }
+    Size numDates() const override { return cube_->numDates(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return cube_->depth(); }
+
+    const std::map<std::string, Size>& idsAndIndexes() const override { return cube_->idsAndIndexes(); }
+    const std::vector<QuantLib::Date>& dates() const override { return cube_->dates(); }
+    QuantLib::Date asof() const override { return cube_->asof(); }
+
+    Real getT0(Size id, Size depth = 0) const override { return cube_->getT0(id, depth); }
+    void setT0(Real value, Size id, Size depth = 0) override { cube_->setT0(value, id, depth); }
+
+    Real get(Size id, Size date, Size sample, Size depth = 0) const override {
+        check(sample);
+        return cube_->get(id, date, sample, depth);
+    }
+    void set(Real value, Size id, Size date, Size sample, Size depth = 0) override {
+        check(sample);
+        cube_->set(value, id, date, sample, depth);
+    }
+
+    void getSamples(Size id, Size date, Size depth, std::vector<Real>& out) const override {
+        cube_->getSamples(id, date, depth, out);
+        out.resize(samples_);
+    }
+
+    void remove(Size id) override { cube_->remove(id); }
+    void remove(Size id, Size sample) override {
+        check(sample);
+        cube_->remove(id, sample);
+    }
+
+private:
+    void check(Size sample) const {
+        QL_REQUIRE(sample < samples_, "Out of bounds on samples (k=" << sample << ", samples=" << samples_ << ")");
+    }
+
+    boost::shared_ptr<NPVCube> cube_;
+    Size samples_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -33,6 +33,7 @@
 #include <boost/make_shared.hpp>
 #include <boost/math/special_functions/relative_difference.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -42,11 +43,13 @@ namespace ore {
 namespace analytics {
 
 //! SensiCube stores only npvs not equal to the base npvs
+/*! The npvs of a trade are held in a contiguous vector of (scenario index, npv) pairs sorted by the scenario index.
+    Since the valuation engine fills the scenarios in increasing order, setting a value is an append in general. */
 template <typename T> class SensiCube : public NPVSensiCube {
 public:
     SensiCube(const std::set<std::string>& ids, const QuantLib::Date& asof, QuantLib::Size samples, const T& t = T())
         : asof_(asof), dates_(1, asof), samples_(samples), t0Data_(ids.size(), t),
-          tradeNPVs_(ids.size(), map<Size, T>()) {
+          tradeNPVs_(ids.size()) {
         Size pos = 0;
         for (const auto& id : ids) {
             idIdx_[id] = pos++; 
@@ -82,8 +85,8 @@ public:
     Real get(Size i, Size j, Size k, Size) const override {
         this->check(i, j, k);
 
-        auto itr = this->tradeNPVs_[i].find(k);
-        if (itr != tradeNPVs_[i].end()) {
+        auto itr = find(i, k);
+        if (itr != tradeNPVs_[i].end() && itr->first == k) {
             return itr->second;
         } else {
             return this->t0Data_[i];
@@ -95,7 +98,16 @@ public:
         this->check(i, j, k);
         T castValue = static_cast<T>(value);
         if (boost::math::epsilon_difference<T>(castValue, t0Data_[i]) > 42) {
-            this->tradeNPVs_[i][k] = castValue;
+            auto& npvs = this->tradeNPVs_[i];
+            if (npvs.empty() || npvs.back().first < k) {
+                npvs.push_back(std::make_pair(k, castValue));
+            } else {
+                auto itr = find(i, k);
+                if (itr->first == k)
+                    itr->second = castValue;
+                else
+                    npvs.insert(itr, std::make_pair(k, castValue));
+            }
             relevantScenarios_.insert(k);
         }
     }
@@ -108,10 +120,25 @@ public:
 
     void remove(Size i, Size k) override {
         this->check(i,0,k);
-        this->tradeNPVs_[i].erase(k);
+        auto itr = find(i, k);
+        if (itr != tradeNPVs_[i].end() && itr->first == k)
+            this->tradeNPVs_[i].erase(itr);
     }
 
-    std::map<QuantLib::Size, QuantLib::Real> getTradeNPVs(QuantLib::Size i) const override { return tradeNPVs_[i]; }
+    std::map<QuantLib::Size, QuantLib::Real> getTradeNPVs(QuantLib::Size i) const override {
+        std::map<QuantLib::Size, QuantLib::Real> result;
+        for (auto const& [k, v] : tradeNPVs_[i])
+            result.emplace_hint(result.end(), k, v);
+        return result;
+    }
+
+    //! The scenario indices with npvs different from the base npv for trade \p i, in increasing order
+    std::vector<QuantLib::Size> getTradeScenarios(QuantLib::Size i) const override {
+        std::vector<QuantLib::Size> result(tradeNPVs_[i].size());
+        for (Size n = 0; n < result.size(); ++n)
+            result[n] = tradeNPVs_[i][n].first;
+        return result;
+    }
 
     std::set<QuantLib::Size> relevantScenarios() const override { return relevantScenarios_; }
 
@@ -123,7 +150,7 @@ private:
 
 protected:
     std::vector<T> t0Data_;
-    std::vector<std::map<QuantLib::Size, T>> tradeNPVs_;
+    std::vector<std::vector<std::pair<QuantLib::Size, T>>> tradeNPVs_;
     std::set<QuantLib::Size> relevantScenarios_;
 
     void check(QuantLib::Size i, QuantLib::Size j, QuantLib::Size k) const {
@@ -131,6 +158,16 @@ protected:
         QL_REQUIRE(j < depth(), "Out of bounds on depth (j=" << j << ")");
         QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ")");
     }
+
+    // first entry of trade i with scenario index not less than k
+    static bool lessIndex(const std::pair<QuantLib::Size, T>& p, QuantLib::Size k) { return p.first < k; }
+    typename std::vector<std::pair<QuantLib::Size, T>>::iterator find(QuantLib::Size i, QuantLib::Size k) {
+        return std::lower_bound(tradeNPVs_[i].begin(), tradeNPVs_[i].end(), k, lessIndex);
+    }
+    typename std::vector<std::pair<QuantLib::Size, T>>::const_iterator find(QuantLib::Size i,
+                                                                            QuantLib::Size k) const {
+        return std::lower_bound(tradeNPVs_[i].begin(), tradeNPVs_[i].end(), k, lessIndex);
+    }
 };
 
 //! Sensi cube with single precision floating point numbers.
@@ -104,14 +104,12 @@ void SensitivityCube::initialise() {
                                                               << des.key1() << "]");
             factors_.insert(des.key1());
             upFactors_[des.key1()] = fd;
-            upIndexToKey_[fd.index] = des.key1();
             break;
         case ShiftScenarioDescription::Type::Down:
             QL_REQUIRE(downFactors_.count(des.key1()) == 0, "Cannot have multiple down factors with "
                                                             "the same risk factor key ["
                                                                 << des.key1() << "]");
             downFactors_[des.key1()] = fd;
-            downIndexToKey_[fd.index] = des.key1();
             break;
         case ShiftScenarioDescription::Type::Cross:
             factorPair = make_pair(des.key1(), des.key2());
@@ -119,7 +117,6 @@ void SensitivityCube::initialise() {
                                                             "the same risk factor key pair ["
                                                                 << des.key1() << ", " << des.key2() << "]");
             crossFactors[factorPair] = i;
-            crossIndexToKey_[i] = factorPair;
             break;
         default:
             // Do nothing
@@ -134,6 +131,32 @@ void SensitivityCube::initialise() {
         crossFactors_[cf.first] = make_tuple(id_1, id_2, cf.second);
     }
 
+    // Build the flat side tables
+    std::map<RiskFactorKey, Size> factorPos;
+    scenarioFactorPos_.resize(scenarioDescriptions_.size(), Null<Size>());
+    factorTable_.reserve(upFactors_.size());
+    for (auto const& [key, fd] : upFactors_) {
+        FlatFactor f;
+        f.key = key;
+        f.up = fd;
+        auto down = downFactors_.find(key);
+        f.downIndex = down == downFactors_.end() ? Null<Size>() : down->second.index;
+        f.twoSidedDelta = twoSidedDelta(key.keytype);
+        factorPos[key] = scenarioFactorPos_[fd.index] = factorTable_.size();
+        if (f.downIndex != Null<Size>())
+            scenarioFactorPos_[f.downIndex] = factorTable_.size();
+        factorTable_.push_back(f);
+    }
+    crossFactorTable_.reserve(crossFactors_.size());
+    for (auto const& [keys, data] : crossFactors_) {
+        FlatCrossFactor f;
+        f.keys = keys;
+        std::tie(f.first, f.second, f.index) = data;
+        f.firstPos = factorPos.at(keys.first);
+        f.secondPos = factorPos.at(keys.second);
+        crossFactorTable_.push_back(f);
+    }
+
     // Log warnings if each factor does not have a shift size entry and that it is not a Null<Real>()
     if (upFactors_.size() != shiftSizes_.size()) {
         WLOG("The number of 'Up' shifts (" << upFactors_.size() << ") does not equal "
@@ -154,24 +177,27 @@ void SensitivityCube::initialise() {
 bool SensitivityCube::hasTrade(const string& tradeId) const { return tradeIdx_.count(tradeId) > 0; }
 
 RiskFactorKey SensitivityCube::upFactor(const Size upIndex) const {
-    if (auto k = upIndexToKey_.find(upIndex); k != upIndexToKey_.end()) {
-        return k->second;
+    if (upIndex < scenarioDescriptions_.size() &&
+        scenarioDescriptions_[upIndex].type() == ShiftScenarioDescription::Type::Up) {
+        return scenarioDescriptions_[upIndex].key1();
     } else {
         return RiskFactorKey();
     }
 }
 
 RiskFactorKey SensitivityCube::downFactor(const Size downIndex) const {
-    if (auto k = downIndexToKey_.find(downIndex); k != downIndexToKey_.end()) {
-        return k->second;
+    if (downIndex < scenarioDescriptions_.size() &&
+        scenarioDescriptions_[downIndex].type() == ShiftScenarioDescription::Type::Down) {
+        return scenarioDescriptions_[downIndex].key1();
     } else {
         return RiskFactorKey();
     }
 }
 
 SensitivityCube::crossPair SensitivityCube::crossFactor(const Size crossIndex) const {
-    if (auto k = crossIndexToKey_.find(crossIndex); k != crossIndexToKey_.end()) {
-        return k->second;
+    if (crossIndex < scenarioDescriptions_.size() &&
+        scenarioDescriptions_[crossIndex].type() == ShiftScenarioDescription::Type::Cross) {
+        return std::make_pair(scenarioDescriptions_[crossIndex].key1(), scenarioDescriptions_[crossIndex].key2());
     } else {
         return std::make_pair(RiskFactorKey(), RiskFactorKey());
     }
@@ -30,6 +30,7 @@
 #include <ql/errors.hpp>
 #include <ql/time/date.hpp>
 #include <ql/types.hpp>
+#include <ql/utilities/null.hpp>
 #include <vector>
 
 namespace ore {
@@ -52,6 +53,25 @@ public:
         bool operator<(const FactorData& fd) const { return index < fd.index; }
     };
 
+    //! Entry of the flat factor table, see factorTable()
+    struct FlatFactor {
+        RiskFactorKey key;
+        FactorData up;
+        //! index of the down scenario, Null<Size>() if there is none
+        QuantLib::Size downIndex;
+        bool twoSidedDelta;
+    };
+
+    //! Entry of the flat cross factor table, see crossFactorTable()
+    struct FlatCrossFactor {
+        crossPair keys;
+        FactorData first, second;
+        //! index of the cross scenario
+        QuantLib::Size index;
+        //! positions of the two factors in the factorTable()
+        QuantLib::Size firstPos, secondPos;
+    };
+
     //! Constructor using a vector of scenario descriptions
     SensitivityCube(const boost::shared_ptr<NPVSensiCube>& cube,
                     const std::vector<ShiftScenarioDescription>& scenarioDescriptions,
@@ -105,6 +125,19 @@ public:
     const std::map<crossPair, std::tuple<SensitivityCube::FactorData, SensitivityCube::FactorData, QuantLib::Size>>&
     crossFactors() const;
 
+    /*! Return the up factors in the order of upFactors() as a flat table, this allows to iterate over the factors and
+        to address them by their position without map lookups */
+    const std::vector<FlatFactor>& factorTable() const { return factorTable_; }
+
+    //! Return the cross factors in the order of crossFactors() as a flat table
+    const std::vector<FlatCrossFactor>& crossFactorTable() const { return crossFactorTable_; }
+
+    /*! Return the position in factorTable() of the factor shifted in the up or down scenario with index \p scenarioIdx,
+        or Null<Size>() if the scenario is not an up or down scenario of a factor in the table */
+    QuantLib::Size factorPosition(const QuantLib::Size scenarioIdx) const {
+        return scenarioIdx < scenarioFactorPos_.size() ? scenarioFactorPos_[scenarioIdx] : QuantLib::Null<Size>();
+    }
+
     //! Returns the absolute shift size for given risk factor \p key
     QuantLib::Real shiftSize(const RiskFactorKey& riskFactorKey) const;
 
@@ -174,11 +207,10 @@ private:
     // Set of risk factor key types where we want a two-sided delta calculation.
     std::set<RiskFactorKey::KeyType> twoSidedDeltas_;
 
-    // map of up / down / cross factor index to risk factor key
-    std::map<QuantLib::Size, RiskFactorKey> upIndexToKey_;
-    std::map<QuantLib::Size, RiskFactorKey> downIndexToKey_;
-    std::map<QuantLib::Size, crossPair> crossIndexToKey_;
-
+    // side tables indexed by factor position resp. scenario index
+    std::vector<FlatFactor> factorTable_;
+    std::vector<FlatCrossFactor> crossFactorTable_;
+    std::vector<QuantLib::Size> scenarioFactorPos_;
 };
 
 std::ostream& operator<<(std::ostream& out, const SensitivityCube::crossPair& cp);
@@ -18,6 +18,7 @@
 
 #include <orea/cube/sparsenpvcube.hpp>
 
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/serializationdate.hpp>
 
 #include <ql/errors.hpp>
@@ -104,6 +105,14 @@ template <typename T> void SparseNpvCube<T>::set(Real value, Size i, Size j, Siz
     }
 }
 
+template <typename T> std::size_t SparseNpvCube<T>::memoryFootprint() const {
+    std::size_t bytes = ore::data::memoryFootprint(data_) + ore::data::memoryFootprint(ids_) +
+                        ore::data::memoryFootprint(dates_);
+    for (auto const& v : data_)
+        bytes += ore::data::memoryFootprint(v.second);
+    return bytes;
+}
+
 template <typename T> void SparseNpvCube<T>::check(Size i, Size j, Size k, Size d) const {
     QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
     QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
@@ -127,6 +136,7 @@ template Real SparseNpvCube<Real>::getT0(Size i, Size d) const;
 template void SparseNpvCube<Real>::setT0(Real value, Size i, Size d);
 template Real SparseNpvCube<Real>::get(Size i, Size j, Size k, Size d) const;
 template void SparseNpvCube<Real>::set(Real value, Size i, Size j, Size k, Size d);
+template std::size_t SparseNpvCube<Real>::memoryFootprint() const;
 template void SparseNpvCube<Real>::check(Size i, Size j, Size k, Size d) const;
 
 template SparseNpvCube<float>::SparseNpvCube();
@@ -144,6 +154,7 @@ template Real SparseNpvCube<float>::getT0(Size i, Size d) const;
 template void SparseNpvCube<float>::setT0(Real value, Size i, Size d);
 template Real SparseNpvCube<float>::get(Size i, Size j, Size k, Size d) const;
 template void SparseNpvCube<float>::set(Real value, Size i, Size j, Size k, Size d);
+template std::size_t SparseNpvCube<float>::memoryFootprint() const;
 template void SparseNpvCube<float>::check(Size i, Size j, Size k, Size d) const;
 
 } // namespace analytics
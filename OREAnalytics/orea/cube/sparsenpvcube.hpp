@@ -49,6 +49,7 @@ public:
     void setT0(Real value, Size i, Size d) override;
     Real get(Size i, Size j, Size k, Size d) const override;
     void set(Real value, Size i, Size j, Size k, Size d) override;
+    std::size_t memoryFootprint() const override;
 
 private:
     void check(Size i, Size j, Size k, Size d) const;
@@ -0,0 +1,200 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/truncatedcube.hpp
+    \brief A cube implementation that stores each trade up to its maturity only
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+//! TruncatedCube stores the values of each id for its first dates only, the values of later dates are zero
+/*! The number of stored dates is given per id, the values of all ids are stored in a single contiguous vector with
+    the samples and depth of one (id, date) pair contiguous, the depth varying fastest. Getting a value of a later date
+    returns zero, setting a non-zero value there is an error.
+
+    The portfolio constructor stores each trade for the dates on or before its maturity, the valuation engine does not
+    price trades on later dates if ValuationEngine::setSkipMaturedTrades() is set. For a typical book of short dated
+    trades this avoids storing a large part of the cube.
+
+    \ingroup cube
+ */
+template <typename T> class TruncatedCube : public NPVCube {
+public:
+    //! ctor, dateLengths gives the number of stored dates per id, in the order of the ids
+    TruncatedCube(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
+                  Size depth, const vector<Size>& dateLengths)
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth), dateLengths_(dateLengths) {
+        init(ids);
+    }
+
+    //! ctor, stores each trade of the portfolio for the dates on or before its maturity
+    TruncatedCube(const Date& asof, const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                  const vector<Date>& dates, Size samples, Size depth)
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth) {
+        for (const auto& [tid, t] : portfolio->trades()) {
+            Date maturity = t->maturity();
+            dateLengths_.push_back(maturity == Date()
+                                       ? dates.size()
+                                       : std::upper_bound(dates.begin(), dates.end(), maturity) - dates.begin());
+        }
+        init(portfolio->ids());
+    }
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+
+    //! Return a map of all ids and their position in the cube
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! The number of stored dates for id i
+    Size dateLength(Size i) const {
+        check(i, 0, 0, 0);
+        return dateLengths_[i];
+    }
+
+    //! Get a T0 value from the cube
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return t0Data_[i * depth_ + d];
+    }
+
+    //! Set a value in the cube
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+
+    //! Get a value from the cube
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return j < dateLengths_[i] ? static_cast<Real>(data_[offset(i, j, k, d)]) : 0.0;
+    }
+
+    //! Set a value in the cube
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        if (j < dateLengths_[i])
+            data_[offset(i, j, k, d)] = static_cast<T>(value);
+        else
+            QL_REQUIRE(value == 0.0, "TruncatedCube: Cannot set nonzero value "
+                                         << value << " for id " << i << ", date " << j << ", sample " << k
+                                         << ", depth " << d << ", only " << dateLengths_[i] << " dates are stored");
+    }
+
+    //! Get the values of all samples for a given id, date and depth
+    void getSamples(Size i, Size j, Size d, std::vector<Real>& out) const override {
+        check(i, j, 0, d);
+        out.resize(samples_);
+        if (j >= dateLengths_[i]) {
+            std::fill(out.begin(), out.end(), 0.0);
+            return;
+        }
+        const T* p = data_.data() + offset(i, j, 0, d);
+        for (Size k = 0; k < samples_; ++k)
+            out[k] = p[k * depth_];
+    }
+
+    //! Remove all values for a given id
+    void remove(Size i) override {
+        check(i, 0, 0, 0);
+        std::fill(t0Data_.begin() + i * depth_, t0Data_.begin() + (i + 1) * depth_, T());
+        std::fill(data_.begin() + offsets_[i], data_.begin() + offsets_[i + 1], T());
+    }
+
+    //! Remove all values for a given id and sample, keep the T0 values
+    void remove(Size i, Size k) override {
+        check(i, 0, k, 0);
+        for (Size j = 0; j < dateLengths_[i]; ++j)
+            std::fill(data_.begin() + offset(i, j, k, 0), data_.begin() + offset(i, j, k, 0) + depth_, T());
+    }
+
+private:
+    void init(const std::set<std::string>& ids) {
+        QL_REQUIRE(ids.size() > 0, "TruncatedCube: no ids specified");
+        QL_REQUIRE(dates_.size() > 0, "TruncatedCube: no dates specified");
+        QL_REQUIRE(samples_ > 0, "TruncatedCube: samples must be > 0");
+        QL_REQUIRE(depth_ > 0, "TruncatedCube: depth must be > 0");
+        QL_REQUIRE(dateLengths_.size() == ids.size(), "TruncatedCube: number of date lengths ("
+                                                          << dateLengths_.size() << ") does not match number of ids ("
+                                                          << ids.size() << ")");
+        Size pos = 0;
+        for (const auto& id : ids)
+            idIdx_[id] = pos++;
+        offsets_.resize(ids.size() + 1, 0);
+        for (Size i = 0; i < ids.size(); ++i) {
+            QL_REQUIRE(dateLengths_[i] <= dates_.size(), "TruncatedCube: date length "
+                                                             << dateLengths_[i] << " for id " << i
+                                                             << " exceeds number of dates " << dates_.size());
+            offsets_[i + 1] = offsets_[i] + dateLengths_[i] * samples_ * depth_;
+        }
+        t0Data_.resize(ids.size() * depth_, T());
+        data_.resize(offsets_.back(), T());
+    }
+
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    Size offset(Size i, Size j, Size k, Size d) const { return offsets_[i] + (j * samples_ + k) * depth_ + d; }
+
+    QuantLib::Date asof_;
+    vector<QuantLib::Date> dates_;
+    Size samples_, depth_;
+    vector<Size> dateLengths_;
+    std::map<std::string, Size> idIdx_;
+    // start of the values of each id in data_, the last entry is the size of data_
+    vector<Size> offsets_;
+    vector<T> t0Data_;
+    vector<T> data_;
+};
+
+//! TruncatedCube with single precision floating point numbers.
+using SinglePrecisionTruncatedCube = TruncatedCube<float>;
+
+//! TruncatedCube with double precision floating point numbers.
+using DoublePrecisionTruncatedCube = TruncatedCube<double>;
+
+} // namespace analytics
+} // namespace ore
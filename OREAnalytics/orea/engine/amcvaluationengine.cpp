@@ -33,6 +33,7 @@
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/methods/multipathvariategenerator.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
+#include <qle/pricingengines/mcmultilegpathcache.hpp>
 
 #include <ql/instruments/compositeinstrument.hpp>
 
@@ -141,7 +142,8 @@ void runCoreEngine(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
                    const boost::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
                    const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
                    boost::shared_ptr<ore::analytics::AggregationScenarioData> asd,
-                   boost::shared_ptr<NPVCube> outputCube, boost::shared_ptr<ProgressIndicator> progressIndicator) {
+                   boost::shared_ptr<NPVCube> outputCube, boost::shared_ptr<ProgressIndicator> progressIndicator,
+                   const Size pathBundles) {
 
     progressIndicator->updateProgress(0, portfolio->size() + 1);
 
@@ -236,6 +238,11 @@ void runCoreEngine(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
             }
         }
     };
+    // trades with the same simulation times and path generator settings share their paths and regressor matrices
+    if (pathBundles > 0) {
+        LOG("Sharing paths between AMC trades, keeping up to " << pathBundles << " path bundles");
+        McMultiLegPathCache::instance().enable(pathBundles);
+    }
     for (auto const& trade : portfolio->trades()) {
         boost::shared_ptr<AmcCalculator> amcCalc;
         try {
@@ -270,6 +277,10 @@ void runCoreEngine(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
         }
         progressIndicator->updateProgress(++progressCounter, portfolio->size() + 1);
     }
+    if (pathBundles > 0) {
+        DLOG("Used " << McMultiLegPathCache::instance().size() << " path bundles");
+        McMultiLegPathCache::instance().disable();
+    }
     timer.stop();
     calibrationTime += timer.elapsed().wall * 1e-9;
     LOG("Extracted " << amcCalculators.size() << " AMCCalculators for " << portfolio->size() << " source trades");
@@ -588,7 +599,8 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<Portfolio>& portfolio
         // we can use the mt progress indicator here although we are running on a single thread
         runCoreEngine(portfolio, model_, market_, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_, asd_,
                       outputCube,
-                      boost::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators()));
+                      boost::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators()),
+                      pathBundles_);
     } catch (const std::exception& e) {
         QL_FAIL("Error during amc val engine run: " << e.what());
     }
@@ -642,12 +654,12 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<ore::data::Portfolio>
         LOG("Portfolio #" << i << " number of trades       : " << portfolios[i]->size());
     }
 
-    // build loaders for each thread as clones of the original one
+    // build loaders for each thread as clones of the original one, the market data are cloned on their first request
 
     LOG("Cloning loaders for " << eff_nThreads << " threads...");
-    std::vector<boost::shared_ptr<ore::data::ClonedLoader>> loaders;
+    std::vector<boost::shared_ptr<ore::data::LazyClonedLoader>> loaders;
     for (Size i = 0; i < eff_nThreads; ++i)
-        loaders.push_back(boost::make_shared<ore::data::ClonedLoader>(today_, loader_));
+        loaders.push_back(boost::make_shared<ore::data::LazyClonedLoader>(today_, loader_));
 
     // build nThreads mini-cubes to which each thread writes its results
 
@@ -670,12 +682,7 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<ore::data::Portfolio>
     auto progressIndicator =
         boost::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators());
 
-    // create the thread pool with eff_nThreads and queue size = eff_nThreads as well
-
-    // LOG("Create thread pool with " << eff_nThreads);
-    // ctpl::thread_pool threadPool(eff_nThreads);
-
-    // create the jobs and push them to the pool
+    // create the jobs, these are pushed to the shared thread pool if one is set or run on dedicated threads
 
     using resultType = int;
     std::vector<std::future<resultType>> results(eff_nThreads);
@@ -736,7 +743,7 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<ore::data::Portfolio>
                 // run core engine code (asd is written for thread id 0 only)
 
                 runCoreEngine(portfolio, cam, initMarket, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
-                              id == 0 ? asd_ : nullptr, miniCubes_[id], progressIndicator);
+                              id == 0 ? asd_ : nullptr, miniCubes_[id], progressIndicator, pathBundles_);
 
                 // return code 0 = ok
 
@@ -759,16 +766,16 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<ore::data::Portfolio>
             return rc;
         };
 
-        // results[i] = threadPool.push(job);
-
-        // not needed if thread pool is used
-        std::packaged_task<resultType(int)> task(job);
-        results[i] = task.get_future();
-        std::thread thread(std::move(task), i);
-        jobs.emplace_back(std::move(thread));
+        if (threadPool_) {
+            results[i] = threadPool_->push([job, i]() { return job(static_cast<int>(i)); });
+        } else {
+            std::packaged_task<resultType(int)> task(job);
+            results[i] = task.get_future();
+            std::thread thread(std::move(task), i);
+            jobs.emplace_back(std::move(thread));
+        }
     }
 
-    // not needed if thread pool is used
     for (auto& t : jobs)
         t.join();
 
@@ -783,10 +790,7 @@ void AMCValuationEngine::buildCube(const boost::shared_ptr<ore::data::Portfolio>
                                              << ". Check for structured errors from 'AMCValuationEngine'.");
     }
 
-    // stop the thread pool, wait for unfinished jobs
-
-    // LOG("Stop thread pool");
-    // threadPool.stop(true);
+    progressIndicator->publish();
 
     LOG("Finished multi-threaded AMCValuationEngine run.");
 }
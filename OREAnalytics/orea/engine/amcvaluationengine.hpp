@@ -24,6 +24,7 @@
 #pragma once
 
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/scenario/scenariogeneratordata.hpp>
 
 #include <ored/marketdata/loader.hpp>
@@ -74,6 +75,13 @@ public:
     //! build cube in multi threaded run
     void buildCube(const boost::shared_ptr<ore::data::Portfolio>& portfolio);
 
+    //! run the jobs of a multi threaded run on a thread pool shared with other engines instead of on dedicated threads
+    void setThreadPool(const boost::shared_ptr<ThreadPool>& threadPool) { threadPool_ = threadPool; }
+
+    /*! share the paths and regressor matrices between trades with the same simulation times, keeping up to the given
+        number of path bundles while the AMC calculators are extracted, zero (the default) disables the sharing */
+    void setPathBundles(const QuantLib::Size pathBundles) { pathBundles_ = pathBundles; }
+
     // result output cubes for multi threaded runs (mini-cubes, one per thread)
     std::vector<boost::shared_ptr<ore::analytics::NPVCube>> outputCubes() const { return miniCubes_; }
 
@@ -119,6 +127,8 @@ private:
     std::function<boost::shared_ptr<ore::analytics::NPVCube>(const QuantLib::Date&, const std::set<std::string>&,
                                                              const std::vector<QuantLib::Date>&, const QuantLib::Size)>
         cubeFactory_;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    QuantLib::Size pathBundles_ = 0;
 
     // result cubes for multi-threaded run
     std::vector<boost::shared_ptr<ore::analytics::NPVCube>> miniCubes_;
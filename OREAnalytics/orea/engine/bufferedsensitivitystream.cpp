@@ -35,6 +35,22 @@ SensitivityRecord BufferedSensitivityStream::next() {
     return {};
 }
 
+Size BufferedSensitivityStream::nextBatch(SensitivityRecord* records, Size n) {
+    if (index_ == QuantLib::Null<Size>()) {
+        Size m = stream_->nextBatch(records, n);
+        buffer_.insert(buffer_.end(), records, records + m);
+        // keep the end of stream marker, as next() does
+        if (m < n)
+            buffer_.push_back(SensitivityRecord());
+        return m;
+    }
+    Size i = 0;
+    // the buffer ends with the end of stream marker, which is not copied
+    for (; i < n && index_ < buffer_.size() && buffer_[index_]; ++i)
+        records[i] = buffer_[index_++];
+    return i;
+}
+
 void BufferedSensitivityStream::reset() {
     // if next() was never called, we do not switch to the buffered mode
     if (!buffer_.empty())
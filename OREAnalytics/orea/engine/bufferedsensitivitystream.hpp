@@ -31,6 +31,8 @@ class BufferedSensitivityStream : public SensitivityStream {
 public:
     explicit BufferedSensitivityStream(const boost::shared_ptr<SensitivityStream>& stream);
     SensitivityRecord next() override;
+    QuantLib::Size nextBatch(SensitivityRecord* records, QuantLib::Size n) override;
+    using SensitivityStream::nextBatch;
     void reset() override;
 
 private:
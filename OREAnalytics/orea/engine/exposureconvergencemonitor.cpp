@@ -0,0 +1,117 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/exposureconvergencemonitor.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace analytics {
+
+ExposureConvergenceMonitor::ExposureConvergenceMonitor(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                                                       const Real tolerance, const Size minSamples,
+                                                       const Size batches, const Size checkInterval)
+    : tolerance_(tolerance), minSamples_(minSamples), batches_(batches), checkInterval_(checkInterval) {
+    QL_REQUIRE(portfolio, "ExposureConvergenceMonitor: portfolio is null");
+    QL_REQUIRE(tolerance_ > 0.0, "ExposureConvergenceMonitor: tolerance (" << tolerance_ << ") must be positive");
+    QL_REQUIRE(batches_ > 1, "ExposureConvergenceMonitor: number of batches (" << batches_ << ") must be at least 2");
+    QL_REQUIRE(checkInterval_ > 0, "ExposureConvergenceMonitor: check interval must be positive");
+    minSamples_ = std::max(minSamples_, batches_);
+    for (auto const& [tradeId, trade] : portfolio->trades())
+        tradeNettingSet_[tradeId] = trade->envelope().nettingSetId();
+}
+
+void ExposureConvergenceMonitor::init(const boost::shared_ptr<NPVCube>& cube) {
+    std::map<std::string, Size> nettingSetIndex;
+    idNettingSet_.resize(cube->numIds());
+    for (auto const& [id, index] : cube->idsAndIndexes()) {
+        auto t = tradeNettingSet_.find(id);
+        const std::string& nettingSet = t == tradeNettingSet_.end() ? id : t->second;
+        auto n = nettingSetIndex.emplace(nettingSet, nettingSets_.size());
+        if (n.second)
+            nettingSets_.push_back(nettingSet);
+        idNettingSet_[index] = n.first->second;
+    }
+    values_.resize(nettingSets_.size());
+    exposure_.resize(nettingSets_.size());
+}
+
+void ExposureConvergenceMonitor::add(const boost::shared_ptr<NPVCube>& cube, const Size sample) {
+    if (nettingSets_.empty())
+        init(cube);
+    QL_REQUIRE(sample == samples_,
+               "ExposureConvergenceMonitor: expected sample " << samples_ << ", got " << sample);
+    std::vector<Real> average(nettingSets_.size(), 0.0);
+    for (Size j = 0; j < cube->numDates(); ++j) {
+        std::fill(exposure_.begin(), exposure_.end(), 0.0);
+        for (Size i = 0; i < cube->numIds(); ++i)
+            exposure_[idNettingSet_[i]] += cube->get(i, j, sample, 0);
+        for (Size n = 0; n < nettingSets_.size(); ++n)
+            average[n] += std::max(exposure_[n], 0.0);
+    }
+    for (Size n = 0; n < nettingSets_.size(); ++n)
+        values_[n].push_back(average[n] / static_cast<Real>(cube->numDates()));
+    ++samples_;
+    converged_ = false;
+    if (samples_ >= minSamples_ && samples_ % checkInterval_ == 0)
+        update();
+}
+
+void ExposureConvergenceMonitor::update() {
+    const Size batchSize = samples_ / batches_;
+    converged_ = true;
+    Real worst = 0.0;
+    std::string worstNettingSet;
+    for (Size n = 0; n < nettingSets_.size(); ++n) {
+        std::vector<Real> batchMeans(batches_, 0.0);
+        for (Size b = 0; b < batches_; ++b) {
+            for (Size k = b * batchSize; k < (b + 1) * batchSize; ++k)
+                batchMeans[b] += values_[n][k];
+            batchMeans[b] /= static_cast<Real>(batchSize);
+        }
+        Real mean = 0.0;
+        for (Real m : batchMeans)
+            mean += m;
+        mean /= static_cast<Real>(batches_);
+        Real variance = 0.0;
+        for (Real m : batchMeans)
+            variance += (m - mean) * (m - mean);
+        variance /= static_cast<Real>(batches_ - 1);
+        Real standardError = std::sqrt(variance / static_cast<Real>(batches_));
+        means_[nettingSets_[n]] = mean;
+        standardErrors_[nettingSets_[n]] = standardError;
+        Real relativeError = mean > 0.0 ? standardError / mean : (standardError > 0.0 ? QL_MAX_REAL : 0.0);
+        if (relativeError > tolerance_)
+            converged_ = false;
+        if (relativeError >= worst) {
+            worst = relativeError;
+            worstNettingSet = nettingSets_[n];
+        }
+    }
+    DLOG("ExposureConvergenceMonitor: " << samples_ << " samples, largest relative standard error " << worst
+                                        << " for netting set " << worstNettingSet << ", tolerance " << tolerance_);
+}
+
+} // namespace analytics
+} // namespace ore
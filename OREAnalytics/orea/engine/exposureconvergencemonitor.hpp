@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/exposureconvergencemonitor.hpp
+    \brief running standard error estimates of netting set exposures during cube generation
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/types.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Running estimates of the standard error of the netting set EPE during cube generation
+/*! For each simulated sample the monitor aggregates the npvs (depth 0) of the cube ids by netting set and records the
+    time average of the positive part over the valuation dates, i.e. the path contribution to the time averaged EPE,
+    which drives the CVA for a flat default probability. The standard error of the mean is estimated with batch means:
+    the samples recorded so far are split into a fixed number of consecutive batches and the standard deviation of
+    the batch means is divided by the square root of the number of batches. This does not assume independent samples,
+    so it applies to pseudo random as well as Sobol sequences, for the latter it is typically conservative.
+
+    The estimates are updated every checkInterval samples once minSamples samples are recorded. The simulation has
+    converged if the standard error relative to the estimated time averaged EPE is below the tolerance for all netting
+    sets. A netting set with zero EPE estimate counts as converged if its standard error is zero.
+
+    Cube ids that are not trades of the portfolio, e.g. the netting sets of a NettingSetAggregationCube, are treated as
+    their own netting set.
+
+    \ingroup engine
+*/
+class ExposureConvergenceMonitor {
+public:
+    ExposureConvergenceMonitor(const boost::shared_ptr<ore::data::Portfolio>& portfolio, const QuantLib::Real tolerance,
+                               const QuantLib::Size minSamples = 1000, const QuantLib::Size batches = 20,
+                               const QuantLib::Size checkInterval = 100);
+
+    //! Record the given sample of the cube, the samples are expected in order starting at 0
+    void add(const boost::shared_ptr<NPVCube>& cube, const QuantLib::Size sample);
+
+    //! True if the estimates were updated with the last sample and the tolerance is met for all netting sets
+    bool converged() const { return converged_; }
+
+    //! Number of recorded samples
+    QuantLib::Size samples() const { return samples_; }
+
+    //! The time averaged EPE estimates by netting set, as of the last update
+    const std::map<std::string, QuantLib::Real>& expectedExposures() const { return means_; }
+    //! The standard errors of the time averaged EPE by netting set, as of the last update
+    const std::map<std::string, QuantLib::Real>& standardErrors() const { return standardErrors_; }
+
+private:
+    void init(const boost::shared_ptr<NPVCube>& cube);
+    void update();
+
+    std::map<std::string, std::string> tradeNettingSet_;
+    QuantLib::Real tolerance_;
+    QuantLib::Size minSamples_, batches_, checkInterval_;
+
+    // netting set index of each cube id, netting set names and the recorded sample values by netting set
+    std::vector<QuantLib::Size> idNettingSet_;
+    std::vector<std::string> nettingSets_;
+    std::vector<std::vector<QuantLib::Real>> values_;
+    std::vector<QuantLib::Real> exposure_;
+
+    QuantLib::Size samples_ = 0;
+    bool converged_ = false;
+    std::map<std::string, QuantLib::Real> means_, standardErrors_;
+};
+
+} // namespace analytics
+} // namespace ore
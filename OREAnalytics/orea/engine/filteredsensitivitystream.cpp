@@ -19,7 +19,11 @@
 #include <math.h>
 #include <orea/engine/filteredsensitivitystream.hpp>
 
+#include <utility>
+#include <vector>
+
 using QuantLib::Real;
+using QuantLib::Size;
 using std::fabs;
 
 namespace ore {
@@ -30,12 +34,18 @@ FilteredSensitivityStream::FilteredSensitivityStream(const boost::shared_ptr<Sen
     : ss_(ss), deltaThreshold_(deltaThreshold), gammaThreshold_(gammaThreshold) {
     // Reset the underlying stream in case
     ss_->reset();
-    while (SensitivityRecord sr = ss_->next()) {
-        if (sr.isCrossGamma() && fabs(sr.gamma) > gammaThreshold_) {
-            deltaKeys_.insert(sr.key_1);
-            deltaKeys_.insert(sr.key_2);
+    std::vector<SensitivityRecord> records(1024);
+    Size n;
+    do {
+        n = ss_->nextBatch(records);
+        for (Size i = 0; i < n; ++i) {
+            const SensitivityRecord& sr = records[i];
+            if (sr.isCrossGamma() && fabs(sr.gamma) > gammaThreshold_) {
+                deltaKeys_.insert(sr.key_1);
+                deltaKeys_.insert(sr.key_2);
+            }
         }
-    }
+    } while (n == records.size());
     ss_->reset();
 }
 
@@ -47,8 +57,7 @@ SensitivityRecord FilteredSensitivityStream::next() {
     // Return the next sensitivity record in the underlying stream that satisfies
     // the threshold conditions
     while (SensitivityRecord sr = ss_->next()) {
-        if (fabs(sr.delta) > deltaThreshold_ || fabs(sr.gamma) > gammaThreshold_ ||
-            (!sr.isCrossGamma() && deltaKeys_.find(sr.key_1) != deltaKeys_.end())) {
+        if (keep(sr)) {
             return sr;
         }
     }
@@ -57,6 +66,31 @@ SensitivityRecord FilteredSensitivityStream::next() {
     return SensitivityRecord();
 }
 
+Size FilteredSensitivityStream::nextBatch(SensitivityRecord* records, Size n) {
+    // Read batches from the underlying stream into the free part of the buffer and move the records that satisfy
+    // the threshold conditions to its front, swapping keeps the storage of the dropped records in the buffer
+    Size kept = 0;
+    while (kept < n) {
+        Size m = ss_->nextBatch(records + kept, n - kept);
+        Size end = kept + m;
+        for (Size i = kept; i < end; ++i) {
+            if (keep(records[i])) {
+                if (i != kept)
+                    std::swap(records[kept], records[i]);
+                ++kept;
+            }
+        }
+        if (end < n)
+            break;
+    }
+    return kept;
+}
+
+bool FilteredSensitivityStream::keep(const SensitivityRecord& sr) const {
+    return fabs(sr.delta) > deltaThreshold_ || fabs(sr.gamma) > gammaThreshold_ ||
+           (!sr.isCrossGamma() && deltaKeys_.find(sr.key_1) != deltaKeys_.end());
+}
+
 void FilteredSensitivityStream::reset() {
     // Reset the underlying stream
     ss_->reset();
@@ -44,10 +44,16 @@ public:
     FilteredSensitivityStream(const boost::shared_ptr<SensitivityStream>& ss, QuantLib::Real threshold);
     //! Returns the next SensitivityRecord in the stream after filtering
     SensitivityRecord next() override;
+    //! Writes the next records after filtering to \p records, see SensitivityStream::nextBatch()
+    QuantLib::Size nextBatch(SensitivityRecord* records, QuantLib::Size n) override;
+    using SensitivityStream::nextBatch;
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     void reset() override;
 
 private:
+    //! True if the record satisfies the threshold conditions
+    bool keep(const SensitivityRecord& sr) const;
+
     //! The underlying sensitivity stream that has been wrapped
     boost::shared_ptr<SensitivityStream> ss_;
     //! The delta threshold
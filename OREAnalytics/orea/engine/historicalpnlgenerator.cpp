@@ -48,7 +48,7 @@ HistoricalPnlGenerator::HistoricalPnlGenerator(
     const set<std::pair<string, boost::shared_ptr<QuantExt::ModelBuilder>>>& modelBuilders, bool dryRun)
     : useSingleThreadedEngine_(true), portfolio_(portfolio), simMarket_(simMarket), hisScenGen_(hisScenGen),
       cube_(cube), dryRun_(dryRun),
-      npvCalculator_([&baseCurrency]() -> std::vector<boost::shared_ptr<ValuationCalculator>> {
+      npvCalculator_([baseCurrency]() -> std::vector<boost::shared_ptr<ValuationCalculator>> {
           return {boost::make_shared<NPVCalculator>(baseCurrency)};
       }) {
 
@@ -88,7 +88,7 @@ HistoricalPnlGenerator::HistoricalPnlGenerator(
       nThreads_(nThreads), today_(today), loader_(loader), curveConfigs_(curveConfigs),
       todaysMarketParams_(todaysMarketParams), configuration_(configuration), simMarketData_(simMarketData),
       referenceData_(referenceData), iborFallbackConfig_(iborFallbackConfig), dryRun_(dryRun), context_(context),
-      npvCalculator_([&baseCurrency]() -> std::vector<boost::shared_ptr<ValuationCalculator>> {
+      npvCalculator_([baseCurrency]() -> std::vector<boost::shared_ptr<ValuationCalculator>> {
           return {boost::make_shared<NPVCalculator>(baseCurrency)};
       }) {}
 
@@ -110,6 +110,7 @@ void HistoricalPnlGenerator::generateCube(const boost::shared_ptr<ScenarioFilter
         simMarket_->reset();
         simMarket_->scenarioGenerator() = hisScenGen_;
         hisScenGen_->baseScenario() = simMarket_->baseScenario();
+        valuationEngine_->setIncrementalValuation(incrementalValuation_);
         valuationEngine_->buildCube(portfolio_, cube_, npvCalculator_(), true, nullptr, nullptr, {}, dryRun_);
 
     } else {
@@ -117,12 +118,19 @@ void HistoricalPnlGenerator::generateCube(const boost::shared_ptr<ScenarioFilter
             nThreads_, today_, boost::make_shared<ore::analytics::DateGrid>(), hisScenGen_->numScenarios(), loader_,
             hisScenGen_, engineData_, curveConfigs_, todaysMarketParams_, configuration_, simMarketData_, false, false,
             filter, referenceData_, iborFallbackConfig_, true, true, {}, {}, {}, context_);
+        engine.setSampleParallel(sampleParallel_);
+        engine.setReuseT0(sampleParallel_);
+        engine.setIncrementalValuation(incrementalValuation_);
         for (auto const& i : this->progressIndicators()) {
             i->reset();
             engine.registerProgressIndicator(i);
         }
         engine.buildCube(portfolio_, npvCalculator_, {}, true, dryRun_);
-        cube_ = boost::make_shared<JointNPVCube>(engine.outputCubes(), portfolio_->ids(), true);
+        // in the sample-parallel mode all threads write into a single cube
+        if (sampleParallel_)
+            cube_ = engine.outputCubes().front();
+        else
+            cube_ = boost::make_shared<JointNPVCube>(engine.outputCubes(), portfolio_->ids(), true);
     }
 
     DLOG("Historical P&L cube generated");
@@ -80,6 +80,16 @@ public:
                            const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
                            bool dryRun = false, const std::string& context = "historical pnl generation");
 
+    /*! Enable incremental valuation, i.e. trades are only repriced in the scenarios that move a risk factor they
+        depend on, see ValuationEngine::setIncrementalValuation(). In the multi-threaded mode the dependencies are
+        taken from the market requests recorded while the workers build the portfolio. */
+    void setIncrementalValuation(const bool incrementalValuation) { incrementalValuation_ = incrementalValuation; }
+
+    /*! In the multi-threaded mode, split the historical scenarios over the threads instead of the trades (default).
+        Each thread then builds the full portfolio once and prices a disjoint range of scenarios, the T0 NPVs are
+        computed in the first thread only, see MultiThreadedValuationEngine::setSampleParallel(). */
+    void setSampleParallel(const bool sampleParallel) { sampleParallel_ = sampleParallel; }
+
     /*! Generate a "cube" of P&L values for the trades in the portfolio on each of
         the scenarios provided by the historical scenario generator. The historical
         scenarios will have the given \p filter applied.
@@ -169,6 +179,8 @@ private:
 
     bool dryRun_;
     std::string context_;
+    bool incrementalValuation_ = false;
+    bool sampleParallel_ = true;
 
     std::function<std::vector<boost::shared_ptr<ValuationCalculator>>()> npvCalculator_;
 
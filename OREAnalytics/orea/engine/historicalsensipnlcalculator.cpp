@@ -23,6 +23,8 @@
 #include <boost/accumulators/statistics/tail_quantile.hpp>
 #include <boost/range/adaptor/indexed.hpp>
 
+#include <algorithm>
+
 using namespace std;
 using namespace QuantLib;
 using namespace boost::accumulators;
@@ -30,47 +32,47 @@ using namespace boost::accumulators;
 namespace {
  
 using TradeSensiCache = map<Size, map<Size, pair<Real, Real>>>;
+using ore::analytics::RiskFactorKey;
 using ore::analytics::SensitivityRecord;
 
 void cacheTradeSensitivities(TradeSensiCache& cache, ore::analytics::SensitivityStream& ss,
                              const set<SensitivityRecord>& srs,
                              const vector<string>& tradeIds) {
 
+    // Positions of the trade IDs and of the records' keys, the first position wins for duplicate trade IDs
+    map<string, Size> tradePos;
+    for (Size t = 0; t < tradeIds.size(); ++t)
+        tradePos.insert(make_pair(tradeIds[t], t));
+    map<pair<RiskFactorKey, RiskFactorKey>, Size> srPos;
+    for (const auto elem : srs | boost::adaptors::indexed(0))
+        srPos.insert(make_pair(make_pair(elem.value().key_1, elem.value().key_2), elem.index()));
+
     // Reset the stream to ensure at start.
     ss.reset();
 
     // One pass of sensitivity records to populate the trade level cache.
-    while (SensitivityRecord sr = ss.next()) {
-
-        // Sensitivity record is only relevant if it is in our set of trade IDs
-        auto itTrade = find(tradeIds.begin(), tradeIds.end(), sr.tradeId);
-        if (itTrade == tradeIds.end())
-            continue;
-
-        // This sensitivity record should be in the set of passed in sensitivity records.
-        auto itSr = find_if(srs.begin(), srs.end(), [&sr](const SensitivityRecord& other) {
-            return sr.key_1 == other.key_1 && sr.key_2 == other.key_2;
-        });
-
-        // Positions for the cache keys.
-        auto posTrade = distance(tradeIds.begin(), itTrade);
-        auto posSr = distance(srs.begin(), itSr);
-
-        // Add the sensitivity record values to the cache.
-        auto itCacheSr = cache.find(posSr);
-        if (itCacheSr == cache.end()) {
-            cache[posSr][posTrade] = make_pair(sr.delta, sr.gamma);
-        } else {
-            auto itCacheTrade = itCacheSr->second.find(posTrade);
-            if (itCacheTrade == itCacheSr->second.end()) {
-                itCacheSr->second[posTrade] = make_pair(sr.delta, sr.gamma);
-            } else {
-                auto& p = itCacheTrade->second;
-                p.first += sr.delta;
-                p.second += sr.gamma;
-            }
+    vector<SensitivityRecord> buffer(1024);
+    Size n;
+    do {
+        n = ss.nextBatch(buffer);
+        for (Size i = 0; i < n; ++i) {
+            const SensitivityRecord& sr = buffer[i];
+
+            // Sensitivity record is only relevant if it is in our set of trade IDs and in the set of passed in
+            // sensitivity records.
+            auto itTrade = tradePos.find(sr.tradeId);
+            if (itTrade == tradePos.end())
+                continue;
+            auto itSr = srPos.find(make_pair(sr.key_1, sr.key_2));
+            if (itSr == srPos.end())
+                continue;
+
+            // Add the sensitivity record values to the cache.
+            auto& p = cache[itSr->second].insert(make_pair(itTrade->second, make_pair(0.0, 0.0))).first->second;
+            p.first += sr.delta;
+            p.second += sr.gamma;
         }
-    }
+    } while (n == buffer.size());
 
     // Reset the stream to ensure at start.
     ss.reset();
@@ -82,48 +84,85 @@ namespace ore {
 namespace analytics {
 
 void CovarianceCalculator::initialise(const set<pair<RiskFactorKey, Size>>& keys) {
-    // Set up the boost accumulators that will calculate the covariance between the time series of historical shifts for
-    // each relevant risk factor key i.e. the risk factor keys in the set keys over the benchmark period
-    
-    for (auto ito = keys.begin(); ito != keys.end(); ito++) {
-        accCov_[make_pair(ito->second, ito->second)] = accumulator();
-        for (auto iti = keys.begin(); iti != ito; iti++) {
-            accCov_[make_pair(iti->second, ito->second)] = accumulator();
-        }
-    }
+    // The covariance is computed between the time series of historical shifts for each relevant risk factor key i.e.
+    // the risk factor keys in the set keys over the benchmark period
+    keyIndex_.clear();
+    for (const auto& k : keys)
+        keyIndex_.push_back(k.second);
+    shifts_.clear();
 }
 
 void CovarianceCalculator::updateAccumulators(const ext::shared_ptr<NPVCube>& shiftCube, Date startDate, Date endDate, Size index) {
     TLOG("Updating Covariance accumlators for sensitivity record " << index);
     if (covariancePeriod_.contains(startDate) &&
         covariancePeriod_.contains(endDate)) {
-        // Update the covariance accumulators if in benchmark period
-        for (auto it = accCov_.begin(); it != accCov_.end(); it++) {
-            Real oShift = shiftCube->get(it->first.first, 0, index);
-            if (it->first.first == it->first.second) {
-                it->second(oShift, covariate1 = oShift);
-            } else {
-                Real iShift = shiftCube->get(it->first.second, 0, index);
-                it->second(oShift, covariate1 = iShift);
-            }
-        }
+        // Add the row of shifts if in benchmark period
+        for (Size k : keyIndex_)
+            shifts_.push_back(shiftCube->get(k, 0, index));
     }
 }
 
 void CovarianceCalculator::populateCovariance(const std::set<std::pair<RiskFactorKey, QuantLib::Size>>& keys) {
     LOG("Populate the covariance matrix with the calculated covariances");
-    covariance_ = Matrix(keys.size(), keys.size());
-    Size i = 0;
-    for (auto ito = keys.begin(); ito != keys.end(); ito++) {
-        covariance_[i][i] = boost::accumulators::covariance(accCov_.at(make_pair(ito->second, ito->second)));
-        Size j = 0;
-        for (auto iti = keys.begin(); iti != ito; iti++) {
-            covariance_[i][j] = covariance_[j][i] =
-                boost::accumulators::covariance(accCov_.at(make_pair(iti->second, ito->second)));
-            j++;
+    const Size n = keyIndex_.size();
+    QL_REQUIRE(keys.size() == n, "CovarianceCalculator: got " << keys.size() << " keys, expected " << n);
+    const Size m = n == 0 ? 0 : shifts_.size() / n;
+    covariance_ = Matrix(n, n, 0.0);
+    if (m == 0)
+        return;
+
+    // scenario weights, normalised to sum to one
+    vector<Real> weights(m, 1.0 / m);
+    if (ewmaLambda_ != Null<Real>()) {
+        QL_REQUIRE(ewmaLambda_ > 0.0 && ewmaLambda_ <= 1.0,
+                   "CovarianceCalculator: ewma lambda (" << ewmaLambda_ << ") must be in (0, 1]");
+        Real sum = 0.0, weight = 1.0;
+        for (Size r = m; r > 0; --r) {
+            weights[r - 1] = weight;
+            sum += weight;
+            weight *= ewmaLambda_;
         }
-        i++;
+        for (auto& w : weights)
+            w /= sum;
     }
+
+    // centre the shifts around the weighted means and scale the rows by the square roots of the weights
+    vector<Real> means(n, 0.0);
+    for (Size r = 0; r < m; ++r)
+        for (Size k = 0; k < n; ++k)
+            means[k] += weights[r] * shifts_[r * n + k];
+    for (Size r = 0; r < m; ++r) {
+        Real sw = std::sqrt(weights[r]);
+        for (Size k = 0; k < n; ++k)
+            shifts_[r * n + k] = sw * (shifts_[r * n + k] - means[k]);
+    }
+
+    // X^T X over the upper triangle of blocks of factors, each block pair is written by exactly one job
+    const Size blockSize = 64;
+    const Size nBlocks = (n + blockSize - 1) / blockSize;
+    vector<pair<Size, Size>> blockPairs;
+    for (Size bi = 0; bi < nBlocks; ++bi)
+        for (Size bj = bi; bj < nBlocks; ++bj)
+            blockPairs.push_back(make_pair(bi, bj));
+    runBlocks(blockPairs.size(), nThreads_, threadPool_, [this, &blockPairs, n, m, blockSize](Size begin, Size end) {
+        for (Size p = begin; p < end; ++p) {
+            Size i0 = blockPairs[p].first * blockSize, i1 = std::min(i0 + blockSize, n);
+            Size j0 = blockPairs[p].second * blockSize, j1 = std::min(j0 + blockSize, n);
+            for (Size r = 0; r < m; ++r) {
+                const Real* x = &shifts_[r * n];
+                for (Size i = i0; i < i1; ++i) {
+                    Real xi = x[i];
+                    Real* c = covariance_[i];
+                    for (Size j = std::max(i, j0); j < j1; ++j)
+                        c[j] += xi * x[j];
+                }
+            }
+        }
+    });
+    for (Size i = 0; i < n; ++i)
+        for (Size j = 0; j < i; ++j)
+            covariance_[i][j] = covariance_[j][i];
+    shifts_.clear();
 }
 
 void PNLCalculator::populatePNLs(const std::vector<Real>& allPnls,
@@ -166,15 +205,49 @@ void HistoricalSensiPnlCalculator::populateSensiShifts(boost::shared_ptr<NPVCube
     cube = boost::make_shared<DoublePrecisionInMemoryCube>(
         baseScenario->asof(), keyNames, vector<Date>(1, baseScenario->asof()), hisScenGen_->numScenarios());
 
+    // The scenarios that are fully covered by the shift store don't have to be generated, the generator only has to
+    // be advanced up to the last scenario with missing shifts
+    const Size nScenarios = hisScenGen_->numScenarios();
+    vector<bool> stored(nScenarios, false);
+    Size nStored = 0, nGenerate = nScenarios;
+    if (shiftStore_) {
+        set<HistoricalShiftStore::DatePair> dates;
+        for (Size i = 0; i < nScenarios; i++) {
+            HistoricalShiftStore::DatePair d(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i]);
+            dates.insert(d);
+            stored[i] = std::all_of(keyNameMapping.begin(), keyNameMapping.end(), [this, &d](const auto& k) {
+                return shiftStore_->shift(d, k.second) != Null<Real>();
+            });
+            if (stored[i])
+                nStored++;
+        }
+        shiftStore_->prune(dates);
+        while (nGenerate > 0 && stored[nGenerate - 1])
+            nGenerate--;
+        LOG("Reuse the stored shifts for " << nStored << " out of " << nScenarios << " historical scenarios");
+    }
+
     // Loop over each historical scenario which represents the market move from t_i to
     // t_i + mpor applied to the base scenario for all i in historical period of scenario generator
-    for (Size i = 0; i < hisScenGen_->numScenarios(); i++) {
+    for (Size i = 0; i < nScenarios; i++) {
+        HistoricalShiftStore::DatePair d(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i]);
+        if (stored[i]) {
+            Size j = 0;
+            for (const auto& [_, key] : keyNameMapping)
+                cube->set(shiftStore_->shift(d, key), j++, 0, i);
+        }
+        if (i >= nGenerate)
+            continue;
         boost::shared_ptr<Scenario> scenario = hisScenGen_->next(baseScenario->asof());
+        if (stored[i])
+            continue;
 
         Size j = 0;
         for (const auto& [_, key] : keyNameMapping) {
             Real shift = shiftCalculator->shift(key, *baseScenario, *scenario);
             cube->set(shift, j, 0, i);
+            if (shiftStore_)
+                shiftStore_->set(d, key, shift);
             j++;
         }
     }
@@ -221,24 +294,49 @@ void HistoricalSensiPnlCalculator::calculateSensiPnl(
     // we require a sensitivity stream to run at trade level
     bool runTradeLevel = tradeLevel && sensitivityStream_;
 
-    // Local P&L vectors to hold _all_ historical P&Ls
     auto nScenarios = hisScenGen_->numScenarios();
-    vector<Real> allPnls(hisScenGen_->numScenarios(), 0.0);
-    vector<Real> allFoPnls(hisScenGen_->numScenarios(), 0.0);
-
-    using TradePnLStore = std::vector<std::vector<QuantLib::Real>>;
-    TradePnLStore tradePnls, foTradePnls;
+    Size nKeys = shiftCube->numIds();
+    const auto& startDates = hisScenGen_->startDates();
+    const auto& endDates = hisScenGen_->endDates();
+
+    // The scenarios that are in the period of at least one P&L calculator, these get trade level P&Ls
+    vector<Size> periodScenarios;
+    for (Size i = 0; i < nScenarios; i++) {
+        for (const auto& c : pnlCalculators) {
+            if (c->isInTimePeriod(startDates[i], endDates[i])) {
+                periodScenarios.push_back(i);
+                break;
+            }
+        }
+    }
 
-    // We may need to store trade level P&Ls.
-    if (runTradeLevel) {
-        tradePnls.clear();
-        tradePnls.reserve(nScenarios);
-        foTradePnls.clear();
-        foTradePnls.reserve(nScenarios);
+    // Shift matrix with one row of factor shifts per scenario, in the order of the shift cube ids
+    Matrix shifts(nScenarios, nKeys);
+    for (Size i = 0; i < nScenarios; i++)
+        for (Size k = 0; k < nKeys; k++)
+            shifts[i][k] = shiftCube->get(k, 0, i);
+
+    // Portfolio delta and gamma vectors aligned with the shift cube ids and the list of cross gammas
+    vector<Real> deltas(nKeys, 0.0), gammas(nKeys, 0.0);
+    struct CrossGamma {
+        Size index_1, index_2;
+        Real gamma;
+    };
+    vector<CrossGamma> crossGammas;
+    vector<bool> isCrossGamma;
+    for (const auto elem : srs | boost::adaptors::indexed(0)) {
+        const auto& sr = elem.value();
+        const auto& index = srsIndex[elem.index()];
+        isCrossGamma.push_back(sr.isCrossGamma());
+        if (sr.isCrossGamma()) {
+            crossGammas.push_back({index.first, index.second, sr.gamma});
+        } else {
+            deltas[index.first] += sr.delta;
+            gammas[index.first] += 0.5 * sr.gamma;
+        }
     }
 
     hisScenGen_->reset();
-    boost::shared_ptr<Scenario> baseScenario = hisScenGen_->baseScenario();
 
     // If we have been asked for a trade level P&L contribution report or detail report, store the trade level
     // sensitivities. We store them in a container here that is easily looked up in the loop below.
@@ -247,112 +345,135 @@ void HistoricalSensiPnlCalculator::calculateSensiPnl(
         cacheTradeSensitivities(tradeSensiCache, *sensitivityStream_, srs, tradeIds);
     }
 
-    // Loop over each historical scenario
-    for (Size i = 0; i < hisScenGen_->numScenarios(); i++) {
-
-        // Add trade level P&L vector if needed.
-        if (runTradeLevel) {
-            bool inPeriod = false;
-            for (const auto& c : pnlCalculators) {
-                if (c->isInTimePeriod(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i]))
-                    inPeriod = true;
+    // Compressed rows of the trade level sensitivities, the delta and half gamma per shift cube id, then the cross
+    // gammas
+    struct TradeRow {
+        vector<Size> index;
+        vector<Real> delta, gamma;
+        vector<CrossGamma> crossGammas;
+    };
+    vector<TradeRow> tradeRows(runTradeLevel ? tradeIds.size() : 0);
+    for (const auto& [j, trades] : tradeSensiCache) {
+        for (const auto& [t, sensi] : trades) {
+            if (isCrossGamma[j]) {
+                tradeRows[t].crossGammas.push_back({srsIndex[j].first, srsIndex[j].second, sensi.second});
+            } else {
+                tradeRows[t].index.push_back(srsIndex[j].first);
+                tradeRows[t].delta.push_back(sensi.first);
+                tradeRows[t].gamma.push_back(0.5 * sensi.second);
             }
-            if (inPeriod) {
-                tradePnls.push_back(vector<Real>(tradeIds.size(), 0.0));
-                foTradePnls.push_back(vector<Real>(tradeIds.size(), 0.0));
+        }
+    }
+
+    // Local P&L vectors to hold _all_ historical P&Ls and trade level P&Ls for the scenarios in a P&L period
+    vector<Real> allPnls(nScenarios, 0.0);
+    vector<Real> allFoPnls(nScenarios, 0.0);
+
+    using TradePnLStore = std::vector<std::vector<QuantLib::Real>>;
+    TradePnLStore tradePnls, foTradePnls;
+    if (runTradeLevel) {
+        tradePnls.assign(periodScenarios.size(), vector<Real>(tradeIds.size(), 0.0));
+        foTradePnls.assign(periodScenarios.size(), vector<Real>(tradeIds.size(), 0.0));
+    }
+
+    LOG("Compute the sensitivity P&Ls for " << nScenarios << " scenarios, " << nKeys << " factors and "
+                                            << crossGammas.size() << " cross gammas in " << nThreads_ << " blocks");
+
+    runBlocks(nScenarios, nThreads_, threadPool_, [&](Size begin, Size end) {
+        for (Size i = begin; i < end; i++) {
+            const Real* shift = shifts[i];
+            Real deltaPnl = 0.0, gammaPnl = 0.0;
+            for (Size k = 0; k < nKeys; k++) {
+                deltaPnl += deltas[k] * shift[k];
+                gammaPnl += gammas[k] * shift[k] * shift[k];
             }
+            for (const auto& cg : crossGammas)
+                gammaPnl += cg.gamma * shift[cg.index_1] * shift[cg.index_2];
+            // If backtesting curvature margin, we exclude deltas i.e. 1st order effects from the sensi P&L
+            // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
+            allFoPnls[i] = deltaPnl;
+            allPnls[i] = (includeDeltaMargin ? deltaPnl : 0.0) + (includeGammaMargin ? gammaPnl : 0.0);
         }
+    });
+
+    if (runTradeLevel) {
+        runBlocks(periodScenarios.size(), nThreads_, threadPool_, [&](Size begin, Size end) {
+            for (Size p = begin; p < end; p++) {
+                const Real* shift = shifts[periodScenarios[p]];
+                for (Size t = 0; t < tradeRows.size(); t++) {
+                    const auto& row = tradeRows[t];
+                    Real deltaPnl = 0.0, gammaPnl = 0.0;
+                    for (Size e = 0; e < row.index.size(); e++) {
+                        Real s = shift[row.index[e]];
+                        deltaPnl += row.delta[e] * s;
+                        gammaPnl += row.gamma[e] * s * s;
+                    }
+                    for (const auto& cg : row.crossGammas)
+                        gammaPnl += cg.gamma * shift[cg.index_1] * shift[cg.index_2];
+                    foTradePnls[p][t] = deltaPnl;
+                    tradePnls[p][t] = (includeDeltaMargin ? deltaPnl : 0.0) + (includeGammaMargin ? gammaPnl : 0.0);
+                }
+            }
+        });
+    }
 
+    // Write the P&L contributions per record and trade, in the order of the records
+    for (Size i : periodScenarios) {
+        const Real* shift = shifts[i];
         for (const auto elem : srs | boost::adaptors::indexed(0)) {
 
             const auto& sr = elem.value();
             auto j = elem.index();
+            auto itSr = tradeSensiCache.find(j);
 
             if (!sr.isCrossGamma()) {
-
-                Real shift = shiftCube->get(srsIndex[j].first, 0, i);
-                Real deltaPnl = shift * sr.delta;
-                Real gammaPnl = 0.5 * shift * shift * sr.gamma;
-                // Update the first order P&L
-                allFoPnls[i] += deltaPnl;
-                // If backtesting curvature margin, we exclude deltas i.e. 1st order effects from the sensi P&L
-                if (includeDeltaMargin)
-                    allPnls[i] += deltaPnl;
-                // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
-                if (includeGammaMargin)
-                    allPnls[i] += gammaPnl;
-
+                Real s = shift[srsIndex[j].first];
+                Real deltaPnl = s * sr.delta;
+                Real gammaPnl = 0.5 * s * s * sr.gamma;
                 for (const auto& c : pnlCalculators) {
-                    if (c->isInTimePeriod(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i])) {
-                        c->writePNL(i, true, sr.key_1, shift, sr.delta, sr.gamma, deltaPnl, gammaPnl);
-                        if (!tradeSensiCache.empty()) {
-                            auto itSr = tradeSensiCache.find(j);
-                            if (itSr != tradeSensiCache.end()) {
-                                for (const auto& kv : itSr->second) {
-                                    const auto& tradeId = tradeIds[kv.first];
-                                    Real tradeDelta = kv.second.first;
-                                    Real tradeDeltaPnl = shift * tradeDelta;
-                                    Real tradeGamma = kv.second.second;
-                                    Real tradeGammaPnl = 0.5 * shift * shift * tradeGamma;
-                                    // Attempt to write trade level P&L contribution row.
-                                    c->writePNL(i, true, sr.key_1, shift, tradeDelta, tradeGamma, tradeDeltaPnl,
-                                                  tradeGammaPnl, RiskFactorKey(), 0.0, tradeId);
-                                    // Update the sensitivity based trade level P&Ls
-                                    if (runTradeLevel) {
-                                        foTradePnls.back()[kv.first] += tradeDeltaPnl;
-                                        if (includeDeltaMargin)
-                                            tradePnls.back()[kv.first] += tradeDeltaPnl;
-                                        if (includeGammaMargin)
-                                            tradePnls.back()[kv.first] += tradeGammaPnl;
-                                    }
-                                }
-                            }
+                    if (!c->isInTimePeriod(startDates[i], endDates[i]))
+                        continue;
+                    c->writePNL(i, true, sr.key_1, s, sr.delta, sr.gamma, deltaPnl, gammaPnl);
+                    if (itSr != tradeSensiCache.end()) {
+                        for (const auto& kv : itSr->second) {
+                            Real tradeDelta = kv.second.first;
+                            Real tradeGamma = kv.second.second;
+                            // Attempt to write trade level P&L contribution row.
+                            c->writePNL(i, true, sr.key_1, s, tradeDelta, tradeGamma, s * tradeDelta,
+                                        0.5 * s * s * tradeGamma, RiskFactorKey(), 0.0, tradeIds[kv.first]);
                         }
                     }
                 }
             } else {
-                Real shift_1 = shiftCube->get(srsIndex[j].first, 0, i);
-                Real shift_2 = shiftCube->get(srsIndex[j].second, 0, i);
+                Real shift_1 = shift[srsIndex[j].first];
+                Real shift_2 = shift[srsIndex[j].second];
                 Real gammaPnl = shift_1 * shift_2 * sr.gamma;
-
-                // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
-                if (includeGammaMargin)
-                    allPnls[i] += gammaPnl;
-                                
                 for (const auto& c : pnlCalculators) {
-                    if (c->isInTimePeriod(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i])) {
-                        c->writePNL(i, true, sr.key_1, shift_1, sr.delta, sr.gamma, 0.0, gammaPnl, sr.key_2, shift_2);
-                        if (!tradeSensiCache.empty()) {
-                            auto itSr = tradeSensiCache.find(j);
-                            if (itSr != tradeSensiCache.end()) {
-                                for (const auto& kv : itSr->second) {
-                                    const auto& tradeId = tradeIds[kv.first];
-                                    Real tradeGamma = kv.second.second;
-                                    Real tradeGammaPnl = shift_1 * shift_2 * tradeGamma;
-                                    // Attempt to write trade level P&L contribution row.
-                                    c->writePNL(i, true, sr.key_1, shift_1, 0.0, tradeGamma, 0.0, tradeGammaPnl,
-                                                  sr.key_2, shift_2, tradeId);
-                                    // Update the sensitivity based trade level P&Ls
-                                    if (runTradeLevel && includeGammaMargin) {
-                                        tradePnls.back()[kv.first] += tradeGammaPnl;
-                                    }
-                                }
-                            }
+                    if (!c->isInTimePeriod(startDates[i], endDates[i]))
+                        continue;
+                    c->writePNL(i, true, sr.key_1, shift_1, sr.delta, sr.gamma, 0.0, gammaPnl, sr.key_2, shift_2);
+                    if (itSr != tradeSensiCache.end()) {
+                        for (const auto& kv : itSr->second) {
+                            Real tradeGamma = kv.second.second;
+                            // Attempt to write trade level P&L contribution row.
+                            c->writePNL(i, true, sr.key_1, shift_1, 0.0, tradeGamma, 0.0,
+                                        shift_1 * shift_2 * tradeGamma, sr.key_2, shift_2, tradeIds[kv.first]);
                         }
                     }
-
                 }
             }
         }
-        if (covarianceCalculator)
-            covarianceCalculator->updateAccumulators(shiftCube, hisScenGen_->startDates()[i], hisScenGen_->endDates()[i], i);
     }
-    if (covarianceCalculator)
+
+    if (covarianceCalculator) {
+        for (Size i = 0; i < nScenarios; i++)
+            covarianceCalculator->updateAccumulators(shiftCube, startDates[i], endDates[i], i);
         covarianceCalculator->populateCovariance(keys);
+    }
 
     LOG("Populate the sensitivity backtesting P&L vectors");
     for (const auto& c : pnlCalculators) {
-        c->populatePNLs(allPnls, allFoPnls, hisScenGen_->startDates(), hisScenGen_->endDates());
+        c->populatePNLs(allPnls, allFoPnls, startDates, endDates);
         if (runTradeLevel)
             c->populateTradePNLs(tradePnls, foTradePnls);
     }
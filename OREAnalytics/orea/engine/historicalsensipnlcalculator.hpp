@@ -24,24 +24,16 @@
 
 #include <orea/cube/npvcube.hpp>
 #include <orea/scenario/historicalscenariogenerator.hpp>
+#include <orea/scenario/historicalshiftstore.hpp>
 #include <orea/scenario/scenarioshiftcalculator.hpp>
 #include <orea/engine/sensitivityrecord.hpp>
 #include <orea/engine/sensitivitystream.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/scenario/scenario.hpp>
 
 #include <ql/math/matrix.hpp>
 #include <ql/shared_ptr.hpp>
-
-#include <boost/accumulators/accumulators.hpp>
-// Including <boost/accumulators/statistics.hpp> causes the following swig wrapper compiler errors
-//   explicit specialization of 'boost::accumulators::feature_of<boost::accumulators::tag::weighted_skewness>'
-//   explicit specialization of 'boost::accumulators::feature_of<boost::accumulators::tag::weighted_kurtosis>'
-// see https://github.com/boostorg/accumulators/issues/20
-// The following subset of includes is sufficient here and circumvents the swig errors
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/variance.hpp>
-#include <boost/accumulators/statistics/covariance.hpp>
-#include <boost/accumulators/statistics/variates/covariate.hpp>
+#include <ql/utilities/null.hpp>
 
 namespace ore {
 namespace analytics {
@@ -72,30 +64,68 @@ protected:
     ore::data::TimePeriod pnlPeriod_;
 };
 
+//! Covariance of the historical shifts of a set of risk factors
+/*! The shifts of the scenarios in the covariance period are collected by updateAccumulators() into a matrix with one
+    row per scenario. populateCovariance() then centres the matrix and computes the covariance as X^T X in blocks of
+    factor pairs, which can be distributed over several threads, see setThreads().
+
+    By default all scenarios have the same weight and the result is the population covariance. If a decay factor
+    lambda in (0, 1) is given, the scenario added k scenarios before the last one has a weight proportional to
+    lambda^k, i.e. the scenarios are assumed to be added in chronological order.
+*/
 class CovarianceCalculator {
 public:
-    CovarianceCalculator(ore::data::TimePeriod covariancePeriod) : covariancePeriod_(covariancePeriod) {}
+    CovarianceCalculator(ore::data::TimePeriod covariancePeriod,
+                         QuantLib::Real ewmaLambda = QuantLib::Null<QuantLib::Real>())
+        : covariancePeriod_(covariancePeriod), ewmaLambda_(ewmaLambda) {}
+    //! Compute the covariance blocks in nThreads jobs, on the given thread pool if set, otherwise in separate threads
+    void setThreads(const QuantLib::Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = nThreads;
+        threadPool_ = threadPool;
+    }
     void initialise(const std::set<std::pair<RiskFactorKey, QuantLib::Size>>& keys);
     void updateAccumulators(const QuantLib::ext::shared_ptr<NPVCube>& shiftCube, QuantLib::Date startDate, QuantLib::Date endDate, QuantLib::Size index);
     void populateCovariance(const std::set<std::pair<RiskFactorKey, QuantLib::Size>>& keys);
     const Matrix& covariance() const { return covariance_; }
 
 private:
-    typedef boost::accumulators::accumulator_set<
-        QuantLib::Real,
-        boost::accumulators::stats<boost::accumulators::tag::covariance<QuantLib::Real, boost::accumulators::tag::covariate1>>>
-        accumulator;
-    std::map<std::pair<QuantLib::Size, QuantLib::Size>, accumulator> accCov_;
     ore::data::TimePeriod covariancePeriod_;
+    QuantLib::Real ewmaLambda_;
+    QuantLib::Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    //! positions of the keys in the shift cube
+    std::vector<QuantLib::Size> keyIndex_;
+    //! the shifts of the scenarios in the covariance period, one row of keyIndex_.size() shifts per scenario
+    std::vector<QuantLib::Real> shifts_;
     QuantLib::Matrix covariance_;
 };
 
+//! Sensitivity based P&L on historical scenarios
+/*! The sensitivity records are compiled into a delta and a gamma vector aligned with the keys of the shift cube and a
+    list of cross gammas, per trade the records are held in compressed rows. The P&L of each historical scenario is
+    then the product of these with the scenario's shift vector. The scenarios are processed in blocks, which can be
+    distributed over several threads, see setThreads(). The PNLCalculator::writePNL() callbacks are invoked in the
+    calling thread after the P&Ls are computed, in the same order as the records.
+*/
 class HistoricalSensiPnlCalculator {
 public:
     HistoricalSensiPnlCalculator(const boost::shared_ptr<HistoricalScenarioGenerator>& hisScenGen,
                                  const boost::shared_ptr<SensitivityStream>& ss)
         : hisScenGen_(hisScenGen), sensitivityStream_(ss) {}
-    
+
+    /*! Compute the scenario P&Ls in nThreads blocks, on the given thread pool if set, otherwise in separate
+        threads */
+    void setThreads(const QuantLib::Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = nThreads;
+        threadPool_ = threadPool;
+    }
+
+    /*! Reuse the shifts of the store for the scenarios whose (start, end) dates it contains, see HistoricalShiftStore
+        for when this is valid. The shifts computed by populateSensiShifts() are added to the store and the date pairs
+        that are no longer in the historical period are removed, so that the store can be saved for the next run. If
+        no store is set, all shifts are computed. */
+    void setShiftStore(const boost::shared_ptr<HistoricalShiftStore>& shiftStore) { shiftStore_ = shiftStore; }
+
     void populateSensiShifts(QuantLib::ext::shared_ptr<NPVCube>& cube, const vector<RiskFactorKey>& keys,
                              QuantLib::ext::shared_ptr<ScenarioShiftCalculator> shiftCalculator);
 
@@ -112,6 +142,9 @@ private:
     QuantLib::ext::shared_ptr<HistoricalScenarioGenerator> hisScenGen_;
     //! Stream of sensitivity records used for the sensitivity based backtest
     QuantLib::ext::shared_ptr<SensitivityStream> sensitivityStream_;
+    QuantLib::Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    boost::shared_ptr<HistoricalShiftStore> shiftStore_;
 };
 
 } // namespace analytics
@@ -18,29 +18,29 @@
 
 #include <orea/engine/historicalsimulationvar.hpp>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics.hpp>
-#include <boost/accumulators/statistics/tail_quantile.hpp>
-
-using namespace boost::accumulators;
+using namespace QuantLib;
 
 namespace ore {
 namespace analytics {
 
-QuantLib::Real HistoricalSimulationVarCalculator::var(QuantLib::Real confidence, const bool isCall, 
-    const set<pair<string, Size>>& tradeIds) {
+Real HistoricalSimulationVarCalculator::var(Real confidence, const bool isCall,
+                                            const set<pair<string, Size>>& tradeIds) {
+    return tailStatistics(std::vector<Real>(1, confidence), isCall).quantiles.front();
+}
 
-    // Use boost to calculate the quantile based on confidence_
-    Size c = static_cast<Size>(std::floor(pnls_.size() * (1.0 - confidence) + 0.5)) + 2;
-    typedef accumulator_set<double, stats<boost::accumulators::tag::tail_quantile<boost::accumulators::right>>>
-        accumulator;
-    accumulator acc(boost::accumulators::tag::tail<boost::accumulators::right>::cache_size = c);
+std::vector<Real> HistoricalSimulationVarCalculator::var(const std::vector<Real>& confidence, const bool isCall,
+                                                         const set<pair<string, Size>>& tradeIds) {
+    return tailStatistics(confidence, isCall).quantiles;
+}
 
-    for (const auto& pnl : pnls_) {
-        acc(isCall ? pnl : -pnl);
+QuantExt::TailStatistics HistoricalSimulationVarCalculator::tailStatistics(const std::vector<Real>& confidence,
+                                                                           const bool isCall) const {
+    std::vector<Real> pnls(pnls_);
+    if (!isCall) {
+        for (auto& pnl : pnls)
+            pnl = -pnl;
     }
-
-    return quantile(acc, quantile_probability = confidence);
+    return QuantExt::rightTailStatistics(std::move(pnls), confidence, weights_);
 }
 
 } // namespace analytics
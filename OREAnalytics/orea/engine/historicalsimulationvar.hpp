@@ -34,6 +34,7 @@
 #include <ored/utilities/timeperiod.hpp>
 
 #include <qle/math/covariancesalvage.hpp>
+#include <qle/math/tailstatistics.hpp>
 
 #include <ql/math/array.hpp>
 #include <ql/math/matrix.hpp>
@@ -48,15 +49,28 @@ using QuantLib::Matrix;
 
 typedef std::pair<RiskFactorKey, RiskFactorKey> CrossPair;
 
+//! Historical simulation VaR and expected shortfall from a vector of scenario P&Ls
+/*! The scenarios can be weighted, e.g. for age or volatility weighting, see QuantExt::rightTailStatistics() for the
+    definition of the quantiles and expected shortfalls. The P&L vector is held by reference. */
 class HistoricalSimulationVarCalculator : public VarCalculator {
 public:
-    HistoricalSimulationVarCalculator(const std::vector<QuantLib::Real>& pnls) : pnls_(pnls) {}
+    HistoricalSimulationVarCalculator(const std::vector<QuantLib::Real>& pnls,
+                                      const std::vector<QuantLib::Real>& weights = std::vector<QuantLib::Real>())
+        : pnls_(pnls), weights_(weights) {}
 
+    using VarCalculator::var;
     QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true,
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+    std::vector<QuantLib::Real> var(const std::vector<QuantLib::Real>& confidence, const bool isCall = true,
+                                    const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+
+    //! VaR and expected shortfall for several confidence levels in one pass over the P&Ls
+    QuantExt::TailStatistics tailStatistics(const std::vector<QuantLib::Real>& confidence,
+                                            const bool isCall = true) const;
 
 private:
     const std::vector<QuantLib::Real>& pnls_;
+    const std::vector<QuantLib::Real> weights_;
 };
 
 } // namespace analytics
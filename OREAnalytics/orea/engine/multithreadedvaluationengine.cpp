@@ -22,24 +22,93 @@
 
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/scenario/clonedscenariogenerator.hpp>
 
 #include <ored/marketdata/clonedloader.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/portfolio/enginefactory.hpp>
+#include <ored/utilities/xmlutils.hpp>
 
 #include <boost/timer/timer.hpp>
 
+#include <atomic>
 #include <future>
+#include <mutex>
+#include <stdexcept>
 
-// #include <ctpl_stl.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace ore {
 namespace analytics {
 
+using QuantLib::Null;
+using QuantLib::Real;
 using QuantLib::Size;
 
+namespace {
+bool isSharedMemoryCube(const boost::shared_ptr<NPVCube>& cube) {
+    return cube == nullptr || boost::dynamic_pointer_cast<SinglePrecisionMemoryMappedCube>(cube) != nullptr ||
+           boost::dynamic_pointer_cast<DoublePrecisionMemoryMappedCube>(cube) != nullptr;
+}
+
+/* a view on the samples [firstSample, firstSample + samples) of a cube, used by the sample-parallel mode; several
+   views on disjoint sample ranges are written concurrently, T0 values are only written through one of them */
+class SampleRangeCube : public NPVCube {
+public:
+    SampleRangeCube(const boost::shared_ptr<NPVCube>& cube, const Size firstSample, const Size samples,
+                    const bool writeT0)
+        : cube_(cube), firstSample_(firstSample), samples_(samples), writeT0_(writeT0) {
+        QL_REQUIRE(firstSample + samples <= cube->samples(), "SampleRangeCube: samples " << firstSample << " + "
+                                                                                         << samples << " exceed cube "
+                                                                                         << cube->samples());
+    }
+    Size numIds() const override { return cube_->numIds(); }
+    Size numDates() const override { return cube_->numDates(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return cube_->depth(); }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return cube_->idsAndIndexes(); }
+    const std::vector<QuantLib::Date>& dates() const override { return cube_->dates(); }
+    QuantLib::Date asof() const override { return cube_->asof(); }
+    Real getT0(Size id, Size depth) const override { return cube_->getT0(id, depth); }
+    void setT0(Real value, Size id, Size depth) override {
+        if (writeT0_)
+            cube_->setT0(value, id, depth);
+    }
+    Real get(Size id, Size date, Size sample, Size depth) const override {
+        QL_REQUIRE(sample < samples_, "SampleRangeCube: sample " << sample << " out of range 0..." << samples_ - 1);
+        return cube_->get(id, date, firstSample_ + sample, depth);
+    }
+    void set(Real value, Size id, Size date, Size sample, Size depth) override {
+        QL_REQUIRE(sample < samples_, "SampleRangeCube: sample " << sample << " out of range 0..." << samples_ - 1);
+        cube_->set(value, id, date, firstSample_ + sample, depth);
+    }
+    void remove(Size id) override {
+        for (Size d = 0; d < depth(); ++d)
+            setT0(0.0, id, d);
+        for (Size k = 0; k < samples_; ++k)
+            cube_->remove(id, firstSample_ + k);
+    }
+    void remove(Size id, Size sample) override { cube_->remove(id, firstSample_ + sample); }
+
+private:
+    boost::shared_ptr<NPVCube> cube_;
+    Size firstSample_, samples_;
+    bool writeT0_;
+};
+
+boost::shared_ptr<NPVCube> sampleRange(const boost::shared_ptr<NPVCube>& cube, const Size firstSample,
+                                       const Size samples, const bool writeT0) {
+    if (cube == nullptr)
+        return nullptr;
+    return boost::make_shared<SampleRangeCube>(cube, firstSample, samples, writeT0);
+}
+} // namespace
+
 MultiThreadedValuationEngine::MultiThreadedValuationEngine(
     const Size nThreads, const QuantLib::Date& today, const boost::shared_ptr<ore::data::DateGrid>& dateGrid,
     const Size nSamples, const boost::shared_ptr<ore::data::Loader>& loader,
@@ -82,8 +151,11 @@ MultiThreadedValuationEngine::MultiThreadedValuationEngine(
     // if no cube factory is given, create a default one
 
     if (!cubeFactory_)
-        cubeFactory_ = [](const QuantLib::Date& asof, const std::set<std::string>& ids,
-                          const std::vector<QuantLib::Date>& dates, const Size samples) {
+        cubeFactory_ = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
+                              const std::vector<QuantLib::Date>& dates,
+                              const Size samples) -> boost::shared_ptr<ore::analytics::NPVCube> {
+            if (useProcesses_)
+                return boost::make_shared<ore::analytics::DoublePrecisionMemoryMappedCube>(asof, ids, dates, samples);
             return boost::make_shared<ore::analytics::DoublePrecisionInMemoryCube>(asof, ids, dates, samples);
         };
 
@@ -101,6 +173,99 @@ void MultiThreadedValuationEngine::setAggregationScenarioData(
     aggregationScenarioData_ = aggregationScenarioData;
 }
 
+void MultiThreadedValuationEngine::setDynamicScheduling(const Size chunkSize) { chunkSize_ = chunkSize; }
+
+void MultiThreadedValuationEngine::setShareTodaysMarket(const bool shareTodaysMarket) {
+    QL_REQUIRE(!shareTodaysMarket || !useSpreadedTermStructures_,
+               "MultiThreadedValuationEngine: sharing the T0 market is not supported with spreaded term structures");
+    shareTodaysMarket_ = shareTodaysMarket;
+}
+
+void MultiThreadedValuationEngine::setSampleParallel(const bool sampleParallel) { sampleParallel_ = sampleParallel; }
+
+void MultiThreadedValuationEngine::setReuseT0(const bool reuseT0) { reuseT0_ = reuseT0; }
+
+void MultiThreadedValuationEngine::setIncrementalValuation(const bool incrementalValuation) {
+    incrementalValuation_ = incrementalValuation;
+}
+
+void MultiThreadedValuationEngine::setAnalyticDeltas(const bool analyticDeltas, const bool validate) {
+    analyticDeltas_ = analyticDeltas;
+    validateAnalyticDeltas_ = validate;
+}
+
+void MultiThreadedValuationEngine::setTradeTypeObservationModes(
+    const std::map<std::string, ObservationMode::Mode>& modes) {
+    tradeTypeObservationModes_ = modes;
+}
+
+void MultiThreadedValuationEngine::setCollectTimings(const bool collectTimings) { collectTimings_ = collectTimings; }
+
+void MultiThreadedValuationEngine::setThreadPool(const boost::shared_ptr<ThreadPool>& threadPool) {
+    threadPool_ = threadPool;
+}
+
+void MultiThreadedValuationEngine::setThreadPlacement(const ThreadPlacement threadPlacement) {
+    threadPlacement_ = threadPlacement;
+}
+
+void MultiThreadedValuationEngine::setPricingCostProfile(
+    const boost::shared_ptr<PricingCostProfile>& pricingCostProfile) {
+    pricingCostProfile_ = pricingCostProfile;
+}
+
+void MultiThreadedValuationEngine::setUseProcesses(const bool useProcesses) {
+#if defined(_WIN32) || defined(_WIN64)
+    QL_REQUIRE(!useProcesses, "MultiThreadedValuationEngine: process based valuation is not supported on Windows");
+#endif
+    useProcesses_ = useProcesses;
+}
+
+void MultiThreadedValuationEngine::runProcesses(const std::function<int(int)>& job, std::vector<int>& returnCodes) {
+#if defined(_WIN32) || defined(_WIN64)
+    QL_FAIL("MultiThreadedValuationEngine: process based valuation is not supported on Windows");
+#else
+    std::vector<pid_t> pids(returnCodes.size(), 0);
+    for (Size i = 1; i < returnCodes.size(); ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // child process: tag the log messages with the pid, run the job and exit without unwinding the parent's
+            // state (atexit handlers, static destructors) which the child shares copy-on-write
+            ore::data::Log::instance().setPid(getpid());
+            int rc = 1;
+            try {
+                rc = job(static_cast<int>(i));
+            } catch (...) {
+            }
+            _exit(rc);
+        }
+        if (pid < 0) {
+            ALOG(ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "",
+                                                                 "fork() failed for process " + std::to_string(i)));
+            returnCodes[i] = 1;
+        } else {
+            LOG("Started process " << i << " with pid " << pid);
+            pids[i] = pid;
+        }
+    }
+
+    // the first part is processed in this process, while the child processes are running
+
+    returnCodes[0] = job(0);
+
+    for (Size i = 1; i < returnCodes.size(); ++i) {
+        if (pids[i] <= 0)
+            continue;
+        int status;
+        if (waitpid(pids[i], &status, 0) != pids[i])
+            returnCodes[i] = 1;
+        else
+            returnCodes[i] = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+        LOG("Process " << i << " (pid " << pids[i] << ") finished with return code " << returnCodes[i]);
+    }
+#endif
+}
+
 void MultiThreadedValuationEngine::buildCube(
     const boost::shared_ptr<ore::data::Portfolio>& portfolio,
     const std::function<std::vector<boost::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
@@ -139,26 +304,47 @@ void MultiThreadedValuationEngine::buildCube(
                             << t->npvCurrency());
     }
 
-    // split portfolio into nThreads parts such that each part has an approximately similar total avg pricing time
+    /* split portfolio into nThreads parts such that each part has an approximately similar total avg pricing time,
+       or - if dynamic scheduling is enabled - into chunks of at most chunkSize_ trades which are processed by the
+       worker threads in the order of decreasing avg pricing time; in the sample-parallel mode there is only one
+       part containing all trades, which is processed by all threads for disjoint sample ranges */
+
+    bool dynamicScheduling = chunkSize_ > 0;
 
-    Size eff_nThreads = std::min(portfolio->size(), nThreads_);
+    Size nParts = sampleParallel_      ? 1
+                  : dynamicScheduling ? (portfolio->size() + chunkSize_ - 1) / chunkSize_
+                                      : std::min(portfolio->size(), nThreads_);
+    Size eff_nThreads = std::min(sampleParallel_ ? nSamples_ : nParts, nThreads_);
 
     LOG("Splitting portfolio.");
 
     LOG("portfolio size = " << portfolio->size());
     LOG("nThreads       = " << nThreads_);
     LOG("eff nThreads   = " << eff_nThreads);
+    LOG("chunk size     = " << chunkSize_ << (dynamicScheduling ? " (dynamic scheduling)" : " (static split)"));
+    LOG("parts          = " << nParts);
 
     QL_REQUIRE(eff_nThreads > 0, "effective threads are zero, this is not allowed.");
+    QL_REQUIRE(!useProcesses_ || !dynamicScheduling,
+               "MultiThreadedValuationEngine: dynamic scheduling is not supported with process based valuation");
+    QL_REQUIRE(!sampleParallel_ || (!dynamicScheduling && !useProcesses_),
+               "MultiThreadedValuationEngine: the sample-parallel mode can not be combined with dynamic scheduling "
+               "or process based valuation");
 
     std::vector<boost::shared_ptr<ore::data::Portfolio>> portfolios;
-    for (Size i = 0; i < eff_nThreads; ++i)
+    for (Size i = 0; i < nParts; ++i)
         portfolios.push_back(boost::make_shared<ore::data::Portfolio>());
 
     double totalAvgPricingTime = 0.0;
     std::vector<std::pair<std::string, double>> timings;
+    Size nProfileTimings = 0;
     for (auto const& [tid, t] : portfolio->trades()) {
-        if (t->getNumberOfPricings() != 0) {
+        Real profileTime = pricingCostProfile_ ? pricingCostProfile_->cost(tid, t->tradeType()) : Null<Real>();
+        if (profileTime != Null<Real>()) {
+            timings.push_back(std::make_pair(tid, profileTime));
+            totalAvgPricingTime += profileTime;
+            ++nProfileTimings;
+        } else if (t->getNumberOfPricings() != 0) {
             double dt = t->getCumulativePricingTime() / static_cast<double>(t->getNumberOfPricings());
             timings.push_back(std::make_pair(tid, dt));
             totalAvgPricingTime += dt;
@@ -168,6 +354,10 @@ void MultiThreadedValuationEngine::buildCube(
         }
     }
 
+    if (pricingCostProfile_)
+        LOG("took avg pricing time for " << nProfileTimings << " out of " << timings.size()
+                                         << " trades from pricing cost profile");
+
     std::sort(timings.begin(), timings.end(),
               [](const std::pair<std::string, double>& p1, const std::pair<std::string, double> p2) {
                   if (p1.second == p2.second)
@@ -177,25 +367,30 @@ void MultiThreadedValuationEngine::buildCube(
               });
 
     std::vector<double> portfolioTotalAvgPricingTime(portfolios.size());
-    Size portfolioIndex = 0;
+    Size portfolioIndex = 0, tradeIndex = 0;
     for (auto const& t : timings) {
+        if (dynamicScheduling)
+            portfolioIndex = tradeIndex++ / chunkSize_;
         portfolios[portfolioIndex]->add(portfolio->get(t.first));
         portfolioTotalAvgPricingTime[portfolioIndex] += t.second;
-        if (++portfolioIndex >= eff_nThreads)
+        if (!dynamicScheduling && ++portfolioIndex >= nParts)
             portfolioIndex = 0;
     }
 
-    // output the portfolios into strings so that the worker threads can load them from there
+    /* output the portfolios into xml documents so that the worker threads can load them from there, the trades are
+       read from the document nodes directly, i.e. without writing and parsing the xml text in between */
 
-    std::vector<std::string> portfoliosAsString;
+    std::vector<boost::shared_ptr<ore::data::XMLDocument>> portfolioDocs;
     for (auto const& p : portfolios) {
-        portfoliosAsString.emplace_back(p->toXMLString());
+        auto doc = boost::make_shared<ore::data::XMLDocument>();
+        doc->appendNode(p->toXML(*doc));
+        portfolioDocs.push_back(doc);
     }
 
     // log info on the portfolio split
 
     LOG("Total avg pricing time     : " << totalAvgPricingTime / 1E6 << " ms");
-    for (Size i = 0; i < eff_nThreads; ++i) {
+    for (Size i = 0; i < nParts; ++i) {
         LOG("Portfolio #" << i << " number of trades       : " << portfolios[i]->size());
         LOG("Portfolio #" << i << " total avg pricing time : " << portfolioTotalAvgPricingTime[i] / 1E6 << " ms");
     }
@@ -213,24 +408,88 @@ void MultiThreadedValuationEngine::buildCube(
         DLOG("generator for thread " << (i + 1) << " cloned.");
     }
 
-    // build loaders for each thread as clones of the original one
+    // in the sample-parallel mode thread i processes the samples [firstSample[i], firstSample[i+1])
+
+    std::vector<Size> firstSample(eff_nThreads + 1, 0);
+    if (sampleParallel_) {
+        for (Size i = 0; i <= eff_nThreads; ++i)
+            firstSample[i] = i * nSamples_ / eff_nThreads;
+        for (Size i = 0; i < eff_nThreads; ++i) {
+            boost::static_pointer_cast<ore::analytics::ClonedScenarioGenerator>(scenarioGenerators[i])
+                ->setFirstSample(firstSample[i]);
+            LOG("Thread " << i << " processes samples " << firstSample[i] << " to " << firstSample[i + 1] - 1);
+        }
+    }
+
+    // in the sample-parallel mode each thread writes to its own sample range of the aggregation scenario data if the
+    // latter can be written concurrently, otherwise to its own aggregation scenario data, merged after the run
+
+    std::vector<boost::shared_ptr<AggregationScenarioData>> threadAggregationScenarioData(eff_nThreads);
+    bool mergeAggregationScenarioData = false;
+    if (sampleParallel_ && aggregationScenarioData_ != nullptr) {
+        bool concurrentWrites =
+            boost::dynamic_pointer_cast<InMemoryAggregationScenarioData>(aggregationScenarioData_) != nullptr ||
+            boost::dynamic_pointer_cast<SinglePrecisionInMemoryAggregationScenarioData>(aggregationScenarioData_) !=
+                nullptr;
+        for (Size i = 0; i < eff_nThreads; ++i) {
+            if (concurrentWrites)
+                threadAggregationScenarioData[i] = boost::make_shared<AggregationScenarioDataSampleRange>(
+                    aggregationScenarioData_, firstSample[i], firstSample[i + 1] - firstSample[i]);
+            else
+                threadAggregationScenarioData[i] = boost::make_shared<InMemoryAggregationScenarioData>(
+                    aggregationScenarioData_->dimDates(), firstSample[i + 1] - firstSample[i]);
+        }
+        mergeAggregationScenarioData = !concurrentWrites;
+    } else {
+        threadAggregationScenarioData[0] = aggregationScenarioData_;
+    }
+
+    // build loaders for each thread as clones of the original one, the market data are cloned on their first request,
+    // the loaders are not needed if the T0 market is shared
 
-    LOG("Cloning loaders for " << eff_nThreads << " threads...");
-    std::vector<boost::shared_ptr<ore::data::ClonedLoader>> loaders;
-    for (Size i = 0; i < eff_nThreads; ++i)
-        loaders.push_back(boost::make_shared<ore::data::ClonedLoader>(today_, loader_));
+    std::vector<boost::shared_ptr<ore::data::LazyClonedLoader>> loaders;
+    if (shareTodaysMarket_ || useProcesses_) {
+        LOG("T0 market is shared between " << eff_nThreads << " workers, no loaders are cloned.");
+    } else {
+        LOG("Cloning loaders for " << eff_nThreads << " threads...");
+        for (Size i = 0; i < eff_nThreads; ++i)
+            loaders.push_back(boost::make_shared<ore::data::LazyClonedLoader>(today_, loader_));
+    }
 
-    // build nThreads mini-cubes to which each thread writes its results
+    // report the placement of the workers on the NUMA nodes
 
-    LOG("Build " << eff_nThreads << " mini result cubes...");
+    if (threadPlacement_ != ThreadPlacement::None) {
+        const NumaTopology& topology = NumaTopology::instance();
+        LOG("Thread placement " << threadPlacement_ << " on " << topology.nodes() << " NUMA node(s)");
+        for (Size n = 0; n < topology.nodes(); ++n)
+            LOG("NUMA node #" << n << ": " << topology.cpus(n).size() << " cpus");
+    }
+
+    /* build one mini-cube per part, each part is processed by exactly one thread, so no locking is required; if the
+       workers are pinned, the cubes are created by the workers, so that they are allocated on the node of the worker
+       writing them */
+
+    bool deferCubes = threadPlacement_ != ThreadPlacement::None && !sampleParallel_ && !useProcesses_;
     miniCubes_.clear();
     miniNettingSetCubes_.clear();
     miniCptyCubes_.clear();
-    for (Size i = 0; i < eff_nThreads; ++i) {
-        miniCubes_.push_back(cubeFactory_(today_, portfolios[i]->ids(), dateGrid_->dates(), nSamples_));
-        miniNettingSetCubes_.push_back(nettingSetCubeFactory_(today_, dateGrid_->dates(), nSamples_));
-        miniCptyCubes_.push_back(
-            cptyCubeFactory_(today_, portfolios[i]->counterparties(), dateGrid_->dates(), nSamples_));
+    if (deferCubes) {
+        LOG("The " << nParts << " mini result cubes are built by the worker threads");
+        miniCubes_.resize(nParts);
+        miniNettingSetCubes_.resize(nParts);
+        miniCptyCubes_.resize(nParts);
+    } else {
+        LOG("Build " << nParts << " mini result cubes...");
+        for (Size i = 0; i < nParts; ++i) {
+            miniCubes_.push_back(cubeFactory_(today_, portfolios[i]->ids(), dateGrid_->dates(), nSamples_));
+            miniNettingSetCubes_.push_back(nettingSetCubeFactory_(today_, dateGrid_->dates(), nSamples_));
+            miniCptyCubes_.push_back(
+                cptyCubeFactory_(today_, portfolios[i]->counterparties(), dateGrid_->dates(), nSamples_));
+            QL_REQUIRE(!useProcesses_ || (isSharedMemoryCube(miniCubes_.back()) &&
+                                          isSharedMemoryCube(miniNettingSetCubes_.back()) &&
+                                          isSharedMemoryCube(miniCptyCubes_.back())),
+                       "MultiThreadedValuationEngine: process based valuation requires MemoryMappedCube result cubes");
+        }
     }
 
     // build progress indicator consolidating the results from the threads
@@ -238,147 +497,273 @@ void MultiThreadedValuationEngine::buildCube(
     auto progressIndicator =
         boost::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators());
 
-    // create the thread pool with eff_nThreads and queue size = eff_nThreads as well
-
-    // LOG("Create thread pool with " << eff_nThreads);
-    // ctpl::thread_pool threadPool(eff_nThreads);
-
-    // create the jobs and push them to the pool
+    // create the jobs, these are pushed to the shared thread pool if one is set or run on dedicated threads
 
     using resultType = int;
-    std::vector<std::future<resultType>> results(eff_nThreads);
-
-    std::vector<std::thread> jobs; // not needed if thread pool is used
 
     // pricing stats accumulated in worker threads
     std::vector<std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>> workerPricingStats(
         eff_nThreads);
 
+    // timings per worker, populated if collectTimings_ is true
+    std::vector<ValuationEngineTimings> workerTimings(eff_nThreads);
+
     // get obs mode of main thread, so that we can set this mode in the worker threads below
     ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
 
-    for (Size i = 0; i < eff_nThreads; ++i) {
-
-        auto job = [this, obsMode, dryRun, &calculators, &cptyCalculators, mporStickyDate, &portfoliosAsString,
-                    &scenarioGenerators, &loaders, &workerPricingStats, &progressIndicator](int id) -> resultType {
-            // set thread local singletons
-
-            QuantLib::Settings::instance().evaluationDate() = today_;
-            ore::analytics::ObservationMode::instance().setMode(obsMode);
-
+    // the queue of parts shared by the worker threads if dynamic scheduling is enabled
+    std::atomic<Size> nextPart(0);
+
+    // serialises the sim market builds against the T0 market if the latter is shared
+    std::mutex initMarketMutex;
+
+    /* in the sample-parallel mode with T0 reuse the first thread publishes the availability of the T0 values (or its
+       failure) to the other threads; since the jobs are started or queued in the order of their ids, the first thread
+       is always running while the others wait, so this can not deadlock on a thread pool */
+    bool reuseT0 = sampleParallel_ && reuseT0_ && eff_nThreads > 1;
+    std::promise<void> t0Promise;
+    std::shared_future<void> t0Future = t0Promise.get_future().share();
+    std::once_flag t0Once;
+    auto releaseT0 = [&t0Promise, &t0Once](const std::exception_ptr& e) {
+        std::call_once(t0Once, [&t0Promise, &e]() {
+            if (e)
+                t0Promise.set_exception(e);
+            else
+                t0Promise.set_value();
+        });
+    };
+
+    auto job = [this, obsMode, dryRun, dynamicScheduling, &calculators, &cptyCalculators, mporStickyDate,
+                &portfolioDocs, &scenarioGenerators, &loaders, &workerPricingStats, &workerTimings, &progressIndicator,
+                &nextPart, &initMarket, &initMarketMutex, &firstSample, &threadAggregationScenarioData, reuseT0,
+                &t0Future, &releaseT0, deferCubes, &portfolios, eff_nThreads](int id) -> resultType {
+        // set thread local singletons
+
+        QuantLib::Settings::instance().evaluationDate() = today_;
+        ore::analytics::ObservationMode::instance().setMode(obsMode);
+
+        // pin the thread before it allocates its state
+
+        Size node = pinWorkerThread(threadPlacement_, id, eff_nThreads);
+
+        if (node == Null<Size>())
             LOG("Start thread " << id);
+        else
+            LOG("Start thread " << id << " on NUMA node #" << node);
+
+        int rc;
+
+        try {
+
+            /* build todays market using cloned market data or use the shared one from the main thread, a worker process
+               has its own copy of the latter, so no locking is required in this case */
+
+            boost::shared_ptr<ore::data::Market> threadInitMarket;
+            std::unique_lock<std::mutex> initMarketLock(initMarketMutex, std::defer_lock);
+            if (shareTodaysMarket_ || useProcesses_) {
+                threadInitMarket = initMarket;
+                if (!useProcesses_)
+                    initMarketLock.lock();
+            } else {
+                threadInitMarket = boost::make_shared<ore::data::TodaysMarket>(
+                    today_, todaysMarketParams_, loaders[id], curveConfigs_, true, true, true, referenceData_,
+                    false, iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
+            }
 
-            int rc;
+            // build sim market
 
-            try {
+            boost::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket =
+                boost::make_shared<ore::analytics::ScenarioSimMarketPlus>(
+                    threadInitMarket, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
+                    useSpreadedTermStructures_, cacheSimData_, false, iborFallbackConfig_,
+                    handlePseudoCurrenciesSimMarket_);
 
-                // build todays market using cloned market data
+            if (initMarketLock.owns_lock())
+                initMarketLock.unlock();
 
-                boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<ore::data::TodaysMarket>(
-                    today_, todaysMarketParams_, loaders[id], curveConfigs_, true, true, true, referenceData_, false,
-                    iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
+            /* set aggregation scenario data, but only in one of the sim markets, that's sufficient to populate it,
+               unless we run in the sample-parallel mode, where each thread populates its own sample range */
 
-                // build sim market
+            if (threadAggregationScenarioData[id] != nullptr)
+                simMarket->aggregationScenarioData() = threadAggregationScenarioData[id];
 
-                boost::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket =
-                    boost::make_shared<ore::analytics::ScenarioSimMarketPlus>(
-                        initMarket, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
-                        useSpreadedTermStructures_, cacheSimData_, false, iborFallbackConfig_,
-                        handlePseudoCurrenciesSimMarket_);
+            // link scenario generator to sim market
 
-                // set aggregation scenario data, but only in one of the sim markets, that's sufficient to populate it
+            simMarket->scenarioGenerator() = scenarioGenerators[id];
 
-                if (id == 0 && aggregationScenarioData_ != nullptr)
-                    simMarket->aggregationScenarioData() = aggregationScenarioData_;
+            // set scenario filter
 
-                // link scenario generator to sim market
+            if (scenarioFilter_)
+                simMarket->filter() = scenarioFilter_;
 
-                simMarket->scenarioGenerator() = scenarioGenerators[id];
+            // process the part with index id (static split) or pull parts from the queue (dynamic scheduling)
 
-                // set scenario filter
+            Size part = sampleParallel_ ? 0 : (dynamicScheduling ? nextPart++ : id);
+            while (part < portfolioDocs.size()) {
 
-                if (scenarioFilter_)
-                    simMarket->filter() = scenarioFilter_;
+                DLOG("Thread " << id << " processes part " << part);
 
                 // build portfolio against sim market
 
                 auto portfolio = boost::make_shared<ore::data::Portfolio>();
-                portfolio->fromXMLString(portfoliosAsString[id]);
+                portfolio->fromXML(portfolioDocs[part]->getFirstNode("Portfolio"));
                 auto engineFactory = boost::make_shared<ore::data::EngineFactory>(
                     engineData_, simMarket, std::map<ore::data::MarketContext, string>(), referenceData_,
                     iborFallbackConfig_);
 
+                simMarket->setRecordRequests(incrementalValuation_);
                 portfolio->build(engineFactory, context_, true);
+                simMarket->setRecordRequests(false);
 
                 // build valuation engine
 
-                auto valEngine = boost::make_shared<ore::analytics::ValuationEngine>(today_, dateGrid_, simMarket,
-                                                                                     engineFactory->modelBuilders());
-                valEngine->registerProgressIndicator(progressIndicator);
-
-                // build mini-cube
-
-                valEngine->buildCube(portfolio, miniCubes_[id], calculators(), mporStickyDate, miniNettingSetCubes_[id],
-                                     miniCptyCubes_[id],
-                                     cptyCalculators ? cptyCalculators()
-                                                     : std::vector<boost::shared_ptr<CounterpartyCalculator>>(),
-                                     dryRun);
+                auto valEngine = boost::make_shared<ore::analytics::ValuationEngine>(
+                    today_, dateGrid_, simMarket, engineFactory->modelBuilders());
+                valEngine->setIncrementalValuation(incrementalValuation_);
+                valEngine->setTradeTypeObservationModes(tradeTypeObservationModes_);
+                valEngine->setAnalyticDeltas(analyticDeltas_, validateAnalyticDeltas_);
+                valEngine->setCollectTimings(collectTimings_);
+                if (reuseT0 && id == 0)
+                    valEngine->setT0Callback([&releaseT0]() { releaseT0(nullptr); });
+                else if (reuseT0)
+                    valEngine->setReuseT0([&t0Future]() { t0Future.get(); });
+                // progress is reported from the calling process only, if the workers are processes
+                if (!useProcesses_ || id == 0)
+                    valEngine->registerProgressIndicator(progressIndicator);
+
+                // build mini-cube, the scenario generator is rewound since it may have served a previous part
+
+                if (deferCubes) {
+                    miniCubes_[part] = cubeFactory_(today_, portfolios[part]->ids(), dateGrid_->dates(), nSamples_);
+                    miniNettingSetCubes_[part] = nettingSetCubeFactory_(today_, dateGrid_->dates(), nSamples_);
+                    miniCptyCubes_[part] =
+                        cptyCubeFactory_(today_, portfolios[part]->counterparties(), dateGrid_->dates(), nSamples_);
+                }
+                scenarioGenerators[id]->reset();
+                if (sampleParallel_) {
+                    Size first = firstSample[id], n = firstSample[id + 1] - firstSample[id];
+                    valEngine->buildCube(portfolio, sampleRange(miniCubes_[part], first, n, id == 0), calculators(),
+                                         mporStickyDate, sampleRange(miniNettingSetCubes_[part], first, n, id == 0),
+                                         sampleRange(miniCptyCubes_[part], first, n, id == 0),
+                                         cptyCalculators
+                                             ? cptyCalculators()
+                                             : std::vector<boost::shared_ptr<CounterpartyCalculator>>(),
+                                         dryRun);
+                } else {
+                    valEngine->buildCube(portfolio, miniCubes_[part], calculators(), mporStickyDate,
+                                         miniNettingSetCubes_[part], miniCptyCubes_[part],
+                                         cptyCalculators
+                                             ? cptyCalculators()
+                                             : std::vector<boost::shared_ptr<CounterpartyCalculator>>(),
+                                         dryRun);
+                }
 
                 // set pricing stats for val engine run
 
                 for (auto const& [tid, t] : portfolio->trades())
                     workerPricingStats[id][tid] =
                         std::make_pair(t->getNumberOfPricings(), t->getCumulativePricingTime());
+                workerTimings[id].add(valEngine->timings());
 
-                // return code 0 = ok
+                if (!dynamicScheduling)
+                    break;
 
-                LOG("Thread " << id << " successfully finished.");
+                // the aggregation scenario data is fully populated by the first part processed in this thread
 
-                rc = 0;
+                simMarket->aggregationScenarioData() = nullptr;
 
-            } catch (const std::exception& e) {
+                part = nextPart++;
+            }
 
-                // log error and return code 1 = not ok
+            // return code 0 = ok
 
-                ALOG(ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "", e.what()));
-                rc = 1;
-            }
+            LOG("Thread " << id << " successfully finished.");
 
-            // exit
+            rc = 0;
 
-            return rc;
-        };
+        } catch (const std::exception& e) {
 
-        // results[i] = threadPool.push(job);
+            // log error and return code 1 = not ok
 
-        // not needed if thread pool is used
-        std::packaged_task<resultType(int)> task(job);
-        results[i] = task.get_future();
-        std::thread thread(std::move(task), i);
-        jobs.emplace_back(std::move(thread));
-    }
+            ALOG(ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "", e.what()));
+            rc = 1;
+        }
 
-    // check return codes from jobs
+        // the first thread releases the other threads in any case, by an exception if it failed before its T0 values
+        // were written
 
-    // not needed if thread pool is used
-    for (auto& t : jobs)
-        t.join();
+        if (reuseT0 && id == 0) {
+            releaseT0(rc == 0 ? std::exception_ptr()
+                              : std::make_exception_ptr(std::runtime_error("T0 valuation failed in thread 0")));
+        }
 
-    for (Size i = 0; i < results.size(); ++i) {
-        results[i].wait();
-    }
+        // exit
 
-    for (Size i = 0; i < results.size(); ++i) {
-        QL_REQUIRE(results[i].valid(), "internal error: did not get a valid result");
-        int rc = results[i].get();
-        QL_REQUIRE(rc == 0, "error: thread " << i << " exited with return code " << rc
-                                             << ". Check for structured errors from 'MultiThreaded Valuation Engine'.");
+        return rc;
+    };
+
+    // run the jobs in separate processes or in threads and collect the return codes
+
+    std::vector<resultType> returnCodes(eff_nThreads);
+
+    if (useProcesses_) {
+        runProcesses(job, returnCodes);
+    } else {
+        std::vector<std::future<resultType>> results(eff_nThreads);
+        std::vector<std::thread> jobs; // not needed if thread pool is used
+
+        for (Size i = 0; i < eff_nThreads; ++i) {
+            if (threadPool_) {
+                results[i] = threadPool_->push([&job, i]() { return job(static_cast<int>(i)); });
+            } else {
+                std::packaged_task<resultType(int)> task(job);
+                results[i] = task.get_future();
+                std::thread thread(std::move(task), i);
+                jobs.emplace_back(std::move(thread));
+            }
+        }
+
+        for (auto& t : jobs)
+            t.join();
+
+        for (Size i = 0; i < results.size(); ++i) {
+            results[i].wait();
+        }
+
+        for (Size i = 0; i < results.size(); ++i) {
+            QL_REQUIRE(results[i].valid(), "internal error: did not get a valid result");
+            returnCodes[i] = results[i].get();
+        }
     }
 
-    // stop the thread pool, wait for unfinished jobs
+    // report the final progress before further output is written
+    progressIndicator->publish();
 
-    // LOG("Stop thread pool");
-    // threadPool.stop(true);
+    // check return codes from jobs
+
+    for (Size i = 0; i < returnCodes.size(); ++i) {
+        QL_REQUIRE(returnCodes[i] == 0, "error: " << (useProcesses_ ? "process " : "thread ") << i
+                                                  << " exited with return code " << returnCodes[i]
+                                                  << ". Check for structured errors from 'MultiThreaded Valuation "
+                                                     "Engine'.");
+    }
+
+    // merge the aggregation scenario data from the threads in the sample-parallel mode
+
+    if (mergeAggregationScenarioData) {
+        LOG("Merge aggregation scenario data from " << eff_nThreads << " threads.");
+        for (Size i = 0; i < eff_nThreads; ++i) {
+            auto const& asd = threadAggregationScenarioData[i];
+            for (auto const& [type, qualifier] : asd->keys()) {
+                for (Size d = 0; d < asd->dimDates(); ++d) {
+                    for (Size k = 0; k < asd->dimSamples(); ++k) {
+                        aggregationScenarioData_->set(d, firstSample[i] + k, asd->get(d, k, type, qualifier), type,
+                                                      qualifier);
+                    }
+                }
+            }
+        }
+    }
 
     // set updated pricing stats in original portfolio
 
@@ -398,6 +783,30 @@ void MultiThreadedValuationEngine::buildCube(
         t->resetPricingStats(n, d);
     }
 
+    // update the pricing cost profile with the stats from the workers, i.e. without the T0 pricing above
+
+    if (pricingCostProfile_) {
+        for (auto const& [tid, t] : portfolio->trades()) {
+            std::size_t n = 0;
+            boost::timer::nanosecond_type d = 0;
+            for (auto const& w : workerPricingStats) {
+                if (auto p = w.find(tid); p != w.end()) {
+                    n += p->second.first;
+                    d += p->second.second;
+                }
+            }
+            pricingCostProfile_->update(tid, t->tradeType(), n, static_cast<double>(d));
+        }
+    }
+
+    // sum up the timings from the workers
+
+    timings_ = ValuationEngineTimings();
+    if (collectTimings_) {
+        for (auto const& w : workerTimings)
+            timings_.add(w);
+    }
+
     // log timings and return the result mini-cubes
 
     LOG("MultiThreadedValuationEngine::buildCube() successfully finished, timings: "
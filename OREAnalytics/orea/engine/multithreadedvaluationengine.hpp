@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <orea/engine/pricingcostprofile.hpp>
+#include <orea/engine/threadplacement.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/engine/valuationengine.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
@@ -70,6 +73,65 @@ public:
     // can be optionally called to set the agg scen data (which is done in the ssm for single-threaded runs)
     void setAggregationScenarioData(const boost::shared_ptr<AggregationScenarioData>& aggregationScenarioData);
 
+    /* can be optionally called to enable dynamic scheduling: the portfolio is split into chunks of at most chunkSize
+       trades that are pulled from a shared queue by the worker threads, so that idle threads pick up remaining work
+       from slower ones; chunkSize = 0 restores the default static split into one sub-portfolio per thread */
+    void setDynamicScheduling(const QuantLib::Size chunkSize);
+
+    /* can be optionally called to build the T0 market only once: the worker threads then build their sim markets
+       from this shared market instead of bootstrapping their own copy from a cloned loader; the sim markets are
+       built one at a time, after that non-simulated market objects are only read; this is not supported in
+       combination with spreaded term structures, which keep the T0 curves alive as part of the sim market */
+    void setShareTodaysMarket(const bool shareTodaysMarket);
+
+    /* can be optionally called to run the workers in separate processes instead of threads (not supported on
+       Windows): the first part is processed in the calling process, for the other parts child processes are forked,
+       which inherit the T0 market from the calling process and write directly into the result cubes; this requires
+       all result cubes to be MemoryMappedCube instances, the default cube factory creates these in this mode;
+       pricing stats from the child processes are not propagated back into the portfolio */
+    void setUseProcesses(const bool useProcesses);
+
+    /* can be optionally called to parallelise over samples instead of trades: each thread builds the full portfolio
+       and processes a disjoint range of samples using a clone of the scenario generator that skips ahead to the first
+       sample of its range; all threads write into a single result cube, i.e. outputCubes() returns one cube only */
+    void setSampleParallel(const bool sampleParallel);
+
+    /* can be optionally called in the sample-parallel mode to compute the T0 values in the first thread only: the
+       other threads skip their T0 valuation and wait until the first thread has written the T0 values into the result
+       cube, see ValuationEngine::setReuseT0() for the requirements on the calculators */
+    void setReuseT0(const bool reuseT0);
+
+    //! can be optionally called to enable incremental valuation in the workers, see ValuationEngine
+    void setIncrementalValuation(const bool incrementalValuation);
+
+    /*! can be optionally called to enable the analytic deltas in the workers, see ValuationEngine; the engine data
+        must set the global parameter ZeroRateDependencies for the engines to provide the dependencies */
+    void setAnalyticDeltas(const bool analyticDeltas, const bool validate = false);
+
+    //! can be optionally called to override the observation mode by trade type in the workers, see ValuationEngine
+    void setTradeTypeObservationModes(const std::map<std::string, ObservationMode::Mode>& modes);
+
+    /* can be optionally called to collect timings in the workers, see ValuationEngine; the timings of all workers are
+       summed up in timings(), timings from worker processes are not propagated back to the calling process */
+    void setCollectTimings(const bool collectTimings);
+
+    /* can be optionally called to balance the portfolio split by the average pricing times from the given profile,
+       e.g. read from a previous run, instead of the time of the single T0 pricing in this process; trades neither
+       contained in the profile nor estimated by their trade type fall back to the latter; after buildCube() the profile
+       is updated with the pricing stats from the worker threads, so that it can be persisted for the next run */
+    void setPricingCostProfile(const boost::shared_ptr<PricingCostProfile>& pricingCostProfile);
+
+    /* can be optionally called to run the worker jobs on a thread pool shared with other engines instead of on
+       dedicated threads, the jobs are queued if the pool has less than nThreads threads */
+    void setThreadPool(const boost::shared_ptr<ThreadPool>& threadPool);
+
+    /* can be optionally called to pin the workers to the NUMA nodes of the machine, see ThreadPlacement; a worker is
+       pinned before it builds its state (cloned loader, T0 market, sim market, portfolio), so that this state is
+       allocated on the node of the worker; for the same reason the mini-cubes are created by the worker processing
+       them instead of the calling thread, except in the sample-parallel mode and for process based valuation, where
+       the result cubes are created upfront; the cube factories must therefore be safe to call concurrently */
+    void setThreadPlacement(const ThreadPlacement threadPlacement);
+
     /* analoguous to buildCube() in the single-threaded engine, results are retrieved using below constructors
        if no cptyCalculators is given a function returning an empty vector of calculators will be returned */
     void
@@ -79,7 +141,8 @@ public:
                   cptyCalculators = {},
               bool mporStickyDate = true, bool dryRun = false);
 
-    // result output cubes (mini-cubes, one per thread)
+    /* result output cubes (mini-cubes, one per thread or one per chunk if dynamic scheduling is enabled, a single
+       cube in the sample-parallel mode) */
     std::vector<boost::shared_ptr<ore::analytics::NPVCube>> outputCubes() const { return miniCubes_; }
 
     // result netting cubes (might be null, if nettingSetCubeFactory is returning null)
@@ -90,7 +153,13 @@ public:
     // result cpty cubes (might be null, if cptyCubeFactory is returning null)
     std::vector<boost::shared_ptr<ore::analytics::NPVCube>> outputCptyCubes() const { return miniCptyCubes_; }
 
+    // timings summed up over all workers, only populated if setCollectTimings() was called
+    const ValuationEngineTimings& timings() const { return timings_; }
+
 private:
+    // runs job(i) for i = 1, ... in forked child processes and job(0) in the calling process
+    void runProcesses(const std::function<int(int)>& job, std::vector<int>& returnCodes);
+
     QuantLib::Size nThreads_;
     QuantLib::Date today_;
     boost::shared_ptr<ore::data::DateGrid> dateGrid_;
@@ -119,6 +188,19 @@ private:
                                                              const std::vector<QuantLib::Date>&, const QuantLib::Size)>
         cptyCubeFactory_;
     std::string context_;
+    QuantLib::Size chunkSize_ = 0;
+    bool shareTodaysMarket_ = false;
+    bool useProcesses_ = false;
+    bool sampleParallel_ = false;
+    bool reuseT0_ = false;
+    bool incrementalValuation_ = false;
+    std::map<std::string, ObservationMode::Mode> tradeTypeObservationModes_;
+    bool analyticDeltas_ = false, validateAnalyticDeltas_ = false;
+    bool collectTimings_ = false;
+    ValuationEngineTimings timings_;
+    boost::shared_ptr<PricingCostProfile> pricingCostProfile_;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    ThreadPlacement threadPlacement_ = ThreadPlacement::None;
 
     boost::shared_ptr<AggregationScenarioData> aggregationScenarioData_;
 
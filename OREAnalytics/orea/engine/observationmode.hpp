@@ -61,8 +61,70 @@ public:
         }
     }
 
+    /*! Set the mode from a string as above, "Auto" selects \p autoMode. The analytics pass the cheapest correct mode
+        for their kind of run: Disable if all risk factors move in each scenario (exposure simulation), None if few
+        factors move per scenario, so that the lazy instruments of unaffected trades keep their results (pricing,
+        sensitivity, stress). */
+    void setMode(const std::string& s, const Mode autoMode) {
+        if (s == "Auto")
+            mode_ = autoMode;
+        else
+            setMode(s);
+    }
+
 private:
     Mode mode_;
 };
+
+//! Scoped batch of QuantLib observer notifications
+/*!
+  If active, the notifications are deferred from construction until flush() or destruction, so that each observer is
+  notified once only instead of once per changed observable. This is used for the market updates of the sim market
+  in the observation modes None and Unregister, the modes Defer and Disable control the notifications themselves.
+
+  If the updates are disabled or deferred already on construction, the batch is not active.
+
+  Notice that lazy objects must not be queried for results before the batch is flushed, since they are not notified
+  until then.
+  \ingroup utilities
+ */
+class ObservableNotificationBatch {
+public:
+    //! start a batch if active is true
+    explicit ObservableNotificationBatch(const bool active = true)
+        : active_(active && QuantLib::ObservableSettings::instance().updatesEnabled()) {
+        if (active_)
+            QuantLib::ObservableSettings::instance().disableUpdates(true);
+    }
+    ~ObservableNotificationBatch() {
+        try {
+            flush();
+        } catch (...) {
+            // errors during the notification of observers are not propagated from the destructor
+        }
+    }
+    ObservableNotificationBatch(const ObservableNotificationBatch&) = delete;
+    ObservableNotificationBatch& operator=(const ObservableNotificationBatch&) = delete;
+
+    //! enable the updates, which notifies the observers of all deferred notifications
+    void flush() {
+        if (active_) {
+            active_ = false;
+            QuantLib::ObservableSettings::instance().enableUpdates();
+        }
+    }
+
+    //! true if the notifications are deferred by this batch
+    bool active() const { return active_; }
+
+    //! true if batches should be used for the market updates in the current ObservationMode
+    static bool useForMarketUpdates() {
+        ObservationMode::Mode om = ObservationMode::instance().mode();
+        return om == ObservationMode::Mode::None || om == ObservationMode::Mode::Unregister;
+    }
+
+private:
+    bool active_;
+};
 } // namespace analytics
 } // namespace ore
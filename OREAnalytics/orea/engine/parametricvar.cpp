@@ -47,6 +47,7 @@ ParametricVarCalculator::ParametricVarParams::Method parseParametricVarMethod(co
         {"Delta", ParametricVarCalculator::ParametricVarParams::Method::Delta},
         {"DeltaGammaNormal", ParametricVarCalculator::ParametricVarParams::Method::DeltaGammaNormal},
         {"MonteCarlo", ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo},
+        {"QuasiMonteCarlo", ParametricVarCalculator::ParametricVarParams::Method::QuasiMonteCarlo},
         {"Cornish-Fisher", ParametricVarCalculator::ParametricVarParams::Method::CornishFisher},
         {"Saddlepoint", ParametricVarCalculator::ParametricVarParams::Method::Saddlepoint}
     };
@@ -66,6 +67,8 @@ std::ostream& operator<<(std::ostream& out, const ParametricVarCalculator::Param
         return out << "DeltaGammaNormal";
     case ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo:
         return out << "MonteCarlo";
+    case ParametricVarCalculator::ParametricVarParams::Method::QuasiMonteCarlo:
+        return out << "QuasiMonteCarlo";
     case ParametricVarCalculator::ParametricVarParams::Method::CornishFisher:
         return out << "Cornish-Fisher";
     case ParametricVarCalculator::ParametricVarParams::Method::Saddlepoint:
@@ -77,6 +80,11 @@ std::ostream& operator<<(std::ostream& out, const ParametricVarCalculator::Param
 
 QuantLib::Real ParametricVarCalculator::var(QuantLib::Real confidence, const bool isCall, 
     const set<pair<string, Size>>& tradeIds) {
+    return var(std::vector<Real>(1, confidence), isCall, tradeIds).front();
+}
+
+std::vector<Real> ParametricVarCalculator::var(const std::vector<Real>& confidence, const bool isCall,
+                                               const set<pair<string, Size>>& tradeIds) {
     Real factor = isCall ? 1.0 : -1.0;
 
     Array delta(deltas_.size(), 0.0);
@@ -106,29 +114,43 @@ QuantLib::Real ParametricVarCalculator::var(QuantLib::Real confidence, const boo
         }
     }
 
+    return computeVar(delta, gamma, confidence);
+}
+
+std::vector<Real> ParametricVarCalculator::computeVar(const Array& delta, const Matrix& gamma,
+                                                      const std::vector<Real>& confidence) const {
+    // all methods share the decompositions and moments of the PL distribution, resp. the Monte Carlo simulation,
+    // between the confidence levels
     if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::Delta)
         return QuantExt::deltaVar(omega_, delta, confidence, *covarianceSalvage_);
     else if (parametricVarParams_.method ==
                 ParametricVarCalculator::ParametricVarParams::Method::DeltaGammaNormal)
         return QuantExt::deltaGammaVarNormal(omega_, delta, gamma, confidence, *covarianceSalvage_);
-    else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo) {
+    else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo ||
+             parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::QuasiMonteCarlo) {
         QL_REQUIRE(parametricVarParams_.samples != Null<Size>(),
-                    "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
+                    "ParametricVarCalculator::computeVar(): method " << parametricVarParams_.method
+                                                                      << " requires mcSamples");
         QL_REQUIRE(parametricVarParams_.seed != Null<Size>(),
-                    "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
+                    "ParametricVarCalculator::computeVar(): method " << parametricVarParams_.method
+                                                                      << " requires mcSeed");
+        if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::QuasiMonteCarlo)
+            return QuantExt::deltaGammaVarMc<LowDiscrepancy>(omega_, delta, gamma, confidence,
+                                                             parametricVarParams_.samples, parametricVarParams_.seed,
+                                                             *covarianceSalvage_, nThreads_);
         return QuantExt::deltaGammaVarMc<PseudoRandom>(omega_, delta, gamma, confidence, parametricVarParams_.samples,
-                                                        parametricVarParams_.seed, *covarianceSalvage_);
+                                                        parametricVarParams_.seed, *covarianceSalvage_, nThreads_);
     } else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::CornishFisher)
         return QuantExt::deltaGammaVarCornishFisher(omega_, delta, gamma, confidence, *covarianceSalvage_);
     else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::Saddlepoint) {
-        Real res;
+        std::vector<Real> res;
         try {
             res = QuantExt::deltaGammaVarSaddlepoint(omega_, delta, gamma, confidence, *covarianceSalvage_);
         } catch (const std::exception& e) {
             ALOG("Saddlepoint VaR computation exited with an error: " << e.what()
                                                                         << ", falling back on Monte-Carlo");
             res = QuantExt::deltaGammaVarMc<PseudoRandom>(omega_, delta, gamma, confidence,
-                parametricVarParams_.samples, parametricVarParams_.seed, *covarianceSalvage_);
+                parametricVarParams_.samples, parametricVarParams_.seed, *covarianceSalvage_, nThreads_);
         }        
         return res;
     } else
@@ -197,34 +219,40 @@ void ParametricVarReport::calculate(ore::data::Report& report) {
 
     SensitivityAggregator sensiAgg(tradePortfolios_);
 
-    // create a calculator for the VAR
-
-    Matrix covariance;
-    map<RiskFactorKey, Real> deltas;
-    map<pair<RiskFactorKey, RiskFactorKey>, Real> gammas;
     boost::shared_ptr<QuantExt::CovarianceSalvage> covarianceSalvage =
         boost::make_shared<QuantExt::SpectralCovarianceSalvage>();
     bool includeGammaMargin = true;
     bool includeDeltaMargin = true;
-    ParametricVarCalculator calculator(parametricVarParams_, covariance, deltas, gammas, covarianceSalvage,
-                                       includeGammaMargin, includeDeltaMargin); 
+
+    // The inputs of the VaR calculations of one risk filter, these are collected in the loop over the portfolios and
+    // then computed in parallel
+    struct VarInput {
+        string portfolioId;
+        Matrix covariance;
+        map<RiskFactorKey, Real> deltas;
+        map<pair<RiskFactorKey, RiskFactorKey>, Real> gammas;
+        vector<Real> var;
+    };
 
     // loop over risk class and type filters (index 0 == all risk types)
     for (Size j = 0; j < (breakdown_ ? RiskFilter::numberOfRiskClasses() : 1); ++j) {
         for (Size k = 0; k < (breakdown_ ? RiskFilter::numberOfRiskTypes() : 1); ++k) {
             ext::shared_ptr<RiskFilter> rf = ext::make_shared<RiskFilter>(j, k);
             sensiAgg.aggregate(*sensitivities_, rf);
-                        
+
+            vector<VarInput> inputs;
             for (const auto& portfolioId : portfolioIds) {
                 if (!hasFilter || portfolioId == allStr || boost::regex_match(portfolioId, filter)) {
 
                     set<SensitivityRecord> srs = sensiAgg.sensitivities(portfolioId);
-                    deltas.clear();
-                    gammas.clear();
+                    VarInput input;
+                    input.portfolioId = portfolioId;
+                    map<RiskFactorKey, Real>& deltas = input.deltas;
+                    Matrix& covariance = input.covariance;
                     // Populate the deltas and gammas for a parametric VAR benchmark calculation
-                    sensiAgg.generateDeltaGamma(portfolioId, deltas, gammas);
+                    sensiAgg.generateDeltaGamma(portfolioId, deltas, input.gammas);
 
-                    std::vector<Real> var;
+                    // without deltas the VaR is zero and no line is written to the report
                     if (deltas.size() > 0) {
                         vector<RiskFactorKey> keys;
                         transform(deltas.begin(), deltas.end(), back_inserter(keys),
@@ -261,6 +289,7 @@ void ParametricVarReport::calculate(ore::data::Report& report) {
                                 ext::make_shared<ScenarioShiftCalculator>(sensitivityConfig_, simMarketConfig_);
                             ext::shared_ptr<HistoricalSensiPnlCalculator> sensiPnlCalculator =
                                 ext::make_shared<HistoricalSensiPnlCalculator>(hisScenGen_, sensitivities_);
+                            sensiPnlCalculator->setShiftStore(shiftStore_);
 
                             ext::shared_ptr<NPVCube> npvCube;
 
@@ -284,22 +313,36 @@ void ParametricVarReport::calculate(ore::data::Report& report) {
                             covarianceSalvage = boost::make_shared<QuantExt::NoCovarianceSalvage>();
                         }
                         DLOG("Covariance matrix salvage complete.");
-                        // compute var and write to report
-                        for (Size i = 0; i < p_.size(); i++)
-                            var.push_back(calculator.var(p_[i]));
-                    } else
-                        var = std::vector<Real>(p_.size(), 0.0);
-
-                    if (!close_enough(QuantExt::detail::absMax(var), 0.0)) {
-                        report.next();
-                        report.add(portfolioId);
-                        report.add(rf->riskClassLabel());
-                        report.add(rf->riskTypeLabel());
-                        for (auto const& v : var)
-                            report.add(v);
+                        inputs.push_back(std::move(input));
                     }
                 }
             }
+
+            // compute the var for all portfolios, the calculations are independent, if there are fewer portfolios
+            // than threads, the threads are used by the Monte Carlo simulations instead
+            bool parallelInputs = inputs.size() >= nThreads_;
+            runBlocks(inputs.size(), parallelInputs ? nThreads_ : 1, threadPool_, [&](Size begin, Size end) {
+                for (Size i = begin; i < end; i++) {
+                    ParametricVarCalculator calculator(parametricVarParams_, inputs[i].covariance, inputs[i].deltas,
+                                                       inputs[i].gammas, covarianceSalvage, includeGammaMargin,
+                                                       includeDeltaMargin);
+                    if (!parallelInputs)
+                        calculator.setThreads(nThreads_);
+                    inputs[i].var = calculator.var(p_);
+                }
+            });
+
+            // write to report
+            for (const auto& input : inputs) {
+                if (!close_enough(QuantExt::detail::absMax(input.var), 0.0)) {
+                    report.next();
+                    report.add(input.portfolioId);
+                    report.add(rf->riskClassLabel());
+                    report.add(rf->riskTypeLabel());
+                    for (auto const& v : input.var)
+                        report.add(v);
+                }
+            }
             sensiAgg.reset();
         }
     }
@@ -25,8 +25,10 @@
 
 #include <orea/engine/sensitivitystream.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/engine/varcalculator.hpp>
 #include <orea/scenario/historicalscenariogenerator.hpp>
+#include <orea/scenario/historicalshiftstore.hpp>
 #include <orea/scenario/sensitivityscenariodata.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 
@@ -56,6 +58,7 @@ public:
             Delta,
             DeltaGammaNormal,
             MonteCarlo,
+            QuasiMonteCarlo,
             CornishFisher,
             Saddlepoint,
         };
@@ -76,10 +79,20 @@ public:
         includeGammaMargin_(includeGammaMargin), includeDeltaMargin_(includeDeltaMargin) {}
 
     
+    //! Number of threads used by the Monte Carlo methods
+    void setThreads(const QuantLib::Size nThreads) { nThreads_ = nThreads; }
+
+    using VarCalculator::var;
     QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true, 
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+    //! VaR for several confidence levels, the decompositions resp. the simulation are shared by all levels
+    std::vector<QuantLib::Real> var(const std::vector<QuantLib::Real>& confidence, const bool isCall = true,
+                                    const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
 
 private:
+    std::vector<QuantLib::Real> computeVar(const QuantLib::Array& delta, const QuantLib::Matrix& gamma,
+                                           const std::vector<QuantLib::Real>& confidence) const;
+
     const ParametricVarParams& parametricVarParams_;
     const QuantLib::Matrix& omega_;
     const std::map<RiskFactorKey, QuantLib::Real>& deltas_;
@@ -87,6 +100,7 @@ private:
     const QuantLib::ext::shared_ptr<QuantExt::CovarianceSalvage>& covarianceSalvage_;
     const bool& includeGammaMargin_;
     const bool& includeDeltaMargin_;
+    QuantLib::Size nThreads_ = 1;
 };
 
 //! Parametric VaR Calculator
@@ -114,7 +128,17 @@ public:
         const bool salvageCovarianceMatrix);
 
     void calculate(ore::data::Report& report);
-    
+
+    /*! Compute the VaR of the portfolios for each risk filter in nThreads blocks, on the given thread pool if set,
+        otherwise in separate threads */
+    void setThreads(const QuantLib::Size nThreads, const boost::shared_ptr<ThreadPool>& threadPool = nullptr) {
+        nThreads_ = nThreads;
+        threadPool_ = threadPool;
+    }
+
+    //! Reuse and update the historical shifts of the given store when the covariance is generated
+    void setShiftStore(const QuantLib::ext::shared_ptr<HistoricalShiftStore>& shiftStore) { shiftStore_ = shiftStore; }
+
     typedef std::pair<RiskFactorKey, RiskFactorKey> CrossPair;
 
 protected:
@@ -129,6 +153,9 @@ protected:
     boost::optional<ore::data::TimePeriod> benchmarkPeriod_;
     const QuantLib::ext::shared_ptr<SensitivityScenarioData> sensitivityConfig_;
     const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig_;
+    QuantLib::ext::shared_ptr<HistoricalShiftStore> shiftStore_;
+    QuantLib::Size nThreads_ = 1;
+    boost::shared_ptr<ThreadPool> threadPool_;
 
     Matrix cov_;
 
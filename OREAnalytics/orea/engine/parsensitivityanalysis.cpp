@@ -62,7 +62,16 @@
 #include <qle/pricingengines/depositengine.hpp>
 #include <qle/pricingengines/discountingfxforwardengine.hpp>
 #include <qle/pricingengines/inflationcapfloorengines.hpp>
-#include <qle/math/blockmatrixinverse.hpp>
+#include <qle/math/sparselu.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -692,6 +701,23 @@ void writeSensitivity(const RiskFactorKey& a, const RiskFactorKey& b, const Real
     parSensi[std::make_pair(a, b)] = value;
     DLOG("ParInstrument Sensi " << a << " w.r.t. " << b << " " << setprecision(6) << value);
 }
+
+// replays the given scenarios of a shift scenario generator
+class ScenarioSubsetGenerator : public ScenarioGenerator {
+public:
+    ScenarioSubsetGenerator(const boost::shared_ptr<ShiftScenarioGenerator>& source, const std::vector<Size>& indices)
+        : source_(source), indices_(indices), next_(0) {}
+    boost::shared_ptr<Scenario> next(const Date& d) override {
+        QL_REQUIRE(next_ < indices_.size(), "ScenarioSubsetGenerator: no more scenarios");
+        return source_->scenario(indices_[next_++]);
+    }
+    void reset() override { next_ = 0; }
+
+private:
+    boost::shared_ptr<ShiftScenarioGenerator> source_;
+    std::vector<Size> indices_;
+    Size next_;
+};
 } // namespace
 
 void ParSensitivityAnalysis::computeParInstrumentSensitivities(const boost::shared_ptr<ScenarioSimMarket>& simMarket) {
@@ -747,7 +773,216 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const boost::shar
     createParInstruments(simMarket);
 
     map<RiskFactorKey, Real> parRatesBase, parCapVols; // for both ir and yoy caps
+    computeBaseValues(simMarket, parRatesBase, parCapVols);
 
+    LOG("Caching base scenario par rates and float vols done.");
+
+    /****************************************************************
+     * Discount curve instrument fair rate sensitivity to zero shifts
+     * Index curve instrument fair rate sensitivity to zero shifts
+     * Cap/Floor flat vol sensitivity to optionlet vol shifts
+     *
+     * Step 3:
+     * - Apply all single up-shift scenarios,
+     * - Compute respective fair par rates and flat vols
+     * - Compute par rate / flat vol sensitivities
+     */
+    LOG("Compute par rate and flat vol sensitivities");
+
+    vector<ShiftScenarioGenerator::ScenarioDescription> desc = scenarioGenerator->scenarioDescriptions();
+    QL_REQUIRE(desc.size() == scenarioGenerator->samples(), "descriptions size " << desc.size() <<
+        " does not match samples " << scenarioGenerator->samples());
+
+    std::set<RiskFactorKey> parKeysCheck, parKeysNonZero;
+    std::set<RiskFactorKey> rawKeysCheck, rawKeysNonZero;
+
+    for (auto const& p : parHelpers_) {
+	parKeysCheck.insert(p.first);
+    }
+
+    for(auto const& p: parCaps_) {
+	parKeysCheck.insert(p.first);
+    }
+
+    for(auto const& p: parYoYCaps_) {
+	parKeysCheck.insert(p.first);
+    }
+
+    // use single "UP" shift scenarios only, use only scenarios relevant for par instruments,
+    // use relevant scenarios only, if specified
+    // ignore risk factor types that have been disabled
+    // the scenarios are grouped by the curve they shift
+
+    std::map<CurveKey, std::vector<Size>> curveScenarios;
+    for (Size i = 1; i < scenarioGenerator->samples(); ++i) {
+        if (desc[i].type() != ShiftScenarioGenerator::ScenarioDescription::Type::Up ||
+            !isParType(desc[i].key1().keytype) || typesDisabled_.count(desc[i].key1().keytype) == 1 ||
+            !(relevantRiskFactors_.empty() || relevantRiskFactors_.find(desc[i].key1()) != relevantRiskFactors_.end()))
+            continue;
+        curveScenarios[std::make_pair(desc[i].key1().keytype, desc[i].key1().name)].push_back(i);
+        rawKeysCheck.insert(desc[i].key1());
+    }
+
+    // only the par instruments depending on the shifted curve are repriced under a scenario
+
+    std::set<CurveKey> curves;
+    for (auto const& c : curveScenarios)
+        curves.insert(c.first);
+    std::map<CurveKey, std::set<RiskFactorKey>> dependencies = parInstrumentDependencies(simMarket, curves);
+
+    Size nThreads = std::min(nThreads_, curveScenarios.size());
+
+    if (nThreads <= 1 || !simMarketBuilder_) {
+
+        std::vector<const std::set<RiskFactorKey>*> scenarioDependencies(scenarioGenerator->samples(), nullptr);
+        for (auto const& c : curveScenarios) {
+            for (auto i : c.second)
+                scenarioDependencies[i] = &dependencies.at(c.first);
+        }
+
+        for (Size i = 1; i < scenarioGenerator->samples(); ++i) {
+            simMarket->update(asof_);
+            if (scenarioDependencies[i] == nullptr)
+                continue;
+            processScenario(simMarket, desc[i], *scenarioDependencies[i], parRatesBase, parCapVols, parSensi_,
+                            parKeysNonZero, rawKeysNonZero);
+        } // end of loop over samples
+
+    } else {
+
+        // distribute the curves over the workers, largest first, each to the worker with the least scenarios so far
+
+        std::vector<std::pair<CurveKey, Size>> curveSizes;
+        for (auto const& c : curveScenarios)
+            curveSizes.push_back(std::make_pair(c.first, c.second.size()));
+        std::stable_sort(curveSizes.begin(), curveSizes.end(),
+                         [](const std::pair<CurveKey, Size>& x, const std::pair<CurveKey, Size>& y) {
+                             return x.second > y.second;
+                         });
+        std::vector<std::vector<Size>> workerScenarios(nThreads);
+        for (auto const& c : curveSizes) {
+            auto w = std::min_element(
+                workerScenarios.begin(), workerScenarios.end(),
+                [](const std::vector<Size>& x, const std::vector<Size>& y) { return x.size() < y.size(); });
+            w->insert(w->end(), curveScenarios.at(c.first).begin(), curveScenarios.at(c.first).end());
+        }
+        for (auto& w : workerScenarios)
+            std::sort(w.begin(), w.end());
+
+        LOG("Compute par instrument sensitivities for " << curveScenarios.size() << " curves in " << nThreads
+                                                        << " threads");
+
+        std::vector<ParContainer> workerParSensi(nThreads);
+        std::vector<std::set<RiskFactorKey>> workerParKeysNonZero(nThreads), workerRawKeysNonZero(nThreads);
+
+        Date today = Settings::instance().evaluationDate();
+        ObservationMode::Mode obsMode = ObservationMode::instance().mode();
+        Size samples = scenarioGenerator->samples();
+        std::mutex simMarketMutex;
+
+        auto job = [this, today, obsMode, samples, &desc, &dependencies, &workerScenarios, &workerParSensi,
+                    &workerParKeysNonZero, &workerRawKeysNonZero, &simMarketMutex](int id) -> int {
+            // set thread local singletons
+
+            Settings::instance().evaluationDate() = today;
+            ObservationMode::instance().setMode(obsMode);
+
+            try {
+                boost::shared_ptr<ScenarioSimMarket> workerSimMarket;
+                {
+                    std::lock_guard<std::mutex> lock(simMarketMutex);
+                    workerSimMarket = simMarketBuilder_();
+                }
+                auto workerScenarioGenerator =
+                    boost::dynamic_pointer_cast<ShiftScenarioGenerator>(workerSimMarket->scenarioGenerator());
+                QL_REQUIRE(workerScenarioGenerator, "sim market does not have a ShiftScenarioGenerator");
+                QL_REQUIRE(workerScenarioGenerator->samples() == samples,
+                           "sim market scenario generator has " << workerScenarioGenerator->samples()
+                                                                << " samples, expected " << samples);
+
+                // build the par instruments against the worker's sim market in the base state
+
+                ParSensitivityAnalysis worker(*this);
+                workerSimMarket->reset();
+                workerScenarioGenerator->reset();
+                workerSimMarket->update(asof_);
+                worker.createParInstruments(workerSimMarket);
+                map<RiskFactorKey, Real> workerParRatesBase, workerParCapVols;
+                worker.computeBaseValues(workerSimMarket, workerParRatesBase, workerParCapVols);
+
+                // apply the scenarios assigned to this worker only
+
+                workerSimMarket->scenarioGenerator() =
+                    boost::make_shared<ScenarioSubsetGenerator>(workerScenarioGenerator, workerScenarios[id]);
+                for (auto i : workerScenarios[id]) {
+                    workerSimMarket->update(asof_);
+                    worker.processScenario(
+                        workerSimMarket, desc[i],
+                        dependencies.at(std::make_pair(desc[i].key1().keytype, desc[i].key1().name)),
+                        workerParRatesBase, workerParCapVols, workerParSensi[id], workerParKeysNonZero[id],
+                        workerRawKeysNonZero[id]);
+                }
+                return 0;
+            } catch (const std::exception& e) {
+                ALOG(StructuredAnalyticsErrorMessage("Par sensitivity analysis", "", e.what()));
+                return 1;
+            }
+        };
+
+        std::vector<std::future<int>> results(nThreads);
+        std::vector<std::thread> jobs; // not needed if thread pool is used
+
+        for (Size i = 0; i < nThreads; ++i) {
+            if (threadPool_) {
+                results[i] = threadPool_->push([&job, i]() { return job(static_cast<int>(i)); });
+            } else {
+                std::packaged_task<int(int)> task(job);
+                results[i] = task.get_future();
+                std::thread thread(std::move(task), i);
+                jobs.emplace_back(std::move(thread));
+            }
+        }
+
+        for (auto& t : jobs)
+            t.join();
+
+        for (Size i = 0; i < nThreads; ++i) {
+            QL_REQUIRE(results[i].get() == 0,
+                       "error: thread " << i << " exited with return code 1. Check for structured errors from 'Par "
+                                           "sensitivity analysis'.");
+        }
+
+        // the workers are assigned disjoint sets of risk factors, so the results can be merged without conflicts
+
+        for (Size i = 0; i < nThreads; ++i) {
+            parSensi_.insert(workerParSensi[i].begin(), workerParSensi[i].end());
+            parKeysNonZero.insert(workerParKeysNonZero[i].begin(), workerParKeysNonZero[i].end());
+            rawKeysNonZero.insert(workerRawKeysNonZero[i].begin(), workerRawKeysNonZero[i].end());
+        }
+    }
+
+    // check for
+    // a) par instruments which have no sensitivity to any of the risk factors
+    // b) risk factors w.r.t. which no par instrument has a sensitivity
+    std::set<RiskFactorKey> parKeysZero, rawKeysZero;
+    std::set_difference(parKeysCheck.begin(), parKeysCheck.end(), parKeysNonZero.begin(), parKeysNonZero.end(),
+                        std::inserter(parKeysZero, parKeysZero.begin()));
+    std::set_difference(rawKeysCheck.begin(), rawKeysCheck.end(), rawKeysNonZero.begin(), rawKeysNonZero.end(),
+                        std::inserter(rawKeysZero, rawKeysZero.begin()));
+    for (auto const& k : parKeysZero) {
+        WLOG("Found par instrument which has no sensitivity to any of the risk factors: \"" << k << "\"");
+    }
+    for (auto const& k : rawKeysZero) {
+        WLOG("Found risk factor w.r.t. which no par instrument has a sensitivity: \"" << k << "\"");
+    }
+
+    LOG("Computing par rate and flat vol sensitivities done");
+
+} // namespace sensitivity
+
+void ParSensitivityAnalysis::computeBaseValues(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                               map<RiskFactorKey, Real>& parRatesBase,
+                                               map<RiskFactorKey, Real>& parCapVols) {
     for (auto& p : parHelpers_) {
         try {
             Real parRate = impliedQuote(p.second);
@@ -800,209 +1035,221 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const boost::shar
         // Populate zero and par shift size for the current risk factor
         populateShiftSizes(c.first, parVol, simMarket);
     }
+}
 
-    LOG("Caching base scenario par rates and float vols done.");
-
-    /****************************************************************
-     * Discount curve instrument fair rate sensitivity to zero shifts
-     * Index curve instrument fair rate sensitivity to zero shifts
-     * Cap/Floor flat vol sensitivity to optionlet vol shifts
-     *
-     * Step 3:
-     * - Apply all single up-shift scenarios,
-     * - Compute respective fair par rates and flat vols
-     * - Compute par rate / flat vol sensitivities
-     */
-    LOG("Compute par rate and flat vol sensitivities");
+std::map<ParSensitivityAnalysis::CurveKey, std::set<RiskFactorKey>>
+ParSensitivityAnalysis::parInstrumentDependencies(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                                  const std::set<CurveKey>& curves) {
 
-    vector<ShiftScenarioGenerator::ScenarioDescription> desc = scenarioGenerator->scenarioDescriptions();
-    QL_REQUIRE(desc.size() == scenarioGenerator->samples(), "descriptions size " << desc.size() <<
-        " does not match samples " << scenarioGenerator->samples());
+    // par instruments which are not cached after the base valuation are considered dependent on all curves
 
-    std::set<RiskFactorKey> parKeysCheck, parKeysNonZero;
-    std::set<RiskFactorKey> rawKeysCheck, rawKeysNonZero;
+    std::set<RiskFactorKey> all, notCached;
+    auto collect = [&all, &notCached](const auto& instruments) {
+        for (auto const& p : instruments) {
+            all.insert(p.first);
+            if (!p.second->isCalculated())
+                notCached.insert(p.first);
+        }
+    };
+    collect(parHelpers_);
+    collect(parCaps_);
+    collect(parYoYCaps_);
 
-    for (auto const& p : parHelpers_) {
-	parKeysCheck.insert(p.first);
-    }
+    /* a change of a sim market quote notifies the par instruments on the curve built from it, in the unregister
+       mode some of the notification chains are cut, so we fall back to reprice all par instruments then */
 
-    for(auto const& p: parCaps_) {
-	parKeysCheck.insert(p.first);
-    }
+    bool probe = ObservationMode::instance().mode() != ObservationMode::Mode::Unregister;
 
-    for(auto const& p: parYoYCaps_) {
-	parKeysCheck.insert(p.first);
+    std::map<CurveKey, std::set<RiskFactorKey>> result;
+    for (auto const& c : curves) {
+        std::set<RiskFactorKey>& deps = result[c];
+        auto q = simMarket->simData().lower_bound(RiskFactorKey(c.first, c.second, 0));
+        if (!probe || q == simMarket->simData().end() || q->first.keytype != c.first || q->first.name != c.second) {
+            deps = all;
+            continue;
+        }
+        Real v = q->second->value();
+        q->second->setValue(v + 1.0E-8);
+        q->second->setValue(v);
+        deps = notCached;
+        for (auto const& p : parHelpers_) {
+            if (!p.second->isCalculated()) {
+                deps.insert(p.first);
+                impliedQuote(p.second);
+            }
+        }
+        for (auto const& p : parCaps_) {
+            if (!p.second->isCalculated()) {
+                deps.insert(p.first);
+                p.second->NPV();
+            }
+        }
+        for (auto const& p : parYoYCaps_) {
+            if (!p.second->isCalculated()) {
+                deps.insert(p.first);
+                p.second->NPV();
+            }
+        }
+        DLOG("Curve " << c.first << "/" << c.second << ": " << deps.size() << " out of " << all.size()
+                      << " par instruments depend on it");
     }
+    return result;
+}
 
-    for (Size i = 1; i < scenarioGenerator->samples(); ++i) {
-
-        simMarket->update(asof_);
-
-        // use single "UP" shift scenarios only, use only scenarios relevant for par instruments,
-        // use relevant scenarios only, if specified
-        // ignore risk factor types that have been disabled
-        if (desc[i].type() != ShiftScenarioGenerator::ScenarioDescription::Type::Up ||
-            !isParType(desc[i].key1().keytype) || typesDisabled_.count(desc[i].key1().keytype) == 1 ||
-            !(relevantRiskFactors_.empty() || relevantRiskFactors_.find(desc[i].key1()) != relevantRiskFactors_.end()))
-            continue;
+void ParSensitivityAnalysis::processScenario(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                             const ShiftScenarioGenerator::ScenarioDescription& desc,
+                                             const std::set<RiskFactorKey>& dependencies,
+                                             const map<RiskFactorKey, Real>& parRatesBase,
+                                             const map<RiskFactorKey, Real>& parCapVols, ParContainer& parSensi,
+                                             std::set<RiskFactorKey>& parKeysNonZero,
+                                             std::set<RiskFactorKey>& rawKeysNonZero) {
+
+    // par instruments that do not depend on the shifted curve are skipped, except the diagonal entries
+    auto skip = [&dependencies, &desc](const RiskFactorKey& key) {
+        return dependencies.count(key) == 0 && key != desc.key1();
+    };
 
-        // Since we are not using ValuationEngine we need to manually perform the trade updates here
-        // TODO - explore means of utilising valuation engine
-        if (ObservationMode::instance().mode() == ObservationMode::Mode::Disable) {
-            for (auto it : parHelpers_)
+    // Since we are not using ValuationEngine we need to manually perform the trade updates here
+    // TODO - explore means of utilising valuation engine
+    if (ObservationMode::instance().mode() == ObservationMode::Mode::Disable) {
+        for (auto it : parHelpers_)
+            if (!skip(it.first))
                 it.second->deepUpdate();
-            for (auto it : parCaps_)
+        for (auto it : parCaps_)
+            if (!skip(it.first))
                 it.second->deepUpdate();
-            for (auto it : parYoYCaps_)
+        for (auto it : parYoYCaps_)
+            if (!skip(it.first))
                 it.second->deepUpdate();
-        }
-
-        rawKeysCheck.insert(desc[i].key1());
-
-        // Get the absolute shift size and skip if close to zero
+    }
 
-        Real shiftSize = getShiftSize(desc[i].key1(), sensitivityData_, simMarket);
+    // Get the absolute shift size and skip if close to zero
 
-        if (close_enough(shiftSize, 0.0)) {
-            ALOG("Shift size for " << desc[i].key1() << " is zero, skipping");
-            continue;
-        }
+    Real shiftSize = getShiftSize(desc.key1(), sensitivityData_, simMarket);
 
-        // process par helpers
+    if (close_enough(shiftSize, 0.0)) {
+        ALOG("Shift size for " << desc.key1() << " is zero, skipping");
+        return;
+    }
 
-        for (auto const& p : parHelpers_) {
+    // process par helpers
 
-            // skip if par helper has no sensi to zero risk factor (except the special treatment below kicks in)
+    for (auto const& p : parHelpers_) {
 
-            if (p.second->isCalculated() &&
-                (p.first.keytype != RiskFactorKey::KeyType::SurvivalProbability || p.first != desc[i].key1()))
-                continue;
+        // skip if par helper has no sensi to zero risk factor (except the special treatment below kicks in)
 
-            // compute fair and base quotes
+        if (skip(p.first))
+            continue;
 
-            Real fair = impliedQuote(p.second);
-            auto base = parRatesBase.find(p.first);
-            QL_REQUIRE(base != parRatesBase.end(), "internal error: did not find parRatesBase[" << p.first << "]");
+        if (p.second->isCalculated() &&
+            (p.first.keytype != RiskFactorKey::KeyType::SurvivalProbability || p.first != desc.key1()))
+            continue;
 
-            Real tmp = (fair - base->second) / shiftSize;
+        // compute fair and base quotes
 
-            // special treatments for certain risk factors
+        Real fair = impliedQuote(p.second);
+        auto base = parRatesBase.find(p.first);
+        QL_REQUIRE(base != parRatesBase.end(), "internal error: did not find parRatesBase[" << p.first << "]");
 
-            // for curves with survival probabilities going to zero quickly we might see a sensitivity
-            // that is close to zero, which we sanitise here in order to prevent the Jacobi matrix
-            // getting ill-conditioned or even singular
+        Real tmp = (fair - base->second) / shiftSize;
 
-            if (p.first.keytype == RiskFactorKey::KeyType::SurvivalProbability && p.first == desc[i].key1() &&
-                std::abs(tmp) < 0.01) {
-                WLOG("Setting Diagonal Default Curve Sensi " << p.first << " w.r.t. " << desc[i].key1()
-                                                             << " to 0.01 (got " << tmp << ")");
-                tmp = 0.01;
-            }
+        // special treatments for certain risk factors
 
-            // YoY diagnoal entries are 1.0
+        // for curves with survival probabilities going to zero quickly we might see a sensitivity
+        // that is close to zero, which we sanitise here in order to prevent the Jacobi matrix
+        // getting ill-conditioned or even singular
 
-            if (p.first.keytype == RiskFactorKey::KeyType::YoYInflationCurve && p.first == desc[i].key1() &&
-                close_enough(tmp, 0.0)) {
-                tmp = 1.0;
-            }
+        if (p.first.keytype == RiskFactorKey::KeyType::SurvivalProbability && p.first == desc.key1() &&
+            std::abs(tmp) < 0.01) {
+            WLOG("Setting Diagonal Default Curve Sensi " << p.first << " w.r.t. " << desc.key1()
+                                                         << " to 0.01 (got " << tmp << ")");
+            tmp = 0.01;
+        }
 
-            // write sensitivity
+        // YoY diagnoal entries are 1.0
 
-            writeSensitivity(p.first, desc[i].key1(), tmp, parSensi_, parKeysNonZero, rawKeysNonZero);
+        if (p.first.keytype == RiskFactorKey::KeyType::YoYInflationCurve && p.first == desc.key1() &&
+            close_enough(tmp, 0.0)) {
+            tmp = 1.0;
         }
 
-        // process par caps
+        // write sensitivity
 
-        for (auto const& p : parCaps_) {
+        writeSensitivity(p.first, desc.key1(), tmp, parSensi, parKeysNonZero, rawKeysNonZero);
+    }
 
-            if (p.second->isCalculated() && p.first != desc[i].key1())
-                continue;
+    // process par caps
 
-            Handle<OptionletVolatilityStructure> ovs = simMarket->capFloorVol(p.first.name, marketConfiguration_);
-            auto yts = parCapsYts_.find(p.first);
-            QL_REQUIRE(yts != parCapsYts_.end(), "internal error: did not find parCapYts[" << p.first << "]");
+    for (auto const& p : parCaps_) {
 
-            Real price = p.second->NPV();
-            Real fair = impliedVolatility<QuantLib::CapFloor>(*p.second, price, yts->second, 0.01,
-                                                              ovs->volatilityType(), ovs->displacement());
-            auto base = parCapVols.find(p.first);
-            QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
+        if (skip(p.first) || (p.second->isCalculated() && p.first != desc.key1()))
+            continue;
 
-            Real tmp = (fair - base->second) / shiftSize;
+        Handle<OptionletVolatilityStructure> ovs = simMarket->capFloorVol(p.first.name, marketConfiguration_);
+        auto yts = parCapsYts_.find(p.first);
+        QL_REQUIRE(yts != parCapsYts_.end(), "internal error: did not find parCapYts[" << p.first << "]");
 
-            // ensure Jacobi matrix is regular and not (too) ill-conditioned, this is necessary because
-            // a) the shift size used to compute dpar / dzero might be close to zero and / or
-            // b) the implied vol calculation has numerical inaccuracies
+        Real price = p.second->NPV();
+        Real fair = impliedVolatility<QuantLib::CapFloor>(*p.second, price, yts->second, 0.01,
+                                                          ovs->volatilityType(), ovs->displacement());
+        auto base = parCapVols.find(p.first);
+        QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
 
-            if (p.first == desc[i].key1() && std::abs(tmp) < 0.01) {
-                WLOG("Setting Diagonal CapFloorVol Sensi " << p.first << " w.r.t. " << desc[i].key1()
-                                                           << " to 0.01 (got " << tmp << ")");
-                tmp = 0.01;
-            }
+        Real tmp = (fair - base->second) / shiftSize;
 
-            // write sensitivity
+        // ensure Jacobi matrix is regular and not (too) ill-conditioned, this is necessary because
+        // a) the shift size used to compute dpar / dzero might be close to zero and / or
+        // b) the implied vol calculation has numerical inaccuracies
 
-            writeSensitivity(p.first, desc[i].key1(), tmp, parSensi_, parKeysNonZero, rawKeysNonZero);
+        if (p.first == desc.key1() && std::abs(tmp) < 0.01) {
+            WLOG("Setting Diagonal CapFloorVol Sensi " << p.first << " w.r.t. " << desc.key1()
+                                                       << " to 0.01 (got " << tmp << ")");
+            tmp = 0.01;
         }
 
-        // process par yoy caps
+        // write sensitivity
 
-        for (auto const& p : parYoYCaps_) {
+        writeSensitivity(p.first, desc.key1(), tmp, parSensi, parKeysNonZero, rawKeysNonZero);
+    }
 
-            if (p.second->isCalculated() && p.first != desc[i].key1())
-                continue;
+    // process par yoy caps
 
-            Handle<QuantExt::YoYOptionletVolatilitySurface> ovs =
-                simMarket->yoyCapFloorVol(p.first.name, marketConfiguration_);
-            auto yts = parYoYCapsYts_.find(p.first);
-            auto index = parYoYCapsIndex_.find(p.first);
-            QL_REQUIRE(yts != parYoYCapsYts_.end(), "internal error: did not find parYoYCapsYts[" << p.first << "]");
-            QL_REQUIRE(index != parYoYCapsIndex_.end(),
-                       "internal error: did not find parYoYCapsIndex[" << p.first << "]");
-
-            Real price = p.second->NPV();
-            Real fair = impliedVolatility<QuantLib::YoYInflationCapFloor, QuantLib::YoYInflationIndex>(
-                *p.second, price, yts->second, 0.01, ovs->volatilityType(), ovs->displacement(), index->second);
-            auto base = parCapVols.find(p.first);
-            QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
-
-            Real tmp = (fair - base->second) / shiftSize;
-
-            // ensure Jacobi matrix is regular and not (too) ill-conditioned, this is necessary because
-            // a) the shift size used to compute dpar / dzero might be close to zero and / or
-            // b) the implied vol calculation has numerical inaccuracies
-
-            if (p.first == desc[i].key1() && std::abs(tmp) < 0.01) {
-                WLOG("Setting Diagonal CapFloorVol Sensi " << p.first << " w.r.t. " << desc[i].key1()
-                                                           << " to 0.01 (got " << tmp << ")");
-                tmp = 0.01;
-            }
+    for (auto const& p : parYoYCaps_) {
 
-            // write sensitivity
+        if (skip(p.first) || (p.second->isCalculated() && p.first != desc.key1()))
+            continue;
 
-            writeSensitivity(p.first, desc[i].key1(), tmp, parSensi_, parKeysNonZero, rawKeysNonZero);
+        Handle<QuantExt::YoYOptionletVolatilitySurface> ovs =
+            simMarket->yoyCapFloorVol(p.first.name, marketConfiguration_);
+        auto yts = parYoYCapsYts_.find(p.first);
+        auto index = parYoYCapsIndex_.find(p.first);
+        QL_REQUIRE(yts != parYoYCapsYts_.end(), "internal error: did not find parYoYCapsYts[" << p.first << "]");
+        QL_REQUIRE(index != parYoYCapsIndex_.end(),
+                   "internal error: did not find parYoYCapsIndex[" << p.first << "]");
+
+        Real price = p.second->NPV();
+        Real fair = impliedVolatility<QuantLib::YoYInflationCapFloor, QuantLib::YoYInflationIndex>(
+            *p.second, price, yts->second, 0.01, ovs->volatilityType(), ovs->displacement(), index->second);
+        auto base = parCapVols.find(p.first);
+        QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
+
+        Real tmp = (fair - base->second) / shiftSize;
+
+        // ensure Jacobi matrix is regular and not (too) ill-conditioned, this is necessary because
+        // a) the shift size used to compute dpar / dzero might be close to zero and / or
+        // b) the implied vol calculation has numerical inaccuracies
+
+        if (p.first == desc.key1() && std::abs(tmp) < 0.01) {
+            WLOG("Setting Diagonal CapFloorVol Sensi " << p.first << " w.r.t. " << desc.key1()
+                                                       << " to 0.01 (got " << tmp << ")");
+            tmp = 0.01;
         }
 
-    } // end of loop over samples
+        // write sensitivity
 
-    // check for
-    // a) par instruments which have no sensitivity to any of the risk factors
-    // b) risk factors w.r.t. which no par instrument has a sensitivity
-    std::set<RiskFactorKey> parKeysZero, rawKeysZero;
-    std::set_difference(parKeysCheck.begin(), parKeysCheck.end(), parKeysNonZero.begin(), parKeysNonZero.end(),
-                        std::inserter(parKeysZero, parKeysZero.begin()));
-    std::set_difference(rawKeysCheck.begin(), rawKeysCheck.end(), rawKeysNonZero.begin(), rawKeysNonZero.end(),
-                        std::inserter(rawKeysZero, rawKeysZero.begin()));
-    for (auto const& k : parKeysZero) {
-        WLOG("Found par instrument which has no sensitivity to any of the risk factors: \"" << k << "\"");
+        writeSensitivity(p.first, desc.key1(), tmp, parSensi, parKeysNonZero, rawKeysNonZero);
     }
-    for (auto const& k : rawKeysZero) {
-        WLOG("Found risk factor w.r.t. which no par instrument has a sensitivity: \"" << k << "\"");
-    }
-
-    LOG("Computing par rate and flat vol sensitivities done");
-
-} // namespace sensitivity
+}
 
 void ParSensitivityAnalysis::alignPillars() {
     LOG("Align simulation market pillars to actual latest relevant dates of par instruments");
@@ -2126,8 +2373,55 @@ set<RiskFactorKey::KeyType> ParSensitivityAnalysis::parTypes_ = {
     RiskFactorKey::KeyType::YoYInflationCapFloorVolatility
 };
 
+namespace {
+// Log zero and pairwise linearly dependent rows (byRows = true) or columns of m. Two vectors can only be linearly
+// dependent if their patterns of non-zero entries coincide, so we group the vectors by pattern and only compare
+// vectors within a group, instead of comparing all pairs.
+void logZeroOrDependentVectors(const SparseMatrix& m, const bool byRows) {
+    constexpr Size nOp = 1000; // number of operations for close_enough comparisons below
+    const string label = byRows ? "row" : "column";
+    const Size n = byRows ? m.size1() : m.size2();
+    vector<vector<Size>> pattern(n);
+    vector<vector<Real>> values(n);
+    vector<Real> norm2(n, 0.0);
+    for (auto it1 = m.begin1(); it1 != m.end1(); ++it1) {
+        for (auto it2 = it1.begin(); it2 != it1.end(); ++it2) {
+            Size i = byRows ? it2.index1() : it2.index2();
+            norm2[i] += (*it2) * (*it2);
+            if (!close_enough(*it2, 0.0, nOp)) {
+                pattern[i].push_back(byRows ? it2.index2() : it2.index1());
+                values[i].push_back(*it2);
+            }
+        }
+    }
+    map<vector<Size>, vector<Size>> groups;
+    for (Size i = 0; i < n; ++i) {
+        if (close_enough(norm2[i], 0.0, n * nOp)) {
+            WLOG(label << " " << i << " is zero");
+        }
+        if (!pattern[i].empty())
+            groups[pattern[i]].push_back(i);
+    }
+    for (auto const& g : groups) {
+        for (Size a = 0; a < g.second.size(); ++a) {
+            const vector<Real>& va = values[g.second[a]];
+            for (Size b = a + 1; b < g.second.size(); ++b) {
+                const vector<Real>& vb = values[g.second[b]];
+                Real ratio = vb[0] / va[0];
+                bool dependent = true;
+                for (Size k = 1; k < va.size() && dependent; ++k)
+                    dependent = close_enough(vb[k] / va[k], ratio, nOp);
+                if (dependent) {
+                    WLOG(label << "s " << g.second[a] << " and " << g.second[b] << " are linearly dependent.");
+                }
+            }
+        }
+    }
+}
+} // namespace
+
 ParSensitivityConverter::ParSensitivityConverter(const ParSensitivityAnalysis::ParContainer& parSensitivities,
-    const map<RiskFactorKey, pair<Real, Real>>& shiftSizes) {
+    const map<RiskFactorKey, pair<Real, Real>>& shiftSizes, const string& cacheDirectory) {
     
     // Populate the set of par keys (rows of Jacobi) and raw zero keys (columns of Jacobi)
     for (auto parEntry : parSensitivities) {
@@ -2182,154 +2476,92 @@ ParSensitivityConverter::ParSensitivityConverter(const ParSensitivityAnalysis::P
         << parSensitivities.size() << " ("
         << 100.0 * static_cast<Real>(parSensitivities.size()) / static_cast<Real>(n_par * n_raw) << "%)");
 
-    LOG("Populating block indices");
-    vector<Size> blockIndices;
-    pair<RiskFactorKey::KeyType, string> previousGroup(RiskFactorKey::KeyType::None, "");
-    Size blockIndex = 0;
-    for (auto r : rawKeys_) {
-        // Update block indices with the index where the risk factor group changes
-        // e.g. when move from (DiscountCurve, EUR) to (DiscountCurve, USD)
-        pair<RiskFactorKey::KeyType, string> thisGroup(r.keytype, r.name);
-        if (blockIndex > 0 && previousGroup != thisGroup) {
-            blockIndices.push_back(blockIndex);
-            TLOG("Adding block index " << blockIndex);
-        }
-        ++blockIndex;
-
-        // Update the risk factor group
-        previousGroup = thisGroup;
-    }
-    blockIndices.push_back(blockIndex);
-    TLOG("Adding block index " << blockIndex);
-    LOG("Finished Populating block indices.");
-
-    LOG("Invert Transposed Jacobi matrix");
-    bool success = true;
-    try {
-        jacobi_transp_inv_ = blockMatrixInverse(jacobi_transp, blockIndices);
-    } catch (const std::exception& e) {
-        // something went wrong during the matrix inversion, so we run an extended analysis on the original matrix
-        // to see whether there are zero or linearly dependent rows / columns
-        ALOG(StructuredAnalyticsErrorMessage("Par sensitivity conversion", "Transposed Jacobi matrix inversion failed",
-                                             e.what()));
-        LOG("Running extended matrix diagnostics (looking for zero or linearly dependent rows / columns...)");
-        constexpr Size nOp = 1000; // number of operations for close_enough comparisons below
-        LOG("Checking for zero rows...");
+    string cacheFile;
+    if (!cacheDirectory.empty()) {
+        std::size_t seed = 0;
+        for (auto const& k : rawKeys_)
+            boost::hash_combine(seed, to_string(k));
         for (auto it1 = jacobi_transp.begin1(); it1 != jacobi_transp.end1(); ++it1) {
-            Real tmp = 0.0;
             for (auto it2 = it1.begin(); it2 != it1.end(); ++it2) {
-                tmp += (*it2) * (*it2);
-            }
-            if (close_enough(tmp, 0.0, n_par * nOp)) {
-                WLOG("row " << it1.index1() << " is zero");
+                boost::hash_combine(seed, it2.index1());
+                boost::hash_combine(seed, it2.index2());
+                boost::hash_combine(seed, *it2);
             }
         }
-        LOG("Checking for zero columns...");
-        for (auto it2 = jacobi_transp.begin2(); it2 != jacobi_transp.end2(); ++it2) {
-            Real tmp = 0.0;
-            for (auto it1 = it2.begin(); it1 != it2.end(); ++it1) {
-                tmp += (*it1) * (*it1);
-            }
-            if (close_enough(tmp, 0.0, n_par * nOp)) {
-                WLOG("column " << it2.index2() << " is zero");
-            }
+        std::ostringstream key;
+        key << std::hex << std::setw(2 * sizeof(std::size_t)) << std::setfill('0') << seed;
+        cacheFile = (boost::filesystem::path(cacheDirectory) / ("parconversion_" + key.str() + ".lu")).string();
+    }
+
+    bool cached = false;
+    if (!cacheFile.empty() && boost::filesystem::exists(cacheFile)) {
+        try {
+            std::ifstream is(cacheFile, std::ios::binary);
+            jacobi_transp_lu_.load(is);
+            QL_REQUIRE(jacobi_transp_lu_.size() == n_raw, "dimension " << jacobi_transp_lu_.size()
+                                                                        << " does not match Jacobi matrix dimension "
+                                                                        << n_raw);
+            // guard against hash collisions, the factorisation must solve a system with the Jacobi matrix
+            boost::numeric::ublas::vector<Real> b(n_raw, 1.0), r(n_raw);
+            boost::numeric::ublas::axpy_prod(jacobi_transp, jacobi_transp_lu_.solve(b), r, true);
+            QL_REQUIRE(boost::numeric::ublas::norm_inf(r - b) < 1E-6, "factorisation does not match Jacobi matrix");
+            cached = true;
+            LOG("Read factorisation of transposed Jacobi matrix from " << cacheFile);
+        } catch (const std::exception& e) {
+            WLOG("Could not read factorisation of transposed Jacobi matrix from " << cacheFile << ": " << e.what()
+                                                                                    << ", factorise matrix");
         }
-        LOG("Checking for linearly dependent rows...");
-        for (auto it1 = jacobi_transp.begin1(); it1 != jacobi_transp.end1(); ++it1) {
-            for (auto it1b = jacobi_transp.begin1(); it1b != jacobi_transp.end1(); ++it1b) {
-                if (it1b.index1() <= it1.index1())
-                    continue;
-                Real ratio = Null<Real>();
-                if (it1.begin() != it1.end() && it1b.begin() != it1b.end()) {
-                    bool dependent = true;
-                    auto it2b = it1b.begin();
-                    for (auto it2 = it1.begin(); it2 != it1.end() && dependent; ++it2) {
-                        if (close_enough(*it2, 0.0, nOp))
-                            continue;
-                        bool foundMatchingIndex = false;
-                        while (it2b != it1b.end() && it2b.index2() <= it2.index2() && dependent) {
-                            if (it2b.index2() < it2.index2()) {
-                                if (!close_enough(*it2b, 0.0, nOp))
-                                    dependent = false;
-                            } else {
-                                foundMatchingIndex = true;
-                                if (close_enough(*it2b, 0.0, nOp)) {
-                                    dependent = false;
-                                } else if (ratio == Null<Real>()) {
-                                    ratio = *it2b / *it2;
-                                } else if (!close_enough(*it2b / *it2, ratio, nOp)) {
-                                    dependent = false;
-                                }
-                            }
-                            ++it2b;
-                        }
-                        if (!foundMatchingIndex)
-                            dependent = false;
-                    }
-                    while (it2b != it1b.end() && dependent) {
-                        if (!close_enough(*it2b, 0.0))
-                            dependent = false;
-                        ++it2b;
-                    }
-                    if (dependent) {
-                        WLOG("rows " << it1.index1() << " and " << it1b.index1() << " are linearly dependent.");
-                    }
-                }
-            }
+    }
+
+    if (!cached) {
+        LOG("Factorise transposed Jacobi matrix");
+        try {
+            jacobi_transp_lu_ = SparseLU(jacobi_transp);
+        } catch (const std::exception& e) {
+            // something went wrong during the factorisation, so we run an extended analysis on the original matrix
+            // to see whether there are zero or linearly dependent rows / columns
+            ALOG(StructuredAnalyticsErrorMessage("Par sensitivity conversion",
+                                                 "Transposed Jacobi matrix factorisation failed", e.what()));
+            LOG("Running extended matrix diagnostics (looking for zero or linearly dependent rows / columns...)");
+            LOG("Checking for zero or linearly dependent rows...");
+            logZeroOrDependentVectors(jacobi_transp, true);
+            LOG("Checking for zero or linearly dependent columns...");
+            logZeroOrDependentVectors(jacobi_transp, false);
+            LOG("Extended matrix diagnostics done. Exiting application.");
+            QL_FAIL("Jacobi matrix factorisation failed, see log file for more details.");
         }
-        LOG("Checking for linearly dependent columns...");
-        for (auto it1 = jacobi_transp.begin2(); it1 != jacobi_transp.end2(); ++it1) {
-            for (auto it1b = jacobi_transp.begin2(); it1b != jacobi_transp.end2(); ++it1b) {
-                if (it1b.index2() <= it1.index2())
-                    continue;
-                Real ratio = Null<Real>();
-                if (it1.begin() != it1.end() && it1b.begin() != it1b.end()) {
-                    bool dependent = true;
-                    auto it2b = it1b.begin();
-                    for (auto it2 = it1.begin(); it2 != it1.end() && dependent; ++it2) {
-                        if (close_enough(*it2, 0.0, nOp))
-                            continue;
-                        bool foundMatchingIndex = false;
-                        while (it2b != it1b.end() && it2b.index1() <= it2.index1() && dependent) {
-                            if (it2b.index1() < it2.index1()) {
-                                if (!close_enough(*it2b, 0.0, nOp))
-                                    dependent = false;
-                            } else {
-                                foundMatchingIndex = true;
-                                if (close_enough(*it2b, 0.0, nOp)) {
-                                    dependent = false;
-                                } else if (ratio == Null<Real>()) {
-                                    ratio = *it2b / *it2;
-                                } else if (!close_enough(*it2b / *it2, ratio, nOp)) {
-                                    dependent = false;
-                                }
-                            }
-                            ++it2b;
-                        }
-                        if (!foundMatchingIndex)
-                            dependent = false;
-                    }
-                    while (it2b != it1b.end() && dependent) {
-                        if (!close_enough(*it2b, 0.0))
-                            dependent = false;
-                        ++it2b;
-                    }
-                    if (dependent) {
-                        WLOG("columns " << it1.index2() << " and " << it1b.index2() << " are linearly dependent.");
-                    }
+        LOG("Factorisation done, non-zero entries in L and U = " << jacobi_transp_lu_.nonZeros());
+        if (!cacheFile.empty()) {
+            // write to a temporary file first, so that concurrent runs never see a partial file
+            string tmp = cacheFile + ".tmp";
+            try {
+                boost::filesystem::create_directories(cacheDirectory);
+                {
+                    std::ofstream os(tmp, std::ios::binary);
+                    jacobi_transp_lu_.save(os);
                 }
+                boost::filesystem::rename(tmp, cacheFile);
+                LOG("Wrote factorisation of transposed Jacobi matrix to " << cacheFile);
+            } catch (const std::exception& e) {
+                WLOG("Could not write factorisation of transposed Jacobi matrix to " << cacheFile << ": "
+                                                                                      << e.what());
             }
         }
-        LOG("Extended matrix diagnostics done. Exiting application.");
-        success = false;
     }
-    QL_REQUIRE(success, "Jacobi matrix inversion failed, see log file for more details.");
-    Real conditionNumber = modifiedMaxNorm(jacobi_transp) * modifiedMaxNorm(jacobi_transp_inv_);
-    LOG("Inverse Jacobi done, condition number of Jacobi matrix is " << conditionNumber);
-    DLOG("Diagonal entries of Jacobi and inverse Jacobi:");
-    DLOG("row/col              Jacobi             Inverse");
-    for (Size j = 0; j < jacobi_transp.size1(); ++j) {
-        DLOG(right << setw(7) << j << setw(20) << jacobi_transp(j, j) << setw(20) << jacobi_transp_inv_(j, j));
+
+    Real conditionNumber = jacobi_transp_lu_.conditionNumberEstimate();
+    LOG("Condition number estimate (1-norm) of Jacobi matrix is " << conditionNumber);
+    // the diagonal of the inverse requires one solve per entry, so we only compute it if it is logged
+    if (ORE_LOG_ACTIVE(ORE_DEBUG)) {
+        DLOG("Diagonal entries of Jacobi and inverse Jacobi:");
+        DLOG("row/col              Jacobi             Inverse");
+        boost::numeric::ublas::vector<Real> e(n_raw, 0.0);
+        for (Size j = 0; j < jacobi_transp.size1(); ++j) {
+            e[j] = 1.0;
+            Real inv = jacobi_transp_lu_.solve(e)[j];
+            e[j] = 0.0;
+            DLOG(right << setw(7) << j << setw(20) << jacobi_transp(j, j) << setw(20) << inv);
+        }
     }
 }
 
@@ -2339,9 +2571,9 @@ ParSensitivityConverter::convertSensitivity(const boost::numeric::ublas::vector<
     DLOG("Start sensitivity conversion");
     
     Size dim = zeroSensitivities.size();
-    QL_REQUIRE(jacobi_transp_inv_.size1() == dim,
-               "Size mismatch between Transoposed Jacobi inverse matrix ["
-                   << jacobi_transp_inv_.size1() << " x " << jacobi_transp_inv_.size2()
+    QL_REQUIRE(jacobi_transp_lu_.size() == dim,
+               "Size mismatch between Transposed Jacobi matrix factorisation ["
+                   << jacobi_transp_lu_.size() << " x " << jacobi_transp_lu_.size()
                    << "] and zero sensitivity array [" << dim << "]");
 
     // Vector storing approximation for \frac{\partial V}{\partial z_i} for each zero factor z_i
@@ -2349,8 +2581,7 @@ ParSensitivityConverter::convertSensitivity(const boost::numeric::ublas::vector<
     zeroDerivs = element_div(zeroSensitivities, zeroShifts_);
 
     // Vector initially storing approximation for \frac{\partial V}{\partial c_i} for each par factor c_i
-    boost::numeric::ublas::vector<Real> parSensitivities(dim);
-    boost::numeric::ublas::axpy_prod(jacobi_transp_inv_, zeroDerivs, parSensitivities, true);
+    boost::numeric::ublas::vector<Real> parSensitivities = jacobi_transp_lu_.solve(zeroDerivs);
     
     // Update parSensitivities vector to hold the first order approximation of the NPV change due to the configured 
     // shift in each of the par factors c_i
@@ -2361,6 +2592,29 @@ ParSensitivityConverter::convertSensitivity(const boost::numeric::ublas::vector<
     return parSensitivities;
 }
 
+void ParSensitivityConverter::convertSensitivities(Matrix& sensitivities) const {
+
+    Size dim = sensitivities.rows();
+    QL_REQUIRE(jacobi_transp_lu_.size() == dim,
+               "Size mismatch between Transposed Jacobi matrix factorisation ["
+                   << jacobi_transp_lu_.size() << " x " << jacobi_transp_lu_.size()
+                   << "] and zero sensitivity block [" << dim << " x " << sensitivities.columns() << "]");
+
+    // same steps as in convertSensitivity(), applied to all columns at once
+    Size m = sensitivities.columns();
+    for (Size i = 0; i < dim; ++i) {
+        Real* row = sensitivities[i];
+        for (Size k = 0; k < m; ++k)
+            row[k] /= zeroShifts_[i];
+    }
+    jacobi_transp_lu_.solve(sensitivities);
+    for (Size i = 0; i < dim; ++i) {
+        Real* row = sensitivities[i];
+        for (Size k = 0; k < m; ++k)
+            row[k] *= parShifts_[i];
+    }
+}
+
 void ParSensitivityConverter::writeConversionMatrix(Report& report) const {
     
     // Report headers
@@ -2368,16 +2622,21 @@ void ParSensitivityConverter::writeConversionMatrix(Report& report) const {
     report.addColumn("ParFactor(c)", string());
     report.addColumn("dz/dc", double(), 12);
 
-    // Write report contents i.e. entries where sparse matrix is non-zero
+    // Write report contents i.e. entries where the inverse is non-zero, row parIdx of the inverse of the transposed
+    // Jacobian is the solution of the transposed system for the unit vector parIdx
     Size parIdx = 0;
+    boost::numeric::ublas::vector<Real> e(jacobi_transp_lu_.size(), 0.0);
     for (const auto& parKey : parKeys_) {
+        e[parIdx] = 1.0;
+        boost::numeric::ublas::vector<Real> row = jacobi_transp_lu_.solveTransposed(e);
+        e[parIdx] = 0.0;
         Size rawIdx = 0;
         for (const auto& rawKey : rawKeys_) {
-            if (!close(jacobi_transp_inv_(parIdx, rawIdx), 0.0)) {
+            if (!close(row[rawIdx], 0.0)) {
                 report.next();
                 report.add(to_string(rawKey));
                 report.add(to_string(parKey));
-                report.add(jacobi_transp_inv_(parIdx, rawIdx));
+                report.add(row[rawIdx]);
             }
             rawIdx++;
         }
@@ -25,6 +25,7 @@
 
 #include <orea/cube/npvcube.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <orea/scenario/sensitivityscenariodata.hpp>
@@ -36,8 +37,11 @@
 #include <ql/instruments/inflationcapfloor.hpp>
 #include <ql/math/matrixutilities/sparsematrix.hpp>
 
+#include <qle/math/sparselu.hpp>
+
 #include <boost/numeric/ublas/vector.hpp>
 
+#include <functional>
 #include <map>
 #include <set>
 #include <tuple>
@@ -101,7 +105,44 @@ public:
         return typesDisabled_;
     }
 
+    /*! Compute the par instrument sensitivities in \p nThreads worker threads. The zero shift scenarios are grouped
+        by curve and the curves are distributed over the workers, each worker reprices its own copy of the par
+        instruments built against a sim market returned by \p simMarketBuilder. The builder must return a sim market
+        with a ShiftScenarioGenerator producing the same scenarios as the one passed to
+        computeParInstrumentSensitivities(), it is called under a lock. */
+    void setParallel(const QuantLib::Size nThreads,
+                     const std::function<boost::shared_ptr<ore::analytics::ScenarioSimMarket>()>& simMarketBuilder) {
+        nThreads_ = nThreads;
+        simMarketBuilder_ = simMarketBuilder;
+    }
+
+    //! Set a thread pool to run the workers on, if not set, the workers are run in separate threads
+    void setThreadPool(const boost::shared_ptr<ThreadPool>& threadPool) { threadPool_ = threadPool; }
+
 private:
+    typedef std::pair<ore::analytics::RiskFactorKey::KeyType, std::string> CurveKey;
+
+    //! Compute the par rates and flat vols of the par instruments in the current state of \p simMarket
+    void computeBaseValues(const boost::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket,
+                           std::map<ore::analytics::RiskFactorKey, QuantLib::Real>& parRatesBase,
+                           std::map<ore::analytics::RiskFactorKey, QuantLib::Real>& parCapVols);
+
+    /*! Determine the par instruments notified by a change of the risk factors of each of the given curves, the par
+        instruments are left in their base state */
+    std::map<CurveKey, std::set<ore::analytics::RiskFactorKey>>
+    parInstrumentDependencies(const boost::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket,
+                              const std::set<CurveKey>& curves);
+
+    /*! Compute the sensitivities of the par instruments in \p dependencies w.r.t. the shift described by \p desc,
+        the scenario must be applied to \p simMarket already */
+    void processScenario(const boost::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket,
+                         const ShiftScenarioGenerator::ScenarioDescription& desc,
+                         const std::set<ore::analytics::RiskFactorKey>& dependencies,
+                         const std::map<ore::analytics::RiskFactorKey, QuantLib::Real>& parRatesBase,
+                         const std::map<ore::analytics::RiskFactorKey, QuantLib::Real>& parCapVols,
+                         ParContainer& parSensi, std::set<ore::analytics::RiskFactorKey>& parKeysNonZero,
+                         std::set<ore::analytics::RiskFactorKey>& rawKeysNonZero);
+
     //! Augment relevant risk factors
     void augmentRelevantRiskFactors();
 
@@ -233,6 +274,11 @@ private:
 
     // ql index names for which we want to remove today's fixing for the purpose of the par sensi calculation
     std::set<std::string> removeTodaysFixingIndices_;
+
+    // parallel computation of the par instrument sensitivities, see setParallel()
+    QuantLib::Size nThreads_ = 1;
+    std::function<boost::shared_ptr<ore::analytics::ScenarioSimMarket>()> simMarketBuilder_;
+    boost::shared_ptr<ThreadPool> threadPool_;
 };
 
 //! ParSensitivityConverter class
@@ -271,9 +317,14 @@ class ParSensitivityConverter {
 public:
     /*! Constructor where \p parSensitivities is the par rate sensitivities w.r.t. zero shifts \p shiftSizes gives 
         the absolute zero and par shift sizes for each risk factor key.
+
+        The transposed Jacobian is not inverted, its sparse LU factorisation is kept as the conversion operator.
+        If \p cacheDirectory is given, the factorisation is read from / written to a file in this directory, keyed
+        by a hash of the Jacobian, so that reruns on the same par configuration and market skip the factorisation.
     */
     ParSensitivityConverter(const ParSensitivityAnalysis::ParContainer& parSensitivities,
-        const std::map<ore::analytics::RiskFactorKey, std::pair<QuantLib::Real, QuantLib::Real>>& shiftSizes);
+        const std::map<ore::analytics::RiskFactorKey, std::pair<QuantLib::Real, QuantLib::Real>>& shiftSizes,
+        const std::string& cacheDirectory = "");
 
     //! Inspectors
     //@{
@@ -295,14 +346,20 @@ public:
     boost::numeric::ublas::vector<Real>
     convertSensitivity(const boost::numeric::ublas::vector<Real>& zeroSensitivities);
 
-    //! Write the inverse of the transposed Jacobian to the \p reportOut
+    //! Converts a block of zero sensitivities to par sensitivities in place
+    /*! \param sensitivities matrix with one column per trade, on input the rows hold the zero sensitivities ordered
+                             according to rawKeys(), on output the par sensitivities ordered according to parKeys()
+    */
+    void convertSensitivities(QuantLib::Matrix& sensitivities) const;
+
+    //! Write the inverse of the transposed Jacobian to the \p reportOut, the inverse is computed row by row
     void writeConversionMatrix(ore::data::Report& reportOut) const;
 
 private:
     std::set<ore::analytics::RiskFactorKey> rawKeys_;
     std::set<ore::analytics::RiskFactorKey> parKeys_;
-    // transposed inverse Jacobian, i.e. the matrix we use for the zero-par conversion effectively
-    QuantLib::SparseMatrix jacobi_transp_inv_;
+    // LU factorisation of the transposed Jacobian, the conversion applies its inverse per solve
+    QuantExt::SparseLU jacobi_transp_lu_;
     //! Vector of absolute zero shift sizes
     boost::numeric::ublas::vector<QuantLib::Real> zeroShifts_;
     //! Vector of absolute par shift sizes
@@ -21,6 +21,8 @@
 #include <orea/engine/sensitivityrecord.hpp>
 #include <orea/scenario/shiftscenariogenerator.hpp>
 
+#include <algorithm>
+
 using ore::analytics::deconstructFactor;
 using ore::analytics::SensitivityRecord;
 
@@ -29,8 +31,10 @@ namespace analytics {
 
 // Note: iterator initialisation below works because currentDeltas_ is
 //       (empty) initialised before itCurrent_
-ParSensitivityCubeStream::ParSensitivityCubeStream(const boost::shared_ptr<ZeroToParCube>& cube, const string& currency)
-    : cube_(cube), currency_(currency), tradeIdx_(cube_->zeroCube()->tradeIdx().begin()), itCurrent_(currentDeltas_.begin()) {
+ParSensitivityCubeStream::ParSensitivityCubeStream(const boost::shared_ptr<ZeroToParCube>& cube, const string& currency,
+                                                   Size blockSize)
+    : cube_(cube), currency_(currency), tradeIdx_(cube_->zeroCube()->tradeIdx().begin()),
+      itCurrent_(currentDeltas_.begin()), blockSize_(std::max<Size>(blockSize, 1)), blockPos_(0) {
     // Call init
     init();
 }
@@ -43,12 +47,8 @@ SensitivityRecord ParSensitivityCubeStream::next() {
         // Move to next trade
         tradeIdx_++;
         // update par deltas
-        if (tradeIdx_ != cube_->zeroCube()->tradeIdx().end()) {
-            DLOG("Retrieving par deltas for trade " << tradeIdx_->first);
-            currentDeltas_ = cube_->parDeltas(tradeIdx_->second);
-            itCurrent_ = currentDeltas_.begin();
-            DLOG("There are " << currentDeltas_.size() << " par deltas for trade " << tradeIdx_->first);
-        }
+        if (tradeIdx_ != cube_->zeroCube()->tradeIdx().end())
+            updateDeltas();
 
     }
     if (tradeIdx_ != cube_->zeroCube()->tradeIdx().end()) {
@@ -79,6 +79,8 @@ void ParSensitivityCubeStream::reset() {
     tradeIdx_ = cube_->zeroCube()->tradeIdx().begin();
     currentDeltas_ = {};
     itCurrent_ = currentDeltas_.begin();
+    blockDeltas_.clear();
+    blockPos_ = 0;
     // Call init
     init();
 }
@@ -87,11 +89,23 @@ void ParSensitivityCubeStream::init() {
     // If we have trade IDs in the underlying cube
     if (!cube_->zeroCube()->tradeIdx().empty()) {
         tradeIdx_ = cube_->zeroCube()->tradeIdx().begin();
-        DLOG("Retrieving par deltas for trade " << tradeIdx_->first);
-        currentDeltas_ = cube_->parDeltas(tradeIdx_->second);
-        itCurrent_ = currentDeltas_.begin();
-        DLOG("There are " << currentDeltas_.size() << " par deltas for trade " << tradeIdx_->first);
+        updateDeltas();
+    }
+}
+
+void ParSensitivityCubeStream::updateDeltas() {
+    if (blockPos_ == blockDeltas_.size()) {
+        // convert the par deltas for the block of trades starting with the current one
+        std::vector<Size> tradeIndices;
+        for (auto it = tradeIdx_; it != cube_->zeroCube()->tradeIdx().end() && tradeIndices.size() < blockSize_; ++it)
+            tradeIndices.push_back(it->second);
+        DLOG("Retrieving par deltas for " << tradeIndices.size() << " trades starting with " << tradeIdx_->first);
+        blockDeltas_ = cube_->parDeltas(tradeIndices);
+        blockPos_ = 0;
     }
+    currentDeltas_ = std::move(blockDeltas_[blockPos_++]);
+    itCurrent_ = currentDeltas_.begin();
+    DLOG("There are " << currentDeltas_.size() << " par deltas for trade " << tradeIdx_->first);
 }
 
 } // namespace analytics
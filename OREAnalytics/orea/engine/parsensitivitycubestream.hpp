@@ -26,6 +26,7 @@
 #include <orea/engine/zerotoparcube.hpp>
 
 #include <string>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -35,9 +36,11 @@ namespace analytics {
 class ParSensitivityCubeStream : public ore::analytics::SensitivityStream {
 public:
     /*! Constructor providing the sensitivity \p cube and currency of the
-        sensitivities
+        sensitivities. The par deltas are converted for blocks of \p blockSize
+        trades at once, see ZeroToParCube::parDeltas().
     */
-    ParSensitivityCubeStream(const boost::shared_ptr<ZeroToParCube>& cube, const std::string& currency);
+    ParSensitivityCubeStream(const boost::shared_ptr<ZeroToParCube>& cube, const std::string& currency,
+                             QuantLib::Size blockSize = 64);
 
     /*! Returns the next SensitivityRecord in the stream
 
@@ -59,9 +62,16 @@ private:
     std::map<ore::analytics::RiskFactorKey, QuantLib::Real> currentDeltas_;
     //! Iterator to current delta
     std::map<ore::analytics::RiskFactorKey, QuantLib::Real>::iterator itCurrent_;
+    //! Number of trades converted at once
+    QuantLib::Size blockSize_;
+    //! Par deltas for the current block of trades and position of the next trade in the block
+    std::vector<std::map<ore::analytics::RiskFactorKey, QuantLib::Real>> blockDeltas_;
+    QuantLib::Size blockPos_;
 
     //! Shared initialisation
     void init();
+    //! Set the par deltas for the current trade ID, converting the next block of trades if required
+    void updateDeltas();
 };
 
 } // namespace analytics
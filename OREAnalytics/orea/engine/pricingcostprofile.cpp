@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/pricingcostprofile.hpp>
+
+#include <ored/report/csvreport.hpp>
+#include <ored/utilities/csvfilereader.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+using QuantLib::Null;
+using QuantLib::Real;
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+void PricingCostProfile::fromFile(const std::string& fileName) {
+    LOG("Read pricing cost profile from file '" << fileName << "'");
+    ore::data::CSVFileReader reader(fileName, true);
+    Size n = 0;
+    while (reader.next()) {
+        Real numberOfPricings, averageTime;
+        if (!ore::data::tryParseReal(reader.get("NumberOfPricings"), numberOfPricings) ||
+            !ore::data::tryParseReal(reader.get("AverageTiming"), averageTime)) {
+            WLOG("PricingCostProfile: skip line " << reader.currentLine() << " in file '" << fileName
+                                                  << "', could not parse number of pricings or average timing");
+            continue;
+        }
+        setEntry(reader.get("TradeId"), {reader.get("TradeType"), static_cast<Size>(numberOfPricings), averageTime});
+        ++n;
+    }
+    reader.close();
+    LOG("Read " << n << " entries from pricing cost profile");
+}
+
+void PricingCostProfile::toFile(const std::string& fileName) const {
+    LOG("Write pricing cost profile with " << entries_.size() << " entries to file '" << fileName << "'");
+    ore::data::CSVFileReport report(fileName, ',', false);
+    report.addColumn("TradeId", std::string())
+        .addColumn("TradeType", std::string())
+        .addColumn("NumberOfPricings", Size())
+        .addColumn("AverageTiming", Real(), 0);
+    for (auto const& [tradeId, e] : entries_)
+        report.next().add(tradeId).add(e.tradeType).add(e.numberOfPricings).add(e.averageTime);
+    report.end();
+}
+
+void PricingCostProfile::update(const std::string& tradeId, const std::string& tradeType, const Size numberOfPricings,
+                                const double cumulativeTime) {
+    if (numberOfPricings == 0)
+        return;
+    setEntry(tradeId, {tradeType, numberOfPricings, cumulativeTime / static_cast<Real>(numberOfPricings)});
+}
+
+void PricingCostProfile::setEntry(const std::string& tradeId, const Entry& entry) {
+    if (auto e = entries_.find(tradeId); e != entries_.end()) {
+        auto& c = tradeTypeCosts_[e->second.tradeType];
+        c.first -= e->second.averageTime;
+        --c.second;
+    }
+    entries_[tradeId] = entry;
+    auto& c = tradeTypeCosts_[entry.tradeType];
+    c.first += entry.averageTime;
+    ++c.second;
+}
+
+Real PricingCostProfile::cost(const std::string& tradeId, const std::string& tradeType) const {
+    if (auto e = entries_.find(tradeId); e != entries_.end())
+        return e->second.averageTime;
+    // fallback estimate for new trades, the average over the known trades of the same type
+    if (auto c = tradeTypeCosts_.find(tradeType); c != tradeTypeCosts_.end() && c->second.second > 0)
+        return c->second.first / static_cast<Real>(c->second.second);
+    return Null<Real>();
+}
+
+} // namespace analytics
+} // namespace ore
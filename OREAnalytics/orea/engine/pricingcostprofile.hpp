@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/pricingcostprofile.hpp
+    \brief average pricing times by trade that can be persisted across runs
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <map>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Average pricing time by trade id and trade type
+/*! The profile is used by the MultiThreadedValuationEngine to balance the split of a portfolio over the worker threads
+    before any scenario pricing has taken place in the current process. It is populated from the pricing stats of a
+    previous run and can be written to and read from a csv file with the columns TradeId, TradeType, NumberOfPricings
+    and AverageTiming (in nanoseconds), so that e.g. a daily batch can reuse the profile of the previous day.
+
+    For trades not contained in the profile the average pricing time over all trades of the same trade type is used as
+    an estimate.
+*/
+class PricingCostProfile {
+public:
+    PricingCostProfile() {}
+
+    //! Read the profile from a csv file, existing entries are overwritten
+    void fromFile(const std::string& fileName);
+    //! Write the profile to a csv file
+    void toFile(const std::string& fileName) const;
+
+    /*! Set the average pricing time for a trade from the given stats, if the number of pricings is zero the update is
+        ignored. This overwrites a previous entry for the trade. */
+    void update(const std::string& tradeId, const std::string& tradeType, const QuantLib::Size numberOfPricings,
+                const double cumulativeTime);
+
+    /*! The average pricing time in nanoseconds of a trade, or - if the trade is not known - the average of the trades
+        of the same type, or Null<Real> if there is no trade of that type in the profile either */
+    QuantLib::Real cost(const std::string& tradeId, const std::string& tradeType) const;
+
+    //! Number of trades in the profile
+    QuantLib::Size size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::string tradeType;
+        QuantLib::Size numberOfPricings;
+        QuantLib::Real averageTime;
+    };
+    void setEntry(const std::string& tradeId, const Entry& entry);
+    std::map<std::string, Entry> entries_;
+    // sum of average times and number of trades by trade type
+    std::map<std::string, std::pair<QuantLib::Real, QuantLib::Size>> tradeTypeCosts_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -21,6 +21,8 @@
 #include <ored/utilities/log.hpp>
 #include <ql/errors.hpp>
 
+#include <vector>
+
 using ore::analytics::ScenarioFilter;
 using std::function;
 using std::map;
@@ -53,27 +55,46 @@ void SensitivityAggregator::aggregate(SensitivityStream& ss, const boost::shared
     // Ensure at start of stream
     ss.reset();
 
-    // Loop over stream's records
-    while (SensitivityRecord sr = ss.next()) {
-        // Skip this record if the risk factor is not in the filter
-        if (!sr.isCrossGamma() && !filter->allow(sr.key_1))
-            continue;
-        if (sr.isCrossGamma() && (!filter->allow(sr.key_1) || !filter->allow(sr.key_2)))
-            continue;
-
-        // "Blank out" trade ID before adding
-        string tradeId = sr.tradeId;
-        sr.tradeId = "";
-
-        // Update aggRecords_ for each category
-        for (const auto& kv : categories_) {
-            // Check if the sensitivity record's trade ID is in the category
-            if (kv.second(tradeId)) {
-                DLOG("Updating aggregated sensitivities for category " << kv.first << " with record: " << sr);
-                add(sr, aggRecords_[kv.first]);
+    /* The records come grouped by trade, so the categories of a trade are determined once when the trade changes
+       and the records are then added to the aggregated records of these categories directly */
+    string currentTradeId;
+    bool first = true;
+    std::vector<std::pair<const string*, set<SensitivityRecord>*>> tradeCategories;
+
+    // Loop over stream's records, in batches into a reused buffer
+    std::vector<SensitivityRecord> buffer(1024);
+    Size n;
+    do {
+        n = ss.nextBatch(buffer);
+        for (Size i = 0; i < n; ++i) {
+            SensitivityRecord& sr = buffer[i];
+            // Skip this record if the risk factor is not in the filter
+            if (!sr.isCrossGamma() && !filter->allow(sr.key_1))
+                continue;
+            if (sr.isCrossGamma() && (!filter->allow(sr.key_1) || !filter->allow(sr.key_2)))
+                continue;
+
+            if (first || sr.tradeId != currentTradeId) {
+                first = false;
+                currentTradeId = sr.tradeId;
+                tradeCategories.clear();
+                for (const auto& kv : categories_) {
+                    // Check if the sensitivity record's trade ID is in the category
+                    if (kv.second(currentTradeId))
+                        tradeCategories.push_back(std::make_pair(&kv.first, &aggRecords_[kv.first]));
+                }
+            }
+
+            // "Blank out" trade ID before adding
+            sr.tradeId.clear();
+
+            // Update aggRecords_ for each category of the trade
+            for (const auto& [category, records] : tradeCategories) {
+                DLOG("Updating aggregated sensitivities for category " << *category << " with record: " << sr);
+                add(sr, *records);
             }
         }
-    }
+    } while (n == buffer.size());
 }
 
 void SensitivityAggregator::reset() {
@@ -96,7 +117,7 @@ const set<SensitivityRecord>& SensitivityAggregator::sensitivities(const string&
 void SensitivityAggregator::generateDeltaGamma(const string& category, map<RiskFactorKey, Real>& deltas,
     map<CrossPair, Real>& gammas) {
 
-    auto srs = sensitivities(category);
+    const auto& srs = sensitivities(category);
     for (const auto& sr : srs) {
         if (!sr.isCrossGamma()) {
             QL_REQUIRE(deltas.count(sr.key_1) == 0,
@@ -141,7 +162,7 @@ void SensitivityAggregator::add(SensitivityRecord& sr, set<SensitivityRecord>& r
 
 bool SensitivityAggregator::inCategory(const string& tradeId, const string& category) const {
     QL_REQUIRE(setCategories_.count(category), "The category " << category << " is not valid");
-    auto tradeIds = setCategories_.at(category);
+    const auto& tradeIds = setCategories_.at(category);
     for (auto it = tradeIds.begin(); it != tradeIds.end(); ++it) {
         if (it->first == tradeId)
             return true;
@@ -25,6 +25,7 @@
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/osutils.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <ql/errors.hpp>
 #include <ql/instruments/makeois.hpp>
 #include <ql/instruments/makevanillaswap.hpp>
@@ -45,6 +46,8 @@
 #include <qle/pricingengines/depositengine.hpp>
 #include <qle/pricingengines/discountingfxforwardengine.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -79,12 +82,16 @@ std::vector<boost::shared_ptr<ValuationCalculator>> SensitivityAnalysis::buildVa
 }
 
 void SensitivityAnalysis::initialize(boost::shared_ptr<NPVSensiCube>& cube) {
+    TraceSpan span("sensitivity", "SensitivityAnalysis::initialize");
     LOG("Build Sensitivity Scenario Generator and Simulation Market");
     initializeSimMarket();
 
     LOG("Build Engine Factory and rebuild portfolio");
     boost::shared_ptr<EngineFactory> factory = buildFactory();
+    // record the market requests of the trades, these determine the trades repriced in the incremental valuation
+    simMarket_->setRecordRequests(incrementalValuation_ || analyticDeltas_);
     resetPortfolio(factory);
+    simMarket_->setRecordRequests(false);
     if (recalibrateModels_)
         modelBuilders_ = factory->modelBuilders();
     else
@@ -104,14 +111,22 @@ void SensitivityAnalysis::initialize(boost::shared_ptr<NPVSensiCube>& cube) {
 
 void SensitivityAnalysis::generateSensitivities(boost::shared_ptr<NPVSensiCube> cube) {
 
+    TraceSpan span("sensitivity", "SensitivityAnalysis::generateSensitivities");
+    span.arg("trades", portfolio_->size());
+
     QL_REQUIRE(!initialized_, "unexpected state of SensitivitiesAnalysis object");
 
+    // restrict the cross gammas to the material pairs, if configured
+    selectCrossGammaPairs();
+
     // initialize the helper member objects
     initialize(cube);
     QL_REQUIRE(initialized_, "SensitivitiesAnalysis member objects not correctly initialized");
     boost::shared_ptr<DateGrid> dg = boost::make_shared<DateGrid>("1,0W", NullCalendar());
     vector<boost::shared_ptr<ValuationCalculator>> calculators = buildValuationCalculators();
     ValuationEngine engine(asof_, dg, simMarket_, modelBuilders_);
+    engine.setIncrementalValuation(incrementalValuation_ || analyticDeltas_);
+    engine.setAnalyticDeltas(analyticDeltas_, validateAnalyticDeltas_);
     for (auto const& i : this->progressIndicators())
         engine.registerProgressIndicator(i);
     LOG("Run Sensitivity Scenarios");
@@ -122,6 +137,92 @@ void SensitivityAnalysis::generateSensitivities(boost::shared_ptr<NPVSensiCube>
     LOG("Sensitivity analysis completed");
 }
 
+void SensitivityAnalysis::selectCrossGammaPairs() {
+
+    if (dryRun_ || sensitivityData_->crossGammaFilter().empty() ||
+        sensitivityData_->crossGammaMaterialityThreshold() == Null<Real>())
+        return;
+
+    Real threshold = sensitivityData_->crossGammaMaterialityThreshold();
+    LOG("Select cross gamma pairs with materiality threshold " << threshold << ", run delta scenarios first");
+
+    // delta pre-pass, the empty filter makes sure we do not end up here again
+    boost::shared_ptr<SensitivityScenarioData> fullData = sensitivityData_;
+    auto deltaData = boost::make_shared<SensitivityScenarioData>(*fullData);
+    deltaData->computeGamma() = false;
+    deltaData->crossGammaFilter().clear();
+    deltaData->crossGammaPairs().clear();
+    sensitivityData_ = deltaData;
+    generateSensitivities();
+    boost::shared_ptr<SensitivityCube> deltaCube = sensiCube_;
+
+    // the factors that appear in the filter and their key names
+    const auto& filter = fullData->crossGammaFilter();
+    std::map<RiskFactorKey, string> candidates;
+    for (auto const& d : deltaCube->scenarioDescriptions()) {
+        if (d.type() != ScenarioDescription::Type::Up)
+            continue;
+        string keyName = d.keyName1();
+        if (std::any_of(filter.begin(), filter.end(), [&keyName](const pair<string, string>& p) {
+                return p.first == keyName || p.second == keyName;
+            }))
+            candidates[d.key1()] = keyName;
+    }
+
+    // pairs of factors that are both material for at least one trade
+    std::map<RiskFactorKey, Real> maxAbsDelta;
+    std::set<SensitivityCube::crossPair> material;
+    for (auto const& [tradeId, tradeIdx] : deltaCube->tradeIdx()) {
+        vector<RiskFactorKey> materialFactors;
+        for (auto const& [key, _] : candidates) {
+            auto up = deltaCube->upFactors().find(key);
+            if (up == deltaCube->upFactors().end())
+                continue;
+            auto down = deltaCube->downFactors().find(key);
+            Real d = deltaCube->twoSidedDelta(key.keytype) && down != deltaCube->downFactors().end()
+                         ? deltaCube->delta(tradeIdx, up->second.index, down->second.index)
+                         : deltaCube->delta(tradeIdx, up->second.index);
+            Real& m = maxAbsDelta[key];
+            m = std::max(m, std::abs(d));
+            if (std::abs(d) > threshold)
+                materialFactors.push_back(key);
+        }
+        for (Size i = 0; i < materialFactors.size(); ++i)
+            for (Size j = i + 1; j < materialFactors.size(); ++j)
+                material.insert(std::make_pair(materialFactors[i], materialFactors[j]));
+    }
+
+    // split the pairs allowed by the filter into selected and skipped pairs
+    std::set<SensitivityCube::crossPair> selected;
+    skippedCrossGammaPairs_.clear();
+    for (auto i = candidates.begin(); i != candidates.end(); ++i) {
+        for (auto j = std::next(i); j != candidates.end(); ++j) {
+            const string &n1 = i->second, &n2 = j->second;
+            if (std::none_of(filter.begin(), filter.end(), [&n1, &n2](const pair<string, string>& p) {
+                    return (p.first == n1 && p.second == n2) || (p.first == n2 && p.second == n1);
+                }))
+                continue;
+            auto p = std::make_pair(i->first, j->first);
+            if (material.count(p) > 0)
+                selected.insert(p);
+            else
+                skippedCrossGammaPairs_[p] = std::make_pair(maxAbsDelta[i->first], maxAbsDelta[j->first]);
+        }
+    }
+    LOG("Selected " << selected.size() << " cross gamma pairs, skipped " << skippedCrossGammaPairs_.size()
+                    << " pairs below the materiality threshold");
+
+    // reset the state for the main run
+    auto data = boost::make_shared<SensitivityScenarioData>(*fullData);
+    if (selected.empty())
+        data->crossGammaFilter().clear();
+    else
+        data->crossGammaPairs() = selected;
+    sensitivityData_ = data;
+    sensiCube_ = nullptr;
+    initialized_ = computed_ = false;
+}
+
 void SensitivityAnalysis::initializeSimMarket(boost::shared_ptr<ScenarioFactory> scenFact) {
 
     LOG("Initialise sim market for sensitivity analysis (continueOnError=" << std::boolalpha << continueOnError_
@@ -156,6 +257,8 @@ boost::shared_ptr<EngineFactory> SensitivityAnalysis::buildFactory() const {
     auto ed = boost::make_shared<EngineData>(*engineData_);
     ed->globalParameters()["RunType"] =
         std::string("Sensitivity") + (sensitivityData_->computeGamma() ? "DeltaGamma" : "Delta");
+    if (analyticDeltas_)
+        ed->globalParameters()["ZeroRateDependencies"] = "true";
     boost::shared_ptr<EngineFactory> factory =
         boost::make_shared<EngineFactory>(ed, simMarket_, configurations, referenceData_, iborFallbackConfig_);
     return factory;
@@ -102,12 +102,29 @@ public:
     //! override shift tenors with sim market tenors
     void overrideTenors(const bool b) { overrideTenors_ = b; }
 
+    //! only reprice trades depending on the shifted risk factors, see ValuationEngine::setIncrementalValuation()
+    void setIncrementalValuation(const bool b) { incrementalValuation_ = b; }
+
+    /*! value trades with linear yield curve dependencies analytically in the yield curve scenarios, optionally
+        validated against a full revaluation, see ValuationEngine::setAnalyticDeltas(); this implies incremental
+        valuation */
+    void setAnalyticDeltas(const bool b, const bool validate = false) {
+        analyticDeltas_ = b;
+        validateAnalyticDeltas_ = validate;
+    }
+
     //! the portfolio of trades
     boost::shared_ptr<Portfolio> portfolio() const { return portfolio_; }
 
     //! a wrapper for the sensitivity results cube
     boost::shared_ptr<SensitivityCube> sensiCube() const { return sensiCube_; }
 
+    /*! the cross gamma pairs matching the cross gamma filter that were dropped by the materiality check, together
+        with the maximum absolute delta over all trades w.r.t. the first and second factor of the pair */
+    const std::map<SensitivityCube::crossPair, std::pair<Real, Real>>& skippedCrossGammaPairs() const {
+        return skippedCrossGammaPairs_;
+    }
+
 protected:
     //! initialize the various components that will be passed to the sensitivities valuation engine
     virtual void initialize(boost::shared_ptr<NPVSensiCube>& cube);
@@ -124,6 +141,11 @@ protected:
     //! build valuation calculators for valuation engine
     virtual std::vector<boost::shared_ptr<ValuationCalculator>> buildValuationCalculators() const;
 
+    /*! if a cross gamma materiality threshold is configured, run a delta only pre-pass and restrict the cross gamma
+        scenarios to the pairs for which at least one trade has an absolute delta above the threshold w.r.t. both
+        factors, the sensitivity data is replaced by a copy holding the selected pairs */
+    void selectCrossGammaPairs();
+
     boost::shared_ptr<ore::data::Market> market_;
     std::string marketConfiguration_;
     Date asof_;
@@ -137,6 +159,8 @@ protected:
     //! Optional todays market parameters. Used in building the scenario sim market.
     boost::shared_ptr<ore::data::TodaysMarketParameters> todaysMarketParams_;
     bool overrideTenors_;
+    bool incrementalValuation_ = false;
+    bool analyticDeltas_ = false, validateAnalyticDeltas_ = false;
 
     // if true, convert sensis to base currency using the original (non-shifted) FX rate
     bool nonShiftedBaseCurrencyConversion_;
@@ -157,6 +181,8 @@ protected:
     std::set<std::pair<string, boost::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders_;
     //! sensitivityCube
     boost::shared_ptr<SensitivityCube> sensiCube_;
+    //! cross gamma pairs dropped by selectCrossGammaPairs()
+    std::map<SensitivityCube::crossPair, std::pair<Real, Real>> skippedCrossGammaPairs_;
 };
 
 /*! Returns the absolute shift size corresponding to a particular risk factor \p key
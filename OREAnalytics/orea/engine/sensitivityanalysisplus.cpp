@@ -21,6 +21,7 @@
 #include <orea/scenario/scenariosimmarketplus.hpp>
 #include <orea/engine/sensitivityanalysisplus.hpp>
 
+#include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/jointnpvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
@@ -82,7 +83,10 @@ void SensitivityAnalysisPlus::initialize(boost::shared_ptr<ore::analytics::NPVSe
 
     LOG("Build Engine Factory and rebuild portfolio");
     boost::shared_ptr<EngineFactory> factory = buildFactory();
+    // record the market requests of the trades, these determine the trades repriced in the incremental valuation
+    simMarket_->setRecordRequests(incrementalValuation_ || analyticDeltas_);
     resetPortfolio(factory);
+    simMarket_->setRecordRequests(false);
     if (recalibrateModels_)
         modelBuilders_ = factory->modelBuilders();
     else
@@ -132,6 +136,9 @@ void SensitivityAnalysisPlus::generateSensitivities(boost::shared_ptr<NPVSensiCu
 
     // handle request to use multi-threaded engine
 
+    // restrict the cross gammas to the material pairs, if configured
+    selectCrossGammaPairs();
+
     LOG("SensitivitiyAnalysis::generateSensitivities(): use multi-threaded engine to generate sensi cube.");
 
     market_ =
@@ -154,17 +161,33 @@ void SensitivityAnalysisPlus::generateSensitivities(boost::shared_ptr<NPVSensiCu
     auto ed = boost::make_shared<EngineData>(*engineData_);
     ed->globalParameters()["RunType"] =
         std::string("Sensitivity") + (sensitivityData_->computeGamma() ? "DeltaGamma" : "Delta");
+    if (analyticDeltas_)
+        ed->globalParameters()["ZeroRateDependencies"] = "true";
+
+    /* in the scenario-parallel mode all threads write into one cube concurrently, which the sparse sensi cube does not
+       support, so a dense cube is used and copied into a sensi cube after the run */
 
+    bool scenarioParallel = scenarioParallel_;
     MultiThreadedValuationEngine engine(
         nThreads_, asof_, boost::make_shared<ore::analytics::DateGrid>(), scenarioGenerator_->numScenarios(), loader_,
         scenarioGenerator_, ed, curveConfigs_, todaysMarketParams_, marketConfiguration_, simMarketData_,
         sensitivityData_->useSpreadedTermStructures(), false, boost::make_shared<ore::analytics::ScenarioFilter>(),
         referenceData_, iborFallbackConfig_, true, true,
-        [](const QuantLib::Date& asof, const std::set<std::string>& ids, const std::vector<QuantLib::Date>&,
-           const QuantLib::Size samples) {
+        [scenarioParallel](const QuantLib::Date& asof, const std::set<std::string>& ids,
+                           const std::vector<QuantLib::Date>& dates,
+                           const QuantLib::Size samples) -> boost::shared_ptr<ore::analytics::NPVCube> {
+            if (scenarioParallel)
+                return boost::make_shared<ore::analytics::DoublePrecisionInMemoryCube>(asof, ids, dates, samples);
             return boost::make_shared<ore::analytics::DoublePrecisionSensiCube>(ids, asof, samples);
         },
         {}, {}, context_);
+    engine.setIncrementalValuation(incrementalValuation_ || analyticDeltas_);
+    engine.setAnalyticDeltas(analyticDeltas_, validateAnalyticDeltas_);
+    engine.setThreadPool(threadPool_);
+    engine.setThreadPlacement(threadPlacement_);
+    engine.setSampleParallel(scenarioParallel_);
+    if (shareTodaysMarket_ && !sensitivityData_->useSpreadedTermStructures())
+        engine.setShareTodaysMarket(true);
     for (auto const& i : this->progressIndicators())
         engine.registerProgressIndicator(i);
 
@@ -175,13 +198,28 @@ void SensitivityAnalysisPlus::generateSensitivities(boost::shared_ptr<NPVSensiCu
             return {boost::make_shared<NPVCalculator>(baseCcy)};
         },
         {}, true, dryRun_);
-    std::vector<boost::shared_ptr<NPVSensiCube>> miniCubes;
-    for (auto const& c : engine.outputCubes()) {
-        miniCubes.push_back(boost::dynamic_pointer_cast<NPVSensiCube>(c));
-        QL_REQUIRE(miniCubes.back() != nullptr,
-                   "SensitivityAnalysis::generateSensitivities(): internal error, could not cast to NPVSensiCube.");
+    if (scenarioParallel_) {
+        QL_REQUIRE(engine.outputCubes().size() == 1, "SensitivityAnalysis::generateSensitivities(): internal error, "
+                                                     "expected one output cube in the scenario-parallel mode, got "
+                                                         << engine.outputCubes().size());
+        auto denseCube = engine.outputCubes().front();
+        auto sensiCube = boost::make_shared<DoublePrecisionSensiCube>(portfolio_->ids(), asof_, denseCube->samples());
+        for (auto const& [id, pos] : sensiCube->idsAndIndexes()) {
+            Size densePos = denseCube->getTradeIndex(id);
+            sensiCube->setT0(denseCube->getT0(densePos), pos, 0);
+            for (Size k = 0; k < denseCube->samples(); ++k)
+                sensiCube->set(denseCube->get(densePos, 0, k), pos, 0, k, 0);
+        }
+        cube = sensiCube;
+    } else {
+        std::vector<boost::shared_ptr<NPVSensiCube>> miniCubes;
+        for (auto const& c : engine.outputCubes()) {
+            miniCubes.push_back(boost::dynamic_pointer_cast<NPVSensiCube>(c));
+            QL_REQUIRE(miniCubes.back() != nullptr,
+                       "SensitivityAnalysis::generateSensitivities(): internal error, could not cast to NPVSensiCube.");
+        }
+        cube = boost::make_shared<JointNPVSensiCube>(miniCubes, portfolio_->ids());
     }
-    cube = boost::make_shared<JointNPVSensiCube>(miniCubes, portfolio_->ids());
 
     sensiCube_ =
         boost::make_shared<SensitivityCube>(cube, scenarioGenerator_->scenarioDescriptions(),
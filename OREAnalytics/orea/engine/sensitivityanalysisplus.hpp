@@ -24,6 +24,8 @@
 #pragma once
 
 #include <orea/engine/sensitivityanalysis.hpp>
+#include <orea/engine/threadplacement.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 #include <orea/scenario/scenariosimmarketplus.hpp>
@@ -98,6 +100,22 @@ public:
     void generateSensitivities(boost::shared_ptr<ore::analytics::NPVSensiCube> cube =
                                    boost::shared_ptr<ore::analytics::NPVSensiCube>()) override;
 
+    //! run the jobs of the multi-threaded engine on a shared thread pool, see MultiThreadedValuationEngine
+    void setThreadPool(const boost::shared_ptr<ThreadPool>& threadPool) { threadPool_ = threadPool; }
+
+    /*! parallelise the multi-threaded engine over the sensitivity scenarios instead of the trades: each thread builds
+        the full portfolio against its own sim market and processes a contiguous block of the shift scenarios, see
+        MultiThreadedValuationEngine::setSampleParallel(); the threads write into one dense cube which is copied into
+        the sensi cube after the run, so the memory consumption during the run is proportional to the number of trades
+        times the number of scenarios */
+    void setScenarioParallel(const bool scenarioParallel) { scenarioParallel_ = scenarioParallel; }
+
+    /*! build the T0 market only once and build the sim markets of the threads from it, see
+        MultiThreadedValuationEngine::setShareTodaysMarket(); ignored if spreaded term structures are used */
+    void setShareTodaysMarket(const bool shareTodaysMarket) { shareTodaysMarket_ = shareTodaysMarket; }
+    //! can be optionally called to pin the worker threads to the NUMA nodes, see MultiThreadedValuationEngine
+    void setThreadPlacement(const ThreadPlacement threadPlacement) { threadPlacement_ = threadPlacement; }
+
 protected:
     //! initialize the SensitivityScenarioGenerator that determines which sensitivities to compute
     virtual void initializeSimMarket(boost::shared_ptr<ore::analytics::ScenarioFactory> scenFact = {}) override;
@@ -116,6 +134,10 @@ private:
     Size nThreads_;
     boost::shared_ptr<ore::data::Loader> loader_;
     std::string context_;
+    boost::shared_ptr<ThreadPool> threadPool_;
+    bool scenarioParallel_ = false;
+    bool shareTodaysMarket_ = false;
+    ThreadPlacement threadPlacement_ = ThreadPlacement::None;
 };
 } // namespace analytics
 } // namespace ore
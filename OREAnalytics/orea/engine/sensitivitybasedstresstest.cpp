@@ -0,0 +1,188 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/sensitivitybasedstresstest.hpp>
+#include <orea/scenario/clonescenariofactory.hpp>
+#include <orea/scenario/scenarioshiftcalculator.hpp>
+#include <orea/scenario/stressscenariogenerator.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/math/matrix.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+using namespace std;
+
+namespace ore {
+namespace analytics {
+
+SensitivityBasedStressTest::SensitivityBasedStressTest(const boost::shared_ptr<SensitivityCube>& sensiCube,
+                                                       const boost::shared_ptr<SensitivityScenarioData>& sensiData,
+                                                       const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                                       const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                                                       const boost::shared_ptr<StressTestScenarioData>& stressData,
+                                                       const Real errorThreshold) {
+
+    QL_REQUIRE(sensiCube, "SensitivityBasedStressTest: no sensitivity cube given");
+    QL_REQUIRE(simMarket, "SensitivityBasedStressTest: no simulation market given");
+
+    LOG("Build Stress Scenario Generator for sensitivity based stress test");
+    boost::shared_ptr<Scenario> baseScenario = simMarket->baseScenario();
+    auto scenarioGenerator = boost::make_shared<StressScenarioGenerator>(
+        stressData, baseScenario, simMarketData, simMarket, boost::make_shared<CloneScenarioFactory>(baseScenario));
+
+    // shifts of the cube factors in the stress scenarios, in multiples of the sensitivity shift sizes
+    LOG("Compute stress scenario shifts in terms of the sensitivity factors");
+    ScenarioShiftCalculator shiftCalculator(sensiData, simMarketData, simMarket);
+    const auto& factors = sensiCube->factorTable();
+    const auto& crossFactors = sensiCube->crossFactorTable();
+    Size nScenarios = scenarioGenerator->samples();
+    Matrix shifts(factors.size(), nScenarios, 0.0);
+    vector<string> labels(nScenarios);
+    set<RiskFactorKey> factorKeys;
+    for (auto const& f : factors)
+        factorKeys.insert(f.key);
+    set<RiskFactorKey> uncovered;
+    for (Size j = 0; j < nScenarios; ++j) {
+        const boost::shared_ptr<Scenario>& scenario = scenarioGenerator->scenarios()[j];
+        labels[j] = scenario->label();
+        labels_.insert(labels[j]);
+        for (Size k = 0; k < factors.size(); ++k) {
+            if (scenario->has(factors[k].key))
+                shifts[k][j] = shiftCalculator.shift(factors[k].key, *baseScenario, *scenario);
+        }
+        for (auto const& key : scenario->keys()) {
+            if (factorKeys.count(key) == 0 && baseScenario->has(key) &&
+                !close_enough(scenario->get(key), baseScenario->get(key)))
+                uncovered.insert(key);
+        }
+    }
+    for (auto const& key : uncovered)
+        WLOG("SensitivityBasedStressTest: stress shift of risk factor " << key
+                                                                        << " is not covered by the sensitivities");
+
+    // expansion per trade, one pass over the trade's factors for all scenarios
+    LOG("Compute sensitivity based stress NPVs");
+    vector<Real> firstOrder(nScenarios), secondOrder(nScenarios);
+    vector<Size> tradeFactors;
+    for (auto const& [tradeId, i] : sensiCube->tradeIdx()) {
+        trades_.insert(tradeId);
+        Real npv0 = sensiCube->npv(i);
+        baseNPV_[tradeId] = npv0;
+        std::fill(firstOrder.begin(), firstOrder.end(), 0.0);
+        std::fill(secondOrder.begin(), secondOrder.end(), 0.0);
+
+        tradeFactors.clear();
+        for (auto const idx : sensiCube->npvCube()->getTradeScenarios(i)) {
+            if (Size pos = sensiCube->factorPosition(idx); pos != Null<Size>())
+                tradeFactors.push_back(pos);
+        }
+        std::sort(tradeFactors.begin(), tradeFactors.end());
+        tradeFactors.erase(std::unique(tradeFactors.begin(), tradeFactors.end()), tradeFactors.end());
+
+        for (auto const k : tradeFactors) {
+            const auto& f = factors[k];
+            bool hasDown = f.downIndex != Null<Size>();
+            Real d = f.twoSidedDelta && hasDown ? sensiCube->delta(i, f.up.index, f.downIndex)
+                                                : sensiCube->delta(i, f.up.index);
+            Real g = hasDown ? sensiCube->gamma(i, f.up.index, f.downIndex) : 0.0;
+            for (Size j = 0; j < nScenarios; ++j) {
+                Real x = shifts[k][j];
+                firstOrder[j] += d * x;
+                secondOrder[j] += 0.5 * g * x * x;
+            }
+        }
+
+        for (auto const& c : crossFactors) {
+            Real cg = sensiCube->crossGamma(i, c.first.index, c.second.index, c.index);
+            if (close_enough(cg, 0.0))
+                continue;
+            for (Size j = 0; j < nScenarios; ++j)
+                secondOrder[j] += cg * shifts[c.firstPos][j] * shifts[c.secondPos][j];
+        }
+
+        for (Size j = 0; j < nScenarios; ++j) {
+            pair<string, string> p(tradeId, labels[j]);
+            Real d = firstOrder[j] + secondOrder[j];
+            shiftedNPV_[p] = npv0 + d;
+            delta_[p] = d;
+            Real denominator = std::abs(firstOrder[j]) + std::abs(secondOrder[j]);
+            Real indicator = close_enough(denominator, 0.0) ? 0.0 : std::abs(secondOrder[j]) / denominator;
+            errorIndicator_[p] = indicator;
+            if (indicator > errorThreshold)
+                fullRevaluationTrades_.insert(tradeId);
+        }
+    }
+
+    LOG("Sensitivity based stress testing done, " << fullRevaluationTrades_.size() << " out of " << trades_.size()
+                                                  << " trades are flagged for full revaluation");
+}
+
+void SensitivityBasedStressTest::setFullRevaluationResults(StressTest& stressTest) {
+    for (auto const& tradeId : stressTest.trades()) {
+        QL_REQUIRE(trades_.count(tradeId) == 1,
+                   "SensitivityBasedStressTest: trade " << tradeId << " from full revaluation is unknown");
+        baseNPV_[tradeId] = stressTest.baseNPV().at(tradeId);
+        for (auto const& label : labels_) {
+            pair<string, string> p(tradeId, label);
+            auto npv = stressTest.shiftedNPV().find(p);
+            QL_REQUIRE(npv != stressTest.shiftedNPV().end(), "SensitivityBasedStressTest: no full revaluation for trade "
+                                                                 << tradeId << " and scenario " << label);
+            shiftedNPV_[p] = npv->second;
+            delta_[p] = stressTest.delta().at(p);
+        }
+        revaluedTrades_.insert(tradeId);
+    }
+}
+
+void SensitivityBasedStressTest::writeReport(const boost::shared_ptr<ore::data::Report>& report,
+                                             Real outputThreshold) {
+
+    report->addColumn("TradeId", string());
+    report->addColumn("ScenarioLabel", string());
+    report->addColumn("Base NPV", double(), 2);
+    report->addColumn("Scenario NPV", double(), 2);
+    report->addColumn("Sensitivity", double(), 2);
+    report->addColumn("ErrorIndicator", double(), 4);
+    report->addColumn("FullRevaluation", string());
+
+    for (auto const& [p, npv] : shiftedNPV_) {
+        Real base = baseNPV_.at(p.first);
+        Real sensi = npv - base;
+        if (fabs(sensi) > outputThreshold) {
+            report->next();
+            report->add(p.first);
+            report->add(p.second);
+            report->add(base);
+            report->add(npv);
+            report->add(sensi);
+            report->add(errorIndicator_.at(p));
+            report->add(string(revaluedTrades_.count(p.first) == 1 ? "true" : "false"));
+        }
+    }
+
+    report->end();
+}
+
+} // namespace analytics
+} // namespace ore
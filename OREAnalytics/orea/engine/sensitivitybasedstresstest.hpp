@@ -0,0 +1,103 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file engine/sensitivitybasedstresstest.hpp
+    \brief stress test based on a second order expansion in the sensitivities
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/cube/sensitivitycube.hpp>
+#include <orea/engine/stresstest.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/sensitivityscenariodata.hpp>
+#include <orea/scenario/stressscenariodata.hpp>
+#include <ored/report/report.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Sensitivity based stress test
+/*! This class approximates the NPV impact of the stress scenarios by a second order Taylor expansion in the deltas,
+    gammas and cross gammas of an existing sensitivity cube instead of a full revaluation of the portfolio. It
+
+    - generates the stress scenarios on the simulation market of the sensitivity analysis
+    - converts each stress scenario to multiples of the sensitivity shift sizes using the ScenarioShiftCalculator,
+      giving a matrix of shifts with one row per factor of the sensitivity cube and one column per stress scenario
+    - computes the NPV change of each trade under all scenarios as the product of its sensitivity vector with this
+      matrix, plus the gamma and cross gamma terms
+
+    For each trade and scenario an error indicator is computed as the ratio of the absolute second order term to the
+    sum of the absolute first and second order terms. Trades for which the indicator exceeds the given threshold in at
+    least one scenario are flagged for a full revaluation, see fullRevaluationTrades(). Their results can be replaced
+    by those of a StressTest run on these trades only, see setFullRevaluationResults().
+
+    Stress scenario shifts of risk factors which are not part of the sensitivity configuration are not captured by
+    the approximation, a warning is logged for them.
+
+    \ingroup simulation
+*/
+class SensitivityBasedStressTest {
+public:
+    SensitivityBasedStressTest(const boost::shared_ptr<SensitivityCube>& sensiCube,
+                               const boost::shared_ptr<SensitivityScenarioData>& sensiData,
+                               const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                               const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                               const boost::shared_ptr<StressTestScenarioData>& stressData,
+                               const QuantLib::Real errorThreshold = 0.1);
+
+    //! Return set of trades analysed
+    const std::set<std::string>& trades() const { return trades_; }
+    //! Return unique set of stress scenario labels
+    const std::set<std::string>& stressTests() const { return labels_; }
+    //! Return base NPV by trade, before shift
+    const std::map<std::string, QuantLib::Real>& baseNPV() const { return baseNPV_; }
+    //! Return shifted NPVs by trade and scenario
+    const std::map<std::pair<std::string, std::string>, QuantLib::Real>& shiftedNPV() const { return shiftedNPV_; }
+    //! Return delta NPV by trade and scenario
+    const std::map<std::pair<std::string, std::string>, QuantLib::Real>& delta() const { return delta_; }
+    //! Return the error indicator of the approximation by trade and scenario
+    const std::map<std::pair<std::string, std::string>, QuantLib::Real>& errorIndicator() const {
+        return errorIndicator_;
+    }
+    //! Return the trades with an error indicator above the threshold in at least one scenario
+    const std::set<std::string>& fullRevaluationTrades() const { return fullRevaluationTrades_; }
+    //! Return the trades for which the results were replaced by a full revaluation
+    const std::set<std::string>& revaluedTrades() const { return revaluedTrades_; }
+
+    //! Replace the approximated results by the results of the given stress test for the trades it contains
+    void setFullRevaluationResults(StressTest& stressTest);
+
+    /*! Write NPV by trade/scenario to a report, with the same columns as StressTest::writeReport() plus the error
+        indicator and a flag that is true if the trade was fully revalued */
+    void writeReport(const boost::shared_ptr<ore::data::Report>& report, QuantLib::Real outputThreshold = 0.0);
+
+private:
+    std::map<std::string, QuantLib::Real> baseNPV_;
+    std::map<std::pair<std::string, std::string>, QuantLib::Real> shiftedNPV_, delta_, errorIndicator_;
+    std::set<std::string> labels_, trades_, fullRevaluationTrades_, revaluedTrades_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -21,6 +21,8 @@
 #include <orea/scenario/shiftscenariogenerator.hpp>
 #include <ored/utilities/log.hpp>
 
+#include <algorithm>
+
 using QuantLib::Real;
 
 using std::map;
@@ -45,6 +47,21 @@ SensitivityCubeStream::SensitivityCubeStream(const boost::shared_ptr<Sensitivity
 }
 
 SensitivityRecord SensitivityCubeStream::next() {
+    SensitivityRecord sr;
+    if (!next(sr))
+        return SensitivityRecord();
+    TLOG("Next record is: " << sr);
+    return sr;
+}
+
+Size SensitivityCubeStream::nextBatch(SensitivityRecord* records, Size n) {
+    Size i = 0;
+    while (i < n && next(records[i]))
+        ++i;
+    return i;
+}
+
+bool SensitivityCubeStream::next(SensitivityRecord& sr) {
 
     while (tradeIdx_ != cube_->tradeIdx().end() && currentDeltaKey_ == currentDeltaKeys_.end() &&
            currentCrossGammaKey_ == currentCrossGammaKeys_.end()) {
@@ -53,9 +70,9 @@ SensitivityRecord SensitivityCubeStream::next() {
     }
 
     if (tradeIdx_ == cube_->tradeIdx().end())
-        return SensitivityRecord();
+        return false;
 
-    SensitivityRecord sr;
+    // the strings are assigned, not constructed, so that the record's storage is reused
     Size tradeIdx = tradeIdx_->second;
     sr.tradeId = tradeIdx_->first;
     sr.isPar = false;
@@ -63,30 +80,41 @@ SensitivityRecord SensitivityCubeStream::next() {
     sr.baseNpv = cube_->npv(tradeIdx);
 
     if (currentDeltaKey_ != currentDeltaKeys_.end()) {
-        auto fd = cube_->upFactors().at(*currentDeltaKey_);
-        sr.key_1 = *currentDeltaKey_;
-        sr.desc_1 = fd.factorDesc;
-        sr.shift_1 = fd.shiftSize;
-        sr.delta = cube_->delta(tradeIdx_->first, *currentDeltaKey_);
+        const auto& f = cube_->factorTable()[*currentDeltaKey_];
+        sr.key_1 = f.key;
+        sr.desc_1 = f.up.factorDesc;
+        sr.shift_1 = f.up.shiftSize;
+        sr.key_2.keytype = RiskFactorKey::KeyType::None;
+        sr.key_2.name.clear();
+        sr.key_2.index = 0;
+        sr.desc_2.clear();
+        sr.shift_2 = 0.0;
+        if (f.twoSidedDelta) {
+            QL_REQUIRE(f.downIndex != Null<Size>(), "SensitivityCubeStream: no down scenario for two sided delta of "
+                                                        << f.key);
+            sr.delta = cube_->delta(tradeIdx, f.up.index, f.downIndex);
+        } else {
+            sr.delta = cube_->delta(tradeIdx, f.up.index);
+        }
         if (canComputeGamma_)
-            sr.gamma = cube_->gamma(tradeIdx_->first, *currentDeltaKey_);
+            sr.gamma = cube_->gamma(tradeIdx, f.up.index, f.downIndex);
         else
             sr.gamma = Null<Real>();
         ++currentDeltaKey_;
-    } else if (currentCrossGammaKey_ != currentCrossGammaKeys_.end()) {
-        auto fd = cube_->crossFactors().at(*currentCrossGammaKey_);
-        sr.key_1 = currentCrossGammaKey_->first;
-        sr.desc_1 = std::get<0>(fd).factorDesc;
-        sr.shift_1 = std::get<0>(fd).shiftSize;
-        sr.key_2 = currentCrossGammaKey_->second;
-        sr.desc_2 = std::get<1>(fd).factorDesc;
-        sr.shift_2 = std::get<1>(fd).shiftSize;
-        sr.gamma = cube_->crossGamma(tradeIdx_->first, *currentCrossGammaKey_);
+    } else {
+        const auto& f = cube_->crossFactorTable()[*currentCrossGammaKey_];
+        sr.key_1 = f.keys.first;
+        sr.desc_1 = f.first.factorDesc;
+        sr.shift_1 = f.first.shiftSize;
+        sr.key_2 = f.keys.second;
+        sr.desc_2 = f.second.factorDesc;
+        sr.shift_2 = f.second.shiftSize;
+        sr.delta = 0.0;
+        sr.gamma = cube_->crossGamma(tradeIdx, f.first.index, f.second.index, f.index);
         ++currentCrossGammaKey_;
     }
 
-    TLOG("Next record is: " << sr);
-    return sr;
+    return true;
 }
 
 void SensitivityCubeStream::updateForNewTrade() {
@@ -95,29 +123,32 @@ void SensitivityCubeStream::updateForNewTrade() {
 
     if (tradeIdx_ != cube_->tradeIdx().end()) {
 
-        // add delta keys
+        // add delta keys, the scenarios come in increasing index order, i.e. ordered by up factors and then by down
+        // factors (in the order of scenario generation), so we sort and remove duplicates afterwards
 
-        for (auto const& [idx, _] : cube_->npvCube()->getTradeNPVs(tradeIdx_->second)) {
-            if (auto k = cube_->upFactor(idx); k.keytype != RiskFactorKey::KeyType::None)
-                currentDeltaKeys_.insert(k);
-            else if (auto k = cube_->downFactor(idx); k.keytype != RiskFactorKey::KeyType::None)
-                currentDeltaKeys_.insert(k);
+        for (auto const idx : cube_->npvCube()->getTradeScenarios(tradeIdx_->second)) {
+            if (Size pos = cube_->factorPosition(idx); pos != Null<Size>())
+                currentDeltaKeys_.push_back(pos);
         }
 
         // add cross gamma keys
 
-        for (auto const& [crossPair, data] : cube_->crossFactors()) {
-            if (!close_enough(cube_->crossGamma(tradeIdx_->second, std::get<0>(data).index, std::get<1>(data).index,
-                                                std::get<2>(data)),
-                              0.0)) {
-                currentCrossGammaKeys_.insert(crossPair);
+        const auto& crossFactors = cube_->crossFactorTable();
+        for (Size c = 0; c < crossFactors.size(); ++c) {
+            const auto& f = crossFactors[c];
+            if (!close_enough(cube_->crossGamma(tradeIdx_->second, f.first.index, f.second.index, f.index), 0.0)) {
+                currentCrossGammaKeys_.push_back(c);
 
                 // make sure, delta keys contain both cross keys, that's a guarantee of the SensitivityCubeStream
 
-                currentDeltaKeys_.insert(crossPair.first);
-                currentDeltaKeys_.insert(crossPair.second);
+                currentDeltaKeys_.push_back(f.firstPos);
+                currentDeltaKeys_.push_back(f.secondPos);
             }
         }
+
+        std::sort(currentDeltaKeys_.begin(), currentDeltaKeys_.end());
+        currentDeltaKeys_.erase(std::unique(currentDeltaKeys_.begin(), currentDeltaKeys_.end()),
+                                currentDeltaKeys_.end());
     }
 
     currentDeltaKey_ = currentDeltaKeys_.begin();
@@ -26,8 +26,8 @@
 #include <orea/engine/sensitivitystream.hpp>
 
 #include <map>
-#include <set>
 #include <string>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -47,23 +47,30 @@ public:
     */
     SensitivityRecord next() override;
 
+    //! Writes the next records to \p records in place, see SensitivityStream::nextBatch()
+    QuantLib::Size nextBatch(SensitivityRecord* records, QuantLib::Size n) override;
+    using SensitivityStream::nextBatch;
+
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     void reset() override;
 
 private:
     void updateForNewTrade();
+    //! Writes the next record to \p sr, returns false at the end of the stream
+    bool next(SensitivityRecord& sr);
 
     //! Handle on the SensitivityCube
     boost::shared_ptr<SensitivityCube> cube_;
     //! Currency of the sensitivities in the SensitivityCube
     std::string currency_;
 
-    //! Current delta risk factor keys to process and iterators
-    std::set<RiskFactorKey> currentDeltaKeys_;
-    std::set<std::pair<RiskFactorKey,RiskFactorKey>> currentCrossGammaKeys_;
+    /*! Positions of the current trade's delta factors and cross factors to process in the flat factor tables of the
+        cube, sorted, and the next position to process */
+    std::vector<QuantLib::Size> currentDeltaKeys_;
+    std::vector<QuantLib::Size> currentCrossGammaKeys_;
 
-    std::set<RiskFactorKey>::const_iterator currentDeltaKey_;
-    std::set<std::pair<RiskFactorKey,RiskFactorKey>>::const_iterator currentCrossGammaKey_;
+    std::vector<QuantLib::Size>::const_iterator currentDeltaKey_;
+    std::vector<QuantLib::Size>::const_iterator currentCrossGammaKey_;
 
     //! Current trade iterator
     std::map<std::string, QuantLib::Size>::const_iterator tradeIdx_;
@@ -35,6 +35,13 @@ SensitivityRecord SensitivityInMemoryStream::next() {
     return *(itCurrent_++);
 }
 
+QuantLib::Size SensitivityInMemoryStream::nextBatch(SensitivityRecord* records, QuantLib::Size n) {
+    QuantLib::Size i = 0;
+    for (; i < n && itCurrent_ != records_.end(); ++i)
+        records[i] = *(itCurrent_++);
+    return i;
+}
+
 void SensitivityInMemoryStream::reset() {
     // Reset iterator to start of container
     itCurrent_ = records_.begin();
@@ -39,6 +39,9 @@ public:
     SensitivityInMemoryStream(Iter begin, Iter end);
     //! Returns the next SensitivityRecord in the stream
     SensitivityRecord next() override;
+    //! Copies the next records to \p records, see SensitivityStream::nextBatch()
+    QuantLib::Size nextBatch(SensitivityRecord* records, QuantLib::Size n) override;
+    using SensitivityStream::nextBatch;
     //! Resets the stream so that SensitivityRecords can be streamed again
     void reset() override;
     /*! Add a record to the in-memory collection.
@@ -56,7 +59,8 @@ private:
 };
 
 template <class Iter> 
-SensitivityInMemoryStream::SensitivityInMemoryStream(Iter begin, Iter end) : records_(begin, end) {}
+SensitivityInMemoryStream::SensitivityInMemoryStream(Iter begin, Iter end)
+    : records_(begin, end), itCurrent_(records_.begin()) {}
 
 } // namespace analytics
 } // namespace ore
@@ -24,6 +24,9 @@
 
 #include <orea/engine/sensitivityrecord.hpp>
 
+#include <utility>
+#include <vector>
+
 namespace ore {
 namespace analytics {
 
@@ -34,6 +37,23 @@ public:
     virtual ~SensitivityStream() {}
     //! Returns the next SensitivityRecord in the stream
     virtual SensitivityRecord next() = 0;
+    /*! Writes the next records of the stream to \p records, at most \p n, and returns the number of records written,
+        which is less than \p n only at the end of the stream. The given records are overwritten in place, so that
+        the storage of their string members is reused when the same buffer is passed in successive calls. The default
+        implementation calls next() for each record. */
+    virtual QuantLib::Size nextBatch(SensitivityRecord* records, QuantLib::Size n) {
+        for (QuantLib::Size i = 0; i < n; ++i) {
+            SensitivityRecord sr = next();
+            if (!sr)
+                return i;
+            records[i] = std::move(sr);
+        }
+        return n;
+    }
+    //! Fills the buffer \p records with the next records of the stream, see above
+    QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records) {
+        return nextBatch(records.data(), records.size());
+    }
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     virtual void reset() = 0;
 };
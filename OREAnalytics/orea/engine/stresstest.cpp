@@ -18,6 +18,7 @@
 
 #include <boost/lexical_cast.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/stresstest.hpp>
 #include <orea/engine/valuationengine.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
@@ -57,7 +58,8 @@ StressTest::StressTest(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
                        const CurveConfigurations& curveConfigs, const TodaysMarketParameters& todaysMarketParams,
                        boost::shared_ptr<ScenarioFactory> scenarioFactory,
                        const boost::shared_ptr<ReferenceDataManager>& referenceData,
-                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError) {
+                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError,
+                       bool incrementalValuation) {
 
     LOG("Build Simulation Market");
     boost::shared_ptr<ScenarioSimMarket> simMarket = boost::make_shared<ScenarioSimMarket>(
@@ -82,7 +84,10 @@ StressTest::StressTest(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
 
     LOG("Reset and Build Portfolio");
     portfolio->reset();
+    // record the market requests of the trades, these determine the trades repriced in the incremental valuation
+    simMarket->setRecordRequests(incrementalValuation);
     portfolio->build(factory, "stress analysis");
+    simMarket->setRecordRequests(false);
 
     LOG("Build the cube object to store sensitivities");
     boost::shared_ptr<NPVCube> cube = boost::make_shared<DoublePrecisionInMemoryCube>(
@@ -93,6 +98,7 @@ StressTest::StressTest(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
     vector<boost::shared_ptr<ValuationCalculator>> calculators;
     calculators.push_back(boost::make_shared<NPVCalculator>(simMarketData->baseCcy()));
     ValuationEngine engine(asof, dg, simMarket, factory->modelBuilders());
+    engine.setIncrementalValuation(incrementalValuation);
     LOG("Run Stress Scenarios");
     /*ostringstream o;
     o.str("");
@@ -104,16 +110,78 @@ StressTest::StressTest(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
     engine.registerProgressIndicator(progressLog);*/
     engine.buildCube(portfolio, cube, calculators);
 
-    /*****************
-     * Collect results
-     */
+    collectResults(portfolio, cube, scenarioGenerator);
+    LOG("Stress testing done");
+}
+
+StressTest::StressTest(const Size nThreads, const boost::shared_ptr<ore::data::Loader>& loader,
+                       const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                       const boost::shared_ptr<ore::data::Market>& market,
+                       const boost::shared_ptr<ore::data::EngineData>& engineData,
+                       const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                       const boost::shared_ptr<StressTestScenarioData>& stressData,
+                       const boost::shared_ptr<CurveConfigurations>& curveConfigs,
+                       const boost::shared_ptr<TodaysMarketParameters>& todaysMarketParams,
+                       boost::shared_ptr<ScenarioFactory> scenarioFactory,
+                       const boost::shared_ptr<ReferenceDataManager>& referenceData,
+                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError, bool incrementalValuation,
+                       const boost::shared_ptr<ThreadPool>& threadPool, bool shareTodaysMarket,
+                       const std::string& context) {
+
+    QL_REQUIRE(curveConfigs && todaysMarketParams,
+               "StressTest: multi-threaded engine requires curve configurations and todays market parameters");
+
+    /* the stress scenarios are generated once on a sim market in this thread, the worker threads get clones of the
+       scenarios and build their own sim markets and portfolios */
+
+    LOG("Build Simulation Market");
+    boost::shared_ptr<ScenarioSimMarket> simMarket = boost::make_shared<ScenarioSimMarket>(
+        market, simMarketData, Market::defaultConfiguration, *curveConfigs, *todaysMarketParams, continueOnError, false,
+        false, false, iborFallbackConfig);
+
+    LOG("Build Stress Scenario Generator");
+    Date asof = market->asofDate();
+    boost::shared_ptr<Scenario> baseScenario = simMarket->baseScenario();
+    scenarioFactory = scenarioFactory ? scenarioFactory : boost::make_shared<CloneScenarioFactory>(baseScenario);
+    boost::shared_ptr<StressScenarioGenerator> scenarioGenerator =
+        boost::make_shared<StressScenarioGenerator>(stressData, baseScenario, simMarketData, simMarket, scenarioFactory);
+    simMarket->scenarioGenerator() = scenarioGenerator;
+
+    auto ed = boost::make_shared<EngineData>(*engineData);
+    ed->globalParameters()["RunType"] = "Stress";
+
+    LOG("Run " << scenarioGenerator->samples() << " Stress Scenarios on " << nThreads << " threads");
+    MultiThreadedValuationEngine engine(nThreads, asof, boost::make_shared<DateGrid>(), scenarioGenerator->samples(),
+                                        loader, scenarioGenerator, ed, curveConfigs, todaysMarketParams,
+                                        Market::defaultConfiguration, simMarketData, false, false,
+                                        boost::make_shared<ScenarioFilter>(), referenceData, iborFallbackConfig, true,
+                                        true, {}, {}, {}, context);
+    engine.setSampleParallel(true);
+    engine.setReuseT0(true);
+    engine.setIncrementalValuation(incrementalValuation);
+    engine.setThreadPool(threadPool);
+    engine.setShareTodaysMarket(shareTodaysMarket);
+    auto baseCcy = simMarketData->baseCcy();
+    engine.buildCube(portfolio, [&baseCcy]() -> std::vector<boost::shared_ptr<ValuationCalculator>> {
+        return {boost::make_shared<NPVCalculator>(baseCcy)};
+    });
+    QL_REQUIRE(engine.outputCubes().size() == 1,
+               "StressTest: internal error, expected one output cube in the scenario-parallel mode, got "
+                   << engine.outputCubes().size());
+
+    collectResults(portfolio, engine.outputCubes().front(), scenarioGenerator);
+    LOG("Stress testing done");
+}
+
+void StressTest::collectResults(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                                const boost::shared_ptr<NPVCube>& cube,
+                                const boost::shared_ptr<StressScenarioGenerator>& scenarioGenerator) {
     baseNPV_.clear();
     shiftedNPV_.clear();
     delta_.clear();
     labels_.clear();
-    size_t i = 0;
-    for (auto tradeIt = portfolio->trades().begin(); tradeIt != portfolio->trades().end(); ++tradeIt, ++i) {
-        string tradeId = tradeIt->first;
+    for (auto const& [tradeId, trade] : portfolio->trades()) {
+        Size i = cube->getTradeIndex(tradeId);
         Real npv0 = cube->getT0(i, 0);
         trades_.insert(tradeId);
         baseNPV_[tradeId] = npv0;
@@ -126,7 +194,6 @@ StressTest::StressTest(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
             labels_.insert(label);
         }
     }
-    LOG("Stress testing done");
 }
 
 void StressTest::writeReport(const boost::shared_ptr<ore::data::Report>& report, Real outputThreshold) {
@@ -24,10 +24,12 @@
 #pragma once
 
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <orea/scenario/stressscenariodata.hpp>
 #include <orea/scenario/stressscenariogenerator.hpp>
+#include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/report/report.hpp>
@@ -65,7 +67,28 @@ public:
                boost::shared_ptr<ScenarioFactory> scenarioFactory = {},
                const boost::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
                const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
-               bool continueOnError = false);
+               bool continueOnError = false, bool incrementalValuation = false);
+
+    /*! Constructor using the multi-threaded engine: the stress scenarios are generated once from a sim market on the
+        given market and then distributed in contiguous blocks over nThreads threads, each thread builds its own clone
+        of the portfolio against its own sim market, see MultiThreadedValuationEngine::setSampleParallel(); the base
+        NPVs are only computed in the first thread. With incremental valuation the threads only reprice the trades depending
+        on the risk factors shifted by a scenario. If shareTodaysMarket is true, the sim markets of the threads are
+        built from one T0 market built from the loader, see MultiThreadedValuationEngine::setShareTodaysMarket(). */
+    StressTest(const Size nThreads, const boost::shared_ptr<ore::data::Loader>& loader,
+               const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+               const boost::shared_ptr<ore::data::Market>& market,
+               const boost::shared_ptr<ore::data::EngineData>& engineData,
+               const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+               const boost::shared_ptr<StressTestScenarioData>& stressData,
+               const boost::shared_ptr<ore::data::CurveConfigurations>& curveConfigs,
+               const boost::shared_ptr<ore::data::TodaysMarketParameters>& todaysMarketParams,
+               boost::shared_ptr<ScenarioFactory> scenarioFactory = {},
+               const boost::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
+               const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
+               bool continueOnError = false, bool incrementalValuation = false,
+               const boost::shared_ptr<ThreadPool>& threadPool = nullptr, bool shareTodaysMarket = false,
+               const std::string& context = "stress analysis");
 
     //! Return set of trades analysed
     const std::set<std::string>& trades() { return trades_; }
@@ -86,6 +109,11 @@ public:
     void writeReport(const boost::shared_ptr<ore::data::Report>& report, Real outputThreshold = 0.0);
 
 private:
+    // fill the result structures from a cube holding the stress scenarios as samples on a single date
+    void collectResults(const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                        const boost::shared_ptr<NPVCube>& cube,
+                        const boost::shared_ptr<StressScenarioGenerator>& scenarioGenerator);
+
     // base NPV by trade
     std::map<std::string, Real> baseNPV_;
     // NPV respectively sensitivity by trade and scenario
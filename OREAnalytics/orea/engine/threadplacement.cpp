@@ -0,0 +1,160 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/threadplacement.hpp>
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using QuantLib::Null;
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+// the highest node number probed in /sys/devices/system/node
+const Size maxNumaNodes = 1024;
+} // namespace
+
+ThreadPlacement parseThreadPlacement(const std::string& s) {
+    if (s == "None")
+        return ThreadPlacement::None;
+    else if (s == "Compact")
+        return ThreadPlacement::Compact;
+    else if (s == "Scatter")
+        return ThreadPlacement::Scatter;
+    else
+        QL_FAIL("thread placement '" << s << "' not recognised, expected None, Compact or Scatter");
+}
+
+std::ostream& operator<<(std::ostream& out, const ThreadPlacement p) {
+    switch (p) {
+    case ThreadPlacement::None:
+        return out << "None";
+    case ThreadPlacement::Compact:
+        return out << "Compact";
+    case ThreadPlacement::Scatter:
+        return out << "Scatter";
+    default:
+        QL_FAIL("unknown thread placement");
+    }
+}
+
+std::vector<Size> parseCpuList(const std::string& s) {
+    std::vector<Size> result;
+    std::vector<std::string> tokens;
+    std::string t = boost::trim_copy(s);
+    if (t.empty())
+        return result;
+    boost::split(tokens, t, boost::is_any_of(","));
+    for (auto const& token : tokens) {
+        std::vector<std::string> range;
+        boost::split(range, token, boost::is_any_of("-"));
+        QL_REQUIRE(range.size() == 1 || range.size() == 2, "parseCpuList: invalid range '" << token << "'");
+        Size first = ore::data::parseInteger(boost::trim_copy(range.front()));
+        Size last = ore::data::parseInteger(boost::trim_copy(range.back()));
+        QL_REQUIRE(first <= last, "parseCpuList: invalid range '" << token << "'");
+        for (Size c = first; c <= last; ++c)
+            result.push_back(c);
+    }
+    return result;
+}
+
+NumaTopology::NumaTopology() {
+#if defined(__linux__)
+    for (Size n = 0; n < maxNumaNodes; ++n) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+        if (!file.is_open())
+            continue;
+        std::string line;
+        std::getline(file, line);
+        try {
+            std::vector<Size> cpus = parseCpuList(line);
+            // nodes without CPUs only provide memory
+            if (!cpus.empty())
+                cpus_.push_back(cpus);
+        } catch (const std::exception& e) {
+            WLOG("NumaTopology: could not read cpu list of node " << n << ": " << e.what());
+        }
+    }
+#endif
+    if (cpus_.empty()) {
+        std::vector<Size> cpus(std::max<unsigned int>(std::thread::hardware_concurrency(), 1));
+        std::iota(cpus.begin(), cpus.end(), 0);
+        cpus_.push_back(cpus);
+    }
+}
+
+Size NumaTopology::node(const ThreadPlacement placement, const Size worker, const Size nWorkers) const {
+    QL_REQUIRE(worker < nWorkers, "NumaTopology: worker " << worker << " out of range, have " << nWorkers);
+    switch (placement) {
+    case ThreadPlacement::Compact:
+        return worker * nodes() / nWorkers;
+    case ThreadPlacement::Scatter:
+        return worker % nodes();
+    default:
+        QL_FAIL("NumaTopology: no node for thread placement " << placement);
+    }
+}
+
+const NumaTopology& NumaTopology::instance() {
+    static const NumaTopology topology;
+    return topology;
+}
+
+Size pinWorkerThread(const ThreadPlacement placement, const Size worker, const Size nWorkers) {
+    if (placement == ThreadPlacement::None)
+        return Null<Size>();
+    const NumaTopology& topology = NumaTopology::instance();
+    Size node = topology.node(placement, worker, nWorkers);
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : topology.cpus(node)) {
+        if (c < CPU_SETSIZE)
+            CPU_SET(c, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        WLOG("pinWorkerThread: could not pin worker " << worker << " to NUMA node " << node);
+        return Null<Size>();
+    }
+    return node;
+#else
+    WLOG("pinWorkerThread: thread placement " << placement << " is only supported on Linux, worker " << worker
+                                              << " is not pinned");
+    return Null<Size>();
+#endif
+}
+
+} // namespace analytics
+} // namespace ore
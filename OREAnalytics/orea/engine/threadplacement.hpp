@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/threadplacement.hpp
+    \brief placement of worker threads on the NUMA nodes of the machine
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Placement of the worker threads of the multi-threaded engines on the NUMA nodes
+/*! - None: the threads are scheduled by the operating system without restrictions
+    - Compact: the workers are assigned to the nodes in contiguous blocks, i.e. the first nodes are filled first
+    - Scatter: the workers are assigned to the nodes round robin, i.e. neighbouring workers run on different nodes
+
+    A worker is pinned to all CPUs of its node, not to a single CPU, so that the operating system can still balance
+    the threads within a node. Since memory is allocated on the node of the thread that first touches it (the default
+    policy on Linux), the state a pinned worker builds itself is local to its node. */
+enum class ThreadPlacement { None, Compact, Scatter };
+
+ThreadPlacement parseThreadPlacement(const std::string& s);
+
+std::ostream& operator<<(std::ostream& out, const ThreadPlacement p);
+
+//! The CPUs of the NUMA nodes of the machine
+/*! On Linux the nodes are read from /sys/devices/system/node, on other platforms or if the node information is not
+    available the machine is represented by a single node holding all CPUs. */
+class NumaTopology {
+public:
+    NumaTopology();
+
+    //! Number of nodes
+    QuantLib::Size nodes() const { return cpus_.size(); }
+    //! CPUs of a node
+    const std::vector<QuantLib::Size>& cpus(const QuantLib::Size node) const { return cpus_.at(node); }
+    //! The node of the worker with the given index for a total of nWorkers workers
+    QuantLib::Size node(const ThreadPlacement placement, const QuantLib::Size worker,
+                        const QuantLib::Size nWorkers) const;
+
+    //! The topology of this machine, read once
+    static const NumaTopology& instance();
+
+private:
+    std::vector<std::vector<QuantLib::Size>> cpus_;
+};
+
+/*! Pins the calling thread to the node of the worker with the given index, returns the node or QuantLib::Null<Size>()
+    if the placement is None or the thread could not be pinned; a failure to pin is logged and not an error. The
+    affinity of the thread stays in place after the worker is done, which is harmless for the threads of the shared
+    thread pool, since each job pins the thread again. */
+QuantLib::Size pinWorkerThread(const ThreadPlacement placement, const QuantLib::Size worker,
+                               const QuantLib::Size nWorkers);
+
+//! Parses a Linux cpu list like 0-15,64-79
+std::vector<QuantLib::Size> parseCpuList(const std::string& s);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/threadpool.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+
+namespace ore {
+namespace analytics {
+
+ThreadPool::ThreadPool(const QuantLib::Size nThreads) : stop_(false) {
+    QL_REQUIRE(nThreads > 0, "ThreadPool: number of threads must be positive");
+    LOG("Create thread pool with " << nThreads << " threads");
+    for (QuantLib::Size i = 0; i < nThreads; ++i)
+        threads_.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+void ThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        // exceptions are stored in the future by the packaged task
+        task();
+    }
+}
+
+void runBlocks(const QuantLib::Size n, const QuantLib::Size nBlocks, const boost::shared_ptr<ThreadPool>& threadPool,
+               const std::function<void(QuantLib::Size, QuantLib::Size)>& f) {
+    QuantLib::Size blocks = std::min(std::max<QuantLib::Size>(nBlocks, 1), n);
+    if (blocks <= 1) {
+        f(0, n);
+        return;
+    }
+    std::vector<std::future<void>> results;
+    std::vector<std::thread> jobs; // not needed if thread pool is used
+    for (QuantLib::Size b = 0; b < blocks; ++b) {
+        QuantLib::Size begin = n * b / blocks, end = n * (b + 1) / blocks;
+        if (threadPool) {
+            results.push_back(threadPool->push([&f, begin, end]() { f(begin, end); }));
+        } else {
+            std::packaged_task<void()> task([&f, begin, end]() { f(begin, end); });
+            results.push_back(task.get_future());
+            jobs.emplace_back(std::move(task));
+        }
+    }
+    for (auto& j : jobs)
+        j.join();
+    // rethrows the first exception raised in a block
+    for (auto& r : results)
+        r.get();
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/threadpool.hpp
+    \brief a fixed size pool of worker threads shared by the multi-threaded engines
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Fixed size pool of worker threads processing a queue of tasks in FIFO order
+/*! The pool is created once per application run (see AnalyticsManager) and shared by the multi-threaded engines of
+    all analytics, so that consecutive analytics reuse the same threads and concurrent analytics do not oversubscribe
+    the machine.
+
+    The worker threads keep their thread local QuantLib session state (evaluation date, observation mode etc.) between
+    tasks, a task must therefore initialise this state itself, as the engines' worker jobs do.
+
+    A task must not wait for the result of another task submitted to the same pool, since this can deadlock once all
+    worker threads are waiting.
+*/
+class ThreadPool {
+public:
+    //! Starts nThreads worker threads
+    explicit ThreadPool(const QuantLib::Size nThreads);
+    //! Processes the remaining tasks in the queue and joins the worker threads
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! Number of worker threads
+    QuantLib::Size size() const { return threads_.size(); }
+
+    //! Queue a task, the returned future holds the result or the exception thrown by the task
+    template <typename F> std::future<typename std::invoke_result<F>::type> push(F&& f) {
+        using resultType = typename std::invoke_result<F>::type;
+        auto task = boost::make_shared<std::packaged_task<resultType()>>(std::forward<F>(f));
+        std::future<resultType> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push([task]() { (*task)(); });
+        }
+        condition_.notify_one();
+        return result;
+    }
+
+private:
+    void work();
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+};
+
+//! Run f(begin, end) on up to nBlocks blocks covering [0, n), on the thread pool if given, otherwise in own threads
+/*! The blocks are run in the calling thread if there is only one. Returns when all blocks are done and rethrows the
+    first exception raised in a block. Must not be called from a task running on the same thread pool. */
+void runBlocks(const QuantLib::Size n, const QuantLib::Size nBlocks, const boost::shared_ptr<ThreadPool>& threadPool,
+               const std::function<void(QuantLib::Size, QuantLib::Size)>& f);
+
+} // namespace analytics
+} // namespace ore
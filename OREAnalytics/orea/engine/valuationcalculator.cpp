@@ -25,9 +25,28 @@
 #include <ored/portfolio/optionwrapper.hpp>
 #include <ored/utilities/log.hpp>
 
+#include <typeinfo>
+
 namespace ore {
 namespace analytics {
 
+void ValuationCalculator::calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades,
+                                         const std::vector<bool>& active, const boost::shared_ptr<SimMarket>& simMarket,
+                                         boost::shared_ptr<NPVCube>& outputCube,
+                                         boost::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date,
+                                         Size dateIndex, Size sample, bool isCloseOut,
+                                         std::map<Size, std::string>& errors) {
+    for (Size i = 0; i < trades.size(); ++i) {
+        if (!active[i] || errors.count(i) > 0)
+            continue;
+        try {
+            calculate(trades[i], i, simMarket, outputCube, outputCubeNettingSet, date, dateIndex, sample, isCloseOut);
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    }
+}
+
 void NPVCalculator::init(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<SimMarket>& simMarket) {
     DLOG("init NPVCalculator");
     tradeCcyIndex_.resize(portfolio->size());
@@ -60,6 +79,41 @@ void NPVCalculator::calculate(const boost::shared_ptr<Trade>& trade, Size tradeI
         outputCube->set(npv(tradeIndex, trade, simMarket), tradeIndex, dateIndex, sample, index_);
 }
 
+void NPVCalculator::calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades,
+                                   const std::vector<bool>& active, const boost::shared_ptr<SimMarket>& simMarket,
+                                   boost::shared_ptr<NPVCube>& outputCube,
+                                   boost::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date, Size dateIndex,
+                                   Size sample, bool isCloseOut, std::map<Size, std::string>& errors) {
+    if (isCloseOut)
+        return;
+    // derived classes overriding npv() keep the per trade path
+    if (typeid(*this) != typeid(NPVCalculator)) {
+        ValuationCalculator::calculateBatch(trades, active, simMarket, outputCube, outputCubeNettingSet, date,
+                                            dateIndex, sample, isCloseOut, errors);
+        return;
+    }
+    calculateBatchNPVs(trades, active, simMarket, outputCube, dateIndex, sample, errors);
+}
+
+void NPVCalculator::calculateBatchNPVs(const std::vector<boost::shared_ptr<Trade>>& trades,
+                                       const std::vector<bool>& active, const boost::shared_ptr<SimMarket>& simMarket,
+                                       boost::shared_ptr<NPVCube>& outputCube, Size dateIndex, Size sample,
+                                       std::map<Size, std::string>& errors) {
+    Real numeraire = simMarket->numeraire();
+    for (Size i = 0; i < trades.size(); ++i) {
+        if (!active[i] || errors.count(i) > 0)
+            continue;
+        try {
+            Real npv = trades[i]->instrument()->NPV();
+            if (!close_enough(npv, 0.0))
+                npv *= fxRates_[tradeCcyIndex_[i]] / numeraire;
+            outputCube->set(npv, i, dateIndex, sample, index_);
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    }
+}
+
 void NPVCalculator::calculateT0(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                                 const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
                                 boost::shared_ptr<NPVCube>& outputCubeNettingSet) {
@@ -28,6 +28,8 @@
 #include <ored/portfolio/trade.hpp>
 #include <ored/utilities/dategrid.hpp>
 
+#include <map>
+
 namespace ore {
 namespace analytics {
 using ore::data::Trade;
@@ -72,6 +74,16 @@ public:
         //! The cube
         boost::shared_ptr<NPVCube>& outputCubeNettingSet) = 0;
 
+    /*! Batched version of calculate(), called by the ValuationEngine once per date and sample for all trades of the
+        portfolio. The trades are given in portfolio order, i.e. trades[i] is written to cube index i, and only the
+        trades with active[i] == true are processed. Errors are reported by adding a message for the trade index to
+        errors, such trades are not processed by the remaining calculators. The default implementation calls
+        calculate() for each active trade. */
+    virtual void calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades, const std::vector<bool>& active,
+                                const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
+                                boost::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date, Size dateIndex,
+                                Size sample, bool isCloseOut, std::map<Size, std::string>& errors);
+
     // called once before the valuation engine run
     virtual void init(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<SimMarket>& simMarket) = 0;
 
@@ -98,6 +110,12 @@ public:
                              const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
                              boost::shared_ptr<NPVCube>& outputCubeNettingSet) override;
 
+    //! reads the numeraire once per date and sample instead of once per trade
+    void calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades, const std::vector<bool>& active,
+                        const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
+                        boost::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date, Size dateIndex,
+                        Size sample, bool isCloseOut, std::map<Size, std::string>& errors) override;
+
     virtual Real npv(Size tradeIndex, const boost::shared_ptr<Trade>& trade,
                      const boost::shared_ptr<SimMarket>& simMarket);
 
@@ -105,6 +123,11 @@ public:
     void initScenario() override;
 
 protected:
+    //! writes the npvs of the active trades, reading the numeraire once, used by calculateBatch()
+    void calculateBatchNPVs(const std::vector<boost::shared_ptr<Trade>>& trades, const std::vector<bool>& active,
+                            const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
+                            Size dateIndex, Size sample, std::map<Size, std::string>& errors);
+
     std::string baseCcyCode_;
     Size index_;
 
@@ -18,7 +18,9 @@
 
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/riskfactorpruning.hpp>
 #include <orea/simulation/simmarket.hpp>
+#include <ored/portfolio/instrumentwrapper.hpp>
 #include <ored/portfolio/optionwrapper.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
@@ -26,9 +28,15 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/progressbar.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 
+#include <boost/core/demangle.hpp>
 #include <boost/timer/timer.hpp>
 #include <ql/errors.hpp>
+#include <qle/instruments/zeroratedependencies.hpp>
+
+#include <algorithm>
+#include <typeinfo>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -40,6 +48,46 @@ using boost::timer::default_places;
 namespace ore {
 namespace analytics {
 
+namespace {
+boost::timer::cpu_times elapsedSince(const cpu_timer& timer, const boost::timer::cpu_times& start) {
+    boost::timer::cpu_times t = timer.elapsed();
+    t.wall -= start.wall;
+    t.user -= start.user;
+    t.system -= start.system;
+    return t;
+}
+
+std::string calculatorName(const boost::shared_ptr<ValuationCalculator>& calc) {
+    std::string name = boost::core::demangle(typeid(*calc).name());
+    std::size_t pos = name.rfind("::");
+    return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+} // namespace
+
+void ValuationEngineTimings::Timing::add(const boost::timer::cpu_times& t, const Size n) {
+    count += n;
+    wall += t.wall;
+    cpu += t.user + t.system;
+}
+
+void ValuationEngineTimings::Timing::add(const Timing& t) {
+    count += t.count;
+    wall += t.wall;
+    cpu += t.cpu;
+}
+
+void ValuationEngineTimings::add(const ValuationEngineTimings& other) {
+    for (auto const& [id, t] : other.trades)
+        trades[id].add(t);
+    tradeTypes.insert(other.tradeTypes.begin(), other.tradeTypes.end());
+    for (auto const& [name, t] : other.calculators)
+        calculators[name].add(t);
+    for (auto const& [name, t] : other.marketUpdates)
+        marketUpdates[name].add(t);
+    for (auto const& [name, t] : other.phases)
+        phases[name].add(t);
+}
+
 ValuationEngine::ValuationEngine(const Date& today, const boost::shared_ptr<DateGrid>& dg,
                                  const boost::shared_ptr<SimMarket>& simMarket,
                                  const set<std::pair<string, boost::shared_ptr<ModelBuilder>>>& modelBuilders)
@@ -96,10 +144,23 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
     LOG("Starting ValuationEngine for " << portfolio->size() << " trades, " << outputCube->samples() << " samples and "
                                         << dg_->size() << " dates.");
 
+    TraceSpan span("simulation", "ValuationEngine::buildCube");
+    span.arg("trades", portfolio->size()).arg("samples", outputCube->samples()).arg("dates", dg_->size());
+
     ObservationMode::Mode om = ObservationMode::instance().mode();
-    Real updateTime = 0.0;
-    Real pricingTime = 0.0;
-    Real fixingTime = 0.0;
+    ValuationEngineTimings::Timing updateTiming, pricingTiming, fixingTiming;
+
+    // timings are collected per trade and calculator index and added to timings_ at the end of the run
+    boost::shared_ptr<ScenarioSimMarket> ssm;
+    std::map<RiskFactorKey::KeyType, boost::timer::cpu_times> updateTimingsStart;
+    if (collectTimings_) {
+        tradeTimings_.assign(portfolio->size(), ValuationEngineTimings::Timing());
+        calculatorTimings_.assign(calculators.size(), ValuationEngineTimings::Timing());
+        if ((ssm = boost::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_))) {
+            ssm->setCollectUpdateTimings(true);
+            updateTimingsStart = ssm->updateTimings();
+        }
+    }
 
     LOG("Initialise " << calculators.size() << " valuation calculators");
     for (auto const& c : calculators) {
@@ -112,10 +173,26 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
     const auto& trades = portfolio->trades();
     auto& counterparties = outputCptyCube ? outputCptyCube->idsAndIndexes() : std::map<string, Size>();
     std::vector<bool> tradeHasError(portfolio->size(), false);
+    batchTrades_.clear();
+    for (const auto& [tradeId, trade] : trades)
+        batchTrades_.push_back(trade);
+    tradeDateLengths_.clear();
+    if (skipMaturedTrades_) {
+        const auto& valuationDates = dg_->valuationDates();
+        for (const auto& [tradeId, trade] : trades) {
+            Date maturity = trade->maturity();
+            tradeDateLengths_.push_back(
+                maturity == Date() ? valuationDates.size()
+                                   : std::upper_bound(valuationDates.begin(), valuationDates.end(), maturity) -
+                                         valuationDates.begin());
+        }
+    }
     LOG("Initialise state objects...");
     // initialise state objects for each trade (required for path-dependent derivatives in particular)
     size_t i = 0;
     for (const auto& [tradeId, trade] : trades) {
+        TraceSpan tradeSpan("simulation", "ValuationEngine::initialiseTrade");
+        tradeSpan.arg("tradeId", tradeId).arg("tradeType", trade->tradeType());
         QL_REQUIRE(!trade->npvCurrency().empty(), "NPV currency not set for trade " << trade->id());
 
         DLOG("Initialise wrapper for trade " << trade->id());
@@ -123,10 +200,12 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
         recalibrateModels();
 
-        // T0 values
+        // T0 values, unless they are provided by another engine
         try {
-            for (auto& calc : calculators)
-                calc->calculateT0(trade, i, simMarket_, outputCube, outputCubeNettingSet);
+            if (!waitForT0_) {
+                for (auto& calc : calculators)
+                    calc->calculateT0(trade, i, simMarket_, outputCube, outputCubeNettingSet);
+            }
         } catch (const std::exception& e) {
             string expMsg = string("T0 valuation error: ") + e.what();
             ALOG(StructuredTradeErrorMessage(tradeId, trade->tradeType(), "ScenarioValuation",
@@ -134,7 +213,56 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
             tradeHasError[i] = true;
         }
 
-        if (om == ObservationMode::Mode::Unregister) {
+        ++i;
+    }
+    LOG("Total number of trades = " << portfolio->size());
+
+    if (waitForT0_) {
+        LOG("Wait for the T0 values to be provided");
+        waitForT0_();
+    } else if (t0Done_) {
+        t0Done_();
+    }
+
+    // incremental valuation, the dependencies are determined while the instruments still observe their coupons
+    affectedTrades_.clear();
+    analyticTrades_.clear();
+    analyticDeltaFactors_.clear();
+    analyticDeltaDeviations_.clear();
+    if (incrementalValuation_) {
+        auto scenarioSimMarket = boost::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_);
+        if (scenarioSimMarket && dates.size() == 1 && dates.front() == simMarket_->asofDate() &&
+            dg_->isValuationDate().front() && !dg_->isCloseOutDate().front() && outputCubeNettingSet == nullptr) {
+            buildRiskFactorDependencies(scenarioSimMarket, portfolio, tradeHasError);
+            affectedTrades_.resize(trades.size(), true);
+            if (analyticDeltas_)
+                buildAnalyticDeltas(scenarioSimMarket, portfolio);
+        } else {
+            WLOG("Incremental valuation requires a scenario sim market, a single valuation date equal to the asof date "
+                 "and no netting set cube, fall back to full revaluation");
+        }
+    } else if (analyticDeltas_) {
+        WLOG("Analytic deltas require incremental valuation, all trades are repriced");
+    }
+
+    /* the observation mode of each trade: in the mode Disable no notifications take place and in the mode Unregister
+       the sim market curves do not notify their observers, so all trades are updated explicitly then, in the other
+       modes the trades follow the trade type overrides */
+    forceUpdate_.assign(trades.size(), false);
+    Size tradeIndex = 0;
+    Size overridden = 0;
+    for (const auto& [tradeId, trade] : trades) {
+        ObservationMode::Mode tradeMode = om;
+        if (om == ObservationMode::Mode::None || om == ObservationMode::Mode::Defer) {
+            auto m = tradeTypeObservationModes_.find(trade->tradeType());
+            if (m != tradeTypeObservationModes_.end()) {
+                tradeMode = m->second;
+                ++overridden;
+            }
+        }
+        forceUpdate_[tradeIndex++] =
+            tradeMode == ObservationMode::Mode::Disable || tradeMode == ObservationMode::Mode::Unregister;
+        if (tradeMode == ObservationMode::Mode::Unregister) {
             for (const Leg& leg : trade->legs()) {
                 for (Size n = 0; n < leg.size(); n++) {
                     boost::shared_ptr<FloatingRateCoupon> frc = boost::dynamic_pointer_cast<FloatingRateCoupon>(leg[n]);
@@ -149,13 +277,18 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
                 }
             }
         }
-        ++i;
     }
-    LOG("Total number of trades = " << portfolio->size());
+    if (!tradeTypeObservationModes_.empty()) {
+        if (om == ObservationMode::Mode::None || om == ObservationMode::Mode::Defer)
+            DLOG("ValuationEngine: observation mode overridden by trade type for " << overridden << " trades");
+        else
+            WLOG("ValuationEngine: trade type observation modes are ignored in the observation mode Disable and "
+                 "Unregister");
+    }
 
     if (!dates.empty() && dates.front() > simMarket_->asofDate()) {
         // the fixing manager is only required if sim dates contain future dates
-        simMarket_->fixingManager()->initialise(portfolio, simMarket_);
+        simMarket_->fixingManager()->initialise(portfolio, simMarket_, Market::defaultConfiguration, dates);
     }
 
     cpu_timer timer;
@@ -163,10 +296,18 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
     // We call Cube::samples() each time her to allow for dynamic stopping times
     // e.g. MC convergence tests
+    simulatedSamples_ = 0;
     for (Size sample = 0; sample < (dryRun ? std::min<Size>(1, outputCube->samples()) : outputCube->samples());
          ++sample) {
+        if (convergenceMonitor_ && convergenceMonitor_->converged()) {
+            LOG("ValuationEngine: exposures converged after " << sample << " samples, stop the simulation");
+            break;
+        }
         updateProgress(sample, outputCube->samples());
 
+        TraceSpan sampleSpan("simulation", "ValuationEngine::sample");
+        sampleSpan.arg("sample", sample);
+
         for (auto& [tradeId, trade] : portfolio->trades())
             trade->instrument()->reset();
 
@@ -183,18 +324,20 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
             if (dg_->isCloseOutDate()[i]) {
                 timer.start();
 
-                // update market
+                // update market, the notifications are batched until the fixings are updated in postUpdate()
+                ObservableNotificationBatch batch(ObservableNotificationBatch::useForMarketUpdates());
                 simMarket_->preUpdate();
                 if (!mporStickyDate)
                     simMarket_->updateDate(d);
                 simMarket_->updateScenario(d);
                 scenarioUpdated = true;
+                batch.flush();
                 simMarket_->postUpdate(d, !mporStickyDate); // with fixings only if not sticky
 
                 recalibrateModels();
 
                 timer.stop();
-                updateTime += timer.elapsed().wall * 1e-9;
+                updateTiming.add(timer.elapsed());
 
                 // loop over trades
                 timer.start();
@@ -207,7 +350,7 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
                 if (mporStickyDate) // switch on again, if sticky
                     tradeExercisable(true, trades);
                 timer.stop();
-                pricingTime += timer.elapsed().wall * 1e-9;
+                pricingTiming.add(timer.elapsed());
             }
 
             // process a valuation date as usual
@@ -218,11 +361,13 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
                 // All the steps below from preUpdate() to updateAsd(d) are combined in update(d), but we decompose as
                 // follows simMarket_->update(d);
+                ObservableNotificationBatch batch(ObservableNotificationBatch::useForMarketUpdates());
                 simMarket_->preUpdate();
                 simMarket_->updateDate(d);
                 // We can skip this step, if we have done that above in the close-out date section
                 if (!scenarioUpdated)
                     simMarket_->updateScenario(d);
+                batch.flush();
                 // Always with fixing update here, in contrast to the close-out date section
                 simMarket_->postUpdate(d, true);
                 // Aggregation scenario data update on valuation dates only
@@ -230,30 +375,45 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
                 recalibrateModels();
 
+                if (!affectedTrades_.empty())
+                    updateAffectedTrades();
+
                 timer.stop();
-                updateTime += timer.elapsed().wall * 1e-9;
+                updateTiming.add(timer.elapsed());
 
                 timer.start();
                 // loop over trades
                 runCalculators(false, trades, tradeHasError, calculators, outputCube, outputCubeNettingSet, d,
                                cubeDateIndex, sample, simMarket_->label());
+                if (!analyticTrades_.empty())
+                    applyAnalyticDeltas(tradeHasError, outputCube, cubeDateIndex, sample);
                 // loop over counterparty names
                 runCalculators(false, counterparties, cptyCalculators, outputCptyCube, d, cubeDateIndex, sample);
                 timer.stop();
-                pricingTime += timer.elapsed().wall * 1e-9;
+                pricingTiming.add(timer.elapsed());
             }
         }
 
         timer.start();
-        simMarket_->fixingManager()->reset();
-        fixingTime += timer.elapsed().wall * 1e-9;
+        {
+            TraceSpan fixingSpan("simulation", "FixingManager::reset");
+            simMarket_->fixingManager()->reset();
+        }
+        fixingTiming.add(timer.elapsed());
+
+        simulatedSamples_ = sample + 1;
+        if (convergenceMonitor_ && !dryRun)
+            convergenceMonitor_->add(outputCube, sample);
     }
 
     if (dryRun) {
         LOG("Doing a dry run - fill remaining cube with random values.");
+        simulatedSamples_ = outputCube->samples();
         for (Size sample = 1; sample < outputCube->samples(); ++sample) {
             for (Size i = 0; i < dates.size(); ++i) {
                 for (Size j = 0; j < trades.size(); ++j) {
+                    if (!tradeDateLengths_.empty() && i >= tradeDateLengths_[j])
+                        continue;
                     for (Size d = 0; d < outputCube->depth(); ++d) {
                         // add some noise, but only for the first few samples, so that e.g.
                         // a sensi run is not polluted with too many sensis for each trade
@@ -269,9 +429,61 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
     updateProgress(outputCube->samples(), outputCube->samples());
     loopTimer.stop();
     LOG("ValuationEngine completed: loop " << setprecision(2) << loopTimer.format(2, "%w") << " sec, "
-                                           << "pricing " << pricingTime << " sec, "
-                                           << "update " << updateTime << " sec "
-                                           << "fixing " << fixingTime);
+                                           << "pricing " << pricingTiming.wall * 1e-9 << " sec, "
+                                           << "update " << updateTiming.wall * 1e-9 << " sec "
+                                           << "fixing " << fixingTiming.wall * 1e-9);
+
+    if (collectTimings_) {
+        timings_.phases["MarketUpdate"].add(updateTiming);
+        timings_.phases["Pricing"].add(pricingTiming);
+        timings_.phases["Fixings"].add(fixingTiming);
+        i = 0;
+        for (auto const& [tradeId, trade] : trades) {
+            timings_.trades[tradeId].add(tradeTimings_[i++]);
+            timings_.tradeTypes[tradeId] = trade->tradeType();
+        }
+        for (Size c = 0; c < calculators.size(); ++c)
+            timings_.calculators[calculatorName(calculators[c])].add(calculatorTimings_[c]);
+        ValuationEngineTimings::Timing otherUpdates = updateTiming;
+        if (ssm) {
+            for (auto const& [type, t] : ssm->updateTimings()) {
+                auto start = updateTimingsStart.find(type);
+                ValuationEngineTimings::Timing u;
+                u.count = updateTiming.count;
+                u.wall = t.wall - (start == updateTimingsStart.end() ? 0 : start->second.wall);
+                u.cpu = t.user + t.system -
+                        (start == updateTimingsStart.end() ? 0 : start->second.user + start->second.system);
+                timings_.marketUpdates[ore::data::to_string(type)].add(u);
+                otherUpdates.wall -= u.wall;
+                otherUpdates.cpu -= u.cpu;
+            }
+            ssm->setCollectUpdateTimings(false);
+        }
+        timings_.marketUpdates["Other"].add(otherUpdates);
+    }
+
+    if (analyticDeltas_ && validateAnalyticDeltas_ && !analyticDeltaFactors_.empty()) {
+        i = 0;
+        Size nDeviations = 0;
+        for (auto const& [tradeId, trade] : trades) {
+            if (analyticDeltaFactors_[i] != Null<Real>() && !tradeHasError[i]) {
+                Real dev = analyticDeltaMaxChange_[i] > 0.0
+                               ? analyticDeltaMaxDeviation_[i] / analyticDeltaMaxChange_[i]
+                               : analyticDeltaMaxDeviation_[i];
+                analyticDeltaDeviations_[tradeId] = dev;
+                if (dev > 0.01) {
+                    WLOG("Analytic deltas for trade " << tradeId << " deviate from the repriced values by up to "
+                                                      << analyticDeltaMaxDeviation_[i]
+                                                      << ", the maximum npv change is "
+                                                      << analyticDeltaMaxChange_[i]);
+                    ++nDeviations;
+                }
+            }
+            ++i;
+        }
+        LOG("Validated analytic deltas of " << analyticDeltaDeviations_.size() << " trades, " << nDeviations
+                                            << " trades deviate by more than 1% of their maximum npv change");
+    }
 
     // for trades with errors set all output cube values to zero
     i = 0;
@@ -291,9 +503,47 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
                                      boost::shared_ptr<analytics::NPVCube>& outputCube,
                                      boost::shared_ptr<analytics::NPVCube>& outputCubeNettingSet, const Date& d,
                                      const Size cubeDateIndex, const Size sample, const string& label) {
-    ObservationMode::Mode om = ObservationMode::instance().mode();
+    TraceSpan span("simulation", "ValuationEngine::runCalculators");
+    if (span.active())
+        span.arg("date", ore::data::to_string(d)).arg("closeOut", isCloseOutDate ? "true" : "false");
     for(auto& calc: calculators)
         calc->initScenario();
+
+    // without timings the calculators are called once for all trades, otherwise per trade to attribute the timings
+    if (!collectTimings_) {
+        batchActive_.assign(trades.size(), false);
+        size_t j = 0;
+        for (auto tradeIt = trades.begin(); tradeIt != trades.end(); ++tradeIt, ++j) {
+            if (tradeHasError[j])
+                continue;
+            // matured trades: the cube values stay zero
+            if (!tradeDateLengths_.empty() && cubeDateIndex >= tradeDateLengths_[j])
+                continue;
+            // incremental valuation: the trade's inputs did not move, so its results are the T0 results
+            if (!affectedTrades_.empty() && !affectedTrades_[j]) {
+                for (Size d = 0; d < outputCube->depth(); ++d)
+                    outputCube->set(outputCube->getT0(j, d), j, cubeDateIndex, sample, d);
+                continue;
+            }
+            if (forceUpdate_[j])
+                tradeIt->second->instrument()->updateQlInstruments();
+            batchActive_[j] = true;
+        }
+        std::map<Size, std::string> errors;
+        for (auto& calc : calculators)
+            calc->calculateBatch(batchTrades_, batchActive_, simMarket_, outputCube, outputCubeNettingSet, d,
+                                 cubeDateIndex, sample, isCloseOutDate, errors);
+        for (const auto& [index, msg] : errors) {
+            const auto& trade = batchTrades_[index];
+            string expMsg = "date = " + ore::data::to_string(io::iso_date(d)) +
+                            ", sample = " + ore::data::to_string(sample) + ", label = " + label + ": " + msg;
+            ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "ScenarioValuation", expMsg.c_str()));
+            tradeHasError[index] = true;
+        }
+        return;
+    }
+
+    cpu_timer tradeTimer;
     // loop over trades
     size_t j = 0;
     for (auto tradeIt = trades.begin(); tradeIt != trades.end(); ++tradeIt, ++j) {
@@ -302,13 +552,33 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
             continue;
         }
 
+        // matured trades: the cube values stay zero
+        if (!tradeDateLengths_.empty() && cubeDateIndex >= tradeDateLengths_[j])
+            continue;
+
+        // incremental valuation: the trade's inputs did not move, so its results are the T0 results
+        if (!affectedTrades_.empty() && !affectedTrades_[j]) {
+            for (Size d = 0; d < outputCube->depth(); ++d)
+                outputCube->set(outputCube->getT0(j, d), j, cubeDateIndex, sample, d);
+            continue;
+        }
+
+        if (collectTimings_)
+            tradeTimer.start();
+
         // We can avoid checking mode here and always call updateQlInstruments()
-        if (om == ObservationMode::Mode::Disable || om == ObservationMode::Mode::Unregister)
+        if (forceUpdate_[j])
             trade->instrument()->updateQlInstruments();
         try {
-            for (auto& calc : calculators)
-                calc->calculate(trade, j, simMarket_, outputCube, outputCubeNettingSet, d, cubeDateIndex, sample,
-                                isCloseOutDate);
+            for (Size c = 0; c < calculators.size(); ++c) {
+                boost::timer::cpu_times start = collectTimings_ ? tradeTimer.elapsed() : boost::timer::cpu_times();
+                calculators[c]->calculate(trade, j, simMarket_, outputCube, outputCubeNettingSet, d, cubeDateIndex,
+                                          sample, isCloseOutDate);
+                if (collectTimings_)
+                    calculatorTimings_[c].add(elapsedSince(tradeTimer, start));
+            }
+            if (collectTimings_)
+                tradeTimings_[j].add(tradeTimer.elapsed());
         } catch (const std::exception& e) {
             string expMsg = "date = " + ore::data::to_string(io::iso_date(d)) +
                             ", sample = " + ore::data::to_string(sample) + ", label = " + label + ": " + e.what();
@@ -330,6 +600,235 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
     }
 }
 
+void ValuationEngine::buildRiskFactorDependencies(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                                  const boost::shared_ptr<data::Portfolio>& portfolio,
+                                                  const std::vector<bool>& tradeHasError) {
+
+    LOG("Build risk factor dependencies for incremental valuation");
+    cpu_timer timer;
+
+    const auto& trades = portfolio->trades();
+
+    // use the market requests recorded while building the portfolio if they are available for all trades
+
+    const auto& marketRequests = portfolio->marketRequests();
+    bool useRequests = simMarket->parameters() != nullptr;
+    for (auto const& [tradeId, trade] : trades)
+        useRequests = useRequests && marketRequests.find(tradeId) != marketRequests.end();
+
+    // collect the instruments of each trade, trades that are not plain instrument wrappers (e.g. option wrappers with
+    // their exercise logic) or that were not priced successfully at T0 are always repriced
+
+    alwaysReprice_.assign(trades.size(), false);
+    std::vector<std::vector<boost::shared_ptr<Instrument>>> instruments(trades.size());
+    std::vector<std::string> npvCurrencies(trades.size());
+    Size j = 0;
+    for (const auto& [tradeId, trade] : trades) {
+        auto wrapper = trade->instrument();
+        npvCurrencies[j] = trade->npvCurrency();
+        if (tradeHasError[j] || !boost::dynamic_pointer_cast<VanillaInstrument>(wrapper) ||
+            wrapper->qlInstrument() == nullptr) {
+            alwaysReprice_[j++] = true;
+            continue;
+        }
+        instruments[j].push_back(wrapper->qlInstrument());
+        for (auto const& a : wrapper->additionalInstruments()) {
+            if (a)
+                instruments[j].push_back(a);
+        }
+        if (!useRequests) {
+            for (auto const& inst : instruments[j])
+                alwaysReprice_[j] = alwaysReprice_[j] || !inst->isCalculated();
+        }
+        ++j;
+    }
+
+    // group the sim market quotes by key type and name, the keys of a group are contiguous in the sim data map
+
+    riskFactorQuotes_.clear();
+    riskFactorBaseValues_.clear();
+    riskFactorGroups_.clear();
+    riskFactorGroupTypes_.clear();
+    std::vector<RiskFactorKey> groupKeys;
+    for (auto const& [key, quote] : simMarket->simData()) {
+        if (groupKeys.empty() || groupKeys.back().keytype != key.keytype || groupKeys.back().name != key.name) {
+            groupKeys.push_back(key);
+            riskFactorGroupTypes_.push_back(key.keytype);
+        }
+        riskFactorQuotes_.push_back(quote);
+        riskFactorBaseValues_.push_back(quote->value());
+        riskFactorGroups_.push_back(groupKeys.size() - 1);
+    }
+
+    riskFactorDependencies_.assign(groupKeys.size(), std::vector<Size>());
+    Size nDependencies = 0;
+
+    if (useRequests) {
+        std::map<std::pair<RiskFactorKey::KeyType, std::string>, Size> groupIndex;
+        for (Size g = 0; g < groupKeys.size(); ++g)
+            groupIndex[std::make_pair(groupKeys[g].keytype, groupKeys[g].name)] = g;
+        const std::string& baseCcy = simMarket->parameters()->baseCcy();
+        j = 0;
+        for (const auto& [tradeId, trade] : trades) {
+            if (!alwaysReprice_[j]) {
+                for (auto const& f : tradeRiskFactors(*simMarket, baseCcy, *trade, marketRequests.at(tradeId))) {
+                    riskFactorDependencies_[groupIndex.at(f)].push_back(j);
+                    ++nDependencies;
+                }
+            }
+            ++j;
+        }
+        timer.stop();
+        LOG("Found " << nDependencies << " trade dependencies on " << groupKeys.size()
+                     << " risk factor groups from the recorded market requests, "
+                     << std::count(alwaysReprice_.begin(), alwaysReprice_.end(), true) << " trades are always repriced ("
+                     << timer.format(default_places, "%w") << " sec)");
+        return;
+    }
+
+    // bump the quotes of each group and collect the instruments which were notified, then restore the base values and
+    // reprice the notified instruments, so that they can be notified again by the next group
+    Size q0 = 0;
+    for (Size g = 0; g < groupKeys.size(); ++g) {
+        Size q1 = q0;
+        while (q1 < riskFactorQuotes_.size() && riskFactorGroups_[q1] == g)
+            ++q1;
+        for (Size q = q0; q < q1; ++q) {
+            Real v = riskFactorBaseValues_[q];
+            riskFactorQuotes_[q]->setValue(v == 0.0 ? 1.0E-4 : v * (1.0 + 1.0E-4));
+        }
+        recalibrateModels();
+        for (Size q = q0; q < q1; ++q)
+            riskFactorQuotes_[q]->setValue(riskFactorBaseValues_[q]);
+        recalibrateModels();
+        // the calculators convert the trade npv with the sim market fx spot, which the instruments do not observe
+        bool isFxSpot = groupKeys[g].keytype == RiskFactorKey::KeyType::FXSpot;
+        for (j = 0; j < trades.size(); ++j) {
+            if (alwaysReprice_[j])
+                continue;
+            bool notified = isFxSpot && groupKeys[g].name.find(npvCurrencies[j]) != std::string::npos;
+            try {
+                for (auto const& inst : instruments[j]) {
+                    if (!inst->isCalculated()) {
+                        notified = true;
+                        inst->NPV();
+                    }
+                }
+            } catch (const std::exception&) {
+                alwaysReprice_[j] = true;
+                continue;
+            }
+            if (notified) {
+                riskFactorDependencies_[g].push_back(j);
+                ++nDependencies;
+            }
+        }
+        q0 = q1;
+    }
+
+    timer.stop();
+    LOG("Found " << nDependencies << " trade dependencies on " << groupKeys.size() << " risk factor groups, "
+                 << std::count(alwaysReprice_.begin(), alwaysReprice_.end(), true) << " trades are always repriced ("
+                 << timer.format(default_places, "%w") << " sec)");
+}
+
+void ValuationEngine::updateAffectedTrades() {
+    affectedTrades_ = alwaysReprice_;
+    bool yieldCurvesOnly = true;
+    for (Size q = 0; q < riskFactorQuotes_.size(); ++q) {
+        if (riskFactorQuotes_[q]->value() != riskFactorBaseValues_[q]) {
+            Size g = riskFactorGroups_[q];
+            for (auto j : riskFactorDependencies_[g])
+                affectedTrades_[j] = true;
+            RiskFactorKey::KeyType t = riskFactorGroupTypes_[g];
+            yieldCurvesOnly = yieldCurvesOnly && (t == RiskFactorKey::KeyType::DiscountCurve ||
+                                                  t == RiskFactorKey::KeyType::IndexCurve ||
+                                                  t == RiskFactorKey::KeyType::YieldCurve);
+            // skip the remaining keys of this group
+            while (q + 1 < riskFactorQuotes_.size() && riskFactorGroups_[q + 1] == g)
+                ++q;
+        }
+    }
+
+    // the affected trades with zero rate dependencies are valued analytically if only yield curves moved
+    if (analyticDeltaFactors_.empty())
+        return;
+    analyticTrades_.assign(affectedTrades_.size(), false);
+    if (!yieldCurvesOnly)
+        return;
+    for (Size j = 0; j < affectedTrades_.size(); ++j) {
+        if (affectedTrades_[j] && analyticDeltaFactors_[j] != Null<Real>()) {
+            analyticTrades_[j] = true;
+            affectedTrades_[j] = validateAnalyticDeltas_;
+        }
+    }
+}
+
+void ValuationEngine::buildAnalyticDeltas(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                          const boost::shared_ptr<data::Portfolio>& portfolio) {
+    const auto& trades = portfolio->trades();
+    analyticDeltaDependencies_.assign(trades.size(), std::vector<AnalyticDelta>());
+    analyticDeltaFactors_.assign(trades.size(), Null<Real>());
+    analyticDeltaMaxDeviation_.assign(trades.size(), 0.0);
+    analyticDeltaMaxChange_.assign(trades.size(), 0.0);
+
+    if (simMarket->parameters() == nullptr) {
+        WLOG("Analytic deltas require the sim market parameters, all trades are repriced");
+        return;
+    }
+    const std::string& baseCcy = simMarket->parameters()->baseCcy();
+
+    // the sim market is in its base state here, i.e. the zero rates are the T0 zero rates
+    Size j = 0, nAnalytic = 0;
+    for (const auto& [tradeId, trade] : trades) {
+        auto wrapper = trade->instrument();
+        if (!alwaysReprice_[j] && wrapper->additionalInstruments().empty()) {
+            auto const& results = wrapper->qlInstrument()->additionalResults();
+            auto r = results.find("zeroRateDependencies");
+            if (r != results.end()) {
+                try {
+                    for (auto const& d : boost::any_cast<const std::vector<ZeroRateDependency>&>(r->second)) {
+                        analyticDeltaDependencies_[j].push_back(
+                            {d.curve, d.time, d.delta,
+                             d.curve->zeroRate(d.time, Continuous, NoFrequency, true).rate()});
+                    }
+                    analyticDeltaFactors_[j] = wrapper->multiplier() *
+                                               simMarket->fxRate(trade->npvCurrency() + baseCcy)->value() /
+                                               simMarket->numeraire();
+                    ++nAnalytic;
+                } catch (const std::exception& e) {
+                    WLOG("Could not set up analytic deltas for trade " << tradeId << ", it is repriced: " << e.what());
+                    analyticDeltaDependencies_[j].clear();
+                    analyticDeltaFactors_[j] = Null<Real>();
+                }
+            }
+        }
+        ++j;
+    }
+    LOG("Analytic deltas are used for " << nAnalytic << " out of " << trades.size() << " trades");
+}
+
+void ValuationEngine::applyAnalyticDeltas(const std::vector<bool>& tradeHasError,
+                                          boost::shared_ptr<analytics::NPVCube>& outputCube,
+                                          const Size cubeDateIndex, const Size sample) {
+    for (Size j = 0; j < analyticTrades_.size(); ++j) {
+        if (!analyticTrades_[j] || tradeHasError[j])
+            continue;
+        Real change = 0.0;
+        for (auto const& d : analyticDeltaDependencies_[j])
+            change += d.delta * (d.curve->zeroRate(d.time, Continuous, NoFrequency, true).rate() - d.baseZeroRate);
+        Real t0 = outputCube->getT0(j, 0);
+        Real value = t0 + analyticDeltaFactors_[j] * change;
+        if (validateAnalyticDeltas_) {
+            Real repriced = outputCube->get(j, cubeDateIndex, sample, 0);
+            analyticDeltaMaxDeviation_[j] = std::max(analyticDeltaMaxDeviation_[j], std::abs(value - repriced));
+            analyticDeltaMaxChange_[j] = std::max(analyticDeltaMaxChange_[j], std::abs(repriced - t0));
+        } else {
+            outputCube->set(value, j, cubeDateIndex, sample, 0);
+        }
+    }
+}
+
 void ValuationEngine::tradeExercisable(bool enable, const std::map<std::string, boost::shared_ptr<Trade>>& trades) {
     for (const auto& [tradeId, trade] : trades) {
         auto t = boost::dynamic_pointer_cast<OptionWrapper>(trade->instrument());
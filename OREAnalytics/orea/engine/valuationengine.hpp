@@ -25,13 +25,20 @@
 
 #include <orea/cube/npvcube.hpp>
 #include <orea/engine/cptycalculator.hpp>
+#include <orea/engine/exposureconvergencemonitor.hpp>
+#include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationcalculator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/simulation/simmarket.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/utilities/dategrid.hpp>
 #include <ored/utilities/progressbar.hpp>
 #include <qle/models/modelbuilder.hpp>
 
+#include <boost/timer/timer.hpp>
+
+#include <functional>
+
 #include <map>
 #include <set>
 
@@ -39,6 +46,35 @@ namespace ore {
 namespace analytics {
 using std::set;
 
+//! Timings collected by the ValuationEngine, see ValuationEngine::setCollectTimings()
+/*! The cpu times are process times as reported by boost::timer, i.e. they are only meaningful for single-threaded
+    runs, while the wall times are always attributed correctly.
+
+  \ingroup simulation
+*/
+struct ValuationEngineTimings {
+    //! cumulated wall and cpu (user + system) time in nanoseconds over a number of measurements
+    struct Timing {
+        QuantLib::Size count = 0;
+        boost::timer::nanosecond_type wall = 0, cpu = 0;
+        void add(const boost::timer::cpu_times& t, const QuantLib::Size n = 1);
+        void add(const Timing& t);
+    };
+    //! pricing time by trade id, including the instrument update and all calculators
+    std::map<std::string, Timing> trades;
+    //! trade type by trade id
+    std::map<std::string, std::string> tradeTypes;
+    //! time by calculator class name
+    std::map<std::string, Timing> calculators;
+    /*! time spent in applying the scenarios to the sim market by risk factor type, the remainder of the market update
+        (date and fixing updates, deferred notifications, model recalibration) is reported as "Other" */
+    std::map<std::string, Timing> marketUpdates;
+    //! total time by phase (MarketUpdate, Pricing, Fixings)
+    std::map<std::string, Timing> phases;
+    //! add the timings collected by another engine, e.g. by another worker of a multi-threaded run
+    void add(const ValuationEngineTimings& other);
+};
+
 //! Valuation Engine
 /*!
   The valuation engine's purpose is to generate an NPV cube.
@@ -88,8 +124,101 @@ public:
         //! Limit samples to one and fill the rest of the cube with random values
         bool dryRun = false);
 
+    /*! can be optionally called to enable incremental valuation: before the scenario loop the engine determines the
+        risk factor groups (key type and name) each trade depends on by bumping the sim market quotes of one group at
+        a time and recording which instruments are notified; in the scenario loop only trades depending on a group
+        that moved away from its base value are repriced, for all other trades the T0 values are copied into the
+        cube. The dependency probe costs roughly one revaluation of each trade per group it depends on, so this pays
+        off for sensitivity runs and large stress tests, where most scenarios shift a single curve or surface.
+
+        If the market objects requested by the trades were recorded while the portfolio was built against the sim
+        market (see ScenarioSimMarket::setRecordRequests() and Portfolio::marketRequests()), the dependencies are
+        taken from these requests instead, see tradeRiskFactors(), which avoids the dependency probe.
+
+        This requires a ScenarioSimMarket and a date grid consisting of the asof date only, and it assumes that the
+        calculators produce their T0 values when the market is in its base state (true for the NPV calculators);
+        trades which are not plain instrument wrappers are always repriced. In other setups the engine falls back to
+        a full revaluation. */
+    void setIncrementalValuation(const bool incrementalValuation) { incrementalValuation_ = incrementalValuation; }
+
+    /*! can be optionally called in addition to setIncrementalValuation() to value trades with linear dependencies on
+        the yield curves analytically: trades whose instrument publishes its zero rate dependencies (see
+        QuantExt::ZeroRateDependency, e.g. swaps priced with the DiscountingSwapEngineOptimised or fx forwards, if the
+        engine factory has the global parameter ZeroRateDependencies set to true) are not repriced in scenarios that
+        move discount, index or yield curves only. Instead the first order npv change, i.e. the sum of the deltas
+        times the change of the curves' zero rates at the dependency times, converted with the T0 fx rate to the sim
+        market base currency, is added to the T0 value at cube depth 0, which is assumed to hold the npv in base
+        currency (NPVCalculator). All other depths get their T0 values.
+
+        If validate is true, these trades are repriced all the same and the cube holds the repriced values, the
+        analytic values are compared against them, see analyticDeltaDeviations(). */
+    void setAnalyticDeltas(const bool analyticDeltas, const bool validate = false) {
+        analyticDeltas_ = analyticDeltas;
+        validateAnalyticDeltas_ = validate;
+    }
+
+    /*! the maximum deviation of the analytic values from the repriced values over all scenarios, relative to the
+        maximum absolute npv change by trade id, if the analytic deltas were validated, see setAnalyticDeltas() */
+    const std::map<std::string, QuantLib::Real>& analyticDeltaDeviations() const { return analyticDeltaDeviations_; }
+
+    /*! can be optionally called to skip the pricing of trades on valuation dates after their maturity, the cube values
+        of these dates are left untouched, i.e. they are expected to be zero already. Close-out dates are skipped if
+        their valuation date is after the maturity. This is required for cubes storing each trade up to its maturity
+        only, see TruncatedCube. */
+    void setSkipMaturedTrades(const bool skipMaturedTrades) { skipMaturedTrades_ = skipMaturedTrades; }
+
+    /*! can be optionally called to collect timings per trade, per calculator and per phase of buildCube(), the sim
+        market update time is split by risk factor type if the sim market is a ScenarioSimMarket; the timings of
+        several buildCube() calls are accumulated */
+    void setCollectTimings(const bool collectTimings) { collectTimings_ = collectTimings; }
+
+    //! the collected timings, see setCollectTimings()
+    const ValuationEngineTimings& timings() const { return timings_; }
+
+    /*! can be optionally called to reuse the T0 values which another engine on the same portfolio writes into the
+        output cube, e.g. another worker of the MultiThreadedValuationEngine in the sample-parallel mode: the T0
+        valuation of the calculators is skipped and \p waitForT0 is called instead, which must return once the T0
+        values are available in the output cube or throw. This assumes that the calculators do not keep state from
+        their T0 valuation (true for the NPV calculators). Since the trades are not priced at T0, T0 pricing errors are
+        not detected and incremental valuation relies on recorded market requests, see setIncrementalValuation(). */
+    void setReuseT0(const std::function<void()>& waitForT0) { waitForT0_ = waitForT0; }
+
+    //! can be optionally called to be notified once the T0 values are written into the output cube, see setReuseT0()
+    void setT0Callback(const std::function<void()>& t0Done) { t0Done_ = t0Done; }
+
+    /*! can be optionally called to stop the simulation once the monitor reports convergence, each sample of the output
+        cube is added to the monitor after it is generated; the remaining samples of the cube are left untouched, the
+        number of generated samples is given by simulatedSamples() */
+    void setConvergenceMonitor(const boost::shared_ptr<ExposureConvergenceMonitor>& monitor) {
+        convergenceMonitor_ = monitor;
+    }
+
+    //! the number of samples generated by the last buildCube() call
+    Size simulatedSamples() const { return simulatedSamples_; }
+
+    /*! can be optionally called to override the trade level handling of the global ObservationMode by trade type, in
+        the global modes None and Defer: trades of a type mapped to Unregister have their floating coupons detached
+        from the index notifications and are updated explicitly before each pricing, which
+        is cheaper for eager instruments with many coupons; trades mapped to None rely on the notifications. In the
+        global modes Disable and Unregister all trades are updated explicitly and the overrides are ignored. */
+    void setTradeTypeObservationModes(const std::map<std::string, ObservationMode::Mode>& modes) {
+        tradeTypeObservationModes_ = modes;
+    }
+
 private:
     void recalibrateModels();
+    //! determine the trades depending on each risk factor group of the sim market, see setIncrementalValuation()
+    void buildRiskFactorDependencies(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                     const boost::shared_ptr<data::Portfolio>& portfolio,
+                                     const std::vector<bool>& tradeHasError);
+    //! flag the trades that have to be repriced given the current state of the sim market
+    void updateAffectedTrades();
+    //! collect the zero rate dependencies of the trades that can be valued analytically, see setAnalyticDeltas()
+    void buildAnalyticDeltas(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                             const boost::shared_ptr<data::Portfolio>& portfolio);
+    //! write the analytic values of the current scenario into the cube resp. compare them to the repriced values
+    void applyAnalyticDeltas(const std::vector<bool>& tradeHasError, boost::shared_ptr<analytics::NPVCube>& outputCube,
+                             const Size cubeDateIndex, const Size sample);
     void runCalculators(bool isCloseOutDate, const std::map<std::string, boost::shared_ptr<Trade>>& trades,
                         std::vector<bool>& tradeHasError,
                         const std::vector<boost::shared_ptr<ValuationCalculator>>& calculators,
@@ -105,6 +234,60 @@ private:
     boost::shared_ptr<DateGrid> dg_;
     boost::shared_ptr<analytics::SimMarket> simMarket_;
     set<std::pair<string, boost::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders_;
+
+    bool incrementalValuation_ = false;
+    // sim market quotes with their base values and the index of the risk factor group they belong to
+    std::vector<boost::shared_ptr<QuantLib::SimpleQuote>> riskFactorQuotes_;
+    std::vector<QuantLib::Real> riskFactorBaseValues_;
+    std::vector<QuantLib::Size> riskFactorGroups_;
+    // trade indices depending on each risk factor group
+    std::vector<std::vector<QuantLib::Size>> riskFactorDependencies_;
+    // trades that are repriced in every scenario resp. in the current scenario, the latter is empty if incremental
+    // valuation is not active
+    std::vector<bool> alwaysReprice_, affectedTrades_;
+    // key type of each risk factor group
+    std::vector<RiskFactorKey::KeyType> riskFactorGroupTypes_;
+
+    bool analyticDeltas_ = false, validateAnalyticDeltas_ = false;
+    // zero rate dependencies with the base zero rates by trade index, empty for trades that are not valued analytically
+    struct AnalyticDelta {
+        boost::shared_ptr<QuantLib::YieldTermStructure> curve;
+        QuantLib::Time time;
+        QuantLib::Real delta, baseZeroRate;
+    };
+    std::vector<std::vector<AnalyticDelta>> analyticDeltaDependencies_;
+    // factor converting the instrument npv change to the cube value (multiplier, T0 fx rate, numeraire)
+    std::vector<QuantLib::Real> analyticDeltaFactors_;
+    // trades valued analytically in the current scenario, empty if analytic deltas are not active
+    std::vector<bool> analyticTrades_;
+    // maximum absolute deviation of the analytic values and maximum absolute npv change by trade index
+    std::vector<QuantLib::Real> analyticDeltaMaxDeviation_, analyticDeltaMaxChange_;
+    std::map<std::string, QuantLib::Real> analyticDeltaDeviations_;
+
+    bool skipMaturedTrades_ = false;
+    // number of valuation dates on or before the maturity of each trade, empty if matured trades are not skipped
+    std::vector<QuantLib::Size> tradeDateLengths_;
+
+    // see setTradeTypeObservationModes(), and the trades that are updated explicitly before their pricing
+    std::map<std::string, ObservationMode::Mode> tradeTypeObservationModes_;
+    std::vector<bool> forceUpdate_;
+
+    bool collectTimings_ = false;
+    ValuationEngineTimings timings_;
+    // timings by trade and by calculator index during buildCube()
+    std::vector<ValuationEngineTimings::Timing> tradeTimings_, calculatorTimings_;
+
+    // the trades in portfolio order and the trades to be priced in the current scenario, used for the batched
+    // calculator calls, see ValuationCalculator::calculateBatch()
+    std::vector<boost::shared_ptr<Trade>> batchTrades_;
+    std::vector<bool> batchActive_;
+
+    // see setConvergenceMonitor()
+    boost::shared_ptr<ExposureConvergenceMonitor> convergenceMonitor_;
+    Size simulatedSamples_ = 0;
+
+    // see setReuseT0() and setT0Callback()
+    std::function<void()> waitForT0_, t0Done_;
 };
 } // namespace analytics
 } // namespace ore
@@ -0,0 +1,266 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/vanillaoptionbatchcalculator.hpp>
+#include <ored/portfolio/equityoption.hpp>
+#include <ored/portfolio/fxoption.hpp>
+#include <ored/portfolio/instrumentwrapper.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/event.hpp>
+#include <ql/exercise.hpp>
+#include <ql/instruments/payoffs.hpp>
+#include <ql/instruments/vanillaoption.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+
+using namespace QuantLib;
+using ore::data::EquityOption;
+using ore::data::FxOption;
+using ore::data::VanillaInstrument;
+using ore::data::VanillaOptionTrade;
+
+namespace ore {
+namespace analytics {
+
+void blackFormulaBatch(const std::vector<Real>& phi, const std::vector<Real>& strike, const std::vector<Real>& forward,
+                       const std::vector<Real>& stdDev, const std::vector<Real>& discount, std::vector<Real>& npv) {
+    static const CumulativeNormalDistribution N;
+    const Size n = phi.size();
+    QL_REQUIRE(strike.size() == n && forward.size() == n && stdDev.size() == n && discount.size() == n,
+               "blackFormulaBatch: input sizes do not match, phi ("
+                   << n << "), strike (" << strike.size() << "), forward (" << forward.size() << "), stdDev ("
+                   << stdDev.size() << "), discount (" << discount.size() << ")");
+    npv.resize(n);
+    for (Size k = 0; k < n; ++k) {
+        if (stdDev[k] < QL_EPSILON) {
+            npv[k] = discount[k] * std::max(phi[k] * (forward[k] - strike[k]), 0.0);
+        } else {
+            Real d1 = std::log(forward[k] / strike[k]) / stdDev[k] + 0.5 * stdDev[k];
+            Real d2 = d1 - stdDev[k];
+            npv[k] = discount[k] * phi[k] * (forward[k] * N(phi[k] * d1) - strike[k] * N(phi[k] * d2));
+        }
+    }
+}
+
+void VanillaOptionBatchNPVCalculator::init(const boost::shared_ptr<Portfolio>& portfolio,
+                                           const boost::shared_ptr<SimMarket>& simMarket) {
+    NPVCalculator::init(portfolio, simMarket);
+    DLOG("init VanillaOptionBatchNPVCalculator");
+
+    // collect the candidates by underlying
+    std::vector<Underlying> candidates;
+    std::vector<std::vector<boost::shared_ptr<VanillaOption>>> options;
+    std::map<std::string, Size> underlyingIndex;
+    Size i = 0;
+    for (auto const& [tradeId, trade] : portfolio->trades()) {
+        Size tradeIndex = i++;
+        bool isFx = boost::dynamic_pointer_cast<FxOption>(trade) != nullptr;
+        if (!isFx && boost::dynamic_pointer_cast<EquityOption>(trade) == nullptr)
+            continue;
+        auto wrapper = trade->instrument();
+        if (wrapper == nullptr || typeid(*wrapper) != typeid(VanillaInstrument))
+            continue;
+        // derived instruments such as quanto or forward options have their own engines
+        auto option = boost::dynamic_pointer_cast<VanillaOption>(wrapper->qlInstrument());
+        if (option == nullptr || typeid(*option) != typeid(VanillaOption))
+            continue;
+        auto payoff = boost::dynamic_pointer_cast<PlainVanillaPayoff>(option->payoff());
+        if (payoff == nullptr || option->exercise()->type() != Exercise::European)
+            continue;
+
+        const std::string& asset = boost::dynamic_pointer_cast<VanillaOptionTrade>(trade)->asset();
+        const std::string& ccy = trade->npvCurrency();
+        std::string key = (isFx ? "FX/" : "EQ/") + asset + "/" + ccy;
+        auto u = underlyingIndex.find(key);
+        if (u == underlyingIndex.end()) {
+            Underlying c;
+            // the market objects of the AnalyticEuropeanEngine set up by the EuropeanOptionEngineBuilder
+            if (isFx) {
+                c.spot = simMarket->fxSpot(asset + ccy);
+                c.dividendCurve = simMarket->discountCurve(asset);
+                c.forecastCurve = simMarket->discountCurve(ccy);
+                c.vol = simMarket->fxVol(asset + ccy);
+            } else {
+                c.spot = simMarket->equitySpot(asset);
+                c.dividendCurve = simMarket->equityDividendCurve(asset);
+                c.forecastCurve = simMarket->equityForecastCurve(asset);
+                c.vol = simMarket->equityVol(asset);
+            }
+            c.discountCurve = simMarket->discountCurve(ccy);
+            u = underlyingIndex.emplace(key, candidates.size()).first;
+            candidates.push_back(c);
+            options.push_back({});
+        }
+        Underlying& c = candidates[u->second];
+        Date expiry = option->exercise()->lastDate();
+        auto e = std::find(c.expiries.begin(), c.expiries.end(), expiry);
+        c.expiryIndex.push_back(e - c.expiries.begin());
+        if (e == c.expiries.end())
+            c.expiries.push_back(expiry);
+        c.tradeIndex.push_back(tradeIndex);
+        c.phi.push_back(payoff->optionType() == Option::Call ? 1.0 : -1.0);
+        c.strike.push_back(payoff->strike());
+        c.multiplier.push_back(wrapper->multiplier());
+        options[u->second].push_back(option);
+    }
+
+    // keep the options for which the batch price matches the instrument npv in the current market state
+    underlyings_.clear();
+    isBatchTrade_.assign(portfolio->size(), false);
+    const Date asof = simMarket->asofDate();
+    for (Size u = 0; u < candidates.size(); ++u) {
+        Underlying& c = candidates[u];
+        try {
+            price(c, asof);
+        } catch (const std::exception& e) {
+            DLOG("VanillaOptionBatchNPVCalculator: can not price underlying " << u << " in batch: " << e.what());
+            continue;
+        }
+        Underlying b;
+        b.spot = c.spot;
+        b.dividendCurve = c.dividendCurve;
+        b.forecastCurve = c.forecastCurve;
+        b.discountCurve = c.discountCurve;
+        b.vol = c.vol;
+        b.expiries = c.expiries;
+        for (Size k = 0; k < c.tradeIndex.size(); ++k) {
+            Real npv;
+            try {
+                npv = options[u][k]->NPV();
+            } catch (const std::exception&) {
+                continue;
+            }
+            if (std::abs(c.npv[k] - npv) > 1.0E-8 * std::max(std::abs(npv), 1.0)) {
+                DLOG("VanillaOptionBatchNPVCalculator: batch price " << c.npv[k] << " of trade index "
+                                                                    << c.tradeIndex[k] << " does not match npv "
+                                                                    << npv << ", the trade is priced individually");
+                continue;
+            }
+            b.tradeIndex.push_back(c.tradeIndex[k]);
+            b.expiryIndex.push_back(c.expiryIndex[k]);
+            b.phi.push_back(c.phi[k]);
+            b.strike.push_back(c.strike[k]);
+            b.multiplier.push_back(c.multiplier[k]);
+            isBatchTrade_[c.tradeIndex[k]] = true;
+        }
+        if (!b.tradeIndex.empty())
+            underlyings_.push_back(b);
+    }
+    DLOG("VanillaOptionBatchNPVCalculator: " << batchTrades() << " trades on " << underlyings_.size()
+                                             << " underlyings are priced in batch");
+}
+
+Size VanillaOptionBatchNPVCalculator::batchTrades() const {
+    Size n = 0;
+    for (auto const& u : underlyings_)
+        n += u.tradeIndex.size();
+    return n;
+}
+
+void VanillaOptionBatchNPVCalculator::price(Underlying& u, const Date& asof) const {
+    const Size n = u.tradeIndex.size();
+    const Size m = u.expiries.size();
+    std::vector<bool> expired(m);
+    u.dividendDiscount.resize(m);
+    u.forecastDiscount.resize(m);
+    u.discount.resize(m);
+    for (Size e = 0; e < m; ++e) {
+        // the option npv is zero once the exercise date has occurred, as for the instrument
+        expired[e] = QuantLib::detail::simple_event(u.expiries[e]).hasOccurred(asof);
+        if (expired[e])
+            continue;
+        u.dividendDiscount[e] = u.dividendCurve->discount(u.expiries[e]);
+        u.forecastDiscount[e] = u.forecastCurve->discount(u.expiries[e]);
+        u.discount[e] = u.discountCurve->discount(u.expiries[e]);
+    }
+    const Real spot = u.spot->value();
+    u.forward.resize(n);
+    u.stdDev.resize(n);
+    u.optionDiscount.resize(n);
+    for (Size k = 0; k < n; ++k) {
+        Size e = u.expiryIndex[k];
+        if (expired[e]) {
+            u.forward[k] = u.strike[k];
+            u.stdDev[k] = 0.0;
+            u.optionDiscount[k] = 0.0;
+        } else {
+            u.forward[k] = spot * u.dividendDiscount[e] / u.forecastDiscount[e];
+            u.stdDev[k] = std::sqrt(u.vol->blackVariance(u.expiries[e], u.strike[k]));
+            u.optionDiscount[k] = u.discount[e];
+        }
+    }
+    blackFormulaBatch(u.phi, u.strike, u.forward, u.stdDev, u.optionDiscount, u.npv);
+}
+
+void VanillaOptionBatchNPVCalculator::calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades,
+                                                     const std::vector<bool>& active,
+                                                     const boost::shared_ptr<SimMarket>& simMarket,
+                                                     boost::shared_ptr<NPVCube>& outputCube,
+                                                     boost::shared_ptr<NPVCube>& outputCubeNettingSet,
+                                                     const Date& date, Size dateIndex, Size sample, bool isCloseOut,
+                                                     std::map<Size, std::string>& errors) {
+    if (isCloseOut)
+        return;
+
+    // the remaining trades are priced as in the NPVCalculator
+    perTradeActive_ = active;
+    for (Size i = 0; i < perTradeActive_.size(); ++i)
+        if (isBatchTrade_[i])
+            perTradeActive_[i] = false;
+    calculateBatchNPVs(trades, perTradeActive_, simMarket, outputCube, dateIndex, sample, errors);
+
+    const Real numeraire = simMarket->numeraire();
+    const Date asof = simMarket->asofDate();
+    for (auto& u : underlyings_) {
+        bool hasActiveTrades = false;
+        for (Size i : u.tradeIndex)
+            hasActiveTrades = hasActiveTrades || (active[i] && errors.count(i) == 0);
+        if (!hasActiveTrades)
+            continue;
+        try {
+            price(u, asof);
+        } catch (const std::exception& e) {
+            for (Size i : u.tradeIndex)
+                if (active[i])
+                    errors.emplace(i, e.what());
+            continue;
+        }
+        for (Size k = 0; k < u.tradeIndex.size(); ++k) {
+            Size i = u.tradeIndex[k];
+            if (!active[i] || errors.count(i) > 0)
+                continue;
+            try {
+                // premiums are priced by their instruments
+                Real npv = u.npv[k] * u.multiplier[k] + trades[i]->instrument()->additionalInstrumentsNPV();
+                if (!close_enough(npv, 0.0))
+                    npv *= fxRates_[tradeCcyIndex_[i]] / numeraire;
+                outputCube->set(npv, i, dateIndex, sample, index_);
+            } catch (const std::exception& e) {
+                errors[i] = e.what();
+            }
+        }
+    }
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file engine/vanillaoptionbatchcalculator.hpp
+    \brief NPV calculator pricing European FX and equity options in batches per underlying
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/engine/valuationcalculator.hpp>
+
+#include <ql/handle.hpp>
+#include <ql/quote.hpp>
+#include <ql/termstructures/volatility/equityfx/blackvoltermstructure.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Black formula for arrays of options, the results are written to npv
+/*! This is the formula of QuantLib::BlackCalculator for plain vanilla payoffs, with phi = +1 for calls and -1 for
+    puts, evaluated in one loop over the given options. */
+void blackFormulaBatch(const std::vector<Real>& phi, const std::vector<Real>& strike, const std::vector<Real>& forward,
+                       const std::vector<Real>& stdDev, const std::vector<Real>& discount, std::vector<Real>& npv);
+
+//! NPVCalculator pricing European FX and equity options in batches
+/*! The calculator identifies the FxOption and EquityOption trades that are priced as a QuantLib::VanillaOption with
+    European exercise and a plain vanilla payoff by the AnalyticEuropeanEngine. They are grouped by underlying and in
+    each scenario the forwards, standard deviations and discount factors of all options on an underlying are
+    gathered into arrays and priced with blackFormulaBatch(), bypassing the lazy object and pricing engine machinery
+    of the single trades. The results written to the cube are the same as those of the NPVCalculator, i.e. the trade
+    npv including premiums, converted to the base currency and divided by the numeraire.
+
+    Whether a trade is priced in batch is decided in init(): the batch price is compared to the instrument npv in the
+    market state at this point (normally T0), trades with other engines or a mismatch are priced as in the
+    NPVCalculator. The T0 values are always computed by the instruments.
+*/
+class VanillaOptionBatchNPVCalculator : public NPVCalculator {
+public:
+    //! base ccy and index to write to
+    VanillaOptionBatchNPVCalculator(const std::string& baseCcyCode, Size index = 0)
+        : NPVCalculator(baseCcyCode, index) {}
+
+    void init(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<SimMarket>& simMarket) override;
+
+    void calculateBatch(const std::vector<boost::shared_ptr<Trade>>& trades, const std::vector<bool>& active,
+                        const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
+                        boost::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date, Size dateIndex,
+                        Size sample, bool isCloseOut, std::map<Size, std::string>& errors) override;
+
+    //! Number of trades priced in batch, available after init()
+    Size batchTrades() const;
+
+private:
+    // the options on one underlying, the expiries are the distinct expiry dates of the options
+    struct Underlying {
+        QuantLib::Handle<QuantLib::Quote> spot;
+        QuantLib::Handle<QuantLib::YieldTermStructure> dividendCurve, forecastCurve, discountCurve;
+        QuantLib::Handle<QuantLib::BlackVolTermStructure> vol;
+        std::vector<Date> expiries;
+        std::vector<Size> tradeIndex, expiryIndex;
+        std::vector<Real> phi, strike, multiplier;
+        // work arrays
+        std::vector<Real> dividendDiscount, forecastDiscount, discount;
+        std::vector<Real> forward, stdDev, optionDiscount, npv;
+    };
+
+    // gather the inputs of the options on u from the current market state and price them
+    void price(Underlying& u, const Date& asof) const;
+
+    std::vector<Underlying> underlyings_;
+    std::vector<bool> isBatchTrade_;
+    std::vector<bool> perTradeActive_;
+};
+
+} // namespace analytics
+} // namespace ore
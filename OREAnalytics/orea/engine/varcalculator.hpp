@@ -33,6 +33,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -47,6 +48,15 @@ public:
 
     virtual QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true, 
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) = 0;
+
+    //! VaR for several confidence levels, calculators that can share work between the levels override this
+    virtual std::vector<QuantLib::Real> var(const std::vector<QuantLib::Real>& confidence, const bool isCall = true,
+                                            const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) {
+        std::vector<QuantLib::Real> res;
+        for (auto c : confidence)
+            res.push_back(var(c, isCall, tradeIds));
+        return res;
+    }
 };
 
 } // namespace analytics
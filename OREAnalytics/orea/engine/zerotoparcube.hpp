@@ -24,6 +24,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <orea/cube/sensitivitycube.hpp>
 #include <orea/engine/parsensitivityanalysis.hpp>
@@ -59,6 +60,12 @@ public:
     //! Return the non-zero par deltas for the given trade index
     std::map<ore::analytics::RiskFactorKey, QuantLib::Real> parDeltas(QuantLib::Size tradeIdx) const;
 
+    /*! Return the non-zero par deltas for each of the given trade indices. The zero deltas of all trades are collected
+        in one matrix and converted in a single pass over the conversion operator, so that the number of trades per
+        call should be chosen such that the block (number of zero factors x number of trades) fits into the cache. */
+    std::vector<std::map<ore::analytics::RiskFactorKey, QuantLib::Real>>
+    parDeltas(const std::vector<QuantLib::Size>& tradeIdx) const;
+
 private:
     boost::shared_ptr<ore::analytics::SensitivityCube> zeroCube_;
     boost::shared_ptr<ParSensitivityConverter> parConverter_;
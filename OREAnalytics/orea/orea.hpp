@@ -13,9 +13,11 @@
 #include <orea/aggregation/cvaspreadsensitivitycalculator.hpp>
 #include <orea/aggregation/dimcalculator.hpp>
 #include <orea/aggregation/dimregressioncalculator.hpp>
+#include <orea/aggregation/dimsimmcalculator.hpp>
 #include <orea/aggregation/dynamiccreditxvacalculator.hpp>
 #include <orea/aggregation/exposureallocator.hpp>
 #include <orea/aggregation/exposurecalculator.hpp>
+#include <orea/aggregation/exposurestatistics.hpp>
 #include <orea/aggregation/nettedexposurecalculator.hpp>
 #include <orea/aggregation/postprocess.hpp>
 #include <orea/aggregation/staticcreditxvacalculator.hpp>
@@ -33,29 +35,41 @@
 #include <orea/app/marketdatainmemoryloader.hpp>
 #include <orea/app/marketdataloader.hpp>
 #include <orea/app/oreapp.hpp>
+#include <orea/app/oreservice.hpp>
 #include <orea/app/parameters.hpp>
+#include <orea/app/reportsink.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/sensitivityrunner.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/app/xvarunner.hpp>
+#include <orea/app/xvasharding.hpp>
 #include <orea/app/zerosensitivityloader.hpp>
+#include <orea/cube/arrow_io.hpp>
+#include <orea/cube/binarycubefile.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/cubecsvreader.hpp>
 #include <orea/cube/cubeinterpretation.hpp>
 #include <orea/cube/cubewriter.hpp>
+#include <orea/cube/filemappedcube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/jaggedcube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/cube/jointnpvsensicube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
+#include <orea/cube/nettingsetaggregationcube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/npvsensicube.hpp>
+#include <orea/cube/quantisedcube.hpp>
+#include <orea/cube/samplesubsetcube.hpp>
 #include <orea/cube/sensicube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
 #include <orea/cube/sparsenpvcube.hpp>
+#include <orea/cube/truncatedcube.hpp>
 #include <orea/engine/amcvaluationengine.hpp>
 #include <orea/engine/bufferedsensitivitystream.hpp>
 #include <orea/engine/cptycalculator.hpp>
+#include <orea/engine/exposureconvergencemonitor.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/historicalpnlgenerator.hpp>
 #include <orea/engine/historicalsensipnlcalculator.hpp>
@@ -68,23 +82,31 @@
 #include <orea/engine/parametricvar.hpp>
 #include <orea/engine/parsensitivityanalysis.hpp>
 #include <orea/engine/parsensitivitycubestream.hpp>
+#include <orea/engine/pricingcostprofile.hpp>
 #include <orea/engine/riskfilter.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
 #include <orea/engine/sensitivityanalysisplus.hpp>
+#include <orea/engine/sensitivitybasedstresstest.hpp>
 #include <orea/engine/sensitivitycubestream.hpp>
 #include <orea/engine/sensitivityfilestream.hpp>
 #include <orea/engine/sensitivityinmemorystream.hpp>
 #include <orea/engine/sensitivityrecord.hpp>
 #include <orea/engine/sensitivitystream.hpp>
 #include <orea/engine/stresstest.hpp>
+#include <orea/engine/threadplacement.hpp>
+#include <orea/engine/threadpool.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/engine/valuationengine.hpp>
+#include <orea/engine/vanillaoptionbatchcalculator.hpp>
 #include <orea/engine/varcalculator.hpp>
 #include <orea/engine/zerotoparcube.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/clonedscenariogenerator.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
+#include <orea/scenario/compactscenario.hpp>
+#include <orea/scenario/compactscenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/csvscenariogenerator.hpp>
 #include <orea/scenario/deltascenario.hpp>
@@ -93,8 +115,11 @@
 #include <orea/scenario/historicalscenariogenerator.hpp>
 #include <orea/scenario/historicalscenarioloader.hpp>
 #include <orea/scenario/historicalscenarioreader.hpp>
+#include <orea/scenario/historicalshiftstore.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/riskfactorpruning.hpp>
 #include <orea/scenario/scenario.hpp>
+#include <orea/scenario/scenariocache.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/scenariofilter.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
@@ -144,6 +169,7 @@
 #include <orea/simm/simmconfigurationisdav2_6.hpp>
 #include <orea/simm/simmnamemapper.hpp>
 #include <orea/simm/simmresults.hpp>
+#include <orea/simm/simmsensitivitymapper.hpp>
 #include <orea/simm/utilities.hpp>
 #include <orea/simulation/fixingmanager.hpp>
 #include <orea/simulation/simmarket.hpp>
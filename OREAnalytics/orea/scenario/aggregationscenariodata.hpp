@@ -23,10 +23,16 @@
 
 #pragma once
 
+#include <ored/utilities/memoryaccounting.hpp>
+
 #include <ql/errors.hpp>
 #include <ql/types.hpp>
 #include <ql/patterns/observable.hpp>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 #include <fstream>
 #include <map>
 #include <vector>
@@ -82,6 +88,10 @@ public:
     // Get available keys (type, qualifier)
     virtual std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const = 0;
 
+    /*! An estimate of the memory held by the data in bytes, see ore::data::MemoryAccounting, the default
+        implementation returns 0 for views on other data */
+    virtual std::size_t memoryFootprint() const { return 0; }
+
     //! Set a value in the cube, assumes normal traversal of the cube (dates then samples)
     virtual void set(Real value, const AggregationScenarioDataType& type, const string& qualifier = "") {
         set(dIndex_, sIndex_, value, type, qualifier);
@@ -100,18 +110,37 @@ private:
     Size dIndex_, sIndex_;
 };
 
+//! Read only view on the values of all samples for one date, in the style of std::span
+template <typename T> class AggregationScenarioDataSpan {
+public:
+    AggregationScenarioDataSpan(const T* data, Size size) : data_(data), size_(size) {}
+    const T* data() const { return data_; }
+    Size size() const { return size_; }
+    const T& operator[](Size i) const { return data_[i]; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+private:
+    const T* data_;
+    Size size_;
+};
+
 //! A concrete in memory implementation of AggregationScenarioData
-/*! \ingroup scenario
+/*! The data of each key is stored in one contiguous date x sample block of type T. Values for different
+    (date, sample) cells can be set concurrently from several threads, new keys are added under a lock.
+
+    \ingroup scenario
  */
-class InMemoryAggregationScenarioData : public AggregationScenarioData {
+template <typename T> class InMemoryAggregationScenarioDataBase : public AggregationScenarioData {
 public:
-    InMemoryAggregationScenarioData() : AggregationScenarioData(), dimDates_(0), dimSamples_(0) {}
-    InMemoryAggregationScenarioData(Size dimDates, Size dimSamples)
+    InMemoryAggregationScenarioDataBase() : AggregationScenarioData(), dimDates_(0), dimSamples_(0) {}
+    InMemoryAggregationScenarioDataBase(Size dimDates, Size dimSamples)
         : AggregationScenarioData(), dimDates_(dimDates), dimSamples_(dimSamples) {}
     Size dimDates() const override { return dimDates_; }
     Size dimSamples() const override { return dimSamples_; }
 
     bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
         return data_.find(std::make_pair(type, qualifier)) != data_.end();
     }
 
@@ -120,10 +149,11 @@ public:
     Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
              const string& qualifier = "") const override {
         check(dateIndex, sampleIndex, type, qualifier);
-        return data_.at(std::make_pair(type, qualifier))[dateIndex][sampleIndex];
+        return values(type, qualifier)[dateIndex * dimSamples_ + sampleIndex];
     }
 
     std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
         std::vector<std::pair<AggregationScenarioDataType, std::string>> res;
         for (auto const& k : data_)
             res.push_back(k.first);
@@ -133,12 +163,22 @@ public:
     void set(Size dateIndex, Size sampleIndex, Real value, const AggregationScenarioDataType& type,
              const string& qualifier = "") override {
         check(dateIndex, sampleIndex, type, qualifier);
-        auto key = std::make_pair(type, qualifier);
-        auto it = data_.find(key);
-        if (it == data_.end()) {
-            data_.insert(make_pair(key, vector<vector<Real>>(dimDates_, vector<Real>(dimSamples_, 0.0))));
-        }
-        data_[key][dateIndex][sampleIndex] = value;
+        values(type, qualifier)[dateIndex * dimSamples_ + sampleIndex] = static_cast<T>(value);
+    }
+
+    std::size_t memoryFootprint() const override {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        std::size_t bytes = ore::data::memoryFootprint(data_);
+        for (auto const& d : data_)
+            bytes += ore::data::memoryFootprint(d.first.second) + ore::data::memoryFootprint(d.second);
+        return bytes;
+    }
+
+    //! The values of all samples for the given date, throws if the type is not known
+    AggregationScenarioDataSpan<T> samples(Size dateIndex, const AggregationScenarioDataType& type,
+                                           const string& qualifier = "") const {
+        check(dateIndex, 0, type, qualifier);
+        return AggregationScenarioDataSpan<T>(values(type, qualifier).data() + dateIndex * dimSamples_, dimSamples_);
     }
 
 private:
@@ -149,8 +189,74 @@ private:
                    "sampleIndex (" << sampleIndex << ") out of range 0..." << dimSamples_ - 1);
         return;
     }
+    const vector<T>& values(const AggregationScenarioDataType& type, const string& qualifier) const {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        return data_.at(std::make_pair(type, qualifier));
+    }
+    // the block is allocated on first use, its address is stable afterwards
+    vector<T>& values(const AggregationScenarioDataType& type, const string& qualifier) {
+        auto key = std::make_pair(type, qualifier);
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            auto it = data_.find(key);
+            if (it != data_.end())
+                return it->second;
+        }
+        boost::unique_lock<boost::shared_mutex> lock(mutex_);
+        auto it = data_.find(key);
+        if (it == data_.end())
+            it = data_.insert(std::make_pair(key, vector<T>(dimDates_ * dimSamples_, T(0.0)))).first;
+        return it->second;
+    }
     Size dimDates_, dimSamples_;
-    map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data_;
+    map<std::pair<AggregationScenarioDataType, string>, vector<T>> data_;
+    mutable boost::shared_mutex mutex_;
+};
+
+//! In memory aggregation scenario data using double precision
+using InMemoryAggregationScenarioData = InMemoryAggregationScenarioDataBase<double>;
+
+//! In memory aggregation scenario data using single precision
+using SinglePrecisionInMemoryAggregationScenarioData = InMemoryAggregationScenarioDataBase<float>;
+
+//! View on a range of samples of an aggregation scenario data instance
+/*! The view has its own traversal state for set(value, type, qualifier) and next(), so that several valuation
+    threads processing disjoint sample ranges can write into one InMemoryAggregationScenarioDataBase instance.
+
+    \ingroup scenario
+ */
+class AggregationScenarioDataSampleRange : public AggregationScenarioData {
+public:
+    AggregationScenarioDataSampleRange(const boost::shared_ptr<AggregationScenarioData>& data, Size firstSample,
+                                       Size samples)
+        : AggregationScenarioData(), data_(data), firstSample_(firstSample), samples_(samples) {
+        QL_REQUIRE(data_, "AggregationScenarioDataSampleRange: no data given");
+        QL_REQUIRE(firstSample_ + samples_ <= data_->dimSamples(),
+                   "AggregationScenarioDataSampleRange: samples " << firstSample_ << "..." << firstSample_ + samples_
+                                                                  << " out of range, data has "
+                                                                  << data_->dimSamples() << " samples");
+    }
+    Size dimDates() const override { return data_->dimDates(); }
+    Size dimSamples() const override { return samples_; }
+    bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        return data_->has(type, qualifier);
+    }
+    Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
+             const string& qualifier = "") const override {
+        QL_REQUIRE(sampleIndex < samples_, "sampleIndex (" << sampleIndex << ") out of range 0..." << samples_ - 1);
+        return data_->get(dateIndex, firstSample_ + sampleIndex, type, qualifier);
+    }
+    void set(Size dateIndex, Size sampleIndex, Real value, const AggregationScenarioDataType& type,
+             const string& qualifier = "") override {
+        QL_REQUIRE(sampleIndex < samples_, "sampleIndex (" << sampleIndex << ") out of range 0..." << samples_ - 1);
+        data_->set(dateIndex, firstSample_ + sampleIndex, value, type, qualifier);
+    }
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override { return data_->keys(); }
+    using AggregationScenarioData::set;
+
+private:
+    boost::shared_ptr<AggregationScenarioData> data_;
+    Size firstSample_, samples_;
 };
 
 inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t) {
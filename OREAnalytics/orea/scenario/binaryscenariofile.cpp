@@ -0,0 +1,241 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+const char magic[8] = {'O', 'R', 'E', 'S', 'C', 'N', 'B', '\0'};
+const std::uint32_t version = 1;
+const std::uint32_t endiannessMarker = 0x01020304;
+// date serial, sample, numeraire
+const Size blockHeaderValues = 3;
+
+template <class T> void write(FILE* fp, const T& value) { fwrite(&value, sizeof(T), 1, fp); }
+} // namespace
+
+BinaryScenarioFileWriter::BinaryScenarioFileWriter(const boost::shared_ptr<ScenarioGenerator>& src,
+                                                   const std::string& filename)
+    : BinaryScenarioFileWriter(filename) {
+    src_ = src;
+}
+
+BinaryScenarioFileWriter::BinaryScenarioFileWriter(const std::string& filename)
+    : filename_(filename), fp_(nullptr), sample_(0) {
+    fp_ = fopen(filename.c_str(), "wb");
+    QL_REQUIRE(fp_, "Error opening file " << filename << " for binary scenarios");
+}
+
+BinaryScenarioFileWriter::~BinaryScenarioFileWriter() { close(); }
+
+void BinaryScenarioFileWriter::reset() {
+    if (src_)
+        src_->reset();
+    close();
+}
+
+void BinaryScenarioFileWriter::close() {
+    if (fp_) {
+        fclose(fp_);
+        fp_ = nullptr;
+    }
+}
+
+boost::shared_ptr<Scenario> BinaryScenarioFileWriter::next(const Date& d) {
+    QL_REQUIRE(src_, "No ScenarioGenerator found.");
+    boost::shared_ptr<Scenario> s = src_->next(d);
+    writeScenario(s);
+    return s;
+}
+
+void BinaryScenarioFileWriter::writeHeader(const boost::shared_ptr<Scenario>& s) {
+    keys_ = s->keys();
+    std::sort(keys_.begin(), keys_.end());
+    QL_REQUIRE(keys_.size() > 0, "No keys in scenario");
+    fwrite(magic, sizeof(char), sizeof(magic), fp_);
+    write(fp_, version);
+    write(fp_, endiannessMarker);
+    write(fp_, static_cast<std::uint64_t>(keys_.size()));
+    Size bytes = sizeof(magic) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+    for (auto const& k : keys_) {
+        write(fp_, static_cast<std::int32_t>(k.keytype));
+        write(fp_, static_cast<std::uint32_t>(k.name.size()));
+        write(fp_, static_cast<std::uint64_t>(k.index));
+        fwrite(k.name.data(), sizeof(char), k.name.size(), fp_);
+        bytes += 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t) + k.name.size();
+    }
+    // pad to a multiple of 8 bytes, so that the blocks are aligned in the mapped file
+    const char padding[8] = {};
+    fwrite(padding, sizeof(char), (8 - bytes % 8) % 8, fp_);
+    buffer_.resize(blockHeaderValues + keys_.size());
+    firstDate_ = s->asof();
+}
+
+void BinaryScenarioFileWriter::writeScenario(const boost::shared_ptr<Scenario>& s) {
+    QL_REQUIRE(fp_, "BinaryScenarioFileWriter: file " << filename_ << " is closed");
+    if (keys_.empty())
+        writeHeader(s);
+    QL_REQUIRE(s->keys().size() == keys_.size(), "BinaryScenarioFileWriter: scenario has "
+                                                     << s->keys().size() << " keys, expected " << keys_.size());
+    const Date d = s->asof();
+    if (d == firstDate_)
+        sample_++;
+
+    std::int64_t serial = d.serialNumber();
+    std::uint64_t sample = sample_;
+    std::memcpy(&buffer_[0], &serial, sizeof(double));
+    std::memcpy(&buffer_[1], &sample, sizeof(double));
+    buffer_[2] = s->getNumeraire();
+    for (Size k = 0; k < keys_.size(); ++k)
+        buffer_[blockHeaderValues + k] = s->get(keys_[k]);
+    fwrite(buffer_.data(), sizeof(double), buffer_.size(), fp_);
+}
+
+BinaryScenarioFileReader::BinaryScenarioFileReader(const std::string& filename)
+    : filename_(filename), file_(filename.c_str(), boost::interprocess::read_only),
+      region_(file_, boost::interprocess::read_only) {
+    const char* p = static_cast<const char*>(region_.get_address());
+    const Size n = region_.get_size();
+    Size pos = 0;
+    auto read = [this, p, n, &pos](void* target, const Size bytes) {
+        QL_REQUIRE(pos + bytes <= n, "BinaryScenarioFileReader: unexpected end of header in " << filename_);
+        std::memcpy(target, p + pos, bytes);
+        pos += bytes;
+    };
+
+    char m[sizeof(magic)];
+    std::uint32_t v, e;
+    std::uint64_t nKeys;
+    read(m, sizeof(m));
+    QL_REQUIRE(std::memcmp(m, magic, sizeof(magic)) == 0,
+               "BinaryScenarioFileReader: " << filename_ << " is not a binary scenario file");
+    read(&v, sizeof(v));
+    QL_REQUIRE(v == version, "BinaryScenarioFileReader: unsupported version " << v << " in " << filename_);
+    read(&e, sizeof(e));
+    QL_REQUIRE(e == endiannessMarker,
+               "BinaryScenarioFileReader: " << filename_ << " was written on a platform with different byte order");
+    read(&nKeys, sizeof(nKeys));
+
+    std::vector<RiskFactorKey> keys(nKeys);
+    for (auto& k : keys) {
+        std::int32_t keyType;
+        std::uint32_t nameSize;
+        std::uint64_t index;
+        read(&keyType, sizeof(keyType));
+        read(&nameSize, sizeof(nameSize));
+        read(&index, sizeof(index));
+        std::string name(nameSize, ' ');
+        read(&name[0], nameSize);
+        k = RiskFactorKey(static_cast<RiskFactorKey::KeyType>(keyType), name, index);
+    }
+    keys_ = boost::make_shared<CompactScenarioKeys>(keys);
+
+    pos = (pos + 7) / 8 * 8;
+    blockSize_ = sizeof(double) * (blockHeaderValues + nKeys);
+    QL_REQUIRE(pos <= n && (n - pos) % blockSize_ == 0,
+               "BinaryScenarioFileReader: " << filename_ << " is truncated or corrupt");
+    blocks_ = p + pos;
+    size_ = (n - pos) / blockSize_;
+    DLOG("BinaryScenarioFileReader: mapped " << filename_ << " with " << size_ << " scenarios and " << nKeys
+                                             << " keys");
+}
+
+const char* BinaryScenarioFileReader::block(Size i) const {
+    QL_REQUIRE(i < size_, "BinaryScenarioFileReader: scenario index " << i << " out of range, file " << filename_
+                                                                      << " has " << size_ << " scenarios");
+    return blocks_ + i * blockSize_;
+}
+
+Date BinaryScenarioFileReader::date(Size i) const {
+    std::int64_t serial;
+    std::memcpy(&serial, block(i), sizeof(serial));
+    return Date(static_cast<Date::serial_type>(serial));
+}
+
+Size BinaryScenarioFileReader::sample(Size i) const {
+    std::uint64_t sample;
+    std::memcpy(&sample, block(i) + sizeof(double), sizeof(sample));
+    return static_cast<Size>(sample);
+}
+
+Real BinaryScenarioFileReader::numeraire(Size i) const {
+    double numeraire;
+    std::memcpy(&numeraire, block(i) + 2 * sizeof(double), sizeof(numeraire));
+    return numeraire;
+}
+
+const double* BinaryScenarioFileReader::values(Size i) const {
+    return reinterpret_cast<const double*>(block(i)) + blockHeaderValues;
+}
+
+boost::shared_ptr<CompactScenario> BinaryScenarioFileReader::scenario(Size i) const {
+    auto s = boost::make_shared<CompactScenario>(keys_, date(i), "", numeraire(i));
+    const double* v = values(i);
+    for (Size k = 0; k < keys_->size(); ++k)
+        s->set(k, v[k]);
+    return s;
+}
+
+BinaryScenarioGenerator::BinaryScenarioGenerator(const std::string& filename) : reader_(filename), i_(0) {}
+
+boost::shared_ptr<Scenario> BinaryScenarioGenerator::next(const Date& d) {
+    QL_REQUIRE(i_ < reader_.size(), "BinaryScenarioGenerator: unexpected end of scenario file");
+    QL_REQUIRE(reader_.date(i_) == d,
+               "BinaryScenarioGenerator: incompatible date " << reader_.date(i_) << ", expected " << d);
+    return reader_.scenario(i_++);
+}
+
+HistoricalBinaryScenarioReader::HistoricalBinaryScenarioReader(const std::string& filename)
+    : reader_(filename), i_(0) {}
+
+bool HistoricalBinaryScenarioReader::next() {
+    if (i_ <= reader_.size())
+        ++i_;
+    return i_ <= reader_.size();
+}
+
+Date HistoricalBinaryScenarioReader::date() const {
+    return i_ == 0 || i_ > reader_.size() ? Null<Date>() : reader_.date(i_ - 1);
+}
+
+boost::shared_ptr<Scenario> HistoricalBinaryScenarioReader::scenario() const {
+    if (i_ == 0 || i_ > reader_.size())
+        return nullptr;
+    return reader_.scenario(i_ - 1);
+}
+
+Size HistoricalBinaryScenarioReader::position() const {
+    QL_REQUIRE(i_ > 0 && i_ <= reader_.size(), "HistoricalBinaryScenarioReader: reader is not valid");
+    return i_ - 1;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/binaryscenariofile.hpp
+    \brief Binary scenario file format, writer and memory mapped readers
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/compactscenario.hpp>
+#include <orea/scenario/historicalscenarioreader.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdio>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Writer for binary scenario files
+/*! The binary format is the counterpart of the csv format written by the ScenarioWriter. The file consists of
+
+    - a header with a magic string, a format version, an endianness marker and the key table, padded to a multiple
+      of 8 bytes,
+    - one fixed size block per scenario holding the date serial number (int64), the sample number as in the csv
+      format (uint64), the numeraire and the values of all keys (float64), in the order of the key table.
+
+    The key table is sorted and taken from the first scenario written, all further scenarios must provide the same
+    keys. Numbers are written in native byte order, the reader checks the endianness marker. Since all blocks have
+    the same size, the file can be memory mapped and read without parsing, see BinaryScenarioFileReader.
+
+    \ingroup scenario
+*/
+class BinaryScenarioFileWriter : public ScenarioGenerator {
+public:
+    //! Constructor, writes the scenarios generated by src
+    BinaryScenarioFileWriter(const boost::shared_ptr<ScenarioGenerator>& src, const std::string& filename);
+
+    //! Constructor to write single scenarios
+    explicit BinaryScenarioFileWriter(const std::string& filename);
+
+    //! Destructor
+    ~BinaryScenarioFileWriter() override;
+
+    //! Return the next scenario for the given date.
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+
+    //! Write a single scenario
+    void writeScenario(const boost::shared_ptr<Scenario>& s);
+
+    //! Reset the generator so calls to next() return the first scenario.
+    void reset() override;
+
+    //! Close the file if it is open, not normally needed by client code
+    void close();
+
+private:
+    void writeHeader(const boost::shared_ptr<Scenario>& s);
+
+    boost::shared_ptr<ScenarioGenerator> src_;
+    std::string filename_;
+    FILE* fp_;
+    std::vector<RiskFactorKey> keys_;
+    std::vector<double> buffer_;
+    Date firstDate_;
+    Size sample_;
+};
+
+//! Memory mapped reader for binary scenario files, see BinaryScenarioFileWriter for the format
+/*! The scenarios are returned as CompactScenario instances that share the key table of the file.
+
+    \ingroup scenario
+*/
+class BinaryScenarioFileReader {
+public:
+    explicit BinaryScenarioFileReader(const std::string& filename);
+
+    //! The key table of the file
+    const boost::shared_ptr<const CompactScenarioKeys>& keys() const { return keys_; }
+    //! Number of scenarios in the file
+    Size size() const { return size_; }
+
+    //! Date of the i-th scenario
+    Date date(Size i) const;
+    //! Sample number of the i-th scenario, starting at 1 as in the csv format
+    Size sample(Size i) const;
+    //! Numeraire of the i-th scenario
+    Real numeraire(Size i) const;
+    //! Values of the i-th scenario in the order of the key table, this points into the mapped file
+    const double* values(Size i) const;
+
+    //! Build the i-th scenario
+    boost::shared_ptr<CompactScenario> scenario(Size i) const;
+
+private:
+    const char* block(Size i) const;
+
+    std::string filename_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    boost::shared_ptr<const CompactScenarioKeys> keys_;
+    const char* blocks_;
+    Size blockSize_, size_;
+};
+
+//! Scenario generator replaying a binary scenario file, the binary counterpart of the CSVScenarioGenerator
+/*! \ingroup scenario
+ */
+class BinaryScenarioGenerator : public ScenarioGenerator {
+public:
+    explicit BinaryScenarioGenerator(const std::string& filename);
+
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override { i_ = 0; }
+
+private:
+    BinaryScenarioFileReader reader_;
+    Size i_;
+};
+
+//! Historical scenario reader for binary scenario files, the binary counterpart of the HistoricalScenarioFileReader
+/*! \ingroup scenario
+ */
+class HistoricalBinaryScenarioReader : public HistoricalScenarioReader {
+public:
+    explicit HistoricalBinaryScenarioReader(const std::string& filename);
+
+    //! Return true if there is another Scenario to read and move to it
+    bool next() override;
+    //! Return the current scenario's date if reader is still valid and `Null<Date>()` otherwise
+    QuantLib::Date date() const override;
+    //! Return the current scenario if reader is still valid and `nullptr` otherwise
+    boost::shared_ptr<Scenario> scenario() const override;
+
+    //! The underlying file reader
+    const BinaryScenarioFileReader& file() const { return reader_; }
+    //! The position of the current scenario in the file, the reader must be valid
+    Size position() const;
+
+private:
+    BinaryScenarioFileReader reader_;
+    // index of the current scenario plus one, zero before the first call to next()
+    Size i_;
+};
+
+} // namespace analytics
+} // namespace ore
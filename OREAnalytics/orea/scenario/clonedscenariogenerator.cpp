@@ -20,11 +20,14 @@
 
 #include <ored/utilities/log.hpp>
 
+#include <algorithm>
+
 namespace ore {
 namespace analytics {
 
 ClonedScenarioGenerator::ClonedScenarioGenerator(const boost::shared_ptr<ScenarioGenerator>& scenarioGenerator,
-                                                 const std::vector<Date>& dates, const Size nSamples) {
+                                                 const std::vector<Date>& dates, const Size nSamples)
+    : nDates_(dates.size()) {
     DLOG("Build cloned scenario generator for " << dates.size() << " dates and " << nSamples << " samples.");
     scenarioGenerator->reset();
     scenarios_.resize(nSamples * dates.size());
@@ -40,7 +43,16 @@ boost::shared_ptr<Scenario> ClonedScenarioGenerator::next(const Date& d) {
     return scenarios_[i_++];
 }
 
-void ClonedScenarioGenerator::reset() { i_ = 0; }
+void ClonedScenarioGenerator::reset() { i_ = firstSample_ * nDates_; }
+
+void ClonedScenarioGenerator::setFirstSample(const Size firstSample) {
+    QL_REQUIRE(firstSample * nDates_ <= scenarios_.size(), "ClonedScenarioGenerator::setFirstSample("
+                                                               << firstSample << "): only "
+                                                               << scenarios_.size() / std::max<Size>(nDates_, 1)
+                                                               << " samples stored.");
+    firstSample_ = firstSample;
+    reset();
+}
 
 } // namespace analytics
 } // namespace ore
@@ -35,8 +35,13 @@ public:
     boost::shared_ptr<Scenario> next(const Date& d) override;
     virtual void reset() override;
 
+    //! skip ahead to the given sample, subsequent calls to reset() rewind to this sample
+    void setFirstSample(const Size firstSample);
+
 private:
     std::vector<boost::shared_ptr<Scenario>> scenarios_;
+    Size nDates_;
+    Size firstSample_ = 0;
     Size i_ = 0;
 };
 
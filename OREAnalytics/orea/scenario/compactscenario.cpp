@@ -0,0 +1,72 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <orea/scenario/compactscenario.hpp>
+#include <ql/errors.hpp>
+
+namespace ore {
+namespace analytics {
+
+using QuantLib::Null;
+
+CompactScenarioKeys::CompactScenarioKeys(const std::vector<RiskFactorKey>& keys) : keys_(keys) {
+    for (Size i = 0; i < keys_.size(); ++i) {
+        QL_REQUIRE(index_.insert(std::make_pair(keys_[i], i)).second,
+                   "CompactScenarioKeys: duplicate key " << keys_[i]);
+    }
+}
+
+Size CompactScenarioKeys::index(const RiskFactorKey& key) const {
+    auto it = index_.find(key);
+    return it == index_.end() ? Null<Size>() : it->second;
+}
+
+CompactScenario::CompactScenario(const boost::shared_ptr<const CompactScenarioKeys>& keys, Date asof,
+                                 const std::string& label, Real numeraire)
+    : keys_(keys), asof_(asof), numeraire_(numeraire), label_(label), next_(0) {
+    QL_REQUIRE(keys_, "CompactScenario: no key table given");
+    values_.resize(keys_->size(), Null<Real>());
+}
+
+bool CompactScenario::has(const RiskFactorKey& key) const {
+    Size i = keys_->index(key);
+    return i != Null<Size>() && values_[i] != Null<Real>();
+}
+
+void CompactScenario::add(const RiskFactorKey& key, Real value) {
+    Size i;
+    if (next_ < values_.size() && keys_->keys()[next_] == key) {
+        i = next_;
+    } else {
+        i = keys_->index(key);
+        QL_REQUIRE(i != Null<Size>(), "CompactScenario: key " << key << " is not part of the key table");
+    }
+    values_[i] = value;
+    next_ = i + 1;
+}
+
+Real CompactScenario::get(const RiskFactorKey& key) const {
+    Size i = keys_->index(key);
+    QL_REQUIRE(i != Null<Size>() && values_[i] != Null<Real>(), "Scenario does not provide data for key " << key);
+    return values_[i];
+}
+
+boost::shared_ptr<Scenario> CompactScenario::clone() const { return boost::make_shared<CompactScenario>(*this); }
+} // namespace analytics
+} // namespace ore
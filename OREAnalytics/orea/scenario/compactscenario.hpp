@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/compactscenario.hpp
+    \brief Memory optimised scenario class sharing the keys between instances
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenario.hpp>
+
+#include <ql/utilities/null.hpp>
+
+#include <map>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using std::string;
+
+//! Immutable table of risk factor keys shared by CompactScenario instances
+/*! \ingroup scenario
+ */
+class CompactScenarioKeys {
+public:
+    //! Constructor, the keys must be unique
+    explicit CompactScenarioKeys(const std::vector<RiskFactorKey>& keys);
+
+    //! Number of keys
+    Size size() const { return keys_.size(); }
+    //! The keys in the order of their positions
+    const std::vector<RiskFactorKey>& keys() const { return keys_; }
+    //! The position of the key, or Null<Size>() if the key is not contained in the table
+    Size index(const RiskFactorKey& key) const;
+
+private:
+    std::vector<RiskFactorKey> keys_;
+    std::map<RiskFactorKey, Size> index_;
+};
+
+//-----------------------------------------------------------------------------------------------
+//! Compact Scenario class
+/*! This implementation stores the values in a single vector whose positions are given by a key table
+  that is shared by all instances built against it, see CompactScenarioFactory. In contrast to
+  SimpleScenario no keys are stored per instance.
+
+  Keys that are not part of the table can not be added. Adding the keys in the order of the table
+  does not require a lookup in the key table. Consumers can read the values by position, see values().
+
+  \ingroup scenario
+*/
+class CompactScenario : public Scenario {
+public:
+    //! Constructor
+    CompactScenario(const boost::shared_ptr<const CompactScenarioKeys>& keys, Date asof, const std::string& label = "",
+                    Real numeraire = 0);
+
+    //! Return the scenario asof date
+    const Date& asof() const override { return asof_; }
+
+    //! Return the scenario label
+    const std::string& label() const override { return label_; }
+    //! set the label
+    void label(const string& s) override { label_ = s; }
+
+    //! Get Numeraire ratio n = N(t) / N(0) so that Price(0) = N(0) * E [Price(t) / N(t) ]
+    Real getNumeraire() const override { return numeraire_; }
+    //! Set the Numeraire ratio n = N(t) / N(0) so that Price(0) = N(0) * E [Price(t) / N(t) ]
+    void setNumeraire(Real n) override { numeraire_ = n; }
+
+    //! Check, get, add a single market point
+    bool has(const RiskFactorKey& key) const override;
+    //! The keys of the key table, values which are not set yet are Null<Real>()
+    const std::vector<RiskFactorKey>& keys() const override { return keys_->keys(); }
+    void add(const RiskFactorKey& key, Real value) override;
+    Real get(const RiskFactorKey& key) const override;
+
+    boost::shared_ptr<Scenario> clone() const override;
+
+    //! The shared key table
+    const boost::shared_ptr<const CompactScenarioKeys>& keyTable() const { return keys_; }
+    //! The values by position in the key table
+    const std::vector<Real>& values() const { return values_; }
+    //! Set a value by position in the key table
+    void set(Size index, Real value) { values_[index] = value; }
+
+private:
+    boost::shared_ptr<const CompactScenarioKeys> keys_;
+    Date asof_;
+    Real numeraire_;
+    std::string label_;
+    std::vector<Real> values_;
+    // position expected for the next add() call
+    Size next_;
+};
+} // namespace analytics
+} // namespace ore
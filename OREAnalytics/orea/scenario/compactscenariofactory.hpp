@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file compactscenariofactory.hpp
+    \brief factory classes for compact scenarios
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <orea/scenario/compactscenario.hpp>
+#include <orea/scenario/scenariofactory.hpp>
+#include <ql/errors.hpp>
+
+namespace ore {
+namespace analytics {
+
+//! Factory class for building compact scenario objects
+/*! All scenarios built by the factory share its key table. If the factory is constructed without key table, the
+    scenario generator it is passed to sets the table to the keys it generates, see e.g.
+    CrossAssetModelScenarioGenerator and HistoricalScenarioGenerator.
+
+    \ingroup scenario
+ */
+class CompactScenarioFactory : public ScenarioFactory {
+public:
+    CompactScenarioFactory() {}
+    explicit CompactScenarioFactory(const boost::shared_ptr<const CompactScenarioKeys>& keys) : keys_(keys) {}
+
+    const boost::shared_ptr<Scenario> buildScenario(Date asof, const std::string& label = "",
+                                                    Real numeraire = 0.0) const override {
+        QL_REQUIRE(keys_, "CompactScenarioFactory: key table not set");
+        return boost::make_shared<CompactScenario>(keys_, asof, label, numeraire);
+    }
+
+    //! The key table, might be null
+    const boost::shared_ptr<const CompactScenarioKeys>& keys() const { return keys_; }
+    //! Set the key table
+    void setKeys(const boost::shared_ptr<const CompactScenarioKeys>& keys) { keys_ = keys; }
+
+private:
+    boost::shared_ptr<const CompactScenarioKeys> keys_;
+};
+
+} // namespace analytics
+} // namespace ore
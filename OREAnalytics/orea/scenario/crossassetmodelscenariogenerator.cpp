@@ -16,11 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/compactscenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 
 #include <qle/indexes/inflationindexobserver.hpp>
+#include <qle/models/lgmvectorised.hpp>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -34,16 +36,37 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
     boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator,
     boost::shared_ptr<ScenarioFactory> scenarioFactory, boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
     Date today, boost::shared_ptr<DateGrid> grid, boost::shared_ptr<ore::data::Market> initMarket,
-    const std::string& configuration)
+    const std::string& configuration, const bool conditionalCloseOut, const BigNatural closeOutSeed)
     : ScenarioPathGenerator(today, grid->dates(), grid->timeGrid()), model_(model), pathGenerator_(pathGenerator),
-      scenarioFactory_(scenarioFactory), simMarketConfig_(simMarketConfig), initMarket_(initMarket),
-      configuration_(configuration) {
+      conditionalCloseOut_(conditionalCloseOut), closeOutSeed_(closeOutSeed), scenarioFactory_(scenarioFactory),
+      simMarketConfig_(simMarketConfig), initMarket_(initMarket), configuration_(configuration) {
 
     LOG("CrossAssetModelScenarioGenerator ctor called");
     
     QL_REQUIRE(initMarket != NULL, "CrossAssetScenarioGenerator: initMarket is null");
     QL_REQUIRE(timeGrid_.size() == dates_.size() + 1, "date/time grid size mismatch");
 
+    if (conditionalCloseOut_) {
+        QL_REQUIRE(pathGenerator_, "CrossAssetModelScenarioGenerator: conditional close-out requires a path generator");
+        // the valuation dates are the steps of the path, a close-out date refers to the preceding valuation date
+        Size valuationIndex = 0;
+        pathTimes_.push_back(0.0);
+        for (Size i = 0; i < dates_.size(); ++i) {
+            bool closeOutOnly = grid->isCloseOutDate()[i] && !grid->isValuationDate()[i];
+            if (!closeOutOnly) {
+                ++valuationIndex;
+                pathTimes_.push_back(timeGrid_[i + 1]);
+            }
+            pathIndex_.push_back(valuationIndex);
+            isConditionalCloseOut_.push_back(closeOutOnly);
+        }
+        closeOutRsg_ = boost::make_shared<PseudoRandom::rsg_type>(
+            PseudoRandom::make_sequence_generator(model_->stateProcess()->factors(), closeOutSeed_));
+        LOG("CrossAssetModelScenarioGenerator: " << valuationIndex << " valuation dates are simulated, "
+                                                 << dates_.size() - valuationIndex
+                                                 << " close-out dates are sampled conditionally");
+    }
+
     // TODO, curve tenors might be overwritten by dates in simMarketConfig_, here we just take the tenors
 
     DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
@@ -127,6 +150,8 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
             DLOG("Pair " << pair << " index " << index);
             // index - 1 to convert "IR" index into an "FX" index
             fxVols_.push_back(boost::make_shared<CrossAssetModelImpliedFxVolTermStructure>(model_, index - 1));
+            for (Size j = 0; j < simMarketConfig_->fxVolExpiries(pair).size(); ++j)
+                fxVolKeys_.emplace_back(RiskFactorKey::KeyType::FXVolatility, pair, j);
             DLOG("Set up CrossAssetModelImpliedFxVolTermStructures for " << pair << " done");
         }
     }
@@ -153,6 +178,8 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
             DLOG("EQ Vol Name = " << equityName << ", index = " << eqIndex);
             // index - 1 to convert "IR" index into an "FX" index
             eqVols_.push_back(boost::make_shared<CrossAssetModelImpliedEqVolTermStructure>(model_, eqIndex));
+            for (Size j = 0; j < simMarketConfig_->equityVolExpiries(equityName).size(); ++j)
+                eqVolKeys_.emplace_back(RiskFactorKey::KeyType::EquityVolatility, equityName, j);
             DLOG("Set up CrossAssetModelImpliedEqVolTermStructures for " << equityName << " done");
         }
     }
@@ -234,6 +261,7 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         auto impliedFwdCurve = boost::make_shared<ModelImpliedYtsFwdFwdCorrected>(
             model_->irModel(model_->ccyIndex(index->currency())), fts, dc, false);
         fwdCurves_.push_back(impliedFwdCurve);
+        fwdTargetCurves_.push_back(fts);
         indices_.push_back(index->clone(Handle<YieldTermStructure>(impliedFwdCurve)));
     }
 
@@ -244,6 +272,7 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         auto impliedYieldCurve =
             boost::make_shared<ModelImpliedYtsFwdFwdCorrected>(model_->irModel(model_->ccyIndex(ccy)), yts, dc, false);
         yieldCurves_.push_back(impliedYieldCurve);
+        yieldTargetCurves_.push_back(yts);
         yieldCurveCurrency_.push_back(ccy);
     }
 
@@ -311,20 +340,66 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         }
     }
 
+    // the key table in the order the keys are added in nextPath()
+    std::vector<RiskFactorKey> keys;
+    for (auto const* k : {&discountCurveKeys_, &indexCurveKeys_, &yieldCurveKeys_, &fxKeys_, &fxVolKeys_, &eqKeys_,
+                          &eqVolKeys_, &cpiKeys_, &zeroInflationKeys_, &yoyInflationKeys_, &defaultCurveKeys_,
+                          &commodityCurveKeys_, &crStateKeys_})
+        keys.insert(keys.end(), k->begin(), k->end());
+    for (Size k = 0; k < n_survivalweights_; ++k) {
+        keys.push_back(survivalWeightKeys_[k]);
+        keys.push_back(recoveryRateKeys_[k]);
+    }
+    keys_ = boost::make_shared<CompactScenarioKeys>(keys);
+
+    // a compact scenario factory without key table gets the keys in the order they are added in nextPath()
+    if (auto csf = boost::dynamic_pointer_cast<CompactScenarioFactory>(scenarioFactory_)) {
+        if (!csf->keys()) {
+            csf->setKeys(keys_);
+            DLOG("CrossAssetModelScenarioGenerator: set compact scenario key table with " << keys_->size() << " keys");
+        }
+    }
+
     LOG("CrossAssetModelScenarioGenerator ctor done");
 }
 
+CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
+    boost::shared_ptr<QuantExt::CrossAssetModel> model,
+    boost::shared_ptr<QuantExt::StreamingMultiPathGenerator> streamingGenerator,
+    boost::shared_ptr<ScenarioFactory> scenarioFactory, boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
+    Date today, boost::shared_ptr<DateGrid> grid, boost::shared_ptr<ore::data::Market> initMarket,
+    const std::string& configuration)
+    : CrossAssetModelScenarioGenerator(model, boost::shared_ptr<QuantExt::MultiPathGeneratorBase>(), scenarioFactory,
+                                       simMarketConfig, today, grid, initMarket, configuration) {
+    QL_REQUIRE(streamingGenerator, "CrossAssetModelScenarioGenerator: streaming path generator is null");
+    QL_REQUIRE(streamingGenerator->blockSize() == 1,
+               "CrossAssetModelScenarioGenerator: streaming path generator must have block size 1, got "
+                   << streamingGenerator->blockSize());
+    QL_REQUIRE(streamingGenerator->timeGrid().size() == timeGrid_.size(),
+               "CrossAssetModelScenarioGenerator: streaming path generator time grid size ("
+                   << streamingGenerator->timeGrid().size() << ") does not match date grid (" << timeGrid_.size()
+                   << ")");
+    streamingGenerator_ = streamingGenerator;
+}
+
+std::vector<bool> CrossAssetModelScenarioGenerator::bridgedCloseOutDates(const DateGrid& grid) {
+    std::vector<bool> bridged(grid.dates().size() + 1, false);
+    for (Size i = 0; i < grid.dates().size(); ++i)
+        bridged[i + 1] = grid.isCloseOutDate()[i] && !grid.isValuationDate()[i];
+    return bridged;
+}
+
 namespace {
-void copyPathToArray(const MultiPath& p, Size t, Size a, Array& target) {
+template <class Path> void copyPathToArray(const Path& path, Size a, Array& target) {
     for (Size k = 0; k < target.size(); ++k)
-        target[k] = p[a + k][t];
+        target[k] = path(a + k);
 }
 } // namespace
 
-std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
-    std::vector<boost::shared_ptr<Scenario>> scenarios(dates_.size());
-    QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator::nextPath(): pathGenerator is null");
-    Sample<MultiPath> sample = pathGenerator_->next();
+template <class Path>
+boost::shared_ptr<Scenario> CrossAssetModelScenarioGenerator::buildScenario(Size i, const Path& path) {
+    Real t = timeGrid_[i + 1]; // recall: time grid has inserted t=0
+    boost::shared_ptr<Scenario> scenario = scenarioFactory_->buildScenario(dates_[i]);
     DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
 
     std::vector<Array> ir_state(n_ccy_);
@@ -341,240 +416,435 @@ std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextP
     for (Size j = 0; j < n_curves_; ++j)
         yieldCurveCcyIdx[j] = model_->ccyIndex(yieldCurveCurrency_[j]);
 
-    for (Size i = 0; i < dates_.size(); i++) {
-        Real t = timeGrid_[i + 1]; // recall: time grid has inserted t=0
+    // populate IR states
+    copyPathToArray(path, model_->pIdx(CrossAssetModel::AssetType::IR, 0), ir_state[0]);
+    copyPathToArray(path, model_->pIdx(CrossAssetModel::AssetType::IR, 0) + ir_state[0].size(), ir_state_aux);
+    for (Size j = 1; j < n_ccy_; ++j)
+        copyPathToArray(path, model_->pIdx(CrossAssetModel::AssetType::IR, j), ir_state[j]);
+
+    // Set numeraire from domestic ir process
+    scenario->setNumeraire(model_->numeraire(0, t, ir_state[0], Handle<YieldTermStructure>(), ir_state_aux));
+
+    // Discount curves
+    for (Size j = 0; j < n_ccy_; j++) {
+        curves_[j]->move(t, ir_state[j]);
+        for (Size k = 0; k < ten_dsc_[j].size(); k++) {
+            Date d = dates_[i] + ten_dsc_[j][k];
+            Time T = dc.yearFraction(dates_[i], d);
+            Real discount = std::max(curves_[j]->discount(T), 0.00001);
+            scenario->add(discountCurveKeys_[j * ten_dsc_[j].size() + k], discount);
+        }
+    }
 
-        scenarios[i] = scenarioFactory_->buildScenario(dates_[i]);
+    // Index curves and Index fixings
+    for (Size j = 0; j < n_indices_; ++j) {
+        fwdCurves_[j]->move(dates_[i], ir_state[indexCcyIdx[j]]);
+        for (Size k = 0; k < ten_idx_[j].size(); ++k) {
+            Date d = dates_[i] + ten_idx_[j][k];
+            Time T = dc.yearFraction(dates_[i], d);
+            Real discount = std::max(fwdCurves_[j]->discount(T), 0.00001);
+            scenario->add(indexCurveKeys_[j * ten_idx_[j].size() + k], discount);
+        }
+    }
 
-        // populate IR states
-        copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, 0), ir_state[0]);
-        copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, 0) + ir_state[0].size(),
-                        ir_state_aux);
-        for (Size j = 1; j < n_ccy_; ++j)
-            copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, j), ir_state[j]);
+    // Yield curves
+    for (Size j = 0; j < n_curves_; ++j) {
+        yieldCurves_[j]->move(dates_[i], ir_state[yieldCurveCcyIdx[j]]);
+        for (Size k = 0; k < ten_yc_[j].size(); ++k) {
+            Date d = dates_[i] + ten_yc_[j][k];
+            Time T = dc.yearFraction(dates_[i], d);
+            Real discount = std::max(yieldCurves_[j]->discount(T), 0.00001);
+            scenario->add(yieldCurveKeys_[j * ten_yc_[j].size() + k], discount);
+        }
+    }
 
-        // Set numeraire from domestic ir process
-        scenarios[i]->setNumeraire(model_->numeraire(0, t, ir_state[0], Handle<YieldTermStructure>(), ir_state_aux));
+    // FX rates
+    for (Size k = 0; k < n_ccy_ - 1; k++) {
+        Real fx = std::exp(path(model_->pIdx(CrossAssetModel::AssetType::FX, k)));
+        scenario->add(fxKeys_[k], fx);
+    }
 
-        // Discount curves
-        for (Size j = 0; j < n_ccy_; j++) {
-            curves_[j]->move(t, ir_state[j]);
-            for (Size k = 0; k < ten_dsc_[j].size(); k++) {
-                Date d = dates_[i] + ten_dsc_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(curves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(discountCurveKeys_[j * ten_dsc_[j].size() + k], discount);
-            }
-        }
+    // FX vols
+    if (simMarketConfig_->simulateFXVols()) {
+        Size fxVolKeyIndex = 0;
+        for (Size k = 0; k < simMarketConfig_->fxVolCcyPairs().size(); k++) {
+            const string ccyPair = simMarketConfig_->fxVolCcyPairs()[k];
+            const vector<Period>& expires = simMarketConfig_->fxVolExpiries(ccyPair);
 
-        // Index curves and Index fixings
-        for (Size j = 0; j < n_indices_; ++j) {
-            fwdCurves_[j]->move(dates_[i], ir_state[indexCcyIdx[j]]);
-            for (Size k = 0; k < ten_idx_[j].size(); ++k) {
-                Date d = dates_[i] + ten_idx_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(fwdCurves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(indexCurveKeys_[j * ten_idx_[j].size() + k], discount);
+            Size fxIndex = fxVols_[k]->fxIndex();
+            Real zFor = path(fxIndex + 1);
+            Real logFx = path(n_ccy_ + fxIndex); // multiplies USD amount to get EUR
+            fxVols_[k]->move(dates_[i], ir_state[0][0], zFor, logFx);
+
+            for (Size j = 0; j < expires.size(); j++) {
+                Real vol = fxVols_[k]->blackVol(dates_[i] + expires[j], Null<Real>(), true);
+                scenario->add(fxVolKeys_[fxVolKeyIndex++], vol);
             }
         }
+    }
 
-        // Yield curves
-        for (Size j = 0; j < n_curves_; ++j) {
-            yieldCurves_[j]->move(dates_[i], ir_state[yieldCurveCcyIdx[j]]);
-            for (Size k = 0; k < ten_yc_[j].size(); ++k) {
-                Date d = dates_[i] + ten_yc_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(yieldCurves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(yieldCurveKeys_[j * ten_yc_[j].size() + k], discount);
+    // Equity spots
+    for (Size k = 0; k < n_eq_; k++) {
+        Real eqSpot = std::exp(path(model_->pIdx(CrossAssetModel::AssetType::EQ, k)));
+        scenario->add(eqKeys_[k], eqSpot);
+    }
+
+    // Equity vols
+    if (simMarketConfig_->simulateEquityVols()) {
+        Size eqVolKeyIndex = 0;
+        for (Size k = 0; k < simMarketConfig_->equityVolNames().size(); k++) {
+            const string equityName = simMarketConfig_->equityVolNames()[k];
+
+            const vector<Period>& expiries = simMarketConfig_->equityVolExpiries(equityName);
+
+            Size eqIndex = eqVols_[k]->equityIndex();
+            Size eqCcyIdx = eqVols_[k]->eqCcyIndex();
+            Real z_eqIr = path(eqCcyIdx);
+            Real logEq = path(eqIndex);
+            eqVols_[k]->move(dates_[i], z_eqIr, logEq);
+
+            for (Size j = 0; j < expiries.size(); j++) {
+                Real vol = eqVols_[k]->blackVol(dates_[i] + expiries[j], Null<Real>(), true);
+                scenario->add(eqVolKeys_[eqVolKeyIndex++], vol);
             }
         }
+    }
 
-        // FX rates
-        for (Size k = 0; k < n_ccy_ - 1; k++) {
-            Real fx = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::FX, k)][i + 1]);
-            scenarios[i]->add(fxKeys_[k], fx);
+    // Inflation index values
+    for (Size j = 0; j < n_inf_; j++) {
+
+        // Depending on type of model, i.e. DK or JY, z and y mean different things.
+        Real z = path(model_->pIdx(CrossAssetModel::AssetType::INF, j, 0));
+        Real y = path(model_->pIdx(CrossAssetModel::AssetType::INF, j, 1));
+
+        // Could possibly cache the model type outside the loop to improve performance.
+        Real cpi = 0.0;
+        if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::JY) {
+            cpi = std::exp(path(model_->pIdx(CrossAssetModel::AssetType::INF, j, 1)));
+        } else if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::DK) {
+            auto index = *initMarket_->zeroInflationIndex(model_->inf(j)->name());
+            Date baseDate = index->zeroInflationTermStructure()->baseDate();
+            auto zts = index->zeroInflationTermStructure();
+            Time relativeTime = inflationYearFraction(zts->frequency(), false, zts->dayCounter(),
+                                                      baseDate, dates_[i] - zts->observationLag());
+            std::tie(cpi, std::ignore) = model_->infdkI(j, relativeTime, relativeTime, z, y);
+            cpi *= index->fixing(baseDate);
+        } else {
+            QL_FAIL("CrossAssetModelScenarioGenerator: expected inflation model to be JY or DK.");
         }
 
-        // FX vols
-        if (simMarketConfig_->simulateFXVols()) {
-            for (Size k = 0; k < simMarketConfig_->fxVolCcyPairs().size(); k++) {
-                const string ccyPair = simMarketConfig_->fxVolCcyPairs()[k];
-                const vector<Period>& expires = simMarketConfig_->fxVolExpiries(ccyPair);
+        scenario->add(cpiKeys_[j], cpi);
+    }
 
-                Size fxIndex = fxVols_[k]->fxIndex();
-                Real zFor = sample.value[fxIndex + 1][i + 1];
-                Real logFx = sample.value[n_ccy_ + fxIndex][i + 1]; // multiplies USD amount to get EUR
-                fxVols_[k]->move(dates_[i], ir_state[0][0], zFor, logFx);
+    // Zero inflation curves
+    for (Size j = 0; j < zeroInfCurves_.size(); ++j) {
 
-                for (Size j = 0; j < expires.size(); j++) {
-                    Real vol = fxVols_[k]->blackVol(dates_[i] + expires[j], Null<Real>(), true);
-                    scenarios[i]->add(RiskFactorKey(RiskFactorKey::KeyType::FXVolatility, ccyPair, j), vol);
-                }
-            }
+        auto tup = zeroInfCurves_[j];
+
+        // State variables needed depends on model, 3 for JY and 2 for DK.
+        auto idx = std::get<0>(tup);
+        Array path(3);
+        state[0] = path(model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0));
+        state[1] = path(model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1));
+        if (std::get<2>(tup) == CrossAssetModel::ModelType::DK) {
+            state.resize(2);
+        } else {
+            state[2] = ir_state[std::get<1>(tup)][0];
         }
 
-        // Equity spots
-        for (Size k = 0; k < n_eq_; k++) {
-            Real eqSpot = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::EQ, k)][i + 1]);
-            scenarios[i]->add(eqKeys_[k], eqSpot);
+        // Update the term structure's date and state.
+        auto ts = std::get<3>(tup);
+        ts->move(dates_[i], state);
+
+        // Populate the zero inflation scenario values based on the current date and state.
+        for (Size k = 0; k < ten_zinf_[j].size(); k++) {
+            Time T = dc.yearFraction(dates_[i], dates_[i] + ten_zinf_[j][k]);
+            scenario->add(zeroInflationKeys_[j * ten_zinf_[j].size() + k], ts->zeroRate(T));
         }
+    }
 
-        // Equity vols
-        if (simMarketConfig_->simulateEquityVols()) {
-            for (Size k = 0; k < simMarketConfig_->equityVolNames().size(); k++) {
-                const string equityName = simMarketConfig_->equityVolNames()[k];
+    // YoY inflation curves
+    for (Size j = 0; j < yoyInfCurves_.size(); ++j) {
 
-                const vector<Period>& expiries = simMarketConfig_->equityVolExpiries(equityName);
+        auto tup = yoyInfCurves_[j];
 
-                Size eqIndex = eqVols_[k]->equityIndex();
-                Size eqCcyIdx = eqVols_[k]->eqCcyIndex();
-                Real z_eqIr = sample.value[eqCcyIdx][i + 1];
-                Real logEq = sample.value[eqIndex][i + 1];
-                eqVols_[k]->move(dates_[i], z_eqIr, logEq);
+        // For YoY model implied term structure, JY and DK both need 3 state variables.
+        auto idx = std::get<0>(tup);
+        Array path(3);
+        state[0] = path(model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0));
+        state[1] = path(model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1));
+        state[2] = ir_state[std::get<1>(tup)][0];
 
-                for (Size j = 0; j < expiries.size(); j++) {
-                    Real vol = eqVols_[k]->blackVol(dates_[i] + expiries[j], Null<Real>(), true);
-                    scenarios[i]->add(RiskFactorKey(RiskFactorKey::KeyType::EquityVolatility, equityName, j), vol);
-                }
-            }
+        // Update the term structure's date and state.
+        auto ts = std::get<3>(tup);
+        ts->move(dates_[i], state);
+
+        // Create the YoY pillar dates from the tenors.
+        vector<Date> pillarDates(ten_yinf_[j].size());
+        for (Size k = 0; k < pillarDates.size(); ++k)
+            pillarDates[k] = dates_[i] + ten_yinf_[j][k];
+
+        // Use the YoY term structure's YoY rates to populate the scenarios.
+        auto yoyRates = ts->yoyRates(pillarDates);
+        for (Size k = 0; k < pillarDates.size(); ++k) {
+            scenario->add(yoyInflationKeys_[j * ten_yinf_[j].size() + k], yoyRates.at(pillarDates[k]));
         }
+    }
 
-        // Inflation index values
-        for (Size j = 0; j < n_inf_; j++) {
-
-            // Depending on type of model, i.e. DK or JY, z and y mean different things.
-            Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 0)][i + 1];
-            Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 1)][i + 1];
-
-            // Could possibly cache the model type outside the loop to improve performance.
-            Real cpi = 0.0;
-            if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::JY) {
-                cpi = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 1)][i + 1]);
-            } else if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::DK) {
-                auto index = *initMarket_->zeroInflationIndex(model_->inf(j)->name());
-                Date baseDate = index->zeroInflationTermStructure()->baseDate();
-                auto zts = index->zeroInflationTermStructure();
-                Time relativeTime = inflationYearFraction(zts->frequency(), false, zts->dayCounter(),
-                                                          baseDate, dates_[i] - zts->observationLag());
-                std::tie(cpi, std::ignore) = model_->infdkI(j, relativeTime, relativeTime, z, y);
-                cpi *= index->fixing(baseDate);
-            } else {
-                QL_FAIL("CrossAssetModelScenarioGenerator: expected inflation model to be JY or DK.");
+    // Credit curves
+    for (Size j = 0; j < n_cr_; ++j) {
+        if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::LGM1F) {
+            Real z = path(model_->pIdx(CrossAssetModel::AssetType::CR, j, 0));
+            Real y = path(model_->pIdx(CrossAssetModel::AssetType::CR, j, 1));
+            lgmDefaultCurves_[j]->move(dates_[i], z, y);
+            for (Size k = 0; k < ten_dfc_[j].size(); k++) {
+                Date d = dates_[i] + ten_dfc_[j][k];
+                Time T = dc.yearFraction(dates_[i], d);
+                Real survProb = std::max(lgmDefaultCurves_[j]->survivalProbability(T), 0.00001);
+                scenario->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
+            }
+        } else if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::CIRPP) {
+            Real y = path(model_->pIdx(CrossAssetModel::AssetType::CR, j, 0));
+            cirppDefaultCurves_[j]->move(dates_[i], y);
+            for (Size k = 0; k < ten_dfc_[j].size(); k++) {
+                Date d = dates_[i] + ten_dfc_[j][k];
+                Time T = dc.yearFraction(dates_[i], d);
+                Real survProb = std::max(cirppDefaultCurves_[j]->survivalProbability(T), 0.00001);
+                scenario->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
             }
+        }
+    }
 
-            scenarios[i]->add(cpiKeys_[j], cpi);
+    // Commodity curves
+    Array comState(1, 0.0); // FIXME: single-factor for now
+    for (Size j = 0; j < n_com_; j++) {
+        comState[0] = path(model_->pIdx(CrossAssetModel::AssetType::COM, j));
+        comCurves_[j]->move(t, comState);
+        for (Size k = 0; k < ten_com_[j].size(); k++) {
+            Date d = dates_[i] + ten_com_[j][k];
+            Time T = dc.yearFraction(dates_[i], d);
+            Real price = std::max(comCurves_[j]->price(T), 0.00001);
+            scenario->add(commodityCurveKeys_[j * ten_com_[j].size() + k], price);
         }
+    }
 
-        // Zero inflation curves
-        for (Size j = 0; j < zeroInfCurves_.size(); ++j) {
+    // Credit States
+    for (Size k = 0; k < n_crstates_; ++k) {
+        Real z = path(model_->pIdx(CrossAssetModel::AssetType::CrState, k));
+        scenario->add(crStateKeys_[k], z);
+    }
 
-            auto tup = zeroInfCurves_[j];
+    // Survival Weights, stochastic cumulative survival probability, Recovery Rates
+    for (Size k = 0; k < n_survivalweights_; ++k) {
+        string name = simMarketConfig_->additionalScenarioDataSurvivalWeights()[k];
+        Real rr = survivalWeightsDefaultCurves_[k]->recovery().empty()
+                      ? 0.0
+                      : survivalWeightsDefaultCurves_[k]->recovery()->value();
+        scenario->add(survivalWeightKeys_[k],
+                          survivalWeightsDefaultCurves_[k]->curve()->survivalProbability(dates_[i]));
+        scenario->add(recoveryRateKeys_[k], rr);
+    }
+    return scenario;
+}
 
-            // State variables needed depends on model, 3 for JY and 2 for DK.
-            auto idx = std::get<0>(tup);
-            Array state(3);
-            state[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0)][i + 1];
-            state[1] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1)][i + 1];
-            if (std::get<2>(tup) == CrossAssetModel::ModelType::DK) {
-                state.resize(2);
-            } else {
-                state[2] = ir_state[std::get<1>(tup)][0];
-            }
+std::vector<Array> CrossAssetModelScenarioGenerator::conditionalCloseOutStates(const Sample<MultiPath>& sample) const {
+    QL_REQUIRE(sample.value[0].length() == pathTimes_.size(),
+               "CrossAssetModelScenarioGenerator: path length (" << sample.value[0].length()
+                                                                 << ") does not match the number of valuation dates ("
+                                                                 << pathTimes_.size() - 1 << ") plus one");
+    const Size dim = model_->dimension();
+    auto pathState = [&sample, dim](const Size k) {
+        Array x(dim);
+        for (Size c = 0; c < dim; ++c)
+            x[c] = sample.value[c][k];
+        return x;
+    };
+    std::vector<Array> states(dates_.size());
+    for (Size i = 0; i < dates_.size(); ++i) {
+        Size k = pathIndex_[i];
+        if (!isConditionalCloseOut_[i]) {
+            states[i] = pathState(k);
+        } else {
+            // one step of the state process from the preceding valuation date, i.e. a draw from the transition
+            // density given the state on that date
+            const Array& z = closeOutRsg_->nextSequence().value;
+            Array dw(z.begin(), z.end());
+            states[i] = model_->stateProcess()->evolve(pathTimes_[k], pathState(k), timeGrid_[i + 1] - pathTimes_[k],
+                                                       dw);
+        }
+    }
+    return states;
+}
+
+std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
+    std::vector<boost::shared_ptr<Scenario>> scenarios(dates_.size());
+    QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator::nextPath(): pathGenerator is null");
+    Sample<MultiPath> sample = pathGenerator_->next();
+    if (conditionalCloseOut_) {
+        std::vector<Array> states = conditionalCloseOutStates(sample);
+        for (Size i = 0; i < dates_.size(); i++)
+            scenarios[i] = buildScenario(i, [&states, i](Size c) { return states[i][c]; });
+        return scenarios;
+    }
+    for (Size i = 0; i < dates_.size(); i++)
+        scenarios[i] = buildScenario(i, [&sample, i](Size c) { return sample.value[c][i + 1]; });
+    return scenarios;
+}
+
+boost::shared_ptr<Scenario> CrossAssetModelScenarioGenerator::next(const Date& d) {
+    if (!streamingGenerator_)
+        return ScenarioPathGenerator::next(d);
+    if (d == dates_.front()) { // new path
+        streamingGenerator_->nextBlock();
+        pathStep_ = 0;
+    }
+    QL_REQUIRE(pathStep_ < dates_.size() && d == dates_[pathStep_], "step mismatch");
+    const Array& x = streamingGenerator_->next().front();
+    return buildScenario(pathStep_++, [&x](Size c) { return x[c]; });
+}
+
+void CrossAssetModelScenarioGenerator::reset() {
+    if (streamingGenerator_)
+        streamingGenerator_->reset();
+    else
+        pathGenerator_->reset();
+    if (closeOutRsg_)
+        closeOutRsg_ = boost::make_shared<PseudoRandom::rsg_type>(
+            PseudoRandom::make_sequence_generator(model_->stateProcess()->factors(), closeOutSeed_));
+}
+
+bool CrossAssetModelScenarioGenerator::supportsBlocks() const {
+    for (Size j = 0; j < n_ccy_; ++j) {
+        if (model_->modelType(CrossAssetModel::AssetType::IR, j) != CrossAssetModel::ModelType::LGM1F)
+            return false;
+    }
+    return model_->irModel(0)->n_aux() == 0 && fxVolKeys_.empty() && eqVolKeys_.empty() && n_inf_ == 0 &&
+           n_cr_ == 0 && n_com_ == 0;
+}
 
-            // Update the term structure's date and state.
-            auto ts = std::get<3>(tup);
-            ts->move(dates_[i], state);
+std::vector<CrossAssetModelScenarioGenerator::ScenarioBlock>
+CrossAssetModelScenarioGenerator::nextBlocks(const Size samples) {
+    QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator::nextBlocks(): pathGenerator is null");
+    QL_REQUIRE(supportsBlocks(), "CrossAssetModelScenarioGenerator::nextBlocks(): not supported for the given model "
+                                 "and simulation market configuration");
+    QL_REQUIRE(samples > 0, "CrossAssetModelScenarioGenerator::nextBlocks(): samples must be positive");
+    DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
 
-            // Populate the zero inflation scenario values based on the current date and state.
-            for (Size k = 0; k < ten_zinf_[j].size(); k++) {
-                Time T = dc.yearFraction(dates_[i], dates_[i] + ten_zinf_[j][k]);
-                scenarios[i]->add(zeroInflationKeys_[j * ten_zinf_[j].size() + k], ts->zeroRate(T));
+    // collect the model states as state[factor][date][sample]
+    Size nFactors = model_->dimension();
+    std::vector<std::vector<RandomVariable>> state(nFactors,
+                                                   std::vector<RandomVariable>(dates_.size(), RandomVariable(samples)));
+    for (Size s = 0; s < samples; ++s) {
+        Sample<MultiPath> sample = pathGenerator_->next();
+        if (conditionalCloseOut_) {
+            std::vector<Array> states = conditionalCloseOutStates(sample);
+            for (Size f = 0; f < nFactors; ++f) {
+                for (Size i = 0; i < dates_.size(); ++i)
+                    state[f][i].set(s, states[i][f]);
             }
+            continue;
+        }
+        for (Size f = 0; f < nFactors; ++f) {
+            for (Size i = 0; i < dates_.size(); ++i)
+                state[f][i].set(s, sample.value[f][i + 1]);
         }
+    }
 
-        // YoY inflation curves
-        for (Size j = 0; j < yoyInfCurves_.size(); ++j) {
+    std::vector<LgmVectorised> lgm;
+    for (Size j = 0; j < n_ccy_; ++j)
+        lgm.emplace_back(model_->irlgm1f(j));
 
-            auto tup = yoyInfCurves_[j];
+    std::vector<Size> indexCcyIdx(n_indices_);
+    for (Size j = 0; j < n_indices_; ++j)
+        indexCcyIdx[j] = model_->ccyIndex(indices_[j]->currency());
 
-            // For YoY model implied term structure, JY and DK both need 3 state variables.
-            auto idx = std::get<0>(tup);
-            Array state(3);
-            state[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0)][i + 1];
-            state[1] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1)][i + 1];
-            state[2] = ir_state[std::get<1>(tup)][0];
+    std::vector<Size> yieldCurveCcyIdx(n_curves_);
+    for (Size j = 0; j < n_curves_; ++j)
+        yieldCurveCcyIdx[j] = model_->ccyIndex(yieldCurveCurrency_[j]);
 
-            // Update the term structure's date and state.
-            auto ts = std::get<3>(tup);
-            ts->move(dates_[i], state);
+    const RandomVariable floor(samples, 0.00001);
 
-            // Create the YoY pillar dates from the tenors.
-            vector<Date> pillarDates(ten_yinf_[j].size());
-            for (Size k = 0; k < pillarDates.size(); ++k)
-                pillarDates[k] = dates_[i] + ten_yinf_[j][k];
+    // same as ModelImpliedYtsFwdFwdCorrected, i.e. the target curve is used directly at relative time zero
+    auto fwdFwdCorrectedDiscount = [&lgm, &dc, samples](const Size ccy, const Date& d, const Time T,
+                                                        const RandomVariable& x,
+                                                        const Handle<YieldTermStructure>& target) {
+        Time t = dc.yearFraction(lgm[ccy].parametrization()->termStructure()->referenceDate(), d);
+        if (QuantLib::close_enough(t, 0.0))
+            return RandomVariable(samples, target->discount(T));
+        return lgm[ccy].discountBond(t, t + T, x, target);
+    };
 
-            // Use the YoY term structure's YoY rates to populate the scenarios.
-            auto yoyRates = ts->yoyRates(pillarDates);
-            for (Size k = 0; k < pillarDates.size(); ++k) {
-                scenarios[i]->add(yoyInflationKeys_[j * ten_yinf_[j].size() + k], yoyRates.at(pillarDates[k]));
+    std::vector<ScenarioBlock> blocks(dates_.size());
+    for (Size i = 0; i < dates_.size(); i++) {
+        Real t = timeGrid_[i + 1]; // recall: time grid has inserted t=0
+        ScenarioBlock& block = blocks[i];
+        block.date = dates_[i];
+        block.values.reserve(keys_->size());
+
+        auto irState = [this, &state, i](const Size ccy) -> const RandomVariable& {
+            return state[model_->pIdx(CrossAssetModel::AssetType::IR, ccy)][i];
+        };
+
+        // Numeraire from domestic ir process
+        block.numeraire = lgm[0].numeraire(t, irState(0));
+
+        // Discount curves
+        for (Size j = 0; j < n_ccy_; j++) {
+            for (Size k = 0; k < ten_dsc_[j].size(); k++) {
+                Time T = dc.yearFraction(dates_[i], dates_[i] + ten_dsc_[j][k]);
+                block.values.push_back(max(lgm[j].discountBond(t, t + T, irState(j)), floor));
             }
         }
 
-        // Credit curves
-        for (Size j = 0; j < n_cr_; ++j) {
-            if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::LGM1F) {
-                Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 0)][i + 1];
-                Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 1)][i + 1];
-                lgmDefaultCurves_[j]->move(dates_[i], z, y);
-                for (Size k = 0; k < ten_dfc_[j].size(); k++) {
-                    Date d = dates_[i] + ten_dfc_[j][k];
-                    Time T = dc.yearFraction(dates_[i], d);
-                    Real survProb = std::max(lgmDefaultCurves_[j]->survivalProbability(T), 0.00001);
-                    scenarios[i]->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
-                }
-            } else if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::CIRPP) {
-                Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 0)][i + 1];
-                cirppDefaultCurves_[j]->move(dates_[i], y);
-                for (Size k = 0; k < ten_dfc_[j].size(); k++) {
-                    Date d = dates_[i] + ten_dfc_[j][k];
-                    Time T = dc.yearFraction(dates_[i], d);
-                    Real survProb = std::max(cirppDefaultCurves_[j]->survivalProbability(T), 0.00001);
-                    scenarios[i]->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
-                }
+        // Index curves
+        for (Size j = 0; j < n_indices_; ++j) {
+            for (Size k = 0; k < ten_idx_[j].size(); ++k) {
+                Time T = dc.yearFraction(dates_[i], dates_[i] + ten_idx_[j][k]);
+                block.values.push_back(max(fwdFwdCorrectedDiscount(indexCcyIdx[j], dates_[i], T,
+                                                                   irState(indexCcyIdx[j]), fwdTargetCurves_[j]),
+                                           floor));
             }
         }
 
-        // Commodity curves
-        Array comState(1, 0.0); // FIXME: single-factor for now
-        for (Size j = 0; j < n_com_; j++) {
-            comState[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::COM, j)][i + 1];
-            comCurves_[j]->move(t, comState);
-            for (Size k = 0; k < ten_com_[j].size(); k++) {
-                Date d = dates_[i] + ten_com_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real price = std::max(comCurves_[j]->price(T), 0.00001);
-                scenarios[i]->add(commodityCurveKeys_[j * ten_com_[j].size() + k], price);
+        // Yield curves
+        for (Size j = 0; j < n_curves_; ++j) {
+            for (Size k = 0; k < ten_yc_[j].size(); ++k) {
+                Time T = dc.yearFraction(dates_[i], dates_[i] + ten_yc_[j][k]);
+                block.values.push_back(max(fwdFwdCorrectedDiscount(yieldCurveCcyIdx[j], dates_[i], T,
+                                                                   irState(yieldCurveCcyIdx[j]),
+                                                                   yieldTargetCurves_[j]),
+                                           floor));
             }
         }
 
+        // FX rates
+        for (Size k = 0; k < n_ccy_ - 1; k++)
+            block.values.push_back(exp(state[model_->pIdx(CrossAssetModel::AssetType::FX, k)][i]));
+
+        // Equity spots
+        for (Size k = 0; k < n_eq_; k++)
+            block.values.push_back(exp(state[model_->pIdx(CrossAssetModel::AssetType::EQ, k)][i]));
+
         // Credit States
-        for (Size k = 0; k < n_crstates_; ++k) {
-            Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::CrState, k)][i + 1];
-            scenarios[i]->add(crStateKeys_[k], z);
-        }
+        for (Size k = 0; k < n_crstates_; ++k)
+            block.values.push_back(state[model_->pIdx(CrossAssetModel::AssetType::CrState, k)][i]);
 
-        // Survival Weights, stochastic cumulative survival probability, Recovery Rates
+        // Survival Weights, Recovery Rates (deterministic)
         for (Size k = 0; k < n_survivalweights_; ++k) {
-            string name = simMarketConfig_->additionalScenarioDataSurvivalWeights()[k];
             Real rr = survivalWeightsDefaultCurves_[k]->recovery().empty()
                           ? 0.0
                           : survivalWeightsDefaultCurves_[k]->recovery()->value();
-            scenarios[i]->add(survivalWeightKeys_[k],
-                              survivalWeightsDefaultCurves_[k]->curve()->survivalProbability(dates_[i]));
-            scenarios[i]->add(recoveryRateKeys_[k], rr);
+            block.values.push_back(
+                RandomVariable(samples, survivalWeightsDefaultCurves_[k]->curve()->survivalProbability(dates_[i])));
+            block.values.push_back(RandomVariable(samples, rr));
         }
+
+        QL_REQUIRE(block.values.size() == keys_->size(), "CrossAssetModelScenarioGenerator::nextBlocks(): internal "
+                                                         "error, got "
+                                                             << block.values.size() << " values, expected "
+                                                             << keys_->size());
     }
-    return scenarios;
+    return blocks;
 }
 } // namespace analytics
 } // namespace ore
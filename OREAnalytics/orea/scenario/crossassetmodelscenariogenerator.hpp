@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <orea/scenario/compactscenario.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
@@ -30,7 +31,9 @@
 #include <ored/marketdata/market.hpp>
 #include <ored/utilities/dategrid.hpp>
 
+#include <qle/math/randomvariable.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
+#include <qle/methods/streamingmultipathgenerator.hpp>
 #include <qle/models/cirppimplieddefaulttermstructure.hpp>
 #include <qle/models/crossassetmodel.hpp>
 #include <qle/models/crossassetmodelimpliedeqvoltermstructure.hpp>
@@ -55,11 +58,28 @@ using namespace QuantExt;
   - a calibrated model,
   - an associated multi path generator (i.e. providing paths for all factors
     of the model ordered as described in the model),
-  - a scenario factory that provides building scenario class instances,
+  - a scenario factory that provides building scenario class instances, a CompactScenarioFactory without key table
+    gets the keys of the generated scenarios assigned in the ctor,
   - the configuration of market curves to be simulated
   - a simulation date grid that starts in the future, i.e. does not include today's date
   - the associated time grid including t=0
 
+  Alternatively the generator can be constructed with a streaming path generator, which is advanced date by date in
+  next() for one sample at a time, so that neither the path nor the scenarios of a whole path are buffered. Close-out
+  dates that are not valuation dates can be bridged by the streaming generator, see
+  CrossAssetModelScenarioGenerator::bridgedCloseOutDates().
+
+  With conditional close-out, the multi path generator is expected on the valuation time grid of the date grid, see
+  DateGrid::valuationTimeGrid(). The states on close-out dates that are not valuation dates are then not simulated as
+  steps of the path, but sampled from the transition density of the model state process given the state on the
+  nearest preceding valuation date, using independent pseudo random variates. The joint distribution of the states on
+  a valuation date and its close-out date is therefore the same as for a full path simulation, only the close-out
+  states are conditionally independent of the later states of the path.
+
+  For pure LGM1F IR / FX / EQ models the generator can alternatively produce the scenarios of many samples at once,
+  see nextBlocks(). The blocks hold one random variable over the samples per key of the key table keys(), i.e. the
+  data is laid out factor by sample for each date.
+
   \ingroup scenario
  */
 class CrossAssetModelScenarioGenerator : public ScenarioPathGenerator {
@@ -71,15 +91,62 @@ public:
                                      boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
                                      QuantLib::Date today, boost::shared_ptr<DateGrid> grid,
                                      boost::shared_ptr<ore::data::Market> initMarket,
+                                     const std::string& configuration = Market::defaultConfiguration,
+                                     const bool conditionalCloseOut = false, const BigNatural closeOutSeed = 0);
+    //! Constructor using a streaming path generator with block size 1 on the time grid of the date grid
+    CrossAssetModelScenarioGenerator(boost::shared_ptr<QuantExt::CrossAssetModel> model,
+                                     boost::shared_ptr<QuantExt::StreamingMultiPathGenerator> streamingGenerator,
+                                     boost::shared_ptr<ScenarioFactory> scenarioFactory,
+                                     boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
+                                     QuantLib::Date today, boost::shared_ptr<DateGrid> grid,
+                                     boost::shared_ptr<ore::data::Market> initMarket,
                                      const std::string& configuration = Market::defaultConfiguration);
     //! Default destructor
     ~CrossAssetModelScenarioGenerator(){};
+    boost::shared_ptr<Scenario> next(const Date& d) override;
     std::vector<boost::shared_ptr<Scenario>> nextPath() override;
-    void reset() override { pathGenerator_->reset(); }
+    void reset() override;
+
+    /*! Flags for the points of the time grid of \p grid (including t=0) that are close-out dates but not valuation
+        dates, to be passed to the StreamingMultiPathGenerator */
+    static std::vector<bool> bridgedCloseOutDates(const DateGrid& grid);
+
+    //! Scenario values of all samples for one simulation date
+    struct ScenarioBlock {
+        Date date;
+        QuantExt::RandomVariable numeraire;
+        //! one random variable per key, in the order of the key table keys()
+        std::vector<QuantExt::RandomVariable> values;
+    };
+
+    //! The keys of the generated scenarios, in the order in which nextPath() adds them
+    const boost::shared_ptr<const CompactScenarioKeys>& keys() const { return keys_; }
+
+    /*! True if nextBlocks() is supported, this requires LGM1F IR models in the LGM measure and excludes the
+        simulation of FX and EQ vols, inflation, credit and commodities */
+    bool supportsBlocks() const;
+
+    /*! Generate the next \p samples paths and return one block per simulation date. The values coincide with those
+        of \p samples calls to nextPath(), but are computed using vectorised LGM calculations per date. */
+    std::vector<ScenarioBlock> nextBlocks(const Size samples);
 
 private:
+    // build the scenario for the i-th simulation date from the model states path(0), path(1), ...
+    template <class Path> boost::shared_ptr<Scenario> buildScenario(Size i, const Path& path);
+    // the model states on all simulation dates for a sample on the valuation time grid, with conditional close-out
+    std::vector<Array> conditionalCloseOutStates(const Sample<MultiPath>& sample) const;
+
     boost::shared_ptr<QuantExt::CrossAssetModel> model_;
     boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator_;
+    boost::shared_ptr<QuantExt::StreamingMultiPathGenerator> streamingGenerator_;
+    // conditional close-out: the path index of each simulation date, or of the preceding valuation date for a
+    // close-out date that is not a valuation date, and the generator for the close-out variates
+    bool conditionalCloseOut_;
+    BigNatural closeOutSeed_;
+    std::vector<Size> pathIndex_;
+    std::vector<bool> isConditionalCloseOut_;
+    std::vector<Time> pathTimes_;
+    boost::shared_ptr<PseudoRandom::rsg_type> closeOutRsg_;
     boost::shared_ptr<ScenarioFactory> scenarioFactory_;
     boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig_;
     boost::shared_ptr<ore::data::Market> initMarket_;
@@ -87,8 +154,9 @@ private:
     // generated data
     std::vector<RiskFactorKey> discountCurveKeys_, indexCurveKeys_, yieldCurveKeys_, zeroInflationKeys_,
         yoyInflationKeys_, defaultCurveKeys_, commodityCurveKeys_;
-    std::vector<RiskFactorKey> fxKeys_, eqKeys_, cpiKeys_;
+    std::vector<RiskFactorKey> fxKeys_, fxVolKeys_, eqKeys_, eqVolKeys_, cpiKeys_;
     std::vector<RiskFactorKey> crStateKeys_, survivalWeightKeys_, recoveryRateKeys_;
+    boost::shared_ptr<const CompactScenarioKeys> keys_;
     std::vector<boost::shared_ptr<QuantExt::CrossAssetModelImpliedFxVolTermStructure>> fxVols_;
     std::vector<boost::shared_ptr<QuantExt::CrossAssetModelImpliedEqVolTermStructure>> eqVols_;
     std::vector<std::vector<Period>> ten_dsc_, ten_idx_, ten_yc_, ten_efc_, ten_zinf_, ten_yinf_, ten_dfc_, ten_com_;
@@ -97,6 +165,7 @@ private:
 
     vector<boost::shared_ptr<QuantExt::ModelImpliedYieldTermStructure>> curves_, fwdCurves_, yieldCurves_;
     vector<boost::shared_ptr<QuantExt::ModelImpliedPriceTermStructure>> comCurves_;
+    vector<Handle<YieldTermStructure>> fwdTargetCurves_, yieldTargetCurves_;
     vector<boost::shared_ptr<IborIndex>> indices_;
     vector<Currency> yieldCurveCurrency_;
     vector<string> zeroInflationIndex_, yoyInflationIndex_;
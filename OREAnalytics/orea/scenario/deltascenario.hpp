@@ -73,6 +73,8 @@ public:
 
     //! Get delta
     boost::shared_ptr<Scenario> delta() const { return delta_; }
+    //! Get base scenario
+    const boost::shared_ptr<Scenario>& baseScenario() const { return baseScenario_; }
 
     boost::shared_ptr<Scenario> clone() const override;
 
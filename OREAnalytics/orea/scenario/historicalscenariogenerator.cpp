@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/compactscenariofactory.hpp>
 #include <orea/scenario/historicalscenariogenerator.hpp>
 #include <orea/scenario/simplescenario.hpp>
 #include <ored/utilities/csvfilereader.hpp>
@@ -30,6 +31,17 @@ using namespace QuantLib;
 namespace ore {
 namespace analytics {
 
+namespace {
+// a compact scenario factory without key table gets the keys of the base scenario
+void initCompactScenarioKeys(const boost::shared_ptr<ScenarioFactory>& factory,
+                             const boost::shared_ptr<Scenario>& baseScenario) {
+    if (auto csf = boost::dynamic_pointer_cast<CompactScenarioFactory>(factory)) {
+        if (!csf->keys())
+            csf->setKeys(boost::make_shared<CompactScenarioKeys>(baseScenario->keys()));
+    }
+}
+} // namespace
+
 ReturnConfiguration::ReturnConfiguration()
     : // Default Configuration for risk factor returns
       // For all yield curves we have DFs in the Scenario, for credit we have SurvProbs,
@@ -220,10 +232,11 @@ boost::shared_ptr<Scenario> HistoricalScenarioGenerator::next(const Date& d) {
 
     // build the scenarios
     QL_REQUIRE(d >= baseScenario_->asof(), "Cannot generate a scenario in the past");
+    initCompactScenarioKeys(scenarioFactory_, baseScenario_);
     boost::shared_ptr<Scenario> scen = scenarioFactory_->buildScenario(d, "", 1.0);
 
     // loop over all keys
-    for (auto key : baseScenario_->keys()) {
+    for (const auto& key : baseScenario_->keys()) {
         Real base = baseScenario_->get(key);
         Real v1 = 1.0, v2 = 1.0;
         if (!s1->has(key) || !s2->has(key)) {
@@ -280,10 +293,11 @@ boost::shared_ptr<Scenario> HistoricalScenarioGeneratorRandom::next(const Date&
     // build the scenarios
     QL_REQUIRE(d >= baseScenario()->asof(),
                "HistoricalScenarioGeneratorRandom: Cannot generate a scenario in the past");
+    initCompactScenarioKeys(scenarioFactory_, baseScenario());
     boost::shared_ptr<Scenario> scen = scenarioFactory_->buildScenario(d, "", 1.0);
 
     // loop over all keys
-    for (auto key : baseScenario()->keys()) {
+    for (const auto& key : baseScenario()->keys()) {
         Real base = baseScenario()->get(key);
         Real value = 0.0;
         switch (key.keytype) {
@@ -82,7 +82,7 @@ public:
     HistoricalScenarioGenerator(
         //! Historical Scenario Loader containing all scenarios
         const boost::shared_ptr<HistoricalScenarioLoader>& historicalScenarioLoader,
-        //! Scenario factory to use
+        //! Scenario factory to use, a CompactScenarioFactory without key table gets the base scenario keys
         const boost::shared_ptr<ScenarioFactory>& scenarioFactory,
         //! Calendar to use
         const QuantLib::Calendar& cal,
@@ -19,8 +19,11 @@
 #include <orea/scenario/historicalscenarioloader.hpp>
 #include <ored/utilities/csvfilereader.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/parsers.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using QuantLib::io::iso_date;
 using namespace QuantLib;
@@ -41,6 +44,13 @@ boost::shared_ptr<Scenario> HistoricalScenarioLoader::getHistoricalScenario(cons
 HistoricalScenarioLoader::HistoricalScenarioLoader(const boost::shared_ptr<HistoricalScenarioReader>& scenarioReader,
                                                    const Date& startDate, const Date& endDate,
                                                    const Calendar& calendar) {
+    loadScenarios(scenarioReader, startDate, endDate, calendar,
+                  [this, &scenarioReader]() { historicalScenarios_.push_back(scenarioReader->scenario()); });
+}
+
+void HistoricalScenarioLoader::loadScenarios(const boost::shared_ptr<HistoricalScenarioReader>& scenarioReader,
+                                             const Date& startDate, const Date& endDate, const Calendar& calendar,
+                                             const std::function<void()>& store) {
 
     QL_REQUIRE(scenarioReader, "The historical scenario loader must be provided with a valid scenario reader");
 
@@ -80,7 +90,7 @@ HistoricalScenarioLoader::HistoricalScenarioLoader(const boost::shared_ptr<Histo
         if (d <= endDate) {
             // create scenario and store it
             DLOG("Loading scenario for date " << iso_date(d));
-            historicalScenarios_.push_back(scenarioReader->scenario());
+            store();
             dates_.push_back(d);
 
             // Advance the request date
@@ -91,7 +101,91 @@ HistoricalScenarioLoader::HistoricalScenarioLoader(const boost::shared_ptr<Histo
         }
     }
 
-    LOG("Loaded " << historicalScenarios_.size() << " from " << startDate << " to " << endDate);
+    LOG("Loaded " << dates_.size() << " from " << startDate << " to " << endDate);
+}
+
+CompactHistoricalScenarioLoader::CompactHistoricalScenarioLoader(
+    const boost::shared_ptr<HistoricalScenarioReader>& scenarioReader, const Date& startDate, const Date& endDate,
+    const Calendar& calendar) {
+
+    binaryReader_ = boost::dynamic_pointer_cast<HistoricalBinaryScenarioReader>(scenarioReader);
+    if (binaryReader_) {
+        keys_ = binaryReader_->file().keys();
+        loadScenarios(scenarioReader, startDate, endDate, calendar,
+                      [this]() { filePositions_.push_back(binaryReader_->position()); });
+        return;
+    }
+
+    loadScenarios(scenarioReader, startDate, endDate, calendar, [this, &scenarioReader]() {
+        boost::shared_ptr<Scenario> s = scenarioReader->scenario();
+        QL_REQUIRE(s, "CompactHistoricalScenarioLoader: no scenario for date " << scenarioReader->date());
+        auto c = boost::dynamic_pointer_cast<CompactScenario>(s);
+        if (!keys_) {
+            if (c)
+                keys_ = c->keyTable();
+            else
+                keys_ = boost::make_shared<CompactScenarioKeys>(s->keys());
+        }
+        Size n = keys_->size();
+        values_.resize(values_.size() + n, Null<Real>());
+        Real* row = values_.data() + values_.size() - n;
+        if (c && c->keyTable() == keys_) {
+            std::copy(c->values().begin(), c->values().end(), row);
+        } else {
+            const std::vector<RiskFactorKey>& keys = s->keys();
+            for (Size k = 0; k < keys.size(); ++k) {
+                // avoid the lookup if the keys come in the order of the table
+                Size i = k < n && keys_->keys()[k] == keys[k] ? k : keys_->index(keys[k]);
+                QL_REQUIRE(i != Null<Size>(), "CompactHistoricalScenarioLoader: key "
+                                                  << keys[k] << " in scenario for " << scenarioReader->date()
+                                                  << " is not in the key table of the first scenario");
+                row[i] = s->get(keys[k]);
+            }
+        }
+        numeraires_.push_back(s->getNumeraire());
+    });
+
+    LOG("CompactHistoricalScenarioLoader: stored " << dates_.size() << " dates and "
+                                                   << (keys_ ? keys_->size() : 0) << " keys");
+}
+
+Size CompactHistoricalScenarioLoader::index(const Date& date) const {
+    auto it = std::lower_bound(dates_.begin(), dates_.end(), date);
+    QL_REQUIRE(it != dates_.end() && *it == date,
+               "CompactHistoricalScenarioLoader can't find an index for date " << date);
+    return std::distance(dates_.begin(), it);
+}
+
+boost::shared_ptr<Scenario> CompactHistoricalScenarioLoader::getHistoricalScenario(const Date& date) const {
+    QL_REQUIRE(!dates_.empty(), "No Historical Scenarios Loaded");
+    Size i = index(date);
+    if (binaryReader_)
+        return binaryReader_->file().scenario(filePositions_[i]);
+    Size n = keys_->size();
+    auto s = boost::make_shared<CompactScenario>(keys_, date, "", numeraires_[i]);
+    for (Size k = 0; k < n; ++k)
+        s->set(k, values_[i * n + k]);
+    return s;
+}
+
+std::size_t HistoricalScenarioLoader::memoryFootprint() const {
+    using ore::data::memoryFootprint;
+    std::size_t bytes = memoryFootprint(historicalScenarios_) + memoryFootprint(dates_);
+    for (auto const& s : historicalScenarios_) {
+        if (s)
+            bytes += s->keys().size() * (sizeof(RiskFactorKey) + sizeof(Real) + 4 * sizeof(void*));
+    }
+    return bytes;
+}
+
+std::size_t CompactHistoricalScenarioLoader::memoryFootprint() const {
+    using ore::data::memoryFootprint;
+    std::size_t bytes = memoryFootprint(dates_) + memoryFootprint(values_) + memoryFootprint(numeraires_) +
+                        memoryFootprint(filePositions_);
+    // the key table holds the keys in a vector and an index map
+    if (keys_)
+        bytes += keys_->size() * (2 * sizeof(RiskFactorKey) + sizeof(Size) + 4 * sizeof(void*));
+    return bytes;
 }
 
 } // namespace analytics
@@ -24,10 +24,13 @@
 #pragma once
 
 #include <boost/make_shared.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <orea/scenario/compactscenario.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/historicalscenarioreader.hpp>
 #include <ql/time/calendar.hpp>
+#include <functional>
 #include <vector>
 
 namespace ore {
@@ -38,6 +41,7 @@ class HistoricalScenarioLoader {
 public:
     //! Default constructor
     HistoricalScenarioLoader() {}
+    virtual ~HistoricalScenarioLoader() {}
 
     /*! Constructor that loads scenarios, read from \p scenarioReader, between \p startDate
         and \p endDate.
@@ -56,9 +60,9 @@ public:
         const QuantLib::Calendar& calendar);
 
     //! Get a Scenario for a given date
-    boost::shared_ptr<ore::analytics::Scenario> getHistoricalScenario(const QuantLib::Date& date) const;
+    virtual boost::shared_ptr<ore::analytics::Scenario> getHistoricalScenario(const QuantLib::Date& date) const;
     //! Number of scenarios
-    QuantLib::Size numScenarios() const { return historicalScenarios_.size(); }
+    virtual QuantLib::Size numScenarios() const { return historicalScenarios_.size(); }
     //! Set historical scenarios
     std::vector<boost::shared_ptr<ore::analytics::Scenario>>& historicalScenarios() { return historicalScenarios_; }
     //! The historical scenarios
@@ -69,12 +73,59 @@ public:
     std::vector<QuantLib::Date>& dates() { return dates_; }
     //! The historical scenario dates
     const std::vector<QuantLib::Date>& dates() const { return dates_; }
+    /*! Estimated memory footprint in bytes, the scenarios are counted as key value maps, see
+        ore::data::MemoryAccounting */
+    virtual std::size_t memoryFootprint() const;
 
 protected:
+    /*! Walks through the scenarios of \p scenarioReader between \p startDate and \p endDate, for each date to load
+        the date is added to dates_ and \p store is called with the reader positioned on the date's scenario */
+    void loadScenarios(const boost::shared_ptr<HistoricalScenarioReader>& scenarioReader,
+                       const QuantLib::Date& startDate, const QuantLib::Date& endDate,
+                       const QuantLib::Calendar& calendar, const std::function<void()>& store);
+
     // to be populated by derived classes
     std::vector<boost::shared_ptr<ore::analytics::Scenario>> historicalScenarios_;
     std::vector<QuantLib::Date> dates_;
 };
 
+//! Class for loading historical scenarios into a compact (date x factor) matrix
+/*! Instead of holding one scenario object per date, the market values are stored in a single matrix with one row per
+    date and one column per key of a shared key table. The scenarios returned by getHistoricalScenario() are built on
+    demand as CompactScenario instances. If the scenarios are read by a HistoricalBinaryScenarioReader, the loader
+    only keeps the positions of the dates in the memory mapped file and no values are copied.
+
+    The key table is taken from the first scenario loaded, all further scenarios must only contain keys of this
+    table. Keys not provided by a scenario are reported as missing by the returned scenario, as for the other loaders.
+
+    The historicalScenarios() vector is not populated by this loader.
+*/
+class CompactHistoricalScenarioLoader : public HistoricalScenarioLoader {
+public:
+    /*! Constructor that loads scenarios, read from \p scenarioReader, between \p startDate and \p endDate, see the
+        HistoricalScenarioLoader constructor */
+    CompactHistoricalScenarioLoader(const boost::shared_ptr<HistoricalScenarioReader>& scenarioReader,
+                                    const QuantLib::Date& startDate, const QuantLib::Date& endDate,
+                                    const QuantLib::Calendar& calendar);
+
+    boost::shared_ptr<ore::analytics::Scenario> getHistoricalScenario(const QuantLib::Date& date) const override;
+    QuantLib::Size numScenarios() const override { return dates_.size(); }
+
+    //! The key table shared by the scenarios
+    const boost::shared_ptr<const CompactScenarioKeys>& keys() const { return keys_; }
+    //! Estimated memory footprint in bytes, the mapped binary scenario file is not included
+    std::size_t memoryFootprint() const override;
+
+private:
+    QuantLib::Size index(const QuantLib::Date& date) const;
+
+    boost::shared_ptr<const CompactScenarioKeys> keys_;
+    //! the values by date and key and the numeraires by date if not read from a binary scenario file
+    std::vector<QuantLib::Real> values_, numeraires_;
+    //! the binary scenario reader and the positions of the dates in its file
+    boost::shared_ptr<HistoricalBinaryScenarioReader> binaryReader_;
+    std::vector<QuantLib::Size> filePositions_;
+};
+
 } // namespace analytics
 } // namespace ore
@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/historicalshiftstore.hpp>
+#include <ored/utilities/csvfilereader.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace analytics {
+
+Real HistoricalShiftStore::shift(const DatePair& dates, const RiskFactorKey& key) const {
+    auto it = shifts_.find(dates);
+    if (it == shifts_.end())
+        return Null<Real>();
+    auto s = it->second.find(key);
+    return s == it->second.end() ? Null<Real>() : s->second;
+}
+
+void HistoricalShiftStore::set(const DatePair& dates, const RiskFactorKey& key, Real shift) {
+    shifts_[dates][key] = shift;
+}
+
+void HistoricalShiftStore::prune(const std::set<DatePair>& dates) {
+    for (auto it = shifts_.begin(); it != shifts_.end();) {
+        if (dates.find(it->first) == dates.end())
+            it = shifts_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void HistoricalShiftStore::load(const std::string& fileName) {
+    ore::data::CSVFileReader reader(fileName, true);
+    QL_REQUIRE(reader.numberOfColumns() == 4,
+               "HistoricalShiftStore: expected 4 columns in " << fileName << ", got " << reader.numberOfColumns());
+    Size n = 0;
+    while (reader.next()) {
+        DatePair dates(ore::data::parseDate(reader.get(0)), ore::data::parseDate(reader.get(1)));
+        set(dates, parseRiskFactorKey(reader.get(2)), ore::data::parseReal(reader.get(3)));
+        ++n;
+    }
+    reader.close();
+    LOG("HistoricalShiftStore: read " << n << " shifts for " << shifts_.size() << " date pairs from " << fileName);
+}
+
+void HistoricalShiftStore::save(const std::string& fileName) const {
+    std::ofstream file(fileName);
+    QL_REQUIRE(file.is_open(), "HistoricalShiftStore: error opening file " << fileName);
+    // write all digits so that a reloaded store reproduces the shifts exactly
+    file << std::setprecision(std::numeric_limits<Real>::max_digits10);
+    file << "StartDate,EndDate,RiskFactor,Shift\n";
+    for (const auto& [dates, shifts] : shifts_) {
+        std::string start = ore::data::to_string(dates.first), end = ore::data::to_string(dates.second);
+        for (const auto& [key, shift] : shifts)
+            file << start << ',' << end << ',' << key << ',' << shift << '\n';
+    }
+    file.close();
+    QL_REQUIRE(!file.fail(), "HistoricalShiftStore: error writing file " << fileName);
+    LOG("HistoricalShiftStore: wrote " << shifts_.size() << " date pairs to " << fileName);
+}
+
+} // namespace analytics
+} // namespace ore
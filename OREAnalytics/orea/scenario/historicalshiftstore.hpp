@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/historicalshiftstore.hpp
+    \brief Persistent store of historical sensitivity shifts
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenario.hpp>
+
+#include <ql/time/date.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Store of the sensitivity shifts of historical scenarios, keyed by the scenario's (start date, end date) pair
+/*! A rolling historical window shares all but one scenario with the window of the previous day. If the shifts
+    generated for the sensitivity based P&L only depend on the historical returns, which holds for the usual
+    combination of absolute / relative returns with absolute / relative shifts of the same quantity, the shifts of
+    the overlapping scenarios can be reused, see HistoricalSensiPnlCalculator::setShiftStore(). The store can be
+    saved to and loaded from a csv file with the columns StartDate, EndDate, RiskFactor and Shift.
+
+    A store should only be reused with the same sensitivity and simulation market configuration and the same
+    historical scenarios.
+
+    \ingroup scenario
+*/
+class HistoricalShiftStore {
+public:
+    typedef std::pair<QuantLib::Date, QuantLib::Date> DatePair;
+
+    HistoricalShiftStore() {}
+    //! Constructor loading the store from a file
+    explicit HistoricalShiftStore(const std::string& fileName) { load(fileName); }
+
+    //! Return the stored shift or Null<Real>() if there is none
+    QuantLib::Real shift(const DatePair& dates, const RiskFactorKey& key) const;
+    //! Store a shift, overwrites an existing entry
+    void set(const DatePair& dates, const RiskFactorKey& key, QuantLib::Real shift);
+    //! Number of date pairs in the store
+    QuantLib::Size size() const { return shifts_.size(); }
+
+    //! Remove all date pairs that are not in the given set
+    void prune(const std::set<DatePair>& dates);
+
+    //! Add the entries of a csv file, entries in the file overwrite existing entries
+    void load(const std::string& fileName);
+    //! Write the store to a csv file
+    void save(const std::string& fileName) const;
+
+private:
+    std::map<DatePair, std::map<RiskFactorKey, QuantLib::Real>> shifts_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,295 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/riskfactorpruning.hpp>
+#include <orea/scenario/scenariofilter.hpp>
+
+#include <ored/utilities/indexparser.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <qle/indexes/commodityindex.hpp>
+#include <qle/indexes/equityindex.hpp>
+
+#include <ql/indexes/iborindex.hpp>
+#include <ql/indexes/inflationindex.hpp>
+
+#include <boost/make_shared.hpp>
+
+using namespace ore::data;
+using namespace QuantLib;
+using std::string;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+using Requests = std::set<std::pair<MarketObject, string>>;
+using KeyType = RiskFactorKey::KeyType;
+
+// the currency of an index name like EUR-EURIBOR-6M or EUR-CMS-30Y, or of a plain currency key
+string currencyPrefix(const string& name) { return name.substr(0, name.find('-')); }
+
+// add the market objects that are projected from the sim market to produce the required fixings of a trade
+void addFixingRequests(const Trade& trade, Requests& requests) {
+    auto r = trade.requiredFixings();
+    r.unsetPayDates();
+    for (auto const& [name, dates] : r.fixingDatesIndices(Date::maxDate())) {
+        try {
+            auto index = parseIndex(name);
+            if (auto eq = boost::dynamic_pointer_cast<QuantExt::EquityIndex2>(index))
+                requests.insert(std::make_pair(MarketObject::EquityCurve, eq->familyName()));
+            else if (auto comm = boost::dynamic_pointer_cast<QuantExt::CommodityIndex>(index))
+                requests.insert(std::make_pair(MarketObject::CommodityCurve, comm->underlyingName()));
+            else if (boost::dynamic_pointer_cast<ZeroInflationIndex>(index))
+                requests.insert(std::make_pair(MarketObject::ZeroInflationCurve, name));
+            else if (boost::dynamic_pointer_cast<SwapIndex>(index))
+                requests.insert(std::make_pair(MarketObject::SwapIndexCurve, name));
+            else if (boost::dynamic_pointer_cast<IborIndex>(index))
+                requests.insert(std::make_pair(MarketObject::IndexCurve, name));
+        } catch (const std::exception& e) {
+            // fx and other indices are not mapped to prunable risk factors
+            TLOG("unusedRiskFactors: index '" << name << "' not mapped (" << e.what() << ")");
+        }
+    }
+}
+
+void addFixingRequests(const Portfolio& portfolio, Requests& requests) {
+    for (auto const& [tradeId, trade] : portfolio.trades())
+        addFixingRequests(*trade, requests);
+}
+
+bool requested(const Requests& requests, const MarketObject o, const string& name) {
+    return requests.find(std::make_pair(o, name)) != requests.end();
+}
+
+bool requestedForCurrency(const Requests& requests, const std::vector<MarketObject>& objects, const string& ccy) {
+    for (auto const& [o, name] : requests) {
+        if (std::find(objects.begin(), objects.end(), o) != objects.end() && currencyPrefix(name) == ccy)
+            return true;
+    }
+    return false;
+}
+
+bool requestedAny(const Requests& requests, const std::vector<MarketObject>& objects) {
+    for (auto const& r : requests) {
+        if (std::find(objects.begin(), objects.end(), r.first) != objects.end())
+            return true;
+    }
+    return false;
+}
+
+bool correlationRequested(const Requests& requests, const string& name) {
+    std::vector<string> tokens = getCorrelationTokens(name);
+    if (tokens.size() != 2)
+        return true;
+    for (auto const& [o, n] : requests) {
+        if (o != MarketObject::Correlation)
+            continue;
+        std::vector<string> t = getCorrelationTokens(n);
+        if (t.size() == 2 && ((t[0] == tokens[0] && t[1] == tokens[1]) || (t[0] == tokens[1] && t[1] == tokens[0])))
+            return true;
+    }
+    return false;
+}
+
+// true if the risk factor (type, name) is used given the requests
+bool used(const KeyType type, const string& name, const Requests& requests) {
+    switch (type) {
+    case KeyType::IndexCurve:
+        return requested(requests, MarketObject::IndexCurve, name) ||
+               requestedForCurrency(requests,
+                                    {MarketObject::SwapIndexCurve, MarketObject::SwaptionVol, MarketObject::YieldVol,
+                                     MarketObject::CapFloorVol},
+                                    currencyPrefix(name));
+    case KeyType::YieldCurve:
+        // yield curves are also used as equity forecast curves, security and commodity curves in the sim market
+        return requested(requests, MarketObject::YieldCurve, name) ||
+               requestedAny(requests, {MarketObject::EquityCurve, MarketObject::EquityVol, MarketObject::Security,
+                                       MarketObject::CommodityCurve, MarketObject::CommodityVolatility});
+    case KeyType::SwaptionVolatility:
+        return requested(requests, MarketObject::SwaptionVol, name);
+    case KeyType::YieldVolatility:
+        return requested(requests, MarketObject::YieldVol, name);
+    case KeyType::OptionletVolatility:
+        return requested(requests, MarketObject::CapFloorVol, name);
+    case KeyType::FXVolatility:
+        return name.size() != 6 || requested(requests, MarketObject::FXVol, name) ||
+               requested(requests, MarketObject::FXVol, name.substr(3, 3) + name.substr(0, 3));
+    case KeyType::EquitySpot:
+    case KeyType::DividendYield:
+        return requested(requests, MarketObject::EquityCurve, name) ||
+               requested(requests, MarketObject::EquityVol, name);
+    case KeyType::EquityVolatility:
+        return requested(requests, MarketObject::EquityVol, name);
+    case KeyType::SurvivalProbability:
+    case KeyType::RecoveryRate:
+        // default curves underlie cds vols, base correlations and securities
+        return requested(requests, MarketObject::DefaultCurve, name) ||
+               requestedAny(requests, {MarketObject::CDSVol, MarketObject::BaseCorrelation, MarketObject::Security});
+    case KeyType::CDSVolatility:
+        return requested(requests, MarketObject::CDSVol, name);
+    case KeyType::BaseCorrelation:
+        return requested(requests, MarketObject::BaseCorrelation, name);
+    case KeyType::SecuritySpread:
+        return requested(requests, MarketObject::Security, name);
+    case KeyType::CPIIndex:
+    case KeyType::ZeroInflationCurve:
+        return requested(requests, MarketObject::ZeroInflationCurve, name) ||
+               requested(requests, MarketObject::ZeroInflationCapFloorVol, name) ||
+               requested(requests, MarketObject::YoYInflationCurve, name);
+    case KeyType::ZeroInflationCapFloorVolatility:
+        return requested(requests, MarketObject::ZeroInflationCapFloorVol, name);
+    case KeyType::YoYInflationCurve:
+        return requested(requests, MarketObject::YoYInflationCurve, name) ||
+               requested(requests, MarketObject::YoYInflationCapFloorVol, name);
+    case KeyType::YoYInflationCapFloorVolatility:
+        return requested(requests, MarketObject::YoYInflationCapFloorVol, name);
+    case KeyType::CommodityCurve:
+        return requested(requests, MarketObject::CommodityCurve, name) ||
+               requested(requests, MarketObject::CommodityVolatility, name);
+    case KeyType::CommodityVolatility:
+        return requested(requests, MarketObject::CommodityVolatility, name);
+    case KeyType::Correlation:
+        return correlationRequested(requests, name);
+    default:
+        // discount curves, fx spots, credit states, survival weights, cpr are never pruned
+        return true;
+    }
+}
+
+// the currencies of the fx spots, fx vols and discount curves requested by a trade and its npv currency
+std::set<string> tradeCurrencies(const Requests& requests, const string& npvCurrency) {
+    std::set<string> ccys = {npvCurrency};
+    for (auto const& [o, name] : requests) {
+        if ((o == MarketObject::FXSpot || o == MarketObject::FXVol) && name.size() == 6) {
+            ccys.insert(name.substr(0, 3));
+            ccys.insert(name.substr(3, 3));
+        } else if (o == MarketObject::DiscountCurve) {
+            ccys.insert(name);
+        }
+    }
+    return ccys;
+}
+
+// true if the risk factor (type, name) is used by a single trade given its requests and currencies
+bool usedByTrade(const KeyType type, const string& name, const Requests& requests, const std::set<string>& ccys,
+                 const string& baseCcy) {
+    switch (type) {
+    case KeyType::DiscountCurve:
+        // discount curves are used by swap indices, fx, equity, commodity and inflation objects of the sim market
+        return requested(requests, MarketObject::DiscountCurve, name) ||
+               requestedForCurrency(requests,
+                                    {MarketObject::IndexCurve, MarketObject::SwapIndexCurve, MarketObject::SwaptionVol,
+                                     MarketObject::YieldVol, MarketObject::CapFloorVol},
+                                    name) ||
+               requestedAny(requests, {MarketObject::FXVol, MarketObject::EquityCurve, MarketObject::EquityVol,
+                                       MarketObject::CommodityCurve, MarketObject::CommodityVolatility,
+                                       MarketObject::Security, MarketObject::ZeroInflationCurve,
+                                       MarketObject::YoYInflationCurve, MarketObject::ZeroInflationCapFloorVol,
+                                       MarketObject::YoYInflationCapFloorVol, MarketObject::Correlation});
+    case KeyType::FXSpot: {
+        if (name.size() != 6)
+            return true;
+        string c1 = name.substr(0, 3), c2 = name.substr(3, 3);
+        return (c1 != baseCcy && ccys.count(c1) > 0) || (c2 != baseCcy && ccys.count(c2) > 0);
+    }
+    default:
+        return used(type, name, requests);
+    }
+}
+
+} // namespace
+
+std::set<std::pair<RiskFactorKey::KeyType, string>> tradeRiskFactors(const ScenarioSimMarket& simMarket,
+                                                                     const string& baseCcy, const Trade& trade,
+                                                                     const Requests& requests) {
+    Requests r = requests;
+    addFixingRequests(trade, r);
+    std::set<string> ccys = tradeCurrencies(r, trade.npvCurrency());
+    std::set<std::pair<KeyType, string>> result;
+    KeyType lastType = KeyType::None;
+    string lastName;
+    for (auto const& [key, quote] : simMarket.simData()) {
+        if (key.keytype == lastType && key.name == lastName)
+            continue;
+        lastType = key.keytype;
+        lastName = key.name;
+        if (usedByTrade(key.keytype, key.name, r, ccys, baseCcy))
+            result.insert(std::make_pair(key.keytype, key.name));
+    }
+    return result;
+}
+
+std::set<RiskFactorKey> unusedRiskFactors(const ScenarioSimMarket& simMarket,
+                                          const ScenarioSimMarketParameters& parameters, const Portfolio& portfolio) {
+    QL_REQUIRE(!simMarket.requests().empty(), "unusedRiskFactors(): no market requests recorded, enable the "
+                                              "recording on the sim market before building the portfolio");
+    Requests requests = simMarket.requests();
+    addFixingRequests(portfolio, requests);
+    for (auto const& i : parameters.additionalScenarioDataIndices())
+        requests.insert(std::make_pair(MarketObject::IndexCurve, i));
+
+    std::set<RiskFactorKey> unused;
+    // the keys are sorted by type and name, so we evaluate the usage once per name
+    KeyType lastType = KeyType::None;
+    string lastName;
+    bool lastUsed = true;
+    for (auto const& [key, quote] : simMarket.simData()) {
+        if (key.keytype != lastType || key.name != lastName) {
+            lastType = key.keytype;
+            lastName = key.name;
+            lastUsed = used(key.keytype, key.name, requests);
+        }
+        if (!lastUsed)
+            unused.insert(key);
+    }
+    return unused;
+}
+
+std::set<RiskFactorKey> pruneRiskFactors(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                         const ScenarioSimMarketParameters& parameters, const Portfolio& portfolio,
+                                         const boost::shared_ptr<Report>& report) {
+    std::set<RiskFactorKey> unused = unusedRiskFactors(*simMarket, parameters, portfolio);
+    if (!unused.empty())
+        simMarket->filter() = boost::make_shared<RiskFactorExclusionScenarioFilter>(unused, simMarket->filter());
+    LOG("pruneRiskFactors: " << unused.size() << " out of " << simMarket->simData().size()
+                             << " simulated risk factors are not used by the portfolio and excluded from the updates");
+
+    if (report) {
+        report->addColumn("RiskFactorType", string()).addColumn("Name", string()).addColumn("Keys", Size());
+        auto it = unused.begin();
+        while (it != unused.end()) {
+            auto type = it->keytype;
+            auto name = it->name;
+            Size n = 0;
+            for (; it != unused.end() && it->keytype == type && it->name == name; ++it)
+                ++n;
+            DLOG("pruneRiskFactors: dropped " << type << " " << name << " (" << n << " keys)");
+            report->next().add(ore::data::to_string(type)).add(name).add(n);
+        }
+        report->end();
+    }
+
+    return unused;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/scenario/riskfactorpruning.hpp
+    \brief Pruning of the simulated risk factors that are not used by a portfolio
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariosimmarket.hpp>
+
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/report/report.hpp>
+
+#include <set>
+
+namespace ore {
+namespace analytics {
+
+//! Risk factors of a sim market that a portfolio does not use
+/*! The usage is derived from the market objects requested from the sim market while the portfolio was built, see
+    ScenarioSimMarket::setRecordRequests(), and from the required fixings of the trades, which are projected from the
+    sim market during a simulation. The objects of the sim market are linked, e.g. an equity vol surface refers to the
+    equity spot and dividend curve, or an index curve to the swap indices built on it. A risk factor is therefore kept
+    if any request refers to it directly or to one of its dependants, where dependants are identified by name or, for
+    index curves, by currency.
+
+    A few risk factor types are never pruned: discount curves and FX spots (used for numeraires, base currency
+    conversions and collateral), credit states, survival weights and CPRs. Index curves and discount curves required
+    as aggregation scenario data are kept as well.
+
+    \ingroup scenario
+*/
+std::set<RiskFactorKey> unusedRiskFactors(const ScenarioSimMarket& simMarket,
+                                          const ScenarioSimMarketParameters& parameters,
+                                          const ore::data::Portfolio& portfolio);
+
+/*! The risk factor groups (key type and name) of a sim market that a single trade depends on, the trade level
+    counterpart of unusedRiskFactors(). The usage is derived from the market objects requested while the trade was
+    built, see ore::data::Portfolio::marketRequests(), and from the required fixings of the trade, with the same rules
+    as in unusedRiskFactors(). Discount curves and FX spots are attributed to the trade as well: a discount curve is
+    used if it is requested directly or if the trade requests an object which might be linked to discount curves in
+    the sim market, an FX spot is used if one of its currencies other than the base currency is the npv currency of the
+    trade or part of a requested FX spot, FX vol or discount curve. Credit states, survival weights and CPRs are
+    always attributed to the trade. */
+std::set<std::pair<RiskFactorKey::KeyType, std::string>>
+tradeRiskFactors(const ScenarioSimMarket& simMarket, const std::string& baseCcy, const ore::data::Trade& trade,
+                 const std::set<std::pair<ore::data::MarketObject, std::string>>& requests);
+
+/*! Exclude the unused risk factors from the scenario updates of \p simMarket by means of a
+    RiskFactorExclusionScenarioFilter on top of the current filter and return the excluded keys. If a report is given,
+    one row per risk factor type and name with the number of dropped keys is written. */
+std::set<RiskFactorKey> pruneRiskFactors(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                         const ScenarioSimMarketParameters& parameters,
+                                         const ore::data::Portfolio& portfolio,
+                                         const boost::shared_ptr<ore::data::Report>& report = nullptr);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <orea/scenario/scenariocache.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+// replays scenarios held in memory
+class InMemoryScenarioGenerator : public ScenarioGenerator {
+public:
+    explicit InMemoryScenarioGenerator(const boost::shared_ptr<const std::vector<boost::shared_ptr<Scenario>>>& s)
+        : scenarios_(s), i_(0) {}
+    boost::shared_ptr<Scenario> next(const Date& d) override {
+        QL_REQUIRE(i_ < scenarios_->size(), "ScenarioCache: no more cached scenarios");
+        const boost::shared_ptr<Scenario>& s = (*scenarios_)[i_++];
+        QL_REQUIRE(s->asof() == d, "ScenarioCache: incompatible date " << s->asof() << ", expected " << d);
+        return s;
+    }
+    void reset() override { i_ = 0; }
+
+private:
+    boost::shared_ptr<const std::vector<boost::shared_ptr<Scenario>>> scenarios_;
+    Size i_;
+};
+} // namespace
+
+void ScenarioCache::setSpillDirectory(const std::string& dir) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    spillDirectory_ = dir;
+}
+
+std::string ScenarioCache::spillDirectory() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return spillDirectory_;
+}
+
+std::string ScenarioCache::fileName(const std::string& key) const {
+    return (boost::filesystem::path(spillDirectory_) / ("scenarios_" + key + ".bin")).string();
+}
+
+bool ScenarioCache::has(const std::string& key) const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return scenarios_.find(key) != scenarios_.end() ||
+           (!spillDirectory_.empty() && boost::filesystem::exists(fileName(key)));
+}
+
+void ScenarioCache::add(const std::string& key, const std::vector<boost::shared_ptr<Scenario>>& scenarios) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    if (spillDirectory_.empty()) {
+        scenarios_[key] = boost::make_shared<const std::vector<boost::shared_ptr<Scenario>>>(scenarios);
+        DLOG("ScenarioCache: added " << scenarios.size() << " scenarios for key " << key);
+    } else {
+        // write to a temporary file first, so that an incomplete file is never picked up
+        std::string file = fileName(key), tmp = file + ".tmp";
+        {
+            BinaryScenarioFileWriter writer(tmp);
+            for (auto const& s : scenarios)
+                writer.writeScenario(s);
+        }
+        boost::filesystem::rename(tmp, file);
+        DLOG("ScenarioCache: spilled " << scenarios.size() << " scenarios for key " << key << " to " << file);
+    }
+}
+
+boost::shared_ptr<ScenarioGenerator> ScenarioCache::generator(const std::string& key) const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    auto s = scenarios_.find(key);
+    if (s != scenarios_.end())
+        return boost::make_shared<InMemoryScenarioGenerator>(s->second);
+    if (!spillDirectory_.empty() && boost::filesystem::exists(fileName(key)))
+        return boost::make_shared<BinaryScenarioGenerator>(fileName(key));
+    return nullptr;
+}
+
+void ScenarioCache::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    scenarios_.clear();
+}
+
+CachingScenarioGenerator::CachingScenarioGenerator(const boost::shared_ptr<ScenarioGenerator>& src,
+                                                   const std::string& key, Size size)
+    : src_(src), key_(key), size_(size), cached_(false) {
+    QL_REQUIRE(src_, "CachingScenarioGenerator: no ScenarioGenerator given");
+    QL_REQUIRE(size_ > 0, "CachingScenarioGenerator: size must be positive");
+    scenarios_.reserve(size_);
+}
+
+boost::shared_ptr<Scenario> CachingScenarioGenerator::next(const Date& d) {
+    boost::shared_ptr<Scenario> s = src_->next(d);
+    if (!cached_) {
+        scenarios_.push_back(s);
+        if (scenarios_.size() == size_) {
+            ScenarioCache::instance().add(key_, scenarios_);
+            scenarios_.clear();
+            scenarios_.shrink_to_fit();
+            cached_ = true;
+        }
+    }
+    return s;
+}
+
+void CachingScenarioGenerator::reset() {
+    src_->reset();
+    scenarios_.clear();
+}
+
+std::string scenarioCacheKey(const boost::shared_ptr<CrossAssetModel>& model,
+                             const boost::shared_ptr<ScenarioGeneratorData>& data,
+                             const boost::shared_ptr<ScenarioSimMarketParameters>& marketConfig, const Date& asof,
+                             const std::string& configuration) {
+    std::size_t seed = 0;
+
+    // calibrated model
+    for (Real p : model->params())
+        boost::hash_combine(seed, p);
+    const Matrix& c = model->correlation();
+    for (Size i = 0; i < c.rows(); ++i)
+        for (Size j = 0; j < c.columns(); ++j)
+            boost::hash_combine(seed, c[i][j]);
+
+    // initial curves on the simulation grid and spots
+    const TimeGrid& times = data->getGrid()->timeGrid();
+    for (Size j = 0; j < model->components(CrossAssetModel::AssetType::IR); ++j) {
+        boost::hash_combine(seed, model->parametrizations()[j]->currency().code());
+        for (Time t : times)
+            boost::hash_combine(seed, model->irModel(j)->termStructure()->discount(t));
+    }
+    for (Size k = 0; k < model->components(CrossAssetModel::AssetType::FX); ++k)
+        boost::hash_combine(seed, model->fxbs(k)->fxSpotToday()->value());
+    for (Size k = 0; k < model->components(CrossAssetModel::AssetType::EQ); ++k) {
+        boost::hash_combine(seed, model->eqbs(k)->name());
+        boost::hash_combine(seed, model->eqbs(k)->eqSpotToday()->value());
+    }
+
+    // configuration, the scenario generator data contain the seed, samples and grid
+    boost::hash_combine(seed, data->toXMLString());
+    boost::hash_combine(seed, marketConfig->toXMLString());
+    boost::hash_combine(seed, asof.serialNumber());
+    boost::hash_combine(seed, configuration);
+
+    std::ostringstream key;
+    key << std::hex << std::setw(2 * sizeof(std::size_t)) << std::setfill('0') << seed;
+    return key.str();
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/scenariocache.hpp
+    \brief Cache for generated scenarios shared between analytics
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/scenariogeneratordata.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+
+#include <qle/models/crossassetmodel.hpp>
+
+#include <ql/patterns/singleton.hpp>
+
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Store for generated scenario paths
+/*! The cache holds the complete set of scenarios (all samples, all dates) generated for a key, see
+    scenarioCacheKey(). The scenarios are kept in memory or, if a spill directory is set, written to a file in the
+    binary scenario format, see BinaryScenarioFileWriter. Files found in the spill directory are reused, so cached
+    scenarios are also available to later runs.
+
+    \ingroup scenario
+*/
+class ScenarioCache : public QuantLib::Singleton<ScenarioCache, std::integral_constant<bool, true>> {
+public:
+    //! Set the directory to spill the scenarios to, an empty string keeps them in memory
+    void setSpillDirectory(const std::string& dir);
+    std::string spillDirectory() const;
+
+    //! true if the scenarios for the key are cached
+    bool has(const std::string& key) const;
+
+    //! Store the scenarios for the key, ordered by sample, then date
+    void add(const std::string& key, const std::vector<boost::shared_ptr<Scenario>>& scenarios);
+
+    //! A generator replaying the cached scenarios for the key, or null if the key is not cached
+    boost::shared_ptr<ScenarioGenerator> generator(const std::string& key) const;
+
+    //! Remove all scenarios held in memory, spilled files are kept
+    void clear();
+
+private:
+    std::string fileName(const std::string& key) const;
+
+    std::map<std::string, boost::shared_ptr<const std::vector<boost::shared_ptr<Scenario>>>> scenarios_;
+    std::string spillDirectory_;
+    mutable boost::shared_mutex mutex_;
+};
+
+//! Scenario generator decorator adding the generated scenarios to the ScenarioCache
+/*! Once \p size scenarios are generated they are added to the cache under \p key. A reset before that discards the
+    recorded scenarios. The decorator is the cache counterpart of the ScenarioWriter.
+
+    \ingroup scenario
+*/
+class CachingScenarioGenerator : public ScenarioGenerator {
+public:
+    CachingScenarioGenerator(const boost::shared_ptr<ScenarioGenerator>& src, const std::string& key, Size size);
+
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+
+private:
+    boost::shared_ptr<ScenarioGenerator> src_;
+    std::string key_;
+    Size size_;
+    bool cached_;
+    std::vector<boost::shared_ptr<Scenario>> scenarios_;
+};
+
+/*! Key identifying the scenarios generated for a calibrated model and configuration. It is a hash of the model
+    parameters and correlations, the initial curves and spots of the model, the scenario generator data including
+    the seed, the simulation market parameters, the asof date and the market configuration. */
+std::string scenarioCacheKey(const boost::shared_ptr<QuantExt::CrossAssetModel>& model,
+                             const boost::shared_ptr<ScenarioGeneratorData>& data,
+                             const boost::shared_ptr<ScenarioSimMarketParameters>& marketConfig, const Date& asof,
+                             const std::string& configuration);
+
+} // namespace analytics
+} // namespace ore
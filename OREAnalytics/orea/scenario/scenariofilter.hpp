@@ -89,5 +89,24 @@ private:
     std::vector<ScenarioFilter> filters_;
 };
 
+//! Filter excluding a set of keys, all other keys are passed to an optional underlying filter
+class RiskFactorExclusionScenarioFilter : public ScenarioFilter {
+public:
+    explicit RiskFactorExclusionScenarioFilter(const std::set<RiskFactorKey>& excluded,
+                                               const boost::shared_ptr<ScenarioFilter>& underlying = nullptr)
+        : excluded_(excluded), underlying_(underlying) {}
+
+    bool allow(const RiskFactorKey& key) const override {
+        return excluded_.find(key) == excluded_.end() && (underlying_ == nullptr || underlying_->allow(key));
+    }
+
+    //! The excluded keys
+    const std::set<RiskFactorKey>& excluded() const { return excluded_; }
+
+private:
+    std::set<RiskFactorKey> excluded_;
+    boost::shared_ptr<ScenarioFilter> underlying_;
+};
+
 } // namespace analytics
 } // namespace oreplus
@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/scenariocache.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <ored/utilities/log.hpp>
@@ -49,11 +50,49 @@ ScenarioGeneratorBuilder::build(boost::shared_ptr<QuantExt::CrossAssetModel> mod
 
     QL_REQUIRE(initMarket != NULL, "ScenarioGeneratorBuilder: initMarket is null");
 
-    auto pathGen = pf->build(data_->sequenceType(), model->stateProcess(), data_->getGrid()->timeGrid(), data_->seed(),
-                             data_->ordering(), data_->directionIntegers());
+    std::string cacheKey;
+    if (useScenarioCache_) {
+        cacheKey = scenarioCacheKey(model, data_, marketConfig, asof, configuration);
+        if (auto cached = ScenarioCache::instance().generator(cacheKey)) {
+            LOG("ScenarioGeneratorBuilder: reuse cached scenarios for key " << cacheKey);
+            return cached;
+        }
+    }
 
-    return boost::make_shared<CrossAssetModelScenarioGenerator>(model, pathGen, scenarioFactory, marketConfig, asof,
-                                                                data_->getGrid(), initMarket, configuration);
+    boost::shared_ptr<ScenarioGenerator> generator;
+    if (data_->streamingPaths()) {
+        if (data_->conditionalCloseOut())
+            WLOG("ScenarioGeneratorBuilder: streaming paths bridge the close-out dates, conditional close-out is "
+                 "ignored");
+        if (data_->sequenceType() != QuantExt::MersenneTwister)
+            WLOG("ScenarioGeneratorBuilder: streaming paths use a Mersenne twister sequence, sequence type "
+                 << data_->sequenceType() << " is ignored");
+        auto streamingGen = boost::make_shared<QuantExt::StreamingMultiPathGenerator>(
+            model->stateProcess(), data_->getGrid()->timeGrid(), 1, data_->seed(),
+            CrossAssetModelScenarioGenerator::bridgedCloseOutDates(*data_->getGrid()));
+        generator = boost::make_shared<CrossAssetModelScenarioGenerator>(
+            model, streamingGen, scenarioFactory, marketConfig, asof, data_->getGrid(), initMarket, configuration);
+    } else if (data_->conditionalCloseOut()) {
+        // only the valuation dates are path steps, the close-out variates are drawn from a separate sequence
+        auto pathGen = pf->build(data_->sequenceType(), model->stateProcess(), data_->getGrid()->valuationTimeGrid(),
+                                 data_->seed(), data_->ordering(), data_->directionIntegers());
+        generator = boost::make_shared<CrossAssetModelScenarioGenerator>(model, pathGen, scenarioFactory, marketConfig,
+                                                                         asof, data_->getGrid(), initMarket,
+                                                                         configuration, true, data_->seed() + 1);
+    } else {
+        auto pathGen = pf->build(data_->sequenceType(), model->stateProcess(), data_->getGrid()->timeGrid(),
+                                 data_->seed(), data_->ordering(), data_->directionIntegers());
+        generator = boost::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, scenarioFactory, marketConfig, asof, data_->getGrid(), initMarket, configuration);
+    }
+
+    if (useScenarioCache_) {
+        LOG("ScenarioGeneratorBuilder: scenarios will be cached with key " << cacheKey);
+        generator = boost::make_shared<CachingScenarioGenerator>(generator, cacheKey,
+                                                                 data_->samples() * data_->getGrid()->dates().size());
+    }
+
+    return generator;
 }
 } // namespace analytics
 } // namespace ore
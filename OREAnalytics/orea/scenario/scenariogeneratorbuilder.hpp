@@ -49,6 +49,9 @@ using namespace QuantLib;
   - scenario factory
   - fixing method
 
+  If the scenario cache is used, the scenarios of a model and configuration that were generated before are replayed
+  from the ScenarioCache and newly generated scenarios are added to it, see CachingScenarioGenerator.
+
   \ingroup scenario
  */
 class ScenarioGeneratorBuilder {
@@ -57,7 +60,8 @@ public:
     ScenarioGeneratorBuilder() {}
 
     //! Constructor
-    ScenarioGeneratorBuilder(boost::shared_ptr<ScenarioGeneratorData> data) : data_(data) {}
+    ScenarioGeneratorBuilder(boost::shared_ptr<ScenarioGeneratorData> data, const bool useScenarioCache = false)
+        : data_(data), useScenarioCache_(useScenarioCache) {}
 
     //! Build function
     boost::shared_ptr<ScenarioGenerator>
@@ -69,6 +73,7 @@ public:
 
 private:
     boost::shared_ptr<ScenarioGeneratorData> data_;
+    bool useScenarioCache_ = false;
     boost::optional<std::set<std::string>> currencies_;
 };
 } // namespace analytics
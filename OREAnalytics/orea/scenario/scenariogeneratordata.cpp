@@ -142,6 +142,18 @@ void ScenarioGeneratorData::fromXML(XMLNode* root) {
             mporCashFlowMode_ = ScenarioGeneratorData::MporCashFlowMode::BothPay;
     }
 
+    streamingPaths_ = false;
+    if (auto n = XMLUtils::getChildNode(node, "StreamingPaths")) {
+        streamingPaths_ = parseBool(XMLUtils::getNodeValue(n));
+        LOG("ScenarioGeneratorData streaming paths = " << std::boolalpha << streamingPaths_);
+    }
+
+    conditionalCloseOut_ = false;
+    if (auto n = XMLUtils::getChildNode(node, "ConditionalCloseOut")) {
+        conditionalCloseOut_ = parseBool(XMLUtils::getNodeValue(n));
+        LOG("ScenarioGeneratorData conditional close-out = " << std::boolalpha << conditionalCloseOut_);
+    }
+
     LOG("ScenarioGeneratorData done.");
 }
 
@@ -174,6 +186,12 @@ XMLNode* ScenarioGeneratorData::toXML(XMLDocument& doc) {
     } else {
         XMLUtils::addChild(doc, pNode, "MporMode", "ActualDate");
     }
+    if (streamingPaths_) {
+        XMLUtils::addChild(doc, pNode, "StreamingPaths", streamingPaths_);
+    }
+    if (conditionalCloseOut_) {
+        XMLUtils::addChild(doc, pNode, "ConditionalCloseOut", conditionalCloseOut_);
+    }
 
     return node;
 }
@@ -57,7 +57,8 @@ public:
     ScenarioGeneratorData()
         : grid_(boost::make_shared<DateGrid>()), sequenceType_(SobolBrownianBridge), seed_(0), samples_(0),
           ordering_(SobolBrownianGenerator::Steps), directionIntegers_(SobolRsg::JoeKuoD7), withCloseOutLag_(false),
-          withMporStickyDate_(false), mporCashFlowMode_(MporCashFlowMode::BothPay) {}
+          withMporStickyDate_(false), mporCashFlowMode_(MporCashFlowMode::BothPay), streamingPaths_(false),
+          conditionalCloseOut_(false) {}
 
     //! Constructor
     ScenarioGeneratorData(boost::shared_ptr<DateGrid> dateGrid, SequenceType sequenceType, long seed, Size samples,
@@ -65,7 +66,8 @@ public:
                           SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7,
                           bool withCloseOutLag = false, bool withMporStickyDate = false, MporCashFlowMode mporCashFlowMode = MporCashFlowMode::BothPay)
         : sequenceType_(sequenceType), seed_(seed), samples_(samples), ordering_(ordering),
-          directionIntegers_(directionIntegers), withCloseOutLag_(false), withMporStickyDate_(false), mporCashFlowMode_(mporCashFlowMode) {
+          directionIntegers_(directionIntegers), withCloseOutLag_(false), withMporStickyDate_(false), mporCashFlowMode_(mporCashFlowMode),
+          streamingPaths_(false), conditionalCloseOut_(false) {
         setGrid(dateGrid);
     }
 
@@ -90,6 +92,12 @@ public:
     bool withMporStickyDate() const { return withMporStickyDate_; }
     Period closeOutLag() const { return closeOutLag_; }
     MporCashFlowMode mporCashFlowMode() const {  return mporCashFlowMode_; }
+    /*! If true, the paths are generated date by date using a StreamingMultiPathGenerator and close-out dates that
+        are not valuation dates are filled using a Brownian bridge */
+    bool streamingPaths() const { return streamingPaths_; }
+    /*! If true, only the valuation dates are simulated as path steps and the states on close-out dates that are not
+        valuation dates are sampled given the state on the preceding valuation date */
+    bool conditionalCloseOut() const { return conditionalCloseOut_; }
     //@}
 
     //! \name Setters
@@ -104,6 +112,8 @@ public:
     bool& withMporStickyDate() { return withMporStickyDate_; }
     Period& closeOutLag() { return closeOutLag_; }
     MporCashFlowMode& mporCashFlowMode() {  return mporCashFlowMode_; }
+    bool& streamingPaths() { return streamingPaths_; }
+    bool& conditionalCloseOut() { return conditionalCloseOut_; }
     //@}
 private:
     boost::shared_ptr<DateGrid> grid_;
@@ -117,6 +127,8 @@ private:
     bool withMporStickyDate_;
     Period closeOutLag_;
     MporCashFlowMode mporCashFlowMode_;
+    bool streamingPaths_;
+    bool conditionalCloseOut_;
     string gridString_;
 };
 
@@ -23,6 +23,7 @@
 
 #include <orea/engine/observationmode.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/deltascenario.hpp>
 #include <orea/scenario/simplescenario.hpp>
 #include <qle/termstructures/credit/basecorrelationstructure.hpp>
 #include <qle/termstructures/proxyoptionletvolatility.hpp>
@@ -54,6 +55,7 @@
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <qle/indexes/fallbackiborindex.hpp>
 #include <qle/indexes/fallbackovernightindex.hpp>
 #include <qle/indexes/inflationindexobserver.hpp>
@@ -61,6 +63,8 @@
 #include <qle/instruments/makeoiscapfloor.hpp>
 #include <qle/termstructures/blackvariancesurfacestddevs.hpp>
 #include <qle/termstructures/blackvolconstantspread.hpp>
+#include <qle/termstructures/cachedoptionletvolatility.hpp>
+#include <qle/termstructures/cachedswaptionvolatility.hpp>
 #include <qle/termstructures/credit/spreadedbasecorrelationcurve.hpp>
 #include <qle/termstructures/dynamicblackvoltermstructure.hpp>
 #include <qle/termstructures/dynamiccpivolatilitystructure.hpp>
@@ -93,6 +97,7 @@
 #include <qle/termstructures/commoditybasispricecurvewrapper.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/timer/timer.hpp>
 
 using namespace QuantLib;
@@ -131,6 +136,13 @@ void processException(bool continueOnError, const std::exception& e, const std::
         QL_FAIL("Object with CurveID '" << curve << "' failed to build in scenario sim market: " << e.what());
     }
 }
+
+// combine the hash of a risk factor key into seed, used to validate the binding of scenario keys to the sim data
+void hashRiskFactorKey(std::size_t& seed, const ore::analytics::RiskFactorKey& key) {
+    boost::hash_combine(seed, static_cast<int>(key.keytype));
+    boost::hash_combine(seed, key.name);
+    boost::hash_combine(seed, key.index);
+}
 } // namespace
 
 namespace ore {
@@ -833,6 +845,10 @@ ScenarioSimMarket::ScenarioSimMarket(
                             svp = Handle<SwaptionVolatilityStructure>(svolp);
                         }
 
+                        if (parameters->swapVolCacheLookups())
+                            svp = Handle<SwaptionVolatilityStructure>(
+                                boost::make_shared<QuantExt::CachedSwaptionVolatility>(svp));
+
                         svp->enableExtrapolation(); // FIXME
 
                         DLOG("Simulation market " << name << " yield volatility type = " << svp->volatilityType());
@@ -1076,6 +1092,10 @@ ScenarioSimMarket::ScenarioSimMarket(
                             hCapletVol = Handle<OptionletVolatilityStructure>(capletVol);
                         }
 
+                        if (parameters->capFloorVolCacheLookups())
+                            hCapletVol = Handle<OptionletVolatilityStructure>(
+                                boost::make_shared<QuantExt::CachedOptionletVolatility>(hCapletVol));
+
                         hCapletVol->enableExtrapolation();
                         capFloorCurves_.emplace(std::piecewise_construct,
                                                 std::forward_as_tuple(Market::defaultConfiguration, name),
@@ -2713,6 +2733,12 @@ bool ScenarioSimMarket::addSwapIndexToSsm(const std::string& indexName, const bo
     }
 }
 
+void ScenarioSimMarket::require(const MarketObject o, const string& name, const string&, const bool) const {
+    // all objects are built upfront, we only record the request if required
+    if (recordRequests_)
+        requests_.insert(std::make_pair(o, name));
+}
+
 void ScenarioSimMarket::reset() {
     auto filterBackup = filter_;
     // no filter
@@ -2722,9 +2748,10 @@ void ScenarioSimMarket::reset() {
     // reset numeraire and label
     numeraire_ = baseScenario_->getNumeraire();
     label_ = baseScenario_->label();
-    // delete the sim data cache
-    cachedSimData_.clear();
-    cachedSimDataActive_.clear();
+    // delete the bindings of the scenario keys to the sim data
+    compactKeys_.reset();
+    boundKeys_.clear();
+    boundDeltaApplied_ = false;
     // reset term structures
     applyScenario(baseScenario_);
     // see the comment in update() for why this is necessary...
@@ -2740,79 +2767,178 @@ void ScenarioSimMarket::reset() {
 
 void ScenarioSimMarket::applyScenario(const boost::shared_ptr<Scenario>& scenario) {
 
+    TraceSpan span("simmarket", "ScenarioSimMarket::applyScenario");
+    span.arg("label", scenario->label());
+
     currentScenario_ = scenario;
 
-    // apply scenario based on cached indices for simData_ for a SimpleScenario
-    // this assumes that all scenarios have an identical key structure in their data map
+    // optionally attribute the time spent in setting the quotes to the risk factor types, the clock is only read
+    // when the key type changes, which is rare since the keys are grouped by type
 
-    if (cacheSimData_) {
-        if (auto s = boost::dynamic_pointer_cast<SimpleScenario>(scenario)) {
+    boost::timer::cpu_timer timer;
+    boost::timer::cpu_times lastTimes{0, 0, 0};
+    RiskFactorKey::KeyType lastType = RiskFactorKey::KeyType::None;
+    auto recordTiming = [this, &timer, &lastTimes, &lastType](const RiskFactorKey::KeyType type) {
+        if (type == lastType)
+            return;
+        boost::timer::cpu_times times = timer.elapsed();
+        if (lastType != RiskFactorKey::KeyType::None) {
+            auto& t = updateTimings_.insert(std::make_pair(lastType, boost::timer::cpu_times{0, 0, 0})).first->second;
+            t.wall += times.wall - lastTimes.wall;
+            t.user += times.user - lastTimes.user;
+            t.system += times.system - lastTimes.system;
+        }
+        lastTimes = times;
+        lastType = type;
+    };
+
+    // the delta scenario path below relies on the quotes being in the state of the previous delta scenario
+    bool previousWasDelta = boundDeltaApplied_;
+    boundDeltaApplied_ = false;
+
+    // apply a compact scenario by position, the binding to the simData_ quotes is built once per key table
+
+    if (auto s = boost::dynamic_pointer_cast<CompactScenario>(scenario)) {
+        if (s->keyTable() != compactKeys_ || filter_ != compactFilter_) {
+            compactKeys_.reset();
+            bindScenarioKeys(s->keyTable()->keys(), compactSimData_);
+            compactKeys_ = s->keyTable();
+            compactFilter_ = filter_;
+        }
+        const std::vector<Real>& values = s->values();
+        for (Size i = 0; i < values.size(); ++i) {
+            if (collectUpdateTimings_)
+                recordTiming(compactKeys_->keys()[i].keytype);
+            if (compactSimData_[i] && values[i] != Null<Real>())
+                compactSimData_[i]->setValue(values[i]);
+        }
+        if (collectUpdateTimings_)
+            recordTiming(RiskFactorKey::KeyType::None);
+        return;
+    }
 
-            // fill cache
+    // all other scenarios are applied by position as well, the keys are bound to the simData_ quotes once and the
+    // binding is revalidated by a hash of the keys; simple scenarios are bound in the order of their data map, which
+    // avoids the lookup of the values, all other scenarios in the order of their keys
 
-            if (cachedSimData_.empty()) {
-                Size count = 0;
-                for (auto const& d : s->data()) {
-                    auto it = simData_.find(d.first);
-                    if (it == simData_.end()) {
-                        WLOG("simulation data point missing for key " << d.first);
-                        cachedSimData_.push_back(boost::shared_ptr<SimpleQuote>());
-                        cachedSimDataActive_.push_back(false);
-                    } else {
-                        ++count;
-                        cachedSimData_.push_back(it->second);
-                        cachedSimDataActive_.push_back(filter_->allow(d.first));
-                    }
-                }
-                if (count != simData_.size() && !allowPartialScenarios_) {
-                    ALOG("mismatch between scenario and sim data size, " << count << " vs " << simData_.size());
-                    for (auto it : simData_) {
-                        if (!scenario->has(it.first))
-                            WLOG("Key " << it.first << " missing in scenario");
-                    }
-                    QL_FAIL("mismatch between scenario and sim data size, exit.");
-                }
-            }
+    auto simple = boost::dynamic_pointer_cast<SimpleScenario>(scenario);
+    auto delta = boost::dynamic_pointer_cast<DeltaScenario>(scenario);
 
-            // apply scenario data according to cached indices
+    std::size_t hash = 0;
+    Size size = 0;
+    if (simple) {
+        for (auto const& d : simple->data()) {
+            hashRiskFactorKey(hash, d.first);
+            ++size;
+        }
+    } else {
+        for (auto const& k : scenario->keys())
+            hashRiskFactorKey(hash, k);
+        size = scenario->keys().size();
+    }
 
-            Size i = 0;
-            for (auto const& q : s->data()) {
-                if (cachedSimDataActive_[i])
-                    cachedSimData_[i]->setValue(q.second);
-                ++i;
-            }
+    if (hash != boundKeysHash_ || size != boundKeys_.size() || filter_ != boundFilter_ || boundKeys_.empty()) {
+        boundKeys_.clear();
+        boundKeysIndex_.clear();
+        boundBaseScenario_.reset();
+        if (simple) {
+            for (auto const& d : simple->data())
+                boundKeys_.push_back(d.first);
+        } else {
+            boundKeys_ = scenario->keys();
+        }
+        bindScenarioKeys(boundKeys_, boundSimData_);
+        for (Size i = 0; i < boundKeys_.size(); ++i)
+            boundKeysIndex_[boundKeys_[i]] = i;
+        boundKeysHash_ = hash;
+        boundFilter_ = filter_;
+        previousWasDelta = false;
+    }
 
+    auto setValue = [this, &recordTiming](const Size i, const Real value) {
+        if (!boundSimData_[i])
             return;
+        if (collectUpdateTimings_)
+            recordTiming(boundKeys_[i].keytype);
+        boundSimData_[i]->setValue(value);
+    };
+
+    if (simple) {
+        Size i = 0;
+        for (auto const& d : simple->data())
+            setValue(i++, d.second);
+    } else if (delta) {
+        // the values of the base scenario are cached, only the keys of the delta are looked up
+        if (delta->baseScenario() != boundBaseScenario_) {
+            boundBaseScenario_ = delta->baseScenario();
+            boundBaseValues_.resize(boundKeys_.size());
+            for (Size i = 0; i < boundKeys_.size(); ++i)
+                boundBaseValues_[i] = boundBaseScenario_->get(boundKeys_[i]);
+            previousWasDelta = false;
+        }
+        std::vector<std::pair<Size, Real>> shifts;
+        for (auto const& k : delta->delta()->keys()) {
+            auto it = boundKeysIndex_.find(k);
+            if (it != boundKeysIndex_.end())
+                shifts.push_back(std::make_pair(it->second, delta->delta()->get(k)));
+        }
+        // defer the notifications until all quotes are set, so that each observer is notified once only, unless the
+        // updates are disabled or deferred already (see preUpdate())
+        bool defer = ObservableSettings::instance().updatesEnabled();
+        if (defer)
+            ObservableSettings::instance().disableUpdates(true);
+        if (previousWasDelta) {
+            // the quotes are in the state of the previous delta scenario on the same base, so we only reset the
+            // quotes shifted there and not here to the base values and set the shifts of this scenario
+            for (auto const& [i, v] : boundShifts_) {
+                if (std::find_if(shifts.begin(), shifts.end(),
+                                 [i = i](const std::pair<Size, Real>& s) { return s.first == i; }) == shifts.end())
+                    setValue(i, boundBaseValues_[i]);
+            }
+            for (auto const& [i, v] : shifts)
+                setValue(i, v);
+        } else {
+            boundValues_ = boundBaseValues_;
+            for (auto const& [i, v] : shifts)
+                boundValues_[i] = v;
+            for (Size i = 0; i < boundValues_.size(); ++i)
+                setValue(i, boundValues_[i]);
+        }
+        if (defer)
+            ObservableSettings::instance().enableUpdates();
+        boundShifts_ = std::move(shifts);
+        boundDeltaApplied_ = true;
+    } else {
+        for (Size i = 0; i < boundKeys_.size(); ++i) {
+            if (boundSimData_[i])
+                setValue(i, scenario->get(boundKeys_[i]));
         }
     }
+    if (collectUpdateTimings_)
+        recordTiming(RiskFactorKey::KeyType::None);
+}
 
-    const vector<RiskFactorKey>& keys = scenario->keys();
-
-    Size count = 0;
-    for (const auto& key : keys) {
-        // Loop through the scenario keys and check which keys are present in simData_,
-        // adding to the count when a match is identified
-        // Then check that the count=simData_.size - this ensures that simData_ is a valid
-        // subset of the scenario - fails is a member of simData is not present in the
-        // scenario
-        auto it = simData_.find(key);
+void ScenarioSimMarket::bindScenarioKeys(const std::vector<RiskFactorKey>& keys,
+                                         std::vector<boost::shared_ptr<SimpleQuote>>& quotes) const {
+    quotes.assign(keys.size(), boost::shared_ptr<SimpleQuote>());
+    std::set<RiskFactorKey> found;
+    for (Size i = 0; i < keys.size(); ++i) {
+        auto it = simData_.find(keys[i]);
         if (it == simData_.end()) {
-            WLOG("simulation data point missing for key " << key);
+            WLOG("simulation data point missing for key " << keys[i]);
         } else {
-            if (filter_->allow(key)) {
-                it->second->setValue(scenario->get(key));
-            }
-            count++;
+            found.insert(keys[i]);
+            if (filter_->allow(keys[i]))
+                quotes[i] = it->second;
         }
     }
-
-    if (count != simData_.size() && !allowPartialScenarios_) {
-        ALOG("mismatch between scenario and sim data size, " << count << " vs " << simData_.size());
+    if (found.size() != simData_.size() && !allowPartialScenarios_) {
+        ALOG("mismatch between scenario and sim data size, " << found.size() << " vs " << simData_.size());
         for (auto it : simData_) {
-            if (!scenario->has(it.first))
+            if (found.find(it.first) == found.end())
                 ALOG("Key " << it.first << " missing in scenario");
         }
+        quotes.clear();
         QL_FAIL("mismatch between scenario and sim data size, exit.");
     }
 }
@@ -2826,6 +2952,9 @@ void ScenarioSimMarket::preUpdate() {
 }
 
 void ScenarioSimMarket::updateDate(const Date& d) {
+    TraceSpan span("simmarket", "ScenarioSimMarket::updateDate");
+    if (span.active())
+        span.arg("date", ore::data::to_string(d));
     ObservationMode::Mode om = ObservationMode::instance().mode();
     if (d != Settings::instance().evaluationDate())
         Settings::instance().evaluationDate() = d;
@@ -2842,6 +2971,9 @@ void ScenarioSimMarket::updateDate(const Date& d) {
 }
 
 void ScenarioSimMarket::updateScenario(const Date& d) {
+    TraceSpan span("simmarket", "ScenarioSimMarket::updateScenario");
+    if (span.active())
+        span.arg("date", ore::data::to_string(d));
     QL_REQUIRE(scenarioGenerator_ != nullptr, "ScenarioSimMarket::update: no scenario generator set");
     auto scenario = scenarioGenerator_->next(d);
     QL_REQUIRE(scenario->asof() == d,
@@ -2852,6 +2984,9 @@ void ScenarioSimMarket::updateScenario(const Date& d) {
 }
 
 void ScenarioSimMarket::postUpdate(const Date& d, bool withFixings) {
+    TraceSpan span("simmarket", "ScenarioSimMarket::postUpdate");
+    if (span.active())
+        span.arg("date", ore::data::to_string(d));
     ObservationMode::Mode om = ObservationMode::instance().mode();
 
     // Observation Mode - key to update these before fixings are set
@@ -2868,6 +3003,7 @@ void ScenarioSimMarket::postUpdate(const Date& d, bool withFixings) {
 }
 
 void ScenarioSimMarket::updateAsd(const Date& d) {
+    TraceSpan span("simmarket", "ScenarioSimMarket::updateAsd");
     if (asd_) {
         // add additional scenario data to the given container, if required
         for (auto i : parameters_->additionalScenarioDataIndices()) {
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <orea/scenario/compactscenario.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
@@ -31,6 +32,8 @@
 #include <ored/configuration/curveconfigurations.hpp>
 #include <ored/configuration/iborfallbackconfig.hpp>
 #include <ql/quotes/all.hpp>
+
+#include <boost/timer/timer.hpp>
 #include <ql/termstructures/credit/defaultprobabilityhelpers.hpp>
 #include <ql/termstructures/volatility/inflation/yoyinflationoptionletvolatilitystructure.hpp>
 #include <qle/termstructures/averageoisratehelper.hpp>
@@ -82,6 +85,7 @@
 #include <qle/termstructures/zeroinflationcurveobserverstatic.hpp>
 
 #include <map>
+#include <set>
 
 namespace ore {
 namespace analytics {
@@ -110,8 +114,12 @@ public:
 /*! If useSpreadedTermStructures is true, spreaded term structures over the initMarket for supported risk factors will
   be generated. This is used by the SensitivityScenarioGenerator.
 
-  If cacheSimData is true, the scenario application is optimised. This requires that all scenarios are SimpleScenario
-  instances with identical key structure in their data.
+  Scenarios are applied by position: the scenario keys are bound to the simData_ quotes once, CompactScenario
+  instances per key table, all other scenarios per key set, which is revalidated by a hash of the keys for each
+  scenario. For DeltaScenario instances the values of the base scenario are cached in addition, and if the previous
+  scenario was a DeltaScenario on the same base, only the quotes that differ between the two scenarios are set, with
+  the observer notifications deferred until all of them are updated. The cacheSimData flag is not required for this
+  any more and kept for backwards compatibility only.
 
   If allowPartialScenarios is true, the check that all simData_ is touched by a scenario is disabled.
  */
@@ -184,8 +192,44 @@ public:
     //! is risk factor key simulated by this sim market instance?
     virtual bool isSimulated(const RiskFactorKey::KeyType& factor) const;
 
+    //! Simulated market data quotes by risk factor key
+    const std::map<RiskFactorKey, boost::shared_ptr<SimpleQuote>>& simData() const { return simData_; }
+
+    //! The parameters the sim market was built from
+    const boost::shared_ptr<ScenarioSimMarketParameters>& parameters() const { return parameters_; }
+
+    //! Enable collecting the time spent in applying scenarios by risk factor type
+    void setCollectUpdateTimings(const bool b) { collectUpdateTimings_ = b; }
+    /*! Cumulated time spent in applying scenarios by risk factor type, this includes the propagation of notifications
+      to the observers of the updated quotes if these are not deferred or disabled by the ObservationMode */
+    const std::map<RiskFactorKey::KeyType, boost::timer::cpu_times>& updateTimings() const { return updateTimings_; }
+
+    /*! Enable recording the market objects requested from this market, e.g. while a portfolio is built against it,
+      see pruneRiskFactors() */
+    void setRecordRequests(const bool b) { recordRequests_ = b; }
+    //! The recorded market object requests, the names are those passed to require() by the market accessors
+    const std::set<std::pair<MarketObject, std::string>>& requests() const { return requests_; }
+    //! Clear the recorded market object requests
+    void clearRequests() { requests_.clear(); }
+
+    //! \name Market request recording interface
+    //@{
+    bool recordingRequests() const override { return recordRequests_; }
+    std::set<std::pair<MarketObject, std::string>> recordedRequests() const override { return requests_; }
+    void setRecordedRequests(const std::set<std::pair<MarketObject, std::string>>& requests) override {
+        requests_ = requests;
+    }
+    //@}
+
 protected:
+    void require(const MarketObject o, const string& name, const string& configuration,
+                 const bool forceBuild = false) const override;
+
     virtual void applyScenario(const boost::shared_ptr<Scenario>& scenario);
+    /*! bind the keys to the simData_ quotes by position, the quote is null for keys that are not simulated or excluded
+      by the filter, throws if the keys do not cover the sim data unless partial scenarios are allowed */
+    void bindScenarioKeys(const std::vector<RiskFactorKey>& keys,
+                          std::vector<boost::shared_ptr<SimpleQuote>>& quotes) const;
 
     void writeSimData(std::map<RiskFactorKey, boost::shared_ptr<SimpleQuote>>& simDataTmp,
                       std::map<RiskFactorKey, Real>& absoluteSimDataTmp);
@@ -215,8 +259,23 @@ protected:
     boost::shared_ptr<Scenario> baseScenario_;
     boost::shared_ptr<Scenario> baseScenarioAbsolute_;
 
-    std::vector<boost::shared_ptr<SimpleQuote>> cachedSimData_;
-    std::vector<bool> cachedSimDataActive_;
+    // binding of the key table of compact scenarios to the simData_ quotes
+    boost::shared_ptr<const CompactScenarioKeys> compactKeys_;
+    boost::shared_ptr<ScenarioFilter> compactFilter_;
+    std::vector<boost::shared_ptr<SimpleQuote>> compactSimData_;
+
+    // binding of the keys of all other scenarios to the simData_ quotes, validated by the hash of the keys
+    std::size_t boundKeysHash_ = 0;
+    boost::shared_ptr<ScenarioFilter> boundFilter_;
+    std::vector<RiskFactorKey> boundKeys_;
+    std::map<RiskFactorKey, Size> boundKeysIndex_;
+    std::vector<boost::shared_ptr<SimpleQuote>> boundSimData_;
+    // cached values of the base scenario of delta scenarios
+    boost::shared_ptr<Scenario> boundBaseScenario_;
+    std::vector<Real> boundBaseValues_, boundValues_;
+    // true if the last scenario was applied as a delta scenario, then boundShifts_ holds its deviations from the base
+    bool boundDeltaApplied_ = false;
+    std::vector<std::pair<Size, Real>> boundShifts_;
 
     std::set<RiskFactorKey::KeyType> nonSimulatedFactors_;
 
@@ -230,6 +289,12 @@ protected:
     IborFallbackConfig iborFallbackConfig_;
 
     mutable boost::shared_ptr<Scenario> currentScenario_;
+
+    bool collectUpdateTimings_ = false;
+    std::map<RiskFactorKey::KeyType, boost::timer::cpu_times> updateTimings_;
+
+    bool recordRequests_ = false;
+    mutable std::set<std::pair<MarketObject, std::string>> requests_;
 };
 } // namespace analytics
 } // namespace ore
@@ -656,7 +656,8 @@ bool ScenarioSimMarketParameters::operator==(const ScenarioSimMarketParameters&
         extrapolation_ != rhs.extrapolation_ || swapVolTerms_ != rhs.swapVolTerms_ ||
         swapVolIsCube_ != rhs.swapVolIsCube_ || swapVolSimulateATMOnly_ != rhs.swapVolSimulateATMOnly_ ||
         swapVolExpiries_ != rhs.swapVolExpiries_ || swapVolStrikeSpreads_ != rhs.swapVolStrikeSpreads_ ||
-        swapVolDecayMode_ != rhs.swapVolDecayMode_ || capFloorVolExpiries_ != rhs.capFloorVolExpiries_ ||
+        swapVolDecayMode_ != rhs.swapVolDecayMode_ || swapVolCacheLookups_ != rhs.swapVolCacheLookups_ ||
+        capFloorVolExpiries_ != rhs.capFloorVolExpiries_ || capFloorVolCacheLookups_ != rhs.capFloorVolCacheLookups_ ||
         capFloorVolStrikes_ != rhs.capFloorVolStrikes_ ||
         zeroInflationCapFloorVolExpiries_ != rhs.zeroInflationCapFloorVolExpiries_ ||
         zeroInflationCapFloorVolStrikes_ != rhs.zeroInflationCapFloorVolStrikes_ ||
@@ -883,6 +884,8 @@ void ScenarioSimMarketParameters::fromXML(XMLNode* root) {
         if (atmOnlyNode)
             swapVolSimulateATMOnly_ = XMLUtils::getChildValueAsBool(nodeChild, "SimulateATMOnly", true);
 
+        swapVolCacheLookups_ = XMLUtils::getChildValueAsBool(nodeChild, "CacheLookups", false, false);
+
         if (!swapVolSimulateATMOnly_) {
             vector<XMLNode*> spreadNodes = XMLUtils::getChildrenNodes(nodeChild, "StrikeSpreads");
             if (spreadNodes.size() > 0) {
@@ -1065,6 +1068,8 @@ void ScenarioSimMarketParameters::fromXML(XMLNode* root) {
             capFloorVolUseCapAtm_ = parseBool(XMLUtils::getNodeValue(n));
         }
 
+        capFloorVolCacheLookups_ = XMLUtils::getChildValueAsBool(nodeChild, "CacheLookups", false, false);
+
         // Get smile dynamics
         vector<XMLNode*> smileDynamicsNodes = XMLUtils::getChildrenNodes(nodeChild, "SmileDynamics");
         for (XMLNode* smileDynamicsNode : smileDynamicsNodes) {
@@ -1668,6 +1673,8 @@ XMLNode* ScenarioSimMarketParameters::toXML(XMLDocument& doc) {
         for (auto it = swapVolSmileDynamics_.begin(); it != swapVolSmileDynamics_.end(); it++) {
             XMLUtils::addChild(doc, swaptionVolatilitiesNode, "SmileDynamics", it->second, "key", it->first);
         }
+        if (swapVolCacheLookups_)
+            XMLUtils::addChild(doc, swaptionVolatilitiesNode, "CacheLookups", swapVolCacheLookups_);
     }
 
     // yield volatilities
@@ -1720,6 +1727,8 @@ XMLNode* ScenarioSimMarketParameters::toXML(XMLDocument& doc) {
         for (auto it = capFloorVolSmileDynamics_.begin(); it != capFloorVolSmileDynamics_.end(); it++) {
             XMLUtils::addChild(doc, capFloorVolatilitiesNode, "SmileDynamics", it->second, "key", it->first);
         }
+        if (capFloorVolCacheLookups_)
+            XMLUtils::addChild(doc, capFloorVolatilitiesNode, "CacheLookups", capFloorVolCacheLookups_);
     }
 
     // zero inflation cap/floor volatilities
@@ -49,7 +49,8 @@ public:
     //! Default constructor
     ScenarioSimMarketParameters()
         : swapVolIsCube_({{"", false}}), swapVolSimulateATMOnly_(false), swapVolStrikeSpreads_({{"", {0.0}}}),
-          capFloorVolAdjustOptionletPillars_(false), capFloorVolUseCapAtm_(false), cprSimulate_(false),
+          swapVolCacheLookups_(false), capFloorVolAdjustOptionletPillars_(false), capFloorVolUseCapAtm_(false),
+          capFloorVolCacheLookups_(false), cprSimulate_(false),
           correlationIsSurface_(false), correlationStrikes_({0.0}) {
         setDefaults();
     }
@@ -88,6 +89,10 @@ public:
     const string& swapVolDecayMode() const { return swapVolDecayMode_; }
     const vector<Real>& swapVolStrikeSpreads(const string& key) const;
     const string& swapVolSmileDynamics(const string& key) const;
+    /*! If \c true, the simulation market swaption volatility structures cache the volatilities looked up by the
+        pricing engines until the next scenario is applied.
+    */
+    bool swapVolCacheLookups() const { return swapVolCacheLookups_; }
 
     bool simulateYieldVols() const { return paramsSimulate(RiskFactorKey::KeyType::YieldVolatility); }
     const vector<Period>& yieldVolTerms() const { return yieldVolTerms_; }
@@ -112,6 +117,10 @@ public:
         volatility structure at the configured expiries. Otherwise, use the index forward rate.
     */
     bool capFloorVolUseCapAtm() const { return capFloorVolUseCapAtm_; }
+    /*! If \c true, the simulation market optionlet volatility structures cache the volatilities looked up by the
+        pricing engines until the next scenario is applied.
+    */
+    bool capFloorVolCacheLookups() const { return capFloorVolCacheLookups_; }
     const string& capFloorVolSmileDynamics(const string& key) const;
 
     bool simulateYoYInflationCapFloorVols() const {
@@ -262,6 +271,7 @@ public:
     void setSwapVolStrikeSpreads(const std::string& key, const std::vector<QuantLib::Rate>& strikes);
     string& swapVolDecayMode() { return swapVolDecayMode_; }
     void setSwapVolSmileDynamics(const string& key, const string& smileDynamics);
+    void setSwapVolCacheLookups(bool swapVolCacheLookups) { swapVolCacheLookups_ = swapVolCacheLookups; }
   
     void setSimulateYieldVols(bool simulate);
     vector<Period>& yieldVolTerms() { return yieldVolTerms_; }
@@ -282,6 +292,9 @@ public:
     void setCapFloorVolUseCapAtm(bool capFloorVolUseCapAtm) {
         capFloorVolUseCapAtm_ = capFloorVolUseCapAtm;
     }
+    void setCapFloorVolCacheLookups(bool capFloorVolCacheLookups) {
+        capFloorVolCacheLookups_ = capFloorVolCacheLookups;
+    }
     void setCapFloorVolSmileDynamics(const string& key, const string& smileDynamics);
 
     void setSimulateYoYInflationCapFloorVols(bool simulate);
@@ -424,6 +437,7 @@ private:
     map<string, vector<Real>> swapVolStrikeSpreads_;
     string swapVolDecayMode_;
     map<string, string> swapVolSmileDynamics_;
+    bool swapVolCacheLookups_;
 
     vector<Period> yieldVolTerms_;
     vector<Period> yieldVolExpiries_;
@@ -436,6 +450,7 @@ private:
     string capFloorVolDecayMode_;
     bool capFloorVolAdjustOptionletPillars_;
     bool capFloorVolUseCapAtm_;
+    bool capFloorVolCacheLookups_;
     map<string, string> capFloorVolSmileDynamics_;
 
     map<string, vector<Period>> yoyInflationCapFloorVolExpiries_;
@@ -454,6 +454,11 @@ void SensitivityScenarioData::fromXML(XMLNode* root) {
         }
     }
 
+    if (auto n = XMLUtils::getChildNode(node, "CrossGammaMaterialityThreshold"))
+        crossGammaMaterialityThreshold_ = parseReal(XMLUtils::getNodeValue(n));
+    else
+        crossGammaMaterialityThreshold_ = Null<Real>();
+
     LOG("Get compute gamma flag");
     computeGamma_ = XMLUtils::getChildValueAsBool(node, "ComputeGamma", false); // defaults to true
 
@@ -463,6 +468,12 @@ void SensitivityScenarioData::fromXML(XMLNode* root) {
     else
         useSpreadedTermStructures_ = false;
 
+    LOG("Get lazyScenarioGeneration flag");
+    if (auto n = XMLUtils::getChildNode(node, "LazyScenarioGeneration"))
+        lazyScenarioGeneration_ = parseBool(XMLUtils::getNodeValue(n));
+    else
+        lazyScenarioGeneration_ = false;
+
     DLOG("Get TwoSidedDeltaKeyTypes.");
     if (auto n = XMLUtils::getChildNode(node, "TwoSidedDeltaKeyTypes")) {
         for (XMLNode* c = XMLUtils::getChildNode(n, "RiskFactorKeyType"); c; c = XMLUtils::getNextSibling(c)) {
@@ -839,8 +850,13 @@ XMLNode* SensitivityScenarioData::toXML(XMLDocument& doc) {
         }
     }
 
+    if (crossGammaMaterialityThreshold_ != Null<Real>())
+        XMLUtils::addChild(doc, root, "CrossGammaMaterialityThreshold", crossGammaMaterialityThreshold_);
+
     XMLUtils::addChild(doc, root, "ComputeGamma", computeGamma_);
     XMLUtils::addChild(doc, root, "UseSpreadedTermStructures", useSpreadedTermStructures_);
+    if (lazyScenarioGeneration_)
+        XMLUtils::addChild(doc, root, "LazyScenarioGeneration", lazyScenarioGeneration_);
 
     if (!twoSidedDeltas_.empty()) {
         DLOG("toXML for TwoSidedDeltaKeyTypes");
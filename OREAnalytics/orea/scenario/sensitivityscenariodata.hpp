@@ -28,6 +28,8 @@
 #include <ored/utilities/xmlutils.hpp>
 #include <qle/termstructures/dynamicstype.hpp>
 
+#include <ql/utilities/null.hpp>
+
 namespace ore {
 namespace analytics {
 using ore::data::XMLNode;
@@ -130,7 +132,8 @@ public:
 
     //! Default constructor
     SensitivityScenarioData(bool parConversion = true)
-        : computeGamma_(true), useSpreadedTermStructures_(false), parConversion_(parConversion) {};
+        : crossGammaMaterialityThreshold_(QuantLib::Null<QuantLib::Real>()), computeGamma_(true),
+          useSpreadedTermStructures_(false), lazyScenarioGeneration_(false), parConversion_(parConversion) {};
 
     //! \name Inspectors
     //@{
@@ -176,8 +179,16 @@ public:
     const map<string, SpotShiftData>& securityShiftData() const { return securityShiftData_; }
 
     const vector<pair<string, string>>& crossGammaFilter() const { return crossGammaFilter_; }
+    /*! If not null, only those cross gamma pairs allowed by the filter are computed for which at least one trade has an
+        absolute delta above this threshold w.r.t. both risk factors, see SensitivityAnalysis */
+    QuantLib::Real crossGammaMaterialityThreshold() const { return crossGammaMaterialityThreshold_; }
+    /*! Pairs of risk factors the cross gamma scenarios are restricted to in addition to the filter, no restriction if
+        empty. This is not part of the configuration, but set by the SensitivityAnalysis from the materiality check. */
+    const std::set<std::pair<RiskFactorKey, RiskFactorKey>>& crossGammaPairs() const { return crossGammaPairs_; }
     const bool computeGamma() const { return computeGamma_; }
     const bool useSpreadedTermStructures() const { return useSpreadedTermStructures_; }
+    //! If true, the sensitivity scenarios are built on demand, see SensitivityScenarioGenerator
+    const bool lazyScenarioGeneration() const { return lazyScenarioGeneration_; }
 
     //! Give back the shift data for the given risk factor type, \p keyType, with the given \p name
     const ShiftData& shiftData(const ore::analytics::RiskFactorKey::KeyType& keyType, const std::string& name) const;
@@ -226,8 +237,11 @@ public:
     map<string, SpotShiftData>& securityShiftData() { return securityShiftData_; }
 
     vector<pair<string, string>>& crossGammaFilter() { return crossGammaFilter_; }
+    QuantLib::Real& crossGammaMaterialityThreshold() { return crossGammaMaterialityThreshold_; }
+    std::set<std::pair<RiskFactorKey, RiskFactorKey>>& crossGammaPairs() { return crossGammaPairs_; }
     bool& computeGamma() { return computeGamma_; }
     bool& useSpreadedTermStructures() { return useSpreadedTermStructures_; }
+    bool& lazyScenarioGeneration() { return lazyScenarioGeneration_; }
 
     std::set<RiskFactorKey::KeyType>& twoSidedDeltas() { return twoSidedDeltas_; }
     //@}
@@ -288,8 +302,11 @@ protected:
     map<string, SpotShiftData> securityShiftData_; // key: security name
 
     vector<pair<string, string>> crossGammaFilter_;
+    QuantLib::Real crossGammaMaterialityThreshold_;
+    std::set<std::pair<RiskFactorKey, RiskFactorKey>> crossGammaPairs_;
     bool computeGamma_;
     bool useSpreadedTermStructures_;
+    bool lazyScenarioGeneration_;
     bool parConversion_;
 
     /*! Set of risk factor keys for which a two sided delta has been configured.
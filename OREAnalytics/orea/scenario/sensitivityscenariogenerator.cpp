@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/scenario/sensitivityscenariogenerator.hpp>
 
 #include <ored/utilities/indexparser.hpp>
@@ -51,7 +52,14 @@ SensitivityScenarioGenerator::SensitivityScenarioGenerator(
 
     QL_REQUIRE(sensitivityData_, "SensitivityScenarioGenerator: sensitivityData is null");
 
+    // in lazy mode we only keep the differences to the base scenario
+    if (sensitivityData_->lazyScenarioGeneration())
+        sensiScenarioFactory_ = boost::make_shared<DeltaScenarioFactory>(baseScenario_);
+
     generateScenarios();
+
+    if (sensitivityData_->lazyScenarioGeneration())
+        compressScenarios();
 }
 
 struct findFactor {
@@ -244,6 +252,12 @@ void SensitivityScenarioGenerator::generateScenarios() {
                         findPair(iKeyName, jKeyName)) == sensitivityData_->crossGammaFilter().end())
                 continue;
 
+            // check if the pair is one of the selected pairs, if a selection is given
+            auto const& pairs = sensitivityData_->crossGammaPairs();
+            if (!pairs.empty() && pairs.count(std::make_pair(iDesc.key1(), jDesc.key1())) == 0 &&
+                pairs.count(std::make_pair(jDesc.key1(), iDesc.key1())) == 0)
+                continue;
+
             // build cross scenario
             boost::shared_ptr<Scenario> crossScenario = sensiScenarioFactory_->buildScenario(asof);
 
@@ -93,6 +93,8 @@ using namespace data;
   - Likewise, Cap/Floor volatility sensitivities are computed in the optionlet domain.
   Conversion into par (flat cap/floor) volatility sensis has to be implemented as a
   postprocessor step.
+  - If sensitivityData_->lazyScenarioGeneration() = true, only the values differing from the base
+  scenario are kept after generation and each scenario is built on demand as a DeltaScenario in next().
 
   If sensitivityData_->generateSpreadScenarios() = true spread scenarios will be generated for
   supported risk factor types.
@@ -122,7 +124,7 @@ public:
     */
     const std::map<RiskFactorKey, QuantLib::Real>& shiftSizes() const { return shiftSizes_; }
 
-    Size numScenarios() const { return scenarios_.size(); }
+    Size numScenarios() const { return samples(); }
 
 private:
     void generateScenarios();
@@ -17,7 +17,9 @@
 */
 
 #include <boost/algorithm/string/split.hpp>
+#include <orea/scenario/deltascenario.hpp>
 #include <orea/scenario/shiftscenariogenerator.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
@@ -130,7 +132,7 @@ string ShiftScenarioGenerator::ScenarioDescription::factors() const {
 ShiftScenarioGenerator::ShiftScenarioGenerator(const boost::shared_ptr<Scenario>& baseScenario,
                                                const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
 					       const boost::weak_ptr<ScenarioSimMarket>& simMarket)
-  : baseScenario_(baseScenario), simMarketData_(simMarketData), simMarket_(simMarket), counter_(0) {
+  : baseScenario_(baseScenario), simMarketData_(simMarketData), simMarket_(simMarket), counter_(0), lazy_(false) {
     QL_REQUIRE(baseScenario_ != NULL, "ShiftScenarioGenerator: baseScenario is null");
     QL_REQUIRE(simMarketData_ != NULL, "ShiftScenarioGenerator: simMarketData is null");
     scenarios_.push_back(baseScenario_);
@@ -138,8 +140,46 @@ ShiftScenarioGenerator::ShiftScenarioGenerator(const boost::shared_ptr<Scenario>
 }
 
 boost::shared_ptr<Scenario> ShiftScenarioGenerator::next(const Date& d) {
-    QL_REQUIRE(counter_ < scenarios_.size(), "scenario vector size " << scenarios_.size() << " exceeded");
-    return scenarios_[counter_++];
+    QL_REQUIRE(counter_ < samples(), "scenario vector size " << samples() << " exceeded");
+    return scenario(counter_++);
+}
+
+boost::shared_ptr<Scenario> ShiftScenarioGenerator::scenario(Size i) const {
+    QL_REQUIRE(i < samples(), "scenario index " << i << " out of range, number of scenarios is " << samples());
+    if (!lazy_ || i == 0)
+        return scenarios_[i];
+    auto delta = boost::make_shared<SimpleScenario>(baseScenario_->asof(), to_string(scenarioDescriptions_[i]));
+    for (auto const& s : shifts_[i - 1])
+        delta->add(shiftKeys_[s.first], s.second);
+    return boost::make_shared<DeltaScenario>(baseScenario_, delta);
+}
+
+void ShiftScenarioGenerator::compressScenarios() {
+    if (lazy_)
+        return;
+    shiftKeys_ = baseScenario_->keys();
+    std::map<RiskFactorKey, Size> index;
+    for (Size k = 0; k < shiftKeys_.size(); ++k)
+        index[shiftKeys_[k]] = k;
+    shifts_.resize(scenarios_.size() - 1);
+    for (Size i = 1; i < scenarios_.size(); ++i) {
+        // for delta scenarios it is sufficient to look at the keys of the delta
+        auto d = boost::dynamic_pointer_cast<DeltaScenario>(scenarios_[i]);
+        for (auto const& k : d ? d->delta()->keys() : scenarios_[i]->keys()) {
+            Real v = scenarios_[i]->get(k);
+            if (v == baseScenario_->get(k))
+                continue;
+            auto it = index.find(k);
+            QL_REQUIRE(it != index.end(), "ShiftScenarioGenerator: key " << k << " of scenario "
+                                                                          << scenarios_[i]->label()
+                                                                          << " not found in base scenario");
+            shifts_[i - 1].emplace_back(it->second, v);
+        }
+        scenarios_[i].reset();
+    }
+    scenarios_.resize(1);
+    lazy_ = true;
+    DLOG("ShiftScenarioGenerator: " << shifts_.size() << " shift scenarios compressed for lazy generation");
 }
 
 ShiftScenarioGenerator::ShiftType parseShiftType(const std::string& s) {
@@ -103,11 +103,18 @@ public:
     //! Inspectors
     //@{
     //! Number of shift scenarios
-    Size samples() { return scenarios_.size(); }
+    Size samples() const { return lazy_ ? shifts_.size() + 1 : scenarios_.size(); }
     //! Return the base scenario, i.e. cached initial values of all relevant market points
     const boost::shared_ptr<Scenario>& baseScenario() { return scenarios_.front(); }
-    //! Return vector of sensitivity scenarios, scenario 0 is the base scenario
-    const std::vector<boost::shared_ptr<Scenario>>& scenarios() { return scenarios_; }
+    //! Return vector of sensitivity scenarios, scenario 0 is the base scenario, not available in lazy mode
+    const std::vector<boost::shared_ptr<Scenario>>& scenarios() {
+        QL_REQUIRE(!lazy_, "ShiftScenarioGenerator::scenarios() not available in lazy mode, use scenario(i)");
+        return scenarios_;
+    }
+    //! Return the i-th scenario, scenario 0 is the base scenario, in lazy mode the scenario is built on demand
+    boost::shared_ptr<Scenario> scenario(Size i) const;
+    //! True if the shift scenarios are built on demand
+    bool lazy() const { return lazy_; }
     //! Return vector of scenario descriptions
     std::vector<ScenarioDescription> scenarioDescriptions() { return scenarioDescriptions_; }
     // ! Return map of RiskFactorKeys to factors, i.e. human readable text representations
@@ -182,11 +189,19 @@ public:
     boost::shared_ptr<Scenario> baseScenario() const { return scenarios_.front(); }
 
 protected:
+    /*! Switch to lazy mode: the shift scenarios are replaced by their values that differ from the base scenario
+        and are rebuilt as DeltaScenario instances in next() resp. scenario(i) */
+    void compressScenarios();
+
     const boost::shared_ptr<Scenario> baseScenario_;
     const boost::shared_ptr<ScenarioSimMarketParameters> simMarketData_;
     const boost::weak_ptr<ScenarioSimMarket> simMarket_;
     std::vector<boost::shared_ptr<Scenario>> scenarios_;
     Size counter_;
+    // lazy mode: shifted values of scenarios 1, 2, ... as pairs (index in shiftKeys_, value)
+    bool lazy_;
+    std::vector<RiskFactorKey> shiftKeys_;
+    std::vector<std::vector<std::pair<Size, Real>>> shifts_;
     std::vector<ScenarioDescription> scenarioDescriptions_;
     // map risk factor key to "factor", i.e. human readable text representation
     std::map<RiskFactorKey, std::string> keyToFactor_;
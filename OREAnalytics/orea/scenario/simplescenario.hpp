@@ -71,7 +71,7 @@ public:
     boost::shared_ptr<Scenario> clone() const override;
 
     //! get data map
-    const std::map<RiskFactorKey, Real> data() const { return data_; }
+    const std::map<RiskFactorKey, Real>& data() const { return data_; }
 
 private:
     friend class boost::serialization::access;
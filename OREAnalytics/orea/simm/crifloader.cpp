@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/engine/threadpool.hpp>
 #include <orea/simm/crifloader.hpp>
 #include <orea/simm/simmbucketmapper.hpp>
 #include <orea/simm/simmconfiguration.hpp>
@@ -26,6 +27,10 @@
 
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstring>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/to_string.hpp>
@@ -240,13 +245,19 @@ void CrifLoader::loadFromFile(const std::string& fileName, char eol, char delim,
                                           << static_cast<int>(quoteChar) << " escape character "
                                           << static_cast<int>(escapeChar));
 
-    // Try to open the file
+    // Try to open the file, non-empty files are memory mapped and processed in place
     ifstream file;
     file.open(fileName);
     QL_REQUIRE(file.is_open(), "error opening file " << fileName);
-
-    // Process the file
-    loadFromStream(file, eol, delim, quoteChar, escapeChar);
+    if (boost::filesystem::file_size(fileName) == 0) {
+        loadFromStream(file, eol, delim, quoteChar, escapeChar);
+    } else {
+        file.close();
+        boost::interprocess::file_mapping mapping(fileName.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        const char* begin = static_cast<const char*>(region.get_address());
+        loadFromBuffer(begin, begin + region.get_size(), eol, delim, quoteChar, escapeChar);
+    }
 
     LOG("Finished loading CRIF records from file " << fileName);
 }
@@ -257,11 +268,8 @@ void CrifLoader::loadFromString(const std::string& csvBuffer, char eol, char del
         << static_cast<int>(eol) << ", delimiter " << static_cast<int>(delim) << " quote character "
         << static_cast<int>(quoteChar) << " escape character " << static_cast<int>(escapeChar));
 
-    // Process the file
-    std::stringstream csvStream;
-
-    csvStream << csvBuffer;
-    loadFromStream(csvStream, eol, delim, quoteChar, escapeChar);
+    // Process the buffer
+    loadFromBuffer(csvBuffer.data(), csvBuffer.data() + csvBuffer.size(), eol, delim, quoteChar, escapeChar);
 
     LOG("Finished loading CRIF records from csvBuffer");
 }
@@ -301,12 +309,8 @@ void CrifLoader::loadFromStream(std::istream& stream, char eol, char delim, char
             }
         } else {
             // Process the header line of the CRIF file
-            processHeader(entries);
+            maxIndex = header(entries);
             headerProcessed = true;
-            auto maxPair = max_element(
-                columnIndex_.begin(), columnIndex_.end(),
-                [](const pair<Size, Size>& p1, const pair<Size, Size>& p2) { return p1.second < p2.second; });
-            maxIndex = maxPair->second;
         }
     }
 
@@ -314,6 +318,101 @@ void CrifLoader::loadFromStream(std::istream& stream, char eol, char delim, char
                   << " invalid lines and " << emptyLines << " empty lines.");
 }
 
+void CrifLoader::loadFromBuffer(const char* begin, const char* end, char eol, char delim, char quoteChar,
+                                char escapeChar) {
+    // The lines are processed in batches. The lines of a batch are parsed on nThreads_ threads and the records are
+    // then added in the order of the lines, so that the result does not depend on the number of threads.
+    const Size batchSize = 100000;
+    enum class LineStatus : char { Empty, Invalid, Valid };
+    vector<pair<const char*, const char*>> lines;
+    vector<CrifRecord> records;
+    vector<LineStatus> status;
+    bool headerProcessed = false;
+    Size emptyLines = 0;
+    Size validLines = 0;
+    Size invalidLines = 0;
+    Size maxIndex = 0;
+    Size currentLine = 0;
+    const char* pos = begin;
+    while (pos < end) {
+        // Split the next batch of lines
+        Size firstLine = currentLine;
+        lines.clear();
+        while (pos < end && lines.size() < batchSize) {
+            const char* e = static_cast<const char*>(std::memchr(pos, eol, end - pos));
+            if (e == nullptr)
+                e = end;
+            lines.push_back(std::make_pair(pos, e));
+            pos = e == end ? end : e + 1;
+        }
+        currentLine += lines.size();
+
+        // Process the header line of the CRIF file
+        Size first = 0;
+        for (; !headerProcessed && first < lines.size(); ++first) {
+            string line(lines[first].first, lines[first].second);
+            boost::trim(line);
+            if (line.empty()) {
+                ++emptyLines;
+                continue;
+            }
+            maxIndex = header(parseListOfValues(line, escapeChar, delim, quoteChar));
+            headerProcessed = true;
+        }
+
+        // Parse the regular lines of the CRIF file
+        records.assign(lines.size(), CrifRecord());
+        status.assign(lines.size(), LineStatus::Empty);
+        runBlocks(lines.size() - first, nThreads_, nullptr, [&](const Size b, const Size e) {
+            for (Size i = first + b; i < first + e; ++i) {
+                string line(lines[i].first, lines[i].second);
+                boost::trim(line);
+                if (line.empty())
+                    continue;
+                vector<string> entries = parseListOfValues(line, escapeChar, delim, quoteChar);
+                status[i] = parse(entries, maxIndex, firstLine + i + 1, records[i]) ? LineStatus::Valid
+                                                                                      : LineStatus::Invalid;
+            }
+        });
+
+        // Add the records
+        for (Size i = first; i < lines.size(); ++i) {
+            if (status[i] == LineStatus::Valid && !addRecord(records[i], firstLine + i + 1))
+                status[i] = LineStatus::Invalid;
+            if (status[i] == LineStatus::Empty)
+                ++emptyLines;
+            else if (status[i] == LineStatus::Valid)
+                ++validLines;
+            else
+                ++invalidLines;
+        }
+    }
+
+    LOG("Out of " << currentLine << " lines, there were " << validLines << " valid lines, " << invalidLines
+                  << " invalid lines and " << emptyLines << " empty lines.");
+}
+
+Size CrifLoader::header(const vector<string>& headers) {
+    processHeader(headers);
+    auto maxPair =
+        max_element(columnIndex_.begin(), columnIndex_.end(),
+                    [](const pair<Size, Size>& p1, const pair<Size, Size>& p2) { return p1.second < p2.second; });
+
+    // Canonical Label1 and Label2 values by lower case value, for the case-insensitive matching in parse()
+    labels1_.clear();
+    labels2_.clear();
+    for (const auto& rt : SimmConfiguration::riskTypes()) {
+        if (!configuration_->isValidRiskType(rt))
+            continue;
+        for (const string& l : configuration_->labels1(rt))
+            labels1_[rt][boost::to_lower_copy(l)] = l;
+        for (const string& l : configuration_->labels2(rt))
+            labels2_[rt][boost::to_lower_copy(l)] = l;
+    }
+
+    return maxPair->second;
+}
+
 const SimmNetSensitivities CrifLoader::netRecords(const bool includeSimmParams) const {
     SimmNetSensitivities netRecords = crifRecords_;
 
@@ -399,6 +498,24 @@ void CrifLoader::processHeader(const vector<string>& headers) {
 }
 
 bool CrifLoader::process(const vector<string>& entries, Size maxIndex, Size currentLine) {
+    CrifRecord cr;
+    return parse(entries, maxIndex, currentLine, cr) && addRecord(cr, currentLine);
+}
+
+bool CrifLoader::addRecord(const CrifRecord& cr, Size currentLine) {
+    // There could still be issues here so we surround with try..catch to allow processing to continue
+    try {
+        add(cr);
+    } catch (const exception& e) {
+        WLOG(ore::data::StructuredTradeErrorMessage(cr.tradeId, cr.tradeType, "CRIF loading",
+            "Line number: " + to_string(currentLine) +
+                ". Error processing CRIF line, so skipping it. Error: " + to_string(e.what())));
+        return false;
+    }
+    return true;
+}
+
+bool CrifLoader::parse(const vector<string>& entries, Size maxIndex, Size currentLine, CrifRecord& cr) const {
     // Return early if there are not enough entries in the line
     if (entries.size() <= maxIndex) {
         WLOG("Line number: " << currentLine << ". Expected at least " << maxIndex + 1 << " entries but got only "
@@ -406,23 +523,24 @@ bool CrifLoader::process(const vector<string>& entries, Size maxIndex, Size curr
         return false;
     }
 
-    // Try to create and add a CRIF record
+    // Try to create a CRIF record
     // There could still be issues here so we surround with try..catch to allow processing to continue
     auto loadOptionalString = [&entries, this](int column) {
-        return columnIndex_.count(column) == 0 ? "" : entries[columnIndex_[column]];
+        auto it = columnIndex_.find(column);
+        return it == columnIndex_.end() ? "" : entries[it->second];
     };
     auto loadOptionalReal = [&entries, this](int column) -> QuantLib::Real{
-        if (columnIndex_.count(column) == 0) {
+        auto it = columnIndex_.find(column);
+        if (it == columnIndex_.end()) {
             return QuantLib::Null<QuantLib::Real>();
         } else{
-            return entries[columnIndex_[column]].empty() ? QuantLib::Null<QuantLib::Real>()
-                                                         : parseReal(entries[columnIndex_[column]]);
+            return entries[it->second].empty() ? QuantLib::Null<QuantLib::Real>() : parseReal(entries[it->second]);
         } 
     };
 
     string tradeId, tradeType, imModel;
     try {
-        CrifRecord cr;
+        cr = CrifRecord();
         tradeId = entries[columnIndex_.at(0)];
         tradeType = loadOptionalString(15);
         imModel = loadOptionalString(16);
@@ -464,22 +582,19 @@ bool CrifLoader::process(const vector<string>& entries, Size maxIndex, Size curr
         if (boost::to_lower_copy(cr.bucket) == "residual")
             cr.bucket = "Residual";
 
-        // Label1
-        cr.label1 = entries[columnIndex_.at(6)];
-        if (configuration_->isValidRiskType(cr.riskType)) {
-            for (const string& l : configuration_->labels1(cr.riskType)) {
-                if (boost::to_lower_copy(cr.label1) == boost::to_lower_copy(l))
-                    cr.label1 = l;
+        // Label1 and Label2, matched case-insensitively against the configuration's labels
+        auto canonicalLabel = [&cr](const map<RiskType, map<string, string>>& labels, string& label) {
+            auto it = labels.find(cr.riskType);
+            if (it != labels.end()) {
+                auto l = it->second.find(boost::to_lower_copy(label));
+                if (l != it->second.end())
+                    label = l->second;
             }
-        }
-        // Label2
+        };
+        cr.label1 = entries[columnIndex_.at(6)];
+        canonicalLabel(labels1_, cr.label1);
         cr.label2 = entries[columnIndex_.at(7)];
-        if (configuration_->isValidRiskType(cr.riskType)) {
-            for (const string& l : configuration_->labels2(cr.riskType)) {
-                if (boost::to_lower_copy(cr.label2) == boost::to_lower_copy(l))
-                    cr.label2 = l;
-            }
-        }
+        canonicalLabel(labels2_, cr.label2);
 
         // We populate these 'required' values using loadOptional*, but they will have been validated already in processHeader,
         // and missing amountUsd (but with valid amount and amountCurrency) values populated later on in the analytics
@@ -518,9 +633,6 @@ bool CrifLoader::process(const vector<string>& entries, Size maxIndex, Size curr
                 cr.additionalFields[*additionalField.second.begin()] = value;
         }
 
-        // Add the CRIF record to the net records
-        add(cr);
-
     } catch (const exception& e) {
         WLOG(ore::data::StructuredTradeErrorMessage(tradeId, tradeType, "CRIF loading",
             "Line number: " + to_string(currentLine) +
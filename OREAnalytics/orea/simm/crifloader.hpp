@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <tuple>
 
@@ -110,6 +111,10 @@ public:
     //! SIMM configuration getter
     const boost::shared_ptr<SimmConfiguration>& simmConfiguration() { return configuration_; }
 
+    /*! Number of threads used to parse the lines in loadFromFile() and loadFromString(), the records are added in
+        the order of the lines in any case */
+    void setThreads(QuantLib::Size nThreads) { nThreads_ = std::max<QuantLib::Size>(nThreads, 1); }
+
 protected:
     //! Simm configuration that is used during loading of CRIF records
     boost::shared_ptr<SimmConfiguration> configuration_;
@@ -150,6 +155,27 @@ protected:
         or false if an invalid line
     */
     virtual bool process(const std::vector<std::string>& entries, QuantLib::Size maxIndex, QuantLib::Size currentLine);
+
+    /*! Build the CRIF record from a line of a CRIF file and return true if valid line or false if an invalid line,
+        this does not change the state of the loader and can be called concurrently
+    */
+    bool parse(const std::vector<std::string>& entries, QuantLib::Size maxIndex, QuantLib::Size currentLine,
+               CrifRecord& record) const;
+
+    //! Add a parsed CRIF record and return false if this fails
+    bool addRecord(const CrifRecord& record, QuantLib::Size currentLine);
+
+private:
+    //! Process the header line and return the maximum column index
+    QuantLib::Size header(const std::vector<std::string>& headers);
+
+    //! Load CRIF records from the characters in [begin, end), parsing batches of lines in parallel
+    void loadFromBuffer(const char* begin, const char* end, char eol, char delim, char quoteChar, char escapeChar);
+
+    //! Canonical Label1 and Label2 values by risk type and lower case value, set up with the header
+    std::map<SimmConfiguration::RiskType, std::map<std::string, std::string>> labels1_, labels2_;
+
+    QuantLib::Size nThreads_ = 1;
 };
 
 } // namespace analytics
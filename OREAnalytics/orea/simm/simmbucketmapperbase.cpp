@@ -58,29 +58,18 @@ SimmBucketMapperBase::SimmBucketMapperBase(
                       RiskType::CreditVolNonQ, RiskType::EquityVol, RiskType::CommodityVol};
 }
 
-std::string BucketMapping::name() const {
+BucketMapping::BucketMapping(const string& bucket, const string& validFrom, const string& validTo, bool fallback)
+    : bucket_(bucket), validFrom_(validFrom), validTo_(validTo), fallback_(fallback),
+      validFromDate_(validFrom.empty() ? Date::minDate() : ore::data::parseDate(validFrom)),
+      validToDate_(validTo.empty() ? Date::maxDate() : ore::data::parseDate(validTo)) {
     std::ostringstream o;
     o << bucket_ << "-" << validFrom_ << "-" << validTo_ << "-" << fallback_;
-    return o.str();
-}   
+    name_ = o.str();
+}
 
 bool operator<(const BucketMapping &a, const BucketMapping &b) {
     return a.name() < b.name();
 }
-    
-QuantLib::Date BucketMapping::validToDate() const {
-    if (validTo_.empty())
-        return Date::maxDate();
-    else
-        return ore::data::parseDate(validTo_);
-}
-
-QuantLib::Date BucketMapping::validFromDate() const {
-    if (validFrom_.empty())
-        return Date::minDate();
-    else
-        return ore::data::parseDate(validFrom_);
-}
 
 string SimmBucketMapperBase::bucket(const RiskType& riskType, const string& qualifier) const {
 
@@ -98,6 +87,35 @@ string SimmBucketMapperBase::bucket(const RiskType& riskType, const string& qual
         return irBucket(qualifier);
     }
 
+    // The same qualifiers are looked up many times during CRIF loading and SIMM calculation, so the resolved
+    // buckets are cached per evaluation date
+    Date today = Settings::instance().evaluationDate();
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cacheMutex_);
+        if (cacheDate_ == today) {
+            auto c = cache_.find(lookupRiskType);
+            if (c != cache_.end()) {
+                auto b = c->second.find(qualifier);
+                if (b != c->second.end())
+                    return b->second;
+            }
+        }
+    }
+
+    string bucket = resolveBucket(riskType, lookupRiskType, qualifier);
+
+    boost::unique_lock<boost::shared_mutex> lock(cacheMutex_);
+    if (cacheDate_ != today) {
+        cache_.clear();
+        cacheDate_ = today;
+    }
+    cache_[lookupRiskType].emplace(qualifier, bucket);
+    return bucket;
+}
+
+string SimmBucketMapperBase::resolveBucket(const RiskType& riskType, const RiskType& lookupRiskType,
+                                           const string& qualifier) const {
+
     string bucket;
     string lookupName = qualifier;
 
@@ -159,13 +177,14 @@ string SimmBucketMapperBase::bucket(const RiskType& riskType, const string& qual
         fm.lookupName = lookupName;
         fm.riskType = riskType;
         fm.lookupRiskType = lookupRiskType;
+        std::lock_guard<std::mutex> lock(failedMappingsMutex_);
         failedMappings_.insert(fm);
 
     } else {
         // We may have several mappings per qualifier, pick the first valid one that matches the fallback flag
         Date today = Settings::instance().evaluationDate();
-        for (auto m : bucketMapping_.at(lookupRiskType).at(lookupName)) {
-            if (m.validToDate() >= today && m.validFromDate() <= today && m.fallback() == !haveMapping) {
+        for (const auto& m : bucketMapping_.at(lookupRiskType).at(lookupName)) {
+            if (m.isValid(today) && m.fallback() == !haveMapping) {
                 bucket = m.bucket();
                 return bucket;
             }
@@ -206,9 +225,7 @@ bool SimmBucketMapperBase::has(const RiskType& riskType, const string& qualifier
     // So pick the first valid one
 
     for (const auto& m : q->second) {
-        Date validTo = m.validToDate();
-        Date validFrom = m.validFromDate();
-        if (validTo >= today && validFrom <= today && (fallback ? *fallback == m.fallback() : true))
+        if (m.isValid(today) && (fallback ? *fallback == m.fallback() : true))
             return true;
     }
     return false;
@@ -349,7 +366,8 @@ void SimmBucketMapperBase::addMapping(const RiskType& riskType, const string& qu
         }
     }
     
-    bucketMapping_[rt][qualifier].insert(BucketMapping(bucket, vt, vf, fallback));
+    bucketMapping_[rt][qualifier].insert(BucketMapping(bucket, vf, vt, fallback));
+    clearCache();
 }
 
 string SimmBucketMapperBase::irBucket(const string& qualifier) const {
@@ -377,6 +395,13 @@ void SimmBucketMapperBase::reset() {
     // Clear the bucket mapper and add back the commodity mappings
     bucketMapping_.clear();
     failedMappings_.clear();
+    clearCache();
+}
+
+void SimmBucketMapperBase::clearCache() {
+    boost::unique_lock<boost::shared_mutex> lock(cacheMutex_);
+    cache_.clear();
+    cacheDate_ = Date();
 }
 
 } // namespace analytics
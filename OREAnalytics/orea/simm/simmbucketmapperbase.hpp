@@ -28,29 +28,39 @@
 #include <ored/utilities/xmlutils.hpp>
 #include <ored/portfolio/referencedata.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 namespace ore {
 namespace analytics {
 
 class BucketMapping {
 public:
-    BucketMapping(const std::string& bucket, const std::string& validFrom = "", const std::string& validTo = "", bool fallback = false)
-        : bucket_(bucket), validFrom_(validFrom), validTo_(validTo), fallback_(fallback) {}
+    BucketMapping(const std::string& bucket, const std::string& validFrom = "", const std::string& validTo = "",
+                  bool fallback = false);
     const std::string& bucket() const { return bucket_; }
     const std::string& validFrom() const { return validFrom_; }
     const std::string& validTo() const { return validTo_; }
     bool fallback() const { return fallback_; }
-    QuantLib::Date validToDate() const;
-    QuantLib::Date validFromDate() const;
-    std::string name() const;
+    //! The validity dates are parsed once on construction
+    const QuantLib::Date& validToDate() const { return validToDate_; }
+    const QuantLib::Date& validFromDate() const { return validFromDate_; }
+    //! Check if the mapping is valid on \p d
+    bool isValid(const QuantLib::Date& d) const { return validFromDate_ <= d && d <= validToDate_; }
+    const std::string& name() const { return name_; }
 private:
     std::string bucket_;
     std::string validFrom_;
     std::string validTo_;
     bool fallback_;
+    QuantLib::Date validFromDate_;
+    QuantLib::Date validToDate_;
+    std::string name_;
 };
 
 bool operator< (const BucketMapping &a, const BucketMapping &b);
@@ -90,10 +100,16 @@ public:
                     const std::string& bucket, const std::string& validFrom = "", const std::string& validTo = "", bool fallback = false) override;
 
     //! Set the Reference data manager
-    void setSimmNameMapper(const boost::shared_ptr<SimmBasicNameMapper> nameMapper) { nameMapper_ = nameMapper; }
+    void setSimmNameMapper(const boost::shared_ptr<SimmBasicNameMapper> nameMapper) {
+        nameMapper_ = nameMapper;
+        clearCache();
+    }
 
     //! Set the Reference data manager
-    void setRefDataManger(const boost::shared_ptr<ore::data::BasicReferenceDataManager>& refDataManager) { refDataManager_ = refDataManager; }
+    void setRefDataManger(const boost::shared_ptr<ore::data::BasicReferenceDataManager>& refDataManager) {
+        refDataManager_ = refDataManager;
+        clearCache();
+    }
 
     const std::set<FailedMapping>& failedMappings() const override { return failedMappings_; }
 
@@ -114,6 +130,15 @@ protected:
     //! Set of SIMM risk types that have buckets
     std::set<SimmConfiguration::RiskType> rtWithBuckets_;
 
+    /*! Resolve the bucket for the non-vol \p lookupRiskType and \p qualifier from the mappings, the name mapper
+        and the reference data, bypassing the cache
+    */
+    std::string resolveBucket(const SimmConfiguration::RiskType& riskType,
+                              const SimmConfiguration::RiskType& lookupRiskType, const std::string& qualifier) const;
+
+    //! Clear the cache of resolved buckets, must be called whenever the mappings change
+    void clearCache();
+
 private:
     //! Reset the SIMM bucket mapper i.e. clears all mappings and adds the initial hard-coded commodity mappings
     void reset();
@@ -125,6 +150,15 @@ private:
     boost::shared_ptr<SimmBasicNameMapper> nameMapper_;
 
     mutable std::set<FailedMapping> failedMappings_;
+    //! Guards failedMappings_, since bucket() may be called concurrently by the SimmCalculator
+    mutable std::mutex failedMappingsMutex_;
+
+    /*! Buckets resolved so far, keyed by the non-vol lookup risk type and the qualifier. The cache is only valid for
+        the evaluation date cacheDate_, since the mappings have validity periods.
+    */
+    mutable std::map<SimmConfiguration::RiskType, std::unordered_map<std::string, std::string>> cache_;
+    mutable QuantLib::Date cacheDate_;
+    mutable boost::shared_mutex cacheMutex_;
 };
 
 } // namespace analytics
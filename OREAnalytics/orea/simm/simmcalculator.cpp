@@ -21,14 +21,18 @@
 #include <orea/simm/simmcalculator.hpp>
 #include <orea/simm/utilities.hpp>
 
+#include <algorithm>
 #include <boost/math/distributions/normal.hpp>
+#include <functional>
 #include <numeric>
 #include <ored/portfolio/structuredtradewarning.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/quote.hpp>
+#include <ql/settings.hpp>
 
 using std::abs;
 using std::accumulate;
@@ -49,6 +53,7 @@ using ore::data::to_string;
 using ore::data::parseBool;
 using QuantLib::close_enough;
 using QuantLib::Real;
+using QuantLib::Size;
 
 namespace ore {
 namespace analytics {
@@ -61,14 +66,222 @@ typedef SimmConfiguration::RiskType RiskType;
 typedef SimmConfiguration::Regulation Regulation;
 typedef SimmConfiguration::SimmSide SimmSide;
 
+/*! Correlations between the CRIF records of each risk type and bucket, kept across netting sets. Records with the
+    same qualifier, Label1 and Label2 share a key, since the SIMM correlations depend on these only. The correlation
+    between two keys is looked up from the SIMM configuration on first use and kept in a lower triangular table per
+    risk type and bucket, so that the aggregation over pairs of records does not need string comparisons or
+    configuration lookups. The correlations are assumed to be symmetric, as the SIMM correlation matrices are.
+*/
+class SimmCalculator::CorrelationCache {
+    struct Table {
+        map<std::tuple<string, string, string>, Size> ids;
+        // rows[i][j] for j <= i is the correlation between the keys i and j, null if not looked up yet
+        std::vector<std::vector<Real>> rows;
+    };
+
+public:
+    typedef std::function<Real(const CrifRecord&, const CrifRecord&)> Correlation;
+
+    //! The CRIF records of a bucket compiled to the key ids of the cache
+    class CompiledBucket {
+    public:
+        Size size() const { return records_.size(); }
+        const CrifRecord& record(const Size k) const { return *records_[k]; }
+
+        //! Write the correlations between the record \p k and the records \p 0, ..., \p k-1 to \p row
+        void correlations(const Size k, Real* row) {
+            const Size i = ids_[k];
+            for (Size l = 0; l < k; ++l) {
+                const Size j = ids_[l];
+                if (i == QuantLib::Null<Size>() || j == QuantLib::Null<Size>()) {
+                    row[l] = correlation_(*records_[k], *records_[l]);
+                    continue;
+                }
+                Real& c = i >= j ? table_->rows[i][j] : table_->rows[j][i];
+                if (c == QuantLib::Null<Real>())
+                    c = correlation_(*records_[k], *records_[l]);
+                row[l] = c;
+            }
+        }
+
+    private:
+        friend class CorrelationCache;
+        Table* table_;
+        std::vector<const CrifRecord*> records_;
+        std::vector<Size> ids_;
+        Correlation correlation_;
+    };
+
+    //! Compile the \p records of the \p bucket, keys beyond the cache capacity are not cached
+    CompiledBucket compile(const RiskType& rt, const string& bucket, const std::vector<const CrifRecord*>& records,
+                           const Correlation& correlation) {
+        CompiledBucket c;
+        c.table_ = &tables_[make_pair(rt, bucket)];
+        c.records_ = records;
+        c.correlation_ = correlation;
+        auto& ids = c.table_->ids;
+        auto& rows = c.table_->rows;
+        for (const CrifRecord* r : records) {
+            auto key = make_tuple(r->qualifier, r->label1, r->label2);
+            auto it = ids.find(key);
+            if (it == ids.end() && ids.size() < maxKeys) {
+                it = ids.insert(make_pair(key, ids.size())).first;
+                rows.push_back(std::vector<Real>(rows.size() + 1, QuantLib::Null<Real>()));
+            }
+            c.ids_.push_back(it == ids.end() ? QuantLib::Null<Size>() : it->second);
+        }
+        return c;
+    }
+
+private:
+    static constexpr Size maxKeys = 2048;
+    map<pair<RiskType, string>, Table> tables_;
+};
+
+namespace {
+
+// Dot product with independent partial sums, so that the compiler can vectorise it
+Real dot(const Real* a, const Real* b, const Size n) {
+    Real s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    Size i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i)
+        s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+// The records of a bucket with the derivatives of the bucket's weighted sensitivity sum, w, and of half its squared
+// margin $K_b^2$, h, with respect to the amounts of the records, used to back propagate the margin derivatives
+struct BucketGradient {
+    std::vector<const CrifRecord*> records;
+    std::vector<Real> w, h;
+};
+
+// Half the derivatives of $\sum_{k,l} c_{k,l} WS_k WS_l$ with respect to the amounts $x_k$, where $WS_k = w_k x_k$ and
+// $c_{k,k} = 1$, added to the derivatives h of the bucket
+void addQuadraticFormDerivatives(BucketGradient& b, const std::vector<Real>& ws,
+                                 const std::function<Real(Size, Size)>& c) {
+    b.h.resize(ws.size(), 0.0);
+    for (Size k = 0; k < ws.size(); ++k) {
+        Real t = ws[k];
+        for (Size l = 0; l < ws.size(); ++l)
+            if (l != k)
+                t += c(k, l) * ws[l];
+        b.h[k] += b.w[k] * t;
+    }
+}
+
+// The aggregation across buckets $\sqrt{\sum_b K_b^2 + \sum_{b \neq c} \gamma_{b,c} S_b S_c}$, where $S_b$ is the
+// sum of the weighted sensitivities of bucket b capped at $\pm K_b$, and its derivatives with respect to the $K_b$
+// and the uncapped sums. gamma holds the lower triangle, i.e. gamma[b][c] for c < b.
+Real crossBucketAggregation(const std::vector<Real>& k, const std::vector<Real>& sums,
+                            const std::vector<std::vector<Real>>& gamma, std::vector<Real>& dk,
+                            std::vector<Real>& dsum) {
+    const Size n = k.size();
+    std::vector<Real> s(n);
+    Real q = 0.0;
+    for (Size b = 0; b < n; ++b) {
+        s[b] = max(min(sums[b], k[b]), -k[b]);
+        q += k[b] * k[b];
+        for (Size c = 0; c < b; ++c)
+            q += 2.0 * gamma[b][c] * s[b] * s[c];
+    }
+    dk.assign(n, 0.0);
+    dsum.assign(n, 0.0);
+    if (q <= 0.0)
+        return 0.0;
+    const Real m = sqrt(q);
+    for (Size b = 0; b < n; ++b) {
+        Real t = 0.0;
+        for (Size c = 0; c < n; ++c)
+            if (c != b)
+                t += (c < b ? gamma[b][c] : gamma[c][b]) * s[c];
+        dk[b] = k[b] / m;
+        if (sums[b] > k[b])
+            dk[b] += t / m;
+        else if (sums[b] < -k[b])
+            dk[b] -= t / m;
+        else
+            dsum[b] = t / m;
+    }
+    return m;
+}
+
+// Add the derivatives of a margin with the given derivatives with respect to $K_b$ and the weighted sensitivity sum of
+// the bucket b to the gradient
+void addBucketGradient(const BucketGradient& b, const Real kb, const Real dk, const Real dsum,
+                       map<const CrifRecord*, Real>& gradient) {
+    for (Size i = 0; i < b.records.size(); ++i) {
+        Real d = dsum * b.w[i];
+        if (kb > 0.0)
+            d += dk * b.h[i] / kb;
+        gradient[b.records[i]] += d;
+    }
+}
+
+// The entry of a (side, netting set, regulation) container, null if there is none
+template <class T>
+const T* findEntry(const map<SimmSide, map<NettingSetDetails, map<string, T>>>& container, const SimmSide& side,
+              const NettingSetDetails& nettingSetDetails, const string& regulation) {
+    auto s = container.find(side);
+    if (s == container.end())
+        return nullptr;
+    auto n = s->second.find(nettingSetDetails);
+    if (n == s->second.end())
+        return nullptr;
+    auto r = n->second.find(regulation);
+    return r == n->second.end() ? nullptr : &r->second;
+}
+
+// The risk class of the margin components that the records of a risk type contribute to, All for the SIMM parameters
+RiskClass riskClass(const RiskType& rt) {
+    switch (rt) {
+    case RiskType::IRCurve:
+    case RiskType::IRVol:
+    case RiskType::Inflation:
+    case RiskType::InflationVol:
+    case RiskType::XCcyBasis:
+        return RiskClass::InterestRate;
+    case RiskType::CreditQ:
+    case RiskType::CreditVol:
+    case RiskType::BaseCorr:
+        return RiskClass::CreditQualifying;
+    case RiskType::CreditNonQ:
+    case RiskType::CreditVolNonQ:
+        return RiskClass::CreditNonQualifying;
+    case RiskType::Equity:
+    case RiskType::EquityVol:
+        return RiskClass::Equity;
+    case RiskType::Commodity:
+    case RiskType::CommodityVol:
+        return RiskClass::Commodity;
+    case RiskType::FX:
+    case RiskType::FXVol:
+        return RiskClass::FX;
+    default:
+        return RiskClass::All;
+    }
+}
+
+} // namespace
+
 SimmCalculator::SimmCalculator(const SimmNetSensitivities& simmNetSensitivities,
                                const boost::shared_ptr<SimmConfiguration>& simmConfiguration,
                                const string& calculationCcy, const string& resultCcy, const boost::shared_ptr<Market> market,
                                const bool determineWinningRegulations,
-                               const bool enforceIMRegulations, const bool quiet)
+                               const bool enforceIMRegulations, const bool quiet, const Size nThreads,
+                               const boost::shared_ptr<ThreadPool>& threadPool)
     : simmNetSensitivities_(simmNetSensitivities), simmConfiguration_(simmConfiguration),
       calculationCcy_(calculationCcy), resultCcy_(resultCcy.empty() ? calculationCcy_ : resultCcy), market_(market),
-      quiet_(quiet) {
+      quiet_(quiet), nThreads_(std::max<Size>(nThreads, 1)), threadPool_(threadPool) {
+
+    TraceSpan span("simm", "SimmCalculator");
+    span.arg("records", simmNetSensitivities_.size());
 
     QL_REQUIRE(checkCurrency(calculationCcy_),
                "SIMM Calculator: The calculation currency (" << calculationCcy_ << ") must be a valid ISO currency code");
@@ -148,13 +361,21 @@ SimmCalculator::SimmCalculator(const SimmNetSensitivities& simmNetSensitivities,
         }
     }
 
-    // Calculate SIMM call and post for each regulation under each netting set
+    // Collect the side-nettingSet-regulation combinations to calculate. The results containers are created here, so
+    // that the combinations can be calculated independently of each other below.
+    struct Unit {
+        SimmSide side;
+        const NettingSetDetails* nsd;
+        const string* regulation;
+        const CrifLoader* crifLoader;
+        SimmResults* results;
+        std::map<ProductClass, MarginComponents>* components;
+    };
+    std::vector<Unit> units;
     for (const auto& sv : regSensitivities_) {
         const SimmSide side = sv.first;
         for (const auto& nettingSetSensis : sv.second) {
             const NettingSetDetails& nsd = nettingSetSensis.first;
-
-            // Calculate SIMM for particular side-nettingSet-regulation combination
             for (const auto& regSensis : nettingSetSensis.second) {
                 const string& regulation = regSensis.first;
                 bool hasFixedAddOn = false;
@@ -164,11 +385,29 @@ SimmCalculator::SimmCalculator(const SimmNetSensitivities& simmNetSensitivities,
                         break;
                     }
                 if (regSensis.second->hasCrifRecords() || hasFixedAddOn)
-                    calculateRegulationSimm(regSensis.second->netRecords(true), nsd, regulation, side);
+                    units.push_back({side, &nsd, &regulation, regSensis.second.get(),
+                                     &simmResults_[side][nsd][regulation],
+                                     &marginComponents_[side][nsd][regulation]});
             }
         }
     }
 
+    // Calculate SIMM call and post for each regulation under each netting set. If there are fewer combinations than
+    // threads, the remaining threads are used for the product classes within a combination.
+    const Size nBlocks = std::min(nThreads_, units.size());
+    const Size nProductClassThreads = std::max<Size>(nThreads_ / std::max<Size>(units.size(), 1), 1);
+    const QuantLib::Date today = QuantLib::Settings::instance().evaluationDate();
+    runBlocks(units.size(), nBlocks, threadPool_, [&](const Size begin, const Size end) {
+        QuantLib::Settings::instance().evaluationDate() = today;
+        // the correlations looked up for a netting set are reused for the later netting sets of the block
+        CorrelationCache cache;
+        for (Size i = begin; i < end; ++i) {
+            const Unit& u = units[i];
+            calculateRegulationSimm(u.crifLoader->netRecords(true), *u.nsd, *u.regulation, u.side, *u.results,
+                                    *u.components, nProductClassThreads, cache);
+        }
+    });
+
     // Convert to result currency
     convert();
 
@@ -219,7 +458,24 @@ SimmCalculator::SimmCalculator(const SimmNetSensitivities& simmNetSensitivities,
 
 const void SimmCalculator::calculateRegulationSimm(const SimmNetSensitivities& netRecords,
                                                    const NettingSetDetails& nettingSetDetails, const string& regulation,
-                                                   const SimmSide& side) {
+                                                   const SimmSide& side, const Size nThreads) {
+    CorrelationCache cache;
+    calculateRegulationSimm(netRecords, nettingSetDetails, regulation, side,
+                            simmResults_[side][nettingSetDetails][regulation],
+                            marginComponents_[side][nettingSetDetails][regulation], nThreads, cache);
+}
+
+void SimmCalculator::calculateRegulationSimm(const SimmNetSensitivities& netRecords,
+                                             const NettingSetDetails& nettingSetDetails, const string& regulation,
+                                             const SimmSide& side, SimmResults& results,
+                                             map<ProductClass, MarginComponents>& components, const Size nThreads,
+                                             CorrelationCache& cache) {
+
+    TraceSpan span("simm", "SimmCalculator::calculateRegulationSimm");
+    if (span.active())
+        span.arg("nettingSet", ore::data::to_string(nettingSetDetails))
+            .arg("regulation", regulation)
+            .arg("side", ore::data::to_string(side));
 
     if (!quiet_) {
         LOG("SimmCalculator: Calculating SIMM " << side << " for portfolio [" << nettingSetDetails << "], regulation "
@@ -229,126 +485,303 @@ const void SimmCalculator::calculateRegulationSimm(const SimmNetSensitivities& n
     // Index in to SimmNetSensitivities
     auto& indexProduct = netRecords.get<ProductClassTag>();
 
-    // Loop over portfolios and product classes
+    // Product classes in the portfolio
+    std::vector<ProductClass> productClasses;
     for (auto it = indexProduct.begin(); it != indexProduct.end();
-         it = indexProduct.upper_bound(make_tuple(nettingSetDetails, it->productClass))) {
-        auto productClass = it->productClass;
-        if (!quiet_) {
-            LOG("SimmCalculator: Calculating SIMM for product class " << productClass);
-        }
-
-        // Delta margin components
-        RiskClass rc = RiskClass::InterestRate;
-        MarginType mt = MarginType::Delta;
-        auto p = irDeltaMargin(nettingSetDetails, productClass, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FX, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditQ, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditNonQ, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::Equity, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::Commodity, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        // Vega margin components
-        mt = MarginType::Vega;
-        rc = RiskClass::InterestRate;
-        p = irVegaMargin(nettingSetDetails, productClass, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FXVol, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVol, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::EquityVol, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::CommodityVol, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        // Curvature margin components for sides call and post
-        mt = MarginType::Curvature;
-        rc = RiskClass::InterestRate;
-
-        p = irCurvatureMargin(nettingSetDetails, productClass, side, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::FXVol, side, netRecords, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVol, side, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, side, netRecords);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::EquityVol, side, netRecords, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CommodityVol, side, netRecords, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        // Base correlation margin components. This risk type came later so need to check
-        // first if it is valid under the configuration
-        if (simmConfiguration_->isValidRiskType(RiskType::BaseCorr)) {
-            p = margin(nettingSetDetails, productClass, RiskType::BaseCorr, netRecords);
-            if (p.second)
-                add(nettingSetDetails, regulation, productClass, RiskClass::CreditQualifying, MarginType::BaseCorr,
-                    p.first, side);
-        }
+         it = indexProduct.upper_bound(make_tuple(nettingSetDetails, it->productClass)))
+        productClasses.push_back(it->productClass);
+
+    // The product classes are independent, their margin components are calculated in parallel if requested and
+    // added to the results in the order of the serial calculation. Own threads are used here, since this might
+    // already run on a task of the thread pool.
+    std::vector<MarginComponents> pcMargins(productClasses.size());
+    const QuantLib::Date today = QuantLib::Settings::instance().evaluationDate();
+    runBlocks(productClasses.size(), nThreads, nullptr, [&](const Size begin, const Size end) {
+        QuantLib::Settings::instance().evaluationDate() = today;
+        // the first block uses the caller's correlation cache, the others run concurrently and use their own
+        CorrelationCache blockCache;
+        for (Size i = begin; i < end; ++i)
+            pcMargins[i] = productClassMargins(nettingSetDetails, productClasses[i], side, netRecords,
+                                               begin == 0 ? cache : blockCache);
+    });
+    components.clear();
+    for (Size i = 0; i < productClasses.size(); ++i) {
+        for (const auto& m : pcMargins[i])
+            add(results, nettingSetDetails, regulation, productClasses[i], std::get<0>(m), std::get<1>(m),
+                std::get<2>(m), side);
+        components[productClasses[i]] = std::move(pcMargins[i]);
     }
 
     // Calculate the higher level margins
-    populateResults(side, nettingSetDetails, regulation);
+    populateResults(results, side, nettingSetDetails, regulation);
 
     // For each portfolio, calculate the additional margin
-    calcAddMargin(side, nettingSetDetails, regulation, netRecords);
+    calcAddMargin(results, side, nettingSetDetails, regulation, netRecords);
+}
+
+std::pair<Real, Real> SimmCalculator::whatIf(const SimmNetSensitivities& candidate, const SimmSide& side,
+                                             const NettingSetDetails& nettingSetDetails, const string& regulation,
+                                             SimmResults* results) const {
+
+    // The base records, margin components and SIMM of the netting set and regulation, if any
+    const boost::shared_ptr<CrifLoader>* baseLoader = findEntry(regSensitivities_, side, nettingSetDetails, regulation);
+    const map<ProductClass, MarginComponents>* baseComponents =
+        findEntry(marginComponents_, side, nettingSetDetails, regulation);
+    const SimmResults* baseResults = findEntry(simmResults_, side, nettingSetDetails, regulation);
+    Real baseSimm = 0.0;
+    if (baseResults && baseResults->has(ProductClass::All, RiskClass::All, MarginType::All, "All"))
+        baseSimm = baseResults->get(ProductClass::All, RiskClass::All, MarginType::All, "All");
+
+    // The (product class, risk class) combinations with candidate sensitivities
+    map<ProductClass, set<RiskClass>> touched;
+    for (const CrifRecord& cr : candidate) {
+        if (cr.imModel == "Schedule")
+            continue;
+        const RiskClass rc = riskClass(cr.riskType);
+        if (rc != RiskClass::All)
+            touched[cr.productClass].insert(rc);
+    }
+
+    // Net the candidate records with the base records of the touched product classes and the SIMM parameters
+    CrifLoader loader(simmConfiguration_, CrifRecord::additionalHeaders, true, true);
+    const bool onDiffAmountCcy = true;
+    if (baseLoader) {
+        for (const CrifRecord& cr : (*baseLoader)->netRecords(true))
+            if (cr.isSimmParameter() || touched.count(cr.productClass) > 0)
+                loader.add(cr, onDiffAmountCcy);
+    }
+    for (CrifRecord cr : candidate) {
+        if (cr.imModel == "Schedule")
+            continue;
+        cr.nettingSetDetails = nettingSetDetails;
+        cr.collectRegulations.clear();
+        cr.postRegulations.clear();
+        loader.add(cr, onDiffAmountCcy);
+    }
+    const SimmNetSensitivities netRecords = loader.netRecords(true);
+
+    // Recalculate the touched components, the others are taken from the base calculation
+    map<ProductClass, MarginComponents> components;
+    if (baseComponents)
+        components = *baseComponents;
+    CorrelationCache cache;
+    for (const auto& t : touched) {
+        MarginComponents& pcComponents = components[t.first];
+        pcComponents.erase(std::remove_if(pcComponents.begin(), pcComponents.end(),
+                                          [&t](const MarginComponents::value_type& m) {
+                                              return t.second.count(std::get<0>(m)) > 0;
+                                          }),
+                           pcComponents.end());
+        for (auto& m : productClassMargins(nettingSetDetails, t.first, side, netRecords, cache, &t.second))
+            pcComponents.push_back(std::move(m));
+    }
+
+    // Aggregate as in the full calculation
+    SimmResults whatIfResults;
+    for (const auto& c : components)
+        for (const auto& m : c.second)
+            add(whatIfResults, nettingSetDetails, regulation, c.first, std::get<0>(m), std::get<1>(m), std::get<2>(m),
+                side);
+    populateResults(whatIfResults, side, nettingSetDetails, regulation);
+    calcAddMargin(whatIfResults, side, nettingSetDetails, regulation, netRecords);
+    if (resultCcy_ != "USD")
+        whatIfResults.convert(resultCcyFxSpot(), resultCcy_);
+
+    const Real simm = whatIfResults.get(ProductClass::All, RiskClass::All, MarginType::All, "All");
+    if (results)
+        *results = whatIfResults;
+    return make_pair(simm, simm - baseSimm);
+}
+
+map<string, Real> SimmCalculator::eulerAllocation(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
+                                                  const string& regulation) const {
+
+    const boost::shared_ptr<CrifLoader>* loader = findEntry(regSensitivities_, side, nettingSetDetails, regulation);
+    QL_REQUIRE(loader, "SimmCalculator::eulerAllocation(): no " << side << " CRIF records for netting set ["
+                                                                << nettingSetDetails << "] and regulation "
+                                                                << regulation);
+    const SimmNetSensitivities netRecords = (*loader)->netRecords(true);
+
+    // The margin components of each product class and their gradients
+    auto& indexProduct = netRecords.get<ProductClassTag>();
+    CorrelationCache cache;
+    Gradient gradient;
+    for (auto it = indexProduct.begin(); it != indexProduct.end();
+         it = indexProduct.upper_bound(make_tuple(nettingSetDetails, it->productClass))) {
+        const ProductClass pc = it->productClass;
+        ComponentGradients gradients;
+        MarginComponents components =
+            productClassMargins(nettingSetDetails, pc, side, netRecords, cache, nullptr, &gradients);
+
+        // The risk class margins and the product class margin, as in populateResults()
+        map<RiskClass, Real> riskClassMargins;
+        for (const auto& m : components)
+            riskClassMargins[std::get<0>(m)] += std::get<2>(m).at("All");
+        Real im = 0.0;
+        for (const auto& o : riskClassMargins) {
+            im += o.second * o.second;
+            for (const auto& i : riskClassMargins)
+                if (i.first < o.first)
+                    im += 2.0 * simmConfiguration_->correlationRiskClasses(o.first, i.first) * o.second * i.second;
+        }
+        if (im <= 0.0)
+            continue;
+        im = sqrt(im);
+
+        // The product class multipliers scale the product class margin, see calcAddMargin()
+        Real factor = 1.0;
+        auto& ssRiskTypeIndex = netRecords.get<RiskTypeTag>();
+        auto p = ssRiskTypeIndex.equal_range(
+            make_tuple(nettingSetDetails, ProductClass::Empty, RiskType::ProductClassMultiplier));
+        for (; p.first != p.second; ++p.first)
+            if (parseSimmProductClass(p.first->qualifier) == pc)
+                factor += p.first->amount - 1.0;
+
+        // Derivatives of the product class margin with respect to the risk class margins, chained with the gradients
+        // of the components
+        for (const auto& g : gradients) {
+            const RiskClass rc = g.first.first;
+            Real d = 0.0;
+            for (const auto& m : riskClassMargins)
+                d += (m.first == rc ? 1.0 : simmConfiguration_->correlationRiskClasses(rc, m.first)) * m.second;
+            d *= factor / im;
+            for (const auto& r : g.second)
+                gradient[r.first] += d * r.second;
+        }
+    }
+
+    // The notional based add-on is linear in the notionals, see calcAddMargin()
+    auto& ssRiskTypeIndex = netRecords.get<RiskTypeTag>();
+    auto& ssQualifierIndex = netRecords.get<QualifierTag>();
+    auto p = ssRiskTypeIndex.equal_range(
+        make_tuple(nettingSetDetails, ProductClass::Empty, RiskType::AddOnNotionalFactor));
+    for (; p.first != p.second; ++p.first) {
+        auto q = ssQualifierIndex.equal_range(
+            make_tuple(nettingSetDetails, ProductClass::Empty, RiskType::Notional, p.first->qualifier));
+        for (; q.first != q.second; ++q.first)
+            gradient[&*q.first] += p.first->amount / 100.0;
+    }
+
+    // The derivatives by risk factor, the trade records are netted to the records with the same risk factor
+    typedef std::tuple<ProductClass, RiskType, string, string, string, string> RiskFactor;
+    map<RiskFactor, Real> derivatives;
+    for (const auto& g : gradient) {
+        const CrifRecord& cr = *g.first;
+        derivatives[RiskFactor(cr.productClass, cr.riskType, cr.qualifier, cr.bucket, cr.label1, cr.label2)] +=
+            g.second;
+    }
+
+    // The trades of the regulation, including the CFTC trades for SEC, see the constructor
+    set<string> tradeIds;
+    if (const set<string>* t = findEntry(tradeIds_, side, nettingSetDetails, regulation))
+        tradeIds = *t;
+    if (regulation == "SEC" && findEntry(regSensitivities_, side, nettingSetDetails, "CFTC")) {
+        if (const set<string>* t = findEntry(tradeIds_, side, nettingSetDetails, "CFTC"))
+            tradeIds.insert(t->begin(), t->end());
+    }
+
+    // Allocate to the trades
+    const Real fxSpot = resultCcy_ == "USD" ? 1.0 : resultCcyFxSpot();
+    map<string, Real> allocation;
+    for (const CrifRecord& cr : simmNetSensitivities_) {
+        if (cr.nettingSetDetails != nettingSetDetails || (!cr.tradeId.empty() && tradeIds.count(cr.tradeId) == 0))
+            continue;
+        auto d = derivatives.find(
+            RiskFactor(cr.productClass, cr.riskType, cr.qualifier, cr.bucket, cr.label1, cr.label2));
+        if (d != derivatives.end())
+            allocation[cr.tradeId] += cr.amountUsd * d->second * fxSpot;
+    }
+
+    return allocation;
+}
+
+SimmCalculator::MarginComponents
+SimmCalculator::productClassMargins(const NettingSetDetails& nettingSetDetails, const ProductClass& productClass,
+                                    const SimmSide& side, const SimmNetSensitivities& netRecords,
+                                    CorrelationCache& cache, const set<RiskClass>* riskClasses,
+                                    ComponentGradients* gradients) const {
+
+    if (!quiet_) {
+        LOG("SimmCalculator: Calculating SIMM for product class " << productClass);
+    }
+
+    MarginComponents margins;
+
+    // Calculate a component unless its risk class is excluded
+    auto addMargin = [&margins, riskClasses, gradients](
+                         const RiskClass& rc, const MarginType& mt,
+                         const std::function<pair<map<string, Real>, bool>(Gradient*)>& calculate) {
+        if (riskClasses && riskClasses->count(rc) == 0)
+            return;
+        Gradient gradient;
+        auto p = calculate(gradients ? &gradient : nullptr);
+        if (p.second) {
+            margins.emplace_back(rc, mt, p.first);
+            if (gradients)
+                (*gradients)[make_pair(rc, mt)] = std::move(gradient);
+        }
+    };
+    const NettingSetDetails& nsd = nettingSetDetails;
+    const ProductClass& pc = productClass;
+
+    // Delta margin components
+    MarginType mt = MarginType::Delta;
+    addMargin(RiskClass::InterestRate, mt, [&](Gradient* g) { return irDeltaMargin(nsd, pc, netRecords, g); });
+    addMargin(RiskClass::FX, mt, [&](Gradient* g) { return margin(nsd, pc, RiskType::FX, netRecords, cache, g); });
+    addMargin(RiskClass::CreditQualifying, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::CreditQ, netRecords, cache, g); });
+    addMargin(RiskClass::CreditNonQualifying, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::CreditNonQ, netRecords, cache, g); });
+    addMargin(RiskClass::Equity, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::Equity, netRecords, cache, g); });
+    addMargin(RiskClass::Commodity, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::Commodity, netRecords, cache, g); });
+
+    // Vega margin components
+    mt = MarginType::Vega;
+    addMargin(RiskClass::InterestRate, mt, [&](Gradient* g) { return irVegaMargin(nsd, pc, netRecords, g); });
+    addMargin(RiskClass::FX, mt, [&](Gradient* g) { return margin(nsd, pc, RiskType::FXVol, netRecords, cache, g); });
+    addMargin(RiskClass::CreditQualifying, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::CreditVol, netRecords, cache, g); });
+    addMargin(RiskClass::CreditNonQualifying, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::CreditVolNonQ, netRecords, cache, g); });
+    addMargin(RiskClass::Equity, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::EquityVol, netRecords, cache, g); });
+    addMargin(RiskClass::Commodity, mt,
+              [&](Gradient* g) { return margin(nsd, pc, RiskType::CommodityVol, netRecords, cache, g); });
+
+    // Curvature margin components for sides call and post
+    mt = MarginType::Curvature;
+    addMargin(RiskClass::InterestRate, mt,
+              [&](Gradient* g) { return irCurvatureMargin(nsd, pc, side, netRecords, g); });
+    addMargin(RiskClass::FX, mt,
+              [&](Gradient* g) {
+                  return curvatureMargin(nsd, pc, RiskType::FXVol, side, netRecords, cache, false, g);
+              });
+    addMargin(RiskClass::CreditQualifying, mt,
+              [&](Gradient* g) {
+                  return curvatureMargin(nsd, pc, RiskType::CreditVol, side, netRecords, cache, true, g);
+              });
+    addMargin(RiskClass::CreditNonQualifying, mt,
+              [&](Gradient* g) {
+                  return curvatureMargin(nsd, pc, RiskType::CreditVolNonQ, side, netRecords, cache, true, g);
+              });
+    addMargin(RiskClass::Equity, mt,
+              [&](Gradient* g) {
+                  return curvatureMargin(nsd, pc, RiskType::EquityVol, side, netRecords, cache, false, g);
+              });
+    addMargin(RiskClass::Commodity, mt,
+              [&](Gradient* g) {
+                  return curvatureMargin(nsd, pc, RiskType::CommodityVol, side, netRecords, cache, false, g);
+              });
+
+    // Base correlation margin components. This risk type came later so need to check
+    // first if it is valid under the configuration
+    if (simmConfiguration_->isValidRiskType(RiskType::BaseCorr))
+        addMargin(RiskClass::CreditQualifying, MarginType::BaseCorr,
+                  [&](Gradient* g) { return margin(nsd, pc, RiskType::BaseCorr, netRecords, cache, g); });
+
+    return margins;
 }
 
 const string& SimmCalculator::winningRegulations(const SimmSide& side, const NettingSetDetails& nettingSetDetails) const {
@@ -418,7 +851,8 @@ const map<SimmSide, map<NettingSetDetails, pair<string, SimmResults>>>& SimmCalc
 
 pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDetails& nettingSetDetails,
                                                             const ProductClass& pc,
-                                                            const SimmNetSensitivities& netRecords) const {
+                                                            const SimmNetSensitivities& netRecords,
+                                                            Gradient* gradient) const {
 
     // "Bucket" here referse to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -468,6 +902,8 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
     map<string, Real> deltaMargin;
     // The sum of the weighted sensitivities for each currency i.e. $\sum_{i,k} WS_{k,i}$ from SIMM docs
     map<string, Real> sumWeightedSensis;
+    // For the gradient, the derivatives of the weighted sensitivities and delta margins for each currency
+    map<string, BucketGradient> bucketGradients;
 
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
@@ -583,6 +1019,42 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
 
         // Finally have the value of $K_b$
         deltaMargin[qualifier] = sqrt(max(deltaMargin[qualifier], 0.0));
+
+        // For the gradient, the derivatives of the weighted sensitivities and of half of $K_b^2$
+        if (gradient) {
+            BucketGradient& bg = bucketGradients[qualifier];
+            std::vector<Real> ws;
+            for (auto it = pIrQualifier.first; it != pIrQualifier.second; ++it) {
+                bg.records.push_back(&*it);
+                bg.w.push_back(simmConfiguration_->weight(RiskType::IRCurve, qualifier, it->label1) *
+                               concentrationRisk[qualifier]);
+            }
+            if (itInflation != ssQualifierIndex.end()) {
+                bg.records.push_back(&*itInflation);
+                bg.w.push_back(simmConfiguration_->weight(RiskType::Inflation, qualifier, itInflation->label1) *
+                               concentrationRisk[qualifier]);
+            }
+            if (itXccy != ssQualifierIndex.end()) {
+                bg.records.push_back(&*itXccy);
+                bg.w.push_back(simmConfiguration_->weight(RiskType::XCcyBasis, qualifier, itXccy->label1));
+            }
+            for (Size k = 0; k < bg.records.size(); ++k)
+                ws.push_back(bg.w[k] * bg.records[k]->amountUsd);
+            addQuadraticFormDerivatives(bg, ws, [this, &bg, &qualifier](const Size k, const Size l) {
+                const CrifRecord& a = *bg.records[k];
+                const CrifRecord& b = *bg.records[l];
+                if (a.riskType == RiskType::IRCurve && b.riskType == RiskType::IRCurve)
+                    return simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", a.label2,
+                                                           RiskType::IRCurve, qualifier, "", b.label2) *
+                           simmConfiguration_->correlation(RiskType::IRCurve, qualifier, a.label1, "",
+                                                           RiskType::IRCurve, qualifier, b.label1, "");
+                // IRCurve vs. Inflation or XccyBasis, Inflation vs. XccyBasis, as in the margin calculation above
+                RiskType first = a.riskType, second = b.riskType;
+                if (second == RiskType::IRCurve || (first == RiskType::XCcyBasis && second == RiskType::Inflation))
+                    std::swap(first, second);
+                return simmConfiguration_->correlation(first, qualifier, "", "", second, qualifier, "", "");
+            });
+        }
     }
 
     // Now calculate final IR delta margin by aggregating across currencies
@@ -603,6 +1075,29 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
     }
     margin = sqrt(max(margin, 0.0));
 
+    // Back propagate the derivatives of the margin to the records
+    if (gradient) {
+        std::vector<Real> k, sums, dk, dsum;
+        std::vector<std::vector<Real>> gamma;
+        for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
+            k.push_back(deltaMargin.at(*itOuter));
+            sums.push_back(sumWeightedSensis.at(*itOuter));
+            gamma.emplace_back();
+            for (auto itInner = qualifiers.begin(); itInner != itOuter; ++itInner) {
+                Real g = min(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner)) /
+                         max(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner));
+                gamma.back().push_back(g * simmConfiguration_->correlation(RiskType::IRCurve, *itOuter, "", "",
+                                                                           RiskType::IRCurve, *itInner, "", ""));
+            }
+        }
+        crossBucketAggregation(k, sums, gamma, dk, dsum);
+        Size b = 0;
+        for (const auto& q : qualifiers) {
+            addBucketGradient(bucketGradients[q], deltaMargin.at(q), dk[b], dsum[b], *gradient);
+            ++b;
+        }
+    }
+
     for (const auto& m : deltaMargin)
         bucketMargins[m.first] = m.second;
     bucketMargins["All"] = margin;
@@ -612,7 +1107,8 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
 
 pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetails& nettingSetDetails,
                                                            const SimmConfiguration::ProductClass& pc,
-                                                           const SimmNetSensitivities& netRecords) const {
+                                                           const SimmNetSensitivities& netRecords,
+                                                           Gradient* gradient) const {
 
     // "Bucket" here refers to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -654,6 +1150,8 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
     map<string, Real> vegaMargin;
     // The sum of the weighted sensitivities for each currency i.e. $\sum_{k=1}^K VR_{k}$ from SIMM docs
     map<string, Real> sumWeightedSensis;
+    // For the gradient, the derivatives of the weighted sensitivities and vega margins for each currency
+    map<string, BucketGradient> bucketGradients;
 
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
@@ -736,6 +1234,33 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
 
         // Finally have the value of $K_b$
         vegaMargin[qualifier] = sqrt(max(vegaMargin[qualifier], 0.0));
+
+        // For the gradient, the derivatives of the weighted sensitivities and of half of $K_b^2$
+        if (gradient) {
+            BucketGradient& bg = bucketGradients[qualifier];
+            std::vector<Real> ws;
+            for (auto it = pIrQualifier.first; it != pIrQualifier.second; ++it) {
+                bg.records.push_back(&*it);
+                bg.w.push_back(simmConfiguration_->weight(RiskType::IRVol, qualifier, it->label1) *
+                               concentrationRisk[qualifier]);
+            }
+            for (auto it = pInfQualifier.first; it != pInfQualifier.second; ++it) {
+                bg.records.push_back(&*it);
+                bg.w.push_back(simmConfiguration_->weight(RiskType::InflationVol, qualifier, it->label1) *
+                               concentrationRisk[qualifier]);
+            }
+            for (Size k = 0; k < bg.records.size(); ++k)
+                ws.push_back(bg.w[k] * bg.records[k]->amountUsd);
+            addQuadraticFormDerivatives(bg, ws, [this, &bg, &qualifier](const Size k, const Size l) {
+                const CrifRecord* a = bg.records[k];
+                const CrifRecord* b = bg.records[l];
+                // InflationVol first, as in the margin calculation above
+                if (b->riskType == RiskType::InflationVol)
+                    std::swap(a, b);
+                return simmConfiguration_->correlation(a->riskType, qualifier, a->label1, "", b->riskType, qualifier,
+                                                       b->label1, "");
+            });
+        }
     }
 
     // Now calculate final vega margin by aggregating across currencies
@@ -756,6 +1281,30 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
     }
     margin = sqrt(max(margin, 0.0));
 
+    // Back propagate the derivatives of the margin to the records
+    if (gradient) {
+        std::vector<Real> k, sums, dk, dsum;
+        std::vector<std::vector<Real>> gamma;
+        for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
+            k.push_back(vegaMargin.at(*itOuter));
+            sums.push_back(sumWeightedSensis.at(*itOuter));
+            gamma.emplace_back();
+            for (auto itInner = qualifiers.begin(); itInner != itOuter; ++itInner) {
+                Real g = min(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner)) /
+                         max(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner));
+                gamma.back().push_back(g * simmConfiguration_->correlation(RiskType::IRVol, *itOuter, "", "",
+                                                                           RiskType::IRVol, *itInner, "", "",
+                                                                           calculationCcy_));
+            }
+        }
+        crossBucketAggregation(k, sums, gamma, dk, dsum);
+        Size b = 0;
+        for (const auto& q : qualifiers) {
+            addBucketGradient(bucketGradients[q], vegaMargin.at(q), dk[b], dsum[b], *gradient);
+            ++b;
+        }
+    }
+
     for (const auto& m : vegaMargin)
         bucketMargins[m.first] = m.second;
     bucketMargins["All"] = margin;
@@ -766,7 +1315,8 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
 pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSetDetails& nettingSetDetails,
                                                                 const SimmConfiguration::ProductClass& pc,
                                                                 const SimmSide& side,
-                                                                const SimmNetSensitivities& netRecords) const {
+                                                                const SimmNetSensitivities& netRecords,
+                                                                Gradient* gradient) const {
 
     // "Bucket" here refers to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -813,6 +1363,8 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
     Real sumWs = 0.0;
     // The sum of the absolute value of weighted sensitivities across currencies and risk factors
     Real sumAbsWs = 0.0;
+    // For the gradient, the derivatives of the weighted curvatures and curvature margins for each currency
+    map<string, BucketGradient> bucketGradients;
 
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
@@ -882,6 +1434,41 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
 
         // Finally have the value of $K_b$
         curvatureMargin[qualifier] = sqrt(max(curvatureMargin[qualifier], 0.0));
+
+        // For the gradient, the derivatives of the weighted curvatures and of half of $K_b^2$. The InflationVol
+        // records enter through their sum, i.e. they have correlation one between each other.
+        if (gradient) {
+            BucketGradient& bg = bucketGradients[qualifier];
+            std::vector<Real> ws;
+            for (auto it = pIrQualifier.first; it != pIrQualifier.second; ++it) {
+                bg.records.push_back(&*it);
+                bg.w.push_back(simmConfiguration_->curvatureWeight(RiskType::IRVol, it->label1) * multiplier);
+            }
+            if (version > thresholdVersion) {
+                for (auto it = pInfQualifier.first; it != pInfQualifier.second; ++it) {
+                    bg.records.push_back(&*it);
+                    bg.w.push_back(simmConfiguration_->curvatureWeight(RiskType::InflationVol, it->label1) *
+                                   multiplier);
+                }
+            }
+            for (Size k = 0; k < bg.records.size(); ++k)
+                ws.push_back(bg.w[k] * bg.records[k]->amountUsd);
+            addQuadraticFormDerivatives(bg, ws, [this, &bg, &qualifier](const Size k, const Size l) -> Real {
+                const CrifRecord* a = bg.records[k];
+                const CrifRecord* b = bg.records[l];
+                if (a->riskType == RiskType::InflationVol && b->riskType == RiskType::InflationVol)
+                    return 1.0;
+                Real corr;
+                if (a->riskType == RiskType::IRVol && b->riskType == RiskType::IRVol)
+                    corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, a->label1, "", RiskType::IRVol,
+                                                           qualifier, b->label1, "");
+                else
+                    corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, "", "",
+                                                           RiskType::IRVol, qualifier,
+                                                           a->riskType == RiskType::IRVol ? a->label1 : b->label1, "");
+                return corr * corr;
+            });
+        }
     }
 
     // If sum of absolute value of all individual curvature risks is zero, we can return 0.0
@@ -914,6 +1501,29 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
         bucketMargins[m.first] = m.second;
 
     Real scaling = simmConfiguration_->curvatureMarginScaling();
+
+    // Back propagate the derivatives of the margin to the records, with $\lambda$ held fixed
+    if (gradient && margin > 0.0) {
+        std::vector<Real> k, sums, dk, dsum;
+        std::vector<std::vector<Real>> gamma;
+        for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
+            k.push_back(curvatureMargin.at(*itOuter));
+            sums.push_back(sumWeightedSensis.at(*itOuter));
+            gamma.emplace_back();
+            for (auto itInner = qualifiers.begin(); itInner != itOuter; ++itInner) {
+                Real corr = simmConfiguration_->correlation(RiskType::IRVol, *itOuter, "", "", RiskType::IRVol,
+                                                            *itInner, "", "");
+                gamma.back().push_back(corr * corr);
+            }
+        }
+        crossBucketAggregation(k, sums, gamma, dk, dsum);
+        Size b = 0;
+        for (const auto& q : qualifiers) {
+            addBucketGradient(bucketGradients[q], curvatureMargin.at(q), scaling * lambda(theta) * dk[b],
+                              scaling * (1.0 + lambda(theta) * dsum[b]), *gradient);
+            ++b;
+        }
+    }
     Real totalCurvatureMargin = scaling * max(margin, 0.0);
     // TODO: Review, should we return the pre-scaled value instead?
     bucketMargins["All"] = totalCurvatureMargin;
@@ -922,7 +1532,8 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
 }
 
 pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc,
-                                                     const RiskType& rt, const SimmNetSensitivities& netRecords) const {
+                                                     const RiskType& rt, const SimmNetSensitivities& netRecords,
+                                                     CorrelationCache& cache, Gradient* gradient) const {
     
     // "Bucket" here refers to exposures under the CRIF qualifiers for FX (and IR) risk class, and CRIF buckets for
     // every other risk class.
@@ -960,6 +1571,8 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
     map<string, Real> sumWeightedSensis;
     // The historical volatility ratio for the risk type - will be 1.0 if not applicable
     Real hvr = simmConfiguration_->historicalVolatilityRatio(rt);
+    // For the gradient, the derivatives of the weighted sensitivities and bucket margins for each bucket
+    map<string, BucketGradient> bucketGradients;
 
     // Loop over the buckets
     for (const auto& kv : buckets) {
@@ -997,61 +1610,73 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
             concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
         }
 
-        // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
+        // Compile the records of the current bucket and get their weighted sensitivities, i.e. $WS_{k}$ from SIMM
+        // docs, in one pass
         auto pBucket = ssBucketIndex.equal_range(make_tuple(nettingSetDetails, pc, rt, bucket));
-        for (auto itOuter = pBucket.first; itOuter != pBucket.second; ++itOuter) {
+        std::vector<const CrifRecord*> records;
+        std::vector<Real> ws, cr;
+        for (auto it = pBucket.first; it != pBucket.second; ++it) {
             // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-            if (rt == RiskType::FX && itOuter->qualifier == calculationCcy_) {
+            if (rt == RiskType::FX && it->qualifier == calculationCcy_) {
                 if (!quiet_) {
-                    DLOG("Skipping qualifier " << itOuter->qualifier << " of risk type " << rt
+                    DLOG("Skipping qualifier " << it->qualifier << " of risk type " << rt
                                                << " since the qualifier equals the SIMM calculation currency "
                                                << calculationCcy_);
                 }
                 continue;
             }
             // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(rt, itOuter->qualifier, itOuter->label1, calculationCcy_);
+            Real rw = simmConfiguration_->weight(rt, it->qualifier, it->label1, calculationCcy_);
             // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calculationCcy_);
-            // Weighted sensitivity i.e. $WS_{k}$ from SIMM docs
-            Real wsOuter = rwOuter * (itOuter->amountUsd * sigmaOuter * hvr) * concentrationRisk[itOuter->qualifier];
+            Real sigma = simmConfiguration_->sigma(rt, it->qualifier, it->label1, calculationCcy_);
+            records.push_back(&*it);
+            cr.push_back(concentrationRisk[it->qualifier]);
+            ws.push_back(rw * (it->amountUsd * sigma * hvr) * cr.back());
+            if (gradient)
+                bucketGradients[bucket].w.push_back(rw * sigma * hvr * cr.back());
+        }
+        auto compiled = cache.compile(rt, bucket, records, [this, &rt](const CrifRecord& a, const CrifRecord& b) {
+            // Correlation, $\rho_{k,l}$ in the SIMM docs
+            return simmConfiguration_->correlation(rt, a.qualifier, a.label1, a.label2, rt, b.qualifier, b.label1,
+                                                   b.label2, calculationCcy_);
+        });
+
+        // Calculate the margin component for the current bucket. Row k of the lower triangle of the matrix
+        // $\rho_{k,l} f_{k,l}$ is materialised and multiplied with the weighted sensitivities.
+        Real& kb = bucketMargin[bucket];
+        std::vector<Real> row(compiled.size());
+        // For the gradient, the matrix times the weighted sensitivities
+        std::vector<Real> g(gradient ? compiled.size() : 0, 0.0);
+        for (Size k = 0; k < compiled.size(); ++k) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
-            // Add diagonal element to bucket margin
-            bucketMargin[bucket] += wsOuter * wsOuter;
-            // Add the cross elements to the bucket margin
-            for (auto itInner = pBucket.first; itInner != itOuter; ++itInner) {
-                // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-                if (rt == RiskType::FX && itInner->qualifier == calculationCcy_) {
-                    if (!quiet_) {
-                        DLOG("Skipping qualifier " << itInner->qualifier << " of risk type " << rt
-                                                   << " since the qualifier equals the SIMM calculation currency "
-                                                   << calculationCcy_);
-                    }
-                    continue;
-                }
-                // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr = simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2,
-                                                            rt, itInner->qualifier, itInner->label1, itInner->label2,
-                                                            calculationCcy_);
+            sumWeightedSensis[bucket] += ws[k];
+            compiled.correlations(k, row.data());
+            for (Size l = 0; l < k; ++l) {
                 // $f_{k,l}$ from the SIMM docs
-                Real f = min(concentrationRisk.at(itOuter->qualifier), concentrationRisk.at(itInner->qualifier)) /
-                         max(concentrationRisk.at(itOuter->qualifier), concentrationRisk.at(itInner->qualifier));
-                // Add cross element to delta margin
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calculationCcy_);
-                Real rwInner = simmConfiguration_->weight(rt, itInner->qualifier, itInner->label1, calculationCcy_);
-                Real wsInner =
-                    rwInner * (itInner->amountUsd * sigmaInner * hvr) * concentrationRisk[itInner->qualifier];
-                bucketMargin[bucket] += 2 * corr * f * wsOuter * wsInner;
+                row[l] *= min(cr[k], cr[l]) / max(cr[k], cr[l]);
+            }
+            const Real rowWs = dot(row.data(), ws.data(), k);
+            // Add diagonal and cross elements to bucket margin
+            kb += ws[k] * (ws[k] + 2.0 * rowWs);
+            if (gradient) {
+                g[k] += ws[k] + rowWs;
+                for (Size l = 0; l < k; ++l)
+                    g[l] += row[l] * ws[k];
             }
             // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[compiled.record(k).qualifier] += ws[k];
         }
 
         // Finally have the value of $K_b$
         bucketMargin[bucket] = sqrt(max(bucketMargin[bucket], 0.0));
+
+        if (gradient) {
+            BucketGradient& bg = bucketGradients[bucket];
+            bg.records = records;
+            for (Size k = 0; k < g.size(); ++k)
+                bg.h.push_back(bg.w[k] * g[k]);
+        }
     }
 
     // If there is a "Residual" bucket entry store it separately
@@ -1087,6 +1712,31 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
     }
     margin = sqrt(max(margin, 0.0));
 
+    // Back propagate the derivatives of the margin to the records
+    if (gradient) {
+        std::vector<Real> k, sums, dk, dsum;
+        std::vector<std::vector<Real>> gamma;
+        for (auto itOuter = bucketMargin.begin(); itOuter != bucketMargin.end(); ++itOuter) {
+            k.push_back(itOuter->second);
+            sums.push_back(sumWeightedSensis.at(itOuter->first));
+            gamma.emplace_back();
+            string outerQualifier = *buckets.at(itOuter->first).begin();
+            for (auto itInner = bucketMargin.begin(); itInner != itOuter; ++itInner) {
+                string innerQualifier = *buckets.at(itInner->first).begin();
+                gamma.back().push_back(simmConfiguration_->correlation(rt, outerQualifier, "", "", rt, innerQualifier,
+                                                                       "", "", calculationCcy_));
+            }
+        }
+        crossBucketAggregation(k, sums, gamma, dk, dsum);
+        Size b = 0;
+        for (const auto& m : bucketMargin) {
+            addBucketGradient(bucketGradients[m.first], m.second, dk[b], dsum[b], *gradient);
+            ++b;
+        }
+        if (bucketGradients.count("Residual") > 0)
+            addBucketGradient(bucketGradients.at("Residual"), residualMargin, 1.0, 0.0, *gradient);
+    }
+
     // Now add the residual component back in
     margin += residualMargin;
     if (!close_enough(residualMargin, 0.0))
@@ -1106,7 +1756,8 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
 
 pair<map<string, Real>, bool>
 SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc, const RiskType& rt,
-                                const SimmSide& side, const SimmNetSensitivities& netRecords, bool rfLabels) const {
+                                const SimmSide& side, const SimmNetSensitivities& netRecords,
+                                CorrelationCache& cache, bool rfLabels, Gradient* gradient) const {
 
     // "Bucket" here refers to exposures under the CRIF qualifiers for FX (and IR) risk class, and CRIF buckets for
     // every other risk class
@@ -1145,57 +1796,79 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
     map<string, Real> sumWeightedSensis;
     map<string, map<string, Real>> sumAbsTemp;
     map<string, Real> sumAbsWeightedSensis;
+    // For the gradient, the derivatives of the weighted curvatures and bucket margins for each bucket
+    map<string, BucketGradient> bucketGradients;
 
     // Loop over the buckets
     for (const auto& kv : buckets) {
         string bucket = kv.first;
         sumAbsTemp[bucket] = {};
 
-        // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
+        // Compile the records of the current bucket and get their weighted curvatures, i.e. $CVR_{ik}$ from SIMM
+        // docs, in one pass
         auto pBucket = ssBucketIndex.equal_range(make_tuple(nettingSetDetails, pc, rt, bucket));
-        for (auto itOuter = pBucket.first; itOuter != pBucket.second; ++itOuter) {
+        // for ISDA SIMM 2.2 or higher, this $CVR_{ik}$ for EQ bucket 12 is zero
+        SimmVersion version = parseSimmVersion(simmConfiguration_->version());
+        SimmVersion thresholdVersion = SimmVersion::V2_2;
+        const bool zeroCurvature = version >= thresholdVersion && bucket == "12" && rt == RiskType::EquityVol;
+        std::vector<const CrifRecord*> records;
+        std::vector<Real> ws;
+        for (auto it = pBucket.first; it != pBucket.second; ++it) {
             // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
-            Real sfOuter = simmConfiguration_->curvatureWeight(rt, itOuter->label1);
+            Real sf = simmConfiguration_->curvatureWeight(rt, it->label1);
             // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calculationCcy_);
-            // Weighted curvature i.e. $CVR_{ik}$ from SIMM docs
+            Real sigma = simmConfiguration_->sigma(rt, it->qualifier, it->label1, calculationCcy_);
             // WARNING: The order of multiplication here is important because unit tests fail if for
-            //          example you use sfOuter * (itOuter->amountUsd * multiplier) * sigmaOuter;
-            Real wsOuter = sfOuter * ((itOuter->amountUsd * multiplier) * sigmaOuter);
-            // for ISDA SIMM 2.2 or higher, this $CVR_{ik}$ for EQ bucket 12 is zero
-            SimmVersion version = parseSimmVersion(simmConfiguration_->version());
-            SimmVersion thresholdVersion = SimmVersion::V2_2;
-            if (version >= thresholdVersion && bucket == "12" && rt == RiskType::EquityVol) {
-                wsOuter = 0.0;
-            }
+            //          example you use sf * (it->amountUsd * multiplier) * sigma;
+            records.push_back(&*it);
+            ws.push_back(zeroCurvature ? 0.0 : sf * ((it->amountUsd * multiplier) * sigma));
+            if (gradient)
+                bucketGradients[bucket].w.push_back(zeroCurvature ? 0.0 : sf * multiplier * sigma);
+        }
+        auto compiled = cache.compile(rt, bucket, records, [this, &rt](const CrifRecord& a, const CrifRecord& b) {
+            // Correlation, $\rho_{k,l}$ in the SIMM docs
+            return simmConfiguration_->correlation(rt, a.qualifier, a.label1, a.label2, rt, b.qualifier, b.label1,
+                                                   b.label2, calculationCcy_);
+        });
+
+        // Calculate the margin component for the current bucket. Row k of the lower triangle of the matrix
+        // $\rho_{k,l}^2$ is materialised and multiplied with the weighted curvatures.
+        Real& kb = curvatureMargin[bucket];
+        std::vector<Real> row(compiled.size());
+        // For the gradient, the matrix times the weighted curvatures
+        std::vector<Real> g(gradient ? compiled.size() : 0, 0.0);
+        for (Size k = 0; k < compiled.size(); ++k) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
-            sumAbsTemp[bucket][itOuter->qualifier] += rfLabels ? std::abs(wsOuter) : wsOuter;
-            // Add diagonal element to curvature margin
-            curvatureMargin[bucket] += wsOuter * wsOuter;
-            // Add the cross elements to the curvature margin
-            for (auto itInner = pBucket.first; itInner != itOuter; ++itInner) {
-                // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr = simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2,
-                                                            rt, itInner->qualifier, itInner->label1, itInner->label2,
-                                                            calculationCcy_);
-                // Add cross element to delta margin
-                Real sfInner = simmConfiguration_->curvatureWeight(rt, itInner->label1);
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calculationCcy_);
-                Real wsInner = sfInner * ((itInner->amountUsd * multiplier) * sigmaInner);
-                curvatureMargin[bucket] += 2 * corr * corr * wsOuter * wsInner;
+            sumWeightedSensis[bucket] += ws[k];
+            sumAbsTemp[bucket][compiled.record(k).qualifier] += rfLabels ? std::abs(ws[k]) : ws[k];
+            compiled.correlations(k, row.data());
+            for (Size l = 0; l < k; ++l)
+                row[l] *= row[l];
+            const Real rowWs = dot(row.data(), ws.data(), k);
+            // Add diagonal and cross elements to curvature margin
+            kb += ws[k] * (ws[k] + 2.0 * rowWs);
+            if (gradient) {
+                g[k] += ws[k] + rowWs;
+                for (Size l = 0; l < k; ++l)
+                    g[l] += row[l] * ws[k];
             }
             // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not
             // used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[compiled.record(k).qualifier] += ws[k];
         }
 
         // Finally have the value of $K_b$
         Real bucketCurvatureMargin = sqrt(max(curvatureMargin[bucket], 0.0));
         curvatureMargin[bucket] = bucketCurvatureMargin;
 
+        if (gradient) {
+            BucketGradient& bg = bucketGradients[bucket];
+            bg.records = records;
+            for (Size k = 0; k < g.size(); ++k)
+                bg.h.push_back(bg.w[k] * g[k]);
+        }
+
         // Bucket level absolute sensitivity
         for (const auto& kv : sumAbsTemp[bucket]) {
             sumAbsWeightedSensis[bucket] += std::abs(kv.second);
@@ -1249,6 +1922,31 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
             }
         }
         margin = max(sumSensis + lambda(theta) * sqrt(max(margin, 0.0)), 0.0);
+
+        // Back propagate the derivatives of the margin to the records, with $\lambda$ held fixed
+        if (gradient && margin > 0.0) {
+            std::vector<Real> k, sums, dk, dsum;
+            std::vector<std::vector<Real>> gamma;
+            for (auto itOuter = curvatureMargin.begin(); itOuter != curvatureMargin.end(); ++itOuter) {
+                k.push_back(itOuter->second);
+                sums.push_back(sumWeightedSensis.at(itOuter->first));
+                gamma.emplace_back();
+                string outerQualifier = *buckets.at(itOuter->first).begin();
+                for (auto itInner = curvatureMargin.begin(); itInner != itOuter; ++itInner) {
+                    string innerQualifier = *buckets.at(itInner->first).begin();
+                    Real corr = simmConfiguration_->correlation(rt, outerQualifier, "", "", rt, innerQualifier, "", "",
+                                                                calculationCcy_);
+                    gamma.back().push_back(corr * corr);
+                }
+            }
+            crossBucketAggregation(k, sums, gamma, dk, dsum);
+            Size b = 0;
+            for (const auto& m : curvatureMargin) {
+                addBucketGradient(bucketGradients[m.first], m.second, lambda(theta) * dk[b],
+                                  1.0 + lambda(theta) * dsum[b], *gradient);
+                ++b;
+            }
+        }
     }
 
     // Second, the residual bucket if necessary, and add "Residual" bucket back in to be added to the SIMM results
@@ -1256,6 +1954,8 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
         Real theta = min(residualSum / residualAbsSum, 0.0);
         curvatureMargin["Residual"] = max(residualSum + lambda(theta) * residualMargin, 0.0);
         margin += curvatureMargin["Residual"];
+        if (gradient && curvatureMargin["Residual"] > 0.0)
+            addBucketGradient(bucketGradients.at("Residual"), residualMargin, lambda(theta), 1.0, *gradient);
     }
 
     // For non-FX risk class, results are broken down by buckets
@@ -1270,15 +1970,13 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
     return make_pair(bucketMargins, true);
 }
 
-void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                   const string& regulation, const SimmNetSensitivities& netRecords) {
+void SimmCalculator::calcAddMargin(SimmResults& results, const SimmSide& side,
+                                   const NettingSetDetails& nettingSetDetails, const string& regulation,
+                                   const SimmNetSensitivities& netRecords) const {
 
     // Index on SIMM sensitivities in to risk type level
     auto& ssRiskTypeIndex = netRecords.get<RiskTypeTag>();
 
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
-
     const bool overwrite = false;
 
     if (!quiet_) {
@@ -1302,16 +2000,16 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             QL_REQUIRE(factor >= 0.0, "SIMM Calculator: Amount for risk type "
                 << rt << " must be greater than or equal to 0 but we got " << factor);
             Real pcmMargin = (factor - 1.0) * im;
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin, side,
+            add(results, nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin, side,
                 overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side, overwrite);
+            add(results, nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side, overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
                 side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", pcmMargin, side,
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", pcmMargin, side,
                 overwrite);
         }
         ++pIt.first;
@@ -1323,18 +2021,18 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
     pIt = ssRiskTypeIndex.equal_range(key);
     while (pIt.first != pIt.second) {
         Real fixedMargin = pIt.first->amountUsd;
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::AdditionalIM,
+        add(results, nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::AdditionalIM,
             "All", fixedMargin, side, overwrite);
 
         // Add to aggregation at margin type level
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All, "All",
+        add(results, nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All, "All",
             fixedMargin,
             side, overwrite);
         // Add to aggregation at product class level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
+        add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
             fixedMargin, side, overwrite);
         // Add to aggregation at portfolio level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", fixedMargin, side,
+        add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", fixedMargin, side,
             overwrite);
         ++pIt.first;
     }
@@ -1364,18 +2062,18 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             Real factor = pIt.first->amount;
             Real notionalFactorMargin = notional * factor / 100.0;
 
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
+            add(results, nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
                 MarginType::AdditionalIM, "All", notionalFactorMargin, side, overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All, MarginType::All,
+            add(results, nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All, MarginType::All,
                 "All",
                 notionalFactorMargin, side, overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
                 notionalFactorMargin, side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
                 notionalFactorMargin,
                 side, overwrite);
         }
@@ -1384,8 +2082,8 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
     }
 }
 
-void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                     const string& regulation) {
+void SimmCalculator::populateResults(SimmResults& results, const SimmSide& side,
+                                     const NettingSetDetails& nettingSetDetails, const string& regulation) const {
 
     if (!quiet_) {
         LOG("SimmCalculator: Populating higher level results")
@@ -1398,9 +2096,6 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
     // Populate netting set level results for each portfolio
 
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
-
     // Fill in the margin within each (product class, risk class) combination
     for (const auto& pc : pcs) {
         for (const auto& rc : rcs) {
@@ -1418,7 +2113,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRiskClass) {
-                add(nettingSetDetails, regulation, pc, rc, MarginType::All, "All", riskClassMargin, side);
+                add(results, nettingSetDetails, regulation, pc, rc, MarginType::All, "All", riskClassMargin, side);
             }
         }
     }
@@ -1456,7 +2151,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
         // Add the margin to the results if it was calculated
         if (hasProductClass) {
             productClassMargin = sqrt(max(productClassMargin, 0.0));
-            add(nettingSetDetails, regulation, pc, RiskClass::All, MarginType::All, "All", productClassMargin, side);
+            add(results, nettingSetDetails, regulation, pc, RiskClass::All, MarginType::All, "All", productClassMargin, side);
         }
     }
 
@@ -1468,7 +2163,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             im += results.get(pc, RiskClass::All, MarginType::All, "All");
         }
     }
-    add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
+    add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
 
     // Combinations outside of the natural SIMM hierarchy
 
@@ -1506,7 +2201,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             // Add the margin to the results if it was calculated
             if (hasPcMt) {
                 margin = sqrt(max(margin, 0.0));
-                add(nettingSetDetails, regulation, pc, RiskClass::All, mt, "All", margin, side);
+                add(results, nettingSetDetails, regulation, pc, RiskClass::All, mt, "All", margin, side);
             }
         }
     }
@@ -1531,7 +2226,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRcMt) {
-                add(nettingSetDetails, regulation, ProductClass::All, rc, mt, "All", margin, side);
+                add(results, nettingSetDetails, regulation, ProductClass::All, rc, mt, "All", margin, side);
             }
         }
     }
@@ -1556,7 +2251,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasRc) {
-            add(nettingSetDetails, regulation, ProductClass::All, rc, MarginType::All, "All", margin, side);
+            add(results, nettingSetDetails, regulation, ProductClass::All, rc, MarginType::All, "All", margin, side);
         }
     }
 
@@ -1580,7 +2275,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasMt) {
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, mt, "All", margin, side);
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, mt, "All", margin, side);
         }
     }
 }
@@ -1632,24 +2327,24 @@ void SimmCalculator::populateFinalResults() {
     populateFinalResults(winningRegulations_);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
-                         const RiskClass& rc, const MarginType& mt, const string& b, Real margin, SimmSide side,
-                         const bool overwrite) {
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const string& regulation,
+                         const ProductClass& pc, const RiskClass& rc, const MarginType& mt, const string& b,
+                         Real margin, SimmSide side, const bool overwrite) const {
     if (!quiet_) {
         DLOG("Calculated " << side << " margin for [netting set details, product class, risk class, margin type] = ["
                            << "[" << NettingSetDetails(nettingSetDetails) << "]"
                            << ", " << pc << ", " << rc << ", " << mt << "] of " << margin);
     }
 
-    simmResults_[side][nettingSetDetails][regulation].add(pc, rc, mt, b, margin, "USD", calculationCcy_, overwrite);
+    results.add(pc, rc, mt, b, margin, "USD", calculationCcy_, overwrite);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
-                         const RiskClass& rc, const MarginType& mt, const map<string, Real>& margins, SimmSide side,
-                         const bool overwrite) {
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const string& regulation,
+                         const ProductClass& pc, const RiskClass& rc, const MarginType& mt,
+                         const map<string, Real>& margins, SimmSide side, const bool overwrite) const {
 
     for (const auto& kv : margins)
-        add(nettingSetDetails, regulation, pc, rc, mt, kv.first, kv.second, side, overwrite);
+        add(results, nettingSetDetails, regulation, pc, rc, mt, kv.first, kv.second, side, overwrite);
 }
 
 void SimmCalculator::addCrifRecord(const CrifRecord& crifRecord, const SimmSide& side,
@@ -1701,17 +2396,22 @@ Real SimmCalculator::lambda(Real theta) const {
     return (q * q - 1.0) * (1.0 + theta) - theta;
 }
 
-void SimmCalculator::convert() {
-    // If calculation currency is USD, nothing to do.
-    if (resultCcy_ == "USD")
-        return;
-
+Real SimmCalculator::resultCcyFxSpot() const {
     QL_REQUIRE(market_, "market not set");
     QuantLib::Handle<QuantLib::Quote> fxQuote = market_->fxRate("USD" + resultCcy_);
     QL_REQUIRE(!fxQuote.empty(), "market FX/USD/" << resultCcy_ << " rate not found");
     const Real fxSpot = fxQuote->value();
 
     QL_REQUIRE(fxSpot > 0, "SIMM Calculator: The USD spot rate must be positive");
+    return fxSpot;
+}
+
+void SimmCalculator::convert() {
+    // If calculation currency is USD, nothing to do.
+    if (resultCcy_ == "USD")
+        return;
+
+    const Real fxSpot = resultCcyFxSpot();
 
     // Loop over all results and divide by the spot rate (i.e. convert from USD to SIMM calculation currency)
     for (auto& side : simmResults_) {
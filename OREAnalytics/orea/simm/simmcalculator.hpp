@@ -22,12 +22,16 @@
 
 #pragma once
 
+#include <orea/engine/threadpool.hpp>
 #include <orea/simm/crifrecord.hpp>
 #include <orea/simm/crifloader.hpp>
 #include <orea/simm/simmresults.hpp>
 #include <ored/marketdata/market.hpp>
 
 #include <map>
+#include <set>
+#include <tuple>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -44,6 +48,9 @@ public:
         \p calculationCcy is not USD then the \p usdSpot parameter must be used to
         give the FX spot rate between USD and the \p calculationCcy. This spot rate is
         interpreted as the number of USD per unit of \p calculationCcy.
+
+        The (side, netting set, regulation) combinations are calculated independently of each other on \p nThreads
+        threads, taken from the \p threadPool if given. The results do not depend on the number of threads.
     */
     SimmCalculator(const SimmNetSensitivities& simmNetSensitivities,
                    const boost::shared_ptr<SimmConfiguration>& simmConfiguration,
@@ -52,11 +59,14 @@ public:
                    const boost::shared_ptr<ore::data::Market> market = nullptr,
                    const bool determineWinningRegulations = true,
                    const bool enforceIMRegulations = false,
-                   const bool quiet = false);
+                   const bool quiet = false,
+                   const QuantLib::Size nThreads = 1,
+                   const boost::shared_ptr<ThreadPool>& threadPool = nullptr);
 
-    //! Calculates SIMM for a given regulation under a given netting set
+    //! Calculates SIMM for a given regulation under a given netting set, with the product classes on \p nThreads threads
     const void calculateRegulationSimm(const SimmNetSensitivities& netRecords, const ore::data::NettingSetDetails& nsd,
-                                       const string& regulation, const SimmSide& side);
+                                       const string& regulation, const SimmSide& side,
+                                       const QuantLib::Size nThreads = 1);
 
     //! Return the winning regulation for each netting set
     const std::string& winningRegulations(const SimmSide& side,
@@ -99,7 +109,48 @@ public:
     */
     void populateFinalResults(const std::map<SimmSide, std::map<ore::data::NettingSetDetails, std::string>>& winningRegulations);
 
+    /*! What-if SIMM for adding the \p candidate CRIF records, e.g. the CRIF of a new trade, to the given netting set
+        and regulation. The candidate records are netted with the records of the netting set and regulation and only
+        the (product class, risk class) margin components with candidate sensitivities are recalculated, the other
+        components are taken from the calculation done on construction. The netting set details of the candidate
+        records are ignored and their regulations are not checked, i.e. all candidate records are assigned to the given
+        netting set and regulation.
+
+        Returns the SIMM including the candidate records and the marginal SIMM of the candidate records, i.e. the
+        difference to the SIMM in simmResults(), both in the result currency. If \p results is given, it is populated
+        with the what-if results.
+    */
+    std::pair<QuantLib::Real, QuantLib::Real> whatIf(const SimmNetSensitivities& candidate, const SimmSide& side,
+                                                     const ore::data::NettingSetDetails& nettingSetDetails,
+                                                     const std::string& regulation,
+                                                     SimmResults* results = nullptr) const;
+
+    /*! Euler allocation of the SIMM of the given side, netting set and regulation to the trades. The derivatives of
+        the SIMM with respect to the netted sensitivities are propagated back through the SIMM aggregation in one pass
+        and the contribution of a trade is the sum of its sensitivities times these derivatives. The concentration risk
+        factors and the curvature \f$\lambda\f$ are held fixed, so that the SIMM is homogeneous of degree one in the
+        sensitivities and the contributions of the trades add up to the SIMM. The fixed add-on amounts are not
+        allocated, neither are the records of trades outside the netting set and regulation.
+
+        Returns the contribution of each trade ID in the result currency.
+    */
+    std::map<std::string, QuantLib::Real> eulerAllocation(const SimmSide& side,
+                                                          const ore::data::NettingSetDetails& nettingSetDetails,
+                                                          const std::string& regulation) const;
+
 private:
+    //! Derivatives of a margin with respect to the amountUsd of the CRIF records
+    typedef std::map<const CrifRecord*, QuantLib::Real> Gradient;
+
+    //! The gradients of the margin components of a product class
+    typedef std::map<std::pair<SimmConfiguration::RiskClass, SimmConfiguration::MarginType>, Gradient>
+        ComponentGradients;
+
+    //! The (risk class, margin type, margins) components of a product class
+    typedef std::vector<std::tuple<SimmConfiguration::RiskClass, SimmConfiguration::MarginType,
+                                   std::map<std::string, QuantLib::Real>>>
+        MarginComponents;
+
     //! All the net sensitivities passed in for the calculation
     SimmNetSensitivities simmNetSensitivities_;
 
@@ -121,6 +172,10 @@ private:
     //! If true, no logging is written out
     bool quiet_;
 
+    //! Number of threads and optional thread pool for the calculation
+    QuantLib::Size nThreads_;
+    boost::shared_ptr<ThreadPool> threadPool_;
+
     //! For each netting set, whether all CRIF records' collect regulations are empty
     std::map<ore::data::NettingSetDetails, bool> collectRegsIsEmpty_;
 
@@ -149,20 +204,50 @@ private:
 
     std::map<SimmSide, set<string>> finalTradeIds_;
 
+    //! The margin components of each product class in USD, kept for the what-if calculations
+    //       side,              netting set details,                   regulation,   product class
+    std::map<SimmSide, std::map<ore::data::NettingSetDetails,
+                                std::map<std::string, std::map<SimmConfiguration::ProductClass, MarginComponents>>>>
+        marginComponents_;
+
+    //! Correlations between CRIF records per risk type and bucket, reused across netting sets
+    class CorrelationCache;
+
+    //! Calculates SIMM for a given regulation under a given netting set into the given results container
+    void calculateRegulationSimm(const SimmNetSensitivities& netRecords, const ore::data::NettingSetDetails& nsd,
+                                 const string& regulation, const SimmSide& side, SimmResults& results,
+                                 std::map<SimmConfiguration::ProductClass, MarginComponents>& components,
+                                 const QuantLib::Size nThreads, CorrelationCache& cache);
+
+    /*! Calculate the (risk class, margin type, margins) components for the given portfolio and product class, in the
+        order in which they are added to the results. If \p riskClasses is given, only the components of these risk
+        classes are calculated. If \p gradients is given, it is populated with the gradients of the components.
+    */
+    MarginComponents productClassMargins(const ore::data::NettingSetDetails& nettingSetDetails,
+                                         const SimmConfiguration::ProductClass& pc, const SimmSide& side,
+                                         const SimmNetSensitivities& netRecords, CorrelationCache& cache,
+                                         const std::set<SimmConfiguration::RiskClass>* riskClasses = nullptr,
+                                         ComponentGradients* gradients = nullptr) const;
+
+    /* The margin functions below add the derivatives of the "All" margin with respect to the records' amountUsd to
+       the \p gradient if it is given, see eulerAllocation()
+    */
+
     //! Calculate the Interest Rate delta margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irDeltaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const SimmConfiguration::ProductClass& pc,
-                  const SimmNetSensitivities& netRecords) const;
+                  const SimmNetSensitivities& netRecords, Gradient* gradient = nullptr) const;
 
     //! Calculate the Interest Rate vega margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irVegaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const SimmConfiguration::ProductClass& pc,
-                 const SimmNetSensitivities& netRecords) const;
+                 const SimmNetSensitivities& netRecords, Gradient* gradient = nullptr) const;
 
     //! Calculate the Interest Rate curvature margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irCurvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const SimmConfiguration::ProductClass& pc,
-                      const SimmSide& side, const SimmNetSensitivities& netRecords) const;
+                      const SimmSide& side, const SimmNetSensitivities& netRecords,
+                      Gradient* gradient = nullptr) const;
 
     /*! Calculate the (delta or vega) margin component for the given portfolio, product class and risk type
         Used to calculate delta or vega or base correlation margin for all risk types except IR, IRVol
@@ -171,7 +256,9 @@ private:
     std::pair<std::map<std::string, QuantLib::Real>, bool> margin(const ore::data::NettingSetDetails& nettingSetDetails,
                                                                   const SimmConfiguration::ProductClass& pc,
                                                                   const SimmConfiguration::RiskType& rt,
-                                                                  const SimmNetSensitivities& netRecords) const;
+                                                                  const SimmNetSensitivities& netRecords,
+                                                                  CorrelationCache& cache,
+                                                                  Gradient* gradient = nullptr) const;
 
     /*! Calculate the curvature margin component for the given portfolio, product class and risk type
         Used to calculate curvature margin for all risk types except IR
@@ -179,36 +266,37 @@ private:
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     curvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const SimmConfiguration::ProductClass& pc,
                     const SimmConfiguration::RiskType& rt, const SimmSide& side, const SimmNetSensitivities& netRecords,
-                    bool rfLabels = true) const;
+                    CorrelationCache& cache, bool rfLabels = true, Gradient* gradient = nullptr) const;
 
     //! Calculate the additional initial margin for the portfolio ID and regulation
-    void calcAddMargin(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation, const SimmNetSensitivities& netRecords);
+    void calcAddMargin(SimmResults& results, const SimmSide& side, const ore::data::NettingSetDetails& nsd,
+                       const string& regulation, const SimmNetSensitivities& netRecords) const;
 
     /*! Populate the results structure with the higher level results after the IMs have been
         calculated at the (product class, risk class, margin type) level for the given
         regulation under the given portfolio
     */
-    void populateResults(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation);
+    void populateResults(SimmResults& results, const SimmSide& side, const ore::data::NettingSetDetails& nsd,
+                         const string& regulation) const;
 
     /*! Populate final (i.e. winning regulators') using own list of winning regulators, which were determined
         solely by the SIMM results (i.e. not including any external IMSchedule results)
     */
     void populateFinalResults();
 
-    /*! Add a margin result to either call or post results container depending on the
-        \p side parameter.
+    /*! Add a margin result to the given results container of the \p side, netting set and regulation.
 
         \remark all additions to the results containers should happen in this method
     */
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
              const SimmConfiguration::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
              const SimmConfiguration::MarginType& mt, const std::string& b, QuantLib::Real margin, SimmSide side,
-             const bool overwrite = true);
+             const bool overwrite = true) const;
 
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
              const SimmConfiguration::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
              const SimmConfiguration::MarginType& mt, const std::map<std::string, QuantLib::Real>& margins, SimmSide side,
-             const bool overwrite = true);
+             const bool overwrite = true) const;
 
     //! Add CRIF record to the CRIF records container that correspondsd to the given regulation/s and portfolio ID
     void addCrifRecord(const CrifRecord& crifRecord, const SimmSide& side, const bool enforceIMRegulations);
@@ -216,6 +304,9 @@ private:
     //! Give the \f$\lambda\f$ used in the curvature margin calculation
     QuantLib::Real lambda(QuantLib::Real theta) const;
 
+    //! The FX spot rate for converting USD amounts to the result currency
+    QuantLib::Real resultCcyFxSpot() const;
+
     //! Convert all results to the calculation currency
     void convert();
 };
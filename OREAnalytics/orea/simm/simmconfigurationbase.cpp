@@ -59,6 +59,14 @@ vector<string> lookup(const RiskType& rt, const map<RiskType, vector<string>>& m
     }
 }
 
+// As lookup, but without copying the labels, for the risk weight and correlation lookups which are called for each
+// (pair of) CRIF records in the SIMM calculation
+const vector<string>& lookupRef(const RiskType& rt, const map<RiskType, vector<string>>& m) {
+    static const vector<string> empty;
+    auto it = m.find(rt);
+    return it == m.end() ? empty : it->second;
+}
+
 string periodToLabels2(const QuantLib::Period& p) {
     if ((p.units() == Months && p.length() == 3) || (p.units() == Weeks && p.length() == 13)) {
         return "Libor3m";
@@ -152,12 +160,12 @@ QuantLib::Real SimmConfigurationBase::weight(const RiskType& rt, boost::optional
     // We now at least have bucket dependent risk weights so check qualifier and buckets
     QL_REQUIRE(qualifier, "Need a valid qualifier to return a risk weight because the risk type "
                               << rt << " has bucket dependent risk weights");
-    QL_REQUIRE(!buckets(rt).empty(), "Could not find any buckets for risk type " << rt);
+    QL_REQUIRE(!lookupRef(rt, mapBuckets_).empty(), "Could not find any buckets for risk type " << rt);
     string bucket = simmBucketMapper_->bucket(rt, *qualifier);
 
     // If risk weight for this risk type is bucket-dependent
     if (rwBucket_.count(rt) > 0) {
-        auto idx = labelIndex(bucket, buckets(rt));
+        auto idx = labelIndex(bucket, lookupRef(rt, mapBuckets_));
 
         return rwBucket_.at(rt)[idx];
     }
@@ -166,8 +174,8 @@ QuantLib::Real SimmConfigurationBase::weight(const RiskType& rt, boost::optional
     if (rwLabel_1_.count({rt, bucket}) > 0) {
         QL_REQUIRE(label_1, "Need a valid Label1 value to return a risk weight because the risk type "
                                 << rt << " has bucket and Label1 dependent risk weights");
-        QL_REQUIRE(!labels1(rt).empty(), "Could not find any Label1 values for risk type " << rt);
-        auto idx = labelIndex(*label_1, labels1(rt));
+        QL_REQUIRE(!lookupRef(rt, mapLabels_1_).empty(), "Could not find any Label1 values for risk type " << rt);
+        auto idx = labelIndex(*label_1, lookupRef(rt, mapLabels_1_));
 
         return rwLabel_1_.at({rt, bucket})[idx];
     }
@@ -184,8 +192,8 @@ QuantLib::Real SimmConfigurationBase::curvatureWeight(const RiskType& rt, const
 
     QL_REQUIRE(curvatureWeights_.count(rt) > 0, "The risk type " << rt << " does not have a curvature weight.");
 
-    QL_REQUIRE(!labels1(rt).empty(), "Could not find any Label1 values for risk type " << rt);
-    auto idx = labelIndex(label_1, labels1(rt));
+    QL_REQUIRE(!lookupRef(rt, mapLabels_1_).empty(), "Could not find any Label1 values for risk type " << rt);
+    auto idx = labelIndex(label_1, lookupRef(rt, mapLabels_1_));
 
     return curvatureWeights_.at(rt)[idx];
 }
@@ -294,8 +302,8 @@ QuantLib::Real SimmConfigurationBase::correlation(const RiskType& firstRt, const
             }
 
             // Label1 level, i.e. tenor, correlations
-            auto idx_1 = labelIndex(firstLabel_1, labels1(firstRt));
-            auto idx_2 = labelIndex(secondLabel_1, labels1(secondRt));
+            auto idx_1 = labelIndex(firstLabel_1, lookupRef(firstRt, mapLabels_1_));
+            auto idx_2 = labelIndex(secondLabel_1, lookupRef(secondRt, mapLabels_1_));
             return irTenorCorrelation_[idx_1][idx_2];
         } else {
             // If the qualifiers, i.e. currencies, are not the same
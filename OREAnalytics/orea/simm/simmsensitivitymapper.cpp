@@ -0,0 +1,220 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+#include <orea/simm/simmsensitivitymapper.hpp>
+#include <ored/utilities/indexparser.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+#include <qle/utilities/time.hpp>
+
+#include <ql/math/comparison.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+
+using std::string;
+using std::vector;
+
+namespace ore {
+namespace analytics {
+
+// Ease syntax
+using RiskType = SimmConfiguration::RiskType;
+using ProductClass = SimmConfiguration::ProductClass;
+
+namespace {
+
+// Default product class for a sensitivity of risk type rt
+ProductClass productClass(const RiskType& rt) {
+    switch (rt) {
+    case RiskType::CreditQ:
+        return ProductClass::Credit;
+    case RiskType::Equity:
+        return ProductClass::Equity;
+    case RiskType::Commodity:
+        return ProductClass::Commodity;
+    default:
+        return ProductClass::RatesFX;
+    }
+}
+
+} // namespace
+
+SimmSensitivityMapper::SimmSensitivityMapper(const boost::shared_ptr<SimmConfiguration>& configuration,
+                                             const boost::shared_ptr<ore::data::Market>& market,
+                                             const boost::shared_ptr<SimmNameMapper>& nameMapper,
+                                             const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+                                             const std::map<string, ProductClass>& productClasses)
+    : configuration_(configuration), market_(market), nameMapper_(nameMapper), productClasses_(productClasses) {
+
+    QL_REQUIRE(configuration_, "SimmSensitivityMapper: no SIMM configuration given");
+
+    if (portfolio) {
+        for (const auto& t : portfolio->trades()) {
+            nettingSetDetails_[t.first] = t.second->envelope().nettingSetDetails();
+            tradeTypes_[t.first] = t.second->tradeType();
+        }
+    }
+
+    for (const auto& rt : {RiskType::IRCurve, RiskType::CreditQ}) {
+        auto& v = vertices_[rt];
+        for (const auto& l : configuration_->labels1(rt))
+            v.push_back(std::make_pair(QuantExt::periodToTime(ore::data::parsePeriod(l)), l));
+        std::sort(v.begin(), v.end());
+        QL_REQUIRE(!v.empty(), "SimmSensitivityMapper: no Label1 vertices for risk type " << rt);
+    }
+}
+
+Size SimmSensitivityMapper::map(const SensitivityRecord& sr, vector<CrifRecord>& records) const {
+
+    if (!sr || sr.isCrossGamma() || close_enough(sr.shift_1, 0.0))
+        return 0;
+
+    const string& name = sr.key_1.name;
+    try {
+        switch (sr.key_1.keytype) {
+        case RiskFactorKey::KeyType::DiscountCurve:
+            return addTenorRecords(sr, RiskType::IRCurve, name, "OIS", sr.delta * 1.0E-4 / sr.shift_1, sr.desc_1,
+                                   records);
+        case RiskFactorKey::KeyType::IndexCurve: {
+            auto index = ore::data::parseIborIndex(name);
+            return addTenorRecords(sr, RiskType::IRCurve, index->currency().code(), configuration_->labels2(index),
+                                   sr.delta * 1.0E-4 / sr.shift_1, sr.desc_1, records);
+        }
+        case RiskFactorKey::KeyType::ZeroInflationCurve: {
+            auto index = ore::data::parseZeroInflationIndex(name);
+            records.push_back(
+                record(sr, RiskType::Inflation, index->currency().code(), sr.delta * 1.0E-4 / sr.shift_1));
+            return 1;
+        }
+        case RiskFactorKey::KeyType::SurvivalProbability:
+            return addTenorRecords(sr, RiskType::CreditQ, nameMapper_ ? nameMapper_->qualifier(name) : name, "",
+                                   sr.delta * 1.0E-4 / sr.shift_1, sr.desc_1, records);
+        case RiskFactorKey::KeyType::FXSpot:
+        case RiskFactorKey::KeyType::EquitySpot:
+        case RiskFactorKey::KeyType::CommodityCurve: {
+            Real s = spot(sr);
+            if (s == Null<Real>())
+                return 0;
+            Real amount = sr.delta * 0.01 * s / sr.shift_1;
+            if (sr.key_1.keytype == RiskFactorKey::KeyType::FXSpot)
+                records.push_back(record(sr, RiskType::FX, name.substr(0, 3), amount));
+            else if (sr.key_1.keytype == RiskFactorKey::KeyType::EquitySpot)
+                records.push_back(
+                    record(sr, RiskType::Equity, nameMapper_ ? nameMapper_->qualifier(name) : name, amount));
+            else
+                records.push_back(record(sr, RiskType::Commodity, name, amount));
+            return 1;
+        }
+        default:
+            TLOG("SimmSensitivityMapper: skip sensitivity to " << sr.key_1 << " for trade " << sr.tradeId);
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        WLOG("SimmSensitivityMapper: could not map sensitivity " << sr << ": " << e.what());
+        return 0;
+    }
+}
+
+Size SimmSensitivityMapper::load(SensitivityStream& stream, CrifLoader& loader, Size batchSize) const {
+    QL_REQUIRE(batchSize > 0, "SimmSensitivityMapper: batch size must be positive");
+    LOG("Loading CRIF records from sensitivity stream");
+    vector<SensitivityRecord> batch(batchSize);
+    vector<CrifRecord> records;
+    Size count = 0, n;
+    do {
+        n = stream.nextBatch(batch);
+        records.clear();
+        for (Size i = 0; i < n; ++i)
+            map(batch[i], records);
+        for (auto& cr : records)
+            loader.add(std::move(cr));
+        count += records.size();
+    } while (n == batchSize);
+    LOG("Loaded " << count << " CRIF records from sensitivity stream");
+    return count;
+}
+
+CrifRecord SimmSensitivityMapper::record(const SensitivityRecord& sr, const RiskType& rt, const string& qualifier,
+                                         Real amount) const {
+    auto pc = productClasses_.find(sr.tradeId);
+    auto nsd = nettingSetDetails_.find(sr.tradeId);
+    auto tt = tradeTypes_.find(sr.tradeId);
+    return CrifRecord(sr.tradeId, tt == tradeTypes_.end() ? "" : tt->second,
+                      nsd == nettingSetDetails_.end() ? ore::data::NettingSetDetails() : nsd->second,
+                      pc == productClasses_.end() ? productClass(rt) : pc->second, rt, qualifier,
+                      configuration_->hasBuckets(rt) ? configuration_->bucket(rt, qualifier) : "", "", "",
+                      sr.currency, amount, Null<Real>());
+}
+
+Size SimmSensitivityMapper::addTenorRecords(const SensitivityRecord& sr, const RiskType& rt, const string& qualifier,
+                                            const string& label2, Real amount, const string& tenor,
+                                            vector<CrifRecord>& records) const {
+    const auto& v = vertices_.at(rt);
+    Real t = QuantExt::periodToTime(ore::data::parsePeriod(tenor));
+    auto u = std::upper_bound(v.begin(), v.end(), t,
+                              [](Real x, const std::pair<Real, string>& p) { return x < p.first; });
+    auto add = [this, &sr, &rt, &qualifier, &label2, &records](const string& label1, Real a) {
+        records.push_back(record(sr, rt, qualifier, a));
+        records.back().label1 = label1;
+        records.back().label2 = label2;
+    };
+    // flat extrapolation beyond the first and last vertex, linear allocation in between
+    if (u == v.begin()) {
+        add(v.front().second, amount);
+        return 1;
+    }
+    if (u == v.end()) {
+        add(v.back().second, amount);
+        return 1;
+    }
+    auto l = std::prev(u);
+    Real w = (t - l->first) / (u->first - l->first);
+    if (close_enough(w, 0.0)) {
+        add(l->second, amount);
+        return 1;
+    }
+    add(l->second, (1.0 - w) * amount);
+    add(u->second, w * amount);
+    return 2;
+}
+
+Real SimmSensitivityMapper::spot(const SensitivityRecord& sr) const {
+    if (!market_) {
+        WLOG("SimmSensitivityMapper: no market given, can not rescale sensitivity to " << sr.key_1 << " for trade "
+                                                                                         << sr.tradeId);
+        return Null<Real>();
+    }
+    const string& name = sr.key_1.name;
+    switch (sr.key_1.keytype) {
+    case RiskFactorKey::KeyType::FXSpot:
+        return market_->fxSpot(name)->value();
+    case RiskFactorKey::KeyType::EquitySpot:
+        return market_->equitySpot(name)->value();
+    case RiskFactorKey::KeyType::CommodityCurve:
+        return market_->commodityPriceCurve(name)->price(market_->asofDate() + ore::data::parsePeriod(sr.desc_1),
+                                                         true);
+    default:
+        QL_FAIL("SimmSensitivityMapper: no spot for risk factor " << sr.key_1);
+    }
+}
+
+} // namespace analytics
+} // namespace ore
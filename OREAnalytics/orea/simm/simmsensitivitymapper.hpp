@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+/*! \file orea/simm/simmsensitivitymapper.hpp
+    \brief Class for mapping ORE sensitivity records to CRIF records
+*/
+
+#pragma once
+
+#include <orea/engine/sensitivitystream.hpp>
+#include <orea/simm/crifloader.hpp>
+#include <orea/simm/simmnamemapper.hpp>
+#include <ored/marketdata/market.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+/*! A class for mapping the delta sensitivities of a SensitivityStream to CRIF records, so that a SIMM calculation
+    can be fed from a sensitivity analysis in memory, without writing the sensitivities to a file and converting
+    them externally.
+
+    The following risk factors are mapped:
+    - DiscountCurve and IndexCurve to IRCurve, the Label2 is OIS for discount curves and the sub curve of the index
+      for index curves,
+    - ZeroInflationCurve to Inflation,
+    - SurvivalProbability to CreditQ,
+    - FXSpot to FX, with the foreign currency of the pair as qualifier,
+    - EquitySpot to Equity,
+    - CommodityCurve to Commodity.
+
+    The tenors of the curve sensitivities are allocated linearly to the adjacent SIMM vertices. The shift sizes of the
+    records are taken as absolute shifts, the deltas are rescaled to 1bp for the interest rate, inflation and credit
+    risk types and to a 1% relative move of the spot for the FX, equity and commodity risk types, which requires a
+    market to look up the spot. Gamma, cross gamma and all other risk factors are skipped.
+
+    The mapper does not know the SIMM product class of a trade, by default it is derived from the risk class of each
+    sensitivity, i.e. RatesFX for interest rate and FX risk etc. This can be overridden per trade.
+*/
+class SimmSensitivityMapper {
+public:
+    /*! Constructor
+        The netting set details and trade types are taken from the \p portfolio if it is given.
+    */
+    SimmSensitivityMapper(const boost::shared_ptr<SimmConfiguration>& configuration,
+                          const boost::shared_ptr<ore::data::Market>& market = nullptr,
+                          const boost::shared_ptr<SimmNameMapper>& nameMapper = nullptr,
+                          const boost::shared_ptr<ore::data::Portfolio>& portfolio = nullptr,
+                          const std::map<std::string, SimmConfiguration::ProductClass>& productClasses = {});
+
+    /*! Map the sensitivity record \p sr to CRIF records that are appended to \p records, returns the number of
+        records appended, which is zero if the record can not be mapped
+    */
+    QuantLib::Size map(const SensitivityRecord& sr, std::vector<CrifRecord>& records) const;
+
+    /*! Stream the sensitivity records from \p stream in batches of \p batchSize and add the mapped CRIF records to
+        \p loader, returns the number of CRIF records added
+    */
+    QuantLib::Size load(SensitivityStream& stream, CrifLoader& loader, QuantLib::Size batchSize = 10000) const;
+
+private:
+    CrifRecord record(const SensitivityRecord& sr, const SimmConfiguration::RiskType& rt,
+                      const std::string& qualifier, QuantLib::Real amount) const;
+
+    //! Allocate the \p amount at \p tenor to the adjacent SIMM Label1 vertices of \p rt and append the records
+    QuantLib::Size addTenorRecords(const SensitivityRecord& sr, const SimmConfiguration::RiskType& rt,
+                                   const std::string& qualifier, const std::string& label2, QuantLib::Real amount,
+                                   const std::string& tenor, std::vector<CrifRecord>& records) const;
+
+    //! Spot used to rescale the records of the relatively shifted risk factors, or null if none is available
+    QuantLib::Real spot(const SensitivityRecord& sr) const;
+
+    boost::shared_ptr<SimmConfiguration> configuration_;
+    boost::shared_ptr<ore::data::Market> market_;
+    boost::shared_ptr<SimmNameMapper> nameMapper_;
+    std::map<std::string, SimmConfiguration::ProductClass> productClasses_;
+    std::map<std::string, ore::data::NettingSetDetails> nettingSetDetails_;
+    std::map<std::string, std::string> tradeTypes_;
+    //! SIMM vertices in years by risk type
+    std::map<SimmConfiguration::RiskType, std::vector<std::pair<QuantLib::Real, std::string>>> vertices_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -35,8 +35,8 @@
 #include <ql/math/matrixutilities/symmetricschurdecomposition.hpp>
 #include <ql/utilities/null.hpp>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/regex.hpp>
 
 #include <fstream>
 
@@ -39,6 +39,8 @@
 #include <ql/experimental/coupons/cmsspreadcoupon.hpp>
 #include <ql/experimental/coupons/digitalcmsspreadcoupon.hpp>
 
+#include <algorithm>
+
 using namespace std;
 using namespace QuantLib;
 using namespace QuantExt;
@@ -63,7 +65,7 @@ FixingManager::FixingManager(Date today) : today_(today), fixingsEnd_(today), mo
 //! Initialise the manager-
 
 void FixingManager::initialise(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<Market>& market,
-                               const std::string& configuration) {
+                               const std::string& configuration, const std::vector<Date>& simulationDates) {
 
     // populate the map "Index -> set of required fixing dates", where the index on the LHS is linked to curves
     for (auto const& [tradeId,t] : portfolio->trades()) {
@@ -110,6 +112,22 @@ void FixingManager::initialise(const boost::shared_ptr<Portfolio>& portfolio, co
     for (auto const& m : fixingMap_) {
         fixingCache_[m.first] = IndexManager::instance().getHistory(m.first->name());
     }
+
+    // Compile the fixing schedules for the steps between the simulation dates
+    schedules_.clear();
+    if (!fixingMap_.empty()) {
+        Date start = today_;
+        for (auto const& d : simulationDates) {
+            if (d > start) {
+                schedules_[std::make_pair(start, d)] = compileSchedule(start, d);
+                start = d;
+            }
+        }
+        Size events = 0;
+        for (auto const& s : schedules_)
+            events += s.second.size();
+        DLOG("FixingManager: compiled " << schedules_.size() << " fixing schedules with " << events << " events");
+    }
 }
 
 //! Update fixings to date d
@@ -135,6 +153,26 @@ void FixingManager::reset() {
 }
 
 void FixingManager::applyFixings(Date start, Date end) {
+    auto key = std::make_pair(start, end);
+    auto s = schedules_.find(key);
+    if (s == schedules_.end())
+        s = schedules_.insert(std::make_pair(key, compileSchedule(start, end))).first;
+
+    for (auto const& e : s->second) {
+        Real currentFixing;
+        if (e.fromPriceCurve)
+            currentFixing = boost::static_pointer_cast<QuantExt::CommodityIndex>(e.index)->priceCurve()->price(
+                e.currentFixingDate);
+        else
+            currentFixing = e.index->fixing(e.currentFixingDate);
+        values_.assign(e.fixingDates.size(), currentFixing);
+        e.index->addFixings(e.fixingDates.begin(), e.fixingDates.end(), values_.begin(), true);
+        modifiedFixingHistory_ = true;
+    }
+}
+
+FixingManager::FixingSchedule FixingManager::compileSchedule(Date start, Date end) const {
+    FixingSchedule schedule;
     // Loop over all indices
     for (auto const& m : fixingMap_) {
         Date fixStart = start;
@@ -161,40 +199,27 @@ void FixingManager::applyFixings(Date start, Date end) {
                 currentFixingDate = nextValidFixingDate(currentFixingDate, m.first);
         }
 
-        // Add we have a coupon between start and asof.
-        bool needFixings = false;
-        for (auto const& d : m.second) {
-            if (d >= fixStart && d < fixEnd) {
-                needFixings = true;
-                break;
-            }
+        // Collect the fixing dates of coupons between start and asof
+        FixingEvent event;
+        for (auto it = m.second.lower_bound(fixStart); it != m.second.end() && *it < fixEnd; ++it) {
+            // Fixing dates include the valuation grid dates which might not be valid fixing dates (BMA/SIFMA)
+            if (m.first->isValidFixingDate(*it))
+                event.fixingDates.push_back(*it);
         }
 
-        if (needFixings) {
-            Rate currentFixing;
-            if (auto comm = boost::dynamic_pointer_cast<QuantExt::CommodityIndex>(m.first);
-                comm != nullptr && comm->expiryDate() < currentFixingDate) {
-                currentFixing = comm->priceCurve()->price(currentFixingDate);
-            } else {
-                currentFixing = m.first->fixing(currentFixingDate);
-            }
-            // if we read the fixing from an inverted FxIndex we have to undo the inversion
-            TimeSeries<Real> history;
-            for (auto const& d : m.second) {
-                if (d >= fixStart && d < fixEnd) {
-                    // Fixing dates include the valuation grid dates which might not be valid fixing dates (BMA/SIFMA)
-                    bool valid = m.first->isValidFixingDate(d);
-                    if (valid) {
-                        history[d] = currentFixing;
-                        modifiedFixingHistory_ = true;
-                    }
-                }
-                if (d >= fixEnd)
-                    break;
-            }
-            m.first->addFixings(history, true);
+        if (!event.fixingDates.empty()) {
+            event.index = m.first;
+            event.currentFixingDate = currentFixingDate;
+            auto comm = boost::dynamic_pointer_cast<QuantExt::CommodityIndex>(m.first);
+            event.fromPriceCurve = comm != nullptr && comm->expiryDate() < currentFixingDate;
+            schedule.push_back(event);
         }
     }
+
+    std::stable_sort(schedule.begin(), schedule.end(), [](const FixingEvent& a, const FixingEvent& b) {
+        return a.currentFixingDate < b.currentFixingDate;
+    });
+    return schedule;
 }
 
 } // namespace analytics
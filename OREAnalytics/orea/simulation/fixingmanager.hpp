@@ -52,6 +52,11 @@ struct IndexComparator {
   When stepping between simulation dated t_(n-1) and t_(n) and update a fixing t with t_(n-1) < t < t(n) than the fixing
   from t(n) will be backfilled. There is currently no interpolation of fixings.
 
+  The fixings to apply when stepping from t_(n-1) to t_(n) only depend on the two dates, not on the path. They are
+  therefore compiled once into a schedule of fixing events sorted by date, either in initialise() for the given
+  simulation dates or on the first update for a pair of dates, and the update on subsequent paths only evaluates
+  the current fixing for each event of the schedule.
+
   \ingroup simulation
  */
 class FixingManager {
@@ -60,8 +65,10 @@ public:
     virtual ~FixingManager() {}
 
     //! Initialise the manager with these flows and indices from the given portfolio
+    /*! If simulation dates are given, the fixing schedules for the steps between them are compiled here */
     void initialise(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<Market>& market,
-                    const std::string& configuration = Market::defaultConfiguration);
+                    const std::string& configuration = Market::defaultConfiguration,
+                    const std::vector<Date>& simulationDates = {});
 
     //! Update fixings to date d
     void update(Date d);
@@ -74,7 +81,20 @@ public:
     using FixingMap = std::map<boost::shared_ptr<Index>, std::set<Date>, detail::IndexComparator>;
 
 private:
+    //! A fixing event of a precompiled schedule
+    struct FixingEvent {
+        boost::shared_ptr<Index> index;
+        // the date for which the current fixing is read
+        Date currentFixingDate;
+        // read the current fixing from the commodity price curve instead of the index
+        bool fromPriceCurve;
+        // the valid fixing dates that are overwritten with the current fixing
+        std::vector<Date> fixingDates;
+    };
+    using FixingSchedule = std::vector<FixingEvent>;
+
     void applyFixings(Date start, Date end);
+    FixingSchedule compileSchedule(Date start, Date end) const;
 
     Date today_, fixingsEnd_;
     bool modifiedFixingHistory_;
@@ -83,6 +103,9 @@ private:
 
     FixingMap fixingMap_;
     FixingCache fixingCache_;
+
+    std::map<std::pair<Date, Date>, FixingSchedule> schedules_;
+    std::vector<Real> values_;
 };
 
 } // namespace analytics
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <orea/engine/observationmode.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <orea/simulation/fixingmanager.hpp>
 #include <ored/configuration/conventions.hpp>
@@ -47,9 +48,12 @@ public:
 
     //! Generate or retrieve market scenario, update market, notify termstructures and update fixings
     virtual void update(const Date& d) {
+        // the notifications are batched until the market is updated, fixings and the asd require updated curves
+        ObservableNotificationBatch batch(ObservableNotificationBatch::useForMarketUpdates());
         preUpdate();
         updateDate(d);
         updateScenario(d);
+        batch.flush();
         postUpdate(d, true);
         updateAsd(d);
     }
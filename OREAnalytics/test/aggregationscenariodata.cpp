@@ -17,10 +17,16 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/cube/cube_io.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <test/oreatoplevelfixture.hpp>
 
+#include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+
+#include <thread>
+
 using namespace ore::analytics;
 using namespace boost::unit_test_framework;
 
@@ -65,6 +71,87 @@ BOOST_AUTO_TEST_CASE(testInMemoryAggregationScenarioData) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBinaryFileIO) {
+    InMemoryAggregationScenarioData data(3, 5);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            data.set(i, j, 0.0001 * i + 0.01 * j, AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+            data.set(i, j, 1.0 + i * j, AggregationScenarioDataType::Numeraire);
+            data.set(i, j, i + 0.1 * j, AggregationScenarioDataType::FXSpot, "EURUSD");
+        }
+    }
+
+    for (auto const& extension : {".bin", ".bin.gz"}) {
+        std::string filename = boost::filesystem::unique_path().string() + extension;
+        BOOST_TEST_MESSAGE("Saving aggregation scenario data to file " << filename);
+        saveAggregationScenarioData(filename, data);
+        auto data2 = loadAggregationScenarioData(filename);
+        boost::filesystem::remove(filename);
+
+        BOOST_CHECK_EQUAL(data2->dimDates(), 3);
+        BOOST_CHECK_EQUAL(data2->dimSamples(), 5);
+        BOOST_CHECK(data2->keys() == data.keys());
+        for (Size i = 0; i < 3; ++i) {
+            for (Size j = 0; j < 5; ++j) {
+                for (auto const& k : data.keys())
+                    BOOST_CHECK_EQUAL(data2->get(i, j, k.first, k.second), data.get(i, j, k.first, k.second));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSinglePrecisionAndSamples) {
+    SinglePrecisionInMemoryAggregationScenarioData data(2, 4);
+    BOOST_CHECK(!data.has(AggregationScenarioDataType::Numeraire));
+    for (Size i = 0; i < 2; ++i)
+        for (Size j = 0; j < 4; ++j)
+            data.set(i, j, 1.0 + i + 0.25 * j, AggregationScenarioDataType::Numeraire);
+    BOOST_CHECK(data.has(AggregationScenarioDataType::Numeraire));
+    BOOST_CHECK_THROW(data.samples(0, AggregationScenarioDataType::FXSpot, "EURUSD"), std::exception);
+
+    for (Size i = 0; i < 2; ++i) {
+        auto s = data.samples(i, AggregationScenarioDataType::Numeraire);
+        BOOST_REQUIRE_EQUAL(s.size(), 4);
+        Size j = 0;
+        for (float v : s) {
+            BOOST_CHECK_EQUAL(v, static_cast<float>(1.0 + i + 0.25 * j));
+            BOOST_CHECK_EQUAL(data.get(i, j, AggregationScenarioDataType::Numeraire), v);
+            ++j;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testConcurrentSampleRanges) {
+    Size dates = 3, samples = 1000, nThreads = 4;
+    auto data = boost::make_shared<InMemoryAggregationScenarioData>(dates, samples);
+
+    // each thread traverses its own sample range as the sim market does
+    std::vector<std::thread> threads;
+    for (Size t = 0; t < nThreads; ++t) {
+        threads.emplace_back([data, dates, samples, nThreads, t]() {
+            Size first = t * samples / nThreads, n = (t + 1) * samples / nThreads - first;
+            AggregationScenarioDataSampleRange range(data, first, n);
+            for (Size k = 0; k < n; ++k) {
+                for (Size d = 0; d < dates; ++d) {
+                    range.set(d + 0.001 * (first + k), AggregationScenarioDataType::Numeraire);
+                    range.set(2.0 * d, AggregationScenarioDataType::FXSpot, "EURUSD");
+                    range.next();
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(data->keys().size(), 2);
+    for (Size d = 0; d < dates; ++d) {
+        for (Size k = 0; k < samples; ++k) {
+            BOOST_CHECK_EQUAL(data->get(d, k, AggregationScenarioDataType::Numeraire), d + 0.001 * k);
+            BOOST_CHECK_EQUAL(data->get(d, k, AggregationScenarioDataType::FXSpot, "EURUSD"), 2.0 * d);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
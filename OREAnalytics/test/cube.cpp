@@ -18,10 +18,22 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <orea/app/xvasharding.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/arrow_io.hpp>
+#include <orea/cube/binarycubefile.hpp>
 #include <orea/cube/cube_io.hpp>
+#include <orea/cube/filemappedcube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/jaggedcube.hpp>
+#include <orea/cube/jointnpvcube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
+#include <orea/cube/nettingsetaggregationcube.hpp>
+#include <orea/cube/quantisedcube.hpp>
+#include <orea/cube/samplesubsetcube.hpp>
+#include <orea/cube/sensicube.hpp>
+#include <orea/cube/truncatedcube.hpp>
+#include <orea/engine/exposureconvergencemonitor.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/parametricvar.hpp>
@@ -88,6 +100,18 @@ void checkCube(NPVCube& cube, Real tolerance) {
             }
         }
     }
+    // the slice accessor must agree with get()
+    vector<Real> values;
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        for (Size j = 0; j < cube.numDates(); ++j) {
+            for (Size d = 0; d < cube.depth(); ++d) {
+                cube.getSamples(i, j, d, values);
+                BOOST_REQUIRE_EQUAL(values.size(), cube.samples());
+                for (Size k = 0; k < cube.samples(); ++k)
+                    BOOST_CHECK_EQUAL(values[k], cube.get(i, j, k, d));
+            }
+        }
+    }
 }
 
 void testCube(NPVCube& cube, const std::string& cubeName, Real tolerance) {
@@ -112,12 +136,13 @@ void testCube(NPVCube& cube, const std::string& cubeName, Real tolerance) {
 }
 
 template <class T>
-void testCubeFileIO(NPVCube& cube, const std::string& cubeName, Real tolerance, bool doublePrecision) {
+void testCubeFileIO(NPVCube& cube, const std::string& cubeName, Real tolerance, bool doublePrecision,
+                    const std::string& extension = "") {
 
     initCube(cube);
 
-    // get a random filename
-    string filename = boost::filesystem::unique_path().string();
+    // get a random filename, the extension selects the file format
+    string filename = boost::filesystem::unique_path().string() + extension;
     BOOST_TEST_MESSAGE("Saving cube " << cubeName << " to file " << filename);
     saveCube(filename, cube, doublePrecision);
 
@@ -440,6 +465,225 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeN) {
     testCube(c, "DoublePrecisionInMemoryCubeN", 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeNDateTradeLayout) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 3;
+    DoublePrecisionInMemoryCubeN c(Date(), ids, dates, samples, depth, 0.0, InMemoryCubeLayout::DateTradeSampleDepth);
+    testCube(c, "DoublePrecisionInMemoryCubeN (date-trade-sample-depth)", 1e-14);
+    BOOST_CHECK(c.layout() == InMemoryCubeLayout::DateTradeSampleDepth);
+
+    // the samples and depth of one (id, date) pair are contiguous, and so are the ids of one date
+    const double* v = c.values(1, 10);
+    BOOST_CHECK_CLOSE(v[10 * depth + 2], 1000000.0 + 10.0 + 10.0 / 1000000.0 + 6.0, 1e-14);
+    BOOST_CHECK_CLOSE(c.values(2, 10)[0], v[samples * depth], 1e-14);
+    BOOST_CHECK_CLOSE(v[samples * depth], 2000000.0 + 10.0, 1e-14);
+
+    // removing an id must not touch the values of the other ids
+    c.remove(1);
+    BOOST_CHECK_EQUAL(c.get(1, 10, 10, 2), 0.0);
+    BOOST_CHECK_CLOSE(c.get(0, 10, 10, 2), 10.0 + 10.0 / 1000000.0 + 6.0, 1e-14);
+    BOOST_CHECK_CLOSE(c.get(2, 10, 10, 2), 2000000.0 + 10.0 + 10.0 / 1000000.0 + 6.0, 1e-14);
+    c.remove(2, 10);
+    BOOST_CHECK_EQUAL(c.get(2, 20, 10, 1), 0.0);
+    BOOST_CHECK_CLOSE(c.get(2, 20, 11, 1), 2000000.0 + 20.0 + 11.0 / 1000000.0 + 3.0, 1e-14);
+}
+
+BOOST_AUTO_TEST_CASE(testSinglePrecisionMemoryMappedCube) {
+    std::set<string> ids{string("id")}; // the overlap doesn't matter
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 6;
+    SinglePrecisionMemoryMappedCube c(Date(), ids, dates, samples, depth);
+    testCube(c, "SinglePrecisionMemoryMappedCube", 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(testDoublePrecisionMemoryMappedCube) {
+    std::set<string> ids{string("id1"), string("id2")};
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 3;
+    DoublePrecisionMemoryMappedCube c(Date(), ids, dates, samples, depth);
+    testCube(c, "DoublePrecisionMemoryMappedCube", 1e-14);
+
+    // removing an id must not touch the values of the other ids
+    c.remove(0);
+    BOOST_CHECK_EQUAL(c.get(0, 10, 10, 2), 0.0);
+    BOOST_CHECK_CLOSE(c.get(1, 10, 10, 2), 1000000.0 + 10.0 + 10.0 / 1000000.0 + 6.0, 1e-14);
+}
+
+BOOST_AUTO_TEST_CASE(testQuantisedInMemoryCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(20, Date());
+    Size samples = 200;
+    Size depth = 3;
+    QuantisedInMemoryCube c(Date(), ids, dates, samples, depth);
+    initCube(c);
+    BOOST_CHECK_THROW(c.set(1.0, 0, 0, samples, 0), std::exception);
+    BOOST_CHECK_THROW(c.get(0, dates.size(), 0, 0), std::exception);
+
+    vector<Real> values;
+    for (Size i = 0; i < c.numIds(); ++i) {
+        for (Size j = 0; j < c.numDates(); ++j) {
+            for (Size d = 0; d < c.depth(); ++d) {
+                Real maxValue = i * 1000000.0 + j + (samples - 1) / 1000000.0 + d * 3;
+                Real bound = c.errorBound(i, j, d);
+                BOOST_CHECK(bound <= QuantisedInMemoryCube::relativeErrorBound() * maxValue);
+                c.getSamples(i, j, d, values);
+                for (Size k = 0; k < samples; ++k) {
+                    Real expected = i * 1000000.0 + j + k / 1000000.0 + d * 3;
+                    BOOST_CHECK_SMALL(c.get(i, j, k, d) - expected, bound);
+                    BOOST_CHECK_EQUAL(values[k], c.get(i, j, k, d));
+                }
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(c.errorBound(), c.errorBound(2, 19, 2));
+
+    // a larger value set later rescales the values of the slice set before
+    c.set(1.0E9, 1, 5, 7, 2);
+    BOOST_CHECK_SMALL(c.get(1, 5, 7, 2) - 1.0E9, c.errorBound(1, 5, 2));
+    BOOST_CHECK_SMALL(c.get(1, 5, 8, 2) - (1000000.0 + 5 + 8 / 1000000.0 + 6), c.errorBound(1, 5, 2));
+    BOOST_CHECK(c.errorBound(1, 5, 2) <= QuantisedInMemoryCube::relativeErrorBound() * 1.0E9);
+
+    c.remove(1);
+    BOOST_CHECK_EQUAL(c.get(1, 5, 7, 2), 0.0);
+    BOOST_CHECK_EQUAL(c.errorBound(1, 5, 2), 0.0);
+    BOOST_CHECK_SMALL(c.get(2, 5, 7, 2) - (2000000.0 + 5 + 7 / 1000000.0 + 6), c.errorBound(2, 5, 2));
+}
+
+BOOST_AUTO_TEST_CASE(testTruncatedCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 3;
+    vector<Size> dateLengths = {50, 10, 0};
+    DoublePrecisionTruncatedCube c(Date(), ids, dates, samples, depth, dateLengths);
+    vector<Size> tooFewLengths = {50, 10}, tooLongLengths = {50, 10, 51};
+    BOOST_CHECK_THROW(DoublePrecisionTruncatedCube(Date(), ids, dates, samples, depth, tooFewLengths), std::exception);
+    BOOST_CHECK_THROW(DoublePrecisionTruncatedCube(Date(), ids, dates, samples, depth, tooLongLengths),
+                      std::exception);
+
+    for (Size i = 0; i < c.numIds(); ++i) {
+        BOOST_CHECK_EQUAL(c.dateLength(i), dateLengths[i]);
+        c.setT0(i + 0.5, i, 1);
+        for (Size j = 0; j < dateLengths[i]; ++j)
+            for (Size k = 0; k < samples; ++k)
+                for (Size d = 0; d < depth; ++d)
+                    c.set(i * 1000000.0 + j + k / 1000000.0 + d * 3, i, j, k, d);
+    }
+
+    // beyond the stored dates the values are zero and only zeros can be set
+    BOOST_CHECK_THROW(c.set(1.0, 1, 10, 0, 0), std::exception);
+    BOOST_CHECK_NO_THROW(c.set(0.0, 2, 0, 0, 0));
+    BOOST_CHECK_THROW(c.get(0, dates.size(), 0, 0), std::exception);
+
+    vector<Real> values;
+    for (Size i = 0; i < c.numIds(); ++i) {
+        BOOST_CHECK_EQUAL(c.getT0(i, 1), i + 0.5);
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size d = 0; d < depth; ++d) {
+                c.getSamples(i, j, d, values);
+                BOOST_REQUIRE_EQUAL(values.size(), samples);
+                for (Size k = 0; k < samples; ++k) {
+                    Real expected = j < dateLengths[i] ? i * 1000000.0 + j + k / 1000000.0 + d * 3 : 0.0;
+                    BOOST_CHECK_EQUAL(c.get(i, j, k, d), expected);
+                    BOOST_CHECK_EQUAL(values[k], expected);
+                }
+            }
+        }
+    }
+
+    c.remove(1, 7);
+    BOOST_CHECK_EQUAL(c.get(1, 5, 7, 2), 0.0);
+    BOOST_CHECK_EQUAL(c.get(1, 5, 8, 2), 1000000.0 + 5 + 8 / 1000000.0 + 6);
+    c.remove(0);
+    BOOST_CHECK_EQUAL(c.getT0(0, 1), 0.0);
+    BOOST_CHECK_EQUAL(c.get(0, 49, 199, 2), 0.0);
+    BOOST_CHECK_EQUAL(c.get(1, 9, 199, 2), 1000000.0 + 9 + 199 / 1000000.0 + 6);
+}
+
+BOOST_AUTO_TEST_CASE(testNettingSetAggregationCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    std::map<string, string> nettingSetIds{{"id1", "ns1"}, {"id2", "ns2"}, {"id3", "ns1"}};
+    vector<Date> dates(20, Date());
+    Size samples = 50;
+    Size depth = 2;
+    NettingSetAggregationCube c(Date(), ids, nettingSetIds, dates, samples, depth);
+    std::map<string, string> missingNettingSetIds{{"id1", "ns1"}};
+    BOOST_CHECK_THROW(NettingSetAggregationCube(Date(), ids, missingNettingSetIds, dates, samples, depth),
+                      std::exception);
+    BOOST_CHECK_EQUAL(c.numIds(), 3);
+    BOOST_CHECK_EQUAL(c.nettingSetCube()->numIds(), 2);
+
+    for (Size i = 0; i < c.numIds(); ++i) {
+        c.setT0(i + 0.5, i, 1);
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < samples; ++k)
+                for (Size d = 0; d < depth; ++d)
+                    c.set(i * 1000.0 + j + k / 1000.0 + d * 3, i, j, k, d);
+    }
+
+    // the trade values are aggregated by netting set, only the T0 values are kept on trade level
+    BOOST_CHECK_THROW(c.get(0, 0, 0, 0), std::exception);
+    const auto& n = c.nettingSetCube();
+    Size ns1 = n->getTradeIndex("ns1"), ns2 = n->getTradeIndex("ns2");
+    for (Size i = 0; i < c.numIds(); ++i)
+        BOOST_CHECK_EQUAL(c.getT0(i, 1), i + 0.5);
+    BOOST_CHECK_EQUAL(n->getT0(ns1, 1), 0.5 + 2.5);
+    BOOST_CHECK_EQUAL(n->getT0(ns2, 1), 1.5);
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            for (Size d = 0; d < depth; ++d) {
+                BOOST_CHECK_CLOSE(n->get(ns1, j, k, d), 2000.0 + 2 * (j + k / 1000.0 + d * 3), 1E-12);
+                BOOST_CHECK_CLOSE(n->get(ns2, j, k, d), 1000.0 + j + k / 1000.0 + d * 3, 1E-12);
+            }
+        }
+    }
+
+    // removing a trade only resets its T0 values
+    c.remove(2);
+    BOOST_CHECK_EQUAL(c.getT0(2, 1), 0.0);
+    BOOST_CHECK_EQUAL(n->getT0(ns1, 1), 0.5);
+    BOOST_CHECK_CLOSE(n->get(ns1, 5, 7, 1), 2000.0 + 2 * (5 + 7 / 1000.0 + 3), 1E-12);
+}
+
+BOOST_AUTO_TEST_CASE(testNettingSetAggregationCubeSubtractedIds) {
+    // a base run with trades id1, id2 in netting set ns1, then an incremental run adding id3 and removing id2
+    std::set<string> baseIds{string("id1"), string("id2")}, deltaIds{string("id2"), string("id3")};
+    std::map<string, string> nettingSetIds{{"id1", "ns1"}, {"id2", "ns1"}, {"id3", "ns1"}};
+    std::set<string> subtractedIds{string("id2")};
+    vector<Date> dates(5, Date());
+    Size samples = 10;
+    NettingSetAggregationCube base(Date(), baseIds, nettingSetIds, dates, samples, 1);
+    NettingSetAggregationCube delta(Date(), deltaIds, nettingSetIds, dates, samples, 1, subtractedIds);
+    auto value = [](Size trade, Size date, Size sample) { return trade * 100.0 + date + sample / 100.0; };
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            base.set(value(1, j, k), base.getTradeIndex("id1"), j, k);
+            base.set(value(2, j, k), base.getTradeIndex("id2"), j, k);
+            delta.set(value(2, j, k), delta.getTradeIndex("id2"), j, k);
+            delta.set(value(3, j, k), delta.getTradeIndex("id3"), j, k);
+        }
+    }
+    base.setT0(1.0, base.getTradeIndex("id1"));
+    base.setT0(2.0, base.getTradeIndex("id2"));
+    delta.setT0(2.0, delta.getTradeIndex("id2"));
+    delta.setT0(3.0, delta.getTradeIndex("id3"));
+
+    // the trade level T0 values are kept as they are, the netting set values net the removed trade out
+    BOOST_CHECK_EQUAL(delta.getT0(delta.getTradeIndex("id2")), 2.0);
+    BOOST_CHECK_EQUAL(delta.nettingSetCube()->getT0(0), 1.0);
+
+    JointNPVCube joint(base.nettingSetCube(), delta.nettingSetCube(), {}, false);
+    BOOST_CHECK_EQUAL(joint.numIds(), 1);
+    BOOST_CHECK_CLOSE(joint.getT0(0), 4.0, 1E-12);
+    for (Size j = 0; j < dates.size(); ++j)
+        for (Size k = 0; k < samples; ++k)
+            BOOST_CHECK_CLOSE(joint.get(0, j, k), value(1, j, k) + value(3, j, k), 1E-12);
+}
+
 BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileIO) {
     std::set<string> ids{string("id")}; // the overlap doesn't matter
     Date d(1, QuantLib::Jan, 2016);        // need a real date here
@@ -459,6 +703,197 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileNIO) {
     testCubeFileIO<DoublePrecisionInMemoryCubeN>(c, "DoublePrecisionInMemoryCubeN", 1e-14, true);
 }
 
+BOOST_AUTO_TEST_CASE(testInMemoryCubeBinaryFileIO) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    Date d(1, QuantLib::Jan, 2016); // need a real date here
+    vector<Date> dates(50, d);
+    Size samples = 200;
+    Size depth = 3;
+    DoublePrecisionInMemoryCubeN c(d, ids, dates, samples, depth);
+    testCubeFileIO<DoublePrecisionInMemoryCubeN>(c, "DoublePrecisionInMemoryCubeN", 1e-14, true, ".bin");
+    testCubeFileIO<DoublePrecisionInMemoryCubeN>(c, "DoublePrecisionInMemoryCubeN", 1e-14, true, ".bin.gz");
+    SinglePrecisionInMemoryCube c1(d, ids, dates, samples);
+    testCubeFileIO<SinglePrecisionInMemoryCube>(c1, "SinglePrecisionInMemoryCube", 1e-5, false, ".bin");
+}
+
+BOOST_AUTO_TEST_CASE(testBinaryCubeFileChunks) {
+    std::set<string> ids;
+    for (Size i = 0; i < 10; ++i)
+        ids.insert("id" + std::to_string(i));
+    Date d(1, QuantLib::Jan, 2016); // need a real date here
+    vector<Date> dates(20, d);
+    Size samples = 50;
+    Size depth = 2;
+    DoublePrecisionInMemoryCubeN c(d, ids, dates, samples, depth);
+    initCube(c);
+
+    // write 3 ids per chunk and compress on 2 threads, the last chunk holds one id only
+    string filename = boost::filesystem::unique_path().string() + ".bin.gz";
+    vector<string> idVec(ids.begin(), ids.end());
+    {
+        BinaryCubeWriter writer(filename, d, idVec, dates, samples, depth, true, true, 3, 2);
+        vector<Real> t0(depth), values(dates.size() * samples * depth);
+        for (Size i = 0; i < ids.size(); ++i) {
+            for (Size dd = 0; dd < depth; ++dd)
+                t0[dd] = c.getT0(i, dd);
+            for (Size j = 0, v = 0; j < dates.size(); ++j)
+                for (Size k = 0; k < samples; ++k)
+                    for (Size dd = 0; dd < depth; ++dd, ++v)
+                        values[v] = c.get(i, j, k, dd);
+            writer.write(t0, values);
+        }
+        writer.close();
+    }
+
+    BinaryCubeReader reader(filename);
+    BOOST_CHECK_EQUAL(reader.numChunks(), 4);
+
+    // read a single id
+    vector<Real> t0, values;
+    reader.get("id7", t0, values);
+    BOOST_REQUIRE_EQUAL(values.size(), dates.size() * samples * depth);
+    BOOST_CHECK_CLOSE(values[(5 * samples + 3) * depth + 1], 7000000.0 + 5 + 3 / 1000000.0 + 3, 1e-14);
+
+    // read all ids in parallel, the checks are done afterwards since Boost.Test is not thread safe
+    std::vector<Size> visited(ids.size(), 0);
+    std::vector<Real> last(ids.size(), 0.0);
+    reader.forEach(4, [&visited, &last](Size n, const vector<Real>& t0, const vector<Real>& values) {
+        visited[n]++;
+        last[n] = values.back();
+    });
+    for (Size n = 0; n < ids.size(); ++n) {
+        BOOST_CHECK_EQUAL(visited[n], 1);
+        BOOST_CHECK_CLOSE(last[n], n * 1000000.0 + 19 + 49 / 1000000.0 + 3, 1e-14);
+    }
+
+    // loadCube() uses the same reader
+    auto c2 = loadCube(filename, true);
+    checkCube(*c2, 1e-14);
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(testMappedBinaryCubeFile) {
+    std::set<string> ids;
+    for (Size i = 0; i < 7; ++i)
+        ids.insert("id" + std::to_string(i));
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates(10, d);
+    Size samples = 20;
+    Size depth = 2;
+    DoublePrecisionInMemoryCubeN c(d, ids, dates, samples, depth);
+    initCube(c);
+    for (Size i = 0; i < ids.size(); ++i)
+        for (Size dd = 0; dd < depth; ++dd)
+            c.setT0(i + 0.5 * dd, i, dd);
+
+    // write 3 ids per chunk uncompressed in single precision, the values are read in place from the mapped file
+    string filename = boost::filesystem::unique_path().string() + ".bin";
+    vector<string> idVec(ids.begin(), ids.end());
+    {
+        BinaryCubeWriter writer(filename, d, idVec, dates, samples, depth, false, false, 3);
+        vector<Real> t0(depth), values(dates.size() * samples * depth);
+        for (Size i = 0; i < ids.size(); ++i) {
+            for (Size dd = 0; dd < depth; ++dd)
+                t0[dd] = c.getT0(i, dd);
+            for (Size j = 0, v = 0; j < dates.size(); ++j)
+                for (Size k = 0; k < samples; ++k)
+                    for (Size dd = 0; dd < depth; ++dd, ++v)
+                        values[v] = c.get(i, j, k, dd);
+            writer.write(t0, values);
+        }
+        writer.close();
+    }
+
+    {
+        MappedBinaryCubeReader reader(filename);
+        BOOST_CHECK(!reader.doublePrecision());
+        BOOST_CHECK_EQUAL(reader.samples(), samples);
+        BOOST_REQUIRE_EQUAL(reader.ids().size(), ids.size());
+        BOOST_CHECK_EQUAL(reader.index("id4"), 4);
+        // the values of an id are contiguous, also across the chunk boundaries
+        BOOST_CHECK_EQUAL(reader.offset(2) - reader.offset(1), (1 + dates.size() * samples) * depth * sizeof(float));
+        for (Size i = 0; i < ids.size(); ++i) {
+            for (Size dd = 0; dd < depth; ++dd)
+                BOOST_CHECK_CLOSE(reader.getT0(i, dd), c.getT0(i, dd), 1e-5);
+            for (Size j = 0; j < dates.size(); ++j)
+                for (Size k = 0; k < samples; ++k)
+                    for (Size dd = 0; dd < depth; ++dd)
+                        BOOST_CHECK_CLOSE(reader.get(i, j, k, dd), c.get(i, j, k, dd), 1e-5);
+        }
+        BOOST_CHECK_THROW(reader.get(0, dates.size(), 0), std::exception);
+        BOOST_CHECK_THROW(reader.index("id7"), std::exception);
+    }
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(testCubeArrowFile) {
+    BOOST_CHECK(isArrowFilename("cube.arrow"));
+    BOOST_CHECK(isArrowFilename("cube.feather"));
+    BOOST_CHECK(!isArrowFilename("cube.csv.gz"));
+
+    std::set<string> ids{string("id1"), string("id2")};
+    vector<Date> dates(5, Date(15, QuantLib::December, 2016));
+    DoublePrecisionInMemoryCubeN c(Date(14, QuantLib::December, 2016), ids, dates, 10, 2);
+    initCube(c);
+    std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() +
+                           ".arrow";
+    if (!arrowSupported()) {
+        BOOST_CHECK_THROW(saveCube(filename, c), std::exception);
+        return;
+    }
+    saveCube(filename, c, true);
+    // arrow ipc files start and end with the magic string ARROW1
+    std::ifstream in(filename, std::ios::binary);
+    char magic[6];
+    in.read(magic, 6);
+    BOOST_CHECK_EQUAL(std::string(magic, 6), "ARROW1");
+    in.close();
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(testFileMappedCube) {
+    std::set<string> ids{string("id1"), string("id2")};
+    Date d(1, QuantLib::Jan, 2016); // need a real date here
+    vector<Date> dates;
+    for (Size i = 0; i < 50; ++i)
+        dates.push_back(d + i + 1);
+    Size samples = 200;
+    Size depth = 3;
+    string filename = boost::filesystem::unique_path().string();
+    {
+        DoublePrecisionFileMappedCube c(filename, d, ids, dates, samples, depth);
+        testCube(c, "DoublePrecisionFileMappedCube", 1e-14);
+        c.setT0(42.0, 1, 2);
+    }
+
+    // the file is the persisted cube, loadCube() maps it without parsing
+    BOOST_TEST_MESSAGE("Loading from file " << filename);
+    auto c2 = loadCube(filename);
+    BOOST_REQUIRE(boost::dynamic_pointer_cast<DoublePrecisionFileMappedCube>(c2));
+    BOOST_CHECK_EQUAL(c2->asof(), d);
+    BOOST_CHECK(c2->ids() == ids);
+    BOOST_CHECK(c2->dates() == dates);
+    BOOST_CHECK_EQUAL(c2->samples(), samples);
+    BOOST_CHECK_EQUAL(c2->depth(), depth);
+    BOOST_CHECK_EQUAL(c2->getT0(1, 2), 42.0);
+    checkCube(*c2, 1e-14);
+
+    // the loaded cube is copy on write, changes are not written back to the file
+    c2->set(-1.0, 0, 0, 0, 0);
+    c2 = nullptr;
+    {
+        SinglePrecisionFileMappedCube c3(filename + "_single", d, ids, dates, samples, depth, 1.0f);
+        BOOST_CHECK_EQUAL(c3.get(1, 49, 199, 2), 1.0);
+        BOOST_CHECK_THROW(SinglePrecisionFileMappedCube(filename, true), std::exception);
+        DoublePrecisionFileMappedCube c4(filename, true);
+        BOOST_CHECK_EQUAL(c4.get(0, 0, 0, 0), 0.0);
+        checkCube(c4, 1e-14);
+    }
+
+    boost::filesystem::remove(filename);
+    boost::filesystem::remove(filename + "_single");
+}
+
 BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     std::set<string> ids = {"id1", "id2", "id3"}; // the overlap doesn't matter
     Date today = Date::todaysDate();
@@ -469,6 +904,91 @@ BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     testCubeGetSetbyDateID(cube, 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testJointNPVCubeSamplesAndMaterialise) {
+    vector<Date> dates(10, Date());
+    Size samples = 100;
+    Size depth = 2;
+    auto c1 = boost::make_shared<DoublePrecisionInMemoryCubeN>(Date(), std::set<string>{"id1", "id2"}, dates, samples,
+                                                               depth);
+    auto c2 = boost::make_shared<DoublePrecisionMemoryMappedCube>(Date(), std::set<string>{"id2", "id3"}, dates,
+                                                                  samples, depth);
+    initCube(*c1);
+    initCube(*c2);
+
+    // id2 occurs in both cubes and is aggregated
+    JointNPVCube joint(c1, c2, {}, false);
+    BOOST_REQUIRE_EQUAL(joint.numIds(), 3);
+    vector<Real> v;
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < dates.size(); ++j) {
+            joint.getSamples(i, j, 1, v);
+            BOOST_REQUIRE_EQUAL(v.size(), samples);
+            for (Size k = 0; k < samples; ++k)
+                BOOST_CHECK_CLOSE(v[k], joint.get(i, j, k, 1), 1e-12);
+        }
+    }
+    // id2 has index 1 in c1 and index 0 in c2
+    joint.getSamples(1, 5, 1, v);
+    BOOST_CHECK_CLOSE(v[7], (1000000.0 + 5 + 7 / 1000000.0 + 3) + (5 + 7 / 1000000.0 + 3), 1e-12);
+
+    auto m = joint.materialise(true);
+    BOOST_CHECK(m->ids() == joint.ids());
+    for (Size i = 0; i < 3; ++i)
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < samples; ++k)
+                for (Size d = 0; d < depth; ++d)
+                    BOOST_CHECK_CLOSE(m->get(i, j, k, d), joint.get(i, j, k, d), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(testExposureConvergenceMonitor) {
+    vector<Date> dates(2, Date());
+    Size samples = 200;
+    // the ids are not trades of the (empty) portfolio, so they are treated as their own netting sets
+    auto c = boost::make_shared<DoublePrecisionInMemoryCube>(Date(), std::set<string>{"NS1", "NS2"}, dates, samples);
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            c->set(1.0, 0, j, k);
+            c->set(k % 10 < 5 ? 2.0 : -1.0, 1, j, k);
+        }
+    }
+
+    auto portfolio = boost::make_shared<Portfolio>();
+    ExposureConvergenceMonitor monitor(portfolio, 0.01, 100, 20, 50);
+    for (Size k = 0; k < 100; ++k) {
+        BOOST_CHECK(!monitor.converged());
+        monitor.add(c, k);
+    }
+    BOOST_CHECK_EQUAL(monitor.samples(), 100);
+    BOOST_CHECK_CLOSE(monitor.expectedExposures().at("NS1"), 1.0, 1e-12);
+    BOOST_CHECK_SMALL(monitor.standardErrors().at("NS1"), 1e-12);
+    // batches of 5 samples alternate between an exposure of 2 and 0
+    BOOST_CHECK_CLOSE(monitor.expectedExposures().at("NS2"), 1.0, 1e-12);
+    BOOST_CHECK_CLOSE(monitor.standardErrors().at("NS2"), std::sqrt(20.0 / 19.0 / 20.0), 1e-10);
+    BOOST_CHECK(!monitor.converged());
+    BOOST_CHECK_THROW(monitor.add(c, 101), std::exception);
+
+    // NS1 alone converges at the first check
+    auto c1 = boost::make_shared<DoublePrecisionInMemoryCube>(Date(), std::set<string>{"NS1"}, dates, samples);
+    for (Size j = 0; j < dates.size(); ++j)
+        for (Size k = 0; k < samples; ++k)
+            c1->set(1.0, 0, j, k);
+    ExposureConvergenceMonitor monitor1(portfolio, 0.01, 100, 20, 50);
+    for (Size k = 0; k < 100; ++k)
+        monitor1.add(c1, k);
+    BOOST_CHECK(monitor1.converged());
+
+    // the post processing of an early stopped run sees the simulated samples only
+    SampleSubsetCube subset(c, 100);
+    BOOST_CHECK_EQUAL(subset.samples(), 100);
+    BOOST_CHECK_EQUAL(subset.numIds(), 2);
+    BOOST_CHECK_EQUAL(subset.get(1, 1, 7), -1.0);
+    vector<Real> v;
+    subset.getSamples(1, 0, 0, v);
+    BOOST_CHECK_EQUAL(v.size(), 100);
+    BOOST_CHECK_THROW(subset.get(0, 0, 100), std::exception);
+    BOOST_CHECK_THROW(SampleSubsetCube(c, 201), std::exception);
+}
+
 BOOST_AUTO_TEST_CASE(testSinglePrecisionJaggedCube) {
 
     SavedSettings backup;
@@ -537,6 +1057,116 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionJaggedCube) {
     IndexManager::instance().clearHistories();
 }
 
+BOOST_AUTO_TEST_CASE(testSensiCube) {
+
+    BOOST_TEST_MESSAGE("Testing the sensi cube storage with scenarios set in arbitrary order");
+
+    Date today = Date(15, December, 2016);
+    DoublePrecisionSensiCube cube({"trade1", "trade2"}, today, 10);
+    cube.setT0(100.0, 0, 0);
+    cube.setT0(50.0, 1, 0);
+
+    // out of order, a value equal to the base npv and an overwrite
+    cube.set(101.0, 0, 5);
+    cube.set(102.0, 0, 2);
+    cube.set(100.0, 0, 3);
+    cube.set(103.0, 0, 8);
+    cube.set(104.0, 0, 2);
+    cube.set(51.0, 1, 9);
+
+    BOOST_CHECK_EQUAL(cube.get(0, 2), 104.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 3), 100.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 5), 101.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 8), 103.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 9), 100.0);
+    BOOST_CHECK_EQUAL(cube.get(1, 9), 51.0);
+    BOOST_CHECK_EQUAL(cube.get(1, 2), 50.0);
+
+    std::vector<Size> expected = {2, 5, 8};
+    std::vector<Size> scenarios = cube.getTradeScenarios(0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(scenarios.begin(), scenarios.end(), expected.begin(), expected.end());
+    std::map<Size, Real> npvs = cube.getTradeNPVs(0);
+    BOOST_CHECK_EQUAL(npvs.size(), 3);
+    BOOST_CHECK_EQUAL(npvs[5], 101.0);
+
+    cube.remove(0, 5);
+    cube.remove(0, 4);
+    BOOST_CHECK_EQUAL(cube.get(0, 5), 100.0);
+    BOOST_CHECK_EQUAL(cube.getTradeScenarios(0).size(), 2);
+    BOOST_CHECK_EQUAL(cube.relevantScenarios().size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(testCubeMemoryFootprint) {
+
+    BOOST_TEST_MESSAGE("Testing the memory footprint estimate of in memory cubes");
+
+    std::set<string> ids{"trade1", "trade2", "trade3"};
+    vector<Date> dates(10, Date(15, December, 2016));
+    Size samples = 100;
+    SinglePrecisionInMemoryCube single(Date(14, December, 2016), ids, dates, samples);
+    DoublePrecisionInMemoryCube dbl(Date(14, December, 2016), ids, dates, samples);
+
+    Size values = ids.size() * dates.size() * samples;
+    BOOST_CHECK_GE(single.memoryFootprint(), values * sizeof(float));
+    BOOST_CHECK_GE(dbl.memoryFootprint(), values * sizeof(double));
+    BOOST_CHECK_GT(dbl.memoryFootprint(), single.memoryFootprint());
+}
+
+BOOST_AUTO_TEST_CASE(testCubeShards) {
+
+    BOOST_TEST_MESSAGE("Testing the partition of a portfolio into shards and the merge of the shard cubes");
+
+    // netting sets NS0, NS1, NS2 with 4, 2 and 1 trades
+    ore::data::Portfolio portfolio;
+    for (Size i = 0; i < 7; ++i) {
+        auto trade = boost::make_shared<ore::data::Swap>();
+        trade->id() = "trade" + std::to_string(i);
+        trade->envelope() = Envelope("CP", i < 4 ? "NS0" : (i < 6 ? "NS1" : "NS2"));
+        portfolio.add(trade);
+    }
+    auto shards = partitionByNettingSet(portfolio, 2);
+    BOOST_REQUIRE_EQUAL(shards.size(), Size(2));
+    BOOST_CHECK_EQUAL(shards[0].size(), Size(4));
+    BOOST_CHECK_EQUAL(shards[1].size(), Size(3));
+    BOOST_CHECK(shards[1].count("trade4") == 1 && shards[1].count("trade6") == 1);
+    // the partition is deterministic and more shards than netting sets leave shards empty
+    BOOST_CHECK(partitionByNettingSet(portfolio, 2) == shards);
+    BOOST_CHECK(partitionByNettingSet(portfolio, 4)[3].empty());
+
+    // the shard cubes written to files are joined to the cube of the whole portfolio
+    vector<Date> dates(5, Date(15, December, 2016));
+    Size samples = 20;
+    DoublePrecisionInMemoryCubeN cube(Date(14, December, 2016), portfolio.ids(), dates, samples, 2);
+    initCube(cube);
+    std::string pattern = boost::filesystem::unique_path().string() + "_{shard}.bin";
+    for (Size s = 0; s < shards.size(); ++s) {
+        DoublePrecisionInMemoryCubeN shardCube(cube.asof(), shards[s], dates, samples, 2);
+        for (auto const& [id, i] : shardCube.idsAndIndexes()) {
+            Size c = cube.idsAndIndexes().at(id);
+            for (Size d = 0; d < 2; ++d) {
+                shardCube.setT0(cube.getT0(c, d), i, d);
+                for (Size j = 0; j < dates.size(); ++j)
+                    for (Size k = 0; k < samples; ++k)
+                        shardCube.set(cube.get(c, j, k, d), i, j, k, d);
+            }
+        }
+        saveCube(shardName(pattern, s), shardCube, true);
+    }
+    JointNPVCube joint(loadCubeShards(pattern, shards.size()));
+    BOOST_REQUIRE(joint.ids() == cube.ids());
+    for (Size i = 0; i < cube.numIds(); ++i)
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < samples; ++k)
+                for (Size d = 0; d < 2; ++d)
+                    BOOST_CHECK_EQUAL(joint.get(i, j, k, d), cube.get(i, j, k, d));
+    for (Size s = 0; s < shards.size(); ++s)
+        boost::filesystem::remove(shardName(pattern, s));
+
+    // the portfolio of a shard
+    restrictToShard(portfolio, 2, 1);
+    BOOST_CHECK(portfolio.ids() == shards[1]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
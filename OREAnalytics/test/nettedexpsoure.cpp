@@ -43,11 +43,16 @@
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <test/oreatoplevelfixture.hpp>
 #include <test/testmarket.hpp>
+#include <test/testportfolio.hpp>
 
+#include <orea/aggregation/collatexposurehelper.hpp>
 #include <orea/aggregation/exposurecalculator.hpp>
 #include <orea/aggregation/nettedexposurecalculator.hpp>
 #include <orea/aggregation/dimcalculator.hpp>
 #include <orea/aggregation/dimregressioncalculator.hpp>
+#include <orea/aggregation/dimsimmcalculator.hpp>
+#include <orea/simm/simmbucketmapperbase.hpp>
+#include <orea/simm/utilities.hpp>
 #include <orea/scenario/scenariogeneratordata.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <ored/portfolio/nettingsetdetails.hpp>
@@ -55,6 +60,7 @@
 #include <ored/portfolio/nettingsetmanager.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/engine/mporcalculator.hpp>
+#include <orea/engine/vanillaoptionbatchcalculator.hpp>
 #include <ql/time/date.hpp>
 #include <ql/utilities/dataparsers.hpp>
 #include <cmath>
@@ -691,5 +697,162 @@ BOOST_AUTO_TEST_CASE(NettedExposureCalculatorTest) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(CollateralBalancesTest) {
+
+    BOOST_TEST_MESSAGE("Testing collateral balances of all samples against the collateral account paths...");
+
+    Date today(10, Jan, 2022);
+    vector<Date> dateGrid;
+    for (Size i = 1; i <= 30; ++i)
+        dateGrid.push_back(today + Period(2 * i, Weeks));
+    Size samples = 50;
+
+    MersenneTwisterUniformRng rng(42);
+    vector<vector<Real>> values(dateGrid.size(), vector<Real>(samples)), fx = values, rates = values;
+    for (Size k = 0; k < samples; ++k) {
+        Real v = 0.0;
+        for (Size j = 0; j < dateGrid.size(); ++j) {
+            v += 2.0E5 * (rng.nextReal() - 0.5);
+            values[j][k] = v;
+            fx[j][k] = 1.0 + 0.2 * (rng.nextReal() - 0.5);
+            rates[j][k] = 0.01 + 0.02 * rng.nextReal();
+        }
+    }
+
+    vector<string> elgColls = {"EUR"};
+    vector<boost::shared_ptr<NettingSetDefinition>> nettingSets = {
+        boost::make_shared<NettingSetDefinition>("NS1", "Bilateral", "EUR", "EUR-EONIA", 1.0E4, 2.0E4, 5.0E3, 1.0E3,
+                                                 0.0, "FIXED", "1W", "2W", "2W", 0.001, 0.002, elgColls),
+        boost::make_shared<NettingSetDefinition>("NS2", "Bilateral", "EUR", "EUR-EONIA", 0.0, 0.0, 0.0, 0.0, 1.0E4,
+                                                 "FIXED", "1D", "1D", "10D", 0.0, 0.0, elgColls)};
+
+    for (auto const& n : nettingSets) {
+        for (auto calcType : {CollateralExposureHelper::Symmetric, CollateralExposureHelper::AsymmetricCVA,
+                              CollateralExposureHelper::AsymmetricDVA, CollateralExposureHelper::NoLag}) {
+            auto paths = CollateralExposureHelper::collateralBalancePaths(
+                n, 1.0E4, today, values, dateGrid.back() - 20, dateGrid, 1.0, fx, 0.01, rates, calcType);
+            vector<vector<Real>> balances = CollateralExposureHelper::collateralBalances(
+                n, 1.0E4, today, values, dateGrid.back() - 20, dateGrid, 1.0, fx, 0.01, rates, calcType);
+            BOOST_REQUIRE_EQUAL(balances.size(), dateGrid.size());
+            for (Size j = 0; j < dateGrid.size(); ++j) {
+                for (Size k = 0; k < samples; ++k) {
+                    Real expected = paths->at(k)->accountBalance(dateGrid[j]);
+                    BOOST_CHECK_SMALL(balances[j][k] - expected, 1.0E-8 * std::max(1.0, std::fabs(expected)));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BatchVanillaOptionPricingTest) {
+
+    BOOST_TEST_MESSAGE("Testing the batch pricing of FX options against the individual pricing...");
+
+    SavedSettings backup;
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<DateGrid> dateGrid = boost::make_shared<DateGrid>("10,6M");
+    Size samples = 20;
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<CrossAssetModel> model = buildCrossAssetModel(initMarket);
+    auto simMarket = buildScenarioSimMarket(dateGrid, initMarket, model, samples);
+
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("FxOption") = "GarmanKohlhagen";
+    data->engine("FxOption") = "AnalyticEuropeanEngine";
+    boost::shared_ptr<EngineFactory> factory = boost::make_shared<EngineFactory>(data, simMarket);
+
+    // options on USDEUR, some expire within the date grid, one has a premium
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildFxOption("FxCall_1Y", "Long", "Call", 1, "USD", 1.0E6, "EUR", 0.9E6));
+    portfolio->add(buildFxOption("FxPut_2Y", "Short", "Put", 2, "USD", 1.0E6, "EUR", 0.8E6));
+    portfolio->add(buildFxOption("FxCall_3Y", "Short", "Call", 3, "USD", 2.0E6, "EUR", 1.6E6));
+    portfolio->add(buildFxOption("FxPut_4Y", "Long", "Put", 4, "USD", 1.0E6, "EUR", 0.95E6, 1.0E4, "EUR",
+                                 ore::data::to_string(today + 1 * Years)));
+    portfolio->build(factory);
+
+    ValuationEngine valEngine(today, dateGrid, simMarket);
+    auto cube = boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dateGrid->dates(), samples);
+    valEngine.buildCube(portfolio, cube, {boost::make_shared<NPVCalculator>("EUR")});
+
+    auto batchCalculator = boost::make_shared<VanillaOptionBatchNPVCalculator>("EUR");
+    auto batchCube =
+        boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dateGrid->dates(), samples);
+    valEngine.buildCube(portfolio, batchCube, {batchCalculator});
+    BOOST_CHECK_EQUAL(batchCalculator->batchTrades(), portfolio->size());
+
+    for (Size i = 0; i < portfolio->size(); ++i) {
+        BOOST_CHECK_CLOSE(batchCube->getT0(i), cube->getT0(i), 1.0E-10);
+        for (Size j = 0; j < dateGrid->size(); ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                Real expected = cube->get(i, j, k);
+                BOOST_CHECK_SMALL(batchCube->get(i, j, k) - expected, 1.0E-8 * std::max(1.0, std::fabs(expected)));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SimmDynamicInitialMarginTest) {
+
+    BOOST_TEST_MESSAGE("Testing the SIMM dynamic initial margin on regression sensitivities...");
+
+    SavedSettings backup;
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    auto trade = boost::make_shared<ore::data::Swap>();
+    trade->id() = "Swap";
+    trade->envelope() = Envelope("CP", "NS");
+    portfolio->add(trade);
+
+    // the netting set value is a quadratic function of the simulated index fixing, so that the second order
+    // regression is exact and the SIMM delta is known in closed form
+    vector<Date> dates = {today + 6 * Months, today + 1 * Years, today + 18 * Months};
+    Size samples = 50;
+    Real a = 1.0E6, b = -2.0E7;
+    auto cube = boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dates, samples);
+    auto asd = boost::make_shared<InMemoryAggregationScenarioData>(dates.size(), samples);
+    vector<vector<Real>> fixing(dates.size(), vector<Real>(samples));
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            Real x = 0.01 + 0.02 * (j + 1) * (static_cast<Real>(k) / samples - 0.5);
+            fixing[j][k] = x;
+            asd->set(j, k, 1.0, AggregationScenarioDataType::Numeraire);
+            asd->set(j, k, x, AggregationScenarioDataType::IndexFixing, "EUR-EURIBOR-6M");
+            cube->set(a * x + b * x * x, 0, j, k);
+        }
+    }
+    auto cubeInterpreter =
+        boost::make_shared<CubeInterpretation>(false, false, Handle<AggregationScenarioData>(asd));
+
+    auto simmConfiguration = buildSimmConfiguration("2.6", boost::make_shared<SimmBucketMapperBase>());
+    vector<SimmDynamicInitialMarginCalculator::RiskFactor> riskFactors = {
+        parseDimSimmRiskFactor("EUR-EURIBOR-6M:Risk_IRCurve:EUR:5y:Libor6m")};
+    BOOST_CHECK_EQUAL(riskFactors[0].label1, "5y");
+    BOOST_CHECK_EQUAL(riskFactors[0].label2, "Libor6m");
+
+    boost::shared_ptr<InputParameters> inputs = boost::make_shared<InputParameters>();
+    auto dimCalculator = boost::make_shared<SimmDynamicInitialMarginCalculator>(
+        inputs, portfolio, cube, cubeInterpreter, asd, simmConfiguration, "EUR", riskFactors, 2);
+    dimCalculator->build();
+
+    Real riskWeight = simmConfiguration->weight(SimmConfiguration::RiskType::IRCurve, "EUR", "5y", "EUR");
+    const vector<vector<Real>>& dim = dimCalculator->dynamicIM("NS");
+    const vector<vector<vector<Real>>>& sensis = dimCalculator->sensitivities("NS");
+    // the last date of a regular cube is not part of the DIM calculation
+    for (Size j = 0; j + 1 < dates.size(); ++j) {
+        Real expectedDim = 0.0;
+        for (Size k = 0; k < samples; ++k) {
+            Real delta = (a + 2.0 * b * fixing[j][k]) * 1.0E-4;
+            BOOST_CHECK_SMALL(sensis[0][j][k] - delta, 1.0E-6 * std::fabs(a) * 1.0E-4);
+            BOOST_CHECK_SMALL(dim[j][k] - riskWeight * std::fabs(delta), 1.0E-6 * std::fabs(a));
+            expectedDim += riskWeight * std::fabs(delta) / samples;
+        }
+        BOOST_CHECK_SMALL(dimCalculator->expectedIM("NS")[j] - expectedDim, 1.0E-6 * std::fabs(a));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
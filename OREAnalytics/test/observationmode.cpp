@@ -428,6 +428,18 @@ BOOST_AUTO_TEST_CASE(testDefer) {
     simulation("10,1Y", true);
 }
 
+BOOST_AUTO_TEST_CASE(testAuto) {
+    BOOST_TEST_MESSAGE("Testing Observation Mode Auto");
+    ObservationMode::instance().setMode("Auto", ObservationMode::Mode::Disable);
+    BOOST_CHECK(ObservationMode::instance().mode() == ObservationMode::Mode::Disable);
+    ObservationMode::instance().setMode("Auto", ObservationMode::Mode::None);
+    BOOST_CHECK(ObservationMode::instance().mode() == ObservationMode::Mode::None);
+    // explicit modes are not affected by the auto default
+    ObservationMode::instance().setMode("Unregister", ObservationMode::Mode::Disable);
+    BOOST_CHECK(ObservationMode::instance().mode() == ObservationMode::Mode::Unregister);
+    ObservationMode::instance().setMode(ObservationMode::Mode::None);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
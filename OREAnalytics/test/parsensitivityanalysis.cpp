@@ -20,6 +20,7 @@
 #include <test/oreatoplevelfixture.hpp>
 #include <test/testmarket.hpp>
 #include <test/testportfolio.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/timer/timer.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/npvcube.hpp>
@@ -1184,6 +1185,22 @@ void testParConversion(ObservationMode::Mode om) {
         }
     }
 
+    // the batched conversion gives the same par deltas as the conversion trade by trade
+    std::vector<Size> tradeIndices;
+    for (auto const& [tradeId, tradeIdx] : sensiCube->tradeIdx())
+        tradeIndices.push_back(tradeIdx);
+    auto batchedDeltas = parCube.parDeltas(tradeIndices);
+    BOOST_REQUIRE_EQUAL(batchedDeltas.size(), tradeIndices.size());
+    for (Size t = 0; t < tradeIndices.size(); ++t) {
+        auto singleDeltas = parCube.parDeltas(tradeIndices[t]);
+        BOOST_CHECK_EQUAL(batchedDeltas[t].size(), singleDeltas.size());
+        for (auto const& [key, delta] : singleDeltas) {
+            auto it = batchedDeltas[t].find(key);
+            BOOST_REQUIRE_MESSAGE(it != batchedDeltas[t].end(), "batched par delta for " << key << " not found");
+            BOOST_CHECK_CLOSE(it->second, delta, 1.0E-10);
+        }
+    }
+
     struct Results {
         string id;
         string label;
@@ -1336,6 +1353,44 @@ void testParConversion(ObservationMode::Mode om) {
     BOOST_CHECK_MESSAGE(count == cachedResults.size(), "number of non-zero par sensitivities ("
                                                            << count << ") do not match regression data ("
                                                            << cachedResults.size() << ")");
+
+    // the factorisation written to / read from the cache directory gives the same conversion
+    string cacheDir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    auto writingConverter = boost::make_shared<ParSensitivityConverter>(parAnalysis.parSensitivities(),
+                                                                        parAnalysis.shiftSizes(), cacheDir);
+    BOOST_CHECK(!boost::filesystem::is_empty(cacheDir));
+    auto readingConverter = boost::make_shared<ParSensitivityConverter>(parAnalysis.parSensitivities(),
+                                                                        parAnalysis.shiftSizes(), cacheDir);
+    boost::numeric::ublas::vector<Real> zeroSensis(parConverter->rawKeys().size());
+    for (Size i = 0; i < zeroSensis.size(); ++i)
+        zeroSensis[i] = 1.0 + static_cast<Real>(i % 7);
+    boost::numeric::ublas::vector<Real> p0 = parConverter->convertSensitivity(zeroSensis);
+    boost::numeric::ublas::vector<Real> p1 = writingConverter->convertSensitivity(zeroSensis);
+    boost::numeric::ublas::vector<Real> p2 = readingConverter->convertSensitivity(zeroSensis);
+    for (Size i = 0; i < zeroSensis.size(); ++i) {
+        BOOST_CHECK_EQUAL(p1[i], p0[i]);
+        BOOST_CHECK_EQUAL(p2[i], p0[i]);
+    }
+    boost::filesystem::remove_all(cacheDir);
+
+    // the par instrument sensitivities computed in parallel match the sequential ones
+    ParSensitivityAnalysis parallelParAnalysis(today, simMarketData, *sensiData, "default");
+    parallelParAnalysis.alignPillars();
+    IborFallbackConfig iborFallbackConfig = IborFallbackConfig::defaultConfig();
+    parallelParAnalysis.setParallel(4, [&initMarket, &simMarketData, &sensiData, &iborFallbackConfig]() {
+        return buildScenarioSimMarketForSensitivityAnalysis(initMarket, simMarketData, sensiData, nullptr, nullptr,
+                                                            nullptr, "default", false, true, iborFallbackConfig);
+    });
+    parallelParAnalysis.computeParInstrumentSensitivities(zeroAnalysis->simMarket());
+    BOOST_CHECK_EQUAL(parallelParAnalysis.parSensitivities().size(), parAnalysis.parSensitivities().size());
+    for (auto const& p : parAnalysis.parSensitivities()) {
+        auto q = parallelParAnalysis.parSensitivities().find(p.first);
+        BOOST_REQUIRE_MESSAGE(q != parallelParAnalysis.parSensitivities().end(),
+                              "parallel par sensitivity " << p.first.first << " w.r.t. " << p.first.second
+                                                          << " not found");
+        BOOST_CHECK_CLOSE(q->second, p.second, 1.0E-8);
+    }
+
     ObservationMode::instance().setMode(backupMode);
     IndexManager::instance().clearHistories();
 }
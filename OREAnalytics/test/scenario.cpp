@@ -5,10 +5,16 @@ All rights reserved.
 
 #include <oret/toplevelfixture.hpp>
 #include <boost/make_shared.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <orea/scenario/compactscenariofactory.hpp>
+#include <orea/scenario/historicalscenarioloader.hpp>
+#include <orea/scenario/historicalshiftstore.hpp>
+#include <orea/scenario/scenariocache.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/csvscenariogenerator.hpp>
+#include <ql/time/calendars/target.hpp>
 
 using namespace boost::unit_test_framework;
 using namespace QuantLib;
@@ -32,6 +38,21 @@ private:
     int current_position_;
 };
 
+class TestHistoricalScenarioReader : public HistoricalScenarioReader {
+public:
+    TestHistoricalScenarioReader(const vector<boost::shared_ptr<Scenario>>& scenarios)
+        : scenarios_(scenarios), i_(0) {}
+    bool next() override { return ++i_ <= scenarios_.size(); }
+    Date date() const override { return i_ <= scenarios_.size() ? scenarios_[i_ - 1]->asof() : Null<Date>(); }
+    boost::shared_ptr<Scenario> scenario() const override {
+        return i_ <= scenarios_.size() ? scenarios_[i_ - 1] : nullptr;
+    }
+
+private:
+    vector<boost::shared_ptr<Scenario>> scenarios_;
+    Size i_;
+};
+
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(CSVScenarioGeneratorTest)
@@ -89,4 +110,293 @@ BOOST_AUTO_TEST_CASE(testCSVScenarioGenerator) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(BinaryScenarioFileTest)
+
+BOOST_AUTO_TEST_CASE(testBinaryScenarioFile) {
+
+    BOOST_TEST_MESSAGE("Testing binary scenario file write and read...");
+
+    vector<Date> dates = {Date(21, Dec, 2016), Date(21, Jan, 2017)};
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::IndexCurve, "CHF-LIBOR-6M", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "CHF", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "CHF", 1},
+                                  {RiskFactorKey::KeyType::FXSpot, "CHFEUR"}};
+
+    // two samples on two dates
+    vector<boost::shared_ptr<Scenario>> scenarios;
+    for (Size sample = 0; sample < 2; ++sample) {
+        for (auto const& d : dates) {
+            auto s = boost::make_shared<SimpleScenario>(d, "", 1.0 + 0.1 * sample);
+            for (auto const& rf : rfks)
+                s->add(rf, rand() / static_cast<Real>(RAND_MAX));
+            scenarios.push_back(s);
+        }
+    }
+
+    string filename = "test_binary_scenario_file.bin";
+    {
+        BinaryScenarioFileWriter writer(filename);
+        for (auto const& s : scenarios)
+            writer.writeScenario(s);
+    }
+
+    BinaryScenarioFileReader reader(filename);
+    BOOST_REQUIRE_EQUAL(reader.size(), scenarios.size());
+    BOOST_REQUIRE_EQUAL(reader.keys()->size(), rfks.size());
+    for (Size i = 0; i < scenarios.size(); ++i) {
+        BOOST_CHECK_EQUAL(reader.date(i), scenarios[i]->asof());
+        BOOST_CHECK_EQUAL(reader.sample(i), i / dates.size() + 1);
+        BOOST_CHECK_EQUAL(reader.numeraire(i), scenarios[i]->getNumeraire());
+        auto s = reader.scenario(i);
+        BOOST_CHECK(s->keyTable() == reader.keys());
+        for (auto const& rf : rfks)
+            BOOST_CHECK_EQUAL(s->get(rf), scenarios[i]->get(rf));
+    }
+
+    // replay as scenario generator and as historical scenario reader
+    BinaryScenarioGenerator generator(filename);
+    for (Size i = 0; i < scenarios.size(); ++i) {
+        auto s = generator.next(scenarios[i]->asof());
+        BOOST_CHECK_EQUAL(s->get(rfks[1]), scenarios[i]->get(rfks[1]));
+    }
+    BOOST_CHECK_THROW(generator.next(dates[0]), QuantLib::Error);
+    generator.reset();
+    BOOST_CHECK_THROW(generator.next(dates[1]), QuantLib::Error);
+
+    HistoricalBinaryScenarioReader historicalReader(filename);
+    BOOST_CHECK(historicalReader.date() == Null<Date>());
+    Size count = 0;
+    while (historicalReader.next()) {
+        BOOST_CHECK_EQUAL(historicalReader.date(), scenarios[count]->asof());
+        BOOST_CHECK_EQUAL(historicalReader.scenario()->get(rfks[3]), scenarios[count]->get(rfks[3]));
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, scenarios.size());
+    BOOST_CHECK(historicalReader.scenario() == nullptr);
+
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testCompactHistoricalScenarioLoader) {
+
+    BOOST_TEST_MESSAGE("Testing compact historical scenario loader...");
+
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::DiscountCurve, "EUR", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "EUR", 1},
+                                  {RiskFactorKey::KeyType::FXSpot, "USDEUR"}};
+
+    // business days from 1 to 10 March 2017 with a gap, the last key is missing on 6 March
+    vector<boost::shared_ptr<Scenario>> scenarios;
+    for (Date d = Date(1, Mar, 2017); d <= Date(10, Mar, 2017); ++d) {
+        if (!TARGET().isBusinessDay(d) || d == Date(7, Mar, 2017))
+            continue;
+        auto s = boost::make_shared<SimpleScenario>(d, "", 1.0);
+        for (auto const& rf : rfks) {
+            if (d != Date(6, Mar, 2017) || rf != rfks[2])
+                s->add(rf, rand() / static_cast<Real>(RAND_MAX));
+        }
+        scenarios.push_back(s);
+    }
+
+    Date startDate(2, Mar, 2017), endDate(9, Mar, 2017);
+    HistoricalScenarioLoader loader(boost::make_shared<TestHistoricalScenarioReader>(scenarios), startDate, endDate,
+                                    TARGET());
+    CompactHistoricalScenarioLoader compact(boost::make_shared<TestHistoricalScenarioReader>(scenarios), startDate,
+                                            endDate, TARGET());
+
+    auto check = [&loader, &rfks](const HistoricalScenarioLoader& l) {
+        BOOST_REQUIRE_EQUAL(l.numScenarios(), loader.numScenarios());
+        BOOST_CHECK(l.dates() == loader.dates());
+        for (auto const& d : loader.dates()) {
+            auto s1 = loader.getHistoricalScenario(d);
+            auto s2 = l.getHistoricalScenario(d);
+            BOOST_CHECK_EQUAL(s2->asof(), d);
+            for (auto const& rf : rfks) {
+                BOOST_REQUIRE_EQUAL(s2->has(rf), s1->has(rf));
+                if (s1->has(rf))
+                    BOOST_CHECK_EQUAL(s2->get(rf), s1->get(rf));
+            }
+        }
+        BOOST_CHECK_THROW(l.getHistoricalScenario(Date(7, Mar, 2017)), QuantLib::Error);
+    };
+
+    BOOST_CHECK_EQUAL(loader.numScenarios(), 5);
+    BOOST_CHECK(compact.historicalScenarios().empty());
+    check(compact);
+
+    // the same scenarios read from a binary file, missing values are written as null
+    string filename = "test_compact_historical_scenario_loader.bin";
+    {
+        BinaryScenarioFileWriter writer(filename);
+        for (auto const& s : scenarios) {
+            auto c = s->clone();
+            if (!c->has(rfks[2]))
+                c->add(rfks[2], Null<Real>());
+            writer.writeScenario(c);
+        }
+    }
+    CompactHistoricalScenarioLoader binary(boost::make_shared<HistoricalBinaryScenarioReader>(filename), startDate,
+                                           endDate, TARGET());
+    check(binary);
+
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(HistoricalShiftStoreTest)
+
+BOOST_AUTO_TEST_CASE(testHistoricalShiftStore) {
+
+    BOOST_TEST_MESSAGE("Testing historical shift store save, load and prune...");
+
+    RiskFactorKey k1(RiskFactorKey::KeyType::DiscountCurve, "EUR", 3), k2(RiskFactorKey::KeyType::FXSpot, "USDEUR");
+    HistoricalShiftStore::DatePair d1(Date(3, Jan, 2022), Date(4, Jan, 2022)),
+        d2(Date(4, Jan, 2022), Date(5, Jan, 2022));
+
+    HistoricalShiftStore store;
+    store.set(d1, k1, 0.1 / 3.0);
+    store.set(d1, k2, -1.0E-5);
+    store.set(d2, k1, 7.0);
+    BOOST_CHECK_EQUAL(store.size(), 2);
+    BOOST_CHECK(store.shift(d2, k2) == Null<Real>());
+    BOOST_CHECK(store.shift(HistoricalShiftStore::DatePair(d1.first, d2.second), k1) == Null<Real>());
+
+    string filename = "test_historical_shift_store.csv";
+    store.save(filename);
+    HistoricalShiftStore loaded(filename);
+    remove(filename.c_str());
+
+    // the shifts are written with full precision
+    BOOST_CHECK_EQUAL(loaded.size(), 2);
+    BOOST_CHECK_EQUAL(loaded.shift(d1, k1), 0.1 / 3.0);
+    BOOST_CHECK_EQUAL(loaded.shift(d1, k2), -1.0E-5);
+    BOOST_CHECK_EQUAL(loaded.shift(d2, k1), 7.0);
+
+    loaded.prune({d2});
+    BOOST_CHECK_EQUAL(loaded.size(), 1);
+    BOOST_CHECK(loaded.shift(d1, k1) == Null<Real>());
+    BOOST_CHECK_EQUAL(loaded.shift(d2, k1), 7.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ScenarioCacheTest)
+
+BOOST_AUTO_TEST_CASE(testScenarioCache) {
+
+    BOOST_TEST_MESSAGE("Testing ScenarioCache and CachingScenarioGenerator...");
+
+    vector<Date> dates = {Date(21, Dec, 2016), Date(21, Jan, 2017)};
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::DiscountCurve, "CHF", 0},
+                                  {RiskFactorKey::KeyType::FXSpot, "CHFEUR"}};
+
+    // source generator replaying two samples on two dates
+    vector<boost::shared_ptr<Scenario>> scenarios;
+    string filename = "test_scenario_cache_source.bin";
+    {
+        BinaryScenarioFileWriter writer(filename);
+        for (Size sample = 0; sample < 2; ++sample) {
+            for (auto const& d : dates) {
+                boost::shared_ptr<Scenario> s = boost::make_shared<SimpleScenario>(d, "", 1.0 + 0.1 * sample);
+                for (auto const& rf : rfks)
+                    s->add(rf, rand() / static_cast<Real>(RAND_MAX));
+                writer.writeScenario(s);
+                scenarios.push_back(s);
+            }
+        }
+    }
+
+    ScenarioCache::instance().clear();
+    ScenarioCache::instance().setSpillDirectory("");
+    string key = "testScenarioCache";
+    CachingScenarioGenerator generator(boost::make_shared<BinaryScenarioGenerator>(filename), key, scenarios.size());
+
+    // a reset before all scenarios are generated does not populate the cache
+    generator.next(dates[0]);
+    generator.reset();
+    BOOST_CHECK(!ScenarioCache::instance().has(key));
+    BOOST_CHECK(ScenarioCache::instance().generator(key) == nullptr);
+
+    for (auto const& s : scenarios)
+        generator.next(s->asof());
+    BOOST_REQUIRE(ScenarioCache::instance().has(key));
+
+    auto cached = ScenarioCache::instance().generator(key);
+    BOOST_REQUIRE(cached);
+    for (Size pass = 0; pass < 2; ++pass) {
+        for (auto const& s : scenarios) {
+            auto c = cached->next(s->asof());
+            BOOST_CHECK_EQUAL(c->getNumeraire(), s->getNumeraire());
+            for (auto const& rf : rfks)
+                BOOST_CHECK_EQUAL(c->get(rf), s->get(rf));
+        }
+        BOOST_CHECK_THROW(cached->next(dates[0]), QuantLib::Error);
+        cached->reset();
+    }
+
+    ScenarioCache::instance().clear();
+    BOOST_CHECK(!ScenarioCache::instance().has(key));
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(CompactScenarioTest)
+
+BOOST_AUTO_TEST_CASE(testCompactScenario) {
+
+    BOOST_TEST_MESSAGE("Testing CompactScenario...");
+
+    Date d(21, Dec, 2016);
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::DiscountCurve, "CHF", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "CHF", 1},
+                                  {RiskFactorKey::KeyType::IndexCurve, "CHF-LIBOR-6M", 0},
+                                  {RiskFactorKey::KeyType::FXSpot, "CHFEUR"}};
+    auto keys = boost::make_shared<CompactScenarioKeys>(rfks);
+    CompactScenarioFactory factory(keys);
+
+    auto s1 = boost::dynamic_pointer_cast<CompactScenario>(factory.buildScenario(d, "s1", 1.5));
+    auto s2 = boost::dynamic_pointer_cast<CompactScenario>(factory.buildScenario(d, "s2"));
+    BOOST_REQUIRE(s1 && s2);
+    BOOST_CHECK(s1->keyTable() == s2->keyTable());
+    BOOST_CHECK_EQUAL(s1->getNumeraire(), 1.5);
+
+    // add in table order and out of order
+    for (Size i = 0; i < rfks.size(); ++i)
+        s1->add(rfks[i], 0.1 * i);
+    for (Size i = rfks.size(); i > 0; --i)
+        s2->add(rfks[i - 1], 0.2 * (i - 1));
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(s1->keys().begin(), s1->keys().end(), rfks.begin(), rfks.end());
+    for (Size i = 0; i < rfks.size(); ++i) {
+        BOOST_CHECK(s1->has(rfks[i]));
+        BOOST_CHECK_CLOSE(s1->get(rfks[i]), 0.1 * i, 1E-12);
+        BOOST_CHECK_CLOSE(s2->values()[i], 0.2 * i, 1E-12);
+    }
+
+    // keys outside the table
+    RiskFactorKey unknown(RiskFactorKey::KeyType::FXSpot, "USDEUR");
+    BOOST_CHECK(!s1->has(unknown));
+    BOOST_CHECK_THROW(s1->add(unknown, 1.0), QuantLib::Error);
+    BOOST_CHECK_THROW(s1->get(unknown), QuantLib::Error);
+
+    // unset values
+    auto s3 = factory.buildScenario(d);
+    BOOST_CHECK(!s3->has(rfks[0]));
+    BOOST_CHECK_THROW(s3->get(rfks[0]), QuantLib::Error);
+
+    // clones are independent but share the key table
+    auto c = boost::dynamic_pointer_cast<CompactScenario>(s1->clone());
+    c->set(0, 42.0);
+    BOOST_CHECK_EQUAL(c->get(rfks[0]), 42.0);
+    BOOST_CHECK_EQUAL(s1->get(rfks[0]), 0.0);
+    BOOST_CHECK(c->keyTable() == s1->keyTable());
+
+    // duplicate keys are rejected
+    BOOST_CHECK_THROW(CompactScenarioKeys({rfks[0], rfks[0]}), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -478,6 +478,168 @@ BOOST_AUTO_TEST_CASE(testCrossAssetLowDiscrepancyBrownianBridge) {
     test_crossasset(true, false, true);
 }
 
+BOOST_AUTO_TEST_CASE(testCrossAssetBlocks) {
+    BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator blocks against single paths...");
+    setConventions();
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    boost::shared_ptr<DateGrid> grid = boost::make_shared<DateGrid>(tenorGrid);
+
+    // IR-FX model with the LGM and FX components of the full model
+    std::vector<boost::shared_ptr<Parametrization>> parametrizations;
+    for (Size j = 0; j < d.ccLgm->components(CrossAssetModel::AssetType::IR); ++j)
+        parametrizations.push_back(d.ccLgm->irlgm1f(j));
+    for (Size k = 0; k < d.ccLgm->components(CrossAssetModel::AssetType::FX); ++k)
+        parametrizations.push_back(d.ccLgm->fxbs(k));
+    auto model = boost::make_shared<QuantExt::CrossAssetModel>(parametrizations);
+
+    boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setIndices({"EUR-EURIBOR-6M"});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+
+    // two generators with identical paths
+    BigNatural seed = 42;
+    auto scenGen = [&](const boost::shared_ptr<ScenarioFactory>& factory) {
+        auto pathGen =
+            boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(), grid->timeGrid(), seed);
+        return boost::make_shared<CrossAssetModelScenarioGenerator>(model, pathGen, factory, simMarketConfig, today,
+                                                                    grid, d.market);
+    };
+    auto pathScenGen = scenGen(boost::make_shared<SimpleScenarioFactory>());
+    auto blockScenGen = scenGen(boost::make_shared<SimpleScenarioFactory>());
+    BOOST_REQUIRE(blockScenGen->supportsBlocks());
+
+    Size samples = 100;
+    std::vector<CrossAssetModelScenarioGenerator::ScenarioBlock> blocks = blockScenGen->nextBlocks(samples);
+    BOOST_REQUIRE_EQUAL(blocks.size(), grid->dates().size());
+    const std::vector<RiskFactorKey>& keys = blockScenGen->keys()->keys();
+
+    Real tol = 1.0E-12;
+    for (Size s = 0; s < samples; ++s) {
+        for (Size i = 0; i < grid->dates().size(); ++i) {
+            boost::shared_ptr<Scenario> scenario = pathScenGen->next(grid->dates()[i]);
+            BOOST_REQUIRE_EQUAL(blocks[i].date, scenario->asof());
+            BOOST_REQUIRE_EQUAL(blocks[i].values.size(), keys.size());
+            BOOST_CHECK_CLOSE(blocks[i].numeraire[s], scenario->getNumeraire(), tol);
+            for (Size k = 0; k < keys.size(); ++k)
+                BOOST_CHECK_CLOSE(blocks[i].values[k][s], scenario->get(keys[k]), tol);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCrossAssetStreamingPaths) {
+    BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator with streaming paths and bridged close-out dates...");
+    setConventions();
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    boost::shared_ptr<DateGrid> grid = boost::make_shared<DateGrid>(tenorGrid);
+    grid->addCloseOutDates(2 * Weeks);
+
+    std::vector<bool> bridged = CrossAssetModelScenarioGenerator::bridgedCloseOutDates(*grid);
+    BOOST_REQUIRE_EQUAL(bridged.size(), grid->dates().size() + 1);
+    BOOST_CHECK(!bridged.front());
+    BOOST_CHECK_EQUAL(std::count(bridged.begin(), bridged.end(), true), tenorGrid.size());
+
+    boost::shared_ptr<QuantExt::CrossAssetModel> model = d.ccLgm;
+    boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+
+    auto streamingGen = boost::make_shared<QuantExt::StreamingMultiPathGenerator>(model->stateProcess(),
+                                                                                 grid->timeGrid(), 1, 42, bridged);
+    auto scenGen = boost::make_shared<CrossAssetModelScenarioGenerator>(
+        model, streamingGen, boost::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, grid, d.market);
+
+    // martingale test, E[1 / N(t)] = P(0,t) on valuation and bridged close-out dates
+    Size samples = 5000;
+    std::vector<Real> sum(grid->dates().size(), 0.0);
+    for (Size s = 0; s < samples; ++s) {
+        for (Size i = 0; i < grid->dates().size(); ++i) {
+            boost::shared_ptr<Scenario> scenario = scenGen->next(grid->dates()[i]);
+            BOOST_REQUIRE_EQUAL(scenario->asof(), grid->dates()[i]);
+            sum[i] += 1.0 / scenario->getNumeraire();
+        }
+    }
+    for (Size i = 0; i < grid->dates().size(); ++i) {
+        Real expected = model->irModel(0)->termStructure()->discount(grid->timeGrid()[i + 1]);
+        BOOST_TEST_MESSAGE("date " << io::iso_date(grid->dates()[i]) << " bridged " << std::boolalpha
+                                   << bridged[i + 1] << " E[1/N] " << sum[i] / samples << " P(0,t) " << expected);
+        BOOST_CHECK_CLOSE(sum[i] / samples, expected, 1.0);
+    }
+
+    // reset restarts the sequence
+    scenGen->reset();
+    auto streamingGen2 = boost::make_shared<QuantExt::StreamingMultiPathGenerator>(model->stateProcess(),
+                                                                                  grid->timeGrid(), 1, 42, bridged);
+    auto scenGen2 = boost::make_shared<CrossAssetModelScenarioGenerator>(
+        model, streamingGen2, boost::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, grid, d.market);
+    for (Size i = 0; i < grid->dates().size(); ++i)
+        BOOST_CHECK_EQUAL(scenGen->next(grid->dates()[i])->getNumeraire(),
+                          scenGen2->next(grid->dates()[i])->getNumeraire());
+}
+
+BOOST_AUTO_TEST_CASE(testCrossAssetConditionalCloseOut) {
+    BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator with close-out dates sampled conditionally...");
+    setConventions();
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    boost::shared_ptr<DateGrid> grid = boost::make_shared<DateGrid>(tenorGrid);
+    grid->addCloseOutDates(2 * Weeks);
+    boost::shared_ptr<DateGrid> valuationGrid = boost::make_shared<DateGrid>(tenorGrid);
+
+    boost::shared_ptr<QuantExt::CrossAssetModel> model = d.ccLgm;
+    boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+
+    // the path generator covers the valuation dates only
+    BOOST_REQUIRE_EQUAL(grid->valuationTimeGrid().size(), tenorGrid.size() + 1);
+    auto pathGen = boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(),
+                                                                         grid->valuationTimeGrid(), 42, false);
+    auto scenGen = boost::make_shared<CrossAssetModelScenarioGenerator>(
+        model, pathGen, boost::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, grid, d.market,
+        Market::defaultConfiguration, true, 43);
+
+    auto refPathGen = boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(),
+                                                                            valuationGrid->timeGrid(), 42, false);
+    auto refScenGen = boost::make_shared<CrossAssetModelScenarioGenerator>(
+        model, refPathGen, boost::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, valuationGrid,
+        d.market);
+
+    // martingale test, E[1 / N(t)] = P(0,t) on valuation and close-out dates, the valuation dates coincide with
+    // a simulation on the valuation dates only
+    Size samples = 5000;
+    std::vector<Real> sum(grid->dates().size(), 0.0);
+    for (Size s = 0; s < samples; ++s) {
+        std::vector<boost::shared_ptr<Scenario>> path = scenGen->nextPath();
+        std::vector<boost::shared_ptr<Scenario>> refPath = refScenGen->nextPath();
+        BOOST_REQUIRE_EQUAL(path.size(), grid->dates().size());
+        for (Size i = 0, k = 0; i < grid->dates().size(); ++i) {
+            BOOST_REQUIRE_EQUAL(path[i]->asof(), grid->dates()[i]);
+            sum[i] += 1.0 / path[i]->getNumeraire();
+            if (grid->isValuationDate()[i])
+                BOOST_CHECK_CLOSE(path[i]->getNumeraire(), refPath[k++]->getNumeraire(), 1.0E-10);
+        }
+    }
+    for (Size i = 0; i < grid->dates().size(); ++i) {
+        Real expected = model->irModel(0)->termStructure()->discount(grid->timeGrid()[i + 1]);
+        BOOST_TEST_MESSAGE("date " << io::iso_date(grid->dates()[i]) << " close-out only " << std::boolalpha
+                                   << !grid->isValuationDate()[i] << " E[1/N] " << sum[i] / samples << " P(0,t) "
+                                   << expected);
+        BOOST_CHECK_CLOSE(sum[i] / samples, expected, 1.0);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testCrossAssetSimMarket) {
     BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator via SimMarket (Martingale tests)...");
     setConventions();
@@ -17,11 +17,16 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/scenario/riskfactorpruning.hpp>
+#include <orea/scenario/scenariofilter.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <ored/configuration/conventions.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/report/inmemoryreport.hpp>
 #include <ored/utilities/log.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/termstructures/credit/flathazardrate.hpp>
@@ -32,6 +37,7 @@
 #include <ql/time/daycounters/actualactual.hpp>
 #include <test/oreatoplevelfixture.hpp>
 #include <test/testmarket.hpp>
+#include <test/testportfolio.hpp>
 
 #include <ql/indexes/ibor/all.hpp>
 
@@ -42,6 +48,7 @@ using namespace std;
 using namespace ore;
 using namespace ore::data;
 
+using testsuite::buildSwap;
 using testsuite::TestMarket;
 
 namespace {
@@ -305,6 +312,111 @@ BOOST_AUTO_TEST_CASE(testScenarioSimMarket) {
     testToXML(parameters);
 }
 
+BOOST_AUTO_TEST_CASE(testRiskFactorPruning) {
+    BOOST_TEST_MESSAGE("Testing pruning of risk factors not used by the portfolio...");
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters = scenarioParameters();
+    convs();
+    auto simMarket = boost::make_shared<analytics::ScenarioSimMarket>(initMarket, parameters);
+
+    // without recorded requests pruning is refused
+    Portfolio portfolio;
+    BOOST_CHECK_THROW(analytics::unusedRiskFactors(*simMarket, *parameters, portfolio), std::exception);
+
+    // a single EUR swap built against the sim market
+    auto data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    auto factory = boost::make_shared<EngineFactory>(data, simMarket);
+    portfolio.add(buildSwap("Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                            "EUR-EURIBOR-6M"));
+    simMarket->setRecordRequests(true);
+    portfolio.build(factory);
+    simMarket->setRecordRequests(false);
+    BOOST_CHECK(!simMarket->requests().empty());
+
+    auto report = boost::make_shared<InMemoryReport>();
+    std::set<analytics::RiskFactorKey> pruned = analytics::pruneRiskFactors(simMarket, *parameters, portfolio, report);
+    BOOST_CHECK(!pruned.empty());
+    BOOST_CHECK(report->rows() > 0);
+
+    using KT = analytics::RiskFactorKey::KeyType;
+    for (auto const& [key, quote] : simMarket->simData()) {
+        bool expectedPruned = (key.keytype == KT::IndexCurve && key.name == "USD-LIBOR-6M") ||
+                              key.keytype == KT::SwaptionVolatility || key.keytype == KT::SurvivalProbability ||
+                              key.keytype == KT::RecoveryRate || key.keytype == KT::ZeroInflationCurve;
+        bool neverPruned = key.keytype == KT::DiscountCurve || key.keytype == KT::FXSpot ||
+                           (key.keytype == KT::IndexCurve && key.name == "EUR-EURIBOR-6M");
+        if (expectedPruned)
+            BOOST_CHECK_MESSAGE(pruned.count(key) == 1, "expected " << key << " to be pruned");
+        if (neverPruned)
+            BOOST_CHECK_MESSAGE(pruned.count(key) == 0, "expected " << key << " to be kept");
+        BOOST_CHECK_EQUAL(simMarket->filter()->allow(key), pruned.count(key) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testTradeRiskFactors) {
+    BOOST_TEST_MESSAGE("Testing the risk factors attributed to single trades...");
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters = scenarioParameters();
+    convs();
+    auto simMarket = boost::make_shared<analytics::ScenarioSimMarket>(initMarket, parameters);
+
+    // the second EUR swap uses the cached engine of the first one, the engine's requests are attributed to both
+    auto data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    auto factory = boost::make_shared<EngineFactory>(data, simMarket);
+    Portfolio portfolio;
+    portfolio.add(buildSwap("Swap_EUR_1", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                            "EUR-EURIBOR-6M"));
+    portfolio.add(buildSwap("Swap_EUR_2", "EUR", false, 10000000.0, 0, 5, 0.02, 0.00, "1Y", "30/360", "6M", "A360",
+                            "EUR-EURIBOR-6M"));
+    portfolio.add(buildSwap("Swap_USD", "USD", true, 10000000.0, 0, 10, 0.03, 0.00, "6M", "30/360", "3M", "A360",
+                            "USD-LIBOR-6M"));
+
+    // nothing is recorded unless the sim market records requests
+    portfolio.build(factory);
+    BOOST_CHECK(portfolio.marketRequests().empty());
+
+    factory = boost::make_shared<EngineFactory>(data, simMarket);
+    simMarket->setRecordRequests(true);
+    portfolio.build(factory);
+    simMarket->setRecordRequests(false);
+    BOOST_REQUIRE_EQUAL(portfolio.marketRequests().size(), 3);
+    BOOST_CHECK(portfolio.marketRequests().at("Swap_EUR_1") == portfolio.marketRequests().at("Swap_EUR_2"));
+
+    using KT = analytics::RiskFactorKey::KeyType;
+    auto eur = analytics::tradeRiskFactors(*simMarket, "EUR", *portfolio.get("Swap_EUR_1"),
+                                           portfolio.marketRequests().at("Swap_EUR_1"));
+    auto usd = analytics::tradeRiskFactors(*simMarket, "EUR", *portfolio.get("Swap_USD"),
+                                           portfolio.marketRequests().at("Swap_USD"));
+    auto has = [](const std::set<std::pair<KT, std::string>>& f, const KT t, const std::string& n) {
+        return f.count(std::make_pair(t, n)) == 1;
+    };
+    BOOST_CHECK(has(eur, KT::DiscountCurve, "EUR"));
+    BOOST_CHECK(has(eur, KT::IndexCurve, "EUR-EURIBOR-6M"));
+    BOOST_CHECK(!has(eur, KT::DiscountCurve, "USD"));
+    BOOST_CHECK(!has(eur, KT::IndexCurve, "USD-LIBOR-6M"));
+    BOOST_CHECK(!has(eur, KT::FXSpot, "USDEUR"));
+    BOOST_CHECK(!has(eur, KT::SwaptionVolatility, "EUR"));
+    BOOST_CHECK(has(usd, KT::DiscountCurve, "USD"));
+    BOOST_CHECK(has(usd, KT::IndexCurve, "USD-LIBOR-6M"));
+    BOOST_CHECK(has(usd, KT::FXSpot, "USDEUR"));
+    BOOST_CHECK(!has(usd, KT::DiscountCurve, "EUR"));
+    BOOST_CHECK(!has(usd, KT::IndexCurve, "EUR-EURIBOR-6M"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
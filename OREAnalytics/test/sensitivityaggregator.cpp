@@ -17,6 +17,8 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/engine/bufferedsensitivitystream.hpp>
+#include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
 #include <orea/engine/sensitivityinmemorystream.hpp>
 #include <oret/toplevelfixture.hpp>
@@ -26,10 +28,13 @@
 using namespace boost::unit_test_framework;
 using namespace std;
 
+using ore::analytics::BufferedSensitivityStream;
+using ore::analytics::FilteredSensitivityStream;
 using ore::analytics::RiskFactorKey;
 using ore::analytics::SensitivityAggregator;
 using ore::analytics::SensitivityInMemoryStream;
 using ore::analytics::SensitivityRecord;
+using ore::analytics::SensitivityStream;
 using std::function;
 using std::map;
 using std::set;
@@ -240,6 +245,56 @@ BOOST_AUTO_TEST_CASE(testGeneralAggregationFunctionCategories) {
     check(expAggregationAll, res, "all_except_002");
 }
 
+BOOST_AUTO_TEST_CASE(testBatchStreaming) {
+
+    BOOST_TEST_MESSAGE("Testing batch streaming of sensitivity records against record by record streaming");
+
+    auto readAll = [](SensitivityStream& ss) {
+        vector<SensitivityRecord> result;
+        ss.reset();
+        while (SensitivityRecord sr = ss.next())
+            result.push_back(sr);
+        return result;
+    };
+
+    auto readBatches = [](SensitivityStream& ss) {
+        vector<SensitivityRecord> result, buffer(4);
+        ss.reset();
+        QuantLib::Size n;
+        do {
+            n = ss.nextBatch(buffer);
+            result.insert(result.end(), buffer.begin(), buffer.begin() + n);
+        } while (n == buffer.size());
+        return result;
+    };
+
+    auto check = [](const vector<SensitivityRecord>& exp, const vector<SensitivityRecord>& res) {
+        BOOST_REQUIRE_EQUAL(exp.size(), res.size());
+        for (QuantLib::Size i = 0; i < exp.size(); ++i) {
+            BOOST_CHECK_EQUAL(exp[i], res[i]);
+            BOOST_CHECK_EQUAL(exp[i].delta, res[i].delta);
+            BOOST_CHECK_EQUAL(exp[i].gamma, res[i].gamma);
+        }
+    };
+
+    auto ss = boost::make_shared<SensitivityInMemoryStream>(records.begin(), records.end());
+    vector<SensitivityRecord> all = readAll(*ss);
+    BOOST_CHECK_EQUAL(all.size(), records.size());
+    check(all, readBatches(*ss));
+
+    FilteredSensitivityStream fss(ss, 100.0);
+    vector<SensitivityRecord> filtered = readAll(fss);
+    BOOST_CHECK(!filtered.empty() && filtered.size() < records.size());
+    check(filtered, readBatches(fss));
+
+    // the buffered stream reads the underlying stream once and replays its buffer after a reset
+    ss->reset();
+    BufferedSensitivityStream bss(ss);
+    check(all, readBatches(bss));
+    check(all, readBatches(bss));
+    check(all, readAll(bss));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -49,6 +49,7 @@
 #include <ored/portfolio/commodityoption.hpp>
 #include <ored/portfolio/equityforward.hpp>
 #include <ored/portfolio/equityoption.hpp>
+#include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/fxoption.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/swap.hpp>
@@ -1993,6 +1994,174 @@ BOOST_AUTO_TEST_CASE(testCrossGamma) {
     IndexManager::instance().clearHistories();
 }
 
+BOOST_AUTO_TEST_CASE(testLazyScenarioGeneration) {
+
+    BOOST_TEST_MESSAGE("Testing lazy sensitivity scenario generation against materialised scenarios");
+
+    SavedSettings backup;
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData =
+        TestConfigurationObjects::setupSimMarketData5();
+    boost::shared_ptr<SensitivityScenarioData> sensiData = TestConfigurationObjects::setupSensitivityScenarioData5();
+    sensiData->crossGammaFilter().push_back(pair<string, string>("DiscountCurve/EUR", "IndexCurve/EUR"));
+    sensiData->crossGammaFilter().push_back(pair<string, string>("FXSpot/EURUSD", "DiscountCurve/EUR"));
+
+    boost::shared_ptr<analytics::ScenarioSimMarket> simMarket =
+        boost::make_shared<analytics::ScenarioSimMarket>(initMarket, simMarketData);
+    boost::shared_ptr<Scenario> baseScenario = simMarket->baseScenario();
+
+    auto eager = boost::make_shared<SensitivityScenarioGenerator>(
+        sensiData, baseScenario, simMarketData, simMarket, boost::make_shared<CloneScenarioFactory>(baseScenario),
+        false);
+    sensiData->lazyScenarioGeneration() = true;
+    auto lazy = boost::make_shared<SensitivityScenarioGenerator>(
+        sensiData, baseScenario, simMarketData, simMarket, boost::make_shared<CloneScenarioFactory>(baseScenario),
+        false);
+
+    BOOST_CHECK(!eager->lazy());
+    BOOST_CHECK(lazy->lazy());
+    BOOST_REQUIRE_EQUAL(lazy->samples(), eager->samples());
+    BOOST_REQUIRE_EQUAL(lazy->numScenarios(), eager->scenarios().size());
+    BOOST_CHECK_THROW(lazy->scenarios(), QuantLib::Error);
+
+    for (Size i = 0; i < eager->samples(); ++i) {
+        boost::shared_ptr<Scenario> e = eager->next(today);
+        boost::shared_ptr<Scenario> l = lazy->next(today);
+        BOOST_CHECK_EQUAL(l->label(), e->label());
+        BOOST_CHECK_EQUAL(l->getNumeraire(), e->getNumeraire());
+        for (auto const& k : baseScenario->keys())
+            BOOST_CHECK_EQUAL(l->get(k), e->get(k));
+    }
+    BOOST_CHECK_THROW(lazy->next(today), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testCrossGammaMateriality) {
+
+    BOOST_TEST_MESSAGE("Testing the restriction of cross gammas to material factor pairs");
+
+    SavedSettings backup;
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData =
+        TestConfigurationObjects::setupSimMarketData5();
+    boost::shared_ptr<SensitivityScenarioData> sensiData = TestConfigurationObjects::setupSensitivityScenarioData5();
+    sensiData->crossGammaFilter().push_back(pair<string, string>("DiscountCurve/EUR", "IndexCurve/EUR"));
+    sensiData->crossGammaFilter().push_back(pair<string, string>("DiscountCurve/EUR", "DiscountCurve/USD"));
+
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 0, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+
+    auto full = boost::make_shared<SensitivityAnalysis>(portfolio, initMarket, Market::defaultConfiguration, data,
+                                                        simMarketData, sensiData, false);
+    full->generateSensitivities();
+    BOOST_CHECK(full->skippedCrossGammaPairs().empty());
+
+    Real threshold = 100.0;
+    auto restrictedData = boost::make_shared<SensitivityScenarioData>(*sensiData);
+    restrictedData->crossGammaMaterialityThreshold() = threshold;
+    auto restricted = boost::make_shared<SensitivityAnalysis>(
+        portfolio, initMarket, Market::defaultConfiguration, data, simMarketData, restrictedData, false);
+    restricted->generateSensitivities();
+
+    auto fullCube = full->sensiCube();
+    auto restrictedCube = restricted->sensiCube();
+    auto const& skipped = restricted->skippedCrossGammaPairs();
+    BOOST_CHECK(!restrictedCube->crossFactors().empty());
+    BOOST_CHECK(!skipped.empty());
+    BOOST_CHECK_EQUAL(restrictedCube->crossFactors().size() + skipped.size(), fullCube->crossFactors().size());
+
+    // the selected pairs must have a material delta on both factors for one trade and reproduce the full run
+    for (auto const& [cp, unused] : restrictedCube->crossFactors()) {
+        BOOST_CHECK(fullCube->crossFactors().count(cp) == 1);
+        BOOST_CHECK(skipped.count(cp) == 0);
+        bool material = false;
+        for (auto const& [tradeId, idx] : fullCube->tradeIdx()) {
+            material = material || (std::abs(fullCube->delta(tradeId, cp.first)) > threshold &&
+                                    std::abs(fullCube->delta(tradeId, cp.second)) > threshold);
+            BOOST_CHECK_CLOSE(restrictedCube->crossGamma(tradeId, cp), fullCube->crossGamma(tradeId, cp), 1E-8);
+        }
+        BOOST_CHECK_MESSAGE(material, "cross pair " << cp << " is not material");
+    }
+
+    // the EUR and USD discount curves never both affect a single trade
+    for (auto const& [cp, unused] : restrictedCube->crossFactors())
+        BOOST_CHECK(!(cp.first.name == "USD" || cp.second.name == "USD"));
+}
+
+BOOST_AUTO_TEST_CASE(testAnalyticDeltas) {
+
+    BOOST_TEST_MESSAGE("Testing analytic deltas for swaps and fx forwards against bump and revalue");
+
+    SavedSettings backup;
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData =
+        TestConfigurationObjects::setupSimMarketData5();
+    boost::shared_ptr<SensitivityScenarioData> sensiData = TestConfigurationObjects::setupSensitivityScenarioData5();
+
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngineOptimised";
+    data->model("FxForward") = "DiscountedCashflows";
+    data->engine("FxForward") = "DiscountingFxForwardEngine";
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", false, 10000000.0, 1, 15, 0.02, 0.001, "6M", "30/360", "3M",
+                             "A360", "USD-LIBOR-3M"));
+    Envelope env("CP1");
+    auto fxForward = boost::make_shared<ore::data::FxForward>(env, "2019-04-14", "EUR", 10000000.0, "USD",
+                                                              11500000.0);
+    fxForward->id() = "3_FxForward_EURUSD";
+    portfolio->add(fxForward);
+
+    auto run = [&](const bool analyticDeltas, const bool validate) {
+        auto sa = boost::make_shared<SensitivityAnalysis>(portfolio, initMarket, Market::defaultConfiguration, data,
+                                                          simMarketData, sensiData, false);
+        sa->setAnalyticDeltas(analyticDeltas, validate);
+        sa->generateSensitivities();
+        return sa->sensiCube()->npvCube();
+    };
+
+    auto reference = run(false, false);
+    auto analytic = run(true, false);
+    auto validated = run(true, true);
+
+    Size nChanged = 0;
+    for (Size i = 0; i < portfolio->size(); ++i) {
+        Real t0 = reference->getT0(i, 0);
+        BOOST_CHECK_CLOSE(analytic->getT0(i, 0), t0, 1E-10);
+        for (Size j = 0; j < reference->samples(); ++j) {
+            Real ref = reference->get(i, 0, j, 0);
+            Real ana = analytic->get(i, 0, j, 0);
+            // the analytic values are exact to first order
+            BOOST_CHECK_SMALL(ana - ref, 1E-2 * std::abs(ref - t0) + 1E-4);
+            BOOST_CHECK_SMALL(validated->get(i, 0, j, 0) - ref, 1E-8);
+            if (std::abs(ref - t0) > 1.0)
+                ++nChanged;
+        }
+    }
+    BOOST_CHECK(nChanged > 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
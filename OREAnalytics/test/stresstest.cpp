@@ -23,6 +23,7 @@
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/parametricvar.hpp>
 #include <orea/engine/riskfilter.hpp>
+#include <orea/engine/sensitivitybasedstresstest.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
 #include <orea/engine/sensitivitycubestream.hpp>
@@ -70,6 +71,7 @@ using testsuite::buildEuropeanSwaption;
 using testsuite::buildFloor;
 using testsuite::buildFxOption;
 using testsuite::buildSwap;
+using testsuite::TestConfigurationObjects;
 using testsuite::TestMarket;
 
 boost::shared_ptr<data::Conventions> stressConv() {
@@ -381,6 +383,74 @@ BOOST_AUTO_TEST_CASE(regression) {
     IndexManager::instance().clearHistories();
 }
 
+BOOST_AUTO_TEST_CASE(testSensitivityBasedStressTest) {
+    BOOST_TEST_MESSAGE("Testing sensitivity based stress test against full revaluation");
+
+    SavedSettings backup;
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData =
+        TestConfigurationObjects::setupSimMarketData5();
+    boost::shared_ptr<SensitivityScenarioData> sensiData = TestConfigurationObjects::setupSensitivityScenarioData5();
+
+    // small parallel shifts of the EUR and USD curves, for which the second order expansion is accurate
+    boost::shared_ptr<StressTestScenarioData> stressData = boost::make_shared<StressTestScenarioData>();
+    vector<StressTestScenarioData::StressTestData> stressTests;
+    for (auto const& [label, shift] : vector<pair<string, Real>>{{"up", 0.0010}, {"down", -0.0005}}) {
+        StressTestScenarioData::StressTestData data;
+        data.label = label;
+        StressTestScenarioData::CurveShiftData curveShift;
+        curveShift.shiftType = "Absolute";
+        curveShift.shiftTenors = {1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years};
+        curveShift.shifts = vector<Real>(curveShift.shiftTenors.size(), shift);
+        data.discountCurveShifts["EUR"] = curveShift;
+        data.discountCurveShifts["USD"] = curveShift;
+        data.indexCurveShifts["EUR-EURIBOR-6M"] = curveShift;
+        data.indexCurveShifts["USD-LIBOR-3M"] = curveShift;
+        stressTests.push_back(data);
+    }
+    stressData->data() = stressTests;
+
+    boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+    engineData->model("Swap") = "DiscountedCashflows";
+    engineData->engine("Swap") = "DiscountingSwapEngine";
+
+    boost::shared_ptr<Portfolio> portfolio(new Portfolio());
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 0, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+
+    auto sa = boost::make_shared<SensitivityAnalysis>(portfolio, initMarket, Market::defaultConfiguration, engineData,
+                                                      simMarketData, sensiData, false);
+    sa->generateSensitivities();
+
+    SensitivityBasedStressTest approx(sa->sensiCube(), sensiData, sa->simMarket(), simMarketData, stressData, 0.1);
+    StressTest full(portfolio, initMarket, Market::defaultConfiguration, engineData, simMarketData, stressData);
+
+    BOOST_CHECK_EQUAL(approx.trades().size(), portfolio->size());
+    BOOST_CHECK_EQUAL(approx.stressTests().size(), stressTests.size());
+    BOOST_CHECK(approx.fullRevaluationTrades().empty());
+    for (auto const& [key, delta] : full.delta()) {
+        BOOST_TEST_MESSAGE(key.first << " " << key.second << ": approximation " << approx.delta().at(key)
+                                     << ", full revaluation " << delta << ", error indicator "
+                                     << approx.errorIndicator().at(key));
+        BOOST_CHECK_CLOSE(approx.baseNPV().at(key.first), full.baseNPV().at(key.first), 1E-6);
+        BOOST_CHECK_CLOSE(approx.delta().at(key), delta, 1.0);
+    }
+
+    // replacing the results by those of a full revaluation reproduces the full stress test
+    approx.setFullRevaluationResults(full);
+    BOOST_CHECK_EQUAL(approx.revaluedTrades().size(), portfolio->size());
+    for (auto const& [key, delta] : full.delta())
+        BOOST_CHECK_CLOSE(approx.delta().at(key), delta, 1E-10);
+
+    IndexManager::instance().clearHistories();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
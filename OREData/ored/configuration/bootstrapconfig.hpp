@@ -37,7 +37,8 @@ public:
     //! Constructor
     BootstrapConfig(QuantLib::Real accuracy = 1.0e-12, QuantLib::Real globalAccuracy = QuantLib::Null<QuantLib::Real>(),
                     bool dontThrow = false, QuantLib::Size maxAttempts = 5, QuantLib::Real maxFactor = 2.0,
-                    QuantLib::Real minFactor = 2.0, QuantLib::Size dontThrowSteps = 10);
+                    QuantLib::Real minFactor = 2.0, QuantLib::Size dontThrowSteps = 10, bool globalNewton = false,
+                    bool warmStart = false);
 
     //! \name XMLSerializable interface
     //@{
@@ -54,6 +55,8 @@ public:
     QuantLib::Real maxFactor() const { return maxFactor_; }
     QuantLib::Real minFactor() const { return minFactor_; }
     QuantLib::Size dontThrowSteps() const { return dontThrowSteps_; }
+    bool globalNewton() const { return globalNewton_; }
+    bool warmStart() const { return warmStart_; }
     //@}
 
 private:
@@ -64,6 +67,8 @@ private:
     QuantLib::Real maxFactor_;
     QuantLib::Real minFactor_;
     QuantLib::Size dontThrowSteps_;
+    bool globalNewton_;
+    bool warmStart_;
 };
 
 } // namespace data
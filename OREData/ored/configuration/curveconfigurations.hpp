@@ -44,6 +44,9 @@
 #include <ored/marketdata/todaysmarketparameters.hpp>
 #include <ored/utilities/xmlutils.hpp>
 
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 #include <typeindex>
 #include <typeinfo>
 
@@ -53,7 +56,10 @@ using ore::data::XMLNode;
 using ore::data::XMLSerializable;
 
 //! Container class for all Curve Configurations
-/*!
+/*! The configurations are parsed from their XML on first access and then kept, the getters can be used
+    concurrently from several threads, so that one instance can be shared by parallel market builds and by
+    several TodaysMarket instances.
+
   \ingroup configuration
 */
 class CurveConfigurations : public XMLSerializable {
@@ -169,8 +175,11 @@ public:
 
     mutable std::map<CurveSpec::CurveType, std::map<std::string, boost::shared_ptr<CurveConfig>>> configs_;
     mutable std::map<CurveSpec::CurveType, std::map<std::string, std::string>> unparsed_;
+    // guards the lazy parsing in get(), has() and parseAll()
+    mutable boost::shared_mutex mutex_;
 
-    // utility function for parsing a node of name "parentName" and storing the result in the map
+    // utility function for parsing a node of name "parentName" and storing the result in the map, the caller holds
+    // an exclusive lock on mutex_ if the instance is shared
     void parseNode(const CurveSpec::CurveType& type, const string& curveId) const;
     
     // utility function for getting a child curve config node
@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+#include <ored/marketdata/calibratedcurvecache.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/lock_types.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace data {
+
+void CalibratedCurveCache::setEnabled(const bool enabled) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    enabled_ = enabled;
+}
+
+bool CalibratedCurveCache::enabled() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return enabled_;
+}
+
+boost::shared_ptr<const CalibratedCurve> CalibratedCurveCache::get(const std::string& name,
+                                                                   const std::size_t fingerprint) const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    auto c = curves_.find(name);
+    if (c == curves_.end() || c->second->fingerprint != fingerprint)
+        return nullptr;
+    return c->second;
+}
+
+boost::shared_ptr<const CalibratedCurve> CalibratedCurveCache::get(const std::string& name) const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    auto c = curves_.find(name);
+    return c == curves_.end() ? nullptr : c->second;
+}
+
+void CalibratedCurveCache::add(const std::string& name, const boost::shared_ptr<const CalibratedCurve>& curve) {
+    QL_REQUIRE(curve, "CalibratedCurveCache: curve " << name << " is null");
+    QL_REQUIRE(curve->dates.size() == curve->values.size(), "CalibratedCurveCache: curve "
+                                                                << name << " has " << curve->dates.size()
+                                                                << " dates, but " << curve->values.size() << " values");
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    curves_[name] = curve;
+}
+
+Size CalibratedCurveCache::size() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return curves_.size();
+}
+
+void CalibratedCurveCache::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    curves_.clear();
+}
+
+/* One line per curve: name;fingerprint;date1;value1;date2;value2;..., the curve spec names do not contain ';' and
+   the values are written with enough digits to be restored exactly. */
+
+void CalibratedCurveCache::load(const std::string& fileName) {
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        DLOG("CalibratedCurveCache: file " << fileName << " not found, nothing to load");
+        return;
+    }
+    std::string line;
+    Size n = 0;
+    while (std::getline(file, line)) {
+        boost::trim(line);
+        if (line.empty())
+            continue;
+        std::vector<std::string> tokens;
+        boost::split(tokens, line, boost::is_any_of(";"));
+        QL_REQUIRE(tokens.size() >= 2 && tokens.size() % 2 == 0,
+                   "CalibratedCurveCache: invalid line '" << line << "' in " << fileName);
+        auto curve = boost::make_shared<CalibratedCurve>();
+        curve->fingerprint = std::stoull(tokens[1], nullptr, 16);
+        for (Size i = 2; i < tokens.size(); i += 2) {
+            curve->dates.push_back(parseDate(tokens[i]));
+            curve->values.push_back(parseReal(tokens[i + 1]));
+        }
+        add(tokens[0], curve);
+        ++n;
+    }
+    LOG("CalibratedCurveCache: loaded " << n << " curves from " << fileName);
+}
+
+void CalibratedCurveCache::save(const std::string& fileName) const {
+    std::ofstream file(fileName);
+    QL_REQUIRE(file.is_open(), "CalibratedCurveCache: error opening file " << fileName);
+    file << std::setprecision(std::numeric_limits<Real>::max_digits10);
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    for (auto const& c : curves_) {
+        file << c.first << ";" << std::hex << c.second->fingerprint << std::dec;
+        for (Size i = 0; i < c.second->dates.size(); ++i)
+            file << ";" << QuantLib::io::iso_date(c.second->dates[i]) << ";" << c.second->values[i];
+        file << "\n";
+    }
+    LOG("CalibratedCurveCache: saved " << curves_.size() << " curves to " << fileName);
+}
+
+} // namespace data
+} // namespace ore
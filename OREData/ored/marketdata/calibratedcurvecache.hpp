@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+/*! \file ored/marketdata/calibratedcurvecache.hpp
+    \brief Cache for the node values of bootstrapped curves
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+#include <ql/time/date.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Node values of a bootstrapped curve
+struct CalibratedCurve {
+    //! fingerprint of the curve configuration and the inputs of the bootstrap
+    std::size_t fingerprint;
+    //! node dates, the first one is the asof date
+    std::vector<QuantLib::Date> dates;
+    //! node values of the curve's interpolation variable
+    std::vector<QuantLib::Real> values;
+};
+
+//! Store for the node values of bootstrapped curves
+/*! The cache holds the last calibrated curve for each curve spec name together with a fingerprint of the curve
+    configuration and of the inputs of the bootstrap, see YieldCurve and DefaultCurve. A curve whose fingerprint is
+    unchanged is restored from its node values without bootstrapping. The cache can be saved to and loaded from a
+    file, so that e.g. intraday reruns only bootstrap the curves affected by changed quotes.
+
+    The cache is disabled by default, it is only used if the curves are not linked to the loader quotes.
+
+    \ingroup marketdata
+*/
+class CalibratedCurveCache : public QuantLib::Singleton<CalibratedCurveCache, std::integral_constant<bool, true>> {
+public:
+    //! Enable or disable the cache
+    void setEnabled(const bool enabled);
+    bool enabled() const;
+
+    //! The cached curve for the name, or null if there is none with the given fingerprint
+    boost::shared_ptr<const CalibratedCurve> get(const std::string& name, const std::size_t fingerprint) const;
+    //! The cached curve for the name regardless of its fingerprint, e.g. as a warm start, or null if there is none
+    boost::shared_ptr<const CalibratedCurve> get(const std::string& name) const;
+
+    //! Store a curve under the name, replacing a previous one
+    void add(const std::string& name, const boost::shared_ptr<const CalibratedCurve>& curve);
+
+    //! Number of cached curves
+    QuantLib::Size size() const;
+
+    //! Remove all cached curves
+    void clear();
+
+    //! Add the curves stored in the file, a missing file is ignored
+    void load(const std::string& fileName);
+    //! Write all cached curves to the file
+    void save(const std::string& fileName) const;
+
+private:
+    std::map<std::string, boost::shared_ptr<const CalibratedCurve>> curves_;
+    bool enabled_ = false;
+    mutable boost::shared_mutex mutex_;
+};
+
+} // namespace data
+} // namespace ore
@@ -34,5 +34,70 @@ ClonedLoader::ClonedLoader(const Date& loaderDate, const boost::shared_ptr<Loade
     dividends_ = inLoader->loadDividends();
 }
 
+LazyClonedLoader::LazyClonedLoader(const Date& loaderDate, const boost::shared_ptr<Loader>& inLoader)
+    : loaderDate_(loaderDate), inLoader_(inLoader) {
+    QL_REQUIRE(inLoader_, "LazyClonedLoader: no source loader given");
+}
+
+boost::shared_ptr<MarketDatum> LazyClonedLoader::clone(const boost::shared_ptr<MarketDatum>& md) const {
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        auto it = clones_.find(md->name());
+        if (it != clones_.end())
+            return it->second;
+    }
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    // another thread might have cloned the datum in the meantime, then we keep its clone
+    return clones_.emplace(md->name(), md->clone()).first->second;
+}
+
+std::vector<boost::shared_ptr<MarketDatum>> LazyClonedLoader::loadQuotes(const Date& d) const {
+    if (d != loaderDate_)
+        return {};
+    std::vector<boost::shared_ptr<MarketDatum>> result;
+    for (auto const& md : inLoader_->loadQuotes(d))
+        result.push_back(clone(md));
+    return result;
+}
+
+boost::shared_ptr<MarketDatum> LazyClonedLoader::get(const string& name, const Date& d) const {
+    QL_REQUIRE(d == loaderDate_, "No datum for " << name << " on date " << d);
+    return clone(inLoader_->get(name, d));
+}
+
+std::set<boost::shared_ptr<MarketDatum>> LazyClonedLoader::get(const std::set<std::string>& names,
+                                                               const Date& asof) const {
+    std::set<boost::shared_ptr<MarketDatum>> result;
+    if (asof != loaderDate_)
+        return result;
+    for (auto const& md : inLoader_->get(names, asof))
+        result.insert(clone(md));
+    return result;
+}
+
+std::set<boost::shared_ptr<MarketDatum>> LazyClonedLoader::get(const Wildcard& wildcard, const Date& asof) const {
+    std::set<boost::shared_ptr<MarketDatum>> result;
+    if (asof != loaderDate_)
+        return result;
+    for (auto const& md : inLoader_->get(wildcard, asof))
+        result.insert(clone(md));
+    return result;
+}
+
+bool LazyClonedLoader::has(const string& name, const Date& d) const {
+    return d == loaderDate_ && inLoader_->has(name, d);
+}
+
+bool LazyClonedLoader::hasQuotes(const Date& d) const { return d == loaderDate_ && inLoader_->hasQuotes(d); }
+
+bool LazyClonedLoader::hasFixing(const string& name, const Date& d) const { return inLoader_->hasFixing(name, d); }
+
+Fixing LazyClonedLoader::getFixing(const string& name, const Date& d) const { return inLoader_->getFixing(name, d); }
+
+Size LazyClonedLoader::numberOfClones() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return clones_.size();
+}
+
 } // namespace data
 } // namespace ore
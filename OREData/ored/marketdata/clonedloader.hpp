@@ -23,6 +23,9 @@
 
 #include <ored/marketdata/inmemoryloader.hpp>
 
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 #pragma once
 
 namespace ore {
@@ -39,5 +42,42 @@ protected:
     QuantLib::Date loaderDate_;
 };
 
+//! Loader providing cloned data from another loader, cloning each market datum on its first request only
+/*! Like the ClonedLoader this loader provides independent quotes for the loader date, e.g. for the markets built in
+    different threads, but a datum is only cloned when it is requested. The clones are kept, so that a datum requested
+    twice is the same. Fixings and dividends are read from the source loader, they are not copied.
+
+    The source loader is only read and must not be modified while this loader is in use.
+*/
+class LazyClonedLoader : public Loader {
+public:
+    LazyClonedLoader(const QuantLib::Date& loaderDate, const boost::shared_ptr<Loader>& inLoader);
+
+    std::vector<boost::shared_ptr<MarketDatum>> loadQuotes(const QuantLib::Date& d) const override;
+    boost::shared_ptr<MarketDatum> get(const string& name, const QuantLib::Date& d) const override;
+    std::set<boost::shared_ptr<MarketDatum>> get(const std::set<std::string>& names,
+                                                 const QuantLib::Date& asof) const override;
+    std::set<boost::shared_ptr<MarketDatum>> get(const Wildcard& wildcard, const QuantLib::Date& asof) const override;
+    bool has(const string& name, const QuantLib::Date& d) const override;
+    bool hasQuotes(const QuantLib::Date& d) const override;
+    std::set<Fixing> loadFixings() const override { return inLoader_->loadFixings(); }
+    bool hasFixing(const string& name, const QuantLib::Date& d) const override;
+    Fixing getFixing(const string& name, const QuantLib::Date& d) const override;
+    std::set<QuantExt::Dividend> loadDividends() const override { return inLoader_->loadDividends(); }
+
+    const QuantLib::Date& getLoaderDate() const { return loaderDate_; };
+
+    //! the number of market data cloned so far
+    Size numberOfClones() const;
+
+private:
+    boost::shared_ptr<MarketDatum> clone(const boost::shared_ptr<MarketDatum>& md) const;
+
+    QuantLib::Date loaderDate_;
+    boost::shared_ptr<Loader> inLoader_;
+    mutable std::map<std::string, boost::shared_ptr<MarketDatum>> clones_;
+    mutable boost::shared_mutex mutex_;
+};
+
 } // namespace data
 } // namespace ore
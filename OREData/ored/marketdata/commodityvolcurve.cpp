@@ -692,7 +692,7 @@ void CommodityVolCurve::buildVolatility(const Date& asof, CommodityVolatilityCon
         volatility_ = coss->volSurface();
 
         // If data level logging, output the stripped volatilities.
-        if (Log::instance().filter(ORE_DATA)) {
+        if (ORE_LOG_ACTIVE(ORE_DATA)) {
             volatility_->enableExtrapolation(vssc.extrapolation());
             TLOG("CommodityVolCurve: stripped volatilities:");
             TLOG("expiry,strike,forward_price,call_price,put_price,discount,volatility");
@@ -0,0 +1,412 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+#include <ored/marketdata/compactloader.hpp>
+#include <ored/marketdata/marketdatumparser.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/lock_types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace data {
+
+Size CompactLoader::key(const std::string& name) const {
+    auto it = keys_.find(name);
+    return it == keys_.end() ? Null<Size>() : it->second;
+}
+
+Real CompactLoader::value(Size k, const Date& d) const {
+    auto it = values_.find(d);
+    if (k == Null<Size>() || it == values_.end() || k >= it->second.size())
+        return Null<Real>();
+    return it->second[k];
+}
+
+boost::shared_ptr<MarketDatum> CompactLoader::datum(Size k, const Date& d, Real value) const {
+    auto id = std::make_pair(d, k);
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        auto it = cache_.find(id);
+        if (it != cache_.end())
+            return it->second;
+    }
+    auto md = parseMarketDatum(d, *names_[k], value);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    // another thread might have built the datum in the meantime, return the one in the cache in this case
+    return cache_.insert(std::make_pair(id, md)).first->second;
+}
+
+template <class I>
+std::set<boost::shared_ptr<MarketDatum>> CompactLoader::data(I begin, I end, const Date& d) const {
+    std::set<boost::shared_ptr<MarketDatum>> result;
+    for (I it = begin; it != end; ++it) {
+        Real v = value(it->second, d);
+        if (v != Null<Real>())
+            result.insert(datum(it->second, d, v));
+    }
+    return result;
+}
+
+std::vector<boost::shared_ptr<MarketDatum>> CompactLoader::loadQuotes(const Date& d) const {
+    if (values_.find(d) == values_.end())
+        return {};
+    // the keys are ordered by name, so is the result
+    std::vector<boost::shared_ptr<MarketDatum>> result;
+    for (auto const& k : keys_) {
+        Real v = value(k.second, d);
+        if (v != Null<Real>())
+            result.push_back(datum(k.second, d, v));
+    }
+    return result;
+}
+
+boost::shared_ptr<MarketDatum> CompactLoader::get(const std::string& name, const Date& d) const {
+    Size k = key(name);
+    Real v = value(k, d);
+    QL_REQUIRE(v != Null<Real>(), "No datum for " << name << " on date " << d);
+    return datum(k, d, v);
+}
+
+bool CompactLoader::has(const std::string& name, const Date& d) const {
+    return value(key(name), d) != Null<Real>();
+}
+
+bool CompactLoader::hasQuotes(const Date& d) const { return values_.find(d) != values_.end(); }
+
+std::set<boost::shared_ptr<MarketDatum>> CompactLoader::get(const std::set<std::string>& names,
+                                                            const Date& asof) const {
+    std::set<boost::shared_ptr<MarketDatum>> result;
+    for (auto const& n : names) {
+        Size k = key(n);
+        Real v = value(k, asof);
+        if (v != Null<Real>())
+            result.insert(datum(k, asof, v));
+    }
+    return result;
+}
+
+std::set<boost::shared_ptr<MarketDatum>> CompactLoader::get(const Wildcard& wildcard, const Date& asof) const {
+    if (!wildcard.hasWildcard()) {
+        // no wildcard => use get by name function
+        if (has(wildcard.pattern(), asof))
+            return {get(wildcard.pattern(), asof)};
+        return {};
+    }
+    if (values_.find(asof) == values_.end())
+        return {};
+    auto it1 = keys_.begin(), it2 = keys_.end();
+    if (wildcard.wildcardPos() != 0) {
+        // search the range matching the substring of the pattern until the wildcard
+        std::string prefix = wildcard.pattern().substr(0, wildcard.wildcardPos());
+        it1 = keys_.lower_bound(prefix);
+        it2 = keys_.upper_bound(prefix + "\xFF");
+    }
+    if (wildcard.isPrefix())
+        return data(it1, it2, asof);
+    std::set<boost::shared_ptr<MarketDatum>> result;
+    for (auto it = it1; it != it2; ++it) {
+        Real v = value(it->second, asof);
+        if (v != Null<Real>() && wildcard.matches(it->first))
+            result.insert(datum(it->second, asof, v));
+    }
+    return result;
+}
+
+bool CompactLoader::hasFixing(const std::string& name, const Date& d) const {
+    return fixings_.find(Fixing(d, name, 0.0)) != fixings_.end();
+}
+
+Fixing CompactLoader::getFixing(const std::string& name, const Date& d) const {
+    auto it = fixings_.find(Fixing(d, name, 0.0));
+    return it == fixings_.end() ? Fixing() : *it;
+}
+
+void CompactLoader::add(const Date& date, const std::string& name, Real value) { addValue(date, name, value, true); }
+
+void CompactLoader::addValue(const Date& date, const std::string& name, Real value, bool checkName) {
+    QL_REQUIRE(value != Null<Real>(), "CompactLoader: null value for " << name << " on " << date);
+    Size k = key(name);
+    if (k == Null<Size>()) {
+        if (invalidNames_.find(name) != invalidNames_.end())
+            return;
+        // parse the name once to check that it is a valid market datum
+        if (checkName) {
+            try {
+                parseMarketDatum(date, name, value);
+            } catch (std::exception& e) {
+                WLOG("Failed to parse MarketDatum " << name << ": " << e.what());
+                invalidNames_.insert(name);
+                return;
+            }
+        }
+        k = names_.size();
+        names_.push_back(&keys_.insert(std::make_pair(name, k)).first->first);
+    }
+    auto& v = values_[date];
+    if (v.size() <= k)
+        v.resize(names_.size(), Null<Real>());
+    if (v[k] == Null<Real>()) {
+        v[k] = value;
+        TLOG("Added MarketDatum " << name);
+    } else {
+        WLOG("Skipped MarketDatum " << name << " - this is already present.");
+    }
+}
+
+void CompactLoader::add(const Date& date, const Loader& loader) {
+    // the names of the loaded market datums are valid
+    for (auto const& md : loader.loadQuotes(date))
+        addValue(date, md->name(), md->quote()->value(), false);
+}
+
+void CompactLoader::add(const Loader& loader, const std::set<Date>& dates) {
+    for (auto const& d : dates)
+        add(d, loader);
+    for (auto const& f : loader.loadFixings())
+        addFixing(f.date, f.name, f.fixing);
+    for (auto const& d : loader.loadDividends())
+        addDividend(d);
+}
+
+void CompactLoader::addFixing(const Date& date, const std::string& name, Real value) {
+    // the hint makes the insertion of fixings in the set order, e.g. from another loader, constant time
+    Size n = fixings_.size();
+    fixings_.insert(fixings_.end(), Fixing(date, name, value));
+    if (fixings_.size() == n) {
+        WLOG("Skipped Fixing " << name << "@" << QuantLib::io::iso_date(date) << " - this is already present.");
+    }
+}
+
+void CompactLoader::addDividend(const QuantExt::Dividend& dividend) {
+    if (!dividends_.insert(dividend).second) {
+        WLOG("Skipped Dividend " << dividend.name << "@" << QuantLib::io::iso_date(dividend.exDate)
+                                 << " - this is already present.");
+    }
+}
+
+/* Snapshot layout, all numbers in native byte order:
+   - magic string, version and endianness marker, the tag (uint32 size and bytes)
+   - the key table: uint64 number of names, for each name its uint32 size and bytes, in the order of the keys
+   - the quotes: uint64 number of dates, for each date its int64 serial number, the uint64 number of quotes and for
+     each quote its uint64 key and float64 value
+   - the fixings as one time series per index: uint64 number of indices, for each index its name, the uint64 number
+     of fixings and for each fixing the int64 date serial number and the float64 value
+   - the dividends: uint64 number of dividends, for each dividend its name, int64 ex and pay date serial numbers and
+     the float64 rate */
+
+namespace {
+const char snapshotMagic[8] = {'O', 'R', 'E', 'L', 'D', 'S', 'N', '\0'};
+const std::uint32_t snapshotVersion = 1;
+const std::uint32_t endiannessMarker = 0x01020304;
+
+template <class T> void write(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ofstream& out, const std::string& s) {
+    write(out, static_cast<std::uint32_t>(s.size()));
+    out.write(s.data(), s.size());
+}
+} // namespace
+
+void CompactLoader::writeSnapshot(const std::string& filename, const std::string& tag) const {
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out.is_open(), "CompactLoader: error opening snapshot file " << filename);
+    out.write(snapshotMagic, sizeof(snapshotMagic));
+    write(out, snapshotVersion);
+    write(out, endiannessMarker);
+    writeString(out, tag);
+
+    write(out, static_cast<std::uint64_t>(names_.size()));
+    for (auto const n : names_)
+        writeString(out, *n);
+
+    write(out, static_cast<std::uint64_t>(values_.size()));
+    for (auto const& v : values_) {
+        write(out, static_cast<std::int64_t>(v.first.serialNumber()));
+        std::uint64_t n = std::count_if(v.second.begin(), v.second.end(), [](Real x) { return x != Null<Real>(); });
+        write(out, n);
+        for (Size k = 0; k < v.second.size(); ++k) {
+            if (v.second[k] != Null<Real>()) {
+                write(out, static_cast<std::uint64_t>(k));
+                write(out, static_cast<double>(v.second[k]));
+            }
+        }
+    }
+
+    // the fixings are ordered by name, so that the fixings of an index form a contiguous block
+    std::vector<std::pair<std::set<Fixing>::const_iterator, std::uint64_t>> blocks;
+    for (auto f = fixings_.begin(); f != fixings_.end(); ++f) {
+        if (blocks.empty() || blocks.back().first->name != f->name)
+            blocks.push_back(std::make_pair(f, 0));
+        ++blocks.back().second;
+    }
+    write(out, static_cast<std::uint64_t>(blocks.size()));
+    for (auto const& b : blocks) {
+        writeString(out, b.first->name);
+        write(out, b.second);
+        auto f = b.first;
+        for (std::uint64_t i = 0; i < b.second; ++i, ++f) {
+            write(out, static_cast<std::int64_t>(f->date.serialNumber()));
+            write(out, static_cast<double>(f->fixing));
+        }
+    }
+
+    write(out, static_cast<std::uint64_t>(dividends_.size()));
+    for (auto const& d : dividends_) {
+        writeString(out, d.name);
+        write(out, static_cast<std::int64_t>(d.exDate.serialNumber()));
+        write(out, static_cast<std::int64_t>(d.payDate.serialNumber()));
+        write(out, static_cast<double>(d.rate));
+    }
+    QL_REQUIRE(out.good(), "CompactLoader: error writing snapshot file " << filename);
+    LOG("CompactLoader: wrote " << values_.size() << " dates with " << names_.size() << " quote names, "
+                                << fixings_.size() << " fixings and " << dividends_.size() << " dividends to "
+                                << filename);
+}
+
+bool CompactLoader::readSnapshot(const std::string& filename, const std::string& tag) {
+    if (!std::ifstream(filename).good()) {
+        DLOG("CompactLoader: snapshot file " << filename << " not found");
+        return false;
+    }
+    boost::interprocess::file_mapping file(filename.c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+    const char* p = static_cast<const char*>(region.get_address());
+    const Size size = region.get_size();
+    Size pos = 0;
+    auto read = [p, size, &pos, &filename](void* target, const Size bytes) {
+        QL_REQUIRE(pos + bytes <= size, "CompactLoader: snapshot file " << filename << " is truncated or corrupt");
+        std::memcpy(target, p + pos, bytes);
+        pos += bytes;
+    };
+    auto readString = [&read]() {
+        std::uint32_t n;
+        read(&n, sizeof(n));
+        std::string s(n, ' ');
+        if (n > 0)
+            read(&s[0], n);
+        return s;
+    };
+    auto readDate = [&read]() {
+        std::int64_t serial;
+        read(&serial, sizeof(serial));
+        return serial == 0 ? Date() : Date(static_cast<Date::serial_type>(serial));
+    };
+    auto readReal = [&read]() {
+        double value;
+        read(&value, sizeof(value));
+        return static_cast<Real>(value);
+    };
+    auto readSize = [&read]() {
+        std::uint64_t n;
+        read(&n, sizeof(n));
+        return static_cast<Size>(n);
+    };
+
+    char magic[sizeof(snapshotMagic)];
+    std::uint32_t version, endianness;
+    read(magic, sizeof(magic));
+    QL_REQUIRE(std::memcmp(magic, snapshotMagic, sizeof(magic)) == 0,
+               "CompactLoader: " << filename << " is not a market data snapshot");
+    read(&version, sizeof(version));
+    QL_REQUIRE(version == snapshotVersion, "CompactLoader: unsupported snapshot version " << version << " in "
+                                                                                          << filename);
+    read(&endianness, sizeof(endianness));
+    QL_REQUIRE(endianness == endiannessMarker,
+               "CompactLoader: " << filename << " was written on a platform with different byte order");
+    if (readString() != tag) {
+        LOG("CompactLoader: snapshot file " << filename << " was written for different market data, ignore it");
+        return false;
+    }
+
+    std::map<std::string, Size> keys;
+    std::vector<const std::string*> names(readSize());
+    for (Size k = 0; k < names.size(); ++k)
+        names[k] = &keys.insert(keys.end(), std::make_pair(readString(), k))->first;
+    QL_REQUIRE(keys.size() == names.size(), "CompactLoader: duplicate quote names in snapshot file " << filename);
+
+    std::map<Date, std::vector<Real>> values;
+    for (Size i = 0, nDates = readSize(); i < nDates; ++i) {
+        auto& v = values.insert(values.end(), std::make_pair(readDate(), std::vector<Real>()))->second;
+        v.resize(names.size(), Null<Real>());
+        for (Size j = 0, n = readSize(); j < n; ++j) {
+            Size k = readSize();
+            QL_REQUIRE(k < names.size(), "CompactLoader: invalid key in snapshot file " << filename);
+            v[k] = readReal();
+        }
+    }
+
+    std::set<Fixing> fixings;
+    for (Size i = 0, nIndices = readSize(); i < nIndices; ++i) {
+        std::string name = readString();
+        for (Size j = 0, n = readSize(); j < n; ++j) {
+            Date d = readDate();
+            fixings.insert(fixings.end(), Fixing(d, name, readReal()));
+        }
+    }
+
+    std::set<QuantExt::Dividend> dividends;
+    for (Size i = 0, n = readSize(); i < n; ++i) {
+        std::string name = readString();
+        Date exDate = readDate();
+        Date payDate = readDate();
+        dividends.insert(dividends.end(), QuantExt::Dividend(exDate, name, readReal(), payDate));
+    }
+    QL_REQUIRE(pos == size, "CompactLoader: unexpected data at the end of snapshot file " << filename);
+
+    reset();
+    keys_.swap(keys);
+    names_.swap(names);
+    values_.swap(values);
+    fixings_.swap(fixings);
+    dividends_.swap(dividends);
+    LOG("CompactLoader: read " << values_.size() << " dates with " << names_.size() << " quote names, "
+                               << fixings_.size() << " fixings and " << dividends_.size() << " dividends from "
+                               << filename);
+    return true;
+}
+
+void CompactLoader::clearCache() const {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    cache_.clear();
+}
+
+void CompactLoader::reset() {
+    clearCache();
+    keys_.clear();
+    names_.clear();
+    invalidNames_.clear();
+    values_.clear();
+    fixings_.clear();
+    dividends_.clear();
+    actualDate_ = Date();
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+
+/*! \file ored/marketdata/compactloader.hpp
+    \brief Loader holding market data for many dates in a compact form
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <ored/marketdata/loader.hpp>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include <map>
+
+namespace ore {
+namespace data {
+
+//! Loader holding market data for many dates in a compact form
+/*! The quote names are interned in a key table that is shared by all dates, the values of a date are held in a flat
+    vector indexed by the key. The MarketDatum objects are only built when they are requested and are then kept, so
+    that repeated calls return the same object and its quote. A name is parsed once when it is first added, later
+    additions of the same name for other dates only store the value. This reduces the memory footprint compared to
+    the InMemoryLoader when quotes for many dates are kept, e.g. for backtests.
+
+    The const methods can be called concurrently.
+
+    \ingroup marketdata
+*/
+class CompactLoader : public Loader {
+public:
+    CompactLoader() {}
+
+    //! \name Loader interface
+    //@{
+    std::vector<boost::shared_ptr<MarketDatum>> loadQuotes(const QuantLib::Date& d) const override;
+    boost::shared_ptr<MarketDatum> get(const std::string& name, const QuantLib::Date& d) const override;
+    std::set<boost::shared_ptr<MarketDatum>> get(const std::set<std::string>& names,
+                                                 const QuantLib::Date& asof) const override;
+    std::set<boost::shared_ptr<MarketDatum>> get(const Wildcard& wildcard, const QuantLib::Date& asof) const override;
+    bool has(const std::string& name, const QuantLib::Date& d) const override;
+    bool hasQuotes(const QuantLib::Date& d) const override;
+    std::set<Fixing> loadFixings() const override { return fixings_; }
+    bool hasFixing(const std::string& name, const QuantLib::Date& d) const override;
+    Fixing getFixing(const std::string& name, const QuantLib::Date& d) const override;
+    std::set<QuantExt::Dividend> loadDividends() const override { return dividends_; }
+    //@}
+
+    //! add a market datum, names that can not be parsed to a market datum are skipped
+    void add(const QuantLib::Date& date, const std::string& name, QuantLib::Real value);
+    //! add all quotes of the given loader for the given date
+    void add(const QuantLib::Date& date, const Loader& loader);
+    //! add the quotes for the given dates, all fixings and all dividends of the given loader
+    void add(const Loader& loader, const std::set<QuantLib::Date>& dates);
+    //! add a fixing
+    void addFixing(const QuantLib::Date& date, const std::string& name, QuantLib::Real value);
+    //! add a dividend
+    void addDividend(const QuantExt::Dividend& dividend);
+
+    /*! Write all quotes, fixings and dividends to a binary snapshot file. The \p tag identifies the source of the
+        data, e.g. the names and modification times of the market data files, and is checked when the snapshot is
+        read. */
+    void writeSnapshot(const std::string& filename, const std::string& tag = "") const;
+    /*! Read a snapshot written by writeSnapshot(), the file is memory mapped and the quotes are added without parsing
+        their names. Returns false and leaves the loader unchanged if the file does not exist or was written with a
+        different \p tag, otherwise the data of the loader is replaced. */
+    bool readSnapshot(const std::string& filename, const std::string& tag = "");
+
+    //! number of distinct quote names over all dates
+    QuantLib::Size numberOfKeys() const { return names_.size(); }
+    //! release the market datum objects built so far
+    void clearCache() const;
+    //! clear all data
+    void reset();
+
+private:
+    // add a value, a new name is checked to be a valid market datum if checkName is true
+    void addValue(const QuantLib::Date& date, const std::string& name, QuantLib::Real value, bool checkName);
+    // the key index of name, or Null<Size>() if the name is unknown
+    QuantLib::Size key(const std::string& name) const;
+    // the value of the key on date d, or Null<Real>() if there is none
+    QuantLib::Real value(QuantLib::Size k, const QuantLib::Date& d) const;
+    // the market datum for a key and date with a value
+    boost::shared_ptr<MarketDatum> datum(QuantLib::Size k, const QuantLib::Date& d, QuantLib::Real value) const;
+    // the market datums for the keys in [begin, end) that have a value on date d
+    template <class I> std::set<boost::shared_ptr<MarketDatum>> data(I begin, I end, const QuantLib::Date& d) const;
+
+    // interned quote names and their keys, the map is ordered by name for the wildcard lookups
+    std::map<std::string, QuantLib::Size> keys_;
+    std::vector<const std::string*> names_;
+    std::set<std::string> invalidNames_;
+    // values per date indexed by key, Null<Real>() if the key has no value on the date
+    std::map<QuantLib::Date, std::vector<QuantLib::Real>> values_;
+    // market datums built so far
+    mutable std::map<std::pair<QuantLib::Date, QuantLib::Size>, boost::shared_ptr<MarketDatum>> cache_;
+    mutable boost::shared_mutex mutex_;
+
+    std::set<Fixing> fixings_;
+    std::set<QuantExt::Dividend> dividends_;
+};
+
+} // namespace data
+} // namespace ore
@@ -100,6 +100,19 @@ public:
         return fixings;
     }
 
+    bool hasFixing(const std::string& name, const QuantLib::Date& d) const override {
+        return (a_ && a_->hasFixing(name, d)) || (b_ && b_->hasFixing(name, d));
+    }
+
+    Fixing getFixing(const std::string& name, const QuantLib::Date& d) const override {
+        // as in loadFixings() a fixing in a_ takes precedence over one in b_
+        if (a_ && a_->hasFixing(name, d))
+            return a_->getFixing(name, d);
+        if (b_)
+            return b_->getFixing(name, d);
+        return Fixing();
+    }
+
     std::set<QuantExt::Dividend> loadDividends() const override {
         if (!b_)
             return a_->loadDividends();
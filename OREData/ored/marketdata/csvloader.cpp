@@ -23,13 +23,21 @@
 
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <iterator>
 #include <map>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 
+#include <thread>
+
 using namespace std;
 
 namespace ore {
@@ -42,8 +50,8 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
     : CSVLoader(marketFiles, fixingFiles, {}, implyTodaysFixings) {}
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, const string& dividendFilename,
-                     bool implyTodaysFixings)
-    : implyTodaysFixings_(implyTodaysFixings) {
+                     bool implyTodaysFixings, const std::set<Date>& marketDates, const Size nThreads)
+    : implyTodaysFixings_(implyTodaysFixings), marketDates_(marketDates), nThreads_(std::max<Size>(nThreads, 1)) {
 
     // load market data
     loadFile(marketFilename, DataType::Market);
@@ -66,8 +74,9 @@ CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename,
 }
 
 CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles,
-                     const vector<string>& dividendFiles, bool implyTodaysFixings)
-    : implyTodaysFixings_(implyTodaysFixings) {
+                     const vector<string>& dividendFiles, bool implyTodaysFixings, const std::set<Date>& marketDates,
+                     const Size nThreads)
+    : implyTodaysFixings_(implyTodaysFixings), marketDates_(marketDates), nThreads_(std::max<Size>(nThreads, 1)) {
 
     for (auto marketFile : marketFiles)
         // load market data
@@ -90,80 +99,213 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
     LOG("CSVLoader complete.");
 }
 
+namespace {
+
+// minimum size of a chunk parsed on a separate thread
+const std::size_t minChunkSize = 1 << 20;
+
+bool isSeparator(char c) { return c == ',' || c == ';' || c == '\t' || c == ' '; }
+
+bool isDigits(const char* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        if (p[i] < '0' || p[i] > '9')
+            return false;
+    return true;
+}
+
+int toInt(const char* p, std::size_t n) {
+    int r = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        r = 10 * r + (p[i] - '0');
+    return r;
+}
+
+// fast path for yyyy-mm-dd and yyyymmdd, all other formats are handled by parseDate()
+Date fastParseDate(const char* p, std::size_t n) {
+    if (n == 10 && p[4] == '-' && p[7] == '-' && isDigits(p, 4) && isDigits(p + 5, 2) && isDigits(p + 8, 2))
+        return Date(toInt(p + 8, 2), Month(toInt(p + 5, 2)), toInt(p, 4));
+    if (n == 8 && isDigits(p, 8))
+        return Date(toInt(p + 6, 2), Month(toInt(p + 4, 2)), toInt(p, 4));
+    return parseDate(string(p, n));
+}
+
+// same semantics as parseReal(), without the string construction
+Real fastParseReal(const char* p, std::size_t n) {
+    char buffer[64];
+    if (n >= sizeof(buffer))
+        return parseReal(string(p, n));
+    std::memcpy(buffer, p, n);
+    buffer[n] = '\0';
+    char* end;
+    errno = 0;
+    double r = std::strtod(buffer, &end);
+    QL_REQUIRE(end != buffer && errno != ERANGE, "Failed to parseReal(\"" << buffer << "\")");
+    return r;
+}
+
+} // namespace
+
 void CSVLoader::loadFile(const string& filename, DataType dataType) {
     LOG("CSVLoader loading from " << filename);
 
     Date today = QuantLib::Settings::instance().evaluationDate();
 
-    ifstream file;
-    file.open(filename.c_str());
+    ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
     QL_REQUIRE(file.is_open(), "error opening file " << filename);
+    std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
 
-    while (!file.eof()) {
-        string line;
-        getline(file, line);
-        boost::trim(line);
-        // skip blank and comment lines
-        if (line.size() > 0 && line[0] != '#') {
+    // split the buffer into chunks at line boundaries
+    const char* begin = buffer.data();
+    const char* end = begin + buffer.size();
+    Size nChunks = std::max<Size>(1, std::min<Size>(nThreads_, buffer.size() / minChunkSize));
+    std::vector<const char*> bounds(1, begin);
+    for (Size c = 1; c < nChunks; ++c) {
+        const char* b = std::max(bounds.back(), begin + c * (buffer.size() / nChunks));
+        b = std::find(b, end, '\n');
+        bounds.push_back(b == end ? end : b + 1);
+    }
+    bounds.push_back(end);
+    nChunks = bounds.size() - 1;
+
+    // parse the chunks, on worker threads if there is more than one
+    std::vector<QuoteMap> data(nChunks);
+    std::vector<std::set<Fixing>> fixings(nChunks);
+    std::vector<std::set<QuantExt::Dividend>> dividends(nChunks);
+    std::vector<std::exception_ptr> errors(nChunks);
+    auto parse = [&](Size c) {
+        try {
+            parseChunk(bounds[c], bounds[c + 1], dataType, today, data[c], fixings[c], dividends[c]);
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    };
+    if (nChunks == 1) {
+        parse(0);
+    } else {
+        DLOG("CSVLoader parsing " << filename << " in " << nChunks << " chunks");
+        std::vector<std::thread> threads;
+        for (Size c = 0; c < nChunks; ++c)
+            threads.emplace_back(parse, c);
+        for (auto& t : threads)
+            t.join();
+    }
+    for (auto const& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
 
-            vector<string> tokens;
-            boost::trim(line);
-            boost::split(tokens, line, boost::is_any_of(",;\t "), boost::token_compress_on);
+    // merge in file order, so that the first occurrence of a duplicate is kept
+    for (Size c = 0; c < nChunks; ++c) {
+        for (auto& d : data[c]) {
+            auto& target = data_[d.first];
+            if (target.empty()) {
+                target.swap(d.second);
+                continue;
+            }
+            for (auto const& md : d.second) {
+                if (!target.insert(md).second)
+                    WLOG("Skipped MarketDatum " << md->name() << " - this is already present.");
+            }
+        }
+        for (auto const& f : fixings[c]) {
+            if (!fixings_.insert(f).second)
+                WLOG("Skipped Fixing " << f.name << "@" << QuantLib::io::iso_date(f.date)
+                                       << " - this is already present.");
+        }
+        for (auto const& d : dividends[c]) {
+            if (!dividends_.insert(d).second)
+                WLOG("Skipped Dividend " << d.name << "@" << QuantLib::io::iso_date(d.exDate)
+                                         << " - this is already present.");
+        }
+    }
+    LOG("CSVLoader completed processing " << filename);
+}
 
-            // TODO: should we try, catch and log any invalid lines?
-            QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4, "Invalid CSVLoader line, 3 tokens expected " << line);
-            if (tokens.size() == 4)
-                QL_REQUIRE(dataType == DataType::Dividend, "CSVLoader, dataType must be of type Dividend");
-            Date date = parseDate(tokens[0]);
-            const string& key = tokens[1];
-            Real value = parseReal(tokens[2]);
-
-            if (dataType == DataType::Market) {
-                // process market
-                // build market datum and add to map
-                try {
-                    boost::shared_ptr<MarketDatum> md;
-                    try {
-                        md = parseMarketDatum(date, key, value);
-                    } catch (std::exception& e) {
-                        WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
-                    }
-                    if (md != nullptr) {
-                        if (data_[date].insert(md).second) {
-                            TLOG("Added MarketDatum " << key);
-                        } else {
-                            WLOG("Skipped MarketDatum " << key << " - this is already present.");
-                        }
-                    }
-                } catch (std::exception& e) {
-                    WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
+void CSVLoader::parseChunk(const char* begin, const char* end, DataType dataType, const Date& today, QuoteMap& data,
+                           std::set<Fixing>& fixings, std::set<QuantExt::Dividend>& dividends) const {
+    std::vector<std::pair<const char*, std::size_t>> tokens;
+    const char* lineBegin = begin;
+    while (lineBegin < end) {
+        const char* lineEnd = std::find(lineBegin, end, '\n');
+        const char* next = lineEnd == end ? end : lineEnd + 1;
+
+        // trim the line
+        const char* b = lineBegin;
+        const char* e = lineEnd;
+        while (b < e && std::isspace(static_cast<unsigned char>(*b)))
+            ++b;
+        while (e > b && std::isspace(static_cast<unsigned char>(*(e - 1))))
+            --e;
+        lineBegin = next;
+
+        // skip blank and comment lines
+        if (b == e || *b == '#')
+            continue;
+
+        // split at runs of separators
+        tokens.clear();
+        const char* t = b;
+        for (const char* p = b; p <= e; ++p) {
+            if (p == e || isSeparator(*p)) {
+                tokens.emplace_back(t, p - t);
+                while (p + 1 < e && isSeparator(*(p + 1)))
+                    ++p;
+                t = p + 1;
+            }
+        }
+
+        QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4,
+                   "Invalid CSVLoader line, 3 tokens expected " << string(b, e));
+        if (tokens.size() == 4)
+            QL_REQUIRE(dataType == DataType::Dividend, "CSVLoader, dataType must be of type Dividend");
+        Date date = fastParseDate(tokens[0].first, tokens[0].second);
+
+        // skip market data for other dates before parsing the market datum
+        if (dataType == DataType::Market && !marketDates_.empty() && marketDates_.find(date) == marketDates_.end())
+            continue;
+
+        string key(tokens[1].first, tokens[1].second);
+        Real value = fastParseReal(tokens[2].first, tokens[2].second);
+
+        if (dataType == DataType::Market) {
+            // build market datum and add to map
+            boost::shared_ptr<MarketDatum> md;
+            try {
+                md = parseMarketDatum(date, key, value);
+            } catch (std::exception& e) {
+                WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
+            }
+            if (md != nullptr) {
+                if (data[date].insert(md).second) {
+                    TLOG("Added MarketDatum " << key);
+                } else {
+                    WLOG("Skipped MarketDatum " << key << " - this is already present.");
                 }
-            } else if (dataType == DataType::Fixing) {
-                // process fixings
-                if (date < today || (date == today && !implyTodaysFixings_)) {
-                    if(!fixings_.insert(Fixing(date, key, value)).second) {
-                        WLOG("Skipped Fixing " << key << "@" << QuantLib::io::iso_date(date)
-                                               << " - this is already present.");
-                    }
+            }
+        } else if (dataType == DataType::Fixing) {
+            // process fixings
+            if (date < today || (date == today && !implyTodaysFixings_)) {
+                if (!fixings.insert(Fixing(date, key, value)).second) {
+                    WLOG("Skipped Fixing " << key << "@" << QuantLib::io::iso_date(date)
+                                           << " - this is already present.");
                 }
-            } else if (dataType == DataType::Dividend) {
-                Date payDate = date;
-                if (tokens.size() == 4)
-                    payDate = parseDate(tokens[3]);
-                // process dividends
-                if (date <= today) {
-                    if (!dividends_.insert(QuantExt::Dividend(date, key, value, payDate)).second) {
-                        WLOG("Skipped Dividend " << key << "@" << QuantLib::io::iso_date(date)
-                                                 << " - this is already present.");
-                    }
+            }
+        } else if (dataType == DataType::Dividend) {
+            Date payDate = date;
+            if (tokens.size() == 4)
+                payDate = fastParseDate(tokens[3].first, tokens[3].second);
+            // process dividends
+            if (date <= today) {
+                if (!dividends.insert(QuantExt::Dividend(date, key, value, payDate)).second) {
+                    WLOG("Skipped Dividend " << key << "@" << QuantLib::io::iso_date(date)
+                                             << " - this is already present.");
                 }
-            } else {
-                QL_FAIL("unknown data type");
             }
+        } else {
+            QL_FAIL("unknown data type");
         }
     }
-    file.close();
-    LOG("CSVLoader completed processing " << filename);
 }
 
 vector<boost::shared_ptr<MarketDatum>> CSVLoader::loadQuotes(const QuantLib::Date& d) const {
@@ -187,6 +329,11 @@ boost::shared_ptr<MarketDatum> CSVLoader::get(const string& name, const QuantLib
     return *it2;
 }
 
+bool CSVLoader::has(const string& name, const QuantLib::Date& d) const {
+    auto it = data_.find(d);
+    return it != data_.end() && it->second.find(makeDummyMarketDatum(d, name)) != it->second.end();
+}
+
 std::set<boost::shared_ptr<MarketDatum>> CSVLoader::get(const std::set<std::string>& names,
                                                              const QuantLib::Date& asof) const {
     auto it = data_.find(asof);
@@ -232,5 +379,23 @@ std::set<boost::shared_ptr<MarketDatum>> CSVLoader::get(const Wildcard& wildcard
     }
     return result;
 }
+
+std::set<Date> CSVLoader::dates() const {
+    std::set<Date> result;
+    for (auto const& d : data_)
+        result.insert(result.end(), d.first);
+    return result;
+}
+
+bool CSVLoader::hasFixing(const string& name, const QuantLib::Date& d) const {
+    return fixings_.find(Fixing(d, name, 0.0)) != fixings_.end();
+}
+
+Fixing CSVLoader::getFixing(const string& name, const QuantLib::Date& d) const {
+    // fixings are ordered by name and date, the value does not take part in the comparison
+    auto it = fixings_.find(Fixing(d, name, 0.0));
+    return it == fixings_.end() ? Fixing() : *it;
+}
+
 } // namespace data
 } // namespace ore
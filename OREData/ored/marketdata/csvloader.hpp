@@ -34,6 +34,12 @@ namespace data {
   Data is loaded with the call to the constructor.
   Inspectors can be called to then retrieve quotes and fixings.
 
+  A file is read into memory in one go and split into chunks at line boundaries, which are tokenized and parsed on
+  up to \p nThreads worker threads and merged in file order, so that the first occurrence of a duplicate quote or
+  fixing is kept as in a sequential read. Dates in the formats yyyy-mm-dd and yyyymmdd and numbers are parsed
+  without intermediate strings. If a set of \p marketDates is given, market data lines for other dates are skipped
+  before the market datum is parsed.
+
   TODO implementation has large overlap with inmemoryloader.?pp, factor this out
 
   \ingroup marketdata
@@ -64,7 +70,11 @@ public:
         //! Dividend file name
         const string& dividendFilename,
         //! Enable/disable implying today's fixings
-        bool implyTodaysFixings = false);
+        bool implyTodaysFixings = false,
+        //! If not empty, only market data for these dates is loaded
+        const std::set<QuantLib::Date>& marketDates = {},
+        //! Number of threads to parse the files
+        const QuantLib::Size nThreads = 1);
 
     CSVLoader( //! Quote file name
         const vector<string>& marketFiles,
@@ -73,7 +83,11 @@ public:
         //! Dividend file name
         const vector<string>& dividendFiles,
         //! Enable/disable implying today's fixings
-        bool implyTodaysFixings = false);
+        bool implyTodaysFixings = false,
+        //! If not empty, only market data for these dates is loaded
+        const std::set<QuantLib::Date>& marketDates = {},
+        //! Number of threads to parse the files
+        const QuantLib::Size nThreads = 1);
 
     std::vector<boost::shared_ptr<MarketDatum>> loadQuotes(const QuantLib::Date&) const override;
 
@@ -82,19 +96,34 @@ public:
                                                  const QuantLib::Date& asof) const override;
     //! get quotes matching a wildcard
     std::set<boost::shared_ptr<MarketDatum>> get(const Wildcard& wildcard, const QuantLib::Date& asof) const override;
+    //! check for a quote without throwing on a miss
+    bool has(const string& name, const QuantLib::Date& d) const override;
 
     //! Load fixings
     std::set<Fixing> loadFixings() const override { return fixings_; }
+    //! look up a fixing in the (name, date) ordered fixing set, without copying it
+    bool hasFixing(const string& name, const QuantLib::Date& d) const override;
+    Fixing getFixing(const string& name, const QuantLib::Date& d) const override;
     //! Load dividends
     std::set<QuantExt::Dividend> loadDividends() const override { return dividends_; }
     //@}
 
+    //! the dates with market data
+    std::set<QuantLib::Date> dates() const;
+
 private:
     enum class DataType { Market, Fixing, Dividend };
+    typedef std::map<QuantLib::Date, std::set<boost::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>>
+        QuoteMap;
     void loadFile(const string&, DataType);
+    // parse the lines in [begin, end) into the given containers
+    void parseChunk(const char* begin, const char* end, DataType dataType, const QuantLib::Date& today,
+                    QuoteMap& data, std::set<Fixing>& fixings, std::set<QuantExt::Dividend>& dividends) const;
 
     bool implyTodaysFixings_;
-    std::map<QuantLib::Date, std::set<boost::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>> data_;
+    std::set<QuantLib::Date> marketDates_;
+    QuantLib::Size nThreads_ = 1;
+    QuoteMap data_;
     std::set<Fixing> fixings_;
     std::set<QuantExt::Dividend> dividends_;
 };
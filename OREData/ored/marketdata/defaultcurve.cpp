@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <ored/marketdata/calibratedcurvecache.hpp>
 #include <ored/marketdata/defaultcurve.hpp>
 #include <ored/marketdata/yieldcurve.hpp>
 #include <ored/utilities/log.hpp>
@@ -37,6 +38,8 @@
 #include <ql/termstructures/credit/flathazardrate.hpp>
 #include <ql/time/daycounters/actual365fixed.hpp>
 
+#include <boost/functional/hash.hpp>
+
 #include <algorithm>
 #include <set>
 
@@ -226,6 +229,25 @@ set<QuoteData> getConfiguredQuotes(const std::string& curveID, const DefaultCurv
     }
 }
 
+// Fingerprint of the configuration and the inputs of a CDS curve bootstrap, see CalibratedCurveCache
+std::size_t cdsFingerprint(const DefaultCurveConfig::Config& config, const boost::shared_ptr<CdsConvention>& cdsConv,
+                           const Date& asof, const Real recoveryRate,
+                           const vector<boost::shared_ptr<QuantExt::DefaultProbabilityHelper>>& helpers,
+                           const Handle<YieldTermStructure>& discountCurve) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, asof.serialNumber());
+    boost::hash_combine(seed, DefaultCurveConfig::Config(config).toXMLString());
+    boost::hash_combine(seed, cdsConv->toXMLString());
+    boost::hash_combine(seed, recoveryRate);
+    for (auto const& h : helpers) {
+        boost::hash_combine(seed, h->pillarDate().serialNumber());
+        boost::hash_combine(seed, h->quote()->value());
+    }
+    for (auto const& p : YieldCurveCalibrationInfo::defaultPeriods)
+        boost::hash_combine(seed, discountCurve->discount(asof + p, true));
+    return seed;
+}
+
 } // namespace
 
 namespace ore {
@@ -442,11 +464,12 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
     Real maxFactor = config.allowNegativeRates() ? config.bootstrapConfig().maxFactor() : 1.0;
     Real minFactor = config.bootstrapConfig().minFactor();
     Size dontThrowSteps = config.bootstrapConfig().dontThrowSteps();
+    bool globalNewton = config.bootstrapConfig().globalNewton();
 
     typedef PiecewiseDefaultCurve<QuantExt::SurvivalProbability, LogLinear, QuantExt::IterativeBootstrap> SpCurve;
     ATTR_UNUSED typedef SpCurve::traits_type dummy;
     QuantExt::IterativeBootstrap<SpCurve> btconfig(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                   minFactor, dontThrowSteps);
+                                                   minFactor, dontThrowSteps, globalNewton);
     boost::shared_ptr<DefaultProbabilityTermStructure> qlCurve;
 
     if (config.indexTerm() != 0 * Days) {
@@ -492,45 +515,84 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
 
     } else {
 
-        // build single name curve
+        // build single name curve, restore it from the calibrated curve cache if its configuration and inputs are
+        // unchanged
 
-        boost::shared_ptr<DefaultProbabilityTermStructure> tmp = boost::make_shared<SpCurve>(
-            asof, helpers, config.dayCounter(), LogLinear(),
-            QuantExt::IterativeBootstrap<SpCurve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                  minFactor, dontThrowSteps));
+        CalibratedCurveCache& cache = CalibratedCurveCache::instance();
+        std::size_t fingerprint = 0;
+        boost::shared_ptr<const CalibratedCurve> cached;
+        if (cache.enabled()) {
+            fingerprint = cdsFingerprint(config, cdsConv, asof, recoveryRate_, helpers, discountCurve);
+            cached = cache.get(spec.name(), fingerprint);
+        }
 
-        // As for yield curves we need to copy the piecewise curve because on eval date changes the relative date
-        // helpers with trigger a bootstrap.
         vector<Date> dates;
         vector<Real> survivalProbs;
-        dates.push_back(asof);
-        survivalProbs.push_back(1.0);
-
-        for (Size i = 0; i < helpers.size(); ++i) {
-            if (helpers[i]->latestDate() > asof) {
-                Date pillarDate = helpers[i]->pillarDate();
-                Probability sp = tmp->survivalProbability(pillarDate);
-
-                // In some cases the bootstrapped survival probability at one tenor will be `close` to that at a
-                // previous tenor. Here we don't add that survival probability and date to avoid issues when creating
-                // the InterpolatedSurvivalProbabilityCurve below.
-                if (!survivalProbs.empty() && close(survivalProbs.back(), sp)) {
-                    DLOG("Survival probability for curve " << spec.name() << " at date " << io::iso_date(pillarDate)
-                                                           << " is the same as that at previous date "
-                                                           << io::iso_date(dates.back()) << " so skipping it.");
-                    continue;
+
+        if (cached) {
+            DLOG("Restoring default curve " << spec.name() << " from the calibrated curve cache");
+            dates = cached->dates;
+            survivalProbs = cached->values;
+        } else {
+
+            // warm start from the last calibration of the curve in the calibrated curve cache, if any
+            vector<Date> warmStartDates;
+            vector<Real> warmStartValues;
+            if (config.bootstrapConfig().warmStart()) {
+                if (auto c = cache.get(spec.name())) {
+                    DLOG("Warm start of default curve " << spec.name() << " from the calibrated curve cache");
+                    warmStartDates = c->dates;
+                    warmStartValues = c->values;
                 }
+            }
+
+            boost::shared_ptr<DefaultProbabilityTermStructure> tmp = boost::make_shared<SpCurve>(
+                asof, helpers, config.dayCounter(), LogLinear(),
+                QuantExt::IterativeBootstrap<SpCurve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
+                                                      minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                      warmStartValues));
+
+            // As for yield curves we need to copy the piecewise curve because on eval date changes the relative date
+            // helpers with trigger a bootstrap.
+            dates.push_back(asof);
+            survivalProbs.push_back(1.0);
+
+            for (Size i = 0; i < helpers.size(); ++i) {
+                if (helpers[i]->latestDate() > asof) {
+                    Date pillarDate = helpers[i]->pillarDate();
+                    Probability sp = tmp->survivalProbability(pillarDate);
+
+                    // In some cases the bootstrapped survival probability at one tenor will be `close` to that at a
+                    // previous tenor. Here we don't add that survival probability and date to avoid issues when
+                    // creating the InterpolatedSurvivalProbabilityCurve below.
+                    if (!survivalProbs.empty() && close(survivalProbs.back(), sp)) {
+                        DLOG("Survival probability for curve " << spec.name() << " at date " << io::iso_date(pillarDate)
+                                                               << " is the same as that at previous date "
+                                                               << io::iso_date(dates.back()) << " so skipping it.");
+                        continue;
+                    }
 
-                dates.push_back(pillarDate);
-                survivalProbs.push_back(sp);
-                TLOG(io::iso_date(pillarDate) << "," << fixed << setprecision(9) << sp);
+                    dates.push_back(pillarDate);
+                    survivalProbs.push_back(sp);
+                    TLOG(io::iso_date(pillarDate) << "," << fixed << setprecision(9) << sp);
+                }
+            }
+            if (dates.size() == 1) {
+                // We might have removed points above. To make the interpolation work, we need at least two points
+                // though.
+                dates.push_back(dates.back() + 1);
+                survivalProbs.push_back(survivalProbs.back());
+            }
+
+            if (cache.enabled()) {
+                auto c = boost::make_shared<CalibratedCurve>();
+                c->fingerprint = fingerprint;
+                c->dates = dates;
+                c->values = survivalProbs;
+                cache.add(spec.name(), c);
             }
         }
-        if (dates.size() == 1) {
-            // We might have removed points above. To make the interpolation work, we need at least two points though.
-            dates.push_back(dates.back() + 1);
-            survivalProbs.push_back(survivalProbs.back());
-        }
+
         qlCurve = boost::make_shared<QuantExt::InterpolatedSurvivalProbabilityCurve<LogLinear>>(
             dates, survivalProbs, config.dayCounter(), Calendar(), std::vector<Handle<Quote>>(), std::vector<Date>(),
             LogLinear(), config.allowNegativeRates());
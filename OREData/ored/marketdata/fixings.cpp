@@ -21,12 +21,15 @@
     \ingroup
 */
 
+#include <algorithm>
 #include <boost/timer/timer.hpp>
 #include <ored/marketdata/fixings.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ql/index.hpp>
 #include <qle/indexes/equityindex.hpp>
+#include <qle/indexes/fallbackiborindex.hpp>
+#include <qle/indexes/fallbackovernightindex.hpp>
 #include <qle/utilities/savedobservablesettings.hpp>
 
 using boost::timer::cpu_timer;
@@ -38,31 +41,70 @@ using namespace QuantExt;
 namespace ore {
 namespace data {
 
-void applyFixings(const set<Fixing>& fixings) {
-
-    QuantExt::SavedObservableSettings savedObservableSettings;
-    ObservableSettings::instance().disableUpdates(true);
+namespace {
 
-    Size count = 0;
-    cpu_timer timer;
+// add the fixings in [begin, end), all for the same index, returns the number of fixings added
+Size addIndexFixings(set<Fixing>::const_iterator begin, set<Fixing>::const_iterator end) {
+    const string& name = begin->name;
+    if (name.empty()) {
+        WLOG("Skipping " << std::distance(begin, end) << " fixings with empty name");
+        return 0;
+    }
     boost::shared_ptr<Index> index;
-    std::string lastIndexName;
-    for (auto& f : fixings) {
-        if(f.name.empty()) {
-            WLOG("Skipping fixing with empty name, value " << f.fixing << ", date " << f.date);
+    try {
+        index = parseIndex(name);
+    } catch (const std::exception& e) {
+        WLOG("Error during adding fixings for " << name << ": " << e.what());
+        return 0;
+    }
+
+    // add the whole time series in one call, unless the index checks each fixing in its addFixing() override
+    if (!boost::dynamic_pointer_cast<FallbackIborIndex>(index) &&
+        !boost::dynamic_pointer_cast<FallbackOvernightIndex>(index)) {
+        vector<Date> dates;
+        vector<Real> values;
+        for (auto f = begin; f != end; ++f) {
+            dates.push_back(f->date);
+            values.push_back(f->fixing);
+        }
+        try {
+            index->addFixings(dates.begin(), dates.end(), values.begin(), true);
+            TLOG("Added " << dates.size() << " fixings for " << name);
+            return dates.size();
+        } catch (const std::exception& e) {
+            // the valid fixings are added, add them one by one to report the invalid ones
+            DLOG("Error during adding fixings for " << name << " (" << e.what() << "), add them one by one");
         }
+    }
+
+    Size count = 0;
+    for (auto f = begin; f != end; ++f) {
         try {
-            if (lastIndexName != f.name) {
-                index = parseIndex(f.name);
-                lastIndexName = f.name;
-            }
-            index->addFixing(f.date, f.fixing, true);
-            TLOG("Added fixing for " << f.name << " (" << io::iso_date(f.date) << ") value:" << f.fixing);
+            index->addFixing(f->date, f->fixing, true);
+            TLOG("Added fixing for " << f->name << " (" << io::iso_date(f->date) << ") value:" << f->fixing);
             ++count;
         } catch (const std::exception& e) {
-            WLOG("Error during adding fixing for " << f.name << ": " << e.what());
+            WLOG("Error during adding fixing for " << f->name << ": " << e.what());
         }
     }
+    return count;
+}
+
+} // namespace
+
+void applyFixings(const set<Fixing>& fixings) {
+
+    QuantExt::SavedObservableSettings savedObservableSettings;
+    ObservableSettings::instance().disableUpdates(true);
+
+    Size count = 0;
+    cpu_timer timer;
+    // the fixings are ordered by name, so that the fixings of an index form a contiguous block
+    for (auto begin = fixings.begin(); begin != fixings.end();) {
+        auto end = std::find_if(begin, fixings.end(), [&begin](const Fixing& f) { return f.name != begin->name; });
+        count += addIndexFixings(begin, end);
+        begin = end;
+    }
     timer.stop();
     LOG("Added " << count << " of " << fixings.size() << " fixings in " << timer.format(default_places, "%w")
                  << " seconds");
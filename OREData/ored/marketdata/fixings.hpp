@@ -67,7 +67,8 @@ private:
 //! Compare fixings
 bool operator<(const Fixing& f1, const Fixing& f2);
 
-//! Utility to write a vector of fixings in the QuantLib index manager's fixing history
+/*! Utility to write a vector of fixings in the QuantLib index manager's fixing history. The fixings of each index
+    are added in one call, invalid fixings are skipped with a warning. */
 void applyFixings(const std::set<Fixing>& fixings);
 
 } // namespace data
@@ -115,8 +115,11 @@ Handle<Quote> FXTriangulation::getQuote(const std::string& pair) const {
 
     // do we have a cached result?
 
-    if (auto it = quoteCache_.find(pair); it != quoteCache_.end())
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (auto it = quoteCache_.find(pair); it != quoteCache_.end())
+            return it->second;
+    }
 
     // we need to construct the quote from the input quotes
 
@@ -160,16 +163,19 @@ Handle<Quote> FXTriangulation::getQuote(const std::string& pair) const {
 
     // add the result to the lookup cache and return it
 
-    quoteCache_[pair] = result;
-    return result;
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return quoteCache_.emplace(pair, result).first->second;
 }
 
 Handle<FxIndex> FXTriangulation::getIndex(const std::string& indexOrPair, const Market* market) const {
 
     // do we have a cached result?
 
-    if (auto it = indexCache_.find(indexOrPair); it != indexCache_.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (auto it = indexCache_.find(indexOrPair); it != indexCache_.end()) {
+            return it->second;
+        }
     }
 
     // otherwise we need to construct the index
@@ -253,8 +259,8 @@ Handle<FxIndex> FXTriangulation::getIndex(const std::string& indexOrPair, const
 
     // add the result to the lookup cache and return it
 
-    indexCache_[indexOrPair] = result;
-    return result;
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return indexCache_.emplace(indexOrPair, result).first->second;
 }
 
 std::vector<std::string> FXTriangulation::getPath(const std::string& forCcy, const std::string& domCcy) const {
@@ -31,6 +31,7 @@
 #include <ql/quote.hpp>
 #include <ql/types.hpp>
 
+#include <mutex>
 #include <vector>
 
 namespace ore {
@@ -71,9 +72,10 @@ private:
     // the input quotes
     std::map<std::string, QuantLib::Handle<QuantLib::Quote>> quotes_;
 
-    // caches to improve perfomance
+    // caches to improve perfomance, guarded by the mutex since the curve builds of a TodaysMarket might run in parallel
     mutable std::map<std::string, QuantLib::Handle<QuantLib::Quote>> quoteCache_;
     mutable std::map<std::string, QuantLib::Handle<QuantExt::FxIndex>> indexCache_;
+    mutable std::mutex cacheMutex_;
 
     // internal data structure to represent the undirected graph of currencies
     std::vector<std::string> nodeToCcy_;
@@ -20,8 +20,11 @@
 #include <ored/marketdata/inmemoryloader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/parsers.hpp>
 
+#include <ql/quotes/simplequote.hpp>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -50,6 +53,11 @@ boost::shared_ptr<MarketDatum> InMemoryLoader::get(const string& name, const Qua
     return *it2;
 }
 
+bool InMemoryLoader::has(const string& name, const QuantLib::Date& d) const {
+    auto it = data_.find(d);
+    return it != data_.end() && it->second.find(makeDummyMarketDatum(d, name)) != it->second.end();
+}
+
 std::set<boost::shared_ptr<MarketDatum>> InMemoryLoader::get(const std::set<std::string>& names,
                                                              const QuantLib::Date& asof) const {
     auto it = data_.find(asof);
@@ -117,6 +125,15 @@ void InMemoryLoader::add(QuantLib::Date date, const string& name, QuantLib::Real
     }
 }
 
+void InMemoryLoader::add(const boost::shared_ptr<MarketDatum>& datum) {
+    QL_REQUIRE(datum, "InMemoryLoader::add(): no market datum given");
+    if (data_[datum->asofDate()].insert(datum).second) {
+        TLOG("Added MarketDatum " << datum->name());
+    } else {
+        WLOG("Skipped MarketDatum " << datum->name() << " - this is already present.");
+    }
+}
+
 void InMemoryLoader::addFixing(QuantLib::Date date, const string& name, QuantLib::Real value) {
     if (!fixings_.insert(Fixing(date, name, value)).second) {
         WLOG("Skipped Fixing " << name << "@" << QuantLib::io::iso_date(date) << " - this is already present.");
@@ -136,6 +153,37 @@ void InMemoryLoader::reset() {
     actualDate_ = Date();
 }
 
+std::set<Date> InMemoryLoader::dates() const {
+    std::set<Date> result;
+    for (auto const& d : data_)
+        result.insert(result.end(), d.first);
+    return result;
+}
+
+Size InMemoryLoader::numberOfQuotes() const {
+    Size n = 0;
+    for (auto const& d : data_)
+        n += d.second.size();
+    return n;
+}
+
+std::size_t InMemoryLoader::memoryFootprint() const {
+    // set nodes hold the element, three pointers and the colour, shared pointers add a control block
+    const std::size_t node = 4 * sizeof(void*);
+    const std::size_t sharedPtr = sizeof(boost::shared_ptr<MarketDatum>) + 2 * sizeof(long);
+    std::size_t bytes = 0;
+    for (auto const& d : data_) {
+        bytes += d.second.size() * (node + sharedPtr + sizeof(MarketDatum) + sharedPtr + sizeof(SimpleQuote));
+        for (auto const& md : d.second)
+            bytes += ore::data::memoryFootprint(md->name());
+    }
+    for (auto const& f : fixings_)
+        bytes += node + sizeof(Fixing) + ore::data::memoryFootprint(f.name);
+    for (auto const& div : dividends_)
+        bytes += node + sizeof(QuantExt::Dividend) + ore::data::memoryFootprint(div.name);
+    return bytes;
+}
+
 void load(InMemoryLoader& loader, const vector<string>& data, bool isMarket, bool implyTodaysFixings) {
     LOG("MemoryLoader started");
 
@@ -180,5 +228,16 @@ void loadDataFromBuffers(InMemoryLoader& loader, const std::vector<std::string>&
     load(loader, fixingData, false, implyTodaysFixings);
 }
 
+
+bool InMemoryLoader::hasFixing(const string& name, const QuantLib::Date& d) const {
+    return fixings_.find(Fixing(d, name, 0.0)) != fixings_.end();
+}
+
+Fixing InMemoryLoader::getFixing(const string& name, const QuantLib::Date& d) const {
+    // fixings are ordered by name and date, the value does not take part in the comparison
+    auto it = fixings_.find(Fixing(d, name, 0.0));
+    return it == fixings_.end() ? Fixing() : *it;
+}
+
 } // namespace data
 } // namespace ore
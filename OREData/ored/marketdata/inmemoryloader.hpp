@@ -34,13 +34,19 @@ public:
     std::set<boost::shared_ptr<MarketDatum>> get(const std::set<std::string>& names,
                                                  const QuantLib::Date& asof) const override;
     std::set<boost::shared_ptr<MarketDatum>> get(const Wildcard& wildcard, const QuantLib::Date& asof) const override;
+    bool has(const string& name, const QuantLib::Date& d) const override;
     std::set<Fixing> loadFixings() const override { return fixings_; }
+    bool hasFixing(const string& name, const QuantLib::Date& d) const override;
+    Fixing getFixing(const string& name, const QuantLib::Date& d) const override;
     std::set<QuantExt::Dividend> loadDividends() const override { return dividends_; }
     bool hasQuotes(const QuantLib::Date& d) const override;
 
     // add a market datum
     virtual void add(QuantLib::Date date, const string& name, QuantLib::Real value);
 
+    // add a market datum that is already parsed, e.g. taken from another loader
+    virtual void add(const boost::shared_ptr<MarketDatum>& datum);
+
     // add a fixing
     virtual void addFixing(QuantLib::Date date, const string& name, QuantLib::Real value);
 
@@ -50,6 +56,16 @@ public:
     // clear data
     void reset();
 
+    // the dates with market data
+    std::set<QuantLib::Date> dates() const;
+
+    // the number of quotes over all dates
+    QuantLib::Size numberOfQuotes() const;
+
+    /* an estimate of the memory held by the quotes, fixings and dividends in bytes, see MemoryAccounting, quotes
+       are counted with the size of the base MarketDatum and a SimpleQuote */
+    std::size_t memoryFootprint() const;
+
 protected:
     std::map<QuantLib::Date, std::set<boost::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>> data_;
     std::set<Fixing> fixings_;
@@ -91,13 +91,10 @@ bool Loader::hasFixing(const string& name, const QuantLib::Date& d) const {
 }
 
 Fixing Loader::getFixing(const string& name, const QuantLib::Date& d) const {
-    Fixing fixing;
-    for (auto const& f : loadFixings()) {
-        if (f.name == name && f.date == d) {
-            fixing = f;
-        }
-    }
-    return fixing;
+    // the fixings are ordered by name and date, derived classes holding the set should look it up directly
+    auto fixings = loadFixings();
+    auto it = fixings.find(Fixing(d, name, 0.0));
+    return it == fixings.end() ? Fixing() : *it;
 }
 
 std::set<QuantExt::Dividend> Loader::loadDividends() const { return {}; }
@@ -51,6 +51,9 @@
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/locks.hpp>
 
+#include <set>
+#include <utility>
+
 namespace ore {
 namespace data {
 using namespace QuantLib;
@@ -292,6 +295,19 @@ public:
     //! Refresh term structures for a given configuration
     virtual void refresh(const string&) {}
 
+    //! \name Market object request recording
+    /*! Markets supporting this record the market objects requested while the recording is enabled, see e.g.
+        ScenarioSimMarket. The recorded requests are used to attribute market objects to the trades built against
+        the market, see Portfolio::marketRequests(). */
+    //@{
+    //! True if the market currently records the requested market objects
+    virtual bool recordingRequests() const { return false; }
+    //! The recorded requests as pairs of market object and name
+    virtual std::set<std::pair<MarketObject, string>> recordedRequests() const { return {}; }
+    //! Replace the recorded requests
+    virtual void setRecordedRequests(const std::set<std::pair<MarketObject, string>>&) {}
+    //@}
+
     //! Default configuration label
     static const string defaultConfiguration;
 
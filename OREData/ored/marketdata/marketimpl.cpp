@@ -217,6 +217,7 @@ Handle<Quote> MarketImpl::fxSpotImpl(const string& ccypair, const string& config
 
 Handle<BlackVolTermStructure> MarketImpl::fxVolImpl(const string& ccypair, const string& configuration) const {
     require(MarketObject::FXVol, ccypair, configuration);
+    std::unique_lock<std::mutex> lock(fxVolsMutex_);
     auto it = fxVols_.find(make_pair(configuration, ccypair));
     if (it != fxVols_.end())
         return it->second;
@@ -224,16 +225,18 @@ Handle<BlackVolTermStructure> MarketImpl::fxVolImpl(const string& ccypair, const
         // check for reverse EURUSD or USDEUR and add to the map
         QL_REQUIRE(ccypair.length() == 6, "invalid ccy pair length");
         std::string ccypairInverted = ccypair.substr(3, 3) + ccypair.substr(0, 3);
+        lock.unlock();
         require(MarketObject::FXVol, ccypairInverted, configuration);
+        lock.lock();
         it = fxVols_.find(make_pair(configuration, ccypairInverted));
         if (it != fxVols_.end()) {
             Handle<BlackVolTermStructure> h(boost::make_shared<QuantExt::BlackInvertedVolTermStructure>(it->second));
             h->enableExtrapolation();
             // we have found a surface for the inverted pair.
             // so we can invert the surface and store that under the original pair.
-            fxVols_[make_pair(configuration, ccypair)] = h;
-            return h;
+            return fxVols_.emplace(make_pair(configuration, ccypair), h).first->second;
         } else {
+            lock.unlock();
             if (configuration == Market::defaultConfiguration)
                 QL_FAIL("did not find fx vol object " << ccypair);
             else
@@ -31,6 +31,7 @@
 #include <qle/indexes/fxindex.hpp>
 
 #include <map>
+#include <mutex>
 
 namespace ore {
 namespace data {
@@ -212,6 +213,9 @@ protected:
     mutable map<pair<string, string>, pair<string, string>> swaptionIndexBases_;
     mutable map<pair<string, string>, Handle<QuantLib::SwaptionVolatilityStructure>> yieldVolCurves_;
     mutable map<pair<string, string>, Handle<BlackVolTermStructure>> fxVols_;
+    // guards the completion of fxVols_ by inverted pairs on lookup, which might run in the parallel curve builds of a
+    // TodaysMarket (the other maps are only written by the market's build itself)
+    mutable std::mutex fxVolsMutex_;
     mutable map<pair<string, string>, Handle<QuantExt::CreditCurve>> defaultCurves_;
     mutable map<pair<string, string>, Handle<QuantExt::CreditVolCurve>> cdsVols_;
     mutable map<pair<string, string>, Handle<QuantExt::BaseCorrelationTermStructure>> baseCorrelations_;
@@ -43,7 +43,10 @@
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/indexnametranslator.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
+#include <ored/utilities/osutils.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <qle/indexes/dividendmanager.hpp>
 #include <qle/indexes/equityindex.hpp>
 #include <qle/indexes/fallbackiborindex.hpp>
@@ -54,10 +57,17 @@
 #include <qle/termstructures/pricetermstructureadapter.hpp>
 
 #include <boost/graph/topological_sort.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -77,11 +87,12 @@ TodaysMarket::TodaysMarket(const Date& asof, const boost::shared_ptr<TodaysMarke
                            const bool loadFixings, const bool lazyBuild,
                            const boost::shared_ptr<ReferenceDataManager>& referenceData,
                            const bool preserveQuoteLinkage, const IborFallbackConfig& iborFallbackConfig,
-                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies)
+                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies,
+                           const Size nThreads)
     : MarketImpl(handlePseudoCurrencies), params_(params), loader_(loader), curveConfigs_(curveConfigs),
       continueOnError_(continueOnError), loadFixings_(loadFixings), lazyBuild_(lazyBuild),
       preserveQuoteLinkage_(preserveQuoteLinkage), referenceData_(referenceData),
-      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo) {
+      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo), nThreads_(nThreads) {
     QL_REQUIRE(params_, "TodaysMarket: TodaysMarketParameters are null");
     QL_REQUIRE(loader_, "TodaysMarket: Loader is null");
     QL_REQUIRE(curveConfigs_, "TodaysMarket: CurveConfigurations are null");
@@ -93,6 +104,23 @@ struct Count {
     void inc() { ++count; }
     std::size_t count = 0;
 };
+
+// the exclusive lock on the market maps held by the current thread, if it is a worker of a parallel build
+thread_local boost::unique_lock<boost::shared_mutex>* workerBuildLock = nullptr;
+
+/* Returns f(), which builds a market object. A worker of a parallel build releases its exclusive lock while f() runs
+   and holds a shared lock instead, so that the curve builders of several workers run concurrently, while they only
+   read the maps. The exclusive lock is reacquired before returning, also if f() throws. */
+template <class F> auto buildConcurrently(boost::shared_mutex& mutex, F f) -> decltype(f()) {
+    if (workerBuildLock == nullptr)
+        return f();
+    struct Relock {
+        ~Relock() { workerBuildLock->lock(); }
+    } relock;
+    workerBuildLock->unlock();
+    boost::shared_lock<boost::shared_mutex> lock(mutex);
+    return f();
+}
 } // namespace
 
 void TodaysMarket::initialise(const Date& asof) {
@@ -101,6 +129,9 @@ void TodaysMarket::initialise(const Date& asof) {
     std::map<std::string, Count> counts;
     boost::timer::cpu_timer timer;
 
+    const bool accountMemory = MemoryAccounting::instance().enabled();
+    const unsigned long long memoryBefore = accountMemory ? os::getMemoryUsageBytes() : 0;
+
     asof_ = asof;
 
     calibrationInfo_ = boost::make_shared<TodaysMarketCalibrationInfo>();
@@ -157,6 +188,15 @@ void TodaysMarket::initialise(const Date& asof) {
 
     if (!lazyBuild_) {
 
+        bool parallel = nThreads_ > 1;
+#ifndef QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+        if (parallel) {
+            WLOG("TodaysMarket: parallel build with " << nThreads_ << " threads requires a QuantLib build with "
+                                                      << "QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, build sequentially");
+            parallel = false;
+        }
+#endif
+
         // We need to build all discount curves first, since some curve builds ask for discount
         // curves from specific configurations
         timer.start();
@@ -198,6 +238,16 @@ void TodaysMarket::initialise(const Date& asof) {
                 TLOG("vertex #" << index[m] << ": " << g[m]);
             }
 
+            // Build the objects in the graph along the dependencies on the worker threads
+
+            if (parallel && !order.empty()) {
+                timer.start();
+                buildNodesParallel(configuration.first, g, buildErrors);
+                timings["6 build (parallel)"] += timer.elapsed().wall;
+                counts["6 build (parallel)"].inc();
+                continue;
+            }
+
             // Build the objects in the graph in topological order
 
             Size countSuccess = 0, countError = 0;
@@ -240,6 +290,11 @@ void TodaysMarket::initialise(const Date& asof) {
     }
     LOG("Total build time              : " << std::setw(15) << static_cast<double>(sum) / 1.0E6 << " ms");
 
+    if (accountMemory) {
+        unsigned long long memoryAfter = os::getMemoryUsageBytes();
+        initialiseMemory_ = memoryAfter > memoryBefore ? static_cast<std::size_t>(memoryAfter - memoryBefore) : 0;
+    }
+
     // output errors from initialisation phase
 
     if (!buildErrors.empty()) {
@@ -257,6 +312,278 @@ void TodaysMarket::initialise(const Date& asof) {
 
 } // TodaysMarket::initialise()
 
+std::set<std::string> TodaysMarket::update(const std::set<std::string>& changedQuotes) {
+
+    LOG("TodaysMarket: update market for " << changedQuotes.size() << " changed quotes");
+
+    // check whether the object built from a curve spec consumes one of the changed quotes
+
+    std::map<std::string, bool> consumesChangedQuotes;
+    auto consumes = [this, &changedQuotes, &consumesChangedQuotes](const boost::shared_ptr<CurveSpec>& spec) {
+        auto c = consumesChangedQuotes.find(spec->name());
+        if (c != consumesChangedQuotes.end())
+            return c->second;
+        bool result = false;
+        if (spec->baseType() == CurveSpec::CurveType::FX) {
+            if (auto fxSpec = boost::dynamic_pointer_cast<FXSpotSpec>(spec)) {
+                result = changedQuotes.count("FX/RATE/" + fxSpec->unitCcy() + "/" + fxSpec->ccy()) > 0 ||
+                         changedQuotes.count("FX/RATE/" + fxSpec->ccy() + "/" + fxSpec->unitCcy()) > 0;
+            }
+        } else if (curveConfigs_->has(spec->baseType(), spec->curveConfigID())) {
+            for (auto const& q : curveConfigs_->get(spec->baseType(), spec->curveConfigID())->quotes()) {
+                Wildcard w(q);
+                result = w.hasWildcard() ? std::any_of(changedQuotes.begin(), changedQuotes.end(),
+                                                       [&w](const std::string& n) { return w.matches(n); })
+                                         : changedQuotes.count(q) > 0;
+                if (result)
+                    break;
+            }
+        }
+        consumesChangedQuotes[spec->name()] = result;
+        return result;
+    };
+
+    /* collect the nodes consuming the changed quotes and all nodes depending on them, i.e. the sources of their in
+       edges. A curve spec that is rebuilt in one configuration is rebuilt in all of them, so we repeat the search
+       until no further curve specs are found. */
+
+    std::set<std::string> specs;
+    std::map<std::string, std::set<Vertex>> affected;
+    bool foundSpecs = true;
+    while (foundSpecs) {
+        foundSpecs = false;
+        for (auto& [configuration, g] : dependencies_) {
+            std::set<Vertex>& nodes = affected[configuration];
+            VertexIterator v, vend;
+            for (std::tie(v, vend) = boost::vertices(g); v != vend; ++v) {
+                if (nodes.count(*v) > 0 || !g[*v].curveSpec ||
+                    (specs.count(g[*v].curveSpec->name()) == 0 && !consumes(g[*v].curveSpec)))
+                    continue;
+                std::queue<Vertex> todo;
+                todo.push(*v);
+                nodes.insert(*v);
+                while (!todo.empty()) {
+                    Vertex u = todo.front();
+                    todo.pop();
+                    if (g[u].curveSpec && specs.insert(g[u].curveSpec->name()).second)
+                        foundSpecs = true;
+                    for (auto e : boost::make_iterator_range(boost::in_edges(u, g))) {
+                        Vertex s = boost::source(e, g);
+                        if (nodes.insert(s).second)
+                            todo.push(s);
+                    }
+                }
+            }
+        }
+    }
+
+    LOG("TodaysMarket: rebuild " << specs.size() << " curve specs");
+    for (auto const& s : specs)
+        DLOG("rebuild curve spec " << s);
+
+    // remove the objects to rebuild from the caches, the rebuilt yield curves take over the handles of the old ones
+
+    for (auto const& s : specs) {
+        if (auto y = requiredYieldCurves_.find(s); y != requiredYieldCurves_.end()) {
+            previousYieldCurves_[s] = y->second;
+            requiredYieldCurves_.erase(y);
+        }
+        requiredFxVolCurves_.erase(s);
+        requiredGenericYieldVolCurves_.erase(s);
+        requiredCapFloorVolCurves_.erase(s);
+        requiredDefaultCurves_.erase(s);
+        requiredCDSVolCurves_.erase(s);
+        requiredBaseCorrelationCurves_.erase(s);
+        requiredInflationCurves_.erase(s);
+        requiredInflationCapFloorVolCurves_.erase(s);
+        requiredEquityCurves_.erase(s);
+        requiredEquityVolCurves_.erase(s);
+        requiredSecurities_.erase(s);
+        requiredCommodityCurves_.erase(s);
+        requiredCommodityVolCurves_.erase(s);
+        requiredCorrelationCurves_.erase(s);
+    }
+
+    /* rebuild the nodes that were built before in topological order, the nodes that were not built yet are built when
+       they are required. Nodes without curve spec (swap indices) are not rebuilt, since they are built on the yield
+       curve handles, which stay valid. */
+
+    map<string, string> buildErrors;
+    for (auto& [configuration, g] : dependencies_) {
+        const std::set<Vertex>& nodes = affected[configuration];
+        if (nodes.empty())
+            continue;
+        std::vector<Vertex> order;
+        try {
+            boost::topological_sort(g, std::back_inserter(order));
+        } catch (const std::exception& e) {
+            buildErrors["CurveDependencyGraph"] = "Topological sort of dependency graph failed for configuration " +
+                                                  configuration + " (" + ore::data::to_string(e.what()) + ")";
+            continue;
+        }
+        for (auto const& m : order) {
+            if (nodes.count(m) == 0 || !g[m].curveSpec)
+                continue;
+            bool wasBuilt = g[m].built;
+            g[m].built = false;
+            if (!wasBuilt)
+                continue;
+            try {
+                buildNode(configuration, g[m]);
+                DLOG("rebuilt node " << g[m] << " in configuration " << configuration);
+            } catch (const std::exception& e) {
+                buildErrors[g[m].curveSpec->name()] = e.what();
+                ALOG("error while rebuilding node " << g[m] << " in configuration " << configuration << ": "
+                                                    << e.what());
+            }
+        }
+    }
+
+    // yield curves that could not be rebuilt are kept
+
+    for (auto const& p : previousYieldCurves_)
+        requiredYieldCurves_.insert(p);
+    previousYieldCurves_.clear();
+
+    if (!buildErrors.empty()) {
+        for (auto const& error : buildErrors) {
+            ALOG(StructuredCurveErrorMessage(error.first, "Failed to Build Curve", error.second));
+        }
+        if (!continueOnError_) {
+            string errStr;
+            for (auto const& error : buildErrors) {
+                errStr += "(" + error.first + ": " + error.second + "); ";
+            }
+            QL_FAIL("Cannot rebuild all required curves! Building failed for: " << errStr);
+        }
+    }
+
+    return specs;
+} // TodaysMarket::update()
+
+boost::shared_ptr<TodaysMarketParameters> TodaysMarket::usedMarketParameters() const {
+    auto result = boost::make_shared<TodaysMarketParameters>();
+    for (auto const& c : params_->configurations())
+        result->addConfiguration(c.first, c.second);
+    Size count = 0;
+    for (auto const& [configuration, g] : dependencies_) {
+        map<MarketObject, map<string, string>> assignments;
+        VertexIterator v, vend;
+        for (std::tie(v, vend) = boost::vertices(g); v != vend; ++v) {
+            if (g[*v].built) {
+                assignments[g[*v].obj][g[*v].name] = g[*v].mapping;
+                ++count;
+            }
+        }
+        for (auto const& a : assignments)
+            result->addMarketObject(a.first, params_->marketObjectId(a.first, configuration), a.second);
+    }
+    DLOG("TodaysMarket: " << count << " market objects were used");
+    return result;
+}
+
+Size TodaysMarket::numberOfBuiltObjects() const {
+    Size count = 0;
+    for (auto const& [configuration, g] : dependencies_) {
+        VertexIterator v, vend;
+        for (std::tie(v, vend) = boost::vertices(g); v != vend; ++v) {
+            if (g[*v].built)
+                ++count;
+        }
+    }
+    return count;
+}
+
+void TodaysMarket::buildNodesParallel(const std::string& configuration, Graph& g,
+                                      map<string, string>& buildErrors) const {
+
+    // the out edges of a node point to the nodes it depends on, a node is ready to be built once all of them are
+    // processed, successfully or not (the sequential build tries to build the dependents of a failed node, too)
+
+    IndexMap index = boost::get(boost::vertex_index, g);
+    std::vector<Size> pending(boost::num_vertices(g));
+    std::queue<Vertex> ready;
+    VertexIterator v, vend;
+    for (std::tie(v, vend) = boost::vertices(g); v != vend; ++v) {
+        pending[index[*v]] = boost::out_degree(*v, g);
+        if (pending[index[*v]] == 0)
+            ready.push(*v);
+    }
+
+    Size remaining = boost::num_vertices(g), countSuccess = 0, countError = 0;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    // the worker threads start with a fresh session, if sessions are enabled
+
+#ifdef QL_ENABLE_SESSIONS
+    Date evaluationDate = Settings::instance().evaluationDate();
+    std::set<Fixing> fixings;
+    if (loadFixings_)
+        fixings = loader_->loadFixings();
+    std::set<QuantExt::Dividend> dividends = loader_->loadDividends();
+#endif
+
+    auto work = [&]() {
+#ifdef QL_ENABLE_SESSIONS
+        Settings::instance().evaluationDate() = evaluationDate;
+        applyFixings(fixings);
+        applyDividends(dividends);
+#endif
+        boost::unique_lock<boost::shared_mutex> buildLock(buildMutex_, boost::defer_lock);
+        workerBuildLock = &buildLock;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [&ready, &remaining]() { return !ready.empty() || remaining == 0; });
+            if (remaining == 0)
+                break;
+            Vertex m = ready.front();
+            ready.pop();
+            lock.unlock();
+            std::string error;
+            bool success = true;
+            buildLock.lock();
+            try {
+                buildNode(configuration, g[m]);
+                DLOG("built node " << g[m] << " in configuration " << configuration);
+            } catch (const std::exception& e) {
+                success = false;
+                error = e.what();
+                ALOG("error while building node " << g[m] << " in configuration " << configuration << ": "
+                                                  << e.what());
+            }
+            buildLock.unlock();
+            lock.lock();
+            if (success) {
+                ++countSuccess;
+            } else {
+                buildErrors[g[m].curveSpec ? g[m].curveSpec->name() : g[m].name] = error;
+                ++countError;
+            }
+            --remaining;
+            boost::graph_traits<Graph>::in_edge_iterator e, eend;
+            for (std::tie(e, eend) = boost::in_edges(m, g); e != eend; ++e) {
+                Vertex u = boost::source(*e, g);
+                if (--pending[index[u]] == 0)
+                    ready.push(u);
+            }
+            condition.notify_all();
+        }
+        workerBuildLock = nullptr;
+    };
+
+    Size nThreads = std::min<Size>(nThreads_, boost::num_vertices(g));
+    LOG("Build " << boost::num_vertices(g) << " objects in TodaysMarket configuration " << configuration << " on "
+                 << nThreads << " threads");
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < nThreads; ++i)
+        threads.emplace_back(work);
+    for (auto& t : threads)
+        t.join();
+
+    LOG("Loaded CurvesSpecs: success: " << countSuccess << ", error: " << countError);
+}
+
 void TodaysMarket::buildNode(const std::string& configuration, Node& node) const {
 
     // if the node is already built, there is nothing to do
@@ -264,6 +591,13 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
     if (node.built)
         return;
 
+    TraceSpan span("market", "TodaysMarket::buildNode");
+    if (span.active())
+        span.arg("configuration", configuration)
+            .arg("object", ore::data::to_string(node.obj))
+            .arg("name", node.name)
+            .arg("spec", node.mapping);
+
     if (node.curveSpec == nullptr) {
 
         // not spec-based node, this can only be a SwapIndexCurve
@@ -294,9 +628,15 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredYieldCurves_.find(ycspec->name());
             if (itr == requiredYieldCurves_.end()) {
                 DLOG("Building YieldCurve for asof " << asof_);
-                boost::shared_ptr<YieldCurve> yieldCurve = boost::make_shared<YieldCurve>(
-                    asof_, *ycspec, *curveConfigs_, *loader_, requiredYieldCurves_, requiredDefaultCurves_, *fx_,
-                    referenceData_, iborFallbackConfig_, preserveQuoteLinkage_, buildCalibrationInfo_, this);
+                boost::shared_ptr<YieldCurve> yieldCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<YieldCurve>(
+                        asof_, *ycspec, *curveConfigs_, *loader_, requiredYieldCurves_, requiredDefaultCurves_, *fx_,
+                        referenceData_, iborFallbackConfig_, preserveQuoteLinkage_, buildCalibrationInfo_, this);
+                });
+                if (auto previous = previousYieldCurves_.find(ycspec->name()); previous != previousYieldCurves_.end()) {
+                    yieldCurve->takeOverHandle(*previous->second);
+                    previousYieldCurves_.erase(previous);
+                }
                 calibrationInfo_->yieldCurveCalibrationInfo[ycspec->name()] = yieldCurve->calibrationInfo();
                 itr = requiredYieldCurves_.insert(make_pair(ycspec->name(), yieldCurve)).first;
                 DLOG("Added YieldCurve \"" << ycspec->name() << "\" to requiredYieldCurves map");
@@ -376,9 +716,11 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredFxVolCurves_.find(fxvolspec->name());
             if (itr == requiredFxVolCurves_.end()) {
                 DLOG("Building FXVolatility for asof " << asof_);
-                boost::shared_ptr<FXVolCurve> fxVolCurve = boost::make_shared<FXVolCurve>(
-                    asof_, *fxvolspec, *loader_, *curveConfigs_, *fx_, requiredYieldCurves_, requiredFxVolCurves_,
-                    requiredCorrelationCurves_, buildCalibrationInfo_);
+                boost::shared_ptr<FXVolCurve> fxVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<FXVolCurve>(
+                        asof_, *fxvolspec, *loader_, *curveConfigs_, *fx_, requiredYieldCurves_, requiredFxVolCurves_,
+                        requiredCorrelationCurves_, buildCalibrationInfo_);
+                });
                 calibrationInfo_->fxVolCalibrationInfo[fxvolspec->name()] = fxVolCurve->calibrationInfo();
                 itr = requiredFxVolCurves_.insert(make_pair(fxvolspec->name(), fxVolCurve)).first;
             }
@@ -399,9 +741,12 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredGenericYieldVolCurves_.find(swvolspec->name());
             if (itr == requiredGenericYieldVolCurves_.end()) {
                 DLOG("Building Swaption Volatility (" << node.name << ") for asof " << asof_);
-                boost::shared_ptr<SwaptionVolCurve> swaptionVolCurve = boost::make_shared<SwaptionVolCurve>(
-                    asof_, *swvolspec, *loader_, *curveConfigs_, requiredSwapIndices_[configuration],
-                    requiredGenericYieldVolCurves_, buildCalibrationInfo_);
+                const auto& swapIndices = requiredSwapIndices_[configuration];
+                boost::shared_ptr<SwaptionVolCurve> swaptionVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<SwaptionVolCurve>(
+                        asof_, *swvolspec, *loader_, *curveConfigs_, swapIndices, requiredGenericYieldVolCurves_,
+                        buildCalibrationInfo_);
+                });
                 calibrationInfo_->irVolCalibrationInfo[swvolspec->name()] = swaptionVolCurve->calibrationInfo();
                 itr = requiredGenericYieldVolCurves_.insert(make_pair(swvolspec->name(), swaptionVolCurve)).first;
             }
@@ -428,8 +773,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredGenericYieldVolCurves_.find(ydvolspec->name());
             if (itr == requiredGenericYieldVolCurves_.end()) {
                 DLOG("Building Yield Volatility for asof " << asof_);
-                boost::shared_ptr<YieldVolCurve> yieldVolCurve = boost::make_shared<YieldVolCurve>(
-                    asof_, *ydvolspec, *loader_, *curveConfigs_, buildCalibrationInfo_);
+                boost::shared_ptr<YieldVolCurve> yieldVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<YieldVolCurve>(asof_, *ydvolspec, *loader_, *curveConfigs_,
+                                                             buildCalibrationInfo_);
+                });
                 calibrationInfo_->irVolCalibrationInfo[ydvolspec->name()] = yieldVolCurve->calibrationInfo();
                 itr = requiredGenericYieldVolCurves_.insert(make_pair(ydvolspec->name(), yieldVolCurve)).first;
             }
@@ -480,9 +827,11 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
                 }
 
                 // Now create cap/floor vol curve
-                boost::shared_ptr<CapFloorVolCurve> capFloorVolCurve = boost::make_shared<CapFloorVolCurve>(
-                    asof_, *cfVolSpec, *loader_, *curveConfigs_, iborIndex.currentLink(), discountCurve, sourceIndex,
-                    targetIndex, requiredCapFloorVolCurves_, buildCalibrationInfo_);
+                boost::shared_ptr<CapFloorVolCurve> capFloorVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<CapFloorVolCurve>(
+                        asof_, *cfVolSpec, *loader_, *curveConfigs_, iborIndex.currentLink(), discountCurve,
+                        sourceIndex, targetIndex, requiredCapFloorVolCurves_, buildCalibrationInfo_);
+                });
                 calibrationInfo_->irVolCalibrationInfo[cfVolSpec->name()] = capFloorVolCurve->calibrationInfo();
                 itr = requiredCapFloorVolCurves_
                           .insert(make_pair(
@@ -507,8 +856,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             if (itr == requiredDefaultCurves_.end()) {
                 // build the curve
                 DLOG("Building DefaultCurve for asof " << asof_);
-                boost::shared_ptr<DefaultCurve> defaultCurve = boost::make_shared<DefaultCurve>(
-                    asof_, *defaultspec, *loader_, *curveConfigs_, requiredYieldCurves_, requiredDefaultCurves_);
+                boost::shared_ptr<DefaultCurve> defaultCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<DefaultCurve>(
+                        asof_, *defaultspec, *loader_, *curveConfigs_, requiredYieldCurves_, requiredDefaultCurves_);
+                });
                 itr = requiredDefaultCurves_.insert(make_pair(defaultspec->name(), defaultCurve)).first;
             }
             DLOG("Adding DefaultCurve (" << node.name << ") with spec " << *defaultspec << " to configuration "
@@ -528,8 +879,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredCDSVolCurves_.find(cdsvolspec->name());
             if (itr == requiredCDSVolCurves_.end()) {
                 DLOG("Building CDSVol for asof " << asof_);
-                boost::shared_ptr<CDSVolCurve> cdsVolCurve = boost::make_shared<CDSVolCurve>(
-                    asof_, *cdsvolspec, *loader_, *curveConfigs_, requiredCDSVolCurves_, requiredDefaultCurves_);
+                boost::shared_ptr<CDSVolCurve> cdsVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<CDSVolCurve>(
+                        asof_, *cdsvolspec, *loader_, *curveConfigs_, requiredCDSVolCurves_, requiredDefaultCurves_);
+                });
                 itr = requiredCDSVolCurves_.insert(make_pair(cdsvolspec->name(), cdsVolCurve)).first;
             }
             DLOG("Adding CDSVol (" << node.name << ") with spec " << *cdsvolspec << " to configuration "
@@ -547,8 +900,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredBaseCorrelationCurves_.find(baseCorrelationSpec->name());
             if (itr == requiredBaseCorrelationCurves_.end()) {
                 DLOG("Building BaseCorrelation for asof " << asof_);
-                boost::shared_ptr<BaseCorrelationCurve> baseCorrelationCurve = boost::make_shared<BaseCorrelationCurve>(
-                    asof_, *baseCorrelationSpec, *loader_, *curveConfigs_, referenceData_);
+                boost::shared_ptr<BaseCorrelationCurve> baseCorrelationCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<BaseCorrelationCurve>(
+                        asof_, *baseCorrelationSpec, *loader_, *curveConfigs_, referenceData_);
+                });
                 itr =
                     requiredBaseCorrelationCurves_.insert(make_pair(baseCorrelationSpec->name(), baseCorrelationCurve))
                         .first;
@@ -569,8 +924,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredInflationCurves_.find(inflationspec->name());
             if (itr == requiredInflationCurves_.end()) {
                 DLOG("Building InflationCurve " << inflationspec->name() << " for asof " << asof_);
-                boost::shared_ptr<InflationCurve> inflationCurve = boost::make_shared<InflationCurve>(
-                    asof_, *inflationspec, *loader_, *curveConfigs_, requiredYieldCurves_, buildCalibrationInfo_);
+                boost::shared_ptr<InflationCurve> inflationCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<InflationCurve>(
+                        asof_, *inflationspec, *loader_, *curveConfigs_, requiredYieldCurves_, buildCalibrationInfo_);
+                });
                 itr = requiredInflationCurves_.insert(make_pair(inflationspec->name(), inflationCurve)).first;
                 calibrationInfo_->inflationCurveCalibrationInfo[inflationspec->name()] =
                     inflationCurve->calibrationInfo();
@@ -612,8 +969,11 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             if (itr == requiredInflationCapFloorVolCurves_.end()) {
                 DLOG("Building InflationCapFloorVolatilitySurface for asof " << asof_);
                 boost::shared_ptr<InflationCapFloorVolCurve> inflationCapFloorVolCurve =
-                    boost::make_shared<InflationCapFloorVolCurve>(asof_, *infcapfloorspec, *loader_, *curveConfigs_,
-                                                                  requiredYieldCurves_, requiredInflationCurves_);
+                    buildConcurrently(buildMutex_, [&]() {
+                        return boost::make_shared<InflationCapFloorVolCurve>(asof_, *infcapfloorspec, *loader_,
+                                                                             *curveConfigs_, requiredYieldCurves_,
+                                                                             requiredInflationCurves_);
+                    });
                 itr = requiredInflationCapFloorVolCurves_
                           .insert(make_pair(infcapfloorspec->name(), inflationCapFloorVolCurve))
                           .first;
@@ -642,8 +1002,10 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredEquityCurves_.find(equityspec->name());
             if (itr == requiredEquityCurves_.end()) {
                 DLOG("Building EquityCurve for asof " << asof_);
-                boost::shared_ptr<EquityCurve> equityCurve = boost::make_shared<EquityCurve>(
-                    asof_, *equityspec, *loader_, *curveConfigs_, requiredYieldCurves_, buildCalibrationInfo_);
+                boost::shared_ptr<EquityCurve> equityCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<EquityCurve>(
+                        asof_, *equityspec, *loader_, *curveConfigs_, requiredYieldCurves_, buildCalibrationInfo_);
+                });
                 itr = requiredEquityCurves_.insert(make_pair(equityspec->name(), equityCurve)).first;
                 calibrationInfo_->dividendCurveCalibrationInfo[equityspec->name()] = equityCurve->calibrationInfo();
             }
@@ -676,10 +1038,12 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
                 // In addition we should maybe specify the eqIndex name in the vol curve config explicitly
                 // instead of assuming that it has the same curve id as the vol curve to be build?
                 Handle<EquityIndex2> eqIndex = MarketImpl::equityCurve(eqvolspec->curveConfigID(), configuration);
-                boost::shared_ptr<EquityVolCurve> eqVolCurve = boost::make_shared<EquityVolCurve>(
-                    asof_, *eqvolspec, *loader_, *curveConfigs_, eqIndex, requiredEquityCurves_,
-                    requiredEquityVolCurves_, requiredFxVolCurves_, requiredCorrelationCurves_, this,
-                    buildCalibrationInfo_);
+                boost::shared_ptr<EquityVolCurve> eqVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<EquityVolCurve>(
+                        asof_, *eqvolspec, *loader_, *curveConfigs_, eqIndex, requiredEquityCurves_,
+                        requiredEquityVolCurves_, requiredFxVolCurves_, requiredCorrelationCurves_, this,
+                        buildCalibrationInfo_);
+                });
                 itr = requiredEquityVolCurves_.insert(make_pair(eqvolspec->name(), eqVolCurve)).first;
                 calibrationInfo_->eqVolCalibrationInfo[eqvolspec->name()] = eqVolCurve->calibrationInfo();
             }
@@ -709,8 +1073,9 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredSecurities_.find(securityspec->securityID());
             if (itr == requiredSecurities_.end()) {
                 DLOG("Building Securities for asof " << asof_);
-                boost::shared_ptr<Security> security =
-                    boost::make_shared<Security>(asof_, *securityspec, *loader_, *curveConfigs_);
+                boost::shared_ptr<Security> security = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<Security>(asof_, *securityspec, *loader_, *curveConfigs_);
+                });
                 itr = requiredSecurities_.insert(make_pair(securityspec->securityID(), security)).first;
             }
             DLOG("Adding Security (" << node.name << ") with spec " << *securityspec << " to configuration "
@@ -732,9 +1097,11 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredCommodityCurves_.find(commodityCurveSpec->name());
             if (itr == requiredCommodityCurves_.end()) {
                 DLOG("Building CommodityCurve " << commodityCurveSpec->name() << " for asof " << asof_);
-                boost::shared_ptr<CommodityCurve> commodityCurve =
-                    boost::make_shared<CommodityCurve>(asof_, *commodityCurveSpec, *loader_, *curveConfigs_, *fx_,
-                                                       requiredYieldCurves_, requiredCommodityCurves_, buildCalibrationInfo_);
+                boost::shared_ptr<CommodityCurve> commodityCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<CommodityCurve>(
+                        asof_, *commodityCurveSpec, *loader_, *curveConfigs_, *fx_, requiredYieldCurves_,
+                        requiredCommodityCurves_, buildCalibrationInfo_);
+                });
                 itr = requiredCommodityCurves_.insert(make_pair(commodityCurveSpec->name(), commodityCurve)).first;
             }
 
@@ -755,9 +1122,12 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredCommodityVolCurves_.find(commodityVolSpec->name());
             if (itr == requiredCommodityVolCurves_.end()) {
                 DLOG("Building commodity volatility for asof " << asof_);
-                boost::shared_ptr<CommodityVolCurve> commodityVolCurve = boost::make_shared<CommodityVolCurve>(
-                    asof_, *commodityVolSpec, *loader_, *curveConfigs_, requiredYieldCurves_, requiredCommodityCurves_,
-                    requiredCommodityVolCurves_, requiredFxVolCurves_, requiredCorrelationCurves_, this, buildCalibrationInfo_);
+                boost::shared_ptr<CommodityVolCurve> commodityVolCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<CommodityVolCurve>(
+                        asof_, *commodityVolSpec, *loader_, *curveConfigs_, requiredYieldCurves_,
+                        requiredCommodityCurves_, requiredCommodityVolCurves_, requiredFxVolCurves_,
+                        requiredCorrelationCurves_, this, buildCalibrationInfo_);
+                });
                 itr = requiredCommodityVolCurves_.insert(make_pair(commodityVolSpec->name(), commodityVolCurve)).first;
                 calibrationInfo_->commVolCalibrationInfo[commodityVolSpec->name()] = commodityVolCurve->calibrationInfo();
             }
@@ -785,9 +1155,12 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
             auto itr = requiredCorrelationCurves_.find(corrspec->name());
             if (itr == requiredCorrelationCurves_.end()) {
                 DLOG("Building CorrelationCurve for asof " << asof_);
-                boost::shared_ptr<CorrelationCurve> corrCurve = boost::make_shared<CorrelationCurve>(
-                    asof_, *corrspec, *loader_, *curveConfigs_, requiredSwapIndices_[configuration],
-                    requiredYieldCurves_, requiredGenericYieldVolCurves_);
+                auto& swapIndices = requiredSwapIndices_[configuration];
+                boost::shared_ptr<CorrelationCurve> corrCurve = buildConcurrently(buildMutex_, [&]() {
+                    return boost::make_shared<CorrelationCurve>(
+                        asof_, *corrspec, *loader_, *curveConfigs_, swapIndices, requiredYieldCurves_,
+                        requiredGenericYieldVolCurves_);
+                });
                 itr = requiredCorrelationCurves_.insert(make_pair(corrspec->name(), corrCurve)).first;
             }
 
@@ -37,8 +37,10 @@
 #include <boost/graph/graph_traits.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
 #include <map>
+#include <set>
 
 namespace ore {
 namespace data {
@@ -75,6 +77,13 @@ class CorrelationCurve;
   Today's market's purpose is t0 pricing, the Simulation Market's purpose is
   pricing under future scenarios.
 
+  If more than one thread is given and the market is not built lazily, the objects of each configuration are built
+  in parallel: an object is scheduled on a worker thread as soon as all objects it depends on are built, so that the
+  build time is driven by the longest path in the dependency graph rather than by the number of objects. The market
+  maps are updated by one worker at a time, the curve builders run concurrently. This requires a QuantLib build with
+  QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, otherwise the objects are built sequentially, and a loader that supports
+  concurrent calls of its const methods, as the in-memory loaders do.
+
   \ingroup marketdata
  */
 class TodaysMarket : public MarketImpl {
@@ -103,10 +112,38 @@ public:
         //! build calibration info?
         const bool buildCalibrationInfo = true,
         //! support pseudo currencies
-        const bool handlePseudoCurrencies = true);
+        const bool handlePseudoCurrencies = true,
+        //! number of threads to build the market objects of a configuration in parallel
+        const Size nThreads = 1);
 
     boost::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo() const { return calibrationInfo_; }
 
+    /*! Rebuild the market objects that depend on the given quotes after their values have changed. The loader of the
+        market must return the new values, e.g. because the values of the quotes of its market data were set. An
+        object is rebuilt if its curve configuration contains one of the quotes, FX spots are rebuilt if the quote of
+        the pair or the inverse pair has changed, and all objects depending on a rebuilt object are rebuilt as well.
+
+        The handles of rebuilt yield curves are relinked to the new curves, so that objects built on the market, e.g.
+        a portfolio, see the new curves without being rebuilt. Other rebuilt objects replace the existing ones in the
+        market, objects holding the previous ones have to be rebuilt to see them.
+
+        Returns the names of the curve specs of the rebuilt objects. */
+    std::set<std::string> update(const std::set<std::string>& changedQuotes);
+
+    /*! The market parameters restricted to the objects that were built. In a lazily built market these are the
+        objects requested from the market, e.g. by the engine builders of a portfolio or by a simulation market, and
+        the objects they depend on. The result can be written to a todaysmarket.xml that builds only the objects
+        required for the same usage in a next run. */
+    boost::shared_ptr<TodaysMarketParameters> usedMarketParameters() const;
+
+    //! The number of market objects built so far
+    Size numberOfBuiltObjects() const;
+
+    /*! An estimate of the memory held by the market in bytes, this is the increase of the process memory while the
+        market objects were built in the constructor. It is only measured if the MemoryAccounting is enabled, objects
+        built lazily after the construction are not included. */
+    std::size_t memoryFootprint() const { return initialiseMemory_; }
+
 private:
     // MarketImpl interface
     void require(const MarketObject o, const string& name, const string& configuration,
@@ -125,6 +162,8 @@ private:
     const boost::shared_ptr<ReferenceDataManager> referenceData_;
     const IborFallbackConfig iborFallbackConfig_;
     const bool buildCalibrationInfo_;
+    const Size nThreads_;
+    std::size_t initialiseMemory_ = 0;
 
     // initialise market
     void initialise(const Date& asof);
@@ -142,6 +181,15 @@ private:
     // build a single market object
     void buildNode(const std::string& configuration, Node& node) const;
 
+    // build all market objects of a configuration along the dependency graph on nThreads_ worker threads
+    void buildNodesParallel(const std::string& configuration, Graph& g, map<string, string>& buildErrors) const;
+
+    // yield curves of the previous build that are rebuilt in update(), the new curves take over their handles
+    mutable map<string, boost::shared_ptr<YieldCurve>> previousYieldCurves_;
+
+    // held exclusively by a worker of the parallel build while it updates the maps, shared during the curve builds
+    mutable boost::shared_mutex buildMutex_;
+
     // calibration results
     boost::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo_;
 
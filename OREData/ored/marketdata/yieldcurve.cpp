@@ -61,6 +61,7 @@
 #include <qle/termstructures/iborfallbackcurve.hpp>
 #include <qle/termstructures/bondyieldshiftedcurvetermstructure.hpp>
 
+#include <ored/marketdata/calibratedcurvecache.hpp>
 #include <ored/marketdata/defaultcurve.hpp>
 #include <ored/marketdata/fittedbondcurvehelpermarket.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
@@ -74,6 +75,8 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <boost/functional/hash.hpp>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -333,6 +336,18 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
     Real maxFactor = curveConfig_->bootstrapConfig().maxFactor();
     Real minFactor = curveConfig_->bootstrapConfig().minFactor();
     Size dontThrowSteps = curveConfig_->bootstrapConfig().dontThrowSteps();
+    bool globalNewton = curveConfig_->bootstrapConfig().globalNewton();
+
+    // warm start from the last calibration of the curve in the calibrated curve cache, if any
+    vector<Date> warmStartDates;
+    vector<Real> warmStartValues;
+    if (curveConfig_->bootstrapConfig().warmStart()) {
+        if (auto c = CalibratedCurveCache::instance().get(curveSpec_.name())) {
+            DLOG("Warm start of YieldCurve " << curveSpec_.name() << " from the calibrated curve cache");
+            warmStartDates = c->dates;
+            warmStartValues = c->values;
+        }
+    }
 
     // See comment here: https://github.com/lballabio/QuantLib/pull/679#issuecomment-525208897
     // to explain all the typedefs below. Waiting on a pull request from QuantLib here.
@@ -346,7 +361,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Linear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::LogLinear: {
             typedef PiecewiseYieldCurve<ZeroYield, LogLinear, QuantExt::IterativeBootstrap> my_curve;
@@ -354,7 +370,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, LogLinear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::NaturalCubic: {
             typedef PiecewiseYieldCurve<ZeroYield, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -362,7 +379,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Kruger, true),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::FinancialCubic: {
             typedef PiecewiseYieldCurve<ZeroYield, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -372,7 +390,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                 Cubic(CubicInterpolation::Kruger, true, CubicInterpolation::SecondDerivative, 0.0,
                       CubicInterpolation::FirstDerivative),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::ConvexMonotone: {
             typedef PiecewiseYieldCurve<ZeroYield, ConvexMonotone, QuantExt::IterativeBootstrap> my_curve;
@@ -380,7 +399,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, ConvexMonotone(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::Hermite: {
              typedef PiecewiseYieldCurve<ZeroYield, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -388,7 +408,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Parabolic),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::CubicSpline: {
              typedef PiecewiseYieldCurve<ZeroYield, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -397,7 +418,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                  asofDate_, instruments, zeroDayCounter_,
                  Cubic(CubicInterpolation::Spline, false, CubicInterpolation::SecondDerivative, 0.0, CubicInterpolation::SecondDerivative, 0.0),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::Quadratic: {
              typedef PiecewiseYieldCurve<ZeroYield, QuantExt::Quadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -406,7 +428,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                  boost::make_shared<my_curve>(
  					asofDate_, instruments, zeroDayCounter_, QuantExt::Quadratic(1, 0, 1, 0, 1),
  					QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
- 														   minFactor, dontThrowSteps));
+ 														   minFactor, dontThrowSteps, globalNewton, warmStartDates,
+ 														   warmStartValues));
          } break;
          case InterpolationMethod::LogQuadratic: {
              typedef PiecewiseYieldCurve<ZeroYield, QuantExt::LogQuadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -414,7 +437,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, QuantExt::LogQuadratic(1, 0, -1, 0, 1),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
         default:
             QL_FAIL("Interpolation method not recognised.");
@@ -428,7 +452,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Linear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::LogLinear: {
             typedef PiecewiseYieldCurve<Discount, LogLinear, QuantExt::IterativeBootstrap> my_curve;
@@ -436,7 +461,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, LogLinear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::NaturalCubic: {
             typedef PiecewiseYieldCurve<Discount, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -444,7 +470,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Kruger, true),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::FinancialCubic: {
             typedef PiecewiseYieldCurve<Discount, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -454,7 +481,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                 Cubic(CubicInterpolation::Kruger, true, CubicInterpolation::SecondDerivative, 0.0,
                       CubicInterpolation::FirstDerivative),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::ConvexMonotone: {
             typedef PiecewiseYieldCurve<Discount, ConvexMonotone, QuantExt::IterativeBootstrap> my_curve;
@@ -462,7 +490,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, ConvexMonotone(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::Hermite: {
              typedef PiecewiseYieldCurve<Discount, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -470,7 +499,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Parabolic),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::CubicSpline: {
              typedef PiecewiseYieldCurve<Discount, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -480,7 +510,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                  Cubic(CubicInterpolation::Spline, false, CubicInterpolation::SecondDerivative, 0.0,
                        CubicInterpolation::SecondDerivative, 0.0),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::Quadratic: {
              typedef PiecewiseYieldCurve<Discount, QuantExt::Quadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -489,7 +520,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                  boost::make_shared<my_curve>(
  					asofDate_, instruments, zeroDayCounter_, QuantExt::Quadratic(1, 0, 1, 0, 1),
  					QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
- 														   minFactor, dontThrowSteps));
+ 														   minFactor, dontThrowSteps, globalNewton, warmStartDates,
+ 														   warmStartValues));
          } break;
          case InterpolationMethod::LogQuadratic: {
              typedef PiecewiseYieldCurve<Discount, QuantExt::LogQuadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -497,7 +529,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, QuantExt::LogQuadratic(1, 0, -1, 0, 1),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
         default:
             QL_FAIL("Interpolation method not recognised.");
@@ -511,7 +544,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Linear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::LogLinear: {
             typedef PiecewiseYieldCurve<ForwardRate, LogLinear, QuantExt::IterativeBootstrap> my_curve;
@@ -519,7 +553,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, LogLinear(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::NaturalCubic: {
             typedef PiecewiseYieldCurve<ForwardRate, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -527,7 +562,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Kruger, true),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::FinancialCubic: {
             typedef PiecewiseYieldCurve<ForwardRate, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -537,7 +573,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                 Cubic(CubicInterpolation::Kruger, true, CubicInterpolation::SecondDerivative, 0.0,
                       CubicInterpolation::FirstDerivative),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::ConvexMonotone: {
             typedef PiecewiseYieldCurve<ForwardRate, ConvexMonotone, QuantExt::IterativeBootstrap> my_curve;
@@ -545,7 +582,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
             yieldts = boost::make_shared<my_curve>(
                 asofDate_, instruments, zeroDayCounter_, ConvexMonotone(),
                 QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                       minFactor, dontThrowSteps));
+                                                       minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                       warmStartValues));
         } break;
         case InterpolationMethod::Hermite: {
              typedef PiecewiseYieldCurve<ForwardRate, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -553,7 +591,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, Cubic(CubicInterpolation::Parabolic),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::CubicSpline: {
              typedef PiecewiseYieldCurve<ForwardRate, Cubic, QuantExt::IterativeBootstrap> my_curve;
@@ -563,7 +602,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
                  Cubic(CubicInterpolation::Spline, false, CubicInterpolation::SecondDerivative, 0.0,
                        CubicInterpolation::SecondDerivative, 0.0),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::Quadratic: {
              typedef PiecewiseYieldCurve<ForwardRate, QuantExt::Quadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -571,7 +611,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, QuantExt::Quadratic(1, 0, 1, 0, 1),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
          case InterpolationMethod::LogQuadratic: {
              typedef PiecewiseYieldCurve<ForwardRate, QuantExt::LogQuadratic, QuantExt::IterativeBootstrap> my_curve;
@@ -579,7 +620,8 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
              yieldts = boost::make_shared<my_curve>(
                  asofDate_, instruments, zeroDayCounter_, QuantExt::LogQuadratic(1, 0, -1, 0, 1),
                  QuantExt::IterativeBootstrap<my_curve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                        minFactor, dontThrowSteps));
+                                                        minFactor, dontThrowSteps, globalNewton, warmStartDates,
+                                                        warmStartValues));
          } break;
         default:
             QL_FAIL("Interpolation method not recognised.");
@@ -614,14 +656,16 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
         }
         zeros[0] = zeros[1];
         forwards[0] = forwards[1];
+        nodeDates_ = dates;
         if (interpolationVariable_ == InterpolationVariable::Zero)
-            p_ = zerocurve(dates, zeros, zeroDayCounter_, interpolationMethod_);
+            nodeValues_ = zeros;
         else if (interpolationVariable_ == InterpolationVariable::Discount)
-            p_ = discountcurve(dates, discounts, zeroDayCounter_, interpolationMethod_);
+            nodeValues_ = discounts;
         else if (interpolationVariable_ == InterpolationVariable::Forward)
-            p_ = forwardcurve(dates, forwards, zeroDayCounter_, interpolationMethod_);
+            nodeValues_ = forwards;
         else
             QL_FAIL("Interpolation variable not recognised.");
+        p_ = nodeCurve(nodeDates_, nodeValues_);
     }
 
     // set calibration info
@@ -635,6 +679,56 @@ YieldCurve::piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments) {
     return p_;
 }
 
+boost::shared_ptr<YieldTermStructure> YieldCurve::nodeCurve(const vector<Date>& dates,
+                                                            const vector<Real>& values) const {
+    if (interpolationVariable_ == InterpolationVariable::Zero)
+        return zerocurve(dates, values, zeroDayCounter_, interpolationMethod_);
+    else if (interpolationVariable_ == InterpolationVariable::Discount)
+        return discountcurve(dates, values, zeroDayCounter_, interpolationMethod_);
+    else if (interpolationVariable_ == InterpolationVariable::Forward)
+        return forwardcurve(dates, values, zeroDayCounter_, interpolationMethod_);
+    else
+        QL_FAIL("Interpolation variable not recognised.");
+}
+
+std::size_t YieldCurve::bootstrapFingerprint(vector<boost::shared_ptr<RateHelper>> instruments) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, asofDate_.serialNumber());
+
+    // configuration, including the conventions of the segments
+    boost::hash_combine(seed, curveConfig_->toXMLString());
+    const boost::shared_ptr<Conventions>& conventions = InstrumentConventions::instance().conventions();
+    for (auto const& s : curveSegments_) {
+        if (!s->conventionsID().empty() && conventions->has(s->conventionsID()))
+            boost::hash_combine(seed, conventions->get(s->conventionsID())->toXMLString());
+        // the fx spot is not part of the quotes of the cross currency helpers
+        auto ccySegment = boost::dynamic_pointer_cast<CrossCcyYieldCurveSegment>(s);
+        if (ccySegment && !ccySegment->spotRateID().empty())
+            boost::hash_combine(seed, getFxSpotQuote(ccySegment->spotRateID())->quote()->value());
+    }
+
+    // quotes and pillars of the instruments in bootstrap order
+    std::sort(instruments.begin(), instruments.end(), QuantLib::detail::BootstrapHelperSorter());
+    for (auto const& h : instruments) {
+        boost::hash_combine(seed, h->pillarDate().serialNumber());
+        boost::hash_combine(seed, h->quote()->value());
+    }
+
+    // the curves this curve depends on, via their discount factors on the default calibration pillars
+    const set<string>& required =
+        static_cast<const CurveConfig&>(*curveConfig_).requiredCurveIds(CurveSpec::CurveType::Yield);
+    for (auto const& c : requiredYieldCurves_) {
+        if (c.second->curveSpec().curveConfigID() != curveConfig_->discountCurveID() &&
+            required.find(c.second->curveSpec().curveConfigID()) == required.end())
+            continue;
+        boost::hash_combine(seed, c.first);
+        for (auto const& p : YieldCurveCalibrationInfo::defaultPeriods)
+            boost::hash_combine(seed, c.second->handle()->discount(asofDate_ + p, true));
+    }
+
+    return seed;
+}
+
 void YieldCurve::buildZeroCurve() {
 
     QL_REQUIRE(curveSegments_.size() <= 1, "More than one zero curve "
@@ -1018,7 +1112,33 @@ void YieldCurve::buildBootstrappedCurve() {
     /* Build the bootstrapped curve from the instruments. */
     QL_REQUIRE(instruments.size() > 0,
                "Empty instrument list for date = " << io::iso_date(asofDate_) << " and curve = " << curveSpec_.name());
+
+    /* Restore the curve from the calibrated curve cache if its configuration and inputs are unchanged. */
+    CalibratedCurveCache& cache = CalibratedCurveCache::instance();
+    bool useCache = cache.enabled() && !preserveQuoteLinkage_;
+    std::size_t fingerprint = 0;
+    if (useCache) {
+        fingerprint = bootstrapFingerprint(instruments);
+        if (auto c = cache.get(curveSpec_.name(), fingerprint)) {
+            DLOG("Restoring YieldCurve " << curveSpec_.name() << " from the calibrated curve cache");
+            p_ = nodeCurve(c->dates, c->values);
+            if (buildCalibrationInfo_) {
+                calibrationInfo_ = boost::make_shared<PiecewiseYieldCurveCalibrationInfo>();
+                calibrationInfo_->pillarDates.assign(c->dates.begin() + 1, c->dates.end());
+            }
+            return;
+        }
+    }
+
     p_ = piecewisecurve(instruments);
+
+    if (useCache) {
+        auto c = boost::make_shared<CalibratedCurve>();
+        c->fingerprint = fingerprint;
+        c->dates = nodeDates_;
+        c->values = nodeValues_;
+        cache.add(curveSpec_.name(), c);
+    }
 }
 
 void YieldCurve::buildDiscountRatioCurve() {
@@ -118,6 +118,13 @@ public:
     boost::shared_ptr<YieldCurveCalibrationInfo> calibrationInfo() const { return calibrationInfo_; }
     //@}
 
+    /*! Link the handle of a previous build of the curve to this curve and use it as the handle of this curve, so that
+        the objects built on the previous handle see this curve */
+    void takeOverHandle(const YieldCurve& previous) {
+        h_ = previous.h_;
+        h_.linkTo(p_);
+    }
+
 private:
     Date asofDate_;
     Currency currency_;
@@ -166,6 +173,13 @@ private:
     const Market* market_;
 
     boost::shared_ptr<YieldTermStructure> piecewisecurve(vector<boost::shared_ptr<RateHelper>> instruments);
+    // node dates and values of the interpolation variable of a bootstrapped curve not linked to the quotes
+    vector<Date> nodeDates_;
+    vector<Real> nodeValues_;
+    //! Build the curve from node values of the interpolation variable, as for the bootstrapped curves
+    boost::shared_ptr<YieldTermStructure> nodeCurve(const vector<Date>& dates, const vector<Real>& values) const;
+    //! Fingerprint of the configuration and the inputs of the bootstrap, see CalibratedCurveCache
+    std::size_t bootstrapFingerprint(vector<boost::shared_ptr<RateHelper>> instruments);
 
     /* Functions to build RateHelpers from yield curve segments */
     void addDeposits(const boost::shared_ptr<YieldCurveSegment>& segment,
@@ -61,6 +61,11 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+
 using QuantExt::AnalyticJyCpiCapFloorEngine;
 using QuantExt::AnalyticJyYoYCapFloorEngine;
 using QuantExt::CpiCapFloorHelper;
@@ -75,19 +80,60 @@ using std::vector;
 namespace ore {
 namespace data {
 
+namespace {
+/* Run independent calibration jobs on up to nThreads threads. The exception of the first failing job (in the order of
+   the jobs) is rethrown after all jobs are finished, so that the outcome does not depend on the scheduling. */
+void runCalibrations(const std::string& stage, const std::vector<std::function<void()>>& jobs, Size nThreads) {
+    if (nThreads > 1 && jobs.size() > 1) {
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN) || defined(QL_ENABLE_SESSIONS)
+        WLOG("CrossAssetModelBuilder: parallel " << stage << " calibration with " << nThreads
+                                                 << " threads requires a QuantLib build with "
+                                                    "QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without "
+                                                    "QL_ENABLE_SESSIONS, calibrate sequentially");
+        nThreads = 1;
+#endif
+    }
+    Size nWorkers = std::max<Size>(1, std::min(nThreads, jobs.size()));
+    if (nWorkers > 1)
+        DLOG("CrossAssetModelBuilder: run " << jobs.size() << " " << stage << " calibrations on " << nWorkers
+                                            << " threads");
+    std::vector<std::exception_ptr> errors(jobs.size());
+    std::atomic<Size> next(0);
+    auto worker = [&jobs, &errors, &next]() {
+        for (Size i = next++; i < jobs.size(); i = next++) {
+            try {
+                jobs[i]();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (Size w = 1; w < nWorkers; ++w)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+} // namespace
+
 CrossAssetModelBuilder::CrossAssetModelBuilder(
     const boost::shared_ptr<ore::data::Market>& market, const boost::shared_ptr<CrossAssetModelData>& config,
     const std::string& configurationLgmCalibration, const std::string& configurationFxCalibration,
     const std::string& configurationEqCalibration, const std::string& configurationInfCalibration,
     const std::string& configurationCrCalibration, const std::string& configurationFinalModel, const bool dontCalibrate,
-    const bool continueOnError, const std::string& referenceCalibrationGrid, const SalvagingAlgorithm::Type salvaging)
+    const bool continueOnError, const std::string& referenceCalibrationGrid, const SalvagingAlgorithm::Type salvaging,
+    const Size nThreads)
     : market_(market), config_(config), configurationLgmCalibration_(configurationLgmCalibration),
       configurationFxCalibration_(configurationFxCalibration), configurationEqCalibration_(configurationEqCalibration),
       configurationInfCalibration_(configurationInfCalibration),
       configurationCrCalibration_(configurationCrCalibration),
       configurationComCalibration_(Market::defaultConfiguration), configurationFinalModel_(configurationFinalModel),
       dontCalibrate_(dontCalibrate), continueOnError_(continueOnError),
-      referenceCalibrationGrid_(referenceCalibrationGrid), salvaging_(salvaging),
+      referenceCalibrationGrid_(referenceCalibrationGrid), salvaging_(salvaging), nThreads_(nThreads),
       optimizationMethod_(boost::shared_ptr<OptimizationMethod>(new LevenbergMarquardt(1E-8, 1E-8, 1E-8))),
       endCriteria_(EndCriteria(1000, 500, 1E-8, 1E-8, 1E-8)) {
     buildModel();
@@ -229,9 +275,11 @@ void CrossAssetModelBuilder::buildModel() const {
         
         if (auto ir = boost::dynamic_pointer_cast<IrLgmData>(irConfig)) {
         
+            // the IR components are calibrated in parallel already, the remaining threads price the baskets
+            Size calibrationThreads = std::max<Size>(1, nThreads_ / std::max<Size>(1, config_->irConfigs().size()));
             auto builder = boost::make_shared<LgmBuilder>(market_, ir, configurationLgmCalibration_,
-                                                   config_->bootstrapTolerance(),
-                                               continueOnError_, referenceCalibrationGrid_);
+                                                          config_->bootstrapTolerance(), continueOnError_,
+                                                          referenceCalibrationGrid_, false, false, calibrationThreads);
             if (dontCalibrate_)
                 builder->freeze();
             lgmBuilder.push_back(builder);
@@ -460,16 +508,24 @@ void CrossAssetModelBuilder::buildModel() const {
      * Calibrate IR components
      */
 
+    // the IR builders calibrate their own models to their own baskets, so they can run concurrently
+    std::vector<std::function<void()>> irCalibrations;
     for (Size i = 0; i < lgmBuilder.size(); i++) {
-        DLOG("IR Calibration " << i);
-        swaptionCalibrationErrors_[i] = lgmBuilder[i]->error();
+        irCalibrations.push_back([this, &lgmBuilder, i]() {
+            DLOG("IR Calibration " << i);
+            swaptionCalibrationErrors_[i] = lgmBuilder[i]->error();
+        });
     }
 
     for (Size i = 0; i < hwBuilder.size(); i++) {
-        DLOG("IR Calibration " << i);
-        swaptionCalibrationErrors_[i] = hwBuilder[i]->error();
+        irCalibrations.push_back([this, &hwBuilder, i]() {
+            DLOG("IR Calibration " << i);
+            swaptionCalibrationErrors_[i] = hwBuilder[i]->error();
+        });
     }
 
+    runCalibrations("IR", irCalibrations, nThreads_);
+
     /*************************
      * Relink LGM discount curves to curves used for FX calibration
      */
@@ -603,10 +659,15 @@ void CrossAssetModelBuilder::buildModel() const {
      * Calibrate COM components
      */
 
+    std::vector<std::function<void()>> comCalibrations;
     for (Size i = 0; i < csBuilder.size(); i++) {
-        DLOG("COM Calibration " << i);
-        comOptionCalibrationErrors_[i] = csBuilder[i]->error();
+        comCalibrations.push_back([this, &csBuilder, i]() {
+            DLOG("COM Calibration " << i);
+            comOptionCalibrationErrors_[i] = csBuilder[i]->error();
+        });
     }
+
+    runCalibrations("COM", comCalibrations, nThreads_);
     
     /*************************
      * Relink LGM discount curves to curves used for INF calibration
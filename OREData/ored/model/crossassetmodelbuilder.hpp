@@ -50,6 +50,11 @@ using namespace QuantLib;
   passed to the constructor), and a model configuration (passed to
   the "build" member function) to build and calibrate a cross asset model.
 
+  The IR components and the COM components are calibrated by independent builders and run on up to nThreads threads,
+  this requires a QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without QL_ENABLE_SESSIONS and a
+  market that is not built lazily. The FX, EQ and INF components are calibrated on the cross asset model itself and
+  therefore sequentially, after the IR components.
+
   \ingroup models
  */
 class CrossAssetModelBuilder : public QuantExt::ModelBuilder {
@@ -82,7 +87,9 @@ public:
         //! reference calibration grid
         const std::string& referenceCalibrationGrid_ = "",
 	//! salvaging algorithm to apply to correlation matrix
-	const SalvagingAlgorithm::Type salvaging = SalvagingAlgorithm::None);
+	const SalvagingAlgorithm::Type salvaging = SalvagingAlgorithm::None,
+        //! number of threads to calibrate the IR and COM components on, see below
+        const QuantLib::Size nThreads = 1);
 
     //! Default destructor
     ~CrossAssetModelBuilder() {}
@@ -138,6 +145,7 @@ private:
     const bool continueOnError_;
     const std::string referenceCalibrationGrid_;
     const SalvagingAlgorithm::Type salvaging_;
+    const QuantLib::Size nThreads_;
 
     // TODO: Move CalibrationErrorType, optimizer and end criteria parameters to data
     boost::shared_ptr<OptimizationMethod> optimizationMethod_;
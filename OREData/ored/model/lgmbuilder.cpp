@@ -164,10 +164,11 @@ namespace data {
 
 LgmBuilder::LgmBuilder(const boost::shared_ptr<ore::data::Market>& market, const boost::shared_ptr<IrLgmData>& data,
                        const std::string& configuration, const Real bootstrapTolerance, const bool continueOnError,
-                       const std::string& referenceCalibrationGrid, const bool setCalibrationInfo)
+                       const std::string& referenceCalibrationGrid, const bool setCalibrationInfo,
+                       const bool warmStart, const Size calibrationThreads)
     : market_(market), configuration_(configuration), data_(data), bootstrapTolerance_(bootstrapTolerance),
       continueOnError_(continueOnError), referenceCalibrationGrid_(referenceCalibrationGrid),
-      setCalibrationInfo_(setCalibrationInfo),
+      setCalibrationInfo_(setCalibrationInfo), warmStart_(warmStart), calibrationThreads_(calibrationThreads),
       optimizationMethod_(boost::shared_ptr<OptimizationMethod>(new LevenbergMarquardt(1E-8, 1E-8, 1E-8))),
       endCriteria_(EndCriteria(1000, 500, 1E-8, 1E-8, 1E-8)),
       calibrationErrorType_(BlackCalibrationHelper::RelativePriceError) {
@@ -280,6 +281,8 @@ LgmBuilder::LgmBuilder(const boost::shared_ptr<ore::data::Market>& market, const
     DLOG("lambda times size: " << hTimes.size());
 
     model_ = boost::make_shared<QuantExt::LGM>(parametrization_);
+    // each swaption helper gets its own engine in performCalculations(), so the basket can be priced concurrently
+    model_->setCalibrationThreads(calibrationThreads_);
     params_ = model_->params();
 }
 
@@ -339,8 +342,14 @@ void LgmBuilder::performCalculations() const {
         swaptionBasket_[j]->update();
     }
 
-    // reset model parameters to ensure identical results on identical market data input
-    model_->setParams(params_);
+    // reset model parameters to ensure identical results on identical market data input, unless we start from the
+    // last successful calibration
+    if (warmStart_ && !calibratedParams_.empty()) {
+        DLOG("Start calibration from the parameters of the last successful calibration");
+        model_->setParams(calibratedParams_);
+    } else {
+        model_->setParams(params_);
+    }
     parametrization_->shift() = 0.0;
     parametrization_->scaling() = 1.0;
 
@@ -378,8 +387,10 @@ void LgmBuilder::performCalculations() const {
     calibrationInfo.rmse = error_;
     if (fabs(error_) < bootstrapTolerance_ ||
         (data_->calibrationType() == CalibrationType::BestFit && error_ != QL_MAX_REAL)) {
+        if (warmStart_)
+            calibratedParams_ = model_->params();
         // we check the log level here to avoid unnecessary computations
-        if (Log::instance().filter(ORE_DATA) || setCalibrationInfo_) {
+        if (ORE_LOG_ACTIVE(ORE_DATA) || setCalibrationInfo_) {
             TLOGGERSTREAM("Basket details:");
             try {
 		auto d = getBasketDetails(calibrationInfo);
@@ -49,11 +49,19 @@ class LgmBuilder : public QuantExt::ModelBuilder {
 public:
     /*! The configuration should refer to the calibration configuration here,
       alternative discounting curves are then usually set in the pricing
-      engines for swaptions etc. */
+      engines for swaptions etc.
+
+      If warmStart is true, a recalibration starts from the parameters of the last successful calibration instead of
+      the initial parameters, e.g. for the scenarios of a sensitivity run. The results then depend slightly on the
+      order of the calibrations.
+
+      The swaption basket is priced on calibrationThreads threads in each step of a global calibration, see
+      QuantExt::LinkableCalibratedModel::setCalibrationThreads(). */
     LgmBuilder(const boost::shared_ptr<ore::data::Market>& market, const boost::shared_ptr<IrLgmData>& data,
                const std::string& configuration = Market::defaultConfiguration, Real bootstrapTolerance = 0.001,
                const bool continueOnError = false, const std::string& referenceCalibrationGrid = "",
-               const bool setCalibrationInfo = false);
+               const bool setCalibrationInfo = false, const bool warmStart = false,
+               const Size calibrationThreads = 1);
     //! Return calibration error
     Real error() const;
 
@@ -93,12 +101,16 @@ private:
     const bool continueOnError_;
     const std::string referenceCalibrationGrid_;
     const bool setCalibrationInfo_;
+    const bool warmStart_;
+    const Size calibrationThreads_;
     bool requiresCalibration_ = false;
     std::string currency_; // derived from data->qualifier()
 
     mutable Real error_;
     mutable boost::shared_ptr<QuantExt::LGM> model_;
     mutable Array params_;
+    // the parameters of the last successful calibration, if warm start is enabled
+    mutable Array calibratedParams_;
     mutable boost::shared_ptr<QuantExt::IrLgm1fParametrization> parametrization_;
 
     // which swaptions in data->optionExpries() are actually in the basket?
@@ -33,11 +33,13 @@
 #include <ored/configuration/yieldvolcurveconfig.hpp>
 #include <ored/marketdata/adjustmentfactors.hpp>
 #include <ored/marketdata/basecorrelationcurve.hpp>
+#include <ored/marketdata/calibratedcurvecache.hpp>
 #include <ored/marketdata/capfloorvolcurve.hpp>
 #include <ored/marketdata/cdsvolcurve.hpp>
 #include <ored/marketdata/clonedloader.hpp>
 #include <ored/marketdata/commoditycurve.hpp>
 #include <ored/marketdata/commodityvolcurve.hpp>
+#include <ored/marketdata/compactloader.hpp>
 #include <ored/marketdata/compositeloader.hpp>
 #include <ored/marketdata/correlationcurve.hpp>
 #include <ored/marketdata/csvloader.hpp>
@@ -316,6 +318,7 @@
 #include <ored/utilities/initbuilders.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/marketdata.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
 #include <ored/utilities/osutils.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/progressbar.hpp>
@@ -325,7 +328,9 @@
 #include <ored/utilities/strike.hpp>
 #include <ored/utilities/timeperiod.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ored/utilities/wildcard.hpp>
+#include <ored/utilities/xmlconfigurationcache.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ored/version.hpp>
@@ -24,14 +24,84 @@
 #pragma once
 
 #include <ored/portfolio/enginefactory.hpp>
+#include <ored/utilities/parsers.hpp>
 
 #include <ql/cashflows/couponpricer.hpp>
 #include <ql/cashflows/inflationcouponpricer.hpp>
 #include <qle/cashflows/cpicouponpricer.hpp>
 
+#include <boost/algorithm/string/join.hpp>
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <mutex>
+#include <tuple>
+#include <typeinfo>
+
 namespace ore {
 namespace data {
 
+//! Process wide cache of engines or coupon pricers shared between CachingEngineBuilder instances
+/*! The entries are keyed by the builder (its type, model, engine and trade types), the market, the configurations
+    and parameters the builder is initialised with and the builder's own cache key. An entry is only returned for the
+    market it was built on, entries of markets that do not exist any more are removed when new entries are added.
+    There is one cache per key and engine type. */
+template <class T, class U> class SharedEngineCache {
+public:
+    typedef std::tuple<const Market*, std::string, map<MarketContext, string>, map<string, string>,
+                       map<string, string>, map<string, string>, T>
+        Key;
+    struct Entry {
+        boost::weak_ptr<Market> market;
+        boost::shared_ptr<U> engine;
+        //! the model builders registered while building the engine
+        set<std::pair<string, boost::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders;
+    };
+
+    static SharedEngineCache& instance() {
+        static SharedEngineCache cache;
+        return cache;
+    }
+
+    //! look up an entry for market, returns false if there is none
+    bool get(const Key& key, const boost::shared_ptr<Market>& market, Entry& entry) const {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || it->second.market.lock() != market)
+            return false;
+        entry = it->second;
+        return true;
+    }
+
+    //! add an entry, an existing entry for the key is replaced
+    void add(const Key& key, const Entry& entry) {
+        boost::unique_lock<boost::shared_mutex> lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second.market.expired())
+                it = entries_.erase(it);
+            else
+                ++it;
+        }
+        entries_[key] = entry;
+    }
+
+    void clear() {
+        boost::unique_lock<boost::shared_mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+    Size size() const {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    SharedEngineCache() {}
+    mutable boost::shared_mutex mutex_;
+    map<Key, Entry> entries_;
+};
+
 //! Abstract template EngineBuilder class that can cache engines and coupon pricers
 /*! Subclasses must implement two protected methods:
  *  - keyImpl() returns a key that is used to cache
@@ -46,6 +116,20 @@ namespace data {
  *  The remaining variable arguments are to be passed to engine() and
  *  engineImpl(), these are the specific parameters required to build
  *  an engine or coupon pricer for this trade type.
+ *
+ *  If the market records the requested market objects (see Market::recordingRequests()), the requests made while
+ *  an engine is built are stored with the engine and recorded again whenever the cached engine is returned, so
+ *  that they are attributed to every trade using the engine.
+ *
+ *  The cache is guarded by a mutex, so that engine() can be called by several threads, see Portfolio::build(). An
+ *  engine is built once per key, the threads requesting the same key wait for the first build to finish.
+ *
+ *  If the global parameter ShareEngines is true, the engines are also looked up in and added to the process wide
+ *  SharedEngineCache, so that the builders of different engine factories on the same market, e.g. the factories of
+ *  several threads sharing the market or the factories of subsequent analytics, build and calibrate an engine only
+ *  once. The model builders of a shared engine are registered with each builder using it. The engines are shared as
+ *  they are, so the users of a market must not calculate a shared engine at the same time. The shared cache is not
+ *  used while the market records the requested market objects.
     \ingroup builders
  */
 template <class T, class U, typename... Args> class CachingEngineBuilder : public EngineBuilder {
@@ -60,23 +144,86 @@ public:
 
     //! Return a PricingEngine or a FloatingRateCouponPricer
     boost::shared_ptr<U> engine(Args... params) {
+        std::lock_guard<std::recursive_mutex> lock(cacheMutex_);
         T key = keyImpl(params...);
-        if (engines_.find(key) == engines_.end()) {
+        bool record = market_ && market_->recordingRequests();
+        if (engines_.find(key) == engines_.end() && market_ && !record && shareEngines()) {
+            typename SharedEngineCache<T, U>::Key sharedKey(market_.get(), typeid(*this).name() + model_ + engine_ +
+                                                                             boost::algorithm::join(tradeTypes_, ","),
+                                                            configurations_, modelParameters_, engineParameters_,
+                                                            globalParameters_, key);
+            typename SharedEngineCache<T, U>::Entry entry;
+            if (SharedEngineCache<T, U>::instance().get(sharedKey, market_, entry)) {
+                modelBuilders_.insert(entry.modelBuilders.begin(), entry.modelBuilders.end());
+                engines_[key] = entry.engine;
+            } else {
+                auto modelBuilders = modelBuilders_;
+                boost::shared_ptr<U> engine = engineImpl(params...);
+                engines_[key] = engine;
+                entry.market = market_;
+                entry.engine = engine;
+                for (auto const& m : modelBuilders_)
+                    if (modelBuilders.find(m) == modelBuilders.end())
+                        entry.modelBuilders.insert(m);
+                SharedEngineCache<T, U>::instance().add(sharedKey, entry);
+            }
+        } else if (engines_.find(key) == engines_.end()) {
+            std::set<std::pair<MarketObject, string>> requests;
+            if (record) {
+                requests = market_->recordedRequests();
+                market_->setRecordedRequests({});
+            }
             // build first (in case it throws)
-            boost::shared_ptr<U> engine = engineImpl(params...);
+            boost::shared_ptr<U> engine;
+            try {
+                engine = engineImpl(params...);
+            } catch (...) {
+                if (record)
+                    market_->setRecordedRequests(requests);
+                throw;
+            }
             // then add to map
             engines_[key] = engine;
+            if (record) {
+                auto engineRequests = market_->recordedRequests();
+                requests.insert(engineRequests.begin(), engineRequests.end());
+                market_->setRecordedRequests(requests);
+                engineRequests_[key] = engineRequests;
+            }
+        } else if (record) {
+            auto it = engineRequests_.find(key);
+            if (it != engineRequests_.end()) {
+                auto requests = market_->recordedRequests();
+                requests.insert(it->second.begin(), it->second.end());
+                market_->setRecordedRequests(requests);
+            }
         }
         return engines_[key];
     }
 
-    void reset() override { engines_.clear(); }
+    void reset() override {
+        std::lock_guard<std::recursive_mutex> lock(cacheMutex_);
+        engines_.clear();
+        engineRequests_.clear();
+    }
 
 protected:
+    //! true if the global parameter ShareEngines is true
+    bool shareEngines() const {
+        auto s = globalParameters_.find("ShareEngines");
+        return s != globalParameters_.end() && parseBool(s->second);
+    }
+
     virtual T keyImpl(Args...) = 0;
     virtual boost::shared_ptr<U> engineImpl(Args...) = 0;
 
     map<T, boost::shared_ptr<U>> engines_;
+    // the market objects requested while building the cached engines, if the market recorded them
+    map<T, std::set<std::pair<MarketObject, string>>> engineRequests_;
+
+private:
+    // recursive, since an engineImpl() might request another engine from the same builder
+    std::recursive_mutex cacheMutex_;
 };
 
 template <class T, typename... Args>
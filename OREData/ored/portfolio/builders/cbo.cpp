@@ -46,6 +46,7 @@ boost::shared_ptr<PricingEngine> CboMCEngineBuilder::engine(const boost::shared_
     double corr = parseReal(engineParameter("Correlation"));
 
     double errorTolerance = parseReal(engineParameter("ErrorTolerance", {}, false, "1.0e-6"));
+    Size threads = parseInteger(engineParameter("Threads", {}, false, "1"));
 
     string lossDistributionPeriods_str = engineParameter("LossDistributionPeriods");
     std::vector<string> lossDistributionPeriods_vec = parseListOfValues(lossDistributionPeriods_str);
@@ -63,7 +64,7 @@ boost::shared_ptr<PricingEngine> CboMCEngineBuilder::engine(const boost::shared_
     boost::shared_ptr<RandomDefaultModel> rdm(new GaussianRandomDefaultModel(pool, keys, copula, 1.e-6, seed));
 
     return boost::make_shared<QuantExt::MonteCarloCBOEngine>(rdm, samples, bins, errorTolerance,
-                                                             lossDistributionPeriods);
+                                                             lossDistributionPeriods, threads);
 };
 
 } // namespace data
@@ -139,12 +139,19 @@ protected:
             dontCalibrate = !parseBool(g->second);
         }
 
+        Size threads = parseInteger(engineParameter("Threads", {}, false, "1"));
+
         auto modelBuilder = boost::make_shared<CommodityApoModelBuilder>(yts, vol, apo, dontCalibrate);
         modelBuilders_.insert(std::make_pair(id, modelBuilder));
 
-        return boost::make_shared<QuantExt::CommodityAveragePriceOptionMonteCarloEngine>(yts, modelBuilder->model(),
-                                                                                         samples, beta);
+        return boost::make_shared<QuantExt::CommodityAveragePriceOptionMonteCarloEngine>(
+            yts, modelBuilder->model(), samples, beta, 42, threads, pathCache_);
     };
+
+private:
+    // the engines are built per trade, they share the simulated future paths through this cache
+    boost::shared_ptr<QuantExt::CommodityApoMcPathCache> pathCache_ =
+        boost::make_shared<QuantExt::CommodityApoMcPathCache>();
 };
 
 } // namespace data
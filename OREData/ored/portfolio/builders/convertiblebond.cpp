@@ -85,6 +85,8 @@ boost::shared_ptr<QuantLib::PricingEngine> ConvertibleBondFDDefaultableEquityJum
     Size engineStateGridPoints = parseInteger(engineParameter("Pricing.StateGridPoints", {}, true));
     Real engineMesherEpsilon = parseReal(engineParameter("Pricing.MesherEpsilon", {}, true));
     Real engineMesherScaling = parseReal(engineParameter("Pricing.MesherScaling", {}, true));
+    bool engineRichardsonExtrapolation =
+        parseBool(engineParameter("Pricing.RichardsonExtrapolation", {}, false, "false"));
     std::vector<Real> conversionRatioDiscretisationGrid =
         parseListOfValues<Real>(engineParameter("Pricing.ConversionRatioDiscretisationGrid", {}, true), &parseReal);
 
@@ -269,7 +271,7 @@ boost::shared_ptr<QuantLib::PricingEngine> ConvertibleBondFDDefaultableEquityJum
         modelBuilder->model(), referenceCurve, treatSecuritySpreadAsCreditSpread ? Handle<Quote>() : spread,
         isExchangeable ? creditCurve : Handle<DefaultProbabilityTermStructure>(), recovery, Handle<FxIndex>(fx),
         staticMesher, engineTimeStepsPerYear, engineStateGridPoints, engineMesherEpsilon, engineMesherScaling,
-        conversionRatioDiscretisationGrid, generateAdditionalResults);
+        conversionRatioDiscretisationGrid, generateAdditionalResults, engineRichardsonExtrapolation);
 }
 
 } // namespace data
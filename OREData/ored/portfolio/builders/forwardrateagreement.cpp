@@ -45,7 +45,9 @@ boost::shared_ptr<PricingEngine> LgmAmcFraEngineBuilder::buildMcEngine(const boo
         parseSobolBrownianGeneratorOrdering(engineParameter("BrownianBridgeOrdering")),
         parseSobolRsgDirectionIntegers(engineParameter("SobolDirectionIntegers")), discountCurve, simulationDates,
         externalModelIndices, parseBool(engineParameter("MinObsDate")),
-        parseBool(engineParameter("RegressionOnExerciseOnly")));
+        parseBool(engineParameter("RegressionOnExerciseOnly")),
+        engineParameter("ExternalComputeDevice", {}, false, ""),
+        parseInteger(engineParameter("Threads", {}, false, "1")));
 }
 
 boost::shared_ptr<PricingEngine> LgmAmcFraEngineBuilder::engineImpl(const Currency& ccy) {
@@ -72,16 +72,34 @@ protected:
     }
 };
 
+/*! If the engine parameter BatchPricing is true, the engines of the options on one currency pair price them as
+    contracts of a shared QuantExt::AnalyticBarrierBatch
+ */
 class FxBarrierOptionAnalyticEngineBuilder : public FxBarrierOptionEngineBuilder {
 public:
     FxBarrierOptionAnalyticEngineBuilder() : FxBarrierOptionEngineBuilder("GarmanKohlhagen", "AnalyticBarrierEngine") {}
 
+    void reset() override {
+        FxBarrierOptionEngineBuilder::reset();
+        batches_.clear();
+    }
+
 protected:
     virtual boost::shared_ptr<PricingEngine> engineImpl(const Currency& forCcy, const Currency& domCcy,
                                                         const Date& expiryDate, const Date& paymentDate) override {
         boost::shared_ptr<GeneralizedBlackScholesProcess> gbsp = getBlackScholesProcess(forCcy, domCcy);
-        return boost::make_shared<QuantExt::AnalyticBarrierEngine>(gbsp, paymentDate);
+        boost::shared_ptr<QuantExt::AnalyticBarrierBatch> batch;
+        if (parseBool(engineParameter("BatchPricing", {}, false, "false"))) {
+            batch = batches_[forCcy.code() + domCcy.code()];
+            if (!batch)
+                batch = batches_[forCcy.code() + domCcy.code()] =
+                    boost::make_shared<QuantExt::AnalyticBarrierBatch>(gbsp);
+        }
+        return boost::make_shared<QuantExt::AnalyticBarrierEngine>(gbsp, paymentDate, batch);
     }
+
+private:
+    std::map<string, boost::shared_ptr<QuantExt::AnalyticBarrierBatch>> batches_;
 };
 
 class FxBarrierOptionFDEngineBuilder : public FxBarrierOptionEngineBuilder {
@@ -80,7 +80,9 @@ boost::shared_ptr<PricingEngine> CamAmcFxForwardEngineBuilder::engineImpl(const
         parseSobolBrownianGeneratorOrdering(engineParameter("BrownianBridgeOrdering")),
         parseSobolRsgDirectionIntegers(engineParameter("SobolDirectionIntegers")), discountCurves, simulationDates_,
         externalModelIndices, parseBool(engineParameter("MinObsDate")),
-        parseBool(engineParameter("RegressionOnExerciseOnly")));
+        parseBool(engineParameter("RegressionOnExerciseOnly")),
+        engineParameter("ExternalComputeDevice", {}, false, ""),
+        parseInteger(engineParameter("Threads", {}, false, "1")));
 
     return engine;
 }
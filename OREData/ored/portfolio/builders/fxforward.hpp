@@ -26,6 +26,7 @@
 #include <boost/make_shared.hpp>
 #include <ored/portfolio/builders/cachingenginebuilder.hpp>
 #include <ored/portfolio/enginefactory.hpp>
+#include <ored/utilities/parsers.hpp>
 #include <qle/pricingengines/discountingfxforwardengine.hpp>
 
 namespace ore {
@@ -48,7 +49,8 @@ protected:
 };
 
 //! Engine Builder for FX Forwards
-/*! Pricing engines are cached by currency pair
+/*! Pricing engines are cached by currency pair. If the global parameter ZeroRateDependencies is true, the engines
+    publish the zero rate dependencies of the npv, see QuantExt::ZeroRateDependency.
     \ingroup builders
 */
 class FxForwardEngineBuilder : public FxForwardEngineBuilderBase {
@@ -58,10 +60,13 @@ public:
 protected:
     virtual boost::shared_ptr<PricingEngine> engineImpl(const Currency& forCcy, const Currency& domCcy) override {
         string pair = keyImpl(forCcy, domCcy);
+        bool zeroRateDependencies = globalParameters_.count("ZeroRateDependencies") > 0 &&
+                                    parseBool(globalParameters_.at("ZeroRateDependencies"));
         return boost::make_shared<QuantExt::DiscountingFxForwardEngine>(
             domCcy, market_->discountCurve(domCcy.code(), configuration(MarketContext::pricing)), forCcy,
             market_->discountCurve(forCcy.code(), configuration(MarketContext::pricing)),
-            market_->fxRate(pair, configuration(MarketContext::pricing)));
+            market_->fxRate(pair, configuration(MarketContext::pricing)), boost::none, Date(), Date(),
+            zeroRateDependencies);
     }
 };
 
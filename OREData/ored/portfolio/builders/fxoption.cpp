@@ -95,7 +95,9 @@ boost::shared_ptr<PricingEngine> CamAmcFxOptionEngineBuilder::engineImpl(const s
         parseSobolBrownianGeneratorOrdering(engineParameter("BrownianBridgeOrdering")),
         parseSobolRsgDirectionIntegers(engineParameter("SobolDirectionIntegers")), discountCurves, simulationDates_,
         externalModelIndices, parseBool(engineParameter("MinObsDate")),
-        parseBool(engineParameter("RegressionOnExerciseOnly")));
+        parseBool(engineParameter("RegressionOnExerciseOnly")),
+        engineParameter("ExternalComputeDevice", {}, false, ""),
+        parseInteger(engineParameter("Threads", {}, false, "1")));
 
     return engine;
 }
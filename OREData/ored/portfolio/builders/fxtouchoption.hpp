@@ -37,7 +37,8 @@ using namespace std;
 using namespace QuantLib;
 
 //! Engine Builder for FX Touch Options
-/*! Pricing engines are cached by currency pair
+/*! Pricing engines are cached by currency pair. If the engine parameter BatchPricing is true, the engines of the
+    options on one currency pair price them as contracts of a shared QuantExt::AnalyticDigitalAmericanBatch
 
     \ingroup portfolio
  */
@@ -50,6 +51,11 @@ public:
     FxTouchOptionEngineBuilder(const string& model, const string& engine)
         : CachingEngineBuilder(model, engine, {"FxTouchOption"}) {}
 
+    void reset() override {
+        CachingEngineBuilder::reset();
+        batches_.clear();
+    }
+
 protected:
     virtual string keyImpl(const Currency& forCcy, const Currency& domCcy, const string& type, const Date& payDate,
                            const bool flipResults) override {
@@ -67,14 +73,25 @@ protected:
             market_->discountCurve(domCcy.code(), configuration(ore::data::MarketContext::pricing)),
             market_->fxVol(pair, configuration(ore::data::MarketContext::pricing)));
 
+        // the touch options on one currency pair share a batch, if batch pricing is enabled
+        boost::shared_ptr<QuantExt::AnalyticDigitalAmericanBatch> batch;
+        if (parseBool(engineParameter("BatchPricing", {}, false, "false"))) {
+            batch = batches_[pair];
+            if (!batch)
+                batch = batches_[pair] = boost::make_shared<QuantExt::AnalyticDigitalAmericanBatch>(gbsp);
+        }
+
         if (type == "One-Touch") {
-            return boost::make_shared<QuantExt::AnalyticDigitalAmericanEngine>(gbsp, payDate, flipResults);
+            return boost::make_shared<QuantExt::AnalyticDigitalAmericanEngine>(gbsp, payDate, flipResults, batch);
         } else if (type == "No-Touch") {
-            return boost::make_shared<QuantExt::AnalyticDigitalAmericanKOEngine>(gbsp, payDate, flipResults);
+            return boost::make_shared<QuantExt::AnalyticDigitalAmericanKOEngine>(gbsp, payDate, flipResults, batch);
         } else {
             QL_FAIL("Unknown FX touch option type: " << type);
         }
     }
+
+private:
+    std::map<string, boost::shared_ptr<QuantExt::AnalyticDigitalAmericanBatch>> batches_;
 };
 
 } // namespace data
@@ -28,6 +28,7 @@
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/marketdata.hpp>
+#include <ored/utilities/parsers.hpp>
 #include <ql/pricingengines/swap/discountingswapengine.hpp>
 #include <qle/pricingengines/discountingcurrencyswapengine.hpp>
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
@@ -67,7 +68,11 @@ protected:
 };
 
 //! Engine Builder for Single Currency Swaps
-/*! This builder uses QuantExt::DiscountingSwapEngineMultiCurve
+/*! This builder uses QuantExt::DiscountingSwapEngineMultiCurve. If the global parameter ZeroRateDependencies is true,
+    the engines publish the zero rate dependencies of the npv, see QuantExt::ZeroRateDependency. The engine parameter
+    CompiledLegs switches the valuation from compiled legs on or off, see QuantExt::CompiledLeg, it defaults to true
+    for the run type Exposure and to false otherwise. The engine parameter CachedLegValues switches the caching of the
+    cashflow amounts and discount factors in the engine on, it defaults to false.
     \ingroup builders
 */
 class SwapEngineBuilderOptimised : public SwapEngineBuilderBase {
@@ -78,7 +83,14 @@ protected:
     virtual boost::shared_ptr<PricingEngine> engineImpl(const Currency& ccy) override {
 
         Handle<YieldTermStructure> yts = market_->discountCurve(ccy.code(), configuration(MarketContext::pricing));
-        return boost::make_shared<QuantExt::DiscountingSwapEngineMultiCurve>(yts);
+        bool zeroRateDependencies = globalParameters_.count("ZeroRateDependencies") > 0 &&
+                                    parseBool(globalParameters_.at("ZeroRateDependencies"));
+        auto rt = globalParameters_.find("RunType");
+        bool exposure = rt != globalParameters_.end() && rt->second == "Exposure";
+        bool compiledLegs = parseBool(engineParameter("CompiledLegs", {}, false, exposure ? "true" : "false"));
+        bool cachedLegValues = parseBool(engineParameter("CachedLegValues", {}, false, "false"));
+        return boost::make_shared<QuantExt::DiscountingSwapEngineMultiCurve>(
+            yts, true, boost::none, Date(), Date(), zeroRateDependencies, compiledLegs, cachedLegValues);
     }
 };
 
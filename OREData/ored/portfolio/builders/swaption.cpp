@@ -29,6 +29,7 @@
 #include <qle/pricingengines/numericlgmmultilegoptionengine.hpp>
 #include <qle/pricingengines/mcmultilegoptionengine.hpp>
 
+#include <cmath>
 #include <set>
 
 using namespace QuantLib;
@@ -41,7 +42,8 @@ boost::shared_ptr<PricingEngine> buildMcEngine(const std::function<string(string
                                                const boost::shared_ptr<LGM>& lgm,
                                                const Handle<YieldTermStructure>& discountCurve,
                                                const std::vector<Date>& simulationDates,
-                                               const std::vector<Size>& externalModelIndices) {
+                                               const std::vector<Size>& externalModelIndices,
+                                               const std::string& externalComputeDevice, const Size threads) {
 
     return boost::make_shared<QuantExt::McMultiLegOptionEngine>(
         lgm, parseSequenceType(engineParameters("Training.Sequence")),
@@ -52,7 +54,7 @@ boost::shared_ptr<PricingEngine> buildMcEngine(const std::function<string(string
         parseSobolBrownianGeneratorOrdering(engineParameters("BrownianBridgeOrdering")),
         parseSobolRsgDirectionIntegers(engineParameters("SobolDirectionIntegers")), discountCurve, simulationDates,
         externalModelIndices, parseBool(engineParameters("MinObsDate")),
-        parseBool(engineParameters("RegressionOnExerciseOnly")));
+        parseBool(engineParameters("RegressionOnExerciseOnly")), externalComputeDevice, threads);
 }
 } // namespace
 
@@ -100,6 +102,33 @@ boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const s
     auto volatilityType = parseVolatilityType(modelParameter("VolatilityType"));
     bool continueOnCalibrationError = globalParameters_.count("ContinueOnCalibrationError") > 0 &&
                                       parseBool(globalParameters_.at("ContinueOnCalibrationError"));
+    bool warmStart = parseBool(modelParameter("WarmStart", {}, false, "false"));
+    Size calibrationThreads = parseInteger(modelParameter("CalibrationThreads", {}, false, "1"));
+    std::string calibrationBucket = modelParameter("CalibrationBucket", {}, false, "");
+    Date today = Settings::instance().evaluationDate();
+
+    /* Trades with the same key, strategy and (for deal strike calibration) strikes, whose expiries and maturity fall
+       into the same buckets share one calibrated model */
+    std::string bucket;
+    if (!calibrationBucket.empty() && calibrationStrategy != CalibrationStrategy::None) {
+        Real width = static_cast<Real>((today + parsePeriod(calibrationBucket)) - today);
+        QL_REQUIRE(width > 0.0, "CalibrationBucket (" << calibrationBucket << ") must be a positive period");
+        auto bucketIndex = [&today, width](const Date& d) { return std::lround((d - today) / width); };
+        std::ostringstream b;
+        b << key << ":" << calibration << ":" << calibrationStrategy << ":" << bucketIndex(maturity);
+        for (Size i = 0; i < expiries.size(); ++i) {
+            b << ":" << bucketIndex(expiries[i]);
+            if (calibrationStrategy == CalibrationStrategy::CoterminalDealStrike && strikes[i] != Null<Real>())
+                b << "@" << std::to_string(strikes[i]);
+        }
+        bucket = b.str();
+        auto m = bucketModels_.find(bucket);
+        if (m != bucketModels_.end()) {
+            DLOG("Use the model calibrated for calibration bucket " << bucket << " for trade " << id);
+            modelBuilders_.insert(std::make_pair(id, m->second.second));
+            return m->second.first;
+        }
+    }
 
     auto data = boost::make_shared<IrLgmData>();
 
@@ -118,7 +147,6 @@ boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const s
 
     // compute horizon shift
     Real shiftHorizon = parseReal(modelParameter("ShiftHorizon", {}, false, "0.5"));
-    Date today = Settings::instance().evaluationDate();
     shiftHorizon = ActualActual(ActualActual::ISDA).yearFraction(today, maturity) * shiftHorizon;
 
     // Default: no calibration, constant lambda and sigma from engine configuration
@@ -185,7 +213,8 @@ boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const s
     DLOG("Build LGM model");
     boost::shared_ptr<LgmBuilder> calib =
         boost::make_shared<LgmBuilder>(market_, data, configuration(MarketContext::irCalibration), tolerance,
-                                       continueOnCalibrationError, referenceCalibrationGrid, generateAdditionalResults);
+                                       continueOnCalibrationError, referenceCalibrationGrid, generateAdditionalResults,
+                                       warmStart, calibrationThreads);
 
     // In some cases, we do not want to calibrate the model
     boost::shared_ptr<QuantExt::LGM> model;
@@ -199,6 +228,8 @@ boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const s
         calib->unfreeze();
     }
     modelBuilders_.insert(std::make_pair(id, calib));
+    if (!bucket.empty())
+        bucketModels_[bucket] = std::make_pair(model, calib);
 
     return model;
 }
@@ -239,7 +270,9 @@ boost::shared_ptr<PricingEngine> LgmMcBermudanSwaptionEngineBuilder::engineImpl(
     std::string ccy = tryParseIborIndex(key, index) ? index->currency().code() : key;
     auto discountCurve = market_->discountCurve(ccy, configuration(MarketContext::pricing));
     return buildMcEngine([this](const std::string& p) { return this->engineParameter(p); }, lgm, discountCurve,
-                         std::vector<Date>(), std::vector<Size>());
+                         std::vector<Date>(), std::vector<Size>(),
+                         engineParameter("ExternalComputeDevice", {}, false, ""),
+                         parseInteger(engineParameter("Threads", {}, false, "1")));
 } // LgmMc engineImpl()
 
 boost::shared_ptr<PricingEngine> LgmAmcBermudanSwaptionEngineBuilder::engineImpl(const string& id, const string& key,
@@ -261,7 +294,8 @@ boost::shared_ptr<PricingEngine> LgmAmcBermudanSwaptionEngineBuilder::engineImpl
     // we assume that the given cam has pricing discount curves attached already
     Handle<YieldTermStructure> discountCurve;
     return buildMcEngine([this](const std::string& p) { return this->engineParameter(p); }, lgm, discountCurve,
-                         simulationDates_, modelIndex);
+                         simulationDates_, modelIndex, engineParameter("ExternalComputeDevice", {}, false, ""),
+                         parseInteger(engineParameter("Threads", {}, false, "1")));
 } // LgmCam engineImpl
 
 } // namespace data
@@ -85,9 +85,19 @@ class LGMBermudanSwaptionEngineBuilder : public BermudanSwaptionEngineBuilder {
 public:
     LGMBermudanSwaptionEngineBuilder(const string& engine) : BermudanSwaptionEngineBuilder("LGM", engine) {}
 
+    void reset() override {
+        BermudanSwaptionEngineBuilder::reset();
+        bucketModels_.clear();
+    }
+
 protected:
     boost::shared_ptr<QuantExt::LGM> model(const string& id, const string& key, const std::vector<Date>& dates,
                                            const Date& maturity, const std::vector<Real>& strikes);
+
+private:
+    /* models and their builders by calibration bucket, if the model parameter CalibrationBucket is given, trades in
+       the same bucket share the model calibrated for the first of them */
+    map<string, std::pair<boost::shared_ptr<QuantExt::LGM>, boost::shared_ptr<QuantExt::ModelBuilder>>> bucketModels_;
 };
 
 //! Implementation of BermudanSwaptionEngineBuilder using LGM Grid pricer
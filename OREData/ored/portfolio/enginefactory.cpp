@@ -168,6 +168,8 @@ void EngineFactory::registerBuilder(const boost::shared_ptr<EngineBuilder>& buil
 }
 
 boost::shared_ptr<EngineBuilder> EngineFactory::builder(const string& tradeType) {
+    std::lock_guard<std::mutex> lock(builderMutex_);
+
     // Check that we have a model/engine for tradetype
     QL_REQUIRE(engineData_->hasProduct(tradeType),
                "No Pricing Engine configuration was provided for trade type " << tradeType);
@@ -195,6 +197,33 @@ boost::shared_ptr<EngineBuilder> EngineFactory::builder(const string& tradeType)
     return builder;
 }
 
+bool EngineFactory::supportsConcurrentBuilds() {
+    std::lock_guard<std::mutex> lock(builderMutex_);
+    for (auto const& [key, builder] : builders_) {
+        const map<string, string>*modelParameters = nullptr, *engineParameters = nullptr;
+        for (auto const& tradeType : std::get<2>(key)) {
+            if (!engineData_->hasProduct(tradeType) || engineData_->model(tradeType) != std::get<0>(key) ||
+                engineData_->engine(tradeType) != std::get<1>(key))
+                continue;
+            string effectiveTradeType = tradeType;
+            if (auto db = boost::dynamic_pointer_cast<DelegatingEngineBuilder>(builder))
+                effectiveTradeType = db->effectiveTradeType();
+            const map<string, string>& m = engineData_->modelParameters(effectiveTradeType);
+            const map<string, string>& e = engineData_->engineParameters(effectiveTradeType);
+            if (modelParameters == nullptr) {
+                modelParameters = &m;
+                engineParameters = &e;
+            } else if (*modelParameters != m || *engineParameters != e) {
+                DLOG("EngineFactory: builder " << std::get<0>(key) << "/" << std::get<1>(key)
+                                               << " has different parameters for its trade types, e.g. "
+                                               << tradeType);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void EngineFactory::registerLegBuilder(const boost::shared_ptr<LegBuilder>& legBuilder, const bool allowOverwrite) {
     if (allowOverwrite)
         legBuilders_.erase(legBuilder->legType());
@@ -35,6 +35,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -125,16 +126,22 @@ public:
 
     //! Initialise this Builder with the market and parameters to use
     /*! This method should not be called directly, it is called by the EngineFactory
-     *  before it is returned.
+     *  before it is returned. Only the members that change are assigned, so that a builder initialised again with
+     *  the same market and parameters can be used by other threads in the meantime.
      */
     void init(const boost::shared_ptr<Market> market, const map<MarketContext, string>& configurations,
               const map<string, string>& modelParameters, const map<string, string>& engineParameters,
               const std::map<std::string, std::string>& globalParameters = {}) {
-        market_ = market;
-        configurations_ = configurations;
-        modelParameters_ = modelParameters;
-        engineParameters_ = engineParameters;
-        globalParameters_ = globalParameters;
+        if (market_ != market)
+            market_ = market;
+        if (configurations_ != configurations)
+            configurations_ = configurations;
+        if (modelParameters_ != modelParameters)
+            modelParameters_ = modelParameters;
+        if (engineParameters_ != engineParameters)
+            engineParameters_ = engineParameters;
+        if (globalParameters_ != globalParameters)
+            globalParameters_ = globalParameters;
     }
 
     //! return model builders
@@ -257,6 +264,11 @@ public:
      */
     boost::shared_ptr<EngineBuilder> builder(const string& tradeType);
 
+    /*! Return true if the builders can be requested and used by several threads at the same time, i.e. if each
+        builder serving several trade types is configured with the same parameters for all of them, so that the
+        initialisation in builder() does not change a builder in use. See Portfolio::build(). */
+    bool supportsConcurrentBuilds();
+
     //! Register a leg builder with the factory
     void registerLegBuilder(const boost::shared_ptr<LegBuilder>& legBuilder, const bool allowOverwrite = false);
 
@@ -287,6 +299,8 @@ private:
     map<string, boost::shared_ptr<LegBuilder>> legBuilders_;
     boost::shared_ptr<ReferenceDataManager> referenceData_;
     IborFallbackConfig iborFallbackConfig_;
+    // serialises the lookup and initialisation of the builders
+    std::mutex builderMutex_;
 };
 
 //! Leg builder
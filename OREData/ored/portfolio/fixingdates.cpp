@@ -139,6 +139,14 @@ void addZeroInflationDates(set<Date>& dates, const Date& fixingDate, const Date&
 
     dates.insert(fixingDates.begin(), fixingDates.end());
 }
+
+/* Equivalent to !SimpleCashFlow(0.0, payDate).hasOccurred(d) || (alwaysAddIfPaysOnSettlement && payDate == d), but
+   the cashflow is only created if the pay date is the settlement date, i.e. if the settings have to be consulted */
+bool isRequired(const Date& payDate, const Date& d, const bool alwaysAddIfPaysOnSettlement) {
+    if (payDate != d)
+        return payDate > d;
+    return alwaysAddIfPaysOnSettlement || !SimpleCashFlow(0.0, payDate).hasOccurred(d);
+}
 } // namespace
 
 void RequiredFixings::clear() {
@@ -194,8 +202,7 @@ RequiredFixings RequiredFixings::filteredFixingDates(const Date& settlementDate)
         // add to result
         if (fixingDate > d)
             continue;
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
+        if (isRequired(payDate, d, alwaysAddIfPaysOnSettlement)) {
             std::get<2>(f) = Date::maxDate();
             std::get<3>(f) = true;
             rf.addFixingDate(f);
@@ -211,8 +218,7 @@ RequiredFixings RequiredFixings::filteredFixingDates(const Date& settlementDate)
         Date payDate = std::get<2>(fixingEntry);
         bool alwaysAddIfPaysOnSettlement = std::get<3>(fixingEntry);
         // add to result
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
+        if (isRequired(payDate, d, alwaysAddIfPaysOnSettlement)) {
             std::get<2>(std::get<0>(std::get<0>(f))) = Date::maxDate();
             std::get<3>(std::get<0>(std::get<0>(f))) = true;
             rf.addZeroInflationFixingDate(f);
@@ -227,8 +233,7 @@ RequiredFixings RequiredFixings::filteredFixingDates(const Date& settlementDate)
         Date payDate = std::get<2>(fixingEntry);
         bool alwaysAddIfPaysOnSettlement = std::get<3>(fixingEntry);
         // add to result
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
+        if (isRequired(payDate, d, alwaysAddIfPaysOnSettlement)) {
             std::get<2>(std::get<0>(f)) = Date::maxDate();
             std::get<3>(std::get<0>(f)) = true;
             rf.addYoYInflationFixingDate(f);
@@ -244,19 +249,23 @@ std::map<std::string, std::set<Date>> RequiredFixings::fixingDatesIndices(const
 
     std::map<std::string, std::set<Date>> result;
 
-    // handle the general case
+    /* handle the general case, the entries are sorted by index name and fixing date, so the result set is only
+       looked up when the index name changes and the dates are appended at its end */
+    std::set<Date>* dates = nullptr;
+    const std::string* currentIndexName = nullptr;
     for (auto const& f : fixingDates_) {
         // get the data
-        std::string indexName = std::get<0>(f);
-        Date fixingDate = std::get<1>(f);
-        Date payDate = std::get<2>(f);
-        bool alwaysAddIfPaysOnSettlement = std::get<3>(f);
+        const std::string& indexName = std::get<0>(f);
+        const Date& fixingDate = std::get<1>(f);
         // add to result
         if (fixingDate > d)
             continue;
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
-            result[indexName].insert(fixingDate);
+        if (isRequired(std::get<2>(f), d, std::get<3>(f))) {
+            if (currentIndexName == nullptr || *currentIndexName != indexName) {
+                dates = &result[indexName];
+                currentIndexName = &indexName;
+            }
+            dates->insert(dates->end(), fixingDate);
         }
     }
 
@@ -275,8 +284,7 @@ std::map<std::string, std::set<Date>> RequiredFixings::fixingDatesIndices(const
         CPI::InterpolationType couponInterpolation = std::get<1>(f);
         Frequency couponFrequency = std::get<2>(f);
         // add to result
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
+        if (isRequired(payDate, d, alwaysAddIfPaysOnSettlement)) {
             std::set<Date> tmp;
             addZeroInflationDates(tmp, fixingDate, d, indexInterpolated, indexFrequency, indexAvailabilityLag,
                                   couponInterpolation, couponFrequency);
@@ -297,8 +305,7 @@ std::map<std::string, std::set<Date>> RequiredFixings::fixingDatesIndices(const
         Frequency indexFrequency = std::get<2>(f);
         Period indexAvailabilityLag = std::get<3>(f);
         // add to result
-        SimpleCashFlow dummyCf(0.0, payDate);
-        if (!dummyCf.hasOccurred(d) || (alwaysAddIfPaysOnSettlement && dummyCf.date() == d)) {
+        if (isRequired(payDate, d, alwaysAddIfPaysOnSettlement)) {
             auto fixingDates = needsForecast(fixingDate, d, indexInterpolated, indexFrequency, indexAvailabilityLag);
             if (!fixingDates.empty())
                 result[indexName].insert(fixingDates.begin(), fixingDates.end());
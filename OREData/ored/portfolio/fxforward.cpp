@@ -200,6 +200,8 @@ void FxForward::fromXML(XMLNode* node) {
     }
 }
 
+boost::shared_ptr<Trade> FxForward::copy() const { return boost::make_shared<FxForward>(*this); }
+
 XMLNode* FxForward::toXML(XMLDocument& doc) {
     XMLNode* node = Trade::toXML(doc);
     XMLNode* fxNode = doc.allocNode("FxForwardData");
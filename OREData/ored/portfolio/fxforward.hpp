@@ -68,6 +68,10 @@ public:
     virtual XMLNode* toXML(XMLDocument& doc) override;
     //@}
 
+protected:
+    //! Copy the parsed trade data
+    boost::shared_ptr<Trade> copy() const override;
+
 private:
     string maturityDate_;
     string boughtCurrency_;
@@ -23,10 +23,22 @@
 #include <ored/portfolio/swap.hpp>
 #include <ored/portfolio/swaption.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
+#include <ored/utilities/osutils.hpp>
+#include <ored/utilities/tracing.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/errors.hpp>
+#include <ql/settings.hpp>
 #include <ql/time/date.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <thread>
+
 using namespace QuantLib;
 using namespace std;
 
@@ -38,6 +50,7 @@ using namespace data;
 void Portfolio::clear() {
     trades_.clear();
     underlyingIndicesCache_.clear();
+    marketRequests_.clear();
 }
 
 void Portfolio::reset() {
@@ -46,55 +59,287 @@ void Portfolio::reset() {
         t->reset();
 }
 
-void Portfolio::fromXML(XMLNode* node) {
-    XMLUtils::checkNode(node, "Portfolio");
-    vector<XMLNode*> nodes = XMLUtils::getChildrenNodes(node, "Trade");
-    for (Size i = 0; i < nodes.size(); i++) {
-        string tradeType = XMLUtils::getChildValue(nodes[i], "TradeType", true);
-
-        // Get the id attribute
-        string id = XMLUtils::getAttribute(nodes[i], "id");
-        QL_REQUIRE(id != "", "No id attribute in Trade Node");
-        DLOG("Parsing trade id:" << id);
-        
-        boost::shared_ptr<Trade> trade;
-        bool failedToLoad = true;
+namespace {
+
+/* Deserialise a trade node. If this fails and failed trades are built, a failed trade with the id and the envelope
+   of the trade is returned, otherwise a null pointer. */
+boost::shared_ptr<Trade> loadTrade(XMLNode* node, const bool buildFailedTrades) {
+    string tradeType = XMLUtils::getChildValue(node, "TradeType", true);
+
+    // Get the id attribute
+    string id = XMLUtils::getAttribute(node, "id");
+    QL_REQUIRE(id != "", "No id attribute in Trade Node");
+    DLOG("Parsing trade id:" << id);
+
+    try {
+        boost::shared_ptr<Trade> trade = TradeFactory::instance().build(tradeType);
+        trade->fromXML(node);
+        trade->id() = id;
+        DLOG("Parsed Trade " << id << " (" << trade->id() << ")"
+                             << " type:" << tradeType);
+        return trade;
+    } catch (std::exception& ex) {
+        ALOG(StructuredTradeErrorMessage(id, tradeType, "Error parsing Trade XML", ex.what()));
+    }
+
+    // If trade loading failed, then create a dummy trade with same id and envelope
+    if (buildFailedTrades) {
         try {
-            trade = TradeFactory::instance().build(tradeType);
-            trade->fromXML(nodes[i]);
-            trade->id() = id;
-            add(trade);
-            DLOG("Added Trade " << id << " (" << trade->id() << ")"
-                                << " type:" << tradeType);
-            failedToLoad = false;
+            boost::shared_ptr<Trade> trade = TradeFactory::instance().build("Failed");
+            // this loads only type, id and envelope, but type will be set to the original trade's type
+            trade->fromXML(node);
+            // create a dummy trade of type "Dummy"
+            boost::shared_ptr<FailedTrade> failedTrade = boost::make_shared<FailedTrade>();
+            // copy id and envelope
+            failedTrade->id() = id;
+            failedTrade->setUnderlyingTradeType(tradeType);
+            failedTrade->envelope() = trade->envelope();
+            WLOG("Created trade id " << failedTrade->id() << " type " << failedTrade->tradeType()
+                                     << " for original trade type " << trade->tradeType());
+            return failedTrade;
         } catch (std::exception& ex) {
-            ALOG(StructuredTradeErrorMessage(id, tradeType, "Error parsing Trade XML", ex.what()));
+            ALOG(StructuredTradeErrorMessage(id, tradeType, "Error parsing type and envelope", ex.what()));
         }
+    }
+    return nullptr;
+}
 
-        // If trade loading failed, then insert a dummy trade with same id and envelope
-        if (failedToLoad && buildFailedTrades_) {
-            try {
-                trade = TradeFactory::instance().build("Failed");
-                // this loads only type, id and envelope, but type will be set to the original trade's type
-                trade->fromXML(nodes[i]);
-                // create a dummy trade of type "Dummy"
-                boost::shared_ptr<FailedTrade> failedTrade = boost::make_shared<FailedTrade>();
-                // copy id and envelope
-                failedTrade->id() = id;
-                failedTrade->setUnderlyingTradeType(tradeType);
-                failedTrade->envelope() = trade->envelope();
-                // and add it to the portfolio
-                add(failedTrade);
-                WLOG("Added trade id " << failedTrade->id() << " type " << failedTrade->tradeType()
-                                       << " for original trade type " << trade->tradeType());
-            } catch (std::exception& ex) {
-                ALOG(StructuredTradeErrorMessage(id, tradeType, "Error parsing type and envelope", ex.what()));
+/* Reads the top level Trade elements of a portfolio file one by one, without parsing them. Trade elements nested in
+   a trade (e.g. in composite trades) are part of their parent, comments, CDATA sections and processing instructions
+   are skipped. Only the data between two trades and the current trade are held in memory. */
+class TradeElementReader {
+public:
+    explicit TradeElementReader(const std::string& filename)
+        : filename_(filename), in_(filename.c_str(), std::ios::binary), pos_(0), root_(false), done_(false) {
+        QL_REQUIRE(in_.is_open(), "Failed to open file " << filename);
+    }
+
+    //! read the next trade element, returns false at the end of the portfolio
+    bool next(std::string& trade);
+
+private:
+    // append the next block of the file to the buffer, returns false at the end of the file
+    bool fill();
+    // position of token at or after from, npos if it is not found in the rest of the file
+    Size find(const char* token, Size from);
+    // true if the buffer contains token at p
+    bool startsWith(Size p, const std::string& token);
+    // position of the closing '>' of the tag starting at p, quoted attribute values are skipped
+    Size tagEnd(Size p);
+
+    std::string filename_;
+    std::ifstream in_;
+    std::string buffer_;
+    Size pos_;
+    bool root_, done_;
+};
+
+bool TradeElementReader::fill() {
+    static const Size blockSize = 1 << 22;
+    if (!in_)
+        return false;
+    Size n = buffer_.size();
+    buffer_.resize(n + blockSize);
+    in_.read(&buffer_[n], blockSize);
+    buffer_.resize(n + static_cast<Size>(in_.gcount()));
+    return buffer_.size() > n;
+}
+
+Size TradeElementReader::find(const char* token, Size from) {
+    Size length = std::strlen(token);
+    while (true) {
+        Size p = buffer_.find(token, from);
+        if (p != std::string::npos)
+            return p;
+        // a match might start in the last length - 1 characters of the buffer
+        if (buffer_.size() >= length)
+            from = std::max(from, buffer_.size() - length + 1);
+        if (!fill())
+            return std::string::npos;
+    }
+}
+
+bool TradeElementReader::startsWith(Size p, const std::string& token) {
+    while (buffer_.size() < p + token.size())
+        if (!fill())
+            return false;
+    return buffer_.compare(p, token.size(), token) == 0;
+}
+
+Size TradeElementReader::tagEnd(Size p) {
+    char quote = 0;
+    for (Size i = p + 1;; ++i) {
+        if (i == buffer_.size())
+            QL_REQUIRE(fill(), "Unexpected end of file in tag in " << filename_);
+        char c = buffer_[i];
+        if (quote != 0) {
+            if (c == quote)
+                quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return i;
+        }
+    }
+}
+
+bool TradeElementReader::next(std::string& trade) {
+    if (done_)
+        return false;
+    // the data before the current position is not needed any more
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+    Size depth = 0, start = 0;
+    while (true) {
+        Size lt = find("<", pos_);
+        if (lt == std::string::npos) {
+            QL_REQUIRE(depth == 0, "Unexpected end of file in Trade element in " << filename_);
+            QL_REQUIRE(!root_, "Unexpected end of file in Portfolio element in " << filename_);
+            QL_FAIL("No Portfolio element found in " << filename_);
+        }
+        // skip comments, CDATA sections, processing instructions and declarations
+        Size e;
+        if (startsWith(lt, "<!--")) {
+            e = find("-->", lt + 4);
+            QL_REQUIRE(e != std::string::npos, "Unterminated comment in " << filename_);
+            pos_ = e + 3;
+            continue;
+        } else if (startsWith(lt, "<![CDATA[")) {
+            e = find("]]>", lt + 9);
+            QL_REQUIRE(e != std::string::npos, "Unterminated CDATA section in " << filename_);
+            pos_ = e + 3;
+            continue;
+        } else if (startsWith(lt, "<?")) {
+            e = find("?>", lt + 2);
+            QL_REQUIRE(e != std::string::npos, "Unterminated processing instruction in " << filename_);
+            pos_ = e + 2;
+            continue;
+        } else if (startsWith(lt, "<!")) {
+            pos_ = tagEnd(lt) + 1;
+            continue;
+        }
+        e = tagEnd(lt);
+        pos_ = e + 1;
+        bool closing = buffer_[lt + 1] == '/';
+        bool selfClosing = !closing && buffer_[e - 1] == '/';
+        Size nameStart = lt + (closing ? 2 : 1), nameEnd = nameStart;
+        while (nameEnd < e && !std::isspace(static_cast<unsigned char>(buffer_[nameEnd])) && buffer_[nameEnd] != '/')
+            ++nameEnd;
+        std::string name = buffer_.substr(nameStart, nameEnd - nameStart);
+        if (!root_) {
+            QL_REQUIRE(!closing && name == "Portfolio",
+                       "Expected Portfolio as root element in " << filename_ << ", got " << name);
+            root_ = true;
+            done_ = selfClosing;
+            if (done_)
+                return false;
+        } else if (depth == 0 && closing && name == "Portfolio") {
+            done_ = true;
+            return false;
+        } else if (name == "Trade") {
+            if (closing) {
+                QL_REQUIRE(depth > 0, "Unexpected closing Trade tag in " << filename_);
+                if (--depth == 0) {
+                    trade = buffer_.substr(start, pos_ - start);
+                    return true;
+                }
+            } else if (!selfClosing) {
+                if (depth++ == 0)
+                    start = lt;
+            } else if (depth == 0) {
+                trade = buffer_.substr(lt, pos_ - lt);
+                return true;
             }
         }
     }
+}
+
+} // namespace
+
+void Portfolio::fromXML(XMLNode* node) {
+    XMLUtils::checkNode(node, "Portfolio");
+    vector<XMLNode*> nodes = XMLUtils::getChildrenNodes(node, "Trade");
+    for (Size i = 0; i < nodes.size(); i++) {
+        if (auto trade = loadTrade(nodes[i], buildFailedTrades_))
+            addLoadedTrade(trade);
+    }
     LOG("Finished Parsing XML doc");
 }
 
+void Portfolio::addLoadedTrade(const boost::shared_ptr<Trade>& trade) {
+    try {
+        add(trade);
+        DLOG("Added Trade " << trade->id() << " type:" << trade->tradeType());
+    } catch (std::exception& ex) {
+        ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "Error adding trade", ex.what()));
+    }
+}
+
+void Portfolio::fromFile(const std::string& filename, const Size nThreads, const Size chunkSize) {
+    QL_REQUIRE(chunkSize > 0, "Portfolio::fromFile(): chunk size must be positive");
+    Size nWorkers = std::max<Size>(nThreads, 1);
+    LOG("Parsing portfolio file " << filename << " in chunks of " << chunkSize << " trades on " << nWorkers
+                                  << " threads");
+
+    // parse a chunk of trade elements, this is run by the workers, each on a document of its own
+    auto parse = [this](const std::vector<std::string>& chunk) {
+        std::string xml = "<Portfolio>";
+        for (auto const& t : chunk)
+            xml += t;
+        xml += "</Portfolio>";
+        XMLDocument doc;
+        doc.fromXMLString(xml);
+        std::vector<boost::shared_ptr<Trade>> trades;
+        for (auto n : XMLUtils::getChildrenNodes(doc.getFirstNode("Portfolio"), "Trade"))
+            trades.push_back(loadTrade(n, buildFailedTrades_));
+        return trades;
+    };
+
+    TradeElementReader reader(filename);
+    std::string element;
+    bool more = true;
+    Size count = 0;
+    while (more) {
+        // read up to one chunk per worker
+        std::vector<std::vector<std::string>> chunks;
+        while ((chunks.size() < nWorkers || chunks.back().size() < chunkSize) && (more = reader.next(element))) {
+            if (chunks.empty() || chunks.back().size() == chunkSize)
+                chunks.emplace_back();
+            chunks.back().push_back(std::move(element));
+        }
+        std::vector<std::vector<boost::shared_ptr<Trade>>> results(chunks.size());
+        if (chunks.size() > 1) {
+            std::vector<std::exception_ptr> errors(chunks.size());
+            std::vector<std::thread> workers;
+            for (Size i = 0; i < chunks.size(); ++i) {
+                workers.emplace_back([&parse, &chunks, &results, &errors, i]() {
+                    try {
+                        results[i] = parse(chunks[i]);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& w : workers)
+                w.join();
+            for (auto const& e : errors)
+                if (e)
+                    std::rethrow_exception(e);
+        } else if (chunks.size() == 1) {
+            results[0] = parse(chunks[0]);
+        }
+        // add the trades in the order of the file
+        for (auto const& r : results) {
+            for (auto const& trade : r) {
+                if (trade)
+                    addLoadedTrade(trade);
+            }
+            count += r.size();
+        }
+    }
+    LOG("Finished parsing " << count << " trades from portfolio file " << filename);
+}
+
 XMLNode* Portfolio::toXML(XMLDocument& doc) {
     XMLNode* node = doc.allocNode("Portfolio");
     for (auto& t : trades_)
@@ -119,14 +364,55 @@ void Portfolio::removeMatured(const Date& asof) {
 }
 
 void Portfolio::build(const boost::shared_ptr<EngineFactory>& engineFactory, const std::string& context,
-                      const bool emitStructuredError) {
+                      const bool emitStructuredError, const Size nThreads) {
+    TraceSpan span("portfolio", "Portfolio::build");
+    span.arg("context", context).arg("trades", trades_.size());
     LOG("Building Portfolio of size " << trades_.size() << " for context = '" << context << "'");
     auto trade = trades_.begin();
     Size initialSize = trades_.size();
     Size failedTrades = 0;
+    marketRequests_.clear();
+    const boost::shared_ptr<Market>& market = engineFactory->market();
+    bool recordRequests = market && market->recordingRequests();
+    const bool accountMemory = MemoryAccounting::instance().enabled();
+    const unsigned long long memoryBefore = accountMemory ? os::getMemoryUsageBytes() : 0;
+
+    if (nThreads > 1 && trades_.size() > 1) {
+        std::string requirement;
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+        requirement = "a QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN";
+#elif defined(QL_ENABLE_SESSIONS)
+        requirement = "a QuantLib build without QL_ENABLE_SESSIONS";
+#endif
+        if (requirement.empty() && recordRequests)
+            requirement = "a market that does not record the requested market objects";
+        if (requirement.empty() && !engineFactory->supportsConcurrentBuilds())
+            requirement = "engine builders with the same parameters for all their trade types";
+        if (requirement.empty()) {
+            failedTrades = buildParallel(engineFactory, context, emitStructuredError, nThreads);
+            trade = trades_.end();
+        } else {
+            WLOG("Portfolio: parallel build with " << nThreads << " threads requires " << requirement
+                                                   << ", build sequentially");
+        }
+    }
+
     while (trade != trades_.end()) {
+        // collect the requests of this trade separately and add them to the ones recorded so far afterwards
+        std::set<std::pair<MarketObject, std::string>> requests;
+        if (recordRequests) {
+            requests = market->recordedRequests();
+            market->setRecordedRequests({});
+        }
         auto [ft, success] =
             buildTrade((*trade).second, engineFactory, context, buildFailedTrades(), emitStructuredError);
+        if (recordRequests) {
+            auto tradeRequests = market->recordedRequests();
+            requests.insert(tradeRequests.begin(), tradeRequests.end());
+            market->setRecordedRequests(requests);
+            if (success || ft)
+                marketRequests_[(*trade).first] = tradeRequests;
+        }
         if (success) {
             ++trade;
         } else if (ft) {
@@ -140,9 +426,63 @@ void Portfolio::build(const boost::shared_ptr<EngineFactory>& engineFactory, con
     LOG("Built Portfolio. Initial size = " << initialSize << ", size now " << trades_.size() << ", built "
                                            << failedTrades << " failed trades, context is " + context);
 
+    if (accountMemory) {
+        unsigned long long memoryAfter = os::getMemoryUsageBytes();
+        buildMemory_ = memoryAfter > memoryBefore ? static_cast<std::size_t>(memoryAfter - memoryBefore) : 0;
+    }
+
     QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades, context is '" + context + "'");
 }
 
+Size Portfolio::buildParallel(const boost::shared_ptr<EngineFactory>& engineFactory, const std::string& context,
+                              const bool emitStructuredError, const Size nThreads) {
+
+    // the trades are built on the worker threads, the results are applied in the order of the trades afterwards, so
+    // that the portfolio does not depend on the order in which the builds finish
+
+    std::vector<std::map<std::string, boost::shared_ptr<Trade>>::iterator> trades;
+    for (auto t = trades_.begin(); t != trades_.end(); ++t)
+        trades.push_back(t);
+    std::vector<std::pair<boost::shared_ptr<Trade>, bool>> results(trades.size());
+
+    Size nWorkers = std::min(nThreads, trades.size());
+    LOG("Build " << trades.size() << " trades on " << nWorkers << " threads");
+    std::vector<std::exception_ptr> errors(nWorkers);
+    std::atomic<Size> next(0);
+    std::vector<std::thread> workers;
+    for (Size w = 0; w < nWorkers; ++w) {
+        workers.emplace_back([this, &trades, &results, &errors, &next, &engineFactory, &context, emitStructuredError,
+                              w]() {
+            try {
+                for (Size i = next++; i < trades.size(); i = next++)
+                    results[i] =
+                        buildTrade(trades[i]->second, engineFactory, context, buildFailedTrades(), emitStructuredError);
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+
+    Size failedTrades = 0;
+    for (Size i = 0; i < trades.size(); ++i) {
+        auto const& [ft, success] = results[i];
+        if (success)
+            continue;
+        if (ft) {
+            trades[i]->second = ft;
+            ++failedTrades;
+        } else {
+            trades_.erase(trades[i]);
+        }
+    }
+    return failedTrades;
+}
+
 Date Portfolio::maturity() const {
     QL_REQUIRE(trades_.size() > 0, "Cannot get maturity of an empty portfolio");
     Date mat = Date::minDate();
@@ -216,15 +556,65 @@ bool Portfolio::hasNettingSetDetails() const {
     return hasNettingSetDetails;
 }
 
-map<string, set<Date>> Portfolio::fixings(const Date& settlementDate) const {
-
-    map<string, set<Date>> result;
+map<string, set<Date>> Portfolio::fixings(const Date& settlementDate, const Size nThreads) const {
+
+    // the fixing dates are collected in vectors per index and sorted once at the end, which is much cheaper than
+    // inserting the dates of each trade into the result sets for portfolios with many overlapping fixings
+
+    Date d = settlementDate == Date() ? Settings::instance().evaluationDate() : settlementDate;
+    std::vector<boost::shared_ptr<Trade>> trades;
+    for (auto const& t : trades_)
+        trades.push_back(t.second);
+
+    Size nWorkers = 1;
+    if (nThreads > 1 && trades.size() > 1) {
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN) || defined(QL_ENABLE_SESSIONS)
+        WLOG("Portfolio: parallel fixings collection with "
+             << nThreads
+             << " threads requires a QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without "
+                "QL_ENABLE_SESSIONS, collect sequentially");
+#else
+        nWorkers = std::min(nThreads, trades.size());
+#endif
+    }
 
-    for (const auto& t : trades_) {
-        auto fixings = t.second->fixings(settlementDate);
-        for (const auto& kv : fixings) {
-            result[kv.first].insert(kv.second.begin(), kv.second.end());
+    std::vector<map<string, std::vector<Date>>> dates(nWorkers);
+    std::vector<std::exception_ptr> errors(nWorkers);
+    std::atomic<Size> next(0);
+    auto worker = [&trades, &dates, &errors, &next, &d](const Size w) {
+        try {
+            for (Size i = next++; i < trades.size(); i = next++) {
+                for (auto const& [index, fixingDates] : trades[i]->fixings(d)) {
+                    auto& v = dates[w][index];
+                    v.insert(v.end(), fixingDates.begin(), fixingDates.end());
+                }
+            }
+        } catch (...) {
+            errors[w] = std::current_exception();
         }
+    };
+    std::vector<std::thread> workers;
+    for (Size w = 1; w < nWorkers; ++w)
+        workers.emplace_back(worker, w);
+    worker(0);
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+
+    for (Size w = 1; w < nWorkers; ++w) {
+        for (auto& [index, v] : dates[w]) {
+            auto& target = dates[0][index];
+            target.insert(target.end(), v.begin(), v.end());
+            std::vector<Date>().swap(v);
+        }
+    }
+
+    map<string, set<Date>> result;
+    for (auto& [index, v] : dates[0]) {
+        std::sort(v.begin(), v.end());
+        result.emplace_hint(result.end(), index, set<Date>(v.begin(), std::unique(v.begin(), v.end())));
     }
 
     return result;
@@ -269,6 +659,8 @@ std::pair<boost::shared_ptr<Trade>, bool> buildTrade(boost::shared_ptr<Trade>& t
                                                      const boost::shared_ptr<EngineFactory>& engineFactory,
                                                      const std::string& context, const bool buildFailedTrades,
                                                      const bool emitStructuredError) {
+    TraceSpan span("portfolio", "Portfolio::buildTrade");
+    span.arg("tradeId", trade->id()).arg("tradeType", trade->tradeType());
     try {
         trade->reset();
         trade->build(engineFactory);
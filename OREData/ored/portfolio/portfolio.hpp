@@ -70,15 +70,42 @@ public:
     void fromXML(XMLNode* node) override;
     XMLNode* toXML(XMLDocument& doc) override;
 
+    using XMLSerializable::fromFile;
+    /*! Load the trades from a portfolio file without building the document of the whole file. The Trade elements are
+        read from the file in chunks of \p chunkSize trades, each chunk is parsed into a document of its own and its
+        trades are deserialised, the chunks on up to \p nThreads threads. So at most \p nThreads chunks are held in
+        memory at the same time. The trades are added in the order of the file, as in fromXML(). */
+    void fromFile(const std::string& filename, const QuantLib::Size nThreads, const QuantLib::Size chunkSize = 1000);
+
     //! Remove specified trade from the portfolio
     bool remove(const std::string& tradeID);
 
     //! Remove matured trades from portfolio for a given date, each removal is logged with an Alert
     void removeMatured(const QuantLib::Date& asof);
 
-    //! Call build on all trades in the portfolio, the context is included in error messages
+    /*! Call build on all trades in the portfolio, the context is included in error messages. If the market of the
+        engine factory records the requested market objects, the requests are attributed to the trades, see
+        marketRequests().
+
+        If more than one thread is given, the trades are built in parallel against the same engine factory. The
+        resulting portfolio, including the failed trades, is the same as for a sequential build. This requires a
+        QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without QL_ENABLE_SESSIONS, an engine factory
+        that supports concurrent builds (see EngineFactory::supportsConcurrentBuilds()), a market that does not record
+        requests and that can be read concurrently, e.g. a TodaysMarket that is not built lazily. Otherwise the trades
+        are built sequentially, except for the last condition which is the responsibility of the caller. */
     void build(const boost::shared_ptr<EngineFactory>&, const std::string& context = "unspecified",
-               const bool emitStructuredError = true);
+               const bool emitStructuredError = true, const QuantLib::Size nThreads = 1);
+
+    /*! The market objects requested by each trade during the last build(), this is only populated if the market
+        recorded the requests, see Market::recordingRequests(). Requests made while building a cached engine are
+        attributed to all trades using the engine, see CachingEngineBuilder. */
+    const std::map<std::string, std::set<std::pair<MarketObject, std::string>>>& marketRequests() const {
+        return marketRequests_;
+    }
+
+    /*! An estimate of the memory held by the built trades in bytes, this is the increase of the process memory
+        during the last build(). It is only measured if the MemoryAccounting is enabled. */
+    std::size_t memoryFootprint() const { return buildMemory_; }
 
     //! Calculates the maturity of the portfolio
     QuantLib::Date maturity() const;
@@ -109,11 +136,13 @@ public:
 
     /*! Return the fixings that will be requested in order to price every Trade in this Portfolio given
         the \p settlementDate. The map key is the ORE name of the index and the map value is the set of fixing dates.
+        The fixings of the trades are collected on up to \p nThreads threads, this requires a QuantLib build with
+        QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN and without QL_ENABLE_SESSIONS.
 
         \warning This method will return an empty map if the Portfolio has not been built.
     */
     std::map<std::string, std::set<QuantLib::Date>>
-    fixings(const QuantLib::Date& settlementDate = QuantLib::Date()) const;
+    fixings(const QuantLib::Date& settlementDate = QuantLib::Date(), const QuantLib::Size nThreads = 1) const;
 
     /*! Returns the names of the underlying instruments for each asset class */
     std::map<AssetClass, std::set<std::string>>
@@ -123,9 +152,18 @@ public:
                       const boost::shared_ptr<ReferenceDataManager>& referenceDataManager = nullptr);
 
 private:
+    //! add a trade read from xml, an error is logged if this fails
+    void addLoadedTrade(const boost::shared_ptr<Trade>& trade);
+
+    //! build the trades on several threads, returns the number of failed trades
+    QuantLib::Size buildParallel(const boost::shared_ptr<EngineFactory>& engineFactory, const std::string& context,
+                                 const bool emitStructuredError, const QuantLib::Size nThreads);
+
     bool buildFailedTrades_;
     std::map<std::string, boost::shared_ptr<Trade>> trades_;
     std::map<AssetClass, std::set<std::string>> underlyingIndicesCache_;
+    std::map<std::string, std::set<std::pair<MarketObject, std::string>>> marketRequests_;
+    std::size_t buildMemory_ = 0;
 };
 
 std::pair<boost::shared_ptr<Trade>, bool> buildTrade(boost::shared_ptr<Trade>& trade,
@@ -499,8 +499,62 @@ void BasicReferenceDataManager::fromXML(XMLNode* node) {
     }
 }
 
+void BasicReferenceDataManager::appendData(const string& filename) {
+    if (!lazy_) {
+        fromFile(filename);
+        return;
+    }
+    auto doc = boost::make_shared<XMLDocument>(filename);
+    XMLNode* node = doc->getFirstNode("ReferenceData");
+    XMLUtils::checkNode(node, "ReferenceData");
+    Size n = 0;
+    for (XMLNode* child = XMLUtils::getChildNode(node, "ReferenceDatum"); child;
+         child = XMLUtils::getNextSibling(child, "ReferenceDatum")) {
+        string type = XMLUtils::getChildValue(child, "Type", false);
+        if (type.empty()) {
+            ALOG("Found referenceDatum without Type - skipping");
+            continue;
+        }
+        string id = XMLUtils::getAttribute(child, "id");
+        if (id.empty()) {
+            ALOG("Found referenceDatum without id - skipping");
+            continue;
+        }
+        string validFromStr = XMLUtils::getAttribute(child, "validFrom");
+        Date validFrom = validFromStr.empty() ? Date::minDate() : parseDate(validFromStr);
+        auto key = make_pair(type, id);
+        auto d = data_.find(key);
+        auto& nodes = unparsed_[key];
+        if ((d != data_.end() && d->second.count(validFrom) > 0) || nodes.count(validFrom) > 0) {
+            duplicates_.insert(make_tuple(type, id, validFrom));
+            ALOG("Found duplicate referenceDatum for type='" << type << "', id='" << id << "', validFrom='"
+                                                             << validFrom << "'");
+            continue;
+        }
+        nodes[validFrom] = child;
+        ++n;
+    }
+    documents_.push_back(doc);
+    LOG("BasicReferenceDataManager: indexed " << n << " reference data entries in " << filename
+                                              << ", they are built on first use");
+}
+
+void BasicReferenceDataManager::parse(const string& type, const string& id) {
+    auto u = unparsed_.find(make_pair(type, id));
+    if (u == unparsed_.end())
+        return;
+    // move the nodes out first, addFromXMLNode() would see them as duplicates otherwise
+    auto nodes = std::move(u->second);
+    unparsed_.erase(u);
+    for (auto const& [validFrom, node] : nodes)
+        addFromXMLNode(node, id, validFrom);
+}
+
 void BasicReferenceDataManager::add(const boost::shared_ptr<ReferenceDatum>& rd) {
     // Add reference datum, it is overwritten if it is already present.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto u = unparsed_.find(make_pair(rd->type(), rd->id())); u != unparsed_.end())
+        u->second.erase(rd->validFrom());
     data_[make_pair(rd->type(), rd->id())][rd->validFrom()] = rd;
 }
 
@@ -567,6 +621,11 @@ boost::shared_ptr<ReferenceDatum> BasicReferenceDataManager::buildReferenceDatum
 }
 
 XMLNode* BasicReferenceDataManager::toXML(XMLDocument& doc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!unparsed_.empty()) {
+        auto key = unparsed_.begin()->first;
+        parse(key.first, key.second);
+    }
     XMLNode* node = doc.allocNode("ReferenceData");
     for (const auto& kv : data_) {
         for (const auto& [_, refData] : kv.second) {
@@ -604,6 +663,9 @@ void BasicReferenceDataManager::check(const string& type, const string& id, cons
 }
 
 bool BasicReferenceDataManager::hasData(const string& type, const string& id, const QuantLib::Date& asof) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // building lazily loaded data does not change the observable state of the manager
+    const_cast<BasicReferenceDataManager*>(this)->parse(type, id);
     Date asofDate = asof;
     if (asofDate == QuantLib::Null<QuantLib::Date>()) {
         asofDate = Settings::instance().evaluationDate();
@@ -615,6 +677,8 @@ bool BasicReferenceDataManager::hasData(const string& type, const string& id, co
 
 boost::shared_ptr<ReferenceDatum> BasicReferenceDataManager::getData(const string& type, const string& id,
                                                                      const QuantLib::Date& asof) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    parse(type, id);
     Date asofDate = asof;
     if (asofDate == QuantLib::Null<QuantLib::Date>()) {
         asofDate = Settings::instance().evaluationDate();
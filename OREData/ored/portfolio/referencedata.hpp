@@ -30,6 +30,7 @@
 #include <ql/patterns/singleton.hpp>
 #include <ql/time/date.hpp>
 #include <ql/time/period.hpp>
+#include <mutex>
 #include <set>
 #include <tuple>
 
@@ -477,13 +478,18 @@ public:
 };
 
 //! Basic Concrete impl that loads an big XML and keeps data in memory
+/*! If lazy is set, the files are only scanned for the type, id and validFrom of the reference data when they are
+    loaded, and the data is built from its xml node on the first hasData() or getData() query for its type and id. The
+    xml documents are kept in memory for this. This is useful for large reference data files, of which only a small
+    part is used in a run. The queries are guarded by a mutex, so that the manager can be shared by parallel trade
+    builds. */
 class BasicReferenceDataManager : public ReferenceDataManager, public XMLSerializable {
 public:
     BasicReferenceDataManager() {}
-    BasicReferenceDataManager(const string& filename) { fromFile(filename); }
+    BasicReferenceDataManager(const string& filename, const bool lazy = false) : lazy_(lazy) { appendData(filename); }
 
     // Load extra data and append to this manger
-    void appendData(const string& filename) { fromFile(filename); }
+    void appendData(const string& filename);
 
     boost::shared_ptr<ReferenceDatum> buildReferenceDatum(const string& refDataType);
 
@@ -491,7 +497,11 @@ public:
     XMLNode* toXML(ore::data::XMLDocument& doc) override;
 
     // clear this ReferenceData manager, note that we can load multiple files
-    void clear() { data_.clear(); }
+    void clear() {
+        data_.clear();
+        unparsed_.clear();
+        documents_.clear();
+    }
 
     bool hasData(const string& type, const string& id,
                  const QuantLib::Date& asof = QuantLib::Null<QuantLib::Date>()) const override;
@@ -509,6 +519,15 @@ protected:
     map<std::pair<string, string>, std::map<QuantLib::Date, boost::shared_ptr<ReferenceDatum>>> data_;
     std::set<std::tuple<string, string, QuantLib::Date>> duplicates_;
     map<std::pair<string, string>, std::map<QuantLib::Date, string>> buildErrors_;
+
+private:
+    // build the data for type and id from the unparsed xml nodes in lazy mode
+    void parse(const string& type, const string& id);
+
+    bool lazy_ = false;
+    map<std::pair<string, string>, std::map<QuantLib::Date, XMLNode*>> unparsed_;
+    std::vector<boost::shared_ptr<XMLDocument>> documents_;
+    mutable std::mutex mutex_;
 };
 
 } // namespace data
@@ -35,6 +35,8 @@
 #include <ql/instruments/swap.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <typeinfo>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using std::make_pair;
@@ -342,6 +344,13 @@ void Swap::fromXML(XMLNode* node) {
 
 boost::shared_ptr<LegData> Swap::createLegData() const { return boost::make_shared<LegData>(); }
 
+boost::shared_ptr<Trade> Swap::copy() const {
+    // a copy as Swap would slice derived trades
+    if (typeid(*this) != typeid(Swap))
+        return Trade::copy();
+    return boost::make_shared<Swap>(*this);
+}
+
 XMLNode* Swap::toXML(XMLDocument& doc) {
     XMLNode* node = Trade::toXML(doc);
     XMLNode* swapNode = doc.allocNode(tradeType() + "Data");
@@ -74,6 +74,9 @@ public:
     const std::map<std::string,boost::any>& additionalData() const override;
 
 protected:
+    //! Copy the parsed trade data, trades derived from Swap use the default implementation
+    boost::shared_ptr<Trade> copy() const override;
+
     virtual boost::shared_ptr<LegData> createLegData() const;
 
     vector<LegData> legData_;
@@ -54,6 +54,25 @@ XMLNode* Trade::toXML(XMLDocument& doc) {
     return node;
 }
 
+boost::shared_ptr<Trade> Trade::cloneForMarket(const boost::shared_ptr<EngineFactory>& engineFactory) const {
+    boost::shared_ptr<Trade> trade = copy();
+    QL_REQUIRE(trade, "Trade::cloneForMarket(): could not copy trade " << id_);
+    trade->reset();
+    trade->resetPricingStats();
+    trade->build(engineFactory);
+    return trade;
+}
+
+boost::shared_ptr<Trade> Trade::copy() const {
+    XMLDocument doc;
+    // toXML() does not modify the trade, it is just not declared const
+    XMLNode* node = const_cast<Trade*>(this)->toXML(doc);
+    boost::shared_ptr<Trade> trade = TradeFactory::instance().build(tradeType_);
+    trade->fromXML(node);
+    trade->id() = id_;
+    return trade;
+}
+
 Date Trade::addPremiums(std::vector<boost::shared_ptr<Instrument>>& addInstruments, std::vector<Real>& addMultipliers,
                         const Real tradeMultiplier, const PremiumData& premiumData, const Real premiumMultiplier,
                         const Currency& tradeCurrency, const boost::shared_ptr<EngineFactory>& factory,
@@ -71,6 +71,11 @@ public:
         be called between these calls. */
     virtual void build(const boost::shared_ptr<EngineFactory>&) = 0;
 
+    /*! Return a copy of this trade built against the given engine factory, e.g. one per thread for a parallel
+        pricing on different markets. The copy is made from the parsed trade data, see copy(), so the trade data is
+        not serialised and parsed again. This trade is not modified. */
+    boost::shared_ptr<Trade> cloneForMarket(const boost::shared_ptr<EngineFactory>& engineFactory) const;
+
     /*! Return the fixings that will be requested in order to price this Trade given the \p settlementDate.
 
 
@@ -211,6 +216,11 @@ protected:
                      const Currency& tradeCurrency, const boost::shared_ptr<EngineFactory>& factory,
                      const string& configuration);
 
+    /*! Return an unbuilt copy of this trade used by cloneForMarket(). The default implementation serialises the
+        trade to XML and reads it into a new instance from the TradeFactory. Derived classes holding only parsed
+        trade data can override this to copy the data directly. */
+    virtual boost::shared_ptr<Trade> copy() const;
+
     RequiredFixings requiredFixings_;
     mutable std::map<std::string,boost::any> additionalData_;
 
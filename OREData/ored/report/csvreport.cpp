@@ -21,67 +21,112 @@
 #include <boost/filesystem/operations.hpp>
 #include <ored/report/csvreport.hpp>
 #include <ored/utilities/fileio.hpp>
+#include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
 #include <ql/errors.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/math/rounding.hpp>
 
+#ifdef ORE_USE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <thread>
+
 using std::string;
 
 namespace ore {
 namespace data {
 
-// Local class for printing each report type via fprintf
+namespace {
+// size of the output buffer
+const Size bufferCapacity = 4 * 1024 * 1024;
+
+bool isGzipFilename(const string& filename) {
+    return filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+}
+
+void appendSize(string& out, const Size i) {
+    char buf[32];
+    auto r = std::to_chars(buf, buf + sizeof(buf), i);
+    out.append(buf, r.ptr);
+}
+
+void appendReal(string& out, const Real d, const int precision) {
+    char buf[512];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // correctly rounded fixed notation, this gives the same output as printf("%.*f")
+    auto r = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::fixed, precision);
+    if (r.ec == std::errc()) {
+        out.append(buf, r.ptr);
+        return;
+    }
+#endif
+    int n = snprintf(buf, sizeof(buf), "%.*f", precision, d);
+    if (n >= 0 && static_cast<Size>(n) < sizeof(buf)) {
+        out.append(buf, n);
+    } else {
+        std::vector<char> large(n + 1);
+        snprintf(large.data(), large.size(), "%.*f", precision, d);
+        out.append(large.data(), n);
+    }
+}
+} // namespace
+
+// Local class for formatting each report type into a string
 class ReportTypePrinter : public boost::static_visitor<> {
 public:
-    ReportTypePrinter(FILE* fp, int prec, char quoteChar = '\0', const string& nullString = "#N/A")
-        : fp_(fp), rounding_(prec, QuantLib::Rounding::Closest), quoteChar_(quoteChar), null_(nullString) {}
+    ReportTypePrinter(string* out, int prec, char quoteChar = '\0', const string& nullString = "#N/A")
+        : out_(out), rounding_(prec, QuantLib::Rounding::Closest), quoteChar_(quoteChar), null_(nullString) {}
 
     void operator()(const Size i) const {
         if (i == QuantLib::Null<Size>()) {
-            fprintNull();
+            printNull();
         } else {
-            fprintf(fp_, "%zu", i);
+            appendSize(*out_, i);
         }
     }
     void operator()(const Real d) const {
         if (d == QuantLib::Null<Real>() || !std::isfinite(d)) {
-            fprintNull();
+            printNull();
         } else {
             Real r = rounding_(d);
-            fprintf(fp_, "%.*f", rounding_.precision(), QuantLib::close_enough(r, 0.0) ? 0.0 : r);
+            appendReal(*out_, QuantLib::close_enough(r, 0.0) ? 0.0 : r, rounding_.precision());
         }
     }
-    void operator()(const string& s) const { fprintString(s); }
+    void operator()(const string& s) const { printString(s); }
     void operator()(const Date& d) const {
         if (d == QuantLib::Null<Date>()) {
-            fprintNull();
+            printNull();
         } else {
             string s = to_string(d);
-            fprintString(s);
+            printString(s);
         }
     }
     void operator()(const Period& p) const {
         string s = to_string(p);
-        fprintString(s);
+        printString(s);
     }
 
-    void updateFile(FILE* fp) { fp_ = fp; }
+    void updateOutput(string* out) { out_ = out; }
 
 private:
-    void fprintNull() const { fprintf(fp_, "%s", null_.c_str()); }
+    void printNull() const { out_->append(null_); }
 
     // Shared implementation to include the quote character.
-    void fprintString(const string& s) const {
+    void printString(const string& s) const {
         bool quoted = s.size() > 1 && s[0] == quoteChar_ && s[s.size() - 1] == quoteChar_;
         if (!quoted && quoteChar_ != '\0')
-            fputc(quoteChar_, fp_);
-        fprintf(fp_, "%s", s.c_str());
+            out_->push_back(quoteChar_);
+        out_->append(s);
         if (!quoted && quoteChar_ != '\0')
-            fputc(quoteChar_, fp_);
+            out_->push_back(quoteChar_);
     }
 
-    FILE* fp_;
+    string* out_;
     QuantLib::Rounding rounding_;
     char quoteChar_;
     string null_;
@@ -93,6 +138,7 @@ CSVFileReport::CSVFileReport(const string& filename, const char sep, const bool
     : filename_(filename), sep_(sep), commentCharacter_(commentCharacter), quoteChar_(quoteChar),
       nullString_(nullString), lowerHeader_(lowerHeader), rolloverSize_(rolloverSize), i_(0), fp_(NULL) {    
     baseFilename_ = filename_;
+    buffer_.reserve(bufferCapacity);
     open();
 }
 
@@ -105,10 +151,19 @@ CSVFileReport::~CSVFileReport() {
 
 void CSVFileReport::open() {
     LOG("Opening CSV file report '" << filename_ << "'");
-    fp_ = FileIO::fopen(filename_.c_str(), "w");
-    QL_REQUIRE(fp_, "Error opening file '" << filename_ << "'");
-    for (auto& p : printers_)
-        p.updateFile(fp_);
+    if (isGzipFilename(filename_)) {
+#ifdef ORE_USE_ZLIB
+        gz_ = gzopen(filename_.c_str(), "wb");
+        QL_REQUIRE(gz_, "Error opening file '" << filename_ << "'");
+#else
+        QL_FAIL("Can not write compressed report '" << filename_
+                                                    << "', ORE was built without compression support (ORE_USE_ZLIB)");
+#endif
+    } else {
+        fp_ = FileIO::fopen(filename_.c_str(), "w");
+        QL_REQUIRE(fp_, "Error opening file '" << filename_ << "'");
+    }
+    bytesWritten_ = 0;
     finalized_ = false;
 }
 
@@ -126,41 +181,80 @@ void CSVFileReport::rollover() {
 void CSVFileReport::flush() {
     checkIsOpen("flush()");
     LOG("CVS file report '" << filename_ << "' is flushed");
-    fflush(fp_);
+    writeBuffer();
+#ifdef ORE_USE_ZLIB
+    if (gz_)
+        gzflush(gz_, Z_SYNC_FLUSH);
+#endif
+    if (fp_)
+        fflush(fp_);
+}
+
+void CSVFileReport::write(const char* s, Size n) {
+    if (buffer_.size() + n > bufferCapacity)
+        writeBuffer();
+    // large chunks are written directly
+    if (n >= bufferCapacity)
+        writeToFile(s, n);
+    else
+        buffer_.append(s, n);
+}
+
+void CSVFileReport::writeBuffer() {
+    writeToFile(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+void CSVFileReport::writeToFile(const char* s, Size n) {
+    if (n == 0)
+        return;
+#ifdef ORE_USE_ZLIB
+    if (gz_) {
+        int written = gzwrite(gz_, s, static_cast<unsigned>(n));
+        QL_REQUIRE(written == static_cast<int>(n), "Error writing to file '" << filename_ << "'");
+    }
+#endif
+    if (fp_) {
+        Size written = fwrite(s, sizeof(char), n, fp_);
+        QL_REQUIRE(written == n, "Error writing to file '" << filename_ << "'");
+    }
+    bytesWritten_ += n;
+}
+
+void CSVFileReport::checkRollover() {
+    // the size is tracked in memory, the check is done for each row
+    if (rolloverSize_ != Null<Size>()) {
+        Size fileSize = bytesWritten_ + buffer_.size();
+        if (fileSize > rolloverSize_ * 1024 * 1024) {
+            TLOG("CSV size of " << filename_ << " is " << fileSize);
+            rollover();
+        }
+    }
 }
 
 Report& CSVFileReport::addColumn(const string& name, const ReportType& rt, Size precision) {
     checkIsOpen("addColumn(" + name + ")");
     columnTypes_.push_back(rt);
-    printers_.push_back(ReportTypePrinter(fp_, precision, quoteChar_, nullString_));
+    printers_.push_back(ReportTypePrinter(&buffer_, precision, quoteChar_, nullString_));
     if (i_ == 0 && commentCharacter_)
-        fprintf(fp_, "#");
+        buffer_.push_back('#');
     if (i_ > 0)
-        fprintf(fp_, "%c", sep_);
+        buffer_.push_back(sep_);
     string cpName = name;
     if (lowerHeader_ && !cpName.empty())
         cpName[0] = std::tolower(static_cast<unsigned char>(cpName[0]));
-    fprintf(fp_, "%s", cpName.c_str());
+    write(cpName);
     i_++;
     return *this;
 }
 
 Report& CSVFileReport::next() {
-    // check the filesize every for every 1000 rows, and roll if necessary
-    if (rolloverSize_ != Null<Size>()) {     
-        if (j_ >= 10000) {
-            auto fileSize = boost::filesystem::file_size(filename_);
-            TLOG("CSV size of " << filename_ << " is " << fileSize);
-            if (fileSize > rolloverSize_ * 1024 * 1024)
-                rollover();
-            j_ = 0;
-        } else
-            j_++;
-    }
-
+    checkRollover();
     checkIsOpen("next()");
     QL_REQUIRE(i_ == columnTypes_.size(), "Cannot go to next line, only " << i_ << " entries filled");
-    fprintf(fp_, "\n");
+    buffer_.push_back('\n');
+    if (buffer_.size() > bufferCapacity)
+        writeBuffer();
     i_ = 0;    
     return *this;
 }
@@ -173,22 +267,106 @@ Report& CSVFileReport::add(const ReportType& rt) {
                                                                            << columnTypes_[i_].which());
 
     if (i_ != 0)
-        fprintf(fp_, "%c", sep_);
+        buffer_.push_back(sep_);
     boost::apply_visitor(printers_[i_], rt);
     i_++;
     return *this;
 }
 
+void CSVFileReport::addRows(Size rows, const CellFunction& cell, Size threads, Size blockSize) {
+    checkIsOpen("addRows()");
+    QL_REQUIRE(i_ == columnTypes_.size(), "Cannot add rows, only " << i_ << " entries filled in current row");
+    QL_REQUIRE(blockSize > 0, "CSVFileReport::addRows(): block size must be positive");
+    threads = std::max<Size>(1, threads);
+    Size nBlocks = (rows + blockSize - 1) / blockSize;
+
+    // formats the rows of block b into out, using its own copy of the printers
+    auto format = [this, rows, blockSize, &cell](const Size b, std::vector<ReportTypePrinter>& printers,
+                                                 string& out) {
+        out.clear();
+        for (auto& p : printers)
+            p.updateOutput(&out);
+        for (Size r = b * blockSize; r < std::min(rows, (b + 1) * blockSize); ++r) {
+            out.push_back('\n');
+            for (Size c = 0; c < columnTypes_.size(); ++c) {
+                if (c != 0)
+                    out.push_back(sep_);
+                ReportType v = cell(r, c);
+                QL_REQUIRE(v.which() == columnTypes_[c].which(), "Cannot add value " << v << " of type " << v.which()
+                                                                                     << " to column " << c
+                                                                                     << " of type "
+                                                                                     << columnTypes_[c].which());
+                boost::apply_visitor(printers[c], v);
+            }
+        }
+    };
+
+    // the blocks are processed in rounds of one block per thread, each round is written in order
+    std::vector<string> blocks(std::min(threads, nBlocks));
+    std::vector<std::vector<ReportTypePrinter>> printers(blocks.size(), printers_);
+    for (Size first = 0; first < nBlocks; first += blocks.size()) {
+        Size n = std::min(blocks.size(), nBlocks - first);
+        if (threads == 1 || n == 1) {
+            for (Size k = 0; k < n; ++k)
+                format(first + k, printers[k], blocks[k]);
+        } else {
+            std::atomic<Size> nextBlock(0);
+            std::vector<std::exception_ptr> errors(n);
+            auto worker = [&]() {
+                for (Size k = nextBlock++; k < n; k = nextBlock++) {
+                    try {
+                        format(first + k, printers[k], blocks[k]);
+                    } catch (...) {
+                        errors[k] = std::current_exception();
+                    }
+                }
+            };
+            std::vector<std::thread> workers;
+            for (Size t = 1; t < n; ++t)
+                workers.emplace_back(worker);
+            worker();
+            for (auto& w : workers)
+                w.join();
+            for (auto const& e : errors) {
+                if (e)
+                    std::rethrow_exception(e);
+            }
+        }
+        for (Size k = 0; k < n; ++k) {
+            write(blocks[k]);
+            checkRollover();
+        }
+    }
+}
+
 void CSVFileReport::end() {
     checkIsOpen("end()");
 
+    buffer_.push_back('\n');
+    try {
+        writeBuffer();
+    } catch (const std::exception& e) {
+        ALOG("CSV file report '" << filename_ << "' can not be written: " << e.what());
+        buffer_.clear();
+    }
+
+#ifdef ORE_USE_ZLIB
+    if (gz_) {
+        if (int rc = gzclose(gz_)) {
+            ALOG("CSV file report '" << filename_ << "' can not be closed (return code " << rc << ")");
+        } else {
+            LOG("CSV file report '" << filename_ << "' closed.");
+        }
+        gz_ = nullptr;
+    } else
+#endif
     if (fp_) {
-        fprintf(fp_, "\n");
         if (int rc = fclose(fp_)) {
             ALOG("CSV file report '" << filename_ << "' can not be closed (return code " << rc << ")");
         } else {
             LOG("CSV file report '" << filename_ << "' closed.");
         }
+        fp_ = NULL;
     } else {
         ALOG("CSV file report '" << filename_ << "' can not be closed (file handle is null).");
     }
@@ -24,15 +24,22 @@
 #pragma once
 
 #include <ored/report/report.hpp>
+#include <functional>
 #include <stdio.h>
+#include <string>
 #include <vector>
 
+struct gzFile_s;
+
 namespace ore {
 namespace data {
 
 class ReportTypePrinter;
 /*! CSV Report class
 
+    The output is formatted into a memory buffer which is written to the file when it is full, on flush() and on
+    end(). If the filename ends with .gz, the file is gzip compressed, this requires ORE_USE_ZLIB.
+
 \ingroup report
 */
 class CSVFileReport : public Report {
@@ -60,8 +67,20 @@ public:
     void end() override;
     void flush() override;
 
+    //! Function returning the value of a cell given the row and the column
+    typedef std::function<ReportType(Size, Size)> CellFunction;
+    /*! Add \p rows rows with the cells given by \p cell, the current row must be complete. The rows are formatted in
+        blocks of \p blockSize rows, with \p threads > 1 blocks are formatted concurrently and written in order.
+        The cell function must be safe to call concurrently in this case. */
+    void addRows(Size rows, const CellFunction& cell, Size threads = 1, Size blockSize = 10000);
+
 private:
     void checkIsOpen(const std::string& op) const;
+    void write(const char* s, Size n);
+    void write(const std::string& s) { write(s.data(), s.size()); }
+    void writeBuffer();
+    void writeToFile(const char* s, Size n);
+    void checkRollover();
 
     std::vector<ReportType> columnTypes_;
     std::vector<ReportTypePrinter> printers_;
@@ -75,7 +94,11 @@ private:
     Size i_, j_ = 0;
     Size version_ = 0;
     FILE* fp_;
+    gzFile_s* gz_ = nullptr;
     bool finalized_ = false;
+    // pending output and the number of bytes written to the current file so far
+    std::string buffer_;
+    Size bytesWritten_ = 0;
 };
 } // namespace data
 } // namespace ore
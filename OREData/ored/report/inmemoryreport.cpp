@@ -0,0 +1,260 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/report/inmemoryreport.hpp>
+
+namespace ore {
+namespace data {
+
+Report& InMemoryReport::addColumn(const string& name, const ReportType& rt, Size precision) {
+    headers_.push_back(name);
+    columnTypes_.push_back(rt);
+    columnPrecision_.push_back(precision);
+    data_.push_back(Column());
+    i_++;
+    return *this;
+}
+
+Report& InMemoryReport::next() {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot go to next line, only " << i_ << " entires filled");
+    i_ = 0;
+    return *this;
+}
+
+Report& InMemoryReport::add(const ReportType& rt) {
+    // check type is valid
+    QL_REQUIRE(i_ < headers_.size(), "No column to add [" << rt << "] to.");
+    QL_REQUIRE(rt.which() == columnTypes_[i_].which(),
+               "Cannot add value " << rt << " of type " << rt.which() << " to column " << headers_[i_] << " of type "
+                                   << columnTypes_[i_].which());
+
+    Column& c = data_[i_];
+    switch (rt.which()) {
+    case 0:
+        c.sizes.push_back(boost::get<Size>(rt));
+        break;
+    case 1:
+        c.reals.push_back(boost::get<Real>(rt));
+        break;
+    case 2:
+        c.strings.push_back(internString(boost::get<string>(rt)));
+        break;
+    case 3:
+        c.dates.push_back(boost::get<Date>(rt));
+        break;
+    default:
+        c.periods.push_back(boost::get<Period>(rt));
+        break;
+    }
+    i_++;
+    return *this;
+}
+
+Report& InMemoryReport::add(const InMemoryReport& report) {
+    QL_REQUIRE(columns() == report.columns(),
+               "Cannot combine reports of different sizes (" << columns() << " vs " << report.columns() << ").");
+    end();
+    for (Size i = 0; i < columns(); i++) {
+        string h1 = headers_[i];
+        string h2 = report.header(i);
+        QL_REQUIRE(h1 == h2, "Cannot combine reports with different headers (\"" << h1 << "\" and \"" << h2 << "\")");
+        QL_REQUIRE(columnTypes_[i].which() == report.columnType(i).which(),
+                   "Cannot combine reports with different types in column " << h1);
+    }
+
+    // append column by column, the strings are interned in this report's string table
+    for (Size i = 0; i < columns(); i++) {
+        const Column& c = report.data_[i];
+        switch (columnTypes_[i].which()) {
+        case 0:
+            appendColumn(data_[i].sizes, c.sizes);
+            break;
+        case 1:
+            appendColumn(data_[i].reals, c.reals);
+            break;
+        case 2:
+            for (auto id : c.strings)
+                data_[i].strings.push_back(internString(report.internedString(id)));
+            break;
+        case 3:
+            appendColumn(data_[i].dates, c.dates);
+            break;
+        default:
+            appendColumn(data_[i].periods, c.periods);
+            break;
+        }
+    }
+
+    if (columns() > 0)
+        i_ = 0;
+    return *this;
+}
+
+void InMemoryReport::end() {
+    QL_REQUIRE(i_ == headers_.size() || i_ == 0,
+               "report is finalized with incomplete row, got data for " << i_ << " columns out of " << columns());
+    for (Size i = 1; i < columns(); ++i) {
+        QL_REQUIRE(columnSize(i) == columnSize(0), "report is finalized with column "
+                                                       << i << " (" << header(i) << ") containing " << columnSize(i)
+                                                       << " rows, expected are " << columnSize(0) << " rows.");
+    }
+}
+
+InMemoryReport& InMemoryReport::addColumnData(Size i, const vector<Size>& values) {
+    checkColumn(i, 0, "addColumnData");
+    QL_REQUIRE(i_ == 0 || i_ == headers_.size(), "InMemoryReport::addColumnData(): row in progress");
+    appendColumn(data_[i].sizes, values);
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::addColumnData(Size i, const vector<Real>& values) {
+    checkColumn(i, 1, "addColumnData");
+    QL_REQUIRE(i_ == 0 || i_ == headers_.size(), "InMemoryReport::addColumnData(): row in progress");
+    appendColumn(data_[i].reals, values);
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::addColumnData(Size i, const vector<string>& values) {
+    checkColumn(i, 2, "addColumnData");
+    QL_REQUIRE(i_ == 0 || i_ == headers_.size(), "InMemoryReport::addColumnData(): row in progress");
+    vector<Size>& ids = data_[i].strings;
+    ids.reserve(ids.size() + values.size());
+    for (auto const& v : values)
+        ids.push_back(internString(v));
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::addColumnData(Size i, const vector<Date>& values) {
+    checkColumn(i, 3, "addColumnData");
+    QL_REQUIRE(i_ == 0 || i_ == headers_.size(), "InMemoryReport::addColumnData(): row in progress");
+    appendColumn(data_[i].dates, values);
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::addColumnData(Size i, const vector<Period>& values) {
+    checkColumn(i, 4, "addColumnData");
+    QL_REQUIRE(i_ == 0 || i_ == headers_.size(), "InMemoryReport::addColumnData(): row in progress");
+    appendColumn(data_[i].periods, values);
+    return *this;
+}
+
+vector<Report::ReportType> InMemoryReport::data(Size i) const {
+    QL_REQUIRE(columnSize(i) == rows(), "internal error: report column "
+                                            << i << " (" << header(i) << ") contains " << columnSize(i)
+                                            << " rows, expected are " << rows() << " rows.");
+    vector<ReportType> result;
+    result.reserve(rows());
+    for (Size j = 0; j < rows(); ++j)
+        result.push_back(value(i, j));
+    return result;
+}
+
+Report::ReportType InMemoryReport::value(Size i, Size j) const {
+    QL_REQUIRE(i < columns(), "InMemoryReport::value(): column " << i << " out of range, report has " << columns()
+                                                                 << " columns");
+    QL_REQUIRE(j < columnSize(i), "InMemoryReport::value(): row " << j << " out of range, column " << header(i)
+                                                                  << " has " << columnSize(i) << " rows");
+    const Column& c = data_[i];
+    switch (columnTypes_[i].which()) {
+    case 0:
+        return c.sizes[j];
+    case 1:
+        return c.reals[j];
+    case 2:
+        return strings_[c.strings[j]];
+    case 3:
+        return c.dates[j];
+    default:
+        return c.periods[j];
+    }
+}
+
+const vector<Size>& InMemoryReport::sizeColumn(Size i) const {
+    checkColumn(i, 0, "sizeColumn");
+    return data_[i].sizes;
+}
+
+const vector<Real>& InMemoryReport::realColumn(Size i) const {
+    checkColumn(i, 1, "realColumn");
+    return data_[i].reals;
+}
+
+const vector<Size>& InMemoryReport::stringIdColumn(Size i) const {
+    checkColumn(i, 2, "stringIdColumn");
+    return data_[i].strings;
+}
+
+const vector<Date>& InMemoryReport::dateColumn(Size i) const {
+    checkColumn(i, 3, "dateColumn");
+    return data_[i].dates;
+}
+
+const vector<Period>& InMemoryReport::periodColumn(Size i) const {
+    checkColumn(i, 4, "periodColumn");
+    return data_[i].periods;
+}
+
+void InMemoryReport::toFile(const string& filename, const char sep, const bool commentCharacter, char quoteChar,
+                            const string& nullString, bool lowerHeader, Size threads) {
+
+    CSVFileReport cReport(filename, sep, commentCharacter, quoteChar, nullString, lowerHeader);
+
+    for (Size i = 0; i < headers_.size(); i++) {
+        cReport.addColumn(headers_[i], columnTypes_[i], columnPrecision_[i]);
+    }
+
+    if (columns() > 0)
+        cReport.addRows(rows(), [this](Size row, Size column) { return value(column, row); }, threads);
+
+    cReport.end();
+}
+
+Size InMemoryReport::columnSize(Size i) const {
+    const Column& c = data_.at(i);
+    switch (columnTypes_[i].which()) {
+    case 0:
+        return c.sizes.size();
+    case 1:
+        return c.reals.size();
+    case 2:
+        return c.strings.size();
+    case 3:
+        return c.dates.size();
+    default:
+        return c.periods.size();
+    }
+}
+
+Size InMemoryReport::internString(const string& s) {
+    auto it = stringIds_.emplace(s, strings_.size());
+    if (it.second)
+        strings_.push_back(s);
+    return it.first->second;
+}
+
+void InMemoryReport::checkColumn(Size i, int which, const char* method) const {
+    QL_REQUIRE(i < columns(),
+               "InMemoryReport::" << method << "(): column " << i << " out of range, report has " << columns()
+                                  << " columns");
+    QL_REQUIRE(columnTypes_[i].which() == which, "InMemoryReport::" << method << "(): column " << header(i)
+                                                                    << " has type " << columnTypes_[i].which()
+                                                                    << ", expected " << which);
+}
+
+} // namespace data
+} // namespace ore
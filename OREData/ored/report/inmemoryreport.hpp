@@ -26,7 +26,11 @@
 #include <ored/report/csvreport.hpp>
 #include <ored/report/report.hpp>
 #include <ql/errors.hpp>
+
+#include <algorithm>
+#include <unordered_map>
 #include <vector>
+
 namespace ore {
 namespace data {
 using std::string;
@@ -34,112 +38,87 @@ using std::vector;
 
 /*! InMemoryReport just stores report information in local vectors and provides an interface to access
  *  the values. It could be used as a backend to a GUI
+
+    The columns are stored in typed vectors, strings are interned per report and stored as ids into the string
+    table of the report. Besides the row wise Report interface whole columns can be appended with addColumnData().
  \ingroup report
  */
 class InMemoryReport : public Report {
 public:
     InMemoryReport() : i_(0) {}
 
-    Report& addColumn(const string& name, const ReportType& rt, Size precision = 0) override {
-        headers_.push_back(name);
-        columnTypes_.push_back(rt);
-        columnPrecision_.push_back(precision);
-        data_.push_back(vector<ReportType>()); // Initialise vector for
-        i_++;
-        return *this;
-    }
-
-    Report& next() override {
-        QL_REQUIRE(i_ == headers_.size(), "Cannot go to next line, only " << i_ << " entires filled");
-        i_ = 0;
-        return *this;
-    }
-
-    Report& add(const ReportType& rt) override {
-        // check type is valid
-        QL_REQUIRE(i_ < headers_.size(), "No column to add [" << rt << "] to.");
-        QL_REQUIRE(rt.which() == columnTypes_[i_].which(),
-                   "Cannot add value " << rt << " of type " << rt.which() << " to column " << headers_[i_]
-                                       << " of type " << columnTypes_[i_].which());
-
-        data_[i_].push_back(rt);
-        i_++;
-        return *this;
-    }
-
-    Report& add(const InMemoryReport& report) {
-        QL_REQUIRE(columns() == report.columns(),
-                   "Cannot combine reports of different sizes (" << columns() << " vs " << report.columns() << ").");
-        end();
-        for (Size i = 0; i < columns(); i++) {
-            string h1 = headers_[i];
-            string h2 = report.header(i);
-            QL_REQUIRE(h1 == h2, "Cannot combine reports with different headers (\"" << h1 << "\" and \"" << h2 << "\")");
-        }
-
-        if (i_ == headers_.size())
-            next();
-        
-        for (Size rowIdx = 0; rowIdx < report.rows(); rowIdx++) {
-            for (Size columnIdx = 0; columnIdx < report.columns(); columnIdx++) {
-                add(report.data(columnIdx)[rowIdx]);
-            }
-            next();
-        }
-        
-        return *this;
-    }
-
-    void end() override {
-        QL_REQUIRE(i_ == headers_.size() || i_ == 0,
-                   "report is finalized with incomplete row, got data for " << i_ << " columns out of " << columns());
-    }
+    Report& addColumn(const string& name, const ReportType& rt, Size precision = 0) override;
+    Report& next() override;
+    Report& add(const ReportType& rt) override;
+    Report& add(const InMemoryReport& report);
+    void end() override;
+
+    //! \name Bulk append
+    /*! Append values to the end of column i, the type must match the column type. No row may be in progress, i.e.
+        either all or no columns of the current row must have been filled. All columns must have the same number of
+        rows when end() is called. */
+    //@{
+    InMemoryReport& addColumnData(Size i, const vector<Size>& values);
+    InMemoryReport& addColumnData(Size i, const vector<Real>& values);
+    InMemoryReport& addColumnData(Size i, const vector<string>& values);
+    InMemoryReport& addColumnData(Size i, const vector<Date>& values);
+    InMemoryReport& addColumnData(Size i, const vector<Period>& values);
+    //@}
 
     // InMemoryInterface
     Size columns() const { return headers_.size(); }
-    Size rows() const { return columns() == 0 ? 0 : data_[0].size(); }
+    Size rows() const { return columns() == 0 ? 0 : columnSize(0); }
     const string& header(Size i) const { return headers_[i]; }
     bool hasHeader(string h) const { return std::find(headers_.begin(), headers_.end(), h) != headers_.end(); }
     ReportType columnType(Size i) const { return columnTypes_[i]; }
     Size columnPrecision(Size i) const { return columnPrecision_[i]; }
-    //! Returns the data
-    const vector<ReportType>& data(Size i) const {
-        QL_REQUIRE(data_[i].size() == rows(), "internal error: report column "
-                                                  << i << " (" << header(i) << ") contains " << data_[i].size()
-                                                  << " rows, expected are " << rows() << " rows.");
-        return data_[i];
-    }
-
+    //! Returns the data of column i as variants, this copies the column, prefer the typed access below
+    vector<ReportType> data(Size i) const;
+    //! Returns the value in row j of column i
+    ReportType value(Size i, Size j) const;
+
+    //! \name Typed column access
+    //@{
+    const vector<Size>& sizeColumn(Size i) const;
+    const vector<Real>& realColumn(Size i) const;
+    const vector<Date>& dateColumn(Size i) const;
+    const vector<Period>& periodColumn(Size i) const;
+    //! The ids of the strings in column i, see internedString()
+    const vector<Size>& stringIdColumn(Size i) const;
+    //! The string with the given id
+    const string& internedString(Size id) const { return strings_.at(id); }
+    //! The number of distinct strings in the report
+    Size internedStrings() const { return strings_.size(); }
+    //@}
+
+    /*! Write the report to a csv file, see CSVFileReport, with \p threads > 1 the rows are formatted in parallel */
     void toFile(const string& filename, const char sep = ',', const bool commentCharacter = true, char quoteChar = '\0',
-                const string& nullString = "#N/A", bool lowerHeader = false) {
-
-        CSVFileReport cReport(filename, sep, commentCharacter, quoteChar, nullString, lowerHeader);
-
-        for (Size i = 0; i < headers_.size(); i++) {
-            cReport.addColumn(headers_[i], columnTypes_[i], columnPrecision_[i]);
-        }
-
-        auto numColumns = columns();
-        if (numColumns > 0) {
-            auto numRows = data_[0].size();
-
-            for (Size i = 0; i < numRows; i++) {
-                cReport.next();
-                for (Size j = 0; j < numColumns; j++) {
-                    cReport.add(data_[j][i]);
-                }
-            }
-        }
+                const string& nullString = "#N/A", bool lowerHeader = false, Size threads = 1);
 
-        cReport.end();
+private:
+    // typed storage of a column, only the vector matching the column type is used
+    struct Column {
+        vector<Size> sizes;
+        vector<Real> reals;
+        vector<Size> strings;
+        vector<Date> dates;
+        vector<Period> periods;
+    };
+
+    Size columnSize(Size i) const;
+    Size internString(const string& s);
+    void checkColumn(Size i, int which, const char* method) const;
+    template <class T> void appendColumn(vector<T>& column, const vector<T>& values) {
+        column.insert(column.end(), values.begin(), values.end());
     }
 
-private:
     Size i_;
     vector<string> headers_;
     vector<ReportType> columnTypes_;
     vector<Size> columnPrecision_;
-    vector<vector<ReportType>> data_;
+    vector<Column> data_;
+    vector<string> strings_;
+    std::unordered_map<string, Size> stringIds_;
 };
 
 //! InMemoryReport with access to plain types instead of boost::variant<>, to facilitate language bindings
@@ -152,29 +131,25 @@ public:
     std::string header(Size i) const { return imReport_->header(i); }
     // returns: 0 Size, 1 Real, 2 string, 3 Date, 4 Period
     Size columnType(Size i) const { return imReport_->columnType(i).which(); }
-    vector<int> dataAsSize(Size i) const { return sizeToInt(data_T<Size>(i, 0)); }
-    vector<Real> dataAsReal(Size i) const { return data_T<Real>(i, 1); }
-    vector<string> dataAsString(Size i) const { return data_T<string>(i, 2); }
-    vector<Date> dataAsDate(Size i) const { return data_T<Date>(i, 3); }
-    vector<Period> dataAsPeriod(Size i) const { return data_T<Period>(i, 4); }
+    vector<int> dataAsSize(Size i) const { return sizeToInt(imReport_->sizeColumn(i)); }
+    vector<Real> dataAsReal(Size i) const { return imReport_->realColumn(i); }
+    vector<string> dataAsString(Size i) const {
+        vector<string> tmp;
+        for (auto id : imReport_->stringIdColumn(i))
+            tmp.push_back(imReport_->internedString(id));
+        return tmp;
+    }
+    vector<Date> dataAsDate(Size i) const { return imReport_->dateColumn(i); }
+    vector<Period> dataAsPeriod(Size i) const { return imReport_->periodColumn(i); }
     // for convenience, access by row j and column i
-    Size rows() const { return columns() == 0 ? 0 : imReport_->data(0).size(); }
-    int dataAsSize(Size j, Size i) const { return int(boost::get<Size>(imReport_->data(i).at(j))); }
-    Real dataAsReal(Size j, Size i) const { return boost::get<Real>(imReport_->data(i).at(j)); }
-    string dataAsString(Size j, Size i) const { return boost::get<string>(imReport_->data(i).at(j)); }
-    Date dataAsDate(Size j, Size i) const { return boost::get<Date>(imReport_->data(i).at(j)); }
-    Period dataAsPeriod(Size j, Size i) const { return boost::get<Period>(imReport_->data(i).at(j)); }
+    Size rows() const { return imReport_->rows(); }
+    int dataAsSize(Size j, Size i) const { return int(imReport_->sizeColumn(i).at(j)); }
+    Real dataAsReal(Size j, Size i) const { return imReport_->realColumn(i).at(j); }
+    string dataAsString(Size j, Size i) const { return imReport_->internedString(imReport_->stringIdColumn(i).at(j)); }
+    Date dataAsDate(Size j, Size i) const { return imReport_->dateColumn(i).at(j); }
+    Period dataAsPeriod(Size j, Size i) const { return imReport_->periodColumn(i).at(j); }
 
 private:
-    template <typename T> vector<T> data_T(Size i, Size w) const {
-        QL_REQUIRE(columnType(i) == w,
-                   "PlainTypeInMemoryReport::data_T(column=" << i << ",expectedType=" << w
-                   << "): Type mismatch, have " << columnType(i));
-        vector<T> tmp;
-        for(auto const& d: imReport_->data(i))
-            tmp.push_back(boost::get<T>(d));
-        return tmp;
-    }
     vector<int> sizeToInt(const vector<Size>& v) const {
         return std::vector<int>(std::begin(v), std::end(v));
     }
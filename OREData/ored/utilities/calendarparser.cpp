@@ -59,37 +59,43 @@ using namespace QuantExt;
 CalendarParser::CalendarParser() { reset(); }
 
 QuantLib::Calendar CalendarParser::parseCalendar(const std::string& name) const {
-    boost::shared_lock<boost::shared_mutex> lock(mutex_);
-    auto it = calendars_.find(name);
-    if (it != calendars_.end())
-        return it->second;
-    else {
-        // Try to split them up
-        std::vector<std::string> calendarNames;
-        split(calendarNames, name, boost::is_any_of(",()")); // , is delimiter, the brackets may arise if joint calendar
-        // if we have only one token, we won't make progress and exit here to avoid an infinite loop by calling
-        // parseCalendar() recursively below
-        QL_REQUIRE(calendarNames.size() > 1, "Cannot convert \"" << name << "\" to calendar");
-        // now remove any leading strings indicating a joint calendar
-        calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), "JoinHolidays"),
-                            calendarNames.end());
-        calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), "JoinBusinessDays"),
-                            calendarNames.end());
-        calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), ""), calendarNames.end());
-        // Populate a vector of calendars.
-        std::vector<QuantLib::Calendar> calendars;
-        for (Size i = 0; i < calendarNames.size(); i++) {
-            boost::trim(calendarNames[i]);
-            try {
-                calendars.push_back(parseCalendar(calendarNames[i]));
-            } catch (std::exception& e) {
-                QL_FAIL("Cannot convert \"" << name << "\" to Calendar [exception:" << e.what() << "]");
-            } catch (...) {
-                QL_FAIL("Cannot convert \"" << name << "\" to Calendar [unhandled exception]");
-            }
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        auto it = calendars_.find(name);
+        if (it != calendars_.end())
+            return it->second;
+        auto j = jointCalendars_.find(name);
+        if (j != jointCalendars_.end())
+            return j->second;
+    }
+    // Try to split them up
+    std::vector<std::string> calendarNames;
+    split(calendarNames, name, boost::is_any_of(",()")); // , is delimiter, the brackets may arise if joint calendar
+    // if we have only one token, we won't make progress and exit here to avoid an infinite loop by calling
+    // parseCalendar() recursively below
+    QL_REQUIRE(calendarNames.size() > 1, "Cannot convert \"" << name << "\" to calendar");
+    // now remove any leading strings indicating a joint calendar
+    calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), "JoinHolidays"),
+                        calendarNames.end());
+    calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), "JoinBusinessDays"),
+                        calendarNames.end());
+    calendarNames.erase(std::remove(calendarNames.begin(), calendarNames.end(), ""), calendarNames.end());
+    // Populate a vector of calendars.
+    std::vector<QuantLib::Calendar> calendars;
+    for (Size i = 0; i < calendarNames.size(); i++) {
+        boost::trim(calendarNames[i]);
+        try {
+            calendars.push_back(parseCalendar(calendarNames[i]));
+        } catch (std::exception& e) {
+            QL_FAIL("Cannot convert \"" << name << "\" to Calendar [exception:" << e.what() << "]");
+        } catch (...) {
+            QL_FAIL("Cannot convert \"" << name << "\" to Calendar [unhandled exception]");
         }
-        return QuantExt::LargeJointCalendar(calendars);
     }
+    // keep the joint calendar, so that later calls for the same name return it without parsing
+    QuantLib::Calendar cal = QuantExt::LargeJointCalendar(calendars);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    return jointCalendars_.insert(std::make_pair(name, cal)).first->second;
 }
 
 QuantLib::Calendar CalendarParser::addCalendar(const std::string baseName, std::string& newName) {
@@ -425,6 +431,7 @@ void CalendarParser::reset() {
         {"", NullCalendar()}};
 
     calendars_ = ref;
+    jointCalendars_.clear();
 
     // add ql calendar names
     for (auto const& c : ref) {
@@ -43,6 +43,8 @@ public:
 private:
     mutable boost::shared_mutex mutex_;
     std::map<std::string, QuantLib::Calendar> calendars_;
+    // joint calendars parsed so far, by the name they were requested with
+    mutable std::map<std::string, QuantLib::Calendar> jointCalendars_;
 };
 
 } // namespace data
@@ -21,8 +21,12 @@
     \ingroup
 */
 
+#include <boost/date_time/c_local_time_adjustor.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
@@ -74,13 +78,81 @@ void FileLogger::log(unsigned, const string& msg) {
         fout_ << msg << endl;
 }
 
+// -- Buffer for the asynchronous mode
+
+/* Single producer single consumer ring buffer, the producer is the thread owning the buffer, the consumer is the
+   thread holding the drain mutex of the Log */
+class AsyncLogBuffer {
+public:
+    struct Record {
+        unsigned mask;
+        const char* filename;
+        int lineNo;
+        std::chrono::system_clock::time_point time;
+        string msg;
+    };
+
+    explicit AsyncLogBuffer(std::size_t capacity) : records_(capacity), head_(0), tail_(0), dropped_(0) {}
+
+    // producer side, r is only moved from if there is space in the buffer
+    bool push(Record& r) {
+        std::size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_.load(std::memory_order_acquire) == records_.size())
+            return false;
+        records_[t % records_.size()] = std::move(r);
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    void pop(std::vector<Record>& records) {
+        std::size_t h = head_.load(std::memory_order_relaxed);
+        std::size_t t = tail_.load(std::memory_order_acquire);
+        for (; h != t; ++h)
+            records.push_back(std::move(records_[h % records_.size()]));
+        head_.store(h, std::memory_order_release);
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    void drop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+    std::size_t takeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::vector<Record> records_;
+    // head_ is written by the consumer only, tail_ by the producer only, keep them on different cache lines
+    alignas(64) std::atomic<std::size_t> head_;
+    alignas(64) std::atomic<std::size_t> tail_;
+    std::atomic<std::size_t> dropped_;
+};
+
+namespace {
+// convert a time stamp taken at the call site to local time, as used in the header of synchronous messages
+ptime localTime(const std::chrono::system_clock::time_point& time) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    ptime utc = from_time_t(static_cast<std::time_t>(us / 1000000)) + microseconds(us % 1000000);
+    return boost::date_time::c_local_adjustor<ptime>::utc_to_local(utc);
+}
+} // namespace
+
 // The Log itself
-Log::Log() : loggers_(), enabled_(false), mask_(255), ls_() {
+std::atomic<unsigned> Log::activeMask_(0);
+
+Log::Log()
+    : loggers_(), enabled_(false), mask_(255), ls_(), async_(false), overflowPolicy_(OverflowPolicy::Block),
+      bufferSize_(65536), stopWriter_(false) {
 
     ls_.setf(ios::fixed, ios::floatfield);
     ls_.setf(ios::showpoint);
 }
 
+Log::~Log() {
+    try {
+        switchOffAsync();
+    } catch (...) {
+    }
+}
+
 void Log::registerLogger(const boost::shared_ptr<Logger>& logger) {
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
     QL_REQUIRE(loggers_.find(logger->name()) == loggers_.end(),
@@ -107,6 +179,10 @@ void Log::removeAllLoggers() {
 }
 
 void Log::header(unsigned m, const char* filename, int lineNo) {
+    header(m, filename, lineNo, microsec_clock::local_time());
+}
+
+void Log::header(unsigned m, const char* filename, int lineNo, const ptime& time) {
     // 1. Reset stringstream
     ls_.str(string());
     ls_.clear();
@@ -143,7 +219,7 @@ void Log::header(unsigned m, const char* filename, int lineNo) {
     // Timestamp
     // Use boost::posix_time microsecond clock to get better precision (when available).
     // format is "2014-Apr-04 11:10:16.179347"
-    ls_ << '[' << to_simple_string(microsec_clock::local_time()) << ']';
+    ls_ << '[' << to_simple_string(time) << ']';
 
     // Filename & line no
     // format is " (file:line)"
@@ -207,6 +283,111 @@ void Log::log(unsigned m) {
     }
 }
 
+void Log::enqueue(unsigned m, const char* filename, int lineNo, string msg) {
+    thread_local boost::shared_ptr<AsyncLogBuffer> buffer;
+    if (!buffer) {
+        buffer = boost::make_shared<AsyncLogBuffer>(bufferSize_.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffers_.push_back(buffer);
+    }
+    AsyncLogBuffer::Record r{m, filename, lineNo, std::chrono::system_clock::now(), std::move(msg)};
+    while (!buffer->push(r)) {
+        if (!async()) {
+            flush();
+        } else if (overflowPolicy_.load(std::memory_order_relaxed) == OverflowPolicy::Drop) {
+            buffer->drop();
+            return;
+        } else {
+            writerCondition_.notify_one();
+            std::this_thread::yield();
+        }
+    }
+    // the mode might have been switched off after the caller checked it, do not leave the message in the buffer
+    if (!async())
+        flush();
+}
+
+std::size_t Log::drain() {
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+    std::vector<boost::shared_ptr<AsyncLogBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        // remove the buffers of threads that have finished and whose messages are written
+        buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                      [](const boost::shared_ptr<AsyncLogBuffer>& b) {
+                                          return b.use_count() == 1 && b->empty();
+                                      }),
+                       buffers_.end());
+        buffers = buffers_;
+    }
+
+    std::vector<AsyncLogBuffer::Record> records;
+    std::size_t dropped = 0;
+    for (auto const& b : buffers) {
+        b->pop(records);
+        dropped += b->takeDropped();
+    }
+    if (records.empty() && dropped == 0)
+        return 0;
+
+    // the buffers are in chronological order each, merge them
+    std::stable_sort(records.begin(), records.end(),
+                     [](const AsyncLogBuffer::Record& x, const AsyncLogBuffer::Record& y) { return x.time < y.time; });
+
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    for (auto const& r : records) {
+        header(r.mask, r.filename, r.lineNo, localTime(r.time));
+        ls_ << r.msg;
+        log(r.mask);
+    }
+    if (dropped > 0) {
+        header(ORE_WARNING, __FILE__, __LINE__);
+        ls_ << "Log: " << dropped << " messages dropped, because the buffer of the asynchronous logging was full";
+        log(ORE_WARNING);
+    }
+    return records.size();
+}
+
+void Log::writerLoop() {
+    while (!stopWriter_.load()) {
+        std::size_t n = 0;
+        try {
+            n = drain();
+        } catch (...) {
+            // a failing logger must not stop the writer
+        }
+        if (n == 0) {
+            std::unique_lock<std::mutex> lock(writerMutex_);
+            writerCondition_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void Log::switchOnAsync(OverflowPolicy policy, std::size_t bufferSize) {
+    QL_REQUIRE(bufferSize > 0, "Log::switchOnAsync(): buffer size must be positive");
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    overflowPolicy_.store(policy);
+    bufferSize_.store(bufferSize);
+    if (async_.load())
+        return;
+    stopWriter_.store(false);
+    writer_ = std::thread(&Log::writerLoop, this);
+    async_.store(true);
+}
+
+void Log::switchOffAsync() {
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    if (!async_.load())
+        return;
+    async_.store(false);
+    stopWriter_.store(true);
+    writerCondition_.notify_one();
+    writer_.join();
+    flush();
+}
+
+void Log::flush() { drain(); }
+
 // --------
 
 LoggerStream::LoggerStream(unsigned mask, const char* filename, unsigned lineNo)
@@ -220,11 +401,15 @@ LoggerStream::~LoggerStream() {
     string text;
     while (getline(ss_, text)) {
         // we expand the MLOG macro here so we can overwrite __FILE__ and __LINE__
-        if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask_)) {
-            boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());
-            ore::data::Log::instance().header(mask_, filename_, lineNo_);
-            ore::data::Log::instance().logStream() << text;
-            ore::data::Log::instance().log(mask_);
+        if (ORE_LOG_ACTIVE(mask_)) {
+            if (ore::data::Log::instance().async()) {
+                ore::data::Log::instance().enqueue(mask_, filename_, lineNo_, text);
+            } else {
+                boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());
+                ore::data::Log::instance().header(mask_, filename_, lineNo_);
+                ore::data::Log::instance().logStream() << text;
+                ore::data::Log::instance().log(mask_);
+            }
         }
     }
 }
@@ -33,6 +33,12 @@
 #define ORE_DATA 64    // 01000000  127
 #define ORE_MEMORY 128 // 10000000  255
 
+/* Compile time log level: log macros with a level above it, e.g. DLOG and TLOG for ORE_COMPILE_LOG_LEVEL =
+   ORE_NOTICE, are removed at compile time. The level is set by the cmake option of the same name. */
+#ifndef ORE_COMPILE_LOG_LEVEL
+#define ORE_COMPILE_LOG_LEVEL ORE_MEMORY
+#endif
+
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -55,9 +61,16 @@
 #include <sstream>
 
 #include <boost/any.hpp>
+#include <boost/date_time/posix_time/ptime.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/lock_types.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace ore {
 namespace data {
 using std::string;
@@ -196,6 +209,8 @@ private:
     unsigned minLevel_;
 };
 
+class AsyncLogBuffer;
+
 //! Global static Log class
 /*!
   The Global Log class gets registered with individual loggers and receives application log messages.
@@ -204,6 +219,10 @@ private:
 
   Logging is done by the calling thread and the LOG call blocks until all the loggers have returned.
 
+  In the asynchronous mode, see switchOnAsync(), the LOG call only formats the message and pushes it together with
+  the time stamp to a lock-free buffer of the calling thread. A background thread drains the buffers and calls the
+  loggers. Before reading messages from a logger, e.g. a BufferLogger, flush() must be called.
+
   At start up, the Log class has no loggers and so will ignore any LOG() messages until it is configured.
 
   To configure the Log class to log to a file "/tmp/my_log.txt"
@@ -235,6 +254,17 @@ class Log : public QuantLib::Singleton<Log, std::integral_constant<bool, true>>
     friend class QuantLib::Singleton<Log, std::integral_constant<bool, true>>;
 
 public:
+    //! Behaviour of the asynchronous mode if the buffer of a thread is full
+    enum class OverflowPolicy {
+        //! the calling thread waits until the background thread has drained the buffer
+        Block,
+        //! the message is dropped, the number of dropped messages is logged as a warning
+        Drop
+    };
+
+    //! Destructor, writes all pending messages of the asynchronous mode
+    ~Log();
+
     //! Add a new Logger.
     /*!
       Adds a new logger to the Log class, the logger will be stored by it's Logger::name().
@@ -265,26 +295,42 @@ public:
     //! macro utility function - do not use directly
     void header(unsigned m, const char* filename, int lineNo);
     //! macro utility function - do not use directly
+    void header(unsigned m, const char* filename, int lineNo, const boost::posix_time::ptime& time);
+    //! macro utility function - do not use directly
     std::ostream& logStream() { return ls_; }
     //! macro utility function - do not use directly
     void log(unsigned m);
+    //! macro utility function - do not use directly
+    void enqueue(unsigned m, const char* filename, int lineNo, string msg);
+
+    //! \name Asynchronous logging
+    //@{
+    /*! Switch on the asynchronous mode. Each thread gets a buffer for \p bufferSize messages when it logs for
+        the first time, \p policy determines what happens if the buffer is full. */
+    void switchOnAsync(OverflowPolicy policy = OverflowPolicy::Block, std::size_t bufferSize = 65536);
+    //! Write all pending messages and switch back to synchronous logging
+    void switchOffAsync();
+    //! True if the asynchronous mode is on
+    bool async() const { return async_.load(std::memory_order_relaxed); }
+    //! Write all messages queued so far to the loggers
+    void flush();
+    //@}
 
     //! mutex to acquire locks
     boost::shared_mutex& mutex() { return mutex_; }
 
     // Avoid a large number of warnings in VS by adding 0 !=
-    bool filter(unsigned mask) {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return 0 != (mask & mask_);
-    }
-    unsigned mask() {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return mask_;
-    }
+    bool filter(unsigned mask) { return 0 != (mask & mask_.load(std::memory_order_relaxed)); }
+    unsigned mask() { return mask_.load(std::memory_order_relaxed); }
     void setMask(unsigned mask) {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
-        mask_ = mask;
+        mask_.store(mask, std::memory_order_relaxed);
+        updateActiveMask();
     }
+
+    /*! True if the log is enabled and the mask passes the filter. This reads a copy of the mask kept outside of the
+        singleton and is used by the log macros, see ORE_LOG_ACTIVE. */
+    static bool active(unsigned mask) { return 0 != (mask & activeMask_.load(std::memory_order_relaxed)); }
     const boost::filesystem::path& rootPath() {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
         return rootPath_;
@@ -302,17 +348,16 @@ public:
         maxLen_ = n;
     }
 
-    bool enabled() {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return enabled_;
-    }
+    bool enabled() { return enabled_.load(std::memory_order_relaxed); }
     void switchOn() {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
-        enabled_ = true;
+        enabled_.store(true, std::memory_order_relaxed);
+        updateActiveMask();
     }
     void switchOff() {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
-        enabled_ = false;
+        enabled_.store(false, std::memory_order_relaxed);
+        updateActiveMask();
     }
 
     //! if a PID is set for the logger, messages are tagged with [1234] if pid = 1234
@@ -321,9 +366,18 @@ public:
 private:
     Log();
 
+    // drain the buffers of the asynchronous mode and call the loggers, returns the number of messages written
+    std::size_t drain();
+    void writerLoop();
+    // to be called under the mutex when enabled_ or mask_ change
+    void updateActiveMask() { activeMask_.store(enabled_ ? mask_.load() : 0u, std::memory_order_relaxed); }
+
     std::map<string, boost::shared_ptr<Logger>> loggers_;
-    bool enabled_;
-    unsigned mask_;
+    // the filter is checked for each message, so enabled_ and mask_ are read without taking the mutex
+    std::atomic<bool> enabled_;
+    std::atomic<unsigned> mask_;
+    // mask_ if the log is enabled and zero otherwise
+    static std::atomic<unsigned> activeMask_;
     boost::filesystem::path rootPath_;
     std::ostringstream ls_;
 
@@ -337,20 +391,46 @@ private:
     int pid_ = 0;
 
     mutable boost::shared_mutex mutex_;
+
+    // asynchronous mode
+    std::atomic<bool> async_;
+    std::atomic<OverflowPolicy> overflowPolicy_;
+    std::atomic<std::size_t> bufferSize_;
+    // the buffers of all threads that have logged in the asynchronous mode
+    std::vector<boost::shared_ptr<AsyncLogBuffer>> buffers_;
+    std::mutex buffersMutex_;
+    // only one thread may drain the buffers at a time
+    std::mutex drainMutex_;
+    // serialises switching the asynchronous mode on and off
+    std::mutex asyncMutex_;
+    std::thread writer_;
+    std::atomic<bool> stopWriter_;
+    std::mutex writerMutex_;
+    std::condition_variable writerCondition_;
 };
 
+/*!
+  True if messages with the given mask are compiled in and pass the runtime filter. If the mask is a constant above
+  ORE_COMPILE_LOG_LEVEL the condition is false at compile time and the guarded code is removed.
+ */
+#define ORE_LOG_ACTIVE(mask) ((mask) <= ORE_COMPILE_LOG_LEVEL && ore::data::Log::active(mask))
+
 /*!
   Main Logging macro, do not use this directly, use on of the below 6 macros instead
  */
 #define MLOG(mask, text)                                                                                               \
     {                                                                                                                  \
-        if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask)) {                         \
+        if (ORE_LOG_ACTIVE(mask)) {                                                                                    \
             std::ostringstream __ore_mlog_tmp_stringstream__;                                                          \
             __ore_mlog_tmp_stringstream__ << text;                                                                     \
-            boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                          \
-            ore::data::Log::instance().header(mask, __FILE__, __LINE__);                                               \
-            ore::data::Log::instance().logStream() << __ore_mlog_tmp_stringstream__.str();                             \
-            ore::data::Log::instance().log(mask);                                                                      \
+            if (ore::data::Log::instance().async()) {                                                                  \
+                ore::data::Log::instance().enqueue(mask, __FILE__, __LINE__, __ore_mlog_tmp_stringstream__.str());     \
+            } else {                                                                                                   \
+                boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                      \
+                ore::data::Log::instance().header(mask, __FILE__, __LINE__);                                           \
+                ore::data::Log::instance().logStream() << __ore_mlog_tmp_stringstream__.str();                         \
+                ore::data::Log::instance().log(mask);                                                                  \
+            }                                                                                                          \
         }                                                                                                              \
     }
 
@@ -374,12 +454,17 @@ private:
 
 #define MEM_LOG_USING_LEVEL(LEVEL)                                                                                     \
     {                                                                                                                  \
-        if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(LEVEL)) {                        \
-            boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                          \
-            ore::data::Log::instance().header(LEVEL, __FILE__, __LINE__);                                              \
-            ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getPeakMemoryUsageBytes()) << "|"; \
-            ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getMemoryUsageBytes());            \
-            ore::data::Log::instance().log(LEVEL);                                                                     \
+        if (ORE_LOG_ACTIVE(LEVEL)) {                                                                                   \
+            std::string __ore_memlog_tmp_string__ = std::to_string(ore::data::os::getPeakMemoryUsageBytes()) + "|" +   \
+                                                    std::to_string(ore::data::os::getMemoryUsageBytes());              \
+            if (ore::data::Log::instance().async()) {                                                                  \
+                ore::data::Log::instance().enqueue(LEVEL, __FILE__, __LINE__, __ore_memlog_tmp_string__);              \
+            } else {                                                                                                   \
+                boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                      \
+                ore::data::Log::instance().header(LEVEL, __FILE__, __LINE__);                                          \
+                ore::data::Log::instance().logStream() << __ore_memlog_tmp_string__;                                   \
+                ore::data::Log::instance().log(LEVEL);                                                                 \
+            }                                                                                                          \
         }                                                                                                              \
     }
 
@@ -434,7 +519,7 @@ private:
 };
 
 #define CHECKED_LOGGERSTREAM(LEVEL, text)                                                                              \
-    if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(LEVEL)) {                            \
+    if (ORE_LOG_ACTIVE(LEVEL)) {                                                                                       \
         (std::ostream&)ore::data::LoggerStream(LEVEL, __FILE__, __LINE__) << text;                              \
     }
 
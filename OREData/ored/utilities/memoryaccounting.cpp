@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/memoryaccounting.hpp>
+#include <ored/utilities/osutils.hpp>
+
+#include <boost/thread/lock_types.hpp>
+
+namespace ore {
+namespace data {
+
+void MemoryAccounting::record(const std::string& phase, const std::string& subsystem, const std::string& name,
+                              QuantLib::Size count, QuantLib::Size bytes) {
+    if (!enabled_)
+        return;
+    MLOG(ORE_MEMORY, "MemoryAccounting|" << phase << "|" << subsystem << "|" << name << "|" << count << "|" << bytes);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    entries_.push_back({phase, subsystem, name, count, bytes});
+}
+
+void MemoryAccounting::recordProcess(const std::string& phase) {
+    if (!enabled_)
+        return;
+    record(phase, "Process", "Current", 1, os::getMemoryUsageBytes());
+    record(phase, "Process", "Peak", 1, os::getPeakMemoryUsageBytes());
+}
+
+std::vector<MemoryAccounting::Entry> MemoryAccounting::entries() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return entries_;
+}
+
+void MemoryAccounting::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    entries_.clear();
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,117 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/memoryaccounting.hpp
+    \brief opt-in accounting of the memory held by the main data structures of a run
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+#include <ql/types.hpp>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Process wide record of the memory footprint of subsystems at the phase boundaries of a run
+/*! MEM_LOG only logs the current and peak memory of the process. If the accounting is enabled, the components of a
+    run, e.g. the analytics, record the footprint of the objects they hold, like the market data loader, the market,
+    the portfolio, cubes and scenario data, at the end of each phase. Each record is also logged at the memory log
+    level in the format
+
+    MemoryAccounting|phase|subsystem|name|count|bytes
+
+    and the records are written as the memory breakdown report at the end of the run. The footprints are estimates,
+    see the memoryFootprint() methods of the respective classes. While the accounting is disabled record() is a
+    no-op.
+
+    \ingroup utilities
+*/
+class MemoryAccounting : public QuantLib::Singleton<MemoryAccounting, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<MemoryAccounting, std::integral_constant<bool, true>>;
+    MemoryAccounting() : enabled_(false) {}
+
+public:
+    struct Entry {
+        //! the phase of the run, e.g. "XVA/market"
+        std::string phase;
+        //! the subsystem, e.g. "Cube" or "Portfolio"
+        std::string subsystem;
+        //! the name of the object within the subsystem, e.g. "npv"
+        std::string name;
+        //! the number of elements held, e.g. trades or quotes, the meaning depends on the subsystem
+        QuantLib::Size count;
+        //! the estimated footprint in bytes
+        QuantLib::Size bytes;
+    };
+
+    void setEnabled(const bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_; }
+
+    //! Record the footprint of an object at the given phase, a no-op if the accounting is disabled
+    void record(const std::string& phase, const std::string& subsystem, const std::string& name,
+                QuantLib::Size count, QuantLib::Size bytes);
+
+    //! Record the current and peak memory of the process as subsystem "Process", as logged by MEM_LOG
+    void recordProcess(const std::string& phase);
+
+    //! The records in the order they were made
+    std::vector<Entry> entries() const;
+
+    //! Remove all records
+    void clear();
+
+private:
+    std::atomic<bool> enabled_;
+    std::vector<Entry> entries_;
+    mutable boost::shared_mutex mutex_;
+};
+
+/*! \name Footprint estimates of std containers, not including the footprint of the elements' own heap memory unless
+    stated otherwise */
+//@{
+//! The heap memory of a string, zero if it is held in the small string buffer
+inline std::size_t memoryFootprint(const std::string& s) {
+    return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+template <class T> std::size_t memoryFootprint(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+
+//! The nodes of a map, including the heap memory of string keys
+template <class K, class V> std::size_t memoryFootprint(const std::map<K, V>& m) {
+    // a red black tree node holds the value, three pointers and the colour
+    std::size_t bytes = m.size() * (sizeof(typename std::map<K, V>::value_type) + 4 * sizeof(void*));
+    if constexpr (std::is_same_v<K, std::string>) {
+        for (auto const& kv : m)
+            bytes += memoryFootprint(kv.first);
+    }
+    return bytes;
+}
+//@}
+
+} // namespace data
+} // namespace ore
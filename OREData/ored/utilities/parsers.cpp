@@ -38,7 +38,10 @@
 #include <qle/time/yearcounter.hpp>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <regex>
+#include <unordered_map>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -49,7 +52,33 @@ using boost::algorithm::to_lower_copy;
 namespace ore {
 namespace data {
 
-Date parseDate(const string& s) {
+namespace {
+
+/* Thread safe cache for the results of a parser that only depends on the parsed string. Failures are not cached, the
+   size is bounded for inputs with many distinct strings, e.g. the dates of historical market data. */
+template <class T> class ParserCache {
+public:
+    template <class F> T get(const string& s, F parse) {
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            auto it = cache_.find(s);
+            if (it != cache_.end())
+                return it->second;
+        }
+        T result = parse(s);
+        boost::unique_lock<boost::shared_mutex> lock(mutex_);
+        if (cache_.size() < maxSize)
+            cache_.insert(std::make_pair(s, result));
+        return result;
+    }
+
+private:
+    static constexpr Size maxSize = 100000;
+    boost::shared_mutex mutex_;
+    std::unordered_map<string, T> cache_;
+};
+
+Date parseDateImpl(const string& s) {
     // TODO: review
 
     if (s == "")
@@ -110,6 +139,13 @@ Date parseDate(const string& s) {
     QL_FAIL("Cannot convert \"" << s << "\" to Date.");
 }
 
+} // namespace
+
+Date parseDate(const string& s) {
+    static ParserCache<Date> cache;
+    return cache.get(s, parseDateImpl);
+}
+
 Real parseReal(const string& s) {
     try {
         return std::stod(s);
@@ -165,7 +201,10 @@ bool isOnePeriod(const string& s) {
     return true;
 }
 
-Period parsePeriod(const string& s) { return PeriodParser::parse(s); }
+Period parsePeriod(const string& s) {
+    static ParserCache<Period> cache;
+    return cache.get(s, [](const string& t) { return PeriodParser::parse(t); });
+}
 
 BusinessDayConvention parseBusinessDayConvention(const string& s) {
     static map<string, BusinessDayConvention> m = {{"F", Following},
@@ -626,7 +665,8 @@ SequenceType parseSequenceType(const std::string& s) {
     static map<string, SequenceType> seq = {{"MersenneTwister", SequenceType::MersenneTwister},
                                             {"MersenneTwisterAntithetic", SequenceType::MersenneTwisterAntithetic},
                                             {"Sobol", SequenceType::Sobol},
-                                            {"SobolBrownianBridge", SequenceType::SobolBrownianBridge}};
+                                            {"SobolBrownianBridge", SequenceType::SobolBrownianBridge},
+                                            {"Philox", SequenceType::Philox}};
     auto it = seq.find(s);
     if (it != seq.end())
         return it->second;
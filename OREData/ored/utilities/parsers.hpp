@@ -70,6 +70,8 @@ using std::string;
 
 //! Convert std::string to QuantLib::Date
 /*!
+  The results are cached, so that repeated calls for the same string do not parse it again.
+
   \ingroup utilities
 */
 QuantLib::Date parseDate(const string& s);
@@ -118,6 +120,8 @@ bool isOnePeriod(const string& s);
 
 //! Convert text to QuantLib::Period
 /*!
+  The results are cached as for parseDate().
+
   \ingroup utilities
  */
 QuantLib::Period parsePeriod(const string& s);
@@ -18,8 +18,10 @@
 
 #include <ored/utilities/progressbar.hpp>
 
+#include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <unordered_map>
 
 namespace ore {
 namespace data {
@@ -110,28 +112,95 @@ void ProgressLog::updateProgress(const unsigned long progress, const unsigned lo
 
 void ProgressLog::reset() { messageCounter_ = 0; }
 
+namespace {
+std::atomic<std::size_t> nextProgressIndicatorId(0);
+}
+
 MultiThreadedProgressIndicator::MultiThreadedProgressIndicator(
-    const std::set<boost::shared_ptr<ProgressIndicator>>& indicators)
-    : indicators_(indicators) {}
+    const std::set<boost::shared_ptr<ProgressIndicator>>& indicators, const unsigned int sampleInterval)
+    : indicators_(indicators), sampleInterval_(sampleInterval), id_(nextProgressIndicatorId++) {}
+
+MultiThreadedProgressIndicator::~MultiThreadedProgressIndicator() {
+    {
+        std::lock_guard<std::mutex> lock(samplerMutex_);
+        stopSampler_ = true;
+    }
+    samplerCondition_.notify_all();
+    if (sampler_.joinable())
+        sampler_.join();
+    try {
+        publish();
+    } catch (...) {
+    }
+}
+
+MultiThreadedProgressIndicator::Counter& MultiThreadedProgressIndicator::counter() {
+    // the entries of destroyed instances stay in the map, they are never looked up again
+    thread_local std::unordered_map<std::size_t, Counter*> threadCounters;
+    auto c = threadCounters.find(id_);
+    if (c != threadCounters.end())
+        return *c->second;
+    std::lock_guard<std::mutex> lock(countersMutex_);
+    counters_.emplace_back();
+    threadCounters[id_] = &counters_.back();
+    // the sampler is started with the first update, so that an indicator without updates costs no thread
+    if (!sampler_.joinable() && !indicators_.empty())
+        sampler_ = std::thread(&MultiThreadedProgressIndicator::sample, this);
+    return counters_.back();
+}
 
 void MultiThreadedProgressIndicator::updateProgress(const unsigned long progress, const unsigned long total) {
-    boost::unique_lock<boost::shared_mutex> lock(mutex_);
-    threadData_[std::this_thread::get_id()] = std::make_pair(progress, total);
-    unsigned long progressTmp = 0;
-    unsigned long totalTmp = 0;
-    for (auto const& d : threadData_) {
-        progressTmp += d.second.first;
-        totalTmp += d.second.second;
+    Counter& c = counter();
+    c.total.store(total, std::memory_order_relaxed);
+    c.progress.store(progress, std::memory_order_relaxed);
+}
+
+void MultiThreadedProgressIndicator::sample() {
+    std::unique_lock<std::mutex> lock(samplerMutex_);
+    while (!stopSampler_) {
+        samplerCondition_.wait_for(lock, std::chrono::milliseconds(sampleInterval_));
+        if (stopSampler_)
+            break;
+        lock.unlock();
+        publish();
+        lock.lock();
+    }
+}
+
+void MultiThreadedProgressIndicator::publish() {
+    std::lock_guard<std::mutex> publishLock(publishMutex_);
+    unsigned long progress = 0, total = 0;
+    {
+        std::lock_guard<std::mutex> lock(countersMutex_);
+        if (counters_.empty())
+            return;
+        for (auto const& c : counters_) {
+            progress += c.progress.load(std::memory_order_relaxed);
+            total += c.total.load(std::memory_order_relaxed);
+        }
     }
+    // nothing to report before the first thread has set its total
+    if (total == 0 || (published_ && progress == publishedProgress_ && total == publishedTotal_))
+        return;
     for (auto& i : indicators_)
-        i->updateProgress(progressTmp, totalTmp);
+        i->updateProgress(progress, total);
+    publishedProgress_ = progress;
+    publishedTotal_ = total;
+    published_ = true;
 }
 
 void MultiThreadedProgressIndicator::reset() {
-    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> publishLock(publishMutex_);
+    {
+        std::lock_guard<std::mutex> lock(countersMutex_);
+        for (auto& c : counters_) {
+            c.progress.store(0, std::memory_order_relaxed);
+            c.total.store(0, std::memory_order_relaxed);
+        }
+    }
     for (auto& i : indicators_)
         i->reset();
-    threadData_.clear();
+    published_ = false;
 }
 
 NoProgressBar::NoProgressBar(const std::string& message, const unsigned int messageWidth) {
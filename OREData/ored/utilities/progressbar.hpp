@@ -28,6 +28,10 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/unordered_set.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <set>
@@ -125,17 +129,46 @@ public:
     void reset() override {}
 };
 
-/*! Progress Manager that consolidates updates from multiple threads */
+/*! Progress Manager that consolidates updates from multiple threads
+
+    The updating threads only store their progress in atomic counters of their own. A sampler thread sums them up
+    and passes the consolidated progress to the indicators every \p sampleInterval milliseconds, so that the updates
+    do not take locks or call the indicators in the calling threads. The final progress is published by publish() and
+    on destruction. */
 class MultiThreadedProgressIndicator : public ProgressIndicator {
 public:
-    explicit MultiThreadedProgressIndicator(const std::set<boost::shared_ptr<ProgressIndicator>>& indicators);
+    explicit MultiThreadedProgressIndicator(const std::set<boost::shared_ptr<ProgressIndicator>>& indicators,
+                                            const unsigned int sampleInterval = 100);
+    ~MultiThreadedProgressIndicator() override;
     void updateProgress(const unsigned long progress, const unsigned long total) override;
     void reset() override;
 
+    //! pass the current consolidated progress to the indicators, if it changed since the last call
+    void publish();
+
 private:
-    mutable boost::shared_mutex mutex_;
+    struct Counter {
+        std::atomic<unsigned long> progress{0}, total{0};
+    };
+    // the counter of the calling thread
+    Counter& counter();
+    void sample();
+
     std::set<boost::shared_ptr<ProgressIndicator>> indicators_;
-    std::map<std::thread::id, std::pair<unsigned long, unsigned long>> threadData_;
+    unsigned int sampleInterval_;
+    // identifies this instance in the thread local counter lookup, unlike the address it is never reused
+    std::size_t id_;
+    // one counter per updating thread, a deque keeps the addresses stable when counters are added
+    std::deque<Counter> counters_;
+    std::mutex countersMutex_;
+    // serialises the calls to the indicators
+    std::mutex publishMutex_;
+    unsigned long publishedProgress_ = 0, publishedTotal_ = 0;
+    bool published_ = false;
+    std::thread sampler_;
+    std::mutex samplerMutex_;
+    std::condition_variable samplerCondition_;
+    bool stopSampler_ = false;
 };
 
 } // namespace data
@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/tracing.hpp>
+
+#include <ql/errors.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+
+namespace ore {
+namespace data {
+
+namespace {
+// escape a string for use in a json string literal
+void appendEscaped(std::string& target, const char* s) {
+    for (; *s != '\0'; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') {
+            target += '\\';
+            target += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(c));
+            target += buffer;
+        } else {
+            target += c;
+        }
+    }
+}
+
+std::string escaped(const std::string& s) {
+    std::string result;
+    appendEscaped(result, s.c_str());
+    return result;
+}
+} // namespace
+
+Tracer::Tracer() : enabled_(false), epoch_(std::chrono::steady_clock::now()) {}
+
+std::int64_t Tracer::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+void Tracer::record(Event&& e) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(std::move(e));
+}
+
+std::vector<Tracer::Event> Tracer::events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+}
+
+void Tracer::write(std::ostream& os) const {
+    std::vector<Event> events = this->events();
+    // timestamps and durations are given in microseconds in the trace event format
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+    for (QuantLib::Size i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << escaped(e.name) << "\",\"cat\":\"" << escaped(e.category)
+           << "\",\"ph\":\"X\",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << e.duration / 1000.0
+           << ",\"pid\":1,\"tid\":" << e.thread << ",\"args\":{" << e.args << "}}";
+    }
+    os << "\n]}\n";
+}
+
+void Tracer::toFile(const std::string& filename) const {
+    std::ofstream file(filename);
+    QL_REQUIRE(file.is_open(), "Tracer: error opening file " << filename);
+    write(file);
+    file.close();
+    LOG("Tracer: wrote " << events().size() << " spans to " << filename);
+}
+
+QuantLib::Size Tracer::threadId() {
+    static std::atomic<QuantLib::Size> nextId(0);
+    thread_local QuantLib::Size id = nextId++;
+    return id;
+}
+
+TraceSpan::~TraceSpan() {
+    if (!active_)
+        return;
+    try {
+        Tracer& tracer = Tracer::instance();
+        std::int64_t end = tracer.now();
+        tracer.record({name_, category_, std::move(args_), start_, end - start_, Tracer::threadId()});
+    } catch (...) {
+        // a destructor must not throw, the span is lost
+    }
+}
+
+TraceSpan& TraceSpan::arg(const char* key, const std::string& value) {
+    if (!active_)
+        return *this;
+    if (!args_.empty())
+        args_ += ',';
+    args_ += '"';
+    appendEscaped(args_, key);
+    args_ += "\":\"";
+    appendEscaped(args_, value.c_str());
+    args_ += '"';
+    return *this;
+}
+
+TraceSpan& TraceSpan::arg(const char* key, const QuantLib::Size value) {
+    if (!active_)
+        return *this;
+    if (!args_.empty())
+        args_ += ',';
+    args_ += '"';
+    appendEscaped(args_, key);
+    args_ += "\":" + std::to_string(value);
+    return *this;
+}
+
+} // namespace data
+} // namespace ore
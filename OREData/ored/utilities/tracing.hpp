@@ -0,0 +1,136 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/tracing.hpp
+    \brief opt-in structured tracing of the phases of a run in the Chrome trace event format
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+#include <ql/types.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Process wide collector of the trace spans of a run
+/*! If the tracer is enabled, the TraceSpan instances created in the main phases of a run, e.g. the build of the
+    market objects and the trades, the simulation market updates and the valuation engine, record their start time,
+    duration, thread and attributes like the curve spec or the trade id. The spans are written as a Chrome trace
+    event file that can be loaded into Perfetto (ui.perfetto.dev) or chrome://tracing.
+
+    While the tracer is disabled a span costs one atomic load, the attributes of a span should only be computed if
+    they are not readily available and the span is active, see TraceSpan::active().
+
+    \ingroup utilities
+*/
+class Tracer : public QuantLib::Singleton<Tracer, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<Tracer, std::integral_constant<bool, true>>;
+    Tracer();
+
+public:
+    struct Event {
+        //! the name of the span, e.g. "TodaysMarket::buildNode"
+        std::string name;
+        //! the category of the span, e.g. "market"
+        std::string category;
+        //! the attributes as members of a json object, e.g. "tradeId":"T1"
+        std::string args;
+        //! the start time and duration in nanoseconds, the start time is relative to the creation of the tracer
+        std::int64_t start, duration;
+        //! a small number identifying the thread, assigned in the order the threads record their first span
+        QuantLib::Size thread;
+    };
+
+    void setEnabled(const bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    //! The current time in nanoseconds relative to the creation of the tracer
+    std::int64_t now() const;
+
+    //! Record a completed span
+    void record(Event&& e);
+
+    //! The recorded spans in the order they were completed
+    std::vector<Event> events() const;
+
+    //! Remove all recorded spans
+    void clear();
+
+    //! Write the recorded spans in the Chrome trace event format
+    void write(std::ostream& os) const;
+    //! Write the recorded spans to a file in the Chrome trace event format
+    void toFile(const std::string& filename) const;
+
+    //! The id of the calling thread as used in the events
+    static QuantLib::Size threadId();
+
+private:
+    std::atomic<bool> enabled_;
+    std::chrono::steady_clock::time_point epoch_;
+    std::vector<Event> events_;
+    mutable std::mutex mutex_;
+};
+
+//! RAII span recording the time between its construction and destruction, if the Tracer is enabled
+/*! The category and name must be string literals or otherwise outlive the span. Example:
+
+    \code
+    TraceSpan span("portfolio", "Portfolio::buildTrade");
+    span.arg("tradeId", trade->id()).arg("tradeType", trade->tradeType());
+    \endcode
+
+    \ingroup utilities
+*/
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : active_(Tracer::instance().enabled()), category_(category), name_(name),
+          start_(active_ ? Tracer::instance().now() : 0) {}
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    //! True if the span is recorded, i.e. if the tracer was enabled when the span was created
+    bool active() const { return active_; }
+
+    //! Add an attribute to the span, a no-op if the span is not active
+    TraceSpan& arg(const char* key, const std::string& value);
+    TraceSpan& arg(const char* key, const QuantLib::Size value);
+
+private:
+    bool active_;
+    const char* category_;
+    const char* name_;
+    std::int64_t start_;
+    std::string args_;
+};
+
+} // namespace data
+} // namespace ore
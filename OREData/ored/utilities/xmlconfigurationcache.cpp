@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/xmlconfigurationcache.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/functional/hash.hpp>
+
+#include <fstream>
+#include <sstream>
+
+namespace ore {
+namespace data {
+
+std::string XMLConfigurationCache::fileContent(const std::string& fileName) {
+    std::ifstream t(fileName.c_str(), std::ios::binary);
+    QL_REQUIRE(t.is_open(), "Failed to open file " << fileName);
+    std::ostringstream content;
+    content << t.rdbuf();
+    QL_REQUIRE(!content.str().empty(), "File " << fileName << " is empty.");
+    return content.str();
+}
+
+std::size_t XMLConfigurationCache::hash(const std::string& content) {
+    return boost::hash_range(content.begin(), content.end());
+}
+
+QuantLib::Size XMLConfigurationCache::size() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return cache_.size();
+}
+
+QuantLib::Size XMLConfigurationCache::hits() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return hits_;
+}
+
+void XMLConfigurationCache::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    cache_.clear();
+    hits_ = 0;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/xmlconfigurationcache.hpp
+    \brief cache for configuration objects parsed from xml files
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+#include <ql/types.hpp>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <typeindex>
+
+namespace ore {
+namespace data {
+
+//! Process wide cache of configuration objects parsed from xml files
+/*! The objects are keyed by their type and the size and hash of the file content, so that a file with the same
+    content is parsed once, no matter under which name it is read. This helps when large files like conventions.xml
+    or curveconfig.xml are read by several runs in the same process, or when one file serves several purposes in a run.
+
+    The cached objects are shared between all callers and must not be modified after they are returned.
+
+    \ingroup utilities
+*/
+class XMLConfigurationCache
+    : public QuantLib::Singleton<XMLConfigurationCache, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<XMLConfigurationCache, std::integral_constant<bool, true>>;
+    XMLConfigurationCache() {}
+
+public:
+    //! Return the object of type T parsed from the file, T must be default constructible and XMLSerializable
+    template <class T> boost::shared_ptr<T> fromFile(const std::string& fileName);
+
+    //! Number of cached objects
+    QuantLib::Size size() const;
+    //! Number of requests served from the cache
+    QuantLib::Size hits() const;
+    //! Remove all cached objects
+    void clear();
+
+private:
+    // type, content size, content hash
+    typedef std::tuple<std::type_index, std::size_t, std::size_t> Key;
+    static std::string fileContent(const std::string& fileName);
+    static std::size_t hash(const std::string& content);
+
+    std::map<Key, boost::shared_ptr<void>> cache_;
+    QuantLib::Size hits_ = 0;
+    mutable boost::shared_mutex mutex_;
+};
+
+template <class T> boost::shared_ptr<T> XMLConfigurationCache::fromFile(const std::string& fileName) {
+    std::string content = fileContent(fileName);
+    Key key(std::type_index(typeid(T)), content.size(), hash(content));
+    {
+        boost::unique_lock<boost::shared_mutex> lock(mutex_);
+        auto c = cache_.find(key);
+        if (c != cache_.end()) {
+            ++hits_;
+            return boost::static_pointer_cast<T>(c->second);
+        }
+    }
+    // parse outside the lock, if another thread parsed the same content meanwhile its object is kept
+    auto t = boost::make_shared<T>();
+    t->fromXMLString(content);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    return boost::static_pointer_cast<T>(cache_.emplace(key, t).first->second);
+}
+
+} // namespace data
+} // namespace ore
@@ -93,6 +93,10 @@ template <class T> string convertToString(const T& value) { return ore::data::to
 string convertToString2(const std::string& s) { return s; }
 template <class T> string convertToString2(const T& value) { return std::to_string(value); }
 
+// the name argument of the rapidxml lookups where an empty name matches all nodes, passing name.size() along saves
+// measuring the name on each call
+const char* lookupName(std::string_view name) { return name.empty() ? nullptr : name.data(); }
+
 } // namespace
 
 XMLDocument::XMLDocument() : _doc(new rapidxml::xml_document<char>()), _buffer(NULL) {}
@@ -297,43 +301,54 @@ void XMLUtils::addChildren(XMLDocument& doc, XMLNode* parent, const string& name
     }
 }
 
-string XMLUtils::getChildValue(XMLNode* node, const string& name, bool mandatory, const string& defaultValue) {
+string XMLUtils::getChildValue(XMLNode* node, std::string_view name, bool mandatory, const string& defaultValue) {
     QL_REQUIRE(node, "XMLNode is NULL (was looking for child " << name << ")");
-    xml_node<>* child = node->first_node(name.c_str());
+    xml_node<>* child = node->first_node(name.data(), name.size());
     if (mandatory) {
         QL_REQUIRE(child, "Error: No XML Child Node " << name << " found.");
     }
-    return child ? getNodeValue(child) : defaultValue;
+    return child ? string(getNodeValueView(child)) : defaultValue;
 }
 
-Real XMLUtils::getChildValueAsDouble(XMLNode* node, const string& name, bool mandatory, double defaultValue) {
-    string s = getChildValue(node, name, mandatory);
-    return s == "" ? defaultValue : parseReal(s);
+std::string_view XMLUtils::getChildValueView(XMLNode* node, std::string_view name, bool mandatory) {
+    QL_REQUIRE(node, "XMLNode is NULL (was looking for child " << name << ")");
+    xml_node<>* child = node->first_node(name.data(), name.size());
+    if (mandatory) {
+        QL_REQUIRE(child, "Error: No XML Child Node " << name << " found.");
+    }
+    return child ? getNodeValueView(child) : std::string_view();
 }
 
-int XMLUtils::getChildValueAsInt(XMLNode* node, const string& name, bool mandatory, int defaultValue) {
-    string s = getChildValue(node, name, mandatory);
-    return s == "" ? defaultValue : parseInteger(s);
+Real XMLUtils::getChildValueAsDouble(XMLNode* node, std::string_view name, bool mandatory, double defaultValue) {
+    std::string_view s = getChildValueView(node, name, mandatory);
+    return s.empty() ? defaultValue : parseReal(string(s));
 }
 
-bool XMLUtils::getChildValueAsBool(XMLNode* node, const string& name, bool mandatory, bool defaultValue) {
-    string s = getChildValue(node, name, mandatory);
-    return s == "" ? defaultValue : parseBool(s);
+int XMLUtils::getChildValueAsInt(XMLNode* node, std::string_view name, bool mandatory, int defaultValue) {
+    std::string_view s = getChildValueView(node, name, mandatory);
+    return s.empty() ? defaultValue : parseInteger(string(s));
 }
 
-Period XMLUtils::getChildValueAsPeriod(XMLNode* node, const string& name, bool mandatory, const Period& defaultValue) {
-    string s = getChildValue(node, name, mandatory);
-    return s == "" ? defaultValue : parsePeriod(s);
+bool XMLUtils::getChildValueAsBool(XMLNode* node, std::string_view name, bool mandatory, bool defaultValue) {
+    std::string_view s = getChildValueView(node, name, mandatory);
+    return s.empty() ? defaultValue : parseBool(string(s));
+}
+
+Period XMLUtils::getChildValueAsPeriod(XMLNode* node, std::string_view name, bool mandatory,
+                                       const Period& defaultValue) {
+    std::string_view s = getChildValueView(node, name, mandatory);
+    return s.empty() ? defaultValue : parsePeriod(string(s));
 }
 
 vector<string> XMLUtils::getChildrenValues(XMLNode* parent, const string& names, const string& name, bool mandatory) {
     vector<string> vec;
-    xml_node<>* node = parent->first_node(names.c_str());
+    xml_node<>* node = parent->first_node(names.data(), names.size());
     if (mandatory) {
         QL_REQUIRE(node, "Error: No XML Node " << names << " found.");
     }
     if (node) {
-        for (xml_node<>* child = node->first_node(name.c_str()); child; child = child->next_sibling(name.c_str()))
+        for (xml_node<>* child = node->first_node(name.data(), name.size()); child;
+             child = child->next_sibling(name.data(), name.size()))
             vec.push_back(getNodeValue(child));
     }
     return vec;
@@ -370,12 +385,13 @@ vector<string> XMLUtils::getChildrenValuesAsStrings(XMLNode* node, const string&
 map<string, string> XMLUtils::getChildrenValues(XMLNode* parent, const string& names, const string& name,
                                                 const string& firstName, const string& secondName, bool mandatory) {
     map<string, string> res;
-    xml_node<>* node = parent->first_node(names.c_str());
+    xml_node<>* node = parent->first_node(names.data(), names.size());
     if (mandatory) {
         QL_REQUIRE(node, "Error: No XML Node " << names << " found.");
     }
     if (node) {
-        for (xml_node<>* child = node->first_node(name.c_str()); child; child = child->next_sibling(name.c_str())) {
+        for (xml_node<>* child = node->first_node(name.data(), name.size()); child;
+             child = child->next_sibling(name.data(), name.size())) {
             string first = getChildValue(child, firstName, mandatory);
             string second = getChildValue(child, secondName, mandatory);
             // res[first] = second;
@@ -388,8 +404,7 @@ map<string, string> XMLUtils::getChildrenValues(XMLNode* parent, const string& n
 map<string, string> XMLUtils::getChildrenAttributesAndValues(XMLNode* parent, const string& names,
                                                              const string& attributeName, bool mandatory) {
     map<string, string> res;
-    for (XMLNode* child = getChildNode(parent, names.c_str()); child;
-         child = XMLUtils::getNextSibling(child, names.c_str())) {
+    for (XMLNode* child = getChildNode(parent, names); child; child = XMLUtils::getNextSibling(child, names)) {
         string first = getAttribute(child, attributeName);
         string second = getNodeValue(child);
         if (first.empty())
@@ -407,9 +422,9 @@ map<string, string> XMLUtils::getChildrenAttributesAndValues(XMLNode* parent, co
 }
 
 // returns first child node
-XMLNode* XMLUtils::getChildNode(XMLNode* n, const string& name) {
+XMLNode* XMLUtils::getChildNode(XMLNode* n, std::string_view name) {
     QL_REQUIRE(n, "XMLUtils::getChildNode(" << name << "): XML Node is NULL");
-    return n->first_node(name == "" ? nullptr : name.c_str());
+    return n->first_node(lookupName(name), name.size());
 }
 
 // return first node in the hierarchy of n that matches name, maybe n itself
@@ -439,20 +454,24 @@ void XMLUtils::addAttribute(XMLDocument& doc, XMLNode* node, const string& attrN
     node->append_attribute(doc.doc()->allocate_attribute(name, value));
 }
 
-string XMLUtils::getAttribute(XMLNode* node, const string& attrName) {
+string XMLUtils::getAttribute(XMLNode* node, std::string_view attrName) {
+    return string(getAttributeView(node, attrName));
+}
+
+std::string_view XMLUtils::getAttributeView(XMLNode* node, std::string_view attrName) {
     QL_REQUIRE(node, "XMLUtils::getAttribute(" << attrName << ") node is NULL");
-    xml_attribute<>* attr = node->first_attribute(attrName.c_str());
+    xml_attribute<>* attr = node->first_attribute(attrName.data(), attrName.size());
     if (attr && attr->value())
-        return string(attr->value());
+        return std::string_view(attr->value(), attr->value_size());
     else
-        return "";
+        return std::string_view();
 }
 
-vector<XMLNode*> XMLUtils::getChildrenNodes(XMLNode* node, const string& name) {
+vector<XMLNode*> XMLUtils::getChildrenNodes(XMLNode* node, std::string_view name) {
     QL_REQUIRE(node, "XMLUtils::getChildredNodes(" << name << ") node is NULL");
     vector<XMLNode*> res;
-    const char* p = name.empty() ? nullptr : name.c_str();
-    for (xml_node<>* c = node->first_node(p); c; c = c->next_sibling(p))
+    const char* p = lookupName(name);
+    for (xml_node<>* c = node->first_node(p, name.size()); c; c = c->next_sibling(p, name.size()))
         res.push_back(c);
     return res;
 }
@@ -503,19 +522,21 @@ void XMLUtils::setNodeName(XMLDocument& doc, XMLNode* node, const string& name)
     node->name(nodeName);
 }
 
-XMLNode* XMLUtils::getNextSibling(XMLNode* node, const string& name) {
+XMLNode* XMLUtils::getNextSibling(XMLNode* node, std::string_view name) {
     QL_REQUIRE(node, "XMLUtils::getNextSibling(" << name << "): XML Node is NULL");
-    return node->next_sibling(name == "" ? nullptr : name.c_str());
+    return node->next_sibling(lookupName(name), name.size());
 }
 
-string XMLUtils::getNodeValue(XMLNode* node) {
+string XMLUtils::getNodeValue(XMLNode* node) { return string(getNodeValueView(node)); }
+
+std::string_view XMLUtils::getNodeValueView(XMLNode* node) {
     QL_REQUIRE(node, "XMLUtils::getNodeValue(): XML Node is NULL");
     // handle CDATA nodes
     XMLNode* n = node->first_node();
     if (n && n->type() == node_cdata)
-        return n->value();
+        return std::string_view(n->value(), n->value_size());
     // all other cases
-    return node->value();
+    return std::string_view(node->value(), node->value_size());
 }
 
 // template implementations
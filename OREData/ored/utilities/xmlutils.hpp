@@ -32,6 +32,7 @@
 #include <map>
 #include <sstream> // std::ostringstream
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Forward declarations and typedefs
@@ -182,12 +183,17 @@ public:
                             const string& firstName, const string& secondName, const map<string, string>& values);
 
     // If mandatory == true, we throw if the node is not present, otherwise we return a default vale.
-    static string getChildValue(XMLNode* node, const string& name, bool mandatory = false, const string& defaultValue = string());
-    static Real getChildValueAsDouble(XMLNode* node, const string& name, bool mandatory = false, double defaultValue = 0.0);
-    static int getChildValueAsInt(XMLNode* node, const string& name, bool mandatory = false, int defaultValue = 0);
-    static bool getChildValueAsBool(XMLNode* node, const string& name, bool mandatory = false, bool defaultValue = true);
-    static Period getChildValueAsPeriod(XMLNode* node, const string& name, bool mandatory = false,
+    static string getChildValue(XMLNode* node, std::string_view name, bool mandatory = false,
+                                const string& defaultValue = string());
+    static Real getChildValueAsDouble(XMLNode* node, std::string_view name, bool mandatory = false,
+                                      double defaultValue = 0.0);
+    static int getChildValueAsInt(XMLNode* node, std::string_view name, bool mandatory = false, int defaultValue = 0);
+    static bool getChildValueAsBool(XMLNode* node, std::string_view name, bool mandatory = false,
+                                    bool defaultValue = true);
+    static Period getChildValueAsPeriod(XMLNode* node, std::string_view name, bool mandatory = false,
                                         const QuantLib::Period& defaultValue = 0 * QuantLib::Days);
+    //! Allocation free variant of getChildValue(), the view points into the document and is empty if there is no child
+    static std::string_view getChildValueView(XMLNode* node, std::string_view name, bool mandatory = false);
     static vector<string> getChildrenValues(XMLNode* node, const string& names, const string& name,
                                             bool mandatory = false);
     static vector<string>
@@ -227,18 +233,20 @@ public:
                                                               const string& attributeName, bool mandatory = false);
 
     // returns first child node
-    static XMLNode* getChildNode(XMLNode* n, const string& name = "");
+    static XMLNode* getChildNode(XMLNode* n, std::string_view name = {});
     // return first node in the hierarchy of n that matches name, maybe n itself
     static XMLNode* locateNode(XMLNode* n, const string& name = "");
     // append child to parent
     static void appendNode(XMLNode* parent, XMLNode* child);
 
     static void addAttribute(XMLDocument& doc, XMLNode* node, const string& attrName, const string& attrValue);
-    static string getAttribute(XMLNode* node, const string& attrName);
+    static string getAttribute(XMLNode* node, std::string_view attrName);
+    //! Allocation free variant of getAttribute(), the view points into the document
+    static std::string_view getAttributeView(XMLNode* node, std::string_view attrName);
 
     //! Returns all the children with a given name
     // To get all children, set name equal to ""
-    static vector<XMLNode*> getChildrenNodes(XMLNode* node, const string& name);
+    static vector<XMLNode*> getChildrenNodes(XMLNode* node, std::string_view name);
 
     static vector<XMLNode*> getChildrenNodesWithAttributes(XMLNode* node, const string& names, const string& name,
                                                            const string& attrName, vector<string>& attrs,
@@ -253,10 +261,12 @@ public:
     static void setNodeName(XMLDocument& doc, XMLNode* node, const string& name);
 
     //! Get a node's next sibling node
-    static XMLNode* getNextSibling(XMLNode* node, const string& name = "");
+    static XMLNode* getNextSibling(XMLNode* node, std::string_view name = {});
 
     //! Get a node's value
     static string getNodeValue(XMLNode* node);
+    //! Allocation free variant of getNodeValue(), the view points into the document
+    static std::string_view getNodeValueView(XMLNode* node);
 
     //! Get a node's compact values as vector of doubles
     static vector<Real> getNodeValueAsDoublesCompact(XMLNode* node);
@@ -64,6 +64,42 @@ BOOST_AUTO_TEST_CASE(testSimpleCBO) {
     BOOST_CHECK_CLOSE(p.get("CBO-Constellation")->instrument()->NPV(), expectedNpv, tol);
 }
 
+BOOST_AUTO_TEST_CASE(testCBOThreads) {
+    BOOST_TEST_MESSAGE("Testing that the CBO NPV does not depend on the number of waterfall threads...");
+
+    Settings::instance().evaluationDate() = Date(31, Dec, 2018);
+    Date asof = Settings::instance().evaluationDate();
+
+    auto conventions = boost::make_shared<Conventions>();
+    conventions->fromFile(TEST_INPUT_FILE("conventions.xml"));
+    InstrumentConventions::instance().setConventions(conventions);
+
+    auto todaysMarketParams = boost::make_shared<TodaysMarketParameters>();
+    todaysMarketParams->fromFile(TEST_INPUT_FILE("todaysmarket.xml"));
+    auto curveConfigs = boost::make_shared<CurveConfigurations>();
+    curveConfigs->fromFile(TEST_INPUT_FILE("curveconfig.xml"));
+    auto loader = boost::make_shared<CSVLoader>(TEST_INPUT_FILE("market.txt"), TEST_INPUT_FILE("fixings.txt"), false);
+    auto market = boost::make_shared<TodaysMarket>(asof, todaysMarketParams, loader, curveConfigs, false);
+
+    std::vector<Real> npvs;
+    for (string threads : {"1", "4"}) {
+        boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+        engineData->fromFile(TEST_INPUT_FILE("pricingengine.xml"));
+        // enough samples for several blocks of waterfalls
+        engineData->engineParameters("CBO")["Samples"] = "500";
+        engineData->engineParameters("CBO")["Threads"] = threads;
+        boost::shared_ptr<EngineFactory> factory = boost::make_shared<EngineFactory>(engineData, market);
+
+        Portfolio p;
+        p.fromFile(TEST_INPUT_FILE("cbo.xml"));
+        p.build(factory);
+        npvs.push_back(p.get("CBO-Constellation")->instrument()->NPV());
+    }
+
+    BOOST_TEST_MESSAGE("NPV with 1 thread " << npvs[0] << ", with 4 threads " << npvs[1]);
+    BOOST_CHECK_EQUAL(npvs[0], npvs[1]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
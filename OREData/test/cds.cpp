@@ -22,6 +22,7 @@
 #include <boost/test/data/test_case.hpp>
 // clang-format on
 #include <ored/configuration/curveconfigurations.hpp>
+#include <ored/marketdata/calibratedcurvecache.hpp>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/marketimpl.hpp>
@@ -351,6 +352,41 @@ BOOST_AUTO_TEST_CASE(testSimultaneousUsageCdsQuoteTypes) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testCalibratedCurveCache) {
+
+    BOOST_TEST_MESSAGE("Testing restoring CDS curves from the calibrated curve cache ...");
+
+    TodaysMarketFiles tmf;
+    tmf.todaysMarket = "todaysmarket_all_cds_quote_types.xml";
+
+    Date asof(6, Nov, 2020);
+    Settings::instance().evaluationDate() = asof;
+
+    CalibratedCurveCache& cache = CalibratedCurveCache::instance();
+    cache.clear();
+    cache.setEnabled(true);
+
+    // the first build fills the cache, the second one restores the curves from it
+    boost::shared_ptr<TodaysMarket> tm1, tm2;
+    BOOST_CHECK_NO_THROW(tm1 = createTodaysMarket(asof, "upfront", tmf));
+    Size cached = cache.size();
+    BOOST_CHECK(cached > 0);
+    BOOST_CHECK_NO_THROW(tm2 = createTodaysMarket(asof, "upfront", tmf));
+    BOOST_CHECK_EQUAL(cache.size(), cached);
+
+    cache.setEnabled(false);
+    cache.clear();
+
+    for (const string& curveName : {"RED:8B69AP|SNRFOR|USD|CR-UPFRONT", "RED:8B69AP|SNRFOR|USD|CR-PAR_SPREAD"}) {
+        BOOST_TEST_CONTEXT("Checking default curve " << curveName) {
+            for (Real t : {0.5, 1.0, 3.0, 5.0, 10.0}) {
+                BOOST_CHECK_CLOSE(tm2->defaultCurve(curveName)->curve()->survivalProbability(t),
+                                  tm1->defaultCurve(curveName)->curve()->survivalProbability(t), 1.0E-12);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -35,7 +35,10 @@
 #include <ql/math/interpolations/linearinterpolation.hpp>
 #include <ql/termstructures/volatility/equityfx/blackconstantvol.hpp>
 #include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/nullcalendar.hpp>
 #include <ql/time/calendars/unitedstates.hpp>
+#include <qle/cashflows/commodityindexedaveragecashflow.hpp>
+#include <qle/indexes/commodityindex.hpp>
 #include <qle/instruments/commodityapo.hpp>
 #include <qle/pricingengines/commodityapoengine.hpp>
 #include <qle/termstructures/pricecurve.hpp>
@@ -50,6 +53,30 @@ typedef struct {
     QuantLib::Option::Type optionType;
 } ApoTestCase;
 
+namespace {
+
+// futures expiring at the end of each month
+class EndOfMonthExpiryCalculator : public FutureExpiryCalculator {
+public:
+    QuantLib::Date nextExpiry(bool includeExpiry, const QuantLib::Date& referenceDate, QuantLib::Natural offset,
+                              bool forOption) override {
+        return Date::endOfMonth(referenceDate);
+    }
+    QuantLib::Date priorExpiry(bool includeExpiry, const QuantLib::Date& referenceDate, bool forOption) override {
+        return Date(1, referenceDate.month(), referenceDate.year()) - 1 * Days;
+    }
+    QuantLib::Date expiryDate(const QuantLib::Date& contractDate, QuantLib::Natural monthOffset,
+                              bool forOption) override {
+        return Date::endOfMonth(contractDate);
+    }
+    QuantLib::Date contractDate(const QuantLib::Date& expiryDate) override { return expiryDate; }
+    QuantLib::Date applyFutureMonthOffset(const QuantLib::Date& contractDate, Natural futureMonthOffset) override {
+        return QuantLib::Date();
+    }
+};
+
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREPlusCommodityTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(CommodityApoTest)
@@ -144,5 +171,60 @@ BOOST_AUTO_TEST_CASE(testCommodityAPO) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testCommodityAPOMonteCarloPathSharing) {
+
+    BOOST_TEST_MESSAGE("Testing the sharing of the future paths and the threads of the commodity APO MC engine");
+
+    SavedSettings backup;
+
+    Date today(5, Feb, 2019);
+    Settings::instance().evaluationDate() = today;
+    DayCounter dc = Actual365Fixed();
+
+    // Market - upward sloping price curve, flat discount curve and volatility structure
+    std::vector<Date> dates = {today + 1 * Years, today + 5 * Years};
+    std::vector<Real> prices = {100.0, 110.0};
+    Handle<QuantExt::PriceTermStructure> priceCurve(
+        boost::make_shared<InterpolatedPriceCurve<Linear>>(today, dates, prices, dc, USDCurrency()));
+    priceCurve->enableExtrapolation();
+    Handle<YieldTermStructure> discountCurve(boost::make_shared<FlatForward>(today, 0.01, dc));
+    Handle<QuantLib::BlackVolTermStructure> vol(
+        boost::make_shared<QuantLib::BlackConstantVol>(today, NullCalendar(), 0.3, dc));
+
+    // APOs averaging the November and December 2019 futures
+    auto index = boost::make_shared<CommodityFuturesIndex>("CL", Date(31, Dec, 2019), NullCalendar(), priceCurve);
+    auto flow = boost::make_shared<CommodityIndexedAverageCashFlow>(
+        1.0, Date(1, Nov, 2019), Date(31, Dec, 2019), Date(31, Dec, 2019), index, NullCalendar(), 0.0, 1.0, true, 0,
+        0, boost::make_shared<EndOfMonthExpiryCalculator>());
+    boost::shared_ptr<Exercise> exercise = boost::make_shared<EuropeanExercise>(Date(31, Dec, 2019));
+
+    Size samples = 5000;
+    Real beta = 0.5;
+    auto cache = boost::make_shared<CommodityApoMcPathCache>();
+    auto engine = boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, samples, beta,
+                                                                                  42, 1, cache);
+    auto sharedEngine = boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, samples,
+                                                                                        beta, 42, 4, cache);
+    auto threadedEngine =
+        boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, samples, beta, 42, 4);
+
+    for (Real strike : {95.0, 105.0}) {
+        CommodityAveragePriceOption apo(flow, exercise, 1.0, strike, Option::Call);
+        apo.setPricingEngine(engine);
+        Real npv = apo.NPV();
+        apo.setPricingEngine(sharedEngine);
+        Real sharedNpv = apo.NPV();
+        apo.setPricingEngine(threadedEngine);
+        Real threadedNpv = apo.NPV();
+        BOOST_TEST_MESSAGE("strike " << strike << ": " << npv << " " << sharedNpv << " " << threadedNpv);
+        BOOST_CHECK(npv > 0.0);
+        BOOST_CHECK_EQUAL(npv, sharedNpv);
+        BOOST_CHECK_EQUAL(npv, threadedNpv);
+    }
+
+    // the volatility is flat, so both strikes use the same path set
+    BOOST_CHECK_EQUAL(cache->size(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
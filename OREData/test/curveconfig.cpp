@@ -44,6 +44,8 @@
 #include <ql/time/calendar.hpp>
 #include <ql/time/daycounter.hpp>
 
+#include <thread>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace boost::unit_test_framework;
@@ -136,6 +138,37 @@ BOOST_AUTO_TEST_CASE(testFromToXml) {
     BOOST_CHECK(compareFiles(outputFile_1, outputFile_2));
 }
 
+BOOST_AUTO_TEST_CASE(testConcurrentLazyParsing) {
+
+    BOOST_TEST_MESSAGE("Testing concurrent access to lazily parsed curve configurations");
+
+    CurveConfigurations lazyConfigs;
+    lazyConfigs.fromFile(TEST_INPUT_FILE("curve_config.xml"));
+    std::set<string> ids = lazyConfigs.yieldCurveConfigIds();
+    BOOST_REQUIRE(!ids.empty());
+
+    // each config is parsed once, all threads see the same instance
+    const Size nThreads = 4;
+    std::vector<std::vector<boost::shared_ptr<YieldCurveConfig>>> results(nThreads);
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < nThreads; ++i) {
+        threads.emplace_back([&lazyConfigs, &ids, &results, i]() {
+            for (auto const& id : ids)
+                results[i].push_back(lazyConfigs.yieldCurveConfig(id));
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    for (Size i = 0; i < nThreads; ++i) {
+        BOOST_REQUIRE_EQUAL(results[i].size(), ids.size());
+        for (Size j = 0; j < ids.size(); ++j) {
+            BOOST_CHECK(results[i][j]);
+            BOOST_CHECK(results[i][j] == results[0][j]);
+        }
+    }
+}
+
 // Testing curve config quotes method with no restrictions
 BOOST_AUTO_TEST_CASE(testCurveConfigQuotesAll) {
 
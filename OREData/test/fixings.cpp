@@ -23,8 +23,12 @@
 // clang-format on
 #include <ored/configuration/conventions.hpp>
 #include <ored/configuration/curveconfigurations.hpp>
+#include <ored/marketdata/clonedloader.hpp>
+#include <ored/marketdata/compactloader.hpp>
+#include <ored/marketdata/compositeloader.hpp>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/inmemoryloader.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/marketdata/todaysmarketparameters.hpp>
 #include <ored/portfolio/enginefactory.hpp>
@@ -38,6 +42,8 @@
 #include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
+#include <fstream>
+#include <iomanip>
 #include <tuple>
 
 using namespace QuantLib;
@@ -277,6 +283,290 @@ BOOST_AUTO_TEST_CASE(testModifyInflationFixings) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testLoaderFixingLookup) {
+
+    BOOST_TEST_MESSAGE("Testing fixing lookup by name and date in the in memory and composite loaders");
+
+    Date d1(18, Dec, 2018), d2(19, Dec, 2018);
+    auto a = boost::make_shared<InMemoryLoader>();
+    a->addFixing(d1, "EUR-EURIBOR-3M", -0.0031);
+    a->add(d1, "MM/RATE/EUR/0D/1D", -0.0036);
+    auto b = boost::make_shared<InMemoryLoader>();
+    b->addFixing(d1, "EUR-EURIBOR-3M", -0.0030);
+    b->addFixing(d2, "EUR-EURIBOR-3M", -0.0032);
+
+    BOOST_CHECK(a->hasFixing("EUR-EURIBOR-3M", d1));
+    BOOST_CHECK(!a->hasFixing("EUR-EURIBOR-3M", d2));
+    BOOST_CHECK(!a->hasFixing("EUR-EURIBOR-6M", d1));
+    BOOST_CHECK_CLOSE(a->getFixing("EUR-EURIBOR-3M", d1).fixing, -0.0031, 1e-12);
+    BOOST_CHECK(a->getFixing("EUR-EURIBOR-3M", d2).empty());
+    BOOST_CHECK(a->has("MM/RATE/EUR/0D/1D", d1));
+    BOOST_CHECK(!a->has("MM/RATE/EUR/0D/1D", d2));
+    BOOST_CHECK(!a->has("MM/RATE/EUR/0D/2D", d1));
+
+    // the first loader takes precedence, as in loadFixings()
+    CompositeLoader c(a, b);
+    BOOST_CHECK_CLOSE(c.getFixing("EUR-EURIBOR-3M", d1).fixing, -0.0031, 1e-12);
+    BOOST_CHECK_CLOSE(c.getFixing("EUR-EURIBOR-3M", d2).fixing, -0.0032, 1e-12);
+    BOOST_CHECK(!c.hasFixing("EUR-EURIBOR-6M", d1));
+    for (auto const& f : c.loadFixings())
+        BOOST_CHECK_EQUAL(c.getFixing(f.name, f.date).fixing, f.fixing);
+}
+
+BOOST_AUTO_TEST_CASE(testApplyFixings) {
+
+    BOOST_TEST_MESSAGE("Testing applyFixings with valid and invalid fixings");
+
+    IndexManager::instance().clearHistories();
+    // 15 Dec 2018 is a Saturday and not a valid fixing date, the other fixings are added nevertheless
+    set<Fixing> fixings = {Fixing(Date(13, Dec, 2018), "EUR-EURIBOR-3M", -0.0031),
+                           Fixing(Date(14, Dec, 2018), "EUR-EURIBOR-3M", -0.0032),
+                           Fixing(Date(15, Dec, 2018), "EUR-EURIBOR-3M", -0.0033),
+                           Fixing(Date(14, Dec, 2018), "EUR-EURIBOR-6M", -0.0024),
+                           Fixing(Date(14, Dec, 2018), "INVALID-INDEX", 1.0)};
+    applyFixings(fixings);
+
+    auto e3m = parseIborIndex("EUR-EURIBOR-3M");
+    auto e6m = parseIborIndex("EUR-EURIBOR-6M");
+    BOOST_CHECK_EQUAL(e3m->timeSeries().size(), Size(2));
+    BOOST_CHECK_EQUAL(e3m->timeSeries()[Date(13, Dec, 2018)], -0.0031);
+    BOOST_CHECK_EQUAL(e3m->timeSeries()[Date(14, Dec, 2018)], -0.0032);
+    BOOST_CHECK_EQUAL(e6m->timeSeries()[Date(14, Dec, 2018)], -0.0024);
+    IndexManager::instance().clearHistories();
+}
+
+BOOST_AUTO_TEST_CASE(testInMemoryLoaderMerge) {
+
+    BOOST_TEST_MESSAGE("Testing the merge of in memory loaders via parsed market data");
+
+    Date d1(18, Dec, 2018), d2(19, Dec, 2018);
+    InMemoryLoader a, b, merged;
+    a.add(d1, "MM/RATE/EUR/0D/1D", 0.01);
+    a.add(d1, "FX/RATE/EUR/USD", 1.1);
+    b.add(d2, "MM/RATE/EUR/0D/1D", 0.02);
+    for (auto const* l : {&a, &b})
+        for (auto const& d : l->dates())
+            for (auto const& md : l->loadQuotes(d))
+                merged.add(md);
+    // duplicates are skipped
+    merged.add(a.get("MM/RATE/EUR/0D/1D", d1));
+
+    BOOST_CHECK(merged.dates() == std::set<Date>({d1, d2}));
+    BOOST_CHECK_EQUAL(merged.loadQuotes(d1).size(), Size(2));
+    BOOST_CHECK_EQUAL(merged.loadQuotes(d2).size(), Size(1));
+    BOOST_CHECK_EQUAL(merged.get("MM/RATE/EUR/0D/1D", d2)->quote()->value(), 0.02);
+    BOOST_CHECK_EQUAL(merged.get("FX/RATE/EUR/USD", d1)->quote()->value(), 1.1);
+}
+
+BOOST_AUTO_TEST_CASE(testLazyClonedLoader) {
+
+    BOOST_TEST_MESSAGE("Testing the lazy cloned loader");
+
+    Date d1(18, Dec, 2018), d2(19, Dec, 2018);
+    auto source = boost::make_shared<InMemoryLoader>();
+    source->add(d1, "MM/RATE/EUR/0D/1D", 0.01);
+    source->add(d1, "MM/RATE/EUR/0D/3M", 0.02);
+    source->add(d1, "FX/RATE/EUR/USD", 1.1);
+    source->add(d2, "FX/RATE/EUR/USD", 1.2);
+    source->addFixing(d1, "EUR-EONIA", 0.01);
+
+    LazyClonedLoader loader(d1, source);
+    BOOST_CHECK_EQUAL(loader.numberOfClones(), Size(0));
+
+    // a datum is cloned on its first request only, the clone has its own quote
+    auto md = loader.get("FX/RATE/EUR/USD", d1);
+    BOOST_CHECK(md != source->get("FX/RATE/EUR/USD", d1));
+    BOOST_CHECK(md->quote() != source->get("FX/RATE/EUR/USD", d1)->quote());
+    BOOST_CHECK_EQUAL(md->quote()->value(), 1.1);
+    BOOST_CHECK(loader.get("FX/RATE/EUR/USD", d1) == md);
+    BOOST_CHECK_EQUAL(loader.numberOfClones(), Size(1));
+
+    BOOST_CHECK_EQUAL(loader.get(Wildcard("MM/RATE/EUR/*"), d1).size(), Size(2));
+    BOOST_CHECK_EQUAL(loader.numberOfClones(), Size(3));
+    BOOST_CHECK_EQUAL(loader.loadQuotes(d1).size(), Size(3));
+    BOOST_CHECK_EQUAL(loader.numberOfClones(), Size(3));
+
+    // only the loader date is provided, fixings are read from the source
+    BOOST_CHECK(!loader.has("FX/RATE/EUR/USD", d2));
+    BOOST_CHECK(loader.loadQuotes(d2).empty());
+    BOOST_CHECK_THROW(loader.get("FX/RATE/EUR/USD", d2), QuantLib::Error);
+    BOOST_CHECK(loader.hasFixing("EUR-EONIA", d1));
+    BOOST_CHECK_EQUAL(loader.getFixing("EUR-EONIA", d1).fixing, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(testCompactLoader) {
+
+    BOOST_TEST_MESSAGE("Testing the compact loader against the in memory loader");
+
+    Date d1(18, Dec, 2018), d2(19, Dec, 2018);
+    vector<string> names = {"MM/RATE/EUR/0D/1D", "MM/RATE/EUR/0D/3M", "FX/RATE/EUR/USD", "ZERO/RATE/EUR/EUR1D/A365/1Y"};
+    InMemoryLoader reference;
+    CompactLoader loader;
+    for (Size i = 0; i < names.size(); ++i) {
+        for (auto const& d : {d1, d2}) {
+            if (d == d2 && i == 1)
+                continue;
+            reference.add(d, names[i], 0.01 * (i + 1) + (d - d1) * 0.001);
+            loader.add(d, names[i], 0.01 * (i + 1) + (d - d1) * 0.001);
+        }
+    }
+    // invalid names and duplicates are skipped
+    loader.add(d1, "INVALID/NAME", 1.0);
+    loader.add(d1, "MM/RATE/EUR/0D/1D", 1.0);
+    BOOST_CHECK_EQUAL(loader.numberOfKeys(), names.size());
+
+    for (auto const& d : {d1, d2}) {
+        auto q1 = reference.loadQuotes(d);
+        auto q2 = loader.loadQuotes(d);
+        BOOST_REQUIRE_EQUAL(q1.size(), q2.size());
+        for (Size i = 0; i < q1.size(); ++i) {
+            BOOST_CHECK_EQUAL(q1[i]->name(), q2[i]->name());
+            BOOST_CHECK_EQUAL(q1[i]->asofDate(), q2[i]->asofDate());
+            BOOST_CHECK_EQUAL(q1[i]->instrumentType(), q2[i]->instrumentType());
+            BOOST_CHECK_EQUAL(q1[i]->quote()->value(), q2[i]->quote()->value());
+        }
+        BOOST_CHECK_EQUAL(reference.get(Wildcard("MM/RATE/EUR/*"), d).size(),
+                          loader.get(Wildcard("MM/RATE/EUR/*"), d).size());
+    }
+    BOOST_CHECK(!loader.has("MM/RATE/EUR/0D/3M", d2));
+    BOOST_CHECK(!loader.has("INVALID/NAME", d1));
+    BOOST_CHECK_THROW(loader.get("MM/RATE/EUR/0D/3M", d2), QuantLib::Error);
+
+    // the market datums are built once and then shared
+    auto md = loader.get("FX/RATE/EUR/USD", d1);
+    BOOST_CHECK(md == loader.get("FX/RATE/EUR/USD", d1));
+    BOOST_CHECK_CLOSE(md->quote()->value(), 0.03, 1e-10);
+    BOOST_CHECK(boost::dynamic_pointer_cast<FXSpotQuote>(md) != nullptr);
+    loader.clearCache();
+    BOOST_CHECK(md != loader.get("FX/RATE/EUR/USD", d1));
+}
+
+BOOST_AUTO_TEST_CASE(testCompactLoaderSnapshot) {
+
+    BOOST_TEST_MESSAGE("Testing the binary snapshot of the compact loader");
+
+    Date d1(18, Dec, 2018), d2(19, Dec, 2018);
+    CompactLoader loader;
+    loader.add(d1, "MM/RATE/EUR/0D/1D", -0.0036);
+    loader.add(d1, "FX/RATE/EUR/USD", 1.13);
+    loader.add(d2, "FX/RATE/EUR/USD", 1.14);
+    loader.addFixing(d1, "EUR-EURIBOR-3M", -0.0031);
+    loader.addFixing(d2, "EUR-EURIBOR-3M", -0.0032);
+    loader.addFixing(d1, "USD-LIBOR-3M", 0.028);
+    loader.addDividend(QuantExt::Dividend(d1, "SP5", 1.5, d2));
+
+    string file = TEST_OUTPUT_FILE("compactloader_snapshot.bin");
+    loader.writeSnapshot(file, "tag1");
+
+    CompactLoader snapshot;
+    BOOST_CHECK(!snapshot.readSnapshot(file, "tag2"));
+    BOOST_CHECK(!snapshot.hasQuotes(d1));
+    BOOST_CHECK(!snapshot.readSnapshot(TEST_OUTPUT_FILE("does_not_exist.bin"), "tag1"));
+    BOOST_REQUIRE(snapshot.readSnapshot(file, "tag1"));
+
+    for (auto const& d : {d1, d2}) {
+        auto q1 = loader.loadQuotes(d);
+        auto q2 = snapshot.loadQuotes(d);
+        BOOST_REQUIRE_EQUAL(q1.size(), q2.size());
+        for (Size i = 0; i < q1.size(); ++i) {
+            BOOST_CHECK_EQUAL(q1[i]->name(), q2[i]->name());
+            BOOST_CHECK_EQUAL(q1[i]->quote()->value(), q2[i]->quote()->value());
+        }
+    }
+    BOOST_CHECK(!snapshot.has("MM/RATE/EUR/0D/1D", d2));
+    BOOST_CHECK_EQUAL(snapshot.loadFixings().size(), Size(3));
+    BOOST_CHECK_EQUAL(snapshot.getFixing("EUR-EURIBOR-3M", d2).fixing, -0.0032);
+    BOOST_CHECK_EQUAL(snapshot.getFixing("USD-LIBOR-3M", d1).fixing, 0.028);
+    auto dividends = snapshot.loadDividends();
+    BOOST_REQUIRE_EQUAL(dividends.size(), Size(1));
+    BOOST_CHECK_EQUAL(dividends.begin()->name, "SP5");
+    BOOST_CHECK_EQUAL(dividends.begin()->payDate, d2);
+    BOOST_CHECK_EQUAL(dividends.begin()->rate, 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(testCsvLoaderParallelParsing) {
+
+    BOOST_TEST_MESSAGE("Testing chunked parallel parsing and market date filter in the CSVLoader");
+
+    Date asof(21, Feb, 2019);
+    Settings::instance().evaluationDate() = asof;
+
+    // a fixing file above the chunk size, with both date formats, separators and duplicates
+    string fixingFile = TEST_OUTPUT_FILE("csvloader_fixings.csv");
+    {
+        std::ofstream out(fixingFile);
+        out << "# date index value\n";
+        for (Size i = 0; i < 60000; ++i) {
+            Date d = asof - static_cast<Integer>(i % 3000);
+            string name = "INDEX-" + std::to_string(i / 3000);
+            if (i % 2 == 0)
+                out << io::iso_date(d) << "," << name << "," << 0.0001 * i << "\n";
+            else
+                out << d.year() << std::setw(2) << std::setfill('0') << static_cast<int>(d.month()) << std::setw(2)
+                    << d.dayOfMonth() << " \t" << name << ";" << 0.0001 * i << "\r\n";
+            if (i % 1000 == 0)
+                out << io::iso_date(d) << "," << name << "," << -1.0 << "\n";
+        }
+    }
+    string marketFile = TEST_OUTPUT_FILE("csvloader_market.csv");
+    {
+        std::ofstream out(marketFile);
+        out << "2019-02-21,MM/RATE/EUR/0D/1D,-0.0036\n";
+        out << "2019-02-20,MM/RATE/EUR/0D/1D,-0.0035\n";
+        out << "2019-02-21,MM/RATE/EUR/0D/1D,-0.0100\n";
+    }
+
+    vector<string> marketFiles = {marketFile}, fixingFiles = {fixingFile}, dividendFiles;
+    CSVLoader sequential(marketFiles, fixingFiles, dividendFiles, false);
+    CSVLoader parallel(marketFiles, fixingFiles, dividendFiles, false, {asof}, 4);
+
+    auto f1 = sequential.loadFixings();
+    auto f2 = parallel.loadFixings();
+    BOOST_CHECK_EQUAL(f1.size(), Size(60000));
+    BOOST_REQUIRE_EQUAL(f1.size(), f2.size());
+    for (auto it1 = f1.begin(), it2 = f2.begin(); it1 != f1.end(); ++it1, ++it2) {
+        BOOST_CHECK_EQUAL(it1->name, it2->name);
+        BOOST_CHECK_EQUAL(it1->date, it2->date);
+        BOOST_CHECK_EQUAL(it1->fixing, it2->fixing);
+    }
+    // the first occurrence of a duplicate is kept
+    BOOST_CHECK_CLOSE(parallel.getFixing("INDEX-1", asof).fixing, 0.3, 1e-10);
+
+    BOOST_CHECK(sequential.has("MM/RATE/EUR/0D/1D", asof - 1));
+    BOOST_CHECK(!parallel.has("MM/RATE/EUR/0D/1D", asof - 1));
+    BOOST_CHECK_CLOSE(parallel.get("MM/RATE/EUR/0D/1D", asof)->quote()->value(), -0.0036, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(testRequiredFixingDates) {
+
+    BOOST_TEST_MESSAGE("Testing the fixing dates required for a settlement date");
+
+    Date asof(21, Feb, 2019);
+    Settings::instance().evaluationDate() = asof;
+    Settings::instance().includeReferenceDateEvents() = true;
+
+    RequiredFixings rf;
+    // past fixing of a flow paid in the future, on the settlement date and in the past
+    rf.addFixingDate(Date(18, Feb, 2019), "EUR-EONIA", Date(22, Feb, 2019));
+    rf.addFixingDate(Date(19, Feb, 2019), "EUR-EONIA", asof);
+    rf.addFixingDate(Date(20, Feb, 2019), "EUR-EONIA", Date(20, Feb, 2019));
+    // a flow paid on the settlement date added with alwaysAddIfPaysOnSettlement, and a future fixing
+    rf.addFixingDate(Date(15, Feb, 2019), "EUR-EURIBOR-3M", asof, true);
+    rf.addFixingDate(Date(25, Feb, 2019), "EUR-EURIBOR-3M", Date(1, Mar, 2019));
+    rf.addFixingDates({Date(14, Feb, 2019), Date(13, Feb, 2019)}, "USD-FedFunds", Date(1, Mar, 2019));
+
+    // flows paid on the settlement date have not occurred, if reference date events are included
+    map<string, set<Date>> expected = {{"EUR-EONIA", {Date(18, Feb, 2019), Date(19, Feb, 2019)}},
+                                       {"EUR-EURIBOR-3M", {Date(15, Feb, 2019)}},
+                                       {"USD-FedFunds", {Date(13, Feb, 2019), Date(14, Feb, 2019)}}};
+    BOOST_CHECK(rf.fixingDatesIndices() == expected);
+
+    // otherwise their fixings are only required if alwaysAddIfPaysOnSettlement is set
+    Settings::instance().includeReferenceDateEvents() = false;
+    expected["EUR-EONIA"].erase(Date(19, Feb, 2019));
+    BOOST_CHECK(rf.fixingDatesIndices() == expected);
+}
+
 BOOST_AUTO_TEST_CASE(testAddMarketFixings) {
 
     // Set the evaluation date
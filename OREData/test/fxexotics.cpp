@@ -1243,6 +1243,74 @@ DoubleTouchOptionData fxdt[] = {
     {"KnockOut", 95.0, 105.0, 10.0, 100.0, 0.02, 0.05, 0.25, 0.5, 0.0000}};
 } // namespace
 
+BOOST_AUTO_TEST_CASE(testFXBarrierAndTouchOptionBatchPricing) {
+    BOOST_TEST_MESSAGE("Testing FXBarrierOption and FXTouchOption batch pricing...");
+
+    boost::shared_ptr<TestMarket> market = boost::make_shared<TestMarket>(100.0, 0.04, 0.08, 0.25);
+    Date today = Settings::instance().evaluationDate();
+    Settings::instance().evaluationDate() = market->asofDate();
+
+    // the same trades are priced on the same market with and without batch pricing
+    auto buildEngineFactory = [&market](bool batchPricing) {
+        boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+        engineData->model("FxBarrierOption") = "GarmanKohlhagen";
+        engineData->engine("FxBarrierOption") = "AnalyticBarrierEngine";
+        engineData->model("FxOption") = "GarmanKohlhagen";
+        engineData->engine("FxOption") = "AnalyticEuropeanEngine";
+        engineData->model("FxTouchOption") = "GarmanKohlhagen";
+        engineData->engine("FxTouchOption") = "AnalyticDigitalAmericanEngine";
+        engineData->model("Swap") = "DiscountedCashflows";
+        engineData->engine("Swap") = "DiscountingSwapEngine";
+        if (batchPricing) {
+            engineData->engineParameters("FxBarrierOption") = {{"BatchPricing", "true"}};
+            engineData->engineParameters("FxTouchOption") = {{"BatchPricing", "true"}};
+        }
+        return boost::make_shared<EngineFactory>(engineData, market);
+    };
+
+    vector<boost::shared_ptr<Trade>> batchTrades, trades;
+    Envelope env("CP1");
+    for (string barrierType : {"DownAndOut", "UpAndOut", "DownAndIn", "UpAndIn"}) {
+        bool down = barrierType.find("Down") == 0;
+        Real barrier = down ? 95.0 : 105.0;
+        vector<TradeBarrier> tradeBarriers = {TradeBarrier(barrier, "")};
+        for (string optionType : {"Call", "Put"}) {
+            for (Real strike : {90.0, 100.0, 110.0}) {
+                OptionData optionData("Long", optionType, "European", true, vector<string>(1, "20160801"));
+                BarrierData barrierData(barrierType, {barrier}, 3.0, tradeBarriers);
+                for (auto t : {&batchTrades, &trades})
+                    t->push_back(boost::make_shared<FxBarrierOption>(env, optionData, barrierData, Date(), "", "EUR",
+                                                                     1, "JPY", strike));
+            }
+        }
+        OptionData touchOptionData("Long", down ? "Put" : "Call", "American", true, vector<string>(1, "20160801"));
+        BarrierData touchBarrierData(barrierType, {barrier}, 0.0, tradeBarriers);
+        for (auto t : {&batchTrades, &trades})
+            t->push_back(boost::make_shared<FxTouchOption>(env, touchOptionData, touchBarrierData, "EUR", "JPY", "JPY",
+                                                           15.0));
+    }
+
+    auto batchEngineFactory = buildEngineFactory(true);
+    auto engineFactory = buildEngineFactory(false);
+    for (Size i = 0; i < trades.size(); ++i) {
+        batchTrades[i]->build(batchEngineFactory);
+        trades[i]->build(engineFactory);
+    }
+
+    // the batch values are recomputed when the spot moves, also when the barriers are touched
+    for (Real spot : {100.0, 101.0, 97.0, 104.0, 94.0, 106.0, 100.0}) {
+        market->setFxSpot("EURJPY", spot);
+        for (Size i = 0; i < trades.size(); ++i) {
+            Real npv = trades[i]->instrument()->NPV();
+            Real batchNpv = batchTrades[i]->instrument()->NPV();
+            BOOST_TEST_MESSAGE("spot " << spot << " trade " << i << " npv " << npv << " batch npv " << batchNpv);
+            BOOST_CHECK_SMALL(batchNpv - npv, 1.0E-10);
+        }
+    }
+
+    Settings::instance().evaluationDate() = today; // reset
+}
+
 BOOST_AUTO_TEST_CASE(testFXDoubleBarrierOptionPrice) {
     BOOST_TEST_MESSAGE("Testing FXDoubleBarrierOption Price...");
     for (auto& f : fxdb) {
@@ -19,9 +19,11 @@
 
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <thread>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/strike.hpp>
+#include <ored/utilities/to_string.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/time/calendars/austria.hpp>
@@ -1090,6 +1092,46 @@ BOOST_AUTO_TEST_CASE(testJointCalendar) {
     checkCalendars(expectedHolidays, hol);
 }
 
+BOOST_AUTO_TEST_CASE(testParserCaches) {
+
+    BOOST_TEST_MESSAGE("Testing repeated and concurrent calls of the cached parsers...");
+
+    // repeated calls return the cached results, failures are not cached
+    for (Size i = 0; i < 2; ++i) {
+        BOOST_CHECK_EQUAL(ore::data::parseDate("2017-06-05"), Date(5, Jun, 2017));
+        BOOST_CHECK_EQUAL(ore::data::parsePeriod("1Y6M"), 1 * Years + 6 * Months);
+        BOOST_CHECK_THROW(ore::data::parseDate("xx17-06-05"), QuantLib::Error);
+        BOOST_CHECK_THROW(ore::data::parsePeriod("3X"), QuantLib::Error);
+        Calendar cal = ore::data::parseCalendar("TARGET,US,UK");
+        BOOST_CHECK(cal.isHoliday(Date(4, Jul, 2018)));
+        BOOST_CHECK(cal.isHoliday(Date(28, May, 2018)));
+        BOOST_CHECK(cal.isBusinessDay(Date(5, Jul, 2018)));
+        BOOST_CHECK_THROW(ore::data::parseCalendar("TARGET,XYZ"), QuantLib::Error);
+    }
+
+    // concurrent calls for fresh and cached strings
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (Size t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([t, &failures]() {
+            for (Size i = 0; i < 1000; ++i) {
+                Date d = Date(1, Jan, 2020) + static_cast<Integer>(i);
+                if (ore::data::parseDate(ore::data::to_string(d)) != d)
+                    ++failures[t];
+                Integer n = static_cast<Integer>(i % 50 + 1);
+                if (ore::data::parsePeriod(std::to_string(n) + "M") != n * Months)
+                    ++failures[t];
+                if (ore::data::parseCalendar("TARGET,JP").name() != ore::data::parseCalendar("TARGET,JP").name())
+                    ++failures[t];
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    for (auto f : failures)
+        BOOST_CHECK_EQUAL(f, 0);
+}
+
 BOOST_AUTO_TEST_CASE(testParseBoostAny) {
 
     BOOST_TEST_MESSAGE("Testing parsing of Boost::Any...");
@@ -18,15 +18,46 @@
 
 #include <boost/make_shared.hpp>
 #include <boost/test/unit_test.hpp>
+#include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/builders/fxforward.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/failedtrade.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
+#include <ored/portfolio/referencedata.hpp>
+#include <ored/utilities/to_string.hpp>
+#include <ored/utilities/tracing.hpp>
+#include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
+#include <ql/currencies/america.hpp>
+#include <ql/currencies/europe.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 
 using namespace QuantLib;
 using namespace boost::unit_test_framework;
 using namespace std;
 using namespace ore::data;
 
+namespace {
+class TestMarket : public MarketImpl {
+public:
+    TestMarket() : MarketImpl(false) {
+        asof_ = Date(3, Feb, 2015);
+        for (auto const& [ccy, rate] : std::map<string, Real>{{"EUR", 0.02}, {"USD", 0.03}})
+            yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, ccy)] =
+                Handle<YieldTermStructure>(boost::make_shared<FlatForward>(0, NullCalendar(), rate, Actual365Fixed()));
+        std::map<std::string, Handle<Quote>> quotes;
+        quotes["EURUSD"] = Handle<Quote>(boost::make_shared<SimpleQuote>(1.2));
+        fx_ = boost::make_shared<FXTriangulation>(quotes);
+    }
+};
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(PortfolioTests)
@@ -119,6 +150,237 @@ BOOST_AUTO_TEST_CASE(testIds) {
     BOOST_CHECK(portfolio->ids() == trade_ids);
 }
 
+BOOST_AUTO_TEST_CASE(testParallelBuild) {
+
+    BOOST_TEST_MESSAGE("Testing that a parallel portfolio build gives the same portfolio as a sequential build");
+
+    auto market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+    auto engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    auto engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+    BOOST_CHECK(engineFactory->supportsConcurrentBuilds());
+
+    std::vector<boost::shared_ptr<Portfolio>> portfolios;
+    for (Size nThreads : {1, 4}) {
+        auto portfolio = boost::make_shared<Portfolio>();
+        for (Size i = 0; i < 20; ++i) {
+            // every fifth trade has an unknown currency and fails to build
+            auto trade = boost::make_shared<FxForward>(Envelope("CP"), "2016-02-03", "EUR", 1.0E6,
+                                                       i % 5 == 4 ? "XXX" : "USD", 1.2E6 + 1000.0 * i);
+            trade->id() = "trade_" + ore::data::to_string(i);
+            portfolio->add(trade);
+        }
+        portfolio->build(engineFactory, "test", false, nThreads);
+        portfolios.push_back(portfolio);
+    }
+
+    BOOST_REQUIRE_EQUAL(portfolios[0]->size(), Size(20));
+    BOOST_REQUIRE(portfolios[0]->ids() == portfolios[1]->ids());
+    for (auto const& [id, trade] : portfolios[0]->trades()) {
+        auto other = portfolios[1]->trades().at(id);
+        BOOST_CHECK_EQUAL(trade->tradeType(), other->tradeType());
+        BOOST_CHECK_CLOSE(trade->instrument()->NPV(), other->instrument()->NPV(), 1.0E-10);
+    }
+    BOOST_CHECK_EQUAL(portfolios[1]->trades().at("trade_4")->tradeType(), "Failed");
+
+    // a builder serving several trade types with different parameters can not be used concurrently
+    engineData->model("EquityVarianceSwap") = "BlackScholesMerton";
+    engineData->engine("EquityVarianceSwap") = "ReplicatingVarianceSwapEngine";
+    engineData->engineParameters("EquityVarianceSwap")["Scheme"] = "GaussLobatto";
+    engineData->model("FxVarianceSwap") = "BlackScholesMerton";
+    engineData->engine("FxVarianceSwap") = "ReplicatingVarianceSwapEngine";
+    engineData->engineParameters("FxVarianceSwap")["Scheme"] = "Segment";
+    BOOST_CHECK(!boost::make_shared<EngineFactory>(engineData, market)->supportsConcurrentBuilds());
+}
+
+BOOST_AUTO_TEST_CASE(testTraceSpans) {
+
+    BOOST_TEST_MESSAGE("Testing the trace spans recorded by a portfolio build");
+
+    auto market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+    auto engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    auto engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+
+    auto buildPortfolio = [&engineFactory]() {
+        auto portfolio = boost::make_shared<Portfolio>();
+        for (Size i = 0; i < 3; ++i) {
+            auto trade = boost::make_shared<FxForward>(Envelope("CP"), "2016-02-03", "EUR", 1.0E6, "USD", 1.2E6);
+            trade->id() = "trade_\"" + ore::data::to_string(i);
+            portfolio->add(trade);
+        }
+        portfolio->build(engineFactory, "test");
+    };
+
+    // nothing is recorded while the tracer is disabled
+    Tracer& tracer = Tracer::instance();
+    tracer.clear();
+    buildPortfolio();
+    BOOST_CHECK(tracer.events().empty());
+
+    tracer.setEnabled(true);
+    buildPortfolio();
+    tracer.setEnabled(false);
+    std::vector<Tracer::Event> events = tracer.events();
+    std::ostringstream trace;
+    tracer.write(trace);
+    tracer.clear();
+
+    // one span per trade, completed within the span of the portfolio build
+    BOOST_REQUIRE_EQUAL(events.size(), Size(4));
+    const Tracer::Event& build = events.back();
+    BOOST_CHECK_EQUAL(build.name, "Portfolio::build");
+    for (Size i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL(events[i].name, "Portfolio::buildTrade");
+        BOOST_CHECK_EQUAL(events[i].category, "portfolio");
+        BOOST_CHECK(events[i].start >= build.start);
+        BOOST_CHECK(events[i].start + events[i].duration <= build.start + build.duration);
+        BOOST_CHECK_EQUAL(events[i].args,
+                          "\"tradeId\":\"trade_\\\"" + ore::data::to_string(i) + "\",\"tradeType\":\"FxForward\"");
+    }
+
+    // the trace holds one complete event per span, the quote in the trade id is escaped
+    std::string json = trace.str();
+    BOOST_CHECK(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+    BOOST_CHECK_EQUAL(std::count(json.begin(), json.end(), '\n'), 6);
+    BOOST_CHECK(json.find("\"name\":\"Portfolio::build\",\"cat\":\"portfolio\",\"ph\":\"X\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"tradeId\":\"trade_\\\"0\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testSharedEngineCache) {
+
+    BOOST_TEST_MESSAGE("Testing the engine cache shared between engine factories");
+
+    auto market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+    auto engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    engineData->globalParameters()["ShareEngines"] = "true";
+
+    auto engine = [&engineData](const boost::shared_ptr<Market>& m) {
+        auto factory = boost::make_shared<EngineFactory>(engineData, m);
+        auto builder = boost::dynamic_pointer_cast<FxForwardEngineBuilderBase>(factory->builder("FxForward"));
+        BOOST_REQUIRE(builder);
+        return builder->engine(EURCurrency(), USDCurrency());
+    };
+
+    // the factories on the same market share the engine, a factory on another market does not
+    auto e = engine(market);
+    BOOST_CHECK(engine(market) == e);
+    BOOST_CHECK(engine(boost::make_shared<TestMarket>()) != e);
+
+    // without the global parameter the engines are not shared
+    engineData->globalParameters().erase("ShareEngines");
+    BOOST_CHECK(engine(market) != e);
+}
+
+BOOST_AUTO_TEST_CASE(testCloneForMarket) {
+
+    BOOST_TEST_MESSAGE("Testing the cloning of a built trade for another engine factory");
+
+    auto market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+    auto engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    auto engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+
+    auto trade = boost::make_shared<FxForward>(Envelope("CP"), "2016-02-03", "EUR", 1.0E6, "USD", 1.2E6);
+    trade->id() = "trade";
+    trade->build(engineFactory);
+    Real npv = trade->instrument()->NPV();
+
+    // the clone is built against the other factory, the original trade is not touched
+    auto otherFactory = boost::make_shared<EngineFactory>(engineData, boost::make_shared<TestMarket>());
+    auto clone = trade->cloneForMarket(otherFactory);
+    BOOST_REQUIRE(clone);
+    BOOST_CHECK(clone != trade);
+    BOOST_CHECK_EQUAL(clone->id(), "trade");
+    BOOST_CHECK_EQUAL(clone->envelope().counterparty(), "CP");
+    BOOST_CHECK(clone->instrument()->qlInstrument() != trade->instrument()->qlInstrument());
+    BOOST_CHECK_CLOSE(clone->instrument()->NPV(), npv, 1.0E-10);
+    BOOST_CHECK_EQUAL(clone->getNumberOfPricings(), Size(1));
+    BOOST_CHECK_CLOSE(trade->instrument()->NPV(), npv, 1.0E-10);
+}
+
+BOOST_AUTO_TEST_CASE(testChunkedFromFile) {
+
+    BOOST_TEST_MESSAGE("Testing the chunked parsing of a portfolio file");
+
+    Portfolio source;
+    for (Size i = 0; i < 7; ++i) {
+        auto trade = boost::make_shared<FxForward>(Envelope("CP"), "2016-02-03", "EUR", 1.0E6, "USD", 1.2E6);
+        trade->id() = "trade_" + ore::data::to_string(i);
+        source.add(trade);
+    }
+    // add a comment containing a trade tag, a trade that can not be parsed and a duplicate id
+    string xml = source.toXMLString();
+    Size pos = xml.find("<Portfolio>") + string("<Portfolio>").size();
+    xml.insert(pos, "<!-- <Trade id=\"comment\"> --><Trade id=\"unknown\"><TradeType>Unknown</TradeType></Trade>");
+    pos = xml.rfind("</Portfolio>");
+    xml.insert(pos, "<Trade id='trade_0'><TradeType>Unknown</TradeType></Trade>");
+    string file = TEST_OUTPUT_FILE("chunked_portfolio.xml");
+    {
+        std::ofstream out(file);
+        out << "<?xml version=\"1.0\"?>\n" << xml;
+    }
+
+    Portfolio reference;
+    reference.fromFile(file);
+    BOOST_CHECK_EQUAL(reference.size(), Size(8));
+    for (Size nThreads : {1, 3}) {
+        for (Size chunkSize : {1, 2, 100}) {
+            Portfolio portfolio;
+            portfolio.fromFile(file, nThreads, chunkSize);
+            BOOST_REQUIRE(portfolio.ids() == reference.ids());
+            for (auto const& [id, trade] : reference.trades())
+                BOOST_CHECK_EQUAL(portfolio.get(id)->tradeType(), trade->tradeType());
+            BOOST_CHECK_EQUAL(portfolio.get("unknown")->tradeType(), "Failed");
+            BOOST_CHECK_EQUAL(portfolio.get("trade_0")->tradeType(), "FxForward");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testLazyReferenceData) {
+
+    BOOST_TEST_MESSAGE("Testing the lazy loading of reference data");
+
+    Settings::instance().evaluationDate() = Date(3, Feb, 2015);
+    string file = TEST_OUTPUT_FILE("lazy_referencedata.xml");
+    {
+        // a valid entry with two versions, an entry that can not be built and a duplicate
+        auto datum = [](const string& id, const string& validFrom, const string& name) {
+            return "<ReferenceDatum id=\"" + id + "\"" + (validFrom.empty() ? "" : " validFrom=\"" + validFrom + "\"") +
+                   "><Type>EquityIndex</Type><EquityIndexReferenceData><Underlying><Name>" + name +
+                   "</Name><Weight>1.0</Weight></Underlying></EquityIndexReferenceData></ReferenceDatum>";
+        };
+        std::ofstream out(file);
+        out << "<?xml version=\"1.0\"?>\n<ReferenceData>" << datum("IDX", "", "A") << datum("IDX", "2016-01-01", "B")
+            << "<ReferenceDatum id=\"BROKEN\"><Type>EquityIndex</Type></ReferenceDatum>" << datum("IDX", "", "C")
+            << "</ReferenceData>";
+    }
+
+    BasicReferenceDataManager eager(file), lazy(file, true);
+    for (auto* m : {&eager, &lazy}) {
+        BOOST_CHECK(m->hasData("EquityIndex", "IDX"));
+        BOOST_CHECK(!m->hasData("EquityIndex", "BROKEN"));
+        BOOST_CHECK(!m->hasData("EquityIndex", "UNKNOWN"));
+        auto d = boost::dynamic_pointer_cast<EquityIndexReferenceDatum>(m->getData("EquityIndex", "IDX"));
+        BOOST_REQUIRE(d);
+        BOOST_CHECK_EQUAL(d->underlyings().front().first, "A");
+        d = boost::dynamic_pointer_cast<EquityIndexReferenceDatum>(
+            m->getData("EquityIndex", "IDX", Date(1, Feb, 2016)));
+        BOOST_REQUIRE(d);
+        BOOST_CHECK_EQUAL(d->underlyings().front().first, "B");
+    }
+    BOOST_CHECK_EQUAL(lazy.toXMLString(), eager.toXMLString());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
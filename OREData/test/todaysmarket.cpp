@@ -20,6 +20,7 @@
 #include <ored/configuration/volatilityconfig.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
+#include <ored/marketdata/calibratedcurvecache.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/portfolio/builders/cms.hpp>
 #include <ored/portfolio/builders/cmsspread.hpp>
@@ -29,6 +30,7 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/to_string.hpp>
 #include <oret/toplevelfixture.hpp>
+#include <ql/quotes/simplequote.hpp>
 #include <ql/time/calendars/all.hpp>
 #include <ql/time/daycounters/actual360.hpp>
 #include <ql/utilities/dataformatters.hpp>
@@ -1037,6 +1039,121 @@ BOOST_AUTO_TEST_CASE(testCorrelationCurve) {
     BOOST_CHECK_SMALL(npvCash - expectedNpv2Y, 0.000001);
 }
 
+BOOST_AUTO_TEST_CASE(testParallelBuild) {
+
+    BOOST_TEST_MESSAGE("Testing parallel build of todays market");
+
+    // without QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN the market is built sequentially
+    auto parallelMarket = boost::make_shared<TodaysMarket>(
+        market->asofDate(), marketParameters(), boost::make_shared<MarketDataLoader>(), curveConfigurations(), false,
+        true, false, nullptr, false, IborFallbackConfig::defaultConfig(), true, true, 4);
+
+    Date d = market->asofDate() + 5 * Years;
+    for (auto const& c : {"EUR", "USD"})
+        BOOST_CHECK_CLOSE(parallelMarket->discountCurve(c)->discount(d), market->discountCurve(c)->discount(d),
+                          1.0E-10);
+    for (auto const& c : {"EUR_LEND", "EUR_BORROW"})
+        BOOST_CHECK_CLOSE(parallelMarket->yieldCurve(c)->discount(d), market->yieldCurve(c)->discount(d), 1.0E-10);
+    BOOST_CHECK_CLOSE(parallelMarket->equityVol("SP5")->blackVol(d, 100.0),
+                      market->equityVol("SP5")->blackVol(d, 100.0), 1.0E-10);
+    BOOST_CHECK_CLOSE(parallelMarket->commodityPriceCurve("COMDTY_GOLD_USD")->price(d),
+                      market->commodityPriceCurve("COMDTY_GOLD_USD")->price(d), 1.0E-10);
+    BOOST_CHECK(*parallelMarket->correlationCurve("EUR-CMS-10Y", "EUR-CMS-2Y"));
+}
+
+BOOST_AUTO_TEST_CASE(testCalibratedCurveCache) {
+
+    BOOST_TEST_MESSAGE("Testing restoring bootstrapped curves from the calibrated curve cache");
+
+    CalibratedCurveCache& cache = CalibratedCurveCache::instance();
+    cache.clear();
+    cache.setEnabled(true);
+
+    auto build = [this]() {
+        return boost::make_shared<TodaysMarket>(market->asofDate(), marketParameters(),
+                                                boost::make_shared<MarketDataLoader>(), curveConfigurations());
+    };
+
+    // the first build fills the cache, the second one restores the curves from it
+    auto market1 = build();
+    Size cached = cache.size();
+    BOOST_CHECK(cached > 0);
+    auto market2 = build();
+    BOOST_CHECK_EQUAL(cache.size(), cached);
+
+    for (Size i = 1; i <= 120; ++i) {
+        Date d = market->asofDate() + i * Months;
+        for (auto const& c : {"EUR", "USD"}) {
+            BOOST_CHECK_CLOSE(market1->discountCurve(c)->discount(d), market->discountCurve(c)->discount(d), 1.0E-12);
+            BOOST_CHECK_CLOSE(market2->discountCurve(c)->discount(d), market->discountCurve(c)->discount(d), 1.0E-12);
+        }
+    }
+
+    cache.setEnabled(false);
+    cache.clear();
+}
+
+BOOST_AUTO_TEST_CASE(testUpdate) {
+
+    BOOST_TEST_MESSAGE("Testing rebuild of the market objects affected by changed quotes");
+
+    auto loader = boost::make_shared<MarketDataLoader>();
+    auto updatedMarket = boost::make_shared<TodaysMarket>(market->asofDate(), marketParameters(), loader,
+                                                          curveConfigurations());
+
+    Date d = market->asofDate() + 5 * Years;
+    Handle<YieldTermStructure> eur = updatedMarket->discountCurve("EUR");
+    Handle<YieldTermStructure> usd = updatedMarket->discountCurve("USD");
+    Real eurDiscount = eur->discount(d), usdDiscount = usd->discount(d);
+    Real lendDiscount = updatedMarket->yieldCurve("EUR_LEND")->discount(d);
+
+    // shift the Eonia swap quotes and rebuild
+    std::set<std::string> changedQuotes;
+    for (auto const& md : loader->loadQuotes(market->asofDate())) {
+        if (boost::starts_with(md->name(), "IR_SWAP/RATE/EUR/2D/1D/")) {
+            auto q = boost::dynamic_pointer_cast<SimpleQuote>(*md->quote());
+            BOOST_REQUIRE(q);
+            q->setValue(q->value() + 0.0010);
+            changedQuotes.insert(md->name());
+        }
+    }
+    std::set<std::string> rebuilt = updatedMarket->update(changedQuotes);
+
+    BOOST_CHECK(rebuilt.count("Yield/EUR/EUR1D") == 1);
+    BOOST_CHECK(rebuilt.count("Yield/EUR/BANK_EUR_LEND") == 1);
+    BOOST_CHECK(rebuilt.count("Yield/USD/USD1D") == 0);
+
+    // the handles taken before the update see the rebuilt curves
+    BOOST_CHECK(eur->discount(d) < eurDiscount);
+    BOOST_CHECK_CLOSE(eur->discount(d), updatedMarket->discountCurve("EUR")->discount(d), 1.0E-12);
+    BOOST_CHECK(updatedMarket->yieldCurve("EUR_LEND")->discount(d) < lendDiscount);
+    BOOST_CHECK_CLOSE(usd->discount(d), usdDiscount, 1.0E-12);
+}
+
+BOOST_AUTO_TEST_CASE(testUsedMarketParameters) {
+
+    BOOST_TEST_MESSAGE("Testing the market parameters of the objects used in a lazily built market");
+
+    auto lazyMarket =
+        boost::make_shared<TodaysMarket>(market->asofDate(), marketParameters(), boost::make_shared<MarketDataLoader>(),
+                                         curveConfigurations(), false, true, true);
+    Date d = market->asofDate() + 5 * Years;
+    Real lend = lazyMarket->yieldCurve("EUR_LEND")->discount(d);
+
+    // the lending curve is a spread over the EUR discount curve
+    auto used = lazyMarket->usedMarketParameters();
+    auto const& yieldCurves = used->mapping(MarketObject::YieldCurve, Market::defaultConfiguration);
+    BOOST_CHECK_EQUAL(yieldCurves.size(), 1U);
+    BOOST_CHECK(yieldCurves.count("EUR_LEND") == 1);
+    BOOST_CHECK(used->mapping(MarketObject::DiscountCurve, Market::defaultConfiguration).count("USD") == 0);
+    BOOST_CHECK(used->mapping(MarketObject::EquityVol, Market::defaultConfiguration).empty());
+
+    // a market built from the used parameters provides the same curve
+    auto usedMarket = boost::make_shared<TodaysMarket>(market->asofDate(), used, boost::make_shared<MarketDataLoader>(),
+                                                       curveConfigurations());
+    BOOST_CHECK_CLOSE(usedMarket->yieldCurve("EUR_LEND")->discount(d), lend, 1.0E-12);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
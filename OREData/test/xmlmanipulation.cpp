@@ -16,8 +16,12 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <ored/configuration/conventions.hpp>
+#include <ored/utilities/xmlconfigurationcache.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/errors.hpp>
@@ -190,6 +194,66 @@ BOOST_FIXTURE_TEST_CASE(testXMLAttributes, F) {
     BOOST_CHECK_EQUAL(level1aAttrValExract, level1aAttrVal);
 }
 
+BOOST_FIXTURE_TEST_CASE(testXMLValueViews, F) {
+
+    BOOST_TEST_MESSAGE("Testing XML value views");
+
+    XMLNode* root = testDoc.getFirstNode("root");
+    XMLNode* level1a = XMLUtils::getChildNode(XMLUtils::getChildNode(root, "level1"), "level1a");
+    XMLNode* data1a = XMLUtils::getChildNode(level1a, "data1a");
+
+    // the views agree with the string accessors
+    BOOST_CHECK_EQUAL(XMLUtils::getChildValueView(level1a, "data1a"), XMLUtils::getChildValue(level1a, "data1a"));
+    BOOST_CHECK_EQUAL(XMLUtils::getNodeValueView(data1a), "17.5");
+    BOOST_CHECK_EQUAL(XMLUtils::getAttributeView(data1a, "attr"), "0.7736");
+    // missing children and attributes give empty views
+    BOOST_CHECK(XMLUtils::getChildValueView(level1a, "data1b").empty());
+    BOOST_CHECK(XMLUtils::getAttributeView(data1a, "garbagename").empty());
+    BOOST_CHECK_THROW(XMLUtils::getChildValueView(level1a, "data1b", true), QuantLib::Error);
+    // names are matched in full, not by prefix
+    BOOST_CHECK(XMLUtils::getChildNode(level1a, "data1") == nullptr);
+    BOOST_CHECK_EQUAL(XMLUtils::getChildrenNodes(XMLUtils::getChildNode(root, "level2"), "level2aDuplicates").size(),
+                      4);
+}
+
+BOOST_AUTO_TEST_CASE(testXMLConfigurationCache) {
+
+    BOOST_TEST_MESSAGE("Testing XML configuration cache");
+
+    string xml = "<Conventions><Deposit><Id>EUR-DEP-CONVENTIONS</Id><IndexBased>true</IndexBased>"
+                 "<Index>EUR-EURIBOR</Index></Deposit></Conventions>";
+    auto file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.xml");
+    auto copy = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.xml");
+    for (auto const& f : {file, copy}) {
+        std::ofstream os(f.string());
+        os << xml;
+    }
+
+    XMLConfigurationCache& cache = XMLConfigurationCache::instance();
+    cache.clear();
+    auto c1 = cache.fromFile<Conventions>(file.string());
+    BOOST_CHECK(c1->has("EUR-DEP-CONVENTIONS"));
+    // the same content is parsed once, independent of the file name
+    auto c2 = cache.fromFile<Conventions>(copy.string());
+    BOOST_CHECK_EQUAL(c1, c2);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    BOOST_CHECK_EQUAL(cache.hits(), 1);
+
+    // changed content is parsed again
+    {
+        std::ofstream os(copy.string());
+        os << "<Conventions></Conventions>";
+    }
+    auto c3 = cache.fromFile<Conventions>(copy.string());
+    BOOST_CHECK(c3 != c1);
+    BOOST_CHECK(!c3->has("EUR-DEP-CONVENTIONS"));
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    cache.clear();
+    boost::filesystem::remove(file);
+    boost::filesystem::remove(copy);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
 
 #include <qle/cashflows/averageonindexedcoupon.hpp>
 #include <qle/cashflows/averageonindexedcouponpricer.hpp>
+#include <qle/cashflows/overnightindexedcoupon.hpp>
 
 #include <ql/cashflows/cashflowvectors.hpp>
 #include <ql/cashflows/couponpricer.hpp>
@@ -116,12 +117,11 @@ AverageONIndexedCoupon::AverageONIndexedCoupon(const Date& paymentDate, Real nom
 
 const std::vector<Rate>& AverageONIndexedCoupon::indexFixings() const {
 
+    fixings_ = overnightIndexFixings(overnightIndex_, std::vector<Date>(fixingDates_.begin(),
+                                                                        fixingDates_.begin() +
+                                                                            (numPeriods_ - rateCutoff_)));
     fixings_.resize(numPeriods_);
-    Size i;
-
-    for (i = 0; i < numPeriods_ - rateCutoff_; ++i) {
-        fixings_[i] = index_->fixing(fixingDates_[i]);
-    }
+    Size i = numPeriods_ - rateCutoff_;
 
     Rate cutoffFixing = fixings_[i - 1];
     while (i < numPeriods_) {
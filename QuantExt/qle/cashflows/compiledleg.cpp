@@ -0,0 +1,107 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/cashflows/compiledleg.hpp>
+
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/settings.hpp>
+
+#include <typeinfo>
+
+namespace QuantExt {
+
+boost::shared_ptr<CompiledLeg> CompiledLeg::compile(const Leg& leg) {
+    boost::shared_ptr<CompiledLeg> result(new CompiledLeg(leg));
+    for (auto const& cf : leg) {
+        const CashFlow& c = *cf;
+        result->payDates_.push_back(c.date());
+        if (typeid(c) == typeid(FixedRateCoupon)) {
+            auto const& cpn = static_cast<const FixedRateCoupon&>(c);
+            result->fixedAmounts_.push_back(cpn.amount());
+            result->bpsFactors_.push_back(cpn.accrualPeriod() * cpn.nominal());
+            result->iborPosition_.push_back(Null<Size>());
+        } else if (typeid(c) == typeid(SimpleCashFlow) || typeid(c) == typeid(Redemption) ||
+                   typeid(c) == typeid(AmortizingPayment)) {
+            result->fixedAmounts_.push_back(c.amount());
+            result->bpsFactors_.push_back(0.0);
+            result->iborPosition_.push_back(Null<Size>());
+        } else if (typeid(c) == typeid(IborCoupon)) {
+            auto const& cpn = static_cast<const IborCoupon&>(c);
+            Handle<YieldTermStructure> curve = cpn.iborIndex()->forwardingTermStructure();
+            if (curve.empty())
+                return nullptr;
+            Size curveId = 0;
+            while (curveId < result->curves_.size() && result->curves_[curveId] != curve)
+                ++curveId;
+            if (curveId == result->curves_.size())
+                result->curves_.push_back(curve);
+            Real dcfRatio = 1.0;
+            DayCounter indexBasis = cpn.iborIndex()->dayCounter();
+            if (indexBasis != cpn.dayCounter())
+                dcfRatio = cpn.accrualPeriod() / indexBasis.yearFraction(cpn.accrualStartDate(), cpn.accrualEndDate());
+            result->fixedAmounts_.push_back(Null<Real>());
+            result->bpsFactors_.push_back(cpn.accrualPeriod() * cpn.nominal());
+            result->iborPosition_.push_back(result->fixingDates_.size());
+            result->fixingDates_.push_back(cpn.fixingDate());
+            result->accrualStartDates_.push_back(cpn.accrualStartDate());
+            result->accrualEndDates_.push_back(cpn.accrualEndDate());
+            result->forwardFactors_.push_back(cpn.gearing() * cpn.nominal() * dcfRatio);
+            result->spreadAmounts_.push_back(cpn.spread() * cpn.accrualPeriod() * cpn.nominal());
+            result->curveIds_.push_back(curveId);
+            result->indices_.push_back(cpn.iborIndex());
+        } else {
+            return nullptr;
+        }
+    }
+    return result;
+}
+
+void CompiledLeg::npv(const YieldTermStructure& discountCurve, const Date& settlementDate,
+                      bool includeSettlementDateFlows, Real& npv, Real& bps) const {
+    npv = 0.0;
+    bps = 0.0;
+    Date today = Settings::instance().evaluationDate();
+    for (Size i = 0; i < curves_.size(); ++i)
+        QL_REQUIRE(!curves_[i].empty(), "CompiledLeg: forwarding curve is empty");
+    for (Size j = 0; j < payDates_.size(); ++j) {
+        const Date& d = payDates_[j];
+        // the cashflow decides on the events on the settlement date, see CashFlow::hasOccurred()
+        if (d < settlementDate ||
+            (d == settlementDate && leg_[j]->hasOccurred(settlementDate, includeSettlementDateFlows)))
+            continue;
+        Real amount;
+        Size k = iborPosition_[j];
+        if (k == Null<Size>()) {
+            amount = fixedAmounts_[j];
+        } else if (fixingDates_[k] < today ||
+                   (fixingDates_[k] == today && indices_[k]->pastFixing(today) != Null<Real>())) {
+            amount = leg_[j]->amount();
+        } else {
+            const YieldTermStructure& curve = *curves_[curveIds_[k]];
+            amount = forwardFactors_[k] *
+                         (curve.discount(accrualStartDates_[k]) / curve.discount(accrualEndDates_[k]) - 1.0) +
+                     spreadAmounts_[k];
+        }
+        DiscountFactor discount = discountCurve.discount(d);
+        npv += amount * discount;
+        bps += bpsFactors_[j] * discount;
+    }
+}
+
+} // namespace QuantExt
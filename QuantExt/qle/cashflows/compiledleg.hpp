@@ -0,0 +1,80 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/cashflows/compiledleg.hpp
+    \brief Flat representation of a vanilla leg for fast repeated valuation
+*/
+
+#ifndef quantext_compiled_leg_hpp
+#define quantext_compiled_leg_hpp
+
+#include <ql/cashflow.hpp>
+#include <ql/indexes/iborindex.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Flat representation of a vanilla leg
+/*! The leg is compiled once into arrays of payment dates, fixed amounts and, for the ibor coupons, fixing and
+    accrual dates, nominals, gearings, spreads and an id of the forwarding curve. A valuation then loops over these
+    arrays and queries the curves directly, instead of computing the amounts of the coupons via their pricers.
+
+    Fixed rate coupons, ibor coupons without caps or floors and simple cashflows are supported, for all other
+    cashflows compile() returns a null pointer. The ibor coupons are projected with the same assumptions as in the
+    DiscountingSwapEngineMultiCurve, i.e. the index is assumed to have a tenor from accrual start to accrual end
+    date. Coupons that are fixed already are valued by their amount() method.
+
+    \ingroup cashflows
+*/
+class CompiledLeg {
+public:
+    //! Compile the leg, returns a null pointer if the leg contains cashflows that are not supported
+    static boost::shared_ptr<CompiledLeg> compile(const Leg& leg);
+
+    //! The compiled leg
+    const Leg& leg() const { return leg_; }
+
+    /*! Sum of the amounts and of the accrual period times nominal of the coupons not occurred at the settlement date,
+        discounted to the reference date of the discount curve */
+    void npv(const YieldTermStructure& discountCurve, const Date& settlementDate, bool includeSettlementDateFlows,
+             Real& npv, Real& bps) const;
+
+private:
+    explicit CompiledLeg(const Leg& leg) : leg_(leg) {}
+
+    Leg leg_;
+    // one entry per cashflow
+    std::vector<Date> payDates_;
+    std::vector<Real> fixedAmounts_;
+    std::vector<Real> bpsFactors_;
+    // position in the ibor coupon arrays, or Null<Size>() for a fixed cashflow
+    std::vector<Size> iborPosition_;
+    // one entry per ibor coupon
+    std::vector<Date> fixingDates_, accrualStartDates_, accrualEndDates_;
+    std::vector<Real> forwardFactors_, spreadAmounts_;
+    std::vector<Size> curveIds_;
+    std::vector<boost::shared_ptr<IborIndex>> indices_;
+    // the distinct forwarding curves
+    std::vector<Handle<YieldTermStructure>> curves_;
+};
+
+} // namespace QuantExt
+
+#endif
@@ -38,6 +38,8 @@
 */
 
 #include <qle/cashflows/overnightindexedcoupon.hpp>
+#include <qle/indexes/fallbackovernightindex.hpp>
+#include <qle/indexes/ibor/brlcdi.hpp>
 
 #include <ql/cashflows/cashflowvectors.hpp>
 #include <ql/cashflows/couponpricer.hpp>
@@ -147,11 +149,10 @@ OvernightIndexedCoupon::OvernightIndexedCoupon(const Date& paymentDate, Real nom
 }
 
 const vector<Rate>& OvernightIndexedCoupon::indexFixings() const {
+    fixings_ = overnightIndexFixings(overnightIndex_,
+                                     vector<Date>(fixingDates_.begin(), fixingDates_.begin() + (n_ - rateCutoff_)));
     fixings_.resize(n_);
-    Size i;
-    for (i = 0; i < n_ - rateCutoff_; ++i) {
-        fixings_[i] = index_->fixing(fixingDates_[i]);
-    }
+    Size i = n_ - rateCutoff_;
     Rate cutoffFixing = fixings_[i - 1];
     while (i < n_) {
         fixings_[i] = cutoffFixing;
@@ -185,6 +186,39 @@ Real OvernightIndexedCoupon::effectiveIndexFixing() const {
     return p->effectiveIndexFixing();
 }
 
+vector<Rate> overnightIndexFixings(const ext::shared_ptr<OvernightIndex>& index, const vector<Date>& fixingDates) {
+    vector<Rate> fixings(fixingDates.size());
+    if (ext::dynamic_pointer_cast<FallbackOvernightIndex>(index) || ext::dynamic_pointer_cast<BRLCdi>(index)) {
+        for (Size i = 0; i < fixingDates.size(); ++i)
+            fixings[i] = index->fixing(fixingDates[i]);
+        return fixings;
+    }
+    Date today = Settings::instance().evaluationDate();
+    const Handle<YieldTermStructure>& curve = index->forwardingTermStructure();
+    Date lastDate;
+    DiscountFactor lastDiscount = 1.0;
+    for (Size i = 0; i < fixingDates.size(); ++i) {
+        const Date& d = fixingDates[i];
+        if (d <= today) {
+            fixings[i] = index->fixing(d);
+            continue;
+        }
+        QL_REQUIRE(index->isValidFixingDate(d), "Fixing date " << d << " is not valid");
+        QL_REQUIRE(!curve.empty(), "null term structure set to this instance of " << index->name());
+        Date valueDate = index->valueDate(d);
+        Date maturityDate = index->maturityDate(valueDate);
+        DiscountFactor startDiscount = valueDate == lastDate ? lastDiscount : curve->discount(valueDate);
+        DiscountFactor endDiscount = curve->discount(maturityDate);
+        Time t = index->dayCounter().yearFraction(valueDate, maturityDate);
+        QL_REQUIRE(t > 0.0, "cannot calculate forward rate between " << valueDate << " and " << maturityDate
+                                                                      << ": non positive time (" << t << ")");
+        fixings[i] = (startDiscount / endDiscount - 1.0) / t;
+        lastDate = maturityDate;
+        lastDiscount = endDiscount;
+    }
+    return fixings;
+}
+
 // OvernightIndexedCouponPricer implementation
 
 void OvernightIndexedCouponPricer::initialize(const FloatingRateCoupon& coupon) {
@@ -148,6 +148,14 @@ protected:
     mutable Real swapletRate_, effectiveSpread_, effectiveIndexFixing_;
 };
 
+//! fixings of an overnight index on the given fixing dates
+/*! Past fixings and today's fixing are read from the index. The projected fixings are computed from the discount
+    factors of the forwarding curve on their value and maturity dates in one pass over the fixing dates. Each date is
+    evaluated once, i.e. the maturity date discount factor of a fixing is reused if it is the value date of the next
+    fixing. Indices with their own projection (fallback indices, BRL CDI) are projected with their fixing() method. */
+std::vector<Rate> overnightIndexFixings(const ext::shared_ptr<OvernightIndex>& index,
+                                        const std::vector<Date>& fixingDates);
+
 //! capped floored overnight indexed coupon
 class CappedFlooredOvernightIndexedCoupon : public FloatingRateCoupon {
 public:
@@ -0,0 +1,40 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/instruments/zeroratedependencies.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+void addDiscountDependency(std::vector<ZeroRateDependency>& dependencies, const Handle<YieldTermStructure>& curve,
+                           const Date& date, const Real pv) {
+    Time t = curve->timeFromReference(date);
+    if (t <= 0.0)
+        return;
+    // d/dz (c exp(-z t)) = -t c exp(-z t)
+    dependencies.push_back({curve.currentLink(), t, -t * pv});
+}
+
+void addForwardDependency(std::vector<ZeroRateDependency>& dependencies, const Handle<YieldTermStructure>& curve,
+                          const Date& start, const Date& end, const Real pv) {
+    addDiscountDependency(dependencies, curve, start, pv);
+    addDiscountDependency(dependencies, curve, end, -pv);
+}
+
+} // namespace QuantExt
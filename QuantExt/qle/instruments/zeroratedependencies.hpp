@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file zeroratedependencies.hpp
+    \brief sensitivities of an npv to the zero rates of the curves it is computed from
+
+    \ingroup instruments
+*/
+
+#pragma once
+
+#include <ql/handle.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+#include <ql/time/date.hpp>
+#include <ql/types.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+//! Sensitivity of an npv to the continuously compounded zero rate of one curve at one time
+/*! The change of the npv under small changes \f$ dz(t) \f$ of the zero rates of the curves is approximated by the sum
+    of delta times \f$ dz(time) \f$ over all dependencies. Pricing engines supporting this publish the dependencies as
+    additional result "zeroRateDependencies" of type std::vector<ZeroRateDependency>. The curve is the term structure
+    linked to the engine's handle at the time of the calculation.
+
+    \ingroup instruments
+*/
+struct ZeroRateDependency {
+    boost::shared_ptr<QuantLib::YieldTermStructure> curve;
+    QuantLib::Time time = 0.0;
+    QuantLib::Real delta = 0.0;
+};
+
+/*! add the dependency of a present value \p pv = \f$ c P(d) \f$ on the zero rate of \p curve at \p date, nothing is
+    added for dates on or before the curve's reference date */
+void addDiscountDependency(std::vector<ZeroRateDependency>& dependencies,
+                           const QuantLib::Handle<QuantLib::YieldTermStructure>& curve, const QuantLib::Date& date,
+                           const QuantLib::Real pv);
+
+/*! add the dependencies of a present value \p pv = \f$ c P(s) / P(e) \f$ on the zero rates of \p curve at the
+    \p start and \p end date, e.g. the forward part of an ibor coupon */
+void addForwardDependency(std::vector<ZeroRateDependency>& dependencies,
+                          const QuantLib::Handle<QuantLib::YieldTermStructure>& curve, const QuantLib::Date& start,
+                          const QuantLib::Date& end, const QuantLib::Real pv);
+
+} // namespace QuantExt
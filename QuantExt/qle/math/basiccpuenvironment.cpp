@@ -0,0 +1,600 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/basiccpuenvironment.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace QuantExt {
+
+namespace {
+
+// number of paths processed by a worker thread at once
+const std::size_t blockSize = 1024;
+
+// same generator as in the OpenCL implementation (and the boost compute lg-engine)
+const std::uint32_t lcrngMultiplier = 1099087573;
+
+double invCumN(const std::uint32_t x0) {
+    const double a1_ = -3.969683028665376e+01;
+    const double a2_ = 2.209460984245205e+02;
+    const double a3_ = -2.759285104469687e+02;
+    const double a4_ = 1.383577518672690e+02;
+    const double a5_ = -3.066479806614716e+01;
+    const double a6_ = 2.506628277459239e+00;
+    const double b1_ = -5.447609879822406e+01;
+    const double b2_ = 1.615858368580409e+02;
+    const double b3_ = -1.556989798598866e+02;
+    const double b4_ = 6.680131188771972e+01;
+    const double b5_ = -1.328068155288572e+01;
+    const double c1_ = -7.784894002430293e-03;
+    const double c2_ = -3.223964580411365e-01;
+    const double c3_ = -2.400758277161838e+00;
+    const double c4_ = -2.549732539343734e+00;
+    const double c5_ = 4.374664141464968e+00;
+    const double c6_ = 2.938163982698783e+00;
+    const double d1_ = 7.784695709041462e-03;
+    const double d2_ = 3.224671290700398e-01;
+    const double d3_ = 2.445134137142996e+00;
+    const double d4_ = 3.754408661907416e+00;
+    const double x_low_ = 0.02425;
+    const double x_high_ = 1.0 - x_low_;
+    const double x = x0 / static_cast<double>(std::numeric_limits<std::uint32_t>::max());
+    if (x < x_low_ || x_high_ < x) {
+        if (x0 == std::numeric_limits<std::uint32_t>::max()) {
+            return std::numeric_limits<double>::max();
+        } else if (x0 == 0) {
+            return -std::numeric_limits<double>::max();
+        }
+        double z;
+        if (x < x_low_) {
+            z = std::sqrt(-2.0 * std::log(x));
+            z = (((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /
+                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + 1.0);
+        } else {
+            z = std::sqrt(-2.0 * std::log(1.0 - x));
+            z = -(((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /
+                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + 1.0);
+        }
+        return z;
+    } else {
+        double z = x - 0.5;
+        double r = z * z;
+        z = (((((a1_ * r + a2_) * r + a3_) * r + a4_) * r + a5_) * r + a6_) * z /
+            (((((b1_ * r + b2_) * r + b3_) * r + b4_) * r + b5_) * r + 1.0);
+        return z;
+    }
+}
+
+} // namespace
+
+class BasicCpuContext : public ComputeContext {
+public:
+    BasicCpuContext();
+    void init() override final {}
+
+    void setPrecision(const Precision precision) override final { precision_ = precision; }
+    Precision precision() const override final { return precision_; }
+    bool supportsDoublePrecision() const override final { return true; }
+    void setProgramCacheDirectory(const std::string&) override final {}
+
+    std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
+                                                     const std::size_t version = 0,
+                                                     const bool debug = false) override final;
+    std::size_t createInputVariable(float v) override final;
+    std::size_t createInputVariable(float* v) override final;
+    std::size_t createInputVariable(double v) override final;
+    std::size_t createInputVariable(double* v) override final;
+    std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim, const std::size_t steps,
+                                                              const std::uint32_t seed) override final;
+    std::size_t applyOperation(const std::size_t randomVariableOpCode,
+                               const std::vector<std::size_t>& args) override final;
+    void freeVariable(const std::size_t id) override final;
+    void declareOutputVariable(const std::size_t id) override final;
+    void finalizeCalculation(std::vector<float*>& output) override final;
+    void finalizeCalculation(std::vector<double*>& output) override final;
+
+    const DebugInfo& debugInfo() const override final { return debugInfo_; }
+
+private:
+    enum class ComputeState { idle, createInput, createVariates, calc };
+
+    struct Operation {
+        std::size_t opCode;
+        std::vector<std::size_t> args;
+        std::size_t result;
+    };
+
+    // recorded calculation and the slots assigned to its variables
+    struct Program {
+        std::size_t size = 0, version = 0;
+        bool compiled = false;
+        Precision precision = Precision::Double;
+        std::size_t nInputs = 0;
+        std::vector<bool> inputIsScalar;
+        std::vector<std::uint32_t> variateSeeds;
+        std::vector<Operation> operations;
+        std::vector<std::size_t> outputVariables;
+        std::vector<std::size_t> slot;
+        std::size_t nSlots = 0;
+    };
+
+    std::size_t addInputVariable(const bool isScalar, const double value, float* ptr, double* ptrDouble);
+    void compile(Program& p) const;
+    void runBlock(const Program& p, const std::size_t begin, const std::size_t end, std::vector<double>& slots,
+                  std::vector<double>& tmp, const std::vector<double*>& output) const;
+    template <class T> void finalizeCalculationImpl(std::vector<T*>& output);
+
+    Precision precision_ = Precision::Double;
+    std::size_t nThreads_;
+    DebugInfo debugInfo_;
+
+    std::vector<Program> programs_;
+    std::map<std::size_t, std::vector<std::uint32_t>> linearCongruentialMultipliers_;
+
+    // current calc
+    std::size_t currentId_ = 0;
+    ComputeState currentState_ = ComputeState::idle;
+    bool debug_ = false;
+    std::size_t nVars_ = 0;
+    std::vector<bool> inputVarIsScalar_;
+    std::vector<double> inputVarValue_;
+    std::vector<float*> inputVarPtr_;
+    std::vector<double*> inputVarPtrDouble_;
+    std::vector<std::uint32_t> variateSeed_;
+};
+
+BasicCpuFramework::BasicCpuFramework() { contexts_["BasicCpu/Default/Default"] = new BasicCpuContext(); }
+
+BasicCpuFramework::~BasicCpuFramework() {
+    for (auto& [_, c] : contexts_) {
+        delete c;
+    }
+}
+
+std::set<std::string> BasicCpuFramework::getAvailableDevices() const {
+    std::set<std::string> tmp;
+    for (auto const& [name, _] : contexts_)
+        tmp.insert(name);
+    return tmp;
+}
+
+ComputeContext* BasicCpuFramework::getContext(const std::string& deviceName) {
+    auto c = contexts_.find(deviceName);
+    if (c != contexts_.end()) {
+        return c->second;
+    }
+    QL_FAIL("BasicCpuFramework::getContext(): device '"
+            << deviceName << "' not found. Available devices: " << boost::join(getAvailableDevices(), ","));
+}
+
+BasicCpuContext::BasicCpuContext() : nThreads_(std::max<std::size_t>(1, std::thread::hardware_concurrency())) {}
+
+std::pair<std::size_t, bool> BasicCpuContext::initiateCalculation(const std::size_t n, const std::size_t id,
+                                                                  const std::size_t version, const bool debug) {
+
+    QL_REQUIRE(n > 0, "BasicCpuContext::initiateCalculation(): n must not be zero");
+
+    bool newCalc = false;
+    debug_ = debug;
+
+    if (id == 0) {
+        programs_.push_back(Program());
+        programs_.back().size = n;
+        programs_.back().version = version;
+        currentId_ = programs_.size();
+        newCalc = true;
+    } else {
+        QL_REQUIRE(id <= programs_.size(),
+                   "BasicCpuContext::initiateCalculation(): id (" << id << ") invalid, got 1..." << programs_.size());
+        QL_REQUIRE(programs_[id - 1].size == n, "BasicCpuContext::initiateCalculation(): size ("
+                                                    << programs_[id - 1].size << ") for id " << id
+                                                    << " does not match current size (" << n << ")");
+        if (version != programs_[id - 1].version ||
+            (programs_[id - 1].compiled && programs_[id - 1].precision != precision_)) {
+            programs_[id - 1] = Program();
+            programs_[id - 1].size = n;
+            programs_[id - 1].version = version;
+            newCalc = true;
+        }
+        currentId_ = id;
+    }
+
+    if (linearCongruentialMultipliers_.find(n) == linearCongruentialMultipliers_.end()) {
+        std::vector<std::uint32_t> m(n + 1);
+        m[0] = lcrngMultiplier;
+        for (std::size_t i = 1; i <= n; ++i)
+            m[i] = lcrngMultiplier * m[i - 1];
+        linearCongruentialMultipliers_[n] = m;
+    }
+
+    nVars_ = 0;
+    inputVarIsScalar_.clear();
+    inputVarValue_.clear();
+    inputVarPtr_.clear();
+    inputVarPtrDouble_.clear();
+    variateSeed_.clear();
+
+    currentState_ = ComputeState::createInput;
+
+    return std::make_pair(currentId_, newCalc);
+}
+
+std::size_t BasicCpuContext::addInputVariable(const bool isScalar, const double value, float* ptr,
+                                              double* ptrDouble) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput,
+               "BasicCpuContext::createInputVariable(): not in state createInput (" << static_cast<int>(currentState_)
+                                                                                    << ")");
+    inputVarIsScalar_.push_back(isScalar);
+    inputVarValue_.push_back(value);
+    inputVarPtr_.push_back(ptr);
+    inputVarPtrDouble_.push_back(ptrDouble);
+    return nVars_++;
+}
+
+std::size_t BasicCpuContext::createInputVariable(float v) { return addInputVariable(true, v, nullptr, nullptr); }
+
+std::size_t BasicCpuContext::createInputVariable(float* v) { return addInputVariable(false, 0.0, v, nullptr); }
+
+std::size_t BasicCpuContext::createInputVariable(double v) { return addInputVariable(true, v, nullptr, nullptr); }
+
+std::size_t BasicCpuContext::createInputVariable(double* v) { return addInputVariable(false, 0.0, nullptr, v); }
+
+std::vector<std::vector<std::size_t>> BasicCpuContext::createInputVariates(const std::size_t dim,
+                                                                           const std::size_t steps,
+                                                                           const std::uint32_t seed) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates,
+               "BasicCpuContext::createInputVariates(): not in state createInput or createVariates ("
+                   << static_cast<int>(currentState_) << ")");
+    currentState_ = ComputeState::createVariates;
+    const std::uint32_t seedUpdate = linearCongruentialMultipliers_.at(programs_[currentId_ - 1].size).back();
+    std::vector<std::vector<std::size_t>> resultIds(dim, std::vector<std::size_t>(steps));
+    std::uint32_t currentSeed = seed;
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < steps; ++j) {
+            variateSeed_.push_back(currentSeed);
+            currentSeed *= seedUpdate;
+            resultIds[i][j] = nVars_++;
+        }
+    }
+    return resultIds;
+}
+
+std::size_t BasicCpuContext::applyOperation(const std::size_t randomVariableOpCode,
+                                            const std::vector<std::size_t>& args) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates ||
+                   currentState_ == ComputeState::calc,
+               "BasicCpuContext::applyOperation(): not in state createInput or calc ("
+                   << static_cast<int>(currentState_) << ")");
+    currentState_ = ComputeState::calc;
+    auto& p = programs_[currentId_ - 1];
+    QL_REQUIRE(!p.compiled, "BasicCpuContext::applyOperation(): id (" << currentId_ << ") in version " << p.version
+                                                                      << " is compiled already.");
+    QL_REQUIRE(randomVariableOpCode != RandomVariableOpCode::ConditionalExpectation &&
+                   randomVariableOpCode <= RandomVariableOpCode::NormalPdf,
+               "BasicCpuContext::applyOperation(): no implementation for op code " << randomVariableOpCode);
+    const std::size_t nArgs = randomVariableOpCode == RandomVariableOpCode::None ||
+                                      randomVariableOpCode == RandomVariableOpCode::Negative ||
+                                      (randomVariableOpCode >= RandomVariableOpCode::Abs &&
+                                       randomVariableOpCode != RandomVariableOpCode::Pow)
+                                  ? 1
+                                  : 2;
+    QL_REQUIRE(args.size() == nArgs, "BasicCpuContext::applyOperation(): op code "
+                                         << getRandomVariableOpLabels()[randomVariableOpCode] << " requires " << nArgs
+                                         << " arguments, got " << args.size());
+    for (auto const a : args)
+        QL_REQUIRE(a < nVars_, "BasicCpuContext::applyOperation(): variable " << a << " is not defined");
+
+    // variable ids are never reused, the life times of the variables are determined in compile()
+
+    p.operations.push_back(Operation{randomVariableOpCode, args, nVars_});
+
+    if (debug_)
+        debugInfo_.numberOfOperations += p.size;
+
+    return nVars_++;
+}
+
+void BasicCpuContext::freeVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ == ComputeState::calc,
+               "BasicCpuContext::free(): not in state calc (" << static_cast<int>(currentState_) << ")");
+    QL_REQUIRE(id < nVars_, "BasicCpuContext::free(): variable " << id << " is not defined");
+}
+
+void BasicCpuContext::declareOutputVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ != ComputeState::idle, "BasicCpuContext::declareOutputVariable(): state is idle");
+    QL_REQUIRE(currentId_ > 0, "BasicCpuContext::declareOutputVariable(): current id not set");
+    auto& p = programs_[currentId_ - 1];
+    QL_REQUIRE(!p.compiled, "BasicCpuContext::declareOutputVariable(): id (" << currentId_ << ") in version "
+                                                                             << p.version << " is compiled already.");
+    p.outputVariables.push_back(id);
+}
+
+void BasicCpuContext::compile(Program& p) const {
+
+    p.precision = precision_;
+
+    // last use of each variable, output variables are kept until the end
+
+    const std::size_t nVars = p.nInputs + p.variateSeeds.size() + p.operations.size();
+    const std::size_t keep = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> lastUse(nVars, QuantLib::Null<std::size_t>());
+    for (std::size_t k = 0; k < p.operations.size(); ++k)
+        for (auto const a : p.operations[k].args)
+            lastUse[a] = k;
+    for (auto const v : p.outputVariables) {
+        QL_REQUIRE(v < nVars, "BasicCpuContext::compile(): output variable " << v << " is not defined");
+        lastUse[v] = keep;
+    }
+
+    // assign slots to variates and operation results, a slot is reused once its variable is not used any more,
+    // the result of an operation takes the slot of its first argument if possible, since the kernels work in place
+
+    p.slot.assign(nVars, QuantLib::Null<std::size_t>());
+    p.nSlots = 0;
+    std::vector<std::size_t> freeSlots;
+    auto newSlot = [&p, &freeSlots]() {
+        if (freeSlots.empty())
+            return p.nSlots++;
+        std::size_t s = freeSlots.back();
+        freeSlots.pop_back();
+        return s;
+    };
+
+    for (std::size_t v = p.nInputs; v < p.nInputs + p.variateSeeds.size(); ++v) {
+        if (lastUse[v] != QuantLib::Null<std::size_t>())
+            p.slot[v] = newSlot();
+    }
+
+    for (std::size_t k = 0; k < p.operations.size(); ++k) {
+        auto const& op = p.operations[k];
+        std::size_t first = op.args.front();
+        if (p.slot[first] != QuantLib::Null<std::size_t>() && lastUse[first] == k) {
+            p.slot[op.result] = p.slot[first];
+        } else {
+            p.slot[op.result] = newSlot();
+        }
+        for (auto const a : op.args) {
+            if (p.slot[a] != QuantLib::Null<std::size_t>() && lastUse[a] == k && p.slot[a] != p.slot[op.result] &&
+                std::find(freeSlots.begin(), freeSlots.end(), p.slot[a]) == freeSlots.end())
+                freeSlots.push_back(p.slot[a]);
+        }
+        if (lastUse[op.result] == QuantLib::Null<std::size_t>())
+            freeSlots.push_back(p.slot[op.result]);
+    }
+
+    p.compiled = true;
+}
+
+void BasicCpuContext::runBlock(const Program& p, const std::size_t begin, const std::size_t end,
+                               std::vector<double>& slots, std::vector<double>& tmp,
+                               const std::vector<double*>& output) const {
+    using namespace RandomVariableKernels;
+
+    const std::size_t m = end - begin;
+    const bool roundToFloat = p.precision == Precision::Single;
+    auto round = [roundToFloat, m](double* x) {
+        if (roundToFloat) {
+            for (std::size_t j = 0; j < m; ++j)
+                x[j] = static_cast<float>(x[j]);
+        }
+    };
+    auto slotPtr = [&slots](const std::size_t s) { return &slots[s * blockSize]; };
+
+    // pointer to the values of a variable, inputs which are not available as doubles are written to tmp
+
+    auto values = [&](const std::size_t v, const std::size_t k) -> const double* {
+        if (v >= p.nInputs)
+            return slotPtr(p.slot[v]);
+        double* t = &tmp[k * blockSize];
+        if (inputVarIsScalar_[v]) {
+            std::fill(t, t + m, roundToFloat ? static_cast<float>(inputVarValue_[v]) : inputVarValue_[v]);
+        } else if (inputVarPtrDouble_[v] != nullptr) {
+            if (!roundToFloat)
+                return inputVarPtrDouble_[v] + begin;
+            std::copy(inputVarPtrDouble_[v] + begin, inputVarPtrDouble_[v] + end, t);
+            round(t);
+        } else {
+            std::copy(inputVarPtr_[v] + begin, inputVarPtr_[v] + end, t);
+        }
+        return t;
+    };
+
+    // generate the variates
+
+    auto const& mult = linearCongruentialMultipliers_.at(p.size);
+    for (std::size_t i = 0; i < p.variateSeeds.size(); ++i) {
+        std::size_t s = p.slot[p.nInputs + i];
+        if (s == QuantLib::Null<std::size_t>())
+            continue;
+        double* r = slotPtr(s);
+        for (std::size_t j = 0; j < m; ++j)
+            r[j] = invCumN(p.variateSeeds[i] * mult[begin + j]);
+        round(r);
+    }
+
+    // run the operations
+
+    for (auto const& op : p.operations) {
+        double* r = slotPtr(p.slot[op.result]);
+        const double* a = values(op.args[0], 0);
+        if (a != r)
+            std::copy(a, a + m, r);
+        const double* b = op.args.size() > 1 ? values(op.args[1], 1) : nullptr;
+        switch (op.opCode) {
+        case RandomVariableOpCode::None:
+            break;
+        case RandomVariableOpCode::Add:
+            add(r, b, m);
+            break;
+        case RandomVariableOpCode::Subtract:
+            subtract(r, b, m);
+            break;
+        case RandomVariableOpCode::Negative:
+            negate(r, m);
+            break;
+        case RandomVariableOpCode::Mult:
+            multiply(r, b, m);
+            break;
+        case RandomVariableOpCode::Div:
+            divide(r, b, m);
+            break;
+        case RandomVariableOpCode::IndicatorEq:
+            for (std::size_t j = 0; j < m; ++j)
+                r[j] = QuantLib::close_enough(r[j], b[j]) ? 1.0 : 0.0;
+            break;
+        case RandomVariableOpCode::IndicatorGt:
+            for (std::size_t j = 0; j < m; ++j)
+                r[j] = r[j] > b[j] && !QuantLib::close_enough(r[j], b[j]) ? 1.0 : 0.0;
+            break;
+        case RandomVariableOpCode::IndicatorGeq:
+            for (std::size_t j = 0; j < m; ++j)
+                r[j] = r[j] > b[j] || QuantLib::close_enough(r[j], b[j]) ? 1.0 : 0.0;
+            break;
+        case RandomVariableOpCode::Min:
+            min(r, b, m);
+            break;
+        case RandomVariableOpCode::Max:
+            max(r, b, m);
+            break;
+        case RandomVariableOpCode::Abs:
+            abs(r, m);
+            break;
+        case RandomVariableOpCode::Exp:
+            exp(r, m);
+            break;
+        case RandomVariableOpCode::Sqrt:
+            sqrt(r, m);
+            break;
+        case RandomVariableOpCode::Log:
+            log(r, m);
+            break;
+        case RandomVariableOpCode::Pow:
+            for (std::size_t j = 0; j < m; ++j)
+                r[j] = std::pow(r[j], b[j]);
+            break;
+        case RandomVariableOpCode::NormalCdf:
+            normalCdf(r, m);
+            break;
+        case RandomVariableOpCode::NormalPdf:
+            normalPdf(r, m);
+            break;
+        default:
+            QL_FAIL("BasicCpuContext::runBlock(): no implementation for op code "
+                    << op.opCode << " (" << getRandomVariableOpLabels()[op.opCode] << ") provided.");
+        }
+        round(r);
+    }
+
+    // copy the output
+
+    for (std::size_t i = 0; i < p.outputVariables.size(); ++i) {
+        const double* v = values(p.outputVariables[i], 0);
+        std::copy(v, v + m, output[i] + begin);
+    }
+}
+
+void BasicCpuContext::finalizeCalculation(std::vector<float*>& output) { finalizeCalculationImpl(output); }
+
+void BasicCpuContext::finalizeCalculation(std::vector<double*>& output) { finalizeCalculationImpl(output); }
+
+template <class T> void BasicCpuContext::finalizeCalculationImpl(std::vector<T*>& output) {
+    struct exitGuard {
+        ~exitGuard() { *currentState = ComputeState::idle; }
+        ComputeState* currentState;
+    } guard{&currentState_};
+
+    QL_REQUIRE(currentId_ > 0, "BasicCpuContext::finalizeCalculation(): current id is not set");
+    auto& p = programs_[currentId_ - 1];
+
+    boost::timer::cpu_timer timer;
+
+    if (!p.compiled) {
+        p.nInputs = inputVarIsScalar_.size();
+        p.inputIsScalar = inputVarIsScalar_;
+        p.variateSeeds = variateSeed_;
+        compile(p);
+        if (debug_)
+            debugInfo_.nanoSecondsProgramBuild += timer.elapsed().wall;
+    } else {
+        QL_REQUIRE(inputVarIsScalar_ == p.inputIsScalar,
+                   "BasicCpuContext::finalizeCalculation(): input variables ("
+                       << inputVarIsScalar_.size() << ") inconsistent to the input variables of the calculation ("
+                       << p.nInputs << ")");
+    }
+
+    QL_REQUIRE(output.size() == p.outputVariables.size(),
+               "BasicCpuContext::finalizeCalculation(): output size ("
+                   << output.size() << ") inconsistent to calculation output size (" << p.outputVariables.size()
+                   << ")");
+
+    // results are calculated in double (or emulated single) precision, float output is converted from a buffer
+
+    std::vector<std::vector<double>> outputBuffer;
+    std::vector<double*> outputPtr(output.size());
+    for (std::size_t i = 0; i < output.size(); ++i) {
+        if constexpr (std::is_same<T, double>::value) {
+            outputPtr[i] = output[i];
+        } else {
+            outputBuffer.push_back(std::vector<double>(p.size));
+            outputPtr[i] = &outputBuffer.back()[0];
+        }
+    }
+
+    // process the blocks of paths in parallel
+
+    const boost::timer::nanosecond_type timerBase = timer.elapsed().wall;
+    const std::size_t nBlocks = (p.size + blockSize - 1) / blockSize;
+    std::atomic<std::size_t> nextBlock(0);
+    auto worker = [this, &p, &nextBlock, nBlocks, &outputPtr]() {
+        std::vector<double> slots(p.nSlots * blockSize), tmp(2 * blockSize);
+        for (std::size_t b = nextBlock++; b < nBlocks; b = nextBlock++) {
+            runBlock(p, b * blockSize, std::min(p.size, (b + 1) * blockSize), slots, tmp, outputPtr);
+        }
+    };
+    const std::size_t nThreads = std::min(nThreads_, nBlocks);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < nThreads; ++t)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (auto& t : threads)
+        t.join();
+
+    if (debug_)
+        debugInfo_.nanoSecondsCalculation += timer.elapsed().wall - timerBase;
+
+    if constexpr (!std::is_same<T, double>::value) {
+        for (std::size_t i = 0; i < output.size(); ++i)
+            std::copy(outputBuffer[i].begin(), outputBuffer[i].end(), output[i]);
+    }
+}
+
+} // namespace QuantExt
@@ -0,0 +1,47 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/basiccpuenvironment.hpp
+    \brief cpu compute env implementation
+*/
+
+#pragma once
+
+#include <qle/math/computeenvironment.hpp>
+
+#include <map>
+
+namespace QuantExt {
+
+/*! Framework providing a single device "BasicCpu/Default/Default" which executes the recorded calculations on the
+    cpu, using the RandomVariable kernels and splitting the paths into blocks that are processed by worker threads.
+    Single precision is emulated by rounding the variates, inputs and results of each operation to float, the
+    variates are the same as generated by the OpenCL implementation, so that the device can be used as a reference
+    for other frameworks. */
+class BasicCpuFramework : public ComputeFramework {
+public:
+    BasicCpuFramework();
+    ~BasicCpuFramework() override final;
+    std::set<std::string> getAvailableDevices() const override final;
+    ComputeContext* getContext(const std::string& deviceName) override final;
+
+private:
+    std::map<std::string, ComputeContext*> contexts_;
+};
+
+} // namespace QuantExt
@@ -16,13 +16,18 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/computeenvironment.hpp>
+#include <qle/math/multidevicecontext.hpp>
 #include <qle/math/openclenvironment.hpp>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
 
 #include <ql/errors.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 #ifdef ORE_ENABLE_OPENCL
@@ -39,7 +44,20 @@ ComputeEnvironment::ComputeEnvironment() { reset(); }
 
 ComputeEnvironment::~ComputeEnvironment() { releaseFrameworks(); }
 
+namespace {
+std::vector<std::string> splitDeviceNames(const std::string& deviceName) {
+    std::vector<std::string> names;
+    boost::split(names, deviceName, [](char c) { return c == ','; });
+    for (auto& n : names)
+        boost::trim(n);
+    return names;
+}
+} // namespace
+
 void ComputeEnvironment::releaseFrameworks() {
+    for (auto& [_, c] : multiDeviceContexts_)
+        delete c;
+    multiDeviceContexts_.clear();
     for (auto& f : frameworks_)
         delete f;
     frameworks_.clear();
@@ -49,6 +67,7 @@ void ComputeEnvironment::reset() {
     currentContext_ = nullptr;
     releaseFrameworks();
     frameworks_.push_back(new OpenClFramework());
+    frameworks_.push_back(new BasicCpuFramework());
 }
 
 std::set<std::string> ComputeEnvironment::getAvailableDevices() const {
@@ -60,20 +79,44 @@ std::set<std::string> ComputeEnvironment::getAvailableDevices() const {
     return result;
 }
 
+bool ComputeEnvironment::hasDevice(const std::string& deviceName) const {
+    auto devices = getAvailableDevices();
+    if (devices.find(deviceName) != devices.end())
+        return true;
+    auto names = splitDeviceNames(deviceName);
+    std::set<std::string> uniqueNames(names.begin(), names.end());
+    return names.size() > 1 && uniqueNames.size() == names.size() &&
+           std::all_of(names.begin(), names.end(),
+                       [&devices](const std::string& n) { return devices.find(n) != devices.end(); });
+}
+
 bool ComputeEnvironment::hasContext() const { return currentContext_ != nullptr; }
 
-void ComputeEnvironment::selectContext(const std::string& deviceName) {
+ComputeContext* ComputeEnvironment::getContext(const std::string& deviceName) {
     for (auto& f : frameworks_) {
         if (auto tmp = f->getAvailableDevices(); tmp.find(deviceName) != tmp.end()) {
-            currentContext_ = f->getContext(deviceName);
-            currentContext_->init();
-            return;
+            return f->getContext(deviceName);
         }
     }
     QL_FAIL("ComputeEnvironment::selectContext(): device '"
             << deviceName << "' not found. Available devices: " << boost::join(getAvailableDevices(), ","));
 }
 
+void ComputeEnvironment::selectContext(const std::string& deviceName) {
+    if (auto tmp = getAvailableDevices();
+        tmp.find(deviceName) != tmp.end() || deviceName.find(',') == std::string::npos) {
+        currentContext_ = getContext(deviceName);
+    } else if (auto c = multiDeviceContexts_.find(deviceName); c != multiDeviceContexts_.end()) {
+        currentContext_ = c->second;
+    } else {
+        std::vector<ComputeContext*> contexts;
+        for (auto const& n : splitDeviceNames(deviceName))
+            contexts.push_back(getContext(n));
+        currentContext_ = multiDeviceContexts_[deviceName] = new MultiDeviceContext(contexts);
+    }
+    currentContext_->init();
+}
+
 ComputeContext& ComputeEnvironment::context() { return *currentContext_; }
 
 void ComputeContext::finalizeCalculation(std::vector<std::vector<float>>& output) {
@@ -83,4 +126,11 @@ void ComputeContext::finalizeCalculation(std::vector<std::vector<float>>& output
     finalizeCalculation(outputPtr);
 }
 
+void ComputeContext::finalizeCalculation(std::vector<std::vector<double>>& output) {
+    std::vector<double*> outputPtr(output.size());
+    std::transform(output.begin(), output.end(), outputPtr.begin(),
+                   [](std::vector<double>& v) -> double* { return &v[0]; });
+    finalizeCalculation(outputPtr);
+}
+
 }; // namespace QuantExt
@@ -25,7 +25,10 @@
 #include <ql/patterns/singleton.hpp>
 
 #include <cstdint>
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 namespace QuantExt {
 
@@ -37,15 +40,21 @@ public:
     ComputeEnvironment();
     ~ComputeEnvironment();
     std::set<std::string> getAvailableDevices() const;
+    /*! true if the device is available, or if the name is a comma separated list of distinct available devices */
+    bool hasDevice(const std::string& deviceName) const;
     bool hasContext() const;
+    /*! A comma separated list of devices selects a MultiDeviceContext that distributes the paths of the
+        calculations over the devices. The same list always selects the same context. */
     void selectContext(const std::string& deviceName);
     ComputeContext& context();
     void reset();
 
 private:
     void releaseFrameworks();
+    ComputeContext* getContext(const std::string& deviceName);
 
     std::vector<ComputeFramework*> frameworks_;
+    std::map<std::string, ComputeContext*> multiDeviceContexts_;
     ComputeContext* currentContext_;
 };
 
@@ -58,6 +67,10 @@ public:
 
 class ComputeContext {
 public:
+    /*! Floating point type used on the device: Single uses float throughout, Double uses double throughout, Mixed
+        stores the input variables as float and does the calculations and the output in double. */
+    enum class Precision { Single, Double, Mixed };
+
     struct DebugInfo {
         unsigned long numberOfOperations = 0;
         unsigned long nanoSecondsDataCopy = 0;
@@ -68,12 +81,26 @@ public:
     virtual ~ComputeContext() {}
     virtual void init() = 0;
 
+    /*! The precision applies to calculations initiated after the call, an existing calculation id with a different
+        precision is treated like a new version, i.e. it has to be recorded again. */
+    virtual void setPrecision(const Precision precision) = 0;
+    virtual Precision precision() const = 0;
+    virtual bool supportsDoublePrecision() const = 0;
+
+    /*! Directory for compiled programs. If set, programs are stored there after they were built and taken from
+        there instead of being built again, e.g. in a later run of the same calculations. */
+    virtual void setProgramCacheDirectory(const std::string& directory) = 0;
+
     virtual std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
                                                              const std::size_t version = 0,
                                                              const bool debug = false) = 0;
 
+    /*! input variables are converted to the precision of the context, the pointers must be valid until
+        finalizeCalculation() is called */
     virtual std::size_t createInputVariable(float v) = 0;
     virtual std::size_t createInputVariable(float* v) = 0;
+    virtual std::size_t createInputVariable(double v) = 0;
+    virtual std::size_t createInputVariable(double* v) = 0;
     virtual std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim, const std::size_t steps,
                                                                       const std::uint32_t seed) = 0;
 
@@ -83,6 +110,7 @@ public:
     virtual void declareOutputVariable(const std::size_t id) = 0;
 
     virtual void finalizeCalculation(std::vector<float*>& output) = 0;
+    virtual void finalizeCalculation(std::vector<double*>& output) = 0;
 
     // debug info
 
@@ -91,6 +119,7 @@ public:
     // convenience methods
 
     void finalizeCalculation(std::vector<std::vector<float>>& output);
+    void finalizeCalculation(std::vector<std::vector<double>>& output);
 };
 
 } // namespace QuantExt
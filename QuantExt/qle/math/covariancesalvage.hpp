@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <qle/math/salvagedmatrixcache.hpp>
+
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
 
 namespace QuantExt {
@@ -56,11 +58,17 @@ struct NoCovarianceSalvage : public CovarianceSalvage {
     std::pair<Matrix, Matrix> salvage(const Matrix& m) const override { return std::make_pair(m, Matrix()); }
 };
 
-//! Implementation that uses the spectral method
+//! Implementation that uses the spectral method, the results are cached in the SalvagedMatrixCache if it is enabled
 struct SpectralCovarianceSalvage : public CovarianceSalvage {
     std::pair<Matrix, Matrix> salvage(const Matrix& m) const override {
+        SalvagedMatrixCache& cache = SalvagedMatrixCache::instance();
+        std::pair<Matrix, Matrix> result;
+        if (cache.enabled() && cache.get("spectralCovarianceSalvage", m, result))
+            return result;
         auto L = pseudoSqrt(m, SalvagingAlgorithm::Spectral);
-        return std::make_pair(L * transpose(L), L);
+        result = std::make_pair(L * transpose(L), L);
+        cache.add("spectralCovarianceSalvage", m, result);
+        return result;
     }
 };
 
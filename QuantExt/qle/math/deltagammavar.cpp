@@ -42,6 +42,47 @@ void check(const Matrix& omega, const Array& delta, const Matrix& gamma) {
                "gamma (" << gamma.rows() << "x" << gamma.columns() << ") must have same dimensions as omega ("
                          << omega.rows() << "x" << omega.columns() << ")");
 }
+
+Matrix principalComponentFactor(const Matrix& m) {
+    // the eigenvalues are sorted in decreasing order
+    SymmetricSchurDecomposition ssd(m);
+    Matrix l = ssd.eigenvectors();
+    for (Size j = 0; j < l.columns(); ++j) {
+        Real s = std::sqrt(std::max(ssd.eigenvalues()[j], 0.0));
+        for (Size i = 0; i < l.rows(); ++i)
+            l[i][j] *= s;
+    }
+    return l;
+}
+
+void quadraticForms(const Matrix& z, const Size n, const Array& a, const Matrix& b, Real* pl) {
+    const Size d = a.size();
+    // w = z b for the first n rows of z, as a product over tiles of rows of b, so that a tile stays in the cache
+    // while it is applied to all rows of z
+    const Size tileSize = 64;
+    Matrix w(n, d, 0.0);
+    for (Size k0 = 0; k0 < d; k0 += tileSize) {
+        const Size k1 = std::min(k0 + tileSize, d);
+        for (Size i = 0; i < n; ++i) {
+            const Real* zi = z[i];
+            Real* wi = w[i];
+            for (Size k = k0; k < k1; ++k) {
+                const Real zik = zi[k];
+                const Real* bk = b[k];
+                for (Size l = 0; l < d; ++l)
+                    wi[l] += zik * bk[l];
+            }
+        }
+    }
+    for (Size i = 0; i < n; ++i) {
+        const Real* zi = z[i];
+        const Real* wi = w[i];
+        Real res = 0.0;
+        for (Size k = 0; k < d; ++k)
+            res += zi[k] * (a[k] + 0.5 * wi[k]);
+        pl[i] = res;
+    }
+}
 } // namespace detail
 
 namespace {
@@ -303,44 +344,75 @@ Real F(const Array& lambda, const Array& delta, const Real x) {
 } // namespace
 
 Real deltaVar(const Matrix& omega, const Array& delta, const Real p, const CovarianceSalvage& sal) {
-    detail::check(p);
+    return deltaVar(omega, delta, std::vector<Real>(1, p), sal).front();
+} // deltaVar
+
+std::vector<Real> deltaVar(const Matrix& omega, const Array& delta, const std::vector<Real>& p,
+                           const CovarianceSalvage& sal) {
+    for (auto q : p)
+        detail::check(q);
     detail::check(omega, delta);
     Real num = detail::absMax(delta);
     if (close_enough(num, 0.0))
-        return 0.0;
+        return std::vector<Real>(p.size(), 0.0);
     Array tmpDelta = delta / num;
-    return std::sqrt(DotProduct(tmpDelta, sal.salvage(omega).first * tmpDelta)) *
-           QuantLib::InverseCumulativeNormal()(p) * num;
+    Real stdDev = std::sqrt(DotProduct(tmpDelta, sal.salvage(omega).first * tmpDelta));
+    std::vector<Real> res;
+    for (auto q : p)
+        res.push_back(stdDev * QuantLib::InverseCumulativeNormal()(q) * num);
+    return res;
 } // deltaVar
 
 Real deltaGammaVarNormal(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                          const CovarianceSalvage& sal) {
-    detail::check(p);
-    Real s = QuantLib::InverseCumulativeNormal()(p);
+    return deltaGammaVarNormal(omega, delta, gamma, std::vector<Real>(1, p), sal).front();
+} // deltaGammaVarNormal
+
+std::vector<Real> deltaGammaVarNormal(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                      const std::vector<Real>& p, const CovarianceSalvage& sal) {
+    for (auto q : p)
+        detail::check(q);
     Real num = 0.0, mu = 0.0, variance = 0.0;
     moments(sal.salvage(omega).first, delta, gamma, num, mu, variance);
     if (close_enough(num, 0.0) || close_enough(variance, 0.0))
-        return 0.0;
-    return (std::sqrt(variance) * s + mu) * num;
-
+        return std::vector<Real>(p.size(), 0.0);
+    std::vector<Real> res;
+    for (auto q : p)
+        res.push_back((std::sqrt(variance) * QuantLib::InverseCumulativeNormal()(q) + mu) * num);
+    return res;
 } // deltaGammaVarNormal
 
 Real deltaGammaVarCornishFisher(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                                 const CovarianceSalvage& sal) {
-    detail::check(p);
-    Real s = QuantLib::InverseCumulativeNormal()(p);
+    return deltaGammaVarCornishFisher(omega, delta, gamma, std::vector<Real>(1, p), sal).front();
+} // deltaGammaVarCornishFisher
+
+std::vector<Real> deltaGammaVarCornishFisher(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                             const std::vector<Real>& p, const CovarianceSalvage& sal) {
+    for (auto q : p)
+        detail::check(q);
     Real num = 0.0, mu = 0.0, variance = 0.0, tau = 0.0, kappa = 0.0;
     moments(sal.salvage(omega).first, delta, gamma, num, mu, variance, tau, kappa);
     if (close_enough(num, 0.0) || close_enough(variance, 0.0))
-        return 0.0;
-
-    Real xTilde =
-        s + tau / 6.0 * (s * s - 1.0) + kappa / 24.0 * s * (s * s - 3.0) - tau * tau / 36.0 * s * (2.0 * s * s - 5.0);
-    return (xTilde * std::sqrt(variance) + mu) * num;
+        return std::vector<Real>(p.size(), 0.0);
+
+    std::vector<Real> res;
+    for (auto q : p) {
+        Real s = QuantLib::InverseCumulativeNormal()(q);
+        Real xTilde = s + tau / 6.0 * (s * s - 1.0) + kappa / 24.0 * s * (s * s - 3.0) -
+                      tau * tau / 36.0 * s * (2.0 * s * s - 5.0);
+        res.push_back((xTilde * std::sqrt(variance) + mu) * num);
+    }
+    return res;
 } // deltaGammaVarCornishFisher
 
 Real deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                               const CovarianceSalvage& sal) {
+    return deltaGammaVarSaddlepoint(omega, delta, gamma, std::vector<Real>(1, p), sal).front();
+} // deltaGammaVarSaddlepoint
+
+std::vector<Real> deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                           const std::vector<Real>& p, const CovarianceSalvage& sal) {
 
     /* References:
 
@@ -351,7 +423,8 @@ Real deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Mat
        Daniels, H. E. (1987), Tail Probability Approximations, International Statistical Review, 55, 37-48.
     */
 
-    detail::check(p);
+    for (auto q : p)
+        detail::check(q);
     detail::check(omega, delta, gamma);
 
     auto S = sal.salvage(omega);
@@ -404,19 +477,22 @@ Real deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Mat
     if (normGammaBar / normDeltaBar < 1E-10)
         return QuantExt::deltaVar(S.first, delta, p);
 
-    // continue with the saddlepoint approach
-    auto FMinusP = [&lambda, &deltaBar, &p](const Real x) { return F(lambda, deltaBar, x) - p; };
-    Real quantile;
-    try {
-        // TODO check hardcoded tolerance, guess and step
-        Brent b;
-        quantile = b.solve(FMinusP, 1E-6, 0.0, 1.0);
-    } catch (const std::exception& e) {
-        QL_FAIL("deltaGammaVarSaddlepoint: could no solve for quantile p = " << p << ": " << e.what());
+    // continue with the saddlepoint approach, the decomposition above is shared by all quantiles
+    std::vector<Real> res;
+    for (auto q : p) {
+        auto FMinusP = [&lambda, &deltaBar, q](const Real x) { return F(lambda, deltaBar, x) - q; };
+        Real quantile;
+        try {
+            // TODO check hardcoded tolerance, guess and step
+            Brent b;
+            quantile = b.solve(FMinusP, 1E-6, 0.0, 1.0);
+        } catch (const std::exception& e) {
+            QL_FAIL("deltaGammaVarSaddlepoint: could no solve for quantile p = " << q << ": " << e.what());
+        }
+        // undo scaling
+        res.push_back(quantile * scaling);
     }
-
-    // undo scaling and return result
-    return quantile * scaling;
+    return res;
 
 } // deltaGammaVarSaddlepoint
 
@@ -25,6 +25,7 @@
 #define quantext_deltagammavar_hpp
 
 #include <qle/math/covariancesalvage.hpp>
+#include <qle/math/tailstatistics.hpp>
 
 #include <ql/math/comparison.hpp>
 #include <ql/math/array.hpp>
@@ -33,15 +34,12 @@
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
 #include <ql/math/randomnumbers/rngtraits.hpp>
 
-// fix for boost 1.64, see https://lists.boost.org/Archives/boost/2016/11/231756.php
-#if BOOST_VERSION >= 106400
-#include <boost/serialization/array_wrapper.hpp>
-#endif
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/tail_quantile.hpp>
 #include <boost/foreach.hpp>
 
+#include <algorithm>
+#include <future>
+#include <type_traits>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -51,6 +49,10 @@ using namespace QuantLib;
 Real deltaVar(const Matrix& omega, const Array& delta, const Real p,
               const CovarianceSalvage& sal = NoCovarianceSalvage());
 
+//! function that computes a delta VaR for several confidence levels, salvaging the covariance matrix only once
+std::vector<Real> deltaVar(const Matrix& omega, const Array& delta, const std::vector<Real>& p,
+                           const CovarianceSalvage& sal = NoCovarianceSalvage());
+
 //! function that computes a delta-gamma normal VaR
 /*! For a given a covariance matrix, a delta vector and a gamma matrix this function computes a parametric var
  * w.r.t. a given confidence level. The gamma matrix is taken into account when computing the variance of the PL
@@ -58,27 +60,46 @@ Real deltaVar(const Matrix& omega, const Array& delta, const Real p,
 Real deltaGammaVarNormal(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                          const CovarianceSalvage& sal = NoCovarianceSalvage());
 
+//! function that computes a delta-gamma normal VaR for several confidence levels, computing the moments only once
+std::vector<Real> deltaGammaVarNormal(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                      const std::vector<Real>& p,
+                                      const CovarianceSalvage& sal = NoCovarianceSalvage());
+
 //! function that computes a delta-gamma VaR using Monte Carlo (single quantile)
 /*! For a given a covariance matrix, a delta vector and a gamma matrix this function computes a parametric var
  * w.r.t. a given confidence level. The var quantile is estimated from Monte-Carlo realisations of a second order
  * sensitivity based PL. */
 template <class RNG>
 Real deltaGammaVarMc(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p, const Size paths,
-                     const Size seed, const CovarianceSalvage& sal = NoCovarianceSalvage());
+                     const Size seed, const CovarianceSalvage& sal = NoCovarianceSalvage(), const Size nThreads = 1);
 
 //! function that computes a delta-gamma VaR using Monte Carlo (multiple quantiles)
 /*! For a given a covariance matrix, a delta vector and a gamma matrix this function computes a parametric var
  * w.r.t. a vector of given confidence levels. The var quantile is estimated from Monte-Carlo realisations of a second
- * order sensitivity based PL. */
+ * order sensitivity based PL.
+ *
+ * The PL is evaluated as a quadratic form in the independent normal draws for blocks of paths, the blocks can be
+ * distributed over nThreads threads. The draws are generated sequentially, so that the result only depends on the
+ * seed and not on the number of threads. For a low discrepancy generator (e.g. LowDiscrepancy, i.e. Sobol) the
+ * covariance matrix is factorised into principal components in order of decreasing variance, so that the first,
+ * best distributed dimensions of the sequence drive the largest moves - the analogue of the Brownian bridge
+ * ordering for a single time step. */
 template <class RNG>
 std::vector<Real> deltaGammaVarMc(const Matrix& omega, const Array& delta, const Matrix& gamma,
 				  const std::vector<Real>& p, const Size paths, const Size seed,
-				  const CovarianceSalvage& sal = NoCovarianceSalvage());
+				  const CovarianceSalvage& sal = NoCovarianceSalvage(), const Size nThreads = 1);
 
 namespace detail {
 void check(const Real p);
 void check(const Matrix& omega, const Array& delta);
 void check(const Matrix& omega, const Array& delta, const Matrix& gamma);
+//! true for the low discrepancy rng traits
+template <class RNG> struct isLowDiscrepancy : std::false_type {};
+template <class URSG, class IC> struct isLowDiscrepancy<GenericLowDiscrepancy<URSG, IC>> : std::true_type {};
+//! factor l l^T = m with the columns of l being the principal components of m in order of decreasing variance
+Matrix principalComponentFactor(const Matrix& m);
+//! pl[i] = z_i a + 0.5 z_i b z_i^T for the first n rows z_i of z, b must be symmetric
+void quadraticForms(const Matrix& z, const Size n, const Array& a, const Matrix& b, Real* pl);
 template <typename A> Real absMax(const A& a) {
     Real tmp = 0.0;
     BOOST_FOREACH (Real x, a) {
@@ -94,7 +115,7 @@ template <typename A> Real absMax(const A& a) {
 template <class RNG>
 std::vector<Real> deltaGammaVarMc(const Matrix& omega, const Array& delta, const Matrix& gamma,
 				  const std::vector<Real>& p, const Size paths, const Size seed,
-				  const CovarianceSalvage& sal) {
+				  const CovarianceSalvage& sal, const Size nThreads) {
     BOOST_FOREACH (Real q, p) { detail::check(q); }
     detail::check(omega, delta, gamma);
 
@@ -109,47 +130,77 @@ std::vector<Real> deltaGammaVarMc(const Matrix& omega, const Array& delta, const
         L = CholeskyDecomposition(omega, true);
     }
 
-    Real pmin = QL_MAX_REAL;
-    BOOST_FOREACH (Real q, p) { pmin = std::min(pmin, q); }
-
-    Size cache = Size(std::floor(static_cast<double>(paths) * (1.0 - pmin) + 0.5)) + 2;
-    boost::accumulators::accumulator_set<
-        double, boost::accumulators::stats<boost::accumulators::tag::tail_quantile<boost::accumulators::right> > >
-        acc(boost::accumulators::tag::tail<boost::accumulators::right>::cache_size = cache);
-
-    typename RNG::rsg_type rng = RNG::make_sequence_generator(delta.size(), seed);
-
-    for (Size i = 0; i < paths; ++i) {
-        std::vector<Real> seq = rng.nextSequence().value;
-        Array z(seq.begin(), seq.end());
-        Array u = L * z;
-        acc(DotProduct(u, delta) + 0.5 * DotProduct(u, gamma * u));
-    }
-
-    std::vector<Real> res;
-    BOOST_FOREACH (Real q, p) {
-        res.push_back(boost::accumulators::quantile(acc, boost::accumulators::quantile_probability = q));
+    if (detail::isLowDiscrepancy<RNG>::value)
+        L = detail::principalComponentFactor(L * transpose(L));
+
+    // with u = L z the PL is z' a + 0.5 z' b z
+    Matrix Lt = transpose(L);
+    Array a = Lt * delta;
+    Matrix b = Lt * gamma * L;
+
+    const Size n = delta.size();
+    const Size blockSize = 1024;
+    const Size nBlocks = (paths + blockSize - 1) / blockSize;
+    const Size nJobs = std::max<Size>(1, std::min(nThreads, nBlocks));
+
+    typename RNG::rsg_type rng = RNG::make_sequence_generator(n, seed);
+
+    std::vector<Real> pl(paths);
+    std::vector<Matrix> z(nJobs, Matrix(blockSize, n));
+    for (Size b0 = 0; b0 < nBlocks; b0 += nJobs) {
+        const Size b1 = std::min(b0 + nJobs, nBlocks);
+        for (Size j = 0; j < b1 - b0; ++j) {
+            for (Size i = (b0 + j) * blockSize; i < std::min((b0 + j + 1) * blockSize, paths); ++i) {
+                const std::vector<Real>& seq = rng.nextSequence().value;
+                std::copy(seq.begin(), seq.end(), z[j].row_begin(i % blockSize));
+            }
+        }
+        auto evaluate = [&z, &a, &b, &pl, b0, paths, blockSize](const Size j) {
+            const Size begin = (b0 + j) * blockSize;
+            detail::quadraticForms(z[j], std::min(begin + blockSize, paths) - begin, a, b, &pl[begin]);
+        };
+        if (b1 - b0 == 1) {
+            evaluate(0);
+        } else {
+            std::vector<std::future<void>> results;
+            for (Size j = 0; j < b1 - b0; ++j)
+                results.push_back(std::async(std::launch::async, evaluate, j));
+            for (auto& r : results)
+                r.get();
+        }
     }
 
-    return res;
+    return rightTailStatistics(std::move(pl), p).quantiles;
 }
 
 template <class RNG>
 Real deltaGammaVarMc(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p, const Size paths,
-                     const Size seed, const CovarianceSalvage& sal) {
+                     const Size seed, const CovarianceSalvage& sal, const Size nThreads) {
 
     std::vector<Real> pv(1, p);
-    return deltaGammaVarMc<RNG>(omega, delta, gamma, pv, paths, seed, sal).front();
+    return deltaGammaVarMc<RNG>(omega, delta, gamma, pv, paths, seed, sal, nThreads).front();
 }
 
 /* delta-gamma VaR using Cornish-Fisher extrapolation (or normal delta-gamma VaR) */
 Real deltaGammaVarCornishFisher(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                                 const CovarianceSalvage& sal = NoCovarianceSalvage());
 
+/* delta-gamma VaR using Cornish-Fisher extrapolation for several confidence levels, the moments of the PL
+   distribution are computed only once */
+std::vector<Real> deltaGammaVarCornishFisher(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                             const std::vector<Real>& p,
+                                             const CovarianceSalvage& sal = NoCovarianceSalvage());
+
 /* delta-gamma VaR using Saddlepoint approximation */
 Real deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Matrix& gamma, const Real p,
                               const CovarianceSalvage& sal = NoCovarianceSalvage());
 
+/* delta-gamma VaR using Saddlepoint approximation for several confidence levels, the eigen decomposition of the
+   covariance weighted gamma is computed only once and shared by the root searches for the quantiles */
+std::vector<Real> deltaGammaVarSaddlepoint(const Matrix& omega, const Array& delta, const Matrix& gamma,
+                                           const std::vector<Real>& p,
+                                           const CovarianceSalvage& sal = NoCovarianceSalvage());
+
 } // namespace QuantExt
 
 #endif
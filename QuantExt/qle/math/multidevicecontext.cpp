@@ -0,0 +1,244 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/multidevicecontext.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace QuantExt {
+
+namespace {
+// multiplier of the linear congruential generator of the frameworks, the j-th path of a variate with seed s uses
+// the state s * a^(j+1), so that a shard starting at path k uses the seed s * a^k
+const std::uint32_t lcrngMultiplier = 1099087573;
+
+std::uint32_t lcrngPower(std::size_t k) {
+    std::uint32_t result = 1, a = lcrngMultiplier;
+    while (k > 0) {
+        if (k & 1)
+            result *= a;
+        a *= a;
+        k >>= 1;
+    }
+    return result;
+}
+} // namespace
+
+MultiDeviceContext::MultiDeviceContext(const std::vector<ComputeContext*>& contexts) : contexts_(contexts) {
+    QL_REQUIRE(!contexts_.empty(), "MultiDeviceContext: no contexts given");
+    for (std::size_t i = 0; i < contexts_.size(); ++i) {
+        QL_REQUIRE(contexts_[i] != nullptr, "MultiDeviceContext: context #" << i << " is null");
+        QL_REQUIRE(std::find(contexts_.begin(), contexts_.begin() + i, contexts_[i]) == contexts_.begin() + i,
+                   "MultiDeviceContext: context #" << i << " is given more than once");
+    }
+    precision_ = contexts_.front()->precision();
+}
+
+void MultiDeviceContext::init() {
+    for (auto c : contexts_)
+        c->init();
+}
+
+void MultiDeviceContext::setPrecision(const Precision precision) {
+    for (auto c : contexts_)
+        c->setPrecision(precision);
+    precision_ = precision;
+}
+
+bool MultiDeviceContext::supportsDoublePrecision() const {
+    return std::all_of(contexts_.begin(), contexts_.end(),
+                       [](const ComputeContext* c) { return c->supportsDoublePrecision(); });
+}
+
+void MultiDeviceContext::setProgramCacheDirectory(const std::string& directory) {
+    for (auto c : contexts_)
+        c->setProgramCacheDirectory(directory);
+}
+
+std::pair<std::size_t, bool> MultiDeviceContext::initiateCalculation(const std::size_t n, const std::size_t id,
+                                                                     const std::size_t version, const bool debug) {
+    QL_REQUIRE(n > 0, "MultiDeviceContext::initiateCalculation(): n must not be zero");
+
+    bool newCalc = false;
+    if (id == 0) {
+        Calculation c;
+        c.size = n;
+        c.version = version;
+        c.precision = precision_;
+        const std::size_t nShards = std::min(contexts_.size(), n);
+        for (std::size_t k = 0; k <= nShards; ++k)
+            c.offset.push_back(k * n / nShards);
+        c.subId.resize(nShards, 0);
+        calculations_.push_back(c);
+        currentId_ = calculations_.size();
+        newCalc = true;
+    } else {
+        QL_REQUIRE(id <= calculations_.size(), "MultiDeviceContext::initiateCalculation(): id ("
+                                                   << id << ") invalid, got 1..." << calculations_.size());
+        QL_REQUIRE(calculations_[id - 1].size == n, "MultiDeviceContext::initiateCalculation(): size ("
+                                                        << calculations_[id - 1].size << ") for id " << id
+                                                        << " does not match current size (" << n << ")");
+        newCalc = calculations_[id - 1].version != version || calculations_[id - 1].precision != precision_;
+        calculations_[id - 1].version = version;
+        calculations_[id - 1].precision = precision_;
+        currentId_ = id;
+    }
+
+    auto& c = calculations_[currentId_ - 1];
+    for (std::size_t k = 0; k < c.subId.size(); ++k) {
+        auto [subId, subNewCalc] =
+            contexts_[k]->initiateCalculation(c.offset[k + 1] - c.offset[k], c.subId[k], version, debug);
+        QL_REQUIRE(subNewCalc == newCalc, "MultiDeviceContext::initiateCalculation(): context #"
+                                              << k << " (id " << subId << ") is not in sync with the calculation id "
+                                              << currentId_ << ", the contexts must not be used directly");
+        c.subId[k] = subId;
+    }
+
+    varIds_.assign(c.subId.size(), std::vector<std::size_t>());
+    return std::make_pair(currentId_, newCalc);
+}
+
+template <class T> std::size_t MultiDeviceContext::addInputVariable(T v) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::createInputVariable(): current id is not set");
+    for (std::size_t k = 0; k < varIds_.size(); ++k)
+        varIds_[k].push_back(contexts_[k]->createInputVariable(v));
+    return varIds_.front().size() - 1;
+}
+
+template <class T> std::size_t MultiDeviceContext::addInputVariable(T* v) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::createInputVariable(): current id is not set");
+    auto const& c = calculations_[currentId_ - 1];
+    for (std::size_t k = 0; k < varIds_.size(); ++k)
+        varIds_[k].push_back(contexts_[k]->createInputVariable(v + c.offset[k]));
+    return varIds_.front().size() - 1;
+}
+
+std::size_t MultiDeviceContext::createInputVariable(float v) { return addInputVariable(v); }
+
+std::size_t MultiDeviceContext::createInputVariable(float* v) { return addInputVariable(v); }
+
+std::size_t MultiDeviceContext::createInputVariable(double v) { return addInputVariable(v); }
+
+std::size_t MultiDeviceContext::createInputVariable(double* v) { return addInputVariable(v); }
+
+std::vector<std::vector<std::size_t>> MultiDeviceContext::createInputVariates(const std::size_t dim,
+                                                                              const std::size_t steps,
+                                                                              const std::uint32_t seed) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::createInputVariates(): current id is not set");
+    auto const& c = calculations_[currentId_ - 1];
+    std::vector<std::uint32_t> shardMultiplier(varIds_.size());
+    for (std::size_t k = 0; k < varIds_.size(); ++k)
+        shardMultiplier[k] = lcrngPower(c.offset[k]);
+    // the seed update of a single context of size n
+    const std::uint32_t seedUpdate = lcrngPower(c.size + 1);
+    std::vector<std::vector<std::size_t>> resultIds(dim, std::vector<std::size_t>(steps));
+    std::uint32_t currentSeed = seed;
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < steps; ++j) {
+            for (std::size_t k = 0; k < varIds_.size(); ++k)
+                varIds_[k].push_back(contexts_[k]->createInputVariates(1, 1, currentSeed * shardMultiplier[k])[0][0]);
+            currentSeed *= seedUpdate;
+            resultIds[i][j] = varIds_.front().size() - 1;
+        }
+    }
+    return resultIds;
+}
+
+std::size_t MultiDeviceContext::applyOperation(const std::size_t randomVariableOpCode,
+                                               const std::vector<std::size_t>& args) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::applyOperation(): current id is not set");
+    std::vector<std::size_t> subArgs(args.size());
+    for (std::size_t k = 0; k < varIds_.size(); ++k) {
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            QL_REQUIRE(args[i] < varIds_[k].size(),
+                       "MultiDeviceContext::applyOperation(): variable " << args[i] << " is not defined");
+            subArgs[i] = varIds_[k][args[i]];
+        }
+        varIds_[k].push_back(contexts_[k]->applyOperation(randomVariableOpCode, subArgs));
+    }
+    return varIds_.front().size() - 1;
+}
+
+void MultiDeviceContext::freeVariable(const std::size_t id) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::freeVariable(): current id is not set");
+    for (std::size_t k = 0; k < varIds_.size(); ++k) {
+        QL_REQUIRE(id < varIds_[k].size(), "MultiDeviceContext::freeVariable(): variable " << id << " is not defined");
+        contexts_[k]->freeVariable(varIds_[k][id]);
+    }
+}
+
+void MultiDeviceContext::declareOutputVariable(const std::size_t id) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::declareOutputVariable(): current id is not set");
+    for (std::size_t k = 0; k < varIds_.size(); ++k) {
+        QL_REQUIRE(id < varIds_[k].size(),
+                   "MultiDeviceContext::declareOutputVariable(): variable " << id << " is not defined");
+        contexts_[k]->declareOutputVariable(varIds_[k][id]);
+    }
+}
+
+void MultiDeviceContext::finalizeCalculation(std::vector<float*>& output) { finalizeCalculationImpl(output); }
+
+void MultiDeviceContext::finalizeCalculation(std::vector<double*>& output) { finalizeCalculationImpl(output); }
+
+template <class T> void MultiDeviceContext::finalizeCalculationImpl(std::vector<T*>& output) {
+    QL_REQUIRE(currentId_ > 0, "MultiDeviceContext::finalizeCalculation(): current id is not set");
+    auto const& c = calculations_[currentId_ - 1];
+
+    // run the shards concurrently, each context writes its paths into the output at the offset of its shard
+
+    std::vector<std::exception_ptr> errors(varIds_.size());
+    auto run = [this, &c, &output, &errors](const std::size_t k) {
+        try {
+            std::vector<T*> shardOutput(output.size());
+            for (std::size_t i = 0; i < output.size(); ++i)
+                shardOutput[i] = output[i] + c.offset[k];
+            contexts_[k]->finalizeCalculation(shardOutput);
+        } catch (...) {
+            errors[k] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t k = 1; k < varIds_.size(); ++k)
+        threads.push_back(std::thread(run, k));
+    run(0);
+    for (auto& t : threads)
+        t.join();
+
+    for (auto const& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+const ComputeContext::DebugInfo& MultiDeviceContext::debugInfo() const {
+    debugInfo_ = DebugInfo();
+    for (auto c : contexts_) {
+        auto const& d = c->debugInfo();
+        debugInfo_.numberOfOperations += d.numberOfOperations;
+        debugInfo_.nanoSecondsDataCopy += d.nanoSecondsDataCopy;
+        debugInfo_.nanoSecondsProgramBuild += d.nanoSecondsProgramBuild;
+        debugInfo_.nanoSecondsCalculation += d.nanoSecondsCalculation;
+    }
+    return debugInfo_;
+}
+
+} // namespace QuantExt
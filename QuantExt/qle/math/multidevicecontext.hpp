@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/multidevicecontext.hpp
+    \brief compute context distributing the paths over several contexts
+*/
+
+#pragma once
+
+#include <qle/math/computeenvironment.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+/*! Compute context that splits the paths of each calculation into contiguous shards that are calculated on the
+    given contexts, e.g. several devices of one node. The recorded operations are forwarded to all contexts and the
+    calculations are run concurrently in finalizeCalculation(), each context writes its shard of the paths into the
+    output.
+
+    The variates are the same as on a single context, since the linear congruential generator used by the
+    frameworks allows to absorb the path offset of a shard into the seed of the variates.
+
+    The contexts are not owned by this class and must be distinct. */
+class MultiDeviceContext : public ComputeContext {
+public:
+    explicit MultiDeviceContext(const std::vector<ComputeContext*>& contexts);
+
+    void init() override final;
+
+    void setPrecision(const Precision precision) override final;
+    Precision precision() const override final { return precision_; }
+    bool supportsDoublePrecision() const override final;
+    void setProgramCacheDirectory(const std::string& directory) override final;
+
+    std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
+                                                     const std::size_t version = 0,
+                                                     const bool debug = false) override final;
+    std::size_t createInputVariable(float v) override final;
+    std::size_t createInputVariable(float* v) override final;
+    std::size_t createInputVariable(double v) override final;
+    std::size_t createInputVariable(double* v) override final;
+    std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim, const std::size_t steps,
+                                                              const std::uint32_t seed) override final;
+    std::size_t applyOperation(const std::size_t randomVariableOpCode,
+                               const std::vector<std::size_t>& args) override final;
+    void freeVariable(const std::size_t id) override final;
+    void declareOutputVariable(const std::size_t id) override final;
+    void finalizeCalculation(std::vector<float*>& output) override final;
+    void finalizeCalculation(std::vector<double*>& output) override final;
+
+    //! the debug info summed over the contexts
+    const DebugInfo& debugInfo() const override final;
+
+private:
+    struct Calculation {
+        std::size_t size, version;
+        Precision precision;
+        // offsets of the shards, the last entry is the size
+        std::vector<std::size_t> offset;
+        std::vector<std::size_t> subId;
+    };
+
+    template <class T> std::size_t addInputVariable(T v);
+    template <class T> std::size_t addInputVariable(T* v);
+    template <class T> void finalizeCalculationImpl(std::vector<T*>& output);
+
+    std::vector<ComputeContext*> contexts_;
+    Precision precision_ = Precision::Single;
+    mutable DebugInfo debugInfo_;
+
+    std::vector<Calculation> calculations_;
+    std::size_t currentId_ = 0;
+    // variable ids of the contexts, indexed by context and variable id
+    std::vector<std::vector<std::size_t>> varIds_;
+};
+
+} // namespace QuantExt
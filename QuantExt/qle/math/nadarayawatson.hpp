@@ -19,10 +19,16 @@
 #ifndef quantext_nadaraya_watson_regression_hpp
 #define quantext_nadaraya_watson_regression_hpp
 
+#include <ql/errors.hpp>
 #include <ql/math/comparison.hpp>
 
 #include <boost/make_shared.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
 /*! \file qle/math/nadarayawatson.hpp
     \brief Nadaraya-Watson regression
     \ingroup math
@@ -118,6 +124,125 @@ private:
     boost::shared_ptr<detail::RegressionImpl> impl_;
 };
 
+//! Binned Nadaraya Watson regression
+/*! This approximates the NadarayaWatson estimator in linear time: the samples are assigned to an equidistant grid of
+    bins by linear binning, the kernel sums are computed on the grid by a discrete convolution and interpolated
+    linearly between the grid points. The kernel is assumed to vanish outside [-kernelSupport, kernelSupport], the
+    grid covers the range of the samples extended by the kernel support (up to the length of the range on each side),
+    outside the grid the sums are computed directly from the bins.
+
+    The cost is O(n + bins * kernelSupport / h) for the construction, h being the bin width, and O(1) per evaluation
+    on the grid, compared to O(n) per evaluation for the NadarayaWatson estimator.
+
+    \ingroup math
+*/
+class BinnedNadarayaWatson {
+public:
+    /*! \pre kernel needs a Real operator()(Real x) implementation, the x values need not be sorted */
+    template <class I1, class I2, class Kernel>
+    BinnedNadarayaWatson(const I1& xBegin, const I1& xEnd, const I2& yBegin, const Kernel& kernel, Real kernelSupport,
+                         Size bins = 401);
+
+    Real operator()(Real x) const {
+        Real s0, s1, s2;
+        sums(x, s0, s1, s2);
+        return QuantLib::close_enough(s0, 0.0) ? 0.0 : s1 / s0;
+    }
+
+    Real standardDeviation(Real x) const {
+        Real s0, s1, s2;
+        sums(x, s0, s1, s2);
+        // the binning can produce a slightly negative variance when the true variance is zero
+        return QuantLib::close_enough(s0, 0.0) ? 0.0 : std::sqrt(std::max(s2 / s0 - (s1 * s1) / (s0 * s0), 0.0));
+    }
+
+private:
+    // kernel sums of 1, y, y^2 at x
+    void sums(Real x, Real& s0, Real& s1, Real& s2) const {
+        Real pos = (x - gridStart_) / h_;
+        if (pos >= 0.0 && pos <= static_cast<Real>(s_[0].size() - 1)) {
+            Size i = std::min(static_cast<Size>(pos), s_[0].size() - 2);
+            Real w = pos - i;
+            s0 = (1.0 - w) * s_[0][i] + w * s_[0][i + 1];
+            s1 = (1.0 - w) * s_[1][i] + w * s_[1][i + 1];
+            s2 = (1.0 - w) * s_[2][i] + w * s_[2][i + 1];
+        } else {
+            s0 = s1 = s2 = 0.0;
+            for (Size m = 0; m < c_[0].size(); ++m) {
+                Real k = kernel_(x - (xMin_ + m * h_));
+                s0 += c_[0][m] * k;
+                s1 += c_[1][m] * k;
+                s2 += c_[2][m] * k;
+            }
+        }
+    }
+
+    Real xMin_, h_, gridStart_;
+    // binned counts, y and y^2 and the kernel sums of these on the grid
+    std::vector<Real> c_[3], s_[3];
+    std::function<Real(Real)> kernel_;
+};
+
+template <class I1, class I2, class Kernel>
+BinnedNadarayaWatson::BinnedNadarayaWatson(const I1& xBegin, const I1& xEnd, const I2& yBegin, const Kernel& kernel,
+                                           Real kernelSupport, Size bins)
+    : kernel_(kernel) {
+    QL_REQUIRE(xEnd != xBegin, "BinnedNadarayaWatson: no samples given");
+    QL_REQUIRE(bins >= 2, "BinnedNadarayaWatson: at least two bins required, got " << bins);
+    QL_REQUIRE(kernelSupport > 0.0, "BinnedNadarayaWatson: kernel support (" << kernelSupport << ") must be positive");
+    auto range = std::minmax_element(xBegin, xEnd);
+    xMin_ = *range.first;
+    Real xMax = *range.second;
+    // if all x values coincide, a single bin holds all samples, the bin width is then arbitrary
+    if (QuantLib::close_enough(xMin_, xMax))
+        bins = 1;
+    h_ = bins == 1 ? kernelSupport : (xMax - xMin_) / (bins - 1);
+
+    // linear binning
+    for (auto& c : c_)
+        c.resize(bins, 0.0);
+    I2 y = yBegin;
+    for (I1 x = xBegin; x != xEnd; ++x, ++y) {
+        Real pos = bins == 1 ? 0.0 : (*x - xMin_) / h_;
+        Size i = std::min(static_cast<Size>(std::max(pos, 0.0)), bins == 1 ? 0 : bins - 2);
+        Real w = bins == 1 ? 0.0 : std::min(std::max(pos - i, 0.0), 1.0);
+        Real yv = *y;
+        c_[0][i] += 1.0 - w;
+        c_[1][i] += (1.0 - w) * yv;
+        c_[2][i] += (1.0 - w) * yv * yv;
+        if (w > 0.0) {
+            c_[0][i + 1] += w;
+            c_[1][i + 1] += w * yv;
+            c_[2][i + 1] += w * yv * yv;
+        }
+    }
+
+    // discrete convolution on the grid, the kernel values only depend on the distance in bins
+    Size support = static_cast<Size>(std::ceil(kernelSupport / h_));
+    Size extension = std::min(support, bins);
+    Size gridSize = bins + 2 * extension;
+    gridStart_ = xMin_ - extension * h_;
+    Size width = std::min(support, gridSize);
+    std::vector<Real> kernelValues(2 * width + 1);
+    for (Size l = 0; l < kernelValues.size(); ++l)
+        kernelValues[l] = kernel_((static_cast<Real>(l) - static_cast<Real>(width)) * h_);
+    for (auto& s : s_)
+        s.resize(gridSize, 0.0);
+    for (Size m = 0; m < bins; ++m) {
+        if (c_[0][m] == 0.0)
+            continue;
+        // grid point g corresponds to bin g - extension
+        Size g = m + extension;
+        Size from = g >= width ? g - width : 0, to = std::min(g + width, gridSize - 1);
+        for (Size i = from; i <= to; ++i) {
+            Real k = kernelValues[i + width - g];
+            s_[0][i] += c_[0][m] * k;
+            s_[1][i] += c_[1][m] * k;
+            s_[2][i] += c_[2][m] * k;
+        }
+    }
+}
+
 } // namespace QuantExt
 
 #endif
@@ -24,7 +24,15 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <type_traits>
 
 #ifdef ORE_ENABLE_OPENCL
 #ifdef __APPLE__
@@ -39,6 +47,8 @@
 #define MAX_N_NAME 64U
 #define MAX_BUILD_LOG 65536U
 #define MAX_BUILD_LOG_LOGFILE 1024U
+#define MAX_N_CHUNKS std::size_t(4)
+#define MIN_CHUNK_SIZE std::size_t(65536)
 
 namespace QuantExt {
 
@@ -176,11 +186,18 @@ public:
     ~OpenClContext() override final;
     void init() override final;
 
+    void setPrecision(const Precision precision) override final;
+    Precision precision() const override final { return precision_; }
+    bool supportsDoublePrecision() const override final { return supportsDoublePrecision_; }
+    void setProgramCacheDirectory(const std::string& directory) override final { programCacheDirectory_ = directory; }
+
     std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
                                                      const std::size_t version = 0,
                                                      const bool debug = false) override final;
     std::size_t createInputVariable(float v) override final;
     std::size_t createInputVariable(float* v) override final;
+    std::size_t createInputVariable(double v) override final;
+    std::size_t createInputVariable(double* v) override final;
     std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim, const std::size_t steps,
                                                               const std::uint32_t seed) override final;
     std::size_t applyOperation(const std::size_t randomVariableOpCode,
@@ -188,10 +205,17 @@ public:
     void freeVariable(const std::size_t id) override final;
     void declareOutputVariable(const std::size_t id) override final;
     void finalizeCalculation(std::vector<float*>& output) override final;
+    void finalizeCalculation(std::vector<double*>& output) override final;
 
     const DebugInfo& debugInfo() const override final;
 
 private:
+    std::size_t addInputVariable(const bool isScalar, const double value, float* ptr, double* ptrDouble);
+    template <class T> void finalizeCalculationImpl(std::vector<T*>& output);
+    std::string kernelIncludeSource() const;
+    std::string programCacheFile(const std::string& source) const;
+    bool loadCachedProgram(const std::string& source, cl_program& program);
+    void storeCachedProgram(const std::string& source, const cl_program& program) const;
     cl_mem initLinearCongruentialRng(const std::size_t n, std::uint32_t& seedUpdate);
 
     void releaseMem(cl_mem& m);
@@ -203,7 +227,13 @@ private:
     bool initialized_ = false;
     cl_device_id device_;
     cl_context context_;
-    cl_command_queue queue_;
+    // queue_ runs the kernels, inputQueue_ and outputQueue_ copy the data to and from the device
+    cl_command_queue queue_, inputQueue_, outputQueue_;
+    bool supportsDoublePrecision_ = false;
+    Precision precision_ = Precision::Single;
+    // device name, device and driver version, programs are only taken from the cache for the same identifier
+    std::string deviceIdentifier_;
+    std::string programCacheDirectory_;
 
     // will be accumulated over all calcs
     ComputeContext::DebugInfo debugInfo_;
@@ -213,6 +243,7 @@ private:
     std::vector<std::size_t> size_;
     std::vector<bool> hasKernel_;
     std::vector<std::size_t> version_;
+    std::vector<Precision> calcPrecision_;
     std::vector<cl_program> program_;
     std::vector<cl_kernel> kernel_;
     std::vector<std::size_t> inputBufferSize_;
@@ -233,8 +264,9 @@ private:
     // 2a indexed by var id
     std::vector<std::size_t> inputVarOffset_;
     std::vector<bool> inputVarIsScalar_;
-    std::vector<float> inputVarValue_;
+    std::vector<double> inputVarValue_;
     std::vector<float*> inputVarPtr_;
+    std::vector<double*> inputVarPtrDouble_;
 
     // 2b collection of variable ids
     std::vector<std::size_t> freedVariables_;
@@ -274,7 +306,19 @@ OpenClFramework::~OpenClFramework() {
     }
 }
 
-OpenClContext::OpenClContext(cl_device_id device) : initialized_(false), device_(device) {}
+OpenClContext::OpenClContext(cl_device_id device) : initialized_(false), device_(device) {
+    cl_device_fp_config doubleFpConfig;
+    cl_int err =
+        clGetDeviceInfo(device_, CL_DEVICE_DOUBLE_FP_CONFIG, sizeof(cl_device_fp_config), &doubleFpConfig, NULL);
+    supportsDoublePrecision_ = err == CL_SUCCESS && doubleFpConfig != 0;
+    for (auto info : {CL_DEVICE_NAME, CL_DEVICE_VERSION, CL_DRIVER_VERSION}) {
+        char buffer[MAX_N_NAME] = {};
+        clGetDeviceInfo(device_, info, MAX_N_NAME - 1, buffer, NULL);
+        deviceIdentifier_ += std::string(buffer) + "\n";
+    }
+    if (const char* dir = getenv("ORE_OPENCL_PROGRAM_CACHE"))
+        programCacheDirectory_ = dir;
+}
 
 OpenClContext::~OpenClContext() {
     if (initialized_) {
@@ -291,8 +335,10 @@ OpenClContext::~OpenClContext() {
             releaseProgram(p);
         }
 
-        if (err = clReleaseCommandQueue(queue_); err != CL_SUCCESS) {
-            std::cerr << "OpenClContext: error during clReleaseCommandQueue: " + errorText(err) << std::endl;
+        for (auto& q : {queue_, inputQueue_, outputQueue_}) {
+            if (err = clReleaseCommandQueue(q); err != CL_SUCCESS) {
+                std::cerr << "OpenClContext: error during clReleaseCommandQueue: " + errorText(err) << std::endl;
+            }
         }
 
         if (err = clReleaseContext(context_); err != CL_SUCCESS) {
@@ -335,19 +381,27 @@ void OpenClContext::init() {
 
     cl_int err;
 
-    // create context and command queue
+    // create context and command queues
 
     context_ = clCreateContext(NULL, 1, &device_, NULL, NULL, &err);
     QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::OpenClContext(): error during clCreateContext(): " << errorText(err));
 
     // deprecated in open-cl version 2.0, clCreateCommandQueueWithProperties
-    queue_ = clCreateCommandQueue(context_, device_, 0, &err);
-    QL_REQUIRE(err == CL_SUCCESS,
-               "OpenClContext::OpenClContext(): error during clCreateCommandQueue(): " << errorText(err));
+    for (auto q : {&queue_, &inputQueue_, &outputQueue_}) {
+        *q = clCreateCommandQueue(context_, device_, 0, &err);
+        QL_REQUIRE(err == CL_SUCCESS,
+                   "OpenClContext::OpenClContext(): error during clCreateCommandQueue(): " << errorText(err));
+    }
 
     initialized_ = true;
 }
 
+void OpenClContext::setPrecision(const Precision precision) {
+    QL_REQUIRE(precision == Precision::Single || supportsDoublePrecision_,
+               "OpenClContext::setPrecision(): device does not support double precision");
+    precision_ = precision;
+}
+
 cl_mem OpenClContext::initLinearCongruentialRng(const std::size_t n, std::uint32_t& seedUpdate) {
 
     const std::uint32_t a = 1099087573; // same as in the boost compute lg-engine
@@ -385,6 +439,7 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
         size_.push_back(n);
         hasKernel_.push_back(false);
         version_.push_back(version);
+        calcPrecision_.push_back(precision_);
         program_.push_back(cl_program());
         kernel_.push_back(cl_kernel());
         inputBufferSize_.push_back(0);
@@ -406,9 +461,10 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
                                            << size_[id - 1] << ") for id " << id << " does not match current size ("
                                            << n << ")");
 
-        if (version != version_[id - 1]) {
+        if (version != version_[id - 1] || precision_ != calcPrecision_[id - 1]) {
             hasKernel_[id - 1] = false;
             version_[id - 1] = version;
+            calcPrecision_[id - 1] = precision_;
             releaseKernel(kernel_[id - 1]);
             releaseProgram(program_[id - 1]);
             newCalc = true;
@@ -425,6 +481,7 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
     inputVarIsScalar_.clear();
     inputVarValue_.clear();
     inputVarPtr_.clear();
+    inputVarPtrDouble_.clear();
 
     freedVariables_.clear();
     outputVariables_.clear();
@@ -444,7 +501,8 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
     return std::make_pair(currentId_, newCalc);
 }
 
-std::size_t OpenClContext::createInputVariable(float v) {
+std::size_t OpenClContext::addInputVariable(const bool isScalar, const double value, float* ptr,
+                                            double* ptrDouble) {
     QL_REQUIRE(currentState_ == ComputeState::createInput,
                "OpenClContext::createInputVariable(): not in state createInput (" << static_cast<int>(currentState_)
                                                                                   << ")");
@@ -453,26 +511,20 @@ std::size_t OpenClContext::createInputVariable(float v) {
         nextOffset = inputVarOffset_.back() + (inputVarIsScalar_.back() ? 1 : size_[currentId_ - 1]);
     }
     inputVarOffset_.push_back(nextOffset);
-    inputVarIsScalar_.push_back(true);
-    inputVarValue_.push_back(v);
-    inputVarPtr_.push_back(nullptr);
+    inputVarIsScalar_.push_back(isScalar);
+    inputVarValue_.push_back(value);
+    inputVarPtr_.push_back(ptr);
+    inputVarPtrDouble_.push_back(ptrDouble);
     return nVars_++;
 }
 
-std::size_t OpenClContext::createInputVariable(float* v) {
-    QL_REQUIRE(currentState_ == ComputeState::createInput,
-               "OpenClContext::createInputVariable(): not in state createInput (" << static_cast<int>(currentState_)
-                                                                                  << ")");
-    std::size_t nextOffset = 0;
-    if (!inputVarOffset_.empty()) {
-        nextOffset = inputVarOffset_.back() + (inputVarIsScalar_.back() ? 1 : size_[currentId_ - 1]);
-    }
-    inputVarOffset_.push_back(nextOffset);
-    inputVarIsScalar_.push_back(false);
-    inputVarValue_.push_back(0.0f);
-    inputVarPtr_.push_back(v);
-    return nVars_++;
-}
+std::size_t OpenClContext::createInputVariable(float v) { return addInputVariable(true, v, nullptr, nullptr); }
+
+std::size_t OpenClContext::createInputVariable(float* v) { return addInputVariable(false, 0.0, v, nullptr); }
+
+std::size_t OpenClContext::createInputVariable(double v) { return addInputVariable(true, v, nullptr, nullptr); }
+
+std::size_t OpenClContext::createInputVariable(double* v) { return addInputVariable(false, 0.0, nullptr, v); }
 
 std::vector<std::vector<std::size_t>> OpenClContext::createInputVariates(const std::size_t dim, const std::size_t steps,
                                                                          const std::uint32_t seed) {
@@ -533,7 +585,7 @@ std::size_t OpenClContext::applyOperation(const std::size_t randomVariableOpCode
     // generate ssa entry
 
     std::string ssaLine =
-        (resultIdNeedsDeclaration ? "float " : "") + std::string("v") + std::to_string(resultId) + " = ";
+        (resultIdNeedsDeclaration ? "ore_float " : "") + std::string("v") + std::to_string(resultId) + " = ";
 
     switch (randomVariableOpCode) {
     case RandomVariableOpCode::None: {
@@ -639,7 +691,181 @@ void OpenClContext::declareOutputVariable(const std::size_t id) {
     nOutputVars_[currentId_ - 1]++;
 }
 
-void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
+std::string OpenClContext::kernelIncludeSource() const {
+
+    // the source is written in terms of ore_float and ORE_FP(literal), so that it can be compiled in single and
+    // double precision
+
+    std::string fpSource;
+    if (calcPrecision_[currentId_ - 1] == Precision::Single) {
+        fpSource = "typedef float ore_float;\n"
+                   "#define ORE_FP(x) x##f\n"
+                   "#define ORE_EPS FLT_EPSILON\n"
+                   "#define ORE_MAX FLT_MAX\n\n";
+    } else {
+        fpSource = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+                   "typedef double ore_float;\n"
+                   "#define ORE_FP(x) x\n"
+                   "#define ORE_EPS DBL_EPSILON\n"
+                   "#define ORE_MAX DBL_MAX\n\n";
+    }
+
+    return fpSource +
+           "bool ore_closeEnough(const ore_float x, const ore_float y) {\n"
+           "    const ore_float tol = ORE_FP(42.0) * ORE_EPS;\n"
+           "    ore_float diff = fabs(x - y);\n"
+           "    if (x == ORE_FP(0.0) || y == ORE_FP(0.0))\n"
+           "        return diff < tol * tol;\n"
+           "    return diff <= tol * fabs(x) || diff <= tol * fabs(y);\n"
+           "}\n"
+           "\n"
+           "ore_float ore_indicatorEq(const ore_float x, const ore_float y) {\n"
+           "    return ore_closeEnough(x, y) ? ORE_FP(1.0) : ORE_FP(0.0);\n"
+           "}\n\n"
+           "ore_float ore_indicatorGt(const ore_float x, const ore_float y) {\n"
+           "    return x > y && !ore_closeEnough(x, y);\n"
+           "}\n\n"
+           "ore_float ore_indicatorGeq(const ore_float x, const ore_float y) {\n"
+           "    return x > y || ore_closeEnough(x, y);\n"
+           "}\n\n"
+           "ore_float ore_invCumN(const uint x0) {\n"
+           "    const ore_float a1_ = ORE_FP(-3.969683028665376e+01);\n"
+           "    const ore_float a2_ = ORE_FP(2.209460984245205e+02);\n"
+           "    const ore_float a3_ = ORE_FP(-2.759285104469687e+02);\n"
+           "    const ore_float a4_ = ORE_FP(1.383577518672690e+02);\n"
+           "    const ore_float a5_ = ORE_FP(-3.066479806614716e+01);\n"
+           "    const ore_float a6_ = ORE_FP(2.506628277459239e+00);\n"
+           "    const ore_float b1_ = ORE_FP(-5.447609879822406e+01);\n"
+           "    const ore_float b2_ = ORE_FP(1.615858368580409e+02);\n"
+           "    const ore_float b3_ = ORE_FP(-1.556989798598866e+02);\n"
+           "    const ore_float b4_ = ORE_FP(6.680131188771972e+01);\n"
+           "    const ore_float b5_ = ORE_FP(-1.328068155288572e+01);\n"
+           "    const ore_float c1_ = ORE_FP(-7.784894002430293e-03);\n"
+           "    const ore_float c2_ = ORE_FP(-3.223964580411365e-01);\n"
+           "    const ore_float c3_ = ORE_FP(-2.400758277161838e+00);\n"
+           "    const ore_float c4_ = ORE_FP(-2.549732539343734e+00);\n"
+           "    const ore_float c5_ = ORE_FP(4.374664141464968e+00);\n"
+           "    const ore_float c6_ = ORE_FP(2.938163982698783e+00);\n"
+           "    const ore_float d1_ = ORE_FP(7.784695709041462e-03);\n"
+           "    const ore_float d2_ = ORE_FP(3.224671290700398e-01);\n"
+           "    const ore_float d3_ = ORE_FP(2.445134137142996e+00);\n"
+           "    const ore_float d4_ = ORE_FP(3.754408661907416e+00);\n"
+           "    const ore_float x_low_ = ORE_FP(0.02425);\n"
+           "    const ore_float x_high_ = ORE_FP(1.0) - x_low_;\n"
+           "    const ore_float x = x0 / (ore_float)UINT_MAX;\n"
+           "    if (x < x_low_ || x_high_ < x) {\n"
+           "        if (x0 == UINT_MAX) {\n"
+           "          return ORE_MAX;\n"
+           "        } else if(x0 == 0) {\n"
+           "          return -ORE_MAX;\n"
+           "        }\n"
+           "        ore_float z;\n"
+           "        if (x < x_low_) {\n"
+           "            z = sqrt(ORE_FP(-2.0) * log(x));\n"
+           "            z = (((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /\n"
+           "                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + ORE_FP(1.0));\n"
+           "        } else {\n"
+           "            z = sqrt(ORE_FP(-2.0) * log(ORE_FP(1.0) - x));\n"
+           "            z = -(((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /\n"
+           "                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + ORE_FP(1.0));\n"
+           "        }\n"
+           "        return z;\n"
+           "    } else {\n"
+           "        ore_float z = x - ORE_FP(0.5);\n"
+           "        ore_float r = z * z;\n"
+           "        z = (((((a1_ * r + a2_) * r + a3_) * r + a4_) * r + a5_) * r + a6_) * z /\n"
+           "            (((((b1_ * r + b2_) * r + b3_) * r + b4_) * r + b5_) * r + ORE_FP(1.0));\n"
+           "        return z;\n"
+           "    }\n"
+           "}\n\n";
+}
+
+std::string OpenClContext::programCacheFile(const std::string& source) const {
+    // 64 bit FNV-1a hash of the device identifier and the source
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (auto const& str : {deviceIdentifier_, source}) {
+        for (char c : str) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+    }
+    std::ostringstream name;
+    name << programCacheDirectory_ << "/ore_opencl_" << std::hex << std::setw(16) << std::setfill('0') << hash
+         << ".bin";
+    return name.str();
+}
+
+/* The cache file contains the size of the key (device identifier and source), the key and the program binary. The
+   key is compared on loading, so that hash collisions and stale files can not lead to a wrong program. */
+
+bool OpenClContext::loadCachedProgram(const std::string& source, cl_program& program) {
+    if (programCacheDirectory_.empty())
+        return false;
+    std::ifstream file(programCacheFile(source), std::ios::binary);
+    if (!file)
+        return false;
+    const std::string key = deviceIdentifier_ + source;
+    std::uint64_t keySize;
+    if (!file.read(reinterpret_cast<char*>(&keySize), sizeof(keySize)) || keySize != key.size())
+        return false;
+    std::string storedKey(keySize, ' ');
+    if (!file.read(&storedKey[0], keySize) || storedKey != key)
+        return false;
+    std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+        return false;
+    const std::size_t binarySize = binary.size();
+    const unsigned char* binaryPtr = &binary[0];
+    cl_int binaryStatus, err;
+    program = clCreateProgramWithBinary(context_, 1, &device_, &binarySize, &binaryPtr, &binaryStatus, &err);
+    if (err != CL_SUCCESS)
+        return false;
+    if (binaryStatus != CL_SUCCESS || clBuildProgram(program, 1, &device_, NULL, NULL, NULL) != CL_SUCCESS) {
+        releaseProgram(program);
+        return false;
+    }
+    return true;
+}
+
+void OpenClContext::storeCachedProgram(const std::string& source, const cl_program& program) const {
+    if (programCacheDirectory_.empty())
+        return;
+    std::size_t binarySize;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(std::size_t), &binarySize, NULL) != CL_SUCCESS ||
+        binarySize == 0)
+        return;
+    std::vector<unsigned char> binary(binarySize);
+    unsigned char* binaryPtr = &binary[0];
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char*), &binaryPtr, NULL) != CL_SUCCESS)
+        return;
+    // write to a temporary file first, so that concurrent processes never read a partially written file
+    const std::string fileName = programCacheFile(source);
+    const std::string tmpFileName = fileName + "." + std::to_string(std::random_device()()) + ".tmp";
+    const std::string key = deviceIdentifier_ + source;
+    const std::uint64_t keySize = key.size();
+    {
+        std::ofstream file(tmpFileName, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+        file.write(key.data(), key.size());
+        file.write(reinterpret_cast<const char*>(&binary[0]), binary.size());
+        if (!file) {
+            std::cerr << "OpenClContext: could not write program cache file " << tmpFileName << std::endl;
+            file.close();
+            std::remove(tmpFileName.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        std::cerr << "OpenClContext: could not rename " << tmpFileName << " to " << fileName << std::endl;
+        std::remove(tmpFileName.c_str());
+    }
+}
+
+void OpenClContext::finalizeCalculation(std::vector<float*>& output) { finalizeCalculationImpl(output); }
+
+void OpenClContext::finalizeCalculation(std::vector<double*>& output) { finalizeCalculationImpl(output); }
+
+template <class T> void OpenClContext::finalizeCalculationImpl(std::vector<T*>& output) {
     struct exitGuard {
         exitGuard() {}
         ~exitGuard() {
@@ -658,6 +884,12 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
                "OpenClContext::finalizeCalculation(): output size ("
                    << output.size() << ") inconsistent to kernel output size (" << nOutputVars_[currentId_ - 1] << ")");
 
+    const Precision precision = calcPrecision_[currentId_ - 1];
+    const bool doubleInput = precision == Precision::Double;
+    const bool doubleOutput = precision != Precision::Single;
+    const std::size_t inputValueSize = doubleInput ? sizeof(double) : sizeof(float);
+    const std::size_t outputValueSize = doubleOutput ? sizeof(double) : sizeof(float);
+
     boost::timer::cpu_timer timer;
     boost::timer::nanosecond_type timerBase;
 
@@ -673,7 +905,7 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
     cl_int err;
     cl_mem inputBuffer;
     if (inputBufferSize > 0) {
-        inputBuffer = clCreateBuffer(context_, CL_MEM_READ_WRITE, sizeof(float) * inputBufferSize, NULL, &err);
+        inputBuffer = clCreateBuffer(context_, CL_MEM_READ_WRITE, inputValueSize * inputBufferSize, NULL, &err);
         guard.mem.push_back(inputBuffer);
         QL_REQUIRE(err == CL_SUCCESS,
                    "OpenClContext::finalizeCalculation(): creating input buffer fails: " << errorText(err));
@@ -682,7 +914,7 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
     std::size_t outputBufferSize = nOutputVars_[currentId_ - 1] * size_[currentId_ - 1];
     cl_mem outputBuffer;
     if (outputBufferSize > 0) {
-        outputBuffer = clCreateBuffer(context_, CL_MEM_READ_WRITE, sizeof(float) * outputBufferSize, NULL, &err);
+        outputBuffer = clCreateBuffer(context_, CL_MEM_READ_WRITE, outputValueSize * outputBufferSize, NULL, &err);
         guard.mem.push_back(outputBuffer);
         QL_REQUIRE(err == CL_SUCCESS,
                    "OpenClContext::finalizeCalculation(): creating output buffer fails: " << errorText(err));
@@ -696,84 +928,25 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
 
     if (!hasKernel_[currentId_ - 1]) {
 
-        const std::string includeSource =
-            "bool ore_closeEnough(const float x, const float y) {\n"
-            "    const float tol = 42.0f * 1.1920929e-07f;\n"
-            "    float diff = fabs(x - y);\n"
-            "    if (x == 0.0f || y == 0.0f)\n"
-            "        return diff < tol * tol;\n"
-            "    return diff <= tol * fabs(x) || diff <= tol * fabs(y);\n"
-            "}\n"
-            "\n"
-            "float ore_indicatorEq(const float x, const float y) { return ore_closeEnough(x, y) ? 1.0f : 0.0f; }\n\n"
-            "float ore_indicatorGt(const float x, const float y) { return x > y && !ore_closeEnough(x, y); }\n\n"
-            "float ore_indicatorGeq(const float x, const float y) { return x > y || ore_closeEnough(x, y); }\n\n"
-            "float ore_invCumN(const uint x0) {\n"
-            "    const float a1_ = -3.969683028665376e+01f;\n"
-            "    const float a2_ = 2.209460984245205e+02f;\n"
-            "    const float a3_ = -2.759285104469687e+02f;\n"
-            "    const float a4_ = 1.383577518672690e+02f;\n"
-            "    const float a5_ = -3.066479806614716e+01f;\n"
-            "    const float a6_ = 2.506628277459239e+00f;\n"
-            "    const float b1_ = -5.447609879822406e+01f;\n"
-            "    const float b2_ = 1.615858368580409e+02f;\n"
-            "    const float b3_ = -1.556989798598866e+02f;\n"
-            "    const float b4_ = 6.680131188771972e+01f;\n"
-            "    const float b5_ = -1.328068155288572e+01f;\n"
-            "    const float c1_ = -7.784894002430293e-03f;\n"
-            "    const float c2_ = -3.223964580411365e-01f;\n"
-            "    const float c3_ = -2.400758277161838e+00f;\n"
-            "    const float c4_ = -2.549732539343734e+00f;\n"
-            "    const float c5_ = 4.374664141464968e+00f;\n"
-            "    const float c6_ = 2.938163982698783e+00f;\n"
-            "    const float d1_ = 7.784695709041462e-03f;\n"
-            "    const float d2_ = 3.224671290700398e-01f;\n"
-            "    const float d3_ = 2.445134137142996e+00f;\n"
-            "    const float d4_ = 3.754408661907416e+00f;\n"
-            "    const float x_low_ = 0.02425f;\n"
-            "    const float x_high_ = 1.0f - x_low_;\n"
-            "    const float x = x0 / (float)UINT_MAX;\n"
-            "    if (x < x_low_ || x_high_ < x) {\n"
-            "        if (x0 == UINT_MAX) {\n"
-            "          return 0x1.fffffep127f;\n"
-            "        } else if(x0 == 0) {\n"
-            "          return -0x1.fffffep127f;\n"
-            "        }\n"
-            "        float z;\n"
-            "        if (x < x_low_) {\n"
-            "            z = sqrt(-2.0f * log(x));\n"
-            "            z = (((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /\n"
-            "                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + 1.0f);\n"
-            "        } else {\n"
-            "            z = sqrt(-2.0f * log(1.0f - x));\n"
-            "            z = -(((((c1_ * z + c2_) * z + c3_) * z + c4_) * z + c5_) * z + c6_) /\n"
-            "                ((((d1_ * z + d2_) * z + d3_) * z + d4_) * z + 1.0f);\n"
-            "        }\n"
-            "        return z;\n"
-            "    } else {\n"
-            "        float z = x - 0.5f;\n"
-            "        float r = z * z;\n"
-            "        z = (((((a1_ * r + a2_) * r + a3_) * r + a4_) * r + a5_) * r + a6_) * z /\n"
-            "            (((((b1_ * r + b2_) * r + b3_) * r + b4_) * r + b5_) * r + 1.0f);\n"
-            "        return z;\n"
-            "    }\n"
-            "}\n\n";
-
         std::string kernelName =
             "ore_kernel_" + std::to_string(currentId_) + "_" + std::to_string(version_[currentId_ - 1]);
 
-        std::string kernelSource = includeSource + "__kernel void " + kernelName +
+        std::string kernelSource = kernelIncludeSource() + "__kernel void " + kernelName +
                                    "(\n"
                                    "   __global uint* lcrng_mult" +
-                                   (inputBufferSize > 0 ? ",\n   __global float* input" : "") +
-                                   (outputBufferSize > 0 ? ",\n   __global float* output" : "") +
+                                   (inputBufferSize > 0 ? std::string(",\n   __global ") +
+                                                              (doubleInput ? "double" : "float") + "* input"
+                                                        : std::string()) +
+                                   (outputBufferSize > 0 ? std::string(",\n   __global ") +
+                                                               (doubleOutput ? "double" : "float") + "* output"
+                                                         : std::string()) +
                                    ") {\n"
                                    "unsigned int i = get_global_id(0);\n"
                                    "if(i < " +
                                    std::to_string(size_[currentId_ - 1]) + "U) {\n";
 
         for (std::size_t i = 0; i < variateSeed_.size(); ++i) {
-            kernelSource += "  float v" + std::to_string(i + inputVarOffset_.size()) + " = ore_invCumN(" +
+            kernelSource += "  ore_float v" + std::to_string(i + inputVarOffset_.size()) + " = ore_invCumN(" +
                             std::to_string(variateSeed_[i]) + "U * lcrng_mult[i]);\n";
             if (debug_)
                 debugInfo_.numberOfOperations += 23 * size_[currentId_ - 1];
@@ -798,18 +971,22 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
         }
 
         cl_int err;
-        const char* kernelSourcePtr = kernelSource.c_str();
-        program_[currentId_ - 1] = clCreateProgramWithSource(context_, 1, &kernelSourcePtr, NULL, &err);
-        QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): error during clCreateProgramWithSource(): "
-                                          << errorText(err));
-        err = clBuildProgram(program_[currentId_ - 1], 1, &device_, NULL, NULL, NULL);
-        if (err != CL_SUCCESS) {
-            char buffer[MAX_BUILD_LOG];
-            clGetProgramBuildInfo(program_[currentId_ - 1], device_, CL_PROGRAM_BUILD_LOG, MAX_BUILD_LOG * sizeof(char),
-                                  buffer, NULL);
-            QL_FAIL("OpenClContext::finalizeCalculation(): error during program build for kernel '"
-                    << kernelName << "': " << errorText(err) << ": "
-                    << std::string(buffer).substr(MAX_BUILD_LOG_LOGFILE));
+        if (!loadCachedProgram(kernelSource, program_[currentId_ - 1])) {
+            const char* kernelSourcePtr = kernelSource.c_str();
+            program_[currentId_ - 1] = clCreateProgramWithSource(context_, 1, &kernelSourcePtr, NULL, &err);
+            QL_REQUIRE(err == CL_SUCCESS,
+                       "OpenClContext::finalizeCalculation(): error during clCreateProgramWithSource(): "
+                           << errorText(err));
+            err = clBuildProgram(program_[currentId_ - 1], 1, &device_, NULL, NULL, NULL);
+            if (err != CL_SUCCESS) {
+                char buffer[MAX_BUILD_LOG];
+                clGetProgramBuildInfo(program_[currentId_ - 1], device_, CL_PROGRAM_BUILD_LOG,
+                                      MAX_BUILD_LOG * sizeof(char), buffer, NULL);
+                QL_FAIL("OpenClContext::finalizeCalculation(): error during program build for kernel '"
+                        << kernelName << "': " << errorText(err) << ": "
+                        << std::string(buffer).substr(MAX_BUILD_LOG_LOGFILE));
+            }
+            storeCachedProgram(kernelSource, program_[currentId_ - 1]);
         }
         kernel_[currentId_ - 1] = clCreateKernel(program_[currentId_ - 1], kernelName.c_str(), &err);
         QL_REQUIRE(err == CL_SUCCESS,
@@ -828,27 +1005,86 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
                        << inputBufferSize_[currentId_ - 1] << ")");
     }
 
-    // write input data to input buffer (asynchronously)
+    // the paths are processed in chunks: the input data of a chunk is written on the input queue, the kernel runs
+    // on the compute queue and the results are read on the output queue, the chunks are linked by events, so that
+    // the data transfers of one chunk overlap with the kernel execution of the others; in debug mode we use a single
+    // chunk, so that the timings of the phases are not mixed up
+
+    const std::size_t n = size_[currentId_ - 1];
+    const std::size_t nChunks = debug_ ? 1 : std::max<std::size_t>(1, std::min(MAX_N_CHUNKS, n / MIN_CHUNK_SIZE));
+    std::vector<std::size_t> chunkBegin(nChunks + 1);
+    for (std::size_t c = 0; c <= nChunks; ++c)
+        chunkBegin[c] = c * n / nChunks;
+
+    struct eventGuard {
+        ~eventGuard() {
+            for (auto& v : events)
+                for (auto& e : v)
+                    clReleaseEvent(e);
+        }
+        // scalar inputs, inputs per chunk, kernels per chunk, outputs per chunk
+        std::vector<std::vector<cl_event>> events;
+    } events;
+    events.events.resize(1 + 3 * nChunks);
+    std::vector<cl_event>& scalarInputEvents = events.events[0];
+    auto inputEvents = [&events](const std::size_t c) -> std::vector<cl_event>& { return events.events[1 + c]; };
+    auto kernelEvents = [&events, nChunks](const std::size_t c) -> std::vector<cl_event>& {
+        return events.events[1 + nChunks + c];
+    };
+    auto outputEvents = [&events, nChunks](const std::size_t c) -> std::vector<cl_event>& {
+        return events.events[1 + 2 * nChunks + c];
+    };
+
+    // write input data to input buffer (asynchronously), inputs of the wrong type are converted into
+    // staging buffers, which must stay alive until the kernel has finished
 
     if (debug_) {
         timerBase = timer.elapsed().wall;
     }
 
-    std::vector<cl_event> inputBufferEvents;
+    std::vector<float> scalarValues(inputVarOffset_.size());
+    std::vector<double> scalarValuesDouble(inputVarOffset_.size());
+    std::vector<std::vector<float>> stagingValues;
+    std::vector<std::vector<double>> stagingValuesDouble;
+    stagingValues.reserve(inputVarOffset_.size());
+    stagingValuesDouble.reserve(inputVarOffset_.size());
     if (inputBufferSize > 0) {
         for (std::size_t i = 0; i < inputVarOffset_.size(); ++i) {
-            inputBufferEvents.push_back(cl_event());
-            err = clEnqueueWriteBuffer(queue_, inputBuffer, CL_FALSE, sizeof(float) * inputVarOffset_[i],
-                                       sizeof(float) * (inputVarIsScalar_[i] ? 1 : size_[currentId_ - 1]),
-                                       inputVarIsScalar_[i] ? &inputVarValue_[i] : inputVarPtr_[i], 0, NULL,
-                                       &inputBufferEvents.back());
-            QL_REQUIRE(err == CL_SUCCESS,
-                       "OpenClContext::finalizeCalculation(): writing to input buffer fails: " << errorText(err));
+            const char* src;
+            if (inputVarIsScalar_[i]) {
+                scalarValues[i] = static_cast<float>(inputVarValue_[i]);
+                scalarValuesDouble[i] = inputVarValue_[i];
+                src = doubleInput ? reinterpret_cast<const char*>(&scalarValuesDouble[i])
+                                  : reinterpret_cast<const char*>(&scalarValues[i]);
+            } else if (doubleInput && inputVarPtrDouble_[i] == nullptr) {
+                stagingValuesDouble.push_back(std::vector<double>(inputVarPtr_[i], inputVarPtr_[i] + n));
+                src = reinterpret_cast<const char*>(&stagingValuesDouble.back()[0]);
+            } else if (!doubleInput && inputVarPtr_[i] == nullptr) {
+                stagingValues.push_back(std::vector<float>(inputVarPtrDouble_[i], inputVarPtrDouble_[i] + n));
+                src = reinterpret_cast<const char*>(&stagingValues.back()[0]);
+            } else {
+                src = doubleInput ? reinterpret_cast<const char*>(inputVarPtrDouble_[i])
+                                  : reinterpret_cast<const char*>(inputVarPtr_[i]);
+            }
+            for (std::size_t c = 0; c < (inputVarIsScalar_[i] ? 1 : nChunks); ++c) {
+                const std::size_t offset = inputVarIsScalar_[i] ? 0 : chunkBegin[c];
+                const std::size_t size = inputVarIsScalar_[i] ? 1 : chunkBegin[c + 1] - chunkBegin[c];
+                auto& ev = inputVarIsScalar_[i] ? scalarInputEvents : inputEvents(c);
+                ev.push_back(cl_event());
+                err = clEnqueueWriteBuffer(inputQueue_, inputBuffer, CL_FALSE,
+                                           inputValueSize * (inputVarOffset_[i] + offset), inputValueSize * size,
+                                           src + inputValueSize * offset, 0, NULL, &ev.back());
+                QL_REQUIRE(err == CL_SUCCESS,
+                           "OpenClContext::finalizeCalculation(): writing to input buffer fails: " << errorText(err));
+            }
         }
     }
 
+    err = clFlush(inputQueue_);
+    QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): flush input queue fails: " << errorText(err));
+
     if (debug_) {
-        err = clFinish(queue_);
+        err = clFinish(inputQueue_);
         QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::clFinish(): error in debug mode: " << errorText(err));
         debugInfo_.nanoSecondsDataCopy += timer.elapsed().wall - timerBase;
     }
@@ -856,8 +1092,7 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
     // set kernel args
 
     std::size_t kidx = 0;
-    err = clSetKernelArg(kernel_[currentId_ - 1], kidx++, sizeof(cl_mem),
-                         &linearCongruentialMultipliers_.at(size_[currentId_ - 1]));
+    err = clSetKernelArg(kernel_[currentId_ - 1], kidx++, sizeof(cl_mem), &linearCongruentialMultipliers_.at(n));
     if (inputBufferSize > 0) {
         err |= clSetKernelArg(kernel_[currentId_ - 1], kidx++, sizeof(cl_mem), &inputBuffer);
     }
@@ -866,17 +1101,26 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
     }
     QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): set kernel args fails: " << errorText(err));
 
-    // execute kernel
+    // execute kernel, the kernel for a chunk waits for the scalar inputs and the inputs of the chunk
 
     if (debug_) {
         timerBase = timer.elapsed().wall;
     }
 
-    cl_event runEvent;
-    err = clEnqueueNDRangeKernel(queue_, kernel_[currentId_ - 1], 1, NULL, &size_[currentId_ - 1], NULL,
-                                 inputBufferEvents.size(), inputBufferEvents.empty() ? nullptr : &inputBufferEvents[0],
-                                 &runEvent);
-    QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): enqueue kernel fails: " << errorText(err));
+    for (std::size_t c = 0; c < nChunks; ++c) {
+        std::vector<cl_event> waitList(scalarInputEvents);
+        waitList.insert(waitList.end(), inputEvents(c).begin(), inputEvents(c).end());
+        const std::size_t globalOffset = chunkBegin[c], globalSize = chunkBegin[c + 1] - chunkBegin[c];
+        kernelEvents(c).push_back(cl_event());
+        err = clEnqueueNDRangeKernel(queue_, kernel_[currentId_ - 1], 1, &globalOffset, &globalSize, NULL,
+                                     waitList.size(), waitList.empty() ? nullptr : &waitList[0],
+                                     &kernelEvents(c).back());
+        QL_REQUIRE(err == CL_SUCCESS,
+                   "OpenClContext::finalizeCalculation(): enqueue kernel fails: " << errorText(err));
+    }
+
+    err = clFlush(queue_);
+    QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): flush queue fails: " << errorText(err));
 
     if (debug_) {
         err = clFinish(queue_);
@@ -884,31 +1128,57 @@ void OpenClContext::finalizeCalculation(std::vector<float*>& output) {
         debugInfo_.nanoSecondsCalculation += timer.elapsed().wall - timerBase;
     }
 
-    // copy the results (asynchronously)
+    // copy the results (asynchronously), if the output type differs from the kernel output type, we read
+    // into staging buffers and convert the values afterwards
 
     if (debug_) {
         timerBase = timer.elapsed().wall;
     }
 
-    std::vector<cl_event> outputBufferEvents;
+    const bool convertOutput = doubleOutput != std::is_same<T, double>::value;
+    std::vector<std::vector<char>> outputStaging(convertOutput ? output.size() : 0);
+    std::vector<cl_event> waitList;
     if (outputBufferSize > 0) {
         for (std::size_t i = 0; i < output.size(); ++i) {
-            outputBufferEvents.push_back(cl_event());
-            err = clEnqueueReadBuffer(queue_, outputBuffer, CL_FALSE, i * size_[currentId_ - 1],
-                                      sizeof(float) * size_[currentId_ - 1], output[i], 1, &runEvent,
-                                      &outputBufferEvents.back());
-            QL_REQUIRE(err == CL_SUCCESS,
-                       "OpenClContext::finalizeCalculation(): writing to output buffer fails: " << errorText(err));
+            if (convertOutput)
+                outputStaging[i].resize(outputValueSize * n);
+        }
+        for (std::size_t c = 0; c < nChunks; ++c) {
+            for (std::size_t i = 0; i < output.size(); ++i) {
+                char* dst = convertOutput ? &outputStaging[i][0] : reinterpret_cast<char*>(output[i]);
+                outputEvents(c).push_back(cl_event());
+                err = clEnqueueReadBuffer(outputQueue_, outputBuffer, CL_FALSE,
+                                          outputValueSize * (i * n + chunkBegin[c]),
+                                          outputValueSize * (chunkBegin[c + 1] - chunkBegin[c]),
+                                          dst + outputValueSize * chunkBegin[c], 1, &kernelEvents(c).back(),
+                                          &outputEvents(c).back());
+                QL_REQUIRE(err == CL_SUCCESS,
+                           "OpenClContext::finalizeCalculation(): writing to output buffer fails: " << errorText(err));
+            }
+            waitList.insert(waitList.end(), outputEvents(c).begin(), outputEvents(c).end());
+        }
+    } else {
+        for (std::size_t c = 0; c < nChunks; ++c)
+            waitList.push_back(kernelEvents(c).back());
+    }
+
+    err = clWaitForEvents(waitList.size(), waitList.empty() ? nullptr : &waitList[0]);
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::finalizeCalculation(): wait for output buffer events to finish fails: " << errorText(err));
+
+    if (convertOutput) {
+        for (std::size_t i = 0; i < output.size(); ++i) {
+            if (doubleOutput) {
+                const double* src = reinterpret_cast<const double*>(&outputStaging[i][0]);
+                std::copy(src, src + n, output[i]);
+            } else {
+                const float* src = reinterpret_cast<const float*>(&outputStaging[i][0]);
+                std::copy(src, src + n, output[i]);
+            }
         }
-        err = clWaitForEvents(outputBufferEvents.size(), outputBufferEvents.empty() ? nullptr : &outputBufferEvents[0]);
-        QL_REQUIRE(
-            err == CL_SUCCESS,
-            "OpenClContext::finalizeCalculation(): wait for output buffer events to finish fails: " << errorText(err));
     }
 
     if (debug_) {
-        err = clFinish(queue_);
-        QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::clFinish(): error in debug mode: " << errorText(err));
         debugInfo_.nanoSecondsDataCopy += timer.elapsed().wall - timerBase;
     }
 }
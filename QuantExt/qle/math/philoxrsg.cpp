@@ -0,0 +1,86 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/math/philoxrsg.hpp>
+
+#include <ql/errors.hpp>
+
+namespace QuantExt {
+
+namespace {
+const std::uint32_t philoxM0 = 0xD2511F53;
+const std::uint32_t philoxM1 = 0xCD9E8D57;
+const std::uint32_t philoxW0 = 0x9E3779B9;
+const std::uint32_t philoxW1 = 0xBB67AE85;
+
+// Philox4x32 with 10 rounds, maps the counter c to four random 32 bit numbers in place
+void philox4x32(std::uint32_t c[4], std::uint32_t k0, std::uint32_t k1) {
+    for (Size r = 0; r < 10; ++r) {
+        if (r > 0) {
+            k0 += philoxW0;
+            k1 += philoxW1;
+        }
+        std::uint64_t p0 = static_cast<std::uint64_t>(philoxM0) * c[0];
+        std::uint64_t p1 = static_cast<std::uint64_t>(philoxM1) * c[2];
+        std::uint32_t hi0 = static_cast<std::uint32_t>(p0 >> 32), lo0 = static_cast<std::uint32_t>(p0);
+        std::uint32_t hi1 = static_cast<std::uint32_t>(p1 >> 32), lo1 = static_cast<std::uint32_t>(p1);
+        c[0] = hi1 ^ c[1] ^ k0;
+        c[1] = lo1;
+        c[2] = hi0 ^ c[3] ^ k1;
+        c[3] = lo0;
+    }
+}
+
+// counter for the block of components [4 * block, 4 * block + 4) of the n-th sequence
+void setCounter(std::uint32_t c[4], Size n, Size block) {
+    c[0] = static_cast<std::uint32_t>(block);
+    c[1] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(block) >> 32);
+    c[2] = static_cast<std::uint32_t>(n);
+    c[3] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(n) >> 32);
+}
+
+// map to (0,1), excluding the end points as required by the inverse cumulative normal
+inline Real toUniform(std::uint32_t x) { return (static_cast<Real>(x) + 0.5) / 4294967296.0; }
+} // namespace
+
+PhiloxRsg::PhiloxRsg(Size dimensionality, BigNatural seed)
+    : dimensionality_(dimensionality), counter_(0), sequence_(std::vector<Real>(dimensionality), 1.0) {
+    QL_REQUIRE(dimensionality > 0, "PhiloxRsg: dimensionality must be greater than zero");
+    key_[0] = static_cast<std::uint32_t>(seed);
+    key_[1] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(seed) >> 32);
+}
+
+const PhiloxRsg::sample_type& PhiloxRsg::nextSequence() const {
+    std::uint32_t c[4];
+    for (Size b = 0; 4 * b < dimensionality_; ++b) {
+        setCounter(c, counter_, b);
+        philox4x32(c, key_[0], key_[1]);
+        for (Size j = 0; j < 4 && 4 * b + j < dimensionality_; ++j)
+            sequence_.value[4 * b + j] = toUniform(c[j]);
+    }
+    ++counter_;
+    return sequence_;
+}
+
+Real PhiloxRsg::uniform(BigNatural seed, Size n, Size i) {
+    std::uint32_t c[4];
+    setCounter(c, n, i / 4);
+    philox4x32(c, static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(static_cast<std::uint64_t>(seed) >> 32));
+    return toUniform(c[i % 4]);
+}
+
+} // namespace QuantExt
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/math/philoxrsg.hpp
+    \brief counter based uniform random sequence generator
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/methods/montecarlo/sample.hpp>
+#include <ql/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace QuantExt {
+using QuantLib::BigNatural;
+using QuantLib::Real;
+using QuantLib::Sample;
+using QuantLib::Size;
+
+//! Uniform random sequence generator based on the Philox4x32-10 counter based generator
+/*! The i-th component of the n-th sequence is a pure function of (seed, n, i), see Salmon et al., Parallel random
+    numbers: as easy as 1, 2, 3, SC11. Skipping to an arbitrary sequence is therefore O(1) and independent streams of
+    sequences can be generated on several threads without coordination, each thread owning its generator instance.
+
+    The interface is the same as for the QuantLib uniform sequence generators, so that the generator can be used
+    with InverseCumulativeRsg.
+
+    \ingroup math
+*/
+class PhiloxRsg {
+public:
+    typedef Sample<std::vector<Real>> sample_type;
+
+    explicit PhiloxRsg(Size dimensionality, BigNatural seed = 0);
+
+    const sample_type& nextSequence() const;
+    const sample_type& lastSequence() const { return sequence_; }
+    Size dimension() const { return dimensionality_; }
+
+    //! the next call to nextSequence() returns the sequence with index n, the first sequence has index 0
+    void skipTo(Size n) const { counter_ = n; }
+
+    //! the i-th component of the n-th sequence for the given seed, a number in (0,1)
+    static Real uniform(BigNatural seed, Size n, Size i);
+
+private:
+    Size dimensionality_;
+    std::uint32_t key_[2];
+    mutable Size counter_;
+    mutable sample_type sequence_;
+};
+
+} // namespace QuantExt
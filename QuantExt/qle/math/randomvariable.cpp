@@ -21,11 +21,27 @@
 #include <ql/math/comparison.hpp>
 #include <ql/math/generallinearleastsquares.hpp>
 #include <ql/math/matrixutilities/qrdecomposition.hpp>
+#include <ql/math/matrixutilities/svd.hpp>
 
-#include <boost/math/distributions/normal.hpp>
+#include <bitset>
 
 namespace QuantExt {
 
+namespace {
+Size words(const Size n) { return (n + 63) / 64; }
+
+// filter with value pred(i) at position i, the bits are written word wise
+template <class P> Filter makeFilter(const Size n, const P& pred) {
+    Filter result(n, false);
+    result.expand();
+    std::uint64_t* w = result.data();
+    for (Size i = 0; i < n; ++i)
+        w[i >> 6] |= std::uint64_t(pred(i) ? 1 : 0) << (i & 63);
+    result.updateDeterministic();
+    return result;
+}
+} // namespace
+
 void Filter::clear() {
     n_ = 0;
     data_.clear();
@@ -33,57 +49,73 @@ void Filter::clear() {
     deterministic_ = false;
 }
 
+void Filter::clearTail() {
+    if (!deterministic_ && n_ % 64 != 0)
+        data_.back() &= (std::uint64_t(1) << (n_ % 64)) - 1;
+}
+
 void Filter::updateDeterministic() {
     if (deterministic_ || !initialised())
         return;
-    for (Size i = 1; i < n_; ++i) {
-        if (data_[i] != data_.front())
-            return;
-    }
-    setAll(data_.front());
+    Size c = count();
+    if (c == 0 || c == n_)
+        setAll(c != 0);
 }
 
 void Filter::set(const Size i, const bool v) {
     QL_REQUIRE(i < n_, "Filter::set(" << i << "): out of bounds, size is " << n_);
     if (deterministic_) {
-        if (v != data_.front())
+        if (v != (data_.front() != 0))
             expand();
         else
             return;
     }
-    data_[i] = v;
+    const std::uint64_t bit = std::uint64_t(1) << (i & 63);
+    if (v)
+        data_[i >> 6] |= bit;
+    else
+        data_[i >> 6] &= ~bit;
 }
 
 void Filter::setAll(const bool v) {
-    data_ = std::vector<bool>(1, v);
+    data_.assign(1, v ? ~std::uint64_t(0) : 0);
     deterministic_ = true;
 }
 
-bool Filter::operator[](const Size i) const {
-    if (deterministic_)
-        return data_.front();
-    else
-        return data_[i];
-}
-
 bool Filter::at(const Size i) const {
     QL_REQUIRE(n_ > 0, "Filter::at(" << i << "): dimension is zero");
     if (deterministic_)
-        return data_.front();
+        return data_.front() != 0;
     QL_REQUIRE(i < n_, "Filter::at(" << i << "): out of bounds, size is " << n_);
     return operator[](i);
 }
 
+Size Filter::count() const {
+    if (!initialised())
+        return 0;
+    if (deterministic_)
+        return data_.front() != 0 ? n_ : 0;
+    Size c = 0;
+    for (auto const w : data_)
+        c += std::bitset<64>(w).count();
+    return c;
+}
+
 void Filter::expand() {
     if (!deterministic_)
         return;
     deterministic_ = false;
-    data_.resize(size(), data_.front());
+    data_.resize(words(size()), data_.front());
+    clearTail();
 }
 
 bool operator==(const Filter& a, const Filter& b) {
     if (a.size() != b.size())
         return false;
+    if (a.deterministic_ && b.deterministic_)
+        return a.size() == 0 || a.data_.front() == b.data_.front();
+    if (!a.deterministic_ && !b.deterministic_)
+        return a.data_ == b.data_;
     for (Size j = 0; j < a.size(); ++j)
         if (a[j] != b[j])
             return false;
@@ -106,7 +138,7 @@ Filter operator&&(Filter x, const Filter& y) {
     else
         return Filter(x.size(), false);
     for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = x.data_[i] && y[i];
+        x.data_[i] &= y.data_[i];
     }
     return x;
 }
@@ -127,7 +159,7 @@ Filter operator||(Filter x, const Filter& y) {
     else
         return Filter(x.size(), true);
     for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = x.data_[i] || y[i];
+        x.data_[i] |= y.data_[i];
     }
     return x;
 }
@@ -140,15 +172,17 @@ Filter equal(Filter x, const Filter& y) {
     if (!y.deterministic_)
         x.expand();
     for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = x.data_[i] == y[i];
+        x.data_[i] = ~(x.data_[i] ^ (y.deterministic_ ? y.data_.front() : y.data_[i]));
     }
+    x.clearTail();
     return x;
 }
 
 Filter operator!(Filter x) {
     for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = !x.data_[i];
+        x.data_[i] = ~x.data_[i];
     }
+    x.clearTail();
     return x;
 }
 
@@ -162,9 +196,8 @@ RandomVariable::RandomVariable(const Filter& f, const Real valueTrue, const Real
         setAll(f.at(0) ? valueTrue : valueFalse);
     else {
         deterministic_ = false;
-        data_.resize(n_);
-        for (Size i = 0; i < n_; ++i)
-            set(i, f[i] ? valueTrue : valueFalse);
+        data_.assign(n_, valueTrue);
+        RandomVariableKernels::blend(data_.data(), valueFalse, f.data(), n_);
     }
     time_ = time;
 }
@@ -173,7 +206,7 @@ RandomVariable::RandomVariable(const QuantLib::Array& array, const Real time) {
     n_ = array.size();
     deterministic_ = false;
     time_ = time;
-    data_ = std::vector<Real>(array.begin(), array.end());
+    data_.assign(array.begin(), array.end());
 }
 
 void RandomVariable::copyToMatrixCol(QuantLib::Matrix& m, const Size j) const {
@@ -220,7 +253,7 @@ void RandomVariable::set(const Size i, const Real v) {
 }
 
 void RandomVariable::setAll(const Real v) {
-    data_ = std::vector<Real>(1, v);
+    data_.assign(1, v);
     deterministic_ = true;
 }
 
@@ -296,9 +329,10 @@ RandomVariable& RandomVariable::operator+=(const RandomVariable& y) {
         expand();
     else if (QuantLib::close_enough(y.data_.front(), 0.0))
         return *this;
-    for (Size i = 0; i < data_.size(); ++i) {
-        data_[i] += y[i];
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::add(data_.data(), y.data_.front(), data_.size());
+    else
+        RandomVariableKernels::add(data_.data(), y.data_.data(), data_.size());
     return *this;
 }
 
@@ -314,9 +348,10 @@ RandomVariable& RandomVariable::operator-=(const RandomVariable& y) {
         expand();
     else if (QuantLib::close_enough(y.data_.front(), 0.0))
         return *this;
-    for (Size i = 0; i < data_.size(); ++i) {
-        data_[i] -= y[i];
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::add(data_.data(), -y.data_.front(), data_.size());
+    else
+        RandomVariableKernels::subtract(data_.data(), y.data_.data(), data_.size());
     return *this;
 }
 
@@ -332,9 +367,10 @@ RandomVariable& RandomVariable::operator*=(const RandomVariable& y) {
         expand();
     else if (QuantLib::close_enough(y.data_.front(), 1.0))
         return *this;
-    for (Size i = 0; i < data_.size(); ++i) {
-        data_[i] *= y[i];
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::multiply(data_.data(), y.data_.front(), data_.size());
+    else
+        RandomVariableKernels::multiply(data_.data(), y.data_.data(), data_.size());
     return *this;
 }
 
@@ -350,9 +386,10 @@ RandomVariable& RandomVariable::operator/=(const RandomVariable& y) {
         expand();
     else if (QuantLib::close_enough(y.data_.front(), 1.0))
         return *this;
-    for (Size i = 0; i < data_.size(); ++i) {
-        data_[i] /= y[i];
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::divide(data_.data(), y.data_.front(), data_.size());
+    else
+        RandomVariableKernels::divide(data_.data(), y.data_.data(), data_.size());
     return *this;
 }
 
@@ -392,9 +429,10 @@ RandomVariable max(RandomVariable x, const RandomVariable& y) {
     x.checkTimeConsistencyAndUpdate(y.time());
     if (!y.deterministic_)
         x.expand();
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::max(x.data_[i], y[i]);
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::max(x.data_.data(), y.data_.front(), x.data_.size());
+    else
+        RandomVariableKernels::max(x.data_.data(), y.data_.data(), x.data_.size());
     return x;
 }
 
@@ -406,9 +444,10 @@ RandomVariable min(RandomVariable x, const RandomVariable& y) {
     x.checkTimeConsistencyAndUpdate(y.time());
     if (!y.deterministic_)
         x.expand();
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::min(x.data_[i], y[i]);
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::min(x.data_.data(), y.data_.front(), x.data_.size());
+    else
+        RandomVariableKernels::min(x.data_.data(), y.data_.data(), x.data_.size());
     return x;
 }
 
@@ -429,37 +468,27 @@ RandomVariable pow(RandomVariable x, const RandomVariable& y) {
 }
 
 RandomVariable operator-(RandomVariable x) {
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = -x.data_[i];
-    }
+    RandomVariableKernels::negate(x.data_.data(), x.data_.size());
     return x;
 }
 
 RandomVariable abs(RandomVariable x) {
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::abs(-x.data_[i]);
-    }
+    RandomVariableKernels::abs(x.data_.data(), x.data_.size());
     return x;
 }
 
 RandomVariable exp(RandomVariable x) {
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::exp(x.data_[i]);
-    }
+    RandomVariableKernels::exp(x.data_.data(), x.data_.size());
     return x;
 }
 
 RandomVariable log(RandomVariable x) {
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::log(x.data_[i]);
-    }
+    RandomVariableKernels::log(x.data_.data(), x.data_.size());
     return x;
 }
 
 RandomVariable sqrt(RandomVariable x) {
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = std::sqrt(x.data_[i]);
-    }
+    RandomVariableKernels::sqrt(x.data_.data(), x.data_.size());
     return x;
 }
 
@@ -478,18 +507,12 @@ RandomVariable cos(RandomVariable x) {
 }
 
 RandomVariable normalCdf(RandomVariable x) {
-    static const boost::math::normal_distribution<double> n;
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = boost::math::cdf(n, x.data_[i]);
-    }
+    RandomVariableKernels::normalCdf(x.data_.data(), x.data_.size());
     return x;
 }
 
 RandomVariable normalPdf(RandomVariable x) {
-    static const boost::math::normal_distribution<double> n;
-    for (Size i = 0; i < x.data_.size(); ++i) {
-        x.data_[i] = boost::math::pdf(n, x.data_[i]);
-    }
+    RandomVariableKernels::normalPdf(x.data_.data(), x.data_.size());
     return x;
 }
 
@@ -502,11 +525,7 @@ Filter close_enough(const RandomVariable& x, const RandomVariable& y) {
     if (x.deterministic_ && y.deterministic_) {
         return Filter(x.size(), QuantLib::close_enough(x.data_.front(), y.data_.front()));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, QuantLib::close_enough(x[i], y[i]));
-    }
-    return result;
+    return makeFilter(x.size(), [&x, &y](const Size i) { return QuantLib::close_enough(x[i], y[i]); });
 }
 
 bool close_enough_all(const RandomVariable& x, const RandomVariable& y) {
@@ -534,10 +553,10 @@ RandomVariable conditionalResult(const Filter& f, RandomVariable x, const Random
     if (f.deterministic())
         return f.at(0) ? x : y;
     x.expand();
-    for (Size i = 0; i < f.size(); ++i) {
-        if (!f[i])
-            x.set(i, y[i]);
-    }
+    if (y.deterministic_)
+        RandomVariableKernels::blend(x.data_.data(), y.data_.front(), f.data(), f.size());
+    else
+        RandomVariableKernels::blend(x.data_.data(), y.data_.data(), f.data(), f.size());
     return x;
 }
 
@@ -593,11 +612,8 @@ Filter operator<(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(),
                       x.data_.front() < y.data_.front() && !QuantLib::close_enough(x.data_.front(), y.data_.front()));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] < y[i] && !QuantLib::close_enough(x[i], y[i]));
-    }
-    return result;
+    return makeFilter(x.size(),
+                      [&x, &y](const Size i) { return x[i] < y[i] && !QuantLib::close_enough(x[i], y[i]); });
 }
 
 Filter operator<=(const RandomVariable& x, const RandomVariable& y) {
@@ -610,11 +626,8 @@ Filter operator<=(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(),
                       x.data_.front() < y.data_.front() || QuantLib::close_enough(x.data_.front(), y.data_.front()));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] < y[i] || QuantLib::close_enough(x[i], y[i]));
-    }
-    return result;
+    return makeFilter(x.size(),
+                      [&x, &y](const Size i) { return x[i] < y[i] || QuantLib::close_enough(x[i], y[i]); });
 }
 
 Filter operator>(const RandomVariable& x, const RandomVariable& y) {
@@ -627,11 +640,8 @@ Filter operator>(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(),
                       x.data_.front() > y.data_.front() && !QuantLib::close_enough(x.data_.front(), y.data_.front()));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] > y[i] && !QuantLib::close_enough(x[i], y[i]));
-    }
-    return result;
+    return makeFilter(x.size(),
+                      [&x, &y](const Size i) { return x[i] > y[i] && !QuantLib::close_enough(x[i], y[i]); });
 }
 
 Filter operator>=(const RandomVariable& x, const RandomVariable& y) {
@@ -644,11 +654,8 @@ Filter operator>=(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(),
                       x.data_.front() > y.data_.front() || QuantLib::close_enough(x.data_.front(), y.data_.front()));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] > y[i] || QuantLib::close_enough(x[i], y[i]));
-    }
-    return result;
+    return makeFilter(x.size(),
+                      [&x, &y](const Size i) { return x[i] > y[i] || QuantLib::close_enough(x[i], y[i]); });
 }
 
 RandomVariable applyFilter(RandomVariable x, const Filter& f) {
@@ -667,10 +674,8 @@ RandomVariable applyFilter(RandomVariable x, const Filter& f) {
     }
     if (x.deterministic_ && QuantLib::close_enough(x.data_.front(), 0.0))
         return x;
-    for (Size i = 0; i < x.size(); ++i) {
-        if (!f[i])
-            x.set(i, 0.0);
-    }
+    x.expand();
+    RandomVariableKernels::blend(x.data_.data(), 0.0, f.data(), x.size());
     return x;
 }
 
@@ -690,45 +695,197 @@ RandomVariable applyInverseFilter(RandomVariable x, const Filter& f) {
     }
     if (x.deterministic_ && QuantLib::close_enough(x.data_.front(), 0.0))
         return x;
-    for (Size i = 0; i < x.size(); ++i) {
-        if (f[i])
-            x.set(i, 0.0);
-    }
+    x.expand();
+    Filter g = !f;
+    RandomVariableKernels::blend(x.data_.data(), 0.0, g.data(), x.size());
     return x;
 }
 
+namespace {
+
+// number of paths processed in one step of the blocked regression, a multiple of the filter word size
+constexpr Size regressionBlockSize = 256;
+
+// normal equations accumulated over blocks of paths
+class NormalEquations {
+public:
+    explicit NormalEquations(const Size m) : ata_(m, m, 0.0), atb_(m, 0.0) {}
+
+    // add the rows i = 0, ..., n - 1 with basis values a[j][i] and regressand values b[i]
+    void add(const std::vector<const Real*>& a, const Real* b, const Size n) {
+        for (Size j = 0; j < a.size(); ++j) {
+            for (Size k = j; k < a.size(); ++k)
+                ata_[j][k] += RandomVariableKernels::dot(a[j], a[k], n);
+            atb_[j] += RandomVariableKernels::dot(a[j], b, n);
+        }
+    }
+
+    /* Cholesky decomposition of D A^T A D with D = diag(A^T A)^(-1/2), which has a unit diagonal. Returns false if a
+       pivot falls below minPivot, the condition number of the scaled matrix is then above 1 / minPivot. */
+    bool solve(Array& x) const {
+        static constexpr Real minPivot = 1E-8;
+        const Size m = atb_.size();
+        std::vector<Real> d(m);
+        for (Size j = 0; j < m; ++j) {
+            if (!(ata_[j][j] > 0.0))
+                return false;
+            d[j] = 1.0 / std::sqrt(ata_[j][j]);
+        }
+        Matrix l(m, m, 0.0);
+        for (Size j = 0; j < m; ++j) {
+            Real s = 1.0;
+            for (Size k = 0; k < j; ++k)
+                s -= l[j][k] * l[j][k];
+            if (s < minPivot)
+                return false;
+            l[j][j] = std::sqrt(s);
+            for (Size i = j + 1; i < m; ++i) {
+                Real t = ata_[j][i] * d[i] * d[j];
+                for (Size k = 0; k < j; ++k)
+                    t -= l[i][k] * l[j][k];
+                l[i][j] = t / l[j][j];
+            }
+        }
+        x = Array(m);
+        for (Size i = 0; i < m; ++i) {
+            Real t = atb_[i] * d[i];
+            for (Size k = 0; k < i; ++k)
+                t -= l[i][k] * x[k];
+            x[i] = t / l[i][i];
+        }
+        for (Size i = m; i > 0; --i) {
+            Real t = x[i - 1];
+            for (Size k = i; k < m; ++k)
+                t -= l[k][i - 1] * x[k];
+            x[i - 1] = t / l[i - 1][i - 1];
+        }
+        for (Size i = 0; i < m; ++i)
+            x[i] *= d[i];
+        return true;
+    }
+
+private:
+    Matrix ata_;
+    Array atb_;
+};
+
+// regression on basis values given as n values per basis function
+Array regressionCoefficients(const std::vector<const Real*>& a, const Real* b, const Size n,
+                             const RandomVariableRegressionMethod regressionMethod) {
+    const Size m = a.size();
+    if (regressionMethod == RandomVariableRegressionMethod::NormalEquations) {
+        NormalEquations ne(m);
+        std::vector<const Real*> block(m);
+        for (Size offset = 0; offset < n; offset += regressionBlockSize) {
+            for (Size j = 0; j < m; ++j)
+                block[j] = a[j] + offset;
+            ne.add(block, b + offset, std::min(regressionBlockSize, n - offset));
+        }
+        Array x;
+        if (ne.solve(x))
+            return x;
+    }
+    Matrix A(n, m);
+    for (Size j = 0; j < m; ++j)
+        std::copy(a[j], a[j] + n, A.column_begin(j));
+    Array y(b, b + n);
+    if (regressionMethod == RandomVariableRegressionMethod::QR)
+        return qrSolve(A, y);
+    return SVD(A).solveFor(y);
+}
+
+Size maxOrder(const std::vector<std::vector<Size>>& monomials, const Size dimension) {
+    Size order = 0;
+    for (auto const& e : monomials) {
+        QL_REQUIRE(e.size() == dimension,
+                   "monomial dimension (" << e.size() << ") must match the number of regressors (" << dimension << ")");
+        for (auto const p : e)
+            order = std::max(order, p);
+    }
+    return order;
+}
+
+/* values of the monomials on the paths offset, ..., offset + n - 1, monomial j is written to basis[j * blockSize],
+   the powers of the regressors are cached in powers */
+void evaluateMonomials(const std::vector<const RandomVariable*>& regressor,
+                       const std::vector<std::vector<Size>>& monomials, const Size order, const Size offset,
+                       const Size n, std::vector<Real>& powers, std::vector<Real>& basis) {
+    constexpr Size bs = regressionBlockSize;
+    powers.resize(std::max<Size>(regressor.size() * order, 1) * bs);
+    basis.resize(std::max<Size>(monomials.size(), 1) * bs);
+    for (Size k = 0; k < regressor.size(); ++k) {
+        if (order == 0)
+            break;
+        Real* p1 = &powers[k * order * bs];
+        if (regressor[k]->deterministic())
+            std::fill(p1, p1 + n, regressor[k]->data()[0]);
+        else
+            std::copy(regressor[k]->data() + offset, regressor[k]->data() + offset + n, p1);
+        for (Size p = 1; p < order; ++p) {
+            Real* pp = p1 + p * bs;
+            std::copy(pp - bs, pp - bs + n, pp);
+            RandomVariableKernels::multiply(pp, p1, n);
+        }
+    }
+    for (Size j = 0; j < monomials.size(); ++j) {
+        Real* bj = &basis[j * bs];
+        std::fill(bj, bj + n, 1.0);
+        for (Size k = 0; k < regressor.size(); ++k) {
+            if (monomials[j][k] > 0)
+                RandomVariableKernels::multiply(bj, &powers[(k * order + monomials[j][k] - 1) * bs], n);
+        }
+    }
+}
+
+} // namespace
+
 Array regressionCoefficients(
     RandomVariable r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter) {
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
     for (auto const reg : regressor) {
         QL_REQUIRE(reg->size() == r.size(),
                    "regressor size (" << reg->size() << ") must match regressand size (" << r.size() << ")");
     }
     QL_REQUIRE(filter.size() == 0 || filter.size() == r.size(),
                "filter size (" << filter.size() << ") must match regressand size (" << r.size() << ")");
-    Matrix A(r.size(), basisFn.size());
-    for (Size j = 0; j < basisFn.size(); ++j) {
-        RandomVariable a = basisFn[j](regressor);
-        if (filter.initialised()) {
-            a = applyFilter(a, filter);
+    if (regressionMethod == RandomVariableRegressionMethod::QR) {
+        Matrix A(r.size(), basisFn.size());
+        for (Size j = 0; j < basisFn.size(); ++j) {
+            RandomVariable a = basisFn[j](regressor);
+            if (filter.initialised()) {
+                a = applyFilter(a, filter);
+            }
+            if (a.deterministic())
+                std::fill(A.column_begin(j), A.column_end(j), a[0]);
+            else
+                a.copyToMatrixCol(A, j);
+        }
+
+        if (filter.size() > 0) {
+            r = applyFilter(r, filter);
         }
-        if (a.deterministic())
-            std::fill(A.column_begin(j), A.column_end(j), a[0]);
+        Array b(r.size());
+        if (r.deterministic())
+            std::fill(b.begin(), b.end(), r[0]);
         else
-            a.copyToMatrixCol(A, j);
+            r.copyToArray(b);
+        Array res = qrSolve(A, b);
+        return res;
     }
-
-    if (filter.size() > 0) {
-        r = applyFilter(r, filter);
+    std::vector<RandomVariable> a(basisFn.size());
+    std::vector<const Real*> values(basisFn.size());
+    for (Size j = 0; j < basisFn.size(); ++j) {
+        a[j] = basisFn[j](regressor);
+        if (filter.initialised())
+            a[j] = applyFilter(a[j], filter);
+        a[j].expand();
+        values[j] = a[j].data();
     }
-    Array b(r.size());
-    if (r.deterministic())
-        std::fill(b.begin(), b.end(), r[0]);
-    else
-        r.copyToArray(b);
-    Array res = qrSolve(A, b);
-    return res;
+    if (filter.initialised())
+        r = applyFilter(r, filter);
+    r.expand();
+    return regressionCoefficients(values, r.data(), r.size(), regressionMethod);
 }
 
 RandomVariable conditionalExpectation(
@@ -753,13 +910,139 @@ RandomVariable conditionalExpectation(
 RandomVariable conditionalExpectation(
     const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter) {
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
     if (r.deterministic())
         return r;
-    auto coeff = regressionCoefficients(r, regressor, basisFn, filter);
+    auto coeff = regressionCoefficients(r, regressor, basisFn, filter, regressionMethod);
     return conditionalExpectation(regressor, basisFn, coeff);
 }
 
+std::vector<std::vector<Size>> monomialBasis(const Size dimension, const Size order) {
+    std::vector<std::vector<Size>> result;
+    std::vector<Size> e(dimension, 0);
+    // distribute the remaining degree over the variables k, ..., dimension - 1
+    std::function<void(Size, Size)> add = [&](const Size k, const Size degree) {
+        if (k + 1 >= dimension) {
+            if (dimension > 0)
+                e[dimension - 1] = degree;
+            if (dimension > 0 || degree == 0)
+                result.push_back(e);
+            return;
+        }
+        for (Size p = degree + 1; p > 0; --p) {
+            e[k] = p - 1;
+            add(k + 1, degree - (p - 1));
+        }
+        e[k] = 0;
+    };
+    for (Size degree = 0; degree <= order; ++degree)
+        add(0, degree);
+    return result;
+}
+
+Array regressionCoefficients(RandomVariable r, const std::vector<const RandomVariable*>& regressor,
+                             const std::vector<std::vector<Size>>& monomials, const Filter& filter,
+                             const RandomVariableRegressionMethod regressionMethod) {
+    for (auto const reg : regressor) {
+        QL_REQUIRE(reg->size() == r.size(),
+                   "regressor size (" << reg->size() << ") must match regressand size (" << r.size() << ")");
+    }
+    QL_REQUIRE(filter.size() == 0 || filter.size() == r.size(),
+               "filter size (" << filter.size() << ") must match regressand size (" << r.size() << ")");
+    const Size n = r.size(), m = monomials.size();
+    const Size order = maxOrder(monomials, regressor.size());
+    const bool blend = filter.initialised() && !filter.deterministic();
+    if (filter.initialised())
+        r = applyFilter(r, filter);
+    r.expand();
+
+    // the basis is zero on all paths if the filter is deterministic and false
+    const Real filterValue = filter.initialised() && filter.deterministic() && !filter[0] ? 0.0 : 1.0;
+
+    std::vector<Real> powers, basis;
+    std::vector<const Real*> block(m);
+
+    auto evaluate = [&](const Size offset, const Size len) {
+        evaluateMonomials(regressor, monomials, order, offset, len, powers, basis);
+        for (Size j = 0; j < m; ++j) {
+            Real* bj = &basis[j * regressionBlockSize];
+            if (blend)
+                RandomVariableKernels::blend(bj, 0.0, filter.data() + offset / 64, len);
+            else if (filterValue == 0.0)
+                std::fill(bj, bj + len, 0.0);
+            block[j] = bj;
+        }
+    };
+
+    if (regressionMethod == RandomVariableRegressionMethod::NormalEquations) {
+        NormalEquations ne(m);
+        for (Size offset = 0; offset < n; offset += regressionBlockSize) {
+            const Size len = std::min(regressionBlockSize, n - offset);
+            evaluate(offset, len);
+            ne.add(block, r.data() + offset, len);
+        }
+        Array x;
+        if (ne.solve(x))
+            return x;
+    }
+
+    // methods on the full design matrix
+    std::vector<RandomVariable> a(m, RandomVariable(n, 0.0));
+    std::vector<const Real*> values(m);
+    for (Size j = 0; j < m; ++j) {
+        a[j].expand();
+        values[j] = a[j].data();
+    }
+    for (Size offset = 0; offset < n; offset += regressionBlockSize) {
+        const Size len = std::min(regressionBlockSize, n - offset);
+        evaluate(offset, len);
+        for (Size j = 0; j < m; ++j)
+            std::copy(block[j], block[j] + len, a[j].data() + offset);
+    }
+    return regressionCoefficients(values, r.data(), n,
+                                  regressionMethod == RandomVariableRegressionMethod::QR
+                                      ? RandomVariableRegressionMethod::QR
+                                      : RandomVariableRegressionMethod::SVD);
+}
+
+RandomVariable conditionalExpectation(const std::vector<const RandomVariable*>& regressor,
+                                      const std::vector<std::vector<Size>>& monomials, const Array& coefficients) {
+    QL_REQUIRE(!regressor.empty(), "regressor vector is empty");
+    Size n = regressor.front()->size();
+    for (Size i = 1; i < regressor.size(); ++i) {
+        QL_REQUIRE(n == regressor[i]->size(), "regressor #" << i << " size (" << regressor[i]->size()
+                                                            << ") must match regressor #0 size (" << n << ")");
+    }
+    QL_REQUIRE(monomials.size() == coefficients.size(), "monomials size (" << monomials.size()
+                                                                           << ") must match coefficients size ("
+                                                                           << coefficients.size() << ")");
+    const Size order = maxOrder(monomials, regressor.size());
+    RandomVariable r(n, 0.0);
+    r.expand();
+    std::vector<Real> powers, basis;
+    for (Size offset = 0; offset < n; offset += regressionBlockSize) {
+        const Size len = std::min(regressionBlockSize, n - offset);
+        evaluateMonomials(regressor, monomials, order, offset, len, powers, basis);
+        Real* out = r.data() + offset;
+        for (Size j = 0; j < monomials.size(); ++j) {
+            const Real* bj = &basis[j * regressionBlockSize];
+            const Real c = coefficients[j];
+            for (Size i = 0; i < len; ++i)
+                out[i] += c * bj[i];
+        }
+    }
+    return r;
+}
+
+RandomVariable conditionalExpectation(const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
+                                      const std::vector<std::vector<Size>>& monomials, const Filter& filter,
+                                      const RandomVariableRegressionMethod regressionMethod) {
+    if (r.deterministic())
+        return r;
+    auto coeff = regressionCoefficients(r, regressor, monomials, filter, regressionMethod);
+    return conditionalExpectation(regressor, monomials, coeff);
+}
+
 RandomVariable expectation(const RandomVariable& r) {
     if (r.deterministic())
         return r;
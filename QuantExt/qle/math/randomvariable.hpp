@@ -18,6 +18,9 @@
 
 #pragma once
 
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_pool.hpp>
+
 #include <ql/errors.hpp>
 #include <ql/math/array.hpp>
 #include <ql/math/matrix.hpp>
@@ -25,6 +28,7 @@
 
 #include <boost/function.hpp>
 
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 
@@ -34,10 +38,14 @@ using namespace QuantLib;
 
 // filter class
 
+/* The values are stored bit packed in 64 bit words, value i is bit i % 64 of word i / 64. The bits beyond the size
+   in the last word are zero. A deterministic filter stores a single word which is either zero or has all bits set. */
+
 struct Filter {
     // ctors
     Filter() : n_(0), deterministic_(false) {}
-    explicit Filter(const Size n, const bool value = false) : n_(n), data_(1, value), deterministic_(true) {}
+    explicit Filter(const Size n, const bool value = false)
+        : n_(n), data_(1, value ? ~std::uint64_t(0) : 0), deterministic_(true) {}
     // modifiers
     void clear();
     void set(const Size i, const bool v);
@@ -49,8 +57,17 @@ struct Filter {
 
     bool initialised() const { return n_ != 0; }
     Size size() const { return n_; }
-    bool operator[](const Size i) const; // no bound check
-    bool at(const Size i) const;         // with bound check
+    bool operator[](const Size i) const { // no bound check
+        return deterministic_ ? data_.front() != 0 : ((data_[i >> 6] >> (i & 63)) & 1) != 0;
+    }
+    bool at(const Size i) const; // with bound check
+    // number of true values, any true value, all values true
+    Size count() const;
+    bool any() const { return count() > 0; }
+    bool all() const { return count() == n_; }
+    // raw words, (size() + 63) / 64 words for a non-deterministic filter, a single word otherwise
+    const std::uint64_t* data() const { return data_.data(); }
+    std::uint64_t* data() { return data_.data(); }
     //
     friend Filter operator&&(Filter, const Filter&);
     friend Filter operator||(Filter, const Filter&);
@@ -62,8 +79,10 @@ struct Filter {
     void expand();
 
 private:
+    // set the bits beyond the size to zero
+    void clearTail();
     Size n_;
-    std::vector<bool> data_;
+    std::vector<std::uint64_t> data_;
     bool deterministic_;
 };
 
@@ -103,6 +122,9 @@ struct RandomVariable {
     Real operator[](const Size i) const; // no bound check
     Real at(const Size i) const;         // with bound check
     Real time() const { return time_; }
+    // raw values, size() values for a non-deterministic variable, a single value otherwise
+    const Real* data() const { return data_.data(); }
+    Real* data() { return data_.data(); }
     RandomVariable& operator+=(const RandomVariable&);
     RandomVariable& operator-=(const RandomVariable&);
     RandomVariable& operator*=(const RandomVariable&);
@@ -143,7 +165,8 @@ struct RandomVariable {
 private:
     void checkTimeConsistencyAndUpdate(const Real t);
     Size n_;
-    std::vector<Real> data_;
+    // pooled, aligned to the width of the widest vector registers used by the kernels
+    std::vector<Real, RandomVariableAllocator<Real>> data_;
     bool deterministic_;
     Real time_;
 };
@@ -182,11 +205,20 @@ RandomVariable applyFilter(RandomVariable, const Filter&);
 // set all entries to 0 where filter = true, leave the others unchanged
 RandomVariable applyInverseFilter(RandomVariable, const Filter&);
 
+/* regression methods
+   - QR: Householder QR decomposition of the full design matrix
+   - SVD: singular value decomposition of the full design matrix, for rank deficient or ill conditioned problems
+   - NormalEquations: the normal equations are accumulated in one blocked pass through the paths without building
+     the design matrix and solved by a Cholesky decomposition of the Jacobi scaled normal matrix, if this is ill
+     conditioned the SVD method is used instead */
+enum class RandomVariableRegressionMethod { QR, SVD, NormalEquations };
+
 // compute regression coefficients
 Array regressionCoefficients(
     RandomVariable r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter = Filter());
+    const Filter& filter = Filter(),
+    const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR);
 
 // evaluate regression function
 RandomVariable conditionalExpectation(
@@ -198,7 +230,30 @@ RandomVariable conditionalExpectation(
 RandomVariable conditionalExpectation(
     const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter = Filter());
+    const Filter& filter = Filter(),
+    const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR);
+
+/* monomial basis functions, basis function j is the product of the regressors k raised to the powers
+   monomials[j][k], the monomials are evaluated in blocks of paths without intermediate random variables */
+
+// all monomials in dimension variables of total degree up to order, ordered by degree
+std::vector<std::vector<Size>> monomialBasis(const Size dimension, const Size order);
+
+// compute regression coefficients for a monomial basis
+Array regressionCoefficients(
+    RandomVariable r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::vector<Size>>& monomials, const Filter& filter = Filter(),
+    const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::NormalEquations);
+
+// evaluate regression function for a monomial basis
+RandomVariable conditionalExpectation(const std::vector<const RandomVariable*>& regressor,
+                                      const std::vector<std::vector<Size>>& monomials, const Array& coefficients);
+
+// compute and evaluate regression for a monomial basis in one run
+RandomVariable conditionalExpectation(
+    const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::vector<Size>>& monomials, const Filter& filter = Filter(),
+    const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::NormalEquations);
 
 // time zero expectation
 RandomVariable expectation(const RandomVariable& r);
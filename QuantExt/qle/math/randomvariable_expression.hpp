@@ -0,0 +1,359 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_expression.hpp
+    \brief expression templates for the fused evaluation of random variable arithmetic
+    \ingroup math
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/math/comparison.hpp>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace QuantExt {
+
+/*! Opt-in expression templates for RandomVariable arithmetic. An expression like
+
+    \code
+    using namespace RandomVariableExpressions;
+    RandomVariable r = evaluate(lazy(a) * b + c * exp(lazy(d)));
+    \endcode
+
+    builds a tree of lightweight nodes instead of one temporary RandomVariable per operator. evaluate() runs through
+    the paths once, in blocks of blockSize paths. The intermediate results of a block stay in the L1 cache and are
+    computed with the vectorised RandomVariableKernels, so the results agree with the ones of the plain
+    RandomVariable operators.
+
+    Once one operand is an expression, RandomVariable and scalar operands are wrapped automatically. Conditionals on a
+    Filter are supported by conditionalResult(), applyFilter() and applyInverseFilter(). The random variables must
+    be initialised, and must outlive the expression, which only holds references to them.
+
+    \ingroup math
+*/
+namespace RandomVariableExpressions {
+
+//! number of paths evaluated in one pass through the expression tree
+constexpr Size blockSize = 256;
+static_assert(blockSize % 64 == 0, "blockSize must be a multiple of the filter word size");
+
+//! CRTP base of all expression nodes
+template <class E> struct Expression {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace detail {
+// the size of a node, zero stands for a scalar which is compatible with all sizes
+inline Size combineSizes(const Size n1, const Size n2) {
+    QL_REQUIRE(n1 == 0 || n2 == 0 || n1 == n2,
+               "RandomVariableExpressions: operand sizes (" << n1 << ", " << n2 << ") do not match");
+    return n1 == 0 ? n2 : n1;
+}
+
+inline Real combineTimes(const Real t1, const Real t2) {
+    QL_REQUIRE(t1 == Null<Real>() || t2 == Null<Real>() || QuantLib::close_enough(t1, t2),
+               "RandomVariableExpressions: inconsistent times " << t1 << " and " << t2);
+    return t1 == Null<Real>() ? t2 : t1;
+}
+} // namespace detail
+
+//! Leaf referencing a random variable
+class Terminal : public Expression<Terminal> {
+public:
+    explicit Terminal(const RandomVariable& x) : x_(x) {
+        QL_REQUIRE(x_.initialised(), "RandomVariableExpressions: random variable is not initialised");
+    }
+    Size size() const { return x_.size(); }
+    Real time() const { return x_.time(); }
+    bool deterministic() const { return x_.deterministic(); }
+    Real value() const { return x_.data()[0]; }
+    void evaluate(const Size offset, const Size n, Real* out) const {
+        if (x_.deterministic())
+            std::fill(out, out + n, x_.data()[0]);
+        else
+            std::copy(x_.data() + offset, x_.data() + offset + n, out);
+    }
+    // the values of the block if they can be read without evaluation, otherwise nullptr
+    const Real* direct(const Size offset) const { return x_.deterministic() ? nullptr : x_.data() + offset; }
+
+private:
+    const RandomVariable& x_;
+};
+
+//! Leaf holding a scalar
+class Constant : public Expression<Constant> {
+public:
+    explicit Constant(const Real value) : value_(value) {}
+    Size size() const { return 0; }
+    Real time() const { return Null<Real>(); }
+    bool deterministic() const { return true; }
+    Real value() const { return value_; }
+    void evaluate(const Size, const Size n, Real* out) const { std::fill(out, out + n, value_); }
+    const Real* direct(const Size) const { return nullptr; }
+
+private:
+    Real value_;
+};
+
+//! Node applying a binary operation, see Plus etc. for the operations
+template <class Op, class L, class R> class Binary : public Expression<Binary<Op, L, R>> {
+public:
+    Binary(const L& l, const R& r)
+        : l_(l), r_(r), n_(detail::combineSizes(l.size(), r.size())), time_(detail::combineTimes(l.time(), r.time())),
+          deterministic_(l.deterministic() && r.deterministic()), value_(Null<Real>()) {
+        if (deterministic_) {
+            value_ = l_.value();
+            Op::apply(&value_, r_.value(), 1);
+        }
+    }
+    Size size() const { return n_; }
+    Real time() const { return time_; }
+    bool deterministic() const { return deterministic_; }
+    Real value() const { return value_; }
+    void evaluate(const Size offset, const Size n, Real* out) const {
+        l_.evaluate(offset, n, out);
+        if (r_.deterministic()) {
+            Op::apply(out, r_.value(), n);
+            return;
+        }
+        const Real* y = r_.direct(offset);
+        Real buffer[blockSize];
+        if (y == nullptr) {
+            r_.evaluate(offset, n, buffer);
+            y = buffer;
+        }
+        Op::apply(out, y, n);
+    }
+    const Real* direct(const Size) const { return nullptr; }
+
+private:
+    L l_;
+    R r_;
+    Size n_;
+    Real time_;
+    bool deterministic_;
+    Real value_;
+};
+
+//! Node applying a function, see Exp etc. for the functions
+template <class Op, class E> class Unary : public Expression<Unary<Op, E>> {
+public:
+    explicit Unary(const E& e) : e_(e), value_(Null<Real>()) {
+        if (e_.deterministic()) {
+            value_ = e_.value();
+            Op::apply(&value_, 1);
+        }
+    }
+    Size size() const { return e_.size(); }
+    Real time() const { return e_.time(); }
+    bool deterministic() const { return e_.deterministic(); }
+    Real value() const { return value_; }
+    void evaluate(const Size offset, const Size n, Real* out) const {
+        e_.evaluate(offset, n, out);
+        Op::apply(out, n);
+    }
+    const Real* direct(const Size) const { return nullptr; }
+
+private:
+    E e_;
+    Real value_;
+};
+
+//! Node selecting the values of l where the filter is true and the values of r otherwise
+template <class L, class R> class Conditional : public Expression<Conditional<L, R>> {
+public:
+    Conditional(const Filter& f, const L& l, const R& r)
+        : f_(f), l_(l), r_(r), n_(detail::combineSizes(l.size(), r.size())),
+          time_(detail::combineTimes(l.time(), r.time())), value_(Null<Real>()) {
+        QL_REQUIRE(f_.initialised(), "RandomVariableExpressions: filter is not initialised");
+        n_ = detail::combineSizes(n_, f_.size());
+        deterministic_ = f_.deterministic() ? (f_[0] ? l_.deterministic() : r_.deterministic())
+                                            : l_.deterministic() && r_.deterministic() &&
+                                                  QuantLib::close_enough(l_.value(), r_.value());
+        if (deterministic_)
+            value_ = f_.deterministic() && !f_[0] ? r_.value() : l_.value();
+    }
+    Size size() const { return n_; }
+    Real time() const { return time_; }
+    bool deterministic() const { return deterministic_; }
+    Real value() const { return value_; }
+    void evaluate(const Size offset, const Size n, Real* out) const {
+        if (f_.deterministic()) {
+            if (f_[0])
+                l_.evaluate(offset, n, out);
+            else
+                r_.evaluate(offset, n, out);
+            return;
+        }
+        Real buffer[blockSize];
+        l_.evaluate(offset, n, out);
+        r_.evaluate(offset, n, buffer);
+        RandomVariableKernels::blend(out, buffer, f_.data() + offset / 64, n);
+    }
+    const Real* direct(const Size) const { return nullptr; }
+
+private:
+    const Filter& f_;
+    L l_;
+    R r_;
+    Size n_;
+    Real time_;
+    bool deterministic_;
+    Real value_;
+};
+
+// binary operations
+
+struct Plus {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::add(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::add(x, y, n); }
+};
+
+struct Minus {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::subtract(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::add(x, -y, n); }
+};
+
+struct Multiplies {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::multiply(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::multiply(x, y, n); }
+};
+
+struct Divides {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::divide(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::divide(x, y, n); }
+};
+
+struct Max {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::max(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::max(x, y, n); }
+};
+
+struct Min {
+    static void apply(Real* x, const Real* y, const Size n) { RandomVariableKernels::min(x, y, n); }
+    static void apply(Real* x, const Real y, const Size n) { RandomVariableKernels::min(x, y, n); }
+};
+
+// functions
+
+#define QLE_RV_EXPRESSION_FUNCTION(Name, kernel)                                                                       \
+    struct Name {                                                                                                      \
+        static void apply(Real* x, const Size n) { RandomVariableKernels::kernel(x, n); }                             \
+    };
+
+QLE_RV_EXPRESSION_FUNCTION(Negate, negate)
+QLE_RV_EXPRESSION_FUNCTION(Abs, abs)
+QLE_RV_EXPRESSION_FUNCTION(Sqrt, sqrt)
+QLE_RV_EXPRESSION_FUNCTION(Exp, exp)
+QLE_RV_EXPRESSION_FUNCTION(Log, log)
+QLE_RV_EXPRESSION_FUNCTION(NormalCdf, normalCdf)
+QLE_RV_EXPRESSION_FUNCTION(NormalPdf, normalPdf)
+
+#undef QLE_RV_EXPRESSION_FUNCTION
+
+// wrapping of the operands
+
+//! start an expression with a random variable
+inline Terminal lazy(const RandomVariable& x) { return Terminal(x); }
+
+inline Terminal wrap(const RandomVariable& x) { return Terminal(x); }
+inline Constant wrap(const Real x) { return Constant(x); }
+template <class E> const E& wrap(const Expression<E>& e) { return e.self(); }
+
+template <class T> struct IsExpression : std::is_base_of<Expression<T>, T> {};
+
+template <class T>
+struct IsOperand : std::integral_constant<bool, IsExpression<T>::value || std::is_same<T, RandomVariable>::value ||
+                                                    std::is_arithmetic<T>::value> {};
+
+template <class T> using Wrapped = std::decay_t<decltype(wrap(std::declval<const T&>()))>;
+
+// enabled if one operand is an expression and the other one is an expression, a random variable or a scalar
+template <class L, class R>
+using EnableIfOperands = std::enable_if_t<(IsExpression<L>::value || IsExpression<R>::value) && IsOperand<L>::value &&
+                                          IsOperand<R>::value>;
+
+template <class E> using EnableIfExpression = std::enable_if_t<IsExpression<E>::value>;
+
+// operators and functions
+
+#define QLE_RV_EXPRESSION_BINARY(name, Op)                                                                             \
+    template <class L, class R, class = EnableIfOperands<L, R>>                                                        \
+    Binary<Op, Wrapped<L>, Wrapped<R>> name(const L& l, const R& r) {                                                  \
+        return Binary<Op, Wrapped<L>, Wrapped<R>>(wrap(l), wrap(r));                                                   \
+    }
+
+QLE_RV_EXPRESSION_BINARY(operator+, Plus)
+QLE_RV_EXPRESSION_BINARY(operator-, Minus)
+QLE_RV_EXPRESSION_BINARY(operator*, Multiplies)
+QLE_RV_EXPRESSION_BINARY(operator/, Divides)
+QLE_RV_EXPRESSION_BINARY(max, Max)
+QLE_RV_EXPRESSION_BINARY(min, Min)
+
+#undef QLE_RV_EXPRESSION_BINARY
+
+#define QLE_RV_EXPRESSION_UNARY(name, Op)                                                                              \
+    template <class E, class = EnableIfExpression<E>> Unary<Op, E> name(const E& e) { return Unary<Op, E>(e); }
+
+QLE_RV_EXPRESSION_UNARY(operator-, Negate)
+QLE_RV_EXPRESSION_UNARY(abs, Abs)
+QLE_RV_EXPRESSION_UNARY(sqrt, Sqrt)
+QLE_RV_EXPRESSION_UNARY(exp, Exp)
+QLE_RV_EXPRESSION_UNARY(log, Log)
+QLE_RV_EXPRESSION_UNARY(normalCdf, NormalCdf)
+QLE_RV_EXPRESSION_UNARY(normalPdf, NormalPdf)
+
+#undef QLE_RV_EXPRESSION_UNARY
+
+//! values of l where f is true, values of r otherwise
+template <class L, class R, class = EnableIfOperands<L, R>>
+Conditional<Wrapped<L>, Wrapped<R>> conditionalResult(const Filter& f, const L& l, const R& r) {
+    return Conditional<Wrapped<L>, Wrapped<R>>(f, wrap(l), wrap(r));
+}
+
+//! zero where f is false, the values of e otherwise
+template <class E, class = EnableIfExpression<E>> Conditional<E, Constant> applyFilter(const E& e, const Filter& f) {
+    return Conditional<E, Constant>(f, e, Constant(0.0));
+}
+
+//! zero where f is true, the values of e otherwise
+template <class E, class = EnableIfExpression<E>>
+Conditional<Constant, E> applyInverseFilter(const E& e, const Filter& f) {
+    return Conditional<Constant, E>(f, Constant(0.0), e);
+}
+
+//! evaluate the expression in one pass through the paths
+template <class E> RandomVariable evaluate(const Expression<E>& expression) {
+    const E& e = expression.self();
+    QL_REQUIRE(e.size() > 0, "RandomVariableExpressions::evaluate(): expression does not contain a random variable");
+    if (e.deterministic())
+        return RandomVariable(e.size(), e.value(), e.time());
+    RandomVariable result(e.size(), 0.0, e.time());
+    result.expand();
+    Real* out = result.data();
+    for (Size offset = 0; offset < e.size(); offset += blockSize)
+        e.evaluate(offset, std::min(blockSize, e.size() - offset), out + offset);
+    return result;
+}
+
+} // namespace RandomVariableExpressions
+} // namespace QuantExt
@@ -0,0 +1,314 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_kernels.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// function multi versioning, the loader selects the version matching the cpu
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define QLE_RV_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define QLE_RV_KERNEL
+#endif
+
+namespace QuantExt {
+namespace RandomVariableKernels {
+
+namespace {
+
+// 1.5 * 2^52, adding and subtracting it rounds a double of absolute value below 2^51 to an integer, the integer is
+// then contained in the low bits of the sum
+constexpr double magic = 6755399441055744.0;
+
+inline std::uint64_t toBits(double x) {
+    std::uint64_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+inline double fromBits(std::uint64_t b) {
+    double x;
+    std::memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+// 2^k for integer valued -1022 <= k <= 1023, only unsigned 64 bit integer operations are used, since these are
+// available in all vector instruction sets
+inline double pow2(double k) { return fromBits((toBits(k + magic) - toBits(magic) + 1023) << 52); }
+
+inline double expKernel(double x) {
+    constexpr double log2e = 1.4426950408889634074;
+    constexpr double ln2hi = 6.93147180369123816490e-01;
+    constexpr double ln2lo = 1.90821492927058770002e-10;
+    constexpr double maxArg = 709.782712893383973096;
+    constexpr double minArg = -745.133219101941108420;
+    double v = x > maxArg ? maxArg : (x < minArg ? minArg : x);
+    double t = v * log2e + magic;
+    double n = t - magic;
+    // |r| <= ln2 / 2
+    double r = v - n * ln2hi - n * ln2lo;
+    // Taylor polynomial of degree 13, the remainder is below 4E-18 relative
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    // -1075 <= n <= 1024, split the scaling so that both factors are normal numbers
+    double n1 = std::trunc(0.5 * n);
+    double res = p * pow2(n1) * pow2(n - n1);
+    res = x > maxArg ? std::numeric_limits<double>::infinity() : res;
+    res = x < minArg ? 0.0 : res;
+    return x != x ? x : res;
+}
+
+inline double logKernel(double x) {
+    constexpr double ln2hi = 6.93147180369123816490e-01;
+    constexpr double ln2lo = 1.90821492927058770002e-10;
+    constexpr double sqrt2 = 1.41421356237309504880;
+    constexpr double two52 = 4503599627370496.0;
+    // scale subnormal numbers to normal numbers
+    bool subnormal = x < std::numeric_limits<double>::min();
+    double v = subnormal ? x * two52 : x;
+    std::uint64_t b = toBits(v);
+    // exponent, the sign bit is ignored here since negative numbers give nan below
+    double e = fromBits(toBits(magic) + ((b >> 52) & 0x7ff)) - magic - (subnormal ? 1075.0 : 1023.0);
+    // mantissa in [1, 2)
+    double m = fromBits((b & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    bool large = m > sqrt2;
+    m = large ? 0.5 * m : m;
+    e = large ? e + 1.0 : e;
+    // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| <= 0.172
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double s2 = s * s;
+    double p = 1.0 / 23.0;
+    p = p * s2 + 1.0 / 21.0;
+    p = p * s2 + 1.0 / 19.0;
+    p = p * s2 + 1.0 / 17.0;
+    p = p * s2 + 1.0 / 15.0;
+    p = p * s2 + 1.0 / 13.0;
+    p = p * s2 + 1.0 / 11.0;
+    p = p * s2 + 1.0 / 9.0;
+    p = p * s2 + 1.0 / 7.0;
+    p = p * s2 + 1.0 / 5.0;
+    p = p * s2 + 1.0 / 3.0;
+    // f - f s = 2 s, the first term is separated to reduce the rounding error
+    double res = e * ln2hi + ((f - s * f) + (2.0 * s * s2 * p + e * ln2lo));
+    res = x == 0.0 ? -std::numeric_limits<double>::infinity() : res;
+    res = x < 0.0 ? std::numeric_limits<double>::quiet_NaN() : res;
+    res = x == std::numeric_limits<double>::infinity() ? x : res;
+    return x != x ? x : res;
+}
+
+// exp(-y^2 / 2) for y >= 0 computed as exp(-z^2 / 2) exp(-(y - z)(y + z) / 2) with z = y rounded down to a multiple
+// of 1/16, so that the rounding error of y^2 is not amplified
+inline double gaussianKernel(double y) {
+    // the result is zero beyond 40, this also covers y = inf
+    y = y > 40.0 ? 40.0 : y;
+    double z = std::floor(y * 16.0) / 16.0;
+    double del = (y - z) * (y + z);
+    return expKernel(-z * z * 0.5) * expKernel(-del * 0.5);
+}
+
+// W. J. Cody, Algorithm 715, ACM TOMS 19 (1993), as in pnorm() of R
+inline double normalCdfKernel(double x) {
+    constexpr double a0 = 2.2352520354606839287, a1 = 161.02823106855587881, a2 = 1067.6894854603709582,
+                     a3 = 18154.981253343561249, a4 = 0.065682337918207449113;
+    constexpr double b0 = 47.20258190468824187, b1 = 976.09855173777669322, b2 = 10260.932208618978205,
+                     b3 = 45507.789335026729956;
+    constexpr double c0 = 0.39894151208813466764, c1 = 8.8831497943883759412, c2 = 93.506656132177855979,
+                     c3 = 597.27027639480026226, c4 = 2494.5375852903726711, c5 = 6848.1904505362823326,
+                     c6 = 11602.651437647350124, c7 = 9842.7148383839780218, c8 = 1.0765576773720192317e-8;
+    constexpr double d0 = 22.266688044328115691, d1 = 235.38790178262499861, d2 = 1519.377599407554805,
+                     d3 = 6485.558298266760755, d4 = 18615.571640885098091, d5 = 34900.952721145977266,
+                     d6 = 38912.003286093271411, d7 = 19685.429676859990727;
+    constexpr double p0 = 0.21589853405795699, p1 = 0.1274011611602473639, p2 = 0.022235277870649807,
+                     p3 = 0.001421619193227893466, p4 = 2.9112874951168792e-5, p5 = 0.02307344176494017303;
+    constexpr double q0 = 1.28426009614491121, q1 = 0.468238212480865118, q2 = 0.0659881378689285515,
+                     q3 = 0.00378239633202758244, q4 = 7.29751555083966205e-5;
+    constexpr double oneOverSqrt2Pi = 0.398942280401432677939946059934;
+    constexpr double sqrt32 = 5.656854249492380195206754896838;
+    constexpr double lowerBound = -37.5193;
+
+    double y = std::abs(x);
+
+    // |x| <= 0.67448975
+    double xsq = x * x;
+    double num = ((((a4 * xsq + a0) * xsq + a1) * xsq + a2) * xsq);
+    double den = (((xsq + b0) * xsq + b1) * xsq + b2) * xsq;
+    double inner = 0.5 + x * (num + a3) / (den + b3);
+
+    // 0.67448975 < |x| <= sqrt(32), the tail probability
+    num = (((((((c8 * y + c0) * y + c1) * y + c2) * y + c3) * y + c4) * y + c5) * y + c6) * y;
+    den = (((((((y + d0) * y + d1) * y + d2) * y + d3) * y + d4) * y + d5) * y + d6) * y;
+    double middle = (num + c7) / (den + d7);
+
+    // |x| > sqrt(32), the tail probability
+    double ysq = 1.0 / xsq;
+    num = ((((p5 * ysq + p0) * ysq + p1) * ysq + p2) * ysq + p3) * ysq;
+    den = ((((ysq + q0) * ysq + q1) * ysq + q2) * ysq + q3) * ysq;
+    double outer = (oneOverSqrt2Pi - ysq * (num + p4) / (den + q4)) / y;
+
+    double tail = gaussianKernel(y) * (y <= sqrt32 ? middle : outer);
+    double res = y <= 0.67448975 ? inner : (x > 0.0 ? 1.0 - tail : tail);
+    res = x < lowerBound ? 0.0 : res;
+    return x != x ? x : res;
+}
+
+} // namespace
+
+QLE_RV_KERNEL void add(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] += y[i];
+}
+
+QLE_RV_KERNEL void subtract(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] -= y[i];
+}
+
+QLE_RV_KERNEL void multiply(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] *= y[i];
+}
+
+QLE_RV_KERNEL void divide(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] /= y[i];
+}
+
+QLE_RV_KERNEL void max(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = x[i] < y[i] ? y[i] : x[i];
+}
+
+QLE_RV_KERNEL void min(Real* x, const Real* y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = y[i] < x[i] ? y[i] : x[i];
+}
+
+QLE_RV_KERNEL Real dot(const Real* x, const Real* y, Size n) {
+    Real s[8] = {};
+    Size i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (Size l = 0; l < 8; ++l)
+            s[l] += x[i + l] * y[i + l];
+    }
+    Real r = ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+    for (; i < n; ++i)
+        r += x[i] * y[i];
+    return r;
+}
+
+QLE_RV_KERNEL void add(Real* x, Real y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] += y;
+}
+
+QLE_RV_KERNEL void multiply(Real* x, Real y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] *= y;
+}
+
+QLE_RV_KERNEL void divide(Real* x, Real y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] /= y;
+}
+
+QLE_RV_KERNEL void max(Real* x, Real y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = x[i] < y ? y : x[i];
+}
+
+QLE_RV_KERNEL void min(Real* x, Real y, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = y < x[i] ? y : x[i];
+}
+
+QLE_RV_KERNEL void negate(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = -x[i];
+}
+
+QLE_RV_KERNEL void abs(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = std::abs(x[i]);
+}
+
+QLE_RV_KERNEL void sqrt(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = std::sqrt(x[i]);
+}
+
+QLE_RV_KERNEL void exp(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = expKernel(x[i]);
+}
+
+QLE_RV_KERNEL void log(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = logKernel(x[i]);
+}
+
+QLE_RV_KERNEL void normalCdf(Real* x, Size n) {
+    for (Size i = 0; i < n; ++i)
+        x[i] = normalCdfKernel(x[i]);
+}
+
+QLE_RV_KERNEL void normalPdf(Real* x, Size n) {
+    constexpr double oneOverSqrt2Pi = 0.398942280401432677939946059934;
+    for (Size i = 0; i < n; ++i)
+        x[i] = oneOverSqrt2Pi * gaussianKernel(std::abs(x[i]));
+}
+
+QLE_RV_KERNEL void blend(Real* x, const Real* y, const std::uint64_t* mask, Size n) {
+    for (Size w = 0; w * 64 < n; ++w) {
+        const std::uint64_t m = mask[w];
+        const Size len = n - w * 64 < 64 ? n - w * 64 : 64;
+        Real* xw = x + w * 64;
+        const Real* yw = y + w * 64;
+        for (Size j = 0; j < len; ++j)
+            xw[j] = ((m >> j) & 1) ? xw[j] : yw[j];
+    }
+}
+
+QLE_RV_KERNEL void blend(Real* x, Real y, const std::uint64_t* mask, Size n) {
+    for (Size w = 0; w * 64 < n; ++w) {
+        const std::uint64_t m = mask[w];
+        const Size len = n - w * 64 < 64 ? n - w * 64 : 64;
+        Real* xw = x + w * 64;
+        for (Size j = 0; j < len; ++j)
+            xw[j] = ((m >> j) & 1) ? xw[j] : y;
+    }
+}
+
+} // namespace RandomVariableKernels
+} // namespace QuantExt
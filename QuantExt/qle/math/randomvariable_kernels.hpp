@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_kernels.hpp
+    \brief element wise kernels for RandomVariable
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace QuantExt {
+
+/*! Element wise kernels operating on arrays of n values, the result is written to x. The kernels are branch free
+    loops which the compiler vectorises. On x86-64 Linux builds with gcc they are compiled for AVX-512, AVX2 and the
+    baseline instruction set, the version matching the cpu is selected at runtime.
+
+    Accuracy of the transcendental kernels compared to the exact result, as measured over their domain:
+
+    - exp: below 1 ulp, results below the smallest normal number are subnormal or zero as for std::exp
+    - log: below 1.5 ulp
+    - normalCdf: relative error below 1E-15 for x >= -37.5 (W. J. Cody's rational approximations), zero below
+      -37.5193 where the result is not representable as a normal number
+    - normalPdf: relative error below 1E-15
+
+    \ingroup math
+*/
+namespace RandomVariableKernels {
+using QuantLib::Real;
+using QuantLib::Size;
+
+void add(Real* x, const Real* y, Size n);
+void subtract(Real* x, const Real* y, Size n);
+void multiply(Real* x, const Real* y, Size n);
+void divide(Real* x, const Real* y, Size n);
+void max(Real* x, const Real* y, Size n);
+void min(Real* x, const Real* y, Size n);
+
+//! sum of x[i] y[i], accumulated in eight partial sums so that the loop vectorises
+Real dot(const Real* x, const Real* y, Size n);
+
+void add(Real* x, Real y, Size n);
+void multiply(Real* x, Real y, Size n);
+void divide(Real* x, Real y, Size n);
+void max(Real* x, Real y, Size n);
+void min(Real* x, Real y, Size n);
+
+void negate(Real* x, Size n);
+void abs(Real* x, Size n);
+void sqrt(Real* x, Size n);
+void exp(Real* x, Size n);
+void log(Real* x, Size n);
+void normalCdf(Real* x, Size n);
+void normalPdf(Real* x, Size n);
+
+/*! Mask blends, x[i] is kept where bit i % 64 of mask[i / 64] is set and replaced by y (y[i]) otherwise. The mask
+    has the layout of the Filter words. */
+void blend(Real* x, const Real* y, const std::uint64_t* mask, Size n);
+void blend(Real* x, Real y, const std::uint64_t* mask, Size n);
+
+} // namespace RandomVariableKernels
+} // namespace QuantExt
@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+namespace QuantExt {
+
+namespace {
+
+std::atomic<bool> poolEnabled(true);
+
+// four classes per power of two, the class index is 4 (e - 9) + m - 5 for a class size m 2^(e - 2), m = 5, ..., 8
+constexpr std::size_t numberOfClasses = 4 * 56;
+
+std::size_t sizeClass(const std::size_t bytes, std::size_t& classBytes) {
+    // 2^e < bytes <= 2^(e + 1), e >= 9
+    std::size_t e = 9;
+    while ((std::size_t(1) << (e + 1)) < bytes)
+        ++e;
+    const std::size_t step = std::size_t(1) << (e - 2);
+    const std::size_t m = (bytes + step - 1) / step;
+    classBytes = m * step;
+    return 4 * (e - 9) + m - 5;
+}
+
+struct Pool {
+    Pool() : freeLists(numberOfClasses) { alive() = true; }
+    ~Pool() {
+        release();
+        alive() = false;
+    }
+    void release() {
+        for (auto& l : freeLists) {
+            for (auto p : l)
+                ::operator delete(p, std::align_val_t(RandomVariableBufferPool::alignment));
+            l.clear();
+        }
+        statistics.retainedBytes = 0;
+    }
+    // false once the pool of the thread is destroyed, buffers released after that are freed directly
+    static bool& alive() {
+        static thread_local bool a = false;
+        return a;
+    }
+    std::vector<std::vector<void*>> freeLists;
+    RandomVariableBufferPool::Statistics statistics;
+};
+
+Pool* pool() {
+    static thread_local Pool p;
+    return Pool::alive() ? &p : nullptr;
+}
+
+} // namespace
+
+void* RandomVariableBufferPool::allocate(const std::size_t bytes) {
+    if (bytes < minimumBytes)
+        return ::operator new(std::max<std::size_t>(bytes, 1), std::align_val_t(alignment));
+    // the buffer has the class size even if pooling is off, since it might be returned to the pool later on
+    std::size_t classBytes;
+    std::size_t c = sizeClass(bytes, classBytes);
+    Pool* p = enabled() ? pool() : nullptr;
+    if (p != nullptr) {
+        ++p->statistics.allocations;
+        auto& l = p->freeLists[c];
+        if (!l.empty()) {
+            void* b = l.back();
+            l.pop_back();
+            ++p->statistics.allocationsAvoided;
+            p->statistics.retainedBytes -= classBytes;
+            return b;
+        }
+    }
+    return ::operator new(classBytes, std::align_val_t(alignment));
+}
+
+void RandomVariableBufferPool::deallocate(void* b, const std::size_t bytes) noexcept {
+    if (b == nullptr)
+        return;
+    if (bytes >= minimumBytes && enabled()) {
+        std::size_t classBytes;
+        std::size_t c = sizeClass(bytes, classBytes);
+        Pool* p = pool();
+        if (p != nullptr && p->freeLists[c].size() < maxBuffersPerClass &&
+            p->statistics.retainedBytes + classBytes <= maxRetainedBytes) {
+            try {
+                p->freeLists[c].push_back(b);
+                p->statistics.retainedBytes += classBytes;
+                return;
+            } catch (...) {
+            }
+        }
+    }
+    ::operator delete(b, std::align_val_t(alignment));
+}
+
+RandomVariableBufferPool::Statistics RandomVariableBufferPool::statistics() {
+    Pool* p = pool();
+    return p ? p->statistics : Statistics();
+}
+
+void RandomVariableBufferPool::resetStatistics() {
+    if (Pool* p = pool()) {
+        p->statistics.allocations = 0;
+        p->statistics.allocationsAvoided = 0;
+    }
+}
+
+void RandomVariableBufferPool::releaseMemory() {
+    if (Pool* p = pool())
+        p->release();
+}
+
+void RandomVariableBufferPool::setEnabled(const bool enabled) {
+    poolEnabled.store(enabled, std::memory_order_relaxed);
+    if (!enabled)
+        releaseMemory();
+}
+
+bool RandomVariableBufferPool::enabled() { return poolEnabled.load(std::memory_order_relaxed); }
+
+} // namespace QuantExt
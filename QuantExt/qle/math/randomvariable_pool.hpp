@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_pool.hpp
+    \brief thread local buffer pool for the path values of random variables
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <cstddef>
+
+namespace QuantExt {
+using QuantLib::Size;
+
+//! Thread local, size classed pool of 64 byte aligned buffers backing the RandomVariable storage
+/*! Requests of at least minimumBytes are rounded up to a size class, there are four classes per power of two, so
+    that at most 25% of a buffer are unused. Released buffers are kept in a free list of the releasing thread and
+    handed out again by later requests of the same size class on that thread. Smaller requests go to the global
+    allocator directly.
+
+    A thread retains at most maxBuffersPerClass buffers per size class and maxRetainedBytes in total. The retained
+    memory is freed at thread exit or by releaseMemory(). Pooling can be switched off globally, released buffers are
+    then freed immediately.
+
+    \ingroup math
+*/
+class RandomVariableBufferPool {
+public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t minimumBytes = 1024;
+    static constexpr std::size_t maxBuffersPerClass = 16;
+    static constexpr std::size_t maxRetainedBytes = std::size_t(256) << 20;
+
+    //! Allocation statistics of the calling thread
+    struct Statistics {
+        //! number of requests of at least minimumBytes
+        Size allocations = 0;
+        //! number of these requests served from the pool
+        Size allocationsAvoided = 0;
+        //! bytes currently retained in the pool
+        std::size_t retainedBytes = 0;
+    };
+
+    static void* allocate(std::size_t bytes);
+    static void deallocate(void* p, std::size_t bytes) noexcept;
+
+    static Statistics statistics();
+    static void resetStatistics();
+    //! free the buffers retained by the calling thread
+    static void releaseMemory();
+
+    //! switch pooling on or off for all threads, it is on by default
+    static void setEnabled(bool enabled);
+    static bool enabled();
+};
+
+//! Allocator drawing from the RandomVariableBufferPool
+template <class T> struct RandomVariableAllocator {
+    typedef T value_type;
+    RandomVariableAllocator() noexcept {}
+    template <class U> RandomVariableAllocator(const RandomVariableAllocator<U>&) noexcept {}
+    T* allocate(std::size_t n) { return static_cast<T*>(RandomVariableBufferPool::allocate(n * sizeof(T))); }
+    void deallocate(T* p, std::size_t n) noexcept { RandomVariableBufferPool::deallocate(p, n * sizeof(T)); }
+};
+
+template <class T, class U>
+bool operator==(const RandomVariableAllocator<T>&, const RandomVariableAllocator<U>&) noexcept {
+    return true;
+}
+template <class T, class U>
+bool operator!=(const RandomVariableAllocator<T>&, const RandomVariableAllocator<U>&) noexcept {
+    return false;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,260 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_tape.hpp>
+
+#include <ql/errors.hpp>
+
+namespace QuantExt {
+
+RandomVariableTape::RandomVariableTape(const Size n, const Real eps, const Size regressionOrder)
+    : n_(n), eps_(eps), regressionOrder_(regressionOrder) {
+    QL_REQUIRE(n_ > 0, "RandomVariableTape: number of paths must be positive");
+}
+
+Size RandomVariableTape::createInput(const RandomVariable& value) {
+    QL_REQUIRE(value.size() == n_,
+               "RandomVariableTape::createInput(): input has size " << value.size() << ", expected " << n_);
+    nodes_.push_back(Node{RandomVariableOpCode::None, {}});
+    values_.push_back(value);
+    return values_.size() - 1;
+}
+
+Size RandomVariableTape::applyOperation(const Size randomVariableOpCode, const std::vector<Size>& args) {
+    QL_REQUIRE(randomVariableOpCode <= RandomVariableOpCode::NormalPdf,
+               "RandomVariableTape::applyOperation(): unknown op code " << randomVariableOpCode);
+    QL_REQUIRE(!args.empty(), "RandomVariableTape::applyOperation(): no arguments given for op code "
+                                  << getRandomVariableOpLabels()[randomVariableOpCode]);
+    for (auto const a : args)
+        QL_REQUIRE(a < values_.size(), "RandomVariableTape::applyOperation(): node " << a << " is not defined");
+
+    const Size nArgs = randomVariableOpCode == RandomVariableOpCode::None ||
+                               randomVariableOpCode == RandomVariableOpCode::Negative ||
+                               (randomVariableOpCode >= RandomVariableOpCode::Abs &&
+                                randomVariableOpCode != RandomVariableOpCode::Pow)
+                           ? 1
+                           : 2;
+    QL_REQUIRE(randomVariableOpCode == RandomVariableOpCode::ConditionalExpectation || args.size() == nArgs,
+               "RandomVariableTape::applyOperation(): op code " << getRandomVariableOpLabels()[randomVariableOpCode]
+                                                                << " requires " << nArgs << " arguments, got "
+                                                                << args.size());
+
+    const RandomVariable& x = values_[args[0]];
+    const RandomVariable& y = args.size() > 1 ? values_[args[1]] : x;
+    RandomVariable r;
+
+    switch (randomVariableOpCode) {
+    case RandomVariableOpCode::None:
+        r = x;
+        break;
+    case RandomVariableOpCode::Add:
+        r = x + y;
+        break;
+    case RandomVariableOpCode::Subtract:
+        r = x - y;
+        break;
+    case RandomVariableOpCode::Negative:
+        r = -x;
+        break;
+    case RandomVariableOpCode::Mult:
+        r = x * y;
+        break;
+    case RandomVariableOpCode::Div:
+        r = x / y;
+        break;
+    case RandomVariableOpCode::ConditionalExpectation: {
+        std::vector<const RandomVariable*> regressor;
+        for (Size i = 1; i < args.size(); ++i)
+            regressor.push_back(&values_[args[i]]);
+        r = regressor.empty() ? expectation(x)
+                              : conditionalExpectation(x, regressor, monomialBasis(regressor.size(), regressionOrder_));
+        break;
+    }
+    case RandomVariableOpCode::IndicatorEq:
+        r = indicatorEq(x, y);
+        break;
+    case RandomVariableOpCode::IndicatorGt:
+        r = indicatorGt(x, y);
+        break;
+    case RandomVariableOpCode::IndicatorGeq:
+        r = indicatorGeq(x, y);
+        break;
+    case RandomVariableOpCode::Min:
+        r = min(x, y);
+        break;
+    case RandomVariableOpCode::Max:
+        r = max(x, y);
+        break;
+    case RandomVariableOpCode::Abs:
+        r = abs(x);
+        break;
+    case RandomVariableOpCode::Exp:
+        r = exp(x);
+        break;
+    case RandomVariableOpCode::Sqrt:
+        r = sqrt(x);
+        break;
+    case RandomVariableOpCode::Log:
+        r = log(x);
+        break;
+    case RandomVariableOpCode::Pow:
+        r = pow(x, y);
+        break;
+    case RandomVariableOpCode::NormalCdf:
+        r = normalCdf(x);
+        break;
+    case RandomVariableOpCode::NormalPdf:
+        r = normalPdf(x);
+        break;
+    default:
+        QL_FAIL("RandomVariableTape::applyOperation(): no implementation for op code "
+                << randomVariableOpCode << " (" << getRandomVariableOpLabels()[randomVariableOpCode] << ")");
+    }
+
+    nodes_.push_back(Node{randomVariableOpCode, args});
+    values_.push_back(r);
+    return values_.size() - 1;
+}
+
+const RandomVariable& RandomVariableTape::value(const Size node) const {
+    QL_REQUIRE(node < values_.size(), "RandomVariableTape::value(): node " << node << " is not defined");
+    return values_[node];
+}
+
+std::vector<RandomVariable> RandomVariableTape::derivatives(const Size output) const {
+    QL_REQUIRE(output < values_.size(), "RandomVariableTape::derivatives(): node " << output << " is not defined");
+
+    // adjoints stay uninitialised as long as nothing is propagated to them, these nodes are skipped in the sweep
+
+    std::vector<RandomVariable> adj(values_.size());
+    adj[output] = RandomVariable(n_, 1.0);
+
+    auto add = [&adj](const Size node, const RandomVariable& c) {
+        if (adj[node].initialised())
+            adj[node] += c;
+        else
+            adj[node] = c;
+    };
+
+    for (Size k = output + 1; k > 0; --k) {
+        const Size i = k - 1;
+        const Node& node = nodes_[i];
+        if (!adj[i].initialised() || node.args.empty())
+            continue;
+        const RandomVariable& g = adj[i];
+        const RandomVariable& v = values_[i];
+        const RandomVariable& x = values_[node.args[0]];
+        const RandomVariable& y = node.args.size() > 1 ? values_[node.args[1]] : x;
+        switch (node.op) {
+        case RandomVariableOpCode::None:
+            add(node.args[0], g);
+            break;
+        case RandomVariableOpCode::Add:
+            add(node.args[0], g);
+            add(node.args[1], g);
+            break;
+        case RandomVariableOpCode::Subtract:
+            add(node.args[0], g);
+            add(node.args[1], -g);
+            break;
+        case RandomVariableOpCode::Negative:
+            add(node.args[0], -g);
+            break;
+        case RandomVariableOpCode::Mult:
+            add(node.args[0], g * y);
+            add(node.args[1], g * x);
+            break;
+        case RandomVariableOpCode::Div:
+            add(node.args[0], g / y);
+            add(node.args[1], -g * v / y);
+            break;
+        case RandomVariableOpCode::ConditionalExpectation: {
+            if (node.args.size() == 1) {
+                add(node.args[0], expectation(g));
+                break;
+            }
+            std::vector<const RandomVariable*> regressor;
+            for (Size j = 1; j < node.args.size(); ++j)
+                regressor.push_back(&values_[node.args[j]]);
+            add(node.args[0], conditionalExpectation(g, regressor, monomialBasis(regressor.size(), regressionOrder_)));
+            break;
+        }
+        case RandomVariableOpCode::IndicatorEq:
+            break;
+        case RandomVariableOpCode::IndicatorGt:
+        case RandomVariableOpCode::IndicatorGeq: {
+            RandomVariable d = g * indicatorDerivative(x - y, eps_);
+            add(node.args[0], d);
+            add(node.args[1], -d);
+            break;
+        }
+        case RandomVariableOpCode::Min: {
+            RandomVariable ind = indicatorGeq(y, x);
+            add(node.args[0], g * ind);
+            add(node.args[1], g * (RandomVariable(n_, 1.0) - ind));
+            break;
+        }
+        case RandomVariableOpCode::Max: {
+            RandomVariable ind = indicatorGeq(x, y);
+            add(node.args[0], g * ind);
+            add(node.args[1], g * (RandomVariable(n_, 1.0) - ind));
+            break;
+        }
+        case RandomVariableOpCode::Abs:
+            add(node.args[0], g * indicatorGeq(x, RandomVariable(n_, 0.0), 1.0, -1.0));
+            break;
+        case RandomVariableOpCode::Exp:
+            add(node.args[0], g * v);
+            break;
+        case RandomVariableOpCode::Sqrt:
+            add(node.args[0], g * RandomVariable(n_, 0.5) / v);
+            break;
+        case RandomVariableOpCode::Log:
+            add(node.args[0], g / x);
+            break;
+        case RandomVariableOpCode::Pow:
+            add(node.args[0], g * y * pow(x, y - RandomVariable(n_, 1.0)));
+            add(node.args[1], g * log(x) * v);
+            break;
+        case RandomVariableOpCode::NormalCdf:
+            add(node.args[0], g * normalPdf(x));
+            break;
+        case RandomVariableOpCode::NormalPdf:
+            add(node.args[0], -g * x * v);
+            break;
+        default:
+            QL_FAIL("RandomVariableTape::derivatives(): no implementation for op code "
+                    << node.op << " (" << getRandomVariableOpLabels()[node.op] << ")");
+        }
+    }
+
+    for (auto& a : adj) {
+        if (!a.initialised())
+            a = RandomVariable(n_, 0.0);
+    }
+
+    return adj;
+}
+
+void RandomVariableTape::clear() {
+    nodes_.clear();
+    values_.clear();
+}
+
+} // namespace QuantExt
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_tape.hpp
+    \brief reverse mode tape over random variable operations
+    \ingroup math
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+//! Reverse mode tape over RandomVariableOpCode operations
+/*! The tape records the random variables created as inputs and the operations applied to them, the operation codes
+    and arguments are the same as for ComputeContext::applyOperation(). The values of all nodes are computed when the
+    operation is applied and kept on the tape. derivatives() runs one backward sweep from an output node and returns
+    the path wise derivatives of the output w.r.t. all nodes. The derivative of the expectation of the output w.r.t. a
+    deterministic input is the expectation of the path wise derivative.
+
+    Non-differentiable operations are treated as follows:
+
+    - the indicators IndicatorGt and IndicatorGeq are differentiated using indicatorDerivative() with the smoothing
+      parameter eps, IndicatorEq has derivative zero
+    - ConditionalExpectation takes the regressand as first and the regressors as the remaining arguments, it uses a
+      monomial basis of the given order, the adjoint of the regressand is the conditional expectation of the result
+      adjoint w.r.t. the same regressors (Fries, 2017), the regressors are treated as constant
+    - Min, Max and Abs use the one sided derivatives selected by the forward values
+    - the derivative of Pow w.r.t. the exponent requires a positive base
+
+    \ingroup math
+*/
+class RandomVariableTape {
+public:
+    /*! n is the number of paths, eps the smoothing parameter for the indicator derivatives and regressionOrder the
+        order of the monomial basis used for conditional expectations */
+    explicit RandomVariableTape(const Size n, const Real eps = 0.2, const Size regressionOrder = 2);
+
+    //! the number of paths
+    Size size() const { return n_; }
+    //! the number of nodes on the tape
+    Size numberOfNodes() const { return values_.size(); }
+
+    //! record an input, returns its node id
+    Size createInput(const RandomVariable& value);
+    //! record an operation on previously recorded nodes, returns the node id of the result
+    Size applyOperation(const Size randomVariableOpCode, const std::vector<Size>& args);
+
+    //! the value of a node
+    const RandomVariable& value(const Size node) const;
+
+    /*! backward sweep from the given output node, the result holds the path wise derivatives of the output w.r.t.
+        each node on the tape, nodes which the output does not depend on get zero */
+    std::vector<RandomVariable> derivatives(const Size output) const;
+
+    //! remove all nodes from the tape
+    void clear();
+
+private:
+    struct Node {
+        Size op;
+        std::vector<Size> args;
+    };
+
+    Size n_;
+    Real eps_;
+    Size regressionOrder_;
+    std::vector<Node> nodes_;
+    std::vector<RandomVariable> values_;
+};
+
+} // namespace QuantExt
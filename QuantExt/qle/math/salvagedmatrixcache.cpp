@@ -0,0 +1,202 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/math/salvagedmatrixcache.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/functional/hash.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace QuantExt {
+
+using QuantLib::Matrix;
+using QuantLib::Size;
+
+namespace {
+const char magic[8] = {'O', 'R', 'E', 'S', 'M', 'C', '1', '\0'};
+
+template <class T> void write(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T> void read(std::ifstream& file, T& value, const std::string& fileName) {
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    QL_REQUIRE(file, "SalvagedMatrixCache: unexpected end of file " << fileName);
+}
+
+void writeMatrix(std::ofstream& file, const Matrix& m) {
+    write(file, static_cast<std::uint64_t>(m.rows()));
+    write(file, static_cast<std::uint64_t>(m.columns()));
+    if (!m.empty())
+        file.write(reinterpret_cast<const char*>(m.begin()), sizeof(QuantLib::Real) * m.rows() * m.columns());
+}
+
+Matrix readMatrix(std::ifstream& file, const std::string& fileName) {
+    std::uint64_t rows, columns;
+    read(file, rows, fileName);
+    read(file, columns, fileName);
+    Matrix m(rows, columns);
+    if (!m.empty()) {
+        file.read(reinterpret_cast<char*>(m.begin()), sizeof(QuantLib::Real) * rows * columns);
+        QL_REQUIRE(file, "SalvagedMatrixCache: unexpected end of file " << fileName);
+    }
+    return m;
+}
+
+bool equal(const Matrix& a, const Matrix& b) {
+    return a.rows() == b.rows() && a.columns() == b.columns() &&
+           (a.empty() || std::memcmp(a.begin(), b.begin(), sizeof(QuantLib::Real) * a.rows() * a.columns()) == 0);
+}
+} // namespace
+
+void SalvagedMatrixCache::enable(const Size capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    while (order_.size() > capacity_) {
+        entries_.erase(order_.front());
+        order_.pop_front();
+    }
+}
+
+bool SalvagedMatrixCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_ > 0;
+}
+
+bool SalvagedMatrixCache::get(const std::string& method, const Matrix& m, std::pair<Matrix, Matrix>& result) const {
+    Key key(method, hash(m));
+    boost::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto e = entries_.find(key);
+        if (e == entries_.end())
+            return false;
+        entry = e->second;
+    }
+    // the entries are immutable, so the comparison and the copy can be done outside the lock
+    if (!equal(entry->input, m))
+        return false;
+    result = entry->result;
+    return true;
+}
+
+void SalvagedMatrixCache::add(const std::string& method, const Matrix& m, const std::pair<Matrix, Matrix>& result) {
+    if (!enabled())
+        return;
+    auto entry = boost::make_shared<Entry>();
+    entry->input = m;
+    entry->result = result;
+    addImpl(Key(method, hash(m)), entry);
+}
+
+void SalvagedMatrixCache::addImpl(const Key& key, const boost::shared_ptr<const Entry>& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0)
+        return;
+    auto e = entries_.find(key);
+    if (e != entries_.end()) {
+        e->second = entry;
+        return;
+    }
+    if (order_.size() == capacity_) {
+        entries_.erase(order_.front());
+        order_.pop_front();
+    }
+    entries_[key] = entry;
+    order_.push_back(key);
+}
+
+Size SalvagedMatrixCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+/* The file consists of a magic string and the number of entries, followed by the entries, each one given by the
+   length and the characters of the method and the input matrix and the two result matrices, each matrix given by its
+   number of rows and columns and its entries in row major order. Numbers are written in native byte order. */
+
+void SalvagedMatrixCache::load(const std::string& fileName) {
+    if (!enabled())
+        return;
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+        return;
+    char m[sizeof(magic)];
+    file.read(m, sizeof(m));
+    QL_REQUIRE(file && std::memcmp(m, magic, sizeof(magic)) == 0,
+               "SalvagedMatrixCache: " << fileName << " is not a salvaged matrix cache file");
+    std::uint64_t n;
+    read(file, n, fileName);
+    for (std::uint64_t i = 0; i < n; ++i) {
+        std::uint64_t methodSize;
+        read(file, methodSize, fileName);
+        std::string method(methodSize, ' ');
+        file.read(&method[0], methodSize);
+        QL_REQUIRE(file, "SalvagedMatrixCache: unexpected end of file " << fileName);
+        auto entry = boost::make_shared<Entry>();
+        entry->input = readMatrix(file, fileName);
+        entry->result.first = readMatrix(file, fileName);
+        entry->result.second = readMatrix(file, fileName);
+        addImpl(Key(method, hash(entry->input)), entry);
+    }
+}
+
+void SalvagedMatrixCache::save(const std::string& fileName) const {
+    std::ofstream file(fileName, std::ios::binary);
+    QL_REQUIRE(file.is_open(), "SalvagedMatrixCache: error opening file " << fileName);
+    std::lock_guard<std::mutex> lock(mutex_);
+    file.write(magic, sizeof(magic));
+    write(file, static_cast<std::uint64_t>(order_.size()));
+    for (auto const& k : order_) {
+        auto const& e = entries_.at(k);
+        write(file, static_cast<std::uint64_t>(k.first.size()));
+        file.write(k.first.data(), k.first.size());
+        writeMatrix(file, e->input);
+        writeMatrix(file, e->result.first);
+        writeMatrix(file, e->result.second);
+    }
+    QL_REQUIRE(file, "SalvagedMatrixCache: error writing file " << fileName);
+}
+
+std::size_t SalvagedMatrixCache::hash(const Matrix& m) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, m.rows());
+    boost::hash_combine(seed, m.columns());
+    if (!m.empty())
+        boost::hash_range(seed, m.begin(), m.end());
+    return seed;
+}
+
+Matrix cachedPseudoSqrt(const Matrix& m, QuantLib::SalvagingAlgorithm::Type sa) {
+    SalvagedMatrixCache& cache = SalvagedMatrixCache::instance();
+    if (!cache.enabled())
+        return QuantLib::pseudoSqrt(m, sa);
+    std::string method = "pseudoSqrt_" + std::to_string(static_cast<int>(sa));
+    std::pair<Matrix, Matrix> result;
+    if (cache.get(method, m, result))
+        return result.second;
+    result.second = QuantLib::pseudoSqrt(m, sa);
+    cache.add(method, m, result);
+    return result.second;
+}
+
+} // namespace QuantExt
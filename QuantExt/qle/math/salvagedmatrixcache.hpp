@@ -0,0 +1,102 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/math/salvagedmatrixcache.hpp
+    \brief cache for salvaged correlation / covariance matrices and their square roots
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/math/matrix.hpp>
+#include <ql/math/matrixutilities/pseudosqrt.hpp>
+#include <ql/patterns/singleton.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace QuantExt {
+
+//! Cache for salvaged matrices and their square roots
+/*! Salvaging a correlation or covariance matrix and computing its pseudo square root is expensive for large
+    matrices, and the same matrices are often processed several times in a run, e.g. by several analytics or under
+    sensitivity scenarios that do not change them. While the cache is enabled, the results are stored under the
+    method and a hash of the matrix content, a hit is only reported if the stored input matrix equals the given one
+    exactly. On a hash collision the older entry is replaced.
+
+    At most capacity entries are kept, the oldest entry is dropped first. The cache can be saved to and loaded from a
+    binary file, so that the results can be reused across runs. The cache is shared by all threads.
+*/
+class SalvagedMatrixCache : public QuantLib::Singleton<SalvagedMatrixCache, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<SalvagedMatrixCache, std::integral_constant<bool, true>>;
+
+private:
+    SalvagedMatrixCache() = default;
+
+public:
+    //! The input matrix and the result of the method, the second matrix of the result may be empty
+    struct Entry {
+        QuantLib::Matrix input;
+        std::pair<QuantLib::Matrix, QuantLib::Matrix> result;
+    };
+
+    //! Enable the cache with the given maximum number of entries, zero disables it
+    void enable(const QuantLib::Size capacity);
+    //! Disable and clear the cache
+    void disable() { enable(0); }
+    //! True if the cache is enabled
+    bool enabled() const;
+
+    //! Get the cached result of the method for m, returns false if there is none
+    bool get(const std::string& method, const QuantLib::Matrix& m,
+             std::pair<QuantLib::Matrix, QuantLib::Matrix>& result) const;
+    //! Add the result of the method for m, does nothing if the cache is disabled
+    void add(const std::string& method, const QuantLib::Matrix& m,
+             const std::pair<QuantLib::Matrix, QuantLib::Matrix>& result);
+
+    //! The number of entries in the cache
+    QuantLib::Size size() const;
+
+    //! Add the entries stored in the file, a missing file is ignored, does nothing if the cache is disabled
+    void load(const std::string& fileName);
+    //! Write all entries to the file
+    void save(const std::string& fileName) const;
+
+    //! Hash of the dimensions and the entries of the matrix
+    static std::size_t hash(const QuantLib::Matrix& m);
+
+private:
+    typedef std::pair<std::string, std::size_t> Key;
+    void addImpl(const Key& key, const boost::shared_ptr<const Entry>& entry);
+
+    mutable std::mutex mutex_;
+    QuantLib::Size capacity_ = 0;
+    std::map<Key, boost::shared_ptr<const Entry>> entries_;
+    // the keys in the order the entries were added
+    std::list<Key> order_;
+};
+
+/*! QuantLib's pseudoSqrt(), the result is taken from and stored in the SalvagedMatrixCache if this is enabled */
+QuantLib::Matrix cachedPseudoSqrt(const QuantLib::Matrix& m,
+                                  QuantLib::SalvagingAlgorithm::Type sa = QuantLib::SalvagingAlgorithm::None);
+
+} // namespace QuantExt
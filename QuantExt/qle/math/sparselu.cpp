@@ -0,0 +1,383 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/sparselu.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+using boost::numeric::ublas::vector;
+
+namespace {
+const char magic[8] = {'O', 'R', 'E', 'S', 'P', 'L', 'U', '\0'};
+const std::uint32_t version = 1;
+
+template <class T> void write(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T> void read(std::istream& is, T& value) {
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+    QL_REQUIRE(is, "SparseLU: unexpected end of stream");
+}
+
+void writeSizes(std::ostream& os, const std::vector<Size>& v) {
+    write(os, static_cast<std::uint64_t>(v.size()));
+    for (auto const& s : v)
+        write(os, static_cast<std::uint64_t>(s));
+}
+
+void writeReals(std::ostream& os, const std::vector<Real>& v) {
+    write(os, static_cast<std::uint64_t>(v.size()));
+    for (auto const& r : v)
+        write(os, static_cast<double>(r));
+}
+
+void readSizes(std::istream& is, std::vector<Size>& v) {
+    std::uint64_t n, s;
+    read(is, n);
+    v.resize(n);
+    for (auto& t : v) {
+        read(is, s);
+        t = static_cast<Size>(s);
+    }
+}
+
+void readReals(std::istream& is, std::vector<Real>& v) {
+    std::uint64_t n;
+    double r;
+    read(is, n);
+    v.resize(n);
+    for (auto& t : v) {
+        read(is, r);
+        t = r;
+    }
+}
+} // namespace
+
+SparseLU::SparseLU(const SparseMatrix& A, Real pivotThreshold) : n_(A.size1()), normA_(0.0) {
+    QL_REQUIRE(A.size1() == A.size2(), "SparseLU: matrix (" << A.size1() << "x" << A.size2() << ") is not square");
+    QL_REQUIRE(n_ > 0, "SparseLU: empty matrix");
+    QL_REQUIRE(pivotThreshold > 0.0 && pivotThreshold <= 1.0,
+               "SparseLU: pivot threshold (" << pivotThreshold << ") must be in (0,1]");
+
+    const Size none = Null<Size>();
+
+    // A in compressed column format, the row indices in each column are increasing
+    std::vector<Size> ap(n_ + 1, 0), ai, pos;
+    std::vector<Real> ax, colNorm(n_, 0.0);
+    for (auto i1 = A.begin1(); i1 != A.end1(); ++i1)
+        for (auto i2 = i1.begin(); i2 != i1.end(); ++i2)
+            ++ap[i2.index2() + 1];
+    for (Size j = 0; j < n_; ++j)
+        ap[j + 1] += ap[j];
+    ai.resize(ap[n_]);
+    ax.resize(ap[n_]);
+    pos.assign(ap.begin(), ap.end() - 1);
+    for (auto i1 = A.begin1(); i1 != A.end1(); ++i1) {
+        for (auto i2 = i1.begin(); i2 != i1.end(); ++i2) {
+            Size p = pos[i2.index2()]++;
+            ai[p] = i2.index1();
+            ax[p] = *i2;
+            colNorm[i2.index2()] += std::abs(*i2);
+        }
+    }
+    for (auto const& c : colNorm)
+        normA_ = std::max(normA_, c);
+
+    pinv_.assign(n_, none);
+    lp_.assign(1, 0);
+    up_.assign(1, 0);
+    li_.clear();
+    lx_.clear();
+    ui_.clear();
+    ux_.clear();
+
+    std::vector<Real> x(n_, 0.0);
+    std::vector<Size> xi(n_), stack(n_), pstack(n_);
+    std::vector<char> marked(n_, 0);
+
+    for (Size k = 0; k < n_; ++k) {
+
+        // nonzero pattern of L^{-1} A(:,k) in topological order, by depth first search in the graph of L,
+        // the pattern is stored in xi[top], ..., xi[n-1]
+
+        Size top = n_;
+        for (Size p = ap[k]; p < ap[k + 1]; ++p) {
+            if (marked[ai[p]])
+                continue;
+            Size head = 0;
+            stack[0] = ai[p];
+            while (true) {
+                Size j = stack[head];
+                Size J = pinv_[j];
+                if (!marked[j]) {
+                    marked[j] = 1;
+                    pstack[head] = J == none ? 0 : lp_[J] + 1;
+                }
+                Size end = J == none ? 0 : lp_[J + 1];
+                bool done = true;
+                for (Size q = pstack[head]; q < end; ++q) {
+                    if (marked[li_[q]])
+                        continue;
+                    pstack[head] = q + 1;
+                    stack[++head] = li_[q];
+                    done = false;
+                    break;
+                }
+                if (done) {
+                    xi[--top] = j;
+                    if (head == 0)
+                        break;
+                    --head;
+                }
+            }
+        }
+        for (Size p = top; p < n_; ++p)
+            marked[xi[p]] = 0;
+
+        // sparse triangular solve x = L \ A(:,k)
+
+        for (Size p = top; p < n_; ++p)
+            x[xi[p]] = 0.0;
+        for (Size p = ap[k]; p < ap[k + 1]; ++p)
+            x[ai[p]] = ax[p];
+        for (Size p = top; p < n_; ++p) {
+            Size j = xi[p];
+            Size J = pinv_[j];
+            if (J == none)
+                continue;
+            for (Size q = lp_[J] + 1; q < lp_[J + 1]; ++q)
+                x[li_[q]] -= lx_[q] * x[j];
+        }
+
+        // store U(:,k) and choose the pivot among the rows not pivoted yet
+
+        Size ipiv = none;
+        Real a = -1.0;
+        for (Size p = top; p < n_; ++p) {
+            Size i = xi[p];
+            if (pinv_[i] == none) {
+                Real t = std::abs(x[i]);
+                if (t > a) {
+                    a = t;
+                    ipiv = i;
+                }
+            } else {
+                ui_.push_back(pinv_[i]);
+                ux_.push_back(x[i]);
+            }
+        }
+        QL_REQUIRE(ipiv != none && a > 0.0, "SparseLU: matrix is singular, no pivot found in column " << k);
+        if (pinv_[k] == none && std::abs(x[k]) >= pivotThreshold * a)
+            ipiv = k;
+
+        Real pivot = x[ipiv];
+        ui_.push_back(k);
+        ux_.push_back(pivot);
+        up_.push_back(ui_.size());
+        pinv_[ipiv] = k;
+
+        // store L(:,k), the row indices are relabelled below
+
+        li_.push_back(ipiv);
+        lx_.push_back(1.0);
+        for (Size p = top; p < n_; ++p) {
+            Size i = xi[p];
+            if (pinv_[i] == none) {
+                li_.push_back(i);
+                lx_.push_back(x[i] / pivot);
+            }
+            x[i] = 0.0;
+        }
+        lp_.push_back(li_.size());
+    }
+
+    for (auto& i : li_)
+        i = pinv_[i];
+}
+
+vector<Real> SparseLU::solve(const vector<Real>& b) const {
+    QL_REQUIRE(b.size() == n_, "SparseLU::solve(): vector size (" << b.size() << ") does not match matrix size ("
+                                                                   << n_ << ")");
+    vector<Real> x(n_);
+    for (Size i = 0; i < n_; ++i)
+        x[pinv_[i]] = b[i];
+    // L is unit lower triangular
+    for (Size j = 0; j < n_; ++j) {
+        if (x[j] == 0.0)
+            continue;
+        for (Size p = lp_[j] + 1; p < lp_[j + 1]; ++p)
+            x[li_[p]] -= lx_[p] * x[j];
+    }
+    for (Size j = n_; j > 0; --j) {
+        x[j - 1] /= ux_[up_[j] - 1];
+        if (x[j - 1] == 0.0)
+            continue;
+        for (Size p = up_[j - 1]; p < up_[j] - 1; ++p)
+            x[ui_[p]] -= ux_[p] * x[j - 1];
+    }
+    return x;
+}
+
+void SparseLU::solve(Matrix& B) const {
+    QL_REQUIRE(B.rows() == n_, "SparseLU::solve(): matrix rows (" << B.rows() << ") do not match matrix size (" << n_
+                                                                   << ")");
+    const Size m = B.columns();
+    if (m == 0)
+        return;
+    Matrix X(n_, m);
+    for (Size i = 0; i < n_; ++i)
+        std::copy(B[i], B[i] + m, X[pinv_[i]]);
+    // L is unit lower triangular
+    for (Size j = 0; j < n_; ++j) {
+        const Real* xj = X[j];
+        for (Size p = lp_[j] + 1; p < lp_[j + 1]; ++p) {
+            const Real l = lx_[p];
+            Real* xi = X[li_[p]];
+            for (Size k = 0; k < m; ++k)
+                xi[k] -= l * xj[k];
+        }
+    }
+    for (Size j = n_; j > 0; --j) {
+        Real* xj = X[j - 1];
+        const Real d = ux_[up_[j] - 1];
+        for (Size k = 0; k < m; ++k)
+            xj[k] /= d;
+        for (Size p = up_[j - 1]; p < up_[j] - 1; ++p) {
+            const Real u = ux_[p];
+            Real* xi = X[ui_[p]];
+            for (Size k = 0; k < m; ++k)
+                xi[k] -= u * xj[k];
+        }
+    }
+    std::swap(B, X);
+}
+
+vector<Real> SparseLU::solveTransposed(const vector<Real>& b) const {
+    QL_REQUIRE(b.size() == n_, "SparseLU::solveTransposed(): vector size ("
+                                   << b.size() << ") does not match matrix size (" << n_ << ")");
+    vector<Real> z(b);
+    for (Size j = 0; j < n_; ++j) {
+        for (Size p = up_[j]; p < up_[j + 1] - 1; ++p)
+            z[j] -= ux_[p] * z[ui_[p]];
+        z[j] /= ux_[up_[j + 1] - 1];
+    }
+    for (Size j = n_; j > 0; --j) {
+        for (Size p = lp_[j - 1] + 1; p < lp_[j]; ++p)
+            z[j - 1] -= lx_[p] * z[li_[p]];
+    }
+    vector<Real> x(n_);
+    for (Size i = 0; i < n_; ++i)
+        x[i] = z[pinv_[i]];
+    return x;
+}
+
+Real SparseLU::conditionNumberEstimate() const {
+    QL_REQUIRE(n_ > 0, "SparseLU::conditionNumberEstimate(): empty factorisation");
+    vector<Real> x(n_, 1.0 / static_cast<Real>(n_));
+    Real est = 0.0;
+    for (Size iter = 0; iter < 5; ++iter) {
+        vector<Real> y = solve(x);
+        Real newEst = 0.0;
+        for (auto const& v : y)
+            newEst += std::abs(v);
+        if (iter > 0 && newEst <= est)
+            break;
+        est = newEst;
+        for (auto& v : y)
+            v = v >= 0.0 ? 1.0 : -1.0;
+        vector<Real> z = solveTransposed(y);
+        Size jmax = 0;
+        Real zx = 0.0;
+        for (Size j = 0; j < n_; ++j) {
+            zx += z[j] * x[j];
+            if (std::abs(z[j]) > std::abs(z[jmax]))
+                jmax = j;
+        }
+        if (iter > 0 && std::abs(z[jmax]) <= zx)
+            break;
+        x = vector<Real>(n_, 0.0);
+        x[jmax] = 1.0;
+    }
+    return normA_ * est;
+}
+
+void SparseLU::save(std::ostream& os) const {
+    os.write(magic, sizeof(magic));
+    write(os, version);
+    write(os, static_cast<std::uint64_t>(n_));
+    write(os, static_cast<double>(normA_));
+    writeSizes(os, pinv_);
+    writeSizes(os, lp_);
+    writeSizes(os, li_);
+    writeReals(os, lx_);
+    writeSizes(os, up_);
+    writeSizes(os, ui_);
+    writeReals(os, ux_);
+    QL_REQUIRE(os, "SparseLU::save(): error writing to stream");
+}
+
+void SparseLU::load(std::istream& is) {
+    char m[sizeof(magic)];
+    std::uint32_t v;
+    std::uint64_t n;
+    double normA;
+    is.read(m, sizeof(m));
+    QL_REQUIRE(is && std::memcmp(m, magic, sizeof(magic)) == 0, "SparseLU::load(): stream is not a factorisation");
+    read(is, v);
+    QL_REQUIRE(v == version, "SparseLU::load(): unsupported version " << v);
+    read(is, n);
+    read(is, normA);
+    SparseLU tmp;
+    tmp.n_ = static_cast<Size>(n);
+    tmp.normA_ = normA;
+    readSizes(is, tmp.pinv_);
+    readSizes(is, tmp.lp_);
+    readSizes(is, tmp.li_);
+    readReals(is, tmp.lx_);
+    readSizes(is, tmp.up_);
+    readSizes(is, tmp.ui_);
+    readReals(is, tmp.ux_);
+    QL_REQUIRE(tmp.pinv_.size() == tmp.n_ && tmp.lp_.size() == tmp.n_ + 1 && tmp.up_.size() == tmp.n_ + 1 &&
+                   tmp.lp_.back() == tmp.li_.size() && tmp.li_.size() == tmp.lx_.size() &&
+                   tmp.up_.back() == tmp.ui_.size() && tmp.ui_.size() == tmp.ux_.size(),
+               "SparseLU::load(): inconsistent factorisation");
+    for (Size j = 0; j < tmp.n_; ++j) {
+        QL_REQUIRE(tmp.pinv_[j] < tmp.n_, "SparseLU::load(): invalid row permutation");
+        QL_REQUIRE(tmp.lp_[j] < tmp.lp_[j + 1] && tmp.up_[j] < tmp.up_[j + 1],
+                   "SparseLU::load(): invalid column pointers");
+    }
+    for (auto const& i : tmp.li_)
+        QL_REQUIRE(i < tmp.n_, "SparseLU::load(): invalid row index in L");
+    for (auto const& i : tmp.ui_)
+        QL_REQUIRE(i < tmp.n_, "SparseLU::load(): invalid row index in U");
+    *this = std::move(tmp);
+}
+
+} // namespace QuantExt
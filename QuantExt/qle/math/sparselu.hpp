@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/sparselu.hpp
+    \brief sparse LU factorisation with threshold partial pivoting
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/math/matrix.hpp>
+#include <ql/math/matrixutilities/sparsematrix.hpp>
+
+#include <boost/numeric/ublas/vector.hpp>
+
+#include <iosfwd>
+#include <vector>
+
+namespace QuantExt {
+
+//! Sparse LU factorisation \f$ PA = LU \f$ of a square matrix
+/*! The factorisation uses the left looking algorithm of Gilbert and Peierls, i.e. column k of L and U is computed by
+    a sparse triangular solve against the columns computed so far, so the cost is proportional to the number of
+    floating point operations and not to the matrix dimension. Row pivoting is done by threshold partial pivoting:
+    the diagonal element is kept if its absolute value is at least pivotThreshold times the largest candidate in its
+    column, otherwise the largest candidate is chosen. A threshold of 1 gives ordinary partial pivoting, smaller values
+    keep more of the original sparsity pattern. There is no column reordering, so the fill in depends on the ordering
+    of the input matrix.
+
+    The factors are the operator to apply, the inverse is never formed. Use solve() and solveTransposed() to apply
+    \f$ A^{-1} \f$ resp. \f$ A^{-T} \f$ to a vector. The factors can be written to and read from a binary stream.
+
+    Reference: T. A. Davis, Direct Methods for Sparse Linear Systems, SIAM 2006
+
+    \ingroup math
+*/
+class SparseLU {
+public:
+    //! Empty factorisation, use load() to populate it
+    SparseLU() : n_(0), normA_(0.0) {}
+    //! Factorise A, throws if a column without admissible pivot is encountered, i.e. A is singular
+    explicit SparseLU(const QuantLib::SparseMatrix& A, QuantLib::Real pivotThreshold = 0.1);
+
+    //! Dimension of the factorised matrix
+    QuantLib::Size size() const { return n_; }
+    //! Number of stored entries in L and U
+    QuantLib::Size nonZeros() const { return lx_.size() + ux_.size(); }
+
+    //! Solve \f$ Ax = b \f$
+    boost::numeric::ublas::vector<QuantLib::Real> solve(const boost::numeric::ublas::vector<QuantLib::Real>& b) const;
+    //! Solve \f$ A^T x = b \f$
+    boost::numeric::ublas::vector<QuantLib::Real>
+    solveTransposed(const boost::numeric::ublas::vector<QuantLib::Real>& b) const;
+    /*! Solve \f$ AX = B \f$ for all columns of \p B at once, \p B is overwritten by the solution. Each entry of the
+        factors is applied to a whole row of \p B, so the inner loops run over contiguous memory. The caller should
+        choose the number of columns such that \p B fits into the cache. */
+    void solve(QuantLib::Matrix& B) const;
+
+    /*! Estimate of the 1-norm condition number \f$ \|A\|_1 \|A^{-1}\|_1 \f$, the norm of the inverse is estimated
+        using Hager's algorithm, which requires a few solves only */
+    QuantLib::Real conditionNumberEstimate() const;
+
+    //! Write the factorisation to a binary stream
+    void save(std::ostream& os) const;
+    //! Read a factorisation written by save(), throws if the stream does not contain a valid factorisation
+    void load(std::istream& is);
+
+private:
+    QuantLib::Size n_;
+    QuantLib::Real normA_;
+    // row permutation, row i of A is row pinv_[i] of PA
+    std::vector<QuantLib::Size> pinv_;
+    // L (unit diagonal stored first in each column) and U (diagonal stored last) in compressed column format
+    std::vector<QuantLib::Size> lp_, li_, up_, ui_;
+    std::vector<QuantLib::Real> lx_, ux_;
+};
+
+} // namespace QuantExt
@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/math/tailstatistics.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+namespace QuantExt {
+
+using QuantLib::Size;
+
+TailStatistics rightTailStatistics(std::vector<Real> sample, const std::vector<Real>& p,
+                                   const std::vector<Real>& weights) {
+    const Size n = sample.size();
+    QL_REQUIRE(n > 0, "rightTailStatistics: empty sample");
+    for (auto q : p)
+        QL_REQUIRE(q >= 0.0 && q < 1.0, "rightTailStatistics: confidence level (" << q << ") must be in [0, 1)");
+
+    TailStatistics res;
+    res.quantiles.resize(p.size());
+    res.expectedShortfalls.resize(p.size());
+    if (p.empty())
+        return res;
+
+    if (weights.empty()) {
+        // tail sizes, computed as in the boost tail_quantile accumulator
+        std::vector<Size> tail(p.size());
+        Size maxTail = 1;
+        for (Size i = 0; i < p.size(); ++i) {
+            tail[i] = std::min(std::max(static_cast<Size>(std::ceil(n * (1.0 - p[i]))), Size(1)), n);
+            maxTail = std::max(maxTail, tail[i]);
+        }
+        // order the largest values only
+        std::nth_element(sample.begin(), sample.begin() + (maxTail - 1), sample.end(), std::greater<Real>());
+        std::sort(sample.begin(), sample.begin() + maxTail, std::greater<Real>());
+        std::vector<Real> tailSum(maxTail + 1, 0.0);
+        std::partial_sum(sample.begin(), sample.begin() + maxTail, tailSum.begin() + 1);
+        for (Size i = 0; i < p.size(); ++i) {
+            Size k = tail[i];
+            Real mass = n * (1.0 - p[i]);
+            res.quantiles[i] = sample[k - 1];
+            res.expectedShortfalls[i] = (tailSum[k - 1] + (mass - static_cast<Real>(k - 1)) * sample[k - 1]) / mass;
+        }
+        return res;
+    }
+
+    QL_REQUIRE(weights.size() == n,
+               "rightTailStatistics: sample size (" << n << ") does not match number of weights (" << weights.size()
+                                                    << ")");
+    Real sumWeights = 0.0;
+    for (auto w : weights) {
+        QL_REQUIRE(w >= 0.0, "rightTailStatistics: negative weight (" << w << ")");
+        sumWeights += w;
+    }
+    QL_REQUIRE(sumWeights > 0.0, "rightTailStatistics: weights sum to zero");
+
+    std::vector<Size> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&sample](Size a, Size b) { return sample[a] > sample[b]; });
+
+    // confidence levels in descending order, i.e. with increasing tail mass, so that one pass over the sorted
+    // sample serves all levels
+    std::vector<Size> levels(p.size());
+    std::iota(levels.begin(), levels.end(), 0);
+    std::sort(levels.begin(), levels.end(), [&p](Size a, Size b) { return p[a] > p[b]; });
+
+    Size j = 0;
+    Real cumWeight = 0.0, cumValue = 0.0;
+    for (auto l : levels) {
+        Real mass = 1.0 - p[l];
+        // advance to the first value at which the cumulative weight reaches the tail mass
+        while (j + 1 < n && cumWeight + weights[order[j]] / sumWeights < mass) {
+            Real w = weights[order[j]] / sumWeights;
+            cumWeight += w;
+            cumValue += w * sample[order[j]];
+            ++j;
+        }
+        Real x = sample[order[j]];
+        res.quantiles[l] = x;
+        res.expectedShortfalls[l] = (cumValue + (mass - cumWeight) * x) / mass;
+    }
+    return res;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/math/tailstatistics.hpp
+    \brief right tail quantiles and expected shortfalls of empirical distributions
+    \ingroup math
+*/
+
+#ifndef quantext_tailstatistics_hpp
+#define quantext_tailstatistics_hpp
+
+#include <ql/types.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using QuantLib::Real;
+
+//! right tail quantiles and expected shortfalls
+struct TailStatistics {
+    std::vector<Real> quantiles;
+    std::vector<Real> expectedShortfalls;
+};
+
+//! function that computes the right tail quantiles and expected shortfalls of a sample for several confidence levels
+/*! For a sample of size \f$N\f$ without weights the quantile at confidence level \f$p\f$ is the \f$n\f$-th largest
+    value with \f$n = \lceil N (1-p) \rceil\f$, as for the boost tail_quantile accumulator. Only the \f$n_{max}\f$
+    largest values for the smallest confidence level are ordered, using one nth_element and a sort of the tail, so
+    that the cost of additional confidence levels is negligible.
+
+    If weights are given, e.g. for age or volatility weighted historical scenarios, they are normalised to sum to one
+    and the quantile is the smallest value \f$x_{(k)}\f$ in descending order such that the weights of
+    \f$x_{(1)}, \ldots, x_{(k)}\f$ add up to at least \f$1-p\f$. In this case the whole sample is sorted.
+
+    The expected shortfall is the weighted average of the largest values carrying a total weight of \f$1-p\f$, where
+    the quantile itself enters partially,
+    \f[
+    ES_p = \frac{1}{1-p} \left( \sum_{j<k} w_{(j)} x_{(j)} + \left( 1-p-\sum_{j<k} w_{(j)} \right) x_{(k)} \right)
+    \f]
+    with \f$w = 1/N\f$ in the unweighted case.
+
+    The confidence levels must be in [0, 1), the results are in the order of the given levels. */
+TailStatistics rightTailStatistics(std::vector<Real> sample, const std::vector<Real>& p,
+                                   const std::vector<Real>& weights = std::vector<Real>());
+
+} // namespace QuantExt
+
+#endif
@@ -34,7 +34,8 @@ FdmDefaultableEquityJumpDiffusionOp::FdmDefaultableEquityJumpDiffusionOp(
     : mesher_(mesher), model_(model), direction_(direction), recovery_(recovery), discountingCurve_(discountingCurve),
       addCreditCurve_(addCreditCurve), addRecovery_(addRecovery), discountingSpread_(discountingSpread),
       dxMap_(FirstDerivativeOp(direction, mesher)), dxxMap_(SecondDerivativeOp(direction, mesher)),
-      mapT_(direction, mesher), recoveryTerm_(mesher_->locations(direction).size()) {}
+      mapT_(direction, mesher), recoveryTerm_(mesher_->locations(direction).size()),
+      S_(Exp(Array(mesher_->locations(direction).begin(), mesher_->locations(direction).end()))) {}
 
 Size FdmDefaultableEquityJumpDiffusionOp::size() const { return 1ul; }
 
@@ -48,7 +49,7 @@ void FdmDefaultableEquityJumpDiffusionOp::setTime(Time t1, Time t2) {
 
     Array h(n);
     for (Size i = 0; i < h.size(); ++i) {
-        h[i] = model_->h(t1, std::exp(mesher_->locations(direction_)[i]));
+        h[i] = model_->h(t1, S_[i]);
     }
 
     // overwrite discounting term with external curve and / or add external spread
@@ -82,14 +83,13 @@ void FdmDefaultableEquityJumpDiffusionOp::setTime(Time t1, Time t2) {
     mapT_.axpyb(drift, dxMap_, dxxMap_.mult(Array(n, 0.5 * v)), -(Array(n, r_dis) + h + h2));
 
     for (Size i = 0; i < n; ++i) {
-        Real S = std::exp(mesher_->locations(direction_)[i]);
-        Real cr = conversionRatio_ ? conversionRatio_(S) : Null<Real>();
+        Real cr = conversionRatio_ ? conversionRatio_(S_[i]) : Null<Real>();
         recoveryTerm_[i] = 0.0;
         if (recovery_) {
-            recoveryTerm_[i] += recovery_(t1, S, cr) * h[i];
+            recoveryTerm_[i] += recovery_(t1, S_[i], cr) * h[i];
         }
         if (addRecovery_) {
-            recoveryTerm_[i] += addRecovery_(t1, S, cr) * h2[i];
+            recoveryTerm_[i] += addRecovery_(t1, S_[i], cr) * h2[i];
         }
     }
 }
@@ -136,4 +136,10 @@ void FdmDefaultableEquityJumpDiffusionOp::setConversionRatio(const std::function
     conversionRatio_ = conversionRatio;
 }
 
+void FdmDefaultableEquityJumpDiffusionOp::setRecovery(const std::function<Real(Real, Real, Real)>& recovery,
+                                                      const std::function<Real(Real, Real, Real)>& addRecovery) {
+    recovery_ = recovery;
+    addRecovery_ = addRecovery;
+}
+
 } // namespace QuantExt
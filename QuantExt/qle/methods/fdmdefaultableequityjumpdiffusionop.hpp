@@ -67,6 +67,11 @@ public:
     // conversion ratio as a function of S, used to evaluate the recovery term
     void setConversionRatio(const std::function<Real(Real)>& conversionRatio);
 
+    /* replace the recovery functions, so that the operator (which only depends on the mesher and the model in
+       its structure) can be reused for several pricings, the coefficients are recomputed in setTime() */
+    void setRecovery(const std::function<Real(Real, Real, Real)>& recovery,
+                     const std::function<Real(Real, Real, Real)>& addRecovery = {});
+
 private:
     boost::shared_ptr<QuantLib::FdmMesher> mesher_;
     boost::shared_ptr<DefaultableEquityJumpDiffusionModel> model_;
@@ -81,6 +86,8 @@ private:
     QuantLib::TripleBandLinearOp dxxMap_;
     QuantLib::TripleBandLinearOp mapT_;
     Array recoveryTerm_;
+    // the equity spot levels on the mesher
+    Array S_;
 
     std::function<Real(Real)> conversionRatio_;
 };
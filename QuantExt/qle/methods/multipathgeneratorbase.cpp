@@ -20,10 +20,35 @@
 
 #include <boost/make_shared.hpp>
 
+#include <cstdint>
+#include <limits>
+
 using namespace QuantLib;
 
 namespace QuantExt {
 
+void MultiPathGeneratorBase::skipTo(Size sample) {
+    reset();
+    for (Size i = 0; i < sample; ++i)
+        next();
+}
+
+void MultiPathGeneratorBase::nextBlock(Size a, Size b, MultiPathBlock& block) {
+    QL_REQUIRE(a <= b, "MultiPathGeneratorBase::nextBlock(): invalid sample range [" << a << ", " << b << ")");
+    skipTo(a);
+    block.clear();
+    for (Size k = a; k < b; ++k) {
+        const MultiPath& path = next().value;
+        if (block.empty())
+            block.resize(path.assetNumber(),
+                         std::vector<std::vector<Real>>(path.pathSize(), std::vector<Real>(b - a)));
+        for (Size j = 0; j < path.assetNumber(); ++j) {
+            for (Size i = 0; i < path.pathSize(); ++i)
+                block[j][i][k - a] = path[j][i];
+        }
+    }
+}
+
 MultiPathGeneratorMersenneTwister::MultiPathGeneratorMersenneTwister(
     const boost::shared_ptr<StochasticProcess>& process, const TimeGrid& grid, BigNatural seed, bool antitheticSampling)
     : process_(process), grid_(grid), seed_(seed), antitheticSampling_(antitheticSampling), antitheticVariate_(true) {
@@ -36,6 +61,21 @@ void MultiPathGeneratorMersenneTwister::reset() {
     antitheticVariate_ = true;
 }
 
+void MultiPathGeneratorMersenneTwister::skipTo(Size sample) {
+    // with antithetic sampling two consecutive paths share the same variates
+    Size draws = antitheticSampling_ ? sample / 2 : sample;
+    PseudoRandom::ursg_type usg(process_->factors() * (grid_.size() - 1), seed_);
+    for (Size i = 0; i < draws; ++i)
+        usg.nextInt32Sequence();
+    pg_ = boost::make_shared<MultiPathGenerator<PseudoRandom::rsg_type> >(process_, grid_, PseudoRandom::rsg_type(usg),
+                                                                          false);
+    antitheticVariate_ = true;
+    if (antitheticSampling_ && sample % 2 == 1) {
+        pg_->next();
+        antitheticVariate_ = false;
+    }
+}
+
 MultiPathGeneratorSobol::MultiPathGeneratorSobol(const boost::shared_ptr<StochasticProcess>& process,
                                                  const TimeGrid& grid, BigNatural seed,
                                                  SobolRsg::DirectionIntegers directionIntegers)
@@ -50,6 +90,15 @@ void MultiPathGeneratorSobol::reset() {
             SobolRsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_)));
 }
 
+void MultiPathGeneratorSobol::skipTo(Size sample) {
+    QL_REQUIRE(sample <= std::numeric_limits<std::uint32_t>::max(),
+               "MultiPathGeneratorSobol::skipTo(): sample " << sample << " out of range");
+    SobolRsg rsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_);
+    rsg.skipTo(static_cast<std::uint32_t>(sample));
+    pg_ = boost::make_shared<MultiPathGenerator<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal> > >(
+        process_, grid_, InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(rsg));
+}
+
 MultiPathGeneratorSobolBrownianBridge::MultiPathGeneratorSobolBrownianBridge(
     const boost::shared_ptr<StochasticProcess>& process, const TimeGrid& grid,
     SobolBrownianGenerator::Ordering ordering, BigNatural seed, SobolRsg::DirectionIntegers directionIntegers)
@@ -63,6 +112,12 @@ void MultiPathGeneratorSobolBrownianBridge::reset() {
                                                       directionIntegers_);
 }
 
+void MultiPathGeneratorSobolBrownianBridge::skipTo(Size sample) {
+    reset();
+    for (Size i = 0; i < sample; ++i)
+        gen_->nextPath();
+}
+
 const Sample<MultiPath>& MultiPathGeneratorSobolBrownianBridge::next() const {
     Array asset = process_->initialValues();
     MultiPath& path = next_.value;
@@ -84,6 +139,20 @@ const Sample<MultiPath>& MultiPathGeneratorSobolBrownianBridge::next() const {
     return next_;
 }
 
+MultiPathGeneratorPhilox::MultiPathGeneratorPhilox(const boost::shared_ptr<StochasticProcess>& process,
+                                                   const TimeGrid& grid, BigNatural seed)
+    : process_(process), grid_(grid), seed_(seed) {
+    reset();
+}
+
+void MultiPathGeneratorPhilox::reset() { skipTo(0); }
+
+void MultiPathGeneratorPhilox::skipTo(Size sample) {
+    PhiloxRsg rsg(process_->factors() * (grid_.size() - 1), seed_);
+    rsg.skipTo(sample);
+    pg_ = boost::make_shared<MultiPathGenerator<rsg_type> >(process_, grid_, rsg_type(rsg), false);
+}
+
 boost::shared_ptr<MultiPathGeneratorBase> makeMultiPathGenerator(const SequenceType s,
                                                                  const boost::shared_ptr<StochasticProcess>& process,
                                                                  const TimeGrid& timeGrid, const BigNatural seed,
@@ -99,6 +168,8 @@ boost::shared_ptr<MultiPathGeneratorBase> makeMultiPathGenerator(const SequenceT
     case SobolBrownianBridge:
         return boost::make_shared<QuantExt::MultiPathGeneratorSobolBrownianBridge>(process, timeGrid, ordering, seed,
                                                                                    directionIntegers);
+    case Philox:
+        return boost::make_shared<QuantExt::MultiPathGeneratorPhilox>(process, timeGrid, seed);
     default:
         QL_FAIL("Unknown sequence type");
     }
@@ -114,6 +185,8 @@ std::ostream& operator<<(std::ostream& out, const SequenceType s) {
         return out << "Sobol";
     case SobolBrownianBridge:
         return out << "SobolBrownianBridge";
+    case Philox:
+        return out << "Philox";
     default:
         return out << "Unknown sequence type";
     }
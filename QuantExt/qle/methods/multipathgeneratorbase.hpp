@@ -24,6 +24,8 @@
 #ifndef quantext_multi_path_generator_base_hpp
 #define quantext_multi_path_generator_base_hpp
 
+#include <qle/math/philoxrsg.hpp>
+
 #include <ql/math/randomnumbers/rngtraits.hpp>
 #include <ql/methods/montecarlo/brownianbridge.hpp>
 #include <ql/methods/montecarlo/multipath.hpp>
@@ -35,16 +37,28 @@
 namespace QuantExt {
 using namespace QuantLib;
 
-enum SequenceType { MersenneTwister, MersenneTwisterAntithetic, Sobol, SobolBrownianBridge };
+enum SequenceType { MersenneTwister, MersenneTwisterAntithetic, Sobol, SobolBrownianBridge, Philox };
+
+//! Paths for a range of samples in structure of arrays layout, values[asset][time][sample]
+typedef std::vector<std::vector<std::vector<Real>>> MultiPathBlock;
 
 //! Multi Path Generator Base
-/*! \ingroup methods
+/*! The paths are numbered in the order they are returned by next() after a reset(), starting at 0. A generator can
+    be positioned at an arbitrary path with skipTo(), so that a range of samples can be generated independently of
+    the preceding ones, e.g. on several threads with one generator instance per thread.
+
+    \ingroup methods
  */
 class MultiPathGeneratorBase {
 public:
     virtual ~MultiPathGeneratorBase() {}
     virtual const Sample<MultiPath>& next() const = 0;
     virtual void reset() = 0;
+    /*! the next call to next() returns the path with the given index, the default implementation resets the
+        generator and discards the preceding paths */
+    virtual void skipTo(Size sample);
+    //! generates the paths [a, b), the generator is positioned at b afterwards
+    void nextBlock(Size a, Size b, MultiPathBlock& block);
 };
 
 //! Instantiation of MultiPathGenerator with standard PseudoRandom traits
@@ -56,6 +70,8 @@ public:
                                       bool antitheticSampling = false);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    //! discards the underlying variates without evolving the process, this is still linear in the sample index
+    void skipTo(Size sample) override;
 
 private:
     const boost::shared_ptr<StochasticProcess> process_;
@@ -86,6 +102,8 @@ public:
                             SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    //! uses the direct Gray code initialisation of the Sobol sequence, the sample index must be less than 2^32
+    void skipTo(Size sample) override;
 
 private:
     const boost::shared_ptr<StochasticProcess> process_;
@@ -107,6 +125,11 @@ public:
                                           SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    /*! discards the preceding Brownian bridge paths without evolving the process, SobolBrownianGenerator does not
+        expose its underlying Sobol sequence, so this is linear in the sample index */
+    void skipTo(Size sample) override;
+    //! uses the direct Gray code initialisation of the Sobol sequence, the sample index must be less than 2^32
+    void skipTo(Size sample) override;
 
 private:
     const boost::shared_ptr<StochasticProcess> process_;
@@ -118,6 +141,27 @@ private:
     mutable Sample<MultiPath> next_;
 };
 
+//! Instantiation of MultiPathGenerator with the counter based PhiloxRsg
+/*! Skipping to a sample is O(1), this is the preferred sequence type for sample parallel simulations.
+
+    \ingroup methods
+*/
+class MultiPathGeneratorPhilox : public MultiPathGeneratorBase {
+public:
+    MultiPathGeneratorPhilox(const boost::shared_ptr<StochasticProcess>&, const TimeGrid&, BigNatural seed = 0);
+    const Sample<MultiPath>& next() const override;
+    void reset() override;
+    void skipTo(Size sample) override;
+
+private:
+    typedef InverseCumulativeRsg<PhiloxRsg, InverseCumulativeNormal> rsg_type;
+    const boost::shared_ptr<StochasticProcess> process_;
+    TimeGrid grid_;
+    BigNatural seed_;
+
+    boost::shared_ptr<MultiPathGenerator<rsg_type> > pg_;
+};
+
 //! Make function for path generators
 boost::shared_ptr<MultiPathGeneratorBase>
 makeMultiPathGenerator(const SequenceType s, const boost::shared_ptr<StochasticProcess>& process,
@@ -141,6 +185,8 @@ inline const Sample<MultiPath>& MultiPathGeneratorMersenneTwister::next() const
 
 inline const Sample<MultiPath>& MultiPathGeneratorSobol::next() const { return pg_->next(); }
 
+inline const Sample<MultiPath>& MultiPathGeneratorPhilox::next() const { return pg_->next(); }
+
 } // namespace QuantExt
 
 #endif
@@ -116,6 +116,19 @@ Sample<std::vector<Array>> MultiPathVariateGeneratorSobolBrownianBridge::next()
     return Sample<std::vector<Array>>(output, weight);
 }
 
+MultiPathVariateGeneratorPhilox::MultiPathVariateGeneratorPhilox(const Size dimension, const TimeGrid& grid,
+                                                                 BigNatural seed)
+    : MultiPathVariateGeneratorBase(dimension, grid), seed_(seed) {
+    reset();
+}
+
+void MultiPathVariateGeneratorPhilox::reset() {
+    rsg_ = boost::make_shared<InverseCumulativeRsg<PhiloxRsg, InverseCumulativeNormal>>(
+        PhiloxRsg(dimension_ * (grid_.size() - 1), seed_), InverseCumulativeNormal());
+}
+
+Sample<std::vector<Real>> MultiPathVariateGeneratorPhilox::nextSequence() const { return rsg_->nextSequence(); }
+
 boost::shared_ptr<MultiPathVariateGeneratorBase>
 makeMultiPathVariateGenerator(const SequenceType s, const Size dimension, const TimeGrid& timeGrid,
                               const BigNatural seed, const SobolBrownianGenerator::Ordering ordering,
@@ -131,6 +144,8 @@ makeMultiPathVariateGenerator(const SequenceType s, const Size dimension, const
     case SobolBrownianBridge:
         return boost::make_shared<QuantExt::MultiPathVariateGeneratorSobolBrownianBridge>(dimension, timeGrid, ordering,
                                                                                           seed, directionIntegers);
+    case Philox:
+        return boost::make_shared<QuantExt::MultiPathVariateGeneratorPhilox>(dimension, timeGrid, seed);
     default:
         QL_FAIL("Unknown sequence type");
     }
@@ -98,6 +98,19 @@ private:
     boost::shared_ptr<SobolBrownianGenerator> gen_;
 };
 
+class MultiPathVariateGeneratorPhilox : public MultiPathVariateGeneratorBase {
+public:
+    MultiPathVariateGeneratorPhilox(const Size dimension, const TimeGrid&, BigNatural seed = 0);
+    void reset() override;
+
+private:
+    Sample<std::vector<Real>> nextSequence() const override;
+
+    BigNatural seed_;
+
+    boost::shared_ptr<InverseCumulativeRsg<PhiloxRsg, InverseCumulativeNormal>> rsg_;
+};
+
 boost::shared_ptr<MultiPathVariateGeneratorBase>
 makeMultiPathVariateGenerator(const SequenceType s, const Size dimension, const TimeGrid& timeGrid,
                               const BigNatural seed,
@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/methods/brownianbridgepathinterpolator.hpp>
+#include <qle/methods/streamingmultipathgenerator.hpp>
+
+#include <boost/make_shared.hpp>
+
+namespace QuantExt {
+
+StreamingMultiPathGenerator::StreamingMultiPathGenerator(const boost::shared_ptr<StochasticProcess>& process,
+                                                         const TimeGrid& grid, Size blockSize, BigNatural seed,
+                                                         const std::vector<bool>& bridged)
+    : process_(process), grid_(grid), blockSize_(blockSize), seed_(seed), bridged_(bridged) {
+    QL_REQUIRE(process_, "StreamingMultiPathGenerator: no process given");
+    QL_REQUIRE(blockSize_ > 0, "StreamingMultiPathGenerator: block size must be positive");
+    QL_REQUIRE(grid_.size() > 1, "StreamingMultiPathGenerator: time grid must contain at least two points");
+    if (bridged_.empty())
+        bridged_.resize(grid_.size(), false);
+    QL_REQUIRE(bridged_.size() == grid_.size(), "StreamingMultiPathGenerator: bridged flags ("
+                                                    << bridged_.size() << ") do not match time grid size ("
+                                                    << grid_.size() << ")");
+    QL_REQUIRE(!bridged_.front(), "StreamingMultiPathGenerator: the first grid point can not be bridged");
+    // bridged points after the last simulated point are simulated
+    for (Size i = grid_.size() - 1; i > 0 && bridged_[i]; --i)
+        bridged_[i] = false;
+    reset();
+}
+
+void StreamingMultiPathGenerator::reset() {
+    rsg_ = boost::make_shared<PseudoRandom::rsg_type>(
+        PseudoRandom::make_sequence_generator(process_->factors() * blockSize_, seed_));
+    bridgeSeeds_ = boost::make_shared<MersenneTwisterUniformRng>(seed_);
+    step_ = segmentEnd_ = 0;
+    states_.clear();
+}
+
+void StreamingMultiPathGenerator::nextBlock() {
+    states_.assign(blockSize_, process_->initialValues());
+    step_ = segmentEnd_ = 0;
+}
+
+void StreamingMultiPathGenerator::nextSegment() {
+    // the segment runs from the current grid point to the next simulated grid point
+    Size start = step_;
+    segmentEnd_ = start + 1;
+    while (bridged_[segmentEnd_])
+        ++segmentEnd_;
+    Size n = segmentEnd_ - start, d = process_->factors();
+
+    variates_.assign(n, std::vector<RandomVariable>());
+    const std::vector<Real>& z = rsg_->nextSequence().value;
+    variates_.back().resize(d, RandomVariable(blockSize_));
+    for (Size j = 0; j < d; ++j)
+        for (Size s = 0; s < blockSize_; ++s)
+            variates_.back()[j].set(s, z[j * blockSize_ + s]);
+
+    if (n > 1) {
+        std::vector<Real> times(n);
+        for (Size k = 0; k < n; ++k)
+            times[k] = grid_[start + k + 1] - grid_[start];
+        interpolateVariatesWithBrownianBridge(times, variates_, bridgeSeeds_->nextInt32());
+    }
+}
+
+const std::vector<Array>& StreamingMultiPathGenerator::next() {
+    QL_REQUIRE(!states_.empty(), "StreamingMultiPathGenerator::next(): no block started, call nextBlock() first");
+    QL_REQUIRE(step_ + 1 < grid_.size(), "StreamingMultiPathGenerator::next(): end of time grid reached");
+    if (step_ == segmentEnd_)
+        nextSegment();
+    const std::vector<RandomVariable>& v = variates_[step_ + variates_.size() - segmentEnd_];
+    Real t = grid_[step_], dt = grid_.dt(step_);
+    Array dw(process_->factors());
+    for (Size s = 0; s < blockSize_; ++s) {
+        for (Size j = 0; j < dw.size(); ++j)
+            dw[j] = v[j][s];
+        states_[s] = process_->evolve(t, states_[s], dt, dw);
+    }
+    ++step_;
+    return states_;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file methods/streamingmultipathgenerator.hpp
+    \brief multi path generator emitting the states of a block of samples time step by time step
+    \ingroup methods
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <ql/math/randomnumbers/rngtraits.hpp>
+#include <ql/stochasticprocess.hpp>
+#include <ql/timegrid.hpp>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Streaming multi path generator
+/*! In contrast to the MultiPathGeneratorBase implementations, which return the whole path of one sample, this
+    generator evolves a block of samples time step by time step and only holds the current states of the block.
+    The memory consumption is therefore bounded by the block size and does not grow with the length of the time grid.
+
+    Time grid points can be flagged as bridged, typically the close-out dates of a valuation date grid. The process
+    is then only simulated on the remaining points, and the variates for the bridged points between two simulated
+    points are filled in using interpolateVariatesWithBrownianBridge() when the generator reaches the first of them.
+    Bridged points after the last simulated point are simulated as usual.
+
+    The variates are drawn from a pseudo random sequence (Mersenne twister), block by block and time step by time
+    step, the generated paths are therefore not identical to those of MultiPathGeneratorMersenneTwister.
+
+    \ingroup methods
+*/
+class StreamingMultiPathGenerator {
+public:
+    /*! The grid is expected to start at t=0, bridged is either empty or has the size of the grid and flags the
+        bridged grid points, the first grid point can not be bridged */
+    StreamingMultiPathGenerator(const boost::shared_ptr<StochasticProcess>& process, const TimeGrid& grid,
+                                Size blockSize, BigNatural seed = 0, const std::vector<bool>& bridged = {});
+
+    //! Start the next block of samples at the initial values of the process
+    void nextBlock();
+    //! Evolve the samples of the current block to the next grid point and return the states by sample
+    const std::vector<Array>& next();
+    //! Restart the random sequence
+    void reset();
+
+    //! The number of samples per block
+    Size blockSize() const { return blockSize_; }
+    //! The index of the grid point the current states refer to
+    Size step() const { return step_; }
+    //! The time grid
+    const TimeGrid& timeGrid() const { return grid_; }
+
+private:
+    void nextSegment();
+
+    boost::shared_ptr<StochasticProcess> process_;
+    TimeGrid grid_;
+    Size blockSize_;
+    BigNatural seed_;
+    std::vector<bool> bridged_;
+
+    boost::shared_ptr<PseudoRandom::rsg_type> rsg_;
+    boost::shared_ptr<MersenneTwisterUniformRng> bridgeSeeds_;
+
+    Size step_, segmentEnd_;
+    std::vector<Array> states_;
+    // variates by grid point (relative to the segment start) and factor, the components refer to the samples
+    std::vector<std::vector<RandomVariable>> variates_;
+};
+
+} // namespace QuantExt
@@ -295,6 +295,14 @@ Real Basket::expectedTrancheLoss(const Date& d, Real recoveryRate) const {
     return cumulatedLoss() + lossModel_->expectedTrancheLoss(d, recoveryRate);
 }
 
+std::vector<Real> Basket::expectedTrancheLosses(const std::vector<Date>& dates, Real recoveryRate) const {
+    calculate();
+    std::vector<Real> etls = lossModel_->expectedTrancheLosses(dates, recoveryRate);
+    for (auto& l : etls)
+        l += cumulatedLoss();
+    return etls;
+}
+
 std::vector<Real> Basket::splitVaRLevel(const Date& date, Real loss) const {
     calculate();
     return lossModel_->splitVaRLevel(date, loss);
@@ -436,6 +436,7 @@ struct Hz {
     Hz(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->irlgm1f(i_)->H(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! IR alpha component */
@@ -443,6 +444,7 @@ struct az {
     az(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->irlgm1f(i_)->alpha(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! IR zeta component */
@@ -450,6 +452,7 @@ struct zetaz {
     zetaz(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->irlgm1f(i_)->zeta(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! FX sigma component */
@@ -457,6 +460,7 @@ struct sx {
     sx(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->fxbs(i_)->sigma(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! FX variance component */
@@ -464,6 +468,7 @@ struct vx {
     vx(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->fxbs(i_)->variance(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 //! INF H component. May relate to real rate portion of JY model or z component of DK model.
@@ -480,6 +485,7 @@ struct Hy {
     }
 
     QuantLib::Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 //! INF alpha component. May relate to real rate portion of JY model or z component of DK model.
@@ -496,6 +502,7 @@ struct ay {
     }
 
     QuantLib::Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 //! INF zeta component. May relate to real rate portion of JY model or z component of DK model.
@@ -512,6 +519,7 @@ struct zetay {
     }
 
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 //! JY INF index sigma component
@@ -526,6 +534,7 @@ struct sy {
     }
 
     QuantLib::Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 //! JY INF index variance component
@@ -540,6 +549,7 @@ struct vy {
     }
 
     QuantLib::Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! CR H component */
@@ -547,6 +557,7 @@ struct Hl {
     Hl(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->crlgm1f(i_)->H(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! CR alpha component */
@@ -554,6 +565,7 @@ struct al {
     al(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->crlgm1f(i_)->alpha(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! CR zeta component */
@@ -561,6 +573,7 @@ struct zetal {
     zetal(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->crlgm1f(i_)->zeta(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! EQ sigma component */
@@ -568,6 +581,7 @@ struct ss {
     ss(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->eqbs(i_)->sigma(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! EQ variance component */
@@ -575,6 +589,7 @@ struct vs {
     vs(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->eqbs(i_)->variance(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! COM sigma component, non mean-reverting single-factor case */
@@ -582,6 +597,7 @@ struct coms {
     coms(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return x->combs(i_)->sigma(t); }
     const Size i_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); }
 };
 
 /*! IR-IR correlation component */
@@ -591,6 +607,7 @@ struct rzz {
         return x->correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::IR, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! IR-FX correlation component */
@@ -600,6 +617,7 @@ struct rzx {
         return x->correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::FX, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! FX-FX correlation component */
@@ -609,6 +627,7 @@ struct rxx {
         return x->correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::FX, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! INF-INF correlation component.
@@ -631,6 +650,12 @@ struct ryy {
     QuantLib::Size j_;
     QuantLib::Size iOffset_;
     QuantLib::Size jOffset_;
+    void key(std::vector<Real>& k) const {
+        k.push_back(i_);
+        k.push_back(j_);
+        k.push_back(iOffset_);
+        k.push_back(jOffset_);
+    }
 };
 
 /*! IR-INF correlation component */
@@ -643,6 +668,7 @@ struct rzy {
 
     const Size i_, j_;
     QuantLib::Size jOffset_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); k.push_back(jOffset_); }
 };
 
 /*! FX-INF correlation component */
@@ -655,6 +681,7 @@ struct rxy {
 
     const Size i_, j_;
     QuantLib::Size jOffset_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); k.push_back(jOffset_); }
 };
 
 /*! CR-CR correlation component */
@@ -664,6 +691,7 @@ struct rll {
         return x->correlation(CrossAssetModel::AssetType::CR, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! IR-CR correlation component */
@@ -673,6 +701,7 @@ struct rzl {
         return x->correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! FX-CR correlation component */
@@ -682,6 +711,7 @@ struct rxl {
         return x->correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! INF-CR correlation component */
@@ -694,6 +724,7 @@ struct ryl {
 
     const Size i_, j_;
     QuantLib::Size iOffset_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); k.push_back(iOffset_); }
 };
 
 /*! EQ-EQ correlation component */
@@ -703,6 +734,7 @@ struct rss {
         return x->correlation(CrossAssetModel::AssetType::EQ, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! IR-EQ correlation component */
@@ -712,6 +744,7 @@ struct rzs {
         return x->correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! FX-EQ correlation component */
@@ -721,6 +754,7 @@ struct rxs {
         return x->correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! INF-EQ correlation component */
@@ -733,6 +767,7 @@ struct rys {
 
     const Size i_, j_;
     QuantLib::Size iOffset_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); k.push_back(iOffset_); }
 };
 
 /*! CR-EQ correlation component */
@@ -742,6 +777,7 @@ struct rls {
         return x->correlation(CrossAssetModel::AssetType::CR, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! COM-COM correlation component, single-factor case */
@@ -751,6 +787,7 @@ struct rcc {
         return x->correlation(CrossAssetModel::AssetType::COM, i_, CrossAssetModel::AssetType::COM, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! H(t+T)-H(t) component (needed for analytical covariances of zero rates) */
@@ -759,6 +796,7 @@ struct HTtz {
     Real eval(const CrossAssetModel* x, const Real t) const { return x->irlgm1f(i_)->H(T_ + t) - x->irlgm1f(i_)->H(t); }
     const Size i_;
     const Real T_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(T_); }
 };
 
 /*! IR-CrState correlation component */
@@ -768,6 +806,7 @@ struct rzcrs {
         return x->correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! FX-CrState correlation component */
@@ -777,6 +816,7 @@ struct rxcrs {
         return x->correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 
 /*! CrState-CrState correlation component */
@@ -786,6 +826,7 @@ struct rccrs {
         return x->correlation(CrossAssetModel::AssetType::CrState, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
     const Size i_, j_;
+    void key(std::vector<Real>& k) const { k.push_back(i_); k.push_back(j_); }
 };
 /*! @} */
 
@@ -28,6 +28,9 @@
 
 #include <ql/types.hpp>
 
+#include <typeindex>
+#include <vector>
+
 #include <qle/models/crossassetmodel.hpp>
 
 namespace QuantExt {
@@ -42,13 +45,16 @@ namespace CrossAssetAnalytics {
 /*! generic integrand */
 template <class E> Real integral_helper(const CrossAssetModel* x, const E& e, const Real t);
 
-/*! generic integral calculation */
+/*! generic integral calculation, the results are cached in the model, see CrossAssetModel::integralCache(). To
+    identify an integral, each expression appends its parameters (component indices etc.) to the key in key(), the
+    structure of the expression is identified by its type. */
 template <typename E> Real integral(const CrossAssetModel* model, const E& e, const Real a, const Real b);
 
 /*! product expression, 2 factors */
 template <typename E1, typename E2> struct P2_ {
     P2_(const E1& e1, const E2& e2) : e1_(e1), e2_(e2) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return e1_.eval(x, t) * e2_.eval(x, t); }
+    void key(std::vector<Real>& k) const { e1_.key(k); e2_.key(k); }
     const E1& e1_;
     const E2& e2_;
 };
@@ -57,6 +63,7 @@ template <typename E1, typename E2> struct P2_ {
 template <typename E1, typename E2, typename E3> struct P3_ {
     P3_(const E1& e1, const E2& e2, const E3& e3) : e1_(e1), e2_(e2), e3_(e3) {}
     Real eval(const CrossAssetModel* x, const Real t) const { return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t); }
+    void key(std::vector<Real>& k) const { e1_.key(k); e2_.key(k); e3_.key(k); }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -68,6 +75,7 @@ template <typename E1, typename E2, typename E3, typename E4> struct P4_ {
     Real eval(const CrossAssetModel* x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t) * e4_.eval(x, t);
     }
+    void key(std::vector<Real>& k) const { e1_.key(k); e2_.key(k); e3_.key(k); e4_.key(k); }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -81,6 +89,7 @@ template <typename E1, typename E2, typename E3, typename E4, typename E5> struc
     Real eval(const CrossAssetModel* x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t) * e4_.eval(x, t) * e5_.eval(x, t);
     }
+    void key(std::vector<Real>& k) const { e1_.key(k); e2_.key(k); e3_.key(k); e4_.key(k); e5_.key(k); }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -117,6 +126,12 @@ template <typename E1> struct LC1_ {
         return c_ + c1_ * e1_.eval(x, t);
     }
 
+    void key(std::vector<Real>& k) const {
+        k.push_back(c_);
+        k.push_back(c1_);
+        e1_.key(k);
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -132,6 +147,14 @@ template <typename E1, typename E2> struct LC2_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t);
     }
     
+    void key(std::vector<Real>& k) const {
+        k.push_back(c_);
+        k.push_back(c1_);
+        e1_.key(k);
+        k.push_back(c2_);
+        e2_.key(k);
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -149,6 +172,16 @@ template <typename E1, typename E2, typename E3> struct LC3_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t) + c3_ * e3_.eval(x, t);
     }
 
+    void key(std::vector<Real>& k) const {
+        k.push_back(c_);
+        k.push_back(c1_);
+        e1_.key(k);
+        k.push_back(c2_);
+        e2_.key(k);
+        k.push_back(c3_);
+        e3_.key(k);
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -169,6 +202,18 @@ template <typename E1, typename E2, typename E3, typename E4> struct LC4_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t) + c3_ * e3_.eval(x, t) + c4_ * e4_.eval(x, t);
     }
 
+    void key(std::vector<Real>& k) const {
+        k.push_back(c_);
+        k.push_back(c1_);
+        e1_.key(k);
+        k.push_back(c2_);
+        e2_.key(k);
+        k.push_back(c3_);
+        e3_.key(k);
+        k.push_back(c4_);
+        e4_.key(k);
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -213,7 +258,16 @@ template <class E> inline Real integral_helper(const CrossAssetModel* x, const E
 }
 
 template <class E> inline Real integral(const CrossAssetModel* x, const E& e, const Real a, const Real b) {
-    return x->integrator()->operator()(boost::bind(&integral_helper<E>, x, e, boost::placeholders::_1), a, b);
+    if (!x->integralCache())
+        return x->integrator()->operator()(boost::bind(&integral_helper<E>, x, e, boost::placeholders::_1), a, b);
+    std::vector<Real> k = {a, b};
+    e.key(k);
+    Real result;
+    if (!x->cachedIntegral(typeid(E), k, result)) {
+        result = x->integrator()->operator()(boost::bind(&integral_helper<E>, x, e, boost::placeholders::_1), a, b);
+        x->cacheIntegral(typeid(E), k, result);
+    }
+    return result;
 }
 
 /*! @} */
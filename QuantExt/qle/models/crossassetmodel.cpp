@@ -157,6 +157,7 @@ Size CrossAssetModel::crName(const std::string& name) const {
 void CrossAssetModel::update() {
     cache_crlgm1fS_.clear();
     cache_infdkI_.clear();
+    cache_integral_.clear();
     for (Size i = 0; i < p_.size(); ++i) {
         p_[i]->update();
     }
@@ -273,6 +274,8 @@ void CrossAssetModel::initStateProcess() { stateProcess_ = boost::make_shared<Cr
 void CrossAssetModel::setIntegrationPolicy(const boost::shared_ptr<Integrator> integrator,
                                            const bool usePiecewiseIntegration) const {
 
+    cache_integral_.clear();
+
     if (!usePiecewiseIntegration) {
         integrator_ = integrator;
         return;
@@ -291,6 +294,27 @@ void CrossAssetModel::setIntegrationPolicy(const boost::shared_ptr<Integrator> i
     integrator_ = boost::make_shared<PiecewiseIntegral>(integrator, allTimes, true);
 }
 
+void CrossAssetModel::enableIntegralCache(const bool enable) const {
+    integralCacheEnabled_ = enable;
+    cache_integral_.clear();
+}
+
+bool CrossAssetModel::cachedIntegral(const std::type_index& expression, const std::vector<Real>& key,
+                                     Real& value) const {
+    auto c = cache_integral_.find(integral_cache_key{expression, key});
+    if (c == cache_integral_.end())
+        return false;
+    value = c->second;
+    return true;
+}
+
+void CrossAssetModel::cacheIntegral(const std::type_index& expression, const std::vector<Real>& key,
+                                    const Real value) const {
+    if (cache_integral_.size() >= maxIntegralCacheSize)
+        cache_integral_.clear();
+    cache_integral_.insert(std::make_pair(integral_cache_key{expression, key}, value));
+}
+
 std::pair<CrossAssetModel::AssetType, CrossAssetModel::ModelType>
 CrossAssetModel::getComponentType(const Size i) const {
     if (boost::dynamic_pointer_cast<IrHwParametrization>(p_[i]))
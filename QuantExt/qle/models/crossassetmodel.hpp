@@ -47,6 +47,8 @@
 #include <ql/math/matrix.hpp>
 #include <ql/models/model.hpp>
 
+#include <typeindex>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -270,6 +272,15 @@ public:
                               const bool usePiecewiseIntegration = true) const;
     const boost::shared_ptr<Integrator> integrator() const;
 
+    /*! The integrals of the CrossAssetAnalytics are memoised per expression and integration bounds if the cache is
+        enabled, which is the default. The cache is cleared by update() and setIntegrationPolicy(), i.e. whenever the
+        model parameters or the integration may have changed, and when it exceeds maxIntegralCacheSize entries. */
+    void enableIntegralCache(const bool enable) const;
+    bool integralCache() const { return integralCacheEnabled_; }
+    bool cachedIntegral(const std::type_index& expression, const std::vector<Real>& key, Real& value) const;
+    void cacheIntegral(const std::type_index& expression, const std::vector<Real>& key, const Real value) const;
+    static constexpr Size maxIntegralCacheSize = 100000;
+
     /*! return (V(t), V^tilde(t,T)) in the notation of the book */
     std::pair<Real, Real> infdkV(const Size i, const Time t, const Time T);
 
@@ -468,6 +479,24 @@ protected:
 
     mutable boost::unordered_map<cache_key, std::pair<Real, Real>, cache_hasher> cache_crlgm1fS_, cache_infdkI_;
 
+    // cache for integrals, see enableIntegralCache()
+    struct integral_cache_key {
+        std::type_index expression;
+        std::vector<Real> key;
+        bool operator==(const integral_cache_key& o) const { return expression == o.expression && key == o.key; }
+    };
+
+    struct integral_cache_hasher {
+        std::size_t operator()(integral_cache_key const& x) const {
+            std::size_t seed = x.expression.hash_code();
+            boost::hash_range(seed, x.key.begin(), x.key.end());
+            return seed;
+        }
+    };
+
+    mutable bool integralCacheEnabled_ = true;
+    mutable boost::unordered_map<integral_cache_key, Real, integral_cache_hasher> cache_integral_;
+
     /* members */
 
     // components per asset type
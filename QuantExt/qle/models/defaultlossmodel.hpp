@@ -71,6 +71,15 @@ protected:
     virtual Real expectedTrancheLoss(const Date& d, Real recoveryRate = Null<Real>()) const {
         QL_FAIL("expectedTrancheLoss Not implemented for this model.");
     }
+    /*! Expected tranche losses for several dates, models can override this to share work across the dates, e.g.
+        the factor integration grid, or to process the dates in parallel. */
+    virtual std::vector<Real> expectedTrancheLosses(const std::vector<Date>& dates,
+                                                    Real recoveryRate = Null<Real>()) const {
+        std::vector<Real> result;
+        for (auto const& d : dates)
+            result.push_back(expectedTrancheLoss(d, recoveryRate));
+        return result;
+    }
     /*! Probability of the tranche losing the same or more than the
         fractional amount given.
 
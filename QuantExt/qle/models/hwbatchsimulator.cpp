@@ -0,0 +1,183 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/computeenvironment.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/models/hwbatchsimulator.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+HwBatchSimulator::HwBatchSimulator(const boost::shared_ptr<HwModel>& model, const TimeGrid& timeGrid)
+    : timeGrid_(timeGrid) {
+    QL_REQUIRE(model, "HwBatchSimulator: model is null");
+    QL_REQUIRE(model->measure() == IrModel::Measure::BA, "HwBatchSimulator: only measure BA is supported");
+    QL_REQUIRE(timeGrid_.size() > 0, "HwBatchSimulator: empty time grid");
+
+    auto p = model->parametrization();
+    const Size n = p->n();
+    size_ = model->stateProcess()->size();
+    factors_ = model->stateProcess()->factors();
+    QL_REQUIRE(size_ == n || size_ == 2 * n,
+               "HwBatchSimulator: unexpected state size " << size_ << " for " << n << " factors");
+
+    const Array ones(n, 1.0);
+    for (Size k = 0; k + 1 < timeGrid_.size(); ++k) {
+        const Time t = timeGrid_[k], dt = timeGrid_.dt(k);
+        const Array kappa = p->kappa(t);
+        const Matrix sigma = p->sigma_x(t);
+
+        // x' = x + (y(t) 1 - kappa x) dt + sigma^T dW, the integrated state evolves with x dt
+        Matrix A(size_, size_, 0.0);
+        for (Size i = 0; i < size_; ++i)
+            A(i, i) = 1.0;
+        for (Size i = 0; i < n; ++i) {
+            A(i, i) -= kappa[i] * dt;
+            if (size_ > n)
+                A(n + i, i) = dt;
+        }
+
+        Array b(size_, 0.0);
+        Array yOnes = p->y(t) * ones;
+        for (Size i = 0; i < n; ++i)
+            b[i] = yOnes[i] * dt;
+
+        Matrix D(size_, factors_, 0.0);
+        const Real sqrtDt = std::sqrt(dt);
+        for (Size i = 0; i < n; ++i)
+            for (Size j = 0; j < std::min(factors_, sigma.rows()); ++j)
+                D(i, j) = sigma(j, i) * sqrtDt;
+
+        A_.push_back(A);
+        b_.push_back(b);
+        D_.push_back(D);
+    }
+}
+
+std::vector<std::vector<RandomVariable>>
+HwBatchSimulator::simulate(const std::vector<std::vector<RandomVariable>>& dw) const {
+    QL_REQUIRE(dw.size() == A_.size(),
+               "HwBatchSimulator::simulate(): dw has " << dw.size() << " steps, expected " << A_.size());
+    QL_REQUIRE(!dw.empty() && !dw.front().empty(), "HwBatchSimulator::simulate(): no variates given");
+    const Size nSamples = dw.front().front().size();
+
+    std::vector<std::vector<RandomVariable>> result(timeGrid_.size(),
+                                                    std::vector<RandomVariable>(size_, RandomVariable(nSamples, 0.0)));
+    for (Size k = 0; k < A_.size(); ++k) {
+        QL_REQUIRE(dw[k].size() == factors_, "HwBatchSimulator::simulate(): dw[" << k << "] has size " << dw[k].size()
+                                                                                 << ", expected " << factors_);
+        for (Size i = 0; i < size_; ++i) {
+            RandomVariable s(nSamples, b_[k][i]);
+            for (Size j = 0; j < size_; ++j) {
+                if (A_[k](i, j) != 0.0)
+                    s += RandomVariable(nSamples, A_[k](i, j)) * result[k][j];
+            }
+            for (Size j = 0; j < factors_; ++j) {
+                if (D_[k](i, j) != 0.0)
+                    s += RandomVariable(nSamples, D_[k](i, j)) * dw[k][j];
+            }
+            result[k + 1][i] = std::move(s);
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<RandomVariable>> HwBatchSimulator::simulate(const std::string& computeDevice,
+                                                                    const Size nSamples,
+                                                                    const std::uint32_t seed) const {
+    QL_REQUIRE(nSamples > 0, "HwBatchSimulator::simulate(): nSamples must be positive");
+    if (nSamples != externalCalculationSize_ || computeDevice != externalComputeDevice_) {
+        externalCalculationId_ = 0;
+        externalCalculationSize_ = nSamples;
+        externalComputeDevice_ = computeDevice;
+    }
+
+    auto& env = ComputeEnvironment::instance();
+    env.selectContext(computeDevice);
+    auto& context = env.context();
+    context.setPrecision(context.supportsDoublePrecision() ? ComputeContext::Precision::Double
+                                                           : ComputeContext::Precision::Single);
+    auto [id, newCalc] = context.initiateCalculation(nSamples, externalCalculationId_, 0);
+    externalCalculationId_ = id;
+
+    // the input variables are the non-zero entries of the step matrices and drifts
+
+    std::vector<std::vector<std::size_t>> AId(A_.size()), bId(A_.size()), DId(A_.size());
+    for (Size k = 0; k < A_.size(); ++k) {
+        for (Size i = 0; i < size_; ++i) {
+            bId[k].push_back(context.createInputVariable(static_cast<double>(b_[k][i])));
+            for (Size j = 0; j < size_; ++j)
+                AId[k].push_back(A_[k](i, j) != 0.0 ? context.createInputVariable(static_cast<double>(A_[k](i, j)))
+                                                    : Null<std::size_t>());
+            for (Size j = 0; j < factors_; ++j)
+                DId[k].push_back(D_[k](i, j) != 0.0 ? context.createInputVariable(static_cast<double>(D_[k](i, j)))
+                                                    : Null<std::size_t>());
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> dw = context.createInputVariates(factors_, A_.size(), seed);
+
+    // record the evolution of the state, this is only required for a new calculation
+
+    if (newCalc) {
+        std::vector<std::size_t> state(size_, Null<std::size_t>());
+        for (Size k = 0; k < A_.size(); ++k) {
+            std::vector<std::size_t> next(size_);
+            for (Size i = 0; i < size_; ++i) {
+                std::size_t s = bId[k][i];
+                auto add = [&context, &s, &bId, k, i](const std::size_t a, const std::size_t x) {
+                    std::size_t term = context.applyOperation(RandomVariableOpCode::Mult, {a, x});
+                    std::size_t tmp = context.applyOperation(RandomVariableOpCode::Add, {s, term});
+                    context.freeVariable(term);
+                    if (s != bId[k][i])
+                        context.freeVariable(s);
+                    s = tmp;
+                };
+                // the initial state is zero
+                if (k > 0) {
+                    for (Size j = 0; j < size_; ++j)
+                        if (AId[k][i * size_ + j] != Null<std::size_t>())
+                            add(AId[k][i * size_ + j], state[j]);
+                }
+                for (Size j = 0; j < factors_; ++j)
+                    if (DId[k][i * factors_ + j] != Null<std::size_t>())
+                        add(DId[k][i * factors_ + j], dw[j][k]);
+                next[i] = s;
+                context.declareOutputVariable(s);
+            }
+            state.swap(next);
+        }
+    }
+
+    std::vector<std::vector<double>> output(A_.size() * size_, std::vector<double>(nSamples));
+    context.finalizeCalculation(output);
+
+    std::vector<std::vector<RandomVariable>> result(timeGrid_.size(),
+                                                    std::vector<RandomVariable>(size_, RandomVariable(nSamples, 0.0)));
+    for (Size k = 0; k < A_.size(); ++k) {
+        for (Size i = 0; i < size_; ++i) {
+            auto& r = result[k + 1][i];
+            for (Size p = 0; p < nSamples; ++p)
+                r.set(p, output[k * size_ + i][p]);
+        }
+    }
+    return result;
+}
+
+} // namespace QuantExt
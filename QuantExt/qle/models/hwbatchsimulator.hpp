@@ -0,0 +1,86 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file hwbatchsimulator.hpp
+    \brief batched simulation of the hull white n factor model state
+    \ingroup models
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+#include <qle/models/hwmodel.hpp>
+
+#include <ql/math/matrix.hpp>
+#include <ql/timegrid.hpp>
+
+namespace QuantExt {
+
+//! Batched simulation of the HwModel state
+/*! The Euler step of the IrHwStateProcess is affine in the state, since the diffusion does not depend on it,
+
+    s(t_{k+1}) = A_k s(t_k) + b_k + D_k z_k
+
+    where z_k are the independent standard normal variates of the step and s is the state x, followed by the
+    integrated state for the bank account if the model evaluates it. The matrices A_k, D_k and the vectors b_k are
+    computed once per time step in the constructor, the simulation then evolves all paths of a step at once, either
+    on the host using RandomVariable arithmetic or on a device of the ComputeEnvironment.
+
+    The paths agree with the ones generated from the stateProcess() of the model step by step.
+
+    \ingroup models
+*/
+class HwBatchSimulator {
+public:
+    HwBatchSimulator(const boost::shared_ptr<HwModel>& model, const QuantLib::TimeGrid& timeGrid);
+
+    //! dimension of the state
+    QuantLib::Size size() const { return size_; }
+    //! number of driving Brownian motions
+    QuantLib::Size factors() const { return factors_; }
+    //! time grid of the simulation
+    const QuantLib::TimeGrid& timeGrid() const { return timeGrid_; }
+
+    /*! Simulate the paths on the host, dw[k][j] are the variates of factor j in step k, i.e. dw has timeGrid().size()
+        - 1 entries of size factors(). The result has one entry per time grid point, each holding the size() state
+        components, starting with the initial state. */
+    std::vector<std::vector<RandomVariable>> simulate(const std::vector<std::vector<RandomVariable>>& dw) const;
+
+    /*! Simulate nSamples paths on the given compute device, the variates are generated on the device from the given
+        seed. The calculation is recorded once and replayed on subsequent calls with the same number of samples. The
+        result is laid out as in the host version. */
+    std::vector<std::vector<RandomVariable>> simulate(const std::string& computeDevice, const QuantLib::Size nSamples,
+                                                      const std::uint32_t seed) const;
+
+    //! transition matrix of step k
+    const QuantLib::Matrix& transition(const QuantLib::Size k) const { return A_.at(k); }
+    //! drift of step k
+    const QuantLib::Array& drift(const QuantLib::Size k) const { return b_.at(k); }
+    //! diffusion of step k, including the square root of the step size
+    const QuantLib::Matrix& diffusion(const QuantLib::Size k) const { return D_.at(k); }
+
+private:
+    QuantLib::TimeGrid timeGrid_;
+    QuantLib::Size size_, factors_;
+    std::vector<QuantLib::Matrix> A_, D_;
+    std::vector<QuantLib::Array> b_;
+    mutable std::size_t externalCalculationId_ = 0, externalCalculationSize_ = 0;
+    mutable std::string externalComputeDevice_;
+};
+
+} // namespace QuantExt
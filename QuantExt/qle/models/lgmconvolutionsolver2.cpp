@@ -20,6 +20,8 @@
 
 #include <ql/math/distributions/normaldistribution.hpp>
 
+#include <algorithm>
+
 namespace QuantExt {
 
 LgmConvolutionSolver2::LgmConvolutionSolver2(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy,
@@ -68,49 +70,81 @@ RandomVariable LgmConvolutionSolver2::stateGrid(const Real t) const {
     return x;
 }
 
-RandomVariable LgmConvolutionSolver2::rollback(const RandomVariable& v, const Real t1, const Real t0) const {
-    if (QuantLib::close_enough(t0, t1) || v.deterministic())
-        return v;
-    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver2::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
-    Real sigma = std::sqrt(model_->parametrization()->zeta(t1));
+const LgmConvolutionSolver2::RollbackOperator& LgmConvolutionSolver2::rollbackOperator(const Real zeta1,
+                                                                                        const Real zeta0) const {
+    auto key = std::make_pair(zeta1, zeta0);
+    auto op = operators_.find(key);
+    if (op != operators_.end())
+        return op->second;
+
+    if (operators_.size() >= maxCachedOperators)
+        operators_.clear();
+
+    Real sigma = std::sqrt(zeta1);
     Real dx = sigma / static_cast<Real>(nx_);
-    if (QuantLib::close_enough(t0, 0.0)) {
-        // rollback from t1 to t0 = 0
-        Real value = 0.0;
+    Real stdDev = std::sqrt(zeta1 - zeta0);
+    Real dx2 = std::sqrt(zeta0) / static_cast<Real>(nx_);
+
+    // for zeta0 = 0, in particular t0 = 0, all target points have the same value
+    int rows = zeta0 == 0.0 ? 1 : 2 * mx_ + 1;
+    RollbackOperator res;
+    res.first.resize(rows);
+    res.weights.resize(rows);
+    std::vector<Real> row(2 * mx_ + 1);
+    for (int k = 0; k < rows; ++k) {
+        std::fill(row.begin(), row.end(), 0.0);
         for (int i = 0; i <= 2 * my_; i++) {
             // Map y index to x index, not integer in general
-            Real kp = y_[i] * sigma / dx + mx_;
+            Real kp = (dx2 * (k - mx_) + y_[i] * stdDev) / dx + mx_;
             // Adjacent integer x index <= k
             int kk = int(floor(kp));
-            // Get value at kp by linear interpolation on
-            // kk <= kp <= kk + 1 with flat extrapolation
-            value +=
-                w_[i] *
-                (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
-        }
-        return RandomVariable(2 * mx_ + 1, value);
-    } else {
-        RandomVariable value(2 * mx_ + 1, 0.0);
-        value.expand();
-        // rollback from t1 to t0 > 0
-        Real std = std::sqrt(model_->parametrization()->zeta(t1) - model_->parametrization()->zeta(t0));
-        Real dx2 = std::sqrt(model_->parametrization()->zeta(t0)) / static_cast<Real>(nx_);
-        for (int k = 0; k <= 2 * mx_; k++) {
-            for (int i = 0; i <= 2 * my_; i++) {
-                // Map y index to x index, not integer in generalTo
-                Real kp = (dx2 * (k - mx_) + y_[i] * std) / dx + mx_;
-                // Adjacent integer x index <= k
-                int kk = int(floor(kp));
-                // Get value at kp by linear interpolation on
-                // kk <= kp <= kk + 1 with flat extrapolation
-                value.set(k, value[k] + w_[i] * (kk < 0 ? v[0]
-                                                        : (kk + 1 > 2 * mx_
-                                                               ? v[2 * mx_]
-                                                               : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk])));
+            // Linear interpolation on kk <= kp <= kk + 1 with flat extrapolation
+            if (kk < 0)
+                row[0] += w_[i];
+            else if (kk + 1 > 2 * mx_)
+                row[2 * mx_] += w_[i];
+            else {
+                row[kk] += w_[i] * (1.0 + kk - kp);
+                row[kk + 1] += w_[i] * (kp - kk);
             }
         }
-        return value;
+        int lo = 0, hi = 2 * mx_;
+        while (lo < hi && row[lo] == 0.0)
+            ++lo;
+        while (hi > lo && row[hi] == 0.0)
+            --hi;
+        res.first[k] = lo;
+        res.weights[k].assign(row.begin() + lo, row.begin() + hi + 1);
+    }
+    return operators_.insert(std::make_pair(key, res)).first->second;
+}
+
+RandomVariable LgmConvolutionSolver2::rollback(const RandomVariable& v, const Real t1, const Real t0) const {
+    if (QuantLib::close_enough(t0, t1) || v.deterministic())
+        return v;
+    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver2::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
+    Real zeta0 = QuantLib::close_enough(t0, 0.0) ? 0.0 : model_->parametrization()->zeta(t0);
+    const RollbackOperator& op = rollbackOperator(model_->parametrization()->zeta(t1), zeta0);
+    const Real* x = v.data();
+    auto dot = [&op, x](const Size k) {
+        const std::vector<Real>& w = op.weights[k];
+        const Real* xk = x + op.first[k];
+        Real sum = 0.0;
+        for (Size j = 0; j < w.size(); ++j)
+            sum += w[j] * xk[j];
+        return sum;
+    };
+    if (QuantLib::close_enough(t0, 0.0)) {
+        // rollback from t1 to t0 = 0
+        return RandomVariable(2 * mx_ + 1, dot(0));
     }
+    // rollback from t1 to t0 > 0
+    RandomVariable value(2 * mx_ + 1, 0.0);
+    value.expand();
+    Real* y = value.data();
+    for (Size k = 0; k < static_cast<Size>(2 * mx_ + 1); ++k)
+        y[k] = dot(op.first.size() == 1 ? 0 : k);
+    return value;
 }
 
 } // namespace QuantExt
@@ -27,11 +27,18 @@
 #include <qle/math/randomvariable.hpp>
 #include <qle/models/lgm.hpp>
 
+#include <map>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
 /*! Reference: Hagan, Methodology for callable swaps and Bermudan
                exercise into swaptions
+
+    The convolution of a rollback step is a linear map on the state grid, which only depends on the model variances
+    zeta(t0) and zeta(t1). It is assembled once as a banded matrix, i.e. one contiguous range of weights per target
+    grid point, and cached, so that repeated rollbacks over the same step (e.g. for all trades priced with the same
+    engine) reduce to dot products over the band.
 */
 
 class LgmConvolutionSolver2 {
@@ -52,10 +59,21 @@ public:
     const boost::shared_ptr<LinearGaussMarkovModel>& model() const { return model_; }
 
 private:
+    // banded matrix, row k has the weights for the grid points first[k], first[k] + 1, ...
+    struct RollbackOperator {
+        std::vector<int> first;
+        std::vector<std::vector<Real>> weights;
+    };
+    const RollbackOperator& rollbackOperator(const Real zeta1, const Real zeta0) const;
+
     boost::shared_ptr<LinearGaussMarkovModel> model_;
     int mx_, my_, nx_;
     Real h_;
     std::vector<Real> y_, w_;
+
+    // cache for the rollback operators, keyed on (zeta(t1), zeta(t0))
+    static constexpr Size maxCachedOperators = 1000;
+    mutable std::map<std::pair<Real, Real>, RollbackOperator> operators_;
 };
 
 } // namespace QuantExt
@@ -62,6 +62,20 @@ RandomVariable LgmVectorised::reducedDiscountBond(const Time t, const Time T, co
            exp(-HT * x - RandomVariable(x.size(), 0.5 * p_->zeta(t)) * HT * HT);
 }
 
+RandomVariable LgmVectorised::logReducedDiscountBondRatio(const Time t, const Time T1, const Time T2,
+                                                          const Real discountRatio, const RandomVariable& x) const {
+    QL_REQUIRE(T1 >= t && T2 >= t && t >= 0.0, "T1(" << T1 << "), T2(" << T2 << ") >= t(" << t
+                                                     << ") >= 0 required in LGM::reducedDiscountBondRatio");
+    Real H1 = p_->H(T1), H2 = p_->H(T2);
+    return RandomVariable(x.size(), H2 - H1) * x +
+           RandomVariable(x.size(), std::log(discountRatio) - 0.5 * p_->zeta(t) * (H1 * H1 - H2 * H2));
+}
+
+RandomVariable LgmVectorised::reducedDiscountBondRatio(const Time t, const Time T1, const Time T2,
+                                                       const Real discountRatio, const RandomVariable& x) const {
+    return exp(logReducedDiscountBondRatio(t, T1, T2, discountRatio, x));
+}
+
 RandomVariable LgmVectorised::fixing(const boost::shared_ptr<InterestRateIndex>& index, const Date& fixingDate,
                                      const Time t, const RandomVariable& x) const {
 
@@ -77,10 +91,10 @@ RandomVariable LgmVectorised::fixing(const boost::shared_ptr<InterestRateIndex>&
         Time T1 = std::max(t, p_->termStructure()->timeFromReference(d1));
         Time T2 = std::max(T1, p_->termStructure()->timeFromReference(d2));
         Time dt = ibor->dayCounter().yearFraction(d1, d2);
-        // reducedDiscountBond is faster to compute, there we use this here instead of discountBond
-        RandomVariable disc1 = reducedDiscountBond(t, T1, x, ibor->forwardingTermStructure());
-        RandomVariable disc2 = reducedDiscountBond(t, T2, x, ibor->forwardingTermStructure());
-        return (disc1 / disc2 - RandomVariable(x.size(), 1.0)) / RandomVariable(x.size(), dt);
+        // the ratio of the reduced discount bonds is the ratio of the discount bonds and faster to compute
+        const Handle<YieldTermStructure>& curve = ibor->forwardingTermStructure();
+        RandomVariable ratio = reducedDiscountBondRatio(t, T1, T2, curve->discount(T1) / curve->discount(T2), x);
+        return (ratio - RandomVariable(x.size(), 1.0)) / RandomVariable(x.size(), dt);
     } else if (auto swap = boost::dynamic_pointer_cast<SwapIndex>(index)) {
         auto swapDiscountCurve =
             swap->exogenousDiscount() ? swap->discountingTermStructure() : swap->forwardingTermStructure();
@@ -104,13 +118,13 @@ RandomVariable LgmVectorised::fixing(const boost::shared_ptr<InterestRateIndex>&
                 Time T2 = std::max(
                     T1, p_->termStructure()->timeFromReference(fixingEndDate)); // accounts for QL_INDEXED_COUPON
                 Time T3 = std::max(T2, p_->termStructure()->timeFromReference(cpn->date()));
-                RandomVariable disc1 = reducedDiscountBond(t, T1, x, swap->forwardingTermStructure());
-                RandomVariable disc2 = reducedDiscountBond(t, T2, x, swap->forwardingTermStructure());
+                const Handle<YieldTermStructure>& curve = swap->forwardingTermStructure();
                 Real adjFactor =
                     cpn->dayCounter().yearFraction(cpn->accrualStartDate(), cpn->accrualEndDate(),
                                                    cpn->referencePeriodStart(), cpn->referencePeriodEnd()) /
                     swap->iborIndex()->dayCounter().yearFraction(fixingValueDate, fixingEndDate);
-                RandomVariable tmp = disc1 / disc2 - RandomVariable(x.size(), 1.0);
+                RandomVariable tmp = reducedDiscountBondRatio(t, T1, T2, curve->discount(T1) / curve->discount(T2), x) -
+                                     RandomVariable(x.size(), 1.0);
                 if (!QuantLib::close_enough(adjFactor, 1.0)) {
                     tmp *= RandomVariable(x.size(), adjFactor);
                 }
@@ -121,17 +135,17 @@ RandomVariable LgmVectorised::fixing(const boost::shared_ptr<InterestRateIndex>&
                 Time T1 = std::max(t, p_->termStructure()->timeFromReference(start));
                 Time T2 = std::max(T1, p_->termStructure()->timeFromReference(end));
                 Time T3 = std::max(T2, p_->termStructure()->timeFromReference(cpn->date()));
-                RandomVariable disc1 = reducedDiscountBond(t, T1, x, swap->forwardingTermStructure());
-                RandomVariable disc2 = reducedDiscountBond(t, T2, x, swap->forwardingTermStructure());
+                const Handle<YieldTermStructure>& curve = swap->forwardingTermStructure();
+                Real discountRatio = curve->discount(T1) / curve->discount(T2);
                 Real adjFactor =
                     cpn->dayCounter().yearFraction(cpn->accrualStartDate(), cpn->accrualEndDate(),
                                                    cpn->referencePeriodStart(), cpn->referencePeriodEnd()) /
                     swap->iborIndex()->dayCounter().yearFraction(start, end);
                 RandomVariable tmp;
                 if (cpn->averagingMethod() == RateAveraging::Compound) {
-                    tmp = disc1 / disc2 - RandomVariable(x.size(), 1.0);
+                    tmp = reducedDiscountBondRatio(t, T1, T2, discountRatio, x) - RandomVariable(x.size(), 1.0);
                 } else if (cpn->averagingMethod() == RateAveraging::Simple) {
-                    tmp = QuantExt::log(disc1 / disc2);
+                    tmp = logReducedDiscountBondRatio(t, T1, T2, discountRatio, x);
                 } else {
                     QL_FAIL("LgmVectorised::fixing(): RateAveraging '"
                             << static_cast<int>(cpn->averagingMethod())
@@ -249,22 +263,17 @@ RandomVariable LgmVectorised::compoundedOnRate(const boost::shared_ptr<Overnight
             T2_lgm += t - T1;
         }
 
-        // the discount factors estimated in the lgm model
+        /* the ratio of the discount factors estimated in the lgm model, corrected to match the T0 curve, i.e. the
+           product of the daily compounding factors over the projected period, computed in one pass */
 
-        RandomVariable disc1 = reducedDiscountBond(t, T1_lgm, x, curve);
-        RandomVariable disc2 = reducedDiscountBond(t, T2_lgm, x, curve);
-
-        // apply a correction to the discount factors
-
-        disc1 *= RandomVariable(x.size(), startDiscount / curve->discount(T1_lgm));
-        disc2 *= RandomVariable(x.size(), endDiscount / curve->discount(T2_lgm));
+        RandomVariable ratio = reducedDiscountBondRatio(t, T1_lgm, T2_lgm, startDiscount / endDiscount, x);
 
         // continue with the usual computation
 
-        compoundFactorLgm *= disc1 / disc2;
+        compoundFactorLgm *= ratio;
 
         if (includeSpread) {
-            compoundFactorWithoutSpreadLgm *= disc1 / disc2;
+            compoundFactorWithoutSpreadLgm *= ratio;
             Real tau =
                 accrualDayCounter.yearFraction(valueDates[i], valueDates.back()) / (valueDates.back() - valueDates[i]);
             compoundFactorLgm *= RandomVariable(
@@ -367,19 +376,10 @@ RandomVariable LgmVectorised::averagedOnRate(const boost::shared_ptr<OvernightIn
             T2_lgm += t - T1;
         }
 
-        // the discount factors estimated in the lgm model
-
-        RandomVariable disc1 = reducedDiscountBond(t, T1_lgm, x, curve);
-        RandomVariable disc2 = reducedDiscountBond(t, T2_lgm, x, curve);
+        /* the log of the ratio of the discount factors estimated in the lgm model, corrected to match the T0 curve,
+           this is affine in x, so no exp / log over the samples is needed */
 
-        // apply a correction to the discount factors
-
-        disc1 *= RandomVariable(x.size(), startDiscount / curve->discount(T1_lgm));
-        disc2 *= RandomVariable(x.size(), endDiscount / curve->discount(T2_lgm));
-
-        // continue with the usual computation
-
-        accumulatedRateLgm += log(disc1 / disc2);
+        accumulatedRateLgm += logReducedDiscountBondRatio(t, T1_lgm, T2_lgm, startDiscount / endDiscount, x);
     }
 
     Rate tau = accrualDayCounter.yearFraction(valueDates.front(), valueDates.back());
@@ -448,19 +448,13 @@ RandomVariable LgmVectorised::averagedBmaRate(const boost::shared_ptr<BMAIndex>&
                 T2_lgm += t - T1;
             }
 
-            // the discount factors estimated in the lgm model
-
-            RandomVariable disc1 = reducedDiscountBond(t, T1_lgm, x, curve);
-            RandomVariable disc2 = reducedDiscountBond(t, T2_lgm, x, curve);
-
-            // apply a correction to the discount factors
+            // the ratio of the discount factors estimated in the lgm model, corrected to match the T0 curve
 
-            disc1 *= RandomVariable(x.size(), startDiscount / curve->discount(T1_lgm));
-            disc2 *= RandomVariable(x.size(), endDiscount / curve->discount(T2_lgm));
+            RandomVariable ratio = reducedDiscountBondRatio(t, T1_lgm, T2_lgm, startDiscount / endDiscount, x);
 
             // estimate the fixing
 
-            fixing = (disc1 / disc2 - RandomVariable(x.size(), 1.0)) /
+            fixing = (ratio - RandomVariable(x.size(), 1.0)) /
                      RandomVariable(x.size(), index->dayCounter().yearFraction(start, end));
         }
 
@@ -73,6 +73,15 @@ public:
                                    const RandomVariable& x) const;
 
 private:
+    /* The ratio of the reduced discount bonds for T1 and T2 at t, where the ratio of the deterministic discount factors
+       is replaced by discountRatio, i.e. discountRatio * exp(-(H(T1) - H(T2)) x - 0.5 zeta(t) (H(T1)^2 - H(T2)^2)).
+       This is computed as exp(a x + b) in one pass over the samples, instead of two discount bonds and a division. */
+    RandomVariable reducedDiscountBondRatio(const Time t, const Time T1, const Time T2, const Real discountRatio,
+                                            const RandomVariable& x) const;
+    //! The log of reducedDiscountBondRatio(), which is affine in x
+    RandomVariable logReducedDiscountBondRatio(const Time t, const Time T1, const Time T2, const Real discountRatio,
+                                               const RandomVariable& x) const;
+
     const boost::shared_ptr<IrLgm1fParametrization> p_;
 };
 
@@ -21,6 +21,10 @@
 #include <ql/math/optimization/projection.hpp>
 #include <qle/models/linkablecalibratedmodel.hpp>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using boost::shared_ptr;
 using std::vector;
 
@@ -28,10 +32,44 @@ namespace QuantExt {
 
 namespace {
 void no_deletion(void*) {}
+
+/* Evaluate the calibration errors of the helpers on up to nThreads threads. The exception of the first failing
+   helper is rethrown after all threads are finished. */
+void calibrationErrors(const vector<shared_ptr<CalibrationHelper> >& instruments, Size nThreads, Array& errors) {
+#if !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN) || defined(QL_ENABLE_SESSIONS)
+    nThreads = 1;
+#endif
+    Size nWorkers = std::min(nThreads, instruments.size());
+    if (nWorkers <= 1) {
+        for (Size i = 0; i < instruments.size(); ++i)
+            errors[i] = instruments[i]->calibrationError();
+        return;
+    }
+    vector<std::exception_ptr> exceptions(instruments.size());
+    std::atomic<Size> next(0);
+    auto worker = [&instruments, &errors, &exceptions, &next]() {
+        for (Size i = next++; i < instruments.size(); i = next++) {
+            try {
+                errors[i] = instruments[i]->calibrationError();
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        }
+    };
+    vector<std::thread> workers;
+    for (Size w = 1; w < nWorkers; ++w)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : exceptions)
+        if (e)
+            std::rethrow_exception(e);
+}
 } // namespace
 
 LinkableCalibratedModel::LinkableCalibratedModel()
-    : constraint_(new PrivateConstraint(arguments_)), endCriteria_(EndCriteria::None) {}
+    : constraint_(new PrivateConstraint(arguments_)), endCriteria_(EndCriteria::None), calibrationThreads_(1) {}
 
 class LinkableCalibratedModel::CalibrationFunction : public CostFunction {
 public:
@@ -43,10 +81,11 @@ public:
 
     virtual Real value(const Array& params) const override {
         model_->setParams(projection_.include(params));
+        Array errors(instruments_.size());
+        calibrationErrors(instruments_, model_->calibrationThreads(), errors);
         Real value = 0.0;
         for (Size i = 0; i < instruments_.size(); i++) {
-            Real diff = instruments_[i]->calibrationError();
-            value += diff * diff * weights_[i];
+            value += errors[i] * errors[i] * weights_[i];
         }
         return std::sqrt(value);
     }
@@ -54,8 +93,9 @@ public:
     virtual Array values(const Array& params) const override {
         model_->setParams(projection_.include(params));
         Array values(instruments_.size());
+        calibrationErrors(instruments_, model_->calibrationThreads(), values);
         for (Size i = 0; i < instruments_.size(); i++) {
-            values[i] = instruments_[i]->calibrationError() * std::sqrt(weights_[i]);
+            values[i] *= std::sqrt(weights_[i]);
         }
         return values;
     }
@@ -98,6 +138,13 @@ void LinkableCalibratedModel::calibrate(const vector<shared_ptr<CalibrationHelpe
     Array prms = params();
     vector<bool> all(prms.size(), false);
     Projection proj(prms, fixParameters.size() > 0 ? fixParameters : all);
+    /* if the helpers are evaluated concurrently, evaluate them once sequentially before, so that the lazy objects
+       shared between them (curves, vol surfaces, indices) are calculated and only read during the calibration */
+    if (calibrationThreads_ > 1) {
+        for (auto const& i : instruments)
+            i->calibrationError();
+    }
+
     CalibrationFunction f(this, instruments, w, proj);
     ProjectedConstraint pc(c, proj);
     Problem prob(f, pc, proj.project(prms));
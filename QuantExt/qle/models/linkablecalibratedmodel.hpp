@@ -31,6 +31,8 @@
 #include <ql/option.hpp>
 #include <ql/patterns/observable.hpp>
 
+#include <algorithm>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -79,12 +81,20 @@ public:
 
     virtual void setParams(const Array& params);
 
+    /*! Number of threads on which the calibration errors of the helpers are evaluated in each step of calibrate().
+        This requires that the helpers can be priced concurrently, i.e. that each helper has its own pricing engine
+        and that the engines only read the model, and a QuantLib build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+        and without QL_ENABLE_SESSIONS, otherwise the helpers are evaluated sequentially. The default is 1. */
+    void setCalibrationThreads(const Size n) { calibrationThreads_ = std::max<Size>(1, n); }
+    Size calibrationThreads() const { return calibrationThreads_; }
+
 protected:
     virtual void generateArguments() {}
     std::vector<boost::shared_ptr<Parameter> > arguments_;
     boost::shared_ptr<Constraint> constraint_;
     EndCriteria::Type endCriteria_;
     Array problemValues_;
+    Size calibrationThreads_;
 
 private:
     //! Constraint imposed on arguments
@@ -24,14 +24,22 @@
 #include <qle/models/extendedconstantlosslatentmodel.hpp>
 #include <qle/models/defaultlossmodel.hpp>
 #include <qle/models/hullwhitebucketing.hpp>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <thread>
 
 // clang-format off
 namespace QuantExt {
 
 /*! Default loss distribution convolution for finite homogeneous or non-homogeneous pool
 
+    The factor integration nodes and weights are set up once and shared by all dates. Expected tranche losses for
+    several dates can be computed in one call to expectedTrancheLosses(), which sets up the marginal default
+    probabilities of all dates and then computes the conditional loss distributions of the dates on up to
+    nThreads threads.
+
     \todo Extend to the multifactor case for a generic LM
 */
 template <class CopulaPolicy>
@@ -46,10 +54,14 @@ public:
         QuantLib::Real min = -5.0,
         QuantLib::Size nSteps = 50,
         bool useQuadrature = false,
-        bool useStochasticRecovery = false);
+        bool useStochasticRecovery = false,
+        QuantLib::Size nThreads = 1);
 
     QuantLib::Real expectedTrancheLoss(const QuantLib::Date& d, Real recoveryRate = Null<Real>()) const override;
 
+    std::vector<QuantLib::Real> expectedTrancheLosses(const std::vector<QuantLib::Date>& dates,
+                                                      Real recoveryRate = Null<Real>()) const override;
+
     QuantLib::Real percentile(const QuantLib::Date& d, QuantLib::Real percentile) const override;
 
     QuantLib::Real expectedShortfall(const QuantLib::Date& d, QuantLib::Probability percentile) const override;
@@ -67,8 +79,11 @@ private:
     QuantLib::Size nSteps_;
     bool useQuadrature_;
     bool useStochasticRecovery_;
+    QuantLib::Size nThreads_;
 
     QuantLib::Real delta_;
+    // factor integration nodes and weights delta * density, the same for all dates
+    std::vector<QuantLib::Real> factorNodes_, factorWeights_;
     mutable QuantLib::Real attach_;
     mutable QuantLib::Real detach_;
     mutable QuantLib::Real notional_;
@@ -84,16 +99,22 @@ private:
     mutable std::vector<std::vector<QuantLib::Real>> c_;
     // LGD by entity and (stochastic) recovery rate dimension 
     mutable std::vector<std::vector<QuantLib::Real>> lgdVV_;
-    // conditional probability of default with recovery rate, same dimension as lgdVV_
-    mutable std::vector<std::vector<QuantLib::Real>> cprVV_;
     
     QuantLib::Distribution lossDistrib(const QuantLib::Date& d, Real recoveryRate = Null<Real>()) const;
+    /* loss distribution for the given thresholds c, with the same dimension as c_, and the LGDs set in
+       updateLGDs(), this does not change the state of the model and can be called concurrently */
+    QuantLib::Distribution lossDistrib(const std::vector<std::vector<QuantLib::Real>>& c,
+                                       Real recoveryRate = Null<Real>()) const;
     // update lgdVV_
     void updateLGDs(Real recoveryRate = Null<Real>()) const;
     // update q_and c_
     void updateThresholds(QuantLib::Date d, Real recoveryRate = Null<Real>()) const;
-    // update cprVV_
-    std::vector<Real> updateCPRs(std::vector<QuantLib::Real> factor, Real recoveryRate = Null<Real>()) const;
+    /* conditional default probabilities for the thresholds c by entity, returned, and by entity and recovery rate
+       in cprVV, with the same dimension as lgdVV_ */
+    std::vector<Real> updateCPRs(const std::vector<std::vector<QuantLib::Real>>& c,
+                                 const std::vector<QuantLib::Real>& factor,
+                                 std::vector<std::vector<QuantLib::Real>>& cprVV,
+                                 Real recoveryRate = Null<Real>()) const;
 
     void resetModel() override;
 
@@ -144,7 +165,8 @@ PoolLossModel<CopulaPolicy>::PoolLossModel(
     QuantLib::Real min,
     QuantLib::Size nSteps,
     bool useQuadrature,
-    bool useStochasticRecovery)
+    bool useStochasticRecovery,
+    QuantLib::Size nThreads)
     : homogeneous_(homogeneous),
       copula_(copula),
       nBuckets_(nBuckets),
@@ -153,6 +175,7 @@ PoolLossModel<CopulaPolicy>::PoolLossModel(
       nSteps_(nSteps),
       useQuadrature_(useQuadrature),
       useStochasticRecovery_(useStochasticRecovery),
+      nThreads_(std::max<QuantLib::Size>(nThreads, 1)),
       delta_((max - min) / nSteps),
       attach_(0.0),
       detach_(0.0),
@@ -161,6 +184,13 @@ PoolLossModel<CopulaPolicy>::PoolLossModel(
       detachAmount_(0.0) {
 
     QL_REQUIRE(copula->numFactors() == 1, "Multifactor PoolLossModel not yet implemented.");
+
+    std::vector<QuantLib::Real> factor{ min_ + delta_ / 2.0 };
+    for (QuantLib::Size k = 0; k < nSteps_; k++) {
+        factorNodes_.push_back(factor[0]);
+        factorWeights_.push_back(delta_ * copula_->density(factor));
+        factor[0] += delta_;
+    }
 }
 
 template <class CopulaPolicy>
@@ -185,6 +215,49 @@ QuantLib::Real PoolLossModel<CopulaPolicy>::expectedTrancheLoss(const QuantLib::
 
     return expectedLoss;
 }
+
+template <class CopulaPolicy>
+std::vector<QuantLib::Real> PoolLossModel<CopulaPolicy>::expectedTrancheLosses(const std::vector<QuantLib::Date>& dates,
+                                                                               Real recoveryRate) const {
+
+    if (useQuadrature_ && !useStochasticRecovery_)
+        return DefaultLossModel::expectedTrancheLosses(dates, recoveryRate);
+
+    // The thresholds depend on the default curves of the basket, which are not thread safe, set them up first
+    updateLGDs(recoveryRate);
+    std::vector<std::vector<std::vector<QuantLib::Real>>> c(dates.size());
+    for (QuantLib::Size i = 0; i < dates.size(); ++i) {
+        updateThresholds(dates[i], recoveryRate);
+        c[i] = c_;
+    }
+
+    // The loss distributions of the dates are independent, if one fails the error of the first date is rethrown
+    std::vector<QuantLib::Real> result(dates.size(), 0.0);
+    std::vector<std::exception_ptr> exceptions(dates.size());
+    std::atomic<QuantLib::Size> next(0);
+    auto worker = [&]() {
+        for (QuantLib::Size i = next++; i < dates.size(); i = next++) {
+            try {
+                QuantLib::Distribution dist = lossDistrib(c[i], recoveryRate);
+                dist.normalize();
+                result[i] = expectedTrancheLoss1(dates[i], dist);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (QuantLib::Size t = 1; t < std::min(nThreads_, dates.size()); ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : exceptions)
+        if (e)
+            std::rethrow_exception(e);
+
+    return result;
+}
     
 template <class CopulaPolicy>
 QuantLib::Real PoolLossModel<CopulaPolicy>::expectedTrancheLoss1(const QuantLib::Date& d, Distribution& dist) const {
@@ -354,36 +427,39 @@ std::vector<std::vector<Real>> PoolLossModel<CopulaPolicy>::marginalProbabilitie
 }
 
 template <class CopulaPolicy>
-std::vector<Real> PoolLossModel<CopulaPolicy>::updateCPRs(std::vector<QuantLib::Real> factor, Real recoveryRate) const {
-    cprVV_.clear();
+std::vector<Real> PoolLossModel<CopulaPolicy>::updateCPRs(const std::vector<std::vector<QuantLib::Real>>& c,
+                                                          const std::vector<QuantLib::Real>& factor,
+                                                          std::vector<std::vector<QuantLib::Real>>& cprVV,
+                                                          Real recoveryRate) const {
+    // Vector of default probabilities conditional on the common market factor M: P(\tau_i < t | M = m).
+    std::vector<Real> probs(c.size());
+    cprVV.resize(c.size());
 
     Real tiny = 1.0e-10;
     if (useStochasticRecovery_ && recoveryRate == Null<Real>()) {
-        cprVV_.resize(notionals_.size(), std::vector<Real>());
-        for (Size i = 0; i < c_.size(); ++i) {
-            cprVV_[i].resize(c_[i].size() - 1, 0.0);
-            Real pd = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
+        for (Size i = 0; i < c.size(); ++i) {
+            cprVV[i].resize(c[i].size() - 1, 0.0);
+            // each threshold enters two differences, so evaluate the conditional probabilities only once
+            Real pd = copula_->conditionalDefaultProbabilityInvP(c[i][0], i, factor);
+            Real previous = pd;
             Real sum = 0.0;
-            for (Size j = 1; j < c_[i].size(); ++j) {
+            for (Size j = 1; j < c[i].size(); ++j) {
                 // probability of recovery j conditional on default of i
-                cprVV_[i][j-1] = copula_->conditionalDefaultProbabilityInvP(c_[i][j-1], i, factor)
-                    - copula_->conditionalDefaultProbabilityInvP(c_[i][j], i, factor);
-                sum += cprVV_[i][j-1];
+                Real current = copula_->conditionalDefaultProbabilityInvP(c[i][j], i, factor);
+                cprVV[i][j-1] = previous - current;
+                previous = current;
+                sum += cprVV[i][j-1];
             }
             QL_REQUIRE(fabs(sum - pd) < tiny, "probability check failed for factor0 " << factor[0]);
+            probs[i] = pd;
         }
     }
     else {
-        cprVV_.resize(notionals_.size(), std::vector<Real>(1, 0));
-        for (Size i = 0; i < c_.size(); ++i) {
-            cprVV_[i][0] = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
+        for (Size i = 0; i < c.size(); ++i) {
+            probs[i] = copula_->conditionalDefaultProbabilityInvP(c[i][0], i, factor);
+            cprVV[i].assign(1, probs[i]);
         }
     }
-    
-    // Vector of default probabilities conditional on the common market factor M: P(\tau_i < t | M = m).
-    std::vector<Real> probs;
-    for (Size i = 0; i < c_.size(); i++)
-        probs.push_back(copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor));
 
     return probs;
 }
@@ -403,17 +479,54 @@ void PoolLossModel<CopulaPolicy>::resetModel() {
 template <class CopulaPolicy>
 QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::Date& d, Real recoveryRate) const {
 
-    bool check = false;
-    
-    Real maximum = detachAmount_; 
-    Real minimum = 0.0;
-    
     // Update the LGD vector, could be moved to resetModel() if we can disregard the zeroRecovery flag
     updateLGDs(recoveryRate);
 
     // Update probabilities qij and thresholds cij, needs to stay here because date dependent
     updateThresholds(d, recoveryRate);
 
+    // Switch between quadrature integration and basic segment type scheme.
+    if (!useQuadrature_ || useStochasticRecovery_)
+        return lossDistrib(c_, recoveryRate);
+
+    // FIXME: Ensure quadrature works with stochastic recovery
+
+    Real maximum = detachAmount_; 
+    Real minimum = 0.0;
+    QuantLib::Distribution dist(nBuckets_, minimum, maximum);
+
+    boost::shared_ptr<QuantLib::LossDist> bucketing;
+    if (homogeneous_)
+        bucketing = boost::make_shared<QuantLib::LossDistHomogeneous>(nBuckets_, maximum);
+    else
+        bucketing = boost::make_shared<QuantLib::LossDistBucketing>(nBuckets_, maximum);
+
+    QuantLib::GaussHermiteIntegration Integrator(nSteps_);
+    // Marginal probabilities for each remaining entity in basket, P(\tau_i < t).
+    std::vector<QuantLib::Real> prob = basket_->remainingProbabilities(d);
+    LossModelConditionalDist<CopulaPolicy> lmcd(copula_, bucketing, prob, lgd_);
+
+    for (QuantLib::Size j = 0; j < nBuckets_; j++) {
+        std::function<QuantLib::Real(QuantLib::Real)> densityFunc = std::bind(
+            &LossModelConditionalDist<CopulaPolicy>::conditionalDensity, &lmcd, std::placeholders::_1, j);
+        std::function<QuantLib::Real(QuantLib::Real)> averageFunc = std::bind(
+            &LossModelConditionalDist<CopulaPolicy>::conditionalAverage, &lmcd, std::placeholders::_1, j);
+        dist.addDensity(j, Integrator(densityFunc));
+        dist.addAverage(j, Integrator(averageFunc));
+    }
+
+    return dist;
+}
+
+template <class CopulaPolicy>
+QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const std::vector<std::vector<QuantLib::Real>>& c,
+                                                                Real recoveryRate) const {
+
+    bool check = false;
+    
+    Real maximum = detachAmount_; 
+    Real minimum = 0.0;
+    
     // Init bucketing class
     HullWhiteBucketing hwb(minimum, maximum, nBuckets_);
 
@@ -431,96 +544,73 @@ QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::
     // Is the ql bucketing used?
     bool useQlBucketing = false;
 
-    // Switch between quadrature integration and basic segment type scheme.
-    if (useQuadrature_ && !useStochasticRecovery_) {
-
-        // FIXME: Ensure quadrature works with stochastic recovery
-
-        QuantLib::GaussHermiteIntegration Integrator(nSteps_);
-        // Marginal probabilities for each remaining entity in basket, P(\tau_i < t).
-        std::vector<QuantLib::Real> prob = basket_->remainingProbabilities(d);
-        LossModelConditionalDist<CopulaPolicy> lmcd(copula_, bucketing, prob, lgd_);
-
-        for (QuantLib::Size j = 0; j < nBuckets_; j++) {
-            std::function<QuantLib::Real(QuantLib::Real)> densityFunc = std::bind(
-                &LossModelConditionalDist<CopulaPolicy>::conditionalDensity, &lmcd, std::placeholders::_1, j);
-            std::function<QuantLib::Real(QuantLib::Real)> averageFunc = std::bind(
-                &LossModelConditionalDist<CopulaPolicy>::conditionalAverage, &lmcd, std::placeholders::_1, j);
-            dist.addDensity(j, Integrator(densityFunc));
-            dist.addAverage(j, Integrator(averageFunc));
-        }
+    // conditional default probabilities by entity and recovery rate
+    std::vector<std::vector<Real>> cprVV;
 
-        useQlBucketing = true;
+    std::vector<QuantLib::Real> factor(1);
 
-    } else {
+    for (QuantLib::Size k = 0; k < factorNodes_.size(); k++) {
 
-        std::vector<QuantLib::Real> factor{ min_ + delta_ / 2.0 };      
-
-        for (QuantLib::Size k = 0; k < nSteps_; k++) {
-            
-            std::vector<Real> cpr = updateCPRs(factor, recoveryRate);
-
-            // Loss distribution up to date d conditional on common factor M = m.
-            Distribution conditionalDist;
-            if (useStochasticRecovery_) {
-                // HW bucketing with multi-state extension for stochastic recovery
-                // With stochastic recovery the portfolios is in general not homogeneous any more, so that
-                // bucketing is the only choice. We could use this call in all cases (including deterministic
-                // recovery, homogeneous pool), but this can cause small regression errors (using bucketing
-                // instead of homogeneoius pool algorithm) and calculation time increase (QuantLib::LossDist's
-                // bucketing is faster).
-                hwb.computeMultiState(cprVV_.begin(), cprVV_.end(), lgdVV_.begin());                
-            }
-            else if (homogeneous_) {
-                // Original QuantLib::LossDist (homogeneous), works with deterministic recovery only.
-                // If possible we use the homogeneous algorithm in QuantLib::LossDist. This also avoids small
-                // regression errors from switching to any of the bucketing algorithms in the homogeneous case. 
-                conditionalDist = (*bucketing)(lgd_, cpr);
-                useQlBucketing = true;
-            }
-            else {
-                // We could use hwb.computeMultiState here as well, yields the same result,
-                // but compute is slightly faster than computeMultiState.
-                hwb.compute(cpr.begin(), cpr.end(), lgd_.begin());                
-            }
+        factor[0] = factorNodes_[k];
+        std::vector<Real> cpr = updateCPRs(c, factor, cprVV, recoveryRate);
+
+        // Loss distribution up to date d conditional on common factor M = m.
+        Distribution conditionalDist;
+        if (useStochasticRecovery_) {
+            // HW bucketing with multi-state extension for stochastic recovery
+            // With stochastic recovery the portfolios is in general not homogeneous any more, so that
+            // bucketing is the only choice. We could use this call in all cases (including deterministic
+            // recovery, homogeneous pool), but this can cause small regression errors (using bucketing
+            // instead of homogeneoius pool algorithm) and calculation time increase (QuantLib::LossDist's
+            // bucketing is faster).
+            hwb.computeMultiState(cprVV.begin(), cprVV.end(), lgdVV_.begin());                
+        }
+        else if (homogeneous_) {
+            // Original QuantLib::LossDist (homogeneous), works with deterministic recovery only.
+            // If possible we use the homogeneous algorithm in QuantLib::LossDist. This also avoids small
+            // regression errors from switching to any of the bucketing algorithms in the homogeneous case. 
+            conditionalDist = (*bucketing)(lgd_, cpr);
+            useQlBucketing = true;
+        }
+        else {
+            // We could use hwb.computeMultiState here as well, yields the same result,
+            // but compute is slightly faster than computeMultiState.
+            hwb.compute(cpr.begin(), cpr.end(), lgd_.begin());                
+        }
 
-            // Update final distribution with contribution from common factor M = m.
-            Real densitydm = delta_ * copula_->density(factor);
+        // Update final distribution with contribution from common factor M = m.
+        Real densitydm = factorWeights_[k];
 
-            if (useQlBucketing) {
-                for (Size j = 0; j < nBuckets_; j++) {
-                    dist.addDensity(j, conditionalDist.density(j) * densitydm);
-                    dist.addAverage(j, conditionalDist.average(j) * densitydm);
-                }
+        if (useQlBucketing) {
+            for (Size j = 0; j < nBuckets_; j++) {
+                dist.addDensity(j, conditionalDist.density(j) * densitydm);
+                dist.addAverage(j, conditionalDist.average(j) * densitydm);
+            }
+        }
+        else {
+            // Bucket 0 contains losses up to lowerBound, and bucket 1 from [lowerBound, lowerBound + dx),
+            // together both buckets contains (-inf, lowerBound + dx)
+            // Since we dont have any negative losses in a CDO its [0, dx)
+            double p0 = (hwb.probability()[0] + hwb.probability()[1]);
+            double A0 = 0;
+            if (!QuantLib::close_enough(p0, 0.0)) {
+                A0 = (hwb.averageLoss()[0] * hwb.probability()[0] + hwb.averageLoss()[1] * hwb.probability()[1]) / p0; 
             }
-            else {
-                // Bucket 0 contains losses up to lowerBound, and bucket 1 from [lowerBound, lowerBound + dx),
-                // together both buckets contains (-inf, lowerBound + dx)
-                // Since we dont have any negative losses in a CDO its [0, dx)
-                double p0 = (hwb.probability()[0] + hwb.probability()[1]);
-                double A0 = 0;
-                if (!QuantLib::close_enough(p0, 0.0)) {
-                    A0 = (hwb.averageLoss()[0] * hwb.probability()[0] + hwb.averageLoss()[1] * hwb.probability()[1]) / p0; 
-                }
-                p[0] += p0 * densitydm;
-                A[0] += A0 * densitydm;
-                 
-                for (Size j = 2; j < hwb.buckets(); j++) {
-                    p[j-1] += hwb.probability()[j] * densitydm;
-                    A[j-1] += hwb.averageLoss()[j] * densitydm;
-                }
+            p[0] += p0 * densitydm;
+            A[0] += A0 * densitydm;
+             
+            for (Size j = 2; j < hwb.buckets(); j++) {
+                p[j-1] += hwb.probability()[j] * densitydm;
+                A[j-1] += hwb.averageLoss()[j] * densitydm;
             }
-            
-            // Move to next value of common factor in [min,max] region.
-            factor[0] += delta_;
         }
+    }
 
-        if (!useQlBucketing) {
-            // Copy results to distribution, skip the right-most bucket (maximum, infty)
-            for (Size j = 0; j < nBuckets_; j++) {
-                dist.addDensity(j, p[j] / dist.dx(j));
-                dist.addAverage(j, A[j]);
-            }
+    if (!useQlBucketing) {
+        // Copy results to distribution, skip the right-most bucket (maximum, infty)
+        for (Size j = 0; j < nBuckets_; j++) {
+            dist.addDensity(j, p[j] / dist.dx(j));
+            dist.addAverage(j, A[j]);
         }
     }
 
@@ -528,8 +618,8 @@ QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::
         // This checks the consistency between the Distribution object and the "raw" p and A vectors
         // by way of expectedTrancheLoss calculations.
         // Can be deactivated because of its performance impact.
-        Real etl1 = expectedTrancheLoss1(d, dist);
-        Real etl2 = expectedTrancheLoss2(d, p, A);
+        Real etl1 = expectedTrancheLoss1(Date(), dist);
+        Real etl2 = expectedTrancheLoss2(Date(), p, A);
         Real tiny = 1e-3;
         QL_REQUIRE(fabs((etl1 - etl2)/etl2) < tiny, "expected tranche loss failed, " << etl1 << " vs " << etl2);
     }
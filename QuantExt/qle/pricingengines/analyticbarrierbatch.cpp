@@ -0,0 +1,290 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/pricingengines/analyticbarrierbatch.hpp>
+
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/settings.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+namespace {
+
+const CumulativeNormalDistribution cnd;
+
+// the formulas of QuantLib::AnalyticBarrierEngine, phi = +1 for calls and -1 for puts
+Real barrierValue(const Barrier::Type barrierType, const Real phi, const Real spot, const Real strike,
+                  const Real barrier, const Real rebate, const Real stdDev, const Real riskFreeDiscount,
+                  const Real dividendDiscount, const Real mu, const Real lambda) {
+    const Real muSigma = (1.0 + mu) * stdDev;
+    const Real HS = barrier / spot;
+    const Real powHS0 = std::pow(HS, 2.0 * mu);
+    const Real powHS1 = powHS0 * HS * HS;
+    const Real x1 = std::log(spot / strike) / stdDev + muSigma;
+    const Real x2 = std::log(spot / barrier) / stdDev + muSigma;
+    const Real y1 = std::log(barrier * HS / strike) / stdDev + muSigma;
+    const Real y2 = std::log(HS) / stdDev + muSigma;
+    const Real fwd = spot * dividendDiscount, df = strike * riskFreeDiscount;
+
+    auto A = [&](Real p) { return p * (fwd * cnd(p * x1) - df * cnd(p * (x1 - stdDev))); };
+    auto B = [&](Real p) { return p * (fwd * cnd(p * x2) - df * cnd(p * (x2 - stdDev))); };
+    auto C = [&](Real eta, Real p) {
+        return p * (fwd * powHS1 * cnd(eta * y1) - df * powHS0 * cnd(eta * (y1 - stdDev)));
+    };
+    auto D = [&](Real eta, Real p) {
+        return p * (fwd * powHS1 * cnd(eta * y2) - df * powHS0 * cnd(eta * (y2 - stdDev)));
+    };
+    auto E = [&](Real eta) {
+        if (rebate <= 0.0)
+            return 0.0;
+        return rebate * riskFreeDiscount * (cnd(eta * (x2 - stdDev)) - powHS0 * cnd(eta * (y2 - stdDev)));
+    };
+    auto F = [&](Real eta) {
+        if (rebate <= 0.0)
+            return 0.0;
+        Real z = std::log(HS) / stdDev + lambda * stdDev;
+        return rebate * (std::pow(HS, mu + lambda) * cnd(eta * z) +
+                         std::pow(HS, mu - lambda) * cnd(eta * (z - 2.0 * lambda * stdDev)));
+    };
+
+    const bool above = strike >= barrier;
+    if (phi > 0.0) {
+        switch (barrierType) {
+        case Barrier::DownIn:
+            return above ? C(1, 1) + E(1) : A(1) - B(1) + D(1, 1) + E(1);
+        case Barrier::UpIn:
+            return above ? A(1) + E(-1) : B(1) - C(-1, 1) + D(-1, 1) + E(-1);
+        case Barrier::DownOut:
+            return above ? A(1) - C(1, 1) + F(1) : B(1) - D(1, 1) + F(1);
+        case Barrier::UpOut:
+            return above ? F(-1) : A(1) - B(1) + C(-1, 1) - D(-1, 1) + F(-1);
+        }
+    } else {
+        switch (barrierType) {
+        case Barrier::DownIn:
+            return above ? B(-1) - C(1, -1) + D(1, -1) + E(1) : A(-1) + E(1);
+        case Barrier::UpIn:
+            return above ? A(-1) - B(-1) + D(-1, -1) + E(-1) : C(-1, -1) + E(-1);
+        case Barrier::DownOut:
+            return above ? A(-1) - B(-1) + C(1, -1) - D(1, -1) + F(1) : F(1);
+        case Barrier::UpOut:
+            return above ? B(-1) - D(-1, -1) + F(-1) : A(-1) - C(-1, -1) + F(-1);
+        }
+    }
+    QL_FAIL("AnalyticBarrierBatch: unknown barrier type " << barrierType);
+}
+
+bool triggered(const Barrier::Type barrierType, const Real spot, const Real barrier) {
+    return (barrierType == Barrier::DownIn || barrierType == Barrier::DownOut) ? spot < barrier : spot > barrier;
+}
+
+} // namespace
+
+BlackScholesOptionBatch::BlackScholesOptionBatch(const boost::shared_ptr<GeneralizedBlackScholesProcess>& process)
+    : process_(process), calculated_(0), dirty_(true), spot_(Null<Real>()) {
+    registerWith(process_);
+}
+
+Size BlackScholesOptionBatch::addContract(const Date& expiry) {
+    auto e = std::find(expiries_.begin(), expiries_.end(), expiry);
+    expiryIndex_.push_back(e - expiries_.begin());
+    if (e == expiries_.end())
+        expiries_.push_back(expiry);
+    values_.push_back(Null<Real>());
+    served_.push_back(false);
+    return values_.size() - 1;
+}
+
+Real BlackScholesOptionBatch::value(Size i) {
+    QL_REQUIRE(i < values_.size(), "BlackScholesOptionBatch: contract index " << i << " out of range, batch has "
+                                                                              << values_.size() << " contracts");
+    const Real spot = process_->x0();
+    const Date today = Settings::instance().evaluationDate();
+    if (dirty_ || served_[i] || spot != spot_ || today != evaluationDate_) {
+        std::fill(served_.begin(), served_.end(), false);
+        calculated_ = 0;
+        dirty_ = false;
+        spot_ = spot;
+        evaluationDate_ = today;
+    }
+    if (calculated_ < values_.size()) {
+        calculate(calculated_);
+        calculated_ = values_.size();
+    }
+    served_[i] = true;
+    return values_[i];
+}
+
+Size AnalyticBarrierBatch::add(Barrier::Type barrierType, Option::Type optionType, Real strike, Real barrier,
+                               Real rebate, const Date& expiry) {
+    Key key(barrierType, optionType, strike, barrier, rebate, expiry);
+    auto it = index_.find(key);
+    if (it != index_.end())
+        return it->second;
+    Size i = addContract(expiry);
+    barrierType_.push_back(barrierType);
+    phi_.push_back(optionType == Option::Call ? 1.0 : -1.0);
+    strike_.push_back(strike);
+    barrier_.push_back(barrier);
+    rebate_.push_back(rebate);
+    index_[key] = i;
+    return i;
+}
+
+void AnalyticBarrierBatch::calculate(Size from) {
+    const Size n = values_.size(), m = expiries_.size();
+    const Real spot = process_->x0();
+
+    // market data per expiry, as read by the QuantLib::AnalyticBarrierEngine
+    time_.assign(m, Null<Real>());
+    riskFreeDiscount_.resize(m);
+    dividendDiscount_.resize(m);
+    riskFreeRate_.resize(m);
+    dividendYield_.resize(m);
+    for (Size e = 0; e < m; ++e) {
+        try {
+            Time t = process_->time(expiries_[e]);
+            if (t <= 0.0)
+                continue;
+            riskFreeDiscount_[e] = process_->riskFreeRate()->discount(t);
+            dividendDiscount_[e] = process_->dividendYield()->discount(t);
+            riskFreeRate_[e] = process_->riskFreeRate()->zeroRate(t, Continuous, NoFrequency);
+            dividendYield_[e] = process_->dividendYield()->zeroRate(t, Continuous, NoFrequency);
+            time_[e] = t;
+        } catch (...) {
+        }
+    }
+
+    // market data per contract
+    stdDev_.resize(n);
+    mu_.resize(n);
+    lambda_.resize(n);
+    for (Size k = from; k < n; ++k) {
+        stdDev_[k] = Null<Real>();
+        const Size e = expiryIndex_[k];
+        if (time_[e] == Null<Real>() || spot <= 0.0 || strike_[k] <= 0.0 ||
+            triggered(barrierType_[k], spot, barrier_[k]))
+            continue;
+        try {
+            Volatility vol = process_->blackVolatility()->blackVol(time_[e], strike_[k]);
+            Real sd = vol * std::sqrt(time_[e]);
+            if (sd < QL_EPSILON)
+                continue;
+            mu_[k] = (riskFreeRate_[e] - dividendYield_[e]) / (vol * vol) - 0.5;
+            lambda_[k] = rebate_[k] > 0.0 ? std::sqrt(mu_[k] * mu_[k] + 2.0 * riskFreeRate_[e] / (vol * vol)) : 0.0;
+            stdDev_[k] = sd;
+        } catch (...) {
+        }
+    }
+
+    // closed form
+    for (Size k = from; k < n; ++k) {
+        const Size e = expiryIndex_[k];
+        values_[k] = stdDev_[k] == Null<Real>()
+                         ? Null<Real>()
+                         : barrierValue(barrierType_[k], phi_[k], spot, strike_[k], barrier_[k], rebate_[k],
+                                        stdDev_[k], riskFreeDiscount_[e], dividendDiscount_[e], mu_[k], lambda_[k]);
+    }
+}
+
+Size AnalyticDigitalAmericanBatch::add(Option::Type optionType, Real barrier, Real cash, const Date& expiry,
+                                       bool payoffAtExpiry, bool knockIn) {
+    Key key(optionType, barrier, cash, expiry, payoffAtExpiry, knockIn);
+    auto it = index_.find(key);
+    if (it != index_.end())
+        return it->second;
+    Size i = addContract(expiry);
+    // calls are up and puts down touch options
+    eta_.push_back(optionType == Option::Call ? -1.0 : 1.0);
+    barrier_.push_back(barrier);
+    cash_.push_back(cash);
+    payoffAtExpiry_.push_back(payoffAtExpiry);
+    knockIn_.push_back(knockIn);
+    index_[key] = i;
+    return i;
+}
+
+void AnalyticDigitalAmericanBatch::calculate(Size from) {
+    const Size n = values_.size(), m = expiries_.size();
+    const Real spot = process_->x0();
+
+    // market data per expiry, as read by the QuantLib::AnalyticDigitalAmericanEngine
+    riskFreeDiscount_.assign(m, Null<Real>());
+    dividendDiscount_.resize(m);
+    for (Size e = 0; e < m; ++e) {
+        try {
+            if (process_->time(expiries_[e]) <= 0.0)
+                continue;
+            Real dq = process_->dividendYield()->discount(expiries_[e]);
+            Real dr = process_->riskFreeRate()->discount(expiries_[e]);
+            if (dr <= 0.0 || dq <= 0.0)
+                continue;
+            dividendDiscount_[e] = dq;
+            riskFreeDiscount_[e] = dr;
+        } catch (...) {
+        }
+    }
+
+    // market data per contract
+    stdDev_.resize(n);
+    mu_.resize(n);
+    for (Size k = from; k < n; ++k) {
+        stdDev_[k] = Null<Real>();
+        const Size e = expiryIndex_[k];
+        bool touched = eta_[k] < 0.0 ? spot >= barrier_[k] : spot <= barrier_[k];
+        if (riskFreeDiscount_[e] == Null<Real>() || spot <= 0.0 || touched || (!knockIn_[k] && !payoffAtExpiry_[k]))
+            continue;
+        try {
+            Real variance = process_->blackVolatility()->blackVariance(expiries_[e], barrier_[k]);
+            if (variance < QL_EPSILON)
+                continue;
+            mu_[k] = std::log(dividendDiscount_[e] / riskFreeDiscount_[e]) / variance - 0.5;
+            stdDev_[k] = std::sqrt(variance);
+        } catch (...) {
+        }
+    }
+
+    // closed form
+    for (Size k = from; k < n; ++k) {
+        if (stdDev_[k] == Null<Real>()) {
+            values_[k] = Null<Real>();
+            continue;
+        }
+        const Size e = expiryIndex_[k];
+        const Real sd = stdDev_[k], mu = mu_[k], eta = eta_[k];
+        const Real HS = barrier_[k] / spot, logHS = std::log(HS);
+        if (payoffAtExpiry_[k]) {
+            Real d1 = logHS / sd + mu * sd;
+            Real d2 = d1 - 2.0 * mu * sd;
+            Real touchProbability = cnd(eta * d2) + std::pow(HS, 2.0 * mu) * cnd(eta * d1);
+            values_[k] = riskFreeDiscount_[e] * cash_[k] * (knockIn_[k] ? touchProbability : 1.0 - touchProbability);
+        } else {
+            Real lambda = std::sqrt(mu * mu - 2.0 * std::log(riskFreeDiscount_[e]) / (sd * sd));
+            Real d1 = logHS / sd + lambda * sd;
+            Real d2 = d1 - 2.0 * lambda * sd;
+            values_[k] = cash_[k] * (std::pow(HS, mu + lambda) * cnd(eta * d1) +
+                                     std::pow(HS, mu - lambda) * cnd(eta * d2));
+        }
+    }
+}
+
+} // namespace QuantExt
@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/pricingengines/analyticbarrierbatch.hpp
+    \brief batch pricing of single barrier and American digital options under Black-Scholes
+    \ingroup engines
+*/
+
+#pragma once
+
+#include <ql/instruments/barriertype.hpp>
+#include <ql/option.hpp>
+#include <ql/patterns/observable.hpp>
+#include <ql/processes/blackscholesprocess.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace QuantExt {
+
+//! Base class for batches of closed form option prices on one Black-Scholes process
+/*! The contracts of the batch are added once and priced together in the current market state: the market data is
+    gathered into arrays per distinct expiry and contract and the closed form is then evaluated in one loop over the
+    arrays. The values are recomputed when the process notifies a change. Since the notifications might be disabled
+    (e.g. in a simulation market with disabled observation), they are also recomputed when the spot or the evaluation
+    date changed or when a value is requested a second time since the last computation, the latter meaning that the
+    instrument using it is recalculated.
+
+    \ingroup engines
+*/
+class BlackScholesOptionBatch : public QuantLib::Observer {
+public:
+    explicit BlackScholesOptionBatch(const boost::shared_ptr<QuantLib::GeneralizedBlackScholesProcess>& process);
+
+    //! The value of the i-th contract in the current market state, Null<Real>() if it can not be priced in batch
+    QuantLib::Real value(QuantLib::Size i);
+    //! The number of contracts in the batch
+    QuantLib::Size size() const { return values_.size(); }
+
+    void update() override { dirty_ = true; }
+
+protected:
+    //! Add a contract with the given expiry, the derived class stores the contract data at the returned index
+    QuantLib::Size addContract(const QuantLib::Date& expiry);
+    //! Compute the values of the contracts from the given index on
+    virtual void calculate(QuantLib::Size from) = 0;
+
+    boost::shared_ptr<QuantLib::GeneralizedBlackScholesProcess> process_;
+    // the distinct expiries and the expiry of each contract
+    std::vector<QuantLib::Date> expiries_;
+    std::vector<QuantLib::Size> expiryIndex_;
+    std::vector<QuantLib::Real> values_;
+
+private:
+    std::vector<bool> served_;
+    QuantLib::Size calculated_;
+    bool dirty_;
+    QuantLib::Real spot_;
+    QuantLib::Date evaluationDate_;
+};
+
+//! Batch of single barrier options with plain vanilla payoff and European exercise
+/*! The values are those of the QuantLib::AnalyticBarrierEngine, i.e. the formulas of Reiner and Rubinstein with
+    the rebate paid at hit for knock-out and at expiry for knock-in options. Contracts whose barrier is triggered
+    by the current spot are not priced in batch.
+
+    \ingroup engines
+*/
+class AnalyticBarrierBatch : public BlackScholesOptionBatch {
+public:
+    explicit AnalyticBarrierBatch(const boost::shared_ptr<QuantLib::GeneralizedBlackScholesProcess>& process)
+        : BlackScholesOptionBatch(process) {}
+
+    //! Add a contract or return the index of an equal contract already in the batch
+    QuantLib::Size add(QuantLib::Barrier::Type barrierType, QuantLib::Option::Type optionType, QuantLib::Real strike,
+                       QuantLib::Real barrier, QuantLib::Real rebate, const QuantLib::Date& expiry);
+
+private:
+    void calculate(QuantLib::Size from) override;
+
+    typedef std::tuple<int, int, QuantLib::Real, QuantLib::Real, QuantLib::Real, QuantLib::Date> Key;
+    std::map<Key, QuantLib::Size> index_;
+    std::vector<QuantLib::Barrier::Type> barrierType_;
+    std::vector<QuantLib::Real> phi_, strike_, barrier_, rebate_;
+    // work arrays
+    std::vector<QuantLib::Real> time_, riskFreeDiscount_, dividendDiscount_, riskFreeRate_, dividendYield_;
+    std::vector<QuantLib::Real> stdDev_, mu_, lambda_;
+};
+
+//! Batch of American cash-or-nothing options, i.e. one-touch and no-touch options
+/*! The values are those of the QuantLib::AnalyticDigitalAmericanEngine (knock-in) and the
+    QuantLib::AnalyticDigitalAmericanKOEngine (knock-out): the discounted touch probability for payoffs at expiry and
+    the formula of Reiner and Rubinstein for payoffs at hit. Contracts which are already touched by the current spot
+    are not priced in batch.
+
+    \ingroup engines
+*/
+class AnalyticDigitalAmericanBatch : public BlackScholesOptionBatch {
+public:
+    explicit AnalyticDigitalAmericanBatch(const boost::shared_ptr<QuantLib::GeneralizedBlackScholesProcess>& process)
+        : BlackScholesOptionBatch(process) {}
+
+    //! Add a contract or return the index of an equal contract already in the batch
+    QuantLib::Size add(QuantLib::Option::Type optionType, QuantLib::Real barrier, QuantLib::Real cash,
+                       const QuantLib::Date& expiry, bool payoffAtExpiry, bool knockIn);
+
+private:
+    void calculate(QuantLib::Size from) override;
+
+    typedef std::tuple<int, QuantLib::Real, QuantLib::Real, QuantLib::Date, bool, bool> Key;
+    std::map<Key, QuantLib::Size> index_;
+    std::vector<QuantLib::Real> eta_, barrier_, cash_;
+    std::vector<bool> payoffAtExpiry_, knockIn_;
+    // work arrays
+    std::vector<QuantLib::Real> riskFreeDiscount_, dividendDiscount_, stdDev_, mu_;
+};
+
+} // namespace QuantExt
@@ -17,20 +17,50 @@
 */
 
 #include <ql/exercise.hpp>
+#include <ql/instruments/payoffs.hpp>
 #include <qle/pricingengines/analyticbarrierengine.hpp>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 namespace QuantExt {
 
 using namespace QuantLib;
 
-AnalyticBarrierEngine::AnalyticBarrierEngine(ext::shared_ptr<GeneralizedBlackScholesProcess> process, const Date& paymentDate)
-    : QuantLib::AnalyticBarrierEngine(process), process_(std::move(process)), paymentDate_(paymentDate) {
+AnalyticBarrierEngine::AnalyticBarrierEngine(ext::shared_ptr<GeneralizedBlackScholesProcess> process,
+                                             const Date& paymentDate,
+                                             const boost::shared_ptr<AnalyticBarrierBatch>& batch)
+    : QuantLib::AnalyticBarrierEngine(process), process_(std::move(process)), paymentDate_(paymentDate),
+      batch_(batch) {
     registerWith(process_);
 }
 
+bool AnalyticBarrierEngine::calculateBatch() const {
+    auto payoff = boost::dynamic_pointer_cast<PlainVanillaPayoff>(arguments_.payoff);
+    if (!payoff || arguments_.exercise->type() != Exercise::European)
+        return false;
+    Size i = batch_->add(arguments_.barrierType, payoff->optionType(), payoff->strike(), arguments_.barrier,
+                         arguments_.rebate, arguments_.exercise->lastDate());
+    auto c = batchContracts_.find(i);
+    if (c == batchContracts_.end()) {
+        QuantLib::AnalyticBarrierEngine::calculate();
+        Real v = batch_->value(i);
+        batchContracts_[i] =
+            v != Null<Real>() && std::abs(v - results_.value) <= 1.0E-10 * std::max(std::abs(results_.value), 1.0);
+        return true;
+    }
+    if (!c->second)
+        return false;
+    Real v = batch_->value(i);
+    if (v == Null<Real>())
+        return false;
+    results_.value = v;
+    return true;
+}
+
 void AnalyticBarrierEngine::calculate() const {
-    QuantLib::AnalyticBarrierEngine::calculate();
+    if (!batch_ || !calculateBatch())
+        QuantLib::AnalyticBarrierEngine::calculate();
 
     // If a payDate was provided (and is greater than the expiryDate)
     if (paymentDate_ > arguments_.exercise->lastDate()) {
@@ -27,20 +27,32 @@
 #include <ql/math/distributions/normaldistribution.hpp>
 #include <ql/pricingengines/barrier/analyticbarrierengine.hpp>
 #include <ql/processes/blackscholesprocess.hpp>
+#include <qle/pricingengines/analyticbarrierbatch.hpp>
+
+#include <map>
 
 namespace QuantExt {
 
 using namespace QuantLib;
 
 //! Wrapper engine for the QuantLib engine to take settlement delay into account
+/*! If a batch is given, the option is priced as a contract of the batch, which is shared by the engines of the
+    options on the same process. The batch value of a contract is compared to the value of the QuantLib engine the
+    first time the engine sees the contract, if they do not match the contract is priced by the QuantLib engine. */
 class AnalyticBarrierEngine : public QuantLib::AnalyticBarrierEngine {
 public:
-    AnalyticBarrierEngine(ext::shared_ptr<GeneralizedBlackScholesProcess> process, const Date& paymentDate);
+    AnalyticBarrierEngine(ext::shared_ptr<GeneralizedBlackScholesProcess> process, const Date& paymentDate,
+                          const boost::shared_ptr<AnalyticBarrierBatch>& batch = nullptr);
     void calculate() const override;
 
 private:
+    // sets the value from the batch, returns false if the option is not priced in batch
+    bool calculateBatch() const;
+
     ext::shared_ptr<GeneralizedBlackScholesProcess> process_;
     Date paymentDate_;
+    boost::shared_ptr<AnalyticBarrierBatch> batch_;
+    mutable std::map<Size, bool> batchContracts_;
 };
 
 } // namespace QuantExt
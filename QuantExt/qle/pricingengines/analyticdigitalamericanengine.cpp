@@ -17,7 +17,10 @@
 */
 
 #include <ql/exercise.hpp>
+#include <ql/instruments/payoffs.hpp>
 #include <qle/pricingengines/analyticdigitalamericanengine.hpp>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 using std::string;
@@ -27,9 +30,34 @@ namespace QuantExt {
 
 using namespace QuantLib;
 
+bool AnalyticDigitalAmericanEngine::calculateBatch() const {
+    auto payoff = boost::dynamic_pointer_cast<CashOrNothingPayoff>(arguments_.payoff);
+    auto exercise = boost::dynamic_pointer_cast<AmericanExercise>(arguments_.exercise);
+    if (!payoff || !exercise)
+        return false;
+    Size i = batch_->add(payoff->optionType(), payoff->strike(), payoff->cashPayoff(), exercise->lastDate(),
+                         exercise->payoffAtExpiry(), knock_in());
+    auto c = batchContracts_.find(i);
+    if (c == batchContracts_.end()) {
+        QuantLib::AnalyticDigitalAmericanEngine::calculate();
+        Real v = batch_->value(i);
+        batchContracts_[i] =
+            v != Null<Real>() && std::abs(v - results_.value) <= 1.0E-10 * std::max(std::abs(results_.value), 1.0);
+        return true;
+    }
+    if (!c->second)
+        return false;
+    Real v = batch_->value(i);
+    if (v == Null<Real>())
+        return false;
+    results_.value = v;
+    return true;
+}
+
 void AnalyticDigitalAmericanEngine::calculate() const {
 
-    QuantLib::AnalyticDigitalAmericanEngine::calculate();
+    if (!batch_ || !calculateBatch())
+        QuantLib::AnalyticDigitalAmericanEngine::calculate();
 
     // If a payDate was provided (and is greater than the expiryDate)
     if (payDate_ > arguments_.exercise->lastDate()) {
@@ -27,28 +27,38 @@
 #include <ql/instruments/vanillaoption.hpp>
 #include <ql/pricingengines/vanilla/analyticdigitalamericanengine.hpp>
 #include <ql/processes/blackscholesprocess.hpp>
+#include <qle/pricingengines/analyticbarrierbatch.hpp>
+
+#include <map>
 
 namespace QuantExt {
 
 using namespace QuantLib;
 
 //! Analytic pricing engine for American vanilla options with digital payoff
-
+/*! If a batch is given, cash-or-nothing options are priced as contracts of the batch, see AnalyticBarrierEngine. The
+    batch only provides the value, no additional results. */
 class AnalyticDigitalAmericanEngine : public QuantLib::AnalyticDigitalAmericanEngine {
 public:
     AnalyticDigitalAmericanEngine(ext::shared_ptr<GeneralizedBlackScholesProcess> process,
-                                  const QuantLib::Date& payDate, const bool flipResults = false)
+                                  const QuantLib::Date& payDate, const bool flipResults = false,
+                                  const boost::shared_ptr<AnalyticDigitalAmericanBatch>& batch = nullptr)
         : QuantLib::AnalyticDigitalAmericanEngine(process), process_(std::move(process)), payDate_(payDate),
-          flipResults_(flipResults) {
+          flipResults_(flipResults), batch_(batch) {
         registerWith(process_);
     }
     void calculate() const override;
     virtual bool knock_in() const override { return true; }
 
 private:
+    // sets the value from the batch, returns false if the option is not priced in batch
+    bool calculateBatch() const;
+
     ext::shared_ptr<GeneralizedBlackScholesProcess> process_;
     QuantLib::Date payDate_;
     bool flipResults_;
+    boost::shared_ptr<AnalyticDigitalAmericanBatch> batch_;
+    mutable std::map<QuantLib::Size, bool> batchContracts_;
 };
 
 //! Analytic pricing engine for American Knock-out options with digital payoff
@@ -56,8 +66,9 @@ private:
 class AnalyticDigitalAmericanKOEngine : public AnalyticDigitalAmericanEngine {
 public:
     AnalyticDigitalAmericanKOEngine(const ext::shared_ptr<GeneralizedBlackScholesProcess>& engine,
-                                    const QuantLib::Date& payDate, const bool flipResults = false)
-        : AnalyticDigitalAmericanEngine(engine, payDate, flipResults) {}
+                                    const QuantLib::Date& payDate, const bool flipResults = false,
+                                    const boost::shared_ptr<AnalyticDigitalAmericanBatch>& batch = nullptr)
+        : AnalyticDigitalAmericanEngine(engine, payDate, flipResults, batch) {}
     bool knock_in() const override { return false; }
 };
 
@@ -240,8 +240,26 @@ void AnalyticLgmSwaptionEngine::calculate() const {
         D0_ = c_->discount(floatingLeg_[k1_]->accrualStartDate());
         Dj_.resize(fixedLeg_.size() - j1_);
         for (Size j = j1_; j < fixedLeg_.size(); ++j) {
-            Dj_[j - j1_] = c_->discount(fixedLeg_[j - j1_]->date());
+            Dj_[j - j1_] = c_->discount(fixedLeg_[j]->date());
         }
+
+        // the discounted cash amounts of the fixed leg including the final notional exchange and the discounted
+        // amount paid at the start of the underlying, these do not depend on the model parameters
+        Cj_.resize(fixedLeg_.size() - j1_);
+        for (Size j = j1_; j < fixedLeg_.size(); ++j) {
+            Cj_[j - j1_] = (fixedLeg_[j]->amount() - S_[j - j1_]) * Dj_[j - j1_];
+        }
+        Cj_.back() += nominal_ * Dj_.back();
+        C0_ = (S_m1 + nominal_) * D0_;
+
+        // model times, so that a recalibration of H or alpha does not need to go back to the dates
+        t0_ = p_->termStructure()->timeFromReference(floatingLeg_[k1_]->accrualStartDate());
+        tj_.resize(fixedLeg_.size() - j1_);
+        for (Size j = j1_; j < fixedLeg_.size(); ++j) {
+            tj_[j - j1_] = p_->termStructure()->timeFromReference(fixedLeg_[j]->date());
+        }
+        tex_ = p_->termStructure()->timeFromReference(expiry);
+        yStar_ = 0.0;
     }
 
     if (!caching_ || !lgm_H_constant_ || Hj_.empty()) {
@@ -249,26 +267,35 @@ void AnalyticLgmSwaptionEngine::calculate() const {
         // with u = -1.0 we handle the case H' < 0
         u_ = p_->Hprime(0.0) > 0.0 ? 1.0 : -1.0;
 
-        H0_ = p_->H(p_->termStructure()->timeFromReference(floatingLeg_[k1_]->accrualStartDate()));
-        Hj_.resize(fixedLeg_.size() - j1_);
-        for (Size j = j1_; j < fixedLeg_.size(); ++j) {
-            Hj_[j - j1_] = p_->H(p_->termStructure()->timeFromReference(fixedLeg_[j]->date()));
+        H0_ = p_->H(t0_);
+        Hj_.resize(tj_.size());
+        dHj_.resize(tj_.size());
+        for (Size j = 0; j < tj_.size(); ++j) {
+            Hj_[j] = p_->H(tj_[j]);
+            dHj_[j] = Hj_[j] - H0_;
         }
     }
 
     if (!caching_ || !lgm_alpha_constant_ || zetaex_ == Null<Real>()) {
-        zetaex_ = p_->zeta(p_->termStructure()->timeFromReference(expiry));
+        zetaex_ = p_->zeta(tex_);
+    }
+
+    // the y independent part of the exponents in yStarHelper()
+    hzj_.resize(dHj_.size());
+    for (Size j = 0; j < dHj_.size(); ++j) {
+        hzj_[j] = 0.5 * dHj_[j] * dHj_[j] * zetaex_;
     }
 
+    // in calibration mode we start the search from the solution of the previous pricing
     Brent b;
     Real yStar;
     try {
         yStar = b.solve(boost::bind(&AnalyticLgmSwaptionEngine::yStarHelper, this, boost::placeholders::_1), 1.0E-6,
-                        0.0, 0.01);
+                        caching_ ? yStar_ : 0.0, 0.01);
     } catch (const std::exception& e) {
         std::ostringstream os;
         os << "AnalyticLgmSwaptionEngine: failed to compute yStar (" << e.what() << "), parameter details: [";
-        Real tte = p_->termStructure()->timeFromReference(expiry);
+        Real tte = tex_;
         os << "tte=" << tte << ", vol=" << std::sqrt(zetaex_ / tte) << ", nominal=" << nominal_
            << ", d=" << D0_;
         for (Size j = 0; j < Dj_.size(); ++j)
@@ -288,16 +315,16 @@ void AnalyticLgmSwaptionEngine::calculate() const {
         QL_FAIL(os.str());
     }
 
+    if (caching_)
+        yStar_ = yStar;
+
     CumulativeNormalDistribution N;
     Real sqrt_zetaex = std::sqrt(zetaex_);
     Real sum = 0.0;
-    for (Size j = j1_; j < fixedLeg_.size(); ++j) {
-        sum += w_ * (fixedLeg_[j]->amount() - S_[j - j1_]) * Dj_[j - j1_] *
-               N(u_ * w_ * (yStar + (Hj_[j - j1_] - H0_) * zetaex_) / sqrt_zetaex);
+    for (Size j = 0; j < Cj_.size(); ++j) {
+        sum += w_ * Cj_[j] * N(u_ * w_ * (yStar + dHj_[j] * zetaex_) / sqrt_zetaex);
     }
-    sum += -w_ * S_m1 * D0_ * N(u_ * w_ * yStar / sqrt_zetaex);
-    sum += w_ * (nominal_ * Dj_.back() * N(u_ * w_ * (yStar + (Hj_.back() - H0_) * zetaex_) / sqrt_zetaex) -
-                 nominal_ * D0_ * N(u_ * w_ * yStar / sqrt_zetaex));
+    sum -= w_ * C0_ * N(u_ * w_ * yStar / sqrt_zetaex);
     results_.value = sum;
 
     results_.additionalResults["fixedAmountCorrectionSettlement"] = S_m1;
@@ -306,15 +333,10 @@ void AnalyticLgmSwaptionEngine::calculate() const {
 } // calculate
 
 Real AnalyticLgmSwaptionEngine::yStarHelper(const Real y) const {
-    Real sum = 0.0;
-    for (Size j = j1_; j < fixedLeg_.size(); ++j) {
-        sum += (fixedLeg_[j]->amount() - S_[j - j1_]) * Dj_[j - j1_] *
-               std::exp(-(Hj_[j - j1_] - H0_) * y - 0.5 * (Hj_[j - j1_] - H0_) * (Hj_[j - j1_] - H0_) * zetaex_);
+    Real sum = -C0_;
+    for (Size j = 0; j < Cj_.size(); ++j) {
+        sum += Cj_[j] * std::exp(-dHj_[j] * y - hzj_[j]);
     }
-    sum += -S_m1 * D0_;
-    sum += Dj_.back() * nominal_ *
-           std::exp(-(Hj_.back() - H0_) * y - 0.5 * (Hj_.back() - H0_) * (Hj_.back() - H0_) * zetaex_);
-    sum -= D0_ * nominal_;
     return sum;
 }
 
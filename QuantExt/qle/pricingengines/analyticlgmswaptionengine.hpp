@@ -90,7 +90,9 @@ public:
     /* If enabled, the underlying instrument should not changed between two pricings or the cache has to be
        cleared. Furthermore it is assumed that all the market data stays constant between two pricings.
        Regarding the LGM parameters it is assumed that either H(t) or alpha(t) (or both) is constant, depending
-       on the passed parameters here. enableCache() should only be called once on an instance of this class. */
+       on the passed parameters here. enableCache() should only be called once on an instance of this class.
+       With the cache enabled, the discounted cash amounts of the underlying and the model times are computed on
+       the first pricing only, subsequent pricings only recompute the parameter dependent terms H and zeta. */
     void enableCache(const bool lgm_H_constant = true, const bool lgm_alpha_constant = false);
     void clearCache();
 
@@ -102,6 +104,10 @@ private:
     bool caching_, lgm_H_constant_, lgm_alpha_constant_;
     mutable Real H0_, D0_, zetaex_, S_m1, u_, w_;
     mutable std::vector<Real> S_, Hj_, Dj_;
+    // discounted fixed leg cash amounts (incl. notional) and settlement amount, model times, H(t_j) - H(t_0) and
+    // 0.5 (H(t_j) - H(t_0))^2 zeta(t_ex), and the last solution for y*, used as a start value in calibration mode
+    mutable Real C0_, t0_, tex_, yStar_;
+    mutable std::vector<Real> Cj_, tj_, dHj_, hzj_;
     mutable Size j1_, k1_;
     mutable std::vector<boost::shared_ptr<FixedRateCoupon>> fixedLeg_;
     mutable std::vector<boost::shared_ptr<FloatingRateCoupon>> floatingLeg_;
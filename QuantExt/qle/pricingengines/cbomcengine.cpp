@@ -21,141 +21,118 @@
 #include <ql/experimental/credit/loss.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace std;
 using namespace QuantLib;
 
 namespace QuantExt {
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::interestWaterfall(Size i, // sample index
-                                    Size j, // date index
-                                    const vector<Date>& dates,
-                                    map<Currency,vector<Cash> >& iFlows, 
-                                    map<Currency,Cash>& tranche,
-                                    map<Currency,vector<vector<Real> > >& balance,
-                                    map<Currency,Real>& interest,
-                                    map<Currency,Real>& interestAcc,
-                                    Real cureAmount) const {
-        Currency ccy = arguments_.ccy;
-
+    void MonteCarloCBOEngine::interestWaterfall(Size k, // tranche index
+                                                Real& iFlow,
+                                                Real& iDiscountedFlow,
+                                                TrancheState& s) const {
         Real tiny = 1e-9;
-        if (balance[ccy][j][i] < tiny) {
-            tranche[ccy].flow_ = 0.0;
-            tranche[ccy].discountedFlow_ = 0.0;
+        if (s.balance[k] < tiny) {
+            s.flow[k] = 0.0;
+            s.discountedFlow[k] = 0.0;
             return;
         }
 
-        Real ccyDis = (iFlows[ccy][j].flow_ > 0 ?
-                       iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_:
-                       0.0);
+        Real ccyDis = (iFlow > 0 ? iDiscountedFlow / iFlow : 0.0);
 
         // Accrued Interest
 
-        Real amount = std::min(iFlows[ccy][j].flow_, interestAcc[ccy]);
+        Real amount = std::min(iFlow, s.interestAcc[k]);
 
-        tranche[ccy].flow_ += amount;
-        tranche[ccy].discountedFlow_ += amount * ccyDis;
+        s.flow[k] += amount;
+        s.discountedFlow[k] += amount * ccyDis;
 
-        iFlows[ccy][j].flow_  -= amount;
-        iFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+        iFlow -= amount;
+        iDiscountedFlow -= amount * ccyDis;
 
-        interest[ccy] -= amount;
+        s.interest[k] -= amount;
 
         // Truncate rounding errors
-        balance[ccy][j][i] = std::max(balance[ccy][j][i], 0.0);
-        iFlows[ccy][j].flow_ = std::max(iFlows[ccy][j].flow_, 0.0);
-        iFlows[ccy][j].discountedFlow_ = std::max(iFlows[ccy][j].discountedFlow_, 0.0);
-        tranche[ccy].discountedFlow_ = std::max(tranche[ccy].discountedFlow_, 0.0);
+        s.balance[k] = std::max(s.balance[k], 0.0);
+        iFlow = std::max(iFlow, 0.0);
+        iDiscountedFlow = std::max(iDiscountedFlow, 0.0);
+        s.discountedFlow[k] = std::max(s.discountedFlow[k], 0.0);
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::icocInterestWaterfall(Size i, // sample index
-                                                    Size j, // date index
-                                                    Size l, //tranche
-                                                    const vector<Date>& dates,
-                                                    map<Currency,vector<Cash> >& iFlows,
-                                                    vector<map<Currency,Cash> >& tranches,
-                                                    vector<map<Currency,vector<vector<Real> > > >& balances,
+    void MonteCarloCBOEngine::icocInterestWaterfall(Size l, // tranche index
+                                                    Real& iFlow,
+                                                    Real& iDiscountedFlow,
+                                                    TrancheState& s,
                                                     Real cureAmount) const {
-        Currency ccy = arguments_.ccy;
-
-        Real ccyDis = (iFlows[ccy][j].flow_ > 0 ?
-                       iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_:
-                       0.0);
+        Real ccyDis = (iFlow > 0 ? iDiscountedFlow / iFlow : 0.0);
 
         //IC and OC
 
-        Real cureAvailable = min(iFlows[ccy][j].flow_, cureAmount);
+        Real cureAvailable = min(iFlow, cureAmount);
 
         for(Size k = 0; k <= l; k++){
 
-            Real amount = std::min(balances[k][ccy][j][i], cureAvailable);
+            Real amount = std::min(s.balance[k], cureAvailable);
 
-            tranches[k][ccy].flow_ += amount;
-            tranches[k][ccy].discountedFlow_ += amount * ccyDis;
+            s.flow[k] += amount;
+            s.discountedFlow[k] += amount * ccyDis;
 
-            iFlows[ccy][j].flow_           -= amount;
-            iFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+            iFlow           -= amount;
+            iDiscountedFlow -= amount * ccyDis;
 
-            balances[k][ccy][j][i] -= amount;
+            s.balance[k] -= amount;
 
             cureAvailable -= amount;
 
             // truncate rounding errors
-            balances[k][ccy][j][i] = std::max(balances[k][ccy][j][i], 0.0);
-            iFlows[ccy][j].flow_ = std::max(iFlows[ccy][j].flow_, 0.0);
-            iFlows[ccy][j].discountedFlow_ = std::max(iFlows[ccy][j].discountedFlow_, 0.0);
-            tranches[k][ccy].discountedFlow_ = std::max(tranches[k][ccy].discountedFlow_, 0.0);
+            s.balance[k] = std::max(s.balance[k], 0.0);
+            iFlow = std::max(iFlow, 0.0);
+            iDiscountedFlow = std::max(iDiscountedFlow, 0.0);
+            s.discountedFlow[k] = std::max(s.discountedFlow[k], 0.0);
         }
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::principalWaterfall(Size i, // sample index
-                                                Size j, // date index
-                                                const vector<Date>& dates,
-                                                map<Currency,vector<Cash> >& pFlows, 
-                                                map<Currency,Cash>& tranche,
-                                                map<Currency,vector<vector<Real> > >& balance,
-                                                map<Currency,Real>& interest) const {
-        Currency ccy = arguments_.ccy;
-
-        Real ccyDis = (pFlows[ccy][j].flow_ > 0 ?
-                       pFlows[ccy][j].discountedFlow_ / pFlows[ccy][j].flow_:
-                       0.0);
+    void MonteCarloCBOEngine::principalWaterfall(Size k, // tranche index
+                                                 Real& pFlow,
+                                                 Real& pDiscountedFlow,
+                                                 TrancheState& s) const {
+        Real ccyDis = (pFlow > 0 ? pDiscountedFlow / pFlow : 0.0);
 
         //Principal Waterfall
 
-        Real amount = std::min(pFlows[ccy][j].flow_, balance[ccy][j][i]);
+        Real amount = std::min(pFlow, s.balance[k]);
 
-        tranche[ccy].flow_ += amount;
-        tranche[ccy].discountedFlow_ += amount * ccyDis;
+        s.flow[k] += amount;
+        s.discountedFlow[k] += amount * ccyDis;
 
-        pFlows[ccy][j].flow_           -= amount;
-        pFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+        pFlow           -= amount;
+        pDiscountedFlow -= amount * ccyDis;
 
-        balance[ccy][j][i] -= amount;
+        s.balance[k] -= amount;
 
         // truncate rounding errors
-        balance[ccy][j][i] = std::max(balance[ccy][j][i], 0.0);
-        pFlows[ccy][j].flow_ = std::max(pFlows[ccy][j].flow_, 0.0);
-        pFlows[ccy][j].discountedFlow_ = std::max(pFlows[ccy][j].discountedFlow_, 0.0);
-        tranche[ccy].discountedFlow_ = std::max(tranche[ccy].discountedFlow_, 0.0);
+        s.balance[k] = std::max(s.balance[k], 0.0);
+        pFlow = std::max(pFlow, 0.0);
+        pDiscountedFlow = std::max(pDiscountedFlow, 0.0);
+        s.discountedFlow[k] = std::max(s.discountedFlow[k], 0.0);
 
-        interest[ccy] -= std::min(interest[ccy], amount);
+        s.interest[k] -= std::min(s.interest[k], amount);
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    Real MonteCarloCBOEngine::icocCureAmount(Size i,
-                        Size j,
-                        Size k,
+    Real MonteCarloCBOEngine::icocCureAmount(Size k,
                         Real basketNotional,
                         Real basketInterest,
-                        vector<map<Currency ,vector<vector<Real> > > >& trancheBalances,
-                        vector<Real> trancheInterestRates,
+                        const TrancheState& s,
+                        const vector<Real>& trancheInterestRates,
                         Real icRatio,
                         Real ocRatio) const {
-        Currency ccy = arguments_.ccy;
-
         Real cureAmount;
 
         if((icRatio < 0.) && (ocRatio < 0.)){
@@ -166,8 +143,8 @@ namespace QuantExt {
             Real piC = 0.;
 
             for(Size l = 0; l < k; l++){
-                poC-= trancheBalances[l][ccy][j][i];
-                piC-= trancheBalances[l][ccy][j][i]*trancheInterestRates[l];
+                poC-= s.balance[l];
+                piC-= s.balance[l]*trancheInterestRates[l];
             }
 
             poC+= basketNotional/ocRatio;
@@ -182,11 +159,180 @@ namespace QuantExt {
             poC = std::max(poC, 0.);
             Real pTarget = std::min(poC, piC);
 
-            cureAmount = max(trancheBalances[k][ccy][j][i] - pTarget, 0.) ;
+            cureAmount = max(s.balance[k] - pTarget, 0.) ;
         }
         return cureAmount;
     }
 
+    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    void MonteCarloCBOEngine::waterfall(Size i, // sample index
+                                        const BasketScenarios& b,
+                                        const vector<vector<Real> >& trancheInterestRates,
+                                        const vector<Real>& feeYearFractions,
+                                        TrancheState& s,
+                                        SampleValues& v) const {
+        const vector<Tranche>& tranches = arguments_.tranches;
+        const Size n = tranches.size();
+
+        for (Size k = 0; k < n; k++) {
+            s.balance[k] = tranches[k].faceAmount;
+            s.interest[k] = 0.0;
+        }
+
+        for (Size j = 1; j < b.dates; j++) {
+
+            // the flows of this sample and date, updated by the waterfall
+            const Size idx = i * b.dates + j;
+            Real cf = b.flow[idx], cfDiscounted = b.discountedFlow[idx];
+            Real iFlow = b.interestFlow[idx], iDiscounted = b.discountedInterestFlow[idx];
+            Real pFlow = b.principalFlow[idx], pDiscounted = b.discountedPrincipalFlow[idx];
+            Real basketNotional = b.notional[idx];
+
+            //Back out discountfactors
+
+            Real intCcyDis = (iFlow > 0 ? iDiscounted / iFlow : 0.0);
+
+            /**************************************************************
+             * check flows add up
+             */
+            Real tiny = 1.0e-6;
+            Real flowsCheck = fabs(cf - iFlow - pFlow);
+            QL_REQUIRE( flowsCheck < tiny,
+                       "Interest and Principal Flows don't sum to Total: "
+                       << flowsCheck);
+
+            Real dfFlowsCheck = fabs(cfDiscounted - iDiscounted - pDiscounted);
+
+            QL_REQUIRE( dfFlowsCheck < tiny,
+                       "discounted Interest and Principal Flows don't sum to Total: "
+                       << dfFlowsCheck);
+
+            /**************************************************************
+             * tranche interest claim
+             */
+            const vector<Real>& rates = trancheInterestRates[j];
+            for (Size k = 0 ; k < n; k++){
+                s.interestAcc[k] = s.balance[k] * rates[k];
+                s.interest[k] += s.interestAcc[k];
+            }
+            /**************************************************************
+             * Collections
+             */
+            Real ccyDFlow = cfDiscounted;
+            Real basketInterest = iFlow; //for cure amount calc
+
+            /**************************************************************
+             * Senior fees
+             */
+            Real ccyFeeClaim = basketNotional * arguments_.seniorFee * feeYearFractions[j];
+
+            Real ccyFeeFlow = std::min(ccyFeeClaim, iFlow);
+
+            iFlow -= ccyFeeFlow;
+            iDiscounted -= ccyFeeFlow * intCcyDis;
+
+            cf -= ccyFeeFlow;
+            cfDiscounted -= ccyFeeFlow * intCcyDis;
+
+            v.fee[i] += ccyFeeFlow * intCcyDis;
+
+            QL_REQUIRE(cf >= 0.0, "ccy flows < 0");
+
+            /**************************************************************
+             * tranche waterfall
+             */
+            std::fill(s.flow.begin(), s.flow.end(), 0.0);
+            std::fill(s.discountedFlow.begin(), s.discountedFlow.end(), 0.0);
+
+            //Interest Waterfall incl. ICOC
+            for (Size k = 0 ; k < n ; k++){
+
+                //IC and OC Target Balances
+                Real cureAmount = icocCureAmount(k, basketNotional, basketInterest, s, rates,
+                                                 tranches[k].icRatio, tranches[k].ocRatio);
+
+                interestWaterfall(k, iFlow, iDiscounted, s);
+
+                icocInterestWaterfall(k, iFlow, iDiscounted, s, cureAmount);
+            }
+
+            //Principal Waterfall
+            for (Size k = 0 ; k < n ; k++){
+
+                principalWaterfall(k, pFlow, pDiscounted, s);
+
+                cf -= s.flow[k];
+                cfDiscounted -= s.discountedFlow[k];
+            }
+
+            /**************************************************************
+             * Subordinated Fee
+             */
+
+            Real ccysubFeeClaim = basketNotional * arguments_.subordinatedFee * feeYearFractions[j];
+
+            Real ccysubFeeFlow = std::min(ccysubFeeClaim, iFlow);
+
+            iFlow -= ccysubFeeFlow;
+            iDiscounted -= ccysubFeeFlow * intCcyDis;
+
+            cf -= ccysubFeeFlow;
+            cfDiscounted -= ccysubFeeFlow * intCcyDis;
+
+            v.subfee[i] += ccysubFeeFlow * intCcyDis;
+            QL_REQUIRE(cf >= -1.0E-5, "ccy flows < 0");
+
+            /**************************************************************
+             * Kicker:
+             * Split excess flows between equity tranche (1-x) and senior fee (x)
+             */
+            Real x = arguments_.equityKicker;
+
+            Cash residual(0.0, 0.0);
+            residual.discountedFlow_ = pDiscounted + iDiscounted;
+            residual.flow_ = pFlow + iFlow;
+
+            s.flow.back() += residual.flow_ * (1 - x);
+            s.discountedFlow.back() +=  residual.discountedFlow_ * (1 - x);
+
+            v.fee[i] += residual.discountedFlow_ * x;
+
+            cf -= residual.flow_;
+            cfDiscounted -= residual.discountedFlow_;
+
+            /**************************************************************
+             * Consistency checks
+             */
+            QL_REQUIRE(cf >= -1.e-5, "residual ccy flow < 0: "<< cf);
+
+            QL_REQUIRE(ccyFeeFlow  >= -1.e-5, "ccy fee flow < 0");
+
+            for(Size k = 0; k < n ; k++){
+                QL_REQUIRE(s.flow[k] >= -1.e-5, "ccy "<<
+                       tranches[k].name <<" flow < 0: "
+                           <<s.flow[k]);
+            }
+
+            v.basket[i] += ccyDFlow;
+            for(Size k = 0 ; k < n ; k ++){
+                v.tranche[k][i] += s.discountedFlow[k];
+            }
+            Real tranchenpvError(0.);
+            for(Size k = 0 ; k < n ; k ++){
+               tranchenpvError += v.tranche[k][i];
+            }
+            Real  npvError(0.);
+            if(v.basket[i] > 0.){
+               npvError = (v.fee[i] + v.subfee[i] + tranchenpvError) / v.basket[i] - 1.0;
+               if(fabs(npvError) > errorTolerance_)
+                    QL_FAIL("NPVs do not add up, rel. error " << npvError);
+            }
+
+            QL_REQUIRE(v.basket[i] >= 0.0,
+                           "negative basket value " << v.basket[i]);
+
+        } // end dates
+    }
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // copied from AmortizingCboLbEngine
     map<Date, string> MonteCarloCBOEngine::getLossDistributionDates(const Date& valuationDate) const {
@@ -275,314 +421,78 @@ namespace QuantExt {
         //other requirements 
         DayCounter feeDayCount = arguments_.feeDayCounter;
         Currency ccy = arguments_.ccy;
-
-        //asset flows 
-        map<Currency, vector<Cash> > cf;
-        map<Currency, vector<Cash> > iFlows;
-        map<Currency, vector<Cash> > pFlows;
-        map<Currency, vector<Real> > basketNotional;
-
-        //liability flows 
-        vector<Real> basketValue(samples_, 0.0);
-        vector<vector<Real> > trancheValue;
         vector<Tranche> tranches = arguments_.tranches;
-        for (Size i = 0 ; i < tranches.size() ; i ++){
-            vector<Real> tempTrancheValue(samples_, 0.0);
-            trancheValue.push_back(tempTrancheValue);
-        }
 
-        vector <map<Currency, vector<vector<Real> > > > trancheBalance; 
-        trancheBalance.resize(tranches.size());
-        for (Size i = 0 ; i < tranches.size() ; i ++){
-            trancheBalance[i][ccy].resize(
-                                dates.size(), vector<Real>(samples_, 0.0));
+        /**************************************************************
+         * Sample independent inputs of the waterfall: the tranche interest rates and the fee year fractions by date
+         */
+        vector<vector<Real> > trancheInterestRates(dates.size(), vector<Real>(tranches.size(), 0.0));
+        vector<Real> feeYearFractions(dates.size(), 0.0);
+        for (Size j = 1; j < dates.size(); j++) {
+            for (Size k = 0; k < tranches.size(); k++)
+                trancheInterestRates[j][k] = tranches[k].leg[j - 1]->amount() / tranches[k].faceAmount;
+            feeYearFractions[j] = feeDayCount.yearFraction(dates[j - 1], dates[j]);
         }
 
-        vector<Real> feeValue(samples_, 0.0);
-        vector<Real> subfeeValue(samples_, 0.0);
+        /**************************************************************
+         * Basket default simulation: sequential, since the random default model and the basket keep the scenario
+         * state. The flows of all samples are stored in the CBO currency for the waterfalls below.
+         */
+        BasketScenarios b;
+        b.dates = dates.size();
+        for (auto* v : {&b.flow, &b.discountedFlow, &b.interestFlow, &b.discountedInterestFlow, &b.principalFlow,
+                        &b.discountedPrincipalFlow, &b.notional})
+            v->resize(samples_ * dates.size(), 0.0);
 
-        /*
-        //prepare for convergence analysis
-        bool convergenceFlag = false;
-        std::vector<double> runningMean(tranches.size(),0.0);
-        std::vector<double> runningStdev(tranches.size(),0.0);
-        if(ore::data::Log::instance().filter(ORE_DATA)){
-            TLOG("convergence analysis - check first two moments");
-            std::ostringstream labels;
-            labels << "sample";
-            for(Size k = 0 ; k < tranches.size(); k++)
-                labels << "," << tranches[k].name << "-mean,"<< tranches[k].name << "-stdev";
-            TLOG(labels.str());
-            convergenceFlag = true;
-        }
-        */
+        set<Currency> basketCurrency = arguments_.basket->unique_currencies();
 
         for (Size i = 0; i < samples_; i++) { 
             rdm_->nextSequence(tmax);
 
-            for( Size k = 0 ; k < tranches.size() ; k++){
-                trancheBalance[k][ccy][0][i] = arguments_.tranches[k].faceAmount;
-            }
-
-            vector< map<Currency, Real> >trancheInterest;
-            trancheInterest.resize(tranches.size());
-            for( Size k = 0 ; k < tranches.size() ; k++){
-                trancheInterest[k][ccy] = 0.0;
-            }
-
             //Get Collection from bondbasket and exchange into base currency...
-            cf.clear();
-            iFlows.clear();
-            pFlows.clear();
-            basketNotional.clear();
-
             map<Currency, vector<Cash> > cf_full = arguments_.basket->scenarioCashflow(dates);
             map<Currency, vector<Cash> > iFlows_full = arguments_.basket->scenarioInterestflow(dates);
             map<Currency, vector<Cash> > pFlows_full = arguments_.basket->scenarioPrincipalflow(dates);
             map<Currency, vector<Real> > basketNotional_full = arguments_.basket->scenarioRemainingNotional(dates);
 
-            set<Currency> basketCurrency = arguments_.basket->unique_currencies();
-
-            if(basketCurrency.size() > 1){
-
-                vector<Cash> cf_single;
-                vector<Cash> iFlows_single;
-                vector<Cash> pFlows_single;
-                vector<Real> basketNotional_single;
-
-                for(size_t d = 0; d < dates.size(); d++){
-
-                    double cf1 = 0.0;
-                    double cf2 = 0.0;
-                    double if1 = 0.0;
-                    double if2 = 0.0;
-                    double pf1 = 0.0;
-                    double pf2 = 0.0;
-                    //Cash pf(0.0, 0.0);
-                    double bn = 0.0;
-
-                    for(auto& basketCcy : basketCurrency){
-                        cf1 += arguments_.basket->convert(cf_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        cf2 += arguments_.basket->convert(cf_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        if1 += arguments_.basket->convert(iFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        if2 += arguments_.basket->convert(iFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        pf1 += arguments_.basket->convert(pFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        pf2 += arguments_.basket->convert(pFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        bn += arguments_.basket->convert(basketNotional_full[basketCcy][d], basketCcy, dates[d]);
+            if (basketCurrency.size() > 1) {
+                for (size_t d = 0; d < dates.size(); d++) {
+                    const Size idx = i * dates.size() + d;
+                    for (auto& basketCcy : basketCurrency) {
+                        b.flow[idx] += arguments_.basket->convert(cf_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                        b.discountedFlow[idx] +=
+                            arguments_.basket->convert(cf_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
+
+                        b.interestFlow[idx] +=
+                            arguments_.basket->convert(iFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                        b.discountedInterestFlow[idx] +=
+                            arguments_.basket->convert(iFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
+
+                        b.principalFlow[idx] +=
+                            arguments_.basket->convert(pFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                        b.discountedPrincipalFlow[idx] +=
+                            arguments_.basket->convert(pFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
+
+                        b.notional[idx] +=
+                            arguments_.basket->convert(basketNotional_full[basketCcy][d], basketCcy, dates[d]);
                     }
-                    cf_single.push_back(Cash(cf1, cf2));
-                    iFlows_single.push_back(Cash(if1,if2));
-                    pFlows_single.push_back(Cash(pf1,pf2));
-                    basketNotional_single.push_back(bn);
                 }
-                cf[ccy] = cf_single;
-                iFlows[ccy] = iFlows_single;
-                pFlows[ccy] = pFlows_single;
-                basketNotional[ccy] = basketNotional_single;
-
-            }
-            else{
-                cf = cf_full;
-                iFlows = iFlows_full;
-                pFlows = pFlows_full;
-                basketNotional = basketNotional_full;
-            }
-
-            for (Size j = 1; j < dates.size(); j++) {
-
-                //Back out discountfactors 
-
-                Real intCcyDis = (iFlows[ccy][j].flow_ > 0 ?
-                               iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_ :
-                               0.0);
-
-                /**************************************************************
-                 * check flows add up
-                 */
-                Real tiny = 1.0e-6;
-                Real flowsCheck = fabs(cf[ccy][j].flow_
-                                       -iFlows[ccy][j].flow_
-                                       -pFlows[ccy][j].flow_);
-                QL_REQUIRE( flowsCheck < tiny,
-                           "Interest and Principal Flows don't sum to Total: "
-                           << flowsCheck);
-
-                Real dfFlowsCheck = fabs(cf[ccy][j].discountedFlow_
-                                       -iFlows[ccy][j].discountedFlow_
-                                       -pFlows[ccy][j].discountedFlow_);
-
-                QL_REQUIRE( dfFlowsCheck < tiny,
-                           "discounted Interest and Principal Flows don't sum to Total: "
-                           << dfFlowsCheck);
-
-                /**************************************************************
-                 * tranche interest claim
-                 */
-                vector<map<Currency, Real> >trancheIntAcc;
-                trancheIntAcc.resize(tranches.size());
-                vector<Real> trancheInterestRates;
-                // ccy
-                for (Size k = 0 ; k< tranches.size(); k++){
-                    Real trancheInterestRate =
-                        tranches[k].leg[j-1]->amount()/
-                        tranches[k].faceAmount;
-                    trancheInterestRates.push_back(trancheInterestRate);
-                    //ccy
-                    trancheIntAcc[k][ccy] = trancheBalance[k][ccy][j-1][i]
-                        * (trancheInterestRate);
-                    trancheInterest[k][ccy] += trancheIntAcc[k][ccy];
-                    trancheBalance[k][ccy][j][i]
-                        = trancheBalance[k][ccy][j-1][i];
-                }
-                /**************************************************************
-                 * Collections
-                 */
-                Real ccyDFlow = cf[ccy][j].discountedFlow_;
-                Real basketInterest = iFlows[ccy][j].flow_; //for cure amount calc
-
-                /**************************************************************
-                 * Senior fees
-                 */
-                Real ccyFeeClaim = basketNotional[ccy][j] * arguments_.seniorFee
-                    * feeDayCount.yearFraction(dates[j-1], dates[j]);
-
-                Real ccyFeeFlow = std::min(ccyFeeClaim, iFlows[ccy][j].flow_);
-
-                iFlows[ccy][j].flow_ -= ccyFeeFlow;
-                iFlows[ccy][j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
-
-                cf[ccy][j].flow_ -= ccyFeeFlow;
-                cf[ccy][j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
-
-                feeValue[i] += ccyFeeFlow * intCcyDis;
-
-                QL_REQUIRE(cf[ccy][j].flow_ >= 0.0, "ccy flows < 0");
-
-
-                /**************************************************************
-                 * tranche waterfall
-                 */
-                vector<map<Currency, Real> > trancheAmortization;
-                vector<map<Currency, Cash> > tranche;
-                trancheAmortization.resize(tranches.size());
-                tranche.resize(tranches.size());
-
-                //Interest Waterfall incl. ICOC
-                for (Size k = 0 ; k < tranches.size() ; k++){
-
-                    tranche[k][ccy].flow_ = 0.;
-                    tranche[k][ccy].discountedFlow_ = 0.;
-
-                    Real icRatio = arguments_.tranches[k].icRatio;
-                    Real ocRatio = arguments_.tranches[k].ocRatio;
-
-                    //IC and OC Target Balances
-                    Real cureAmount = icocCureAmount(i,j,k,
-                                           basketNotional[ccy][j],
-                                           basketInterest,
-                                           trancheBalance,
-                                           trancheInterestRates,
-                                           icRatio,
-                                           ocRatio);
-
-                    interestWaterfall(i, j, dates, iFlows,
-                          tranche[k], trancheBalance[k], 
-                          trancheInterest[k],
-                          trancheIntAcc[k], cureAmount); 
-
-                    icocInterestWaterfall(i, j, k, dates, iFlows,
-                                      tranche, trancheBalance, 
-                                        cureAmount); 
-
-                }
-
-                //Principal Waterfall
-                for (Size k = 0 ; k < tranches.size() ; k++){
-
-                    principalWaterfall(i, j, dates, pFlows,
-                                       tranche[k], trancheBalance[k],
-                                       trancheInterest[k]);
-
-                    cf[ccy][j].flow_ -= tranche[k][ccy].flow_;
-                    cf[ccy][j].discountedFlow_ -= tranche[k][ccy].discountedFlow_;
-
-                }
-
-                /**************************************************************
-                 * Subordinated Fee
-                 */
-
-                Real ccysubFeeClaim = basketNotional[ccy][j] * arguments_.subordinatedFee
-                                    * feeDayCount.yearFraction(dates[j-1], dates[j]);
-
-                Real ccysubFeeFlow = std::min(ccysubFeeClaim, iFlows[ccy][j].flow_);
-
-                iFlows[ccy][j].flow_ -= ccysubFeeFlow;
-                iFlows[ccy][j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
-
-                cf[ccy][j].flow_ -= ccysubFeeFlow;
-                cf[ccy][j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
-
-                subfeeValue[i] += ccysubFeeFlow * intCcyDis;
-                QL_REQUIRE(cf[ccy][j].flow_ >= -1.0E-5, "ccy flows < 0");
-
-                /**************************************************************
-                 * Kicker:
-                 * Split excess flows between equity tranche (1-x) and senior fee (x)
-                 */
-                Real x = arguments_.equityKicker;
-
-                Cash residual(0.0, 0.0);
-                residual.discountedFlow_ = pFlows[ccy][j].discountedFlow_ + iFlows[ccy][j].discountedFlow_;
-                residual.flow_ = pFlows[ccy][j].flow_ + iFlows[ccy][j].flow_;
-
-                tranche.back()[ccy].flow_ += residual.flow_ * (1 - x);
-                tranche.back()[ccy].discountedFlow_ +=  residual.discountedFlow_ * (1 - x);
-
-                feeValue[i] += residual.discountedFlow_ * x;
-
-                cf[ccy][j].flow_ -= residual.flow_;
-                cf[ccy][j].discountedFlow_ -= residual.discountedFlow_;
-
-
-                /**************************************************************
-                 * Consistency checks
-                 */
-                QL_REQUIRE(cf[ccy][j].flow_ >= -1.e-5, "residual ccy flow < 0: "<<
-                           cf[ccy][j].flow_);
-
-                QL_REQUIRE(ccyFeeFlow  >= -1.e-5, "ccy fee flow < 0");
-
-                for(Size k = 0; k < tranches.size() ; k++){
-                    QL_REQUIRE(tranche[k][ccy].flow_ >= -1.e-5, "ccy "<<
-                           tranches[k].name <<" flow < 0: "
-                               <<tranche[k][ccy].flow_);
-                }
-
-
-                basketValue[i] += ccyDFlow;
-                for(Size k = 0 ; k < tranches.size() ; k ++){
-                    trancheValue[k][i] += tranche[k][ccy].discountedFlow_;
-                }
-                Real tranchenpvError(0.);
-                for(Size k = 0 ; k < tranches.size() ; k ++){
-                   tranchenpvError +=trancheValue[k][i];
-                }
-                Real  npvError(0.);
-                if(basketValue[i] > 0.){
-                   npvError = (feeValue[i] + subfeeValue[i] + tranchenpvError) / basketValue[i] - 1.0;
-                   if(fabs(npvError) > errorTolerance_)
-                        //ALOG("NPVs do not add up, rel. error " << npvError);
-                        QL_FAIL("NPVs do not add up, rel. error " << npvError);
+            } else {
+                QL_REQUIRE(cf_full[ccy].size() == dates.size() && iFlows_full[ccy].size() == dates.size() &&
+                               pFlows_full[ccy].size() == dates.size() &&
+                               basketNotional_full[ccy].size() == dates.size(),
+                           "MonteCarloCBOEngine: no basket flows in the CBO currency " << ccy);
+                for (size_t d = 0; d < dates.size(); d++) {
+                    const Size idx = i * dates.size() + d;
+                    b.flow[idx] = cf_full[ccy][d].flow_;
+                    b.discountedFlow[idx] = cf_full[ccy][d].discountedFlow_;
+                    b.interestFlow[idx] = iFlows_full[ccy][d].flow_;
+                    b.discountedInterestFlow[idx] = iFlows_full[ccy][d].discountedFlow_;
+                    b.principalFlow[idx] = pFlows_full[ccy][d].flow_;
+                    b.discountedPrincipalFlow[idx] = pFlows_full[ccy][d].discountedFlow_;
+                    b.notional[idx] = basketNotional_full[ccy][d];
                 }
-
-                QL_REQUIRE(basketValue[i] >= 0.0,
-                               "negative basket value " << basketValue[i]);
-
-            } // end dates
+            }
 
             /**************************************************************
              * Loss Distribution
@@ -604,25 +514,50 @@ namespace QuantExt {
                     bd->probabilities()[index] += 1.0 / samples_;
                 }
             }
+        } // end samples
 
-            /*
-            //convergence
-            if(convergenceFlag){
-                std::ostringstream meanStev;
-                meanStev << i << fixed << setprecision(2);
-                for(Size k = 0 ; k < tranches.size(); k++){
-                    runningMean[k] += trancheValue[k][i];
-                    double mean = runningMean[k] / (i + 1);
-                    meanStev << "," << mean;
-                    runningStdev[k] += trancheValue[k][i]*trancheValue[k][i];
-                    double stdev = sqrt(runningStdev[k] / (i + 1)  - mean * mean);
-                    meanStev << "," << stdev;
+        /**************************************************************
+         * Waterfalls: the samples are independent given the basket flows, they are run in blocks of samples on
+         * up to threads_ threads. Each sample writes its own results, so they do not depend on the number of threads.
+         * If waterfalls fail, the error of the first failing sample is rethrown.
+         */
+        SampleValues values;
+        values.basket.resize(samples_, 0.0);
+        values.fee.resize(samples_, 0.0);
+        values.subfee.resize(samples_, 0.0);
+        values.tranche.resize(tranches.size(), vector<Real>(samples_, 0.0));
+
+        const Size blockSize = 64;
+        const Size nBlocks = (samples_ + blockSize - 1) / blockSize;
+        vector<std::exception_ptr> exceptions(nBlocks);
+        std::atomic<Size> nextBlock(0);
+        auto worker = [&, this]() {
+            TrancheState state;
+            for (auto* v : {&state.balance, &state.interest, &state.interestAcc, &state.flow, &state.discountedFlow})
+                v->resize(tranches.size(), 0.0);
+            for (Size block = nextBlock++; block < nBlocks; block = nextBlock++) {
+                try {
+                    for (Size i = block * blockSize; i < std::min((block + 1) * blockSize, samples_); ++i)
+                        waterfall(i, b, trancheInterestRates, feeYearFractions, state, values);
+                } catch (...) {
+                    exceptions[block] = std::current_exception();
                 }
-                TLOG(meanStev.str());
             }
-            */
-        } // end samples
-
+        };
+        vector<std::thread> workers;
+        for (Size w = 1; w < std::min(threads_, nBlocks); ++w)
+            workers.emplace_back(worker);
+        worker();
+        for (auto& w : workers)
+            w.join();
+        for (auto const& e : exceptions)
+            if (e)
+                std::rethrow_exception(e);
+
+        const vector<Real>& basketValue = values.basket;
+        const vector<vector<Real> >& trancheValue = values.tranche;
+        const vector<Real>& feeValue = values.fee;
+        const vector<Real>& subfeeValue = values.subfee;
         //handle results...
         Stats basketStats(basketValue);
         vector<Stats> trancheStats;
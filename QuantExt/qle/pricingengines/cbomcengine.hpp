@@ -60,33 +60,44 @@ public:
         //! npvError tolerance
         double errorTolerance = 1.0e-6,
         //! Periods from valuation date for which to return loss distributions
-        std::vector<QuantLib::Period> lossDistributionPeriods = std::vector<QuantLib::Period>())
+        std::vector<QuantLib::Period> lossDistributionPeriods = std::vector<QuantLib::Period>(),
+        /*! Number of threads on which the waterfalls of the samples are run, the default simulation of the basket is
+            sequential, so that the results do not depend on the number of threads */
+        Size threads = 1)
         : rdm_(rdm), samples_(samples), bins_(bins), errorTolerance_(errorTolerance),
-        lossDistributionPeriods_(lossDistributionPeriods) {}
+        lossDistributionPeriods_(lossDistributionPeriods), threads_(std::max<Size>(threads, 1)) {}
     void calculate() const override;
 
 private:
-    //! interest waterfall
-    void interestWaterfall(Size sampleIndex, Size dateIndex, const vector<Date>& dates,
-                           map<Currency, vector<Cash>>& basketFlow, map<Currency, Cash>& trancheFlow,
-                           map<Currency, vector<vector<Real>>>& balance, map<Currency, Real>& interest,
-                           map<Currency, Real>& interestAcc, Real cureAmount) const;
-    //! icoc interest waterfall
-    void icocInterestWaterfall(Size i, // sample index
-                               Size j, // date index
-                               Size k, // tranche index
-                               const vector<Date>& dates, map<Currency, vector<Cash>>& iFlows,
-                               vector<map<Currency, Cash>>& tranches,
-                               vector<map<Currency, vector<vector<Real>>>>& balances, Real cureAmount) const;
-
-    //! pricipal waterfall
-    void principalWaterfall(Size sampleIndex, Size dateIndex, const vector<Date>& dates,
-                            map<Currency, vector<Cash>>& basketFlow, map<Currency, Cash>& trancheFlow,
-                            map<Currency, vector<vector<Real>>>& balance, map<Currency, Real>& interest) const;
+    //! simulated basket flows in the CBO currency, the index is sample * dates + date index
+    struct BasketScenarios {
+        Size dates;
+        vector<Real> flow, discountedFlow, interestFlow, discountedInterestFlow, principalFlow,
+            discountedPrincipalFlow, notional;
+    };
+    //! sample values of the basket and the liabilities, the tranche values are indexed by tranche and sample
+    struct SampleValues {
+        vector<Real> basket, fee, subfee;
+        vector<vector<Real>> tranche;
+    };
+    //! state of the tranches in one sample on the current date, one entry per tranche
+    struct TrancheState {
+        vector<Real> balance, interest, interestAcc, flow, discountedFlow;
+    };
+
+    //! waterfall of sample i over all dates of the basket scenarios
+    void waterfall(Size i, const BasketScenarios& basket, const vector<vector<Real>>& trancheInterestRates,
+                   const vector<Real>& feeYearFractions, TrancheState& state, SampleValues& values) const;
+    //! interest waterfall of tranche k
+    void interestWaterfall(Size k, Real& interestFlow, Real& discountedInterestFlow, TrancheState& state) const;
+    //! icoc interest waterfall for tranche k
+    void icocInterestWaterfall(Size k, Real& interestFlow, Real& discountedInterestFlow, TrancheState& state,
+                               Real cureAmount) const;
+    //! pricipal waterfall of tranche k
+    void principalWaterfall(Size k, Real& principalFlow, Real& discountedPrincipalFlow, TrancheState& state) const;
     //! icoc cure amount
-    Real icocCureAmount(Size sampleIndex, Size dateIndex, Size trancheNo, Real basketNotional, Real basketInterest,
-                        vector<map<Currency, vector<vector<Real>>>>& trancheBalances, vector<Real> trancheInterestRates,
-                        Real icRatios, Real ocRatios) const;
+    Real icocCureAmount(Size k, Real basketNotional, Real basketInterest, const TrancheState& state,
+                        const vector<Real>& trancheInterestRates, Real icRatio, Real ocRatio) const;
 
     //! Return dates on the CBO schedule that are closest to the requested \p lossDistributionPeriods
     std::map<QuantLib::Date, std::string> getLossDistributionDates(const QuantLib::Date& valuationDate) const;
@@ -98,6 +109,8 @@ private:
 
     //! Periods from valuation date for which to return loss distributions
     std::vector<QuantLib::Period> lossDistributionPeriods_;
+
+    Size threads_;
 };
 
 } // namespace QuantExt
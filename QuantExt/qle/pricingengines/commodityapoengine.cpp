@@ -23,6 +23,11 @@
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/pricingengines/commodityapoengine.hpp>
 
+#include <atomic>
+#include <exception>
+#include <numeric>
+#include <thread>
+
 using std::adjacent_difference;
 using std::exp;
 using std::make_pair;
@@ -450,78 +455,165 @@ void CommodityAveragePriceOptionMonteCarloEngine::calculateFuture() const {
     vector<Date> dates;
     vector<Real> dt = timegrid(dates);
 
-    // On each Monte Carlo sample, we must generate the paths for N (size of vols) future contracts where
-    // each path has n time steps. We will represent the paths with an N x n matrix. First step is to fill the
-    // matrix with N x n _independent_ standard normal variables. Then correlate the N variables in each column
-    // using the sqrtCorr matrix and then fill each entry F_{i, j} in the matrix with the value of the i-th
-    // future price process at timestep j. Note, we will possibly simulate contracts past their expiries but not
-    // use the price in the APO rate averaging.
-    LowDiscrepancy::rsg_type rsg = LowDiscrepancy::make_sequence_generator(vols.size() * dt.size(), seed_);
-
-    // Precalculate exp(-0.5 \sigma_i^2 \delta t_j) and std dev = sqrt(\delta t_j) \sigma_i
-    Matrix drifts(vols.size(), dt.size(), 0.0);
-    Matrix stdDev(vols.size(), dt.size(), 0.0);
-    Array logPrices(vols.size());
-    for (Size i = 0; i < drifts.rows(); i++) {
-        logPrices[i] = std::log(prices[i]);
-        for (Size j = 0; j < drifts.columns(); j++) {
-            drifts[i][j] = -vols[i] * vols[i] * dt[j] / 2.0;
-            stdDev[i][j] = vols[i] * sqrt(dt[j]);
-        }
+    // The log future price on pricing date j is log F_i(0) - 1/2 \sigma_i^2 t_j + \sigma_i W_i(t_j) where i is the
+    // future used on that date. The Brownian paths W_i(t_j) do not depend on the prices and volatilities, they are
+    // taken from the path cache and shared by all APOs with the same time grid, future correlations and future
+    // indices.
+    vector<Real> key = {static_cast<Real>(samples_), static_cast<Real>(seed_), static_cast<Real>(vols.size())};
+    key.insert(key.end(), dt.begin(), dt.end());
+    key.insert(key.end(), sqrtCorr.begin(), sqrtCorr.end());
+    for (auto i : futureIndex)
+        key.push_back(static_cast<Real>(i));
+    auto paths = pathCache_->paths(key, [this, &sqrtCorr, &dt, &futureIndex]() {
+        return brownianPaths(sqrtCorr, dt, futureIndex);
+    });
+
+    // Precalculate the log forward, the drift -1/2 \sigma_i^2 t_j and the volatility per pricing date
+    Size n = dt.size();
+    vector<Real> logForwards(n), drifts(n), sigmas(n);
+    Time t = 0.0;
+    for (Size j = 0; j < n; ++j) {
+        t += dt[j];
+        Size i = futureIndex[j];
+        logForwards[j] = std::log(prices[i]);
+        drifts[j] = -vols[i] * vols[i] * t / 2.0;
+        sigmas[j] = vols[i];
     }
 
-    // Loop over each sample
+    // The payoffs are evaluated in blocks of samples on up to threads_ threads, the block sums are added in a fixed
+    // order so that the result does not depend on the number of threads
     auto m = arguments_.flow->indices().size();
-    Matrix paths(vols.size(), dt.size());
-    for (Size k = 0; k < samples_; ++k) {
-
-        // Sequence is N x n independent standard normal random variables
-        const vector<Real>& sequence = rsg.nextSequence().value;
-
-        // paths initially holds independent standard normal random variables
-        std::copy(sequence.begin(), sequence.end(), paths.begin());
-
-        // Correlate the random variables in each column
-        paths = sqrtCorr * paths;
-
-        // Fill the paths
-        for (Size i = 0; i < paths.rows(); ++i) {
-            for (Size j = 0; j < paths.columns(); ++j) {
-                paths[i][j] = (j == 0 ? logPrices[i] : paths[i][j - 1]) + drifts[i][j] + stdDev[i][j] * paths[i][j];
+    const Size blockSize = 1024;
+    const Size nBlocks = (samples_ + blockSize - 1) / blockSize;
+    vector<Real> blockPayoffs(nBlocks, 0.0);
+    vector<std::exception_ptr> exceptions(nBlocks);
+    std::atomic<Size> nextBlock(0);
+    auto worker = [&, this]() {
+        vector<Real> logPrices(n);
+        for (Size block = nextBlock++; block < nBlocks; block = nextBlock++) {
+            try {
+                Real blockPayoff = 0.0;
+                for (Size k = block * blockSize; k < std::min((block + 1) * blockSize, samples_); ++k) {
+
+                    // The log prices on the pricing dates on this sample
+                    const Real* w = paths->row_begin(k);
+                    for (Size j = 0; j < n; ++j)
+                        logPrices[j] = logForwards[j] + drifts[j] + sigmas[j] * w[j];
+
+                    // Calculate the sum of the commodity future prices on the pricing dates after today
+                    Real samplePayoff = 0.0;
+                    bool barrierTriggered = false;
+                    for (Size j = 0; j < n; ++j) {
+                        if (arguments_.barrierStyle == Exercise::American)
+                            barrierTriggered = barrierTriggered || this->barrierTriggered(logPrices[j], true);
+                        samplePayoff += std::exp(logPrices[j]);
+                    }
+
+                    // Average price on this sample
+                    samplePayoff /= m;
+
+                    // Finally, the payoff on this sample
+                    samplePayoff = max(omega * (samplePayoff - effectiveStrike), 0.0);
+
+                    // account for barrier
+                    if (arguments_.barrierStyle == Exercise::European)
+                        barrierTriggered = this->barrierTriggered(n == 0 ? 0.0 : logPrices.back(), true);
+
+                    if (alive(barrierTriggered))
+                        blockPayoff += samplePayoff;
+                }
+                blockPayoffs[block] = blockPayoff;
+            } catch (...) {
+                exceptions[block] = std::current_exception();
             }
         }
+    };
+    vector<std::thread> workers;
+    for (Size w = 1; w < std::min(threads_, nBlocks); ++w)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+    for (auto const& e : exceptions)
+        if (e)
+            std::rethrow_exception(e);
+
+    payoff = std::accumulate(blockPayoffs.begin(), blockPayoffs.end(), 0.0) / samples_;
 
-        // Calculate the sum of the commodity future prices on the pricing dates after today
-        Real samplePayoff = 0.0;
-        bool barrierTriggered = false;
-        Real price = 0.0;
-        for (Size j = 0; j < dt.size(); ++j) {
-            price = paths[futureIndex[j]][j];
-            if (arguments_.barrierStyle == Exercise::American)
-                barrierTriggered = barrierTriggered || this->barrierTriggered(price, true);
-            samplePayoff += std::exp(price);
-        }
-
-        // Average price on this sample
-        samplePayoff /= m;
+    // Populate the result value
+    results_.value = arguments_.quantity * arguments_.flow->gearing() * payoff * discount;
+}
 
-        // Finally, the payoff on this sample
-        samplePayoff = max(omega * (samplePayoff - effectiveStrike), 0.0);
+ext::shared_ptr<const Matrix>
+CommodityAveragePriceOptionMonteCarloEngine::brownianPaths(const Matrix& sqrtCorr, const vector<Real>& dt,
+                                                           const vector<Size>& futureIndex) const {
 
-        // account for barrier
-        if (arguments_.barrierStyle == Exercise::European)
-            barrierTriggered = this->barrierTriggered(price, true);
+    // On each Monte Carlo sample, we must generate the paths for N (size of sqrtCorr) future contracts where
+    // each path has n time steps. We represent the increments with an N x n matrix. First step is to fill the
+    // matrix with N x n _independent_ standard normal variables. Then correlate the N variables in each column
+    // using the sqrtCorr matrix and then accumulate the scaled increments along each row. Note, we will possibly
+    // simulate contracts past their expiries but only keep the future used on each pricing date.
+    Size nFutures = sqrtCorr.rows(), n = dt.size();
+    auto result = ext::make_shared<Matrix>(samples_, n, 0.0);
+    if (n == 0)
+        return result;
+
+    // The sequences are drawn in order, the correlation and accumulation is done on up to threads_ threads
+    LowDiscrepancy::rsg_type rsg = LowDiscrepancy::make_sequence_generator(nFutures * n, seed_);
+    Matrix normals(samples_, nFutures * n);
+    for (Size k = 0; k < samples_; ++k) {
+        const vector<Real>& sequence = rsg.nextSequence().value;
+        std::copy(sequence.begin(), sequence.end(), normals.row_begin(k));
+    }
 
-        if (!alive(barrierTriggered))
-            samplePayoff = 0.0;
+    vector<Real> sqrtDt(n);
+    for (Size j = 0; j < n; ++j)
+        sqrtDt[j] = std::sqrt(dt[j]);
+
+    const Size blockSize = 1024;
+    const Size nBlocks = (samples_ + blockSize - 1) / blockSize;
+    std::atomic<Size> nextBlock(0);
+    auto worker = [&]() {
+        Matrix increments(nFutures, n);
+        vector<Real> w(nFutures);
+        for (Size block = nextBlock++; block < nBlocks; block = nextBlock++) {
+            for (Size k = block * blockSize; k < std::min((block + 1) * blockSize, samples_); ++k) {
+                std::copy(normals.row_begin(k), normals.row_end(k), increments.begin());
+                increments = sqrtCorr * increments;
+                std::fill(w.begin(), w.end(), 0.0);
+                for (Size j = 0; j < n; ++j) {
+                    for (Size i = 0; i < nFutures; ++i)
+                        w[i] += sqrtDt[j] * increments[i][j];
+                    (*result)[k][j] = w[futureIndex[j]];
+                }
+            }
+        }
+    };
+    vector<std::thread> workers;
+    for (Size w = 1; w < std::min(threads_, nBlocks); ++w)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+
+    return result;
+}
 
-        // Update the final average
-        // Note: payoff * k / (k + 1) - left to right precedence => double division.
-        payoff = k == 0 ? samplePayoff : payoff * k / (k + 1) + samplePayoff / (k + 1);
-    }
+ext::shared_ptr<const Matrix>
+CommodityApoMcPathCache::paths(const vector<Real>& key,
+                               const std::function<ext::shared_ptr<const Matrix>()>& generate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto p = paths_.find(key);
+    if (p != paths_.end())
+        return p->second;
+    if (paths_.size() >= maxSize_)
+        paths_.clear();
+    return paths_[key] = generate();
+}
 
-    // Populate the result value
-    results_.value = arguments_.quantity * arguments_.flow->gearing() * payoff * discount;
+Size CommodityApoMcPathCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paths_.size();
 }
 
 void CommodityAveragePriceOptionMonteCarloEngine::setupFuture(vector<Real>& outVolatilities, Matrix& outSqrtCorr,
@@ -28,9 +28,14 @@
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/models/blackscholesmodelwrapper.hpp>
 
+#include <ql/math/matrix.hpp>
 #include <ql/termstructures/volatility/equityfx/blackvoltermstructure.hpp>
 #include <ql/termstructures/yieldtermstructure.hpp>
 
+#include <functional>
+#include <map>
+#include <mutex>
+
 namespace QuantExt {
 
 namespace CommodityAveragePriceOptionMomementMatching {
@@ -117,24 +122,60 @@ public:
     void calculate() const override;
 };
 
+/*! Cache of the correlated Brownian paths used by the CommodityAveragePriceOptionMonteCarloEngine for APOs
+    referencing future prices. The paths only depend on the time grid, the correlation between the future contracts,
+    the future used on each pricing date and the random number generator settings, not on the prices or the
+    volatilities. Engines pricing APOs on the same futures and averaging period can therefore share a cache and
+    reuse a single path set. If the cache holds \p maxSize path sets, it is cleared before a new one is added.
+*/
+class CommodityApoMcPathCache {
+public:
+    explicit CommodityApoMcPathCache(QuantLib::Size maxSize = 32) : maxSize_(maxSize) {}
+
+    //! Return the path set for the given \p key, calling \p generate if it is not cached yet
+    QuantLib::ext::shared_ptr<const QuantLib::Matrix>
+    paths(const std::vector<QuantLib::Real>& key,
+          const std::function<QuantLib::ext::shared_ptr<const QuantLib::Matrix>()>& generate);
+
+    //! Number of cached path sets
+    QuantLib::Size size() const;
+
+private:
+    QuantLib::Size maxSize_;
+    std::map<std::vector<QuantLib::Real>, QuantLib::ext::shared_ptr<const QuantLib::Matrix>> paths_;
+    mutable std::mutex mutex_;
+};
+
 /*! Commodity APO Monte Carlo Engine
     Monte Carlo implementation of the APO payoff
     Reference: Iain Clark, Commodity Option Pricing, Wiley, section 2.7.4, equations (2.118) and (2.126)
+
+    For APOs referencing future prices, the paths of the Brownian motions driving the futures are taken from a
+    CommodityApoMcPathCache, which can be shared between engines, and the payoffs are evaluated on up to
+    \p threads threads. The result does not depend on the number of threads.
 */
 class CommodityAveragePriceOptionMonteCarloEngine : public CommodityAveragePriceOptionBaseEngine {
 public:
     CommodityAveragePriceOptionMonteCarloEngine(const QuantLib::Handle<QuantLib::YieldTermStructure>& discountCurve,
                                                 const QuantLib::Handle<QuantExt::BlackScholesModelWrapper>& model,
                                                 QuantLib::Size samples, QuantLib::Real beta = 0.0,
-                                                const QuantLib::Size seed = 42)
-        : CommodityAveragePriceOptionBaseEngine(discountCurve, model, beta), samples_(samples), seed_(seed) {}
+                                                const QuantLib::Size seed = 42, const QuantLib::Size threads = 1,
+                                                const QuantLib::ext::shared_ptr<CommodityApoMcPathCache>& pathCache =
+                                                    nullptr)
+        : CommodityAveragePriceOptionBaseEngine(discountCurve, model, beta), samples_(samples), seed_(seed),
+          threads_(std::max<QuantLib::Size>(threads, 1)),
+          pathCache_(pathCache ? pathCache : QuantLib::ext::make_shared<CommodityApoMcPathCache>()) {}
 
     // if you want speed-optimized observability, use the other constructor
     CommodityAveragePriceOptionMonteCarloEngine(const QuantLib::Handle<QuantLib::YieldTermStructure>& discountCurve,
                                                 const QuantLib::Handle<QuantLib::BlackVolTermStructure>& vol,
                                                 QuantLib::Size samples, QuantLib::Real beta = 0.0,
-                                                const QuantLib::Size seed = 42)
-        : CommodityAveragePriceOptionBaseEngine(discountCurve, vol, beta), samples_(samples), seed_(seed) {}
+                                                const QuantLib::Size seed = 42, const QuantLib::Size threads = 1,
+                                                const QuantLib::ext::shared_ptr<CommodityApoMcPathCache>& pathCache =
+                                                    nullptr)
+        : CommodityAveragePriceOptionBaseEngine(discountCurve, vol, beta), samples_(samples), seed_(seed),
+          threads_(std::max<QuantLib::Size>(threads, 1)),
+          pathCache_(pathCache ? pathCache : QuantLib::ext::make_shared<CommodityApoMcPathCache>()) {}
 
     void calculate() const override;
 
@@ -163,8 +204,18 @@ private:
     */
     std::vector<QuantLib::Real> timegrid(std::vector<QuantLib::Date>& outDates) const;
 
+    /*! Simulate the paths of the correlated Brownian motions driving the futures. Row \f$k\f$ of the result holds
+        \f$W_{i_j}(t_j)\f$ on sample \f$k\f$ for the pricing dates \f$j=1,\ldots,n\f$, where \f$i_j\f$ is given by
+        \p futureIndex.
+    */
+    QuantLib::ext::shared_ptr<const QuantLib::Matrix>
+    brownianPaths(const QuantLib::Matrix& sqrtCorr, const std::vector<QuantLib::Real>& dt,
+                  const std::vector<QuantLib::Size>& futureIndex) const;
+
     QuantLib::Size samples_;
     QuantLib::Size seed_;
+    QuantLib::Size threads_;
+    QuantLib::ext::shared_ptr<CommodityApoMcPathCache> pathCache_;
 };
 
 } // namespace QuantExt
@@ -20,16 +20,19 @@
 
 #include <qle/pricingengines/discountingfxforwardengine.hpp>
 #include <qle/instruments/cashflowresults.hpp>
+#include <qle/instruments/zeroratedependencies.hpp>
 
 namespace QuantExt {
 
 DiscountingFxForwardEngine::DiscountingFxForwardEngine(
     const Currency& ccy1, const Handle<YieldTermStructure>& currency1Discountcurve, const Currency& ccy2,
     const Handle<YieldTermStructure>& currency2Discountcurve, const Handle<Quote>& spotFX,
-    boost::optional<bool> includeSettlementDateFlows, const Date& settlementDate, const Date& npvDate)
+    boost::optional<bool> includeSettlementDateFlows, const Date& settlementDate, const Date& npvDate,
+    bool zeroRateDependencies)
     : ccy1_(ccy1), currency1Discountcurve_(currency1Discountcurve), ccy2_(ccy2),
       currency2Discountcurve_(currency2Discountcurve), spotFX_(spotFX),
-      includeSettlementDateFlows_(includeSettlementDateFlows), settlementDate_(settlementDate), npvDate_(npvDate) {
+      includeSettlementDateFlows_(includeSettlementDateFlows), settlementDate_(settlementDate), npvDate_(npvDate),
+      zeroRateDependencies_(zeroRateDependencies) {
     registerWith(currency1Discountcurve_);
     registerWith(currency2Discountcurve_);
     registerWith(spotFX_);
@@ -149,6 +152,30 @@ void DiscountingFxForwardEngine::calculate() const {
 
         results_.npv = Money(settleCcy, results_.value);
 
+        if (zeroRateDependencies_) {
+            std::vector<ZeroRateDependency> dependencies;
+            bool fixedFx = !arguments_.isPhysicallySettled && arguments_.payDate >= arguments_.fixingDate &&
+                           arguments_.fxIndex != nullptr;
+            if (!fixedFx) {
+                // value = v1 + v2 with v_i = +- N_i P_i(pay) / P_i(npv) converted to the settlement ccy at fx spot
+                Real sign = tmpPayCurrency1 ? -1.0 : 1.0;
+                Real v1 = sign * tmpNominal1 * disc1far / disc1near / (settleCcy1 ? 1.0 : spotFX_->value());
+                Real v2 = -sign * tmpNominal2 * disc2far / disc2near * (settleCcy1 ? spotFX_->value() : 1.0);
+                addDiscountDependency(dependencies, currency1Discountcurve_, arguments_.payDate, v1);
+                addDiscountDependency(dependencies, currency1Discountcurve_, npvDate, -v1);
+                addDiscountDependency(dependencies, currency2Discountcurve_, arguments_.payDate, v2);
+                addDiscountDependency(dependencies, currency2Discountcurve_, npvDate, -v2);
+            } else if (arguments_.fixingDate < currency1Discountcurve_->referenceDate()) {
+                // the fx fixing is known, the value depends on the settlement ccy curve only
+                const Handle<YieldTermStructure>& settleCurve =
+                    settleCcy1 ? currency1Discountcurve_ : currency2Discountcurve_;
+                addDiscountDependency(dependencies, settleCurve, arguments_.payDate, results_.value);
+                addDiscountDependency(dependencies, settleCurve, npvDate, -results_.value);
+            }
+            if (!fixedFx || arguments_.fixingDate < currency1Discountcurve_->referenceDate())
+                results_.additionalResults["zeroRateDependencies"] = dependencies;
+        }
+
         results_.fairForwardRate = ExchangeRate(ccy2_, ccy1_, fxfwd);
         results_.additionalResults["fairForwardRate"] = fxfwd;
         results_.additionalResults["fxSpot"] = spotFX_->value();
@@ -59,12 +59,18 @@ public:
         \param npvDate
                Discount to this date. If not given the npv date
                is set to the evaluation date
+        \param zeroRateDependencies
+               If true, the sensitivities of the npv to the zero rates of
+               the discount curves are published as additional result
+               "zeroRateDependencies", see ZeroRateDependency. For cash-settled
+               forwards with an fx index this requires the fixing to be known.
     */
     DiscountingFxForwardEngine(const Currency& ccy1, const Handle<YieldTermStructure>& currency1Discountcurve,
                                const Currency& ccy2, const Handle<YieldTermStructure>& currency2Discountcurve,
                                const Handle<Quote>& spotFX,
                                boost::optional<bool> includeSettlementDateFlows = boost::none,
-                               const Date& settlementDate = Date(), const Date& npvDate = Date());
+                               const Date& settlementDate = Date(), const Date& npvDate = Date(),
+                               bool zeroRateDependencies = false);
 
     void calculate() const override;
 
@@ -86,6 +92,7 @@ private:
     boost::optional<bool> includeSettlementDateFlows_;
     Date settlementDate_;
     Date npvDate_;
+    bool zeroRateDependencies_;
 };
 } // namespace QuantExt
 
@@ -24,6 +24,12 @@
 #include <ql/cashflows/simplecashflow.hpp>
 #include <ql/utilities/dataformatters.hpp>
 
+#include <boost/make_shared.hpp>
+
+#include <map>
+
+#include <qle/cashflows/compiledleg.hpp>
+#include <qle/instruments/zeroratedependencies.hpp>
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
 
 namespace QuantExt {
@@ -113,18 +119,115 @@ void AdditionalAmountGetter::visit(IborCoupon& c) {
 class DiscountingSwapEngineMultiCurve::AmountImpl {
 public:
     boost::shared_ptr<AmountGetter> amountGetter_;
+    // the compiled legs by their first cashflow, a null compiled leg marks a leg that can not be compiled
+    std::map<const CashFlow*, std::vector<std::pair<Leg, boost::shared_ptr<CompiledLeg>>>> compiledLegs_;
+
+    boost::shared_ptr<CompiledLeg> compiledLeg(const Leg& leg) {
+        if (leg.empty())
+            return nullptr;
+        auto& candidates = compiledLegs_[leg.front().get()];
+        for (auto const& c : candidates) {
+            if (c.first == leg)
+                return c.second;
+        }
+        candidates.push_back(std::make_pair(leg, CompiledLeg::compile(leg)));
+        return candidates.back().second;
+    }
+
+    // observer that marks an update of the observables it is registered with
+    class UpdateFlag : public Observer {
+    public:
+        UpdateFlag() : updated(true) {}
+        void update() override { updated = true; }
+        bool updated;
+    };
+
+    // the cached amounts, bps factors and discount factors of a leg, the amounts are refreshed when the cashflows
+    // notify a change, e.g. of the forwarding curves, the discount factors when the version of the discount curve
+    // changed, both when the settlement date or the settlement date flows flag changed
+    struct LegValues {
+        Leg leg;
+        boost::shared_ptr<UpdateFlag> amountsUpdated;
+        std::vector<bool> occurred;
+        std::vector<Real> amounts, bpsFactors, discounts;
+        Date settlementDate;
+        bool includeRefDateFlows = false;
+        Size discountVersion = 0;
+    };
+    std::map<const CashFlow*, std::vector<LegValues>> legValues_;
+    boost::shared_ptr<UpdateFlag> discountUpdated_;
+    Size discountVersion_ = 0;
+
+    LegValues& legValues(const Leg& leg) {
+        auto& candidates = legValues_[leg.empty() ? nullptr : leg.front().get()];
+        for (auto& c : candidates) {
+            if (c.leg == leg)
+                return c;
+        }
+        candidates.push_back(LegValues());
+        LegValues& v = candidates.back();
+        v.leg = leg;
+        v.amountsUpdated = boost::make_shared<UpdateFlag>();
+        for (auto const& c : leg)
+            v.amountsUpdated->registerWith(c);
+        return v;
+    }
+
+    void refresh(LegValues& v, const YieldTermStructure& discountCurve, const Date& settlementDate,
+                 bool includeRefDateFlows) {
+        const Leg& leg = v.leg;
+        bool newDates = v.occurred.size() != leg.size() || v.settlementDate != settlementDate ||
+                        v.includeRefDateFlows != includeRefDateFlows;
+        if (newDates) {
+            v.occurred.resize(leg.size());
+            for (Size j = 0; j < leg.size(); ++j)
+                v.occurred[j] = leg[j]->hasOccurred(settlementDate, includeRefDateFlows);
+            v.settlementDate = settlementDate;
+            v.includeRefDateFlows = includeRefDateFlows;
+        }
+        if (newDates || v.amountsUpdated->updated) {
+            v.amounts.assign(leg.size(), 0.0);
+            v.bpsFactors.assign(leg.size(), 0.0);
+            // as in the standard valuation, only the first two coupons call amount()
+            amountGetter_->setCallAmount(true);
+            for (Size j = 0; j < leg.size(); ++j) {
+                if (!v.occurred[j]) {
+                    leg[j]->accept(*amountGetter_);
+                    v.amounts[j] = amountGetter_->amount();
+                    v.bpsFactors[j] = amountGetter_->bpsFactor();
+                }
+                if (j == 1)
+                    amountGetter_->setCallAmount(false);
+            }
+            v.amountsUpdated->updated = false;
+        }
+        if (newDates || v.discountVersion != discountVersion_) {
+            v.discounts.assign(leg.size(), 0.0);
+            for (Size j = 0; j < leg.size(); ++j) {
+                if (!v.occurred[j])
+                    v.discounts[j] = discountCurve.discount(leg[j]->date());
+            }
+            v.discountVersion = discountVersion_;
+        }
+    }
 };
 
 DiscountingSwapEngineMultiCurve::DiscountingSwapEngineMultiCurve(const Handle<YieldTermStructure>& discountCurve,
                                                                  bool minimalResults,
                                                                  boost::optional<bool> includeSettlementDateFlows,
-                                                                 Date settlementDate, Date npvDate)
+                                                                 Date settlementDate, Date npvDate,
+                                                                 bool zeroRateDependencies, bool compiledLegs,
+                                                                 bool cachedLegValues)
     : discountCurve_(discountCurve), minimalResults_(minimalResults),
       includeSettlementDateFlows_(includeSettlementDateFlows), settlementDate_(settlementDate), npvDate_(npvDate),
+      zeroRateDependencies_(zeroRateDependencies), compiledLegs_(compiledLegs), cachedLegValues_(cachedLegValues),
       impl_(new AmountImpl) {
 
     registerWith(discountCurve_);
 
+    impl_->discountUpdated_ = boost::make_shared<AmountImpl::UpdateFlag>();
+    impl_->discountUpdated_->registerWith(discountCurve_);
+
     if (minimalResults_) {
         impl_->amountGetter_.reset(new AmountGetter);
     } else {
@@ -174,12 +277,50 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
 
     const Spread bp = 1.0e-4;
 
+    std::vector<ZeroRateDependency> dependencies;
+    bool dependenciesSupported = zeroRateDependencies_;
+
+    bool cachedLegValues = cachedLegValues_ && !zeroRateDependencies_;
+    if (cachedLegValues && impl_->discountUpdated_->updated) {
+        ++impl_->discountVersion_;
+        impl_->discountUpdated_->updated = false;
+    }
+
     for (Size i = 0; i < numLegs; i++) {
 
-        Leg leg = arguments_.legs[i];
+        const Leg& leg = arguments_.legs[i];
         results_.legNPV[i] = 0.0;
         results_.legBPS[i] = 0.0;
 
+        boost::shared_ptr<CompiledLeg> compiledLeg;
+        if (compiledLegs_ && !zeroRateDependencies_ && (compiledLeg = impl_->compiledLeg(leg))) {
+            compiledLeg->npv(**discountCurve_, settlementDate, includeRefDateFlows, results_.legNPV[i],
+                             results_.legBPS[i]);
+            results_.legNPV[i] *= arguments_.payer[i];
+            results_.legNPV[i] /= results_.npvDateDiscount;
+            results_.legBPS[i] *= arguments_.payer[i] * bp;
+            results_.legBPS[i] /= results_.npvDateDiscount;
+            results_.value += results_.legNPV[i];
+            continue;
+        }
+
+        if (cachedLegValues) {
+            AmountImpl::LegValues& v = impl_->legValues(leg);
+            impl_->refresh(v, **discountCurve_, settlementDate, includeRefDateFlows);
+            for (Size j = 0; j < leg.size(); ++j) {
+                if (!v.occurred[j]) {
+                    results_.legNPV[i] += v.amounts[j] * v.discounts[j];
+                    results_.legBPS[i] += v.bpsFactors[j] * v.discounts[j];
+                }
+            }
+            results_.legNPV[i] *= arguments_.payer[i];
+            results_.legNPV[i] /= results_.npvDateDiscount;
+            results_.legBPS[i] *= arguments_.payer[i] * bp;
+            results_.legBPS[i] /= results_.npvDateDiscount;
+            results_.value += results_.legNPV[i];
+            continue;
+        }
+
         // Call amount() method of underlying coupon for first coupon.
         impl_->amountGetter_->setCallAmount(true);
 
@@ -196,6 +337,35 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
             results_.legNPV[i] += impl_->amountGetter_->amount() * discount;
             results_.legBPS[i] += impl_->amountGetter_->bpsFactor() * discount;
 
+            if (dependenciesSupported) {
+                Real w = arguments_.payer[i] / results_.npvDateDiscount;
+                addDiscountDependency(dependencies, discountCurve_, leg[j]->date(),
+                                      w * impl_->amountGetter_->amount() * discount);
+                if (auto ibor = boost::dynamic_pointer_cast<IborCoupon>(leg[j])) {
+                    Date fixingDate = ibor->fixingDate();
+                    if (fixingDate > referenceDate ||
+                        (fixingDate == referenceDate && ibor->iborIndex()->pastFixing(fixingDate) == Null<Real>())) {
+                        // same assumptions on the index as in AmountGetter
+                        Handle<YieldTermStructure> forwardingCurve = ibor->iborIndex()->forwardingTermStructure();
+                        QL_REQUIRE(!forwardingCurve.empty(), "Forwarding curve is empty.");
+                        Real dcfRatio = 1.0;
+                        if (ibor->iborIndex()->dayCounter() != ibor->dayCounter())
+                            dcfRatio = ibor->accrualPeriod() / ibor->iborIndex()->dayCounter().yearFraction(
+                                                                   ibor->accrualStartDate(), ibor->accrualEndDate());
+                        Real forwardPv = w * discount * ibor->gearing() * ibor->nominal() * dcfRatio *
+                                         forwardingCurve->discount(ibor->accrualStartDate()) /
+                                         forwardingCurve->discount(ibor->accrualEndDate());
+                        addForwardDependency(dependencies, forwardingCurve, ibor->accrualStartDate(),
+                                             ibor->accrualEndDate(), forwardPv);
+                    }
+                } else if (auto frc = boost::dynamic_pointer_cast<FloatingRateCoupon>(leg[j])) {
+                    dependenciesSupported = frc->accrualEndDate() < referenceDate;
+                } else {
+                    dependenciesSupported = boost::dynamic_pointer_cast<FixedRateCoupon>(leg[j]) != nullptr ||
+                                            boost::dynamic_pointer_cast<SimpleCashFlow>(leg[j]) != nullptr;
+                }
+            }
+
             // For all coupons after second do not call amount(), since for those
             // we can be sure that they are not fixed yet
             if (j == 1)
@@ -208,5 +378,11 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
         results_.legBPS[i] /= results_.npvDateDiscount;
         results_.value += results_.legNPV[i];
     }
+
+    if (dependenciesSupported) {
+        // the npv is discounted to the npv date
+        addDiscountDependency(dependencies, discountCurve_, results_.valuationDate, -results_.value);
+        results_.additionalResults["zeroRateDependencies"] = dependencies;
+    }
 }
 } // namespace QuantExt
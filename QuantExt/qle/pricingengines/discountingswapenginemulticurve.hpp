@@ -42,6 +42,31 @@ using namespace QuantLib;
     \warning if an IborCoupon with non-natural fixing and/or accrual
              period is present, the NPV will be false
 
+    If zeroRateDependencies is true, the engine publishes the sensitivities
+    of the NPV to the zero rates of the discount and forwarding curves as
+    additional result "zeroRateDependencies", see ZeroRateDependency. The
+    result is only available if all coupons are fixed rate or ibor coupons
+    or simple cashflows, floating coupons other than ibor coupons are
+    supported only if they are fixed already.
+
+    If compiledLegs is true, the legs are compiled to a CompiledLeg on the
+    first calculation and then valued from the compiled representation,
+    which avoids the calls to the coupon pricers in repeated valuations,
+    e.g. in an exposure simulation. Legs with cashflows that can not be
+    compiled and calculations with zero rate dependencies use the standard
+    valuation. The compiled legs are cached in the engine, so that several
+    swaps can share one engine.
+
+    If cachedLegValues is true, the engine caches the cashflow amounts and
+    the discount factors of each leg separately. The amounts are refreshed
+    when the cashflows of the leg notify a change, e.g. of a forwarding
+    curve or a fixing, the discount factors when the discount curve notifies
+    a change. In a sensitivity run bumping either the discount or the
+    forwarding curves only one of them is recomputed. The cache relies on
+    the notifications of the observables, so it must not be used if these
+    are disabled, e.g. with ObservationMode::Mode::Disable. Compiled legs
+    and zero rate dependencies take precedence over the cached values.
+
     \ingroup engines
 */
 class DiscountingSwapEngineMultiCurve : public QuantLib::Swap::engine {
@@ -49,7 +74,9 @@ public:
     DiscountingSwapEngineMultiCurve(const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
                                     bool minimalResults = true,
                                     boost::optional<bool> includeSettlementDateFlows = boost::none,
-                                    Date settlementDate = Date(), Date npvDate = Date());
+                                    Date settlementDate = Date(), Date npvDate = Date(),
+                                    bool zeroRateDependencies = false, bool compiledLegs = false,
+                                    bool cachedLegValues = false);
     void calculate() const override;
     Handle<YieldTermStructure> discountCurve() const { return discountCurve_; }
 
@@ -59,6 +86,9 @@ private:
     boost::optional<bool> includeSettlementDateFlows_;
     Date settlementDate_;
     Date npvDate_;
+    bool zeroRateDependencies_;
+    bool compiledLegs_;
+    bool cachedLegValues_;
 
     class AmountImpl;
     boost::shared_ptr<AmountImpl> impl_;
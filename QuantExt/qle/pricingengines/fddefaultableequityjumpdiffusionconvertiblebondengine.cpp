@@ -71,12 +71,13 @@ FdDefaultableEquityJumpDiffusionConvertibleBondEngine::FdDefaultableEquityJumpDi
     const Handle<QuantLib::DefaultProbabilityTermStructure>& creditCurve, const Handle<QuantLib::Quote>& recoveryRate,
     const Handle<FxIndex>& fxConversion, const bool staticMesher, const Size timeStepsPerYear,
     const Size stateGridPoints, const Real mesherEpsilon, const Real mesherScaling,
-    const std::vector<Real> conversionRatioDiscretisationGrid, const bool generateAdditionalResults)
+    const std::vector<Real> conversionRatioDiscretisationGrid, const bool generateAdditionalResults,
+    const bool richardsonExtrapolation)
     : model_(model), discountingCurve_(discountingCurve), discountingSpread_(discountingSpread),
       creditCurve_(creditCurve), recoveryRate_(recoveryRate), fxConversion_(fxConversion), staticMesher_(staticMesher),
       timeStepsPerYear_(timeStepsPerYear), stateGridPoints_(stateGridPoints), mesherEpsilon_(mesherEpsilon),
       mesherScaling_(mesherScaling), conversionRatioDiscretisationGrid_(conversionRatioDiscretisationGrid),
-      generateAdditionalResults_(generateAdditionalResults) {
+      generateAdditionalResults_(generateAdditionalResults), richardsonExtrapolation_(richardsonExtrapolation) {
     registerWith(model_);
     registerWith(discountingCurve_);
     registerWith(discountingSpread_);
@@ -148,19 +149,57 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
 
     events.registerMakeWhole(arguments_.makeWholeData);
 
-    // 2 set up PDE time grid
+    // 2 - 14 roll back on the engine grid and, if Richardson extrapolation is enabled, on a grid with half the
+    //        density, the Douglas scheme with theta = 0.5 is of second order in the time step and the grid spacing
+
+    auto [npv, npvBondFloor] =
+        rollback(events, timeStepsPerYear_, stateGridPoints_, cache_, generateAdditionalResults_);
+
+    if (richardsonExtrapolation_) {
+        auto [npvCoarse, npvBondFloorCoarse] = rollback(events, std::max<Size>(timeStepsPerYear_ / 2, 1),
+                                                        std::max<Size>(stateGridPoints_ / 2, 3), coarseCache_, false);
+        if (generateAdditionalResults_) {
+            results_.additionalResults["model.npvFineGrid"] = npv;
+            results_.additionalResults["model.npvCoarseGrid"] = npvCoarse;
+        }
+        npv = (4.0 * npv - npvCoarse) / 3.0;
+        npvBondFloor = (4.0 * npvBondFloor - npvBondFloorCoarse) / 3.0;
+    }
+
+    // 15 set result
+
+    results_.additionalResults["BondFloor"] = npvBondFloor;
+
+    results_.value = arguments_.detachable ? npv - npvBondFloor : npv;
+
+    results_.settlementValue = results_.value; // FIXME this is not entirely correct of course
+}
+
+std::pair<Real, Real> FdDefaultableEquityJumpDiffusionConvertibleBondEngine::rollback(
+    FdConvertibleBondEvents events, const Size timeStepsPerYear, const Size stateGridPoints, GridCache& cache,
+    const bool additionalResults) const {
+
+    Date today = Settings::instance().evaluationDate();
+
+    // 2 set up PDE time grid, reuse the grid if the event times did not change
 
     QL_REQUIRE(!events.times().empty(),
                "FdDefaultableEquityJumpDiffusionConvertibleEngine: internal error, times are empty");
-    Size steps = std::max<Size>(std::lround(timeStepsPerYear_ * (*events.times().rbegin()) + 0.5), 1);
-    TimeGrid grid(events.times().begin(), events.times().end(), steps);
+    if (cache.grid == nullptr || cache.timeStepsPerYear != timeStepsPerYear || cache.eventTimes != events.times()) {
+        Size steps = std::max<Size>(std::lround(timeStepsPerYear * (*events.times().rbegin()) + 0.5), 1);
+        cache.grid = boost::make_shared<TimeGrid>(events.times().begin(), events.times().end(), steps);
+        cache.eventTimes = events.times();
+        cache.timeStepsPerYear = timeStepsPerYear;
+    }
+    const TimeGrid& grid = *cache.grid;
 
-    // 3 build mesher if we do not have one or if we want to rebuild the mesher every time
+    // 3 build mesher if we do not have one or if we want to rebuild the mesher every time, the existing mesher is
+    //   kept if the bounds did not change
 
     Real spot = model_->equity()->equitySpot()->value();
     Real logSpot = std::log(spot);
 
-    if (mesher_ == nullptr || !staticMesher_) {
+    if (cache.mesher == nullptr || !staticMesher_) {
         Real mi = spot;
         Real ma = spot;
         Real forward = spot;
@@ -175,7 +214,12 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
         Real xMin = std::log(mi) - sigmaSqrtT * normInvEps * mesherScaling_;
         Real xMax = std::log(ma) + sigmaSqrtT * normInvEps * mesherScaling_;
 
-        mesher_ = boost::make_shared<Uniform1dMesher>(xMin, xMax, stateGridPoints_);
+        if (cache.mesher == nullptr || !close_enough(xMin, cache.xMin) || !close_enough(xMax, cache.xMax)) {
+            cache.mesher = boost::make_shared<Uniform1dMesher>(xMin, xMax, stateGridPoints);
+            cache.xMin = xMin;
+            cache.xMax = xMax;
+            cache.op.reset();
+        }
     }
 
     // 4 set up functions accrual(t), notional(t), recovery(t, S)
@@ -249,16 +293,21 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
         return accruals;
     };
 
-    // 5 build operator
-
-    auto fdmOp = boost::make_shared<FdmDefaultableEquityJumpDiffusionOp>(
-        boost::make_shared<FdmMesherComposite>(mesher_), *model_, 0, recovery, discountingCurve_, discountingSpread_,
-        creditCurve_, addRecovery);
-
-    // 6 build solver
-
-    auto solver = boost::make_shared<FdmBackwardSolver>(
-        fdmOp, std::vector<boost::shared_ptr<BoundaryCondition<FdmLinearOp>>>(), nullptr, FdmSchemeDesc::Douglas());
+    // 5, 6 build operator and solver if the mesher or the model changed, otherwise only update the recovery terms
+
+    if (cache.op == nullptr || cache.model != model_.currentLink()) {
+        cache.model = model_.currentLink();
+        cache.op = boost::make_shared<FdmDefaultableEquityJumpDiffusionOp>(
+            boost::make_shared<FdmMesherComposite>(cache.mesher), cache.model, 0, recovery, discountingCurve_,
+            discountingSpread_, creditCurve_, addRecovery);
+        cache.solver = boost::make_shared<FdmBackwardSolver>(
+            cache.op, std::vector<boost::shared_ptr<BoundaryCondition<FdmLinearOp>>>(), nullptr,
+            FdmSchemeDesc::Douglas());
+    } else {
+        cache.op->setRecovery(recovery, addRecovery);
+    }
+    const boost::shared_ptr<FdmDefaultableEquityJumpDiffusionOp>& fdmOp = cache.op;
+    const boost::shared_ptr<FdmBackwardSolver>& solver = cache.solver;
 
     // 7 prepare event container
 
@@ -276,7 +325,7 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
 
     // 9 set boundary value at last grid point
 
-    Size n = mesher_->locations().size();
+    Size n = cache.mesher->locations().size();
     std::vector<Array> value(stochasticConversionRatios.size(), Array(n, 0.0)), valueTmp;
 
     // 10 add no-conversion variants for start of period coco feature
@@ -285,7 +334,7 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
 
     // 11 perform the backward PDE pricing
 
-    Array S(mesher_->locations().begin(), mesher_->locations().end());
+    Array S(cache.mesher->locations().begin(), cache.mesher->locations().end());
     S = Exp(S);
 
     for (Size i = grid.size() - 1; i > 0; --i) {
@@ -578,7 +627,7 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
         solver->rollback(valueBondFloor, t_from, t_to, 1, 0);
     }
 
-    // 13 set result
+    // 13 interpolate the results at the spot
 
     QL_REQUIRE(
         value.size() == 1,
@@ -586,24 +635,19 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
             << value.size()
             << " pde planes after complete rollback, the planes should have been collapsed to one during the rollback");
 
-    MonotonicCubicNaturalSpline interpolationValue(mesher_->locations().begin(), mesher_->locations().end(),
+    MonotonicCubicNaturalSpline interpolationValue(cache.mesher->locations().begin(), cache.mesher->locations().end(),
                                                    value[0].begin());
-    MonotonicCubicNaturalSpline interpolationBondFloor(mesher_->locations().begin(), mesher_->locations().end(),
-                                                       valueBondFloor.begin());
+    MonotonicCubicNaturalSpline interpolationBondFloor(cache.mesher->locations().begin(),
+                                                       cache.mesher->locations().end(), valueBondFloor.begin());
     interpolationValue.enableExtrapolation();
     interpolationBondFloor.enableExtrapolation();
     Real npv = interpolationValue(logSpot);
     Real npvBondFloor = interpolationBondFloor(logSpot);
-    results_.additionalResults["BondFloor"] = npvBondFloor;
-
-    results_.value = arguments_.detachable ? npv - npvBondFloor : npv;
-
-    results_.settlementValue = results_.value; // FIXME this is not entirely correct of course
 
     // 14 set additional results, if not disabled
 
-    if (!generateAdditionalResults_)
-        return;
+    if (!additionalResults)
+        return std::make_pair(npv, npvBondFloor);
 
     // 14.1 output events table
 
@@ -765,6 +809,8 @@ void FdDefaultableEquityJumpDiffusionConvertibleBondEngine::calculate() const {
     results_.additionalResults["model.calibrationTimes"] = model_->stepTimes();
     results_.additionalResults["model.h0"] = model_->h0();
     results_.additionalResults["model.sigma"] = model_->sigma();
+
+    return std::make_pair(npv, npvBondFloor);
 }
 
 } // namespace QuantExt
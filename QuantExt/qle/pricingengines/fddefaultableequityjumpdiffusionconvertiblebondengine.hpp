@@ -21,11 +21,15 @@
 #pragma once
 
 #include <qle/instruments/convertiblebond2.hpp>
+#include <qle/methods/fdmdefaultableequityjumpdiffusionop.hpp>
 #include <qle/models/defaultableequityjumpdiffusionmodel.hpp>
+#include <qle/pricingengines/fdconvertiblebondevents.hpp>
 
 #include <qle/indexes/fxindex.hpp>
 
 #include <ql/methods/finitedifferences/meshers/fdm1dmesher.hpp>
+#include <ql/methods/finitedifferences/solvers/fdmbackwardsolver.hpp>
+#include <ql/timegrid.hpp>
 
 namespace QuantExt {
 
@@ -33,7 +37,13 @@ class FdDefaultableEquityJumpDiffusionConvertibleBondEngine : public Convertible
 public:
     /* - The discounting curve / discounting spread replaces the model rate r for discounting purposes.
        - The credit curve - if given - adds an additional discounting and recovery term, related to the
-         bond credit component, while in this case the model credit component is linked to the equity only. */
+         bond credit component, while in this case the model credit component is linked to the equity only.
+       - The time grid, the mesher and the operator are kept between calculations and only rebuilt if the event
+         times, the mesher bounds or the model change, otherwise only the operator coefficients are refreshed. This
+         makes repeated pricings under bumps of e.g. the discounting curve cheaper.
+       - If richardsonExtrapolation is true, the bond is priced on the given grid and on a grid with half the time
+         steps and state grid points, the NPV is extrapolated assuming a second order discretisation error. A
+         coarser grid can then be used for the same accuracy. */
     explicit FdDefaultableEquityJumpDiffusionConvertibleBondEngine(
         const Handle<DefaultableEquityJumpDiffusionModel>& model,
         const Handle<QuantLib::YieldTermStructure>& discountingCurve = Handle<QuantLib::YieldTermStructure>(),
@@ -46,10 +56,25 @@ public:
         const Real mesherScaling = 1.5,
         const std::vector<Real> conversionRatioDiscretisationGrid = {0.1, 0.5, 0.7, 0.9, 1.0, 1.1, 1.3, 1.5, 2.0, 5.0,
                                                                      10.0},
-        const bool generateAdditionalResults = true);
+        const bool generateAdditionalResults = true, const bool richardsonExtrapolation = false);
 
 private:
+    // grid, mesher and operator reused between calculations
+    struct GridCache {
+        std::set<Real> eventTimes;
+        Size timeStepsPerYear = 0;
+        boost::shared_ptr<TimeGrid> grid;
+        Real xMin = Null<Real>(), xMax = Null<Real>();
+        boost::shared_ptr<Fdm1dMesher> mesher;
+        boost::shared_ptr<DefaultableEquityJumpDiffusionModel> model;
+        boost::shared_ptr<FdmDefaultableEquityJumpDiffusionOp> op;
+        boost::shared_ptr<FdmBackwardSolver> solver;
+    };
+
     void calculate() const override;
+    // roll back on a grid with the given density, returns the npv and the bond floor
+    std::pair<Real, Real> rollback(FdConvertibleBondEvents events, const Size timeStepsPerYear,
+                                   const Size stateGridPoints, GridCache& cache, const bool additionalResults) const;
 
     Handle<DefaultableEquityJumpDiffusionModel> model_;
     Handle<QuantLib::YieldTermStructure> discountingCurve_;
@@ -64,8 +89,9 @@ private:
     Real mesherScaling_;
     std::vector<Real> conversionRatioDiscretisationGrid_;
     bool generateAdditionalResults_;
+    bool richardsonExtrapolation_;
 
-    mutable boost::shared_ptr<Fdm1dMesher> mesher_;
+    mutable GridCache cache_, coarseCache_;
 };
 
 } // namespace QuantExt
@@ -29,11 +29,11 @@ McCamCurrencySwapEngine::McCamCurrencySwapEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const bool regressionOnExerciseOnly)
+    const bool regressionOnExerciseOnly, const std::string& externalComputeDevice, const Size threads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minimalObsDate,
-                           regressionOnExerciseOnly),
+                           regressionOnExerciseOnly, externalComputeDevice, threads),
       currencies_(currencies), npvCcy_(npvCcy) {
     registerWith(model_);
     for (auto const& h : discountCurves)
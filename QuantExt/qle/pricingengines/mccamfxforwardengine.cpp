@@ -31,11 +31,12 @@ McCamFxForwardEngine::McCamFxForwardEngine(
     const Size polynomOrder, const LsmBasisSystem::PolynomialType polynomType,
     const SobolBrownianGenerator::Ordering ordering, const SobolRsg::DirectionIntegers directionIntegers,
     const std::vector<Handle<YieldTermStructure>>& discountCurves, const std::vector<Date>& simulationDates,
-    const std::vector<Size>& externalModelIndices, const bool minimalObsDate, const bool regressionOnExerciseOnly)
+    const std::vector<Size>& externalModelIndices, const bool minimalObsDate, const bool regressionOnExerciseOnly,
+    const std::string& externalComputeDevice, const Size threads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minimalObsDate,
-                           regressionOnExerciseOnly),
+                           regressionOnExerciseOnly, externalComputeDevice, threads),
       domesticCcy_(domesticCcy), foreignCcy_(foreignCcy), npvCcy_(npvCcy) {
     registerWith(model_);
     for (auto const& h : discountCurves)
@@ -46,7 +46,8 @@ public:
         const std::vector<Handle<YieldTermStructure>>& discountCurves = std::vector<Handle<YieldTermStructure>>(),
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
-        const bool regressionOnExerciseOnly = false);
+        const bool regressionOnExerciseOnly = false,
+        const std::string& externalComputeDevice = std::string(), const Size threads = 1);
 
     void calculate() const override;
     const Handle<CrossAssetModel>& model() const { return model_; }
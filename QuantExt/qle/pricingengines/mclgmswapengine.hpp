@@ -41,7 +41,8 @@ public:
                     const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
                     const std::vector<Date> simulationDates = std::vector<Date>(),
                     const std::vector<Size> externalModelIndices = std::vector<Size>(),
-                    const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false)
+                    const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false,
+                    const std::string& externalComputeDevice = std::string(), const Size threads = 1)
         : GenericEngine<QuantLib::Swap::arguments, QuantLib::Swap::results>(),
           McMultiLegBaseEngine(Handle<CrossAssetModel>(boost::make_shared<CrossAssetModel>(
                                    std::vector<boost::shared_ptr<IrModel>>(1, model),
@@ -49,7 +50,7 @@ public:
                                calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                                calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                                {discountCurve}, simulationDates, externalModelIndices, minimalObsDate,
-                               regressionOnExerciseOnly) {
+                               regressionOnExerciseOnly, externalComputeDevice, threads) {
         registerWith(model);
     }
 
@@ -43,7 +43,8 @@ public:
                         const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
                         const std::vector<Date> simulationDates = std::vector<Date>(),
                         const std::vector<Size> externalModelIndices = std::vector<Size>(),
-                        const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false)
+                        const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false,
+                        const std::string& externalComputeDevice = std::string(), const Size threads = 1)
         : GenericEngine<QuantLib::Swaption::arguments, QuantLib::Swaption::results>(),
           McMultiLegBaseEngine(Handle<CrossAssetModel>(boost::make_shared<CrossAssetModel>(
                                    std::vector<boost::shared_ptr<IrModel>>(1, model),
@@ -51,7 +52,7 @@ public:
                                calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                                calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                                {discountCurve}, simulationDates, externalModelIndices, minimalObsDate,
-                               regressionOnExerciseOnly) {
+                               regressionOnExerciseOnly, externalComputeDevice, threads) {
         registerWith(model);
     }
 
@@ -72,7 +73,8 @@ public:
                                    const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
                                    const std::vector<Date> simulationDates = std::vector<Date>(),
                                    const std::vector<Size> externalModelIndices = std::vector<Size>(),
-                                   const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false)
+                                   const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false,
+                                   const std::string& externalComputeDevice = std::string(), const Size threads = 1)
         : GenericEngine<QuantLib::NonstandardSwaption::arguments, QuantLib::NonstandardSwaption::results>(),
           McMultiLegBaseEngine(Handle<CrossAssetModel>(boost::make_shared<CrossAssetModel>(
                                    std::vector<boost::shared_ptr<IrModel>>(1, model),
@@ -80,7 +82,7 @@ public:
                                calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                                calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                                {discountCurve}, simulationDates, externalModelIndices, minimalObsDate,
-                               regressionOnExerciseOnly) {
+                               regressionOnExerciseOnly, externalComputeDevice, threads) {
         registerWith(model);
     }
 
@@ -20,7 +20,10 @@
 #include <qle/cashflows/indexedcoupon.hpp>
 #include <qle/cashflows/overnightindexedcoupon.hpp>
 #include <qle/cashflows/subperiodscoupon.hpp>
+#include <qle/math/computeenvironment.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
+#include <qle/pricingengines/mcmultilegpathcache.hpp>
 
 #include <ql/cashflows/averagebmacoupon.hpp>
 #include <ql/cashflows/capflooredcoupon.hpp>
@@ -33,6 +36,13 @@
 #include <ql/indexes/swapindex.hpp>
 #include <ql/math/generallinearleastsquares.hpp>
 #include <ql/math/matrixutilities/qrdecomposition.hpp>
+#include <ql/math/matrixutilities/svd.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <thread>
 
 namespace QuantExt {
 
@@ -48,6 +58,33 @@ Array regression(const std::vector<Array>& X, const I& Y, const std::vector<boos
     return GeneralLinearLeastSquares(X, Y, basisFn).coefficients();
 }
 
+/* As above, but using and, if null, setting the svd of the regressor matrix, which only depends on the paths, so
+   that it can be shared between regressions; the coefficients are computed as in GeneralLinearLeastSquares */
+template <class I, class B>
+Array regression(const std::vector<Array>& X, const I& Y, const B& basisFn, boost::shared_ptr<SVD>& svd) {
+    QL_REQUIRE(X.size() == Y.size(), "McMultiLegBaseEngine: vector lenghts do not match");
+    if (!svd) {
+        Matrix A(X.size(), basisFn.size());
+        for (Size i = 0; i < X.size(); ++i)
+            for (Size k = 0; k < basisFn.size(); ++k)
+                A[i][k] = basisFn[k](X[i]);
+        svd = boost::make_shared<SVD>(A);
+    }
+    const Matrix& U = svd->U();
+    const Matrix& V = svd->V();
+    const Array& w = svd->singularValues();
+    const Real threshold = X.size() * QL_EPSILON * w[0];
+    Array a(basisFn.size(), 0.0);
+    for (Size i = 0; i < basisFn.size(); ++i) {
+        if (w[i] > threshold) {
+            const Real u = std::inner_product(U.column_begin(i), U.column_end(i), Y.begin(), 0.0) / w[i];
+            for (Size j = 0; j < basisFn.size(); ++j)
+                a[j] += u * V[j][i];
+        }
+    }
+    return a;
+}
+
 #if QL_HEX_VERSION > 0x01150000
 Real evalRegression(const Array& c, const Array& x, const std::vector<ext::function<Real(Array)>> basisFns) {
 #else
@@ -72,14 +109,15 @@ McMultiLegBaseEngine::McMultiLegBaseEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const bool regressionOnExerciseOnly)
+    const bool regressionOnExerciseOnly, const std::string& externalComputeDevice, const Size threads)
     : model_(model), calibrationPathGenerator_(calibrationPathGenerator), pricingPathGenerator_(pricingPathGenerator),
       calibrationSamples_(calibrationSamples), pricingSamples_(pricingSamples), calibrationSeed_(calibrationSeed),
       pricingSeed_(pricingSeed), discountCurves_(discountCurves), simulationDates_(simulationDates),
       externalModelIndices_(externalModelIndices),
       basisFns_(LsmBasisSystem::multiPathBasisSystem(model->dimension(), polynomOrder, polynomType)),
       ordering_(ordering), directionIntegers_(directionIntegers), minimalObsDate_(minimalObsDate),
-      regressionOnExerciseOnly_(regressionOnExerciseOnly) {
+      regressionOnExerciseOnly_(regressionOnExerciseOnly), polynomType_(polynomType),
+      externalComputeDevice_(externalComputeDevice), threads_(threads) {
 
     QL_REQUIRE(calibrationSamples >= basisFns_.size(), "McMultiLegBaseEngine: too few calibrationSamples ("
                                                            << calibrationSamples
@@ -94,28 +132,40 @@ McMultiLegBaseEngine::McMultiLegBaseEngine(
     }
 }
 
-void McMultiLegBaseEngine::computePath(const MultiPath& p) const {
+Size McMultiLegBaseEngine::numberOfThreads() const {
+#ifdef QL_ENABLE_SESSIONS
+    return 1;
+#else
+    return threads_ == 0 ? std::max<Size>(1, std::thread::hardware_concurrency()) : threads_;
+#endif
+}
+
+void McMultiLegBaseEngine::computePath(const MultiPath& p, const Size thread, PathValues& values) const {
+
+    const auto& indexFwdCurve = indexFwdCurve_[thread];
+    const auto& indexDscCurve = indexDscCurve_[thread];
+    const auto& modelIndex = modelIndex_[thread];
 
     // reset result vectors
-    std::fill(pathUndEx_.begin(), pathUndEx_.end(), 0.0);
-    std::fill(pathUndDirty_.begin(), pathUndDirty_.end(), 0.0);
-    std::fill(pathUndTrapped_.begin(), pathUndTrapped_.end(), 0.0);
+    std::fill(values.undEx.begin(), values.undEx.end(), 0.0);
+    std::fill(values.undDirty.begin(), values.undDirty.end(), 0.0);
+    std::fill(values.undTrapped.begin(), values.undTrapped.end(), 0.0);
     // loop over the path
     for (Size i = 0; i < p.pathSize() - 1; ++i) {
         // obsevation path index (default value = current path index)
         Size pathIndex = i + 1;
         // loop over events associated to the path time
-        for (Size j = 0; j < modelIndex_[i].size(); ++j) {
+        for (Size j = 0; j < modelIndex[i].size(); ++j) {
             // determine the observation time
             if (observationTimeIndex_[i][j] != Null<Size>())
                 pathIndex = observationTimeIndex_[i][j];
             Real t = p[0].timeGrid()[pathIndex];
-            if (indexFwdCurve_[i][j] != nullptr)
-                indexFwdCurve_[i][j]->move(pathDates_[pathIndex], p[indexCcyIndex_[i][j]][pathIndex]);
-            if (indexDscCurve_[i][j] != nullptr)
-                indexDscCurve_[i][j]->move(pathDates_[pathIndex], p[indexCcyIndex_[i][j]][pathIndex]);
+            if (indexFwdCurve[i][j] != nullptr)
+                indexFwdCurve[i][j]->move(pathDates_[pathIndex], p[indexCcyIndex_[i][j]][pathIndex]);
+            if (indexDscCurve[i][j] != nullptr)
+                indexDscCurve[i][j]->move(pathDates_[pathIndex], p[indexCcyIndex_[i][j]][pathIndex]);
             // compute payoff and add to underlying pvs
-            Real fixing = modelIndex_[i][j] != nullptr ? modelIndex_[i][j]->fixing(fixingDate_[i][j]) : 0.0;
+            Real fixing = modelIndex[i][j] != nullptr ? modelIndex[i][j]->fixing(fixingDate_[i][j]) : 0.0;
             Real underlying_rate = gearing_[i][j] * fixing + spread_[i][j];
             Real rate = std::max(underlying_rate, flooredRate_[i][j]);
             if (isNakedOption_[i][j])
@@ -134,13 +184,13 @@ void McMultiLegBaseEngine::computePath(const MultiPath& p) const {
             Real num = model_->numeraire(0, t, p[0][pathIndex], discountCurves_[0]);
             Real npv = fx * dsc * amount / num;
             for (Size k = 0; k <= maxExerciseIndex_[i][j]; ++k) {
-                pathUndEx_[k] += npv;
+                values.undEx[k] += npv;
             }
             for (Size k = 0; k <= maxDirtyNpvIndex_[i][j]; ++k) {
-                pathUndDirty_[k] += npv;
+                values.undDirty[k] += npv;
             }
             for (Size l = 0; l < trappedCoupons_[i][j].size(); ++l) {
-                pathUndTrapped_[l] += npv;
+                values.undTrapped[l] += npv;
             }
         }
     }
@@ -164,9 +214,6 @@ void McMultiLegBaseEngine::rollback(const bool calibration) const {
 
     // init result vectors
     if (calibration) {
-        pathUndEx_.resize(numEx_ + 1);
-        pathUndDirty_.resize(numSim_ + 1);
-        pathUndTrapped_.resize(numSim_); // no index 0 for whole underlying
         coeffsItm_.resize(numEx_);
         coeffsUndEx_.resize(numEx_);
         coeffsFull_.resize(numSim_);
@@ -182,25 +229,120 @@ void McMultiLegBaseEngine::rollback(const bool calibration) const {
         if (isTrappedDate_[k])
             underlyingValueTrapped[k] = Array(N);
     }
-    for (Size i = 0; i < N; ++i) {
-        Sample<MultiPath> sample = calibration ? pathGeneratorCalibration_->next() : pathGeneratorPricing_->next();
-        computePath(sample.value);
+
+    const Size nThreads = std::min(numberOfThreads(), N);
+    std::vector<PathValues> pathValues(nThreads);
+    for (auto& v : pathValues) {
+        v.undEx.resize(numEx_ + 1);
+        v.undDirty.resize(numSim_ + 1);
+        v.undTrapped.resize(numSim_); // no index 0 for whole underlying
+    }
+
+    auto valuePath = [this, numIdx, &pathValues, &underlyingValueEx, &underlyingValueDirty, &underlyingValueTrapped,
+                      &paths](const MultiPath& p, const Size i, const Size thread) {
+        PathValues& values = pathValues[thread];
+        computePath(p, thread, values);
         for (Size k = 0; k <= numEx_; ++k)
-            underlyingValueEx[k][i] = pathUndEx_[k];
+            underlyingValueEx[k][i] = values.undEx[k];
         for (Size k = 0; k <= numSim_; ++k) {
-            underlyingValueDirty[k][i] = pathUndDirty_[k];
+            underlyingValueDirty[k][i] = values.undDirty[k];
             if (k > 0 && isTrappedDate_[k - 1])
-                underlyingValueTrapped[k - 1][i] = pathUndDirty_[k] - pathUndTrapped_[k - 1];
+                underlyingValueTrapped[k - 1][i] = values.undDirty[k] - values.undTrapped[k - 1];
         }
         for (Size j = 0; j < numIdx; ++j) {
-            Array v(sample.value.assetNumber());
-            for (Size k = 0; k < sample.value.assetNumber(); ++k) {
-                v[k] = sample.value[k][indexes_[j] + 1];
+            Array v(p.assetNumber());
+            for (Size k = 0; k < p.assetNumber(); ++k) {
+                v[k] = p[k][indexes_[j] + 1];
             }
             paths[j][i].swap(v);
         }
+    };
+
+    /* if the path cache is enabled, take the paths from the bundle of engines on the same model with the same time
+       grid and generator settings, or start the bundle, if there is none yet */
+    auto& cache = McMultiLegPathCache::instance();
+    McMultiLegPathCache::Key cacheKey;
+    boost::shared_ptr<McMultiLegPathCache::Bundle> bundle, newBundle;
+    if (cache.enabled()) {
+        cacheKey = McMultiLegPathCache::Key(model_.currentLink().get(), calibration,
+                                            calibration ? calibrationPathGenerator_ : pricingPathGenerator_,
+                                            calibration ? calibrationSeed_ : pricingSeed_, N, ordering_,
+                                            directionIntegers_, times_);
+        bundle = cache.get(cacheKey);
+        if (!bundle) {
+            newBundle = boost::make_shared<McMultiLegPathCache::Bundle>();
+            newBundle->paths.reserve(N);
+        }
+    }
+
+    auto nextPath = [this, calibration, &bundle, &newBundle](const Size i) -> const MultiPath& {
+        if (bundle)
+            return bundle->paths[i];
+        const MultiPath& p =
+            calibration ? pathGeneratorCalibration_->next().value : pathGeneratorPricing_->next().value;
+        if (!newBundle)
+            return p;
+        newBundle->paths.push_back(p);
+        return newBundle->paths.back();
+    };
+
+    if (nThreads == 1) {
+        for (Size i = 0; i < N; ++i)
+            valuePath(nextPath(i), i, 0);
+    } else {
+        // the paths are generated sequentially in blocks and valued in parallel, each thread using its own index
+        // curves; the first path is valued before the threads are started, so that lazy objects shared by the
+        // threads (e.g. the market curves) are calculated already
+        const Size blockSize = 256 * nThreads;
+        std::vector<MultiPath> block;
+        for (Size b = 0; b < N; b += blockSize) {
+            const Size m = std::min(blockSize, N - b);
+            for (Size i = 0; i < m; ++i) {
+                const MultiPath& p = nextPath(b + i);
+                if (i < block.size())
+                    block[i] = p;
+                else
+                    block.push_back(p);
+            }
+            std::atomic<Size> next(b == 0 ? 1 : 0);
+            if (b == 0)
+                valuePath(block[0], 0, 0);
+            std::vector<std::exception_ptr> errors(nThreads);
+            auto worker = [&block, &next, &errors, &valuePath, b, m](const Size thread) {
+                try {
+                    for (Size i = next++; i < m; i = next++)
+                        valuePath(block[i], b + i, thread);
+                } catch (...) {
+                    errors[thread] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (Size t = 1; t < nThreads; ++t)
+                threads.push_back(std::thread(worker, t));
+            worker(0);
+            for (auto& t : threads)
+                t.join();
+            for (auto const& e : errors) {
+                if (e)
+                    std::rethrow_exception(e);
+            }
+        }
+    }
+
+    if (newBundle) {
+        cache.add(cacheKey, newBundle);
+        bundle = newBundle;
     }
 
+    /* full sample regressions on the paths of a calibration bundle share the svd of the regressor matrix, the
+       regressions on the itm paths depend on the trade and are done as usual */
+    auto fullRegression = [this, N, &bundle, &paths](const Size pathIdx, const auto& Y) {
+        if (!bundle || N < basisFns_.size())
+            return regression(paths[pathIdx], Y, basisFns_);
+        return regression(paths[pathIdx], Y, basisFns_,
+                          bundle->svd[std::make_tuple(indexes_[pathIdx], basisFns_.size(), polynomType_)]);
+    };
+
     // roll back over live ex / sim dates (1,2...) and today (0)
     bool isLastExercise = true;
     for (Size ts = numIdx; ts > 0; --ts) {
@@ -212,7 +354,7 @@ void McMultiLegBaseEngine::rollback(const bool calibration) const {
         // conditional expectation of underlying value
         if (calibration) {
             if (isExercise) {
-                coeffsUndEx_[exIdx] = regression(paths[ts - 1], underlyingValueEx[exIdx + 1], basisFns_);
+                coeffsUndEx_[exIdx] = fullRegression(ts - 1, underlyingValueEx[exIdx + 1]);
             }
             if (isSimulation) {
                 Size tmpTs = ts;
@@ -223,10 +365,9 @@ void McMultiLegBaseEngine::rollback(const bool calibration) const {
                     tmpTs = ts;
                 // skip if we know that all underlying flows are zero
                 if (simIdx <= maxUndValDirtyIdx_) {
-                    coeffsUndDirty_[simIdx] = regression(paths[tmpTs - 1], underlyingValueDirty[simIdx + 1], basisFns_);
+                    coeffsUndDirty_[simIdx] = fullRegression(tmpTs - 1, underlyingValueDirty[simIdx + 1]);
                     if (isTrappedDate_[simIdx])
-                        coeffsUndTrapped_[simIdx] =
-                            regression(paths[tmpTs - 1], underlyingValueTrapped[simIdx], basisFns_);
+                        coeffsUndTrapped_[simIdx] = fullRegression(tmpTs - 1, underlyingValueTrapped[simIdx]);
                 } else
                     coeffsUndDirty_[simIdx] = Array(basisFns_.size(), 0.0);
             }
@@ -277,7 +418,7 @@ void McMultiLegBaseEngine::rollback(const bool calibration) const {
                 while (regressionOnExerciseOnly_ && tmpTs <= numIdx && exerciseIdx_[tmpTs - 1] == Null<Size>())
                     ++tmpTs;
                 QL_REQUIRE(tmpTs <= numIdx, "tmpTs > numIdx, this is unexpected");
-                coeffsFull_[simIdx] = regression(paths[tmpTs - 1], option, basisFns_);
+                coeffsFull_[simIdx] = fullRegression(tmpTs - 1, option);
             }
         }
         if (isExercise) {
@@ -445,6 +586,7 @@ void McMultiLegBaseEngine::calculate() const {
     }
 
     // simulation data for each simulation time (empty where not applicable)
+    const Size nThreads = numberOfThreads();
     maxUndValDirtyIdx_ = 0;
     indexCcyIndex_.clear();
     payCcyNum_.clear();
@@ -475,9 +617,9 @@ void McMultiLegBaseEngine::calculate() const {
     payFxIndex_.resize(times_.size());
     maxExerciseIndex_.resize(times_.size());
     maxDirtyNpvIndex_.resize(times_.size());
-    indexFwdCurve_.resize(times_.size());
-    indexDscCurve_.resize(times_.size());
-    modelIndex_.resize(times_.size());
+    indexFwdCurve_.resize(nThreads, decltype(indexFwdCurve_)::value_type(times_.size()));
+    indexDscCurve_.resize(nThreads, decltype(indexDscCurve_)::value_type(times_.size()));
+    modelIndex_.resize(nThreads, decltype(modelIndex_)::value_type(times_.size()));
     observationTimeIndex_.resize(times_.size());
     fixingDate_.resize(times_.size());
     gearing_.resize(times_.size());
@@ -577,9 +719,11 @@ void McMultiLegBaseEngine::calculate() const {
 
             if (isFixedCoupon(leg_[i][j], today)) {
                 indexCcyIndex_[index].push_back(Null<Size>());
-                indexFwdCurve_[index].push_back(nullptr);
-                indexDscCurve_[index].push_back(nullptr);
-                modelIndex_[index].push_back(nullptr);
+                for (Size t = 0; t < nThreads; ++t) {
+                    indexFwdCurve_[t][index].push_back(nullptr);
+                    indexDscCurve_[t][index].push_back(nullptr);
+                    modelIndex_[t][index].push_back(nullptr);
+                }
                 fixingDate_[index].push_back(Null<Date>());
                 gearing_[index].push_back(1.0);
                 spread_[index].push_back(cpn != nullptr ? cpn->rate() : 1.0);
@@ -714,22 +858,26 @@ void McMultiLegBaseEngine::calculate() const {
                 if (auto iborcpn = boost::dynamic_pointer_cast<IborCoupon>(flr)) {
                     // IBOR
                     indexCcyIndex_[index].push_back(model_->pIdx(CrossAssetModel::AssetType::IR, ccyIndex));
-                    indexFwdCurve_[index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
-                        model_->lgm(ccyIndex), iborcpn->iborIndex()->forwardingTermStructure()));
-                    indexDscCurve_[index].push_back(nullptr);
-                    modelIndex_[index].push_back(
-                        iborcpn->iborIndex()->clone(Handle<YieldTermStructure>(indexFwdCurve_[index].back())));
+                    for (Size t = 0; t < nThreads; ++t) {
+                        indexFwdCurve_[t][index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
+                            model_->lgm(ccyIndex), iborcpn->iborIndex()->forwardingTermStructure()));
+                        indexDscCurve_[t][index].push_back(nullptr);
+                        modelIndex_[t][index].push_back(
+                            iborcpn->iborIndex()->clone(Handle<YieldTermStructure>(indexFwdCurve_[t][index].back())));
+                    }
                     cpnrec = true;
                 } else if (auto cmscpn = boost::dynamic_pointer_cast<CmsCoupon>(flr)) {
                     // CMS
                     allowsVanillaValuation = false;
                     indexCcyIndex_[index].push_back(model_->pIdx(CrossAssetModel::AssetType::IR, ccyIndex));
-                    indexFwdCurve_[index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
-                        model_->lgm(ccyIndex), cmscpn->swapIndex()->forwardingTermStructure()));
-                    indexDscCurve_[index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
-                        model_->lgm(ccyIndex), cmscpn->swapIndex()->discountingTermStructure()));
-                    modelIndex_[index].push_back(
-                        cmscpn->swapIndex()->clone(Handle<YieldTermStructure>(indexFwdCurve_[index].back())));
+                    for (Size t = 0; t < nThreads; ++t) {
+                        indexFwdCurve_[t][index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
+                            model_->lgm(ccyIndex), cmscpn->swapIndex()->forwardingTermStructure()));
+                        indexDscCurve_[t][index].push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
+                            model_->lgm(ccyIndex), cmscpn->swapIndex()->discountingTermStructure()));
+                        modelIndex_[t][index].push_back(
+                            cmscpn->swapIndex()->clone(Handle<YieldTermStructure>(indexFwdCurve_[t][index].back())));
+                    }
                     cpnrec = true;
                 }
                 // add more coupon types here ...
@@ -801,7 +949,7 @@ boost::shared_ptr<AmcCalculator> McMultiLegBaseEngine::amcCalculator() const {
         model_->irlgm1f(0)->currency(), model_->stateProcess()->initialValues(), externalModelIndices_,
         exercise_ != nullptr, optionSettlement_ == Settlement::Physical, times_, indexes_, exerciseIdx_, simulationIdx_,
         isTrappedDate_, numSim_, resultValue_, coeffsItm_, coeffsUndEx_, coeffsFull_, coeffsUndTrapped_,
-        coeffsUndDirty_, basisFns_);
+        coeffsUndDirty_, basisFns_, polynomType_, externalComputeDevice_);
 }
 
 std::vector<QuantExt::RandomVariable>
@@ -830,6 +978,9 @@ MultiLegBaseAmcCalculator::simulatePath(const std::vector<QuantLib::Real>& pathT
 
     std::vector<QuantExt::RandomVariable> result(simTimes.size(), RandomVariable(paths.front().front().size(), 0.0));
 
+    if (!externalComputeDevice_.empty() && simulatePathExternal(paths, isRelevantTime, result))
+        return result;
+
     for (Size sample = 0; sample < paths.front().front().size(); ++sample) {
 
         MultiPath path(externalModelIndices_.size(), timeGrid);
@@ -857,6 +1008,136 @@ MultiLegBaseAmcCalculator::simulatePath(const std::vector<QuantLib::Real>& pathT
     return result;
 }
 
+bool MultiLegBaseAmcCalculator::simulatePathExternal(const std::vector<std::vector<QuantExt::RandomVariable>>& paths,
+                                                     const std::vector<bool>& isRelevantTime,
+                                                     std::vector<QuantExt::RandomVariable>& result) {
+
+    // the exercise decision is path dependent and not supported on the device, neither are basis functions
+    // other than monomials, in both cases we fall back to the cpu implementation
+
+    if (hasExercise_ || polynomType_ != LsmBasisSystem::Monomial)
+        return false;
+
+    auto& env = ComputeEnvironment::instance();
+    if (!env.hasDevice(externalComputeDevice_))
+        return false;
+
+    // recover the exponents of the monomials from the basis functions, so that the order of the regression
+    // coefficients from the training is kept
+
+    const Size dim = externalModelIndices_.size();
+    if (monomialExponents_.empty()) {
+        std::vector<std::vector<Size>> exponents(basisFns_.size(), std::vector<Size>(dim));
+        for (Size k = 0; k < basisFns_.size(); ++k) {
+            Array x(dim, 1.0);
+            Real check = 1.0;
+            for (Size j = 0; j < dim; ++j) {
+                x[j] = 2.0;
+                exponents[k][j] = static_cast<Size>(std::lround(std::log2(basisFns_[k](x))));
+                x[j] = 1.0;
+            }
+            for (Size j = 0; j < dim; ++j) {
+                x[j] = 1.1 + 0.1 * j;
+                check *= std::pow(x[j], static_cast<Real>(exponents[k][j]));
+            }
+            if (!QuantLib::close_enough(basisFns_[k](x), check))
+                return false;
+        }
+        monomialExponents_.swap(exponents);
+    }
+
+    std::vector<Size> timeIndex;
+    for (Size i = 0; i < isRelevantTime.size(); ++i)
+        if (isRelevantTime[i])
+            timeIndex.push_back(i);
+    QL_REQUIRE(timeIndex.size() == numSim_, "MultiLegBaseAmcCalculator::simulatePathExternal: expected "
+                                                << numSim_ << " relevant path times, got " << timeIndex.size());
+
+    std::vector<Size> simIndex;
+    for (Size i = 0; i < indexes_.size(); ++i)
+        if (simulationIdx_[i] != Null<Size>())
+            simIndex.push_back(simulationIdx_[i]);
+
+    const Size n = paths.front().front().size();
+    if (n != externalCalculationSize_) {
+        externalCalculationId_ = 0;
+        externalCalculationSize_ = n;
+    }
+
+    env.selectContext(externalComputeDevice_);
+    auto& context = env.context();
+    context.setPrecision(context.supportsDoublePrecision() ? ComputeContext::Precision::Double
+                                                           : ComputeContext::Precision::Single);
+    auto [id, newCalc] = context.initiateCalculation(n, externalCalculationId_, 0);
+    externalCalculationId_ = id;
+
+    // the input variables are the model states on the simulation dates and the regression coefficients, they are
+    // converted to the precision of the context if necessary
+
+    std::vector<std::vector<double>> state(simIndex.size() * dim, std::vector<double>(n));
+    std::vector<std::vector<std::size_t>> stateId(simIndex.size(), std::vector<std::size_t>(dim));
+    for (Size i = 0; i < simIndex.size(); ++i) {
+        for (Size j = 0; j < dim; ++j) {
+            auto const& v = paths[timeIndex[simIndex[i]]][externalModelIndices_[j]];
+            auto& s = state[i * dim + j];
+            for (Size p = 0; p < n; ++p)
+                s[p] = v[p];
+            stateId[i][j] = context.createInputVariable(&s[0]);
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> coeffId(simIndex.size(), std::vector<std::size_t>(basisFns_.size()));
+    for (Size i = 0; i < simIndex.size(); ++i) {
+        QL_REQUIRE(coeffsUndDirty_[simIndex[i]].size() == basisFns_.size(),
+                   "MultiLegBaseAmcCalculator::simulatePathExternal: coefficients size ("
+                       << coeffsUndDirty_[simIndex[i]].size() << ") and number of basis functions ("
+                       << basisFns_.size() << ") do not match");
+        for (Size k = 0; k < basisFns_.size(); ++k)
+            coeffId[i][k] = context.createInputVariable(static_cast<double>(coeffsUndDirty_[simIndex[i]][k]));
+    }
+
+    // record the evaluation of the regression models, this is only required for a new calculation
+
+    if (newCalc) {
+        for (Size i = 0; i < simIndex.size(); ++i) {
+            std::size_t value = 0;
+            for (Size k = 0; k < basisFns_.size(); ++k) {
+                std::size_t term = coeffId[i][k];
+                for (Size j = 0; j < dim; ++j) {
+                    for (Size e = 0; e < monomialExponents_[k][j]; ++e) {
+                        std::size_t tmp = context.applyOperation(RandomVariableOpCode::Mult, {term, stateId[i][j]});
+                        if (term != coeffId[i][k])
+                            context.freeVariable(term);
+                        term = tmp;
+                    }
+                }
+                if (k == 0) {
+                    value = term;
+                } else {
+                    std::size_t tmp = context.applyOperation(RandomVariableOpCode::Add, {value, term});
+                    context.freeVariable(value);
+                    context.freeVariable(term);
+                    value = tmp;
+                }
+            }
+            context.declareOutputVariable(value);
+        }
+    }
+
+    std::vector<std::vector<double>> output(simIndex.size(), std::vector<double>(n));
+    context.finalizeCalculation(output);
+
+    for (Size i = 0; i < simIndex.size(); ++i) {
+        for (Size p = 0; p < n; ++p)
+            result[simIndex[i] + 1].set(p, output[i][p]);
+    }
+
+    for (Size p = 0; p < n; ++p)
+        result[0].set(p, resultValue_);
+
+    return true;
+}
+
 Array MultiLegBaseAmcCalculator::simulatePath(const MultiPath& path, const bool reuseLastEvents, const Size sample) {
     // we assume that the path exactly contains the simulation times (and 0)
     // we only check that the path has the right length here
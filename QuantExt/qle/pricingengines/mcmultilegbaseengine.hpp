@@ -40,7 +40,13 @@ class McMultiLegBaseEngine {
 protected:
     /*! The npv is computed in the model's base currency, discounting curves are taken
       from the model. simulationDates are additional simulation dates.
-      The cross asset model here must be consistent with the multi path that is input in AmcCalculator */
+      The cross asset model here must be consistent with the multi path that is input in AmcCalculator.
+      If externalComputeDevice is not empty, the AmcCalculator evaluates the regression models for the paths
+      on that device (see ComputeEnvironment) where this is supported and falls back to the cpu otherwise.
+      The underlying values on the calibration and pricing paths are computed by the given number of threads,
+      zero means one thread per core. The paths are generated sequentially, so that the results do not depend
+      on the number of threads. In builds with QL_ENABLE_SESSIONS a single thread is used, since the worker
+      threads would not see the session's singletons. */
     McMultiLegBaseEngine(
         const Handle<CrossAssetModel>& model, const SequenceType calibrationPathGenerator,
         const SequenceType pricingPathGenerator, const Size calibrationSamples, const Size pricingSamples,
@@ -50,10 +56,18 @@ protected:
         const std::vector<Handle<YieldTermStructure>>& discountCurves = std::vector<Handle<YieldTermStructure>>(),
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
-        const bool regressionOnExerciseOnly = false);
-
-    // compute path exercise into and (dirty) simulation underlying values
-    void computePath(const MultiPath& p) const;
+        const bool regressionOnExerciseOnly = false,
+        const std::string& externalComputeDevice = std::string(), const Size threads = 1);
+
+    // underlying values on a path, one instance per worker thread
+    struct PathValues {
+        std::vector<Real> undEx, undDirty, undTrapped;
+    };
+
+    // compute path exercise into and (dirty) simulation underlying values, using the index curves of the thread
+    void computePath(const MultiPath& p, const Size thread, PathValues& values) const;
+    // number of threads used to compute the underlying values
+    Size numberOfThreads() const;
     // rollback for calibration or pricing
     void rollback(const bool calibration) const;
     // run calibration and pricing
@@ -83,6 +97,9 @@ protected:
     const SobolBrownianGenerator::Ordering ordering_;
     SobolRsg::DirectionIntegers directionIntegers_;
     const bool minimalObsDate_, regressionOnExerciseOnly_;
+    const LsmBasisSystem::PolynomialType polynomType_;
+    const std::string externalComputeDevice_;
+    const Size threads_;
 
     // precomputed values for simulation
     mutable std::vector<Real> times_;
@@ -90,12 +107,13 @@ protected:
     mutable std::vector<Size> exerciseIdx_, simulationIdx_;
     mutable std::vector<bool> isTrappedDate_;
     mutable Size numEx_, numSim_;
-    mutable std::vector<Real> pathUndEx_, pathUndDirty_, pathUndTrapped_;
     mutable std::vector<std::vector<Size>> indexCcyIndex_, payCcyNum_, payCcyIndex_, payFxIndex_, maxExerciseIndex_,
         maxDirtyNpvIndex_;
     mutable std::vector<std::vector<std::vector<Size>>> trappedCoupons_;
-    mutable std::vector<std::vector<boost::shared_ptr<LgmImpliedYieldTermStructure>>> indexFwdCurve_, indexDscCurve_;
-    mutable std::vector<std::vector<boost::shared_ptr<InterestRateIndex>>> modelIndex_;
+    // the index curves are moved along the path, so each thread has its own curves and indices, indexed by thread
+    mutable std::vector<std::vector<std::vector<boost::shared_ptr<LgmImpliedYieldTermStructure>>>> indexFwdCurve_,
+        indexDscCurve_;
+    mutable std::vector<std::vector<std::vector<boost::shared_ptr<InterestRateIndex>>>> modelIndex_;
     mutable std::vector<std::vector<Size>> observationTimeIndex_;
     mutable std::vector<std::vector<Date>> fixingDate_;
     mutable std::vector<std::vector<Real>> gearing_, spread_, accrualTime_, nominal_, payTime_, cappedRate_,
@@ -132,15 +150,18 @@ public:
                               const std::vector<Array>& coeffsUndEx, const std::vector<Array>& coeffsFull,
                               const std::vector<Array>& coeffsUndTrapped, const std::vector<Array>& coeffsUndDirty,
 #if QL_HEX_VERSION > 0x01150000
-                              const std::vector<ext::function<Real(Array)>>& basisFns)
+                              const std::vector<ext::function<Real(Array)>>& basisFns,
 #else
-                              const std::vector<boost::function1<Real, Array>>& basisFns)
+                              const std::vector<boost::function1<Real, Array>>& basisFns,
 #endif
+                              const LsmBasisSystem::PolynomialType polynomType = LsmBasisSystem::Monomial,
+                              const std::string& externalComputeDevice = std::string())
         : baseCurrency_(baseCurrency), x0_(x0), externalModelIndices_(externalModelIndices), hasExercise_(hasExercise),
           isPhysicalSettlement_(isPhysicalSettlement), times_(times), indexes_(indexes), exerciseIdx_(exerciseIdx),
           simulationIdx_(simulationIdx), isTrappedDate_(isTrappedDate), numSim_(numSim), resultValue_(resultValue),
           coeffsItm_(coeffsItm), coeffsUndEx_(coeffsUndEx), coeffsFull_(coeffsFull),
-          coeffsUndTrapped_(coeffsUndTrapped), coeffsUndDirty_(coeffsUndDirty), basisFns_(basisFns) {
+          coeffsUndTrapped_(coeffsUndTrapped), coeffsUndDirty_(coeffsUndDirty), basisFns_(basisFns),
+          polynomType_(polynomType), externalComputeDevice_(externalComputeDevice) {
     }
     Currency npvCurrency() override { return baseCurrency_; }
 
@@ -151,6 +172,10 @@ public:
 
 private:
     Array simulatePath(const MultiPath& path, const bool reuseLastEvents, const Size sample);
+    /* evaluate the regression models on the external compute device, returns false if this is not possible and
+       the cpu implementation should be used instead */
+    bool simulatePathExternal(const std::vector<std::vector<RandomVariable>>& paths,
+                              const std::vector<bool>& isRelevantTime, std::vector<RandomVariable>& result);
     const Currency baseCurrency_;
     const Array x0_;
     const std::vector<Size> externalModelIndices_;
@@ -172,7 +197,13 @@ private:
 #else
     const std::vector<boost::function1<Real, Array>> basisFns_;
 #endif
+    const LsmBasisSystem::PolynomialType polynomType_;
+    const std::string externalComputeDevice_;
     std::vector<Size> storedExerciseIndex_;
+    // exponents of the monomial basis functions
+    std::vector<std::vector<Size>> monomialExponents_;
+    // calculation id and size on the external compute device
+    std::size_t externalCalculationId_ = 0, externalCalculationSize_ = 0;
 };
 
 } // namespace QuantExt
@@ -27,11 +27,11 @@ McMultiLegOptionEngine::McMultiLegOptionEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const bool regressionOnExerciseOnly)
+    const bool regressionOnExerciseOnly, const std::string& externalComputeDevice, const Size threads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minimalObsDate,
-                           regressionOnExerciseOnly) {
+                           regressionOnExerciseOnly, externalComputeDevice, threads) {
     registerWith(model_);
     for (auto& h : discountCurves_) {
         registerWith(h);
@@ -45,14 +45,14 @@ McMultiLegOptionEngine::McMultiLegOptionEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const Handle<YieldTermStructure>& discountCurve,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const bool regressionOnExerciseOnly)
+    const bool regressionOnExerciseOnly, const std::string& externalComputeDevice, const Size threads)
     : McMultiLegOptionEngine(Handle<CrossAssetModel>(boost::make_shared<CrossAssetModel>(
                                  std::vector<boost::shared_ptr<IrModel>>(1, model),
                                  std::vector<boost::shared_ptr<FxBsParametrization>>())),
                              calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                              calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                              {discountCurve}, simulationDates, externalModelIndices, minimalObsDate,
-                             regressionOnExerciseOnly) {}
+                             regressionOnExerciseOnly, externalComputeDevice, threads) {}
 
 void McMultiLegOptionEngine::calculate() const {
 
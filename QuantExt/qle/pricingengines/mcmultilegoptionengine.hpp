@@ -47,7 +47,8 @@ public:
         const std::vector<Handle<YieldTermStructure>>& discountCurves = std::vector<Handle<YieldTermStructure>>(),
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
-        const bool regressionOnExerciseOnly = false);
+        const bool regressionOnExerciseOnly = false,
+        const std::string& externalComputeDevice = std::string(), const Size threads = 1);
     McMultiLegOptionEngine(const boost::shared_ptr<LinearGaussMarkovModel>& model,
                            const SequenceType calibrationPathGenerator, const SequenceType pricingPathGenerator,
                            const Size calibrationSamples, const Size pricingSamples, const Size calibrationSeed,
@@ -58,7 +59,8 @@ public:
                            const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
                            const std::vector<Date>& simulationDates = std::vector<Date>(),
                            const std::vector<Size>& externalModelIndices = std::vector<Size>(),
-                           const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false);
+                           const bool minimalObsDate = true, const bool regressionOnExerciseOnly = false,
+                           const std::string& externalComputeDevice = std::string(), const Size threads = 1);
 
     void calculate() const override;
     const Handle<CrossAssetModel>& model() const { return model_; }
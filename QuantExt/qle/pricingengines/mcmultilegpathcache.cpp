@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/pricingengines/mcmultilegpathcache.hpp>
+
+namespace QuantExt {
+
+void McMultiLegPathCache::enable(const QuantLib::Size capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    while (order_.size() > capacity_) {
+        bundles_.erase(order_.front());
+        order_.pop_front();
+    }
+}
+
+bool McMultiLegPathCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_ > 0;
+}
+
+boost::shared_ptr<McMultiLegPathCache::Bundle> McMultiLegPathCache::get(const Key& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto b = bundles_.find(key);
+    return b == bundles_.end() ? nullptr : b->second;
+}
+
+void McMultiLegPathCache::add(const Key& key, const boost::shared_ptr<Bundle>& bundle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0 || bundles_.count(key) > 0)
+        return;
+    if (order_.size() == capacity_) {
+        bundles_.erase(order_.front());
+        order_.pop_front();
+    }
+    bundles_[key] = bundle;
+    order_.push_back(key);
+}
+
+QuantLib::Size McMultiLegPathCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bundles_.size();
+}
+
+} // namespace QuantExt
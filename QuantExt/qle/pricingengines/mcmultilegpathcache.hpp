@@ -0,0 +1,102 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file mcmultilegpathcache.hpp
+    \brief cache for the calibration and pricing paths of the McMultiLegBaseEngine
+*/
+
+#pragma once
+
+#include <qle/methods/multipathgeneratorbase.hpp>
+
+#include <ql/math/matrixutilities/svd.hpp>
+#include <ql/methods/montecarlo/lsmbasissystem.hpp>
+#include <ql/methods/montecarlo/multipath.hpp>
+#include <ql/patterns/singleton.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace QuantExt {
+
+class CrossAssetModel;
+
+//! Cache for the paths shared by McMultiLegBaseEngine instances
+/*! Engines on the same model with the same time grid, path generator settings and number of samples generate the
+    same paths. While the cache is enabled, the first engine stores its paths in a bundle and the other engines of the
+    bundle reuse them instead of generating their own. For calibration bundles the singular value decompositions of
+    the regressor matrices, which only depend on the paths, are stored as well, so the regressions of all trades in a
+    bundle share them.
+
+    The cache is meant to be enabled while the trades of a portfolio are priced against a fixed model, e.g. while the
+    AMC calculators are extracted in an AMC exposure run, and must be disabled (which clears it) afterwards, since the
+    bundles are identified by the address of the model. At most capacity bundles are kept, the oldest bundle is
+    dropped first.
+
+    In builds with QL_ENABLE_SESSIONS there is one cache per session.
+*/
+class McMultiLegPathCache : public QuantLib::Singleton<McMultiLegPathCache> {
+    friend class QuantLib::Singleton<McMultiLegPathCache>;
+
+private:
+    McMultiLegPathCache() = default;
+
+public:
+    /*! The paths of a bundle and, for calibration bundles, the svd of the regressor matrices by time index, number of
+        basis functions and polynomial type; the svd are added by the engine computing them first */
+    struct Bundle {
+        std::vector<QuantLib::MultiPath> paths;
+        std::map<std::tuple<QuantLib::Size, QuantLib::Size, QuantLib::LsmBasisSystem::PolynomialType>,
+                 boost::shared_ptr<QuantLib::SVD>>
+            svd;
+    };
+
+    //! model, calibration flag, generator, seed, samples, ordering, direction integers, time grid
+    typedef std::tuple<const CrossAssetModel*, bool, SequenceType, QuantLib::Size, QuantLib::Size,
+                       QuantLib::SobolBrownianGenerator::Ordering, QuantLib::SobolRsg::DirectionIntegers,
+                       std::vector<QuantLib::Real>>
+        Key;
+
+    //! Enable the cache with the given maximum number of bundles, zero disables it
+    void enable(const QuantLib::Size capacity);
+    //! Disable and clear the cache
+    void disable() { enable(0); }
+    //! True if the cache is enabled
+    bool enabled() const;
+
+    //! The bundle for the key or null, if there is none
+    boost::shared_ptr<Bundle> get(const Key& key) const;
+    //! Add a bundle, does nothing if the cache is disabled
+    void add(const Key& key, const boost::shared_ptr<Bundle>& bundle);
+
+    //! The number of bundles in the cache
+    QuantLib::Size size() const;
+
+private:
+    mutable std::mutex mutex_;
+    QuantLib::Size capacity_ = 0;
+    std::map<Key, boost::shared_ptr<Bundle>> bundles_;
+    // the keys in the order the bundles were added
+    std::list<Key> order_;
+};
+
+} // namespace QuantExt
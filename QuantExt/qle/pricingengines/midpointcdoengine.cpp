@@ -81,6 +81,19 @@ void MidPointCDOEngine::calculate() const {
     //         boost::dynamic_pointer_cast<Coupon>(
     //             arguments_.normalizedLeg[0])->accrualStartDate());
     results_.expectedTrancheLoss.push_back(recovery_e1);
+
+    // expected tranche losses up to the end of the future coupon periods, computed in one go by the loss model
+    std::vector<Date> etlDates;
+    for (const auto& c : arguments_.normalizedLeg) {
+        if (!c->hasOccurred(today))
+            etlDates.push_back(boost::dynamic_pointer_cast<Coupon>(c)->accrualEndDate());
+    }
+    std::vector<Real> zeroRecoveryEtls =
+        arguments_.basket->expectedTrancheLosses(etlDates, true); // zero recoveries for the coupon leg
+    std::vector<Real> recoveryEtls =
+        arguments_.basket->expectedTrancheLosses(etlDates, false); // non-zero recovery for the default leg
+    Size etlIndex = 0;
+
     //'e1'  should contain the existing loses.....? use remaining amounts?
     for (Size i = 0; i < arguments_.normalizedLeg.size(); i++) {
         if (arguments_.normalizedLeg[i]->hasOccurred(today)) {
@@ -94,11 +107,8 @@ void MidPointCDOEngine::calculate() const {
         // we assume the loss within the period took place on this date:
         Date defaultDate = startDate + (endDate - startDate) / 2;
 
-        Real zeroRecovery_e2 =
-            arguments_.basket->expectedTrancheLoss(endDate, true); // zero recoveries for the coupon leg
-
-        Real recovery_e2 =
-            arguments_.basket->expectedTrancheLoss(endDate, false); // non-zero recovery for the default leg
+        Real zeroRecovery_e2 = zeroRecoveryEtls[etlIndex];
+        Real recovery_e2 = recoveryEtls[etlIndex++];
 
         results_.expectedTrancheLoss.push_back(recovery_e2);
         results_.premiumValue += ((inceptionTrancheNotional - zeroRecovery_e2) / inceptionTrancheNotional) *
@@ -21,7 +21,6 @@
 #include <qle/utilities/time.hpp>
 
 #include <ql/exercise.hpp>
-#include <ql/math/integrals/simpsonintegral.hpp>
 #include <ql/math/solvers1d/brent.hpp>
 #include <ql/pricingengines/blackformula.hpp>
 #include <ql/pricingengines/credit/midpointcdsengine.hpp>
@@ -37,6 +36,109 @@ using namespace QuantLib;
 
 namespace QuantExt {
 
+namespace {
+
+// the default-adjusted index value Vc using a continuous annuity, for the terminal spread s
+Real indexValue(Real t, Real T, Real r, Real R, Real c, Real s) {
+    Real w = (s / (1.0 - R) + r) * (T - t);
+    Real a = (T - t);
+    if (std::abs(w) < 1.0E-6)
+        a *= 1.0 - 0.5 * w + 1.0 / 6.0 * w * w - 1.0 / 24.0 * w * w * w;
+    else
+        a *= (1.0 - std::exp(-w)) / w;
+    return (s - c) * a;
+}
+
+// composite Simpson rule for the values g on the equidistant nodes i0, ..., i1, if the number of intervals is odd the
+// 3/8 rule is used for the first three intervals
+Real simpson(const std::vector<Real>& g, Size i0, Size i1, Real h) {
+    if (i1 <= i0)
+        return 0.0;
+    if (i1 - i0 == 1)
+        return 0.5 * h * (g[i0] + g[i1]);
+    Real sum = 0.0;
+    if ((i1 - i0) % 2 == 1) {
+        sum += 3.0 / 8.0 * h * (g[i0] + 3.0 * g[i0 + 1] + 3.0 * g[i0 + 2] + g[i0 + 3]);
+        i0 += 3;
+    }
+    for (Size i = i0; i < i1; i += 2)
+        sum += h / 3.0 * (g[i] + 4.0 * g[i + 1] + g[i + 2]);
+    return sum;
+}
+
+// max number of cached calibrations, the cache is cleared when it is reached
+constexpr Size maxCachedCalibrations = 1000;
+
+} // namespace
+
+const NumericalIntegrationIndexCdsOptionEngine::NormalGrid& NumericalIntegrationIndexCdsOptionEngine::normalGrid() {
+    static const NormalGrid grid = []() {
+        NormalGrid g;
+        const Size n = 2001;
+        g.h = 20.0 / static_cast<Real>(n - 1);
+        g.x.resize(n);
+        g.density.resize(n);
+        for (Size k = 0; k < n; ++k) {
+            g.x[k] = -10.0 + static_cast<Real>(k) * g.h;
+            g.density[k] = std::exp(-0.5 * g.x[k] * g.x[k]) / boost::math::constants::root_two_pi<Real>();
+        }
+        return g;
+    }();
+    return grid;
+}
+
+const NumericalIntegrationIndexCdsOptionEngine::IndexValues&
+NumericalIntegrationIndexCdsOptionEngine::calibratedIndexValues(Real exerciseTime, Real maturityTime,
+                                                                Real averageInterestRate, Real stdDev,
+                                                                Real forwardPrice) const {
+
+    Real runningSpread = arguments_.swap->runningSpread();
+    CalibrationKey key(exerciseTime, maturityTime, averageInterestRate, indexRecovery_, runningSpread, stdDev,
+                       forwardPrice);
+    auto cached = calibrations_.find(key);
+    if (cached != calibrations_.end())
+        return cached->second;
+
+    // the terminal spread on the nodes is m times the lognormal factors, the expectation of the index value is
+    // computed with the trapezoidal rule, which converges fast for the smooth and rapidly decaying integrand
+
+    const NormalGrid& grid = normalGrid();
+    Size n = grid.x.size();
+    std::vector<Real> factors(n), values(n);
+    for (Size k = 0; k < n; ++k)
+        factors[k] = std::exp(-0.5 * stdDev * stdDev + stdDev * grid.x[k]);
+
+    auto fillValues = [this, exerciseTime, maturityTime, averageInterestRate, runningSpread, n, &factors,
+                       &values](Real m) {
+        for (Size k = 0; k < n; ++k)
+            values[k] = indexValue(exerciseTime, maturityTime, averageInterestRate, indexRecovery_, runningSpread,
+                                   m * factors[k]);
+    };
+
+    auto target = [&fillValues, &grid, &values, n, forwardPrice](Real m) {
+        fillValues(m);
+        Real sum = 0.5 * (values.front() * grid.density.front() + values.back() * grid.density.back());
+        for (Size k = 1; k + 1 < n; ++k)
+            sum += values[k] * grid.density[k];
+        return sum * grid.h - (1.0 - forwardPrice);
+    };
+
+    IndexValues result;
+    Brent brent;
+    brent.setLowerBound(1.0E-8);
+    try {
+        result.fepAdjustedForwardSpread = brent.solve(target, 1.0E-7, arguments_.swap->fairSpreadClean(), 0.0001);
+    } catch (const std::exception& e) {
+        QL_FAIL("NumericalIntegrationIndexCdsOptionEngine::doCalc(): failed to calibrate forward spread: " << e.what());
+    }
+    fillValues(result.fepAdjustedForwardSpread);
+    result.values = std::move(values);
+
+    if (calibrations_.size() >= maxCachedCalibrations)
+        calibrations_.clear();
+    return calibrations_.emplace(key, std::move(result)).first->second;
+}
+
 void NumericalIntegrationIndexCdsOptionEngine::doCalc() const {
 
     // checks
@@ -193,93 +295,75 @@ void NumericalIntegrationIndexCdsOptionEngine::doCalc() const {
         results_.additionalResults["fepAdjustedForwardPrice"] = forwardPrice;
         results_.additionalResults["forwardPrice"] = forwardPriceExclFep;
 
-        // the default-adjusted index value Vc using a continuous annuity
-
-        auto Vc = [](Real t, Real T, Real r, Real R, Real c, Real stdDev, Real m, Real x) {
-            Real s = m * std::exp(-0.5 * stdDev * stdDev + stdDev * x);
-            Real w = (s / (1.0 - R) + r) * (T - t);
-            Real a = (T - t);
-            if (std::abs(w) < 1.0E-6)
-                a *= 1.0 - 0.5 * w + 1.0 / 6.0 * w * w - 1.0 / 24.0 * w * w * w;
-            else
-                a *= (1.0 - std::exp(-w)) / w;
-            return (s - c) * a;
-        };
-
-        // calibrate the default-adjusted forward spread m to the forward price
-
-        SimpsonIntegral simpson = SimpsonIntegral(1.0E-7, 100);
+        // calibrate the default-adjusted forward spread m to the forward price, the calibration and the index values
+        // on the quadrature nodes only depend on the expiry, the underlying and the volatility, so they are shared
+        // between the strikes and trades priced with this engine
 
-        auto target = [this, &Vc, &simpson, exerciseTime, maturityTime, averageInterestRate, stdDev,
-                       forwardPrice](Real m) {
-            return simpson(
-                       [this, &Vc, exerciseTime, maturityTime, averageInterestRate, stdDev, m](Real x) {
-                           return Vc(exerciseTime, maturityTime, averageInterestRate, indexRecovery_,
-                                     arguments_.swap->runningSpread(), stdDev, m, x) *
-                                  std::exp(-0.5 * x * x) / boost::math::constants::root_two_pi<Real>();
-                       },
-                       -10.0, 10.0) -
-                   (1.0 - forwardPrice);
-        };
-
-        Real fepAdjustedForwardSpread;
-        Brent brent;
-        brent.setLowerBound(1.0E-8);
-        try {
-            fepAdjustedForwardSpread = brent.solve(target, 1.0E-7, arguments_.swap->fairSpreadClean(), 0.0001);
-        } catch (const std::exception& e) {
-            QL_FAIL(
-                "NumericalIntegrationIndexCdsOptionEngine::doCalc(): failed to calibrate forward spread: " << e.what());
-        }
+        const NormalGrid& grid = normalGrid();
+        const IndexValues& indexValues = calibratedIndexValues(exerciseTime, maturityTime, averageInterestRate,
+                                                               stdDev, forwardPrice);
+        Real fepAdjustedForwardSpread = indexValues.fepAdjustedForwardSpread;
         results_.additionalResults["fepAdjustedForwardSpread"] = fepAdjustedForwardSpread;
         results_.additionalResults["forwardSpread"] = arguments_.swap->fairSpreadClean();
 
-        // find the exercise boundary
+        // the payoff on the quadrature nodes
+
+        Real payoffAdjustment = strikeAdjustment + arguments_.realisedFep / arguments_.swap->notional();
+        Size n = grid.x.size();
+        std::vector<Real> payoff(n);
+        for (Size k = 0; k < n; ++k)
+            payoff[k] = omega * (indexValues.values[k] + payoffAdjustment) * grid.density[k];
 
-        auto payoff = [this, &Vc, exerciseTime, maturityTime, averageInterestRate, stdDev, fepAdjustedForwardSpread,
-                       strikeAdjustment](Real x) {
-            return (Vc(exerciseTime, maturityTime, averageInterestRate, indexRecovery_,
-                       arguments_.swap->runningSpread(), stdDev, fepAdjustedForwardSpread, x) +
-                    strikeAdjustment + arguments_.realisedFep / arguments_.swap->notional()) *
-                   std::exp(-0.5 * x * x) / boost::math::constants::root_two_pi<Real>();
+        auto payoffAt = [this, exerciseTime, maturityTime, averageInterestRate, stdDev, fepAdjustedForwardSpread,
+                         payoffAdjustment](Real x) {
+            return indexValue(exerciseTime, maturityTime, averageInterestRate, indexRecovery_,
+                              arguments_.swap->runningSpread(),
+                              fepAdjustedForwardSpread * std::exp(-0.5 * stdDev * stdDev + stdDev * x)) +
+                   payoffAdjustment;
         };
 
-        Real exerciseBoundary;
-        Brent brent2;
-        try {
-            exerciseBoundary = brent2.solve(payoff, 1.0E-7, 0.0, 0.0001);
-        } catch (const std::exception& e) {
-            QL_FAIL(
-                "NumericalIntegrationIndexCdsOptionEngine::doCalc(): failed to find exercise boundary: " << e.what());
+        // find the exercise boundary, bracketed by the first sign change of the payoff on the nodes
+
+        Size k = 0;
+        while (k + 1 < n && (payoff[k] > 0.0) == (payoff[k + 1] > 0.0))
+            ++k;
+
+        Real exerciseBoundary, optionValue;
+        if (k + 1 == n) {
+            // the option is exercised on the whole grid or nowhere
+            bool exercised = payoff.front() > 0.0;
+            exerciseBoundary = exercised == (omega > 0.0) ? grid.x.front() : grid.x.back();
+            optionValue = exercised ? simpson(payoff, 0, n - 1, grid.h) : 0.0;
+        } else {
+            Brent brent;
+            try {
+                exerciseBoundary =
+                    brent.solve(payoffAt, 1.0E-7, 0.5 * (grid.x[k] + grid.x[k + 1]), grid.x[k], grid.x[k + 1]);
+            } catch (const std::exception& e) {
+                QL_FAIL("NumericalIntegrationIndexCdsOptionEngine::doCalc(): failed to find exercise boundary: "
+                        << e.what());
+            }
+            // integrate the nodes in the exercise region and the part of the crossing interval in it, the payoff
+            // vanishes at the exercise boundary
+            auto density = [](Real x) { return std::exp(-0.5 * x * x) / boost::math::constants::root_two_pi<Real>(); };
+            if (payoff[k + 1] > 0.0) {
+                Real mid = 0.5 * (exerciseBoundary + grid.x[k + 1]);
+                optionValue = (grid.x[k + 1] - exerciseBoundary) / 6.0 *
+                                  (4.0 * omega * payoffAt(mid) * density(mid) + payoff[k + 1]) +
+                              simpson(payoff, k + 1, n - 1, grid.h);
+            } else {
+                Real mid = 0.5 * (grid.x[k] + exerciseBoundary);
+                optionValue = simpson(payoff, 0, k, grid.h) +
+                              (exerciseBoundary - grid.x[k]) / 6.0 *
+                                  (payoff[k] + 4.0 * omega * payoffAt(mid) * density(mid));
+            }
         }
         results_.additionalResults["exerciseBoundary"] =
             fepAdjustedForwardSpread * std::exp(-0.5 * stdDev * stdDev + stdDev * exerciseBoundary);
 
         // compute the option value
 
-        Real lowerIntegrationBound = -10.0, upperIntegrationBound = 10.0;
-        if (arguments_.swap->side() == Protection::Buyer) {
-            lowerIntegrationBound = exerciseBoundary;
-        } else {
-            upperIntegrationBound = exerciseBoundary;
-        }
-
-        try {
-            results_.value = arguments_.swap->notional() * discTradeCollToExercise *
-                             simpson(
-                                 [exerciseTime, maturityTime, averageInterestRate, this, stdDev,
-                                  fepAdjustedForwardSpread, omega, strikeAdjustment, &Vc](Real x) {
-                                     return omega *
-                                            (Vc(exerciseTime, maturityTime, averageInterestRate, indexRecovery_,
-                                                arguments_.swap->runningSpread(), stdDev, fepAdjustedForwardSpread, x) +
-                                             strikeAdjustment + arguments_.realisedFep / arguments_.swap->notional()) *
-                                            std::exp(-0.5 * x * x) / boost::math::constants::root_two_pi<Real>();
-                                 },
-                                 lowerIntegrationBound, upperIntegrationBound);
-        } catch (const std::exception& e) {
-            QL_FAIL(
-                "NumericalIntegrationIndexCdsOptionEngine::doCalc(): failed to compute option payoff: " << e.what());
-        }
+        results_.value = arguments_.swap->notional() * discTradeCollToExercise * optionValue;
 
     } // handle 2 spread vol model type
 
@@ -24,6 +24,10 @@
 
 #include <qle/pricingengines/indexcdsoptionbaseengine.hpp>
 
+#include <map>
+#include <tuple>
+#include <vector>
+
 namespace QuantExt {
 
 class NumericalIntegrationIndexCdsOptionEngine : public QuantExt::IndexCdsOptionBaseEngine {
@@ -33,6 +37,26 @@ public:
 private:
     void doCalc() const override;
     Real forwardRiskyAnnuityStrike(const Real strike) const;
+
+    /* The payoff is integrated over a fixed grid of standard normal nodes. The calibrated forward spread and the
+       index values on the nodes depend on the expiry, the underlying and the volatility only, they are cached by
+       these inputs and shared between all strikes and trades priced with the engine. */
+    struct NormalGrid {
+        Real h;
+        std::vector<Real> x, density;
+    };
+    struct IndexValues {
+        Real fepAdjustedForwardSpread;
+        std::vector<Real> values;
+    };
+    // exercise time, maturity time, average interest rate, recovery, running spread, std dev, forward price
+    typedef std::tuple<Real, Real, Real, Real, Real, Real, Real> CalibrationKey;
+
+    static const NormalGrid& normalGrid();
+    const IndexValues& calibratedIndexValues(Real exerciseTime, Real maturityTime, Real averageInterestRate,
+                                             Real stdDev, Real forwardPrice) const;
+
+    mutable std::map<CalibrationKey, IndexValues> calibrations_;
 };
 
 } // namespace QuantExt
@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/math/salvagedmatrixcache.hpp>
 #include <qle/models/crossassetanalytics.hpp>
 #include <qle/models/crossassetmodel.hpp>
 
@@ -24,6 +25,7 @@
 
 #include <boost/make_shared.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace QuantExt {
@@ -90,7 +92,7 @@ void CrossAssetStateProcess::flushCache() const {
 void CrossAssetStateProcess::updateSqrtCorrelation() const {
     if (model_->discretization() != CrossAssetModel::Discretization::Euler)
         return;
-    sqrtCorrelation_ = pseudoSqrt(model_->correlation(), model_->salvagingAlgorithm());
+    sqrtCorrelation_ = cachedPseudoSqrt(model_->correlation(), model_->salvagingAlgorithm());
 }
 
 Array CrossAssetStateProcess::initialValues() const {
@@ -559,6 +561,36 @@ Array CrossAssetStateProcess::evolve(Time t0, const Array& x0, Time dt, const Ar
     return res;
 }
 
+void CrossAssetStateProcess::evolveBlock(const TimeGrid& grid, Size step, const Matrix& x0, const Matrix& dw,
+                                         Matrix& x1) const {
+    QL_REQUIRE(step + 1 < grid.size(), "CrossAssetStateProcess::evolveBlock(): step " << step
+                                                                                      << " out of range, grid has "
+                                                                                      << grid.size() << " points");
+    QL_REQUIRE(&x0 != &x1, "CrossAssetStateProcess::evolveBlock(): x0 and x1 must be different matrices");
+    QL_REQUIRE(x0.columns() == dw.columns(), "CrossAssetStateProcess::evolveBlock(): x0 has "
+                                                 << x0.columns() << " samples, dw has " << dw.columns());
+
+    if (cirppCount_ == 0 &&
+        model_->modelType(CrossAssetModel::AssetType::IR, 0) != CrossAssetModel::ModelType::HW &&
+        model_->discretization() == CrossAssetModel::Discretization::Exact) {
+        if (auto exact = boost::dynamic_pointer_cast<CrossAssetStateProcess::ExactDiscretization>(discretization_)) {
+            exact->evolveBlock(*this, grid, step, x0, dw, x1);
+            return;
+        }
+    }
+
+    Time t0 = grid[step], dt = grid.dt(step);
+    if (x1.rows() != size() || x1.columns() != x0.columns())
+        x1 = Matrix(size(), x0.columns());
+    Array x(x0.rows()), w(dw.rows());
+    for (Size l = 0; l < x0.columns(); ++l) {
+        std::copy(x0.column_begin(l), x0.column_end(l), x.begin());
+        std::copy(dw.column_begin(l), dw.column_end(l), w.begin());
+        Array r = evolve(t0, x, dt, w);
+        std::copy(r.begin(), r.end(), x1.column_begin(l));
+    }
+}
+
 CrossAssetStateProcess::ExactDiscretization::ExactDiscretization(const CrossAssetModel* const model,
                                                                  SalvagingAlgorithm::Type salvaging)
     : model_(model), salvaging_(salvaging) {
@@ -590,7 +622,7 @@ Matrix CrossAssetStateProcess::ExactDiscretization::diffusion(const StochasticPr
     cache_key k = {t0, dt};
     auto i = cache_d_.find(k);
     if (i == cache_d_.end()) {
-        Matrix res = pseudoSqrt(covariance(p, t0, x0, dt), salvaging_);
+        Matrix res = cachedPseudoSqrt(covariance(p, t0, x0, dt), salvaging_);
         // note that covariance actually does not depend on x0
         cache_d_.insert(std::make_pair(k, res));
         return res;
@@ -954,6 +986,67 @@ void CrossAssetStateProcess::ExactDiscretization::flushCache() const {
     cache_m_.clear();
     cache_v_.clear();
     cache_d_.clear();
+    stepCacheGrid_.clear();
+    stepCache_.clear();
+}
+
+const CrossAssetStateProcess::ExactDiscretization::StepCoefficients&
+CrossAssetStateProcess::ExactDiscretization::stepCoefficients(const StochasticProcess& p, const TimeGrid& grid,
+                                                              Size step) const {
+    if (stepCacheGrid_.size() != grid.size() || !std::equal(grid.begin(), grid.end(), stepCacheGrid_.begin())) {
+        stepCacheGrid_.assign(grid.begin(), grid.end());
+        stepCache_.assign(grid.size() - 1, StepCoefficients());
+    }
+    StepCoefficients& c = stepCache_[step];
+    if (c.m.empty()) {
+        Time t0 = grid[step], dt = grid.dt(step);
+        Size n = model_->dimension();
+        Array x0(n, 0.0);
+        c.m = driftImpl1(p, t0, x0, dt);
+        // the state dependent part of the conditional expectation is linear in x0
+        c.a = Matrix(n, n, 0.0);
+        for (Size j = 0; j < n; ++j) {
+            x0[j] = 1.0;
+            Array col = driftImpl2(p, t0, x0, dt);
+            std::copy(col.begin(), col.end(), c.a.column_begin(j));
+            x0[j] = 0.0;
+        }
+        c.d = cachedPseudoSqrt(covarianceImpl(p, t0, x0, dt), salvaging_);
+    }
+    return c;
+}
+
+void CrossAssetStateProcess::ExactDiscretization::evolveBlock(const StochasticProcess& p, const TimeGrid& grid,
+                                                              Size step, const Matrix& x0, const Matrix& dw,
+                                                              Matrix& x1) const {
+    const StepCoefficients& c = stepCoefficients(p, grid, step);
+    Size n = c.m.size(), samples = x0.columns();
+    QL_REQUIRE(x0.rows() == n, "ExactDiscretization::evolveBlock(): x0 has " << x0.rows() << " rows, expected " << n);
+    QL_REQUIRE(dw.rows() == c.d.columns(),
+               "ExactDiscretization::evolveBlock(): dw has " << dw.rows() << " rows, expected " << c.d.columns());
+    if (x1.rows() != n || x1.columns() != samples)
+        x1 = Matrix(n, samples);
+    // row wise accumulation, so that the inner loops run over contiguous samples
+    for (Size i = 0; i < n; ++i) {
+        Real* r = x1.row_begin(i);
+        std::fill(r, r + samples, c.m[i]);
+        for (Size k = 0; k < n; ++k) {
+            Real a = c.a[i][k];
+            if (a == 0.0)
+                continue;
+            const Real* s = x0.row_begin(k);
+            for (Size l = 0; l < samples; ++l)
+                r[l] += a * s[l];
+        }
+        for (Size k = 0; k < c.d.columns(); ++k) {
+            Real d = c.d[i][k];
+            if (d == 0.0)
+                continue;
+            const Real* s = dw.row_begin(k);
+            for (Size l = 0; l < samples; ++l)
+                r[l] += d * s[l];
+        }
+    }
 }
 
 } // namespace QuantExt
@@ -27,6 +27,7 @@
 
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
 #include <ql/stochasticprocess.hpp>
+#include <ql/timegrid.hpp>
 
 #include <boost/unordered_map.hpp>
 
@@ -54,6 +55,13 @@ public:
     /*! specific members */
     virtual void flushCache() const;
 
+    /*! Evolves a block of paths over the step [grid[step], grid[step+1]]. The states x0, x1 and the variates dw are
+        given in structure of arrays layout, i.e. one row per state variable resp. factor and one column per sample.
+        With the exact discretization the step is applied as x1 = m + A x0 + D dw with the conditional expectation
+        m + A x0 and the square root D of the covariance, which are cached per step of the grid. Otherwise the
+        paths are evolved one by one via evolve(). x1 is resized if necessary and must not be x0. */
+    void evolveBlock(const TimeGrid& grid, Size step, const Matrix& x0, const Matrix& dw, Matrix& x1) const;
+
 protected:
     virtual Matrix diffusionOnCorrelatedBrownians(Time t, const Array& x) const;
     virtual Matrix diffusionOnCorrelatedBrowniansImpl(Time t, const Array& x) const;
@@ -74,6 +82,8 @@ protected:
         virtual Matrix diffusion(const StochasticProcess&, Time t0, const Array& x0, Time dt) const override;
         virtual Matrix covariance(const StochasticProcess&, Time t0, const Array& x0, Time dt) const override;
         void flushCache() const;
+        void evolveBlock(const StochasticProcess&, const TimeGrid& grid, Size step, const Matrix& x0,
+                         const Matrix& dw, Matrix& x1) const;
 
     protected:
         virtual Array driftImpl1(const StochasticProcess&, Time t0, const Array& x0, Time dt) const;
@@ -99,6 +109,15 @@ protected:
         };
         mutable boost::unordered_map<cache_key, Array, cache_hasher> cache_m_;
         mutable boost::unordered_map<cache_key, Matrix, cache_hasher> cache_v_, cache_d_;
+
+        // cache for the block evolution, indexed by the step of the grid, an empty m marks a step not yet computed
+        struct StepCoefficients {
+            Array m;
+            Matrix a, d;
+        };
+        const StepCoefficients& stepCoefficients(const StochasticProcess& p, const TimeGrid& grid, Size step) const;
+        mutable std::vector<Time> stepCacheGrid_;
+        mutable std::vector<StepCoefficients> stepCache_;
     }; // ExactDiscretization
 
     // cache for process drift and diffusion (e.g. used in Euler discretization)
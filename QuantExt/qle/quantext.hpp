@@ -40,6 +40,7 @@
 #include <qle/cashflows/commoditycashflow.hpp>
 #include <qle/cashflows/commodityindexedaveragecashflow.hpp>
 #include <qle/cashflows/commodityindexedcashflow.hpp>
+#include <qle/cashflows/compiledleg.hpp>
 #include <qle/cashflows/couponpricer.hpp>
 #include <qle/cashflows/cpicoupon.hpp>
 #include <qle/cashflows/cpicouponpricer.hpp>
@@ -210,7 +211,9 @@
 #include <qle/instruments/tenorbasisswap.hpp>
 #include <qle/instruments/vanillaforwardoption.hpp>
 #include <qle/instruments/varianceswap.hpp>
+#include <qle/instruments/zeroratedependencies.hpp>
 #include <qle/interpolators/optioninterpolator2d.hpp>
+#include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/blockmatrixinverse.hpp>
 #include <qle/math/bucketeddistribution.hpp>
 #include <qle/math/computeenvironment.hpp>
@@ -225,14 +228,23 @@
 #include <qle/math/logquadraticinterpolation.hpp>
 #include <qle/math/matrixfunctions.hpp>
 #include <qle/math/method_mt.hpp>
+#include <qle/math/multidevicecontext.hpp>
 #include <qle/math/nadarayawatson.hpp>
 #include <qle/math/openclenvironment.hpp>
+#include <qle/math/philoxrsg.hpp>
 #include <qle/math/problem_mt.hpp>
 #include <qle/math/quadraticinterpolation.hpp>
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_expression.hpp>
 #include <qle/math/randomvariable_io.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_pool.hpp>
+#include <qle/math/randomvariable_tape.hpp>
+#include <qle/math/salvagedmatrixcache.hpp>
+#include <qle/math/sparselu.hpp>
 #include <qle/math/stabilisedglls.hpp>
+#include <qle/math/tailstatistics.hpp>
 #include <qle/math/trace.hpp>
 #include <qle/methods/brownianbridgepathinterpolator.hpp>
 #include <qle/methods/fdmdefaultableequityjumpdiffusionfokkerplanckop.hpp>
@@ -245,6 +257,7 @@
 #include <qle/methods/projectedbufferedmultipathgeneratorfactory.hpp>
 #include <qle/methods/projectedvariatemultipathgenerator.hpp>
 #include <qle/methods/projectedvariatepathgeneratorfactory.hpp>
+#include <qle/methods/streamingmultipathgenerator.hpp>
 #include <qle/models/annuitymapping.hpp>
 #include <qle/models/basket.hpp>
 #include <qle/models/blackscholesmodelwrapper.hpp>
@@ -289,6 +302,7 @@
 #include <qle/models/gaussianlhplossmodel.hpp>
 #include <qle/models/homogeneouspooldef.hpp>
 #include <qle/models/hullwhitebucketing.hpp>
+#include <qle/models/hwbatchsimulator.hpp>
 #include <qle/models/hwconstantparametrization.hpp>
 #include <qle/models/hwmodel.hpp>
 #include <qle/models/hwparametrization.hpp>
@@ -330,6 +344,7 @@
 #include <qle/models/zeroinflationmodeltermstructure.hpp>
 #include <qle/pricingengines/accrualbondrepoengine.hpp>
 #include <qle/pricingengines/amccalculator.hpp>
+#include <qle/pricingengines/analyticbarrierbatch.hpp>
 #include <qle/pricingengines/analyticbarrierengine.hpp>
 #include <qle/pricingengines/analyticcashsettledeuropeanengine.hpp>
 #include <qle/pricingengines/analyticcclgmfxoptionengine.hpp>
@@ -387,6 +402,7 @@
 #include <qle/pricingengines/mclgmswaptionengine.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
 #include <qle/pricingengines/mcmultilegoptionengine.hpp>
+#include <qle/pricingengines/mcmultilegpathcache.hpp>
 #include <qle/pricingengines/midpointcdoengine.hpp>
 #include <qle/pricingengines/midpointcdsenginemultistate.hpp>
 #include <qle/pricingengines/midpointindexcdsengine.hpp>
@@ -430,6 +446,8 @@
 #include <qle/termstructures/blackvolsurfacewithatm.hpp>
 #include <qle/termstructures/bondyieldshiftedcurvetermstructure.hpp>
 #include <qle/termstructures/brlcdiratehelper.hpp>
+#include <qle/termstructures/cachedoptionletvolatility.hpp>
+#include <qle/termstructures/cachedswaptionvolatility.hpp>
 #include <qle/termstructures/capfloorhelper.hpp>
 #include <qle/termstructures/capfloortermvolcurve.hpp>
 #include <qle/termstructures/capfloortermvolsurface.hpp>
@@ -51,13 +51,20 @@ void BlackVarianceSurfaceMoneyness::update() {
 }
 
 void BlackVarianceSurfaceMoneyness::performCalculations() const {
+    // only update the interpolation if a variance has changed, e.g. not after a spot move only
+    bool changed = false;
     for (Size j = 1; j < variances_.columns(); j++) {
         for (Size i = 0; i < variances_.rows(); i++) {
             Real vol = quotes_[i][j - 1]->value();
-            variances_[i][j] = times_[j] * vol * vol;
+            Real variance = times_[j] * vol * vol;
+            if (variance != variances_[i][j]) {
+                variances_[i][j] = variance;
+                changed = true;
+            }
         }
     }
-    varianceSurface_.update();
+    if (changed)
+        varianceSurface_.update();
 }
 
 void BlackVarianceSurfaceMoneyness::init() {
@@ -123,8 +123,17 @@ BlackVolatilitySurfaceDelta::BlackVolatilitySurfaceDelta(
     registerWith(foreignTS_);
 }
 
+void BlackVolatilitySurfaceDelta::update() {
+    smiles_.clear();
+    BlackVolatilityTermStructure::update();
+}
+
 boost::shared_ptr<FxSmileSection> BlackVolatilitySurfaceDelta::blackVolSmile(Time t) const {
 
+    auto cached = smiles_.find(t);
+    if (cached != smiles_.end())
+        return cached->second;
+
     Real spot = spot_->value();
     DiscountFactor dDiscount = domesticTS_->discount(t);
     DiscountFactor fDiscount = foreignTS_->discount(t);
@@ -199,14 +208,17 @@ boost::shared_ptr<FxSmileSection> BlackVolatilitySurfaceDelta::blackVolSmile(Tim
     // now build smile from strikes and vols
     QL_REQUIRE(!vols.empty(),
                "BlackVolatilitySurfaceDelta::blackVolSmile(" << t << "): no strikes given, this is unexpected.");
+    boost::shared_ptr<FxSmileSection> smile;
     if (vols.size() == 1) {
         // handle the situation that we only have one strike (might occur for e.g. t=0)
-        return boost::make_shared<ConstantSmileSection>(vols.front());
+        smile = boost::make_shared<ConstantSmileSection>(vols.front());
     } else {
         // we have at least two strikes
-        return boost::make_shared<InterpolatedSmileSection>(spot, dDiscount, fDiscount, t, strikes, vols,
-                                                            interpolationMethod_, flatExtrapolation_);
+        smile = boost::make_shared<InterpolatedSmileSection>(spot, dDiscount, fDiscount, t, strikes, vols,
+                                                             interpolationMethod_, flatExtrapolation_);
     }
+    smiles_[t] = smile;
+    return smile;
 }
 
 boost::shared_ptr<FxSmileSection> BlackVolatilitySurfaceDelta::blackVolSmile(const Date& d) const {
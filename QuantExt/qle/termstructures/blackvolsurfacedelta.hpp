@@ -35,6 +35,8 @@
 #include <ql/time/daycounter.hpp>
 #include <qle/termstructures/fxsmilesection.hpp>
 
+#include <map>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -112,6 +114,10 @@ public:
     //@{
     virtual void accept(AcyclicVisitor&) override;
     //@}
+    //! \name Observer interface
+    //@{
+    void update() override;
+    //@}
 
     //! \name Inspectors
     //@{
@@ -122,6 +128,9 @@ public:
     /*! Note the smile does not observe the spot or YTS handles, it will
      *  not update when they change.
      *
+     *  The smiles are cached by time until the surface is notified of a change of the spot or the YTS, so
+     *  that the delta to strike conversions are not repeated for each volatility lookup.
+     *
      *  This is not really FX specific
      */
     boost::shared_ptr<FxSmileSection> blackVolSmile(Time t) const;
@@ -159,6 +168,8 @@ private:
 
     // calculate forward for time $t$
     Real forward(Time t) const;
+
+    mutable std::map<Time, boost::shared_ptr<FxSmileSection> > smiles_;
 };
 
 // inline definitions
@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/termstructures/cachedoptionletvolatility.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+CachedOptionletVolatility::CachedOptionletVolatility(const Handle<OptionletVolatilityStructure>& baseVol)
+    : baseVol_(baseVol) {
+    registerWith(baseVol_);
+    enableExtrapolation(baseVol->allowsExtrapolation());
+}
+
+void CachedOptionletVolatility::update() {
+    timeCache_.clear();
+    dateCache_.clear();
+    OptionletVolatilityStructure::update();
+}
+
+void CachedOptionletVolatility::deepUpdate() {
+    baseVol_->deepUpdate();
+    update();
+}
+
+boost::shared_ptr<SmileSection> CachedOptionletVolatility::smileSectionImpl(const Date& optionDate) const {
+    return baseVol_->smileSection(optionDate, true);
+}
+
+boost::shared_ptr<SmileSection> CachedOptionletVolatility::smileSectionImpl(Time optionTime) const {
+    return baseVol_->smileSection(optionTime, true);
+}
+
+Volatility CachedOptionletVolatility::volatilityImpl(const Date& optionDate, Rate strike) const {
+    auto key = std::make_pair(optionDate.serialNumber(), strike);
+    auto v = dateCache_.find(key);
+    if (v == dateCache_.end())
+        v = dateCache_.insert(std::make_pair(key, baseVol_->volatility(optionDate, strike, true))).first;
+    return v->second;
+}
+
+Volatility CachedOptionletVolatility::volatilityImpl(Time optionTime, Rate strike) const {
+    auto key = std::make_pair(optionTime, strike);
+    auto v = timeCache_.find(key);
+    if (v == timeCache_.end())
+        v = timeCache_.insert(std::make_pair(key, baseVol_->volatility(optionTime, strike, true))).first;
+    return v->second;
+}
+
+} // namespace QuantExt
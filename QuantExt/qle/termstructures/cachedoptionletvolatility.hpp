@@ -0,0 +1,87 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/termstructures/cachedoptionletvolatility.hpp
+    \brief optionlet volatility structure caching the volatility lookups of an underlying structure
+    \ingroup termstructures
+*/
+
+#pragma once
+
+#include <ql/termstructures/volatility/optionlet/optionletvolatilitystructure.hpp>
+
+#include <map>
+#include <utility>
+
+namespace QuantExt {
+
+//! Optionlet volatility structure caching the volatility lookups of an underlying structure
+/*! The volatilities are cached by expiry and strike. The cache is cleared whenever the underlying structure notifies
+    an update or deepUpdate() is called, see CachedSwaptionVolatility. Smile sections are not cached.
+
+    \ingroup termstructures
+*/
+class CachedOptionletVolatility : public QuantLib::OptionletVolatilityStructure {
+public:
+    explicit CachedOptionletVolatility(const QuantLib::Handle<QuantLib::OptionletVolatilityStructure>& baseVol);
+
+    //! \name TermStructure interface
+    //@{
+    QuantLib::DayCounter dayCounter() const override { return baseVol_->dayCounter(); }
+    QuantLib::Date maxDate() const override { return baseVol_->maxDate(); }
+    QuantLib::Time maxTime() const override { return baseVol_->maxTime(); }
+    const QuantLib::Date& referenceDate() const override { return baseVol_->referenceDate(); }
+    QuantLib::Calendar calendar() const override { return baseVol_->calendar(); }
+    QuantLib::Natural settlementDays() const override { return baseVol_->settlementDays(); }
+    //@}
+    //! \name VolatilityTermStructure interface
+    //@{
+    QuantLib::BusinessDayConvention businessDayConvention() const override {
+        return baseVol_->businessDayConvention();
+    }
+    QuantLib::Rate minStrike() const override { return baseVol_->minStrike(); }
+    QuantLib::Rate maxStrike() const override { return baseVol_->maxStrike(); }
+    //@}
+    //! \name OptionletVolatilityStructure interface
+    //@{
+    QuantLib::VolatilityType volatilityType() const override { return baseVol_->volatilityType(); }
+    QuantLib::Real displacement() const override { return baseVol_->displacement(); }
+    //@}
+    //! \name Observer interface
+    //@{
+    void update() override;
+    void deepUpdate() override;
+    //@}
+    //! \name Inspectors
+    //@{
+    const QuantLib::Handle<QuantLib::OptionletVolatilityStructure>& baseVol() const { return baseVol_; }
+    QuantLib::Size cacheSize() const { return timeCache_.size() + dateCache_.size(); }
+    //@}
+
+protected:
+    boost::shared_ptr<QuantLib::SmileSection> smileSectionImpl(const QuantLib::Date& optionDate) const override;
+    boost::shared_ptr<QuantLib::SmileSection> smileSectionImpl(QuantLib::Time optionTime) const override;
+    QuantLib::Volatility volatilityImpl(const QuantLib::Date& optionDate, QuantLib::Rate strike) const override;
+    QuantLib::Volatility volatilityImpl(QuantLib::Time optionTime, QuantLib::Rate strike) const override;
+
+private:
+    QuantLib::Handle<QuantLib::OptionletVolatilityStructure> baseVol_;
+    mutable std::map<std::pair<QuantLib::Time, QuantLib::Rate>, QuantLib::Volatility> timeCache_;
+    mutable std::map<std::pair<QuantLib::Date::serial_type, QuantLib::Rate>, QuantLib::Volatility> dateCache_;
+};
+
+} // namespace QuantExt
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <qle/termstructures/cachedswaptionvolatility.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+CachedSwaptionVolatility::CachedSwaptionVolatility(const Handle<SwaptionVolatilityStructure>& baseVol)
+    : SwaptionVolatilityStructure(baseVol->businessDayConvention(), baseVol->dayCounter()), baseVol_(baseVol) {
+    registerWith(baseVol_);
+    enableExtrapolation(baseVol->allowsExtrapolation());
+}
+
+void CachedSwaptionVolatility::update() {
+    timeCache_.clear();
+    dateCache_.clear();
+    SwaptionVolatilityStructure::update();
+}
+
+void CachedSwaptionVolatility::deepUpdate() {
+    baseVol_->deepUpdate();
+    update();
+}
+
+boost::shared_ptr<SmileSection> CachedSwaptionVolatility::smileSectionImpl(const Date& optionDate,
+                                                                           const Period& swapTenor) const {
+    return baseVol_->smileSection(optionDate, swapTenor, true);
+}
+
+boost::shared_ptr<SmileSection> CachedSwaptionVolatility::smileSectionImpl(Time optionTime, Time swapLength) const {
+    return baseVol_->smileSection(optionTime, swapLength, true);
+}
+
+Volatility CachedSwaptionVolatility::volatilityImpl(const Date& optionDate, const Period& swapTenor,
+                                                    Rate strike) const {
+    auto key = std::make_tuple(optionDate.serialNumber(), swapLength(swapTenor), strike);
+    auto v = dateCache_.find(key);
+    if (v == dateCache_.end())
+        v = dateCache_.insert(std::make_pair(key, baseVol_->volatility(optionDate, swapTenor, strike, true))).first;
+    return v->second;
+}
+
+Volatility CachedSwaptionVolatility::volatilityImpl(Time optionTime, Time swapLength, Rate strike) const {
+    auto key = std::make_tuple(optionTime, swapLength, strike);
+    auto v = timeCache_.find(key);
+    if (v == timeCache_.end())
+        v = timeCache_.insert(std::make_pair(key, baseVol_->volatility(optionTime, swapLength, strike, true))).first;
+    return v->second;
+}
+
+Real CachedSwaptionVolatility::shiftImpl(Time optionTime, Time swapLength) const {
+    return baseVol_->shift(optionTime, swapLength, true);
+}
+
+} // namespace QuantExt
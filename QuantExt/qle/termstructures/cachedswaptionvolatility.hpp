@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file qle/termstructures/cachedswaptionvolatility.hpp
+    \brief swaption volatility structure caching the volatility lookups of an underlying structure
+    \ingroup termstructures
+*/
+
+#pragma once
+
+#include <ql/termstructures/volatility/swaption/swaptionvolstructure.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace QuantExt {
+
+//! Swaption volatility structure caching the volatility lookups of an underlying structure
+/*! The volatilities are cached by expiry, swap tenor and strike. The cache is cleared whenever the underlying
+    structure notifies an update or deepUpdate() is called, so that the wrapper can be used in a simulation market
+    with disabled observation, where deepUpdate() is called after a scenario is applied. Smile sections and shifts
+    are not cached.
+
+    \ingroup termstructures
+*/
+class CachedSwaptionVolatility : public QuantLib::SwaptionVolatilityStructure {
+public:
+    explicit CachedSwaptionVolatility(const QuantLib::Handle<QuantLib::SwaptionVolatilityStructure>& baseVol);
+
+    //! \name TermStructure interface
+    //@{
+    QuantLib::Date maxDate() const override { return baseVol_->maxDate(); }
+    const QuantLib::Date& referenceDate() const override { return baseVol_->referenceDate(); }
+    QuantLib::Calendar calendar() const override { return baseVol_->calendar(); }
+    QuantLib::Natural settlementDays() const override { return baseVol_->settlementDays(); }
+    //@}
+    //! \name VolatilityTermStructure interface
+    //@{
+    QuantLib::Rate minStrike() const override { return baseVol_->minStrike(); }
+    QuantLib::Rate maxStrike() const override { return baseVol_->maxStrike(); }
+    //@}
+    //! \name SwaptionVolatilityStructure interface
+    //@{
+    const QuantLib::Period& maxSwapTenor() const override { return baseVol_->maxSwapTenor(); }
+    QuantLib::VolatilityType volatilityType() const override { return baseVol_->volatilityType(); }
+    //@}
+    //! \name Observer interface
+    //@{
+    void update() override;
+    void deepUpdate() override;
+    //@}
+    //! \name Inspectors
+    //@{
+    const QuantLib::Handle<QuantLib::SwaptionVolatilityStructure>& baseVol() const { return baseVol_; }
+    QuantLib::Size cacheSize() const { return timeCache_.size() + dateCache_.size(); }
+    //@}
+
+private:
+    boost::shared_ptr<QuantLib::SmileSection> smileSectionImpl(const QuantLib::Date& optionDate,
+                                                               const QuantLib::Period& swapTenor) const override;
+    boost::shared_ptr<QuantLib::SmileSection> smileSectionImpl(QuantLib::Time optionTime,
+                                                               QuantLib::Time swapLength) const override;
+    QuantLib::Volatility volatilityImpl(const QuantLib::Date& optionDate, const QuantLib::Period& swapTenor,
+                                        QuantLib::Rate strike) const override;
+    QuantLib::Volatility volatilityImpl(QuantLib::Time optionTime, QuantLib::Time swapLength,
+                                        QuantLib::Rate strike) const override;
+    QuantLib::Real shiftImpl(QuantLib::Time optionTime, QuantLib::Time swapLength) const override;
+
+    QuantLib::Handle<QuantLib::SwaptionVolatilityStructure> baseVol_;
+    mutable std::map<std::tuple<QuantLib::Time, QuantLib::Time, QuantLib::Rate>, QuantLib::Volatility> timeCache_;
+    mutable std::map<std::tuple<QuantLib::Date::serial_type, QuantLib::Time, QuantLib::Rate>, QuantLib::Volatility>
+        dateCache_;
+};
+
+} // namespace QuantExt
@@ -31,6 +31,9 @@
 
 #include <boost/make_shared.hpp>
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace QuantExt {
 using namespace QuantLib;
 //! InterpolatedDiscountCurve2 as in QuantLib, but with floating discount quotes and floating reference date
@@ -39,6 +42,11 @@ using namespace QuantLib;
     reference date is always the global evaluation date,
     i.e. settlement days are zero and calendar is NullCalendar()
 
+    If the times at which the curve is queried are known in advance, e.g. the cashflow and fixing
+    times of a portfolio, they can be registered with registerQueryTimes(). The discount factors at
+    these times are then computed in one pass over precomputed pillar indices and weights on each
+    recalculation, and queries at exactly these times are served from this cache.
+
         \ingroup termstructures
 */
 class InterpolatedDiscountCurve2 : public YieldTermStructure, public LazyObject {
@@ -106,6 +114,28 @@ public:
     Calendar calendar() const override { return NullCalendar(); }
     Natural settlementDays() const override { return 0; }
 
+    //! Register the query times served from the cache, this replaces previously registered times
+    void registerQueryTimes(const std::vector<Time>& times) {
+        queryTimes_.clear();
+        queryPillars_.clear();
+        queryWeights_.clear();
+        queryIndex_.clear();
+        for (auto const& t : times) {
+            if (!queryIndex_.emplace(t, queryTimes_.size()).second)
+                continue;
+            Size i = std::min<Size>(std::upper_bound(times_.begin(), times_.end(), t) - times_.begin(),
+                                    times_.size() - 1);
+            i = std::max<Size>(i, 1);
+            queryTimes_.push_back(t);
+            queryPillars_.push_back(i);
+            queryWeights_.push_back((t - times_[i - 1]) / (times_[i] - times_[i - 1]));
+        }
+        queryDiscounts_.resize(queryTimes_.size());
+        update();
+    }
+    //! The registered query times
+    const std::vector<Time>& queryTimes() const { return queryTimes_; }
+
 protected:
     void performCalculations() const override {
         today_ = Settings::instance().evaluationDate();
@@ -119,10 +149,39 @@ protected:
             }
         }
         dataInterpolation_->update();
+        if (!queryTimes_.empty()) {
+            // log discounts resp. zero rates on the pillars, interpolated linearly to the query times
+            std::vector<Real> y(data_);
+            if (interpolation_ == Interpolation::logLinear) {
+                for (auto& v : y)
+                    v = std::log(v);
+            }
+            for (Size k = 0; k < queryTimes_.size(); ++k) {
+                Time t = queryTimes_[k];
+                if (t > times_.back()) {
+                    queryDiscounts_[k] = interpolatedDiscount(t);
+                    continue;
+                }
+                Size i = queryPillars_[k];
+                Real w = queryWeights_[k];
+                Real v = (1.0 - w) * y[i - 1] + w * y[i];
+                queryDiscounts_[k] = interpolation_ == Interpolation::logLinear ? std::exp(v) : std::exp(-v * t);
+            }
+        }
     }
 
     DiscountFactor discountImpl(Time t) const override {
         calculate();
+        if (!queryIndex_.empty()) {
+            auto q = queryIndex_.find(t);
+            if (q != queryIndex_.end())
+                return queryDiscounts_[q->second];
+        }
+        return interpolatedDiscount(t);
+    }
+
+private:
+    DiscountFactor interpolatedDiscount(Time t) const {
         if (t <= this->times_.back()) {
             Real tmp = (*dataInterpolation_)(t, true);
             if (interpolation_ == Interpolation::logLinear)
@@ -149,6 +208,12 @@ private:
     mutable std::vector<Real> data_;
     mutable Date today_;
     boost::shared_ptr<QuantLib::Interpolation> dataInterpolation_;
+    // registered query times, their pillar indices and interpolation weights, and the cached discount factors
+    std::vector<Time> queryTimes_;
+    std::vector<Size> queryPillars_;
+    std::vector<Real> queryWeights_;
+    std::unordered_map<Time, Size> queryIndex_;
+    mutable std::vector<DiscountFactor> queryDiscounts_;
 };
 
 } // namespace QuantExt
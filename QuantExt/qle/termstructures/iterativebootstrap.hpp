@@ -24,12 +24,17 @@
 #define quantext_iterative_bootstrap_hpp
 
 #include <ql/math/interpolations/linearinterpolation.hpp>
+#include <ql/math/matrix.hpp>
+#include <ql/math/matrixutilities/svd.hpp>
 #include <ql/math/solvers1d/brent.hpp>
 #include <ql/math/solvers1d/finitedifferencenewtonsafe.hpp>
 #include <ql/termstructures/bootstraperror.hpp>
 #include <ql/termstructures/bootstraphelper.hpp>
 #include <ql/utilities/dataformatters.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace QuantExt {
 
 namespace detail {
@@ -73,6 +78,14 @@ QuantLib::Real dontThrowFallback(const QuantLib::BootstrapError<Curve>& error, Q
       \c accuracy specified in the \c Curve which is useful in some situations e.g. cubic spline and optionlet
       stripping. If the \c globalAccuracy is set less than the \c accuracy in the \c Curve, the \c accuracy in the
       \c Curve is used instead.
+    - addition of a \c globalNewton parameter. If the interpolation requires a convergence loop, the pillar values
+      after the first bootstrap of the full curve are used as starting point of a Newton solver for all pillars
+      simultaneously. The Jacobian of the helper errors w.r.t. the pillar values is computed by finite differences
+      and updated by Broyden's method between the iterations. If the solver does not reach the accuracy, the
+      bootstrap continues with the convergence loop from the first bootstrap.
+    - addition of warm start values, e.g. the pillar values of a previous calibration of the curve, that are used
+      as initial guess on the first calibration. The values are interpolated linearly to the pillar dates of the
+      curve. If the bootstrap fails from the warm start, it is restarted from the usual initial guess.
 */
 template <class Curve> class IterativeBootstrap {
     typedef typename Curve::traits_type Traits;
@@ -91,17 +104,25 @@ public:
         \param minFactor      Factor for min value retry on each iteration if there is a failure.
         \param dontThrowSteps If \p dontThrow is \c true, this gives the number of steps to use when searching
                               for a fallback curve pillar value that gives the minimum bootstrap helper error.
+        \param globalNewton   If set to \c true, the convergence loop for global interpolations is replaced by a
+                              Newton solver for all pillars, if it converges.
+        \param warmStartDates  Dates of the warm start values, in increasing order. If empty, no warm start is used.
+        \param warmStartValues Warm start values of the curve's interpolation variable on the \p warmStartDates.
     */
     IterativeBootstrap(QuantLib::Real accuracy = QuantLib::Null<QuantLib::Real>(),
                        QuantLib::Real globalAccuracy = QuantLib::Null<QuantLib::Real>(), bool dontThrow = false,
                        QuantLib::Size maxAttempts = 1, QuantLib::Real maxFactor = 2.0, QuantLib::Real minFactor = 2.0,
-                       QuantLib::Size dontThrowSteps = 10);
+                       QuantLib::Size dontThrowSteps = 10, bool globalNewton = false,
+                       const std::vector<QuantLib::Date>& warmStartDates = std::vector<QuantLib::Date>(),
+                       const std::vector<QuantLib::Real>& warmStartValues = std::vector<QuantLib::Real>());
 
     void setup(Curve* ts);
     void calculate() const;
 
 private:
     void initialize() const;
+    QuantLib::Real warmStartValue(const QuantLib::Date& d) const;
+    bool solveGlobalNewton(QuantLib::Real accuracy) const;
     Curve* ts_;
     QuantLib::Size n_;
     QuantLib::Brent firstSolver_;
@@ -117,15 +138,28 @@ private:
     QuantLib::Real maxFactor_;
     QuantLib::Real minFactor_;
     QuantLib::Size dontThrowSteps_;
+    bool globalNewton_;
+    std::vector<QuantLib::Date> warmStartDates_;
+    std::vector<QuantLib::Real> warmStartValues_;
+    mutable bool useWarmStart_, warmStarted_;
 };
 
 template <class Curve>
 IterativeBootstrap<Curve>::IterativeBootstrap(QuantLib::Real accuracy, QuantLib::Real globalAccuracy, bool dontThrow,
                                               QuantLib::Size maxAttempts, QuantLib::Real maxFactor,
-                                              QuantLib::Real minFactor, QuantLib::Size dontThrowSteps)
+                                              QuantLib::Real minFactor, QuantLib::Size dontThrowSteps,
+                                              bool globalNewton, const std::vector<QuantLib::Date>& warmStartDates,
+                                              const std::vector<QuantLib::Real>& warmStartValues)
     : ts_(0), n_(0), initialized_(false), validCurve_(false), loopRequired_(Interpolator::global),
       firstAliveHelper_(0), alive_(0), accuracy_(accuracy), globalAccuracy_(globalAccuracy), dontThrow_(dontThrow),
-      maxAttempts_(maxAttempts), maxFactor_(maxFactor), minFactor_(minFactor), dontThrowSteps_(dontThrowSteps) {}
+      maxAttempts_(maxAttempts), maxFactor_(maxFactor), minFactor_(minFactor), dontThrowSteps_(dontThrowSteps),
+      globalNewton_(globalNewton), warmStartDates_(warmStartDates), warmStartValues_(warmStartValues),
+      useWarmStart_(!warmStartDates.empty()), warmStarted_(false) {
+    QL_REQUIRE(warmStartDates_.size() == warmStartValues_.size(), "number of warm start dates ("
+                                                                       << warmStartDates_.size()
+                                                                       << ") does not match number of values ("
+                                                                       << warmStartValues_.size() << ")");
+}
 
 template <class Curve> void IterativeBootstrap<Curve>::setup(Curve* ts) {
     ts_ = ts;
@@ -200,10 +234,118 @@ template <class Curve> void IterativeBootstrap<Curve>::initialize() const {
         // because, e.g., of interpolation's early checks
         ts_->data_ = std::vector<QuantLib::Real>(alive_ + 1, Traits::initialValue(ts_));
         previousData_.resize(alive_ + 1);
+        // use the warm start values as guess instead, if given
+        if (useWarmStart_) {
+            for (QuantLib::Size i = 1; i <= alive_; ++i)
+                Traits::updateGuess(ts_->data_, warmStartValue(dates[i]), i);
+            warmStarted_ = true;
+        }
     }
     initialized_ = true;
 }
 
+template <class Curve> QuantLib::Real IterativeBootstrap<Curve>::warmStartValue(const QuantLib::Date& d) const {
+    auto it = std::lower_bound(warmStartDates_.begin(), warmStartDates_.end(), d);
+    if (it == warmStartDates_.begin())
+        return warmStartValues_.front();
+    if (it == warmStartDates_.end())
+        return warmStartValues_.back();
+    QuantLib::Size i = std::distance(warmStartDates_.begin(), it);
+    QuantLib::Real w = static_cast<QuantLib::Real>(d - warmStartDates_[i - 1]) /
+                       static_cast<QuantLib::Real>(warmStartDates_[i] - warmStartDates_[i - 1]);
+    return (1.0 - w) * warmStartValues_[i - 1] + w * warmStartValues_[i];
+}
+
+template <class Curve> bool IterativeBootstrap<Curve>::solveGlobalNewton(QuantLib::Real accuracy) const {
+
+    std::vector<QuantLib::Real>& data = ts_->data_;
+    const std::vector<QuantLib::Real> start(data);
+
+    // the errors of the alive helpers for the pillar values x, data is updated in place, since the interpolation
+    // refers to it
+    auto errors = [this, &data](const QuantLib::Array& x) {
+        for (QuantLib::Size i = 1; i <= alive_; ++i)
+            Traits::updateGuess(data, x[i - 1], i);
+        ts_->interpolation_.update();
+        QuantLib::Array f(alive_);
+        for (QuantLib::Size i = 1; i <= alive_; ++i)
+            f[i - 1] = errors_[i]->helper()->quoteError();
+        return f;
+    };
+
+    auto maxNorm = [](const QuantLib::Array& a) {
+        QuantLib::Real m = 0.0;
+        for (auto const v : a)
+            m = std::max(m, std::fabs(v));
+        return m;
+    };
+
+    try {
+        // the first bootstrap might have used linear interpolation on the first pillars
+        ts_->interpolation_ = ts_->interpolator_.interpolate(ts_->times_.begin(), ts_->times_.end(), data.begin());
+        ts_->interpolation_.update();
+
+        QuantLib::Array x(alive_);
+        for (QuantLib::Size i = 1; i <= alive_; ++i)
+            x[i - 1] = data[i];
+        QuantLib::Array f = errors(x);
+        QuantLib::Matrix jacobian;
+        bool recompute = true;
+
+        for (QuantLib::Size iteration = 0; iteration < Traits::maxIterations(); ++iteration) {
+
+            // forward differences, column k holds the sensitivities of the helper errors to the k-th pillar value
+            bool freshJacobian = recompute;
+            if (recompute) {
+                jacobian = QuantLib::Matrix(alive_, alive_);
+                for (QuantLib::Size k = 0; k < alive_; ++k) {
+                    QuantLib::Array xh(x);
+                    QuantLib::Real h = std::max(std::fabs(x[k]), 1.0) * 1.0E-8;
+                    xh[k] += h;
+                    QuantLib::Array fh = errors(xh);
+                    for (QuantLib::Size j = 0; j < alive_; ++j)
+                        jacobian[j][k] = (fh[j] - f[j]) / h;
+                }
+                recompute = false;
+            }
+
+            QuantLib::Array dx = QuantLib::SVD(jacobian).solveFor(f);
+            QuantLib::Array xNew = x - dx;
+            QuantLib::Array fNew = errors(xNew);
+            for (QuantLib::Size k = 0; k < alive_; ++k) {
+                if (!std::isfinite(xNew[k]) || !std::isfinite(fNew[k]))
+                    QL_FAIL("non finite pillar value or helper error in global newton step");
+            }
+
+            if (maxNorm(dx) <= accuracy)
+                return true;
+
+            if (maxNorm(fNew) < maxNorm(f)) {
+                // Broyden update of the jacobian for the step -dx
+                QuantLib::Array df = fNew - f;
+                QuantLib::Array r = df + jacobian * dx;
+                QuantLib::Real norm = QuantLib::DotProduct(dx, dx);
+                for (QuantLib::Size j = 0; j < alive_; ++j)
+                    for (QuantLib::Size k = 0; k < alive_; ++k)
+                        jacobian[j][k] -= r[j] * dx[k] / norm;
+                x = xNew;
+                f = fNew;
+            } else {
+                // no improvement, retry from the current point with a new jacobian unless it is new already
+                QL_REQUIRE(!freshJacobian, "global newton step does not improve the helper errors");
+                f = errors(x);
+                recompute = true;
+            }
+        }
+    } catch (...) {
+    }
+
+    // restore the result of the first bootstrap
+    std::copy(start.begin(), start.end(), data.begin());
+    ts_->interpolation_.update();
+    return false;
+}
+
 template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
 
     // we might have to call initialize even if the curve is initialized
@@ -239,6 +381,16 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
     // there might be a valid curve state to use as guess
     bool validData = validCurve_;
 
+    // or warm start values, for which the interpolation is set up on all pillars
+    if (!validData && warmStarted_) {
+        try {
+            ts_->interpolation_ = ts_->interpolator_.interpolate(times.begin(), times.end(), data.begin());
+            ts_->interpolation_.update();
+            validData = true;
+        } catch (...) {
+        }
+    }
+
     for (QuantLib::Size iteration = 0;; ++iteration) {
         previousData_ = ts_->data_;
 
@@ -293,7 +445,7 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
                 else
                     firstSolver_.solve(*errors_[i], accuracy, guess, minValues[i - 1], maxValues[i - 1]);
             } catch (std::exception& e) {
-                if (validCurve_) {
+                if (validCurve_ || warmStarted_) {
                     // the previous curve state might have been a
                     // bad guess, so we retry without using it.
                     // This would be tricky to do here (we're
@@ -301,6 +453,7 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
                     // to re-initialize...), so we invalidate the
                     // curve, make a recursive call and then exit.
                     validCurve_ = initialized_ = false;
+                    useWarmStart_ = warmStarted_ = false;
                     calculate();
                     return;
                 }
@@ -346,6 +499,10 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
         if (change <= globalAccuracy || change <= accuracy)
             break;
 
+        // solve for all pillars simultaneously, starting from the first bootstrap
+        if (globalNewton_ && iteration == 0 && solveGlobalNewton(std::max(globalAccuracy, accuracy)))
+            break;
+
         // If we hit the max number of iterations and dontThrow is true, just use what we have
         if (iteration == maxIterations) {
             if (dontThrow_) {
@@ -361,6 +518,7 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
     }
 
     validCurve_ = true;
+    warmStarted_ = false;
 }
 
 } // namespace QuantExt
@@ -170,8 +170,11 @@ inline void PiecewiseOptionletStripper<Interpolator, Bootstrap>::performCalculat
         }
     }
 
-    // Populate the strike curves
+    /* Populate the strike curves. The curves are kept while the reference date does not change, they observe the
+       helpers and are recalculated when the quotes change, starting the bootstrap from their previous solution. */
     for (Size j = 0; j < strikes.size(); j++) {
+        if (strikeCurves_[j] && strikeCurves_[j]->referenceDate() == termVolSurface_->referenceDate())
+            continue;
         strikeCurves_[j] = boost::make_shared<optionlet_curve>(
             termVolSurface_->referenceDate(), helpers_[j], termVolSurface_->calendar(),
             termVolSurface_->businessDayConvention(), termVolSurface_->dayCounter(), volatilityType_, displacement_,
@@ -137,11 +137,8 @@ Real SpreadedBlackVolatilitySurfaceMoneyness::blackVolImpl(Time t, Real strike)
                    "SpreadedBlackVolatilitySurfaceMoneyness: got invalid strike from moneyness at t = "
                        << t << ", input strike = " << strike << ", moneyness = " << m);
     }
-    Real m2 = moneynessFromStrike(t, strike, false);
-    QL_REQUIRE(std::isfinite(m2),
-               "SpreadedBlackVolatilitySurfaceMoneyness: got invalid moneyness (sticky reference) at t = "
-                   << t << ", strike = " << strike << ": " << m2);
-    return referenceVol_->blackVol(t, effStrike) + volSpreadSurface_(t, m2);
+    // the spread is read at the moneyness w.r.t. the dynamic reference, which was computed above
+    return referenceVol_->blackVol(t, effStrike) + volSpreadSurface_(t, m);
 }
 
 Real SpreadedBlackVolatilitySurfaceMoneynessSpot::moneynessFromStrike(Time t, Real strike,
@@ -65,6 +65,7 @@ SwaptionVolCube2::SwaptionVolCube2(const Handle<SwaptionVolatilityStructure>& at
 void SwaptionVolCube2::performCalculations() const {
 
     SwaptionVolatilityCube::performCalculations();
+    smileSections_.clear();
     //! set volSpreadsMatrix_ by volSpreads_ quotes
     for (Size i = 0; i < nStrikes_; i++)
         for (Size j = 0; j < nOptionTenors_; j++)
@@ -101,6 +102,10 @@ boost::shared_ptr<SmileSection> SwaptionVolCube2::smileSectionImpl(Time optionTi
 boost::shared_ptr<SmileSection> SwaptionVolCube2::smileSectionImpl(const Date& optionDate,
                                                                    const Period& swapTenor) const {
     calculate();
+    Time length = swapLength(swapTenor);
+    auto cached = smileSections_.find(std::make_pair(optionDate, length));
+    if (cached != smileSections_.end())
+        return cached->second;
     Rate atmForward = atmStrike(optionDate, swapTenor);
     Volatility referenceVol = volsAreSpreads_ ? atmVol_->volatility(optionDate, swapTenor, atmForward) : 0.0;
     Time optionTime = timeFromReference(optionDate);
@@ -108,17 +113,19 @@ boost::shared_ptr<SmileSection> SwaptionVolCube2::smileSectionImpl(const Date& o
     std::vector<Real> strikes, stdDevs;
     strikes.reserve(nStrikes_);
     stdDevs.reserve(nStrikes_);
-    Time length = swapLength(swapTenor);
     for (Size i = 0; i < nStrikes_; ++i) {
         strikes.push_back(atmForward + strikeSpreads_[i]);
         stdDevs.push_back(exerciseTimeSqrt * (referenceVol + volSpreadsInterpolator_[i](length, optionTime)));
     }
     Real shift = atmVol_->shift(optionTime, length);
+    boost::shared_ptr<SmileSection> section;
     if (!flatExtrapolation_)
-        return boost::shared_ptr<SmileSection>(new InterpolatedSmileSection<Linear>(
+        section = boost::shared_ptr<SmileSection>(new InterpolatedSmileSection<Linear>(
             optionTime, strikes, stdDevs, atmForward, Linear(), Actual365Fixed(), volatilityType(), shift));
     else
-        return boost::shared_ptr<SmileSection>(new InterpolatedSmileSection<LinearFlat>(
+        section = boost::shared_ptr<SmileSection>(new InterpolatedSmileSection<LinearFlat>(
             optionTime, strikes, stdDevs, atmForward, LinearFlat(), Actual365Fixed(), volatilityType(), shift));
+    smileSections_[std::make_pair(optionDate, length)] = section;
+    return section;
 }
 } // namespace QuantExt
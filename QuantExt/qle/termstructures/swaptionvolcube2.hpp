@@ -44,6 +44,8 @@
 #include <ql/math/interpolations/interpolation2d.hpp>
 #include <ql/termstructures/volatility/swaption/swaptionvolcube.hpp>
 
+#include <map>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -63,6 +65,9 @@ public:
 
         If flatExtrapolation is true the implied volatility is
         extrapolated flat in strike direction.
+
+        The smile sections are cached by option date and swap length until the cube is recalculated, since
+        building a section requires the atm strike, i.e. the fair rate of the underlying swap.
   */
     /*! in case volsAreSpreads is false the given volSpreads are interpreted as absolute vols,
       in this case the volSpreads inspectors also return absolute vols */
@@ -87,6 +92,7 @@ private:
     const bool flatExtrapolation_, volsAreSpreads_;
     mutable std::vector<Interpolation2D> volSpreadsInterpolator_;
     mutable std::vector<Matrix> volSpreadsMatrix_;
+    mutable std::map<std::pair<Date, Time>, boost::shared_ptr<SmileSection> > smileSections_;
 };
 
 } // namespace QuantExt
@@ -568,6 +568,67 @@ BOOST_AUTO_TEST_CASE(testLgmInvariances) {
     }
 } // testInvariances
 
+BOOST_AUTO_TEST_CASE(testCalibrationCache) {
+
+    BOOST_TEST_MESSAGE("Testing analytic LGM swaption engine cache for calibration...");
+
+    Handle<YieldTermStructure> discountingCurve(
+        boost::make_shared<FlatForward>(0, NullCalendar(), 0.03, Actual365Fixed()));
+    Handle<YieldTermStructure> forwardingCurve(
+        boost::make_shared<FlatForward>(0, NullCalendar(), 0.05, Actual365Fixed()));
+
+    Array times(0);
+    Array alpha(1, 0.01);
+    Array kappa(1, 0.01);
+
+    boost::shared_ptr<SwapIndex> index =
+        boost::make_shared<EuriborSwapIsdaFixA>(10 * Years, forwardingCurve, discountingCurve);
+    Swaption swaption = MakeSwaption(index, 5 * Years, 0.04);
+
+    const boost::shared_ptr<IrLgm1fParametrization> irlgm1f =
+        boost::make_shared<IrLgm1fPiecewiseConstantParametrization>(EURCurrency(), discountingCurve, times, alpha,
+                                                                    times, kappa);
+    const boost::shared_ptr<LinearGaussMarkovModel> lgm = boost::make_shared<LinearGaussMarkovModel>(irlgm1f);
+
+    boost::shared_ptr<PricingEngine> engine = boost::make_shared<AnalyticLgmSwaptionEngine>(lgm, discountingCurve);
+    boost::shared_ptr<AnalyticLgmSwaptionEngine> engineVol =
+        boost::make_shared<AnalyticLgmSwaptionEngine>(lgm, discountingCurve);
+    engineVol->enableCache(true, false);
+    boost::shared_ptr<AnalyticLgmSwaptionEngine> engineRev =
+        boost::make_shared<AnalyticLgmSwaptionEngine>(lgm, discountingCurve);
+    engineRev->enableCache(false, true);
+
+    // the parameters are alpha and kappa, we vary one of them as in a calibration of the volatility or the reversion
+    Real alphas[] = { 0.0050, 0.0075, 0.0100, 0.0150, 0.0200 };
+    Real kappas[] = { -0.01, 0.0, 0.01, 0.02, 0.03 };
+
+    // the start value of the yStar search differs between the engines, the npv is not sensitive to yStar though
+    Real tol = 1.0E-8;
+    for (Size i = 0; i < LENGTH(alphas); ++i) {
+        Array params(2);
+        params[0] = alphas[i];
+        params[1] = kappa[0];
+        lgm->setParams(params);
+        swaption.setPricingEngine(engine);
+        Real npv = swaption.NPV();
+        swaption.setPricingEngine(engineVol);
+        Real npvVol = swaption.NPV();
+        BOOST_CHECK_CLOSE(npv, npvVol, tol);
+    }
+
+    for (Size i = 0; i < LENGTH(kappas); ++i) {
+        Array params(2);
+        params[0] = alpha[0];
+        params[1] = kappas[i];
+        lgm->setParams(params);
+        swaption.setPricingEngine(engine);
+        Real npv = swaption.NPV();
+        swaption.setPricingEngine(engineRev);
+        Real npvRev = swaption.NPV();
+        BOOST_CHECK_CLOSE(npv, npvRev, tol);
+    }
+} // testCalibrationCache
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -71,6 +71,41 @@ BOOST_AUTO_TEST_CASE(testBlackVolSurfaceDeltaConstantVol) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBlackVolSurfaceDeltaSmileCache) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::BlackVolatilitySurfaceDelta smile cache...");
+
+    Date refDate(1, Jan, 2010);
+    Settings::instance().evaluationDate() = refDate;
+
+    vector<Date> dates = { Date(1, Jan, 2011), Date(1, Jan, 2012) };
+    vector<Real> putDeltas = { -0.25 };
+    vector<Real> callDeltas = { 0.25 };
+    Matrix blackVolMatrix(2, 3, 0.10);
+    blackVolMatrix[0][0] = blackVolMatrix[1][0] = 0.12;
+    blackVolMatrix[0][2] = blackVolMatrix[1][2] = 0.11;
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    auto spotQuote = boost::make_shared<SimpleQuote>(1.0);
+    Handle<Quote> spot(spotQuote);
+    Handle<YieldTermStructure> dts(boost::make_shared<FlatForward>(0, TARGET(), 0.011, dc));
+    Handle<YieldTermStructure> fts(boost::make_shared<FlatForward>(0, TARGET(), 0.012, dc));
+
+    BlackVolatilitySurfaceDelta surface(refDate, dates, putDeltas, callDeltas, true, blackVolMatrix, dc, TARGET(),
+                                        spot, dts, fts);
+
+    // the smile is reused until the spot changes
+    auto smile = surface.blackVolSmile(1.5);
+    BOOST_CHECK(smile == surface.blackVolSmile(1.5));
+    Volatility vol = surface.blackVol(1.5, 1.1);
+
+    spotQuote->setValue(1.2);
+    BOOST_CHECK(smile != surface.blackVolSmile(1.5));
+
+    // the delta strikes scale with the spot, so that the vol at the scaled strike is unchanged
+    BOOST_CHECK_CLOSE(surface.blackVol(1.5, 1.1 * 1.2), vol, 1E-8);
+}
+
 BOOST_AUTO_TEST_CASE(testInterpolatedSmileSectionConstruction) {
 
     BOOST_TEST_MESSAGE("Testing QuantExt::InterpolatedSmileSection...");
@@ -22,6 +22,7 @@
 // clang-format on
 
 #include <qle/math/blockmatrixinverse.hpp>
+#include <qle/math/sparselu.hpp>
 
 #include "toplevelfixture.hpp"
 
@@ -31,6 +32,8 @@
 #include <boost/make_shared.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <sstream>
+
 using namespace QuantLib;
 using namespace QuantExt;
 
@@ -212,6 +215,88 @@ BOOST_AUTO_TEST_CASE(testSparseMatrix) {
     check(res2, ex);
 } // testSingleBlock
 
+BOOST_AUTO_TEST_CASE(testSparseLU) {
+    BOOST_TEST_MESSAGE("Test sparse LU factorisation against dense inverse");
+
+    MersenneTwisterUniformRng mt(42);
+
+    // block lower triangular matrix with a small diagonal in the first block, so that pivoting is required
+    Size n = 60;
+    Matrix m(n, n, 0.0);
+    SparseMatrix sm(n, n);
+    for (Size i = 0; i < n; ++i) {
+        for (Size j = (i / 20) * 20; j <= i; ++j) {
+            Real tmp = j == i ? (i < 20 ? 0.001 : 2.0) : mt.nextReal() - 0.5;
+            m[i][j] = tmp;
+            sm(i, j) = tmp;
+        }
+        if (i > 0) {
+            Real tmp = mt.nextReal() - 0.5;
+            m[i - 1][i] = tmp;
+            sm(i - 1, i) = tmp;
+        }
+    }
+
+    SparseLU lu(sm);
+    BOOST_CHECK_EQUAL(lu.size(), n);
+
+    Matrix ex = inverse(m);
+    Matrix res(n, n), resT(n, n);
+    boost::numeric::ublas::vector<Real> e(n, 0.0);
+    for (Size j = 0; j < n; ++j) {
+        e[j] = 1.0;
+        boost::numeric::ublas::vector<Real> col = lu.solve(e);
+        boost::numeric::ublas::vector<Real> row = lu.solveTransposed(e);
+        e[j] = 0.0;
+        for (Size i = 0; i < n; ++i) {
+            res[i][j] = col[i];
+            resT[j][i] = row[i];
+        }
+    }
+    check(res, ex);
+    check(resT, ex);
+
+    // solving for all unit vectors at once gives the inverse as well
+    Matrix id(n, n, 0.0);
+    for (Size i = 0; i < n; ++i)
+        id[i][i] = 1.0;
+    lu.solve(id);
+    check(id, ex);
+
+    // condition number estimate is a lower bound for the 1-norm condition number
+    Real normA = 0.0, normInv = 0.0;
+    for (Size j = 0; j < n; ++j) {
+        Real a = 0.0, b = 0.0;
+        for (Size i = 0; i < n; ++i) {
+            a += std::abs(m[i][j]);
+            b += std::abs(ex[i][j]);
+        }
+        normA = std::max(normA, a);
+        normInv = std::max(normInv, b);
+    }
+    BOOST_CHECK_LE(lu.conditionNumberEstimate(), normA * normInv * (1.0 + 1E-10));
+    BOOST_CHECK_GT(lu.conditionNumberEstimate(), 0.1 * normA * normInv);
+
+    // serialisation round trip
+    std::stringstream ss;
+    lu.save(ss);
+    SparseLU lu2;
+    lu2.load(ss);
+    e[0] = 1.0;
+    e[n - 1] = -1.0;
+    boost::numeric::ublas::vector<Real> x1 = lu.solve(e), x2 = lu2.solve(e);
+    for (Size i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(x1[i], x2[i]);
+
+    // singular matrix
+    SparseMatrix singular(3, 3);
+    singular(0, 0) = 1.0;
+    singular(0, 1) = 2.0;
+    singular(1, 0) = 2.0;
+    singular(1, 1) = 4.0;
+    singular(2, 2) = 1.0;
+    BOOST_CHECK_THROW(SparseLU(singular), QuantLib::Error);
+} // testSparseLU
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -20,14 +20,18 @@
 #include <boost/make_shared.hpp>
 #include <boost/test/unit_test.hpp>
 #include <ql/currencies/all.hpp>
+#include <ql/indexes/ibor/euribor.hpp>
 #include <ql/indexes/indexmanager.hpp>
+#include <ql/instruments/makevanillaswap.hpp>
 #include <ql/quotes/simplequote.hpp>
 #include <ql/termstructures/yield/flatforward.hpp>
 #include <ql/time/calendars/target.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
+#include <qle/cashflows/compiledleg.hpp>
 #include <qle/cashflows/equitycoupon.hpp>
 #include <qle/cashflows/equitycouponpricer.hpp>
 #include <qle/cashflows/fxlinkedcashflow.hpp>
+#include <qle/pricingengines/discountingswapenginemulticurve.hpp>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -197,6 +201,77 @@ BOOST_AUTO_TEST_CASE(testEquityCoupon) {
     BOOST_CHECK_CLOSE(eq5.amount(), expectedAmount, 1e-10);
 }
 
+BOOST_AUTO_TEST_CASE(testCompiledLeg) {
+
+    BOOST_TEST_MESSAGE("Testing compiled legs in the DiscountingSwapEngineMultiCurve");
+
+    Settings::instance().evaluationDate() = Date(5, Jan, 2016);
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Calendar cal = TARGET();
+    Handle<YieldTermStructure> discount(boost::make_shared<FlatForward>(0, cal, 0.01, dc));
+    RelinkableHandle<YieldTermStructure> forward(boost::make_shared<FlatForward>(0, cal, 0.02, dc));
+    boost::shared_ptr<IborIndex> index = boost::make_shared<Euribor6M>(forward);
+
+    // a seasoned swap, the current coupon is fixed already
+    boost::shared_ptr<VanillaSwap> swap = MakeVanillaSwap(10 * Years, index, 0.015)
+                                              .withEffectiveDate(Date(15, Jul, 2015))
+                                              .withFloatingLegSpread(0.001);
+    index->addFixing(index->fixingDate(Date(15, Jul, 2015)), 0.005);
+    BOOST_REQUIRE(CompiledLeg::compile(swap->fixedLeg()));
+    BOOST_REQUIRE(CompiledLeg::compile(swap->floatingLeg()));
+
+    auto standardEngine = boost::make_shared<DiscountingSwapEngineMultiCurve>(discount);
+    auto compiledEngine =
+        boost::make_shared<DiscountingSwapEngineMultiCurve>(discount, true, boost::none, Date(), Date(), false, true);
+
+    for (Real rate : {0.02, 0.03}) {
+        forward.linkTo(boost::make_shared<FlatForward>(0, cal, rate, dc));
+        swap->setPricingEngine(standardEngine);
+        Real expected = swap->NPV();
+        swap->setPricingEngine(compiledEngine);
+        BOOST_CHECK_CLOSE(swap->NPV(), expected, 1e-10);
+    }
+    IndexManager::instance().clearHistories();
+}
+
+BOOST_AUTO_TEST_CASE(testCachedLegValues) {
+
+    BOOST_TEST_MESSAGE("Testing cached leg values in the DiscountingSwapEngineMultiCurve");
+
+    Settings::instance().evaluationDate() = Date(5, Jan, 2016);
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Calendar cal = TARGET();
+    RelinkableHandle<YieldTermStructure> discount(boost::make_shared<FlatForward>(0, cal, 0.01, dc));
+    RelinkableHandle<YieldTermStructure> forward(boost::make_shared<FlatForward>(0, cal, 0.02, dc));
+    boost::shared_ptr<IborIndex> index = boost::make_shared<Euribor6M>(forward);
+
+    boost::shared_ptr<VanillaSwap> swap = MakeVanillaSwap(10 * Years, index, 0.015)
+                                              .withEffectiveDate(Date(15, Jul, 2015))
+                                              .withFloatingLegSpread(0.001);
+    index->addFixing(index->fixingDate(Date(15, Jul, 2015)), 0.005);
+
+    auto standardEngine = boost::make_shared<DiscountingSwapEngineMultiCurve>(discount);
+    auto cachedEngine = boost::make_shared<DiscountingSwapEngineMultiCurve>(discount, true, boost::none, Date(), Date(),
+                                                                            false, false, true);
+
+    // bump the discount and the forwarding curve alternately, so that only one of them notifies the engine
+    std::vector<std::pair<Real, Real>> rates = {{0.01, 0.02}, {0.011, 0.02}, {0.011, 0.021}, {0.01, 0.021}};
+    for (Size i = 0; i < rates.size(); ++i) {
+        const auto& r = rates[i];
+        if (i > 0 && r.first != rates[i - 1].first)
+            discount.linkTo(boost::make_shared<FlatForward>(0, cal, r.first, dc));
+        if (i > 0 && r.second != rates[i - 1].second)
+            forward.linkTo(boost::make_shared<FlatForward>(0, cal, r.second, dc));
+        swap->setPricingEngine(standardEngine);
+        Real expected = swap->NPV();
+        Real expectedFloat = swap->floatingLegNPV();
+        swap->setPricingEngine(cachedEngine);
+        BOOST_CHECK_CLOSE(swap->NPV(), expected, 1e-10);
+        BOOST_CHECK_CLOSE(swap->floatingLegNPV(), expectedFloat, 1e-10);
+    }
+    IndexManager::instance().clearHistories();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -16,21 +16,28 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/computeenvironment.hpp>
+#include <qle/math/multidevicecontext.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariable_io.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/pricingengines/mcmultilegbaseengine.hpp>
+
+#include <ql/currencies/europe.hpp>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/variance.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/timer/timer.hpp>
 
 #include "toplevelfixture.hpp"
 
 using namespace QuantExt;
+using namespace QuantLib;
 
 BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
 
@@ -203,6 +210,213 @@ BOOST_AUTO_TEST_CASE(testRngGeneration) {
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(testAmcCalculatorOnDevice) {
+    BOOST_TEST_MESSAGE("testing amc calculator regression model evaluation on external devices");
+    ComputeEnvironmentCleanUp cleanUp;
+
+    const Size n = 10000;
+    auto basisFns = LsmBasisSystem::multiPathBasisSystem(2, 2, LsmBasisSystem::Monomial);
+    std::vector<Array> coeffs(2, Array(basisFns.size()));
+    for (Size k = 0; k < basisFns.size(); ++k) {
+        coeffs[0][k] = 0.1 * (k + 1.0);
+        coeffs[1][k] = 0.2 - 0.05 * k;
+    }
+
+    std::vector<std::vector<RandomVariable>> paths(2, std::vector<RandomVariable>(2, RandomVariable(n)));
+    for (Size i = 0; i < 2; ++i) {
+        for (Size j = 0; j < 2; ++j) {
+            for (Size p = 0; p < n; ++p)
+                paths[i][j].set(p, std::sin(0.001 * p + i + 2.0 * j));
+        }
+    }
+
+    auto simulate = [&](const std::string& device) {
+        MultiLegBaseAmcCalculator calc(EURCurrency(), Array(2, 0.0), {0, 1}, false, false, {1.0, 2.0}, {0, 1},
+                                       {Null<Size>(), Null<Size>()}, {0, 1}, {false, false}, 2, 1.0, {}, {}, {}, {},
+                                       coeffs, basisFns, LsmBasisSystem::Monomial, device);
+        return calc.simulatePath({1.0, 2.0}, paths, {true, true}, false);
+    };
+
+    auto expected = simulate("");
+    BOOST_REQUIRE_EQUAL(expected.size(), 3u);
+
+    // an unknown device falls back to the cpu
+    auto fallback = simulate("UnknownDevice");
+    for (Size i = 0; i < expected.size(); ++i)
+        BOOST_CHECK(close_enough_all(fallback[i], expected[i]));
+
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        BOOST_TEST_MESSAGE("  testing device '" << d << "'.");
+        auto result = simulate(d);
+        BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+        for (Size i = 0; i < expected.size(); ++i) {
+            for (Size p = 0; p < n; p += 100)
+                BOOST_CHECK_SMALL(result[i][p] - expected[i][p], 1E-5);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(testPrecision) {
+    BOOST_TEST_MESSAGE("testing single, double and mixed precision calculations");
+    ComputeEnvironmentCleanUp cleanUp;
+    const std::size_t n = 1024;
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        std::vector<ComputeContext::Precision> precisions(1, ComputeContext::Precision::Single);
+        if (c.supportsDoublePrecision()) {
+            precisions.push_back(ComputeContext::Precision::Double);
+            precisions.push_back(ComputeContext::Precision::Mixed);
+        } else {
+            BOOST_TEST_MESSAGE("  device '" << d << "' does not support double precision.");
+        }
+        for (auto const p : precisions) {
+            BOOST_TEST_MESSAGE("  testing device '" << d << "', precision " << static_cast<int>(p));
+            c.setPrecision(p);
+            c.initiateCalculation(n);
+            std::size_t x = c.createInputVariable(1.0);
+            std::size_t y = c.createInputVariable(1E-8);
+            // the increments are lost in float arithmetic
+            for (std::size_t i = 0; i < 1000; ++i) {
+                std::size_t z = c.applyOperation(RandomVariableOpCode::Add, {x, y});
+                if (i > 0)
+                    c.freeVariable(x);
+                x = z;
+            }
+            c.declareOutputVariable(x);
+            std::vector<std::vector<double>> output(1, std::vector<double>(n));
+            c.finalizeCalculation(output);
+            const double expected = p == ComputeContext::Precision::Single ? 1.0 : 1.00001;
+            for (std::size_t i = 0; i < n; i += 100)
+                BOOST_CHECK_CLOSE(output[0][i], expected, 1E-6);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(testProgramCache) {
+    BOOST_TEST_MESSAGE("testing program cache");
+    ComputeEnvironmentCleanUp cleanUp;
+    const std::size_t n = 1024;
+    const boost::filesystem::path dir =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("ore_program_cache_%%%%%%%%");
+    boost::filesystem::create_directories(dir);
+    auto numberOfFiles = [&dir]() {
+        return std::distance(boost::filesystem::directory_iterator(dir), boost::filesystem::directory_iterator());
+    };
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        BOOST_TEST_MESSAGE("  testing device '" << d << "'.");
+        std::vector<std::vector<float>> output(2, std::vector<float>(n));
+        // the second run uses fresh contexts and takes the program from the cache
+        for (std::size_t run = 0; run < 2; ++run) {
+            ComputeEnvironment::instance().reset();
+            ComputeEnvironment::instance().selectContext(d);
+            auto& c = ComputeEnvironment::instance().context();
+            c.setProgramCacheDirectory(dir.string());
+            c.initiateCalculation(n);
+            auto x = c.createInputVariable(2.0f);
+            auto y = c.applyOperation(RandomVariableOpCode::Exp, {x});
+            c.declareOutputVariable(c.applyOperation(RandomVariableOpCode::Mult, {x, y}));
+            std::vector<float*> outputPtr(1, &output[run][0]);
+            c.finalizeCalculation(outputPtr);
+            // only the OpenCL framework compiles programs
+            BOOST_CHECK_EQUAL(numberOfFiles(), d.find("OpenCL/") == 0 ? 1 : 0);
+        }
+        for (std::size_t i = 0; i < n; i += 100) {
+            BOOST_CHECK_CLOSE(output[0][i], 2.0f * std::exp(2.0f), 1E-4);
+            BOOST_CHECK_EQUAL(output[0][i], output[1][i]);
+        }
+        boost::filesystem::remove_all(dir);
+        boost::filesystem::create_directories(dir);
+    }
+    boost::filesystem::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(testBasicCpuReference) {
+    BOOST_TEST_MESSAGE("testing devices against the basic cpu framework");
+    ComputeEnvironmentCleanUp cleanUp;
+    const std::size_t n = 10000;
+    std::vector<double> x(n);
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = 0.0001 * i;
+    auto calc = [&x, n](const std::string& device) {
+        ComputeEnvironment::instance().selectContext(device);
+        auto& c = ComputeEnvironment::instance().context();
+        c.initiateCalculation(n);
+        auto a = c.createInputVariable(&x[0]);
+        auto b = c.createInputVariable(0.5);
+        auto vs = c.createInputVariates(2, 1, 42);
+        auto d = c.applyOperation(RandomVariableOpCode::Mult, {vs[0][0], b});
+        auto e = c.applyOperation(RandomVariableOpCode::Add, {a, d});
+        c.freeVariable(d);
+        auto f = c.applyOperation(RandomVariableOpCode::Max, {e, vs[1][0]});
+        c.declareOutputVariable(c.applyOperation(RandomVariableOpCode::Exp, {f}));
+        c.declareOutputVariable(vs[0][0]);
+        c.declareOutputVariable(vs[1][0]);
+        std::vector<std::vector<float>> output(3, std::vector<float>(n));
+        c.finalizeCalculation(output);
+        return output;
+    };
+    auto expected = calc("BasicCpu/Default/Default");
+    for (std::size_t i = 0; i < n; i += 100) {
+        BOOST_CHECK_CLOSE(expected[0][i], std::exp(std::max<Real>(x[i] + 0.5 * expected[1][i], expected[2][i])),
+                          1E-3);
+    }
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        BOOST_TEST_MESSAGE("  testing device '" << d << "'.");
+        auto result = calc(d);
+        for (std::size_t k = 0; k < result.size(); ++k) {
+            for (std::size_t i = 0; i < n; i += 100)
+                BOOST_CHECK_CLOSE(result[k][i], expected[k][i], 1E-3);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMultiDeviceContext) {
+    BOOST_TEST_MESSAGE("testing multi device context");
+    // two independent cpu frameworks provide distinct contexts, the sharded calculation must reproduce the
+    // calculation on a single context, including the variates
+    BasicCpuFramework f1, f2, f3;
+    auto single = f1.getContext("BasicCpu/Default/Default");
+    MultiDeviceContext multi({f2.getContext("BasicCpu/Default/Default"), f3.getContext("BasicCpu/Default/Default")});
+    const std::size_t n = 5001;
+    std::vector<double> x(n);
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = 0.001 * i;
+    std::vector<std::vector<std::vector<double>>> results;
+    for (auto c : std::vector<ComputeContext*>{single, &multi}) {
+        c->init();
+        c->setPrecision(ComputeContext::Precision::Double);
+        std::size_t id = 0;
+        // the second run only recreates the inputs
+        for (std::size_t run = 0; run < 2; ++run) {
+            auto [calcId, newCalc] = c->initiateCalculation(n, id);
+            BOOST_CHECK_EQUAL(newCalc, run == 0);
+            id = calcId;
+            auto a = c->createInputVariable(&x[0]);
+            auto b = c->createInputVariable(0.5);
+            auto vs = c->createInputVariates(2, 2, 42);
+            if (newCalc) {
+                auto d = c->applyOperation(RandomVariableOpCode::Mult, {vs[1][1], b});
+                c->declareOutputVariable(c->applyOperation(RandomVariableOpCode::Add, {a, d}));
+                c->freeVariable(d);
+                c->declareOutputVariable(vs[0][0]);
+            }
+            std::vector<std::vector<double>> output(2, std::vector<double>(n));
+            c->finalizeCalculation(output);
+            results.push_back(output);
+        }
+    }
+    for (std::size_t r = 1; r < results.size(); ++r) {
+        for (std::size_t k = 0; k < 2; ++k) {
+            for (std::size_t i = 0; i < n; ++i)
+                BOOST_CHECK_EQUAL(results[r][k][i], results[0][k][i]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -23,6 +23,7 @@
 #include <boost/test/data/test_case.hpp>
 // clang-format on
 #include <qle/methods/multipathgeneratorbase.hpp>
+#include <qle/methods/multipathvariategenerator.hpp>
 #include <qle/models/cdsoptionhelper.hpp>
 #include <qle/models/cirppconstantfellerparametrization.hpp>
 #include <qle/models/commodityschwartzmodel.hpp>
@@ -44,6 +45,8 @@
 #include <qle/models/fxbspiecewiseconstantparametrization.hpp>
 #include <qle/models/fxeqoptionhelper.hpp>
 #include <qle/models/gaussian1dcrossassetadaptor.hpp>
+#include <qle/models/hwbatchsimulator.hpp>
+#include <qle/models/hwconstantparametrization.hpp>
 #include <qle/models/infdkparametrization.hpp>
 #include <qle/models/irlgm1fconstantparametrization.hpp>
 #include <qle/models/irlgm1fparametrization.hpp>
@@ -298,6 +301,37 @@ BOOST_AUTO_TEST_CASE(testNonstandardBermudanSwaption) {
                     << (npv - ns_npv) << ", tolerance is " << tol);
 } // testNonstandardBermudanSwaption
 
+BOOST_AUTO_TEST_CASE(testLgmConvolutionRollback) {
+
+    BOOST_TEST_MESSAGE("Testing LGM convolution solver rollback...");
+
+    BermudanTestData d;
+
+    boost::shared_ptr<IrLgm1fParametrization> lgm_p = boost::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+        EURCurrency(), d.yts, d.stepTimes_a, d.sigmas_a, d.stepTimes_a, d.kappas_a);
+    boost::shared_ptr<LinearGaussMarkovModel> lgm = boost::make_shared<LinearGaussMarkovModel>(lgm_p);
+
+    LgmConvolutionSolver2 solver(lgm, 7.0, 16, 7.0, 32);
+    Real t0 = 2.0, t1 = 5.0;
+    RandomVariable x0 = solver.stateGrid(t0), x1 = solver.stateGrid(t1);
+
+    // the LGM state is a martingale, check in the interior of the grid, away from the flat extrapolation
+    RandomVariable v = solver.rollback(x1, t1, t0);
+    BOOST_REQUIRE_EQUAL(v.size(), solver.gridSize());
+    Size mx = (solver.gridSize() - 1) / 2;
+    for (Size k = mx / 2; k <= 3 * mx / 2; ++k)
+        BOOST_CHECK_SMALL(v[k] - x0[k], 1E-6);
+    BOOST_CHECK_SMALL(solver.rollback(x1, t1, 0.0).at(0), 1E-6);
+
+    // a second rollback over the same step uses the cached operator and gives the same result
+    RandomVariable f = exp(x1);
+    RandomVariable r1 = solver.rollback(f, t1, t0), r2 = solver.rollback(f, t1, t0);
+    for (Size k = 0; k < solver.gridSize(); ++k) {
+        BOOST_CHECK_EQUAL(r1[k], r2[k]);
+        BOOST_CHECK(r1[k] > 0.0);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testLgm1fCalibration) {
 
     BOOST_TEST_MESSAGE("Testing calibration of LGM 1F model (analytic engine) "
@@ -453,6 +487,56 @@ BOOST_AUTO_TEST_CASE(testLgm1fCalibration) {
 
 } // testLgm1fCalibration
 
+BOOST_AUTO_TEST_CASE(testLgm1fCalibrationMultiThreaded) {
+
+    BOOST_TEST_MESSAGE("Testing global calibration of LGM 1F model with concurrent basket pricing...");
+
+    SavedSettings backup;
+
+    Date evalDate(12, January, 2015);
+    Settings::instance().evaluationDate() = evalDate;
+    Handle<YieldTermStructure> yts(boost::make_shared<FlatForward>(evalDate, 0.02, Actual365Fixed()));
+    boost::shared_ptr<IborIndex> euribor6m = boost::make_shared<Euribor>(6 * Months, yts);
+
+    Real impliedVols[] = { 0.4, 0.39, 0.38, 0.35, 0.35, 0.34, 0.33, 0.32, 0.31 };
+
+    Array stepTimes_a(8);
+    for (Size i = 0; i < stepTimes_a.size(); ++i)
+        stepTimes_a[i] = static_cast<Real>(i + 1);
+    Array sigmas_a(stepTimes_a.size() + 1, 0.0050);
+    Array kappas_a(stepTimes_a.size() + 1, 0.05);
+
+    LevenbergMarquardt lm(1E-8, 1E-8, 1E-8);
+    EndCriteria ec(1000, 500, 1E-8, 1E-8, 1E-8);
+
+    // calibrate the same model with 1 and 4 threads, each helper has its own engine
+    Array sigmas[2];
+    Size threads[] = { 1, 4 };
+    for (Size r = 0; r < 2; ++r) {
+        boost::shared_ptr<IrLgm1fParametrization> lgm_p =
+            boost::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(EURCurrency(), yts, stepTimes_a, sigmas_a,
+                                                                         stepTimes_a, kappas_a);
+        boost::shared_ptr<LinearGaussMarkovModel> lgm = boost::make_shared<LinearGaussMarkovModel>(lgm_p);
+        lgm->setCalibrationThreads(threads[r]);
+        BOOST_CHECK_EQUAL(lgm->calibrationThreads(), threads[r]);
+        std::vector<boost::shared_ptr<BlackCalibrationHelper> > basket;
+        for (Size i = 0; i < 9; ++i) {
+            basket.push_back(boost::make_shared<SwaptionHelper>(
+                (i + 1) * Years, (9 - i) * Years, Handle<Quote>(boost::make_shared<SimpleQuote>(impliedVols[i])),
+                euribor6m, 1 * Years, Thirty360(Thirty360::BondBasis), Actual360(), yts));
+            basket.back()->setPricingEngine(boost::make_shared<AnalyticLgmSwaptionEngine>(lgm));
+        }
+        lgm->calibrateVolatilities(basket, lm, ec);
+        sigmas[r] = lgm->parametrization()->parameterValues(0);
+        for (Size i = 0; i < basket.size(); ++i)
+            BOOST_CHECK_SMALL(basket[i]->modelValue() - basket[i]->marketValue(), 1E-6);
+    }
+
+    for (Size i = 0; i < sigmas[0].size(); ++i)
+        BOOST_CHECK_CLOSE(sigmas[0][i], sigmas[1][i], 1E-10);
+
+} // testLgm1fCalibrationMultiThreaded
+
 BOOST_AUTO_TEST_CASE(testCcyLgm3fForeignPayouts) {
 
     BOOST_TEST_MESSAGE("Testing pricing of foreign payouts under domestic "
@@ -1310,6 +1394,132 @@ BOOST_AUTO_TEST_CASE(testLgm5fMoments) {
 
 } // testLgm5fMoments
 
+BOOST_AUTO_TEST_CASE(testLgm5fPathGeneratorSkipAhead) {
+
+    BOOST_TEST_MESSAGE("Testing skip ahead and block generation of multi path generators in Ccy LGM 5F model...");
+
+    Lgm5fTestData d;
+    boost::shared_ptr<StochasticProcess> p = d.ccLgmExact->stateProcess();
+    TimeGrid grid(5.0, 10);
+    const Size paths = 20, a = 7, b = 15;
+
+    for (auto s : {MersenneTwister, MersenneTwisterAntithetic, Sobol, SobolBrownianBridge, Philox}) {
+        BOOST_TEST_MESSAGE("sequence type " << s);
+        auto pgen = makeMultiPathGenerator(s, p, grid, 42);
+        vector<MultiPath> reference;
+        for (Size k = 0; k < paths; ++k)
+            reference.push_back(pgen->next().value);
+
+        MultiPathBlock block;
+        pgen->nextBlock(a, b, block);
+        BOOST_REQUIRE_EQUAL(block.size(), p->size());
+        for (Size j = 0; j < block.size(); ++j) {
+            BOOST_REQUIRE_EQUAL(block[j].size(), grid.size());
+            for (Size i = 0; i < grid.size(); ++i) {
+                BOOST_REQUIRE_EQUAL(block[j][i].size(), b - a);
+                for (Size k = a; k < b; ++k)
+                    BOOST_CHECK_CLOSE(block[j][i][k - a], reference[k][j][i], 1E-10);
+            }
+        }
+
+        // the generator continues with path b after the block, and can be positioned backwards
+        Sample<MultiPath> next = pgen->next();
+        BOOST_CHECK_CLOSE(next.value[0].back(), reference[b][0].back(), 1E-10);
+        pgen->skipTo(3);
+        next = pgen->next();
+        BOOST_CHECK_CLOSE(next.value[0].back(), reference[3][0].back(), 1E-10);
+    }
+
+    // the Philox draws are uniform in (0,1) and a pure function of seed, sequence and component
+    PhiloxRsg rsg(5, 42);
+    IncrementalStatistics uniformStats;
+    for (Size k = 0; k < 20000; ++k) {
+        const vector<Real>& u = rsg.nextSequence().value;
+        for (Size i = 0; i < u.size(); ++i) {
+            BOOST_REQUIRE(u[i] > 0.0 && u[i] < 1.0);
+            uniformStats.add(u[i]);
+        }
+    }
+    BOOST_CHECK_SMALL(uniformStats.mean() - 0.5, 0.005);
+    BOOST_CHECK_SMALL(uniformStats.variance() - 1.0 / 12.0, 0.002);
+    rsg.skipTo(1234);
+    BOOST_CHECK_EQUAL(rsg.nextSequence().value[3], PhiloxRsg::uniform(42, 1234, 3));
+}
+
+BOOST_AUTO_TEST_CASE(testLgm5fBlockEvolution) {
+
+    BOOST_TEST_MESSAGE("Testing block evolution of the state process in Ccy LGM 5F model...");
+
+    Lgm5fTestData d;
+    TimeGrid grid(10.0, 20);
+    const Size samples = 50;
+
+    for (auto const& model : {d.ccLgmExact, d.ccLgmEuler}) {
+        auto p = boost::dynamic_pointer_cast<CrossAssetStateProcess>(model->stateProcess());
+        BOOST_REQUIRE(p);
+        MultiPathVariateGeneratorPhilox gen(p->factors(), grid, 42);
+        Matrix x0(p->size(), samples), x1, dw(p->factors(), samples);
+        Array init = p->initialValues();
+        for (Size l = 0; l < samples; ++l)
+            std::copy(init.begin(), init.end(), x0.column_begin(l));
+        vector<vector<Array>> variates(samples);
+        for (Size l = 0; l < samples; ++l)
+            variates[l] = gen.next().value;
+        vector<Array> reference(samples, init);
+
+        for (Size i = 0; i < grid.size() - 1; ++i) {
+            for (Size l = 0; l < samples; ++l) {
+                std::copy(variates[l][i].begin(), variates[l][i].end(), dw.column_begin(l));
+                reference[l] = p->evolve(grid[i], reference[l], grid.dt(i), variates[l][i]);
+            }
+            p->evolveBlock(grid, i, x0, dw, x1);
+            std::swap(x0, x1);
+            for (Size l = 0; l < samples; ++l) {
+                for (Size k = 0; k < p->size(); ++k)
+                    BOOST_CHECK_SMALL(x0[k][l] - reference[l][k], 1E-12);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testLgm5fIntegralCache) {
+
+    BOOST_TEST_MESSAGE("Testing integral cache in Ccy LGM 5F model...");
+
+    Lgm5fTestData d;
+    const CrossAssetModel* m = d.ccLgmExact.get();
+    using namespace CrossAssetAnalytics;
+
+    auto covariances = [m]() {
+        return std::vector<Real>{ir_ir_covariance(m, 0, 1, 1.0, 4.0), ir_fx_covariance(m, 1, 0, 1.0, 4.0),
+                                 fx_fx_covariance(m, 0, 1, 1.0, 4.0), fx_fx_covariance(m, 1, 1, 0.0, 10.0)};
+    };
+
+    BOOST_REQUIRE(m->integralCache());
+    std::vector<Real> first = covariances(), cached = covariances();
+    m->enableIntegralCache(false);
+    std::vector<Real> uncached = covariances();
+    for (Size i = 0; i < first.size(); ++i) {
+        BOOST_CHECK_EQUAL(first[i], cached[i]);
+        BOOST_CHECK_EQUAL(first[i], uncached[i]);
+    }
+
+    // a change of the parameters clears the cache
+    m->enableIntegralCache(true);
+    covariances();
+    Array p = d.ccLgmExact->params();
+    for (Size i = 0; i < p.size(); ++i)
+        p[i] *= 1.1;
+    d.ccLgmExact->setParams(p);
+    cached = covariances();
+    m->enableIntegralCache(false);
+    uncached = covariances();
+    for (Size i = 0; i < first.size(); ++i) {
+        BOOST_CHECK_EQUAL(cached[i], uncached[i]);
+        BOOST_CHECK(std::abs(cached[i] - first[i]) > 1E-10);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testLgmGsrEquivalence) {
 
     BOOST_TEST_MESSAGE("Testing equivalence of GSR and LGM models...");
@@ -4697,6 +4907,77 @@ BOOST_AUTO_TEST_CASE(testCrCalibration) {
     }
 } // testCrCalibration
 
+BOOST_AUTO_TEST_CASE(testHwBatchSimulation) {
+
+    BOOST_TEST_MESSAGE("Testing batched simulation of the HW nF model against its state process...");
+
+    Handle<YieldTermStructure> yts(boost::make_shared<FlatForward>(0, NullCalendar(), 0.02, Actual365Fixed()));
+    Matrix sigma(2, 3, 0.0);
+    sigma[0][0] = 0.0080;
+    sigma[0][1] = 0.0020;
+    sigma[1][1] = 0.0070;
+    sigma[1][2] = 0.0030;
+    Array kappa(3);
+    kappa[0] = 0.01;
+    kappa[1] = 0.10;
+    kappa[2] = 0.50;
+    auto model = boost::make_shared<HwModel>(boost::make_shared<IrHwConstantParametrization>(EURCurrency(), yts, sigma,
+                                                                                             kappa));
+    auto process = model->stateProcess();
+    TimeGrid grid(5.0, 20);
+    HwBatchSimulator simulator(model, grid);
+    BOOST_REQUIRE_EQUAL(simulator.size(), process->size());
+    BOOST_REQUIRE_EQUAL(simulator.factors(), process->factors());
+
+    const Size nSamples = 50;
+    MersenneTwisterUniformRng mt(42);
+    InverseCumulativeNormal icn;
+    std::vector<std::vector<RandomVariable>> dw(
+        grid.size() - 1, std::vector<RandomVariable>(process->factors(), RandomVariable(nSamples)));
+    for (auto& step : dw)
+        for (auto& z : step)
+            for (Size p = 0; p < nSamples; ++p)
+                z.set(p, icn(mt.nextReal()));
+
+    auto paths = simulator.simulate(dw);
+    BOOST_REQUIRE_EQUAL(paths.size(), grid.size());
+
+    Real tol = 1.0E-12;
+    for (Size p = 0; p < nSamples; ++p) {
+        Array state = process->initialValues();
+        for (Size k = 0; k + 1 < grid.size(); ++k) {
+            Array z(process->factors());
+            for (Size j = 0; j < z.size(); ++j)
+                z[j] = dw[k][j][p];
+            state = process->evolve(grid[k], state, grid.dt(k), z);
+            for (Size i = 0; i < state.size(); ++i) {
+                if (std::abs(paths[k + 1][i][p] - state[i]) > tol)
+                    BOOST_ERROR("batched path " << p << " state " << i << " at t=" << grid[k + 1] << " ("
+                                                << paths[k + 1][i][p] << ") differs from state process (" << state[i]
+                                                << ")");
+            }
+        }
+    }
+
+    // the mean of the state is the path with zero variates, since the step is affine in the state
+
+    const Size nDeviceSamples = 10000;
+    auto devicePaths = simulator.simulate("BasicCpu/Default/Default", nDeviceSamples, 42);
+    std::vector<std::vector<RandomVariable>> zero(
+        grid.size() - 1, std::vector<RandomVariable>(process->factors(), RandomVariable(1, 0.0)));
+    auto meanPath = simulator.simulate(zero);
+    const Size l = grid.size() - 1;
+    for (Size i = 0; i < simulator.size(); ++i) {
+        Real sampleMean = expectation(devicePaths[l][i])[0];
+        Real sampleStdDev = std::sqrt(
+            (expectation(devicePaths[l][i] * devicePaths[l][i])[0] - sampleMean * sampleMean) / nDeviceSamples);
+        if (std::abs(sampleMean - meanPath[l][i][0]) > 4.0 * sampleStdDev)
+            BOOST_ERROR("device sample mean of state " << i << " (" << sampleMean << ") differs from the mean ("
+                                                       << meanPath[l][i][0] << ") by more than 4 standard errors ("
+                                                       << sampleStdDev << ")");
+    }
+} // testHwBatchSimulation
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
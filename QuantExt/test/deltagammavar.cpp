@@ -22,10 +22,14 @@
 #include <qle/math/deltagammavar.hpp>
 
 #include <qle/math/deltagammavar.hpp>
+#include <qle/math/salvagedmatrixcache.hpp>
+#include <qle/math/tailstatistics.hpp>
 
 #include <boost/make_shared.hpp>
 #include <boost/math/distributions/chi_squared.hpp>
 
+#include <cstdio>
+
 using namespace QuantLib;
 using namespace QuantExt;
 
@@ -317,6 +321,180 @@ BOOST_AUTO_TEST_CASE(testCase003) {
     BOOST_CHECK_CLOSE(sdvar, mcvar, 1.0);
 }
 
+BOOST_AUTO_TEST_CASE(testQuasiMonteCarloAndThreads) {
+
+    BOOST_TEST_MESSAGE("Testing delta gamma MC VaR with Sobol sequences and several threads...");
+
+    const Size dim = 10;
+    MersenneTwisterUniformRng mt(42);
+    Matrix L(dim, dim);
+    for (Size i = 0; i < dim; ++i)
+        for (Size j = 0; j < dim; ++j)
+            L[i][j] = mt.nextReal();
+    Matrix omega = transpose(L) * L;
+    omega /= QuantExt::detail::absMax(omega) * 10.0;
+    Array delta(dim);
+    Matrix gamma(dim, dim), nullGamma(dim, dim, 0.0);
+    for (Size i = 0; i < dim; ++i) {
+        delta[i] = mt.nextReal() * 1000.0 - 500.0;
+        for (Size j = 0; j <= i; ++j)
+            gamma[i][j] = gamma[j][i] = mt.nextReal() * 1000.0;
+    }
+
+    vector<Real> quantiles = {0.95, 0.99};
+    Size paths = 100000;
+
+    // the result does not depend on the number of threads
+    auto mc1 = deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, quantiles, paths, 42);
+    auto mc4 = deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, quantiles, paths, 42, NoCovarianceSalvage(), 4);
+    auto qmc1 = deltaGammaVarMc<LowDiscrepancy>(omega, delta, gamma, quantiles, paths, 42);
+    auto qmc4 = deltaGammaVarMc<LowDiscrepancy>(omega, delta, gamma, quantiles, paths, 42, NoCovarianceSalvage(), 4);
+    auto qmcDelta = deltaGammaVarMc<LowDiscrepancy>(omega, delta, nullGamma, quantiles, paths, 42);
+
+    for (Size i = 0; i < quantiles.size(); ++i) {
+        BOOST_CHECK_EQUAL(mc1[i], mc4[i]);
+        BOOST_CHECK_EQUAL(qmc1[i], qmc4[i]);
+        BOOST_CHECK_CLOSE(qmcDelta[i], deltaVar(omega, delta, quantiles[i]), 0.5);
+        BOOST_CHECK_CLOSE(qmc1[i], deltaGammaVarSaddlepoint(omega, delta, gamma, quantiles[i]), 5.0);
+        BOOST_CHECK_CLOSE(qmc1[i], mc1[i], 5.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMultipleQuantiles) {
+
+    BOOST_TEST_MESSAGE("Testing analytic delta gamma VaR for several quantiles...");
+
+    Matrix omega(3, 3, 0.0);
+    omega[0][0] = 0.04;
+    omega[1][1] = 0.09;
+    omega[2][2] = 0.01;
+    omega[0][1] = omega[1][0] = 0.018;
+    omega[1][2] = omega[2][1] = -0.009;
+    Array delta(3);
+    delta[0] = 100.0;
+    delta[1] = -50.0;
+    delta[2] = 200.0;
+    Matrix gamma(3, 3, 0.0);
+    gamma[0][0] = 400.0;
+    gamma[1][1] = -300.0;
+    gamma[2][2] = 100.0;
+    gamma[0][2] = gamma[2][0] = 50.0;
+
+    vector<Real> p = {0.9, 0.99, 0.999};
+    SpectralCovarianceSalvage sal;
+    auto dVar = deltaVar(omega, delta, p, sal);
+    auto dgVarN = deltaGammaVarNormal(omega, delta, gamma, p, sal);
+    auto dgVarCf = deltaGammaVarCornishFisher(omega, delta, gamma, p, sal);
+    auto dgVarSd = deltaGammaVarSaddlepoint(omega, delta, gamma, p, sal);
+    for (Size i = 0; i < p.size(); ++i) {
+        BOOST_CHECK_CLOSE(dVar[i], deltaVar(omega, delta, p[i], sal), 1E-12);
+        BOOST_CHECK_CLOSE(dgVarN[i], deltaGammaVarNormal(omega, delta, gamma, p[i], sal), 1E-12);
+        BOOST_CHECK_CLOSE(dgVarCf[i], deltaGammaVarCornishFisher(omega, delta, gamma, p[i], sal), 1E-12);
+        BOOST_CHECK_CLOSE(dgVarSd[i], deltaGammaVarSaddlepoint(omega, delta, gamma, p[i], sal), 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testTailStatistics) {
+
+    BOOST_TEST_MESSAGE("Testing right tail quantiles and expected shortfalls...");
+
+    // a permutation of 1, ..., 1000
+    vector<Real> sample(1000);
+    for (Size i = 0; i < sample.size(); ++i)
+        sample[i] = static_cast<Real>((7 * i) % 1000 + 1);
+
+    vector<Real> p = {0.75, 0.5};
+    TailStatistics res = rightTailStatistics(sample, p);
+    BOOST_CHECK_EQUAL(res.quantiles[0], 751.0);
+    BOOST_CHECK_EQUAL(res.quantiles[1], 501.0);
+    BOOST_CHECK_CLOSE(res.expectedShortfalls[0], 875.5, 1E-12);
+    BOOST_CHECK_CLOSE(res.expectedShortfalls[1], 750.5, 1E-12);
+
+    // equal weights give the same result
+    TailStatistics resWeighted = rightTailStatistics(sample, p, vector<Real>(sample.size(), 3.0));
+    for (Size i = 0; i < p.size(); ++i) {
+        BOOST_CHECK_EQUAL(resWeighted.quantiles[i], res.quantiles[i]);
+        BOOST_CHECK_CLOSE(resWeighted.expectedShortfalls[i], res.expectedShortfalls[i], 1E-10);
+    }
+
+    // the quantile enters the expected shortfall partially
+    vector<Real> x = {1.0, 2.0, 3.0, 4.0}, w = {1.0, 1.0, 1.0, 5.0};
+    res = rightTailStatistics(x, {0.5, 0.25}, w);
+    BOOST_CHECK_EQUAL(res.quantiles[0], 4.0);
+    BOOST_CHECK_EQUAL(res.quantiles[1], 3.0);
+    BOOST_CHECK_CLOSE(res.expectedShortfalls[0], 4.0, 1E-12);
+    BOOST_CHECK_CLOSE(res.expectedShortfalls[1], (0.625 * 4.0 + 0.125 * 3.0) / 0.75, 1E-12);
+
+    BOOST_CHECK_THROW(rightTailStatistics(x, {1.0}), QuantLib::Error);
+    BOOST_CHECK_THROW(rightTailStatistics(vector<Real>(), {0.99}), QuantLib::Error);
+    BOOST_CHECK_THROW(rightTailStatistics(x, {0.99}, {1.0}), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testSalvagedMatrixCache) {
+
+    BOOST_TEST_MESSAGE("Testing salvaged matrix cache...");
+
+    // a correlation matrix that is not positive semidefinite
+    Matrix rho(3, 3, 1.0);
+    rho[0][1] = rho[1][0] = 0.9;
+    rho[0][2] = rho[2][0] = 0.9;
+    rho[1][2] = rho[2][1] = -0.9;
+
+    SalvagedMatrixCache& cache = SalvagedMatrixCache::instance();
+    cache.enable(2);
+    BOOST_CHECK(cache.enabled());
+
+    SpectralCovarianceSalvage sal;
+    auto res1 = sal.salvage(rho);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    auto res2 = sal.salvage(rho);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 3; ++j) {
+            BOOST_CHECK_EQUAL(res1.first[i][j], res2.first[i][j]);
+            BOOST_CHECK_EQUAL(res1.second[i][j], res2.second[i][j]);
+        }
+    }
+
+    // a different matrix is not found
+    Matrix rho2 = rho;
+    rho2[1][2] = rho2[2][1] = -0.8;
+    std::pair<Matrix, Matrix> tmp;
+    BOOST_CHECK(!cache.get("spectralCovarianceSalvage", rho2, tmp));
+
+    // the square roots agree with QuantLib's pseudoSqrt, the oldest entry is dropped
+    Matrix s1 = cachedPseudoSqrt(rho2, SalvagingAlgorithm::Spectral);
+    Matrix s2 = cachedPseudoSqrt(rho2, SalvagingAlgorithm::Spectral);
+    Matrix s3 = pseudoSqrt(rho2, SalvagingAlgorithm::Spectral);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 3; ++j) {
+            BOOST_CHECK_EQUAL(s1[i][j], s2[i][j]);
+            BOOST_CHECK_EQUAL(s1[i][j], s3[i][j]);
+        }
+    }
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    cachedPseudoSqrt(rho2, SalvagingAlgorithm::Hypersphere);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(!cache.get("spectralCovarianceSalvage", rho, tmp));
+
+    // save and load
+    std::string fileName = "salvagedmatrixcache.bin";
+    cache.save(fileName);
+    cache.disable();
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    cache.enable(10);
+    cache.load(fileName);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.get("pseudoSqrt_" + std::to_string(static_cast<int>(SalvagingAlgorithm::Spectral)), rho2, tmp));
+    for (Size i = 0; i < 3; ++i)
+        for (Size j = 0; j < 3; ++j)
+            BOOST_CHECK_EQUAL(tmp.second[i][j], s1[i][j]);
+    std::remove(fileName.c_str());
+
+    cache.disable();
+    BOOST_CHECK(!cache.enabled());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -81,6 +81,46 @@ BOOST_AUTO_TEST_CASE(testDiscountCurve) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testDiscountCurveQueryTimes) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::InterpolatedDiscountCurve2 with registered query times...");
+
+    SavedSettings backup;
+    Settings::instance().evaluationDate() = Date(1, Dec, 2015);
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    vector<Real> times;
+    vector<boost::shared_ptr<SimpleQuote> > simpleQuotes;
+    vector<Handle<Quote> > quotes;
+    for (Size i = 0; i < 30; i++) {
+        times.push_back(static_cast<Real>(i));
+        simpleQuotes.push_back(boost::make_shared<SimpleQuote>(::exp(-(0.01 + i * 0.001) * times.back())));
+        quotes.push_back(Handle<Quote>(simpleQuotes.back()));
+    }
+
+    vector<Time> queryTimes;
+    for (Time t = 0.05; t < 40.0; t += 0.25)
+        queryTimes.push_back(t);
+
+    for (auto interpolation : { QuantExt::InterpolatedDiscountCurve2::Interpolation::logLinear,
+                                QuantExt::InterpolatedDiscountCurve2::Interpolation::linearZero }) {
+        QuantExt::InterpolatedDiscountCurve2 ytsBase(times, quotes, dc, interpolation);
+        QuantExt::InterpolatedDiscountCurve2 ytsTest(times, quotes, dc, interpolation);
+        ytsTest.registerQueryTimes(queryTimes);
+        BOOST_CHECK_EQUAL(ytsTest.queryTimes().size(), queryTimes.size());
+
+        // the cached discount factors follow the quotes
+        for (Real shift : { 1.0, 0.99 }) {
+            for (auto const& q : simpleQuotes)
+                q->setValue(q->value() * shift);
+            for (auto const& t : queryTimes)
+                BOOST_CHECK_CLOSE(ytsBase.discount(t), ytsTest.discount(t), 1e-10);
+            // times which are not registered are interpolated as usual
+            BOOST_CHECK_CLOSE(ytsBase.discount(12.34), ytsTest.discount(12.34), 1e-12);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
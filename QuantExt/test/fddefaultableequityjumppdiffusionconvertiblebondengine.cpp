@@ -111,6 +111,86 @@ BOOST_AUTO_TEST_CASE(test_vanilla_bond) {
     BOOST_CHECK_CLOSE(vanillaEngineNpv, convertibleEngineNpv, 1E-3);
 }
 
+BOOST_AUTO_TEST_CASE(test_grid_reuse_and_richardson_extrapolation) {
+
+    BOOST_TEST_MESSAGE("Test grid reuse and Richardson extrapolation in fd defaultable equity jump diffusion "
+                       "convertible engine...");
+
+    Date today(9, February, 2021);
+    Settings::instance().evaluationDate() = today;
+
+    Real S0 = 100.0;
+    Handle<YieldTermStructure> rate(boost::make_shared<FlatForward>(0, NullCalendar(), 0.01, Actual365Fixed()));
+    Handle<YieldTermStructure> dividend(boost::make_shared<FlatForward>(0, NullCalendar(), 0.02, Actual365Fixed()));
+    Handle<BlackVolTermStructure> vol(boost::make_shared<BlackConstantVol>(0, NullCalendar(), 0.3, Actual365Fixed()));
+
+    auto benchmarkRate = boost::make_shared<SimpleQuote>(0.03);
+    Handle<YieldTermStructure> bondBenchmark(
+        boost::make_shared<FlatForward>(0, NullCalendar(), Handle<Quote>(benchmarkRate), Actual365Fixed()));
+    Handle<DefaultProbabilityTermStructure> creditCurve(
+        boost::make_shared<FlatHazardRate>(0, NullCalendar(), 0.0050, Actual365Fixed()));
+    Handle<Quote> bondRecoveryRate(boost::make_shared<SimpleQuote>(0.25));
+    Handle<Quote> securitySpread(boost::make_shared<SimpleQuote>(0.00));
+
+    auto equity = boost::make_shared<EquityIndex2>("myEqIndex", NullCalendar(), EURCurrency(),
+                                                  Handle<Quote>(boost::make_shared<SimpleQuote>(S0)), rate, dividend);
+
+    auto bond = boost::make_shared<FixedRateBond>(0, TARGET(), 100000.0, today, today + 5 * Years, 1 * Years,
+                                                  std::vector<Real>(1, 0.05), Thirty360(Thirty360::BondBasis));
+    bond->setPricingEngine(boost::make_shared<DiscountingRiskyBondEngine>(bondBenchmark, creditCurve,
+                                                                          bondRecoveryRate, securitySpread, 1 * Years));
+
+    auto modelBuilder = boost::make_shared<DefaultableEquityJumpDiffusionModelBuilder>(
+        std::vector<Real>{1.0, 2.0, 3.0, 4.0, 5.0}, equity, vol, creditCurve, 0.0, 1.0, false, 24, 400, 1E-5, 1.5,
+        Null<Real>(), DefaultableEquityJumpDiffusionModelBuilder::BootstrapMode::Simultaneously, true);
+    auto model = modelBuilder->model();
+
+    auto cpns = bond->cashflows();
+    cpns.erase(
+        std::remove_if(cpns.begin(), cpns.end(),
+                       [](boost::shared_ptr<CashFlow> c) { return boost::dynamic_pointer_cast<Coupon>(c) == nullptr; }),
+        cpns.end());
+
+    auto makeBond = [&bond, &cpns]() {
+        return boost::make_shared<ConvertibleBond2>(bond->settlementDays(), bond->calendar(), bond->issueDate(), cpns);
+    };
+    auto makeEngine = [&](const Size timeStepsPerYear, const Size stateGridPoints, const bool richardson) {
+        return boost::make_shared<FdDefaultableEquityJumpDiffusionConvertibleBondEngine>(
+            model, bondBenchmark, securitySpread, Handle<DefaultProbabilityTermStructure>(), bondRecoveryRate,
+            Handle<FxIndex>(), false, timeStepsPerYear, stateGridPoints, 1E-4, 1.5,
+            std::vector<Real>{0.1, 0.5, 0.7, 0.9, 1.0, 1.1, 1.3, 1.5, 2.0, 5.0, 10.0}, false, richardson);
+    };
+
+    // reprice after a bump of the bond benchmark curve, which keeps the grid and the operator, and compare with a
+    // pricing on a newly built engine
+
+    auto convertibleBond = makeBond();
+    convertibleBond->setPricingEngine(makeEngine(24, 100, false));
+    convertibleBond->NPV();
+    benchmarkRate->setValue(0.031);
+    Real npvReused = convertibleBond->NPV();
+
+    auto convertibleBond2 = makeBond();
+    convertibleBond2->setPricingEngine(makeEngine(24, 100, false));
+    Real npvNew = convertibleBond2->NPV();
+
+    BOOST_TEST_MESSAGE("NPV after bump with reused grid = " << std::setprecision(10) << npvReused
+                                                            << ", with new engine = " << npvNew);
+    BOOST_CHECK_CLOSE(npvReused, npvNew, 1E-10);
+
+    // the extrapolated price on a coarse grid should be close to the vanilla bond price
+
+    Real vanillaEngineNpv = bond->NPV();
+    auto convertibleBond3 = makeBond();
+    convertibleBond3->setPricingEngine(makeEngine(12, 50, true));
+    Real npvRichardson = convertibleBond3->NPV();
+
+    BOOST_TEST_MESSAGE("Vanilla Engine Bond NPV = " << vanillaEngineNpv
+                                                    << ", Richardson extrapolated NPV on coarse grid = "
+                                                    << npvRichardson);
+    BOOST_CHECK_CLOSE(vanillaEngineNpv, npvRichardson, 1E-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
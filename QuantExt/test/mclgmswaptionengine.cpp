@@ -29,6 +29,7 @@
 #include <qle/pricingengines/numericlgmmultilegoptionengine.hpp>
 
 #include <qle/pricingengines/mclgmswaptionengine.hpp>
+#include <qle/pricingengines/mcmultilegpathcache.hpp>
 
 #include <ql/currencies/europe.hpp>
 #include <ql/indexes/ibor/euribor.hpp>
@@ -162,6 +163,27 @@ BOOST_AUTO_TEST_CASE(testAgainstSwaptionEngines) {
     BOOST_CHECK_SMALL(std::fabs(npvGsr - npvLgm), tol);
     BOOST_CHECK_SMALL(std::fabs(npvGsr - npvLgm2), tol);
     BOOST_CHECK_SMALL(std::fabs(npvGsr - npvLgmMc), tol);
+
+    // the paths do not depend on the number of threads used to value the underlying
+    boost::shared_ptr<PricingEngine> swaptionEngineLgmMcMt = boost::make_shared<McLgmSwaptionEngine>(
+        lgm, MersenneTwisterAntithetic, SobolBrownianBridge, tSamples, pSamples, 42, 43, polynomOrder, polynomType,
+        SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, Handle<YieldTermStructure>(), std::vector<Date>(),
+        std::vector<Size>(), true, false, std::string(), 4);
+    swaption->setPricingEngine(swaptionEngineLgmMcMt);
+    BOOST_CHECK_CLOSE(swaption->NPV(), npvLgmMc, 1E-10);
+    BOOST_CHECK_CLOSE(swaption->result<Real>("underlyingNpv"), undNpvMc, 1E-10);
+
+    // nor on whether they are shared between engines via the path cache
+    McMultiLegPathCache::instance().enable(2);
+    for (Size i = 0; i < 2; ++i) {
+        swaption->setPricingEngine(boost::make_shared<McLgmSwaptionEngine>(
+            lgm, MersenneTwisterAntithetic, SobolBrownianBridge, tSamples, pSamples, 42, 43, polynomOrder,
+            polynomType));
+        BOOST_CHECK_CLOSE(swaption->NPV(), npvLgmMc, 1E-8);
+    }
+    BOOST_CHECK_EQUAL(McMultiLegPathCache::instance().size(), 2);
+    McMultiLegPathCache::instance().disable();
+    BOOST_CHECK_EQUAL(McMultiLegPathCache::instance().size(), 0);
 } // testAgainstSwaptionEngines
 
 BOOST_AUTO_TEST_SUITE_END()
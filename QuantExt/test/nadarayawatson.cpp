@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2023 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/kernelfunctions.hpp>
+#include <ql/math/randomnumbers/inversecumulativerng.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <qle/math/nadarayawatson.hpp>
+
+using namespace boost::unit_test_framework;
+using namespace QuantLib;
+using namespace QuantExt;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(NadarayaWatsonTest)
+
+BOOST_AUTO_TEST_CASE(testBinnedVersusExact) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::BinnedNadarayaWatson against exact Nadaraya-Watson regression...");
+
+    Size n = 10000;
+    Real bandWidth = 0.2;
+    InverseCumulativeRng<MersenneTwisterUniformRng, InverseCumulativeNormal> rng(MersenneTwisterUniformRng(42));
+    std::vector<Real> x(n), y(n);
+    for (Size i = 0; i < n; ++i) {
+        x[i] = rng.next().value;
+        y[i] = x[i] * x[i] + 0.5 * rng.next().value;
+    }
+
+    GaussianKernel kernel(0.0, bandWidth);
+    NadarayaWatson exact(x.begin(), x.end(), y.begin(), kernel);
+    BinnedNadarayaWatson binned(x.begin(), x.end(), y.begin(), kernel, 6.0 * bandWidth, 401);
+
+    for (Real t = -2.5; t <= 2.5; t += 0.1) {
+        BOOST_CHECK_SMALL(binned(t) - exact(t), 1.0E-2);
+        BOOST_CHECK_SMALL(binned.standardDeviation(t) - exact.standardDeviation(t), 1.0E-2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBinnedDegenerate) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::BinnedNadarayaWatson with identical x values...");
+
+    std::vector<Real> x(5, 1.0), y = {1.0, 2.0, 3.0, 4.0, 5.0};
+    GaussianKernel kernel(0.0, 0.5);
+    NadarayaWatson exact(x.begin(), x.end(), y.begin(), kernel);
+    BinnedNadarayaWatson binned(x.begin(), x.end(), y.begin(), kernel, 3.0);
+
+    for (Real t : {0.0, 1.0, 1.5}) {
+        BOOST_CHECK_CLOSE(binned(t), exact(t), 1.0E-8);
+        BOOST_CHECK_CLOSE(binned.standardDeviation(t), exact.standardDeviation(t), 1.0E-8);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
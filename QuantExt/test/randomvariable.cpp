@@ -24,6 +24,9 @@
 // clang-format on
 
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_expression.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_tape.hpp>
 
 #include <ql/time/date.hpp>
 #include <ql/pricingengines/blackformula.hpp>
@@ -31,7 +34,9 @@
 #include <boost/math/distributions/normal.hpp>
 
 #include <iostream>
+#include <cstdint>
 #include <iomanip>
+#include <limits>
 
 using namespace QuantExt;
 using namespace QuantLib;
@@ -97,6 +102,53 @@ BOOST_AUTO_TEST_CASE(testFilter) {
     BOOST_CHECK_THROW(r.at(100), QuantLib::Error);
 }
 
+BOOST_AUTO_TEST_CASE(testFilterWordOperations) {
+    BOOST_TEST_MESSAGE("Testing bit packed filter operations...");
+
+    // the size is not a multiple of the word size
+    Size n = 150;
+    Filter f(n, false), g(n, false);
+    for (Size i = 0; i < n; ++i) {
+        f.set(i, i % 3 == 0);
+        g.set(i, i % 2 == 0);
+    }
+
+    Filter a = f && g, o = f || g, e = equal(f, g), nf = !f;
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(a[i], i % 6 == 0);
+        BOOST_CHECK_EQUAL(o[i], i % 3 == 0 || i % 2 == 0);
+        BOOST_CHECK_EQUAL(e[i], (i % 3 == 0) == (i % 2 == 0));
+        BOOST_CHECK_EQUAL(nf[i], i % 3 != 0);
+    }
+
+    BOOST_CHECK_EQUAL(f.count(), 50u);
+    BOOST_CHECK_EQUAL(nf.count(), 100u);
+    BOOST_CHECK_EQUAL((!e).count(), n - e.count());
+    BOOST_CHECK(f.any());
+    BOOST_CHECK(!f.all());
+    BOOST_CHECK((f || nf).all());
+    BOOST_CHECK(!(f && nf).any());
+    BOOST_CHECK_EQUAL(Filter(n, true).count(), n);
+
+    Filter t = f || nf;
+    BOOST_CHECK(!t.deterministic());
+    t.updateDeterministic();
+    BOOST_CHECK(t.deterministic());
+    BOOST_CHECK(t == Filter(n, true));
+
+    // mask blends
+    RandomVariable x(n), y(n, -1.0);
+    for (Size i = 0; i < n; ++i)
+        x.set(i, static_cast<double>(i));
+    RandomVariable c = conditionalResult(f, x, y), p = applyFilter(x, f), q = applyInverseFilter(x, f), r(f, 2.0, 3.0);
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(c[i], i % 3 == 0 ? x[i] : -1.0);
+        BOOST_CHECK_EQUAL(p[i], i % 3 == 0 ? x[i] : 0.0);
+        BOOST_CHECK_EQUAL(q[i], i % 3 == 0 ? 0.0 : x[i]);
+        BOOST_CHECK_EQUAL(r[i], i % 3 == 0 ? 2.0 : 3.0);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testRandomVariable) {
     BOOST_TEST_MESSAGE("Testing random variable...");
 
@@ -161,6 +213,239 @@ BOOST_AUTO_TEST_CASE(testFunctions) {
     BOOST_CHECK_CLOSE((normalPdf(X)).at(0), boost::math::pdf(n, x), tol);
 }
 
+BOOST_AUTO_TEST_CASE(testKernels) {
+    BOOST_TEST_MESSAGE("Testing random variable kernels...");
+
+    double tol = 1E-12;
+    Size n = 1001;
+    boost::math::normal_distribution<double> nd;
+    RandomVariable X(n), Y(n);
+    for (Size i = 0; i < n; ++i) {
+        X.set(i, -30.0 + 60.0 * static_cast<double>(i) / static_cast<double>(n - 1));
+        Y.set(i, 1E-6 + static_cast<double>(i));
+    }
+
+    RandomVariable e = exp(X), l = log(Y), s = sqrt(Y), c = normalCdf(X), p = normalPdf(X);
+    RandomVariable m = max(X, RandomVariable(n, 1.0)), a = abs(X), q = X / Y;
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_CLOSE(e[i], std::exp(X[i]), tol);
+        BOOST_CHECK_CLOSE(l[i], std::log(Y[i]), tol);
+        BOOST_CHECK_CLOSE(s[i], std::sqrt(Y[i]), tol);
+        // boost computes erfc(-x / sqrt(2)), the error of the scaled argument is amplified in the tails
+        BOOST_CHECK_CLOSE(c[i], boost::math::cdf(nd, X[i]), 1E-10);
+        BOOST_CHECK_CLOSE(p[i], boost::math::pdf(nd, X[i]), 1E-10);
+        BOOST_CHECK_EQUAL(m[i], std::max(X[i], 1.0));
+        BOOST_CHECK_EQUAL(a[i], std::abs(X[i]));
+        BOOST_CHECK_EQUAL(q[i], X[i] / Y[i]);
+    }
+
+    // special values
+    std::vector<double> v = {0.0, -1.0, 1000.0, -1000.0, std::numeric_limits<double>::infinity()};
+    RandomVariable V(Array(v.begin(), v.end()));
+    RandomVariable ev = exp(V), lv = log(V), cv = normalCdf(V);
+    BOOST_CHECK_EQUAL(ev[0], 1.0);
+    BOOST_CHECK_EQUAL(ev[2], std::numeric_limits<double>::infinity());
+    BOOST_CHECK_EQUAL(ev[3], 0.0);
+    BOOST_CHECK_EQUAL(lv[0], -std::numeric_limits<double>::infinity());
+    BOOST_CHECK(std::isnan(lv[1]));
+    BOOST_CHECK_EQUAL(cv[0], 0.5);
+    BOOST_CHECK_EQUAL(cv[3], 0.0);
+    BOOST_CHECK_EQUAL(cv[4], 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(testExpressions) {
+    BOOST_TEST_MESSAGE("Testing fused evaluation of random variable expressions...");
+
+    // more than one block of paths, the last block is incomplete
+    Size n = 1000;
+    RandomVariable a(n), b(n), c(n), d(n, 0.5);
+    for (Size i = 0; i < n; ++i) {
+        a.set(i, std::sin(static_cast<double>(i)));
+        b.set(i, std::cos(static_cast<double>(i)));
+        c.set(i, 0.001 * static_cast<double>(i));
+    }
+    Filter f = a > b;
+
+    RandomVariable ref1 = a * b + c * exp(d) - RandomVariable(n, 2.0);
+    RandomVariable ref2 = conditionalResult(f, a / b, max(c, RandomVariable(n, 0.5)));
+    RandomVariable ref3 = applyFilter(normalCdf(a), f) + applyInverseFilter(-abs(b), f);
+
+    using namespace RandomVariableExpressions;
+    RandomVariable res1 = evaluate(lazy(a) * b + c * exp(lazy(d)) - 2.0);
+    RandomVariable res2 = evaluate(conditionalResult(f, lazy(a) / b, max(lazy(c), 0.5)));
+    RandomVariable res3 = evaluate(applyFilter(normalCdf(lazy(a)), f) + applyInverseFilter(-abs(lazy(b)), f));
+
+    BOOST_CHECK(!res1.deterministic());
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(res1[i], ref1[i]);
+        BOOST_CHECK_EQUAL(res2[i], ref2[i]);
+        BOOST_CHECK_EQUAL(res3[i], ref3[i]);
+    }
+
+    // deterministic expressions are evaluated once
+    RandomVariable res4 = evaluate(lazy(d) * 2.0 + exp(lazy(d)));
+    BOOST_CHECK(res4.deterministic());
+    BOOST_CHECK_EQUAL(res4.size(), n);
+    BOOST_CHECK_CLOSE(res4[0], 1.0 + std::exp(0.5), 1E-12);
+
+    RandomVariable e(n + 1);
+    BOOST_CHECK_THROW(evaluate(lazy(a) + e), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPool) {
+    BOOST_TEST_MESSAGE("Testing random variable buffer pool...");
+
+    RandomVariableBufferPool::releaseMemory();
+    RandomVariableBufferPool::resetStatistics();
+
+    Size n = 10000;
+    RandomVariable x(n, 1.0);
+    x.expand();
+    for (Size i = 0; i < 10; ++i) {
+        // one temporary per operation, its buffer is released before the next iteration
+        RandomVariable y = x * x;
+        BOOST_CHECK_EQUAL(y[0], 1.0);
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(y.data()) % RandomVariableBufferPool::alignment, 0u);
+    }
+
+    RandomVariableBufferPool::Statistics s = RandomVariableBufferPool::statistics();
+    BOOST_TEST_MESSAGE("allocations " << s.allocations << ", avoided " << s.allocationsAvoided);
+    BOOST_CHECK_EQUAL(s.allocations, 11u);
+    BOOST_CHECK_EQUAL(s.allocationsAvoided, 9u);
+    BOOST_CHECK(s.retainedBytes >= n * sizeof(Real));
+
+    RandomVariableBufferPool::releaseMemory();
+    BOOST_CHECK_EQUAL(RandomVariableBufferPool::statistics().retainedBytes, 0u);
+
+    // small buffers are not pooled
+    RandomVariableBufferPool::resetStatistics();
+    RandomVariable z(10, 1.0);
+    z.expand();
+    BOOST_CHECK_EQUAL(RandomVariableBufferPool::statistics().allocations, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testRegressionMethods) {
+    BOOST_TEST_MESSAGE("Testing regression methods and monomial basis...");
+
+    Size n = 5000;
+    RandomVariable x(n), y(n), r(n);
+    for (Size i = 0; i < n; ++i) {
+        Real a = std::sin(static_cast<Real>(i)), b = std::cos(3.0 * static_cast<Real>(i));
+        x.set(i, a);
+        y.set(i, b);
+        r.set(i, 1.0 + 2.0 * a - 0.5 * b + 0.3 * a * b + 0.1 * std::sin(7.0 * static_cast<Real>(i)));
+    }
+    std::vector<const RandomVariable*> regressor = {&x, &y};
+
+    std::vector<std::vector<Size>> monomials = monomialBasis(2, 2);
+    BOOST_REQUIRE_EQUAL(monomials.size(), 6u);
+    std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>> basisFn;
+    for (auto const& e : monomials) {
+        basisFn.push_back([e](const std::vector<const RandomVariable*>& v) {
+            RandomVariable t(v.front()->size(), 1.0);
+            for (Size k = 0; k < e.size(); ++k)
+                for (Size p = 0; p < e[k]; ++p)
+                    t *= *v[k];
+            return t;
+        });
+    }
+
+    Filter filter = x > RandomVariable(n, -0.5);
+    for (auto const& f : {Filter(), filter}) {
+        Array qr = regressionCoefficients(r, regressor, basisFn, f, RandomVariableRegressionMethod::QR);
+        Array svd = regressionCoefficients(r, regressor, basisFn, f, RandomVariableRegressionMethod::SVD);
+        Array ne = regressionCoefficients(r, regressor, basisFn, f, RandomVariableRegressionMethod::NormalEquations);
+        Array mono = regressionCoefficients(r, regressor, monomials, f);
+        BOOST_REQUIRE_EQUAL(mono.size(), qr.size());
+        for (Size j = 0; j < qr.size(); ++j) {
+            BOOST_CHECK_SMALL(svd[j] - qr[j], 1E-10);
+            BOOST_CHECK_SMALL(ne[j] - qr[j], 1E-10);
+            BOOST_CHECK_SMALL(mono[j] - qr[j], 1E-10);
+        }
+        RandomVariable e1 = conditionalExpectation(regressor, basisFn, qr);
+        RandomVariable e2 = conditionalExpectation(regressor, monomials, qr);
+        for (Size i = 0; i < n; ++i)
+            BOOST_CHECK_SMALL(e1[i] - e2[i], 1E-12);
+    }
+
+    // collinear regressors, the normal equations fall back to the svd
+    RandomVariable x2 = x * RandomVariable(n, 2.0);
+    std::vector<const RandomVariable*> collinear = {&x, &x2};
+    std::vector<std::vector<Size>> linear = monomialBasis(2, 1);
+    RandomVariable e1 = conditionalExpectation(r, collinear, linear);
+    RandomVariable e2 = conditionalExpectation(r, regressor, std::vector<std::vector<Size>>{{0, 0}, {1, 0}});
+    for (Size i = 0; i < n; ++i)
+        BOOST_CHECK_SMALL(e1[i] - e2[i], 1E-10);
+}
+
+BOOST_AUTO_TEST_CASE(testTapeDerivatives) {
+    BOOST_TEST_MESSAGE("Testing random variable tape derivatives...");
+
+    const Size n = 1000;
+    auto f = [n](const Real hx, const Real hy, std::vector<RandomVariable>* der) {
+        RandomVariableTape tape(n);
+        RandomVariable xv(n), yv(n);
+        for (Size i = 0; i < n; ++i) {
+            xv.set(i, -2.0 + 4.0 * (static_cast<Real>(i) + 0.5) / static_cast<Real>(n) + hx);
+            yv.set(i, 0.5 + static_cast<Real>(i) / static_cast<Real>(n) + hy);
+        }
+        Size x = tape.createInput(xv);
+        Size y = tape.createInput(yv);
+        Size c = tape.createInput(RandomVariable(n, 3.0));
+        // exp(x) * y - sqrt(y) / (x + 3) + pow(y, x) + normalCdf(x) * log(y) - normalPdf(y) + max(x, x + 3)
+        auto op = [&tape](const Size code, const std::vector<Size>& args) { return tape.applyOperation(code, args); };
+        Size t1 = op(RandomVariableOpCode::Mult, {op(RandomVariableOpCode::Exp, {x}), y});
+        Size t2 = op(RandomVariableOpCode::Div,
+                     {op(RandomVariableOpCode::Sqrt, {y}), op(RandomVariableOpCode::Add, {x, c})});
+        Size t3 = op(RandomVariableOpCode::Pow, {y, x});
+        Size t4 = op(RandomVariableOpCode::Mult,
+                     {op(RandomVariableOpCode::NormalCdf, {x}), op(RandomVariableOpCode::Log, {y})});
+        Size t5 = op(RandomVariableOpCode::Negative, {op(RandomVariableOpCode::NormalPdf, {y})});
+        Size t6 = op(RandomVariableOpCode::Max, {x, op(RandomVariableOpCode::Add, {x, c})});
+        Size r = op(RandomVariableOpCode::Subtract, {t1, t2});
+        for (auto t : {t3, t4, t5, t6})
+            r = op(RandomVariableOpCode::Add, {r, t});
+        if (der) {
+            auto d = tape.derivatives(r);
+            BOOST_REQUIRE_EQUAL(d.size(), tape.numberOfNodes());
+            *der = {d[x], d[y], d[c]};
+        }
+        return tape.value(r);
+    };
+
+    std::vector<RandomVariable> der;
+    f(0.0, 0.0, &der);
+    const Real h = 1E-6;
+    RandomVariable fdx = (f(h, 0.0, nullptr) - f(-h, 0.0, nullptr)) / RandomVariable(n, 2.0 * h);
+    RandomVariable fdy = (f(0.0, h, nullptr) - f(0.0, -h, nullptr)) / RandomVariable(n, 2.0 * h);
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_SMALL(der[0][i] - fdx[i], 1E-6);
+        BOOST_CHECK_SMALL(der[1][i] - fdy[i], 1E-6);
+        // c enters via the denominator x + c and the second argument of the max
+        Real xi = -2.0 + 4.0 * (static_cast<Real>(i) + 0.5) / static_cast<Real>(n);
+        Real yi = 0.5 + static_cast<Real>(i) / static_cast<Real>(n);
+        BOOST_CHECK_SMALL(der[2][i] - (std::sqrt(yi) / ((xi + 3.0) * (xi + 3.0)) + 1.0), 1E-12);
+    }
+
+    // conditional expectation, the regressand adjoint is projected on the regressors
+    RandomVariableTape tape(n);
+    RandomVariable xv(n);
+    for (Size i = 0; i < n; ++i)
+        xv.set(i, -2.0 + 4.0 * (static_cast<Real>(i) + 0.5) / static_cast<Real>(n));
+    Size x = tape.createInput(xv);
+    Size ce = tape.applyOperation(RandomVariableOpCode::ConditionalExpectation,
+                                  {tape.applyOperation(RandomVariableOpCode::Mult, {x, x}), x});
+    auto d = tape.derivatives(ce);
+    for (Size i = 0; i < n; ++i) {
+        BOOST_CHECK_SMALL(tape.value(ce)[i] - xv[i] * xv[i], 1E-10);
+        BOOST_CHECK_SMALL(d[x][i] - 2.0 * xv[i], 1E-10);
+    }
+
+    // the expectation of the smoothed indicator derivative approximates the density of x at zero
+    Size ind = tape.applyOperation(RandomVariableOpCode::IndicatorGt, {x, tape.createInput(RandomVariable(n, 0.0))});
+    BOOST_CHECK_CLOSE(expectation(tape.derivatives(ind)[x]).at(0), 0.25, 2.0);
+}
+
 BOOST_AUTO_TEST_CASE(testBlack) {
     BOOST_TEST_MESSAGE("Testing black formula...");
 
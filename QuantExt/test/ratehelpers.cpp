@@ -18,10 +18,15 @@
 
 #include "toplevelfixture.hpp"
 #include <boost/test/unit_test.hpp>
+#include <ql/indexes/ibor/euribor.hpp>
 #include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/math/interpolations/cubicinterpolation.hpp>
 #include <ql/termstructures/yield/flatforward.hpp>
 #include <ql/termstructures/yield/piecewiseyieldcurve.hpp>
+#include <ql/termstructures/yield/ratehelpers.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
 
+#include <qle/termstructures/iterativebootstrap.hpp>
 #include <qle/termstructures/tenorbasisswaphelper.hpp>
 
 #include <boost/make_shared.hpp>
@@ -75,6 +80,63 @@ BOOST_AUTO_TEST_CASE(testTenorBasisSwapHelperDegenerateSchedule) {
     BOOST_CHECK_NO_THROW(curve.discount(1.0));
 }
 
+BOOST_AUTO_TEST_CASE(testIterativeBootstrapGlobalNewtonAndWarmStart) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::IterativeBootstrap with global newton solver and warm start...");
+
+    SavedSettings backup;
+    Settings::instance().evaluationDate() = Date(8, Dec, 2016);
+    Date today = Settings::instance().evaluationDate();
+
+    boost::shared_ptr<IborIndex> euribor6m = boost::make_shared<Euribor6M>();
+    std::vector<Size> tenors = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 15, 20, 25, 30 };
+    std::vector<boost::shared_ptr<SimpleQuote> > quotes(1, boost::make_shared<SimpleQuote>(0.0010));
+    for (Size i = 0; i < tenors.size(); ++i)
+        quotes.push_back(boost::make_shared<SimpleQuote>(0.0015 + 0.0010 * std::sqrt(static_cast<Real>(tenors[i]))));
+
+    // each curve gets its own helpers, since the bootstrap links them to the curve
+    auto makeHelpers = [&]() {
+        std::vector<boost::shared_ptr<RateHelper> > helpers;
+        helpers.push_back(boost::make_shared<DepositRateHelper>(Handle<Quote>(quotes[0]), euribor6m));
+        for (Size i = 0; i < tenors.size(); ++i) {
+            helpers.push_back(boost::make_shared<SwapRateHelper>(Handle<Quote>(quotes[i + 1]), tenors[i] * Years,
+                                                                 TARGET(), Annual, ModifiedFollowing,
+                                                                 Thirty360(Thirty360::BondBasis), euribor6m));
+        }
+        return helpers;
+    };
+
+    typedef PiecewiseYieldCurve<ZeroYield, Cubic, QuantExt::IterativeBootstrap> CurveType;
+    Cubic cubic(CubicInterpolation::Spline, false, CubicInterpolation::SecondDerivative, 0.0,
+                CubicInterpolation::SecondDerivative, 0.0);
+    CurveType reference(today, makeHelpers(), Actual365Fixed(), cubic,
+                        QuantExt::IterativeBootstrap<CurveType>(1.0E-12));
+    CurveType newton(today, makeHelpers(), Actual365Fixed(), cubic,
+                     QuantExt::IterativeBootstrap<CurveType>(1.0E-12, Null<Real>(), false, 1, 2.0, 2.0, 10, true));
+
+    // warm start from the curve before a parallel shift of the quotes
+    std::vector<Date> dates;
+    std::vector<Real> values;
+    for (auto const& n : reference.nodes()) {
+        dates.push_back(n.first);
+        values.push_back(n.second);
+    }
+    for (auto const& q : quotes)
+        q->setValue(q->value() + 0.0005);
+    std::vector<boost::shared_ptr<RateHelper> > helpers = makeHelpers();
+    CurveType warmStart(today, helpers, Actual365Fixed(), cubic,
+                        QuantExt::IterativeBootstrap<CurveType>(1.0E-12, Null<Real>(), false, 1, 2.0, 2.0, 10, false,
+                                                                dates, values));
+
+    for (auto const& h : helpers) {
+        Date d = h->pillarDate();
+        BOOST_CHECK_CLOSE(newton.discount(d), reference.discount(d), 1.0E-8);
+        BOOST_CHECK_CLOSE(warmStart.discount(d), reference.discount(d), 1.0E-8);
+    }
+    for (auto const& h : helpers)
+        BOOST_CHECK_SMALL(h->quoteError(), 1.0E-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
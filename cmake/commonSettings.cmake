@@ -183,6 +183,12 @@ get_filename_component(OREANALYTICS_SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/../ORE
 get_filename_component(ORETEST_SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/../ORETest" ABSOLUTE)
 get_filename_component(RAPIDXML_SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/../ThirdPartyLibs/rapidxml-1.13" ABSOLUTE)
 
+# compile time log level, log messages with a level above it are removed, e.g. 16 removes DLOG and TLOG
+set(ORE_COMPILE_LOG_LEVEL "128" CACHE STRING "Highest log level compiled in (16 = notice, 32 = debug, 64 = data, 128 = all)")
+if (NOT ORE_COMPILE_LOG_LEVEL STREQUAL "128")
+    add_compile_definitions(ORE_COMPILE_LOG_LEVEL=${ORE_COMPILE_LOG_LEVEL})
+endif()
+
 # parallel unit test runner
 option(ORE_ENABLE_PARALLEL_UNIT_TEST_RUNNER "Enable the parallel unit test runner" OFF)
 if (ORE_ENABLE_PARALLEL_UNIT_TEST_RUNNER)